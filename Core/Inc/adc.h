@@ -29,7 +29,8 @@ extern "C" {
 #include "main.h"
 
 /* USER CODE BEGIN Includes */
-
+#include <stdbool.h>
+#include <stdint.h>
 /* USER CODE END Includes */
 
 extern ADC_HandleTypeDef hadc1;
@@ -41,7 +42,24 @@ extern ADC_HandleTypeDef hadc1;
 void MX_ADC1_Init(void);
 
 /* USER CODE BEGIN Prototypes */
+/**
+ * @brief 정전 감지 콜백 (ISR 에서 호출)
+ *
+ * @param fail true: RTK_BAT 가 low 아래로 떨어짐, false: high 위로 회복
+ */
+typedef void (*adc_power_fail_cb_t)(bool fail);
 
+/**
+ * @brief RTK_BAT(ADC1_IN6) 정전 감시 시작
+ *
+ * 연속 변환 + analog watchdog 으로 감시하므로 CPU 는 임계값을 넘을 때만
+ * 인터럽트를 받는다. low/high 사이는 hysteresis.
+ *
+ * @param low 정전으로 보는 ADC 값 (12bit)
+ * @param high 회복으로 보는 ADC 값 (12bit)
+ * @param cb 콜백
+ */
+void adc_power_fail_start(uint16_t low, uint16_t high, adc_power_fail_cb_t cb);
 /* USER CODE END Prototypes */
 
 #ifdef __cplusplus
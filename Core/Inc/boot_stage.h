@@ -0,0 +1,49 @@
+#ifndef BOOT_STAGE_H
+#define BOOT_STAGE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief 부팅 초기화 단계 (initThread 가 넘기는 표의 한 칸)
+ *
+ * 서로 의존하지 않는 단계는 각자 태스크에서 동시에 돈다. 한 단계가 ACK
+ * poll 이나 모듈 응답을 기다리며 잠든 동안 다른 단계가 진행된다.
+ */
+typedef struct {
+  const char *name;   /**< 로그/출력용 */
+  void (*fn)(void);   /**< NULL 이면 이 보드에서 안 씀 (바로 완료) */
+  uint32_t deps;      /**< 먼저 끝나야 하는 단계 (BOOT_STAGE_DEP(index) 의 OR) */
+  uint16_t stack_words;
+} boot_stage_t;
+
+#define BOOT_STAGE_DEP(idx) (1UL << (idx))
+
+/**
+ * @brief 표에 넣을 수 있는 최대 단계 수
+ */
+#define BOOT_STAGE_MAX 8
+
+/**
+ * @brief 단계 실행 (모두 끝날 때까지 대기, 태스크 컨텍스트)
+ *
+ * 의존이 풀린 단계마다 태스크를 만들어 돌리고, 끝나면 지운다.
+ * 단계별 시작/끝 시각 (HAL tick) 을 기록한다.
+ *
+ * @param[in] stage 표 (index 가 BOOT_STAGE_DEP 의 번호)
+ * @param[in] cnt BOOT_STAGE_MAX 이하
+ */
+void boot_stage_run(const boot_stage_t *stage, uint8_t cnt);
+
+/**
+ * @brief 단계별 시각을 문자열로
+ *
+ * 한 줄에 단계 하나 (+STAGE,이름,시작 ms,걸린 ms), 안 쓰는 단계는 빠진다.
+ *
+ * @param[out] buf
+ * @param[in] size
+ * @return size_t 쓴 길이, 버퍼가 모자라거나 기록이 없으면 0
+ */
+size_t boot_stage_format(char *buf, size_t size);
+
+#endif
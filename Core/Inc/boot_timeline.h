@@ -0,0 +1,54 @@
+#ifndef BOOT_TIMELINE_H
+#define BOOT_TIMELINE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief 부팅 ~ 첫 RTK fix 구간의 단계 (리셋 후 처음 도달한 시각만 기록)
+ */
+typedef enum {
+  BOOT_MARK_INIT_THREAD = 0, /**< initThread 시작 */
+  BOOT_MARK_PARAMS,          /**< flash_params_init 완료 */
+  BOOT_MARK_GPS_INIT,        /**< gps_init_all 완료 */
+  BOOT_MARK_LORA_INIT,       /**< lora_instance_init 완료 */
+  BOOT_MARK_RS485_INIT,      /**< rs485 init 완료 */
+  BOOT_MARK_BLE_INIT,        /**< ble_init_all 완료 */
+  BOOT_MARK_GPS_BAUD,        /**< F9P UART 보드레이트 확인/변경 완료 */
+  BOOT_MARK_GPS_CONFIG,      /**< UBX/Unicore 초기화 명령 완료 */
+  BOOT_MARK_LTE_REG,         /**< LTE 네트워크 등록 */
+  BOOT_MARK_NTRIP,           /**< NTRIP 스트림 수신 시작 */
+  BOOT_MARK_RTCM_FWD,        /**< 첫 RTCM 프레임을 GPS 로 전달 */
+  BOOT_MARK_RTK_FLOAT,       /**< 첫 RTK float */
+  BOOT_MARK_RTK_FIX,         /**< 첫 RTK fix */
+  BOOT_MARK_COUNT
+} boot_mark_t;
+
+/**
+ * @brief 기록 시작 (main 에서 HAL_Init 직후 한 번)
+ *
+ * 기록은 초기화하지 않는 RAM 에 있어서, 리셋 전 부팅의 기록이 남아 있으면
+ * 이전 부팅 기록으로 옮겨 두고 새로 시작한다.
+ */
+void boot_timeline_init(void);
+
+/**
+ * @brief 단계 도달 표시 (처음 한 번만 기록, 태스크/ISR 어디서나)
+ */
+void boot_timeline_mark(boot_mark_t mark);
+
+/**
+ * @brief 단계별 시각을 문자열로
+ *
+ * 한 줄에 단계 하나 (+BOOT,이름,ms 또는 -), 첫 줄은 +BOOT,n=부팅 번호.
+ * 시각은 리셋 후 HAL tick (ms).
+ *
+ * @param[out] buf
+ * @param[in] size
+ * @param[in] prev true 면 이전 부팅 기록
+ * @return size_t 쓴 길이, 버퍼가 모자라거나 기록이 없으면 0
+ */
+size_t boot_timeline_format(char *buf, size_t size, bool prev);
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef DIAG_BUNDLE_H
+#define DIAG_BUNDLE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief 원격 진단 묶음 (디버거 없이 현장 장비 상태를 한 번에)
+ *
+ * 요청한 순간의 상태를 RAM 버퍼 하나에 바이너리로 만들어 두고 (다시 만들 때까지
+ * 그대로) 각 경로 (BLE DG, RS485 AT+DIAG, LTE telemetry) 가 offset 으로 조각씩
+ * 읽어 간다. 만드는 동안만 읽기가 막히고, 조각 복사는 critical section 안의
+ * memcpy 하나라 GNSS/보정 경로를 막지 않는다.
+ *
+ * 묶음 (little-endian):
+ *
+ *  off size
+ *   0  4   magic "DGB1"
+ *   4  1   version (1)
+ *   5  1   section 수
+ *   6  2   전체 길이 (CRC 포함)
+ *   8  12  MCU UID
+ *  20  4   uptime [ms]
+ *  24  4   부팅 번호 (pm_trace)
+ *  28  1   이번 부팅 리셋 원인 (RCC_CSR 상위 8 bit)
+ *  29  3   0
+ *  32  4   설정 hash (user_params_t crc32, 사용량 필드 제외)
+ *  36  .   section 들: type(1) 0(1) len(2) + len byte (들어가지 않는 section 은 뺌)
+ *  끝  2   CRC16-CCITT (init 0xFFFF, 0 부터 마지막 section 끝까지)
+ */
+#define DIAG_BUNDLE_MAGIC 0x31424744 // "DGB1"
+#define DIAG_BUNDLE_VERSION 1
+#define DIAG_BUNDLE_SIZE 3584
+#define DIAG_TRACE_PREV_MAX 32 // 리셋 전 부팅 pm_trace 최근 레코드
+#define DIAG_TRACE_CUR_MAX 16
+
+typedef enum {
+  DIAG_SEC_TASK = 1,   // rtos_stats_pack(): ms(4) + rtos_task_rec_t 씩
+  DIAG_SEC_HEAP = 2,   // free(4) min(4) largest(4) allocs(4) frees(4) [byte, 횟수]
+  DIAG_SEC_WM = 3,     // mem_wm_pack(): mem_wm_rec_t 씩
+  DIAG_SEC_GPS = 4,    // 수신기마다 id(1) 0(3) + gps_stats_t
+  DIAG_SEC_RTCM = 5,   // 소스마다 src(1) 0(3) + rtcm_router_stats_t
+  DIAG_SEC_LORA = 6,   // lora_stats_t
+  DIAG_SEC_NTRIP = 7,  // ntrip_mon_stats_t
+  DIAG_SEC_TRACE = 8,  // 리셋 전 부팅: boot(4) reset(1) 0(3) + pm_trace_rec_t 씩 (오래된 것부터)
+  DIAG_SEC_TRACE_CUR = 9, // 이번 부팅, 형식 같음
+  DIAG_SEC_PARAMS = 10,   // user_params_t (비밀번호 필드는 0)
+} diag_sec_t;
+
+/**
+ * @brief 지금 상태로 묶음을 새로 만듦 (부른 태스크에서, 수 ms)
+ *
+ * 만드는 동안 diag_bundle_read() 는 0 을 돌려준다.
+ *
+ * @param[out] crc NULL 이 아니면 묶음 끝 CRC16
+ * @return size_t 묶음 길이, 다른 태스크가 만드는 중이면 0
+ */
+size_t diag_bundle_build(uint16_t *crc);
+
+/**
+ * @brief 마지막으로 만든 묶음 길이 (없으면 0)
+ */
+size_t diag_bundle_len(void);
+
+/**
+ * @brief 묶음 off 부터 len 까지 복사
+ *
+ * @return size_t 복사한 길이, off 가 끝이거나 묶음이 없으면 0
+ */
+size_t diag_bundle_read(size_t off, uint8_t *dst, size_t len);
+
+#endif
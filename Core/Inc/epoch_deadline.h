@@ -0,0 +1,64 @@
+#ifndef EPOCH_DEADLINE_H
+#define EPOCH_DEADLINE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief 항법 해 epoch -> 출력 소비자가 그 epoch 를 마칠 때까지 (출력 마감 감시)
+ *
+ * 기준 수신기의 항법 해 프레임이 완성될 때 (gps_on_new_solution, RX 태스크)
+ * DWT 시각과 순번을 찍고, 순번은 APP_EVT_GPS_SOLUTION/GGA 에 실려 간다.
+ * 소비자 (항법 해 fan-out, pos_out sink, NTRIP GGA) 가 자기 일을 마치면 그
+ * 순번으로 지연을 재서 소비자별 min/avg/p50/p99/max 와 히스토그램에 넣는다.
+ * DEADLINE 을 넘기거나 시각 기록이 이미 덮인 (RING epoch 넘게 늦은) 것은
+ * miss 로 센다. 태스크 우선순위와 lane 배치를 정하는 용도.
+ */
+#define EPOCH_DL_DEADLINE_MS 50
+#define EPOCH_DL_CONSUMER_MAX 8
+#define EPOCH_DL_RING 8 /* 2 의 거듭제곱 */
+
+/**
+ * @brief 새 epoch (RX 태스크, 기준 수신기 항법 해 프레임 완성 직후)
+ *
+ * @return uint16_t 이번 epoch 순번
+ */
+uint16_t epoch_dl_begin(void);
+
+/**
+ * @brief 마지막 epoch 순번 (순번을 못 받은 생산자용, gps_fuse)
+ */
+uint16_t epoch_dl_seq(void);
+
+/**
+ * @brief 소비자 등록 (init 에서, 이름은 static 문자열)
+ *
+ * @param[in] every true: 매 epoch 를 받아야 하는 소비자 (건너뛴 순번을 skip 으로 셈)
+ * @return int 소비자 번호, 가득 차면 -1 (epoch_dl_done 이 무시)
+ */
+int epoch_dl_register(const char *name, bool every);
+
+/**
+ * @brief 소비자가 epoch 하나를 마침
+ */
+void epoch_dl_done(int id, uint16_t seq);
+
+/**
+ * @brief 소비자별 지연 통계를 문자열로
+ *
+ * +EPDL,이름,n=,miss=,skip=,min=,avg=,p50=,p99=,max= (us). p50/p99 는 히스토그램
+ * 칸의 위쪽 경계. 표본이 없는 소비자는 빠지고, 하나도 없으면 +EPDL,none.
+ *
+ * @param[out] buf
+ * @param[in] size
+ * @return size_t 쓴 길이, 버퍼가 모자라면 0
+ */
+size_t epoch_dl_format(char *buf, size_t size);
+
+/**
+ * @brief 통계를 지우고 지금부터 다시 측정 (등록은 그대로)
+ */
+void epoch_dl_reset(void);
+
+#endif
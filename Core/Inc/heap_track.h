@@ -0,0 +1,65 @@
+#ifndef HEAP_TRACK_H
+#define HEAP_TRACK_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief FreeRTOS heap 사용처 구분
+ *
+ * heap_4 의 traceMALLOC/traceFREE 에서 현재 태그로 기록한다. 태그를 붙이지
+ * 않은 할당 (한 번 만드는 큐/뮤텍스/타이머 등) 은 HEAP_TAG_OTHER.
+ */
+typedef enum {
+  HEAP_TAG_OTHER = 0,
+  HEAP_TAG_TASK,     /**< xTaskCreate 스택 + TCB */
+  HEAP_TAG_CMD_SEM,  /**< 명령마다 만들고 지우는 응답 세마포어 */
+  HEAP_TAG_SOCKET,   /**< tcp_socket_t */
+  HEAP_TAG_STATS,    /**< 진단용 임시 버퍼 (태스크 스냅샷) */
+  HEAP_TAG_COUNT
+} heap_tag_t;
+
+/**
+ * @brief 이후 할당을 tag 로 기록 (스케줄러를 멈춤, heap_track_exit 와 짝)
+ *
+ * @return heap_tag_t 이전 태그 (exit 에 넘김)
+ */
+heap_tag_t heap_track_enter(heap_tag_t tag);
+void heap_track_exit(heap_tag_t prev);
+
+/**
+ * @brief expr 안의 heap 할당을 tag 로 기록하고 expr 의 값을 돌려줌
+ *
+ * 예: sem = HEAP_TRACK(HEAP_TAG_CMD_SEM, xSemaphoreCreateBinary());
+ * 그 사이 스케줄러가 멈추므로 블로킹하는 호출은 넣지 않는다.
+ */
+#define HEAP_TRACK(tag, expr)                                                  \
+  ({                                                                           \
+    heap_tag_t heap_track_prev_ = heap_track_enter(tag);                       \
+    __typeof__(expr) heap_track_ret_ = (expr);                                 \
+    heap_track_exit(heap_track_prev_);                                         \
+    heap_track_ret_;                                                           \
+  })
+
+/* FreeRTOSConfig.h 의 traceMALLOC/traceFREE (heap_4 안, 스케줄러 멈춘 상태) */
+void heap_track_on_malloc(void *ptr, size_t size);
+void heap_track_on_free(void *ptr);
+
+/**
+ * @brief 태그별 heap 사용량을 문자열로
+ *
+ * 한 줄에 태그 하나 (+HEAPTAG,이름,cur=,peak=,n=,fail=; byte 는 블록 헤더 포함)
+ * 와 마지막에 +HEAP,total=,free=,min=,untracked=.
+ *
+ * @param[out] buf
+ * @param[in] size
+ * @return size_t 쓴 길이, 버퍼가 모자라면 0
+ */
+size_t heap_track_format(char *buf, size_t size);
+
+/**
+ * @brief peak 를 현재 값으로 되돌림 (fail 카운트도 0)
+ */
+void heap_track_reset_peak(void);
+
+#endif
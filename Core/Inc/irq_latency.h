@@ -0,0 +1,77 @@
+#ifndef IRQ_LATENCY_H
+#define IRQ_LATENCY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief UART IDLE 인터럽트 -> 담당 태스크가 그 구간을 처리하기 시작할 때까지
+ *
+ * ISR 이 IDLE 에서 DWT 시각을 찍고, 태스크가 깨어나 처리를 시작할 때 차이를
+ * 포트별 min/avg/max 와 히스토그램 (p99) 에 넣는다. 태스크 우선순위를 정하고
+ * 새 태스크가 파서를 굶기는 회귀를 잡는 용도. 끄면 매크로가 모두 비어서
+ * 코드가 생기지 않는다.
+ */
+// #define USE_IRQ_LATENCY
+
+typedef enum {
+  IRQ_LAT_GPS1 = 0, /**< USART2 -> GPS RX 태스크 (GPS_ID_BASE) */
+  IRQ_LAT_GPS2,     /**< UART4 -> GPS RX 태스크 (GPS_ID_ROVER) */
+  IRQ_LAT_GSM,      /**< USART1 -> gsm 태스크 */
+  IRQ_LAT_LORA,     /**< USART3 -> lora RX 태스크 */
+  IRQ_LAT_UART5,    /**< UART5 -> BLE (기준국) 또는 RS485 (로버) RX 태스크 */
+  IRQ_LAT_PORT_CNT
+} irq_lat_port_t;
+
+#if defined(USE_IRQ_LATENCY)
+#include "stm32f4xx.h"
+#include <stdbool.h>
+
+typedef struct {
+  volatile uint32_t cyc;     // 처리 안 된 가장 오래된 IDLE 시각
+  volatile bool pending;     // ISR 이 세우고 태스크가 내림
+} irq_lat_stamp_t;
+
+extern irq_lat_stamp_t irq_lat_stamps[IRQ_LAT_PORT_CNT];
+
+/**
+ * @brief IDLE 시각 기록 (UART ISR, 앞의 IDLE 이 아직 처리 안 됐으면 그대로 둠)
+ */
+static inline void irq_lat_isr(irq_lat_port_t port) {
+  irq_lat_stamp_t *s = &irq_lat_stamps[port];
+
+  if (!s->pending) {
+    s->cyc = DWT->CYCCNT;
+    s->pending = true;
+  }
+}
+
+/**
+ * @brief 처리 시작 (담당 태스크가 깨어난 직후, 포트마다 태스크 하나)
+ *
+ * DMA HT/TC 나 타임아웃으로 깬 경우는 IDLE 기록이 없어서 넘어간다.
+ */
+void irq_lat_task(irq_lat_port_t port);
+#else
+#define irq_lat_isr(port) ((void)0)
+#define irq_lat_task(port) ((void)0)
+#endif
+
+/**
+ * @brief 포트별 지연 통계를 문자열로
+ *
+ * +IRQLAT,이름,n=,min=,avg=,p99=,max= (us). p99 는 히스토그램 칸의 위쪽 경계.
+ * 표본이 없는 포트는 빠지고, 하나도 없으면 +IRQLAT,none, 꺼져 있으면 +IRQLAT,off.
+ *
+ * @param[out] buf
+ * @param[in] size
+ * @return size_t 쓴 길이, 버퍼가 모자라면 0
+ */
+size_t irq_lat_format(char *buf, size_t size);
+
+/**
+ * @brief 통계를 지우고 지금부터 다시 측정
+ */
+void irq_lat_reset(void);
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef LOAD_GOV_H
+#define LOAD_GOV_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief CPU/대역폭 과부하 때 덜 중요한 일부터 끄는 조절기
+ *
+ * 1 초마다 CPU 사용률 (idle 시간), 등록된 버퍼/큐의 최대 채움 (mem_watermark),
+ * 로그 버림을 보고 과부하면 한 단계씩 올리고 조용하면 한 단계씩 내린다.
+ * 올릴 때는 연속 LOAD_GOV_UP_CNT 번, 내릴 때는 LOAD_GOV_DOWN_CNT 번 봐서
+ * 경계에서 오르내리지 않게 한다. 단계가 오를수록 아래 동작이 쌓인다.
+ */
+typedef enum {
+  LOAD_GOV_NORMAL = 0,
+  LOAD_GOV_NO_DEBUG,       /**< DEBUG 로그 끔 (log_set_cap INFO) */
+  LOAD_GOV_DECIM_OUT,      /**< RS485/BLE 위치 출력 1/LOAD_GOV_OUT_DECIM */
+  LOAD_GOV_RTCM_ESSENTIAL, /**< 궤도력 등 선택 RTCM 메시지 안 보냄 */
+  LOAD_GOV_NAV_RATE,       /**< F9P 측정 주기 절반 (RAM 레이어) */
+  LOAD_GOV_LEVEL_COUNT
+} load_gov_level_t;
+
+#define LOAD_GOV_PERIOD_MS 1000
+#define LOAD_GOV_CPU_HIGH 850 // [0.1 %]
+#define LOAD_GOV_CPU_LOW 650
+#define LOAD_GOV_FILL_HIGH 80 // [%]
+#define LOAD_GOV_FILL_LOW 50
+#define LOAD_GOV_UP_CNT 2
+#define LOAD_GOV_DOWN_CNT 10
+#define LOAD_GOV_OUT_DECIM 4
+
+/**
+ * @brief 시작 (work queue 뒤, 부팅 마지막에)
+ */
+void load_gov_init(void);
+
+load_gov_level_t load_gov_get_level(void);
+
+/**
+ * @brief 상태 문자열 +LG,lv=,cpu=,fill=,up=,down=
+ *
+ * cpu 는 0.1 %, fill 은 % (직전 샘플), up/down 은 단계를 올리고 내린 횟수.
+ *
+ * @return size_t 길이, 버퍼 부족이면 0
+ */
+size_t load_gov_format(char *buf, size_t size);
+
+#endif
@@ -0,0 +1,102 @@
+#ifndef MEM_WATERMARK_H
+#define MEM_WATERMARK_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "FreeRTOS.h"
+#include "queue.h"
+
+/**
+ * @brief 고정 버퍼 (링/재조립 버퍼) 의 최대 사용량
+ *
+ * 모듈이 정적으로 하나 두고 init 에서 mem_wm_register(), 버퍼를 읽을 때마다
+ * 그 순간 쌓여 있던 양으로 mem_wm_update(). 버퍼 크기를 줄이거나 늘릴 때
+ * peak 가 size 에 얼마나 가까운지 본다.
+ */
+typedef struct mem_wm {
+  const char *name;
+  uint32_t size;
+  volatile uint32_t peak;
+  volatile uint32_t win; // mem_wm_take_fill() 이후 최대
+  struct mem_wm *next;
+} mem_wm_t;
+
+#define MEM_WM_INIT(name_, size_) {.name = (name_), .size = (size_)}
+
+/**
+ * @brief 목록에 추가 (같은 항목을 두 번 넣어도 한 번만 들어감)
+ */
+void mem_wm_register(mem_wm_t *wm);
+
+/**
+ * @brief 지금 사용량이 peak 보다 크면 기록 (버퍼를 쓰는 태스크 하나만 호출)
+ */
+static inline void mem_wm_update(mem_wm_t *wm, uint32_t used) {
+  if (used > wm->peak) {
+    wm->peak = used;
+  }
+  if (used > wm->win) {
+    wm->win = used;
+  }
+}
+
+/**
+ * @brief 큐의 최대 대기 항목 수를 기록하도록 등록
+ *
+ * uxQueueNumber 에 슬롯 번호를 넣고 traceQUEUE_SEND 에서 O(1) 로 갱신한다.
+ * 지우지 않는 큐만 등록한다 (슬롯을 되돌려 받지 않음).
+ *
+ * @return QueueHandle_t q 그대로 (생성 식을 감싸서 쓸 수 있게)
+ */
+QueueHandle_t mem_wm_register_queue(QueueHandle_t q, const char *name);
+
+/* FreeRTOSConfig.h 의 traceQUEUE_SEND(_FROM_ISR) (queue.c, critical section 안) */
+void mem_wm_on_queue_send(uint32_t num, uint32_t waiting);
+
+/**
+ * @brief 등록된 버퍼/큐와 메모리 풀의 최대 사용량을 문자열로
+ *
+ * +WM,이름,size=,peak= (byte), +WMQ,이름,len=,peak= (항목),
+ * +WMPOOL,이름,size=,peak=,fail= (블록; event bus 풀, GSM TCP pbuf/TX 버퍼 등급별).
+ *
+ * @param[out] buf
+ * @param[in] size
+ * @return size_t 쓴 길이, 버퍼가 모자라면 0
+ */
+size_t mem_wm_format(char *buf, size_t size);
+
+/**
+ * @brief 버퍼/큐 하나 (진단 묶음 diag_bundle, little-endian)
+ */
+typedef struct __attribute__((packed)) {
+  uint8_t kind;  // 0: 버퍼 [byte], 1: 큐 [항목]
+  char name[8];  // 0 으로 채움 (잘릴 수 있음)
+  uint32_t size;
+  uint32_t peak;
+} mem_wm_rec_t;
+
+/**
+ * @brief 등록된 버퍼/큐의 최대 사용량을 바이너리로 (등록 순서, 항목마다 mem_wm_rec_t)
+ *
+ * @return size_t 쓴 길이, 버퍼가 모자라면 0
+ */
+size_t mem_wm_pack(uint8_t *buf, size_t size);
+
+/**
+ * @brief 직전 호출 이후 등록된 버퍼/큐 중 가장 많이 찼던 비율 [%]
+ *
+ * 부하 조절 (load_gov) 이 주기적으로 부른다. 구간 최대만 지우고 peak 는 둔다.
+ */
+uint8_t mem_wm_take_fill(void);
+
+/**
+ * @brief 등록된 버퍼/큐 중 peak 가 가장 높은 비율 [%] (지우지 않음)
+ */
+uint8_t mem_wm_peak_fill(void);
+
+/**
+ * @brief 버퍼/큐 peak 를 0 으로 (풀 peak 는 각 모듈 통계라 그대로)
+ */
+void mem_wm_reset_peak(void);
+
+#endif
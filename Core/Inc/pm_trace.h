@@ -0,0 +1,96 @@
+#ifndef PM_TRACE_H
+#define PM_TRACE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief 리셋 직전 몇 초를 남기는 사후 분석용 이벤트 링
+ *
+ * 레코드 (DWT 사이클, 이벤트, 인자 2개) 를 초기화하지 않는 SRAM (.noinit)
+ * 링에 남긴다. 링은 두 개를 부팅마다 번갈아 써서, 리셋 전 부팅의 링은 복사
+ * 없이 그대로 남고 리셋 후 BLE/RS485/LTE 로 꺼낼 수 있다.
+ *
+ * 기록은 자리 하나를 원자적으로 잡고 채우는 것뿐이라 잠금이 없고 태스크,
+ * ISR, fault 핸들러 어디서나 부를 수 있다. 읽는 중 덮인 레코드는 섞일 수
+ * 있다 (지난 부팅 링은 안 바뀜).
+ */
+
+#define PM_TRACE_LEN 128 // 링 하나의 레코드 수 (2 의 거듭제곱)
+
+typedef enum {
+  PM_EVT_NONE = 0,
+  PM_EVT_BOOT,          /**< a: 리셋 원인 (RCC_CSR 상위 8비트), b: 부팅 번호 */
+  PM_EVT_FAULT,         /**< a: 예외 번호, b: PC (태스크에서 난 것만, 아니면 0) */
+  PM_EVT_FAULT_REG,     /**< a: HFSR 상위 16비트, b: CFSR */
+  PM_EVT_MALLOC_FAIL,   /**< a: 남은 heap (포화), b: 태스크 핸들 */
+  PM_EVT_STACK_OVF,     /**< b: 태스크 핸들 */
+  PM_EVT_GPS_FIX,       /**< a: GPS id, b: 이전 fix << 8 | 새 fix */
+  PM_EVT_GPS_CMD_TMO,   /**< a: GPS id */
+  PM_EVT_RTCM_SRC,      /**< a: 새 소스, b: 이전 소스 */
+  PM_EVT_LTE_INIT,      /**< a: 1 성공 / 0 실패, b: 실패한 단계 */
+  PM_EVT_NTRIP_UP,      /**< a: link, b: 받은 바이트 */
+  PM_EVT_NTRIP_DOWN,    /**< a: link, b: 받은 바이트 */
+  PM_EVT_LORA_TMO,      /**< a: 0 명령 응답 / 1 radio TX */
+  PM_EVT_LOAD_LEVEL,    /**< a: 새 과부하 단계, b: CPU [0.1 %] << 8 | 채움 [%] */
+  PM_EVT_RTCM_BASE,     /**< a: 고른 기준국 ID (0xFFFF 없음), b: 거리 [m] */
+  PM_EVT_COUNT
+} pm_evt_t;
+
+typedef struct {
+  uint32_t cyc; // DWT->CYCCNT (168 MHz, 약 25 초마다 돎)
+  uint16_t id;  // pm_evt_t
+  uint16_t a;
+  uint32_t b;
+} pm_trace_rec_t;
+
+/**
+ * @brief 시작 (main 에서 HAL_Init 직후 한 번, 기록 전에)
+ *
+ * 리셋 원인을 읽고 지운 뒤, 지난 부팅 링은 남기고 다른 링에 새로 쓴다.
+ */
+void pm_trace_init(void);
+
+/**
+ * @brief 레코드 하나 (잠금 없음, 어디서나)
+ */
+void pm_trace(pm_evt_t id, uint16_t a, uint32_t b);
+
+/**
+ * @brief fault 핸들러에서 리셋 전에 (예외 번호, PC, fault 레지스터)
+ *
+ * @param[in] exc_return 핸들러 진입 LR (__builtin_return_address(0)),
+ *            태스크 (PSP) 에서 난 fault 면 쌓인 프레임에서 PC 를 꺼낸다
+ */
+void pm_trace_fault(uint32_t exc_return);
+
+/**
+ * @brief 링 정보
+ *
+ * @param[in] prev true 면 리셋 전 부팅
+ * @param[out] boot 부팅 번호
+ * @param[out] reset 그 부팅이 끝난 리셋 원인 (prev 만, 아니면 0)
+ * @return uint16_t 남은 레코드 수, 기록이 없으면 0
+ */
+uint16_t pm_trace_info(bool prev, uint32_t *boot, uint8_t *reset);
+
+/**
+ * @brief 오래된 것부터 first 번째 레코드부터 읽기
+ *
+ * @return size_t 읽은 레코드 수
+ */
+size_t pm_trace_read(bool prev, uint16_t first, pm_trace_rec_t *out, size_t max);
+
+/**
+ * @brief 링을 문자열로 (첫 줄 +PMT,n=,rst=,cnt=, 한 줄에 레코드 하나)
+ *
+ * 레코드 줄은 +PMT,마지막 레코드까지 남은 us,이벤트,a,b. 버퍼가 모자라면
+ * 들어간 줄까지만 쓰고 *next 에 다음 레코드 번호를 둔다 (first 0 일 때만
+ * 첫 줄).
+ *
+ * @return size_t 쓴 길이, 기록이 없거나 다 썼으면 0
+ */
+size_t pm_trace_format(char *buf, size_t size, bool prev, uint16_t first, uint16_t *next);
+
+#endif
@@ -0,0 +1,61 @@
+#ifndef RTOS_STATS_H
+#define RTOS_STATS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief 태스크별 CPU 점유율, 스택 여유, heap 상태를 문자열로
+ *
+ * 한 줄에 태스크 하나 (+TASK,이름,prio=,cpu=%,stack=남은 word) 와
+ * 마지막에 +HEAP,free=,min= (byte). CPU 는 마지막 rtos_stats_reset()
+ * (없으면 부팅) 이후 구간의 DWT cycle 기준.
+ *
+ * @param[out] buf
+ * @param[in] size
+ * @return size_t 쓴 길이, 버퍼가 모자라거나 메모리가 없으면 0
+ */
+size_t rtos_stats_format(char *buf, size_t size);
+
+/**
+ * @brief 태스크 하나 (진단 묶음 diag_bundle, little-endian)
+ */
+typedef struct __attribute__((packed)) {
+  char name[8];   // 0 으로 채움 (잘릴 수 있음)
+  uint8_t prio;
+  uint8_t state;  // eTaskState
+  uint16_t cpu;   // [0.1 %]
+  uint16_t stack; // 남은 word
+} rtos_task_rec_t;
+
+/**
+ * @brief rtos_stats_format() 과 같은 구간의 태스크 상태를 바이너리로
+ *
+ * 구간 길이 [ms] (4) 다음에 태스크마다 rtos_task_rec_t.
+ *
+ * @return size_t 쓴 길이, 버퍼가 모자라거나 메모리가 없으면 0
+ */
+size_t rtos_stats_pack(uint8_t *buf, size_t size);
+
+/**
+ * @brief CPU 점유율 측정 구간을 지금부터 다시 시작
+ */
+void rtos_stats_reset(void);
+
+/**
+ * @brief CPU 사용률 측정 구간 (호출자가 들고 있음, 처음엔 0)
+ */
+typedef struct {
+  uint64_t idle;
+  uint64_t total;
+} rtos_load_t;
+
+/**
+ * @brief 직전 호출 이후 CPU 사용률 [0.1 %] (idle 태스크 외 전부)
+ *
+ * 태스크 목록을 훑지 않아 주기적으로 불러도 가볍다. 구간은 호출자마다
+ * 따로라 rtos_stats_reset() 과 섞이지 않는다.
+ */
+uint16_t rtos_stats_cpu_load(rtos_load_t *prev);
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef SOAK_H
+#define SOAK_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief 장시간 soak 측정 (느린 열화: heap 조각화, 큐 peak 증가, 지연 증가)
+ *
+ * 켜 둔 부하 (RTCM 부하 생성기 rtcm_loadgen, 실제 보정/GNSS 트래픽) 를 그대로
+ * 두고 1 분마다 아래 값을 RAM 시계열에 쌓는다. 칸이 다 차면 이웃 두 칸을
+ * 합쳐 간격을 두 배로 늘리므로 몇 시간이든 SOAK_SAMPLES 칸 안에 들어간다.
+ * 끝나면 항목마다 최소제곱 기울기 (시간당 변화) 로 추세를 보여준다.
+ * 시작할 때 부하 생성기가 켜져 있었으면 끝날 때 같이 끈다.
+ */
+typedef enum {
+  SOAK_F_FREE = 0, /**< heap 여유 (가장 낮았던 값) [8 byte] */
+  SOAK_F_MIN,      /**< heap 부팅 이후 최소 여유 [8 byte] */
+  SOAK_F_BIG,      /**< 가장 큰 빈 블록 (가장 낮았던 값) [8 byte] */
+  SOAK_F_FILL,     /**< 등록된 버퍼/큐 중 가장 높은 peak [%] */
+  SOAK_F_ERR,      /**< 구간 동안 늘어난 GNSS 파서 오류 + RX overrun */
+  SOAK_F_LAT,      /**< 구간 평균 보정 데이터 나이 (RTCM_LAT_TOTAL) [ms] */
+  SOAK_F_CPU,      /**< 구간 CPU 사용률 [0.1 %] */
+  SOAK_F_COUNT
+} soak_field_t;
+
+#define SOAK_PERIOD_MS 60000
+#define SOAK_SAMPLES 256
+#define SOAK_MAX_MIN (7U * 24U * 60U) // 한 번에 최대 일주일
+
+typedef struct {
+  uint16_t v[SOAK_F_COUNT];
+} soak_sample_t;
+
+/**
+ * @brief 시작 (이전 시계열은 지움), minutes 0 이면 지금 멈춤
+ *
+ * @return false: minutes 가 SOAK_MAX_MIN 보다 큼
+ */
+bool soak_start(uint32_t minutes);
+
+bool soak_running(void);
+
+/**
+ * @brief 상태와 추세
+ *
+ * +SOAK,st=<off|run|done>,el=<분>,dur=<분>,n=<칸>,step=<분> 다음에 항목마다
+ * +SOAKD,이름,first=,last=,min=,max=,slope=<시간당> (heap 은 byte, err 는 시간당 개수).
+ *
+ * @return size_t 길이, 시계열이 없거나 버퍼 부족이면 0
+ */
+size_t soak_format(char *buf, size_t size);
+
+/**
+ * @brief 시계열 원본 (first 번째 칸부터 버퍼가 차는 만큼)
+ *
+ * +SOAKS,<분>,free,min,big,fill,err,lat,cpu (저장한 단위 그대로)
+ *
+ * @param[out] next 다음에 넘길 first
+ * @return size_t 길이, 더 없으면 0
+ */
+size_t soak_format_series(char *buf, size_t size, uint16_t first, uint16_t *next);
+
+#endif
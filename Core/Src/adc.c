@@ -118,5 +118,66 @@ void HAL_ADC_MspDeInit(ADC_HandleTypeDef *adcHandle) {
 }
 
 /* USER CODE BEGIN 1 */
+static adc_power_fail_cb_t power_fail_cb;
+static uint16_t power_fail_low;
+static uint16_t power_fail_high;
+static bool power_failed;
 
+void adc_power_fail_start(uint16_t low, uint16_t high, adc_power_fail_cb_t cb) {
+  ADC_ChannelConfTypeDef sConfig = {0};
+  ADC_AnalogWDGConfTypeDef wdg = {0};
+
+  power_fail_cb = cb;
+  power_fail_low = low;
+  power_fail_high = high;
+  power_failed = false;
+
+  // 변환 결과를 읽지 않으므로 EOC/overrun 없이 계속 변환
+  hadc1.Init.ContinuousConvMode = ENABLE;
+  hadc1.Init.EOCSelection = ADC_EOC_SEQ_CONV;
+  if (HAL_ADC_Init(&hadc1) != HAL_OK) {
+    return;
+  }
+
+  // 잡음을 줄이려고 가장 긴 sample time
+  sConfig.Channel = ADC_CHANNEL_6;
+  sConfig.Rank = 1;
+  sConfig.SamplingTime = ADC_SAMPLETIME_480CYCLES;
+  if (HAL_ADC_ConfigChannel(&hadc1, &sConfig) != HAL_OK) {
+    return;
+  }
+
+  wdg.WatchdogMode = ADC_ANALOGWATCHDOG_SINGLE_REG;
+  wdg.Channel = ADC_CHANNEL_6;
+  wdg.HighThreshold = 0xFFF;
+  wdg.LowThreshold = low;
+  wdg.ITMode = ENABLE;
+  if (HAL_ADC_AnalogWDGConfig(&hadc1, &wdg) != HAL_OK) {
+    return;
+  }
+
+  HAL_NVIC_SetPriority(ADC_IRQn, 5, 0);
+  HAL_NVIC_EnableIRQ(ADC_IRQn);
+  HAL_ADC_Start(&hadc1);
+}
+
+void HAL_ADC_LevelOutOfWindowCallback(ADC_HandleTypeDef *hadc) {
+  if (hadc->Instance != ADC1) {
+    return;
+  }
+
+  // 창을 반대쪽으로 옮겨서 같은 방향으로는 한 번만 알림
+  power_failed = !power_failed;
+  if (power_failed) {
+    hadc->Instance->LTR = 0;
+    hadc->Instance->HTR = power_fail_high;
+  } else {
+    hadc->Instance->LTR = power_fail_low;
+    hadc->Instance->HTR = 0xFFF;
+  }
+
+  if (power_fail_cb) {
+    power_fail_cb(power_failed);
+  }
+}
 /* USER CODE END 1 */
@@ -0,0 +1,122 @@
+#include "boot_stage.h"
+#include "FreeRTOS.h"
+#include "heap_track.h"
+#include "stm32f4xx_hal.h"
+#include "task.h"
+#include <stdio.h>
+
+#define TAG "BOOT"
+
+#include "log.h"
+
+typedef struct {
+  uint32_t start_ms; // HAL tick + 1 (0: 시작 안 함)
+  uint32_t end_ms;
+} boot_stage_time_t;
+
+static const boot_stage_t *bs_stage;
+static uint8_t bs_cnt;
+static boot_stage_time_t bs_time[BOOT_STAGE_MAX];
+static volatile uint32_t bs_done;
+static TaskHandle_t bs_waiter;
+
+static void bs_finish(uint8_t idx) {
+  bs_time[idx].end_ms = HAL_GetTick() + 1;
+
+  taskENTER_CRITICAL();
+  bs_done |= BOOT_STAGE_DEP(idx);
+  taskEXIT_CRITICAL();
+}
+
+static void bs_exec(uint8_t idx) {
+  bs_time[idx].start_ms = HAL_GetTick() + 1;
+  bs_stage[idx].fn();
+  bs_finish(idx);
+}
+
+static void bs_task(void *arg) {
+  bs_exec((uint8_t)(uintptr_t)arg);
+  xTaskNotifyGive(bs_waiter);
+  vTaskDelete(NULL);
+}
+
+void boot_stage_run(const boot_stage_t *stage, uint8_t cnt) {
+  uint32_t all;
+  uint32_t started = 0;
+
+  if (cnt > BOOT_STAGE_MAX) {
+    LOG_ERR("too many boot stages (%u)", cnt);
+    cnt = BOOT_STAGE_MAX;
+  }
+  all = (1UL << cnt) - 1U;
+
+  bs_stage = stage;
+  bs_cnt = cnt;
+  bs_done = 0;
+  bs_waiter = xTaskGetCurrentTaskHandle();
+
+  // 안 쓰는 단계는 바로 완료 (의존하는 쪽이 기다리지 않게)
+  for (uint8_t i = 0; i < cnt; i++) {
+    if (stage[i].fn == NULL) {
+      started |= BOOT_STAGE_DEP(i);
+      bs_done |= BOOT_STAGE_DEP(i);
+    }
+  }
+
+  while (bs_done != all) {
+    for (uint8_t i = 0; i < cnt; i++) {
+      if ((started & BOOT_STAGE_DEP(i)) || (stage[i].deps & ~bs_done & all)) {
+        continue;
+      }
+
+      started |= BOOT_STAGE_DEP(i);
+      if (HEAP_TRACK(HEAP_TAG_TASK,
+                     xTaskCreate(bs_task, stage[i].name, stage[i].stack_words,
+                                 (void *)(uintptr_t)i, uxTaskPriorityGet(NULL),
+                                 NULL)) != pdPASS) {
+        // 태스크를 못 만들면 여기서 순서대로
+        LOG_WARN("stage %s: task create failed, running inline", stage[i].name);
+        bs_exec(i);
+        xTaskNotifyGive(bs_waiter);
+      }
+    }
+
+    ulTaskNotifyTake(pdFALSE, portMAX_DELAY);
+  }
+
+  for (uint8_t i = 0; i < cnt; i++) {
+    if (bs_time[i].start_ms != 0) {
+      LOG_INFO("stage %s: %lu ms (start %lu)", stage[i].name,
+               (unsigned long)(bs_time[i].end_ms - bs_time[i].start_ms),
+               (unsigned long)(bs_time[i].start_ms - 1));
+    }
+  }
+}
+
+size_t boot_stage_format(char *buf, size_t size) {
+  size_t pos = 0;
+
+  for (uint8_t i = 0; i < bs_cnt; i++) {
+    boot_stage_time_t t = bs_time[i];
+    int n;
+
+    if (t.start_ms == 0) {
+      continue;
+    }
+
+    if (t.end_ms != 0) {
+      n = snprintf(&buf[pos], size - pos, "+STAGE,%s,%lu,%lu\n\r", bs_stage[i].name,
+                   (unsigned long)(t.start_ms - 1),
+                   (unsigned long)(t.end_ms - t.start_ms));
+    } else {
+      n = snprintf(&buf[pos], size - pos, "+STAGE,%s,%lu,-\n\r", bs_stage[i].name,
+                   (unsigned long)(t.start_ms - 1));
+    }
+    if (n < 0 || (size_t)n >= size - pos) {
+      return 0;
+    }
+    pos += n;
+  }
+
+  return pos;
+}
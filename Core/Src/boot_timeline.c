@@ -0,0 +1,92 @@
+#include "boot_timeline.h"
+#include "mem_section.h"
+#include "stm32f4xx_hal.h"
+#include <stdio.h>
+#include <string.h>
+
+#define BOOT_TIMELINE_MAGIC 0x42544C31 // "BTL1"
+
+typedef struct {
+  uint32_t magic;
+  uint32_t boot_count;
+  uint32_t ms[BOOT_MARK_COUNT]; // 리셋 후 ms + 1 (0: 도달 안 함)
+} boot_record_t;
+
+// 리셋해도 지워지지 않게 (startup 이 건드리지 않는 영역)
+static boot_record_t boot_cur CCM_NOINIT;
+static boot_record_t boot_prev CCM_NOINIT;
+
+static const char *const boot_mark_names[BOOT_MARK_COUNT] = {
+    [BOOT_MARK_INIT_THREAD] = "init_thread",
+    [BOOT_MARK_PARAMS] = "params",
+    [BOOT_MARK_GPS_INIT] = "gps_init",
+    [BOOT_MARK_LORA_INIT] = "lora_init",
+    [BOOT_MARK_RS485_INIT] = "rs485_init",
+    [BOOT_MARK_BLE_INIT] = "ble_init",
+    [BOOT_MARK_GPS_BAUD] = "gps_baud",
+    [BOOT_MARK_GPS_CONFIG] = "gps_config",
+    [BOOT_MARK_LTE_REG] = "lte_reg",
+    [BOOT_MARK_NTRIP] = "ntrip",
+    [BOOT_MARK_RTCM_FWD] = "rtcm_fwd",
+    [BOOT_MARK_RTK_FLOAT] = "rtk_float",
+    [BOOT_MARK_RTK_FIX] = "rtk_fix",
+};
+
+void boot_timeline_init(void) {
+  uint32_t count = 0;
+
+  if (boot_cur.magic == BOOT_TIMELINE_MAGIC) {
+    boot_prev = boot_cur;
+    count = boot_cur.boot_count;
+  } else {
+    memset(&boot_prev, 0, sizeof(boot_prev));
+  }
+
+  memset(&boot_cur, 0, sizeof(boot_cur));
+  boot_cur.boot_count = count + 1;
+  boot_cur.magic = BOOT_TIMELINE_MAGIC;
+}
+
+void boot_timeline_mark(boot_mark_t mark) {
+  uint32_t expected = 0;
+
+  if (mark >= BOOT_MARK_COUNT ||
+      __atomic_load_n(&boot_cur.ms[mark], __ATOMIC_RELAXED) != 0) {
+    return;
+  }
+
+  // 여러 태스크가 같은 단계를 동시에 표시해도 처음 것만
+  __atomic_compare_exchange_n(&boot_cur.ms[mark], &expected, HAL_GetTick() + 1,
+                              false, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+}
+
+size_t boot_timeline_format(char *buf, size_t size, bool prev) {
+  boot_record_t rec = prev ? boot_prev : boot_cur;
+  size_t pos;
+  int n;
+
+  if (rec.magic != BOOT_TIMELINE_MAGIC) {
+    return 0;
+  }
+
+  n = snprintf(buf, size, "+BOOT,n=%lu\n\r", (unsigned long)rec.boot_count);
+  if (n < 0 || (size_t)n >= size) {
+    return 0;
+  }
+  pos = n;
+
+  for (int i = 0; i < BOOT_MARK_COUNT; i++) {
+    if (rec.ms[i] != 0) {
+      n = snprintf(&buf[pos], size - pos, "+BOOT,%s,%lu\n\r", boot_mark_names[i],
+                   (unsigned long)(rec.ms[i] - 1));
+    } else {
+      n = snprintf(&buf[pos], size - pos, "+BOOT,%s,-\n\r", boot_mark_names[i]);
+    }
+    if (n < 0 || (size_t)n >= size - pos) {
+      return 0;
+    }
+    pos += n;
+  }
+
+  return pos;
+}
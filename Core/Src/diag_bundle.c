@@ -0,0 +1,280 @@
+#include "diag_bundle.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "board_config.h"
+#include "crc.h"
+#include "flash_params.h"
+#include "gps_app.h"
+#include "lora_stats.h"
+#include "mem_section.h"
+#include "mem_watermark.h"
+#include "ntrip_monitor.h"
+#include "pm_trace.h"
+#include "rtcm_router.h"
+#include "rtos_stats.h"
+#include "stm32f4xx_ll_utils.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+#define DIAG_HDR_LEN 36
+#define DIAG_SEC_HDR_LEN 4
+#define DIAG_CRC_LEN 2
+
+typedef struct __attribute__((packed)) {
+  uint32_t magic;
+  uint8_t version;
+  uint8_t sections;
+  uint16_t len;
+  uint32_t uid[3];
+  uint32_t uptime_ms;
+  uint32_t boot;
+  uint8_t reset;
+  uint8_t reserved[3];
+  uint32_t cfg_hash;
+} diag_hdr_t;
+
+_Static_assert(sizeof(diag_hdr_t) == DIAG_HDR_LEN, "diag_hdr_t 36 byte");
+
+CCM_BSS static uint8_t dg_buf[DIAG_BUNDLE_SIZE];
+static volatile uint16_t dg_len; // 0: 없음 또는 만드는 중
+static bool dg_busy;
+
+// 만드는 중에만 씀 (dg_busy 를 잡은 태스크 하나)
+static size_t dg_pos;
+static uint8_t dg_sections;
+
+/**
+ * @brief 다음 section 본문 자리와 남은 크기 (CRC 자리는 남김)
+ */
+static uint8_t *dg_room(size_t *size) {
+  size_t used = dg_pos + DIAG_SEC_HDR_LEN + DIAG_CRC_LEN;
+
+  *size = used < DIAG_BUNDLE_SIZE ? DIAG_BUNDLE_SIZE - used : 0;
+  return &dg_buf[dg_pos + DIAG_SEC_HDR_LEN];
+}
+
+/**
+ * @brief dg_room() 에 쓴 본문을 section 으로 (len 0 이면 뺌)
+ */
+static void dg_commit(uint8_t type, size_t len) {
+  uint8_t *h = &dg_buf[dg_pos];
+
+  if (len == 0) {
+    return;
+  }
+  h[0] = type;
+  h[1] = 0;
+  h[2] = (uint8_t)len;
+  h[3] = (uint8_t)(len >> 8);
+  dg_pos += DIAG_SEC_HDR_LEN + len;
+  dg_sections++;
+}
+
+/**
+ * @brief 구조체 하나짜리 section, 앞에 id(1) 0(3) 을 붙이면 여러 개를 이어 씀
+ */
+static size_t dg_put(uint8_t *body, size_t room, size_t pos, int id, const void *src,
+                     size_t len) {
+  size_t need = (id >= 0 ? 4 : 0) + len;
+
+  if (pos + need > room) {
+    return pos;
+  }
+  if (id >= 0) {
+    body[pos] = (uint8_t)id;
+    memset(&body[pos + 1], 0, 3);
+    pos += 4;
+  }
+  memcpy(&body[pos], src, len);
+
+  return pos + len;
+}
+
+static void dg_sec_heap(void) {
+  HeapStats_t hs;
+  uint32_t v[5];
+  size_t room;
+  uint8_t *body = dg_room(&room);
+
+  vPortGetHeapStats(&hs);
+  v[0] = hs.xAvailableHeapSpaceInBytes;
+  v[1] = hs.xMinimumEverFreeBytesRemaining;
+  v[2] = hs.xSizeOfLargestFreeBlockInBytes;
+  v[3] = hs.xNumberOfSuccessfulAllocations;
+  v[4] = hs.xNumberOfSuccessfulFrees;
+  dg_commit(DIAG_SEC_HEAP, dg_put(body, room, 0, -1, v, sizeof(v)));
+}
+
+static void dg_sec_gps(void) {
+  gps_stats_t st;
+  size_t room, pos = 0;
+  uint8_t *body = dg_room(&room);
+
+  for (int id = 0; id < GPS_ID_MAX; id++) {
+    gps_t *gps = gps_get_instance_handle((gps_id_t)id);
+
+    if (!gps) {
+      continue;
+    }
+    gps_get_stats(gps, &st);
+    pos = dg_put(body, room, pos, id, &st, sizeof(st));
+  }
+  dg_commit(DIAG_SEC_GPS, pos);
+}
+
+static void dg_sec_rtcm(void) {
+  rtcm_router_stats_t st;
+  size_t room, pos = 0;
+  uint8_t *body = dg_room(&room);
+
+  for (int src = 0; src < RTCM_SRC_MAX; src++) {
+    if (rtcm_router_get_stats((rtcm_src_t)src, &st)) {
+      pos = dg_put(body, room, pos, src, &st, sizeof(st));
+    }
+  }
+  dg_commit(DIAG_SEC_RTCM, pos);
+}
+
+static void dg_sec_links(void) {
+  static lora_stats_t ls; // 스택을 아끼려고 (만드는 태스크는 하나)
+  static ntrip_mon_stats_t nm;
+  size_t room;
+  uint8_t *body;
+
+  lora_stats_get(&ls);
+  body = dg_room(&room);
+  dg_commit(DIAG_SEC_LORA, dg_put(body, room, 0, -1, &ls, sizeof(ls)));
+
+  ntrip_mon_get(&nm);
+  body = dg_room(&room);
+  dg_commit(DIAG_SEC_NTRIP, dg_put(body, room, 0, -1, &nm, sizeof(nm)));
+}
+
+/**
+ * @brief pm_trace 최근 max 개 (오래된 것부터)
+ */
+static void dg_sec_trace(bool prev, uint16_t max) {
+  uint32_t boot;
+  uint8_t reset;
+  uint16_t cnt = pm_trace_info(prev, &boot, &reset);
+  uint16_t first = cnt > max ? cnt - max : 0;
+  pm_trace_rec_t rec;
+  size_t room, pos = 8;
+  uint8_t *body = dg_room(&room);
+
+  if (cnt == 0 || room < 8 + sizeof(pm_trace_rec_t)) {
+    return;
+  }
+  if ((size_t)(cnt - first) > (room - 8) / sizeof(pm_trace_rec_t)) {
+    first = (uint16_t)(cnt - (room - 8) / sizeof(pm_trace_rec_t));
+  }
+
+  memcpy(&body[0], &boot, 4);
+  body[4] = reset;
+  memset(&body[5], 0, 3);
+  // 본문 자리가 4 byte 정렬이 아닐 수 있어 하나씩 복사
+  for (uint16_t i = first; i < cnt && pm_trace_read(prev, i, &rec, 1) == 1; i++) {
+    memcpy(&body[pos], &rec, sizeof(rec));
+    pos += sizeof(rec);
+  }
+  dg_commit(prev ? DIAG_SEC_TRACE : DIAG_SEC_TRACE_CUR, pos);
+}
+
+static void dg_sec_params(void) {
+  const user_params_t *snap = flash_params_snapshot(NULL);
+  size_t room;
+  uint8_t *body = dg_room(&room);
+
+  if (room < sizeof(user_params_t)) {
+    return;
+  }
+  memcpy(body, snap, sizeof(user_params_t));
+  memset(&body[offsetof(user_params_t, ntrip_pw)], 0, sizeof(snap->ntrip_pw));
+  memset(&body[offsetof(user_params_t, ntrip_srv_pw)], 0, sizeof(snap->ntrip_srv_pw));
+  dg_commit(DIAG_SEC_PARAMS, sizeof(user_params_t));
+}
+
+/**
+ * @brief 설정 hash (주기적으로 저장되는 사용량은 빼서 같은 설정이면 같은 값)
+ */
+static uint32_t dg_cfg_hash(void) {
+  const user_params_t *p = flash_params_snapshot(NULL);
+
+  return crc32_update(0, (const uint8_t *)p, offsetof(user_params_t, lte_usage));
+}
+
+size_t diag_bundle_build(uint16_t *crc) {
+  diag_hdr_t hdr = {0};
+  uint8_t reset = 0, unused;
+  uint32_t boot = 0;
+  size_t room;
+  uint16_t c;
+
+  taskENTER_CRITICAL();
+  if (dg_busy) {
+    taskEXIT_CRITICAL();
+    return 0;
+  }
+  dg_busy = true;
+  dg_len = 0;
+  taskEXIT_CRITICAL();
+
+  dg_pos = DIAG_HDR_LEN;
+  dg_sections = 0;
+
+  dg_commit(DIAG_SEC_TASK, rtos_stats_pack(dg_room(&room), room));
+  dg_sec_heap();
+  dg_commit(DIAG_SEC_WM, mem_wm_pack(dg_room(&room), room));
+  dg_sec_gps();
+  dg_sec_rtcm();
+  dg_sec_links();
+  dg_sec_trace(true, DIAG_TRACE_PREV_MAX);
+  dg_sec_trace(false, DIAG_TRACE_CUR_MAX);
+  dg_sec_params();
+
+  // 리셋 원인은 이번 부팅이 읽은 값이라 리셋 전 부팅 쪽으로 받음
+  pm_trace_info(true, &boot, &reset);
+  pm_trace_info(false, &boot, &unused);
+  hdr.magic = DIAG_BUNDLE_MAGIC;
+  hdr.version = DIAG_BUNDLE_VERSION;
+  hdr.sections = dg_sections;
+  hdr.len = (uint16_t)(dg_pos + DIAG_CRC_LEN);
+  hdr.uid[0] = LL_GetUID_Word0();
+  hdr.uid[1] = LL_GetUID_Word1();
+  hdr.uid[2] = LL_GetUID_Word2();
+  hdr.uptime_ms = (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS);
+  hdr.boot = boot;
+  hdr.reset = reset;
+  hdr.cfg_hash = dg_cfg_hash();
+  memcpy(dg_buf, &hdr, sizeof(hdr));
+
+  c = crc16_ccitt_update(0xFFFF, dg_buf, dg_pos);
+  dg_buf[dg_pos] = (uint8_t)c;
+  dg_buf[dg_pos + 1] = (uint8_t)(c >> 8);
+  if (crc) {
+    *crc = c;
+  }
+
+  taskENTER_CRITICAL();
+  dg_len = hdr.len;
+  dg_busy = false;
+  taskEXIT_CRITICAL();
+
+  return hdr.len;
+}
+
+size_t diag_bundle_len(void) { return dg_len; }
+
+size_t diag_bundle_read(size_t off, uint8_t *dst, size_t len) {
+  size_t n = 0;
+
+  taskENTER_CRITICAL();
+  if (off < dg_len) {
+    n = dg_len - off < len ? dg_len - off : len;
+    memcpy(dst, &dg_buf[off], n);
+  }
+  taskEXIT_CRITICAL();
+
+  return n;
+}
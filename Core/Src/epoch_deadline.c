@@ -0,0 +1,205 @@
+#include "epoch_deadline.h"
+#include "FreeRTOS.h"
+#include "mem_section.h"
+#include "stm32f4xx.h"
+#include "task.h"
+#include <stdio.h>
+#include <string.h>
+
+/* 히스토그램: 0~3 us 는 1 us 칸, 그 위는 2 배 구간마다 4 칸 (약 115 ms 넘으면 마지막 칸) */
+#define EPOCH_DL_BINS 64
+
+typedef struct {
+  uint32_t n;
+  uint32_t miss; // DEADLINE 초과 또는 시각 기록이 덮임
+  uint32_t skip; // 받지 못한 epoch (every 소비자만)
+  uint32_t min_us;
+  uint32_t max_us;
+  uint64_t sum_us;
+  uint32_t hist[EPOCH_DL_BINS];
+} epoch_dl_stat_t;
+
+typedef struct {
+  const char *name;
+  bool every;
+  bool seen;     // last 유효
+  uint16_t last; // 마지막으로 마친 순번
+} epoch_dl_consumer_t;
+
+typedef struct {
+  uint16_t seq;
+  uint32_t cyc;
+} epoch_dl_stamp_t;
+
+static epoch_dl_consumer_t dl_consumers[EPOCH_DL_CONSUMER_MAX];
+static uint8_t dl_consumer_cnt;
+static epoch_dl_stamp_t dl_stamps[EPOCH_DL_RING];
+static volatile uint16_t dl_seq;
+/* DMA 와 무관하고 히스토그램이 커서 CCM */
+CCM_BSS static epoch_dl_stat_t dl_stats[EPOCH_DL_CONSUMER_MAX];
+
+static uint32_t epoch_dl_bin(uint32_t us) {
+  if (us < 4) {
+    return us;
+  }
+
+  uint32_t msb = 31U - (uint32_t)__builtin_clz(us);
+  uint32_t bin = 4U * (msb - 1U) + ((us >> (msb - 2U)) & 3U);
+
+  return bin < EPOCH_DL_BINS ? bin : EPOCH_DL_BINS - 1U;
+}
+
+/**
+ * @brief 칸의 위쪽 경계 [us] (마지막 칸은 끝이 없어서 아래쪽 경계)
+ */
+static uint32_t epoch_dl_bin_upper(uint32_t bin) {
+  if (bin < 4) {
+    return bin;
+  }
+
+  uint32_t msb = bin / 4U + 1U;
+  uint32_t lower = (4U + bin % 4U) << (msb - 2U);
+
+  return bin == EPOCH_DL_BINS - 1U ? lower : lower + (1U << (msb - 2U)) - 1U;
+}
+
+uint16_t epoch_dl_begin(void) {
+  uint32_t cyc = DWT->CYCCNT;
+  uint16_t seq;
+
+  taskENTER_CRITICAL();
+  seq = (uint16_t)(dl_seq + 1U);
+  dl_stamps[seq & (EPOCH_DL_RING - 1)].seq = seq;
+  dl_stamps[seq & (EPOCH_DL_RING - 1)].cyc = cyc;
+  dl_seq = seq;
+  taskEXIT_CRITICAL();
+
+  return seq;
+}
+
+uint16_t epoch_dl_seq(void) { return dl_seq; }
+
+int epoch_dl_register(const char *name, bool every) {
+  int id = -1;
+
+  taskENTER_CRITICAL();
+  for (uint8_t i = 0; i < dl_consumer_cnt; i++) {
+    if (dl_consumers[i].name == name) {
+      id = i;
+    }
+  }
+  if (id < 0 && dl_consumer_cnt < EPOCH_DL_CONSUMER_MAX) {
+    id = dl_consumer_cnt++;
+    dl_consumers[id].name = name;
+    dl_consumers[id].every = every;
+  }
+  taskEXIT_CRITICAL();
+
+  return id;
+}
+
+void epoch_dl_done(int id, uint16_t seq) {
+  uint32_t now = DWT->CYCCNT;
+
+  if (id < 0 || id >= dl_consumer_cnt) {
+    return;
+  }
+
+  epoch_dl_consumer_t *c = &dl_consumers[id];
+  epoch_dl_stat_t *st = &dl_stats[id];
+  const epoch_dl_stamp_t *s = &dl_stamps[seq & (EPOCH_DL_RING - 1)];
+
+  taskENTER_CRITICAL();
+  if (c->every && c->seen) {
+    uint16_t gap = (uint16_t)(seq - c->last);
+
+    // 0 이나 되돌아간 순번 (같은 epoch 두 번) 은 빼고
+    if (gap > 1U && gap < 0x8000U) {
+      st->skip += gap - 1U;
+    }
+  }
+  c->last = seq;
+  c->seen = true;
+
+  if (s->seq != seq) {
+    st->miss++;
+    taskEXIT_CRITICAL();
+    return;
+  }
+
+  uint32_t us = (uint32_t)((uint64_t)(now - s->cyc) * 1000000U / SystemCoreClock);
+
+  if (us > EPOCH_DL_DEADLINE_MS * 1000U) {
+    st->miss++;
+  }
+  if (st->n == 0 || us < st->min_us) {
+    st->min_us = us;
+  }
+  if (us > st->max_us) {
+    st->max_us = us;
+  }
+  st->n++;
+  st->sum_us += us;
+  st->hist[epoch_dl_bin(us)]++;
+  taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief n x pct / 100 번째 (올림) 표본이 들어 있는 칸의 위쪽 경계
+ */
+static uint32_t epoch_dl_pct(const epoch_dl_stat_t *st, uint32_t pct) {
+  uint32_t rank = st->n - (st->n * (100U - pct)) / 100U;
+  uint32_t acc = 0;
+
+  for (uint32_t i = 0; i < EPOCH_DL_BINS; i++) {
+    acc += st->hist[i];
+    if (acc >= rank) {
+      uint32_t upper = epoch_dl_bin_upper(i);
+      // 칸 경계가 실제 최대보다 클 수 있음
+      return upper < st->max_us ? upper : st->max_us;
+    }
+  }
+  return st->max_us;
+}
+
+size_t epoch_dl_format(char *buf, size_t size) {
+  static epoch_dl_stat_t st; // 히스토그램이 커서 호출 태스크 스택 대신
+  size_t pos = 0;
+
+  for (uint8_t i = 0; i < dl_consumer_cnt; i++) {
+    taskENTER_CRITICAL();
+    st = dl_stats[i];
+    taskEXIT_CRITICAL();
+
+    if (st.n == 0 && st.miss == 0) {
+      continue;
+    }
+
+    int n = snprintf(&buf[pos], size - pos,
+                     "+EPDL,%s,n=%lu,miss=%lu,skip=%lu,min=%lu,avg=%lu,p50=%lu,p99=%lu,max=%lu\n\r",
+                     dl_consumers[i].name, (unsigned long)st.n, (unsigned long)st.miss,
+                     (unsigned long)st.skip, (unsigned long)st.min_us,
+                     (unsigned long)(st.n ? st.sum_us / st.n : 0),
+                     (unsigned long)epoch_dl_pct(&st, 50), (unsigned long)epoch_dl_pct(&st, 99),
+                     (unsigned long)st.max_us);
+    if (n < 0 || (size_t)n >= size - pos) {
+      return 0;
+    }
+    pos += (size_t)n;
+  }
+
+  if (pos == 0) {
+    int n = snprintf(buf, size, "+EPDL,none\n\r");
+    return (n < 0 || (size_t)n >= size) ? 0 : (size_t)n;
+  }
+  return pos;
+}
+
+void epoch_dl_reset(void) {
+  taskENTER_CRITICAL();
+  memset(dl_stats, 0, sizeof(dl_stats));
+  for (uint8_t i = 0; i < dl_consumer_cnt; i++) {
+    dl_consumers[i].seen = false;
+  }
+  taskEXIT_CRITICAL();
+}
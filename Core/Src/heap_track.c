@@ -0,0 +1,133 @@
+#include "heap_track.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdio.h>
+
+/* 동시에 살아 있는 heap 블록 수 (넘으면 untracked 로만 셈) */
+#define HEAP_TRACK_SLOTS 96
+
+typedef struct {
+  void *ptr;
+  uint16_t size; // 56KB heap 이라 16bit 로 충분
+  uint8_t tag;
+} heap_track_slot_t;
+
+typedef struct {
+  uint32_t cur;
+  uint32_t peak;
+  uint16_t count;
+  uint16_t fail;
+} heap_tag_stat_t;
+
+static heap_track_slot_t heap_slots[HEAP_TRACK_SLOTS];
+static heap_tag_stat_t heap_stats[HEAP_TAG_COUNT];
+static uint32_t heap_untracked;
+static heap_tag_t heap_cur_tag = HEAP_TAG_OTHER;
+
+static const char *const heap_tag_names[HEAP_TAG_COUNT] = {
+    [HEAP_TAG_OTHER] = "other",       [HEAP_TAG_TASK] = "task",
+    [HEAP_TAG_CMD_SEM] = "cmd_sem",   [HEAP_TAG_SOCKET] = "socket",
+    [HEAP_TAG_STATS] = "stats",
+};
+
+heap_tag_t heap_track_enter(heap_tag_t tag) {
+  heap_tag_t prev;
+
+  vTaskSuspendAll();
+  prev = heap_cur_tag;
+  heap_cur_tag = tag < HEAP_TAG_COUNT ? tag : HEAP_TAG_OTHER;
+  return prev;
+}
+
+void heap_track_exit(heap_tag_t prev) {
+  heap_cur_tag = prev;
+  (void)xTaskResumeAll();
+}
+
+void heap_track_on_malloc(void *ptr, size_t size) {
+  heap_tag_stat_t *st = &heap_stats[heap_cur_tag];
+
+  if (!ptr) {
+    st->fail++;
+    return;
+  }
+
+  for (int i = 0; i < HEAP_TRACK_SLOTS; i++) {
+    if (heap_slots[i].ptr == NULL) {
+      heap_slots[i].ptr = ptr;
+      heap_slots[i].size = (uint16_t)size;
+      heap_slots[i].tag = (uint8_t)heap_cur_tag;
+
+      st->cur += size;
+      st->count++;
+      if (st->cur > st->peak) {
+        st->peak = st->cur;
+      }
+      return;
+    }
+  }
+
+  heap_untracked++;
+}
+
+void heap_track_on_free(void *ptr) {
+  for (int i = 0; i < HEAP_TRACK_SLOTS; i++) {
+    if (heap_slots[i].ptr == ptr) {
+      heap_tag_stat_t *st = &heap_stats[heap_slots[i].tag];
+
+      st->cur -= heap_slots[i].size;
+      st->count--;
+      heap_slots[i].ptr = NULL;
+      return;
+    }
+  }
+
+  if (heap_untracked > 0) {
+    heap_untracked--;
+  }
+}
+
+void heap_track_reset_peak(void) {
+  vTaskSuspendAll();
+  for (int i = 0; i < HEAP_TAG_COUNT; i++) {
+    heap_stats[i].peak = heap_stats[i].cur;
+    heap_stats[i].fail = 0;
+  }
+  (void)xTaskResumeAll();
+}
+
+size_t heap_track_format(char *buf, size_t size) {
+  heap_tag_stat_t st[HEAP_TAG_COUNT];
+  uint32_t untracked;
+  size_t pos = 0;
+  int n;
+
+  vTaskSuspendAll();
+  for (int i = 0; i < HEAP_TAG_COUNT; i++) {
+    st[i] = heap_stats[i];
+  }
+  untracked = heap_untracked;
+  (void)xTaskResumeAll();
+
+  for (int i = 0; i < HEAP_TAG_COUNT; i++) {
+    n = snprintf(&buf[pos], size - pos, "+HEAPTAG,%s,cur=%lu,peak=%lu,n=%u,fail=%u\n\r",
+                 heap_tag_names[i], (unsigned long)st[i].cur,
+                 (unsigned long)st[i].peak, (unsigned)st[i].count,
+                 (unsigned)st[i].fail);
+    if (n < 0 || (size_t)n >= size - pos) {
+      return 0;
+    }
+    pos += n;
+  }
+
+  n = snprintf(&buf[pos], size - pos, "+HEAP,total=%lu,free=%lu,min=%lu,untracked=%lu\n\r",
+               (unsigned long)configTOTAL_HEAP_SIZE,
+               (unsigned long)xPortGetFreeHeapSize(),
+               (unsigned long)xPortGetMinimumEverFreeHeapSize(),
+               (unsigned long)untracked);
+  if (n < 0 || (size_t)n >= size - pos) {
+    return 0;
+  }
+
+  return pos + n;
+}
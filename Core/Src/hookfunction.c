@@ -1,6 +1,8 @@
 #include "FreeRTOS.h"
 #include "semphr.h"
 #include "task.h"
+#include "stm32f4xx.h"
+#include "pm_trace.h"
 /*********************************************************************
  *
  *       vApplicationMallocFailedHook
@@ -16,9 +18,13 @@
  */
 
 void vApplicationMallocFailedHook(void) {
-  taskDISABLE_INTERRUPTS();
-  for (;;)
-    ;
+  size_t free_bytes = xPortGetFreeHeapSize();
+
+  // 멈추지 않음: 실패는 heap_track 이 태그별 fail 로 세고 (AT+HEAP?),
+  // 호출자는 NULL 을 확인해서 그 명령/연결만 포기한다.
+  // 이어서 리셋되면 pm_trace 에 남은 것으로 어느 태스크였는지 본다.
+  pm_trace(PM_EVT_MALLOC_FAIL, free_bytes > 0xFFFF ? 0xFFFF : (uint16_t)free_bytes,
+           (uint32_t)xTaskGetCurrentTaskHandle());
 }
 
 /*********************************************************************
@@ -32,7 +38,7 @@ void vApplicationMallocFailedHook(void) {
  */
 void vApplicationStackOverflowHook(TaskHandle_t xTask, char *pcTaskName) {
   (void)pcTaskName;
-  (void)xTask;
+  pm_trace(PM_EVT_STACK_OVF, 0, (uint32_t)xTask);
   taskDISABLE_INTERRUPTS();
   for (;;)
     ;
@@ -44,24 +50,13 @@ void vApplicationStackOverflowHook(TaskHandle_t xTask, char *pcTaskName) {
  *
  *  Function description
  *    This function is called on each cycle of the idle task.
- *    In this case it does nothing useful, other than report
- *    the amount of FreeRTOS heap that remains unallocated.
+ *    It does nothing; heap headroom is reported by heap_track.
  *
  */
 
 void vApplicationIdleHook(void) {
-#if configSUPPORT_DYNAMIC_ALLOCATION == 1
-  volatile size_t xFreeHeapSpace;
-
-  xFreeHeapSpace = xPortGetFreeHeapSize();
-  if (xFreeHeapSpace > 100) {
-    //
-    // By now, the kernel has allocated everything it is going to, so
-    // if there is a lot of heap remaining unallocated then
-    // the value of configTOTAL_HEAP_SIZE in FreeRTOSConfig.h can be
-    // reduced accordingly.
-  }
-#endif
+  // heap 여유는 heap_track_format() 의 min= (xPortGetMinimumEverFreeHeapSize)
+  // 로 확인한다. configTOTAL_HEAP_SIZE 는 그 값을 보고 줄인다.
 }
 
 /*********************************************************************
@@ -69,23 +64,45 @@ void vApplicationIdleHook(void) {
  *       vMainConfigureTimerForRunTimeStats
  *
  *  Function description
- *    The Blinky build configuration does not include run time
- *    stats gathering, however, the Full and Blinky build configurations
- *    share a FreeRTOSConfig.h file.
- *    Therefore, dummy run time stats functions need to be defined
- *    to keep the linker happy.
+ *    Run time stats use the DWT cycle counter (one count per core
+ *    clock). vTaskStartScheduler() calls this once; CYCCNT keeps
+ *    running from there and is never reset afterwards.
  *
  */
 
-void vMainConfigureTimerForRunTimeStats(void) {}
+static uint32_t run_time_last;
+static uint64_t run_time_high;
+
+void vMainConfigureTimerForRunTimeStats(void) {
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+  run_time_last = 0;
+  run_time_high = 0;
+}
 
 /*********************************************************************
  *
  *       ulMainGetRunTimeCounterValue
  *
+ *  Function description
+ *    Extends the 32-bit CYCCNT (wraps every ~25 s at 168 MHz) to 64 bits.
+ *    The kernel only reads it on context switch and in
+ *    uxTaskGetSystemState() with the scheduler suspended, so calls never
+ *    overlap, and a context switch happens well within one wrap period.
+ *
  */
 
-unsigned long ulMainGetRunTimeCounterValue(void) { return 0UL; }
+uint64_t ulMainGetRunTimeCounterValue(void) {
+  uint32_t now = DWT->CYCCNT;
+
+  if (now < run_time_last) {
+    run_time_high += 1ULL << 32;
+  }
+  run_time_last = now;
+
+  return run_time_high | now;
+}
 
 /*********************************************************************
  *
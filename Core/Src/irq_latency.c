@@ -0,0 +1,148 @@
+#include "irq_latency.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdio.h>
+#include <string.h>
+
+#if defined(USE_IRQ_LATENCY)
+
+/* 히스토그램: 0~3 us 는 1 us 칸, 그 위는 2 배 구간마다 4 칸 (약 115 ms 넘으면 마지막 칸) */
+#define IRQ_LAT_BINS 64
+
+typedef struct {
+  uint32_t n;
+  uint32_t min_us;
+  uint32_t max_us;
+  uint64_t sum_us;
+  uint32_t hist[IRQ_LAT_BINS];
+} irq_lat_stat_t;
+
+static const char *const irq_lat_names[IRQ_LAT_PORT_CNT] = {
+    [IRQ_LAT_GPS1] = "gps1", [IRQ_LAT_GPS2] = "gps2", [IRQ_LAT_GSM] = "gsm",
+    [IRQ_LAT_LORA] = "lora", [IRQ_LAT_UART5] = "uart5",
+};
+
+irq_lat_stamp_t irq_lat_stamps[IRQ_LAT_PORT_CNT];
+static irq_lat_stat_t irq_lat_stats[IRQ_LAT_PORT_CNT];
+
+static uint32_t irq_lat_bin(uint32_t us) {
+  if (us < 4) {
+    return us;
+  }
+
+  uint32_t msb = 31U - (uint32_t)__builtin_clz(us);
+  uint32_t bin = 4U * (msb - 1U) + ((us >> (msb - 2U)) & 3U);
+
+  return bin < IRQ_LAT_BINS ? bin : IRQ_LAT_BINS - 1U;
+}
+
+/**
+ * @brief 칸의 위쪽 경계 [us] (마지막 칸은 끝이 없어서 아래쪽 경계)
+ */
+static uint32_t irq_lat_bin_upper(uint32_t bin) {
+  if (bin < 4) {
+    return bin;
+  }
+
+  uint32_t msb = bin / 4U + 1U;
+  uint32_t lower = (4U + bin % 4U) << (msb - 2U);
+
+  return bin == IRQ_LAT_BINS - 1U ? lower : lower + (1U << (msb - 2U)) - 1U;
+}
+
+void irq_lat_task(irq_lat_port_t port) {
+  irq_lat_stamp_t *s = &irq_lat_stamps[port];
+
+  if (!s->pending) {
+    return;
+  }
+
+  uint32_t cyc = DWT->CYCCNT - s->cyc;
+  s->pending = false;
+
+  uint32_t us = (uint32_t)((uint64_t)cyc * 1000000U / SystemCoreClock);
+  irq_lat_stat_t *st = &irq_lat_stats[port];
+
+  taskENTER_CRITICAL();
+  if (st->n == 0 || us < st->min_us) {
+    st->min_us = us;
+  }
+  if (us > st->max_us) {
+    st->max_us = us;
+  }
+  st->n++;
+  st->sum_us += us;
+  st->hist[irq_lat_bin(us)]++;
+  taskEXIT_CRITICAL();
+}
+
+static uint32_t irq_lat_p99(const irq_lat_stat_t *st) {
+  // n - n/100 번째 (올림) 표본이 들어 있는 칸
+  uint32_t rank = st->n - st->n / 100U;
+  uint32_t acc = 0;
+
+  for (uint32_t i = 0; i < IRQ_LAT_BINS; i++) {
+    acc += st->hist[i];
+    if (acc >= rank) {
+      return irq_lat_bin_upper(i);
+    }
+  }
+  return st->max_us;
+}
+
+size_t irq_lat_format(char *buf, size_t size) {
+  static irq_lat_stat_t st; // 히스토그램이 커서 호출 태스크 스택 대신
+  size_t pos = 0;
+
+  for (uint32_t i = 0; i < IRQ_LAT_PORT_CNT; i++) {
+    taskENTER_CRITICAL();
+    st = irq_lat_stats[i];
+    taskEXIT_CRITICAL();
+
+    if (st.n == 0) {
+      continue;
+    }
+
+    uint32_t p99 = irq_lat_p99(&st);
+    // 칸 경계가 실제 최대보다 클 수 있음
+    if (p99 > st.max_us) {
+      p99 = st.max_us;
+    }
+
+    int n = snprintf(&buf[pos], size - pos, "+IRQLAT,%s,n=%lu,min=%lu,avg=%lu,p99=%lu,max=%lu\n\r",
+                     irq_lat_names[i], (unsigned long)st.n, (unsigned long)st.min_us,
+                     (unsigned long)(st.sum_us / st.n), (unsigned long)p99,
+                     (unsigned long)st.max_us);
+    if (n < 0 || (size_t)n >= size - pos) {
+      return 0;
+    }
+    pos += (size_t)n;
+  }
+
+  if (pos == 0) {
+    int n = snprintf(buf, size, "+IRQLAT,none\n\r");
+    return (n < 0 || (size_t)n >= size) ? 0 : (size_t)n;
+  }
+  return pos;
+}
+
+void irq_lat_reset(void) {
+  taskENTER_CRITICAL();
+  memset(irq_lat_stats, 0, sizeof(irq_lat_stats));
+  for (uint32_t i = 0; i < IRQ_LAT_PORT_CNT; i++) {
+    irq_lat_stamps[i].pending = false;
+  }
+  taskEXIT_CRITICAL();
+}
+
+#else
+
+size_t irq_lat_format(char *buf, size_t size) {
+  int n = snprintf(buf, size, "+IRQLAT,off\n\r");
+
+  return (n < 0 || (size_t)n >= size) ? 0 : (size_t)n;
+}
+
+void irq_lat_reset(void) {}
+
+#endif
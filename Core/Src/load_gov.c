@@ -0,0 +1,129 @@
+#include "load_gov.h"
+#include "gps_app.h"
+#include "gps_rate.h"
+#include "mem_watermark.h"
+#include "pm_trace.h"
+#include "pos_out.h"
+#include "rtcm_router.h"
+#include "rtos_stats.h"
+#include "work_queue.h"
+#include <stdbool.h>
+#include <stdio.h>
+
+#define TAG "LOAD_GOV"
+
+#include "log.h"
+
+static void load_gov_work(work_t *work);
+static work_t lg_work = WORK_INIT(load_gov_work, NULL, WORK_PRIO_LOW);
+
+static rtos_load_t lg_load;
+static uint32_t lg_log_dropped;
+static volatile uint8_t lg_level;
+static uint8_t lg_applied; // 동작이 켜진 단계 (bit: 단계)
+static uint8_t lg_hot, lg_calm;
+static volatile uint16_t lg_cpu;
+static volatile uint8_t lg_fill;
+static uint32_t lg_up, lg_down;
+
+static void load_gov_nav_rate(bool low) {
+  uint32_t hz = gps_rate_get_hz();
+  uint32_t want = low ? (hz > 1 ? hz / 2 : 1) : hz;
+
+  if (want == hz && low) {
+    return; // 1 Hz 는 더 낮추지 않음
+  }
+
+  for (int id = 0; id < GPS_ID_MAX; id++) {
+    gps_set_nav_rate_async((gps_id_t)id, want);
+  }
+}
+
+/**
+ * @brief level 까지의 동작은 켜고 그 위는 끔 (바뀐 것만)
+ */
+static void load_gov_apply(uint8_t level) {
+  for (uint8_t lv = LOAD_GOV_NO_DEBUG; lv < LOAD_GOV_LEVEL_COUNT; lv++) {
+    bool on = lv <= level;
+
+    if (on == !!(lg_applied & (1U << lv))) {
+      continue;
+    }
+    lg_applied ^= 1U << lv;
+
+    switch (lv) {
+    case LOAD_GOV_NO_DEBUG:
+      log_set_cap(on ? LOG_LEVEL_INFO : LOG_LEVEL_DEBUG);
+      break;
+    case LOAD_GOV_DECIM_OUT:
+      pos_out_set_shed(on ? LOAD_GOV_OUT_DECIM : 1);
+      break;
+    case LOAD_GOV_RTCM_ESSENTIAL:
+      rtcm_router_set_shed(on);
+      break;
+    case LOAD_GOV_NAV_RATE:
+      load_gov_nav_rate(on);
+      break;
+    default:
+      break;
+    }
+  }
+}
+
+static void load_gov_work(work_t *work) {
+  uint16_t cpu = rtos_stats_cpu_load(&lg_load);
+  uint8_t fill = mem_wm_take_fill();
+  uint32_t dropped = log_get_dropped();
+  bool hot = cpu >= LOAD_GOV_CPU_HIGH || fill >= LOAD_GOV_FILL_HIGH ||
+             dropped != lg_log_dropped;
+  bool calm = cpu < LOAD_GOV_CPU_LOW && fill < LOAD_GOV_FILL_LOW &&
+              dropped == lg_log_dropped;
+  uint8_t level = lg_level;
+
+  lg_cpu = cpu;
+  lg_fill = fill;
+  lg_log_dropped = dropped;
+
+  // 둘 다 아니면 (경계 사이) 세던 것을 그대로 둔다
+  if (hot) {
+    lg_calm = 0;
+    if (++lg_hot >= LOAD_GOV_UP_CNT && level + 1 < LOAD_GOV_LEVEL_COUNT) {
+      level++;
+      lg_up++;
+      lg_hot = 0;
+    }
+  } else if (calm) {
+    lg_hot = 0;
+    if (++lg_calm >= LOAD_GOV_DOWN_CNT && level > LOAD_GOV_NORMAL) {
+      level--;
+      lg_down++;
+      lg_calm = 0;
+    }
+  }
+
+  if (level != lg_level) {
+    LOG_WARN("level %u -> %u (cpu %u.%u%%, fill %u%%)", lg_level, level, cpu / 10,
+             cpu % 10, fill);
+    pm_trace(PM_EVT_LOAD_LEVEL, level, (uint32_t)cpu << 8 | fill);
+    lg_level = level;
+    load_gov_apply(level);
+  }
+
+  work_submit_delayed(work, LOAD_GOV_PERIOD_MS);
+}
+
+void load_gov_init(void) {
+  rtos_stats_cpu_load(&lg_load);
+  mem_wm_take_fill();
+  lg_log_dropped = log_get_dropped();
+  work_submit_delayed(&lg_work, LOAD_GOV_PERIOD_MS);
+}
+
+load_gov_level_t load_gov_get_level(void) { return (load_gov_level_t)lg_level; }
+
+size_t load_gov_format(char *buf, size_t size) {
+  int n = snprintf(buf, size, "+LG,lv=%u,cpu=%u,fill=%u,up=%lu,down=%lu\n\r", lg_level,
+                   lg_cpu, lg_fill, (unsigned long)lg_up, (unsigned long)lg_down);
+
+  return n < 0 || (size_t)n >= size ? 0 : (size_t)n;
+}
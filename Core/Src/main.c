@@ -34,15 +34,34 @@
 #include "gsm_app.h"
 #include "lora_app.h"
 #include "ble_app.h"
+#include "can_app.h"
+#include "usb_app.h"
+#include "sd_log.h"
 #include "led.h"
 #include "rtcm.h"
+#include "rtcm_router.h"
 #include "flash_params.h"
 #include "queue.h"
 #include "semphr.h"
 #include "task.h"
 #include "softuart.h"
 #include "rs485_app.h"
+#include "heap_track.h"
 #include "board_config.h"
+#include "app_events.h"
+#include "trace_marker.h"
+#include "boot_timeline.h"
+#include "pm_trace.h"
+#include "boot_stage.h"
+#include "dma_copy.h"
+#include "work_queue.h"
+#include "tmo_wheel.h"
+#include "tx_pool.h"
+#include "track_log.h"
+#include "gps_grid.h"
+#include "pos_out.h"
+#include "load_gov.h"
+#include "log.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -91,18 +110,67 @@ uint32_t uart_send(USART_TypeDef *handle, const char *buf, size_t len) {
   return len;
 }
 
-static void dwt_init(void) {
-    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
-    DWT->CYCCNT = 0;
-    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+enum {
+  INIT_STAGE_GPS = 0,
+  INIT_STAGE_LTE,
+  INIT_STAGE_LORA,
+  INIT_STAGE_RS485,
+  INIT_STAGE_BLE,
+  INIT_STAGE_CAN,
+  INIT_STAGE_USB,
+  INIT_STAGE_SD_LOG,
+  INIT_STAGE_CNT
+};
+
+static void init_stage_lte(void) {
+  gsm_task_create(NULL);
+}
+
+static void init_stage_lora(void) {
+  lora_instance_init();
+  boot_timeline_mark(BOOT_MARK_LORA_INIT);
+}
+
+static void init_stage_rs485(void) {
+#if USE_SOFTUART
+  rs485_app_init();
+#else
+  rs485_init_all();
+#endif
+  boot_timeline_mark(BOOT_MARK_RS485_INIT);
+}
+
+static void init_stage_ble(void) {
+  ble_init_all();
+  boot_timeline_mark(BOOT_MARK_BLE_INIT);
+}
+
+static void init_stage_can(void) {
+#if USE_CAN
+  can_app_init();
+#endif
+}
+
+static void init_stage_usb(void) {
+#if USE_USB
+  usb_app_init();
+#endif
 }
 
+static void init_stage_sd_log(void) {
+#if USE_SD_LOG
+  sd_log_init();
+#endif
+}
 
 void initThread(void *pvParameter) {
 	const board_config_t *config = board_get_config();
   user_params_t* params = flash_params_get_current();
 
+  boot_timeline_mark(BOOT_MARK_INIT_THREAD);
 	flash_params_init();
+  boot_timeline_mark(BOOT_MARK_PARAMS);
   //  flash_params_set_manual_position(true, "37.2901527", "127.033646955", "100.918");
 
 	//	flash_params_set_ntrip_url("www.gnssdata.or.kr");
@@ -123,35 +191,50 @@ void initThread(void *pvParameter) {
 	// flash_params_set_ntrip_id("nb030761");
 	// flash_params_set_ntrip_pw("ngii");
   
+  // 다른 모듈 로그보다 먼저 (그 전 로그는 링에 남아 있다가 나감)
+  log_init();
   led_init();
+  dma_copy_init();
+  work_queue_init();
+  tmo_wheel_init();
+  tx_pool_init();
+  rtcm_router_init();
+
+  // DWT 는 스케줄러 시작 때 run-time stats 용으로 켜짐 (hookfunction.c)
+  // 구독하는 모듈보다 먼저 bus 생성
+  app_events_init();
+  track_log_init();
+  gps_grid_init();
+  pos_out_init();
   
-  if(config->board == BOARD_TYPE_BASE_F9P || config->board == BOARD_TYPE_BASE_UM982)
-  {
-    gps_init_all();
-
-    if(params->use_manual_position == false)
-    {
-      gsm_task_create(NULL);
-    }
-    
-    lora_instance_init();
-  }
-
-  if(config->use_rs485)
-  {
-    dwt_init();
-
-    #if USE_SOFTUART
-      rs485_app_init();
-#else
-      rs485_init_all();
-    #endif
-  }
-
-  if(config->use_ble)
-  {
-	  ble_init_all();
-  }
+  bool is_base = config->board == BOARD_TYPE_BASE_F9P || config->board == BOARD_TYPE_BASE_UM982;
+
+  // 서로 기다리지 않는 것은 동시에: LTE 등록이 GNSS 설정 (ACK poll) 과,
+  // BLE 모듈 설정 (응답 poll) 이 나머지와 겹친다. NTRIP 은 GSM 태스크가 LTE 뒤에 연다
+  static boot_stage_t stages[INIT_STAGE_CNT];
+  stages[INIT_STAGE_GPS] = (boot_stage_t){"i_gps", is_base ? gps_init_all : NULL, 0, 512};
+  stages[INIT_STAGE_LTE] = (boot_stage_t){
+      "i_lte", (is_base && !params->use_manual_position) ? init_stage_lte : NULL, 0, 256};
+  // 베이스는 LoRa 로 GPS RTCM 을 보내므로 GPS 뒤
+  stages[INIT_STAGE_LORA] = (boot_stage_t){
+      "i_lora", (is_base || config->lora_mode == LORA_MODE_REPEATER) ? init_stage_lora : NULL,
+      BOOT_STAGE_DEP(INIT_STAGE_GPS), 512};
+  stages[INIT_STAGE_RS485] = (boot_stage_t){"i_rs485", config->use_rs485 ? init_stage_rs485 : NULL,
+                                            0, 512};
+  stages[INIT_STAGE_BLE] = (boot_stage_t){"i_ble", config->use_ble ? init_stage_ble : NULL, 0, 512};
+  stages[INIT_STAGE_CAN] = (boot_stage_t){"i_can", config->use_can ? init_stage_can : NULL, 0, 256};
+  stages[INIT_STAGE_USB] = (boot_stage_t){"i_usb", config->use_usb ? init_stage_usb : NULL, 0, 256};
+  stages[INIT_STAGE_SD_LOG] = (boot_stage_t){"i_sd", config->use_sd_log ? init_stage_sd_log : NULL, 0, 256};
+
+  // 포트 init 들이 동시에 RCC enable 레지스터를 read-modify-write 하지 않게 미리
+  LL_APB1_GRP1_EnableClock(LL_APB1_GRP1_PERIPH_USART2 | LL_APB1_GRP1_PERIPH_USART3 |
+                           LL_APB1_GRP1_PERIPH_UART4 | LL_APB1_GRP1_PERIPH_UART5);
+  LL_APB2_GRP1_EnableClock(LL_APB2_GRP1_PERIPH_USART1 | LL_APB2_GRP1_PERIPH_SYSCFG);
+
+  boot_stage_run(stages, INIT_STAGE_CNT);
+
+  // 포트가 다 뜬 뒤 (샘플하는 큐/링이 등록된 뒤)
+  load_gov_init();
 
   vTaskDelete(NULL);
 }
@@ -174,6 +257,10 @@ int main(void) {
    */
 
 	HAL_Init();
+  // 이전 부팅 기록을 보존하고 새 타임라인 시작 (HAL tick 기준)
+  boot_timeline_init();
+  // 리셋 전 부팅의 이벤트 링을 남기고 다른 링에 기록 시작
+  pm_trace_init();
 
   /* USER CODE BEGIN Init */
 
@@ -186,13 +273,20 @@ int main(void) {
   //  SEGGER_SYSVIEW_DisableEvents(SYSVIEW_EVTMASK_ISR_ENTER | SYSVIEW_EVTMASK_ISR_EXIT);
 
   //  traceSTART();
+#if defined(USE_TRACE_MARKERS)
+  SEGGER_SYSVIEW_Conf();
+#endif
+#if (configUSE_TICKLESS_IDLE == 1) && defined(DEBUG)
+  // tickless WFI 중에도 디버거/RTT 가 붙어 있게
+  HAL_DBGMCU_EnableDBGSleepMode();
+#endif
   /* USER CODE END SysInit */
 
   /* Initialize all configured peripherals */
   MX_GPIO_Init();
 
   GPIO_InitTypeDef GPIO_InitStruct = {0};
-#if defined(BOARD_TYPE_BASE_UNICORE) || defined(BOARD_TYPE_BASE_UBLOX)
+#if defined(BOARD_TYPE_BASE_UNICORE) || defined(BOARD_TYPE_BASE_UBLOX) || defined(BOARD_TYPE_REPEATER)
   /*Configure GPIO pin Output Level */
   HAL_GPIO_WritePin(GPIOC, GPIO_PIN_10, GPIO_PIN_RESET);
 
@@ -244,7 +338,12 @@ int main(void) {
   HAL_GPIO_Init(SOFT_UART_TX_GPIO_Port, &GPIO_InitStruct);
 
   MX_TIM1_Init();
+  #if SOFTUART_USE_DMA
+  // update 인터럽트 없이 DMA 요청만 쓴다 (주기는 SoftUartInit 에서 맞춤)
+  HAL_TIM_Base_Start(&htim1);
+  #else
   HAL_TIM_Base_Start_IT(&htim1);
+  #endif
 
   SoftUartInit(0,SOFT_UART_TX_PORT,SOFT_UART_TX_PIN,SOFT_UART_RX_PORT,SOFT_UART_RX_PIN);
   SoftUartEnableRx(0);
@@ -258,7 +357,8 @@ int main(void) {
 //	HAL_Delay(100);
 
   /* USER CODE BEGIN 2 */
-  xTaskCreate(initThread, "init", 512, NULL, tskIDLE_PRIORITY + 1, NULL);
+  HEAP_TRACK(HEAP_TAG_TASK,
+             xTaskCreate(initThread, "init", 512, NULL, tskIDLE_PRIORITY + 1, NULL));
 
   vTaskStartScheduler();
   /* USER CODE END 2 */
@@ -298,7 +398,7 @@ void SystemClock_Config(void) {
   RCC_OscInitStruct.PLL.PLLM = 13;
   RCC_OscInitStruct.PLL.PLLN = 168;
   RCC_OscInitStruct.PLL.PLLP = RCC_PLLP_DIV2;
-  RCC_OscInitStruct.PLL.PLLQ = 4;
+  RCC_OscInitStruct.PLL.PLLQ = 7; // USB OTG FS 48 MHz (VCO 336 / 7)
   if (HAL_RCC_OscConfig(&RCC_OscInitStruct) != HAL_OK) {
     Error_Handler();
   }
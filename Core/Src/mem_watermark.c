@@ -0,0 +1,237 @@
+#include "mem_watermark.h"
+#include "event_bus.h"
+#include "gsm.h"
+#include "tx_pool.h"
+#include "task.h"
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+/* 등록할 수 있는 큐 수 (uxQueueNumber 1..N, 0 은 등록 안 된 큐) */
+#define MEM_WM_QUEUE_SLOTS 16
+
+typedef struct {
+  const char *name;
+  uint16_t len;
+  volatile uint16_t peak;
+  volatile uint16_t win; // mem_wm_take_fill() 이후 최대
+} mem_wm_queue_t;
+
+static mem_wm_t *wm_head;
+static mem_wm_queue_t wm_queues[MEM_WM_QUEUE_SLOTS];
+static uint32_t wm_queue_count;
+
+void mem_wm_register(mem_wm_t *wm) {
+  taskENTER_CRITICAL();
+  for (mem_wm_t *p = wm_head; p; p = p->next) {
+    if (p == wm) {
+      taskEXIT_CRITICAL();
+      return;
+    }
+  }
+  // 끝에 붙여서 출력이 등록 순서대로 나오게
+  mem_wm_t **tail = &wm_head;
+  while (*tail) {
+    tail = &(*tail)->next;
+  }
+  wm->next = NULL;
+  *tail = wm;
+  taskEXIT_CRITICAL();
+}
+
+QueueHandle_t mem_wm_register_queue(QueueHandle_t q, const char *name) {
+  if (!q) {
+    return q;
+  }
+
+  taskENTER_CRITICAL();
+  if (uxQueueGetQueueNumber(q) == 0 && wm_queue_count < MEM_WM_QUEUE_SLOTS) {
+    mem_wm_queue_t *s = &wm_queues[wm_queue_count++];
+
+    s->name = name;
+    s->len = (uint16_t)(uxQueueMessagesWaiting(q) + uxQueueSpacesAvailable(q));
+    s->peak = (uint16_t)uxQueueMessagesWaiting(q);
+    vQueueSetQueueNumber(q, wm_queue_count);
+  }
+  taskEXIT_CRITICAL();
+
+  return q;
+}
+
+void mem_wm_on_queue_send(uint32_t num, uint32_t waiting) {
+  if (num == 0 || num > wm_queue_count) {
+    return;
+  }
+
+  mem_wm_queue_t *s = &wm_queues[num - 1];
+
+  // queueOVERWRITE 면 꽉 찬 큐에 덮어쓰므로 len 을 넘지 않게
+  if (waiting > s->len) {
+    waiting = s->len;
+  }
+  if (waiting > s->peak) {
+    s->peak = (uint16_t)waiting;
+  }
+  if (waiting > s->win) {
+    s->win = (uint16_t)waiting;
+  }
+}
+
+uint8_t mem_wm_take_fill(void) {
+  uint32_t max = 0;
+
+  // 지우는 사이 들어온 값 하나는 놓쳐도 다음 구간에 다시 잡힌다
+  for (mem_wm_t *p = wm_head; p; p = p->next) {
+    uint32_t pct = p->size ? p->win * 100U / p->size : 0;
+
+    p->win = 0;
+    if (pct > max) {
+      max = pct;
+    }
+  }
+  for (uint32_t i = 0; i < wm_queue_count; i++) {
+    mem_wm_queue_t *s = &wm_queues[i];
+    uint32_t pct = s->len ? s->win * 100U / s->len : 0;
+
+    s->win = 0;
+    if (pct > max) {
+      max = pct;
+    }
+  }
+
+  return (uint8_t)(max > 100 ? 100 : max);
+}
+
+uint8_t mem_wm_peak_fill(void) {
+  uint32_t max = 0;
+
+  for (mem_wm_t *p = wm_head; p; p = p->next) {
+    uint32_t pct = p->size ? p->peak * 100U / p->size : 0;
+
+    if (pct > max) {
+      max = pct;
+    }
+  }
+  for (uint32_t i = 0; i < wm_queue_count; i++) {
+    uint32_t pct = wm_queues[i].len ? wm_queues[i].peak * 100U / wm_queues[i].len : 0;
+
+    if (pct > max) {
+      max = pct;
+    }
+  }
+
+  return (uint8_t)(max > 100 ? 100 : max);
+}
+
+void mem_wm_reset_peak(void) {
+  taskENTER_CRITICAL();
+  for (mem_wm_t *p = wm_head; p; p = p->next) {
+    p->peak = 0;
+  }
+  for (uint32_t i = 0; i < wm_queue_count; i++) {
+    wm_queues[i].peak = 0;
+  }
+  taskEXIT_CRITICAL();
+}
+
+static bool wm_pack_one(uint8_t *buf, size_t size, size_t *pos, uint8_t kind, const char *name,
+                        uint32_t len, uint32_t peak) {
+  mem_wm_rec_t rec = {.kind = kind, .size = len, .peak = peak};
+
+  if (size - *pos < sizeof(rec)) {
+    return false;
+  }
+  strncpy(rec.name, name, sizeof(rec.name));
+  memcpy(&buf[*pos], &rec, sizeof(rec));
+  *pos += sizeof(rec);
+  return true;
+}
+
+size_t mem_wm_pack(uint8_t *buf, size_t size) {
+  size_t pos = 0;
+
+  for (mem_wm_t *p = wm_head; p; p = p->next) {
+    if (!wm_pack_one(buf, size, &pos, 0, p->name, p->size, p->peak)) {
+      return 0;
+    }
+  }
+  for (uint32_t i = 0; i < wm_queue_count; i++) {
+    if (!wm_pack_one(buf, size, &pos, 1, wm_queues[i].name, wm_queues[i].len,
+                     wm_queues[i].peak)) {
+      return 0;
+    }
+  }
+
+  return pos;
+}
+
+static bool wm_append(char *buf, size_t size, size_t *pos, const char *fmt, ...) {
+  va_list ap;
+  int n;
+
+  va_start(ap, fmt);
+  n = vsnprintf(&buf[*pos], size - *pos, fmt, ap);
+  va_end(ap);
+
+  if (n < 0 || (size_t)n >= size - *pos) {
+    return false;
+  }
+  *pos += n;
+  return true;
+}
+
+size_t mem_wm_format(char *buf, size_t size) {
+  uint32_t allocated, peak, failures;
+  size_t pos = 0;
+
+  // 등록은 init 에서 끝나므로 목록은 잠그지 않고 읽음 (peak 는 한 word 읽기)
+  for (mem_wm_t *p = wm_head; p; p = p->next) {
+    if (!wm_append(buf, size, &pos, "+WM,%s,size=%lu,peak=%lu\n\r", p->name,
+                   (unsigned long)p->size, (unsigned long)p->peak)) {
+      return 0;
+    }
+  }
+
+  for (uint32_t i = 0; i < wm_queue_count; i++) {
+    if (!wm_append(buf, size, &pos, "+WMQ,%s,len=%u,peak=%u\n\r", wm_queues[i].name,
+                   (unsigned)wm_queues[i].len, (unsigned)wm_queues[i].peak)) {
+      return 0;
+    }
+  }
+
+  event_bus_get_pool_stats(&allocated, &peak, &failures);
+  if (!wm_append(buf, size, &pos, "+WMPOOL,evt,size=%lu,peak=%lu,fail=%lu\n\r",
+                 (unsigned long)EVENT_MSG_POOL_SIZE, (unsigned long)peak,
+                 (unsigned long)failures)) {
+    return 0;
+  }
+
+  for (uint8_t c = 0; c < GSM_TCP_PBUF_CLASS_CNT; c++) {
+    tcp_pbuf_pool_stats_t st;
+
+    if (!tcp_pbuf_pool_get_stats(c, &st)) {
+      continue;
+    }
+    if (!wm_append(buf, size, &pos, "+WMPOOL,pbuf%u,size=%u,peak=%u,fail=%lu\n\r",
+                   (unsigned)st.size, (unsigned)st.total,
+                   (unsigned)(st.total - st.min_free), (unsigned long)st.exhausted)) {
+      return 0;
+    }
+  }
+
+  for (uint8_t c = 0; c < TX_POOL_CLASS_CNT; c++) {
+    tx_pool_stats_t st;
+
+    if (!tx_pool_get_stats(c, &st)) {
+      continue;
+    }
+    if (!wm_append(buf, size, &pos, "+WMPOOL,tx%u,size=%u,peak=%u,fail=%lu\n\r",
+                   (unsigned)st.size, (unsigned)st.total,
+                   (unsigned)(st.total - st.min_free), (unsigned long)st.exhausted)) {
+      return 0;
+    }
+  }
+
+  return pos;
+}
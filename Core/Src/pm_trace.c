@@ -0,0 +1,185 @@
+#include "pm_trace.h"
+#include "mem_section.h"
+#include "stm32f4xx.h"
+#include <stdio.h>
+#include <string.h>
+
+#define PM_TRACE_MAGIC 0x504D5431 // "PMT1"
+
+typedef struct {
+  uint32_t magic;
+  uint32_t boot_count;
+  uint32_t reset;         // 이 부팅 시작 때 RCC_CSR 리셋 원인 (상위 8비트)
+  volatile uint32_t head; // 지금까지 잡은 자리 수 (링 위치는 head % PM_TRACE_LEN)
+  pm_trace_rec_t rec[PM_TRACE_LEN];
+} pm_trace_ring_t;
+
+_Static_assert((PM_TRACE_LEN & (PM_TRACE_LEN - 1)) == 0, "PM_TRACE_LEN 은 2 의 거듭제곱");
+
+// 리셋해도 지워지지 않게 (부팅마다 번갈아 씀)
+static pm_trace_ring_t pm_rings[2] NOINIT;
+
+static pm_trace_ring_t *pm_cur; // NULL 이면 init 전, 기록 안 함
+static pm_trace_ring_t *pm_prev;
+
+static const char *const pm_evt_names[PM_EVT_COUNT] = {
+    [PM_EVT_NONE] = "none",
+    [PM_EVT_BOOT] = "boot",
+    [PM_EVT_FAULT] = "fault",
+    [PM_EVT_FAULT_REG] = "fault_reg",
+    [PM_EVT_MALLOC_FAIL] = "malloc_fail",
+    [PM_EVT_STACK_OVF] = "stack_ovf",
+    [PM_EVT_GPS_FIX] = "gps_fix",
+    [PM_EVT_GPS_CMD_TMO] = "gps_cmd_tmo",
+    [PM_EVT_RTCM_SRC] = "rtcm_src",
+    [PM_EVT_LTE_INIT] = "lte_init",
+    [PM_EVT_NTRIP_UP] = "ntrip_up",
+    [PM_EVT_NTRIP_DOWN] = "ntrip_down",
+    [PM_EVT_LORA_TMO] = "lora_tmo",
+    [PM_EVT_LOAD_LEVEL] = "load_level",
+    [PM_EVT_RTCM_BASE] = "rtcm_base",
+};
+
+static bool pm_ring_valid(const pm_trace_ring_t *r) { return r->magic == PM_TRACE_MAGIC; }
+
+void pm_trace_init(void) {
+  uint32_t reset = RCC->CSR >> 24;
+  uint32_t count = 0;
+  int cur = 0;
+
+  RCC->CSR |= RCC_CSR_RMVF;
+
+  // 부팅 번호가 큰 쪽이 리셋 전 부팅
+  if (pm_ring_valid(&pm_rings[0]) &&
+      (!pm_ring_valid(&pm_rings[1]) || pm_rings[0].boot_count >= pm_rings[1].boot_count)) {
+    count = pm_rings[0].boot_count;
+    cur = 1;
+  } else if (pm_ring_valid(&pm_rings[1])) {
+    count = pm_rings[1].boot_count;
+  }
+
+  pm_prev = &pm_rings[1 - cur];
+  if (!pm_ring_valid(pm_prev)) {
+    memset(pm_prev, 0, sizeof(*pm_prev));
+  }
+
+  memset(&pm_rings[cur], 0, sizeof(pm_rings[cur]));
+  pm_rings[cur].boot_count = count + 1;
+  pm_rings[cur].reset = reset;
+  pm_rings[cur].magic = PM_TRACE_MAGIC;
+  pm_cur = &pm_rings[cur];
+
+  pm_trace(PM_EVT_BOOT, (uint16_t)reset, count + 1);
+}
+
+void pm_trace(pm_evt_t id, uint16_t a, uint32_t b) {
+  pm_trace_ring_t *r = pm_cur;
+  pm_trace_rec_t *rec;
+
+  if (!r) {
+    return;
+  }
+
+  // 자리만 원자적으로 잡고 채운다 (ISR 이 끼어들면 다음 자리를 씀)
+  rec = &r->rec[__atomic_fetch_add(&r->head, 1, __ATOMIC_RELAXED) & (PM_TRACE_LEN - 1)];
+  rec->cyc = DWT->CYCCNT;
+  rec->id = (uint16_t)id;
+  rec->a = a;
+  rec->b = b;
+}
+
+void pm_trace_fault(uint32_t exc_return) {
+  uint32_t pc = 0;
+
+  // EXC_RETURN bit 2: PSP 프레임 (r0-r3, r12, lr, pc, xpsr)
+  if (exc_return & 0x4U) {
+    pc = ((const uint32_t *)__get_PSP())[6];
+  }
+
+  pm_trace(PM_EVT_FAULT, (uint16_t)(__get_IPSR() & 0x1FFU), pc);
+  pm_trace(PM_EVT_FAULT_REG, (uint16_t)(SCB->HFSR >> 16), SCB->CFSR);
+}
+
+static const pm_trace_ring_t *pm_ring(bool prev) {
+  const pm_trace_ring_t *r = prev ? pm_prev : pm_cur;
+
+  return r && pm_ring_valid(r) ? r : NULL;
+}
+
+uint16_t pm_trace_info(bool prev, uint32_t *boot, uint8_t *reset) {
+  const pm_trace_ring_t *r = pm_ring(prev);
+  uint32_t head;
+
+  if (!r) {
+    return 0;
+  }
+
+  head = r->head;
+  *boot = r->boot_count;
+  // 리셋 전 부팅이 끝난 원인은 이번 부팅이 읽은 값
+  *reset = prev && pm_cur ? (uint8_t)pm_cur->reset : 0;
+
+  return (uint16_t)(head < PM_TRACE_LEN ? head : PM_TRACE_LEN);
+}
+
+size_t pm_trace_read(bool prev, uint16_t first, pm_trace_rec_t *out, size_t max) {
+  const pm_trace_ring_t *r = pm_ring(prev);
+  uint32_t head, cnt, start;
+  size_t n = 0;
+
+  if (!r) {
+    return 0;
+  }
+
+  head = r->head;
+  cnt = head < PM_TRACE_LEN ? head : PM_TRACE_LEN;
+  start = head - cnt;
+
+  for (uint32_t i = first; i < cnt && n < max; i++) {
+    out[n++] = r->rec[(start + i) & (PM_TRACE_LEN - 1)];
+  }
+
+  return n;
+}
+
+size_t pm_trace_format(char *buf, size_t size, bool prev, uint16_t first, uint16_t *next) {
+  pm_trace_rec_t last, rec;
+  uint32_t boot;
+  uint8_t reset;
+  uint16_t cnt = pm_trace_info(prev, &boot, &reset);
+  uint32_t cyc_us = SystemCoreClock / 1000000U;
+  size_t pos = 0;
+  int n;
+
+  *next = first;
+  if (cnt == 0 || first >= cnt || pm_trace_read(prev, cnt - 1, &last, 1) != 1) {
+    return 0;
+  }
+
+  if (first == 0) {
+    n = snprintf(buf, size, "+PMT,n=%lu,rst=%02X,cnt=%u\n\r", (unsigned long)boot, reset,
+                 cnt);
+    if (n < 0 || (size_t)n >= size) {
+      return 0;
+    }
+    pos = n;
+  }
+
+  for (uint16_t i = first; i < cnt; i++) {
+    if (pm_trace_read(prev, i, &rec, 1) != 1) {
+      break;
+    }
+    n = snprintf(&buf[pos], size - pos, "+PMT,%lu,%s,%u,%lX\n\r",
+                 (unsigned long)((last.cyc - rec.cyc) / cyc_us),
+                 rec.id < PM_EVT_COUNT ? pm_evt_names[rec.id] : "?", rec.a,
+                 (unsigned long)rec.b);
+    if (n < 0 || (size_t)n >= size - pos) {
+      buf[pos] = '\0'; // 잘린 줄은 다음에
+      break;
+    }
+    pos += n;
+    *next = i + 1;
+  }
+
+  return *next == first ? 0 : pos;
+}
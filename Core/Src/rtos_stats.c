@@ -0,0 +1,188 @@
+#include "rtos_stats.h"
+#include "heap_track.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdio.h>
+#include <string.h>
+
+#define RTOS_STATS_MAX_TASKS 24
+
+/**
+ * @brief 측정 구간 시작 시점의 run-time (태스크는 xTaskNumber 로 찾음)
+ *
+ * 구간 중에 생긴 태스크는 시작값 0 으로 본다.
+ */
+static struct {
+  UBaseType_t num[RTOS_STATS_MAX_TASKS];
+  configRUN_TIME_COUNTER_TYPE run[RTOS_STATS_MAX_TASKS];
+  UBaseType_t count;
+  configRUN_TIME_COUNTER_TYPE total;
+} base;
+
+static configRUN_TIME_COUNTER_TYPE base_lookup(UBaseType_t num) {
+  for (UBaseType_t i = 0; i < base.count; i++) {
+    if (base.num[i] == num) {
+      return base.run[i];
+    }
+  }
+  return 0;
+}
+
+/**
+ * @brief 전체 태스크 상태 스냅샷 (호출자가 vPortFree)
+ */
+static TaskStatus_t *stats_snapshot(UBaseType_t *count,
+                                    configRUN_TIME_COUNTER_TYPE *total) {
+  // 사이에 태스크가 생겨도 배열이 모자라지 않게 여유
+  UBaseType_t n = uxTaskGetNumberOfTasks() + 2;
+  TaskStatus_t *st = HEAP_TRACK(HEAP_TAG_STATS, pvPortMalloc(n * sizeof(TaskStatus_t)));
+
+  if (!st) {
+    return NULL;
+  }
+
+  *count = uxTaskGetSystemState(st, n, total);
+  return st;
+}
+
+void rtos_stats_reset(void) {
+  configRUN_TIME_COUNTER_TYPE total;
+  UBaseType_t count;
+  TaskStatus_t *st = stats_snapshot(&count, &total);
+
+  if (!st) {
+    return;
+  }
+
+  vTaskSuspendAll();
+  base.count = 0;
+  for (UBaseType_t i = 0; i < count && i < RTOS_STATS_MAX_TASKS; i++) {
+    base.num[i] = st[i].xTaskNumber;
+    base.run[i] = st[i].ulRunTimeCounter;
+    base.count++;
+  }
+  base.total = total;
+  xTaskResumeAll();
+
+  vPortFree(st);
+}
+
+/**
+ * @brief 구간 시작값을 빼서 ulRunTimeCounter 를 구간 동안의 cycle 로 바꿈
+ */
+static void stats_since_base(TaskStatus_t *st, UBaseType_t count,
+                             configRUN_TIME_COUNTER_TYPE *total) {
+  vTaskSuspendAll();
+  for (UBaseType_t i = 0; i < count; i++) {
+    st[i].ulRunTimeCounter -= base_lookup(st[i].xTaskNumber);
+  }
+  *total -= base.total;
+  xTaskResumeAll();
+}
+
+size_t rtos_stats_format(char *buf, size_t size) {
+  configRUN_TIME_COUNTER_TYPE total;
+  UBaseType_t count;
+  TaskStatus_t *st = stats_snapshot(&count, &total);
+  size_t pos = 0;
+  int n;
+
+  if (!st) {
+    return 0;
+  }
+
+  stats_since_base(st, count, &total);
+
+  n = snprintf(buf, size, "+CPU,ms=%lu\n\r",
+               (unsigned long)(total / (SystemCoreClock / 1000)));
+  if (n < 0 || (size_t)n >= size) {
+    vPortFree(st);
+    return 0;
+  }
+  pos = n;
+
+  for (UBaseType_t i = 0; i < count; i++) {
+    uint32_t pct = total ? (uint32_t)(st[i].ulRunTimeCounter * 1000 / total) : 0;
+
+    n = snprintf(&buf[pos], size - pos, "+TASK,%s,prio=%lu,cpu=%lu.%lu%%,stack=%lu\n\r",
+                 st[i].pcTaskName, (unsigned long)st[i].uxCurrentPriority,
+                 (unsigned long)(pct / 10), (unsigned long)(pct % 10),
+                 (unsigned long)st[i].usStackHighWaterMark);
+    if (n < 0 || (size_t)n >= size - pos) {
+      vPortFree(st);
+      return 0;
+    }
+    pos += n;
+  }
+  vPortFree(st);
+
+  n = snprintf(&buf[pos], size - pos, "+HEAP,free=%lu,min=%lu\n\r",
+               (unsigned long)xPortGetFreeHeapSize(),
+               (unsigned long)xPortGetMinimumEverFreeHeapSize());
+  if (n < 0 || (size_t)n >= size - pos) {
+    return 0;
+  }
+  pos += n;
+
+  return pos;
+}
+
+size_t rtos_stats_pack(uint8_t *buf, size_t size) {
+  configRUN_TIME_COUNTER_TYPE total;
+  UBaseType_t count;
+  TaskStatus_t *st;
+  uint32_t ms;
+  size_t pos = sizeof(ms);
+
+  if (size < sizeof(ms)) {
+    return 0;
+  }
+  st = stats_snapshot(&count, &total);
+  if (!st) {
+    return 0;
+  }
+
+  stats_since_base(st, count, &total);
+  ms = (uint32_t)(total / (SystemCoreClock / 1000));
+  memcpy(buf, &ms, sizeof(ms));
+
+  for (UBaseType_t i = 0; i < count; i++) {
+    rtos_task_rec_t rec = {0};
+
+    if (size - pos < sizeof(rec)) {
+      vPortFree(st);
+      return 0;
+    }
+    strncpy(rec.name, st[i].pcTaskName, sizeof(rec.name));
+    rec.prio = (uint8_t)st[i].uxCurrentPriority;
+    rec.state = (uint8_t)st[i].eCurrentState;
+    rec.cpu = total ? (uint16_t)(st[i].ulRunTimeCounter * 1000 / total) : 0;
+    rec.stack = (uint16_t)st[i].usStackHighWaterMark;
+    memcpy(&buf[pos], &rec, sizeof(rec));
+    pos += sizeof(rec);
+  }
+  vPortFree(st);
+
+  return pos;
+}
+
+uint16_t rtos_stats_cpu_load(rtos_load_t *prev) {
+  configRUN_TIME_COUNTER_TYPE idle;
+  configRUN_TIME_COUNTER_TYPE total;
+
+  vTaskSuspendAll();
+  idle = ulTaskGetIdleRunTimeCounter();
+  total = portGET_RUN_TIME_COUNTER_VALUE();
+  xTaskResumeAll();
+
+  uint64_t d_idle = idle - prev->idle;
+  uint64_t d_total = total - prev->total;
+
+  prev->idle = idle;
+  prev->total = total;
+
+  if (d_total == 0 || d_idle > d_total) {
+    return 0;
+  }
+  return (uint16_t)(1000 - d_idle * 1000 / d_total);
+}
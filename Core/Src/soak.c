@@ -0,0 +1,313 @@
+#include "soak.h"
+#include "FreeRTOS.h"
+#include "board_config.h"
+#include "gps_app.h"
+#include "mem_section.h"
+#include "mem_watermark.h"
+#include "rtcm_loadgen.h"
+#include "rtcm_router.h"
+#include "rtos_stats.h"
+#include "work_queue.h"
+#include <stdio.h>
+#include <string.h>
+
+#define TAG "SOAK"
+
+#include "log.h"
+
+typedef enum {
+  SOAK_OFF = 0,
+  SOAK_RUN,
+  SOAK_DONE,
+} soak_state_t;
+
+static void soak_work(work_t *work);
+static work_t sk_work = WORK_INIT(soak_work, NULL, WORK_PRIO_LOW);
+
+CCM_BSS static soak_sample_t sk_series[SOAK_SAMPLES];
+
+static volatile uint8_t sk_state;
+static volatile uint16_t sk_cnt;
+static volatile uint16_t sk_step = 1; // 칸 간격 [분]
+static uint32_t sk_dur, sk_elapsed;  // [분]
+static uint16_t sk_tick;             // 이번 칸에 지난 분
+static bool sk_loadgen;              // 시작할 때 부하 생성기가 켜져 있었음
+
+// 칸 안 최저/최고 (heap, fill) 와 구간 시작 누적값 (err, lat, cpu)
+static soak_sample_t sk_acc;
+static uint32_t sk_err0, sk_lat_cnt0, sk_lat_sum0;
+static rtos_load_t sk_load;
+
+static const char *const sk_names[SOAK_F_COUNT] = {
+    [SOAK_F_FREE] = "free", [SOAK_F_MIN] = "min", [SOAK_F_BIG] = "big",
+    [SOAK_F_FILL] = "fill", [SOAK_F_ERR] = "err", [SOAK_F_LAT] = "lat",
+    [SOAK_F_CPU] = "cpu",
+};
+
+static uint16_t sk_sat16(uint32_t v) { return v > UINT16_MAX ? UINT16_MAX : (uint16_t)v; }
+
+static uint32_t soak_parse_err(void) {
+  uint32_t err = 0;
+  gps_stats_t st;
+
+  for (int id = 0; id < GPS_ID_MAX; id++) {
+    gps_t *gps = gps_get_instance_handle((gps_id_t)id);
+
+    if (!gps) {
+      continue;
+    }
+    gps_get_stats(gps, &st);
+    for (int p = 0; p < GPS_STATS_PROTOCOL_CNT; p++) {
+      err += st.proto[p].chksum_err + st.proto[p].oversize + st.proto[p].resync;
+    }
+    err += st.rx_overrun;
+  }
+
+  return err;
+}
+
+static void soak_lat(uint32_t *cnt, uint32_t *sum) {
+  rtcm_lat_stat_t st;
+
+  *cnt = *sum = 0;
+  for (int src = 0; src < RTCM_SRC_MAX; src++) {
+    if (rtcm_router_get_latency((rtcm_src_t)src, RTCM_LAT_TOTAL, &st)) {
+      *cnt += st.count;
+      *sum += st.sum_ms;
+    }
+  }
+}
+
+/**
+ * @brief 1 분마다 heap/fill 을 보고 칸 안 최저/최고만 남김
+ */
+static void soak_observe(void) {
+  HeapStats_t hs;
+  uint8_t fill = mem_wm_peak_fill();
+
+  vPortGetHeapStats(&hs);
+  if (sk_tick == 0) {
+    sk_acc.v[SOAK_F_FREE] = UINT16_MAX;
+    sk_acc.v[SOAK_F_BIG] = UINT16_MAX;
+    sk_acc.v[SOAK_F_FILL] = 0;
+  }
+  if (hs.xAvailableHeapSpaceInBytes / 8U < sk_acc.v[SOAK_F_FREE]) {
+    sk_acc.v[SOAK_F_FREE] = sk_sat16(hs.xAvailableHeapSpaceInBytes / 8U);
+  }
+  if (hs.xSizeOfLargestFreeBlockInBytes / 8U < sk_acc.v[SOAK_F_BIG]) {
+    sk_acc.v[SOAK_F_BIG] = sk_sat16(hs.xSizeOfLargestFreeBlockInBytes / 8U);
+  }
+  if (fill > sk_acc.v[SOAK_F_FILL]) {
+    sk_acc.v[SOAK_F_FILL] = fill;
+  }
+  sk_acc.v[SOAK_F_MIN] = sk_sat16(hs.xMinimumEverFreeBytesRemaining / 8U);
+}
+
+/**
+ * @brief 칸을 마치고 구간 누적값을 새로 잡음
+ */
+static void soak_close(soak_sample_t *s) {
+  uint32_t err = soak_parse_err();
+  uint32_t cnt, sum;
+
+  soak_lat(&cnt, &sum);
+  *s = sk_acc;
+  s->v[SOAK_F_ERR] = sk_sat16(err - sk_err0);
+  s->v[SOAK_F_LAT] = cnt != sk_lat_cnt0 ? sk_sat16((sum - sk_lat_sum0) / (cnt - sk_lat_cnt0)) : 0;
+  s->v[SOAK_F_CPU] = rtos_stats_cpu_load(&sk_load);
+
+  sk_err0 = err;
+  sk_lat_cnt0 = cnt;
+  sk_lat_sum0 = sum;
+}
+
+/**
+ * @brief 이웃 두 칸을 하나로 (간격 두 배)
+ */
+static void soak_compact(void) {
+  uint16_t half = sk_cnt / 2;
+
+  for (uint16_t i = 0; i < half; i++) {
+    const soak_sample_t *a = &sk_series[2 * i];
+    const soak_sample_t *b = &sk_series[2 * i + 1];
+    soak_sample_t m;
+
+    for (int f = 0; f < SOAK_F_COUNT; f++) {
+      switch (f) {
+      case SOAK_F_FILL:
+        m.v[f] = a->v[f] > b->v[f] ? a->v[f] : b->v[f];
+        break;
+      case SOAK_F_ERR:
+        m.v[f] = sk_sat16((uint32_t)a->v[f] + b->v[f]);
+        break;
+      case SOAK_F_LAT:
+      case SOAK_F_CPU:
+        m.v[f] = (uint16_t)(((uint32_t)a->v[f] + b->v[f]) / 2U);
+        break;
+      default: // heap: 낮은 쪽
+        m.v[f] = a->v[f] < b->v[f] ? a->v[f] : b->v[f];
+        break;
+      }
+    }
+    sk_series[i] = m;
+  }
+
+  taskENTER_CRITICAL();
+  sk_cnt = half;
+  sk_step *= 2;
+  taskEXIT_CRITICAL();
+}
+
+static void soak_finish(void) {
+  sk_state = SOAK_DONE;
+  if (sk_loadgen) {
+    rtcm_loadgen_cfg_t off = {0};
+
+    rtcm_loadgen_set(&off);
+  }
+  LOG_INFO("done %lu min, %u samples x %u min", (unsigned long)sk_elapsed, sk_cnt, sk_step);
+}
+
+static void soak_work(work_t *work) {
+  if (sk_state != SOAK_RUN) {
+    return;
+  }
+
+  soak_observe();
+  sk_elapsed++;
+
+  if (++sk_tick >= sk_step) {
+    sk_tick = 0;
+    if (sk_cnt == SOAK_SAMPLES) {
+      soak_compact();
+    }
+    soak_close(&sk_series[sk_cnt]);
+    sk_cnt++;
+  }
+
+  if (sk_elapsed >= sk_dur) {
+    soak_finish();
+    return;
+  }
+
+  work_submit_delayed(work, SOAK_PERIOD_MS);
+}
+
+bool soak_start(uint32_t minutes) {
+  if (minutes > SOAK_MAX_MIN) {
+    return false;
+  }
+
+  work_cancel(&sk_work);
+  if (minutes == 0) {
+    if (sk_state == SOAK_RUN) {
+      soak_finish();
+    }
+    return true;
+  }
+
+  sk_state = SOAK_OFF;
+  sk_cnt = 0;
+  sk_step = 1;
+  sk_tick = 0;
+  sk_elapsed = 0;
+  sk_dur = minutes;
+  sk_loadgen = rtcm_loadgen_active();
+  sk_err0 = soak_parse_err();
+  soak_lat(&sk_lat_cnt0, &sk_lat_sum0);
+  rtos_stats_cpu_load(&sk_load);
+  sk_state = SOAK_RUN;
+
+  LOG_INFO("start %lu min (loadgen %s)", (unsigned long)minutes, sk_loadgen ? "on" : "off");
+  work_submit_delayed(&sk_work, SOAK_PERIOD_MS);
+
+  return true;
+}
+
+bool soak_running(void) { return sk_state == SOAK_RUN; }
+
+/**
+ * @brief 표시 단위로 (heap 은 byte, err 는 시간당)
+ */
+static float soak_scale(int f, uint16_t step) {
+  switch (f) {
+  case SOAK_F_FREE:
+  case SOAK_F_MIN:
+  case SOAK_F_BIG:
+    return 8.0f;
+  case SOAK_F_ERR:
+    return 60.0f / step;
+  default:
+    return 1.0f;
+  }
+}
+
+size_t soak_format(char *buf, size_t size) {
+  static const char *const st_names[] = {"off", "run", "done"};
+  uint16_t cnt = sk_cnt;
+  uint16_t step = sk_step;
+  size_t pos;
+  int n;
+
+  n = snprintf(buf, size, "+SOAK,st=%s,el=%lu,dur=%lu,n=%u,step=%u\n\r", st_names[sk_state],
+               (unsigned long)sk_elapsed, (unsigned long)sk_dur, cnt, step);
+  if (n < 0 || (size_t)n >= size) {
+    return 0;
+  }
+  pos = n;
+
+  for (int f = 0; cnt > 0 && f < SOAK_F_COUNT; f++) {
+    float k = soak_scale(f, step);
+    float mi = (cnt - 1) / 2.0f, my = 0, sxy = 0, sxx = 0;
+    uint16_t lo = UINT16_MAX, hi = 0;
+
+    for (uint16_t i = 0; i < cnt; i++) {
+      uint16_t v = sk_series[i].v[f];
+
+      my += v;
+      lo = v < lo ? v : lo;
+      hi = v > hi ? v : hi;
+    }
+    my /= cnt;
+    for (uint16_t i = 0; i < cnt; i++) {
+      sxy += (i - mi) * (sk_series[i].v[f] - my);
+      sxx += (i - mi) * (i - mi);
+    }
+
+    // 칸 하나가 step 분이라 시간당은 60 / step 칸
+    n = snprintf(&buf[pos], size - pos, "+SOAKD,%s,first=%lu,last=%lu,min=%lu,max=%lu,slope=%.1f\n\r",
+                 sk_names[f], (unsigned long)(sk_series[0].v[f] * k),
+                 (unsigned long)(sk_series[cnt - 1].v[f] * k), (unsigned long)(lo * k),
+                 (unsigned long)(hi * k), sxx > 0 ? (double)(sxy / sxx * k * 60.0f / step) : 0.0);
+    if (n < 0 || (size_t)n >= size - pos) {
+      return 0;
+    }
+    pos += n;
+  }
+
+  return pos;
+}
+
+size_t soak_format_series(char *buf, size_t size, uint16_t first, uint16_t *next) {
+  uint16_t cnt = sk_cnt;
+  uint16_t step = sk_step;
+  size_t pos = 0;
+
+  *next = first;
+  for (uint16_t i = first; i < cnt; i++) {
+    const soak_sample_t *s = &sk_series[i];
+    int n = snprintf(&buf[pos], size - pos, "+SOAKS,%lu,%u,%u,%u,%u,%u,%u,%u\n\r",
+                     (unsigned long)(i + 1U) * step, s->v[SOAK_F_FREE], s->v[SOAK_F_MIN],
+                     s->v[SOAK_F_BIG], s->v[SOAK_F_FILL], s->v[SOAK_F_ERR], s->v[SOAK_F_LAT],
+                     s->v[SOAK_F_CPU]);
+
+    if (n < 0 || (size_t)n >= size - pos) {
+      buf[pos] = '\0'; // 잘린 줄은 다음에
+      break;
+    }
+    pos += n;
+    *next = i + 1;
+  }
+
+  return *next == first ? 0 : pos;
+}
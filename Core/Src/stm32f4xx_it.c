@@ -22,6 +22,8 @@
 #include "main.h"
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
+#include "gps_time.h"
+#include "pm_trace.h"
 
 /* USER CODE END Includes */
 
@@ -44,6 +46,7 @@
 /* USER CODE BEGIN PV */
 extern void xPortSysTickHandler(void);
 extern TIM_HandleTypeDef htim1;
+extern ADC_HandleTypeDef hadc1;
 /* USER CODE END PV */
 
 /* Private function prototypes -----------------------------------------------*/
@@ -83,6 +86,7 @@ void NMI_Handler(void) {
  */
 void HardFault_Handler(void) {
   /* USER CODE BEGIN HardFault_IRQn 0 */
+	pm_trace_fault((uint32_t)__builtin_return_address(0));
 	NVIC_SystemReset();
   /* USER CODE END HardFault_IRQn 0 */
   while (1) {
@@ -96,6 +100,7 @@ void HardFault_Handler(void) {
  */
 void MemManage_Handler(void) {
   /* USER CODE BEGIN MemoryManagement_IRQn 0 */
+	pm_trace_fault((uint32_t)__builtin_return_address(0));
 	NVIC_SystemReset();
   /* USER CODE END MemoryManagement_IRQn 0 */
   while (1) {
@@ -109,6 +114,7 @@ void MemManage_Handler(void) {
  */
 void BusFault_Handler(void) {
   /* USER CODE BEGIN BusFault_IRQn 0 */
+	pm_trace_fault((uint32_t)__builtin_return_address(0));
 	NVIC_SystemReset();
   /* USER CODE END BusFault_IRQn 0 */
   while (1) {
@@ -122,6 +128,7 @@ void BusFault_Handler(void) {
  */
 void UsageFault_Handler(void) {
   /* USER CODE BEGIN UsageFault_IRQn 0 */
+	pm_trace_fault((uint32_t)__builtin_return_address(0));
 	NVIC_SystemReset();
   /* USER CODE END UsageFault_IRQn 0 */
   while (1) {
@@ -174,6 +181,9 @@ void SysTick_Handler(void) {
  */
 void EXTI4_IRQHandler(void) {
   /* USER CODE BEGIN EXTI4_IRQn 0 */
+  if (__HAL_GPIO_EXTI_GET_IT(RTK_INT_Pin) != 0U) {
+    gps_time_pps_isr(GPS_ID_BASE); // 수신기 PPS, 시각을 먼저 찍는다
+  }
 
   /* USER CODE END EXTI4_IRQn 0 */
   HAL_GPIO_EXTI_IRQHandler(RTK_INT_Pin);
@@ -187,6 +197,9 @@ void EXTI4_IRQHandler(void) {
  */
 void EXTI9_5_IRQHandler(void) {
   /* USER CODE BEGIN EXTI9_5_IRQn 0 */
+  if (__HAL_GPIO_EXTI_GET_IT(RTK2_INT_Pin) != 0U) {
+    gps_time_pps_isr(GPS_ID_ROVER);
+  }
 
   /* USER CODE END EXTI9_5_IRQn 0 */
   HAL_GPIO_EXTI_IRQHandler(RTK2_INT_Pin);
@@ -221,5 +234,10 @@ void TIM1_UP_TIM10_IRQHandler(void)
 // }
 
 /* USER CODE BEGIN 1 */
-
+/**
+ * @brief This function handles ADC1, ADC2 and ADC3 global interrupts.
+ */
+void ADC_IRQHandler(void) {
+  HAL_ADC_IRQHandler(&hadc1);
+}
 /* USER CODE END 1 */
@@ -44,22 +44,38 @@
 /* Ensure definitions are only used by the compiler, and not by the assembler.
  */
 #if defined(__ICCARM__) || defined(__CC_ARM) || defined(__GNUC__)
+#include <stddef.h>
 #include <stdint.h>
 extern uint32_t SystemCoreClock;
+extern void vMainConfigureTimerForRunTimeStats(void);
+extern uint64_t ulMainGetRunTimeCounterValue(void);
+extern void heap_track_on_malloc(void *ptr, size_t size);
+extern void heap_track_on_free(void *ptr);
+extern void mem_wm_on_queue_send(uint32_t num, uint32_t waiting);
+extern volatile uint32_t uwTick;
 #endif
 
+#include "board_type.h"
+
 #define configUSE_PREEMPTION 1
 #define configSUPPORT_STATIC_ALLOCATION 1
 #define configSUPPORT_DYNAMIC_ALLOCATION 1
 #define configUSE_IDLE_HOOK 1
 #define configUSE_TICK_HOOK 1
+/* 기준국 (배터리/태양광) 만 tickless: SysTick 을 멈추고 WFI (Sleep 모드).
+ * F405 에는 LPTIM 이 없고 Stop 모드에서는 UART DMA 가 멈추므로 Sleep 에
+ * 머물며, UART IDLE/DMA 인터럽트가 그대로 깨운다. */
+#if defined(BOARD_TYPE_BASE_UNICORE) || defined(BOARD_TYPE_BASE_UBLOX)
+#define configUSE_TICKLESS_IDLE 1
+#else
 #define configUSE_TICKLESS_IDLE 0
+#endif
 //#define configUSE_DAEMON_TASK_STARTUP_HOOK      1
 #define configCPU_CLOCK_HZ (SystemCoreClock)
 #define configTICK_RATE_HZ ((TickType_t)1000)
 #define configMAX_PRIORITIES (11)
 #define configMINIMAL_STACK_SIZE ((uint16_t)512)
-#define configTOTAL_HEAP_SIZE ((size_t)82 * 1024)
+#define configTOTAL_HEAP_SIZE ((size_t)56 * 1024)
 #define configMAX_TASK_NAME_LEN (16)
 #define configUSE_TRACE_FACILITY 1
 #define configUSE_16_BIT_TICKS 0
@@ -73,9 +89,22 @@ extern uint32_t SystemCoreClock;
 #define configUSE_MALLOC_FAILED_HOOK 1
 #define configCHECK_FOR_STACK_OVERFLOW 2
 #define configUSE_NEWLIB_REENTRANT 1
-#define configGENERATE_RUN_TIME_STATS 0
+#define configGENERATE_RUN_TIME_STATS 1
+#define configRUN_TIME_COUNTER_TYPE uint64_t
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS() vMainConfigureTimerForRunTimeStats()
+#define portGET_RUN_TIME_COUNTER_VALUE() ulMainGetRunTimeCounterValue()
 #define configOVERRIDE_DEFAULT_TICK_CONFIGURATION 0
 #define configRECORD_STACK_HIGH_ADDRESS 1
+/* heap 사용처 태그별 집계 (heap_track.c), heap_4 안에서 스케줄러 멈춘 채 호출 */
+#define traceMALLOC(pvAddress, uiSize) heap_track_on_malloc(pvAddress, uiSize)
+#define traceFREE(pvAddress, uiSize) heap_track_on_free(pvAddress)
+/* 등록한 큐의 최대 대기 항목 수 (mem_watermark.c), 복사 직전이라 +1 */
+#define traceQUEUE_SEND(pxQueue)                                               \
+  mem_wm_on_queue_send((pxQueue)->uxQueueNumber, (pxQueue)->uxMessagesWaiting + 1)
+#define traceQUEUE_SEND_FROM_ISR(pxQueue)                                      \
+  mem_wm_on_queue_send((pxQueue)->uxQueueNumber, (pxQueue)->uxMessagesWaiting + 1)
+/* tickless 로 건너뛴 tick 만큼 HAL tick (uwTick, 둘 다 1 kHz) 도 맞춤 */
+#define traceINCREASE_TICK_COUNT(xTicksToJump) (uwTick += (xTicksToJump))
 /* Defaults to size_t for backward compatibility, but can be changed
  * if lengths will always be less than the number of bytes in a size_t. */
 #define configMESSAGE_BUFFER_LENGTH_TYPE size_t
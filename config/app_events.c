@@ -0,0 +1,37 @@
+#include "app_events.h"
+
+#define APP_BUS_NAME "default"
+#define APP_BUS_QUEUE_DEPTH 16
+#define APP_BUS_PRIORITY (tskIDLE_PRIORITY + 3)
+
+static event_bus_t *app_bus_handle = NULL;
+
+bool app_events_init(void) {
+  if (app_bus_handle) {
+    return true;
+  }
+
+  app_bus_handle = event_bus_create(APP_BUS_NAME, APP_BUS_QUEUE_DEPTH, APP_BUS_PRIORITY);
+  if (!app_bus_handle) {
+    return false;
+  }
+
+  // 10~20Hz 항법 해는 늦은 구독자에게 최신 값 하나만 전달
+  event_bus_set_latest(app_bus_handle, APP_EVT_GPS_SOLUTION);
+
+  return true;
+}
+
+event_bus_t *app_bus(void) { return app_bus_handle; }
+
+bool app_event_publish(app_event_t evt, const void *data, size_t size) {
+  if (!event_bus_has_subscriber(app_bus_handle, evt)) {
+    return false;
+  }
+
+  return event_bus_publish(app_bus_handle, evt, data, size);
+}
+
+bool app_event_subscribe(uint32_t mask, event_handler_t handler, event_bus_lane_id_t lane) {
+  return event_bus_subscribe_lane(app_bus_handle, mask, handler, lane);
+}
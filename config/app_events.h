@@ -0,0 +1,94 @@
+#ifndef APP_EVENTS_H
+#define APP_EVENTS_H
+
+#include "event_bus.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief 시스템 event bus 의 이벤트 종류
+ *
+ * 생산자는 소비자를 모르고 publish 만 한다. 값이 event_mask 비트 번호이므로
+ * 32 개를 넘지 않는다. 괄호 안은 payload 타입.
+ */
+typedef enum {
+  APP_EVT_GPS_SOLUTION = 0, /**< app_evt_gps_solution_t - 새 항법 해, 값은 gps nav 에서 읽음 (최신 값만) */
+  APP_EVT_GPS_FIX_CHANGED,  /**< app_evt_gps_fix_t */
+  APP_EVT_GPS_RTK_SAMPLE,   /**< app_evt_gps_sample_t - RTK FIX 상태의 고정밀 위치 */
+  APP_EVT_GPS_GGA,          /**< app_evt_gps_gga_t - 캐스터로 보낼 GGA 원문 */
+  APP_EVT_RTCM_FRAME,       /**< app_evt_rtcm_frame_t - 수신기가 출력한 RTCM 프레임 */
+  APP_EVT_LINK_STATE,       /**< app_evt_link_state_t */
+} app_event_t;
+
+#define APP_EVT_BIT(evt) (1UL << (evt))
+
+typedef struct {
+  uint8_t id;     /**< gps_id_t */
+  uint16_t epoch; /**< epoch_dl 순번 (출력 마감 감시) */
+} app_evt_gps_solution_t;
+
+typedef struct {
+  uint8_t id;   /**< gps_id_t */
+  uint8_t fix;  /**< gps_fix_t, 바뀐 값 */
+  uint8_t prev; /**< gps_fix_t, 이전 값 */
+} app_evt_gps_fix_t;
+
+typedef struct {
+  int64_t lat; /**< [1e-9 deg] */
+  int64_t lon; /**< [1e-9 deg] */
+  int32_t alt; /**< [0.1 mm] 수신기 출력 높이 (F9P 타원체고, UM982 해발고) */
+  float h_acc; /**< [m] */
+  float v_acc; /**< [m] */
+} app_evt_gps_sample_t;
+
+typedef struct {
+  uint8_t id;  /**< gps_id_t */
+  uint8_t fix; /**< gps_fix_t */
+  uint8_t len;
+  uint16_t epoch; /**< 만든 epoch 의 epoch_dl 순번 */
+  char raw[];  /**< '\0' 없음 */
+} app_evt_gps_gga_t;
+
+typedef struct {
+  uint8_t id; /**< gps_id_t */
+  uint16_t type;
+  uint16_t len;
+  uint8_t data[]; /**< 헤더부터 CRC 까지 */
+} app_evt_rtcm_frame_t;
+
+typedef enum {
+  APP_LINK_NTRIP = 0,
+} app_link_t;
+
+typedef struct {
+  uint8_t link; /**< app_link_t */
+  bool up;
+} app_evt_link_state_t;
+
+/**
+ * @brief 시스템 bus 생성 (initThread 에서 다른 모듈 초기화 전에 한 번)
+ */
+bool app_events_init(void);
+
+/**
+ * @brief 시스템 bus (만들기 전이면 NULL)
+ */
+event_bus_t *app_bus(void);
+
+/**
+ * @brief 구독자가 있을 때만 payload 를 복사해 publish
+ *
+ * @return false 구독자 없음, bus 없음, 또는 pool/queue 가 가득 참
+ */
+bool app_event_publish(app_event_t evt, const void *data, size_t size);
+
+/**
+ * @brief 시스템 bus 구독
+ *
+ * 블록하거나 출력 포맷을 만드는 핸들러는 EVENT_BUS_LANE_LOW 로.
+ *
+ * @param mask APP_EVT_BIT() 조합
+ */
+bool app_event_subscribe(uint32_t mask, event_handler_t handler, event_bus_lane_id_t lane);
+
+#endif
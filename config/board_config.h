@@ -14,6 +14,7 @@
 #define USE_BLE 1
 #define USE_RS485 0
 #define USE_GSM 1
+#define RS485_RX_RING_SIZE 64
 #elif defined(BOARD_TYPE_BASE_UBLOX)
 #define BOARD_TYPE BOARD_TYPE_BASE_F9P
 #define GPS1_TYPE GPS_TYPE_F9P
@@ -23,6 +24,8 @@
 #define USE_BLE 1
 #define USE_RS485 0
 #define USE_GSM 1
+#define GPS1_RX_RING_SIZE 4096 // RTCM 출력 + HPPOSLLH
+#define RS485_RX_RING_SIZE 64
 #elif defined(BOARD_TYPE_ROVER_UNICORE)
 #define BOARD_TYPE BOARD_TYPE_ROVER_UM982
 #define GPS1_TYPE GPS_TYPE_UM982
@@ -33,6 +36,7 @@
 #define USE_RS485 1
 #define USE_GSM 1
 #define USE_SOFTUART 0
+#define BLE_RX_RING_SIZE 64
 #elif defined(BOARD_TYPE_ROVER_UBLOX)
 #define BOARD_TYPE BOARD_TYPE_ROVER_F9P
 #define GPS1_TYPE GPS_TYPE_F9P ///< base
@@ -43,6 +47,23 @@
 #define USE_RS485 1
 #define USE_GSM 1
 #define USE_SOFTUART 0
+#define GPS1_RX_RING_SIZE 4096 // moving base 20Hz + RTCM
+#define GPS2_RX_RING_SIZE 4096 // rover 20Hz RELPOSNED/HPPOSLLH
+#define BLE_RX_RING_SIZE 64
+#elif defined(BOARD_TYPE_REPEATER)
+#define BOARD_TYPE BOARD_TYPE_RELAY
+#define GPS1_TYPE GPS_TYPE_NONE
+#define GPS2_TYPE GPS_TYPE_NONE
+#define GPS_CNT 0
+#define LORA_MODE LORA_MODE_REPEATER
+#define LORA_RELAY_SLOT 0 // 중계 slot 번호 (중계기끼리 겹치지 않게)
+#define USE_BLE 1
+#define USE_RS485 0
+#define USE_GSM 0
+#define GPS1_RX_RING_SIZE 64
+#define GPS2_RX_RING_SIZE 64
+#define RS485_RX_RING_SIZE 64
+#define GSM_RX_RING_SIZE 64
 #else
 #define BOARD_TYPE BOARD_TYPE_NONE
 #define GPS1_TYPE GPS_TYPE_NONE
@@ -54,12 +75,227 @@
 #define USE_GSM 0
 #endif
 
+/*
+ * CAN 위치 출력 (bxCAN1, modules/can)
+ *
+ * 지금 보드들은 CAN 트랜시버가 없어 기본은 끈다. 붙인 보드는 블록에서
+ * USE_CAN 1 과, 기본 핀 (PB8 RX / PB9 TX, AF9) 이 아니면 CAN_PORT_* 를 정의한다.
+ * APB1 42 MHz 에서 bit 당 14 tq 라 CAN_BITRATE 는 3 MHz 의 약수 (1M/500k/250k/125k).
+ */
+#ifndef USE_CAN
+#define USE_CAN 0
+#endif
+#ifndef CAN_BITRATE
+#define CAN_BITRATE 500000
+#endif
+#ifndef CAN_PORT_GPIO
+#define CAN_PORT_GPIO GPIOB
+#define CAN_PORT_GPIO_CLK LL_AHB1_GRP1_PERIPH_GPIOB
+#define CAN_PORT_RX_PIN LL_GPIO_PIN_8
+#define CAN_PORT_TX_PIN LL_GPIO_PIN_9
+#define CAN_PORT_AF LL_GPIO_AF_9
+#endif
+#ifndef CAN_OUT_BASE_ID
+#define CAN_OUT_BASE_ID 0x500 // 11 bit 표준 ID, 출력/명령 ID 는 여기서부터
+#endif
+
+/*
+ * USB CDC 장치 포트 (OTG FS, PA11 DM / PA12 DP, modules/usb)
+ *
+ * 지금 보드들은 USB 커넥터가 없어 기본은 끈다. 벤치 보드가 블록에서
+ * USE_USB 1 로 켜면 로그, GNSS raw tee, 커맨드가 USB 로도 나간다.
+ * VBUS 감지 핀 (PA9) 은 LTE UART 가 쓰므로 감지 없이 붙는다.
+ */
+#ifndef USE_USB
+#define USE_USB 0
+#endif
+#ifndef USB_VID
+#define USB_VID 0x0483 // ST VCP (호스트 기본 CDC 드라이버)
+#define USB_PID 0x5740
+#endif
+
+/*
+ * SD 카드 raw GNSS 기록 (SDIO, PC8~PC11 D0~D3 / PC12 CK / PD2 CMD, modules/sd)
+ *
+ * SDIO 핀이 UART4/UART5 (PC10~PC12, PD2) 와 겹쳐 지금 보드들은 기본으로 끈다.
+ * 카드를 붙인 보드는 블록에서 USE_SD_LOG 1 을 정의한다. D1~D3 를 잇지 않았으면
+ * SD_BUS_4BIT 0. SD_LOG_CHUNK 는 카드에 한 번에 쓰는 단위이자 RAM 버퍼 하나의
+ * 크기 (두 개) 라 카드 쓰기가 늦어지는 동안 이만큼을 받아 둔다.
+ */
+#ifndef USE_SD_LOG
+#define USE_SD_LOG 0
+#endif
+#ifndef SD_BUS_4BIT
+#define SD_BUS_4BIT 1
+#endif
+#ifndef SD_LOG_CHUNK
+#define SD_LOG_CHUNK 16384 // 512 의 배수 (460800 baud 연속 수신이면 약 350 ms)
+#endif
+
+/*
+ * UART RX DMA 링 크기 (byte)
+ *
+ * 보드 블록에서 정의하지 않은 포트는 기본값을 쓴다. 보드에서 쓰지 않는
+ * 포트는 작게 잡아 RAM 을 아낀다. DMA 가 접근해야 하므로 CCM 에는 둘 수 없다.
+ */
+#ifndef GPS1_RX_RING_SIZE
+#define GPS1_RX_RING_SIZE 2048
+#endif
+#ifndef GPS2_RX_RING_SIZE
+#define GPS2_RX_RING_SIZE 2048
+#endif
+#ifndef BLE_RX_RING_SIZE
+#define BLE_RX_RING_SIZE 1024
+#endif
+#ifndef LORA_RX_RING_SIZE
+#define LORA_RX_RING_SIZE 1024
+#endif
+#ifndef RS485_RX_RING_SIZE
+#define RS485_RX_RING_SIZE 512
+#endif
+#ifndef GSM_RX_RING_SIZE
+#define GSM_RX_RING_SIZE 2048
+#endif
+
+/*
+ * UART DMA/IRQ 우선순위 (포트별)
+ *
+ * *_DMA_PRIO 는 같은 DMA 컨트롤러 stream 사이 중재 순위 (0 LOW ~ 3 VERY HIGH),
+ * *_IRQ_PRIO 는 NVIC 선점 순위 (작을수록 먼저, ISR 에서 FreeRTOS API 를
+ * 부르므로 configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY(4) 이상). RX 는 UART
+ * IDLE 과 RX DMA IRQ, TX 는 TX DMA IRQ 다.
+ *
+ * GNSS 포트를 가장 앞에 둬서 GSM burst 가 GPS DMA 나 IDLE 처리를 밀어내지
+ * 못하게 한다. GSM RX 는 같은 DMA2 의 dma_copy (LOW, stream 0 이라 같은
+ * 순위면 이김) 에 밀리지 않게 MEDIUM.
+ *
+ * RX DMA 는 FIFO 없이 (direct) byte 로 쓴다. FIFO 로 모아 word 로 쓰면 IDLE
+ * 시점에 1~3 byte 가 FIFO 에 남아 다음 수신까지 링에 보이지 않는다.
+ */
+#ifndef GPS_RX_DMA_PRIO
+#define GPS_RX_DMA_PRIO 3
+#endif
+#ifndef GPS_TX_DMA_PRIO
+#define GPS_TX_DMA_PRIO 2 // 보정 데이터 주입
+#endif
+#ifndef GPS_RX_IRQ_PRIO
+#define GPS_RX_IRQ_PRIO 4
+#endif
+#ifndef GPS_TX_IRQ_PRIO
+#define GPS_TX_IRQ_PRIO 5
+#endif
+#ifndef LORA_RX_DMA_PRIO
+#define LORA_RX_DMA_PRIO 1
+#endif
+#ifndef LORA_TX_DMA_PRIO
+#define LORA_TX_DMA_PRIO 0
+#endif
+#ifndef LORA_RX_IRQ_PRIO
+#define LORA_RX_IRQ_PRIO 5
+#endif
+#ifndef LORA_TX_IRQ_PRIO
+#define LORA_TX_IRQ_PRIO 6
+#endif
+#ifndef UART5_RX_DMA_PRIO
+#define UART5_RX_DMA_PRIO 1 // BLE 또는 RS485
+#endif
+#ifndef UART5_TX_DMA_PRIO
+#define UART5_TX_DMA_PRIO 0
+#endif
+#ifndef UART5_RX_IRQ_PRIO
+#define UART5_RX_IRQ_PRIO 5
+#endif
+#ifndef UART5_TX_IRQ_PRIO
+#define UART5_TX_IRQ_PRIO 6
+#endif
+#ifndef GSM_RX_DMA_PRIO
+#define GSM_RX_DMA_PRIO 1
+#endif
+#ifndef GSM_TX_DMA_PRIO
+#define GSM_TX_DMA_PRIO 0
+#endif
+#ifndef SDIO_DMA_PRIO
+#define SDIO_DMA_PRIO 3 // 흐름 제어 (HWFC) 는 errata 로 안 써서 SDIO FIFO 가 비면 안 됨
+#endif
+#ifndef GSM_RX_IRQ_PRIO
+#define GSM_RX_IRQ_PRIO 6
+#endif
+#ifndef GSM_TX_IRQ_PRIO
+#define GSM_TX_IRQ_PRIO 6
+#endif
+#ifndef CAN_RX_IRQ_PRIO
+#define CAN_RX_IRQ_PRIO 5 // 명령 FIFO (3 단) 가 넘치지 않게
+#endif
+#ifndef CAN_TX_IRQ_PRIO
+#define CAN_TX_IRQ_PRIO 6
+#endif
+#ifndef USB_IRQ_PRIO
+#define USB_IRQ_PRIO 6 // FIFO 가 packet 여럿을 담아 늦어도 됨
+#endif
+#ifndef SDIO_IRQ_PRIO
+#define SDIO_IRQ_PRIO 6 // 전송 끝/에러만 (데이터는 DMA)
+#endif
+
+/*
+ * NTRIP 보정 데이터 -> GPS UART 송신 링 크기 (byte, 2의 거듭제곱)
+ *
+ * 수신 한 번(QIRD 최대 1500 byte)이 다 들어가도록 잡는다. SRAM 에 둔다.
+ */
+#ifndef GPS_CORR_TX_RING_SIZE
+#define GPS_CORR_TX_RING_SIZE 2048
+#endif
+
+/*
+ * moving base RTCM 다리 (수신기 두 개, GPS1 -> GPS2)
+ *
+ * 보통은 두 F9P 의 UART2 를 이은 선으로 4072/MSM 이 바로 간다. 그 선이 없는
+ * 보드는 블록에서 USE_GPS_MB_BRIDGE 1 을 정의하면 moving base 가 RTCM 을
+ * UART1 (MCU) 로 내보내고, GPS1 RX 태스크가 고른 프레임을 GPS2 UART 송신
+ * 링에 프레임 단위로 넣는다 (링 크기는 2의 거듭제곱, SRAM).
+ */
+#ifndef USE_GPS_MB_BRIDGE
+#define USE_GPS_MB_BRIDGE 0
+#endif
+#if USE_GPS_MB_BRIDGE && GPS_CNT < 2
+#error "USE_GPS_MB_BRIDGE needs two receivers"
+#endif
+#ifndef GPS_MB_TX_RING_SIZE
+#define GPS_MB_TX_RING_SIZE 2048
+#endif
+
+/*
+ * GNSS raw tee -> BLE/RS485 UART 송신 링 크기 (byte, 2의 거듭제곱)
+ *
+ * 수신기 20Hz epoch 몇 개 분량. SRAM 에 두고 DMA 가 바로 읽는다.
+ */
+#ifndef GPS_TEE_TX_RING_SIZE
+#define GPS_TEE_TX_RING_SIZE 2048
+#endif
+
+/*
+ * LoRa 무선부
+ *
+ * LORA_RADIO_RAK 은 RAK 모듈 AT 펌웨어 (USART3), 지금 보드는 모두 이것이다.
+ * SX126X/SX127X 는 SPI 로 직접 붙인 Semtech 칩이라 보드 블록에서 같이 정의한다:
+ *   LORA_SPI, LORA_SPI_CLK_ENABLE(), LORA_SPI_AF, LORA_SPI_PORT, LORA_SPI_PINS
+ *   (SCK/MISO/MOSI 같은 포트), LORA_NSS_/LORA_RESET_/LORA_DIO_PORT, _PIN,
+ *   LORA_BUSY_PORT/PIN (SX126x), LORA_DIO_IRQn, LORA_DIO_IRQHandler
+ * DIO EXTI 선은 RTK PPS (EXTI4, EXTI9_5) 와 BLE (EXTI15_10) 가 쓰지 않는 것으로.
+ */
+#define LORA_RADIO_RAK 0
+#define LORA_RADIO_SX126X 1
+#define LORA_RADIO_SX127X 2
+#ifndef LORA_RADIO
+#define LORA_RADIO LORA_RADIO_RAK
+#endif
+
 typedef enum {
   BOARD_TYPE_NONE = 0,
   BOARD_TYPE_BASE_UM982,
   BOARD_TYPE_BASE_F9P,
   BOARD_TYPE_ROVER_UM982,
-  BOARD_TYPE_ROVER_F9P
+  BOARD_TYPE_ROVER_F9P,
+  BOARD_TYPE_RELAY // 선택 매크로 BOARD_TYPE_REPEATER 와 이름이 겹치지 않게
 } board_type_t;
 
 typedef enum {
@@ -77,7 +313,8 @@ typedef enum {
 typedef enum {
   LORA_MODE_NONE = 0,
   LORA_MODE_BASE,
-  LORA_MODE_ROVER
+  LORA_MODE_ROVER,
+  LORA_MODE_REPEATER
 } lora_mode_t;
 
 typedef struct {
@@ -88,8 +325,44 @@ typedef struct {
   bool use_ble;
   bool use_rs485;
   bool use_gsm;
+  bool use_can;
+  bool use_usb;
+  bool use_sd_log;
 } board_config_t;
 
-const board_config_t *board_get_config(void);
+/*
+ * 컴파일 타임 보드 조건
+ *
+ * 보드는 빌드 구성으로 정해지므로 hot path 에서는 board_get_config() 대신
+ * 이 매크로로 분기한다. 상수 비교라 다른 보드용 분기는 컴파일러가 지운다.
+ * (enum 값이라 #if 에서는 쓸 수 없음, C 의 if 로 쓴다)
+ */
+#define BOARD_IS(type) (BOARD_TYPE == (type))
+#define BOARD_LORA_IS(mode) (LORA_MODE == (mode))
+
+/**
+ * @brief 현재 보드 구성
+ *
+ * 값이 모두 상수라 필드 접근은 호출 지점에서 상수로 접힌다.
+ */
+static inline const board_config_t *board_get_config(void) {
+  static const board_config_t current_config = {
+      .board = BOARD_TYPE,
+      .gps =
+          {
+              [GPS_ID_BASE] = GPS1_TYPE,
+              [GPS_ID_ROVER] = GPS2_TYPE,
+          },
+      .gps_cnt = GPS_CNT,
+      .lora_mode = LORA_MODE,
+      .use_ble = (USE_BLE ? 1 : 0),
+      .use_rs485 = (USE_RS485 ? 1 : 0),
+      .use_gsm = (USE_GSM ? 1 : 0),
+      .use_can = (USE_CAN ? 1 : 0),
+      .use_usb = (USE_USB ? 1 : 0),
+      .use_sd_log = (USE_SD_LOG ? 1 : 0)};
+
+  return &current_config;
+}
 
 #endif
@@ -7,9 +7,11 @@
 // #define BOARD_TYPE_BASE_UBLOX // f9p base
 //  #define BOARD_TYPE_ROVER_UNICORE // um982 rover
 //   #define BOARD_TYPE_ROVER_UBLOX // f9p rover
+// #define BOARD_TYPE_REPEATER // LoRa 중계기 (베이스 보드, GPS 없음)
 
 #if defined(BOARD_TYPE_BASE_UNICORE) + defined(BOARD_TYPE_BASE_UBLOX) +         \
-        defined(BOARD_TYPE_ROVER_UNICORE) + defined(BOARD_TYPE_ROVER_UBLOX) != 1 \
+        defined(BOARD_TYPE_ROVER_UNICORE) + defined(BOARD_TYPE_ROVER_UBLOX) +    \
+        defined(BOARD_TYPE_REPEATER) != 1                                      \
 
 #error " 보드 타입을 하나만 설정해야 합니다"
 #endif
@@ -1,9 +1,52 @@
 #ifndef GPS_CONFIG_H
 #define GPS_CONFIG_H
 
-#define USE_STORE_RAW_GGA
+// 수신기 GGA 원문을 파서에서 byte 단위로 저장 (캐스터 GGA 는 gps_gga.c 가 항법 해로 생성)
+// #define USE_STORE_RAW_GGA
 
-// #define USE_GPS_UBLOX
-// #define USE_GPS_UNICORE
+// UM982 rover 를 binary log 만으로 초기화 (GPGGA/GPTHS 끄고 UNIHEADINGB/PVTSLNB)
+#define USE_UM982_BINARY_ONLY
+
+// gps_parse_process() 소요 cycle 측정 (DWT 필요)
+// #define USE_GPS_PARSE_CYCLES
+
+/*
+ * 수신기 디코더 선택 (보드의 GPS1_TYPE/GPS2_TYPE 기준)
+ *
+ * 보드에 없는 수신기의 디코더는 파싱 분기, 파서 상태, gps_t 안의 데이터와
+ * 초기화 테이블까지 빠진다. NMEA 와 RTCM 은 항상 들어간다.
+ * 호스트 벤치처럼 모든 수신기 캡처를 파싱하려면 USE_GPS_ALL_DECODERS 정의.
+ */
+#include "board_config.h"
+
+#if defined(USE_GPS_ALL_DECODERS) || defined(BOARD_TYPE_BASE_UBLOX) ||        \
+    defined(BOARD_TYPE_ROVER_UBLOX)
+#define USE_GPS_UBLOX
+#endif
+
+#if defined(USE_GPS_ALL_DECODERS) || defined(BOARD_TYPE_BASE_UNICORE) ||      \
+    defined(BOARD_TYPE_ROVER_UNICORE)
+#define USE_GPS_UNICORE
+#endif
+
+#if defined(USE_GPS_UBLOX)
+#define GPS_DECODER_UBLOX 1
+#else
+#define GPS_DECODER_UBLOX 0
+#endif
+
+#if defined(USE_GPS_UNICORE)
+#define GPS_DECODER_UNICORE 1
+#else
+#define GPS_DECODER_UNICORE 0
+#endif
+
+// 보드 블록에 새 수신기를 넣고 위 목록을 빠뜨리면 여기서 걸림
+_Static_assert(GPS_DECODER_UBLOX ||
+                   (GPS1_TYPE != GPS_TYPE_F9P && GPS2_TYPE != GPS_TYPE_F9P),
+               "F9P 보드인데 UBX 디코더가 빠짐");
+_Static_assert(GPS_DECODER_UNICORE ||
+                   (GPS1_TYPE != GPS_TYPE_UM982 && GPS2_TYPE != GPS_TYPE_UM982),
+               "UM982 보드인데 Unicore 디코더가 빠짐");
 
 #endif
\ No newline at end of file
@@ -0,0 +1,51 @@
+#ifndef MEM_SECTION_H
+#define MEM_SECTION_H
+
+/**
+ * @brief 메모리 배치 규칙 (STM32F405: SRAM 128KB, CCM 64KB)
+ *
+ * CCM 은 CPU D-bus 전용이라 wait 없이 읽히고 DMA 와 버스를 다투지 않는다.
+ * 대신 DMA 가 접근할 수 없으므로 다음처럼 나눈다.
+ *
+ * - CCM: 파서 상태(gps_t, RTCM framer), CRC 테이블, 태스크 스택과 큐 저장소,
+ *   CPU 만 만지는 작업 버퍼. uart_tx 동기 송신은 CCM 원본을 bounce 버퍼로
+ *   복사하므로 스택/작업 버퍼를 그대로 넘겨도 된다.
+ * - SRAM: DMA RX 링, uart_tx 비동기/stream 버퍼, softuart DMA 버퍼,
+ *   FreeRTOS heap 과 큰 벌크 버퍼 (GSM TCP large pbuf).
+ *
+ * - SRAM .RamFunc: 바이트마다 도는 파서/CRC 커널. flash 는 168 MHz 에서
+ *   5 wait state 라 ART 캐시에서 밀리면 바이트당 비용이 흔들리고, CCM 은
+ *   명령을 가져올 수 없으므로 SRAM 에 둔다.
+ *
+ * CCM 예산 (64KB): 정적 태스크 스택 약 32KB, GPS 인스턴스 약 5KB,
+ * CRC 테이블 5KB, RTCM framer/MSM 약 5KB, GSM small/mid pbuf 6KB.
+ * 큰 버퍼를 추가할 때는 .map 의 _eccmbss 와 .ccm_noinit 끝을 확인한다.
+ */
+
+/** 초기값 있는 CCM 데이터 (startup 에서 flash 로부터 복사) */
+#define CCM_DATA __attribute__((section(".ccmram")))
+
+/** 0 으로 초기화되는 CCM 데이터 (startup 에서 clear) */
+#define CCM_BSS __attribute__((section(".ccmbss")))
+
+/** 초기화하지 않는 CCM (태스크 스택, 큐 저장소, flash 이미지에 안 들어감) */
+#define CCM_NOINIT __attribute__((section(".ccm_noinit"), aligned(8)))
+
+/** 초기화하지 않는 SRAM (리셋 뒤에도 남길 기록, startup 이 건드리지 않음) */
+#define NOINIT __attribute__((section(".noinit"), aligned(4)))
+
+/**
+ * @brief SRAM 에서 실행하는 함수 (startup 에서 .data 와 함께 flash 로부터 복사)
+ *
+ * flash 와 SRAM 은 BL 범위 (16MB) 밖이라 long_call. 안에서 부르는 flash 함수
+ * (memchr, 이벤트 콜백 등) 는 그대로 flash 에서 돌고, param 섹터 erase 중에는
+ * 벡터 테이블과 ISR 이 flash 에 있어 여전히 밀린다 (그동안 DMA 링은 계속 찬다).
+ * 호스트 빌드 (bench/sim) 에서는 아무것도 하지 않는다.
+ */
+#if defined(__arm__)
+#define RAM_FUNC __attribute__((section(".RamFunc"), noinline, long_call))
+#else
+#define RAM_FUNC
+#endif
+
+#endif
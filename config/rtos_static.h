@@ -0,0 +1,37 @@
+#ifndef RTOS_STATIC_H
+#define RTOS_STATIC_H
+
+#include "FreeRTOS.h"
+#include "queue.h"
+#include "semphr.h"
+#include "task.h"
+#include "mem_section.h"
+#include "mem_watermark.h"
+
+/**
+ * @brief 정적 태스크 저장소 (스택은 CCM, TCB 는 SRAM)
+ *
+ * @param name 저장소 이름 (name##_stack, name##_tcb)
+ * @param words 스택 크기 (word)
+ */
+#define RTOS_STATIC_TASK(name, words)                                         \
+  static StackType_t name##_stack[words] CCM_NOINIT;                          \
+  static StaticTask_t name##_tcb
+
+#define RTOS_TASK_CREATE_STATIC(name, fn, task_name, param, prio)             \
+  xTaskCreateStatic((fn), (task_name), sizeof(name##_stack) / sizeof(StackType_t), \
+                    (param), (prio), name##_stack, &name##_tcb)
+
+/**
+ * @brief 정적 큐 저장소 (항목 저장 영역은 CCM)
+ */
+#define RTOS_STATIC_QUEUE(name, len, item_size)                               \
+  static uint8_t name##_storage[(len) * (item_size)] CCM_NOINIT;              \
+  static StaticQueue_t name##_qcb
+
+/** 만들면서 최대 대기 항목 수 기록에 등록 (mem_wm_register_queue, 이름은 #name) */
+#define RTOS_QUEUE_CREATE_STATIC(name, len, item_size)                        \
+  mem_wm_register_queue(                                                      \
+      xQueueCreateStatic((len), (item_size), name##_storage, &name##_qcb), #name)
+
+#endif
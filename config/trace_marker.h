@@ -0,0 +1,44 @@
+#ifndef TRACE_MARKER_H
+#define TRACE_MARKER_H
+
+/**
+ * @brief SystemView 마커 (보정 데이터 한 epoch 의 타임라인 보기)
+ *
+ * 켜면 main 에서 SystemView 를 초기화하고, 아래 지점에 MarkStart/Stop
+ * (구간) 또는 Mark (순간) 이벤트를 남긴다. 끄면 매크로가 모두 비어서
+ * 코드가 생기지 않는다.
+ */
+// #define USE_TRACE_MARKERS
+
+typedef enum {
+  TRACE_MARK_GPS_PARSE = 1, /**< gps_parse_ring() 구간 */
+  TRACE_MARK_RTCM_LORA,     /**< RTCM 프레임 완료 -> LoRa 조각 큐잉 구간 */
+  TRACE_MARK_LORA_TX,       /**< lora_tx_task 명령 송신 ~ 응답/타임아웃 구간 */
+  TRACE_MARK_QIRD,          /**< QIRD/direct push 데이터 수신 완료 (순간) */
+  TRACE_MARK_GPS_TX,        /**< GPS UART 보정 스트림 쓰기 구간 */
+} trace_mark_t;
+
+#if defined(USE_TRACE_MARKERS)
+#include "SEGGER_SYSVIEW.h"
+
+#define TRACE_MARK_START(id) SEGGER_SYSVIEW_MarkStart(id)
+#define TRACE_MARK_STOP(id) SEGGER_SYSVIEW_MarkStop(id)
+#define TRACE_MARK(id) SEGGER_SYSVIEW_Mark(id)
+
+/**
+ * @brief 마커 이름 전송 (SystemView 접속 시 system description 콜백에서)
+ */
+static inline void trace_marker_send_names(void) {
+  SEGGER_SYSVIEW_NameMarker(TRACE_MARK_GPS_PARSE, "gps_parse");
+  SEGGER_SYSVIEW_NameMarker(TRACE_MARK_RTCM_LORA, "rtcm_lora");
+  SEGGER_SYSVIEW_NameMarker(TRACE_MARK_LORA_TX, "lora_tx");
+  SEGGER_SYSVIEW_NameMarker(TRACE_MARK_QIRD, "qird_done");
+  SEGGER_SYSVIEW_NameMarker(TRACE_MARK_GPS_TX, "gps_corr_tx");
+}
+#else
+#define TRACE_MARK_START(id) ((void)0)
+#define TRACE_MARK_STOP(id) ((void)0)
+#define TRACE_MARK(id) ((void)0)
+#endif
+
+#endif
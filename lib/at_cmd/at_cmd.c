@@ -0,0 +1,78 @@
+#include "at_cmd.h"
+#include <string.h>
+
+/**
+ * @brief 길이가 정해진 두 문자열 비교 (strcmp 와 같은 순서)
+ */
+static int at_cmd_cmp(const char *a, size_t a_len, const char *b, size_t b_len) {
+  size_t n = a_len < b_len ? a_len : b_len;
+  int r = memcmp(a, b, n);
+
+  if (r != 0) {
+    return r;
+  }
+  return (a_len > b_len) - (a_len < b_len);
+}
+
+static inline bool at_cmd_is_prefix(const at_cmd_entry_t *e, const char *line,
+                                    size_t len) {
+  return e->name_len <= len && memcmp(e->name, line, e->name_len) == 0;
+}
+
+const at_cmd_entry_t *at_cmd_find(const at_cmd_table_t *table, const char *line,
+                                  size_t len) {
+  size_t lo = 0;
+  size_t hi = table->count;
+
+  // line 보다 크지 않은 마지막 항목
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    const at_cmd_entry_t *e = &table->entries[mid];
+
+    if (at_cmd_cmp(e->name, e->name_len, line, len) <= 0) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+
+  // line 의 접두어 p 와 line 사이에 오는 이름은 모두 p 로 시작하므로
+  // 뒤로 가며 처음 만나는 접두어가 가장 긴 일치다 (보통 바로 찾음)
+  while (lo > 0) {
+    const at_cmd_entry_t *e = &table->entries[--lo];
+
+    if (at_cmd_is_prefix(e, line, len)) {
+      return e;
+    }
+    if (len == 0 || e->name[0] != line[0]) {
+      break;
+    }
+  }
+
+  return NULL;
+}
+
+bool at_cmd_dispatch(const at_cmd_table_t *table, void *ctx, const char *line,
+                     size_t len) {
+  const at_cmd_entry_t *e = at_cmd_find(table, line, len);
+
+  if (!e) {
+    return false;
+  }
+
+  e->handler(ctx, line + e->name_len, len - e->name_len);
+  return true;
+}
+
+int at_cmd_table_check(const at_cmd_table_t *table) {
+  for (size_t i = 1; i < table->count; i++) {
+    const at_cmd_entry_t *a = &table->entries[i - 1];
+    const at_cmd_entry_t *b = &table->entries[i];
+
+    if (at_cmd_cmp(a->name, a->name_len, b->name, b->name_len) >= 0) {
+      return (int)i;
+    }
+  }
+
+  return -1;
+}
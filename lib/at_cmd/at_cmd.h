@@ -0,0 +1,115 @@
+#ifndef AT_CMD_H
+#define AT_CMD_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief 커맨드 한 줄 최대 길이 (NUL 포함)
+ */
+#define AT_CMD_LINE_MAX 128
+
+/**
+ * @brief 커맨드 핸들러
+ *
+ * param 은 줄 버퍼 안에서 이름 바로 뒤를 가리키고 NUL 로 끝난다 (복사 없음).
+ * 핸들러가 돌아오면 버퍼는 다음 줄로 재사용되므로 보관하려면 복사한다.
+ *
+ * @param[in] ctx at_cmd_dispatch() 에 넘긴 값
+ * @param[in] param 파라미터 시작
+ * @param[in] len 파라미터 길이
+ */
+typedef void (*at_cmd_handler_t)(void *ctx, const char *param, size_t len);
+
+typedef struct {
+  const char *name;
+  uint8_t name_len; /**< AT_CMD() 가 컴파일 시 채움 */
+  at_cmd_handler_t handler;
+} at_cmd_entry_t;
+
+/**
+ * @brief 이름 순(strcmp)으로 정렬된 커맨드 테이블
+ *
+ * C 에서는 컴파일 시 정렬을 검사할 수 없으므로 소스에 정렬해서 적고
+ * 초기화 때 at_cmd_table_check() 로 확인한다.
+ */
+typedef struct {
+  const at_cmd_entry_t *entries;
+  size_t count;
+} at_cmd_table_t;
+
+#define AT_CMD(name, handler) {(name), sizeof(name) - 1, (handler)}
+#define AT_CMD_TABLE(arr) {(arr), sizeof(arr) / sizeof((arr)[0])}
+
+/**
+ * @brief 길이를 미리 계산해 둔 고정 응답 문자열
+ */
+typedef struct {
+  const char *str;
+  size_t len;
+} at_resp_t;
+
+#define AT_RESP(s) {(s), sizeof(s) - 1}
+
+/**
+ * @brief 줄 버퍼 (BLE, RS485 파서 공용)
+ */
+typedef struct {
+  char data[AT_CMD_LINE_MAX];
+  size_t pos;
+  char prev_char;
+} at_cmd_line_t;
+
+static inline void at_cmd_line_reset(at_cmd_line_t *line) {
+  line->pos = 0;
+  line->data[0] = '\0';
+  line->prev_char = '\0';
+}
+
+/**
+ * @brief 줄 버퍼에 한 글자 추가
+ *
+ * @return false: 버퍼가 가득 참 (줄을 버려야 함)
+ */
+static inline bool at_cmd_line_put(at_cmd_line_t *line, char c) {
+  if (line->pos >= sizeof(line->data) - 1) {
+    return false;
+  }
+  line->data[line->pos++] = c;
+  line->data[line->pos] = '\0';
+  return true;
+}
+
+/**
+ * @brief line 앞부분과 가장 길게 일치하는 커맨드 찾기 (이진 탐색)
+ *
+ * @param[in] table
+ * @param[in] line 커맨드 줄
+ * @param[in] len line 길이
+ * @return 일치하는 항목, 없으면 NULL
+ */
+const at_cmd_entry_t *at_cmd_find(const at_cmd_table_t *table, const char *line,
+                                  size_t len);
+
+/**
+ * @brief 커맨드를 찾아 핸들러 호출
+ *
+ * @param[in] table
+ * @param[in] ctx 핸들러에 넘길 값
+ * @param[in] line NUL 로 끝나는 커맨드 줄
+ * @param[in] len line 길이
+ * @return false: 일치하는 커맨드 없음
+ */
+bool at_cmd_dispatch(const at_cmd_table_t *table, void *ctx, const char *line,
+                     size_t len);
+
+/**
+ * @brief 테이블이 정렬되어 있고 이름이 겹치지 않는지 확인
+ *
+ * @param[in] table
+ * @return 정렬 안 된 첫 항목 index, 정상이면 -1
+ */
+int at_cmd_table_check(const at_cmd_table_t *table);
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef CRC_H
+#define CRC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief CRC32 누적 계산 (reflected, poly 0xEDB88320, init/xorout 없음)
+ *
+ * Unicore binary 프레임 CRC 형식. 초기값 0으로 시작해서 수신한 구간을
+ * 순서대로 넘기면 한번에 계산한 값과 같다.
+ *
+ * @param[in] crc 이전까지 누적된 CRC (처음은 0)
+ * @param[in] buf 데이터
+ * @param[in] len 데이터 길이
+ * @return uint32_t 누적된 CRC
+ */
+uint32_t crc32_update(uint32_t crc, const uint8_t *buf, size_t len);
+
+/**
+ * @brief CRC16-CCITT 누적 계산 (poly 0x1021, 반사 없음)
+ *
+ * 초기값 0xFFFF 로 시작하면 CRC-16/CCITT-FALSE 와 같다.
+ *
+ * @param[in] crc 이전까지 누적된 CRC (처음은 0xFFFF)
+ * @param[in] buf 데이터
+ * @param[in] len 데이터 길이
+ * @return uint16_t 누적된 CRC
+ */
+uint16_t crc16_ccitt_update(uint16_t crc, const uint8_t *buf, size_t len);
+
+/**
+ * @brief CRC16/MODBUS 누적 계산 (reflected, poly 0xA001)
+ *
+ * 초기값 0xFFFF 로 시작한다. 결과는 프레임 끝에 하위 바이트부터 붙는다.
+ *
+ * @param[in] crc 이전까지 누적된 CRC (처음은 0xFFFF)
+ * @param[in] buf 데이터
+ * @param[in] len 데이터 길이
+ * @return uint16_t 누적된 CRC
+ */
+uint16_t crc16_modbus_update(uint16_t crc, const uint8_t *buf, size_t len);
+
+/**
+ * @brief NMEA 체크섬 ('$' 와 '*' 사이 문자의 XOR)
+ *
+ * @param[in] buf '$' 다음 문자부터
+ * @param[in] len '*' 앞까지의 길이
+ * @return uint8_t 체크섬 ("*hh" 로 붙인다)
+ */
+uint8_t nmea_checksum(const char *buf, size_t len);
+
+#endif
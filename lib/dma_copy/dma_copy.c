@@ -0,0 +1,215 @@
+#include "dma_copy.h"
+#include "FreeRTOS.h"
+#include "semphr.h"
+#include "task.h"
+#include "stm32f4xx_ll_bus.h"
+#include "stm32f4xx_ll_dma.h"
+#include <string.h>
+
+#ifndef TAG
+#define TAG "DMA_COPY"
+#endif
+
+#include "log.h"
+
+/* memory-to-memory 는 DMA2 만 가능. 다른 드라이버가 안 쓰는 stream 0 */
+#define DC_DMA DMA2
+#define DC_STREAM LL_DMA_STREAM_0
+#define DC_IRQn DMA2_Stream0_IRQn
+
+#define CCMRAM_START 0x10000000UL
+#define CCMRAM_END 0x10010000UL
+
+/* 한 번에 거는 길이 (byte 단위 전송이어도 NDTR 65535 이하, word 배수) */
+#define DC_CHUNK_MAX 0xFFFCU
+
+/* 1KB 가 수 us 라 넉넉히, 넘으면 중단하고 memcpy */
+#define DC_TIMEOUT_MS 10
+
+static SemaphoreHandle_t dc_lock;     // dma_copy() 호출자 직렬화
+static SemaphoreHandle_t dc_done_sem; // dma_copy() 완료 대기
+static volatile bool dc_busy;
+static volatile bool dc_ok;
+static dma_copy_cb_t dc_cb;
+static void *dc_user_data;
+
+static inline bool dc_reachable(const void *p, size_t len) {
+  uint32_t a = (uint32_t)p;
+
+  return a + len <= CCMRAM_START || a >= CCMRAM_END;
+}
+
+static inline bool dc_can_block(void) {
+  return __get_IPSR() == 0 &&
+         xTaskGetSchedulerState() == taskSCHEDULER_RUNNING;
+}
+
+static void dc_clear_flags(void) {
+  LL_DMA_ClearFlag_TC0(DC_DMA);
+  LL_DMA_ClearFlag_HT0(DC_DMA);
+  LL_DMA_ClearFlag_TE0(DC_DMA);
+  LL_DMA_ClearFlag_DME0(DC_DMA);
+  LL_DMA_ClearFlag_FE0(DC_DMA);
+}
+
+static void dc_abort(void) {
+  LL_DMA_DisableStream(DC_DMA, DC_STREAM);
+  while (LL_DMA_IsEnabledStream(DC_DMA, DC_STREAM))
+    ;
+  dc_clear_flags();
+
+  taskENTER_CRITICAL();
+  dc_cb = NULL;
+  dc_busy = false;
+  taskEXIT_CRITICAL();
+}
+
+void dma_copy_init(void) {
+  if (!dc_lock) {
+    dc_lock = xSemaphoreCreateMutex();
+  }
+  if (!dc_done_sem) {
+    dc_done_sem = xSemaphoreCreateBinary();
+  }
+  if (!dc_lock || !dc_done_sem) {
+    LOG_ERR("DMA copy semaphore create failed");
+  }
+
+  LL_AHB1_GRP1_EnableClock(LL_AHB1_GRP1_PERIPH_DMA2);
+
+  LL_DMA_DisableStream(DC_DMA, DC_STREAM);
+  LL_DMA_SetChannelSelection(DC_DMA, DC_STREAM, LL_DMA_CHANNEL_0);
+  LL_DMA_SetDataTransferDirection(DC_DMA, DC_STREAM,
+                                  LL_DMA_DIRECTION_MEMORY_TO_MEMORY);
+  // UART RX 스트림보다 낮게 (버스를 다투면 수신이 먼저)
+  LL_DMA_SetStreamPriorityLevel(DC_DMA, DC_STREAM, LL_DMA_PRIORITY_LOW);
+  LL_DMA_SetMode(DC_DMA, DC_STREAM, LL_DMA_MODE_NORMAL);
+  LL_DMA_SetPeriphIncMode(DC_DMA, DC_STREAM, LL_DMA_PERIPH_INCREMENT);
+  LL_DMA_SetMemoryIncMode(DC_DMA, DC_STREAM, LL_DMA_MEMORY_INCREMENT);
+  // memory-to-memory 는 direct mode 불가
+  LL_DMA_EnableFifoMode(DC_DMA, DC_STREAM);
+  LL_DMA_SetFIFOThreshold(DC_DMA, DC_STREAM, LL_DMA_FIFOTHRESHOLD_FULL);
+
+  dc_clear_flags();
+  LL_DMA_EnableIT_TC(DC_DMA, DC_STREAM);
+  LL_DMA_EnableIT_TE(DC_DMA, DC_STREAM);
+  LL_DMA_EnableIT_DME(DC_DMA, DC_STREAM);
+
+  NVIC_SetPriority(DC_IRQn, NVIC_EncodePriority(NVIC_GetPriorityGrouping(), 5, 0));
+  NVIC_EnableIRQ(DC_IRQn);
+}
+
+bool dma_copy_async(void *dst, const void *src, size_t len, dma_copy_cb_t cb,
+                    void *user_data) {
+  uint32_t d = (uint32_t)dst;
+  uint32_t s = (uint32_t)src;
+
+  if (len == 0 || len > DC_CHUNK_MAX || !dc_reachable(dst, len) ||
+      !dc_reachable(src, len)) {
+    return false;
+  }
+
+  taskENTER_CRITICAL();
+  if (dc_busy) {
+    taskEXIT_CRITICAL();
+    return false;
+  }
+  dc_busy = true;
+  dc_cb = cb;
+  dc_user_data = user_data;
+  taskEXIT_CRITICAL();
+
+  // source 는 peripheral 포트로 읽는다. 정렬된 쪽만 word 로 (FIFO 가 byte 를 묶어 줌)
+  bool words = (len & 3U) == 0;
+  bool s_word = words && (s & 3U) == 0;
+
+  LL_DMA_SetPeriphSize(DC_DMA, DC_STREAM,
+                       s_word ? LL_DMA_PDATAALIGN_WORD : LL_DMA_PDATAALIGN_BYTE);
+  LL_DMA_SetMemorySize(DC_DMA, DC_STREAM,
+                       (words && (d & 3U) == 0) ? LL_DMA_MDATAALIGN_WORD
+                                                : LL_DMA_MDATAALIGN_BYTE);
+  LL_DMA_SetPeriphAddress(DC_DMA, DC_STREAM, s);
+  LL_DMA_SetMemoryAddress(DC_DMA, DC_STREAM, d);
+  LL_DMA_SetDataLength(DC_DMA, DC_STREAM, s_word ? len / 4U : len);
+  dc_clear_flags();
+  LL_DMA_EnableStream(DC_DMA, DC_STREAM);
+
+  return true;
+}
+
+static void dc_done(bool ok, void *user_data) {
+  BaseType_t woken = pdFALSE;
+
+  (void)user_data;
+  dc_ok = ok;
+  xSemaphoreGiveFromISR(dc_done_sem, &woken);
+  portYIELD_FROM_ISR(woken);
+}
+
+void dma_copy(void *dst, const void *src, size_t len) {
+  uint8_t *d = dst;
+  const uint8_t *s = src;
+
+  if (len < DMA_COPY_MIN_LEN || !dc_lock || !dc_can_block() ||
+      !dc_reachable(dst, len) || !dc_reachable(src, len)) {
+    memcpy(dst, src, len);
+    return;
+  }
+
+  xSemaphoreTake(dc_lock, portMAX_DELAY);
+
+  while (len > 0) {
+    size_t n = len < DC_CHUNK_MAX ? len : DC_CHUNK_MAX;
+
+    // 비동기 사용자가 잡고 있으면 기다리지 않고 CPU 로
+    if (!dma_copy_async(d, s, n, dc_done, NULL)) {
+      memcpy(d, s, len);
+      break;
+    }
+
+    if (xSemaphoreTake(dc_done_sem, pdMS_TO_TICKS(DC_TIMEOUT_MS)) != pdTRUE) {
+      LOG_ERR("DMA copy timeout (%u bytes)", (unsigned)n);
+      dc_abort();
+      // 중단 직전 ISR 이 준 완료 표시가 남아 있으면 버림
+      xSemaphoreTake(dc_done_sem, 0);
+      memcpy(d, s, len);
+      break;
+    }
+
+    if (!dc_ok) {
+      memcpy(d, s, len);
+      break;
+    }
+
+    d += n;
+    s += n;
+    len -= n;
+  }
+
+  xSemaphoreGive(dc_lock);
+}
+
+void DMA2_Stream0_IRQHandler(void) {
+  bool err = LL_DMA_IsActiveFlag_TE0(DC_DMA) || LL_DMA_IsActiveFlag_DME0(DC_DMA);
+  bool tc = LL_DMA_IsActiveFlag_TC0(DC_DMA);
+
+  dc_clear_flags();
+
+  if (!err && !tc) {
+    return;
+  }
+
+  if (err) {
+    LL_DMA_DisableStream(DC_DMA, DC_STREAM);
+  }
+
+  dma_copy_cb_t cb = dc_cb;
+  void *user_data = dc_user_data;
+
+  dc_cb = NULL;
+  dc_busy = false;
+
+  if (cb) {
+    cb(!err, user_data);
+  }
+}
@@ -0,0 +1,61 @@
+#ifndef DMA_COPY_H
+#define DMA_COPY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief DMA2 memory-to-memory 복사 (DMA2 Stream0)
+ *
+ * 킬로바이트 단위 블록을 CPU 대신 DMA 로 옮기고, 그동안 호출 태스크는
+ * 잠들어 다른 태스크 (GPS 파서 등) 가 CPU 를 쓴다. CCM 은 DMA 가 접근할 수
+ * 없으므로 어느 한쪽이라도 CCM 이면, 또는 짧은 복사는 memcpy 로 한다.
+ */
+
+/**
+ * @brief 이보다 짧으면 memcpy (세마포어 대기/깨움 비용이 복사보다 큼)
+ */
+#define DMA_COPY_MIN_LEN 512
+
+/**
+ * @brief 비동기 복사 완료 콜백 (DMA ISR 에서 호출)
+ *
+ * @param[in] ok 정상 완료 여부 (DMA 전송 에러 시 false)
+ * @param[in] user_data
+ */
+typedef void (*dma_copy_cb_t)(bool ok, void *user_data);
+
+/**
+ * @brief 초기화 (스케줄러 시작 전, MX_DMA_Init 이후)
+ */
+void dma_copy_init(void);
+
+/**
+ * @brief 비동기 복사 시작
+ *
+ * 끝나면 ISR 에서 콜백이 불린다. 그 전까지 src/dst 를 건드리면 안 된다.
+ *
+ * @param[out] dst
+ * @param[in] src
+ * @param[in] len 최대 65535 (word 정렬이면 x4)
+ * @param[in] cb
+ * @param[in] user_data
+ * @return true 시작, false DMA 사용 중이거나 DMA 로 옮길 수 없는 구간 (호출자가 memcpy)
+ */
+bool dma_copy_async(void *dst, const void *src, size_t len, dma_copy_cb_t cb,
+                    void *user_data);
+
+/**
+ * @brief 복사 (끝날 때까지 대기)
+ *
+ * 조건이 맞으면 DMA 로 옮기고 완료까지 세마포어로 잠든다. 짧거나 CCM 이거나
+ * 잠들 수 없는 컨텍스트 (ISR, 스케줄러 시작 전) 면 memcpy.
+ *
+ * @param[out] dst
+ * @param[in] src
+ * @param[in] len
+ */
+void dma_copy(void *dst, const void *src, size_t len);
+
+#endif
@@ -0,0 +1,86 @@
+#include "dma_ring.h"
+#include <string.h>
+
+void dma_ring_init(dma_ring_t *r, void *buf, uint32_t size, uint32_t mirror,
+                   uint32_t count) {
+  memset(r, 0, sizeof(*r));
+  r->buf = buf;
+  r->size = size;
+  r->mirror = mirror;
+  r->tail = count % size;
+  r->consumed = count;
+}
+
+uint32_t dma_ring_update(dma_ring_t *r, uint32_t count, uint32_t *lost) {
+  uint32_t pending = count - r->consumed;
+  uint32_t skip = 0;
+
+  uint32_t level = pending < r->size ? pending : r->size;
+
+  if (level > r->stats.peak) {
+    r->stats.peak = level;
+  }
+
+  if (pending >= r->size) {
+    // tail 부터는 이미 덮어써졌다
+    skip = pending - r->size / 2;
+    r->tail = (r->tail + skip) % r->size;
+    r->consumed += skip;
+    pending -= skip;
+    r->stats.overruns++;
+    r->stats.lost += skip;
+  }
+
+  if (lost) {
+    *lost = skip;
+  }
+
+  r->avail = pending;
+  return pending;
+}
+
+uint8_t dma_ring_spans(const dma_ring_t *r, dma_ring_span_t span[2]) {
+  uint32_t first = r->size - r->tail;
+
+  if (r->avail == 0) {
+    return 0;
+  }
+
+  span[0].p = &r->buf[r->tail];
+
+  if (r->avail <= first) {
+    span[0].len = r->avail;
+    return 1;
+  }
+
+  span[0].len = first;
+  span[1].p = r->buf;
+  span[1].len = r->avail - first;
+  return 2;
+}
+
+const uint8_t *dma_ring_linear(dma_ring_t *r) {
+  uint32_t first = r->size - r->tail;
+
+  if (r->avail > first) {
+    uint32_t wrap = r->avail - first;
+
+    if (wrap > r->mirror) {
+      return NULL;
+    }
+    memcpy(&r->buf[r->size], r->buf, wrap);
+  }
+
+  return &r->buf[r->tail];
+}
+
+void dma_ring_consume(dma_ring_t *r, uint32_t n) {
+  if (n > r->avail) {
+    n = r->avail;
+  }
+
+  r->tail = (r->tail + n) % r->size;
+  r->consumed += n;
+  r->avail -= n;
+  r->stats.bytes += n;
+}
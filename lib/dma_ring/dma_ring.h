@@ -0,0 +1,109 @@
+#ifndef DMA_RING_H
+#define DMA_RING_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief circular DMA 수신 링 소비자
+ *
+ * 포트는 DMA 가 지금까지 쓴 누적 byte 수 (count) 만 넘기고, 읽을 구간 계산,
+ * wrap 에서 두 구간으로 나누기, 한 바퀴 이상 밀렸을 때 (overrun) 처리를
+ * 여기서 똑같이 한다. count 는 DMA TC 횟수 * 링 크기 + 현재 위치 이고
+ * dma_ring_count() 로 만든다. 2^32 에서 wrap 해도 차이만 보므로 괜찮다.
+ *
+ * 수신 태스크 하나만 부른다 (잠금 없음).
+ */
+
+typedef struct {
+  const uint8_t *p;
+  size_t len;
+} dma_ring_span_t;
+
+typedef struct {
+  uint32_t bytes;    /**< 소비한 byte */
+  uint32_t overruns; /**< 한 바퀴 이상 밀린 횟수 */
+  uint32_t lost;     /**< 덮어써져 건너뛴 byte */
+  uint32_t peak;     /**< 한 번에 밀려 있던 최대 byte (링 크기면 overrun) */
+} dma_ring_stats_t;
+
+typedef struct {
+  uint8_t *buf;
+  uint32_t size;     /**< DMA 가 도는 길이 */
+  uint32_t mirror;   /**< buf 뒤 여분 (wrap 걸친 구간 이어 붙이기, 0 이면 없음) */
+  uint32_t tail;     /**< 다음에 읽을 위치 */
+  uint32_t consumed; /**< 소비한 누적 count */
+  uint32_t avail;    /**< 마지막 dma_ring_update() 이후 읽을 byte */
+  dma_ring_stats_t stats;
+} dma_ring_t;
+
+/**
+ * @brief 초기화
+ *
+ * @param[out] r
+ * @param[in] buf DMA 링 (mirror 가 있으면 size + mirror 크기)
+ * @param[in] size DMA 전송 길이
+ * @param[in] mirror buf 뒤 여분 크기
+ * @param[in] count 지금 count (그 전에 온 것은 읽지 않음)
+ */
+void dma_ring_init(dma_ring_t *r, void *buf, uint32_t size, uint32_t mirror,
+                   uint32_t count);
+
+/**
+ * @brief 새로 들어온 구간 계산
+ *
+ * 한 바퀴 이상 밀렸으면 이미 덮어써진 부분과 함께 앞쪽을 버리고 최근 절반만
+ * 남긴다 (나머지 절반은 처리하는 동안 DMA 가 쓸 여유).
+ *
+ * @param[inout] r
+ * @param[in] count 포트의 현재 count
+ * @param[out] lost 버린 byte (NULL 가능)
+ * @return uint32_t 읽을 byte
+ */
+uint32_t dma_ring_update(dma_ring_t *r, uint32_t count, uint32_t *lost);
+
+/**
+ * @brief 읽을 구간을 연속 구간으로 (wrap 이면 두 개)
+ *
+ * @return uint8_t 구간 수 (0 ~ 2)
+ */
+uint8_t dma_ring_spans(const dma_ring_t *r, dma_ring_span_t span[2]);
+
+/**
+ * @brief 읽을 구간 전체를 한 덩어리로
+ *
+ * wrap 을 걸치면 링 앞쪽 부분을 buf 뒤 여분에 복사해 이어 붙인다.
+ *
+ * @return const uint8_t* 시작 위치, 여분이 모자라면 NULL
+ */
+const uint8_t *dma_ring_linear(dma_ring_t *r);
+
+/**
+ * @brief 읽은 만큼 넘김
+ *
+ * @param[in] n avail 이하
+ */
+void dma_ring_consume(dma_ring_t *r, uint32_t n);
+
+/**
+ * @brief 포트 count 계산 (ISR 이 TC 마다 laps 를 올림)
+ *
+ * TC 가 났지만 ISR 이 아직 안 돌았으면 (NDTR 은 이미 reload) 한 바퀴를 더한다.
+ * 호출자는 laps 가 읽는 도중 바뀌지 않았는지 확인해서 다시 읽는다.
+ *
+ * @param[in] laps TC 횟수
+ * @param[in] pos 링 크기 - NDTR
+ * @param[in] tc_pending TC 플래그
+ * @param[in] size 링 크기
+ */
+static inline uint32_t dma_ring_count(uint32_t laps, uint32_t pos, bool tc_pending,
+                                      uint32_t size) {
+  if (tc_pending && pos < size / 2) {
+    laps++;
+  }
+
+  return laps * size + pos;
+}
+
+#endif
@@ -4,8 +4,19 @@
  */
 
 #include "event_bus.h"
+#include <stdio.h>
 #include <string.h>
 
+#if EVENT_BUS_HANDLER_TIMING
+#include "stm32f4xx.h"
+#define EVENT_BUS_CYCLES() (DWT->CYCCNT)
+#endif
+
+static const uint32_t lat_bounds_us[EVENT_BUS_LAT_BUCKETS - 1] = EVENT_BUS_LAT_BOUNDS_US;
+
+/* Lane task notification: bit n = latest topic n, top bit = lane queue */
+#define LANE_NOTIFY_QUEUE (1UL << 31)
+
 /* Registry configuration */
 #define MAX_EVENT_BUSES 5
 
@@ -18,14 +29,39 @@ typedef struct {
 /* Global registry */
 static event_bus_registry_entry_t g_registry[MAX_EVENT_BUSES] = {0};
 static SemaphoreHandle_t g_registry_mutex = NULL;
+static StaticSemaphore_t g_registry_mutex_buf;
 
 /* Global event message pool (static allocation) */
 static event_msg_pool_t g_msg_pool = {0};
 static bool g_pool_initialized = false;
 
+/* Per-class static storage */
+static event_msg_t g_msgs_small[EVENT_MSG_SMALL_COUNT];
+static event_msg_t g_msgs_medium[EVENT_MSG_MEDIUM_COUNT];
+static event_msg_t g_msgs_large[EVENT_MSG_LARGE_COUNT];
+static uint8_t g_data_small[EVENT_MSG_SMALL_COUNT][EVENT_MSG_SMALL_SIZE];
+static uint8_t g_data_medium[EVENT_MSG_MEDIUM_COUNT][EVENT_MSG_MEDIUM_SIZE];
+static uint8_t g_data_large[EVENT_MSG_LARGE_COUNT][EVENT_DATA_MAX_SIZE];
+
+/* Static bus storage (RTOS control blocks in SRAM, stacks and queue storage in CCM) */
+typedef struct {
+    event_bus_t bus;
+    StaticSemaphore_t sub_mutex_buf;
+    StaticSemaphore_t lane_mutex_buf[EVENT_BUS_LANE_COUNT];
+    StaticQueue_t lane_queue_buf[EVENT_BUS_LANE_COUNT];
+    StaticTask_t lane_tcb[EVENT_BUS_LANE_COUNT];
+    bool in_use;
+} event_bus_slot_t;
+
+static event_bus_slot_t g_bus_slots[EVENT_BUS_STATIC_COUNT];
+static event_msg_t *g_bus_queue_storage[EVENT_BUS_STATIC_COUNT][EVENT_BUS_LANE_COUNT]
+                                       [EVENT_BUS_QUEUE_DEPTH_MAX] EVENT_BUS_STACK_ATTR;
+static StackType_t g_bus_stacks[EVENT_BUS_STATIC_COUNT][EVENT_BUS_LANE_COUNT]
+                               [EVENT_BUS_TASK_STACK] EVENT_BUS_STACK_ATTR;
+
 /* Forward declarations */
 static void event_dispatch_task(void *pvParameter);
-static event_msg_t* event_msg_alloc(void);
+static event_msg_t* event_msg_alloc(size_t size);
 static void event_msg_free(event_msg_t *msg);
 static void event_msg_pool_init(void);
 
@@ -34,7 +70,22 @@ static void event_msg_pool_init(void);
  */
 static void registry_init(void) {
     if (g_registry_mutex == NULL) {
-        g_registry_mutex = xSemaphoreCreateMutex();
+        g_registry_mutex = xSemaphoreCreateMutexStatic(&g_registry_mutex_buf);
+    }
+}
+
+/* Lock-free helpers (LDREX/STREX on Cortex-M, safe from ISR) */
+#define POOL_LOAD(p) __atomic_load_n((p), __ATOMIC_RELAXED)
+#define POOL_INC(p) __atomic_add_fetch((p), 1, __ATOMIC_RELAXED)
+#define POOL_DEC(p) __atomic_sub_fetch((p), 1, __ATOMIC_RELAXED)
+
+/**
+ * @brief Raise a peak counter to v if it is lower
+ */
+static inline void pool_peak_update(uint32_t *peak, uint32_t v) {
+    uint32_t p = POOL_LOAD(peak);
+    while (v > p &&
+           !__atomic_compare_exchange_n(peak, &p, v, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
     }
 }
 
@@ -46,71 +97,126 @@ static void event_msg_pool_init(void) {
         return;
     }
 
-    g_msg_pool.mutex = xSemaphoreCreateMutex();
     g_msg_pool.allocated = 0;
     g_msg_pool.peak = 0;
     g_msg_pool.failures = 0;
 
-    // Initialize all messages as free
-    for (int i = 0; i < EVENT_MSG_POOL_SIZE; i++) {
-        g_msg_pool.pool[i].in_use = false;
+    g_msg_pool.cls[EVENT_MSG_CLASS_SMALL] = (event_msg_class_t){
+        .msgs = g_msgs_small, .data = &g_data_small[0][0],
+        .data_size = EVENT_MSG_SMALL_SIZE, .count = EVENT_MSG_SMALL_COUNT,
+    };
+    g_msg_pool.cls[EVENT_MSG_CLASS_MEDIUM] = (event_msg_class_t){
+        .msgs = g_msgs_medium, .data = &g_data_medium[0][0],
+        .data_size = EVENT_MSG_MEDIUM_SIZE, .count = EVENT_MSG_MEDIUM_COUNT,
+    };
+    g_msg_pool.cls[EVENT_MSG_CLASS_LARGE] = (event_msg_class_t){
+        .msgs = g_msgs_large, .data = &g_data_large[0][0],
+        .data_size = EVENT_DATA_MAX_SIZE, .count = EVENT_MSG_LARGE_COUNT,
+    };
+
+    // Initialize all messages as free, each bound to its data slot
+    for (int c = 0; c < EVENT_MSG_CLASS_COUNT; c++) {
+        event_msg_class_t *cls = &g_msg_pool.cls[c];
+        for (uint32_t i = 0; i < cls->count; i++) {
+            cls->msgs[i].data = &cls->data[i * cls->data_size];
+            cls->msgs[i].cls = (uint8_t)c;
+            cls->msgs[i].in_use = false;
+        }
+        cls->free_mask = cls->count == 32 ? 0xFFFFFFFFu : (1u << cls->count) - 1;
     }
 
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
     g_pool_initialized = true;
 }
 
+/**
+ * @brief Take the lowest free slot of a class
+ *
+ * @param cls Size class
+ * @return event_msg_t* Message, NULL if the class is empty
+ */
+static event_msg_t* event_class_take(event_msg_class_t *cls) {
+    uint32_t mask = POOL_LOAD(&cls->free_mask);
+    uint32_t idx;
+
+    do {
+        if (mask == 0) {
+            return NULL;
+        }
+        idx = (uint32_t)__builtin_ctz(mask);
+        // Clearing the lowest set bit claims slot idx
+    } while (!__atomic_compare_exchange_n(&cls->free_mask, &mask, mask & (mask - 1), true,
+                                          __ATOMIC_ACQUIRE, __ATOMIC_RELAXED));
+
+    return &cls->msgs[idx];
+}
+
 /**
  * @brief Allocate an event message from the pool
  *
+ * Tries the smallest class that fits size first, then larger ones.
+ * Constant time and never blocks, so it may be called from an ISR.
+ *
+ * @param size Payload size
  * @return event_msg_t* Allocated message, NULL if pool exhausted
  */
-static event_msg_t* event_msg_alloc(void) {
+static event_msg_t* event_msg_alloc(size_t size) {
     if (!g_pool_initialized) {
         return NULL;
     }
 
-    xSemaphoreTake(g_msg_pool.mutex, portMAX_DELAY);
-
-    // Find free message
     event_msg_t *msg = NULL;
-    for (int i = 0; i < EVENT_MSG_POOL_SIZE; i++) {
-        if (!g_msg_pool.pool[i].in_use) {
-            msg = &g_msg_pool.pool[i];
-            msg->in_use = true;
-            g_msg_pool.allocated++;
-
-            // Update peak
-            if (g_msg_pool.allocated > g_msg_pool.peak) {
-                g_msg_pool.peak = g_msg_pool.allocated;
-            }
-            break;
+    event_msg_class_t *fit = NULL;
+    for (int c = 0; c < EVENT_MSG_CLASS_COUNT; c++) {
+        event_msg_class_t *cls = &g_msg_pool.cls[c];
+        if (size > cls->data_size) {
+            continue;
+        }
+        if (!fit) {
+            fit = cls;
         }
-    }
 
-    if (!msg) {
-        g_msg_pool.failures++;
+        msg = event_class_take(cls);
+        if (!msg) {
+            POOL_INC(&cls->failures);
+            continue;
+        }
+
+        msg->in_use = true;
+        msg->refcnt = 1;
+        pool_peak_update(&cls->peak, POOL_INC(&cls->allocated));
+        pool_peak_update(&g_msg_pool.peak, POOL_INC(&g_msg_pool.allocated));
+        if (cls != fit) {
+            POOL_INC(&fit->spills);
+        }
+        return msg;
     }
 
-    xSemaphoreGive(g_msg_pool.mutex);
-    return msg;
+    POOL_INC(&g_msg_pool.failures);
+    return NULL;
 }
 
 /**
- * @brief Free an event message back to the pool
+ * @brief Drop one reference; the last one returns the message to the pool
  *
  * @param msg Message to free
  */
 static void event_msg_free(event_msg_t *msg) {
-    if (!msg || !g_pool_initialized) {
+    if (!msg || !g_pool_initialized || msg->cls >= EVENT_MSG_CLASS_COUNT) {
         return;
     }
 
-    xSemaphoreTake(g_msg_pool.mutex, portMAX_DELAY);
+    if (__atomic_sub_fetch(&msg->refcnt, 1, __ATOMIC_ACQ_REL) != 0) {
+        return;  // Still held by a subscriber
+    }
 
-    msg->in_use = false;
-    g_msg_pool.allocated--;
+    event_msg_class_t *cls = &g_msg_pool.cls[msg->cls];
+    uint32_t idx = (uint32_t)(msg - cls->msgs);
 
-    xSemaphoreGive(g_msg_pool.mutex);
+    msg->in_use = false;
+    POOL_DEC(&cls->allocated);
+    POOL_DEC(&g_msg_pool.allocated);
+    __atomic_fetch_or(&cls->free_mask, 1u << idx, __ATOMIC_RELEASE);
 }
 
 /* ==================== Registry Functions ==================== */
@@ -191,8 +297,46 @@ event_bus_t* event_bus_default(void) {
 
 /* ==================== Event Bus Functions ==================== */
 
+/**
+ * @brief Delete the RTOS objects of all lanes (NULL-safe)
+ */
+static void event_bus_free_lanes(event_bus_t *bus) {
+    for (int l = 0; l < EVENT_BUS_LANE_COUNT; l++) {
+        event_bus_lane_t *lane = &bus->lanes[l];
+
+        if (lane->task) {
+            vTaskDelete(lane->task);
+            lane->task = NULL;
+        }
+
+        // Delete queue (drain it first)
+        if (lane->queue) {
+            event_msg_t *msg;
+            while (xQueueReceive(lane->queue, &msg, 0) == pdTRUE) {
+                if (msg) {
+                    event_msg_free(msg);
+                }
+            }
+            vQueueDelete(lane->queue);
+            lane->queue = NULL;
+        }
+
+        if (lane->mutex) {
+            vSemaphoreDelete(lane->mutex);
+            lane->mutex = NULL;
+        }
+
+        for (uint32_t i = 0; i < EVENT_BUS_MAX_LATEST; i++) {
+            event_msg_t *msg = __atomic_exchange_n(&bus->latest[i].pending[l], NULL, __ATOMIC_ACQ_REL);
+            if (msg) {
+                event_msg_free(msg);
+            }
+        }
+    }
+}
+
 event_bus_t* event_bus_create(const char *name, uint32_t queue_depth, uint32_t task_priority) {
-    if (!name || queue_depth == 0) {
+    if (!name || queue_depth == 0 || queue_depth > EVENT_BUS_QUEUE_DEPTH_MAX) {
         return NULL;
     }
 
@@ -201,66 +345,59 @@ event_bus_t* event_bus_create(const char *name, uint32_t queue_depth, uint32_t t
         event_msg_pool_init();
     }
 
-    // Allocate bus structure
-    event_bus_t *bus = (event_bus_t*)pvPortMalloc(sizeof(event_bus_t));
-    if (!bus) {
+    // Claim a static bus slot
+    int idx = -1;
+    taskENTER_CRITICAL();
+    for (int i = 0; i < EVENT_BUS_STATIC_COUNT; i++) {
+        if (!g_bus_slots[i].in_use) {
+            g_bus_slots[i].in_use = true;
+            idx = i;
+            break;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    if (idx < 0) {
         return NULL;
     }
 
+    event_bus_slot_t *slot = &g_bus_slots[idx];
+    event_bus_t *bus = &slot->bus;
+
     memset(bus, 0, sizeof(event_bus_t));
 
     // Initialize fields
     bus->name = name;
     bus->queue_depth = queue_depth;
-    bus->running = false;
-    bus->sub_count = 0;
-    bus->publish_success = 0;
-    bus->publish_failed = 0;
+    bus->running = true;
+    bus->stats_since = xTaskGetTickCount();
 
-    // Initialize subscriber array
-    for (int i = 0; i < EVENT_BUS_MAX_SUBSCRIBERS; i++) {
-        bus->subscribers[i].active = false;
-        bus->subscribers[i].handler = NULL;
-        bus->subscribers[i].event_mask = 0;
-    }
+    // Create mutex for subscriber list
+    bus->sub_mutex = xSemaphoreCreateMutexStatic(&slot->sub_mutex_buf);
 
-    // Create queue (stores pointers to event_msg_t)
-    bus->queue = xQueueCreate(queue_depth, sizeof(event_msg_t*));
-    if (!bus->queue) {
-        vPortFree(bus);
-        return NULL;
-    }
+    // Create one queue, mutex and dispatch task per lane
+    for (int l = 0; l < EVENT_BUS_LANE_COUNT; l++) {
+        event_bus_lane_t *lane = &bus->lanes[l];
+        uint32_t prio = task_priority;
+        char task_name[16];
 
-    // Create mutex for subscriber list
-    bus->sub_mutex = xSemaphoreCreateMutex();
-    if (!bus->sub_mutex) {
-        vQueueDelete(bus->queue);
-        vPortFree(bus);
-        return NULL;
-    }
+        lane->bus = bus;
+        lane->id = (uint8_t)l;
 
-    // Create dispatch task
-    char task_name[16];
-    snprintf(task_name, sizeof(task_name), "evbus_%s", name);
+        if (l == EVENT_BUS_LANE_LOW && prio > tskIDLE_PRIORITY + 1) {
+            prio--;
+        }
 
-    BaseType_t ret = xTaskCreate(
-        event_dispatch_task,
-        task_name,
-        512,  // Stack size
-        bus,  // Parameter
-        task_priority,
-        &bus->dispatch_task
-    );
+        lane->queue = xQueueCreateStatic(queue_depth, sizeof(event_msg_t*),
+                                         (uint8_t*)g_bus_queue_storage[idx][l],
+                                         &slot->lane_queue_buf[l]);
+        lane->mutex = xSemaphoreCreateMutexStatic(&slot->lane_mutex_buf[l]);
+        snprintf(task_name, sizeof(task_name), "evbus_%s%c", name, l == EVENT_BUS_LANE_HIGH ? 'H' : 'L');
 
-    if (ret != pdPASS) {
-        vSemaphoreDelete(bus->sub_mutex);
-        vQueueDelete(bus->queue);
-        vPortFree(bus);
-        return NULL;
+        lane->task = xTaskCreateStatic(event_dispatch_task, task_name, EVENT_BUS_TASK_STACK,
+                                       lane, prio, g_bus_stacks[idx][l], &slot->lane_tcb[l]);
     }
 
-    bus->running = true;
-
     // Register in global registry
     event_bus_register(name, bus);
 
@@ -275,35 +412,53 @@ void event_bus_destroy(event_bus_t *bus) {
     // Unregister from registry
     event_bus_unregister(bus->name);
 
-    // Stop dispatch task
+    // Stop dispatch tasks, delete lane queues and mutexes
     bus->running = false;
-    if (bus->dispatch_task) {
-        vTaskDelete(bus->dispatch_task);
-        bus->dispatch_task = NULL;
-    }
-
-    // Delete queue (drain it first)
-    if (bus->queue) {
-        event_msg_t *msg;
-        while (xQueueReceive(bus->queue, &msg, 0) == pdTRUE) {
-            if (msg) {
-                event_msg_free(msg);
-            }
-        }
-        vQueueDelete(bus->queue);
-    }
+    event_bus_free_lanes(bus);
 
     // Delete mutex
     if (bus->sub_mutex) {
         vSemaphoreDelete(bus->sub_mutex);
+        bus->sub_mutex = NULL;
+    }
+
+    // Release the static slot (bus is its first member)
+    ((event_bus_slot_t*)bus)->in_use = false;
+}
+
+/**
+ * @brief Rebuild the per-lane event masks (sub_mutex held)
+ *
+ * Publish reads these without locking to skip lanes nobody listens on.
+ */
+static void event_bus_update_lane_masks(event_bus_t *bus) {
+    uint32_t mask[EVENT_BUS_LANE_COUNT] = {0};
+    bool all[EVENT_BUS_LANE_COUNT] = {false};
+
+    for (int i = 0; i < EVENT_BUS_MAX_SUBSCRIBERS; i++) {
+        subscriber_t *sub = &bus->subscribers[i];
+        if (!sub->active) {
+            continue;
+        }
+        if (sub->event_mask == 0) {
+            all[sub->lane] = true;
+        }
+        mask[sub->lane] |= sub->event_mask;
     }
 
-    // Free bus structure
-    vPortFree(bus);
+    for (int l = 0; l < EVENT_BUS_LANE_COUNT; l++) {
+        bus->lanes[l].event_mask = mask[l];
+        bus->lanes[l].all_events = all[l];
+    }
 }
 
 bool event_bus_subscribe(event_bus_t *bus, uint32_t event_mask, event_handler_t handler) {
-    if (!bus || !handler) {
+    return event_bus_subscribe_lane(bus, event_mask, handler, EVENT_BUS_LANE_HIGH);
+}
+
+bool event_bus_subscribe_lane(event_bus_t *bus, uint32_t event_mask, event_handler_t handler,
+                              event_bus_lane_id_t lane) {
+    if (!bus || !handler || lane >= EVENT_BUS_LANE_COUNT) {
         return false;
     }
 
@@ -312,16 +467,29 @@ bool event_bus_subscribe(event_bus_t *bus, uint32_t event_mask, event_handler_t
     // Find empty slot
     bool subscribed = false;
     for (int i = 0; i < EVENT_BUS_MAX_SUBSCRIBERS; i++) {
-        if (!bus->subscribers[i].active) {
-            bus->subscribers[i].event_mask = event_mask;
-            bus->subscribers[i].handler = handler;
-            bus->subscribers[i].active = true;
+        subscriber_t *sub = &bus->subscribers[i];
+        if (!sub->active) {
+            // The lane's dispatch task may be scanning the array right now
+            xSemaphoreTake(bus->lanes[lane].mutex, portMAX_DELAY);
+            sub->event_mask = event_mask;
+            sub->handler = handler;
+            sub->lane = (uint8_t)lane;
+            sub->calls = 0;
+            sub->cycles_max = 0;
+            sub->cycles_total = 0;
+            sub->active = true;
+            xSemaphoreGive(bus->lanes[lane].mutex);
+
             bus->sub_count++;
             subscribed = true;
             break;
         }
     }
 
+    if (subscribed) {
+        event_bus_update_lane_masks(bus);
+    }
+
     xSemaphoreGive(bus->sub_mutex);
     return subscribed;
 }
@@ -335,57 +503,284 @@ bool event_bus_unsubscribe(event_bus_t *bus, event_handler_t handler) {
 
     bool unsubscribed = false;
     for (int i = 0; i < EVENT_BUS_MAX_SUBSCRIBERS; i++) {
-        if (bus->subscribers[i].active && bus->subscribers[i].handler == handler) {
-            bus->subscribers[i].active = false;
-            bus->subscribers[i].handler = NULL;
+        subscriber_t *sub = &bus->subscribers[i];
+        if (sub->active && sub->handler == handler) {
+            SemaphoreHandle_t lane_mutex = bus->lanes[sub->lane].mutex;
+
+            // Wait for a running handler of that lane to return
+            xSemaphoreTake(lane_mutex, portMAX_DELAY);
+            sub->active = false;
+            sub->handler = NULL;
+            xSemaphoreGive(lane_mutex);
+
             bus->sub_count--;
             unsubscribed = true;
             break;
         }
     }
 
+    if (unsubscribed) {
+        event_bus_update_lane_masks(bus);
+    }
+
     xSemaphoreGive(bus->sub_mutex);
     return unsubscribed;
 }
 
-bool event_bus_publish(event_bus_t *bus, uint32_t type, const void *data, size_t size) {
+bool event_bus_has_subscriber(event_bus_t *bus, uint32_t type) {
     if (!bus) {
         return false;
     }
 
+    uint32_t bit = type < 32 ? (1u << type) : 0;
+    for (int l = 0; l < EVENT_BUS_LANE_COUNT; l++) {
+        if (bus->lanes[l].all_events || (POOL_LOAD(&bus->lanes[l].event_mask) & bit)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool event_bus_get_subscriber_stats(event_bus_t *bus, event_handler_t handler,
+                                    subscriber_t *out) {
+    if (!bus || !handler || !out) {
+        return false;
+    }
+
+    bool found = false;
+    xSemaphoreTake(bus->sub_mutex, portMAX_DELAY);
+
+    for (int i = 0; i < EVENT_BUS_MAX_SUBSCRIBERS; i++) {
+        subscriber_t *sub = &bus->subscribers[i];
+        if (sub->active && sub->handler == handler) {
+            xSemaphoreTake(bus->lanes[sub->lane].mutex, portMAX_DELAY);
+            *out = *sub;
+            xSemaphoreGive(bus->lanes[sub->lane].mutex);
+            found = true;
+            break;
+        }
+    }
+
+    xSemaphoreGive(bus->sub_mutex);
+    return found;
+}
+
+/**
+ * @brief Queue a filled message on every lane that has a matching subscriber
+ *
+ * Each lane holds its own reference; the publisher's reference is dropped
+ * here, so a message nobody listens to goes straight back to the pool.
+ *
+ * @param woken NULL from a task, otherwise the ISR woken flag
+ */
+static bool event_bus_deliver(event_bus_t *bus, event_msg_t *msg, BaseType_t *woken) {
+    uint32_t bit = msg->type < 32 ? (1u << msg->type) : 0;
+    event_latest_t *latest = NULL;
+    uint32_t latest_idx = 0;
+    bool ok = true;
+
+    if (msg->type < EVENT_BUS_MAX_TYPES) {
+        POOL_INC(&bus->type_count[msg->type]);
+    }
+
+    if (POOL_LOAD(&bus->latest_mask) & bit) {
+        for (uint32_t i = 0; i < EVENT_BUS_MAX_LATEST; i++) {
+            if (bus->latest[i].type == msg->type) {
+                latest = &bus->latest[i];
+                latest_idx = i;
+                break;
+            }
+        }
+    }
+
+    for (int l = 0; l < EVENT_BUS_LANE_COUNT; l++) {
+        event_bus_lane_t *lane = &bus->lanes[l];
+        uint32_t notify = LANE_NOTIFY_QUEUE;
+        BaseType_t sent = pdTRUE;
+
+        if (!lane->all_events && !(POOL_LOAD(&lane->event_mask) & bit)) {
+            continue;
+        }
+
+        __atomic_add_fetch(&msg->refcnt, 1, __ATOMIC_RELAXED);
+
+        if (latest) {
+            // Replace the unread sample; the lane only ever sees the newest
+            event_msg_t *old = __atomic_exchange_n(&latest->pending[l], msg, __ATOMIC_ACQ_REL);
+            if (old) {
+                event_msg_free(old);
+                POOL_INC(&latest->coalesced);
+            }
+            notify = 1UL << latest_idx;
+        } else {
+            // Queue the message (pointer only)
+            sent = woken ? xQueueSendFromISR(lane->queue, &msg, woken)
+                         : xQueueSend(lane->queue, &msg, 0);
+        }
+
+        if (sent != pdTRUE) {
+            // Queue full
+            event_msg_free(msg);
+            ok = false;
+            continue;
+        }
+
+        if (!latest) {
+            UBaseType_t depth = woken ? uxQueueMessagesWaitingFromISR(lane->queue)
+                                      : uxQueueMessagesWaiting(lane->queue);
+            pool_peak_update(&lane->queue_peak, (uint32_t)depth);
+        }
+
+        if (woken) {
+            xTaskNotifyFromISR(lane->task, notify, eSetBits, woken);
+        } else {
+            xTaskNotify(lane->task, notify, eSetBits);
+        }
+    }
+
+    event_msg_free(msg);
+    POOL_INC(ok ? &bus->publish_success : &bus->publish_failed);
+    return ok;
+}
+
+bool event_bus_set_latest(event_bus_t *bus, uint32_t type) {
+    if (!bus || type >= 32) {
+        return false;
+    }
+
+    bool ok = false;
+    xSemaphoreTake(bus->sub_mutex, portMAX_DELAY);
+
+    if (bus->latest_mask & (1u << type)) {
+        ok = true;
+    } else if (bus->latest_count < EVENT_BUS_MAX_LATEST) {
+        event_latest_t *latest = &bus->latest[bus->latest_count++];
+        memset(latest, 0, sizeof(*latest));
+        latest->type = type;
+        __atomic_fetch_or(&bus->latest_mask, 1u << type, __ATOMIC_RELEASE);
+        ok = true;
+    }
+
+    xSemaphoreGive(bus->sub_mutex);
+    return ok;
+}
+
+/**
+ * @brief Take a message from the pool and fill it
+ */
+static event_msg_t* event_msg_prepare(uint32_t type, const void *data, size_t size,
+                                      uint32_t timestamp) {
     // Check size limit
     if (size > EVENT_DATA_MAX_SIZE) {
-        bus->publish_failed++;
-        return false;
+        return NULL;
     }
 
     // Allocate message from pool
-    event_msg_t *msg = event_msg_alloc();
+    event_msg_t *msg = event_msg_alloc(size);
     if (!msg) {
-        bus->publish_failed++;
-        return false;  // Pool exhausted
+        return NULL;  // Pool exhausted
     }
 
     // Fill message
     msg->type = type;
-    msg->timestamp = xTaskGetTickCount();
+    msg->timestamp = timestamp;
+#if EVENT_BUS_HANDLER_TIMING
+    msg->stamp_cycles = EVENT_BUS_CYCLES();
+#endif
     msg->size = size;
 
-    // Copy event data to static buffer
+    // Copy event data to the class buffer
     if (data && size > 0) {
         memcpy(msg->data, data, size);
     }
 
-    // Queue the message (pointer only)
-    if (xQueueSend(bus->queue, &msg, 0) != pdTRUE) {
-        // Queue full
-        event_msg_free(msg);
-        bus->publish_failed++;
+    return msg;
+}
+
+bool event_bus_publish(event_bus_t *bus, uint32_t type, const void *data, size_t size) {
+    if (!bus) {
+        return false;
+    }
+
+    event_msg_t *msg = event_msg_prepare(type, data, size, xTaskGetTickCount());
+    if (!msg) {
+        POOL_INC(&bus->publish_failed);
         return false;
     }
 
-    bus->publish_success++;
-    return true;
+    return event_bus_deliver(bus, msg, NULL);
+}
+
+event_msg_t* event_bus_loan(event_bus_t *bus, size_t size) {
+    if (!bus || size > EVENT_DATA_MAX_SIZE) {
+        return NULL;
+    }
+
+    event_msg_t *msg = event_msg_alloc(size);
+    if (!msg) {
+        POOL_INC(&bus->publish_failed);
+        return NULL;
+    }
+
+    msg->size = size;
+    return msg;
+}
+
+bool event_bus_commit(event_bus_t *bus, event_msg_t *msg, uint32_t type) {
+    if (!bus || !msg) {
+        return false;
+    }
+
+    msg->type = type;
+    msg->timestamp = xTaskGetTickCount();
+#if EVENT_BUS_HANDLER_TIMING
+    msg->stamp_cycles = EVENT_BUS_CYCLES();
+#endif
+
+    return event_bus_deliver(bus, msg, NULL);
+}
+
+void event_bus_loan_cancel(event_msg_t *msg) {
+    event_msg_free(msg);
+}
+
+void event_bus_msg_retain(const event_msg_t *msg) {
+    if (msg) {
+        __atomic_add_fetch(&((event_msg_t *)msg)->refcnt, 1, __ATOMIC_RELAXED);
+    }
+}
+
+void event_bus_msg_release(const event_msg_t *msg) {
+    event_msg_free((event_msg_t *)msg);
+}
+
+bool event_bus_publish_from_isr(event_bus_t *bus, uint32_t type, const void *data, size_t size,
+                                BaseType_t *higher_prio_woken) {
+    BaseType_t woken = pdFALSE;
+    bool ok = false;
+
+    if (!bus) {
+        return false;
+    }
+
+    event_msg_t *msg = event_msg_prepare(type, data, size, xTaskGetTickCountFromISR());
+    if (msg) {
+        ok = event_bus_deliver(bus, msg, &woken);
+    } else {
+        POOL_INC(&bus->publish_failed);
+    }
+
+    if (higher_prio_woken) {
+        // Caller yields once at the end of its own ISR
+        if (woken == pdTRUE) {
+            *higher_prio_woken = pdTRUE;
+        }
+    } else {
+        portYIELD_FROM_ISR(woken);
+    }
+
+    return ok;
 }
 
 bool event_bus_start(event_bus_t *bus) {
@@ -418,59 +813,193 @@ void event_bus_get_stats(event_bus_t *bus, uint32_t *sub_count,
     if (publish_failed) *publish_failed = bus->publish_failed;
 }
 
+bool event_bus_get_detail_stats(event_bus_t *bus, event_bus_stats_t *out) {
+    if (!bus || !out) {
+        return false;
+    }
+
+    out->elapsed_ms = (xTaskGetTickCount() - bus->stats_since) * portTICK_PERIOD_MS;
+    out->publish_success = POOL_LOAD(&bus->publish_success);
+    out->publish_failed = POOL_LOAD(&bus->publish_failed);
+    memcpy(out->type_count, bus->type_count, sizeof(out->type_count));
+
+    out->coalesced = 0;
+    for (uint32_t i = 0; i < EVENT_BUS_MAX_LATEST; i++) {
+        out->coalesced += POOL_LOAD(&bus->latest[i].coalesced);
+    }
+
+    for (int l = 0; l < EVENT_BUS_LANE_COUNT; l++) {
+        event_bus_lane_t *lane = &bus->lanes[l];
+        out->lanes[l].dispatched = lane->dispatched;
+        out->lanes[l].queue_depth = lane->queue ? (uint32_t)uxQueueMessagesWaiting(lane->queue) : 0;
+        out->lanes[l].queue_peak = POOL_LOAD(&lane->queue_peak);
+        out->lanes[l].lat_max_us = lane->lat_max_us;
+        memcpy(out->lanes[l].lat_hist, lane->lat_hist, sizeof(out->lanes[l].lat_hist));
+    }
+
+    return true;
+}
+
+void event_bus_reset_stats(event_bus_t *bus) {
+    if (!bus) {
+        return;
+    }
+
+    xSemaphoreTake(bus->sub_mutex, portMAX_DELAY);
+
+    // Lane counters are written by the lane task with its mutex held
+    for (int l = 0; l < EVENT_BUS_LANE_COUNT; l++) {
+        event_bus_lane_t *lane = &bus->lanes[l];
+        xSemaphoreTake(lane->mutex, portMAX_DELAY);
+        lane->dispatched = 0;
+        lane->queue_peak = 0;
+        lane->lat_max_us = 0;
+        memset(lane->lat_hist, 0, sizeof(lane->lat_hist));
+
+        for (int i = 0; i < EVENT_BUS_MAX_SUBSCRIBERS; i++) {
+            subscriber_t *sub = &bus->subscribers[i];
+            if (sub->lane == l) {
+                sub->calls = 0;
+                sub->cycles_max = 0;
+                sub->cycles_total = 0;
+            }
+        }
+        xSemaphoreGive(lane->mutex);
+    }
+
+    for (uint32_t i = 0; i < EVENT_BUS_MAX_LATEST; i++) {
+        bus->latest[i].coalesced = 0;
+    }
+    memset(bus->type_count, 0, sizeof(bus->type_count));
+    bus->publish_success = 0;
+    bus->publish_failed = 0;
+    bus->stats_since = xTaskGetTickCount();
+
+    xSemaphoreGive(bus->sub_mutex);
+
+    if (g_pool_initialized) {
+        g_msg_pool.peak = POOL_LOAD(&g_msg_pool.allocated);
+        g_msg_pool.failures = 0;
+        for (int c = 0; c < EVENT_MSG_CLASS_COUNT; c++) {
+            event_msg_class_t *cls = &g_msg_pool.cls[c];
+            cls->peak = POOL_LOAD(&cls->allocated);
+            cls->failures = 0;
+            cls->spills = 0;
+        }
+    }
+}
+
 void event_bus_get_pool_stats(uint32_t *allocated, uint32_t *peak, uint32_t *failures) {
     if (!g_pool_initialized) {
         return;
     }
 
-    xSemaphoreTake(g_msg_pool.mutex, portMAX_DELAY);
+    if (allocated) *allocated = POOL_LOAD(&g_msg_pool.allocated);
+    if (peak) *peak = POOL_LOAD(&g_msg_pool.peak);
+    if (failures) *failures = POOL_LOAD(&g_msg_pool.failures);
+}
 
-    if (allocated) *allocated = g_msg_pool.allocated;
-    if (peak) *peak = g_msg_pool.peak;
-    if (failures) *failures = g_msg_pool.failures;
+bool event_bus_get_class_stats(event_msg_class_id_t cls, event_msg_class_t *stats) {
+    if (!g_pool_initialized || !stats || cls >= EVENT_MSG_CLASS_COUNT) {
+        return false;
+    }
+
+    // Counters are read one by one, so they may be off by an in-flight publish
+    *stats = g_msg_pool.cls[cls];
 
-    xSemaphoreGive(g_msg_pool.mutex);
+    return true;
 }
 
 /**
- * @brief Event dispatch task
+ * @brief Run one message through a lane's subscribers
+ */
+static void event_lane_dispatch(event_bus_lane_t *lane, event_msg_t *msg) {
+    event_bus_t *bus = lane->bus;
+    uint32_t bit = msg->type < 32 ? (1u << msg->type) : 0;
+    uint32_t lat_us;
+
+#if EVENT_BUS_HANDLER_TIMING
+    lat_us = (EVENT_BUS_CYCLES() - msg->stamp_cycles) / (SystemCoreClock / 1000000U);
+#else
+    lat_us = (xTaskGetTickCount() - msg->timestamp) * portTICK_PERIOD_MS * 1000U;
+#endif
+
+    uint32_t b = 0;
+    while (b < EVENT_BUS_LAT_BUCKETS - 1 && lat_us >= lat_bounds_us[b]) {
+        b++;
+    }
+    lane->lat_hist[b]++;
+    if (lat_us > lane->lat_max_us) {
+        lane->lat_max_us = lat_us;
+    }
+    lane->dispatched++;
+
+    // Dispatch to all matching subscribers of this lane
+    xSemaphoreTake(lane->mutex, portMAX_DELAY);
+
+    for (int i = 0; i < EVENT_BUS_MAX_SUBSCRIBERS; i++) {
+        subscriber_t *sub = &bus->subscribers[i];
+
+        if (!sub->active || sub->lane != lane->id || !sub->handler) {
+            continue;
+        }
+
+        // Check if subscriber is interested in this event type
+        if (sub->event_mask == 0 || (sub->event_mask & bit)) {
+#if EVENT_BUS_HANDLER_TIMING
+            uint32_t start = EVENT_BUS_CYCLES();
+            sub->handler(msg);
+            uint32_t cycles = EVENT_BUS_CYCLES() - start;
+
+            sub->cycles_total += cycles;
+            if (cycles > sub->cycles_max) {
+                sub->cycles_max = cycles;
+            }
+#else
+            sub->handler(msg);
+#endif
+            sub->calls++;
+        }
+    }
+
+    xSemaphoreGive(lane->mutex);
+
+    // Drop this lane's reference
+    event_msg_free(msg);
+}
+
+/**
+ * @brief Event dispatch task (one per lane)
  *
- * Receives events from queue and dispatches to subscribers.
+ * Woken by task notification: the top bit for queued events, the low bits
+ * for latest-value topics. Queued events go first, in publish order.
  */
 static void event_dispatch_task(void *pvParameter) {
-    event_bus_t *bus = (event_bus_t*)pvParameter;
+    event_bus_lane_t *lane = (event_bus_lane_t*)pvParameter;
+    event_bus_t *bus = lane->bus;
     event_msg_t *msg;
+    uint32_t bits;
 
     while (bus->running) {
         // Wait for event (blocking)
-        if (xQueueReceive(bus->queue, &msg, portMAX_DELAY) == pdTRUE) {
-            if (!msg) {
-                continue;
-            }
-
-            // Dispatch to all matching subscribers
-            xSemaphoreTake(bus->sub_mutex, portMAX_DELAY);
-
-            for (int i = 0; i < EVENT_BUS_MAX_SUBSCRIBERS; i++) {
-                subscriber_t *sub = &bus->subscribers[i];
-
-                if (!sub->active) {
-                    continue;
-                }
+        if (xTaskNotifyWait(0, UINT32_MAX, &bits, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
 
-                // Check if subscriber is interested in this event type
-                if (sub->event_mask == 0 || (sub->event_mask & (1 << msg->type))) {
-                    // Call handler
-                    if (sub->handler) {
-                        sub->handler(msg);
-                    }
-                }
+        while (xQueueReceive(lane->queue, &msg, 0) == pdTRUE) {
+            if (msg) {
+                event_lane_dispatch(lane, msg);
             }
+        }
 
-            xSemaphoreGive(bus->sub_mutex);
-
-            // Free message back to pool
-            event_msg_free(msg);
+        for (uint32_t i = 0; i < EVENT_BUS_MAX_LATEST; i++) {
+            if (!(bits & (1UL << i))) {
+                continue;
+            }
+            msg = __atomic_exchange_n(&bus->latest[i].pending[lane->id], NULL, __ATOMIC_ACQ_REL);
+            if (msg) {
+                event_lane_dispatch(lane, msg);
+            }
         }
     }
 
@@ -19,18 +19,76 @@
 
 /* Configuration */
 #define EVENT_BUS_MAX_SUBSCRIBERS   16      // Maximum subscribers per bus
-#define EVENT_MSG_POOL_SIZE         20      // Total event message pool size
+#define EVENT_BUS_MAX_LATEST        4       // Latest-value (coalescing) topics per bus
+
+/* Static bus storage: buses, lane queues and dispatch stacks are reserved
+ * at link time, so event_bus_create never touches the FreeRTOS heap */
+#define EVENT_BUS_STATIC_COUNT      1       // Buses that can exist at once (app uses one)
+#define EVENT_BUS_QUEUE_DEPTH_MAX   16      // Largest queue_depth accepted by create
+#define EVENT_BUS_TASK_STACK        512     // Dispatch task stack (words)
+
+/* Section for dispatch stacks and queue storage (CCM, not DMA-accessible) */
+#ifndef EVENT_BUS_STACK_ATTR
+#define EVENT_BUS_STACK_ATTR        __attribute__((section(".ccm_noinit"), aligned(8)))
+#endif
+
+/* Size classes: publish picks the smallest class that fits the payload,
+ * spilling into a larger class when that one is exhausted */
+#define EVENT_MSG_SMALL_SIZE        32      // Small class data size (bytes)
+#define EVENT_MSG_SMALL_COUNT       12      // Small class message count
+#define EVENT_MSG_MEDIUM_SIZE       128     // Medium class data size (bytes)
+#define EVENT_MSG_MEDIUM_COUNT      6       // Medium class message count
 #define EVENT_DATA_MAX_SIZE         512     // Maximum event data size (bytes)
+#define EVENT_MSG_LARGE_COUNT       2       // Large class message count
+
+#if EVENT_MSG_SMALL_COUNT > 32 || EVENT_MSG_MEDIUM_COUNT > 32 || EVENT_MSG_LARGE_COUNT > 32
+#error "event message class count must fit the 32-bit free mask"
+#endif
 
-/* Event message structure (static buffer) */
+#define EVENT_MSG_POOL_SIZE         (EVENT_MSG_SMALL_COUNT + EVENT_MSG_MEDIUM_COUNT + \
+                                     EVENT_MSG_LARGE_COUNT)  // Total event message pool size
+
+/* Message size class */
+typedef enum {
+    EVENT_MSG_CLASS_SMALL = 0,
+    EVENT_MSG_CLASS_MEDIUM,
+    EVENT_MSG_CLASS_LARGE,
+    EVENT_MSG_CLASS_COUNT
+} event_msg_class_id_t;
+
+/* Event message structure (data points into its class buffer) */
 typedef struct {
     uint32_t type;                          // Event type ID
     uint32_t timestamp;                     // Tick count when published
-    uint8_t data[EVENT_DATA_MAX_SIZE];      // Event data (static buffer)
+    uint32_t stamp_cycles;                  // DWT cycle count when published (latency)
+    uint8_t *data;                          // Event data (static class buffer)
     size_t size;                            // Actual data size used
+    uint8_t cls;                            // Owning size class
     bool in_use;                            // Allocation flag
+    uint32_t refcnt;                        // Pool slot returns when this drops to 0
 } event_msg_t;
 
+/* Dispatch lanes: each lane has its own queue and task, so a slow
+ * subscriber only delays the subscribers of its own lane */
+typedef enum {
+    EVENT_BUS_LANE_HIGH = 0,                // Runs at the bus task priority
+    EVENT_BUS_LANE_LOW,                     // One priority below (formatting, slow links)
+    EVENT_BUS_LANE_COUNT
+} event_bus_lane_id_t;
+
+/* Per-subscriber handler timing with the DWT cycle counter */
+#ifndef EVENT_BUS_HANDLER_TIMING
+#define EVENT_BUS_HANDLER_TIMING    1
+#endif
+
+/* Publish->dispatch latency histogram: bucket i counts latencies below
+ * bound i, the last bucket everything above the last bound */
+#define EVENT_BUS_LAT_BOUNDS_US     { 50, 100, 250, 500, 1000, 2500, 5000, 10000 }
+#define EVENT_BUS_LAT_BUCKETS       9
+
+/* Event types with per-type counters (type IDs are event_mask bits) */
+#define EVENT_BUS_MAX_TYPES         32
+
 /* Event handler callback type */
 typedef void (*event_handler_t)(const event_msg_t *msg);
 
@@ -39,40 +97,104 @@ typedef struct {
     uint32_t event_mask;                    // Bitmask of subscribed events (0 = all)
     event_handler_t handler;                // Handler callback
     bool active;                            // Active flag
+    uint8_t lane;                           // event_bus_lane_id_t
+
+    /* Handler statistics */
+    uint32_t calls;                         // Handler invocations
+    uint32_t cycles_max;                    // Longest single call (DWT cycles)
+    uint64_t cycles_total;                  // Sum of all calls (DWT cycles)
 } subscriber_t;
 
-/* Event bus structure */
+struct event_bus;
+
+/* Latest-value topic: each lane keeps only the newest unread message */
+typedef struct {
+    uint32_t type;                          // Event type ID
+    event_msg_t *pending[EVENT_BUS_LANE_COUNT];  // Newest undelivered message per lane
+    uint32_t coalesced;                     // Messages replaced before dispatch
+} event_latest_t;
+
+/* Dispatch lane */
 typedef struct {
+    struct event_bus *bus;                  // Owning bus
+    QueueHandle_t queue;                    // FreeRTOS queue (event_msg_t pointers)
+    TaskHandle_t task;                      // Dispatch task handle
+    SemaphoreHandle_t mutex;                // Held while this lane runs handlers
+    uint32_t event_mask;                    // OR of this lane's subscriber masks
+    bool all_events;                        // A subscriber of this lane takes every type
+    uint8_t id;                             // event_bus_lane_id_t
+
+    /* Statistics */
+    uint32_t dispatched;                    // Messages run through handlers
+    uint32_t queue_peak;                    // Peak queue fill
+    uint32_t lat_max_us;                    // Worst publish->dispatch latency
+    uint32_t lat_hist[EVENT_BUS_LAT_BUCKETS];  // Latency histogram
+} event_bus_lane_t;
+
+/* Event bus structure */
+typedef struct event_bus {
     const char *name;                       // Bus name
-    QueueHandle_t queue;                    // FreeRTOS queue
+    event_bus_lane_t lanes[EVENT_BUS_LANE_COUNT];  // Dispatch lanes, highest first
     subscriber_t subscribers[EVENT_BUS_MAX_SUBSCRIBERS];  // Static subscriber array
-    SemaphoreHandle_t sub_mutex;            // Subscriber list mutex
-    TaskHandle_t dispatch_task;             // Dispatch task handle
+    SemaphoreHandle_t sub_mutex;            // Subscriber slot allocation mutex
     bool running;                           // Running flag
-    uint32_t queue_depth;                   // Queue depth
+    uint32_t queue_depth;                   // Queue depth (per lane)
+    event_latest_t latest[EVENT_BUS_MAX_LATEST];  // Latest-value topics
+    uint32_t latest_mask;                   // Type bits of latest topics
+    uint32_t latest_count;                  // Used latest[] entries
 
     /* Statistics */
     uint32_t sub_count;                     // Active subscriber count
     uint32_t publish_success;               // Successful publishes
-    uint32_t publish_failed;                // Failed publishes
+    uint32_t publish_failed;                // Failed publishes (any lane missed)
+    uint32_t type_count[EVENT_BUS_MAX_TYPES];  // Publishes per event type
+    TickType_t stats_since;                 // Tick of creation or last reset
 } event_bus_t;
 
-/* Event message pool (global static) */
+/* Statistics snapshot (event_bus_get_detail_stats) */
+typedef struct {
+    uint32_t elapsed_ms;                    // Window since creation or last reset
+    uint32_t publish_success;
+    uint32_t publish_failed;
+    uint32_t type_count[EVENT_BUS_MAX_TYPES];  // Rate = type_count * 1000 / elapsed_ms
+    uint32_t coalesced;                     // Sum over latest-value topics
+    struct {
+        uint32_t dispatched;
+        uint32_t queue_depth;               // Current queue fill
+        uint32_t queue_peak;
+        uint32_t lat_max_us;
+        uint32_t lat_hist[EVENT_BUS_LAT_BUCKETS];
+    } lanes[EVENT_BUS_LANE_COUNT];
+} event_bus_stats_t;
+
+/* One size class of the message pool */
 typedef struct {
-    event_msg_t pool[EVENT_MSG_POOL_SIZE];  // Static event pool
-    SemaphoreHandle_t mutex;                // Pool mutex
+    event_msg_t *msgs;                      // Static message array
+    uint8_t *data;                          // Static data buffer (count * data_size)
+    size_t data_size;                       // Data bytes per message
+    uint32_t count;                         // Messages in this class (<= 32)
+    uint32_t free_mask;                     // Bit i set = msgs[i] free (lock-free)
     uint32_t allocated;                     // Currently allocated count
     uint32_t peak;                          // Peak allocation
-    uint32_t failures;                      // Allocation failures
+    uint32_t failures;                      // No free message in this class
+    uint32_t spills;                        // Served by a larger class instead
+} event_msg_class_t;
+
+/* Event message pool (global static, lock-free: no mutex on alloc/free) */
+typedef struct {
+    event_msg_class_t cls[EVENT_MSG_CLASS_COUNT];  // Size classes, smallest first
+    uint32_t allocated;                     // Currently allocated count
+    uint32_t peak;                          // Peak allocation
+    uint32_t failures;                      // Allocation failures (no class could serve)
 } event_msg_pool_t;
 
 /**
  * @brief Create a new event bus instance
  *
  * @param name Unique name for this bus (used for registry)
- * @param queue_depth Maximum number of events in queue
- * @param task_priority Priority for dispatch task
- * @return event_bus_t* Pointer to created bus, NULL on failure
+ * @param queue_depth Maximum number of events in queue (per lane, <= EVENT_BUS_QUEUE_DEPTH_MAX)
+ * @param task_priority Priority for the high lane task (low lane runs one below)
+ * @return event_bus_t* Pointer to created bus, NULL on failure or no free static slot
  */
 event_bus_t* event_bus_create(const char *name, uint32_t queue_depth, uint32_t task_priority);
 
@@ -94,6 +216,22 @@ void event_bus_destroy(event_bus_t *bus);
  */
 bool event_bus_subscribe(event_bus_t *bus, uint32_t event_mask, event_handler_t handler);
 
+/**
+ * @brief Subscribe on a specific dispatch lane
+ *
+ * event_bus_subscribe() uses EVENT_BUS_LANE_HIGH. Put handlers that block
+ * or format output on EVENT_BUS_LANE_LOW so they cannot delay others.
+ *
+ * @param bus Event bus
+ * @param event_mask Bitmask of event types to subscribe to (0 = all events)
+ * @param handler Event handler callback
+ * @param lane Dispatch lane
+ * @return true Success
+ * @return false Failure (bus full or invalid lane)
+ */
+bool event_bus_subscribe_lane(event_bus_t *bus, uint32_t event_mask, event_handler_t handler,
+                              event_bus_lane_id_t lane);
+
 /**
  * @brief Unsubscribe from events
  *
@@ -118,6 +256,94 @@ bool event_bus_unsubscribe(event_bus_t *bus, event_handler_t handler);
  */
 bool event_bus_publish(event_bus_t *bus, uint32_t type, const void *data, size_t size);
 
+/**
+ * @brief Publish an event from interrupt context
+ *
+ * Same as event_bus_publish(). Pool allocation is lock-free, so this never
+ * blocks; the copy costs size bytes of memcpy inside the ISR. Keep payloads
+ * small (the 32-byte class) for "data ready"/"overrun" style events.
+ *
+ * If higher_prio_woken is given it is only ever set to pdTRUE (never
+ * cleared), so one flag can collect several FromISR calls and the caller
+ * does portYIELD_FROM_ISR() once. With NULL the function yields itself.
+ *
+ * @param bus Event bus
+ * @param type Event type ID
+ * @param data Pointer to event data (will be copied)
+ * @param size Size of event data (must be <= EVENT_DATA_MAX_SIZE)
+ * @param higher_prio_woken Output for portYIELD_FROM_ISR(), or NULL to yield here
+ * @return true Event queued successfully
+ * @return false Queue full, pool exhausted, or size too large
+ */
+bool event_bus_publish_from_isr(event_bus_t *bus, uint32_t type, const void *data, size_t size,
+                                BaseType_t *higher_prio_woken);
+
+/**
+ * @brief Reserve a pool message to be filled in place (zero-copy publish)
+ *
+ * Write up to size bytes into msg->data, then hand it over with
+ * event_bus_commit(), or give it back with event_bus_loan_cancel().
+ * msg->size may be lowered before committing.
+ *
+ * @param bus Event bus
+ * @param size Bytes to reserve (must be <= EVENT_DATA_MAX_SIZE)
+ * @return event_msg_t* Loaned message, NULL if pool exhausted or too large
+ */
+event_msg_t* event_bus_loan(event_bus_t *bus, size_t size);
+
+/**
+ * @brief Publish a loaned message
+ *
+ * Ownership passes to the bus even on failure (the message is freed).
+ *
+ * @param bus Event bus
+ * @param msg Message from event_bus_loan()
+ * @param type Event type ID
+ * @return true Event queued successfully
+ * @return false Queue full
+ */
+bool event_bus_commit(event_bus_t *bus, event_msg_t *msg, uint32_t type);
+
+/**
+ * @brief Return a loaned message without publishing it
+ *
+ * @param msg Message from event_bus_loan()
+ */
+void event_bus_loan_cancel(event_msg_t *msg);
+
+/**
+ * @brief Keep a message alive after the handler returns
+ *
+ * The message stays out of the pool until a matching
+ * event_bus_msg_release(). Callable from the handler or any task.
+ *
+ * @param msg Message passed to the handler
+ */
+void event_bus_msg_retain(const event_msg_t *msg);
+
+/**
+ * @brief Drop a reference taken with event_bus_msg_retain()
+ *
+ * @param msg Retained message
+ */
+void event_bus_msg_release(const event_msg_t *msg);
+
+/**
+ * @brief Turn an event type into a latest-value (coalescing) topic
+ *
+ * Publishes of this type skip the lane queue: each lane keeps only the
+ * newest message and its task is woken by a notification. A slow
+ * subscriber then sees fewer, fresher samples instead of filling the
+ * queue, and the topic holds at most two pool messages per lane (one
+ * pending, one being dispatched). Call before publishing the type.
+ *
+ * @param bus Event bus
+ * @param type Event type ID (< 32)
+ * @return true Registered (or already registered)
+ * @return false Table full or invalid type
+ */
+bool event_bus_set_latest(event_bus_t *bus, uint32_t type);
+
 /**
  * @brief Start the dispatch task (called automatically in create)
  *
@@ -145,6 +371,27 @@ void event_bus_stop(event_bus_t *bus);
 void event_bus_get_stats(event_bus_t *bus, uint32_t *sub_count,
                          uint32_t *publish_success, uint32_t *publish_failed);
 
+/**
+ * @brief Get latency, queue and per-type statistics of a bus
+ *
+ * Handler execution time per subscriber: event_bus_get_subscriber_stats().
+ * Counters are read without locking and may be off by in-flight events.
+ *
+ * @param bus Event bus
+ * @param out Output snapshot
+ * @return true Success
+ */
+bool event_bus_get_detail_stats(event_bus_t *bus, event_bus_stats_t *out);
+
+/**
+ * @brief Clear all statistics of a bus and the pool peaks/failures
+ *
+ * Starts a new rate window. Handler timing of every subscriber is cleared too.
+ *
+ * @param bus Event bus
+ */
+void event_bus_reset_stats(event_bus_t *bus);
+
 /**
  * @brief Get event pool statistics
  *
@@ -154,6 +401,41 @@ void event_bus_get_stats(event_bus_t *bus, uint32_t *sub_count,
  */
 void event_bus_get_pool_stats(uint32_t *allocated, uint32_t *peak, uint32_t *failures);
 
+/**
+ * @brief Get statistics of one pool size class
+ *
+ * Use the per-class peak/failures to tune EVENT_MSG_*_COUNT.
+ *
+ * @param cls Size class
+ * @param stats Output: copy of the class (msgs/data pointers included)
+ * @return true Success
+ * @return false Invalid class or pool not initialized
+ */
+bool event_bus_get_class_stats(event_msg_class_id_t cls, event_msg_class_t *stats);
+
+/**
+ * @brief Check whether any subscriber would receive an event type
+ *
+ * Lock-free; lets a producer skip building a payload nobody listens to.
+ *
+ * @param bus Event bus
+ * @param type Event type ID
+ * @return true At least one lane has a matching subscriber
+ */
+bool event_bus_has_subscriber(event_bus_t *bus, uint32_t type);
+
+/**
+ * @brief Get one subscriber's lane and handler timing
+ *
+ * @param bus Event bus
+ * @param handler Subscribed handler
+ * @param out Output: copy of the subscriber entry
+ * @return true Found
+ * @return false Handler not subscribed
+ */
+bool event_bus_get_subscriber_stats(event_bus_t *bus, event_handler_t handler,
+                                    subscriber_t *out);
+
 /* ==================== Registry Functions ==================== */
 
 /**
@@ -0,0 +1,160 @@
+#include "fmt.h"
+#include <string.h>
+
+static const uint32_t fmt_pow10[] = {
+    1,      10,      100,      1000,      10000,
+    100000, 1000000, 10000000, 100000000, 1000000000,
+};
+
+void fmt_init(fmt_t *f, char *buf, size_t size) {
+  f->buf = buf;
+  f->size = size;
+  f->len = 0;
+  f->overflow = (size == 0);
+}
+
+// NUL 자리 하나는 항상 남긴다
+static bool fmt_room(fmt_t *f, size_t n) {
+  if (f->overflow || f->len + n >= f->size) {
+    f->overflow = true;
+    return false;
+  }
+  return true;
+}
+
+void fmt_char(fmt_t *f, char c) {
+  if (fmt_room(f, 1)) {
+    f->buf[f->len++] = c;
+  }
+}
+
+void fmt_mem(fmt_t *f, const void *data, size_t len) {
+  if (fmt_room(f, len)) {
+    memcpy(&f->buf[f->len], data, len);
+    f->len += len;
+  }
+}
+
+void fmt_str(fmt_t *f, const char *s) {
+  fmt_mem(f, s, strlen(s));
+}
+
+/**
+ * @brief v 를 정확히 digits 자리로 (앞은 0 으로 채움)
+ */
+static void fmt_digits(fmt_t *f, uint32_t v, uint8_t digits) {
+  char *p;
+
+  if (!fmt_room(f, digits)) {
+    return;
+  }
+
+  p = &f->buf[f->len + digits];
+  f->len += digits;
+  while (digits--) {
+    *--p = (char)('0' + v % 10);
+    v /= 10;
+  }
+}
+
+static uint8_t fmt_num_digits(uint32_t v) {
+  uint8_t n = 1;
+
+  while (n < 10 && v >= fmt_pow10[n]) {
+    n++;
+  }
+  return n;
+}
+
+void fmt_u32(fmt_t *f, uint32_t v) {
+  fmt_digits(f, v, fmt_num_digits(v));
+}
+
+void fmt_i32(fmt_t *f, int32_t v) {
+  if (v < 0) {
+    fmt_char(f, '-');
+    fmt_u32(f, 0u - (uint32_t)v);
+  } else {
+    fmt_u32(f, (uint32_t)v);
+  }
+}
+
+void fmt_hex(fmt_t *f, uint32_t v, uint8_t width) {
+  static const char hex[] = "0123456789ABCDEF";
+  uint8_t n = 1;
+  char *p;
+
+  while (n < 8 && (v >> (n * 4)) != 0) {
+    n++;
+  }
+  if (width > 8) {
+    width = 8;
+  }
+  if (n < width) {
+    n = width;
+  }
+  if (!fmt_room(f, n)) {
+    return;
+  }
+
+  p = &f->buf[f->len + n];
+  f->len += n;
+  while (n--) {
+    *--p = hex[v & 0xF];
+    v >>= 4;
+  }
+}
+
+void fmt_fixed(fmt_t *f, int64_t v, uint8_t decimals) {
+  uint64_t mag;
+  uint64_t ipart;
+  uint32_t frac;
+
+  if (decimals > 9) {
+    decimals = 9;
+  }
+
+  if (v < 0) {
+    fmt_char(f, '-');
+    mag = 0u - (uint64_t)v;
+  } else {
+    mag = (uint64_t)v;
+  }
+
+  // 64bit 나눗셈은 한 번, 나머지는 32bit 로
+  ipart = mag / fmt_pow10[decimals];
+  frac = (uint32_t)(mag - ipart * fmt_pow10[decimals]);
+
+  if (ipart > UINT32_MAX) {
+    // 위경도/고도에서는 안 생김, 1e9 단위로 잘라서
+    uint32_t part[3];
+    int n = 0;
+
+    while (ipart > 0 && n < 3) {
+      uint64_t q = ipart / 1000000000u;
+
+      part[n++] = (uint32_t)(ipart - q * 1000000000u);
+      ipart = q;
+    }
+    fmt_u32(f, part[--n]);
+    while (n > 0) {
+      fmt_digits(f, part[--n], 9);
+    }
+  } else {
+    fmt_u32(f, (uint32_t)ipart);
+  }
+
+  if (decimals > 0) {
+    fmt_char(f, '.');
+    fmt_digits(f, frac, decimals);
+  }
+}
+
+size_t fmt_end(fmt_t *f) {
+  if (f->size == 0) {
+    return 0;
+  }
+
+  f->buf[f->len < f->size ? f->len : f->size - 1] = '\0';
+  return f->overflow ? 0 : f->len;
+}
@@ -0,0 +1,55 @@
+#ifndef FMT_H
+#define FMT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief 출력 경로용 가벼운 문자열 작성기 (printf 대신)
+ *
+ * newlib printf 의 %lf 는 M4F 에서 double 을 소프트웨어로 변환하고 스택도
+ * 많이 쓴다. 여기서는 정수와 고정소수점(정수 + 소수 자릿수)만 다룬다.
+ * 버퍼가 모자라면 overflow 를 세우고 이후 쓰기는 무시, fmt_end() 가 0.
+ */
+typedef struct {
+  char *buf;
+  size_t size;
+  size_t len;
+  bool overflow;
+} fmt_t;
+
+void fmt_init(fmt_t *f, char *buf, size_t size);
+
+void fmt_char(fmt_t *f, char c);
+void fmt_str(fmt_t *f, const char *s);
+void fmt_mem(fmt_t *f, const void *data, size_t len);
+
+void fmt_u32(fmt_t *f, uint32_t v);
+void fmt_i32(fmt_t *f, int32_t v);
+
+/**
+ * @brief 16진수 (대문자)
+ *
+ * @param[in] width 최소 자릿수 (모자라면 0 으로 채움, 0 이면 필요한 만큼)
+ */
+void fmt_hex(fmt_t *f, uint32_t v, uint8_t width);
+
+/**
+ * @brief 고정소수점 10진수
+ *
+ * 값 v 를 10^decimals 로 나눈 수로 찍는다. 예: v=375123456789, decimals=9
+ * -> "375.123456789". 음수는 정수부가 0 이어도 부호를 붙인다.
+ *
+ * @param[in] decimals 소수 자릿수 (0~9)
+ */
+void fmt_fixed(fmt_t *f, int64_t v, uint8_t decimals);
+
+/**
+ * @brief NUL 종료
+ *
+ * @return size_t NUL 을 뺀 길이, 버퍼가 모자랐으면 0
+ */
+size_t fmt_end(fmt_t *f);
+
+#endif
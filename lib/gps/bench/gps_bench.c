@@ -0,0 +1,246 @@
+/**
+ * @file gps_bench.c
+ * @brief GPS 파서 호스트 벤치마크
+ *
+ * 녹화한 UART 캡처 파일을 여러 chunk 크기로 gps_parse_process()에 넣고
+ * 처리량(MB/s, frames/s)과 프로토콜별 통계를 출력한다.
+ * 펌웨어 빌드에서는 제외되며 호스트 gcc로 직접 빌드한다.
+ *
+ * 빌드 (repo 루트에서):
+ *   gcc -O2 -std=gnu11 -Ilib/gps/bench/shim -Ilib/gps -Ilib/parser -Ilib/log \
+ *       -Ilib/crc -Ilib/simd -Ilib/lora -Imodules/lora -Iconfig \
+ *       -DUSE_GPS_ALL_DECODERS -o gps_bench lib/gps/bench/gps_bench.c \
+ *       lib/gps/gps*.c lib/gps/rtcm*.c lib/parser/parser.c lib/crc/crc.c \
+ *       lib/simd/simd.c -lm
+ *
+ * 실행:
+ *   ./gps_bench [-r] [-n repeat] [-c 1,16,64,512] f9p_capture.bin um982_capture.bin
+ *
+ *   -r : DMA 링버퍼(2048) 경유로 gps_parse_ring() 사용
+ *   -n : 캡처 반복 횟수 (기본 20)
+ *   -c : chunk 크기 목록 (기본 1,16,64,256,1024)
+ *
+ * 캡처는 수신기 UART를 그대로 저장한 raw 바이너리 (예: F9P UBX+NMEA+RTCM,
+ * UM982 binary+ASCII).
+ */
+
+#include "gps.h"
+#include "lora_app.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_RING_SIZE 2048
+#define BENCH_MAX_CHUNKS 16
+
+static const char *protocol_names[GPS_STATS_PROTOCOL_CNT] = {
+    "NONE", "NMEA", "UBX", "UNICORE_BIN", "UNICORE", "RTCM",
+};
+
+static uint32_t frame_cnt;
+
+TickType_t bench_tick;
+
+/* rtcm.c 링크용: 벤치마크에서는 LoRa로 보내지 않음 */
+bool lora_send_p2p_raw_async(const uint8_t *data, size_t len, uint32_t timeout_ms,
+                             lora_command_callback_t callback, void *user_data) {
+  (void)data;
+  (void)len;
+  (void)timeout_ms;
+  (void)callback;
+  (void)user_data;
+  return true;
+}
+
+uint32_t lora_get_tx_queue_space(void) { return 25; }
+uint32_t lora_get_p2p_toa_us(size_t len) { (void)len; return 0; }
+uint32_t lora_airtime_available_us(void) { return UINT32_MAX; }
+void lora_stats_tx_queued(bool queued, bool epoch_end) { (void)queued; (void)epoch_end; }
+void lora_stats_tx_done(bool success) { (void)success; }
+void lora_stats_tx_dropped(void) {}
+
+static void bench_msg_cb(gps_t *gps, gps_procotol_t protocol, gps_msg_t msg,
+                         void *ctx) {
+  (void)gps;
+  (void)ctx;
+  (void)protocol;
+  (void)msg;
+  frame_cnt++;
+}
+
+/**
+ * @brief 캡처 파일 읽기
+ *
+ * @param[in] path
+ * @param[out] len
+ * @return uint8_t* malloc 된 버퍼, 실패 시 NULL
+ */
+static uint8_t *load_capture(const char *path, size_t *len) {
+  FILE *fp = fopen(path, "rb");
+  if (!fp) {
+    perror(path);
+    return NULL;
+  }
+
+  fseek(fp, 0, SEEK_END);
+  long size = ftell(fp);
+  fseek(fp, 0, SEEK_SET);
+
+  uint8_t *buf = NULL;
+  if (size > 0) {
+    buf = malloc((size_t)size);
+  }
+  if (!buf || fread(buf, 1, (size_t)size, fp) != (size_t)size) {
+    fprintf(stderr, "%s: read failed\n", path);
+    free(buf);
+    fclose(fp);
+    return NULL;
+  }
+
+  fclose(fp);
+  *len = (size_t)size;
+  return buf;
+}
+
+static double now_sec(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/**
+ * @brief 링버퍼 모드 재생
+ *
+ * DMA처럼 링에 쓰고 쓴 구간만큼 gps_parse_ring()으로 넘긴다.
+ */
+static void replay_ring(gps_t *gps, const uint8_t *data, size_t len,
+                        size_t chunk) {
+  static uint8_t ring[BENCH_RING_SIZE];
+  size_t wr = 0;
+
+  for (size_t i = 0; i < len; i += chunk) {
+    size_t n = (len - i < chunk) ? (len - i) : chunk;
+    size_t old = wr;
+
+    for (size_t k = 0; k < n; k++) {
+      ring[wr] = data[i + k];
+      wr = (wr + 1) % BENCH_RING_SIZE;
+    }
+    gps_parse_ring(gps, ring, BENCH_RING_SIZE, old, wr);
+  }
+}
+
+static void replay(gps_t *gps, const uint8_t *data, size_t len, size_t chunk) {
+  for (size_t i = 0; i < len; i += chunk) {
+    size_t n = (len - i < chunk) ? (len - i) : chunk;
+    gps_parse_process(gps, &data[i], n);
+  }
+}
+
+static void run(const char *name, const uint8_t *data, size_t len,
+                const size_t *chunks, int chunk_cnt, int repeat, bool use_ring) {
+  static gps_t gps;
+  static char frame_buf[GPS_PAYLOAD_SIZE];
+
+  printf("== %s (%zu bytes x %d, %s)\n", name, len, repeat,
+         use_ring ? "ring" : "linear");
+
+  for (int c = 0; c < chunk_cnt; c++) {
+    size_t chunk = chunks[c];
+
+    gps_init(&gps);
+    gps_set_frame_buf(&gps, frame_buf, sizeof(frame_buf));
+    for (int p = GPS_PROTOCOL_NMEA; p < GPS_STATS_PROTOCOL_CNT; p++) {
+      gps_subscribe(&gps, (gps_procotol_t)p, GPS_SUB_ANY, bench_msg_cb, NULL);
+    }
+    frame_cnt = 0;
+
+    double start = now_sec();
+    for (int r = 0; r < repeat; r++) {
+      if (use_ring) {
+        replay_ring(&gps, data, len, chunk);
+      } else {
+        replay(&gps, data, len, chunk);
+      }
+    }
+    double elapsed = now_sec() - start;
+    if (elapsed <= 0) {
+      elapsed = 1e-9;
+    }
+
+    gps_stats_t stats;
+    gps_get_stats(&gps, &stats);
+
+    printf("chunk %5zu: %8.2f MB/s %10.0f frames/s  discarded %u\n", chunk,
+           (double)len * repeat / elapsed / 1e6, frame_cnt / elapsed,
+           (unsigned)stats.discarded);
+
+    for (int p = 1; p < GPS_STATS_PROTOCOL_CNT; p++) {
+      const gps_proto_stats_t *ps = &stats.proto[p];
+      if (ps->frame_ok || ps->chksum_err || ps->oversize || ps->resync) {
+        printf("    %-12s ok %u chksum_err %u oversize %u resync %u\n",
+               protocol_names[p], (unsigned)ps->frame_ok,
+               (unsigned)ps->chksum_err, (unsigned)ps->oversize,
+               (unsigned)ps->resync);
+      }
+    }
+  }
+}
+
+static int parse_chunks(const char *arg, size_t *chunks) {
+  int cnt = 0;
+  char *end;
+
+  while (*arg && cnt < BENCH_MAX_CHUNKS) {
+    long v = strtol(arg, &end, 10);
+    if (end == arg || v <= 0) {
+      return 0;
+    }
+    chunks[cnt++] = (size_t)v;
+    arg = (*end == ',') ? end + 1 : end;
+  }
+
+  return cnt;
+}
+
+int main(int argc, char **argv) {
+  size_t chunks[BENCH_MAX_CHUNKS] = {1, 16, 64, 256, 1024};
+  int chunk_cnt = 5;
+  int repeat = 20;
+  bool use_ring = false;
+  int i = 1;
+
+  for (; i < argc && argv[i][0] == '-'; i++) {
+    if (!strcmp(argv[i], "-r")) {
+      use_ring = true;
+    } else if (!strcmp(argv[i], "-n") && i + 1 < argc) {
+      repeat = atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "-c") && i + 1 < argc) {
+      chunk_cnt = parse_chunks(argv[++i], chunks);
+    } else {
+      chunk_cnt = 0;
+      break;
+    }
+  }
+
+  if (i >= argc || chunk_cnt == 0 || repeat <= 0) {
+    fprintf(stderr,
+            "usage: %s [-r] [-n repeat] [-c 1,16,64] capture.bin...\n",
+            argv[0]);
+    return 1;
+  }
+
+  for (; i < argc; i++) {
+    size_t len = 0;
+    uint8_t *data = load_capture(argv[i], &len);
+    if (!data) {
+      return 1;
+    }
+
+    run(argv[i], data, len, chunks, chunk_cnt, repeat, use_ring);
+    free(data);
+  }
+
+  return 0;
+}
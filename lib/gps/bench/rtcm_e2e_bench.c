@@ -0,0 +1,512 @@
+/**
+ * @file rtcm_e2e_bench.c
+ * @brief 기준국 -> LoRa -> 로버 RTCM 보정 경로 재생 벤치 (golden 비교)
+ *
+ * 녹화한 기준국 수신기 스트림을 기준국 경로 (gps_parse_process ->
+ * rtcm_send_to_lora fragment) 에 넣고, 손실이 있는 가상 링크를 지나 로버 경로
+ * (lora_parse_p2p_recv -> rtcm_reassembly_deliver -> rtcm_validate_packet) 로
+ * 받는다. 로버에서 나온 RTCM 프레임을 기준국이 보낸 프레임과 byte 단위로
+ * 비교해 전달률, epoch 당 무선 byte, 지연을 낸다. LoRa framing/FEC/묶음을
+ * 바꾸면 이 벤치로 전후를 비교한다.
+ *
+ * 시간은 가상 시각이라 실행마다 결과가 같다. 수신기는 period 마다 한 epoch 을
+ * UART 속도로 내보내고 (MSM multiple message bit 0 이 epoch 끝), LoRa 는
+ * 명령 UART 전송 + ToA 동안 한 fragment 씩 보낸다.
+ * 펌웨어 빌드에서는 제외되며 호스트 gcc로 직접 빌드한다.
+ *
+ * 빌드 (repo 루트에서):
+ *   gcc -O2 -std=gnu11 -Ilib/gps/bench/shim -Ilib/gps -Ilib/parser -Ilib/log \
+ *       -Ilib/crc -Ilib/simd -Ilib/lora -Imodules/lora -Imodules/gps -ICore/Inc \
+ *       -Iconfig -DUSE_GPS_ALL_DECODERS -o rtcm_e2e_bench \
+ *       lib/gps/bench/rtcm_e2e_bench.c lib/gps/gps*.c lib/gps/rtcm*.c \
+ *       lib/parser/parser.c lib/crc/crc.c lib/simd/simd.c lib/lora/lora.c \
+ *       modules/lora/rtcm_reassembly.c -lm
+ *
+ * 실행:
+ *   ./rtcm_e2e_bench [-b baud] [-p period_ms] [-l loss] [-B burst] [-S seed]
+ *                    [-f fec] [-s sf] [-w bw] [-L lora_baud] base_capture.bin
+ *
+ *   -b : 수신기 UART 속도 (기본 115200)
+ *   -p : 수신기 epoch 주기 ms (기본 1000)
+ *   -l : fragment 손실률 (1/1000, 기본 0)
+ *   -B : 손실 burst 길이 (fragment, 기본 1)
+ *   -S : 손실 난수 seed (기본 1)
+ *   -f : RTCM FEC 그룹 크기 (기본 0)
+ *   -s, -w : LoRa SF, BW (0:125k 1:250k 2:500k, 기본 7, 2)
+ *   -L : LoRa 모듈 명령 UART 속도 (기본 460800)
+ *
+ * 종료 코드: 0 = 보낸 프레임이 모두 그대로 도착, 2 = 유실 또는 불일치
+ */
+
+#include "gps.h"
+#include "rtcm.h"
+#include "lora_app.h"
+#include "lora_stats.h"
+#include "rtcm_reassembly.h"
+#include "rtcm_router.h"
+#include "mem_watermark.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_LORA_QUEUE_SIZE 25   // lora_app.c LORA_CMD_QUEUE_SIZE
+#define BENCH_LORA_MAX_RAW 118     // lora_app.c LORA_P2P_MAX_RAW
+#define BENCH_LORA_CMD_OVERHEAD 19 // "at+send=lorap2p:" + "\r\n" + 여유
+#define BENCH_AIRTIME_PERMILLE 900 // lora_app.c LORA_AIRTIME_BUDGET_PERMILLE
+#define BENCH_RTCM_MAX 1029
+
+TickType_t bench_tick;
+
+static struct {
+  uint32_t baud;
+  uint32_t period_ms;
+  uint32_t loss;
+  uint32_t burst;
+  uint32_t seed;
+  uint8_t fec;
+  uint32_t lora_baud;
+  lora_modem_params_t lora;
+} cfg = {
+    .baud = 115200,
+    .period_ms = 1000,
+    .loss = 0,
+    .burst = 1,
+    .seed = 1,
+    .fec = 0,
+    .lora_baud = 460800,
+    .lora = {.sf = 7, .bw = 2, .cr = 1, .preamble = 8},
+};
+
+/* 기준국이 LoRa 로 보낸 프레임 (golden) */
+typedef struct {
+  uint8_t *data;
+  uint16_t len;
+  uint16_t type;
+  uint64_t arr_us; // 마지막 byte 가 UART 에 도착한 가상 시각
+} bench_frame_t;
+
+/* LoRa TX 큐의 fragment */
+typedef struct {
+  uint8_t data[BENCH_LORA_MAX_RAW];
+  size_t len;
+  lora_command_callback_t cb;
+  void *user_data;
+  uint64_t queued_us;
+} bench_frag_t;
+
+static gps_t gps;
+static uint8_t frame_buf[GPS_PAYLOAD_SIZE];
+static rtcm_reassembly_t reasm;
+static uint64_t now_us; // 가상 시각
+
+static bench_frame_t *frames;
+static size_t frame_cnt;
+static size_t frame_cap;
+static size_t match_pos; // 다음에 나와야 할 golden 프레임
+
+static bench_frag_t air[BENCH_LORA_QUEUE_SIZE];
+static size_t air_head;
+static size_t air_cnt;
+static uint64_t air_free_us;   // LoRa 모듈이 다음 명령을 받을 수 있는 시각
+static int64_t airtime_us;     // 링크 점유 예산
+static uint64_t airtime_last_us;
+static uint32_t burst_left;
+
+static struct {
+  uint32_t rtcm_in;
+  uint32_t sched_dropped;
+  uint32_t epochs;
+  uint32_t frags;
+  uint64_t frag_bytes;
+  uint32_t frags_lost;
+  uint64_t air_us;
+  uint32_t delivered;
+  uint32_t lost;
+  uint32_t unmatched;
+  uint32_t *lat_us;
+  size_t lat_cnt;
+} st;
+
+/* ---- 링크에 안 쓰는 부분 ---- */
+
+void mem_wm_register(mem_wm_t *wm) { (void)wm; }
+void lora_stats_tx_done(bool success) { (void)success; }
+void lora_stats_tx_dropped(void) { st.sched_dropped++; }
+void lora_stats_rx_epoch_drop(void) {}
+void lora_stats_rx_recovered(void) {}
+void lora_stats_rx_timeout(void) {}
+void lora_stats_rx_overflow(void) {}
+void lora_stats_rx_frame(uint16_t type, bool ok, bool crc_fail) {
+  (void)type;
+  (void)ok;
+  (void)crc_fail;
+}
+
+void lora_stats_tx_queued(bool queued, bool epoch_end) {
+  if (queued && epoch_end) {
+    st.epochs++;
+  }
+}
+
+static uint32_t bench_rand(void) {
+  cfg.seed = cfg.seed * 1103515245u + 12345u;
+  return (cfg.seed >> 16) & 0x7FFF;
+}
+
+/* ---- 기준국 LoRa (lora_app.c 대신) ---- */
+
+static void airtime_refill(void) {
+  int64_t budget = 1000LL * BENCH_AIRTIME_PERMILLE;
+
+  airtime_us += (int64_t)(now_us - airtime_last_us) * BENCH_AIRTIME_PERMILLE / 1000;
+  airtime_last_us = now_us;
+  if (airtime_us > budget) {
+    airtime_us = budget;
+  }
+}
+
+static uint32_t frag_busy_us(size_t len) {
+  uint32_t uart = (uint32_t)((uint64_t)(BENCH_LORA_CMD_OVERHEAD + len * 2) * 10u *
+                             1000000u / cfg.lora_baud);
+  return uart + lora_calc_toa_us(&cfg.lora, len);
+}
+
+bool lora_send_p2p_raw_async(const uint8_t *data, size_t len, uint32_t timeout_ms,
+                             lora_command_callback_t callback, void *user_data) {
+  (void)timeout_ms;
+
+  if (!data || len == 0 || len > BENCH_LORA_MAX_RAW || air_cnt == BENCH_LORA_QUEUE_SIZE) {
+    return false;
+  }
+
+  bench_frag_t *f = &air[(air_head + air_cnt) % BENCH_LORA_QUEUE_SIZE];
+
+  memcpy(f->data, data, len);
+  f->len = len;
+  f->cb = callback;
+  f->user_data = user_data;
+  f->queued_us = now_us;
+  air_cnt++;
+  return true;
+}
+
+uint32_t lora_get_tx_queue_space(void) {
+  return (uint32_t)(BENCH_LORA_QUEUE_SIZE - air_cnt);
+}
+
+uint32_t lora_get_p2p_toa_us(size_t len) { return lora_calc_toa_us(&cfg.lora, len); }
+
+uint32_t lora_airtime_available_us(void) {
+  airtime_refill();
+  return airtime_us > 0 ? (uint32_t)airtime_us : 0;
+}
+
+/* ---- 로버 ---- */
+
+/**
+ * @brief 로버가 받은 RTCM 프레임 (rtcm_reassembly_deliver 에서)
+ *
+ * golden 목록에서 같은 프레임을 찾는다. 건너뛴 프레임은 유실로 센다.
+ */
+void rtcm_router_input_frame(rtcm_src_t src, const uint8_t *frame, size_t len,
+                             TickType_t rx_tick) {
+  (void)src;
+  (void)rx_tick;
+
+  for (size_t i = match_pos; i < frame_cnt; i++) {
+    const bench_frame_t *g = &frames[i];
+
+    if (g->len == len && memcmp(g->data, frame, len) == 0) {
+      st.lost += (uint32_t)(i - match_pos);
+      st.lat_us[st.lat_cnt++] = (uint32_t)(now_us - g->arr_us);
+      st.delivered++;
+      match_pos = i + 1;
+      return;
+    }
+  }
+
+  // CRC 는 맞는데 보낸 적 없는 프레임 (재조립 오류)
+  st.unmatched++;
+}
+
+/**
+ * @brief 무선으로 나간 fragment 를 모듈이 주는 at+recv 줄로 만들어 로버에 넣음
+ */
+static void rover_recv(const bench_frag_t *f) {
+  static const char hex[] = "0123456789ABCDEF";
+  char line[LORA_RECV_PREFIX_LEN + 32 + BENCH_LORA_MAX_RAW * 2];
+  lora_p2p_recv_data_t recv;
+  int n = snprintf(line, sizeof(line), "at+recv=-80,5,%u:", (unsigned)f->len);
+
+  for (size_t i = 0; i < f->len; i++) {
+    line[n++] = hex[f->data[i] >> 4];
+    line[n++] = hex[f->data[i] & 0x0F];
+  }
+  line[n] = '\0';
+
+  if (lora_parse_p2p_recv(line, &recv)) {
+    rtcm_reassembly_deliver(&reasm, (const uint8_t *)recv.data, recv.data_len);
+  }
+}
+
+/**
+ * @brief until 까지 송신이 끝나는 fragment 를 내보냄
+ */
+static void air_run(uint64_t until) {
+  uint64_t saved = now_us;
+
+  while (air_cnt) {
+    bench_frag_t *f = &air[air_head];
+    uint64_t start = f->queued_us > air_free_us ? f->queued_us : air_free_us;
+    uint32_t busy = frag_busy_us(f->len);
+
+    if (start + busy > until) {
+      break;
+    }
+
+    now_us = start;
+    airtime_refill();
+    airtime_us -= busy;
+
+    now_us = start + busy;
+    bench_tick = (TickType_t)(now_us / 1000u);
+    air_free_us = now_us;
+    st.air_us += busy;
+    st.frags++;
+    st.frag_bytes += f->len;
+
+    // 손실: 평균 loss 가 되도록 burst 길이만큼 연속으로 빠짐
+    if (burst_left == 0 && cfg.loss &&
+        bench_rand() % (1000u * cfg.burst) < cfg.loss) {
+      burst_left = cfg.burst;
+    }
+    if (burst_left) {
+      burst_left--;
+      st.frags_lost++;
+    } else {
+      rover_recv(f);
+    }
+
+    if (f->cb) {
+      f->cb(true, f->user_data);
+    }
+    air_head = (air_head + 1) % BENCH_LORA_QUEUE_SIZE;
+    air_cnt--;
+  }
+
+  now_us = saved > now_us ? saved : now_us;
+  bench_tick = (TickType_t)(now_us / 1000u);
+}
+
+/* ---- 기준국 수신 ---- */
+
+static bool epoch_end_seen;
+
+/**
+ * @brief MSM multiple message bit (DF393) 가 0 이면 epoch 끝
+ */
+static bool rtcm_frame_ends_epoch(const uint8_t *f, size_t len, uint16_t type) {
+  if (type < 1071 || type > 1137 || len < 3 + 8) {
+    return false;
+  }
+  // payload bit 54 (타입 12 + station 12 + epoch 30)
+  return (f[3 + 54 / 8] & (0x80 >> (54 % 8))) == 0;
+}
+
+static void bench_on_rtcm(gps_t *g, gps_procotol_t protocol, gps_msg_t msg,
+                          void *ctx) {
+  const uint8_t *f = (const uint8_t *)g->payload;
+  size_t len = g->rtcm.total_len;
+
+  (void)protocol;
+  (void)msg;
+  (void)ctx;
+
+  st.rtcm_in++;
+  if (len > BENCH_RTCM_MAX) {
+    return;
+  }
+
+  if (rtcm_send_to_lora(g)) {
+    if (frame_cnt == frame_cap) {
+      frame_cap = frame_cap ? frame_cap * 2 : 1024;
+      frames = realloc(frames, frame_cap * sizeof(*frames));
+      st.lat_us = realloc(st.lat_us, frame_cap * sizeof(*st.lat_us));
+    }
+    bench_frame_t *b = &frames[frame_cnt++];
+    b->data = malloc(len);
+    memcpy(b->data, f, len);
+    b->len = (uint16_t)len;
+    b->type = g->rtcm.msg_type;
+    b->arr_us = now_us;
+  }
+
+  if (rtcm_frame_ends_epoch(f, len, g->rtcm.msg_type)) {
+    epoch_end_seen = true;
+  }
+}
+
+/* ---- 측정 ---- */
+
+static int cmp_u32(const void *a, const void *b) {
+  uint32_t x = *(const uint32_t *)a;
+  uint32_t y = *(const uint32_t *)b;
+  return (x > y) - (x < y);
+}
+
+static void report(size_t src_len) {
+  uint32_t epochs = st.epochs ? st.epochs : 1;
+  double sec = now_us / 1e6;
+
+  printf("== %zu bytes, %u baud, period %u ms, loss %u/1000 burst %u, fec %u, "
+         "LoRa SF%u BW%u\n",
+         src_len, cfg.baud, cfg.period_ms, cfg.loss, cfg.burst, cfg.fec,
+         cfg.lora.sf, cfg.lora.bw);
+  printf("base  rtcm in %u, sent %zu, scheduler dropped %u, epochs %u\n",
+         st.rtcm_in, frame_cnt, st.sched_dropped, st.epochs);
+  printf("air   frags %u (lost %u), %.1f B/epoch, %.1f frags/epoch, "
+         "busy %.1f%%\n",
+         st.frags, st.frags_lost, (double)st.frag_bytes / epochs,
+         (double)st.frags / epochs, sec > 0 ? st.air_us / 1e4 / sec : 0.0);
+  printf("rover delivered %u/%zu (%.2f%%), lost %u, unmatched %u, "
+         "epochs dropped %lu, recovered %lu\n",
+         st.delivered, frame_cnt,
+         frame_cnt ? 100.0 * st.delivered / frame_cnt : 0.0,
+         st.lost + (uint32_t)(frame_cnt - match_pos), st.unmatched,
+         (unsigned long)reasm.dropped_epochs, (unsigned long)reasm.recovered);
+
+  if (st.lat_cnt) {
+    uint64_t sum = 0;
+
+    qsort(st.lat_us, st.lat_cnt, sizeof(*st.lat_us), cmp_u32);
+    for (size_t i = 0; i < st.lat_cnt; i++) {
+      sum += st.lat_us[i];
+    }
+    printf("lat   min %.1f avg %.1f p50 %.1f p99 %.1f max %.1f ms\n",
+           st.lat_us[0] / 1000.0, (double)sum / st.lat_cnt / 1000.0,
+           st.lat_us[st.lat_cnt / 2] / 1000.0,
+           st.lat_us[st.lat_cnt * 99 / 100] / 1000.0,
+           st.lat_us[st.lat_cnt - 1] / 1000.0);
+  }
+}
+
+static uint8_t *load_capture(const char *path, size_t *len) {
+  FILE *fp = fopen(path, "rb");
+  if (!fp) {
+    perror(path);
+    return NULL;
+  }
+
+  fseek(fp, 0, SEEK_END);
+  long size = ftell(fp);
+  fseek(fp, 0, SEEK_SET);
+
+  uint8_t *buf = NULL;
+  if (size > 0) {
+    buf = malloc((size_t)size);
+  }
+  if (!buf || fread(buf, 1, (size_t)size, fp) != (size_t)size) {
+    fprintf(stderr, "%s: read failed\n", path);
+    free(buf);
+    fclose(fp);
+    return NULL;
+  }
+
+  fclose(fp);
+  *len = (size_t)size;
+  return buf;
+}
+
+int main(int argc, char **argv) {
+  const char *path = NULL;
+  int i = 1;
+
+  for (; i < argc; i++) {
+    const char *o = argv[i];
+    const char *v = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+    if (o[0] != '-') {
+      path = o;
+      continue;
+    }
+    if (!v) {
+      break;
+    }
+    i++;
+    if (!strcmp(o, "-b")) {
+      cfg.baud = (uint32_t)atol(v);
+    } else if (!strcmp(o, "-p")) {
+      cfg.period_ms = (uint32_t)atol(v);
+    } else if (!strcmp(o, "-l")) {
+      cfg.loss = (uint32_t)atol(v);
+    } else if (!strcmp(o, "-B")) {
+      cfg.burst = (uint32_t)atol(v);
+    } else if (!strcmp(o, "-S")) {
+      cfg.seed = (uint32_t)atol(v);
+    } else if (!strcmp(o, "-f")) {
+      cfg.fec = (uint8_t)atoi(v);
+    } else if (!strcmp(o, "-s")) {
+      cfg.lora.sf = (uint8_t)atoi(v);
+    } else if (!strcmp(o, "-w")) {
+      cfg.lora.bw = (uint8_t)atoi(v);
+    } else if (!strcmp(o, "-L")) {
+      cfg.lora_baud = (uint32_t)atol(v);
+    } else {
+      break;
+    }
+  }
+
+  if (i < argc || !path || cfg.baud == 0 || cfg.period_ms == 0 ||
+      cfg.lora_baud == 0 || cfg.burst == 0 || cfg.loss > 1000 ||
+      lora_calc_toa_us(&cfg.lora, 1) == 0 || !rtcm_set_fec_group(cfg.fec)) {
+    fprintf(stderr,
+            "usage: %s [-b baud] [-p period_ms] [-l loss] [-B burst] [-S seed] "
+            "[-f fec] [-s sf] [-w bw] [-L lora_baud] base_capture.bin\n",
+            argv[0]);
+    return 1;
+  }
+
+  size_t src_len;
+  uint8_t *src = load_capture(path, &src_len);
+  if (!src) {
+    return 1;
+  }
+
+  gps_init(&gps);
+  gps_set_frame_buf(&gps, frame_buf, sizeof(frame_buf));
+  gps_subscribe(&gps, GPS_PROTOCOL_RTCM, GPS_SUB_ANY, bench_on_rtcm, NULL);
+  rtcm_reassembly_reset(&reasm);
+  airtime_us = 1000LL * BENCH_AIRTIME_PERMILLE;
+
+  uint64_t byte_us10 = 100000000ull / cfg.baud; // 0.1 us 단위 byte 시간 (8N1)
+  uint64_t epoch_start = 0;
+  uint64_t t10 = 0;
+
+  for (size_t pos = 0; pos < src_len; pos++) {
+    t10 += byte_us10;
+    now_us = epoch_start + t10 / 10u;
+    air_run(now_us);
+    rtcm_epoch_poll();
+
+    gps_parse_process(&gps, &src[pos], 1);
+
+    if (epoch_end_seen) {
+      // 다음 epoch 은 period 뒤 (UART 가 더 오래 걸렸으면 바로)
+      epoch_end_seen = false;
+      uint64_t next = epoch_start + (uint64_t)cfg.period_ms * 1000u;
+      epoch_start = next > now_us ? next : now_us;
+      t10 = 0;
+    }
+  }
+
+  // 남은 epoch 묶음과 큐를 다 보냄
+  for (uint32_t ms = 0; ms < 10000 && (air_cnt || ms < 200); ms++) {
+    now_us += 1000u;
+    air_run(now_us);
+    bench_tick = (TickType_t)(now_us / 1000u);
+    rtcm_epoch_poll();
+  }
+
+  report(src_len);
+  return (st.delivered == frame_cnt && st.unmatched == 0) ? 0 : 2;
+}
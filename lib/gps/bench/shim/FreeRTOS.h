@@ -0,0 +1,53 @@
+#ifndef BENCH_FREERTOS_H
+#define BENCH_FREERTOS_H
+
+/*
+ * gps_bench 호스트 빌드용 FreeRTOS shim
+ * 파서가 사용하는 타입, mutex, tick 정도만 흉내낸다.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+typedef uint32_t TickType_t;
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+typedef void *SemaphoreHandle_t;
+typedef void *QueueHandle_t;
+typedef void *TaskHandle_t;
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS 1
+#define portMAX_DELAY 0xFFFFFFFFUL
+#define configTICK_RATE_HZ 1000
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+
+#define taskENTER_CRITICAL()
+#define taskEXIT_CRITICAL()
+
+static inline void *pvPortMalloc(size_t size) { return malloc(size); }
+static inline void vPortFree(void *p) { free(p); }
+
+/* 벤치가 흘리는 가상 시각 (벤치 .c 에 정의, 안 움직이면 0) */
+extern TickType_t bench_tick;
+
+static inline TickType_t xTaskGetTickCount(void) { return bench_tick; }
+static inline void vTaskDelay(TickType_t ticks) { (void)ticks; }
+
+static inline SemaphoreHandle_t xSemaphoreCreateMutex(void) {
+  return (SemaphoreHandle_t)1;
+}
+static inline BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t t) {
+  (void)sem;
+  (void)t;
+  return pdTRUE;
+}
+static inline BaseType_t xSemaphoreGive(SemaphoreHandle_t sem) {
+  (void)sem;
+  return pdTRUE;
+}
+
+#endif
@@ -0,0 +1,6 @@
+#ifndef BENCH_SEMPHR_H
+#define BENCH_SEMPHR_H
+
+#include "FreeRTOS.h"
+
+#endif
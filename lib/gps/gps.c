@@ -1,6 +1,8 @@
 #include "gps.h"
 #include "gps_config.h"
+#include "mem_section.h"
 #include "parser.h"
+#include "simd.h"
 #include <string.h>
 
 #ifndef TAG
@@ -9,17 +11,54 @@
 
 #include "log.h"
 
+#if defined(USE_GPS_PARSE_CYCLES)
+#include "stm32f4xx.h"
+#endif
+
+/*
+ * 링 끝에서 나뉜 binary 프레임을 이어 붙이는 버퍼
+ *
+ * 링 모드에서는 프레임을 링에서 바로 읽으므로 인스턴스마다 프레임 버퍼를
+ * 두지 않는다. 나뉜 프레임만 여기로 복사하고, 수신기 여럿이 같이 쓰므로
+ * 디코더 저장 단계 동안만 mutex 로 잡는다.
+ */
+CCM_BSS static uint8_t gps_frame_scratch[GPS_PAYLOAD_SIZE];
+static SemaphoreHandle_t gps_frame_scratch_lock;
+
 static inline void add_nmea_chksum(gps_t *gps, char ch);
 static inline uint8_t check_nmea_chksum(gps_t *gps);
 static inline void term_add(gps_t *gps, char ch);
 static inline void term_next(gps_t *gps);
+static inline size_t sync_scan(const uint8_t *d, size_t len);
+static inline uint8_t check_rtcm_crc(gps_t *gps);
+static inline void frame_begin(gps_t *gps, const uint8_t *d);
+RAM_FUNC static void parse_bytes(gps_t *gps, const uint8_t *d, size_t len);
+
+/**
+ * @brief 프로토콜 시작 바이트 ('$', 0xB5, 0xAA, 0xD3)
+ *
+ * 빠진 디코더의 시작 바이트는 동기화 대상에서도 뺀다 ('$' 로 채움).
+ */
+#if defined(USE_GPS_UBLOX)
+#define GPS_SYNC_UBX 0xB5 /* UBX sync 1 */
+#else
+#define GPS_SYNC_UBX '$'
+#endif
+#if defined(USE_GPS_UNICORE)
+#define GPS_SYNC_UNICORE 0xAA /* UNICORE binary sync 1 */
+#else
+#define GPS_SYNC_UNICORE '$'
+#endif
+#define GPS_SYNC_SET SIMD_SET4('$', GPS_SYNC_UBX, GPS_SYNC_UNICORE, 0xD3 /* RTCM3 preamble */)
 
+#if defined(USE_STORE_RAW_GGA)
 void _gps_gga_raw_add(gps_t *gps, char ch) {
   if (gps->nmea_data.gga_raw_pos < 99) {
     gps->nmea_data.gga_raw[gps->nmea_data.gga_raw_pos] = ch;
     gps->nmea_data.gga_raw[++gps->nmea_data.gga_raw_pos] = '\0';
   }
 }
+#endif
 
 
 /**
@@ -55,11 +94,15 @@ static inline uint8_t check_nmea_chksum(gps_t *gps) {
 /**
  * @brief 프로토콜 페이로드 추가
  *
+ * 링 모드에서는 프레임을 링에서 바로 읽으므로 복사를 생략하고 길이만 센다.
+ *
  * @param[inout] gps
  * @param[in] ch
  */
 static inline void add_payload(gps_t *gps, char ch) {
-  if (gps->pos < GPS_PAYLOAD_SIZE - 1) {
+  if (gps->ring) {
+    gps->pos++;
+  } else if (gps->pos < (uint32_t)gps->payload_size - 1) {
     gps->payload[gps->pos] = ch;
     gps->payload[++gps->pos] = 0;
   }
@@ -89,6 +132,7 @@ static inline void term_next(gps_t *gps) {
   gps->nmea.term_num++;
 }
 
+#if defined(USE_GPS_UNICORE)
 static inline void term_add_unicore(gps_t *gps, char ch) {
   if (gps->unicore.term_pos < GPS_UNICORE_TERM_SIZE - 1) {
     gps->unicore.term_str[gps->unicore.term_pos] = ch;
@@ -123,6 +167,49 @@ static inline uint8_t check_unicore_chksum(gps_t *gps) {
 
   return 1;
 }
+#endif
+
+/**
+ * @brief 다음 프로토콜 시작 바이트 위치 탐색
+ *
+ * 프로토콜 동기화가 안된 상태에서 쓰레기 데이터를 바이트 단위 상태머신에
+ * 태우지 않고 워드 단위 비교로 한번에 건너뛴다.
+ *
+ * @param[in] d
+ * @param[in] len
+ * @return size_t 시작 바이트까지 건너뛸 바이트 수 (없으면 len)
+ */
+static inline size_t sync_scan(const uint8_t *d, size_t len) {
+  return simd_find_any4(d, len, GPS_SYNC_SET);
+}
+
+/**
+ * @brief RTCM3 CRC24Q 확인
+ *
+ * 수신 중 누적한 CRC와 패킷 끝 3바이트를 비교
+ *
+ * @param[in] gps
+ * @return uint8_t 1: success 0: fail
+ */
+static inline uint8_t check_rtcm_crc(gps_t *gps) {
+  if (gps->rtcm.crc != (gps->rtcm.crc_rx & 0xFFFFFF)) {
+    return 0;
+  }
+
+  return 1;
+}
+
+/**
+ * @brief 프레임 시작 위치 기록 (링 모드)
+ *
+ * @param[inout] gps
+ * @param[in] d 프레임 첫 바이트
+ */
+static inline void frame_begin(gps_t *gps, const uint8_t *d) {
+  if (gps->ring) {
+    gps->frame_start = (size_t)(d - gps->ring);
+  }
+}
 
 /**
  * @brief gps 객체 초기화
@@ -131,33 +218,251 @@ static inline uint8_t check_unicore_chksum(gps_t *gps) {
  */
 void gps_init(gps_t *gps) {
   memset(gps, 0, sizeof(*gps));
+  gps_sat_init(&gps->sat);
   gps->mutex = xSemaphoreCreateMutex();
+  gps->tx_mutex = xSemaphoreCreateMutex();
+  if (!gps_frame_scratch_lock) {
+    gps_frame_scratch_lock = xSemaphoreCreateMutex();
+  }
+#if defined(USE_GPS_UBLOX)
   ubx_cmd_handler_init(&gps->ubx_cmd_handler);
   ubx_init_context_init(&gps->ubx_init_ctx);
+#endif
 }
 
 /**
  * @brief GPS 프로토콜 파싱
  *
+ * 데이터가 호출 이후 유지되지 않으므로 gps_get_frame()은 사용할 수 없다.
+ *
  * @param[inout] gps
  * @param[in] data
  * @param[in] len
  */
 void gps_parse_process(gps_t *gps, const void *data, size_t len) {
-  const uint8_t *d = data;
+  if (!gps->payload) {
+    LOG_ERR("gps_parse_process: frame buffer not set");
+    return;
+  }
+
+  gps->ring = NULL;
+  parse_bytes(gps, data, len);
+}
+
+/**
+ * @brief 선형 모드 (gps_parse_process) 프레임 버퍼 연결
+ *
+ * 링 모드만 쓰는 인스턴스는 버퍼가 필요 없다. 버퍼보다 긴 프레임은 버린다.
+ *
+ * @param[inout] gps
+ * @param[in] buf
+ * @param[in] size 최대 GPS_PAYLOAD_SIZE 까지 사용
+ */
+void gps_set_frame_buf(gps_t *gps, void *buf, size_t size) {
+  gps->payload = buf;
+  gps->payload_size = (uint16_t)(size < GPS_PAYLOAD_SIZE ? size : GPS_PAYLOAD_SIZE);
+}
+
+/**
+ * @brief binary 디코더가 받을 수 있는 최대 프레임 길이
+ *
+ * 링 모드는 링과 공유 버퍼에 다 들어가야 하고, 선형 모드는 프레임 버퍼 크기.
+ */
+size_t _gps_frame_cap(const gps_t *gps) {
+  if (gps->ring) {
+    return gps->ring_size < sizeof(gps_frame_scratch) ? gps->ring_size
+                                                      : sizeof(gps_frame_scratch);
+  }
+  return gps->payload_size ? (size_t)gps->payload_size - 1 : 0;
+}
+
+/**
+ * @brief 완료된 binary 프레임을 연속 메모리로 가져오기 (디코더 저장 단계)
+ *
+ * 선형 모드는 프레임 버퍼, 링 모드는 링을 그대로 가리키고 링 끝에서 나뉜
+ * 프레임만 공유 버퍼에 이어 붙인다. _gps_frame_release() 까지 유효하다.
+ *
+ * @param[inout] gps
+ * @param[in] skip 프레임 시작 바이트에서 디코더 데이터까지 (선형 모드 버퍼에 없는 sync)
+ * @param[in] len 데이터 길이 (_gps_frame_cap() 이하)
+ * @return const uint8_t*
+ */
+const uint8_t *_gps_frame_acquire(gps_t *gps, size_t skip, size_t len) {
+  if (!gps->ring) {
+    gps->frame = (const uint8_t *)gps->payload;
+    return gps->frame;
+  }
+
+  size_t start = gps->frame_start + skip;
+  if (start >= gps->ring_size) {
+    start -= gps->ring_size;
+  }
+
+  if (start + len <= gps->ring_size) {
+    gps->frame = &gps->ring[start];
+    return gps->frame;
+  }
+
+  size_t first = gps->ring_size - start;
+  if (len > sizeof(gps_frame_scratch)) {
+    len = sizeof(gps_frame_scratch);
+  }
+
+  xSemaphoreTake(gps_frame_scratch_lock, portMAX_DELAY);
+  gps->frame_locked = true;
+  memcpy(gps_frame_scratch, &gps->ring[start], first);
+  memcpy(&gps_frame_scratch[first], gps->ring, len - first);
+  gps->frame = gps_frame_scratch;
+
+  return gps->frame;
+}
+
+void _gps_frame_release(gps_t *gps) {
+  gps->frame = NULL;
+  if (gps->frame_locked) {
+    gps->frame_locked = false;
+    xSemaphoreGive(gps_frame_scratch_lock);
+  }
+}
+
+/**
+ * @brief 수신 링버퍼 구간 파싱
+ *
+ * [from, to) 구간을 파싱하며 to < from 이면 링 끝에서 나뉜 것으로 처리한다.
+ * 이벤트 핸들러 안에서 gps_get_frame()으로 현재 프레임을 링에서 바로 볼 수
+ * 있다.
+ *
+ * @param[inout] gps
+ * @param[in] ring 링버퍼 시작 주소
+ * @param[in] ring_size 링버퍼 크기
+ * @param[in] from 시작 인덱스
+ * @param[in] to 끝 인덱스 (미포함)
+ */
+void gps_parse_ring(gps_t *gps, const void *ring, size_t ring_size,
+                    size_t from, size_t to) {
+  const uint8_t *r = ring;
+
+  gps->ring = r;
+  gps->ring_size = ring_size;
+
+  if (to >= from) {
+    parse_bytes(gps, &r[from], to - from);
+  } else {
+    parse_bytes(gps, &r[from], ring_size - from);
+    parse_bytes(gps, r, to);
+  }
+}
+
+/**
+ * @brief 현재 프레임 뷰 가져오기
+ *
+ * gps_parse_ring()으로 파싱 중일 때 이벤트 핸들러 안에서만 유효하다.
+ * 프레임을 링 이후까지 보관해야 하면 호출자가 복사한다.
+ *
+ * @param[in] gps
+ * @param[out] frame
+ * @return true: 성공, false: 링 모드 아님
+ */
+bool gps_get_frame(const gps_t *gps, gps_frame_t *frame) {
+  if (!gps->ring) {
+    return false;
+  }
+
+  size_t end = (size_t)(gps->cur - gps->ring) + 1;
+
+  frame->seg[0] = &gps->ring[gps->frame_start];
+  if (end > gps->frame_start) {
+    frame->len[0] = end - gps->frame_start;
+    frame->seg[1] = NULL;
+    frame->len[1] = 0;
+  } else {
+    frame->len[0] = gps->ring_size - gps->frame_start;
+    frame->seg[1] = gps->ring;
+    frame->len[1] = end;
+  }
+
+  return true;
+}
+
+/**
+ * @brief RX 링 overrun 처리 (수신 태스크, gps->mutex 잡은 상태)
+ *
+ * 건너뛴 구간에 걸친 프레임은 앞뒤가 이어 붙으므로 파싱 중이던 프레임을
+ * 버리고 다음 시작 바이트부터 다시 동기화한다.
+ *
+ * @param[inout] gps
+ * @param[in] lost 건너뛴 바이트 수
+ */
+void gps_parse_overrun(gps_t *gps, uint32_t lost) {
+  gps->pos = 0;
+  gps->protocol = GPS_PROTOCOL_NONE;
+  gps->state = GPS_PARSE_STATE_NONE;
+
+  gps->stats.rx_overrun++;
+  gps->stats.rx_lost += lost;
+}
+
+/**
+ * @brief 파서 통계 복사
+ *
+ * gps->mutex를 잡으므로 이벤트 핸들러 안에서는 호출하지 않는다.
+ *
+ * @param[in] gps
+ * @param[out] stats
+ */
+void gps_get_stats(gps_t *gps, gps_stats_t *stats) {
+  xSemaphoreTake(gps->mutex, portMAX_DELAY);
+  memcpy(stats, &gps->stats, sizeof(*stats));
+  xSemaphoreGive(gps->mutex);
+}
+
+/**
+ * @brief 파서 통계 초기화
+ *
+ * gps->mutex를 잡으므로 이벤트 핸들러 안에서는 호출하지 않는다.
+ *
+ * @param[inout] gps
+ */
+void gps_reset_stats(gps_t *gps) {
+  xSemaphoreTake(gps->mutex, portMAX_DELAY);
+  memset(&gps->stats, 0, sizeof(gps->stats));
+  xSemaphoreGive(gps->mutex);
+}
+
+RAM_FUNC static void parse_bytes(gps_t *gps, const uint8_t *d, size_t len) {
+#if defined(USE_GPS_PARSE_CYCLES)
+  uint32_t start_cycle = DWT->CYCCNT;
+#endif
 
   for (; len > 0; ++d, --len) {
-    /* @TODO GPS_PROTOCOL_NONE 일때 start 문자 찾는걸 만들고, 프로토콜에 따라
-     * 다르게 파싱하게끔 만들기 */
+    /* 동기화 안된 상태: 다음 시작 바이트까지 한번에 건너뛰기 */
+    if (gps->protocol == GPS_PROTOCOL_NONE &&
+        gps->state == GPS_PARSE_STATE_NONE) {
+      size_t skip = sync_scan(d, len);
+
+      gps->stats.discarded += skip;
+      d += skip;
+      len -= skip;
+
+      if (len == 0) {
+        break;
+      }
+    }
+
+    gps->cur = d;
+
     if (gps->protocol == GPS_PROTOCOL_NONE) {
       if (*d == '$') {
         memset(&gps->nmea, 0, sizeof(gps->nmea));
+        frame_begin(gps, d);
 
         gps->protocol = GPS_PROTOCOL_NMEA;
         gps->state = GPS_PARSE_STATE_NMEA_START;
       } 
+#if defined(USE_GPS_UBLOX)
       /* UBX binary */
       else if (*d == 0xB5 && gps->state == GPS_PARSE_STATE_NONE) {
+        frame_begin(gps, d);
         gps->state = GPS_PARSE_STATE_UBX_SYNC_1;
       } 
       else if (*d == 0x62 && gps->state == GPS_PARSE_STATE_UBX_SYNC_1) {
@@ -166,8 +471,11 @@ void gps_parse_process(gps_t *gps, const void *data, size_t len) {
         gps->protocol = GPS_PROTOCOL_UBX;
         gps->state = GPS_PARSE_STATE_UBX_SYNC_2;
       } 
+#endif
+#if defined(USE_GPS_UNICORE)
       /* UNICORE binary */
       else if(*d == 0xAA && gps->state == GPS_PARSE_STATE_NONE) {
+        frame_begin(gps, d);
         gps->state = GPS_PARSE_STATE_UNICORE_SYNC1;
         gps->pos = 0;
         add_payload(gps, *d);
@@ -181,9 +489,12 @@ void gps_parse_process(gps_t *gps, const void *data, size_t len) {
         gps->protocol = GPS_PROTOCOL_UNICORE_BIN;
         gps->state = GPS_PARSE_STATE_UNICORE_SYNC3;
       }
+#endif
       /* RTCM3 */
       else if(*d == 0xD3 && gps->state == GPS_PARSE_STATE_NONE) {
         memset(&gps->rtcm, 0, sizeof(gps->rtcm));
+        frame_begin(gps, d);
+        gps->rtcm.crc = rtcm_crc24q_update(0, d, 1);
         gps->pos = 0;
         add_payload(gps, *d);
         gps->protocol = GPS_PROTOCOL_RTCM;
@@ -191,25 +502,50 @@ void gps_parse_process(gps_t *gps, const void *data, size_t len) {
       }
       /* 재시도 로직 */
       else {
+#if defined(USE_GPS_UBLOX)
+        if (gps->state == GPS_PARSE_STATE_UBX_SYNC_1) {
+          GPS_STATS_INC(gps, GPS_PROTOCOL_UBX, resync);
+        }
+#endif
+#if defined(USE_GPS_UNICORE)
+        if (gps->state == GPS_PARSE_STATE_UNICORE_SYNC1 ||
+            gps->state == GPS_PARSE_STATE_UNICORE_SYNC2) {
+          GPS_STATS_INC(gps, GPS_PROTOCOL_UNICORE_BIN, resync);
+        }
+#endif
         gps->state = GPS_PARSE_STATE_NONE;
 
         if (*d == '$') {
           memset(&gps->nmea, 0, sizeof(gps->nmea));
+          frame_begin(gps, d);
           gps->protocol = GPS_PROTOCOL_NMEA;
           gps->state = GPS_PARSE_STATE_NMEA_START;
         } else if (*d == 0xD3) {
           memset(&gps->rtcm, 0, sizeof(gps->rtcm));
+          frame_begin(gps, d);
+          gps->rtcm.crc = rtcm_crc24q_update(0, d, 1);
           gps->pos = 0;
           add_payload(gps, *d);
           gps->protocol = GPS_PROTOCOL_RTCM;
           gps->state = GPS_PARSE_STATE_RTCM_PREAMBLE;
-        }else if (*d == 0xB5) {
+        }
+#if defined(USE_GPS_UBLOX)
+        else if (*d == 0xB5) {
+          frame_begin(gps, d);
           gps->state = GPS_PARSE_STATE_UBX_SYNC_1;
-        } else if (*d == 0xAA) {
+        }
+#endif
+#if defined(USE_GPS_UNICORE)
+        else if (*d == 0xAA) {
+          frame_begin(gps, d);
           gps->state = GPS_PARSE_STATE_UNICORE_SYNC1;
           gps->pos = 0;
           add_payload(gps, *d);
         }
+#endif
+        else {
+          gps->stats.discarded++;
+        }
       }
     } 
     else if (gps->protocol == GPS_PROTOCOL_NMEA) {
@@ -220,6 +556,7 @@ void gps_parse_process(gps_t *gps, const void *data, size_t len) {
 #endif
 
       if (*d == ',') {
+#if defined(USE_GPS_UNICORE)
             if (gps->nmea.term_num == 0 && strcmp(gps->nmea.term_str, "command") == 0) {
 
             	memset(&gps->unicore, 0, sizeof(gps->unicore));
@@ -230,7 +567,9 @@ void gps_parse_process(gps_t *gps, const void *data, size_t len) {
               gps->unicore.msg_type = GPS_UNICORE_MSG_COMMAND;
               add_unicore_chksum(gps, *d);
               term_next_unicore(gps);
-            } else {
+            } else
+#endif
+            {
               gps_parse_nmea_term(gps);
               add_nmea_chksum(gps, *d);
               term_next(gps);
@@ -254,10 +593,15 @@ void gps_parse_process(gps_t *gps, const void *data, size_t len) {
 #endif
           gps_msg_t msg;
           msg.nmea = gps->nmea.msg_type;
-          
-          if (gps->handler) {
-            gps->handler(gps, GPS_EVENT_DATA_PARSED, GPS_PROTOCOL_NMEA, msg);
+          GPS_STATS_INC(gps, GPS_PROTOCOL_NMEA, frame_ok);
+          gps_nav_publish(gps, GPS_PROTOCOL_NMEA, msg);
+          if (msg.nmea == GPS_NMEA_MSG_GSV) {
+            gps_sat_gsv_commit(gps);
           }
+
+          gps_dispatch(gps, GPS_PROTOCOL_NMEA, msg);
+        } else {
+          GPS_STATS_INC(gps, GPS_PROTOCOL_NMEA, chksum_err);
         }
 
         gps->pos = 0;
@@ -269,10 +613,14 @@ void gps_parse_process(gps_t *gps, const void *data, size_t len) {
         }
         term_add(gps, *d);
       }
-    } else if (gps->protocol == GPS_PROTOCOL_UBX) {
+    }
+#if defined(USE_GPS_UBLOX)
+    else if (gps->protocol == GPS_PROTOCOL_UBX) {
       add_payload(gps, *d);
       gps_parse_ubx(gps);
     } 
+#endif
+#if defined(USE_GPS_UNICORE)
     else if(gps->protocol == GPS_PROTOCOL_UNICORE)
     {
       if (*d == ',') {
@@ -298,14 +646,14 @@ void gps_parse_process(gps_t *gps, const void *data, size_t len) {
         if (check_unicore_chksum(gps)) {
           gps_msg_t msg;
           msg.unicore.response = gps->unicore.response;
+          GPS_STATS_INC(gps, GPS_PROTOCOL_UNICORE, frame_ok);
 
-          if (gps->handler) {
-            gps->handler(gps, GPS_EVENT_DATA_PARSED, gps->protocol, msg);
-          }
+          gps_dispatch(gps, GPS_PROTOCOL_UNICORE, msg);
+        } else {
+          GPS_STATS_INC(gps, GPS_PROTOCOL_UNICORE, chksum_err);
         }
 
         memset(&gps->unicore, 0, sizeof(gps->unicore));
-        memset(gps->payload, 0, sizeof(gps->payload));
         gps->protocol = GPS_PROTOCOL_NONE;
         gps->state = GPS_PARSE_STATE_NONE;
       } else {
@@ -321,8 +669,17 @@ void gps_parse_process(gps_t *gps, const void *data, size_t len) {
       add_payload(gps, *d);
       gps_parse_unicore_bin(gps);
     }
+#endif
     else if (gps->protocol == GPS_PROTOCOL_RTCM) {
       add_payload(gps, *d);
+      /* 헤더 + 페이로드 구간은 수신하면서 CRC 누적 (CRC 3바이트 제외) */
+      if (gps->state != GPS_PARSE_STATE_RTCM_PAYLOAD ||
+          gps->pos <= (uint32_t)gps->rtcm.total_len - 3) {
+        gps->rtcm.crc = rtcm_crc24q_update(gps->rtcm.crc, d, 1);
+      } else {
+        gps->rtcm.crc_rx = (gps->rtcm.crc_rx << 8) | *d;
+      }
+
       if (gps->state == GPS_PARSE_STATE_RTCM_PREAMBLE) {
     	gps->rtcm.msg_len = (*d & 0x03) << 8;
         gps->state = GPS_PARSE_STATE_RTCM_LEN_1;
@@ -332,6 +689,14 @@ void gps_parse_process(gps_t *gps, const void *data, size_t len) {
         gps->rtcm.total_len = 3 + gps->rtcm.msg_len + 3;  // 헤더(3) + 페이로드 + CRC(3)
         gps->rtcm.payload_cnt = 0;
         gps->state = GPS_PARSE_STATE_RTCM_PAYLOAD;
+
+        /* 버퍼(payload 또는 링)에 다 들어가지 않는 길이는 완료될 수 없으므로 버림 */
+        size_t cap = gps->ring ? gps->ring_size : (size_t)gps->payload_size - 1;
+        if (gps->rtcm.total_len > cap) {
+          GPS_STATS_INC(gps, GPS_PROTOCOL_RTCM, oversize);
+          gps->protocol = GPS_PROTOCOL_NONE;
+          gps->state = GPS_PARSE_STATE_NONE;
+        }
       }
       else if (gps->state == GPS_PARSE_STATE_RTCM_PAYLOAD) {
         gps->rtcm.payload_cnt++;
@@ -343,24 +708,83 @@ void gps_parse_process(gps_t *gps, const void *data, size_t len) {
         }
 
         if (gps->pos >= gps->rtcm.total_len) {
-          gps_msg_t msg;
-          msg.rtcm.msg_type = gps->rtcm.msg_type;
-          if (gps->handler) {
-            gps->handler(gps, GPS_EVENT_DATA_PARSED, GPS_PROTOCOL_RTCM, msg);
+          if (check_rtcm_crc(gps)) {
+            gps_msg_t msg;
+            msg.rtcm.msg_type = gps->rtcm.msg_type;
+            GPS_STATS_INC(gps, GPS_PROTOCOL_RTCM, frame_ok);
+            gps_dispatch(gps, GPS_PROTOCOL_RTCM, msg);
+          } else {
+            GPS_STATS_INC(gps, GPS_PROTOCOL_RTCM, chksum_err);
+            LOG_WARN("RTCM CRC mismatch (type=%d, len=%d)",
+                     gps->rtcm.msg_type, gps->rtcm.total_len);
           }
 
           memset(&gps->rtcm, 0, sizeof(gps->rtcm));
-          memset(gps->payload, 0, sizeof(gps->payload));
+          gps->pos = 0;
           gps->protocol = GPS_PROTOCOL_NONE;
           gps->state = GPS_PARSE_STATE_NONE;
         }
       }
     }
   }
+
+#if defined(USE_GPS_PARSE_CYCLES)
+  gps->stats.parse_cycles += DWT->CYCCNT - start_cycle;
+#endif
+}
+
+/**
+ * @brief 메시지 구독 등록
+ *
+ * 파싱 시작 전 (수신 태스크 시작 시) 에 등록한다. 같은 키에 여러 콜백을
+ * 둘 수 있고 등록 순서대로 불린다.
+ *
+ * @param[inout] gps
+ * @param[in] protocol
+ * @param[in] key gps_msg_key() 값 (UBX 는 GPS_UBX_KEY) 또는 GPS_SUB_ANY
+ * @param[in] cb
+ * @param[in] ctx 콜백에 그대로 넘김
+ * @return true 등록됨, false 표가 가득 참
+ */
+bool gps_subscribe(gps_t *gps, gps_procotol_t protocol, uint16_t key,
+                   gps_msg_cb_t cb, void *ctx) {
+  if (!cb || protocol >= GPS_STATS_PROTOCOL_CNT) {
+    return false;
+  }
+
+  gps_sub_table_t *t = &gps->subs[protocol];
+  if (t->cnt >= GPS_SUB_MAX) {
+    LOG_ERR("GPS subscribe table full (protocol=%d)", protocol);
+    return false;
+  }
+
+  t->sub[t->cnt].key = key;
+  t->sub[t->cnt].cb = cb;
+  t->sub[t->cnt].ctx = ctx;
+  t->cnt++;
+  if (key == GPS_SUB_ANY) {
+    t->any = true;
+  }
+
+  return true;
 }
 
-void gps_set_evt_handler(gps_t *gps, evt_handler handler) {
-  if (handler) {
-    gps->handler = handler;
+/**
+ * @brief 메시지 구독자 존재 여부
+ *
+ * 파서가 구독자 없는 메시지의 저장을 건너뛰는 데 쓴다.
+ */
+bool gps_is_subscribed(const gps_t *gps, gps_procotol_t protocol, uint16_t key) {
+  const gps_sub_table_t *t = &gps->subs[protocol];
+
+  if (t->any) {
+    return true;
   }
+  for (uint8_t i = 0; i < t->cnt; i++) {
+    if (t->sub[i].key == key) {
+      return true;
+    }
+  }
+
+  return false;
 }
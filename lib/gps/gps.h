@@ -4,6 +4,8 @@
 #include "FreeRTOS.h"
 #include "gps_types.h"
 #include "gps_nmea.h"
+#include "gps_nav.h"
+#include "gps_sat.h"
 #include "gps_ubx.h"
 #include "gps_unicore.h"
 #include "rtcm.h"
@@ -12,6 +14,7 @@
 #include <stdint.h>
 #include <stdio.h>
 
+/* 파서가 받는 최대 프레임 (RTCM3 최대 길이) */
 #define GPS_PAYLOAD_SIZE 1029
 
 typedef struct {
@@ -23,8 +26,72 @@ typedef struct {
   int (*recv)(char *buf, size_t len);
 } gps_hal_ops_t;
 
-typedef void (*evt_handler)(gps_t *gps, gps_event_t event,
-                            gps_procotol_t protocol, gps_msg_t msg);
+/**
+ * @brief 메시지 수신 콜백 (파싱 태스크 컨텍스트)
+ *
+ * gps_subscribe() 로 등록한다. 프레임 데이터는 콜백 안에서만 유효하다.
+ */
+typedef void (*gps_msg_cb_t)(gps_t *gps, gps_procotol_t protocol,
+                             gps_msg_t msg, void *ctx);
+
+/* 프로토콜별 구독 수 (gps_t 마다 들고 있으므로 작게) */
+#define GPS_SUB_MAX 8
+
+/* 구독 키: 해당 프로토콜의 모든 메시지 */
+#define GPS_SUB_ANY 0xFFFFU
+
+/* UBX 구독 키 (class << 8 | id) */
+#define GPS_UBX_KEY(cls, id) ((uint16_t)(((cls) << 8) | (id)))
+
+typedef struct {
+  uint16_t key;
+  gps_msg_cb_t cb;
+  void *ctx;
+} gps_sub_t;
+
+/**
+ * @brief 프로토콜 하나의 구독 표
+ */
+typedef struct {
+  gps_sub_t sub[GPS_SUB_MAX];
+  uint8_t cnt;
+  bool any; // GPS_SUB_ANY 구독 존재
+} gps_sub_table_t;
+
+/**
+ * @brief 수신 프레임 뷰
+ *
+ * 수신 링버퍼를 직접 가리키며, 링 끝에서 나뉜 프레임은 2구간으로 표현
+ */
+typedef struct {
+  const uint8_t *seg[2];
+  size_t len[2];
+} gps_frame_t;
+
+/**
+ * @brief 프로토콜별 파서 통계
+ */
+typedef struct {
+  uint32_t frame_ok;    // 정상 수신 프레임 수
+  uint32_t chksum_err;  // 체크섬/CRC 실패 수
+  uint32_t oversize;    // 버퍼를 넘는 길이로 버린 프레임 수
+  uint32_t resync;      // 동기 바이트 수신 후 동기화 실패 수
+} gps_proto_stats_t;
+
+#define GPS_STATS_PROTOCOL_CNT (GPS_PROTOCOL_RTCM + 1)
+
+/**
+ * @brief GPS 파서 통계
+ */
+typedef struct {
+  gps_proto_stats_t proto[GPS_STATS_PROTOCOL_CNT]; // gps_procotol_t 인덱스
+  uint32_t discarded;     // GPS_PROTOCOL_NONE 상태에서 버린 바이트 수
+  uint32_t rx_overrun;    // RX 링을 DMA 가 한 바퀴 이상 앞질러 건너뛴 횟수
+  uint32_t rx_lost;       // overrun 으로 건너뛴 바이트 수
+  uint32_t parse_cycles;  // 파싱 누적 DWT cycle (USE_GPS_PARSE_CYCLES)
+} gps_stats_t;
+
+#define GPS_STATS_INC(gps, protocol, field) ((gps)->stats.proto[(protocol)].field++)
 
 typedef enum {
   GPS_INIT_NONE = 0,
@@ -40,40 +107,119 @@ typedef struct gps_s {
   gps_init_state_t init_state;
 
   /* os variable */
-  SemaphoreHandle_t mutex;
+  SemaphoreHandle_t mutex;    // 파서 상태 (RX 태스크)
+  SemaphoreHandle_t tx_mutex; // 명령 송신 (파서와 따로 잡음)
 
   /* hal */
   const gps_hal_ops_t *ops;
 
   /* parse */
   gps_parse_state_t state;
-  char payload[GPS_PAYLOAD_SIZE];
+  char *payload;         // 선형 모드 프레임 버퍼 (gps_set_frame_buf), 링 모드는 안 씀
+  uint16_t payload_size;
   uint32_t pos;
+  const uint8_t *frame;  // 완료된 binary 프레임 (디코더 저장 단계에서만 유효)
+  bool frame_locked;     // frame 이 공유 버퍼를 잡고 있음
+
+  /* rx ring (gps_parse_ring 사용 시에만 유효) */
+  const uint8_t *ring;
+  size_t ring_size;
+  const uint8_t *cur;   // 현재 처리 중인 바이트
+  size_t frame_start;   // 현재 프레임 시작 바이트의 링 인덱스
 
-  /* protocol header */
+  /* protocol header (보드에 없는 수신기 디코더는 빠짐, gps_config.h) */
   gps_nmea_parser_t nmea;
+#if defined(USE_GPS_UBLOX)
   gps_ubx_parser_t ubx;
+#endif
+#if defined(USE_GPS_UNICORE)
   gps_unicore_parser_t unicore;
   gps_unicore_bin_parser_t unicore_bin;
+#endif
   gps_rtcm_parser_t rtcm;
 
   /* info */
   gps_nmea_data_t nmea_data;
+#if defined(USE_GPS_UBLOX)
   gps_ubx_data_t ubx_data;
+#endif
+#if defined(USE_GPS_UNICORE)
   gps_unicore_bin_data_t unicore_bin_data;
+#endif
+  gps_nav_t nav; // 프레임 완료 시점 값, gps_nav_read() 로 lock 없이 읽기
+  gps_sat_table_t sat; // 위성별 신호, gps_sat_summary() 로 읽기
 
+#if defined(USE_GPS_UBLOX)
   ubx_cmd_handler_t ubx_cmd_handler;
 
   ubx_init_context_t ubx_init_ctx;
-  /* evt handler */
-  evt_handler handler;
+#endif
+
+  /* stats */
+  gps_stats_t stats;
+
+  /* 메시지 구독 (gps_procotol_t 인덱스) */
+  gps_sub_table_t subs[GPS_STATS_PROTOCOL_CNT];
 } gps_t;
 
 void gps_init(gps_t *gps);
+void gps_set_frame_buf(gps_t *gps, void *buf, size_t size);
 void gps_parse_process(gps_t *gps, const void *data, size_t len);
-void gps_set_evt_handler(gps_t *gps, evt_handler handler);
+void gps_parse_ring(gps_t *gps, const void *ring, size_t ring_size,
+                    size_t from, size_t to);
+bool gps_get_frame(const gps_t *gps, gps_frame_t *frame);
+void gps_parse_overrun(gps_t *gps, uint32_t lost);
+void gps_get_stats(gps_t *gps, gps_stats_t *stats);
+void gps_reset_stats(gps_t *gps);
+bool gps_subscribe(gps_t *gps, gps_procotol_t protocol, uint16_t key,
+                   gps_msg_cb_t cb, void *ctx);
+bool gps_is_subscribed(const gps_t *gps, gps_procotol_t protocol, uint16_t key);
+
+/**
+ * @brief 메시지 구독 키
+ *
+ * Unicore ASCII 응답은 메시지 구분이 없어 GPS_SUB_ANY 로만 구독한다.
+ */
+static inline uint16_t gps_msg_key(gps_procotol_t protocol, gps_msg_t msg) {
+  switch (protocol) {
+  case GPS_PROTOCOL_NMEA:
+    return msg.nmea;
+  case GPS_PROTOCOL_UBX:
+    return GPS_UBX_KEY(msg.ubx.class, msg.ubx.id);
+  case GPS_PROTOCOL_UNICORE_BIN:
+    return msg.unicore_bin.msg;
+  case GPS_PROTOCOL_RTCM:
+    return msg.rtcm.msg_type;
+  default:
+    return GPS_SUB_ANY;
+  }
+}
+
+/**
+ * @brief 완료된 프레임을 구독자에게 전달
+ *
+ * 구독자가 없는 프로토콜은 표 하나만 보고 바로 돌아간다.
+ */
+static inline void gps_dispatch(gps_t *gps, gps_procotol_t protocol,
+                                gps_msg_t msg) {
+  const gps_sub_table_t *t = &gps->subs[protocol];
+
+  if (!t->cnt) {
+    return;
+  }
+
+  uint16_t key = gps_msg_key(protocol, msg);
+  for (uint8_t i = 0; i < t->cnt; i++) {
+    if (t->sub[i].key == key || t->sub[i].key == GPS_SUB_ANY) {
+      t->sub[i].cb(gps, protocol, msg, t->sub[i].ctx);
+    }
+  }
+}
 
 /* internal */
 void _gps_gga_raw_add(gps_t *gps, char ch);
+size_t _gps_frame_cap(const gps_t *gps);
+const uint8_t *_gps_frame_acquire(gps_t *gps, size_t skip, size_t len);
+void _gps_frame_release(gps_t *gps);
 
 #endif
@@ -0,0 +1,235 @@
+#include "gps_nav.h"
+#include "gps.h"
+#include "task.h"
+#include <math.h>
+
+/* 같은 코어의 태스크 사이라도 컴파일러가 seq 와 데이터 접근 순서를 바꾸지 않도록 */
+#define GPS_NAV_BARRIER() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+
+static inline void nav_write_begin(gps_nav_t *nav) {
+  nav->seq++;
+  GPS_NAV_BARRIER();
+}
+
+static inline void nav_write_end(gps_nav_t *nav) {
+  GPS_NAV_BARRIER();
+  nav->seq++;
+}
+
+#if defined(USE_GPS_UBLOX)
+/**
+ * @brief NAV-PVT fixType/flags 를 GGA 와 같은 fix 품질로
+ */
+static gps_fix_t nav_fix_from_pvt(const gps_ubx_nav_pvt_t *pvt) {
+  if (pvt->fix_type == 5) {
+    return GPS_FIX_MANUAL_POS; // time only (기준국 fixed 모드)
+  }
+  if (pvt->fix_type == 1) {
+    return GPS_FIX_DR;
+  }
+  if (!pvt->flags.gnss_fix_ok || pvt->fix_type == 0) {
+    return GPS_FIX_INVALID;
+  }
+  if (pvt->flags.carr_soln == 2) {
+    return GPS_FIX_RTK_FIX;
+  }
+  if (pvt->flags.carr_soln == 1) {
+    return GPS_FIX_RTK_FLOAT;
+  }
+  return pvt->flags.diff_soln ? GPS_FIX_DGPS : GPS_FIX_GPS;
+}
+#endif
+
+#if defined(USE_GPS_UNICORE)
+/**
+ * @brief Unicore 해 상태/pos_type 을 GGA 와 같은 fix 품질로
+ */
+static gps_fix_t nav_fix_from_unicore(uint32_t sol_status, uint32_t pos_type) {
+  if (sol_status != 0) {
+    return GPS_FIX_INVALID;
+  }
+
+  switch (pos_type) {
+  case GPS_UNICORE_POS_NONE:
+    return GPS_FIX_INVALID;
+  case GPS_UNICORE_POS_FIXEDPOS:
+  case GPS_UNICORE_POS_FIXEDHEIGHT:
+    return GPS_FIX_MANUAL_POS;
+  case GPS_UNICORE_POS_PSRDIFF:
+  case GPS_UNICORE_POS_SBAS:
+    return GPS_FIX_DGPS;
+  case GPS_UNICORE_POS_L1_FLOAT:
+  case GPS_UNICORE_POS_IONOFREE_FLOAT:
+  case GPS_UNICORE_POS_NARROW_FLOAT:
+    return GPS_FIX_RTK_FLOAT;
+  case GPS_UNICORE_POS_L1_INT:
+  case GPS_UNICORE_POS_WIDE_INT:
+  case GPS_UNICORE_POS_NARROW_INT:
+    return GPS_FIX_RTK_FIX;
+  default:
+    return GPS_FIX_GPS;
+  }
+}
+#endif
+
+/**
+ * @brief 검증된 프레임의 항법 값을 nav 에 게시 (파서 전용)
+ *
+ * 체크섬 통과 후 이벤트 핸들러 호출 전에 불린다. 파싱 도중 필드 단위로
+ * 쓰이는 nmea_data/ubx_data 대신 이 값을 읽으면 찢어진 값을 보지 않는다.
+ *
+ * @param[inout] gps
+ * @param[in] protocol
+ * @param[in] msg
+ */
+void gps_nav_publish(gps_t *gps, gps_procotol_t protocol, gps_msg_t msg) {
+  gps_nav_t *nav = &gps->nav;
+
+  switch (protocol) {
+  case GPS_PROTOCOL_NMEA:
+    if (msg.nmea == GPS_NMEA_MSG_GGA) {
+      const gps_gga_t *gga = &gps->nmea_data.gga;
+
+      nav_write_begin(nav);
+      nav->data.fix = gga->fix;
+      nav->data.sat_num = gga->sat_num;
+      nav->data.hdop = gga->hdop;
+      nav->data.ns = gga->ns;
+      nav->data.ew = gga->ew;
+      nav_write_end(nav);
+    } else if (msg.nmea == GPS_NMEA_MSG_THS) {
+      nav_write_begin(nav);
+      nav->data.heading = gps->nmea_data.ths.heading;
+      nav_write_end(nav);
+    }
+    break;
+
+#if defined(USE_GPS_UBLOX)
+  case GPS_PROTOCOL_UBX:
+    if (msg.ubx.class != GPS_UBX_CLASS_NAV) {
+      break;
+    }
+
+    if (msg.ubx.id == GPS_UBX_NAV_ID_PVT) {
+      const gps_ubx_nav_pvt_t *pvt = &gps->ubx_data.pvt;
+
+      nav_write_begin(nav);
+      nav->data.itow = pvt->tow;
+      nav->data.itow_tick = xTaskGetTickCount();
+      nav->data.fix = nav_fix_from_pvt(pvt);
+      nav->data.sat_num = pvt->num_sv;
+      nav->data.pdop = pvt->pdop * 0.01f;
+      nav->data.llh.lat = gps_llh_from_ubx_deg(pvt->lat, 0);
+      nav->data.llh.lon = gps_llh_from_ubx_deg(pvt->lon, 0);
+      nav->data.llh.ellipsoid_alt = gps_llh_from_ubx_alt(pvt->height, 0);
+      nav->data.llh.msl_alt = gps_llh_from_ubx_alt(pvt->msl, 0);
+      nav->data.ns = pvt->lat >= 0 ? 'N' : 'S';
+      nav->data.ew = pvt->lon >= 0 ? 'E' : 'W';
+      nav->data.h_acc = pvt->hacc * 1e-3f;
+      nav->data.v_acc = pvt->vacc * 1e-3f;
+      nav->data.vel_n = pvt->vel_n;
+      nav->data.vel_e = pvt->vel_e;
+      nav->data.vel_d = pvt->vel_d;
+      nav->data.g_speed = pvt->g_speed;
+      nav_write_end(nav);
+    } else if (msg.ubx.id == GPS_UBX_NAV_ID_HPPOSLLH) {
+      const gps_ubx_nav_hpposllh_t *hp = &gps->ubx_data.hpposllh;
+
+      nav_write_begin(nav);
+      nav->data.itow = hp->tow;
+      nav->data.itow_tick = xTaskGetTickCount();
+      nav->data.llh.lat = gps_llh_from_ubx_deg(hp->lat, hp->lat_hp);
+      nav->data.llh.lon = gps_llh_from_ubx_deg(hp->lon, hp->lon_hp);
+      nav->data.llh.ellipsoid_alt = gps_llh_from_ubx_alt(hp->height, hp->height_hp);
+      nav->data.llh.msl_alt = gps_llh_from_ubx_alt(hp->msl, hp->msl_hp);
+      nav->data.h_acc = hp->hacc * 1e-4f;
+      nav->data.v_acc = hp->vacc * 1e-4f;
+      nav_write_end(nav);
+    } else if (msg.ubx.id == GPS_UBX_NAV_ID_RELPOSNED) {
+      nav_write_begin(nav);
+      nav->data.heading = gps->ubx_data.relposned.rel_pos_heading * 1e-5;
+      nav_write_end(nav);
+    }
+    break;
+#endif
+
+#if defined(USE_GPS_UNICORE)
+  case GPS_PROTOCOL_UNICORE_BIN:
+    if (msg.unicore_bin.msg == GPS_UNICORE_BIN_MSG_BESTNAV ||
+        msg.unicore_bin.msg == GPS_UNICORE_BIN_MSG_ADRNAV) {
+      const hpd_unicore_bestnavb_t *bestnav = &gps->unicore_bin_data.bestnav;
+
+      nav_write_begin(nav);
+      nav->data.itow = gps->unicore_bin.header.ms;
+      nav->data.itow_tick = xTaskGetTickCount();
+      nav->data.fix = nav_fix_from_unicore(bestnav->psol_status, bestnav->pos_type);
+      nav->data.sat_num = bestnav->used_sv;
+      nav->data.ns = bestnav->lat >= 0 ? 'N' : 'S';
+      nav->data.ew = bestnav->lon >= 0 ? 'E' : 'W';
+      // BESTNAV 는 double 로 오므로 여기서 한 번만 변환
+      nav->data.llh.lat = gps_llh_deg_from_double(bestnav->lat);
+      nav->data.llh.lon = gps_llh_deg_from_double(bestnav->lon);
+      nav->data.llh.ellipsoid_alt = gps_llh_alt_from_double(bestnav->height);
+      nav->data.llh.msl_alt =
+          nav->data.llh.ellipsoid_alt - gps_llh_alt_from_double(bestnav->geoid);
+      nav->data.h_acc = sqrtf(bestnav->lat_dev * bestnav->lat_dev +
+                              bestnav->lon_dev * bestnav->lon_dev);
+      nav->data.v_acc = bestnav->height_dev;
+      // 같은 epoch 의 속도 (지연 보상용, PVTSLN 보다 위치와 시각이 맞음)
+      double trk = bestnav->trk_gnd * (M_PI / 180.0);
+      nav->data.vel_n = (int32_t)lround(bestnav->hor_speed * cos(trk) * 1000.0);
+      nav->data.vel_e = (int32_t)lround(bestnav->hor_speed * sin(trk) * 1000.0);
+      nav->data.vel_d = (int32_t)lround(-bestnav->vert_speed * 1000.0);
+      nav->data.g_speed = (int32_t)lround(bestnav->hor_speed * 1000.0);
+      nav_write_end(nav);
+    } else if (msg.unicore_bin.msg == GPS_UNICORE_BIN_MSG_UNIHEADING) {
+      const hpd_unicore_uniheadingb_t *hd = &gps->unicore_bin_data.uniheading;
+
+      if (hd->sol_status == 0 && hd->pos_type != GPS_UNICORE_POS_NONE) {
+        nav_write_begin(nav);
+        nav->data.heading = hd->heading;
+        nav_write_end(nav);
+      }
+    } else if (msg.unicore_bin.msg == GPS_UNICORE_BIN_MSG_PVTSLN) {
+      const hpd_unicore_pvtslnb_t *pvt = &gps->unicore_bin_data.pvtsln;
+
+      nav_write_begin(nav);
+      nav->data.hdop = pvt->hdop;
+      nav->data.pdop = pvt->pdop;
+      nav->data.vel_n = (int32_t)((float)pvt->vel_north * 1000.0f);
+      nav->data.vel_e = (int32_t)((float)pvt->vel_east * 1000.0f);
+      nav->data.g_speed = (int32_t)((float)pvt->vel_ground * 1000.0f);
+      nav_write_end(nav);
+    }
+    break;
+#endif
+
+  default:
+    break;
+  }
+}
+
+/**
+ * @brief 항법 해 스냅샷 읽기 (임의 태스크, lock 없음)
+ *
+ * 읽는 도중 파서가 갱신하면 false 를 리턴하므로 호출한 쪽에서 재시도한다.
+ * 쓰는 중인 파서 태스크보다 우선순위가 높다면 재시도 전에 양보해야 한다.
+ *
+ * @param[in] gps
+ * @param[out] out
+ * @return true 일관된 값을 읽음
+ */
+bool gps_nav_read(const gps_t *gps, gps_nav_data_t *out) {
+  const gps_nav_t *nav = &gps->nav;
+  uint32_t seq = nav->seq;
+
+  if (seq & 1U) {
+    return false;
+  }
+
+  GPS_NAV_BARRIER();
+  *out = nav->data;
+  GPS_NAV_BARRIER();
+
+  return nav->seq == seq;
+}
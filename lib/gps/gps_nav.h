@@ -0,0 +1,56 @@
+#ifndef GPS_NAV_H
+#define GPS_NAV_H
+
+#include "FreeRTOS.h"
+#include "gps_types.h"
+#include "gps_nmea.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct gps_s gps_t;
+
+/**
+ * @brief 최신 항법 해 (프레임 단위로 갱신된 값)
+ *
+ * GGA 는 fix/위성수/hdop/방향만, 위치/정확도는 UBX HPPOSLLH 또는 Unicore BESTNAV,
+ * heading 은 UBX RELPOSNED 또는 NMEA THS 에서 채운다. UBX NAV-PVT 는 혼자서
+ * fix/위성수/pdop/위치/속도를 같은 epoch 로 채우고, HPPOSLLH 도 켜져 있으면
+ * 뒤이어 오는 HPPOSLLH 가 위치를 고정밀 값으로 덮는다. UM982 binary 전용
+ * 모드에서는 BESTNAV/ADRNAV 가 fix/위성수까지, UNIHEADING 이 heading,
+ * PVTSLN 이 dop/속도를 채운다.
+ */
+typedef struct {
+  uint32_t itow;        // GPS time of week [ms] (NAV-PVT/HPPOSLLH/BESTNAV)
+  TickType_t itow_tick; // itow 를 게시한 tick (0: 아직 없음)
+  gps_llh_t llh;        // 위치 (고정소수점)
+  double heading;       // deg
+  double hdop;
+  float pdop;           // NAV-PVT pDOP
+  int32_t vel_n;        // NED 속도 [mm/s] (NAV-PVT, BESTNAV)
+  int32_t vel_e;
+  int32_t vel_d;
+  int32_t g_speed;      // 지면 속도 [mm/s]
+  float h_acc;          // 수평 정확도 [m] (HPPOSLLH hAcc, BESTNAV lat/lon 표준편차)
+  float v_acc;          // 수직 정확도 [m]
+  gps_fix_t fix;
+  uint8_t sat_num;
+  char ns;
+  char ew;
+} gps_nav_data_t;
+
+/**
+ * @brief seqlock 으로 보호되는 항법 해
+ *
+ * 쓰기는 파서(RX 태스크) 하나만 하고, seq 가 홀수인 동안은 쓰는 중이다.
+ * 읽는 쪽은 인터럽트나 뮤텍스 없이 gps_nav_read() 로 읽고 실패하면
+ * 재시도한다.
+ */
+typedef struct {
+  volatile uint32_t seq;
+  gps_nav_data_t data;
+} gps_nav_t;
+
+void gps_nav_publish(gps_t *gps, gps_procotol_t protocol, gps_msg_t msg);
+bool gps_nav_read(const gps_t *gps, gps_nav_data_t *out);
+
+#endif
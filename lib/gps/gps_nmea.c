@@ -3,24 +3,40 @@
 #include "gps_parse.h"
 #include <string.h>
 
-static double parse_lat_lon(gps_t *gps);
+static int64_t parse_lat_lon(gps_t *gps);
 static void parse_nmea_gga(gps_t *gps);
 
 /**
- * @brief 십진수 도 변환
+ * @brief ddmm.mmmm 위경도를 nano-degree로 변환
+ *
+ * double 없이 32bit 정수 연산만 사용한다.
+ * 분(min) * 1e9 / 60 = min * 16666666 + min * 40 / 60 를 이용해
+ * 64bit 나눗셈을 피한다.
  *
  * @param[in] gps
- * @return double
+ * @return int64_t 1e-9 도
  */
-static double parse_lat_lon(gps_t *gps) {
-  double val, deg, min;
+static int64_t parse_lat_lon(gps_t *gps) {
+  const char *term = gps->nmea.term_str;
+  uint32_t ddmm = 0, frac = 0, scale = 1000000000UL;
 
-  val = gps_parse_double(gps);
-  deg = (double)((int)(((int)val / 100)));
-  min = val - (deg * (double)100);
-  val = deg + (min / (double)(60));
+  for (; PARSER_CHAR_IS_NUM(*term); ++term) {
+    ddmm = 10UL * ddmm + PARSER_CHAR_DEC_TO_NUM(*term);
+  }
+  if (*term == '.') {
+    ++term;
+  }
+  /* 분의 소수부를 1e9 배 정수로 (9자리 넘는 부분은 버림) */
+  for (; PARSER_CHAR_IS_NUM(*term) && scale > 1; ++term) {
+    scale /= 10UL;
+    frac += PARSER_CHAR_DEC_TO_NUM(*term) * scale;
+  }
 
-  return val;
+  uint32_t deg = ddmm / 100UL;
+  uint32_t min = ddmm % 100UL;
+
+  return (int64_t)deg * 1000000000LL +
+         (int64_t)(min * 16666666UL + (min * 40UL + frac) / 60UL);
 }
 
 /**
@@ -45,7 +61,7 @@ static void parse_nmea_gga(gps_t *gps) {
     break;
 
   case 2: // lat
-    gps->nmea_data.gga.lat = parse_lat_lon(gps);
+    gps->nmea_data.gga.lat_ndeg = parse_lat_lon(gps);
     break;
 
   case 3: // NS
@@ -54,7 +70,7 @@ static void parse_nmea_gga(gps_t *gps) {
     break;
 
   case 4: // lon
-    gps->nmea_data.gga.lon = parse_lat_lon(gps);
+    gps->nmea_data.gga.lon_ndeg = parse_lat_lon(gps);
     break;
 
   case 5: // EW
@@ -75,13 +91,13 @@ static void parse_nmea_gga(gps_t *gps) {
     break;
 
   case 9: // alt
-    gps->nmea_data.gga.alt = gps_parse_float(gps);
+    gps->nmea_data.gga.alt_mm = gps_parse_fixed(gps, 3);
     break;
 
     // case 10 : // alt unit 'M'
 
   case 11: // geoid separation
-    gps->nmea_data.gga.geo_sep = gps_parse_float(gps);
+    gps->nmea_data.gga.geo_sep_mm = gps_parse_fixed(gps, 3);
     break;
 
     // case 12: // sep unit 'M'
@@ -109,6 +125,37 @@ static void parse_nmea_gpths(gps_t *gps)
   }
 }
 
+/**
+ * @brief 처리할 NMEA sentence 목록
+ *
+ * 자주 오는 sentence를 앞에 둔다. 목록에 없는 sentence는 첫 term에서
+ * 바로 버린다.
+ */
+static const gps_nmea_sentence_t nmea_sentences[] = {
+    {GPS_NMEA_KEY('G', 'G', 'A'), GPS_NMEA_MSG_GGA, parse_nmea_gga},
+    {GPS_NMEA_KEY('T', 'H', 'S'), GPS_NMEA_MSG_THS, parse_nmea_gpths},
+    {GPS_NMEA_KEY('R', 'M', 'C'), GPS_NMEA_MSG_RMC, NULL},
+    {GPS_NMEA_KEY('G', 'S', 'V'), GPS_NMEA_MSG_GSV, gps_sat_gsv_term},
+};
+
+#define NMEA_SENTENCE_CNT (sizeof(nmea_sentences) / sizeof(nmea_sentences[0]))
+
+/**
+ * @brief sentence 등록 정보 검색
+ *
+ * @param[in] key GPS_NMEA_KEY()
+ * @return const gps_nmea_sentence_t* 없으면 NULL
+ */
+static const gps_nmea_sentence_t *find_nmea_sentence(uint32_t key) {
+  for (size_t i = 0; i < NMEA_SENTENCE_CNT; i++) {
+    if (nmea_sentences[i].key == key) {
+      return &nmea_sentences[i];
+    }
+  }
+
+  return NULL;
+}
+
 /**
  * @brief NMEA183 프로토콜 파싱
  *
@@ -118,44 +165,46 @@ static void parse_nmea_gpths(gps_t *gps)
 uint8_t gps_parse_nmea_term(gps_t *gps) {
   if (gps->nmea.msg_type == GPS_NMEA_MSG_NONE) {
     if (gps->state == GPS_PARSE_STATE_NMEA_START) {
-      const char *talker = gps->nmea.term_str;
       const char *msg = &gps->nmea.term_str[2];
+      const gps_nmea_sentence_t *sentence = NULL;
 
-      if (!strncmp(msg, "GGA", 3)) {
-          gps->nmea.msg_type = GPS_NMEA_MSG_GGA;
-
-#if defined(USE_STORE_RAW_GGA)
-          gps->nmea_data.gga_raw_pos = 0;
-          _gps_gga_raw_add(gps, '$');
-          for (int i = 0; i < 5; i++) {
-            _gps_gga_raw_add(gps, gps->nmea.term_str[i]);
-          }
-          _gps_gga_raw_add(gps, ',');
-          gps->nmea_data.gga_is_rdy = false;
-#endif
-
-      } else if (!strncmp(msg, "RMC", 3)) {
-        gps->nmea.msg_type = GPS_NMEA_MSG_RMC;
-      } else if (!strncmp(msg, "THS", 3)) {
-        gps->nmea.msg_type = GPS_NMEA_MSG_THS;
+      if (gps->nmea.term_pos >= 5) {
+        sentence = find_nmea_sentence(GPS_NMEA_KEY(msg[0], msg[1], msg[2]));
       }
-      else {
-        gps->nmea.msg_type = GPS_NMEA_MSG_NONE;
+
+      if (!sentence) {
+        /* 모르는 sentence는 토큰화하지 않고 다음 시작 바이트까지 건너뜀 */
+        gps->protocol = GPS_PROTOCOL_NONE;
         gps->state = GPS_PARSE_STATE_NONE;
 
         return 0;
       }
 
+      gps->nmea.sentence = sentence;
+      gps->nmea.msg_type = sentence->msg_type;
+      gps->nmea.talker[0] = gps->nmea.term_str[0];
+      gps->nmea.talker[1] = gps->nmea.term_str[1];
+
+#if defined(USE_STORE_RAW_GGA)
+      if (gps->nmea.msg_type == GPS_NMEA_MSG_GGA) {
+        gps->nmea_data.gga_raw_pos = 0;
+        _gps_gga_raw_add(gps, '$');
+        for (int i = 0; i < 5; i++) {
+          _gps_gga_raw_add(gps, gps->nmea.term_str[i]);
+        }
+        _gps_gga_raw_add(gps, ',');
+        gps->nmea_data.gga_is_rdy = false;
+      }
+#endif
+
       gps->state = GPS_PARSE_STATE_NMEA_DATA;
     }
 
     return 1;
   }
 
-  if (gps->nmea.msg_type == GPS_NMEA_MSG_GGA) {
-    parse_nmea_gga(gps);
-  } else if (gps->nmea.msg_type == GPS_NMEA_MSG_THS) {
-	  parse_nmea_gpths(gps);
+  if (gps->nmea.sentence->handler) {
+    gps->nmea.sentence->handler(gps);
   }
 
   return 1;
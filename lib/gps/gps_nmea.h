@@ -7,6 +7,13 @@
 
 #define GPS_NMEA_TERM_SIZE 20
 
+/**
+ * @brief sentence id 3글자를 24bit 키로 변환
+ */
+#define GPS_NMEA_KEY(c0, c1, c2)                                              \
+  (((uint32_t)(uint8_t)(c0) << 16) | ((uint32_t)(uint8_t)(c1) << 8) |         \
+   (uint32_t)(uint8_t)(c2))
+
 /**
  * @brief GGA quality fix 상태
  *
@@ -35,15 +42,15 @@ typedef struct {
   uint8_t hour;
   uint8_t min;
   uint8_t sec;
-  double lat;
+  int64_t lat_ndeg;    // 위도 (1e-9 도, 부호 없음 - ns 참고)
   char ns;
-  double lon;
+  int64_t lon_ndeg;    // 경도 (1e-9 도, 부호 없음 - ew 참고)
   char ew;
   gps_fix_t fix;
   uint8_t sat_num;
   double hdop;
-  double alt;
-  double geo_sep;
+  int32_t alt_mm;      // 평균 해수면 고도 (mm)
+  int32_t geo_sep_mm;  // geoid separation (mm)
 } gps_gga_t;
 
 typedef enum
@@ -79,18 +86,35 @@ typedef struct {
  * @brief NMEA 파싱에 필요한 변수
  *
  */
+typedef struct gps_s gps_t;
+
+/**
+ * @brief sentence 데이터 term 파싱 함수
+ */
+typedef void (*gps_nmea_term_handler_t)(gps_t *gps);
+
+/**
+ * @brief NMEA sentence 등록 정보
+ *
+ */
+typedef struct {
+  uint32_t key;                    // GPS_NMEA_KEY()
+  gps_nmea_msg_t msg_type;
+  gps_nmea_term_handler_t handler; // NULL이면 term 파싱 없이 이벤트만 전달
+} gps_nmea_sentence_t;
+
 typedef struct {
   char term_str[GPS_NMEA_TERM_SIZE];
   uint8_t term_pos;
   uint8_t term_num;
+  char talker[2]; // GP, GL, GA, GB ...
 
+  const gps_nmea_sentence_t *sentence;
   gps_nmea_msg_t msg_type;
   uint8_t crc;
   uint8_t star;
 } gps_nmea_parser_t;
 
-typedef struct gps_s gps_t;
-
 uint8_t gps_parse_nmea_term(gps_t *gps);
 
 #endif
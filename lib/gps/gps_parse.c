@@ -95,6 +95,42 @@ float gps_parse_float(gps_t *gps) {
   return sign * val / power;
 }
 
+/**
+ * @brief GPS 프로토콜 고정소수점 파싱
+ *
+ * 소수점 아래 decimals 자리까지 정수로 변환한다. 넘치는 자리는 버린다.
+ * 예: "499.6", decimals = 3 -> 499600
+ *
+ * @param[in] gps
+ * @param[in] decimals 소수점 아래 자리수
+ * @return int32_t 10^decimals 배 한 값
+ */
+int32_t gps_parse_fixed(gps_t *gps, uint8_t decimals) {
+  char *term = gps->nmea.term_str;
+  uint8_t minus = 0;
+  int32_t res = 0;
+
+  for (; *term == ' '; ++term) {
+  }
+
+  minus = (*term == '-' ? (++term, 1) : 0);
+  for (; PARSER_CHAR_IS_NUM(*term); ++term) {
+    res = 10L * res + PARSER_CHAR_DEC_TO_NUM(*term);
+  }
+  if (*term == '.') {
+    ++term;
+  }
+  for (; decimals > 0; --decimals) {
+    res *= 10L;
+    if (PARSER_CHAR_IS_NUM(*term)) {
+      res += PARSER_CHAR_DEC_TO_NUM(*term);
+      ++term;
+    }
+  }
+
+  return minus ? -res : res;
+}
+
 /**
  * @brief GPS 프로토콜 문자 파싱
  *
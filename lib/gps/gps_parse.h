@@ -11,6 +11,7 @@ typedef struct gps_s gps_t;
 int32_t gps_parse_number(gps_t *gps);
 double gps_parse_double(gps_t *gps);
 float gps_parse_float(gps_t *gps);
+int32_t gps_parse_fixed(gps_t *gps, uint8_t decimals);
 char gps_parse_character(gps_t *gps);
 
 #endif
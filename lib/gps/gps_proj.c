@@ -0,0 +1,255 @@
+#include "gps_proj.h"
+#include <math.h>
+#include <string.h>
+
+#define DEG2RAD (M_PI / 180.0)
+#define SEC2RAD (M_PI / (180.0 * 3600.0))
+
+#define PROJ_UTM_K0 0.9996
+#define PROJ_UTM_FE 500000.0
+#define PROJ_UTM_FN_SOUTH 10000000.0
+
+#define PROJ_H_STEP 100.0 // 높이 미분 간격 [m]
+
+static const struct {
+  double a, inv_f;
+} proj_ell[GPS_PROJ_ELL_MAX] = {
+    [GPS_PROJ_ELL_GRS80] = {6378137.0, 298.257222101},
+    [GPS_PROJ_ELL_BESSEL] = {6377397.155, 299.1528128},
+};
+
+static const double wgs84_a = 6378137.0;
+static const double wgs84_e2 = 0.00669437999014;
+
+/** 위도 -> 등각위도의 tan (Karney 2011 식 7~9) */
+static double proj_conformal_tan(const gps_proj_t *p, double phi) {
+  double s = sin(phi);
+
+  return sinh(atanh(s) - p->e * atanh(p->e * s));
+}
+
+/** 원점 zone 정하기 (TM 은 정의 그대로) */
+static void proj_set_zone(gps_proj_t *p, uint8_t zone, bool south) {
+  p->zone = zone;
+  p->south = south;
+  p->lon0 = (zone * 6.0 - 183.0) * DEG2RAD;
+  p->lat0 = 0.0;
+  p->fe = PROJ_UTM_FE;
+  p->fn = south ? PROJ_UTM_FN_SOUTH : 0.0;
+  p->xi0 = 0.0;
+}
+
+bool gps_proj_setup(gps_proj_t *p, const gps_proj_def_t *def) {
+  memset(p, 0, sizeof(*p));
+
+  if (def->ell >= GPS_PROJ_ELL_MAX || (def->utm && def->zone > 60) ||
+      (!def->utm && !(def->k0 > 0.0))) {
+    return false;
+  }
+  p->def = *def;
+
+  double f = 1.0 / proj_ell[def->ell].inv_f;
+  double n = f / (2.0 - f);
+  double n2 = n * n, n3 = n2 * n, n4 = n3 * n, n5 = n4 * n, n6 = n5 * n;
+
+  p->a = proj_ell[def->ell].a;
+  p->e2 = f * (2.0 - f);
+  p->e = sqrt(p->e2);
+
+  // Krüger 급수 (n 6 차, Karney 2011 식 35)
+  p->alpha[0] = n / 2 - 2 * n2 / 3 + 5 * n3 / 16 + 41 * n4 / 180 - 127 * n5 / 288 +
+                7891 * n6 / 37800;
+  p->alpha[1] = 13 * n2 / 48 - 3 * n3 / 5 + 557 * n4 / 1440 + 281 * n5 / 630 -
+                1983433 * n6 / 1935360;
+  p->alpha[2] = 61 * n3 / 240 - 103 * n4 / 140 + 15061 * n5 / 26880 + 167603 * n6 / 181440;
+  p->alpha[3] = 49561 * n4 / 161280 - 179 * n5 / 168 + 6601661 * n6 / 7257600;
+  p->alpha[4] = 34729 * n5 / 80640 - 3418889 * n6 / 1995840;
+  p->alpha[5] = 212378941 * n6 / 319334400;
+
+  double A = p->a / (1 + n) * (1 + n2 / 4 + n4 / 64 + n6 / 256);
+
+  if (def->utm) {
+    p->k0A = PROJ_UTM_K0 * A;
+    if (def->zone != GPS_PROJ_UTM_AUTO) {
+      proj_set_zone(p, def->zone, def->south);
+    }
+  } else {
+    p->k0A = def->k0 * A;
+    p->lon0 = def->lon0 * DEG2RAD;
+    p->lat0 = def->lat0 * DEG2RAD;
+    p->fe = def->fe;
+    p->fn = def->fn;
+
+    // 원점 위도의 xi (중앙 자오선 위라 eta = 0)
+    double chi = atan(proj_conformal_tan(p, p->lat0));
+    p->xi0 = chi;
+    for (int j = 0; j < 6; j++) {
+      p->xi0 += p->alpha[j] * sin(2 * (j + 1) * chi);
+    }
+  }
+
+  // (1 + ds) R, position vector
+  double s = 1.0 + def->ds * 1e-6;
+  double rx = def->rx * SEC2RAD, ry = def->ry * SEC2RAD, rz = def->rz * SEC2RAD;
+  double r[3][3] = {{1, -rz, ry}, {rz, 1, -rx}, {-ry, rx, 1}};
+
+  for (int i = 0; i < 3; i++) {
+    for (int j = 0; j < 3; j++) {
+      p->rot[i][j] = s * r[i][j];
+    }
+  }
+
+  return true;
+}
+
+/** WGS84 -> 대상 datum 위경도/타원체고 [rad, m] */
+static void proj_helmert(const gps_proj_t *p, double *phi, double *lam, double *h) {
+  double sp = sin(*phi), cp = cos(*phi);
+  double N = wgs84_a / sqrt(1 - wgs84_e2 * sp * sp);
+  double x[3] = {(N + *h) * cp * cos(*lam), (N + *h) * cp * sin(*lam),
+                 (N * (1 - wgs84_e2) + *h) * sp};
+  double y[3];
+
+  y[0] = p->def.tx + p->rot[0][0] * x[0] + p->rot[0][1] * x[1] + p->rot[0][2] * x[2];
+  y[1] = p->def.ty + p->rot[1][0] * x[0] + p->rot[1][1] * x[1] + p->rot[1][2] * x[2];
+  y[2] = p->def.tz + p->rot[2][0] * x[0] + p->rot[2][1] * x[1] + p->rot[2][2] * x[2];
+
+  // 대상 타원체로 (지표 근처는 4 회면 0.01 mm 아래로 수렴)
+  double pr = sqrt(y[0] * y[0] + y[1] * y[1]);
+  double ph = atan2(y[2], pr * (1 - p->e2));
+
+  for (int i = 0; i < 4; i++) {
+    sp = sin(ph);
+    N = p->a / sqrt(1 - p->e2 * sp * sp);
+    *h = pr / cos(ph) - N;
+    ph = atan2(y[2], pr * (1 - p->e2 * N / (N + *h)));
+  }
+  sp = sin(ph);
+  N = p->a / sqrt(1 - p->e2 * sp * sp);
+  *h = pr * cos(ph) + y[2] * sp - N * (1 - p->e2 * sp * sp);
+  *phi = ph;
+  *lam = atan2(y[1], y[0]);
+}
+
+void gps_proj_exact(const gps_proj_t *p, double lat, double lon, double h,
+                    double *e, double *n, double *hh) {
+  double phi = lat * DEG2RAD;
+  double lam = lon * DEG2RAD;
+
+  if (p->def.helmert) {
+    proj_helmert(p, &phi, &lam, &h);
+  }
+  *hh = h;
+
+  lam = remainder(lam - p->lon0, 2 * M_PI);
+
+  double t = proj_conformal_tan(p, phi);
+  double xi1 = atan2(t, cos(lam));
+  double eta1 = atanh(sin(lam) / sqrt(1 + t * t));
+
+  // sin/cos(2j xi'), sinh/cosh(2j eta') 는 배각 점화식으로
+  double s1 = sin(2 * xi1), c1 = cos(2 * xi1);
+  double sh1 = sinh(2 * eta1), ch1 = cosh(2 * eta1);
+  double s = s1, c = c1, sh = sh1, ch = ch1;
+  double xi = xi1, eta = eta1;
+
+  for (int j = 0; j < 6; j++) {
+    xi += p->alpha[j] * s * ch;
+    eta += p->alpha[j] * c * sh;
+
+    double s_next = s * c1 + c * s1;
+    double c_next = c * c1 - s * s1;
+    double sh_next = sh * ch1 + ch * sh1;
+    double ch_next = ch * ch1 + sh * sh1;
+    s = s_next, c = c_next, sh = sh_next, ch = ch_next;
+  }
+
+  *e = p->fe + p->k0A * eta;
+  *n = p->fn + p->k0A * (xi - p->xi0);
+}
+
+static inline int64_t proj_round(double v) {
+  return (int64_t)llround(v);
+}
+
+/** llh 에 기준점을 잡고 다항식 계수 계산 */
+static void proj_anchor(gps_proj_t *p, const gps_llh_t *llh) {
+  const double du = GPS_PROJ_ANCHOR_DEG * 1e-9;
+  double lat = gps_llh_deg_to_double(llh->lat);
+  double lon = gps_llh_deg_to_double(llh->lon);
+  double h = gps_llh_alt_to_double(llh->ellipsoid_alt);
+  double e[8], n[8], hh[8];
+
+  if (p->def.utm && p->def.zone == GPS_PROJ_UTM_AUTO) {
+    int zone = (int)floor((lon + 180.0) / 6.0) % 60 + 1;
+    proj_set_zone(p, (uint8_t)(zone < 1 ? zone + 60 : zone), lat < 0);
+  }
+
+  // 0: 중심, 1/2: u +-1, 3/4: v +-1, 5: (1,1), 6: (-1,-1), 7: w + PROJ_H_STEP
+  static const int8_t st[8][2] = {{0, 0}, {1, 0}, {-1, 0}, {0, 1},
+                                  {0, -1}, {1, 1}, {-1, -1}, {0, 0}};
+  for (int i = 0; i < 8; i++) {
+    gps_proj_exact(p, lat + st[i][0] * du, lon + st[i][1] * du, h + (i == 7 ? PROJ_H_STEP : 0),
+                   &e[i], &n[i], &hh[i]);
+  }
+
+  const double *fv[3] = {e, n, hh};
+  float *cv[3] = {p->ce, p->cn, p->ch};
+
+  for (int k = 0; k < 3; k++) {
+    const double *f = fv[k];
+    float *c = cv[k];
+
+    c[0] = (float)((f[1] - f[2]) / 2);
+    c[1] = (float)((f[3] - f[4]) / 2);
+    c[2] = (float)((f[1] - 2 * f[0] + f[2]) / 2);
+    c[3] = (float)((f[5] - f[1] - f[3] + 2 * f[0] - f[2] - f[4] + f[6]) / 2);
+    c[4] = (float)((f[3] - 2 * f[0] + f[4]) / 2);
+    c[5] = (float)((f[7] - f[0]) / PROJ_H_STEP);
+  }
+
+  p->lat_a = llh->lat;
+  p->lon_a = llh->lon;
+  p->h_a = llh->ellipsoid_alt;
+  p->e_a = proj_round(e[0] * GPS_LLH_ALT_SCALE);
+  p->n_a = proj_round(n[0] * GPS_LLH_ALT_SCALE);
+  p->hh_a = (int32_t)proj_round(hh[0] * GPS_LLH_ALT_SCALE);
+  p->anchored = true;
+  p->anchors++;
+}
+
+static inline float proj_poly(const float *c, float u, float v, float w) {
+  return u * (c[0] + u * c[2] + v * c[3]) + v * (c[1] + v * c[4]) + w * c[5];
+}
+
+void gps_proj_forward(gps_proj_t *p, const gps_llh_t *llh, gps_proj_xy_t *out) {
+  int64_t dlat = llh->lat - p->lat_a;
+  int64_t dlon = llh->lon - p->lon_a;
+  int32_t dh = llh->ellipsoid_alt - p->h_a;
+
+  // 날짜 변경선
+  if (dlon > 180 * GPS_LLH_DEG_SCALE) {
+    dlon -= 360 * GPS_LLH_DEG_SCALE;
+  } else if (dlon < -180 * GPS_LLH_DEG_SCALE) {
+    dlon += 360 * GPS_LLH_DEG_SCALE;
+  }
+
+  if (!p->anchored || dlat > GPS_PROJ_ANCHOR_DEG || dlat < -GPS_PROJ_ANCHOR_DEG ||
+      dlon > GPS_PROJ_ANCHOR_DEG || dlon < -GPS_PROJ_ANCHOR_DEG || dh > GPS_PROJ_ANCHOR_H ||
+      dh < -GPS_PROJ_ANCHOR_H) {
+    proj_anchor(p, llh);
+    dlat = dlon = dh = 0;
+  }
+
+  // 여기부터 단정밀도 (차이는 ANCHOR_DEG 아래라 float 로 정확히 옮겨짐)
+  float u = (float)(int32_t)dlat * (1.0f / GPS_PROJ_ANCHOR_DEG);
+  float v = (float)(int32_t)dlon * (1.0f / GPS_PROJ_ANCHOR_DEG);
+  float w = (float)dh * (1.0f / GPS_LLH_ALT_SCALE);
+  float scale = (float)GPS_LLH_ALT_SCALE;
+
+  out->e = p->e_a + (int64_t)lrintf(proj_poly(p->ce, u, v, w) * scale);
+  out->n = p->n_a + (int64_t)lrintf(proj_poly(p->cn, u, v, w) * scale);
+  out->h = p->hh_a + (int32_t)lrintf(proj_poly(p->ch, u, v, w) * scale);
+  out->zone = p->def.utm ? p->zone : 0;
+  out->south = p->def.utm && p->south;
+}
@@ -0,0 +1,120 @@
+#ifndef GPS_PROJ_H
+#define GPS_PROJ_H
+
+#include "gps_types.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief 평면 좌표 투영 (TM/UTM, 선택적으로 7 변수 datum 변환)
+ *
+ * 정확한 계산 (Helmert + Krüger 6 차 급수) 은 double 이라 M4F 에서는 소프트웨어
+ * 연산으로 한 번에 수십 us 가 든다. 그래서 매 항법 해마다 하지 않고, 기준점
+ * (anchor) 을 잡을 때만 double 로 기준점과 주변 8 점을 계산해 2 차 다항식 계수를
+ * 만들어 둔다. 이후 해는 기준점과의 차이 (int64 1e-9 deg 를 빼서 float 로) 로
+ * float 다항식만 계산해 int64 기준값에 더한다.
+ *
+ * 기준점에서 GPS_PROJ_ANCHOR_DEG (위경도 각각) 안이면 다항식 오차는 0.01 mm,
+ * float 반올림은 0.2 mm 아래다. 벗어나면 (또는 높이가 GPS_PROJ_ANCHOR_H 이상
+ * 차이 나면) 그 자리에서 기준점을 다시 잡는다 (double 8 회, 약 1 ms).
+ *
+ * UTM 자동 zone 은 기준점을 잡을 때 정하므로 zone 경계 근처에서는 최대
+ * GPS_PROJ_ANCHOR_DEG 만큼 옆 zone 으로 이어진다. 노르웨이/스발바르 특례 zone
+ * 은 따르지 않는다.
+ */
+#define GPS_PROJ_ANCHOR_DEG 12000000LL // 1e-9 deg (0.012 deg, 위도 약 1.3 km)
+#define GPS_PROJ_ANCHOR_H 5000000      // 0.1 mm (500 m)
+
+#define GPS_PROJ_UTM_AUTO 0
+
+typedef enum {
+  GPS_PROJ_ELL_GRS80 = 0,  // GRS80/WGS84 (차이 0.1 mm 미만이라 같이 씀)
+  GPS_PROJ_ELL_BESSEL = 1, // Bessel 1841
+  GPS_PROJ_ELL_MAX
+} gps_proj_ell_t;
+
+/**
+ * @brief 투영 정의
+ *
+ * utm 이 true 면 lat0/lon0/k0/fe/fn 대신 UTM 값 (zone 이 GPS_PROJ_UTM_AUTO 면
+ * 기준점 위치로 zone/남북반구를 고른다).
+ *
+ * helmert 는 WGS84 -> 대상 datum, position vector 방식 (EPSG 9606):
+ *   X' = T + (1 + ds) R X,  R = [1 -rz ry; rz 1 -rx; -ry rx 1]
+ * coordinate frame (EPSG 9607) 값이면 회전 부호를 바꿔서 넣는다.
+ */
+typedef struct {
+  bool utm;
+  uint8_t zone; // UTM 1~60, GPS_PROJ_UTM_AUTO
+  bool south;   // 고정 zone 일 때 남반구 (false northing 10000 km)
+
+  double lat0, lon0; // TM 원점 [deg]
+  double k0;         // TM 축척계수
+  double fe, fn;     // TM false easting/northing [m]
+
+  uint8_t ell;        // gps_proj_ell_t (투영/역변환 타원체)
+  bool helmert;
+  double tx, ty, tz;  // [m]
+  double rx, ry, rz;  // [arcsec]
+  double ds;          // [ppm]
+} gps_proj_def_t;
+
+typedef struct {
+  int64_t e, n; // [0.1 mm]
+  int32_t h;    // 대상 타원체고 [0.1 mm] (datum 변환이 없으면 입력 그대로)
+  uint8_t zone; // UTM zone (TM 이면 0)
+  bool south;
+} gps_proj_xy_t;
+
+typedef struct {
+  gps_proj_def_t def;
+
+  // gps_proj_setup 에서 미리 계산
+  double a, e2, e;      // 타원체
+  double k0A;           // k0 x 자오선 rectifying radius
+  double alpha[6];      // Krüger 계수
+  double rot[3][3];     // (1 + ds) R
+  double lon0, lat0;    // 지금 zone 의 원점 [rad]
+  double fe, fn;
+  double xi0;           // 원점 위도의 xi
+  uint8_t zone;
+  bool south;
+
+  // 기준점 (anchor)
+  bool anchored;
+  int64_t lat_a, lon_a; // 1e-9 deg
+  int32_t h_a;          // 0.1 mm
+  int64_t e_a, n_a;     // 0.1 mm
+  int32_t hh_a;         // 0.1 mm
+  // 차이 u = dlat / ANCHOR_DEG, v = dlon / ANCHOR_DEG, w = dh [m] 에 대한 [m]
+  // c[0..5] = u, v, uu, uv, vv, w
+  float ce[6], cn[6], ch[6];
+
+  uint32_t anchors; // 기준점을 잡은 횟수
+} gps_proj_t;
+
+/**
+ * @brief 정의로 상수 계산 (기준점은 다음 변환에서 잡음)
+ *
+ * @return false 정의가 잘못됨 (zone 범위, k0 <= 0, 타원체)
+ */
+bool gps_proj_setup(gps_proj_t *p, const gps_proj_def_t *def);
+
+/**
+ * @brief WGS84 위경도/타원체고 -> 평면 좌표 (기준점 다항식)
+ *
+ * p 를 고치므로 (기준점) 여러 태스크에서 부르면 호출자가 잠근다.
+ */
+void gps_proj_forward(gps_proj_t *p, const gps_llh_t *llh, gps_proj_xy_t *out);
+
+/**
+ * @brief 같은 변환을 double 로 직접 (검증/벤치용, 기준점 안 씀)
+ *
+ * @param lat, lon [deg]
+ * @param h 타원체고 [m]
+ * @param[out] e, n, hh [m]
+ */
+void gps_proj_exact(const gps_proj_t *p, double lat, double lon, double h,
+                    double *e, double *n, double *hh);
+
+#endif
@@ -0,0 +1,335 @@
+#include "gps_sat.h"
+#include "gps.h"
+#include "gps_parse.h"
+#include <stdio.h>
+#include <string.h>
+
+#define GPS_SAT_BARRIER() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#define GPS_SAT_READ_RETRY 4
+
+static const char gnss_letters[GPS_SAT_GNSS_CNT] = {
+    [GPS_SAT_GNSS_GPS] = 'G', [GPS_SAT_GNSS_SBAS] = 'S', [GPS_SAT_GNSS_GAL] = 'E',
+    [GPS_SAT_GNSS_BDS] = 'C', [GPS_SAT_GNSS_IMES] = 'I', [GPS_SAT_GNSS_QZSS] = 'J',
+    [GPS_SAT_GNSS_GLO] = 'R', [GPS_SAT_GNSS_NAVIC] = 'N',
+};
+
+static inline void sat_write_begin(gps_sat_table_t *t) {
+  t->seq++;
+  GPS_SAT_BARRIER();
+}
+
+static inline void sat_write_end(gps_sat_table_t *t) {
+  GPS_SAT_BARRIER();
+  t->seq++;
+}
+
+static inline uint32_t sat_le32(const uint8_t *p) {
+  return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+void gps_sat_init(gps_sat_table_t *t) {
+  memset(t, 0, sizeof(*t));
+  memset(t->gsv_sig, 0xFF, sizeof(t->gsv_sig));
+  t->gsv.gnss = GPS_SAT_GNSS_CNT;
+}
+
+/**
+ * @brief UBX-NAV-SAT
+ *
+ * iTOW(4) version(1) numSvs(1) reserved(2) 다음 위성마다 12 byte:
+ * gnssId svId cno elev(I1) azim(I2) prRes(I2) flags(X4)
+ * flags: bit 0~2 qualityInd, 3 svUsed, 4~5 health (2: 비정상), 6 diffCorr
+ */
+void gps_sat_from_nav_sat(gps_sat_table_t *t, const uint8_t *payload, uint16_t len) {
+  uint8_t n;
+
+  if (len < 8) {
+    return;
+  }
+  n = payload[5];
+  if (len != 8 + (uint16_t)n * 12) {
+    return;
+  }
+  if (n > GPS_SAT_MAX) {
+    n = GPS_SAT_MAX;
+  }
+
+  sat_write_begin(t);
+  t->src = GPS_SAT_SRC_NAV_SAT;
+  t->itow = sat_le32(payload);
+  for (uint8_t i = 0; i < n; i++) {
+    const uint8_t *s = &payload[8 + i * 12];
+    int16_t az = (int16_t)(s[4] | s[5] << 8);
+    uint32_t f = sat_le32(&s[8]);
+    uint8_t flags = (uint8_t)((f & 0x07) << GPS_SAT_QUAL_SHIFT);
+
+    if (f & 0x08) {
+      flags |= GPS_SAT_USED;
+    }
+    if (f & 0x40) {
+      flags |= GPS_SAT_DIFF;
+    }
+    if (((f >> 4) & 0x03) == 2) {
+      flags |= GPS_SAT_UNHEALTHY;
+    }
+
+    t->gnss[i] = s[0];
+    t->svid[i] = s[1];
+    t->cno[i] = s[2];
+    t->elev[i] = (int8_t)s[3];
+    t->az2[i] = az < 0 ? 0 : (uint8_t)(az / 2);
+    t->flags[i] = flags;
+  }
+  t->count = n;
+  sat_write_end(t);
+}
+
+/**
+ * @brief NMEA talker ID -> 위성계 (GSV 는 GN 으로 오지 않음)
+ */
+static uint8_t sat_gnss_from_talker(const char *talker) {
+  if (talker[0] == 'B' && talker[1] == 'D') {
+    return GPS_SAT_GNSS_BDS;
+  }
+  if (talker[0] != 'G') {
+    return GPS_SAT_GNSS_CNT;
+  }
+
+  switch (talker[1]) {
+  case 'P':
+    return GPS_SAT_GNSS_GPS;
+  case 'L':
+    return GPS_SAT_GNSS_GLO;
+  case 'A':
+    return GPS_SAT_GNSS_GAL;
+  case 'B':
+    return GPS_SAT_GNSS_BDS;
+  case 'Q':
+    return GPS_SAT_GNSS_QZSS;
+  case 'I':
+    return GPS_SAT_GNSS_NAVIC;
+  default:
+    return GPS_SAT_GNSS_CNT;
+  }
+}
+
+static uint8_t sat_parse_hex(const char *s) {
+  uint8_t v = 0;
+
+  for (; *s; s++) {
+    if (PARSER_CHAR_IS_NUM(*s)) {
+      v = (uint8_t)(v * 16 + PARSER_CHAR_DEC_TO_NUM(*s));
+    } else if (*s >= 'A' && *s <= 'F') {
+      v = (uint8_t)(v * 16 + *s - 'A' + 10);
+    } else {
+      break;
+    }
+  }
+
+  return v;
+}
+
+/**
+ * @brief $xxGSV,numMsg,msgNum,numSV,{svid,elv,az,cno} x 1~4[,signalId]*cs
+ *
+ * 위성 칸의 첫 term 자리에 signalId 가 올 수 있어 term 번호를 남겨 두고
+ * commit 때 위성 수로 가린다.
+ */
+void gps_sat_gsv_term(gps_t *gps) {
+  gps_sat_gsv_t *g = &gps->sat.gsv;
+  uint8_t term = gps->nmea.term_num;
+
+  if (term == 1) {
+    memset(g, 0, sizeof(*g));
+    g->gnss = sat_gnss_from_talker(gps->nmea.talker);
+    return;
+  }
+  if (term == 2) {
+    g->msg_num = (uint8_t)gps_parse_number(gps);
+    return;
+  }
+  if (term == 3) {
+    g->n = (uint8_t)gps_parse_number(gps);
+    return;
+  }
+  if (term < 4) {
+    return;
+  }
+
+  uint8_t k = (uint8_t)((term - 4) / 4);
+
+  g->last_term = term;
+  switch ((term - 4) % 4) {
+  case 0:
+    g->sig = sat_parse_hex(gps->nmea.term_str);
+    if (k < 4) {
+      g->svid[k] = (uint8_t)gps_parse_number(gps);
+    }
+    break;
+  case 1:
+    g->elev[k] = (int8_t)gps_parse_number(gps);
+    break;
+  case 2:
+    g->az[k] = (uint16_t)gps_parse_number(gps);
+    break;
+  default:
+    g->cno[k] = (uint8_t)gps_parse_number(gps);
+    break;
+  }
+}
+
+/**
+ * @brief 위성계 하나의 항목을 지우고 앞으로 당김
+ */
+static void sat_remove_gnss(gps_sat_table_t *t, uint8_t gnss) {
+  uint8_t j = 0;
+
+  for (uint8_t i = 0; i < t->count; i++) {
+    if (t->gnss[i] == gnss) {
+      continue;
+    }
+    if (i != j) {
+      t->svid[j] = t->svid[i];
+      t->gnss[j] = t->gnss[i];
+      t->cno[j] = t->cno[i];
+      t->elev[j] = t->elev[i];
+      t->az2[j] = t->az2[i];
+      t->flags[j] = t->flags[i];
+    }
+    j++;
+  }
+  t->count = j;
+}
+
+void gps_sat_gsv_commit(gps_t *gps) {
+  gps_sat_table_t *t = &gps->sat;
+  const gps_sat_gsv_t *g = &t->gsv;
+  uint32_t before;
+  uint8_t n, sig;
+
+  // NAV-SAT 이 오면 그쪽이 사용 여부까지 있어 GSV 는 보지 않음
+  if (t->src == GPS_SAT_SRC_NAV_SAT || g->gnss >= GPS_SAT_GNSS_CNT || g->msg_num == 0) {
+    return;
+  }
+
+  before = 4U * (g->msg_num - 1U);
+  n = g->n > before ? (uint8_t)(g->n - before) : 0;
+  if (n > 4) {
+    n = 4;
+  }
+  sig = g->last_term == 4 + 4 * n ? g->sig : 0;
+
+  // 같은 위성계의 다른 신호 묶음은 건너뜀 (msgNum 1 이 다시 오면 다음 epoch)
+  if (t->gsv_sig[g->gnss] != 0xFF && t->gsv_sig[g->gnss] != sig) {
+    return;
+  }
+
+  sat_write_begin(t);
+  if (g->msg_num == 1) {
+    if (t->src != GPS_SAT_SRC_GSV) {
+      t->count = 0;
+      t->itow = 0;
+      t->src = GPS_SAT_SRC_GSV;
+    }
+    sat_remove_gnss(t, g->gnss);
+    t->gsv_sig[g->gnss] = sig;
+  }
+  for (uint8_t k = 0; k < n && t->count < GPS_SAT_MAX; k++) {
+    uint8_t i = t->count++;
+
+    t->svid[i] = g->svid[k];
+    t->gnss[i] = g->gnss;
+    t->cno[i] = g->cno[k];
+    t->elev[i] = g->elev[k];
+    t->az2[i] = (uint8_t)(g->az[k] / 2);
+    t->flags[i] = 0;
+  }
+  sat_write_end(t);
+}
+
+static void sat_summarize(const gps_sat_table_t *t, gps_sat_summary_t *out) {
+  uint16_t cno_sum[GPS_SAT_GNSS_CNT] = {0};
+  uint16_t total_sum = 0;
+  uint8_t count = t->count;
+
+  memset(out, 0, sizeof(*out));
+  out->src = t->src;
+  for (uint8_t i = 0; i < count && i < GPS_SAT_MAX; i++) {
+    uint8_t g = t->gnss[i];
+
+    if (g >= GPS_SAT_GNSS_CNT || t->cno[i] == 0) {
+      continue;
+    }
+    out->tracked[g]++;
+    cno_sum[g] += t->cno[i];
+    if (t->flags[i] & GPS_SAT_USED) {
+      out->used[g]++;
+    }
+  }
+
+  for (int g = 0; g < GPS_SAT_GNSS_CNT; g++) {
+    if (out->tracked[g]) {
+      out->cno[g] = (uint8_t)(cno_sum[g] / out->tracked[g]);
+    }
+    out->total_tracked += out->tracked[g];
+    out->total_used += out->used[g];
+    total_sum += cno_sum[g];
+  }
+  if (out->total_tracked) {
+    out->total_cno = (uint8_t)(total_sum / out->total_tracked);
+  }
+}
+
+void gps_sat_summary(const gps_t *gps, gps_sat_summary_t *out) {
+  const gps_sat_table_t *t = &gps->sat;
+
+  for (int retry = 0; retry < GPS_SAT_READ_RETRY; retry++) {
+    uint32_t seq = t->seq;
+
+    if (seq & 1U) {
+      continue;
+    }
+    GPS_SAT_BARRIER();
+    sat_summarize(t, out);
+    GPS_SAT_BARRIER();
+    if (t->seq == seq) {
+      return;
+    }
+  }
+
+  // 계속 쓰는 중이면 마지막으로 읽은 값 (진단용이라 충분)
+  sat_summarize(t, out);
+}
+
+size_t gps_sat_format(uint8_t id, const gps_sat_summary_t *s, char *buf, size_t size) {
+  static const char *const src_names[] = {"none", "gsv", "nav"};
+  size_t pos;
+  int n;
+
+  n = snprintf(buf, size, "+SAT,%u,src=%s,trk=%u,used=%u,cno=%u", id,
+               s->src <= GPS_SAT_SRC_NAV_SAT ? src_names[s->src] : "?", s->total_tracked,
+               s->total_used, s->total_cno);
+  if (n < 0 || (size_t)n >= size) {
+    return 0;
+  }
+  pos = n;
+
+  for (int g = 0; g < GPS_SAT_GNSS_CNT; g++) {
+    if (s->tracked[g] == 0) {
+      continue;
+    }
+    n = snprintf(&buf[pos], size - pos, ",%c=%u/%u/%u", gnss_letters[g], s->tracked[g],
+                 s->used[g], s->cno[g]);
+    if (n < 0 || (size_t)n >= size - pos) {
+      return 0;
+    }
+    pos += n;
+  }
+
+  n = snprintf(&buf[pos], size - pos, "\n\r");
+  if (n < 0 || (size_t)n >= size - pos) {
+    return 0;
+  }
+
+  return pos + n;
+}
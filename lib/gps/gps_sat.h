@@ -0,0 +1,126 @@
+#ifndef GPS_SAT_H
+#define GPS_SAT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct gps_s gps_t;
+
+/**
+ * @brief 위성별 신호 표 (UBX NAV-SAT 또는 NMEA GSV)
+ *
+ * 필드마다 배열로 두고 (structure of arrays) epoch 마다 그 자리에서 고친다.
+ * 위성마다 할당이나 문자열 변환은 없다. NAV-SAT 은 한 메시지가 한 epoch 라
+ * 표 전체를 바꾸고, GSV 는 위성계마다 msgNum 1 이 올 때 그 위성계만 새로
+ * 채운다. GSV 는 위성계의 첫 신호 (보통 L1) 묶음만 쓰고 사용 여부가 없어
+ * GPS_SAT_USED 는 NAV-SAT 에서만 선다.
+ *
+ * 쓰기는 파서 (RX 태스크) 하나만, 읽는 쪽은 gps_sat_summary() 로 seq 를
+ * 보고 다시 읽는다 (gps_nav 와 같은 방식).
+ */
+#define GPS_SAT_MAX 64
+
+/* 위성계 (UBX gnssId 번호) */
+typedef enum {
+  GPS_SAT_GNSS_GPS = 0,
+  GPS_SAT_GNSS_SBAS = 1,
+  GPS_SAT_GNSS_GAL = 2,
+  GPS_SAT_GNSS_BDS = 3,
+  GPS_SAT_GNSS_IMES = 4,
+  GPS_SAT_GNSS_QZSS = 5,
+  GPS_SAT_GNSS_GLO = 6,
+  GPS_SAT_GNSS_NAVIC = 7,
+  GPS_SAT_GNSS_CNT
+} gps_sat_gnss_t;
+
+/* flags */
+#define GPS_SAT_USED 0x01      /**< 항법에 씀 */
+#define GPS_SAT_DIFF 0x02      /**< 보정 데이터 있음 */
+#define GPS_SAT_UNHEALTHY 0x04
+#define GPS_SAT_QUAL_SHIFT 4   /**< bit 4~6: NAV-SAT qualityInd (0~7) */
+#define GPS_SAT_QUAL(flags) (((flags) >> GPS_SAT_QUAL_SHIFT) & 0x07)
+
+typedef enum {
+  GPS_SAT_SRC_NONE = 0,
+  GPS_SAT_SRC_GSV,
+  GPS_SAT_SRC_NAV_SAT,
+} gps_sat_src_t;
+
+/* GSV 한 sentence (최대 4 위성) 를 checksum 확인 전까지 모아 둠 */
+typedef struct {
+  uint8_t gnss;
+  uint8_t msg_num;
+  uint8_t n;
+  uint8_t last_term;
+  uint8_t sig;        // signalId (NMEA 4.10 이전은 0)
+  uint8_t svid[4];
+  int8_t elev[4];
+  uint16_t az[4];
+  uint8_t cno[4];
+} gps_sat_gsv_t;
+
+typedef struct {
+  volatile uint32_t seq;
+  uint8_t src;        // gps_sat_src_t
+  uint8_t count;
+  uint32_t itow;      // NAV-SAT iTOW [ms] (GSV 는 0)
+
+  uint8_t svid[GPS_SAT_MAX];
+  uint8_t gnss[GPS_SAT_MAX];
+  uint8_t cno[GPS_SAT_MAX];  // [dBHz]
+  int8_t elev[GPS_SAT_MAX];  // [deg]
+  uint8_t az2[GPS_SAT_MAX];  // 방위각 / 2 [2 deg]
+  uint8_t flags[GPS_SAT_MAX];
+
+  uint8_t gsv_sig[GPS_SAT_GNSS_CNT]; // 위성계마다 쓰는 GSV 신호 (0xFF: 아직 없음)
+  gps_sat_gsv_t gsv;
+} gps_sat_table_t;
+
+/**
+ * @brief 위성계별 요약
+ */
+typedef struct {
+  uint8_t src; // gps_sat_src_t
+  uint8_t tracked[GPS_SAT_GNSS_CNT];
+  uint8_t used[GPS_SAT_GNSS_CNT];
+  uint8_t cno[GPS_SAT_GNSS_CNT]; // 추적 중 (C/N0 > 0) 위성 평균 [dBHz]
+  uint8_t total_tracked;
+  uint8_t total_used;
+  uint8_t total_cno;
+} gps_sat_summary_t;
+
+void gps_sat_init(gps_sat_table_t *t);
+
+/**
+ * @brief UBX-NAV-SAT payload 로 표 전체를 바꿈
+ */
+void gps_sat_from_nav_sat(gps_sat_table_t *t, const uint8_t *payload, uint16_t len);
+
+/**
+ * @brief GSV term 하나 (NMEA 파서 term 핸들러에서)
+ */
+void gps_sat_gsv_term(gps_t *gps);
+
+/**
+ * @brief checksum 을 통과한 GSV sentence 를 표에 반영
+ */
+void gps_sat_gsv_commit(gps_t *gps);
+
+/**
+ * @brief 위성계별 추적/사용 수와 평균 C/N0 (다른 태스크에서)
+ */
+void gps_sat_summary(const gps_t *gps, gps_sat_summary_t *out);
+
+/**
+ * @brief 요약 문자열
+ *
+ * +SAT,<id>,src=<none|gsv|nav>,trk=<n>,used=<n>,cno=<dBHz> 다음에 위성이 있는
+ * 위성계마다 ,<G|S|E|C|I|J|R|N>=<추적>/<사용>/<평균 C/N0>
+ *
+ * @param id 수신기 번호 (gps_id_t)
+ * @return size_t 길이, 버퍼 부족이면 0
+ */
+size_t gps_sat_format(uint8_t id, const gps_sat_summary_t *s, char *buf, size_t size);
+
+#endif
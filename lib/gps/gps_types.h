@@ -18,6 +18,55 @@ typedef enum {
   GPS_PROTOCOL_INVALID = UINT8_MAX
 } gps_procotol_t;
 
+/**
+ * @brief 고정소수점 위치 (위경도 1e-9 deg, 높이 0.1 mm)
+ *
+ * M4F 의 FPU 는 단정밀도뿐이라 double 연산은 소프트웨어로 돈다. 항법 해는
+ * 수신 프레임 (UBX HPPOSLLH 의 1e-7 + 1e-9 deg, mm + 0.1 mm) 부터 출력까지
+ * 이 형식으로 다루고, double 은 API 경계 (Unicore BESTNAV 입력, 평균기
+ * 통계, 문자열 명령) 에서만 변환한다. int32 0.1 mm 는 +-214 km 까지.
+ */
+typedef struct {
+  int64_t lat;           // 1e-9 deg
+  int64_t lon;           // 1e-9 deg
+  int32_t ellipsoid_alt; // 0.1 mm
+  int32_t msl_alt;       // 0.1 mm
+} gps_llh_t;
+
+#define GPS_LLH_DEG_SCALE 1000000000LL
+#define GPS_LLH_ALT_SCALE 10000
+
+/** UBX 값 + hp 값 (1e-7 deg + 1e-9 deg) -> 1e-9 deg */
+static inline int64_t gps_llh_from_ubx_deg(int32_t v, int8_t hp) {
+  return (int64_t)v * 100 + hp;
+}
+
+/** UBX 값 + hp 값 (mm + 0.1 mm) -> 0.1 mm */
+static inline int32_t gps_llh_from_ubx_alt(int32_t v, int8_t hp) {
+  return v * 10 + hp;
+}
+
+static inline int64_t gps_llh_deg_from_double(double deg) {
+  return (int64_t)(deg * 1e9 + (deg >= 0 ? 0.5 : -0.5));
+}
+
+static inline int32_t gps_llh_alt_from_double(double m) {
+  return (int32_t)(m * 1e4 + (m >= 0 ? 0.5 : -0.5));
+}
+
+static inline double gps_llh_deg_to_double(int64_t v) {
+  return (double)v * 1e-9;
+}
+
+static inline double gps_llh_alt_to_double(int32_t v) {
+  return (double)v * 1e-4;
+}
+
+/** 0.1 mm -> mm (반올림) */
+static inline int32_t gps_llh_alt_to_mm(int32_t v) {
+  return (v >= 0 ? v + 5 : v - 5) / 10;
+}
+
 typedef enum {
   GPS_EVENT_NONE = 0,
 
@@ -84,6 +133,7 @@ typedef enum {
   GPS_NMEA_MSG_GGA = 1,
   GPS_NMEA_MSG_RMC = 2,
   GPS_NMEA_MSG_THS = 3,
+  GPS_NMEA_MSG_GSV = 4,
   GPS_NMEA_MSG_INVALID = UINT8_MAX
 } gps_nmea_msg_t;
 
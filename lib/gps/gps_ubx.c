@@ -1,32 +1,48 @@
 #include "gps_ubx.h"
 #include "gps.h"
 #include "gps_parse.h"
+#include "crc.h"
+#include "mem_section.h"
+#include "simd.h"
+#include <stddef.h>
 #include <string.h>
 
+#if defined(USE_GPS_UBLOX)
+
 #define UBX_SYNC_1 0xB5
 #define UBX_SYNC_2 0x62
 
-static inline void calc_ubx_chksum(gps_t *gps);
+static inline void add_ubx_chksum(gps_t *gps, uint8_t ch);
 static inline uint8_t check_ubx_chksum(gps_t *gps);
 static void store_ubx_nav_data(gps_t *gps);
 static void store_ubx_data(gps_t *gps);
 static void handle_ubx_ack(gps_t *gps, uint8_t cls, uint8_t id, bool is_ack);
 static size_t ubx_build_valset_msg(uint8_t *buf, ubx_cfg_layer_t layer,
+                                   ubx_valset_transaction_t transaction,
                                    const ubx_cfg_item_t *items, size_t item_count);
+static bool ubx_send_valset_tx(gps_t *gps, ubx_cfg_layer_t layer,
+                               ubx_valset_transaction_t transaction,
+                               const ubx_cfg_item_t *items, size_t item_count,
+                               uint32_t timeout_ms, ubx_ack_callback_t callback,
+                               void *user_data);
 static uint32_t get_tick_ms(void);
 static void store_ubx_ack_data(gps_t *gps);
+static void store_ubx_cfg_data(gps_t *gps);
+static void store_ubx_upd_data(gps_t *gps);
+static void store_ubx_rxm_data(gps_t *gps);
+static void store_ubx_mon_data(gps_t *gps);
 
 
-static inline void calc_ubx_chksum(gps_t *gps)
+/**
+ * @brief ubx 프로토콜 체크섬 누적 (바이트 수신 시마다 호출)
+ *
+ * @param[inout] gps
+ * @param[in] ch class ~ payload 범위의 수신 바이트
+ */
+static inline void add_ubx_chksum(gps_t *gps, uint8_t ch)
 {
-  gps->ubx.cal_chksum_a = 0;
-  gps->ubx.cal_chksum_b = 0;
-
-  for (int i = 0; i < gps->ubx.len + 4; i++)
-  {
-    gps->ubx.cal_chksum_a += gps->payload[i];
-    gps->ubx.cal_chksum_b += gps->ubx.cal_chksum_a;
-  }
+  gps->ubx.cal_chksum_a += ch;
+  gps->ubx.cal_chksum_b += gps->ubx.cal_chksum_a;
 }
 
 /**
@@ -37,8 +53,6 @@ static inline void calc_ubx_chksum(gps_t *gps)
  */
 static inline uint8_t check_ubx_chksum(gps_t *gps)
 {
-  calc_ubx_chksum(gps);
-
   if (gps->ubx.cal_chksum_a == gps->ubx.chksum_a &&
       gps->ubx.cal_chksum_b == gps->ubx.chksum_b)
   {
@@ -55,9 +69,13 @@ static inline uint8_t check_ubx_chksum(gps_t *gps)
  */
 static void store_ubx_nav_data(gps_t *gps)
 {
-  char *data = &gps->payload[4];
+  const uint8_t *data = &gps->frame[4];
   switch (gps->ubx.id)
   {
+  case GPS_UBX_NAV_ID_PVT:
+    memcpy(&gps->ubx_data.pvt, data, sizeof(gps_ubx_nav_pvt_t));
+    break;
+
   case GPS_UBX_NAV_ID_HPPOSLLH:
     memcpy(&gps->ubx_data.hpposllh, data, sizeof(gps_ubx_nav_hpposllh_t));
     break;
@@ -66,6 +84,10 @@ static void store_ubx_nav_data(gps_t *gps)
     memcpy(&gps->ubx_data.relposned, data, sizeof(gps_ubx_nav_relposned_t));
     break;
 
+  case GPS_UBX_NAV_ID_SAT:
+    gps_sat_from_nav_sat(&gps->sat, data, gps->ubx.len);
+    break;
+
   default:
     break;
   }
@@ -88,6 +110,22 @@ static void store_ubx_data(gps_t *gps)
     store_ubx_ack_data(gps);
     break;
 
+  case GPS_UBX_CLASS_CFG:
+    store_ubx_cfg_data(gps);
+    break;
+
+  case GPS_UBX_CLASS_UPD:
+    store_ubx_upd_data(gps);
+    break;
+
+  case GPS_UBX_CLASS_RXM:
+    store_ubx_rxm_data(gps);
+    break;
+
+  case GPS_UBX_CLASS_MON:
+    store_ubx_mon_data(gps);
+    break;
+
   default:
     break;
   }
@@ -99,22 +137,44 @@ static void store_ubx_data(gps_t *gps)
  * @param[inout] gps
  * @return uint8_t 1: success 0: checksum mismatch
  */
-uint8_t gps_parse_ubx(gps_t *gps)
+RAM_FUNC uint8_t gps_parse_ubx(gps_t *gps)
 {
+  /* 헤더와 체크섬은 지금 바이트에서 읽음 (링 모드는 payload 에 복사 안 함) */
+  uint8_t ch = *gps->cur;
+
+  /* class, id, len, payload 바이트는 수신 즉시 체크섬에 누적 */
+  if (gps->pos <= 4 + (uint32_t)gps->ubx.len)
+  {
+    add_ubx_chksum(gps, ch);
+  }
+
   if (gps->pos == 1)
   {
-    gps->ubx.class = gps->payload[0];
+    gps->ubx.class = ch;
     gps->state = GPS_PARSE_STATE_UBX_MSG_CLASS;
   }
   else if (gps->pos == 2)
   {
-    gps->ubx.id = gps->payload[1];
+    gps->ubx.id = ch;
     gps->state = GPS_PARSE_STATE_UBX_MSG_ID;
   }
+  else if (gps->pos == 3)
+  {
+    gps->ubx.len = ch;
+  }
   else if (gps->pos == 4)
   {
-    gps->ubx.len = (gps->payload[2] | ((gps->payload[3] << 8)));
+    gps->ubx.len |= (uint16_t)ch << 8;
     gps->state = GPS_PARSE_STATE_UBX_LEN;
+
+    /* 버퍼에 담을 수 없는 길이는 버리고 재동기화 */
+    if ((size_t)gps->ubx.len + 6 > _gps_frame_cap(gps))
+    {
+      GPS_STATS_INC(gps, GPS_PROTOCOL_UBX, oversize);
+      gps->protocol = GPS_PROTOCOL_NONE;
+      gps->state = GPS_PARSE_STATE_NONE;
+      return 0;
+    }
   }
   else
   {
@@ -125,20 +185,25 @@ uint8_t gps_parse_ubx(gps_t *gps)
     else if (gps->pos == 5 + gps->ubx.len)
     {
       gps->state = GPS_PARSE_STATE_UBX_CHKSUM_A;
-      gps->ubx.chksum_a = gps->payload[4 + gps->ubx.len];
+      gps->ubx.chksum_a = ch;
     }
     else if (gps->pos == 6 + gps->ubx.len)
     {
       gps->state = GPS_PARSE_STATE_UBX_CHKSUM_B;
-      gps->ubx.chksum_b = gps->payload[5 + gps->ubx.len];
+      gps->ubx.chksum_b = ch;
 
       if (check_ubx_chksum(gps))
       {
+        // class ~ payload (sync 2 byte 다음부터)
+        _gps_frame_acquire(gps, 2, 4 + gps->ubx.len);
         store_ubx_data(gps);
+        _gps_frame_release(gps);
         gps_msg_t msg;
         msg.ubx.class = gps->ubx.class;
         msg.ubx.id = gps->ubx.id;
-        gps->handler(gps, GPS_EVENT_NONE, GPS_PROTOCOL_UBX, msg);
+        GPS_STATS_INC(gps, GPS_PROTOCOL_UBX, frame_ok);
+        gps_nav_publish(gps, GPS_PROTOCOL_UBX, msg);
+        gps_dispatch(gps, GPS_PROTOCOL_UBX, msg);
         gps->protocol = GPS_PROTOCOL_NONE;
         gps->state = GPS_PARSE_STATE_NONE;
 
@@ -146,6 +211,7 @@ uint8_t gps_parse_ubx(gps_t *gps)
       }
       else
       {
+        GPS_STATS_INC(gps, GPS_PROTOCOL_UBX, chksum_err);
         gps->protocol = GPS_PROTOCOL_NONE;
         gps->state = GPS_PARSE_STATE_NONE;
         return 0;
@@ -194,122 +260,151 @@ void ubx_calc_checksum(const uint8_t *data, size_t len,
 {
 
   *ck_a = 0;
-
   *ck_b = 0;
-
-  for (size_t i = 0; i < len; i++)
-  {
-
-    *ck_a += data[i];
-
-    *ck_b += *ck_a;
-  }
+  simd_fletcher8(data, len, ck_a, ck_b);
 }
 
 /**
-
  * @brief UBX command handler 초기화
-
  *
-
  * @param[inout] handler Command handler
-
  */
-
 void ubx_cmd_handler_init(ubx_cmd_handler_t *handler)
 {
+  memset(handler, 0, sizeof(*handler));
+}
 
-  handler->pending_cls = 0;
-
-  handler->pending_id = 0;
+/**
+ * @brief 응답 대기 슬롯을 잡고 명령 전송
+ *
+ * 응답이 전송 중에 와도 찾을 수 있게 슬롯을 먼저 채운다. 명령은 여러
+ * 태스크에서 보낼 수 있으므로 슬롯 표는 critical section 안에서 바꾼다.
+ *
+ * @return true 전송, false 슬롯이 모두 차 있음
+ */
+static bool ubx_cmd_submit(gps_t *gps, uint8_t cls, uint8_t id, const uint8_t *msg,
+                           size_t len, uint32_t timeout_ms,
+                           ubx_ack_callback_t callback, void *user_data)
+{
+  ubx_cmd_handler_t *handler = &gps->ubx_cmd_handler;
+  ubx_cmd_slot_t *slot = NULL;
 
-  handler->state = UBX_CMD_STATE_IDLE;
+  taskENTER_CRITICAL();
+  for (uint8_t i = 0; i < UBX_CMD_PENDING_MAX && !slot; i++)
+  {
+    if (!handler->slot[i].busy)
+    {
+      slot = &handler->slot[i];
+      slot->busy = true;
+      slot->cls = cls;
+      slot->id = id;
+      slot->seq = handler->seq++;
+      slot->timestamp = get_tick_ms();
+      slot->timeout_ms = timeout_ms;
+      slot->callback = callback;
+      slot->callback_data = user_data;
+    }
+  }
+  taskEXIT_CRITICAL();
 
-  handler->timestamp = 0;
+  if (!slot)
+  {
+    return false;
+  }
 
-  handler->callback = NULL;
+  gps->ops->send((const char *)msg, len);
 
-  handler->callback_data = NULL;
+  return true;
 }
 
 /**
+ * @brief 슬롯을 비우고 콜백 호출 (콜백 안에서 다음 명령을 보낼 수 있음)
+ */
+static void ubx_cmd_complete(ubx_cmd_slot_t *slot, ubx_cmd_state_t result)
+{
+  ubx_ack_callback_t callback;
+  void *user_data;
 
- * @brief 명령 상태 확인 (타임아웃 체크 포함)
-
- *
-
- * @param[inout] handler Command handler
-
- * @param[in] timeout_ms Timeout (ms)
-
- * @return ubx_cmd_state_t 현재 상태
+  taskENTER_CRITICAL();
+  if (!slot->busy)
+  {
+    taskEXIT_CRITICAL();
+    return;
+  }
+  callback = slot->callback;
+  user_data = slot->callback_data;
+  slot->busy = false;
+  taskEXIT_CRITICAL();
 
- */
+  if (callback)
+  {
+    callback(result, user_data);
+  }
+}
 
-ubx_cmd_state_t ubx_get_cmd_state(ubx_cmd_handler_t *handler, uint32_t timeout_ms)
+void ubx_cmd_poll(gps_t *gps)
 {
+  ubx_cmd_handler_t *handler = &gps->ubx_cmd_handler;
+  uint32_t now = get_tick_ms();
 
-  if (handler->state == UBX_CMD_STATE_WAITING)
+  for (uint8_t i = 0; i < UBX_CMD_PENDING_MAX; i++)
   {
+    ubx_cmd_slot_t *slot = &handler->slot[i];
 
-    uint32_t elapsed = get_tick_ms() - handler->timestamp;
-
-    if (elapsed >= timeout_ms)
+    if (slot->busy && now - slot->timestamp >= slot->timeout_ms)
     {
-
-      handler->state = UBX_CMD_STATE_TIMEOUT;
+      ubx_cmd_complete(slot, UBX_CMD_STATE_TIMEOUT);
     }
   }
+}
+
+uint8_t ubx_cmd_pending(gps_t *gps)
+{
+  uint8_t n = 0;
+
+  for (uint8_t i = 0; i < UBX_CMD_PENDING_MAX; i++)
+  {
+    n += gps->ubx_cmd_handler.slot[i].busy ? 1 : 0;
+  }
 
-  return handler->state;
+  return n;
 }
 
 /**
-
  * @brief ACK/NAK 처리 (파서에서 호출)
-
  *
-
+ * 같은 class/ID 를 기다리는 명령 중 가장 먼저 보낸 것을 완료한다.
+ *
  * @param[inout] gps GPS 구조체
-
  * @param[in] cls ACK된 명령의 Class
-
  * @param[in] id ACK된 명령의 ID
-
  * @param[in] is_ack true: ACK, false: NAK
-
  */
-
 static void handle_ubx_ack(gps_t *gps, uint8_t cls, uint8_t id, bool is_ack)
 {
-
   ubx_cmd_handler_t *handler = &gps->ubx_cmd_handler;
+  ubx_cmd_slot_t *oldest = NULL;
+  uint8_t oldest_age = 0;
 
-  // Pending 명령과 일치하는지 확인
-
-  if (handler->state == UBX_CMD_STATE_WAITING &&
-
-      handler->pending_cls == cls &&
-
-      handler->pending_id == id)
+  taskENTER_CRITICAL();
+  for (uint8_t i = 0; i < UBX_CMD_PENDING_MAX; i++)
   {
+    ubx_cmd_slot_t *slot = &handler->slot[i];
+    uint8_t age = (uint8_t)(handler->seq - slot->seq);
 
-    // 상태 업데이트
-
-    handler->state = is_ack ? UBX_CMD_STATE_ACK : UBX_CMD_STATE_NAK;
-
-    // 콜백 호출 (있으면)
-
-    if (handler->callback)
+    if (slot->busy && slot->cls == cls && slot->id == id &&
+        (!oldest || age > oldest_age))
     {
-
-      handler->callback(is_ack, handler->callback_data);
-
-      handler->callback = NULL;
-
-      handler->callback_data = NULL;
+      oldest = slot;
+      oldest_age = age;
     }
   }
+  taskEXIT_CRITICAL();
+
+  if (oldest)
+  {
+    ubx_cmd_complete(oldest, is_ack ? UBX_CMD_STATE_ACK : UBX_CMD_STATE_NAK);
+  }
 }
 
 /**
@@ -322,6 +417,8 @@ static void handle_ubx_ack(gps_t *gps, uint8_t cls, uint8_t id, bool is_ack)
 
  * @param[in] layer Layer (RAM/BBR/Flash)
 
+ * @param[in] transaction Transaction 단계 (NONE 이면 version 0)
+
  * @param[in] items Configuration items
 
  * @param[in] item_count Item 개수
@@ -331,12 +428,17 @@ static void handle_ubx_ack(gps_t *gps, uint8_t cls, uint8_t id, bool is_ack)
  */
 
 static size_t ubx_build_valset_msg(uint8_t *buf, ubx_cfg_layer_t layer,
-
+                                   ubx_valset_transaction_t transaction,
                                    const ubx_cfg_item_t *items, size_t item_count)
 {
 
   size_t offset = 0;
 
+  if (item_count == 0 || item_count > UBX_VALSET_MAX_KEYS)
+  {
+    return 0;
+  }
+
   // Sync bytes
 
   buf[offset++] = UBX_SYNC_1;
@@ -359,11 +461,11 @@ static size_t ubx_build_valset_msg(uint8_t *buf, ubx_cfg_layer_t layer,
 
   // VAL-SET 헤더
 
-  buf[offset++] = 0x00; // Version
+  buf[offset++] = (transaction == UBX_VALSET_TRANSACTION_NONE) ? 0x00 : 0x01; // Version
 
   buf[offset++] = (uint8_t)layer; // Layer
 
-  buf[offset++] = 0x00; // Reserved
+  buf[offset++] = (uint8_t)transaction; // Transaction (version 1)
 
   buf[offset++] = 0x00; // Reserved
 
@@ -377,6 +479,11 @@ static size_t ubx_build_valset_msg(uint8_t *buf, ubx_cfg_layer_t layer,
 
       return 0; // 잘못된 value_len
     }
+
+    if (offset + 4 + items[i].value_len + 2 > UBX_VALSET_MSG_SIZE)
+    {
+      return 0; // 버퍼 초과
+    }
     // Key (4 bytes, little-endian)
 
     buf[offset++] = (items[i].key_id >> 0) & 0xFF;
@@ -437,44 +544,39 @@ bool ubx_send_valset(gps_t *gps, ubx_cfg_layer_t layer,
 
                      const ubx_cfg_item_t *items, size_t item_count)
 {
+  return ubx_send_valset_tx(gps, layer, UBX_VALSET_TRANSACTION_NONE, items,
+                            item_count, UBX_CMD_TIMEOUT_MS, NULL, NULL);
+}
 
-  ubx_cmd_handler_t *handler = &gps->ubx_cmd_handler;
-
-  // 이미 대기 중인 명령이 있으면 실패
-
-  if (handler->state == UBX_CMD_STATE_WAITING)
-  {
-
-    return false;
-  }
-
-  // 메시지 생성
-
-  uint8_t msg[256];
-
-  size_t msg_len = ubx_build_valset_msg(msg, layer, items, item_count);
+/**
+ * @brief UBX VAL-SET 전송 (transaction 지정)
+ *
+ * @param[inout] gps GPS 구조체
+ * @param[in] layer Layer (RAM/BBR/Flash)
+ * @param[in] transaction Transaction 단계
+ * @param[in] items Configuration items
+ * @param[in] item_count Item 개수
+ * @param[in] timeout_ms 응답 타임아웃 (ms)
+ * @param[in] callback ACK/NAK/TIMEOUT 콜백 (NULL 가능)
+ * @param[in] user_data 콜백 데이터
+ * @return true 전송 성공, false 대기 슬롯 없음 또는 메시지 생성 실패
+ */
+static bool ubx_send_valset_tx(gps_t *gps, ubx_cfg_layer_t layer,
+                               ubx_valset_transaction_t transaction,
+                               const ubx_cfg_item_t *items, size_t item_count,
+                               uint32_t timeout_ms, ubx_ack_callback_t callback,
+                               void *user_data)
+{
+  uint8_t msg[UBX_VALSET_MSG_SIZE];
+  size_t msg_len = ubx_build_valset_msg(msg, layer, transaction, items, item_count);
 
   if (msg_len == 0)
   {
-
     return false;
   }
 
-  // Pending 설정
-
-  handler->pending_cls = GPS_UBX_CLASS_CFG;
-
-  handler->pending_id = GPS_UBX_CFG_ID_VALSET;
-
-  handler->state = UBX_CMD_STATE_WAITING;
-
-  handler->timestamp = get_tick_ms();
-
-  // UART로 전송
-
-  gps->ops->send((const char *)msg, msg_len);
-
-  return true;
+  return ubx_cmd_submit(gps, GPS_UBX_CLASS_CFG, GPS_UBX_CFG_ID_VALSET, msg, msg_len,
+                        timeout_ms, callback, user_data);
 }
 
 /**
@@ -491,7 +593,7 @@ bool ubx_send_valset(gps_t *gps, ubx_cfg_layer_t layer,
 
  * @param[in] item_count Item 개수
 
- * @param[in] callback ACK/NAK 콜백
+ * @param[in] callback ACK/NAK/TIMEOUT 콜백
 
  * @param[in] user_data 콜백 데이터
 
@@ -505,20 +607,22 @@ bool ubx_send_valset_cb(gps_t *gps, ubx_cfg_layer_t layer,
 
                         ubx_ack_callback_t callback, void *user_data)
 {
+  return ubx_send_valset_tx(gps, layer, UBX_VALSET_TRANSACTION_NONE, items,
+                            item_count, UBX_CMD_TIMEOUT_MS, callback, user_data);
+}
 
-  if (!ubx_send_valset(gps, layer, items, item_count))
-  {
-
-    return false;
-  }
-
-  // 콜백 등록
-
-  gps->ubx_cmd_handler.callback = callback;
-
-  gps->ubx_cmd_handler.callback_data = user_data;
+bool ubx_send_valset_txn_cb(gps_t *gps, ubx_cfg_layer_t layer,
+                            ubx_valset_transaction_t transaction,
+                            const ubx_cfg_item_t *items, size_t item_count,
+                            ubx_ack_callback_t callback, void *user_data)
+{
+  return ubx_send_valset_tx(gps, layer, transaction, items, item_count,
+                            UBX_CMD_TIMEOUT_MS, callback, user_data);
+}
 
-  return true;
+static void ubx_sync_callback(ubx_cmd_state_t result, void *user_data)
+{
+  *(volatile ubx_cmd_state_t *)user_data = result;
 }
 
 /**
@@ -527,6 +631,11 @@ bool ubx_send_valset_cb(gps_t *gps, ubx_cfg_layer_t layer,
 
  *
 
+ * 결과 변수가 호출자 스택에 있으므로 슬롯이 ACK/NAK 또는 타임아웃으로
+ * 끝날 때까지 돌아가지 않는다 (타임아웃은 여기서도 ubx_cmd_poll() 로 확인).
+
+ *
+
  * @param[inout] gps GPS 구조체
 
  * @param[in] layer Layer (RAM/BBR/Flash)
@@ -547,40 +656,21 @@ bool ubx_send_valset_sync(gps_t *gps, ubx_cfg_layer_t layer,
 
                           uint32_t timeout_ms)
 {
+  volatile ubx_cmd_state_t result = UBX_CMD_STATE_WAITING;
 
-  if (!ubx_send_valset(gps, layer, items, item_count))
+  if (!ubx_send_valset_tx(gps, layer, UBX_VALSET_TRANSACTION_NONE, items,
+                          item_count, timeout_ms, ubx_sync_callback, (void *)&result))
   {
-
     return false;
   }
 
-  while (1)
+  while (result == UBX_CMD_STATE_WAITING)
   {
-
-    ubx_cmd_state_t state = ubx_get_cmd_state(&gps->ubx_cmd_handler, timeout_ms);
-
-    if (state == UBX_CMD_STATE_ACK)
-    {
-
-      return true;
-    }
-
-    if (state == UBX_CMD_STATE_NAK)
-    {
-
-      return false;
-    }
-
-    if (state == UBX_CMD_STATE_TIMEOUT)
-    {
-
-      return false;
-    }
-
-    // 10ms 대기
-
     vTaskDelay(pdMS_TO_TICKS(10));
+    ubx_cmd_poll(gps);
   }
+
+  return result == UBX_CMD_STATE_ACK;
 }
 
 /**
@@ -597,24 +687,20 @@ bool ubx_send_valset_sync(gps_t *gps, ubx_cfg_layer_t layer,
 
  * @param[in] key_count Key 개수
 
+ * @param[in] callback 응답 (CFG-VALGET 또는 NAK) / TIMEOUT 콜백
+
+ * @param[in] user_data 콜백 데이터
+
  * @return true 전송 성공, false 실패
 
  */
 
 bool ubx_send_valget(gps_t *gps, ubx_cfg_layer_t layer,
 
-                     const uint32_t *key_ids, size_t key_count)
-{
-
-  ubx_cmd_handler_t *handler = &gps->ubx_cmd_handler;
-
-  // 이미 대기 중인 명령이 있으면 실패
+                     const uint32_t *key_ids, size_t key_count,
 
-  if (handler->state == UBX_CMD_STATE_WAITING)
-  {
-
-    return false;
-  }
+                     ubx_ack_callback_t callback, void *user_data)
+{
 
   uint8_t msg[256];
 
@@ -640,11 +726,11 @@ bool ubx_send_valget(gps_t *gps, ubx_cfg_layer_t layer,
 
   size_t payload_offset = offset;
 
-  // VAL-GET 헤더
+  // VAL-GET 헤더 (layer 는 VAL-SET 의 bit mask 가 아니라 번호: 0 RAM, 1 BBR, 2 Flash)
 
   msg[offset++] = 0x00; // Version
 
-  msg[offset++] = (uint8_t)layer; // Layer
+  msg[offset++] = (layer & UBX_CFG_LAYER_RAM) ? 0 : (layer & UBX_CFG_LAYER_BBR) ? 1 : 2; // Layer
 
   msg[offset++] = 0x00; // Position (reserved)
 
@@ -682,21 +768,8 @@ bool ubx_send_valget(gps_t *gps, ubx_cfg_layer_t layer,
 
   msg[offset++] = ck_b;
 
-  // Pending 설정
-
-  handler->pending_cls = GPS_UBX_CLASS_CFG;
-
-  handler->pending_id = GPS_UBX_CFG_ID_VALGET;
-
-  handler->state = UBX_CMD_STATE_WAITING;
-
-  handler->timestamp = get_tick_ms();
-
-  // UART로 전송
-
-  gps->ops->send((const char *)msg, offset);
-
-  return true;
+  return ubx_cmd_submit(gps, GPS_UBX_CLASS_CFG, GPS_UBX_CFG_ID_VALGET, msg, offset,
+                        UBX_CMD_TIMEOUT_MS, callback, user_data);
 }
 
 /**
@@ -717,18 +790,115 @@ static void store_ubx_ack_data(gps_t *gps)
   if (gps->ubx.len == 2)
   {
 
-    uint8_t acked_cls = gps->payload[4]; // Payload 시작
+    uint8_t acked_cls = gps->frame[4]; // Payload 시작
 
-    uint8_t acked_id = gps->payload[5];
+    uint8_t acked_id = gps->frame[5];
 
     bool is_ack = (gps->ubx.id == GPS_UBX_ACK_ID_ACK);
 
+    // VAL-GET 은 응답 메시지에서 이미 완료됨 (ACK 는 그 뒤에 옴)
+
+    if (is_ack && acked_cls == GPS_UBX_CLASS_CFG && acked_id == GPS_UBX_CFG_ID_VALGET)
+    {
+      return;
+    }
+
     // ACK/NAK 처리
 
     handle_ubx_ack(gps, acked_cls, acked_id, is_ack);
   }
 }
 
+/**
+ * @brief key ID 의 값 크기 (key ID bit 28~30)
+ *
+ * @param[in] key_id Configuration key ID
+ * @return uint8_t byte 수 (0 이면 알 수 없는 크기)
+ */
+static uint8_t ubx_key_value_size(uint32_t key_id)
+{
+  static const uint8_t size[8] = {0, 1, 1, 2, 4, 8, 0, 0};
+
+  return size[(key_id >> 28) & 0x07];
+}
+
+/**
+ * @brief 설정 한 개의 hash (key ID 4 byte LE + 값)
+ */
+static uint32_t ubx_cfg_item_hash(uint32_t key_id, const uint8_t *value, uint8_t len)
+{
+  uint8_t key[4] = {
+    (uint8_t)(key_id >> 0), (uint8_t)(key_id >> 8),
+    (uint8_t)(key_id >> 16), (uint8_t)(key_id >> 24),
+  };
+
+  return crc32_update(crc32_update(0, key, sizeof(key)), value, len);
+}
+
+/**
+ * @brief 설정 배열 hash
+ *
+ * VAL-GET 응답은 요청한 key 순서를 보장하지 않으므로 항목 hash 를 더해서
+ * 순서와 무관하게 만든다. 값 크기는 응답과 같게 key ID 에서 정한다.
+ *
+ * @param[in] items 설정 배열
+ * @param[in] count 설정 개수
+ * @return uint32_t hash
+ */
+static uint32_t ubx_cfg_hash(const ubx_cfg_item_t *items, size_t count)
+{
+  uint32_t hash = 0;
+
+  for (size_t i = 0; i < count; i++)
+  {
+    hash += ubx_cfg_item_hash(items[i].key_id, items[i].value,
+                              ubx_key_value_size(items[i].key_id));
+  }
+
+  return hash;
+}
+
+/**
+ * @brief 파싱한 ubx CFG 응답 처리 (VAL-GET)
+ *
+ * 대기 중인 VAL-GET 을 완료시킨다. 초기화 확인 중이면 그 전에 응답의
+ * key/값으로 hash 를 만든다.
+ *
+ * @param[inout] gps
+ */
+static void store_ubx_cfg_data(gps_t *gps)
+{
+  ubx_init_context_t *ctx = &gps->ubx_init_ctx;
+  const uint8_t *p = &gps->frame[4 + 4]; // version, layer, position
+  size_t remain = (gps->ubx.len > 4) ? gps->ubx.len - 4 : 0;
+
+  if (gps->ubx.id != GPS_UBX_CFG_ID_VALGET)
+  {
+    return;
+  }
+
+  ctx->rx_hash = 0;
+  ctx->rx_count = 0;
+
+  while (ctx->verifying && remain >= 4)
+  {
+    uint32_t key_id = p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+    uint8_t size = ubx_key_value_size(key_id);
+
+    if (size == 0 || remain < 4u + size)
+    {
+      break;
+    }
+
+    ctx->rx_hash += ubx_cfg_item_hash(key_id, &p[4], size);
+    ctx->rx_count++;
+    p += 4 + size;
+    remain -= 4 + size;
+  }
+
+  handle_ubx_ack(gps, GPS_UBX_CLASS_CFG, GPS_UBX_CFG_ID_VALGET, true);
+}
+
 /**
 
  * @brief 비동기 초기화 컨텍스트 초기화
@@ -746,6 +916,10 @@ void ubx_init_context_init(ubx_init_context_t *ctx)
 
   ctx->current_step = 0;
 
+  ctx->batch_count = 0;
+
+  ctx->batched = true;
+
   ctx->configs = NULL;
 
   ctx->config_count = 0;
@@ -759,6 +933,14 @@ void ubx_init_context_init(ubx_init_context_t *ctx)
   ctx->retry_count = 0;
 
   ctx->max_retries = 3; // 기본 3번 재시도
+
+  ctx->verifying = false;
+
+  ctx->cfg_hash = 0;
+
+  ctx->rx_hash = 0;
+
+  ctx->rx_count = 0;
 }
 
 /**
@@ -773,17 +955,79 @@ void ubx_init_context_init(ubx_init_context_t *ctx)
 
  */
 
-static void ubx_init_async_callback(bool ack, void *user_data)
+static void ubx_init_async_callback(ubx_cmd_state_t result, void *user_data)
 {
 
   gps_t *gps = (gps_t *)user_data;
 
   ubx_init_context_t *ctx = &gps->ubx_init_ctx;
 
+  bool ack = (result == UBX_CMD_STATE_ACK);
+
+  if (ctx->verifying)
+  {
+
+    ctx->verifying = false;
+
+    // 수신기에 같은 설정이 남아 있음 (MCU 만 리셋된 경우) - VAL-SET 생략
+
+    if (ack && ctx->rx_count == ctx->config_count && ctx->rx_hash == ctx->cfg_hash)
+    {
+
+      ctx->current_step = ctx->config_count;
+
+      ctx->state = UBX_INIT_STATE_DONE;
+
+      if (ctx->on_complete)
+      {
+
+        ctx->on_complete(true, 0, ctx->user_data);
+      }
+
+      return;
+    }
+
+    // 다르거나 NAK/타임아웃 - ubx_init_async_process()에서 처음부터 VAL-SET
+
+    return;
+  }
+
+  if (ctx->inflight > 0)
+  {
+    ctx->inflight--;
+  }
+
+  // 취소됐거나 앞선 실패로 다시 시작하기를 기다리는 중이면 남은 응답은 버림
+
+  if (ctx->state != UBX_INIT_STATE_RUNNING || ctx->restart)
+  {
+    return;
+  }
+
   if (!ack)
   {
 
-    // NAK 받음 - 재시도
+    if (ctx->batched)
+    {
+      // 묶음 전송 중 실패 - transaction 이 버려졌으므로 이미 보낸 나머지의
+      // 응답을 다 받은 뒤 처음부터 다시 보낸다 (ubx_init_async_process())
+
+      ctx->current_step = 0;
+
+      ctx->restart = true;
+
+      if (result == UBX_CMD_STATE_NAK)
+      {
+        // NAK 이면 한 개씩 보내 어느 단계가 실패했는지 확인한다
+        ctx->batched = false;
+
+        ctx->retry_count = 0;
+
+        return;
+      }
+    }
+
+    // NAK/타임아웃 - 재시도
 
     ctx->retry_count++;
 
@@ -808,13 +1052,16 @@ static void ubx_init_async_callback(bool ack, void *user_data)
     return;
   }
 
-  // ACK 받음 - 다음 단계로
+  // ACK 받음 - 한 개씩 모드는 여기서 다음 단계로 (묶음 모드는 보낼 때 넘어감)
 
   ctx->retry_count = 0; // 재시도 카운터 리셋
 
-  ctx->current_step++;
+  if (!ctx->batched)
+  {
+    ctx->current_step++;
+  }
 
-  if (ctx->current_step >= ctx->config_count)
+  if (ctx->current_step >= ctx->config_count && ctx->inflight == 0)
   {
 
     // 모든 단계 완료
@@ -831,6 +1078,128 @@ static void ubx_init_async_callback(bool ack, void *user_data)
   // 다음 단계는 ubx_init_async_process()에서 전송
 }
 
+/**
+ * @brief 한 VAL-SET 에 담을 수 있는 설정 개수
+ *
+ * @param[in] items 남은 설정 배열
+ * @param[in] count 남은 설정 개수
+ * @return size_t 묶을 개수 (key 64개 또는 메시지 버퍼 한도)
+ */
+static size_t ubx_valset_batch_count(const ubx_cfg_item_t *items, size_t count)
+{
+  size_t len = 8 + 4; // sync/class/id/len/checksum + VAL-SET 헤더
+  size_t n = 0;
+
+  while (n < count && n < UBX_VALSET_MAX_KEYS)
+  {
+    len += 4 + items[n].value_len;
+
+    if (len > UBX_VALSET_MSG_SIZE)
+    {
+      break;
+    }
+
+    n++;
+  }
+
+  return (n > 0) ? n : 1;
+}
+
+/**
+ * @brief 현재 단계부터 VAL-SET 전송
+ *
+ * 묶음 모드에서는 남은 설정을 가능한 만큼 한 메시지에 담고, 여러 메시지로
+ * 나뉘면 transaction 으로 묶어 마지막 메시지에서 한꺼번에 적용한다. 묶음
+ * 메시지는 ACK 를 기다리지 않고 이어 보내므로 보낼 때 current_step 을 넘긴다.
+ *
+ * @param[inout] gps GPS 구조체
+ * @return true 전송 성공, false 실패
+ */
+static bool ubx_init_send_step(gps_t *gps)
+{
+  ubx_init_context_t *ctx = &gps->ubx_init_ctx;
+  const ubx_cfg_item_t *items = &ctx->configs[ctx->current_step];
+  size_t remain = ctx->config_count - ctx->current_step;
+  ubx_valset_transaction_t transaction = UBX_VALSET_TRANSACTION_NONE;
+
+  if (ctx->batched)
+  {
+    ctx->batch_count = ubx_valset_batch_count(items, remain);
+
+    if (ctx->batch_count < ctx->config_count)
+    {
+      if (ctx->current_step == 0)
+      {
+        transaction = UBX_VALSET_TRANSACTION_BEGIN;
+      }
+      else if (ctx->batch_count == remain)
+      {
+        transaction = UBX_VALSET_TRANSACTION_APPLY;
+      }
+      else
+      {
+        transaction = UBX_VALSET_TRANSACTION_CONTINUE;
+      }
+    }
+  }
+  else
+  {
+    ctx->batch_count = 1;
+  }
+
+  if (!ubx_send_valset_tx(gps, ctx->layer, transaction, items, ctx->batch_count,
+                          UBX_CMD_TIMEOUT_MS, ubx_init_async_callback, gps))
+  {
+    return false;
+  }
+
+  ctx->inflight++;
+
+  if (ctx->batched)
+  {
+    ctx->current_step += ctx->batch_count;
+  }
+
+  return true;
+}
+
+/**
+ * @brief 설정 배열의 key 를 VAL-GET 한 번으로 읽기 요청
+ *
+ * 응답 hash 가 설정 배열 hash 와 같으면 VAL-SET 없이 완료한다.
+ *
+ * @param[inout] gps GPS 구조체
+ * @return true 전송 성공, false 실패 (key 가 너무 많거나 대기 중인 명령 있음)
+ */
+static bool ubx_init_send_verify(gps_t *gps)
+{
+  ubx_init_context_t *ctx = &gps->ubx_init_ctx;
+  uint32_t keys[UBX_VALGET_MAX_KEYS];
+
+  if (ctx->config_count > UBX_VALGET_MAX_KEYS)
+  {
+    return false;
+  }
+
+  for (size_t i = 0; i < ctx->config_count; i++)
+  {
+    keys[i] = ctx->configs[i].key_id;
+  }
+
+  // 응답이 전송 중에 올 수 있으므로 먼저 세운다
+  ctx->verifying = true;
+  ctx->batch_count = 0;
+
+  if (!ubx_send_valget(gps, ctx->layer, keys, ctx->config_count,
+                       ubx_init_async_callback, gps))
+  {
+    ctx->verifying = false;
+    return false;
+  }
+
+  return true;
+}
+
 /**
 
  * @brief 비동기 초기화 시작
@@ -876,6 +1245,10 @@ bool ubx_init_async_start(gps_t *gps, ubx_cfg_layer_t layer,
 
   ctx->current_step = 0;
 
+  ctx->batch_count = 0;
+
+  ctx->batched = true;
+
   ctx->configs = configs;
 
   ctx->config_count = config_count;
@@ -888,14 +1261,20 @@ bool ubx_init_async_start(gps_t *gps, ubx_cfg_layer_t layer,
 
   ctx->retry_count = 0;
 
-  // 첫 번째 설정 전송
+  ctx->verifying = false;
+
+  ctx->inflight = 0;
+
+  ctx->restart = false;
+
+  ctx->cfg_hash = ubx_cfg_hash(configs, config_count);
+
+  // 수신기 설정 확인 요청, 못 보내면 바로 첫 번째 설정 전송
 
   if (config_count > 0)
   {
 
-    if (!ubx_send_valset_cb(gps, layer, &configs[0], 1,
-
-                            ubx_init_async_callback, gps))
+    if (!ubx_init_send_verify(gps) && !ubx_init_send_step(gps))
     {
 
       // 전송 실패
@@ -938,72 +1317,51 @@ void ubx_init_async_process(gps_t *gps)
     return;
   }
 
-  // 명령 상태 확인
+  // 묶음 실패 - 이미 보낸 메시지의 응답 (또는 타임아웃) 이 다 온 뒤 처음부터
 
-  ubx_cmd_state_t cmd_state = ubx_get_cmd_state(&gps->ubx_cmd_handler, 3000);
-
-  if (cmd_state == UBX_CMD_STATE_WAITING)
+  if (ctx->restart)
   {
 
-    // 아직 대기 중
+    if (ctx->inflight > 0)
+    {
+      return;
+    }
 
-    return;
+    ctx->restart = false;
   }
 
-  if (cmd_state == UBX_CMD_STATE_TIMEOUT)
-  {
+  // VAL-GET 응답 대기 중
 
-    // 타임아웃 - 재시도
+  if (ctx->verifying)
+  {
 
-    ctx->retry_count++;
+    return;
+  }
 
-    if (ctx->retry_count >= ctx->max_retries)
-    {
+  if (ctx->batched)
+  {
 
-      // 재시도 횟수 초과 - 실패
+    // transaction 안의 메시지는 명령 슬롯이 남는 만큼 이어서 보냄
 
-      ctx->state = UBX_INIT_STATE_ERROR;
+    while (ctx->current_step < ctx->config_count &&
+           ubx_cmd_pending(gps) < UBX_CMD_PENDING_MAX)
+    {
 
-      if (ctx->on_complete)
+      if (!ubx_init_send_step(gps))
       {
-
-        ctx->on_complete(false, ctx->current_step, ctx->user_data);
+        break; // 다음 process()에서 재시도
       }
-
-      return;
     }
 
-    // 재전송
-
-    ubx_send_valset_cb(gps, ctx->layer, &ctx->configs[ctx->current_step], 1,
-
-                       ubx_init_async_callback, gps);
-
     return;
   }
 
-  // ACK 또는 NAK은 콜백에서 처리됨
+  // 한 개씩 모드 - 응답을 받은 뒤 다음 설정 (또는 재시도) 전송
 
-  // current_step이 증가했으면 다음 설정 전송
-
-  if (cmd_state == UBX_CMD_STATE_ACK &&
-
-      ctx->current_step < ctx->config_count &&
-
-      ctx->state == UBX_INIT_STATE_RUNNING)
+  if (ctx->inflight == 0 && ctx->current_step < ctx->config_count)
   {
 
-    // 다음 설정 전송
-
-    if (!ubx_send_valset_cb(gps, ctx->layer, &ctx->configs[ctx->current_step], 1,
-
-                            ubx_init_async_callback, gps))
-    {
-
-      // 전송 실패 (이미 대기 중인 명령 있음?)
-
-      // 다음 process()에서 재시도
-    }
+    ubx_init_send_step(gps); // 실패하면 다음 process()에서 재시도
   }
 }
 
@@ -1050,22 +1408,6 @@ bool ubx_send_cfg_cfg(gps_t *gps, uint32_t clear_mask, uint32_t save_mask,
 
 {
 
-  ubx_cmd_handler_t *handler = &gps->ubx_cmd_handler;
-
- 
-
-  // 이미 대기 중인 명령이 있으면 실패
-
-  if (handler->state == UBX_CMD_STATE_WAITING)
-
-  {
-
-    return false;
-
-  }
-
- 
-
   // UBX-CFG-CFG 메시지 생성
 
   uint8_t msg[256];
@@ -1158,32 +1500,169 @@ bool ubx_send_cfg_cfg(gps_t *gps, uint32_t clear_mask, uint32_t save_mask,
 
  
 
-  // Pending 설정
+  return ubx_cmd_submit(gps, GPS_UBX_CLASS_CFG, GPS_UBX_CFG_ID_CFG, msg, offset,
 
-  handler->pending_cls = GPS_UBX_CLASS_CFG;
+                        UBX_CMD_TIMEOUT_MS, callback, user_data);
 
-  handler->pending_id = GPS_UBX_CFG_ID_CFG;
+}
 
-  handler->state = UBX_CMD_STATE_WAITING;
+/**
+ * @brief 파싱한 ubx UPD 응답 저장 (UPD-SOS 백업/복원 결과)
+ *
+ * @param[inout] gps
+ */
+static void store_ubx_upd_data(gps_t *gps)
+{
+  // 항법 해에 쓰지 않으므로 구독자가 있을 때만 저장
+  if (gps->ubx.id == GPS_UBX_UPD_ID_SOS && gps->ubx.len == sizeof(gps_ubx_upd_sos_t) &&
+      gps_is_subscribed(gps, GPS_PROTOCOL_UBX, GPS_UBX_KEY(GPS_UBX_CLASS_UPD, GPS_UBX_UPD_ID_SOS)))
+  {
+    memcpy(&gps->ubx_data.sos, &gps->frame[4], sizeof(gps_ubx_upd_sos_t));
+  }
+}
 
-  handler->timestamp = get_tick_ms();
+/**
+ * @brief 파싱한 ubx RXM 메시지 저장 (RXM-RTCM 보정 수신 결과)
+ *
+ * @param[inout] gps
+ */
+static void store_ubx_rxm_data(gps_t *gps)
+{
+  if (gps->ubx.id == GPS_UBX_RXM_ID_RTCM && gps->ubx.len == sizeof(gps_ubx_rxm_rtcm_t) &&
+      gps_is_subscribed(gps, GPS_PROTOCOL_UBX, GPS_UBX_KEY(GPS_UBX_CLASS_RXM, GPS_UBX_RXM_ID_RTCM)))
+  {
+    memcpy(&gps->ubx_data.rxm_rtcm, &gps->frame[4], sizeof(gps_ubx_rxm_rtcm_t));
+  }
+}
 
- 
+/**
+ * @brief 파싱한 ubx MON 메시지 저장 (MON-COMMS 포트 상태)
+ *
+ * @param[inout] gps
+ */
+static void store_ubx_mon_data(gps_t *gps)
+{
+  const size_t head = offsetof(gps_ubx_mon_comms_t, port);
+  gps_ubx_mon_comms_t *mc = &gps->ubx_data.mon_comms;
+  uint8_t n;
 
-  // 콜백 등록
+  if (gps->ubx.id != GPS_UBX_MON_ID_COMMS || gps->ubx.len < head ||
+      !gps_is_subscribed(gps, GPS_PROTOCOL_UBX, GPS_UBX_KEY(GPS_UBX_CLASS_MON, GPS_UBX_MON_ID_COMMS)))
+  {
+    return;
+  }
 
-  handler->callback = callback;
+  // 길이가 nPorts 와 맞지 않으면 버림, 포트가 많으면 앞쪽만
+  n = gps->frame[4 + 1];
+  if (gps->ubx.len != head + (size_t)n * sizeof(gps_ubx_mon_comms_port_t))
+  {
+    return;
+  }
+  if (n > UBX_MON_COMMS_PORT_MAX)
+  {
+    n = UBX_MON_COMMS_PORT_MAX;
+  }
+  memcpy(mc, &gps->frame[4], head + (size_t)n * sizeof(gps_ubx_mon_comms_port_t));
+  mc->n_ports = n;
+}
 
-  handler->callback_data = user_data;
+/**
+ * @brief ACK 을 기다리지 않는 UBX 메시지 전송
+ *
+ * 정전 처리처럼 대기 중인 명령과 상관없이 바로 보내야 하는 메시지용.
+ * 응답(UPD-SOS 등)은 파서가 ubx_data 에 저장한다.
+ */
+static void ubx_send_msg(gps_t *gps, uint8_t cls, uint8_t id,
+                         const uint8_t *payload, uint16_t len)
+{
+  uint8_t msg[8 + 8];
+  size_t offset = 0;
+  uint8_t ck_a, ck_b;
 
- 
+  msg[offset++] = UBX_SYNC_1;
+  msg[offset++] = UBX_SYNC_2;
+  msg[offset++] = cls;
+  msg[offset++] = id;
+  msg[offset++] = len & 0xFF;
+  msg[offset++] = (len >> 8) & 0xFF;
 
-  // UART로 전송
+  if (len > 0)
+  {
+    memcpy(&msg[offset], payload, len);
+    offset += len;
+  }
+
+  ubx_calc_checksum(&msg[2], offset - 2, &ck_a, &ck_b);
+  msg[offset++] = ck_a;
+  msg[offset++] = ck_b;
 
   gps->ops->send((const char *)msg, offset);
+}
 
- 
+/**
+ * @brief UBX-CFG-RST 전송 (BBR 은 건드리지 않음)
+ *
+ * @param[inout] gps GPS 구조체
+ * @param[in] mode resetMode (0x08: GNSS 정지, 0x09: GNSS 시작)
+ */
+static void ubx_send_rst(gps_t *gps, uint8_t mode)
+{
+  const uint8_t payload[4] = {0x00, 0x00, mode, 0x00}; // navBbrMask 0 = hot start
 
-  return true;
+  ubx_send_msg(gps, GPS_UBX_CLASS_CFG, GPS_UBX_CFG_ID_RST, payload, sizeof(payload));
+}
+
+/**
+ * @brief 항법 데이터(ephemeris, almanac, 위치, 시각)를 수신기 flash 에 백업
+ *
+ * 정전 감지 시 호출. 백업 전에 GNSS 를 멈춰야 하므로 CFG-RST 로 controlled
+ * GNSS stop 후 UPD-SOS save 를 보낸다. 다음 부팅에서 수신기가 스스로
+ * 복원하고 UPD-SOS (cmd 3) 로 결과를 알린다. 전원이 돌아오면
+ * ubx_gnss_start() 로 다시 시작해야 한다.
+ *
+ * @param[inout] gps GPS 구조체
+ */
+void ubx_sos_save(gps_t *gps)
+{
+  const uint8_t payload[4] = {UBX_SOS_CMD_SAVE, 0, 0, 0};
+
+  ubx_send_rst(gps, 0x08);
+  ubx_send_msg(gps, GPS_UBX_CLASS_UPD, GPS_UBX_UPD_ID_SOS, payload, sizeof(payload));
+}
+
+/**
+ * @brief flash 백업 삭제 (복원한 뒤 오래된 백업이 다시 쓰이지 않게)
+ *
+ * @param[inout] gps GPS 구조체
+ */
+void ubx_sos_clear(gps_t *gps)
+{
+  const uint8_t payload[4] = {UBX_SOS_CMD_CLEAR, 0, 0, 0};
+
+  ubx_send_msg(gps, GPS_UBX_CLASS_UPD, GPS_UBX_UPD_ID_SOS, payload, sizeof(payload));
+}
+
+/**
+ * @brief 부팅 시 복원 결과 요청 (응답은 UPD-SOS cmd 3)
+ *
+ * 수신기가 시작할 때 내보내는 결과는 MCU 가 baud 를 맞추기 전이라 놓치므로
+ * 초기화가 끝난 뒤 다시 묻는다.
+ *
+ * @param[inout] gps GPS 구조체
+ */
+void ubx_sos_poll(gps_t *gps)
+{
+  ubx_send_msg(gps, GPS_UBX_CLASS_UPD, GPS_UBX_UPD_ID_SOS, NULL, 0);
+}
+
+/**
+ * @brief ubx_sos_save() 로 멈춘 GNSS 다시 시작 (리셋 없이 전원이 돌아온 경우)
+ *
+ * @param[inout] gps GPS 구조체
+ */
+void ubx_gnss_start(gps_t *gps)
+{
+  ubx_send_rst(gps, 0x09);
+}
 
-}
\ No newline at end of file
+#endif
@@ -13,8 +13,11 @@
 typedef enum {
   GPS_UBX_CLASS_NONE = 0,
   GPS_UBX_CLASS_NAV = 0x01,
+  GPS_UBX_CLASS_RXM = 0x02,
   GPS_UBX_CLASS_ACK = 0x05,
   GPS_UBX_CLASS_CFG = 0x06,
+  GPS_UBX_CLASS_UPD = 0x09,
+  GPS_UBX_CLASS_MON = 0x0A,
 } gps_ubx_class_t;
 
 /**
@@ -23,7 +26,9 @@ typedef enum {
  */
 typedef enum {
   GPS_UBX_NAV_ID_NONE = 0,
+  GPS_UBX_NAV_ID_PVT = 0x07, ///< Navigation Position Velocity Time Solution
   GPS_UBX_NAV_ID_HPPOSLLH = 0x14, ///< High Precision Position Solution
+  GPS_UBX_NAV_ID_SAT = 0x35, ///< Satellite Information
   GPS_UBX_NAV_ID_RELPOSNED = 0x3C, ///< Relative Positioning Information in NED frame
 } gps_ubx_nav_id_t;
 
@@ -33,6 +38,7 @@ typedef enum {
  */
  typedef enum {
   GPS_UBX_CFG_ID_NONE = 0,
+  GPS_UBX_CFG_ID_RST = 0x04,
   GPS_UBX_CFG_ID_CFG = 0x09,
   GPS_UBX_CFG_ID_VALSET = 0x8A,
   GPS_UBX_CFG_ID_VALGET = 0x8B,
@@ -48,6 +54,124 @@ typedef enum {
   GPS_UBX_ACK_ID_ACK = 0x01,
  }gps_ubx_ack_id_t;
 
+/**
+ * @brief ubx 프로토콜 UPD 클래스 메시지 id
+ *
+ */
+typedef enum {
+  GPS_UBX_UPD_ID_SOS = 0x14, ///< Backup in flash (save on shutdown)
+} gps_ubx_upd_id_t;
+
+/**
+ * @brief ubx 프로토콜 RXM 클래스 메시지 id
+ *
+ */
+typedef enum {
+  GPS_UBX_RXM_ID_RTCM = 0x32, ///< RTCM input status
+} gps_ubx_rxm_id_t;
+
+/**
+ * @brief ubx 프로토콜 MON 클래스 메시지 id
+ *
+ */
+typedef enum {
+  GPS_UBX_MON_ID_COMMS = 0x36, ///< Communication port information
+} gps_ubx_mon_id_t;
+
+/**
+ * @brief UBX-UPD-SOS cmd
+ */
+typedef enum {
+  UBX_SOS_CMD_SAVE = 0,     ///< (host) BBR 를 flash 에 백업
+  UBX_SOS_CMD_CLEAR = 1,    ///< (host) 백업 삭제
+  UBX_SOS_CMD_SAVE_ACK = 2, ///< (수신기) 백업 결과, response 0: 실패 1: 성공
+  UBX_SOS_CMD_RESTORED = 3, ///< (수신기) 시작 시 복원 결과, response 는 ubx_sos_restore_t
+} ubx_sos_cmd_t;
+
+/**
+ * @brief UBX-UPD-SOS 복원 결과 (cmd 3 의 response)
+ */
+typedef enum {
+  UBX_SOS_RESTORE_UNKNOWN = 0,
+  UBX_SOS_RESTORE_FAILED = 1,
+  UBX_SOS_RESTORE_OK = 2,
+  UBX_SOS_RESTORE_NO_BACKUP = 3,
+} ubx_sos_restore_t;
+
+/**
+ * @brief UBX-UPD-SOS 수신기 출력 (cmd 2, 3)
+ */
+typedef struct {
+  uint8_t cmd;
+  uint8_t reserved0[3];
+  uint8_t response;
+  uint8_t reserved1[3];
+} gps_ubx_upd_sos_t;
+
+/**
+ * @brief UBX-RXM-RTCM flags.msgUsed (bit 1~2)
+ */
+typedef enum {
+  UBX_RTCM_USED_UNKNOWN = 0,
+  UBX_RTCM_USED_NO = 1,  ///< 받았지만 항법에 안 씀 (필요 없는 타입, 기준국 불일치 등)
+  UBX_RTCM_USED_YES = 2,
+} ubx_rtcm_used_t;
+
+#define UBX_RTCM_FLAG_CRC_FAILED 0x01
+#define UBX_RTCM_USED(flags) (((flags) >> 1) & 0x03)
+
+/**
+ * @brief UBX-RXM-RTCM (수신기가 받은 RTCM 메시지마다 1 개)
+ */
+typedef struct {
+  uint8_t version;
+  uint8_t flags;
+  uint16_t sub_type;    ///< 4072 의 sub type
+  uint16_t ref_station; ///< 기준국 id (없는 메시지는 0xFFFF)
+  uint16_t msg_type;
+} gps_ubx_rxm_rtcm_t;
+
+#define UBX_MON_COMMS_PORT_MAX 5
+#define UBX_MON_COMMS_PORT_UART1 0x0100
+#define UBX_MON_COMMS_PORT_UART2 0x0201
+#define UBX_MON_COMMS_PORT_USB 0x0300
+#define UBX_MON_COMMS_PORT_SPI 0x0400
+#define UBX_MON_COMMS_PORT_I2C 0x0000
+
+/**
+ * @brief UBX-MON-COMMS 포트 블록
+ *
+ * usage/peak 는 버퍼 사용률 [%] (최근 1 초 평균/최대), overrun_errs 는 수신
+ * overrun 이 있었던 100 ms 구간 수, skipped 는 프로토콜이 맞지 않아 버린 byte.
+ */
+typedef struct {
+  uint16_t port_id;
+  uint16_t tx_pending;
+  uint32_t tx_bytes;
+  uint8_t tx_usage;
+  uint8_t tx_peak_usage;
+  uint16_t rx_pending;
+  uint32_t rx_bytes;
+  uint8_t rx_usage;
+  uint8_t rx_peak_usage;
+  uint16_t overrun_errs;
+  uint16_t msgs[4]; ///< prot_ids 순서의 프로토콜별 수신 메시지 수
+  uint8_t reserved[8];
+  uint32_t skipped;
+} gps_ubx_mon_comms_port_t;
+
+/**
+ * @brief UBX-MON-COMMS (포트가 UBX_MON_COMMS_PORT_MAX 보다 많으면 앞쪽만)
+ */
+typedef struct {
+  uint8_t version;
+  uint8_t n_ports;
+  uint8_t tx_errors; ///< bit0 mem (메모리 부족), bit1 alloc (송신 버퍼 할당 실패)
+  uint8_t reserved;
+  uint8_t prot_ids[4];
+  gps_ubx_mon_comms_port_t port[UBX_MON_COMMS_PORT_MAX];
+} gps_ubx_mon_comms_t;
+
 /**
  * @brief ubx 프로토콜 NAV 클래스 HPPOSLLH 메시지
  *
@@ -69,6 +193,54 @@ typedef struct {
   uint32_t vacc;    // 0.1mm 단위
 } gps_ubx_nav_hpposllh_t;
 
+/**
+ * @brief ubx 프로토콜 NAV 클래스 PVT 메시지 (92 byte)
+ *
+ * fix, 위성 수, DOP, 위치, 속도가 한 epoch 에 한 프레임으로 온다.
+ * 모든 필드가 자연 정렬이라 packed 없이 payload 를 그대로 복사한다.
+ */
+typedef struct {
+  uint32_t tow;       // time of week [ms]
+  uint16_t year;
+  uint8_t month;
+  uint8_t day;
+  uint8_t hour;
+  uint8_t min;
+  uint8_t sec;
+  uint8_t valid;      // bit0 validDate, bit1 validTime, bit2 fullyResolved
+  uint32_t t_acc;     // [ns]
+  int32_t nano;       // [ns]
+  uint8_t fix_type;   // 0 no fix, 1 DR, 2 2D, 3 3D, 4 GNSS+DR, 5 time only
+  struct {
+    uint8_t gnss_fix_ok : 1;
+    uint8_t diff_soln : 1;
+    uint8_t psm_state : 3;
+    uint8_t head_veh_valid : 1;
+    uint8_t carr_soln : 2; // 0 none, 1 float, 2 fixed
+  } flags;
+  uint8_t flags2;
+  uint8_t num_sv;
+  int32_t lon;        // 1e-7 deg
+  int32_t lat;        // 1e-7 deg
+  int32_t height;     // [mm]
+  int32_t msl;        // [mm]
+  uint32_t hacc;      // [mm]
+  uint32_t vacc;      // [mm]
+  int32_t vel_n;      // [mm/s]
+  int32_t vel_e;      // [mm/s]
+  int32_t vel_d;      // [mm/s]
+  int32_t g_speed;    // [mm/s]
+  int32_t head_mot;   // 1e-5 deg
+  uint32_t s_acc;     // [mm/s]
+  uint32_t head_acc;  // 1e-5 deg
+  uint16_t pdop;      // 0.01
+  uint16_t flags3;
+  uint8_t reserved0[4];
+  int32_t head_veh;   // 1e-5 deg
+  int16_t mag_dec;    // 1e-2 deg
+  uint16_t mag_acc;   // 1e-2 deg
+} gps_ubx_nav_pvt_t;
+
 typedef struct {
   uint8_t version;
   uint8_t reserved0;
@@ -124,8 +296,12 @@ typedef struct {
  *
  */
 typedef struct {
+  gps_ubx_nav_pvt_t pvt;
   gps_ubx_nav_hpposllh_t hpposllh;
   gps_ubx_nav_relposned_t relposned;
+  gps_ubx_upd_sos_t sos;
+  gps_ubx_rxm_rtcm_t rxm_rtcm;
+  gps_ubx_mon_comms_t mon_comms;
 } gps_ubx_data_t;
 
 typedef enum {
@@ -143,16 +319,40 @@ typedef enum {
   UBX_CMD_STATE_TIMEOUT,    // 타임아웃
 } ubx_cmd_state_t;
 
-typedef void (*ubx_ack_callback_t)(bool ack, void *user_data);
+/**
+ * @brief 명령 완료 콜백 (ACK/NAK 은 파싱 태스크, TIMEOUT 은 ubx_cmd_poll() 호출 태스크)
+ *
+ * @param result UBX_CMD_STATE_ACK, _NAK 또는 _TIMEOUT
+ */
+typedef void (*ubx_ack_callback_t)(ubx_cmd_state_t result, void *user_data);
 
+/* 동시에 응답을 기다릴 수 있는 명령 수 */
+#define UBX_CMD_PENDING_MAX 4
+
+/* 명령 응답 기본 타임아웃 (ms) */
+#define UBX_CMD_TIMEOUT_MS 3000
+
+/**
+ * @brief 응답 대기 중인 명령 하나
+ *
+ * ACK 에는 class/ID 만 실려 오지만 수신기는 한 포트의 명령을 받은 순서대로
+ * 처리하므로, 같은 class/ID 가 여럿이면 먼저 보낸 (seq 가 오래된) 것부터 맞춘다.
+ */
 typedef struct {
-  uint8_t pending_cls;              // 대기 중인 명령 Class
-  uint8_t pending_id;               // 대기 중인 명령 ID
-  ubx_cmd_state_t state;            // 명령 상태
+  bool busy;
+  uint8_t cls;
+  uint8_t id;
+  uint8_t seq;                      // 보낸 순서
   uint32_t timestamp;               // 명령 전송 시각 (ms)
+  uint32_t timeout_ms;
 
   ubx_ack_callback_t callback;
   void *callback_data;
+} ubx_cmd_slot_t;
+
+typedef struct {
+  ubx_cmd_slot_t slot[UBX_CMD_PENDING_MAX];
+  uint8_t seq;                      // 다음 명령 번호
 } ubx_cmd_handler_t;
 
  
@@ -166,6 +366,32 @@ typedef struct {
   uint8_t value_len;        // Value length
 } ubx_cfg_item_t;
 
+/**
+ * @brief VAL-SET 한 메시지 제한
+ *
+ * 프로토콜 상한은 64 key, 송신 버퍼는 checksum 까지 포함한 전체 메시지 크기
+ */
+#define UBX_VALSET_MAX_KEYS 64
+#define UBX_VALSET_MSG_SIZE 256
+
+/**
+ * @brief VAL-GET 한 메시지 key 수 (송신 버퍼 256 byte 기준)
+ */
+#define UBX_VALGET_MAX_KEYS 60
+
+/**
+ * @brief VAL-SET transaction (version 1 의 transaction 필드)
+ *
+ * BEGIN ~ APPLY 사이의 설정은 APPLY 를 받을 때 한꺼번에 적용되고
+ * 중간에 NAK 이 나면 전부 버려진다.
+ */
+typedef enum {
+  UBX_VALSET_TRANSACTION_NONE = 0,     // 즉시 적용 (version 0)
+  UBX_VALSET_TRANSACTION_BEGIN = 1,    // 새 transaction 시작
+  UBX_VALSET_TRANSACTION_CONTINUE = 2, // 진행 중인 transaction 에 추가
+  UBX_VALSET_TRANSACTION_APPLY = 3,    // 추가 후 적용, 종료
+} ubx_valset_transaction_t;
+
 /**
 
  * @brief 비동기 초기화 상태
@@ -212,7 +438,11 @@ typedef struct {
 
   ubx_init_state_t state;           // 초기화 상태
 
-  size_t current_step;              // 현재 단계 (0부터 시작)
+  size_t current_step;              // 다음에 보낼 설정 (한 개씩 모드는 ACK 뒤에 넘어감)
+
+  size_t batch_count;               // 전송 중인 VAL-SET 에 담긴 설정 개수
+
+  bool batched;                     // false: NAK 이후 한 개씩 재전송 (실패 단계 확인)
 
   const ubx_cfg_item_t *configs;    // 설정 배열
 
@@ -220,6 +450,10 @@ typedef struct {
 
   ubx_cfg_layer_t layer;                // Layer (RAM/BBR/Flash)
 
+  uint8_t inflight;                 // 응답을 기다리는 VAL-SET 수 (묶음 모드는 여러 개)
+
+  bool restart;                     // 묶음 실패, 남은 응답이 다 오면 처음부터 다시
+
  
 
   // 완료 콜백
@@ -236,6 +470,18 @@ typedef struct {
 
   uint32_t max_retries;             // 최대 재시도 횟수
 
+ 
+
+  // 부팅 때 수신기 설정 확인 (같으면 VAL-SET 생략)
+
+  bool verifying;                   // VAL-GET 응답 대기 중
+
+  uint32_t cfg_hash;                // 설정 배열 hash
+
+  uint32_t rx_hash;                 // VAL-GET 응답 hash
+
+  size_t rx_count;                  // VAL-GET 응답 key 수
+
 } ubx_init_context_t;
 
 
@@ -245,7 +491,17 @@ uint8_t gps_parse_ubx(gps_t *gps);
 
 /* Command functions */
 void ubx_cmd_handler_init(ubx_cmd_handler_t *handler);
-ubx_cmd_state_t ubx_get_cmd_state(ubx_cmd_handler_t *handler, uint32_t timeout_ms);
+
+/**
+ * @brief 타임아웃 지난 명령을 TIMEOUT 으로 완료 (파싱 태스크 루프에서 주기적으로)
+ */
+void ubx_cmd_poll(gps_t *gps);
+
+/**
+ * @brief 응답 대기 중인 명령 수
+ */
+uint8_t ubx_cmd_pending(gps_t *gps);
+
 bool ubx_send_valset(gps_t *gps, ubx_cfg_layer_t layer,
                      const ubx_cfg_item_t *items, size_t item_count);
 
@@ -253,12 +509,30 @@ bool ubx_send_valset_cb(gps_t *gps, ubx_cfg_layer_t layer,
                         const ubx_cfg_item_t *items, size_t item_count,
                         ubx_ack_callback_t callback, void *user_data);
 
+/**
+ * @brief transaction 단계를 지정한 VAL-SET (콜백 방식)
+ *
+ * BEGIN ~ APPLY 를 ACK 기다리지 않고 이어서 보내면 수신기가 APPLY 에서
+ * 한꺼번에 적용한다. 중간에 NAK 이 나면 뒤의 메시지도 NAK 으로 끝난다.
+ */
+bool ubx_send_valset_txn_cb(gps_t *gps, ubx_cfg_layer_t layer,
+                            ubx_valset_transaction_t transaction,
+                            const ubx_cfg_item_t *items, size_t item_count,
+                            ubx_ack_callback_t callback, void *user_data);
+
 bool ubx_send_valset_sync(gps_t *gps, ubx_cfg_layer_t layer,
                           const ubx_cfg_item_t *items, size_t item_count,
                           uint32_t timeout_ms);
 
 bool ubx_send_valget(gps_t *gps, ubx_cfg_layer_t layer,
-                     const uint32_t *key_ids, size_t key_count);
+                     const uint32_t *key_ids, size_t key_count,
+                     ubx_ack_callback_t callback, void *user_data);
+
+/* Warm start (UPD-SOS) */
+void ubx_sos_save(gps_t *gps);
+void ubx_sos_clear(gps_t *gps);
+void ubx_sos_poll(gps_t *gps);
+void ubx_gnss_start(gps_t *gps);
 
 /* Helper functions */
 void ubx_calc_checksum(const uint8_t *data, size_t len,
@@ -1,12 +1,27 @@
 #include "gps_unicore.h"
 #include "gps.h"
 #include "gps_parse.h"
+#include "crc.h"
 #include <string.h>
 
+#if defined(USE_GPS_UNICORE)
+
 gps_unicore_resp_t gps_get_unicore_response(gps_t *gps) {
   return gps->unicore.response;
 }
 
+/**
+ * @brief 응답 프레임의 명령 echo ($command,<echo>,response: OK)
+ *
+ * 이벤트 핸들러 안에서만 유효하다 (프레임이 끝나면 지워짐).
+ *
+ * @param[in] gps
+ * @return const char* echo 문자열
+ */
+const char *gps_get_unicore_echo(gps_t *gps) {
+  return gps->unicore.echo;
+}
+
 uint8_t gps_parse_unicore_term(gps_t *gps) {
   char *term = gps->unicore.term_str;
 
@@ -16,6 +31,10 @@ uint8_t gps_parse_unicore_term(gps_t *gps) {
 //     }
 //   }
 
+  if (gps->unicore.term_num == 1) {
+    strcpy(gps->unicore.echo, term);
+  }
+
   if (gps->unicore.term_num == 2) {
     if (strstr(term, "OK") != NULL) {
       gps->unicore.response = GPS_UNICORE_RESP_OK;
@@ -30,85 +49,121 @@ uint8_t gps_parse_unicore_term(gps_t *gps) {
 
 
 
-uint32_t calc_crc32(uint8_t *buf, uint16_t len);
+/**
+ * @brief 프레임 CRC 확인 (헤더 + 메시지, 완료 시 한 번에)
+ *
+ * @param[in] gps
+ * @param[in] frame sync 부터의 프레임
+ */
+static inline uint8_t check_unicore_binary_chksum(gps_t *gps, const uint8_t *frame) {
+  size_t len = GPS_UNICORE_BIN_HEADER_SIZE + gps->unicore_bin.header.message_len;
 
-static inline uint32_t calc_unicore_binary_chksum(gps_t *gps) {
+  return crc32_update(0, frame, len) == gps->unicore_bin.crc32;
+}
 
-    uint16_t len = (gps->payload[6] | (gps->payload[7] << 8));
-    uint32_t crc32 = calc_crc32((uint8_t*)gps->payload, len + GPS_UNICORE_BIN_HEADER_SIZE);
 
-    return crc32;
+static void store_unicore_bin_bestnavb_data(gps_t *gps) {
+    memcpy(&gps->unicore_bin_data.bestnav , &gps->frame[GPS_UNICORE_BIN_HEADER_SIZE],
+           sizeof(hpd_unicore_bestnavb_t));
 }
 
 
-static inline uint8_t check_unicore_binary_chksum(gps_t *gps) {
-  uint32_t crc32 = calc_unicore_binary_chksum(gps);
+/**
+ * @brief 고정 길이 log 저장 (message_len 이 짧으면 나머지는 0)
+ */
+static void store_unicore_bin_fixed(gps_t *gps, void *dst, size_t size) {
+  size_t len = gps->unicore_bin.header.message_len;
 
-  if (crc32 == gps->unicore_bin.crc32){
-    return 1;
+  if (len < size) {
+    memset((uint8_t *)dst + len, 0, size - len);
+  } else {
+    len = size;
   }
-
-  return 0;
-}
-
-
-static void store_unicore_bin_bestnavb_data(gps_t *gps) {
-    memcpy(&gps->unicore_bin_data.bestnav , &gps->payload[GPS_UNICORE_BIN_HEADER_SIZE],
-           sizeof(hpd_unicore_bestnavb_t));
+  memcpy(dst, &gps->frame[GPS_UNICORE_BIN_HEADER_SIZE], len);
 }
 
-
 static void store_unicore_bin_data(gps_t *gps) {
   switch (gps->unicore_bin.header.message_id) {
   case GPS_UNICORE_BIN_MSG_BESTNAV:
+  case GPS_UNICORE_BIN_MSG_ADRNAV:
     store_unicore_bin_bestnavb_data(gps);
     break;
 
+  case GPS_UNICORE_BIN_MSG_UNIHEADING:
+    store_unicore_bin_fixed(gps, &gps->unicore_bin_data.uniheading,
+                            sizeof(gps->unicore_bin_data.uniheading));
+    break;
+
+  case GPS_UNICORE_BIN_MSG_PVTSLN:
+    store_unicore_bin_fixed(gps, &gps->unicore_bin_data.pvtsln,
+                            sizeof(gps->unicore_bin_data.pvtsln));
+    break;
+
   default:
     break;
   }
 }
 
 uint8_t gps_parse_unicore_bin(gps_t *gps) {
-  if (gps->pos == 6) {
-    gps->unicore_bin.header.message_id = (uint16_t)gps->payload[4] | ((uint16_t)gps->payload[5] << 8);
+  gps_unicore_bin_parser_t *bin = &gps->unicore_bin;
+  /* 헤더와 CRC 는 지금 바이트에서 읽음 (링 모드는 payload 에 복사 안 함) */
+  uint8_t ch = *gps->cur;
+
+  if (gps->pos == 5) {
+    bin->header.message_id = ch;
+  } else if (gps->pos == 6) {
+    bin->header.message_id |= (uint16_t)ch << 8;
     gps->state = GPS_PARSE_STATE_UNICORE_MESSAGE_ID;
+  } else if (gps->pos == 7) {
+    bin->header.message_len = ch;
   } else if (gps->pos == 8) {
-    gps->unicore_bin.header.message_len = (uint16_t)gps->payload[6] | ((uint16_t)gps->payload[7] << 8);
+    bin->header.message_len |= (uint16_t)ch << 8;
     gps->state = GPS_PARSE_STATE_UNICORE_MESSAGE_LEN;
+
+    /* 버퍼에 담을 수 없는 길이는 버리고 재동기화 */
+    if ((size_t)bin->header.message_len + GPS_UNICORE_BIN_HEADER_SIZE + 4 > _gps_frame_cap(gps)) {
+      GPS_STATS_INC(gps, GPS_PROTOCOL_UNICORE_BIN, oversize);
+      gps->protocol = GPS_PROTOCOL_NONE;
+      gps->state = GPS_PARSE_STATE_NONE;
+      gps->pos = 0;
+      return 0;
+    }
   } 
    else {
-    uint16_t message_len = gps->unicore_bin.header.message_len;
+    uint16_t message_len = bin->header.message_len;
 
     if (gps->pos <= message_len + GPS_UNICORE_BIN_HEADER_SIZE) {
       gps->state = GPS_PARSE_STATE_UNICORE_PAYLOAD;
     } 
-     else if (gps->pos == message_len + GPS_UNICORE_BIN_HEADER_SIZE + 4) {
+     else {
       gps->state = GPS_PARSE_STATE_UNICORE_CRC;
-      memcpy(&gps->unicore_bin.crc32, &gps->payload[message_len + GPS_UNICORE_BIN_HEADER_SIZE], 4);
+      bin->crc32 |= (uint32_t)ch << (8 * (gps->pos - message_len - GPS_UNICORE_BIN_HEADER_SIZE - 1));
+      if (gps->pos < message_len + GPS_UNICORE_BIN_HEADER_SIZE + 4) {
+        return 1;
+      }
 
-      if (check_unicore_binary_chksum(gps)) {
-        store_unicore_bin_data(gps);
+      const uint8_t *frame = _gps_frame_acquire(gps, 0, message_len + GPS_UNICORE_BIN_HEADER_SIZE);
 
-        memcpy(&gps->unicore_bin.header, gps->payload, GPS_UNICORE_BIN_HEADER_SIZE);
+      if (check_unicore_binary_chksum(gps, frame)) {
+        memcpy(&bin->header, frame, GPS_UNICORE_BIN_HEADER_SIZE);
+        store_unicore_bin_data(gps);
+        _gps_frame_release(gps);
         
         gps_msg_t msg;
-        msg.unicore_bin.msg = gps->unicore_bin.header.message_id;
-        gps->handler(gps, GPS_EVENT_DATA_PARSED, GPS_PROTOCOL_UNICORE_BIN, msg);
+        msg.unicore_bin.msg = bin->header.message_id;
+        GPS_STATS_INC(gps, GPS_PROTOCOL_UNICORE_BIN, frame_ok);
+        gps_nav_publish(gps, GPS_PROTOCOL_UNICORE_BIN, msg);
+        gps_dispatch(gps, GPS_PROTOCOL_UNICORE_BIN, msg);
         gps->protocol = GPS_PROTOCOL_NONE;
         gps->state = GPS_PARSE_STATE_NONE;
-
-        /* clear payload and reset position */
-        memset(gps->payload, 0, sizeof(gps->payload));
         gps->pos = 0;
 
         return 1;
       } else {
+        _gps_frame_release(gps);
+        GPS_STATS_INC(gps, GPS_PROTOCOL_UNICORE_BIN, chksum_err);
         gps->protocol = GPS_PROTOCOL_NONE;
         gps->state = GPS_PARSE_STATE_NONE;
-
-        /* clear payload and reset position on failure as well */
-        memset(gps->payload, 0, sizeof(gps->payload));
         gps->pos = 0;
         return 0;
       }
@@ -118,104 +173,4 @@ uint8_t gps_parse_unicore_bin(gps_t *gps) {
   return 1;
 }
 
-
-const static uint32_t crc_table[256] =
-{
-0x00000000UL, 0x77073096UL, 0xee0e612cUL, 0x990951baUL, 0x076dc419UL,
-0x706af48fUL,
-0xe963a535UL, 0x9e6495a3UL, 0x0edb8832UL, 0x79dcb8a4UL, 0xe0d5e91eUL,
-0x97d2d988UL,
-0x09b64c2bUL, 0x7eb17cbdUL, 0xe7b82d07UL, 0x90bf1d91UL, 0x1db71064UL,
-0x6ab020f2UL,
-0xf3b97148UL, 0x84be41deUL, 0x1adad47dUL, 0x6ddde4ebUL, 0xf4d4b551UL,
-0x83d385c7UL,
-0x136c9856UL, 0x646ba8c0UL, 0xfd62f97aUL, 0x8a65c9ecUL, 0x14015c4fUL,
-0x63066cd9UL,
-0xfa0f3d63UL, 0x8d080df5UL, 0x3b6e20c8UL, 0x4c69105eUL, 0xd56041e4UL,
-0xa2677172UL,
-0x3c03e4d1UL, 0x4b04d447UL, 0xd20d85fdUL, 0xa50ab56bUL, 0x35b5a8faUL,
-0x42b2986cUL,
-0xdbbbc9d6UL, 0xacbcf940UL, 0x32d86ce3UL, 0x45df5c75UL, 0xdcd60dcfUL,
-0xabd13d59UL,
-0x26d930acUL, 0x51de003aUL, 0xc8d75180UL, 0xbfd06116UL, 0x21b4f4b5UL,
-0x56b3c423UL,
-0xcfba9599UL, 0xb8bda50fUL, 0x2802b89eUL, 0x5f058808UL, 0xc60cd9b2UL,
-0xb10be924UL,
-0x2f6f7c87UL, 0x58684c11UL, 0xc1611dabUL, 0xb6662d3dUL, 0x76dc4190UL,
-0x01db7106UL,
-0x98d220bcUL, 0xefd5102aUL, 0x71b18589UL, 0x06b6b51fUL, 0x9fbfe4a5UL,
-0xe8b8d433UL,
-0x7807c9a2UL, 0x0f00f934UL, 0x9609a88eUL, 0xe10e9818UL, 0x7f6a0dbbUL,
-0x086d3d2dUL,
-0x91646c97UL, 0xe6635c01UL, 0x6b6b51f4UL, 0x1c6c6162UL, 0x856530d8UL,
-0xf262004eUL,
-0x6c0695edUL, 0x1b01a57bUL, 0x8208f4c1UL, 0xf50fc457UL, 0x65b0d9c6UL,
-0x12b7e950UL,
-0x8bbeb8eaUL, 0xfcb9887cUL, 0x62dd1ddfUL, 0x15da2d49UL, 0x8cd37cf3UL,
-0xfbd44c65UL,
-0x4db26158UL, 0x3ab551ceUL, 0xa3bc0074UL, 0xd4bb30e2UL, 0x4adfa541UL,
-0x3dd895d7UL,
-0xa4d1c46dUL, 0xd3d6f4fbUL, 0x4369e96aUL, 0x346ed9fcUL, 0xad678846UL,
-0xda60b8d0UL,
-0x44042d73UL, 0x33031de5UL, 0xaa0a4c5fUL, 0xdd0d7cc9UL, 0x5005713cUL,
-0x270241aaUL,
-0xbe0b1010UL, 0xc90c2086UL, 0x5768b525UL, 0x206f85b3UL, 0xb966d409UL,
-0xce61e49fUL,
-0x5edef90eUL, 0x29d9c998UL, 0xb0d09822UL, 0xc7d7a8b4UL, 0x59b33d17UL,
-0x2eb40d81UL,
-0xb7bd5c3bUL, 0xc0ba6cadUL, 0xedb88320UL, 0x9abfb3b6UL, 0x03b6e20cUL,
-0x74b1d29aUL,
-0xead54739UL, 0x9dd277afUL, 0x04db2615UL, 0x73dc1683UL, 0xe3630b12UL,
-0x94643b84UL,
-0x0d6d6a3eUL, 0x7a6a5aa8UL, 0xe40ecf0bUL, 0x9309ff9dUL, 0x0a00ae27UL,
-0x7d079eb1UL,
-0xf00f9344UL, 0x8708a3d2UL, 0x1e01f268UL, 0x6906c2feUL, 0xf762575dUL,
-0x806567cbUL,
-0x196c3671UL, 0x6e6b06e7UL, 0xfed41b76UL, 0x89d32be0UL, 0x10da7a5aUL,
-0x67dd4accUL,
-0xf9b9df6fUL, 0x8ebeeff9UL, 0x17b7be43UL, 0x60b08ed5UL, 0xd6d6a3e8UL,
-0xa1d1937eUL,
-0x38d8c2c4UL, 0x4fdff252UL, 0xd1bb67f1UL, 0xa6bc5767UL, 0x3fb506ddUL,
-0x48b2364bUL,
-0xd80d2bdaUL, 0xaf0a1b4cUL, 0x36034af6UL, 0x41047a60UL, 0xdf60efc3UL,
-0xa867df55UL,
-0x316e8eefUL, 0x4669be79UL, 0xcb61b38cUL, 0xbc66831aUL, 0x256fd2a0UL,
-0x5268e236UL,
-0xcc0c7795UL, 0xbb0b4703UL, 0x220216b9UL, 0x5505262fUL, 0xc5ba3bbeUL,
-0xb2bd0b28UL,
-0x2bb45a92UL, 0x5cb36a04UL, 0xc2d7ffa7UL, 0xb5d0cf31UL, 0x2cd99e8bUL,
-0x5bdeae1dUL, 
-0x9b64c2b0UL, 0xec63f226UL, 0x756aa39cUL, 0x026d930aUL, 0x9c0906a9UL,
-0xeb0e363fUL,
-0x72076785UL, 0x05005713UL, 0x95bf4a82UL, 0xe2b87a14UL, 0x7bb12baeUL,
-0x0cb61b38UL,
-0x92d28e9bUL, 0xe5d5be0dUL, 0x7cdcefb7UL, 0x0bdbdf21UL, 0x86d3d2d4UL,
-0xf1d4e242UL,
-0x68ddb3f8UL, 0x1fda836eUL, 0x81be16cdUL, 0xf6b9265bUL, 0x6fb077e1UL,
-0x18b74777UL,
-0x88085ae6UL, 0xff0f6a70UL, 0x66063bcaUL, 0x11010b5cUL, 0x8f659effUL,
-0xf862ae69UL,
-0x616bffd3UL, 0x166ccf45UL, 0xa00ae278UL, 0xd70dd2eeUL, 0x4e048354UL,
-0x3903b3c2UL,
-0xa7672661UL, 0xd06016f7UL, 0x4969474dUL, 0x3e6e77dbUL, 0xaed16a4aUL,
-0xd9d65adcUL,
-0x40df0b66UL, 0x37d83bf0UL, 0xa9bcae53UL, 0xdebb9ec5UL, 0x47b2cf7fUL,
-0x30b5ffe9UL,
-0xbdbdf21cUL, 0xcabac28aUL, 0x53b39330UL, 0x24b4a3a6UL, 0xbad03605UL,
-0xcdd70693UL,
-0x54de5729UL, 0x23d967bfUL, 0xb3667a2eUL, 0xc4614ab8UL, 0x5d681b02UL,
-0x2a6f2b94UL,
-0xb40bbe37UL, 0xc30c8ea1UL, 0x5a05df1bUL, 0x2d02ef8dUL 
-};
-
-uint32_t calc_crc32(uint8_t *buf, uint16_t len)
-{
-    int idx;
-    uint32_t crc32 = 0;
-
-    for (idx = 0; idx < len; idx++)
-    {
-        crc32 = crc_table[(crc32 ^ buf[idx]) & 0xff] ^ (crc32 >> 8);
-    }
-    return crc32;
-}
+#endif
@@ -33,12 +33,35 @@ typedef struct {
   uint8_t star;
   uint8_t colon; ///< '$이후부터 : 받을때 까지만 crc 검사 해야함! response: OK에서 스페이스바 부터 OK까지 포함하면 안됨
   gps_unicore_resp_t response;
+  char echo[GPS_UNICORE_TERM_SIZE]; ///< 응답에 실린 명령 echo (TERM_SIZE - 1 에서 잘림)
 } gps_unicore_parser_t;
 
 typedef enum {
+    GPS_UNICORE_BIN_MSG_ADRNAV = 142,      ///< 고정밀 RTK 위치/속도 (BESTNAV 와 같은 형식)
+    GPS_UNICORE_BIN_MSG_UNIHEADING = 972,  ///< dual antenna heading
+    GPS_UNICORE_BIN_MSG_PVTSLN = 1021,     ///< 위치/속도/heading/DOP 요약
     GPS_UNICORE_BIN_MSG_BESTNAV = 2118
 }gps_unicore_bin_msg_t;
 
+/**
+ * @brief Unicore 위치 해 종류 (BESTNAV/ADRNAV pos_type, UNIHEADING pos_type)
+ */
+typedef enum {
+    GPS_UNICORE_POS_NONE = 0,
+    GPS_UNICORE_POS_FIXEDPOS = 1,
+    GPS_UNICORE_POS_FIXEDHEIGHT = 2,
+    GPS_UNICORE_POS_DOPPLER_VELOCITY = 8,
+    GPS_UNICORE_POS_SINGLE = 16,
+    GPS_UNICORE_POS_PSRDIFF = 17,
+    GPS_UNICORE_POS_SBAS = 18,
+    GPS_UNICORE_POS_L1_FLOAT = 32,
+    GPS_UNICORE_POS_IONOFREE_FLOAT = 33,
+    GPS_UNICORE_POS_NARROW_FLOAT = 34,
+    GPS_UNICORE_POS_L1_INT = 48,
+    GPS_UNICORE_POS_WIDE_INT = 49,
+    GPS_UNICORE_POS_NARROW_INT = 50,
+}gps_unicore_pos_type_t;
+
 typedef struct __attribute__((packed)) {
     uint8_t sync[3]; ///< 0xAA 0x44 0xB5
     uint8_t cpu_idle; ///< CPU idle 0-100
@@ -56,7 +79,7 @@ typedef struct __attribute__((packed)) {
 
 typedef struct {
   gps_unicore_bin_header_t header;
-  uint32_t crc32;
+  uint32_t crc32; ///< 수신 CRC (byte 단위로 모음)
 } gps_unicore_bin_parser_t;
 
 typedef struct __attribute__((packed))
@@ -91,13 +114,81 @@ typedef struct __attribute__((packed))
     float horspd_std;
 }hpd_unicore_bestnavb_t;
 
+/**
+ * @brief UNIHEADINGB (972) - 두 안테나 사이 기선의 heading/pitch
+ */
+typedef struct __attribute__((packed))
+{
+    uint32_t sol_status; ///< 0: SOL_COMPUTED
+    uint32_t pos_type;   ///< gps_unicore_pos_type_t
+    float length;        ///< 기선 길이 [m]
+    float heading;       ///< [deg] 0~360
+    float pitch;         ///< [deg]
+    float reserved0;
+    float heading_dev;   ///< [deg]
+    float pitch_dev;     ///< [deg]
+    char base_station_id[4];
+    uint8_t sv;
+    uint8_t used_sv;
+    uint8_t obs;
+    uint8_t multi;
+    uint8_t reserved1;
+    uint8_t ext_sol_stat;
+    uint8_t galileo_bds3_sig_mask;
+    uint8_t gps_glonass_bds2_sig_mask;
+}hpd_unicore_uniheadingb_t;
+
+/**
+ * @brief PVTSLNB (1021) 앞부분 - 위치/속도/heading/DOP (뒤의 PRN 목록은 쓰지 않음)
+ */
+typedef struct __attribute__((packed))
+{
+    uint32_t bestpos_type;
+    float bestpos_hgt;
+    double bestpos_lat;
+    double bestpos_lon;
+    float bestpos_hgt_dev;
+    float bestpos_lat_dev;
+    float bestpos_lon_dev;
+    float bestpos_diff_age;
+    uint32_t psrpos_type;
+    float psrpos_hgt;
+    double psrpos_lat;
+    double psrpos_lon;
+    float undulation;
+    uint8_t bestpos_sv;
+    uint8_t bestpos_used_sv;
+    uint8_t psrpos_sv;
+    uint8_t psrpos_used_sv;
+    double vel_north;    ///< [m/s]
+    double vel_east;     ///< [m/s]
+    double vel_ground;   ///< [m/s]
+    uint32_t heading_type;
+    float heading_length;
+    float heading;       ///< [deg]
+    float heading_pitch; ///< [deg]
+    uint8_t heading_sv;
+    uint8_t heading_used_sv;
+    uint8_t heading_ggl1;
+    uint8_t heading_ggl1l2;
+    float gdop;
+    float pdop;
+    float hdop;
+    float htdop;
+    float tdop;
+    float cutoff;
+}hpd_unicore_pvtslnb_t;
+
 typedef struct {
-  hpd_unicore_bestnavb_t bestnav;
+  hpd_unicore_bestnavb_t bestnav; ///< BESTNAVB 와 ADRNAVB 가 같이 쓴다
+  hpd_unicore_uniheadingb_t uniheading;
+  hpd_unicore_pvtslnb_t pvtsln;
 } gps_unicore_bin_data_t;
 
 typedef struct gps_s gps_t;
 
 gps_unicore_resp_t gps_get_unicore_response(gps_t *gps);
+const char *gps_get_unicore_echo(gps_t *gps);
 uint8_t gps_parse_unicore_term(gps_t *gps);
 uint8_t gps_parse_unicore_bin(gps_t *gps);
 
@@ -1,5 +1,8 @@
 #include "rtcm.h"
+#include "rtcm_msm.h"
 #include "lora_app.h"
+#include "lora_stats.h"
+#include "mem_section.h"
 #include "FreeRTOS.h"
 #include "task.h"
 #include <string.h>
@@ -15,40 +18,176 @@
 // LoRa 최대 236 HEX 문자 = 118 바이트 binary
 #define RTCM_MAX_FRAGMENT_SIZE 118  // Max binary size per fragment
 
-// LoRa Time on Air calculation (SF7, BW125, CR4/5, Preamble 8)
-// HEX 변환: 1 byte -> 2 HEX chars
-// 최대 118바이트 = 236 HEX chars = 350ms (측정값)
-// 20% 여유: 350ms * 1.2 = 420ms
-#define RTCM_MAX_BINARY_BYTES 118   // 최대 binary 크기
-#define LORA_TOA_MAX_MS 350         // 118바이트(236 HEX) 전송 시간
-#define LORA_TOA_MARGIN_PERCENT 20  // 20% margin
+// epoch 마지막 MSM 이 안 와도 이 시간이 지나면 모아 둔 바이트를 보냄
+#define RTCM_EPOCH_FLUSH_MS 100
+
+// XOR 패리티 그룹 크기 기본값 (0: FEC 끔)
+#ifndef RTCM_FEC_GROUP_DEFAULT
+#define RTCM_FEC_GROUP_DEFAULT 0
+#endif
+
+// MSM5/6/7 -> MSM4 재인코딩 기본값 (0: 끔)
+#ifndef RTCM_MSM_COMPACT_DEFAULT
+#define RTCM_MSM_COMPACT_DEFAULT 0
+#endif
+
+// 스케줄러가 기억하는 RTCM 타입 수 (4개 위성군 MSM + 기준국 + 궤도력)
+#define RTCM_SCHED_MAX_TYPES 24
+
+/**
+ * @brief 타입 범위별 기본 송신 주기와 우선순위
+ */
+typedef struct {
+  uint16_t type_lo;
+  uint16_t type_hi;
+  uint32_t period_ms;
+  rtcm_sched_prio_t prio;
+} rtcm_sched_rule_t;
 
 /**
- * @brief Calculate LoRa Time on Air (ToA) with 20% margin
+ * @brief 타입별 스케줄 상태
+ */
+typedef struct {
+  uint16_t type;
+  rtcm_sched_prio_t prio;
+  uint32_t period_ms;
+  TickType_t next_due[RTCM_SINK_MAX]; // 출력별 다음 송신 예정 tick
+  bool started[RTCM_SINK_MAX];
+  uint32_t dropped;      // LoRa 가 주기/큐 여유 때문에 버린 프레임 수
+} rtcm_sched_slot_t;
+
+static const rtcm_sched_rule_t rtcm_sched_rules[] = {
+  { 1005, 1006, 10000, RTCM_SCHED_PRIO_HIGH },   // 기준국 ARP
+  { 1033, 1033, 10000, RTCM_SCHED_PRIO_NORMAL }, // 안테나/수신기 정보
+  { 1071, 1077, 1000, RTCM_SCHED_PRIO_HIGH },    // GPS MSM
+  { 1081, 1137, 1000, RTCM_SCHED_PRIO_NORMAL },  // GLO/GAL/SBAS/QZSS/BDS/NavIC MSM
+  { 1230, 1230, 5000, RTCM_SCHED_PRIO_LOW },     // GLONASS code-phase bias
+  { 1019, 1020, 30000, RTCM_SCHED_PRIO_LOW },    // GPS/GLO 궤도력
+  { 1041, 1046, 30000, RTCM_SCHED_PRIO_LOW },    // NavIC/BDS/QZSS/GAL 궤도력
+};
+
+/**
+ * @brief 우선순위별로 남겨 둬야 하는 LoRa 큐 슬롯 수
  *
- * Formula: ToA = (bytes / 118) * 350ms * 1.2
+ * 낮은 우선순위일수록 큐가 더 비어 있어야 들어갈 수 있어서
+ * 큐가 밀리면 LOW -> NORMAL 순으로 먼저 버려진다.
+ */
+static const uint8_t rtcm_sched_reserve[] = {
+  [RTCM_SCHED_PRIO_HIGH] = 0,
+  [RTCM_SCHED_PRIO_NORMAL] = 3,
+  [RTCM_SCHED_PRIO_LOW] = 8,
+};
+
+static rtcm_sched_slot_t rtcm_sched_slots[RTCM_SCHED_MAX_TYPES];
+static uint8_t rtcm_sched_slot_cnt;
+
+/**
+ * @brief epoch 묶음 버퍼 (아직 fragment 하나를 못 채운 바이트)
  *
- * @param binary_bytes Binary payload size (before HEX conversion)
- * @return Time on Air in milliseconds (with 20% margin)
+ * buf 앞 RTCM_FRAG_HDR_SIZE 바이트는 송신 시 채우는 fragment 헤더 자리.
+ * GPS RX task 에서만 접근한다.
+ */
+static struct {
+  uint8_t buf[RTCM_MAX_FRAGMENT_SIZE];
+  size_t len;             // 헤더를 뺀 데이터 길이
+  TickType_t first_tick;  // 버퍼에 첫 바이트가 들어온 시각
+  uint16_t last_type;
+  uint8_t seq;            // 현재 epoch 번호
+  uint8_t idx;            // 현재 epoch 안의 다음 fragment 번호
+
+  uint8_t fec;            // 이번 epoch 의 패리티 그룹 크기 (0: 끔)
+  uint8_t fec_first;      // 그룹 첫 fragment index
+  uint8_t fec_cnt;        // 그룹에 XOR 한 fragment 수
+  uint8_t fec_last_len;   // 그룹 마지막 fragment 데이터 길이
+  uint8_t parity[RTCM_FEC_DATA_SIZE];
+} rtcm_pack = { .fec = RTCM_FEC_GROUP_DEFAULT };
+
+static uint8_t rtcm_fec_group = RTCM_FEC_GROUP_DEFAULT;
+
+static bool rtcm_msm_compact_on = RTCM_MSM_COMPACT_DEFAULT;
+static uint32_t rtcm_msm_sig_keep[RTCM_MSM_GNSS_MAX] = {
+  RTCM_MSM_SIG_ALL, RTCM_MSM_SIG_ALL, RTCM_MSM_SIG_ALL, RTCM_MSM_SIG_ALL,
+  RTCM_MSM_SIG_ALL, RTCM_MSM_SIG_ALL, RTCM_MSM_SIG_ALL,
+};
+
+/**
+ * @brief MSM 재인코딩 버퍼 (GPS RX task 전용, LoRa 큐가 복사해 가므로 CCM 가능)
  */
-static uint32_t calculate_lora_toa(size_t binary_bytes) {
-  // ToA(ms) = (bytes / 118) * 350 * 1.2
-  uint32_t toa_ms = (binary_bytes * LORA_TOA_MAX_MS / RTCM_MAX_BINARY_BYTES);
-  toa_ms = toa_ms * (100 + LORA_TOA_MARGIN_PERCENT) / 100;
+CCM_BSS static uint8_t rtcm_msm_in[GPS_PAYLOAD_SIZE];
+CCM_BSS static uint8_t rtcm_msm_out[GPS_PAYLOAD_SIZE];
+
+#define RTCM_PACK_DATA_SIZE RTCM_FRAG_DATA_SIZE
 
-  // Minimum ToA
-  if (toa_ms < 60) {
-    toa_ms = 60;  // 최소 60ms (20% margin 포함)
+/**
+ * @brief 이번 epoch 의 fragment 당 데이터 크기 (FEC 면 패리티 정보 자리만큼 작음)
+ */
+static size_t rtcm_pack_cap(void) {
+  return rtcm_pack.fec ? RTCM_FEC_DATA_SIZE : RTCM_PACK_DATA_SIZE;
+}
+
+/**
+ * @brief CRC24Q 테이블 (polynomial 0x1864CFB)
+ */
+static const uint32_t rtcm_crc24q_table[256] = {
+    0x000000, 0x864CFB, 0x8AD50D, 0x0C99F6, 0x93E6E1, 0x15AA1A, 0x1933EC, 0x9F7F17,
+    0xA18139, 0x27CDC2, 0x2B5434, 0xAD18CF, 0x3267D8, 0xB42B23, 0xB8B2D5, 0x3EFE2E,
+    0xC54E89, 0x430272, 0x4F9B84, 0xC9D77F, 0x56A868, 0xD0E493, 0xDC7D65, 0x5A319E,
+    0x64CFB0, 0xE2834B, 0xEE1ABD, 0x685646, 0xF72951, 0x7165AA, 0x7DFC5C, 0xFBB0A7,
+    0x0CD1E9, 0x8A9D12, 0x8604E4, 0x00481F, 0x9F3708, 0x197BF3, 0x15E205, 0x93AEFE,
+    0xAD50D0, 0x2B1C2B, 0x2785DD, 0xA1C926, 0x3EB631, 0xB8FACA, 0xB4633C, 0x322FC7,
+    0xC99F60, 0x4FD39B, 0x434A6D, 0xC50696, 0x5A7981, 0xDC357A, 0xD0AC8C, 0x56E077,
+    0x681E59, 0xEE52A2, 0xE2CB54, 0x6487AF, 0xFBF8B8, 0x7DB443, 0x712DB5, 0xF7614E,
+    0x19A3D2, 0x9FEF29, 0x9376DF, 0x153A24, 0x8A4533, 0x0C09C8, 0x00903E, 0x86DCC5,
+    0xB822EB, 0x3E6E10, 0x32F7E6, 0xB4BB1D, 0x2BC40A, 0xAD88F1, 0xA11107, 0x275DFC,
+    0xDCED5B, 0x5AA1A0, 0x563856, 0xD074AD, 0x4F0BBA, 0xC94741, 0xC5DEB7, 0x43924C,
+    0x7D6C62, 0xFB2099, 0xF7B96F, 0x71F594, 0xEE8A83, 0x68C678, 0x645F8E, 0xE21375,
+    0x15723B, 0x933EC0, 0x9FA736, 0x19EBCD, 0x8694DA, 0x00D821, 0x0C41D7, 0x8A0D2C,
+    0xB4F302, 0x32BFF9, 0x3E260F, 0xB86AF4, 0x2715E3, 0xA15918, 0xADC0EE, 0x2B8C15,
+    0xD03CB2, 0x567049, 0x5AE9BF, 0xDCA544, 0x43DA53, 0xC596A8, 0xC90F5E, 0x4F43A5,
+    0x71BD8B, 0xF7F170, 0xFB6886, 0x7D247D, 0xE25B6A, 0x641791, 0x688E67, 0xEEC29C,
+    0x3347A4, 0xB50B5F, 0xB992A9, 0x3FDE52, 0xA0A145, 0x26EDBE, 0x2A7448, 0xAC38B3,
+    0x92C69D, 0x148A66, 0x181390, 0x9E5F6B, 0x01207C, 0x876C87, 0x8BF571, 0x0DB98A,
+    0xF6092D, 0x7045D6, 0x7CDC20, 0xFA90DB, 0x65EFCC, 0xE3A337, 0xEF3AC1, 0x69763A,
+    0x578814, 0xD1C4EF, 0xDD5D19, 0x5B11E2, 0xC46EF5, 0x42220E, 0x4EBBF8, 0xC8F703,
+    0x3F964D, 0xB9DAB6, 0xB54340, 0x330FBB, 0xAC70AC, 0x2A3C57, 0x26A5A1, 0xA0E95A,
+    0x9E1774, 0x185B8F, 0x14C279, 0x928E82, 0x0DF195, 0x8BBD6E, 0x872498, 0x016863,
+    0xFAD8C4, 0x7C943F, 0x700DC9, 0xF64132, 0x693E25, 0xEF72DE, 0xE3EB28, 0x65A7D3,
+    0x5B59FD, 0xDD1506, 0xD18CF0, 0x57C00B, 0xC8BF1C, 0x4EF3E7, 0x426A11, 0xC426EA,
+    0x2AE476, 0xACA88D, 0xA0317B, 0x267D80, 0xB90297, 0x3F4E6C, 0x33D79A, 0xB59B61,
+    0x8B654F, 0x0D29B4, 0x01B042, 0x87FCB9, 0x1883AE, 0x9ECF55, 0x9256A3, 0x141A58,
+    0xEFAAFF, 0x69E604, 0x657FF2, 0xE33309, 0x7C4C1E, 0xFA00E5, 0xF69913, 0x70D5E8,
+    0x4E2BC6, 0xC8673D, 0xC4FECB, 0x42B230, 0xDDCD27, 0x5B81DC, 0x57182A, 0xD154D1,
+    0x26359F, 0xA07964, 0xACE092, 0x2AAC69, 0xB5D37E, 0x339F85, 0x3F0673, 0xB94A88,
+    0x87B4A6, 0x01F85D, 0x0D61AB, 0x8B2D50, 0x145247, 0x921EBC, 0x9E874A, 0x18CBB1,
+    0xE37B16, 0x6537ED, 0x69AE1B, 0xEFE2E0, 0x709DF7, 0xF6D10C, 0xFA48FA, 0x7C0401,
+    0x42FA2F, 0xC4B6D4, 0xC82F22, 0x4E63D9, 0xD11CCE, 0x575035, 0x5BC9C3, 0xDD8538,
+};
+
+RAM_FUNC uint32_t rtcm_crc24q_update(uint32_t crc, const uint8_t *buf, size_t len) {
+  while (len--) {
+    crc = (crc << 8) ^ rtcm_crc24q_table[((crc >> 16) ^ *buf++) & 0xFF];
   }
 
-  return toa_ms;
+  return crc & 0xFFFFFF;
 }
 
 /**
- * @brief Callback for last fragment transmission completion
+ * @brief fragment 콜백 user_data: epoch 마지막 fragment 면 타입 | RTCM_CB_LAST
  */
-static void rtcm_last_fragment_callback(bool success, void *user_data) {
-  uint16_t msg_type = (uint16_t)(uintptr_t)user_data;
+#define RTCM_CB_LAST 0x10000u
+
+/**
+ * @brief fragment 송신 완료 콜백 (통계, 마지막 fragment 는 로그)
+ */
+static void rtcm_fragment_callback(bool success, void *user_data) {
+  uint32_t tag = (uint32_t)(uintptr_t)user_data;
+  uint16_t msg_type = (uint16_t)tag;
+
+  lora_stats_tx_done(success);
+
+  if (!(tag & RTCM_CB_LAST)) {
+    return;
+  }
 
   if (success) {
     LOG_INFO("RTCM transmission complete (type=%d)", msg_type);
@@ -57,11 +196,389 @@ static void rtcm_last_fragment_callback(bool success, void *user_data) {
   }
 }
 
+/**
+ * @brief 프레임 뷰에서 fragment 위치 가져오기
+ *
+ * fragment가 한 구간 안에 있으면 링을 직접 가리키고,
+ * 링 끝에서 나뉘는 경우에만 tmp로 복사한다.
+ *
+ * @param[in] frame 프레임 뷰
+ * @param[in] offset 프레임 내 시작 위치
+ * @param[in] len fragment 길이
+ * @param[out] tmp 복사용 버퍼 (len 이상)
+ * @return const uint8_t* fragment 데이터
+ */
+static const uint8_t *rtcm_frame_fragment(const gps_frame_t *frame, size_t offset,
+                                          size_t len, uint8_t *tmp) {
+  if (offset + len <= frame->len[0]) {
+    return &frame->seg[0][offset];
+  }
+
+  if (offset >= frame->len[0]) {
+    return &frame->seg[1][offset - frame->len[0]];
+  }
+
+  size_t head = frame->len[0] - offset;
+  memcpy(tmp, &frame->seg[0][offset], head);
+  memcpy(&tmp[head], frame->seg[1], len - head);
+  return tmp;
+}
+
+/**
+ * @brief 타입의 스케줄 슬롯 찾기, 처음 보는 타입이면 기본 규칙으로 할당
+ *
+ * 호출 측에서 critical section 으로 감싼다.
+ *
+ * @param[in] type RTCM 메시지 타입
+ * @return rtcm_sched_slot_t* 슬롯, 테이블이 가득 차면 NULL
+ */
+static rtcm_sched_slot_t *rtcm_sched_slot(uint16_t type) {
+  for (uint8_t i = 0; i < rtcm_sched_slot_cnt; i++) {
+    if (rtcm_sched_slots[i].type == type) {
+      return &rtcm_sched_slots[i];
+    }
+  }
+
+  if (rtcm_sched_slot_cnt >= RTCM_SCHED_MAX_TYPES) {
+    return NULL;
+  }
+
+  rtcm_sched_slot_t *slot = &rtcm_sched_slots[rtcm_sched_slot_cnt++];
+  memset(slot, 0, sizeof(*slot));
+  slot->type = type;
+  slot->period_ms = 0;
+  slot->prio = RTCM_SCHED_PRIO_LOW;
+
+  for (size_t i = 0; i < sizeof(rtcm_sched_rules) / sizeof(rtcm_sched_rules[0]); i++) {
+    if (type >= rtcm_sched_rules[i].type_lo && type <= rtcm_sched_rules[i].type_hi) {
+      slot->period_ms = rtcm_sched_rules[i].period_ms;
+      slot->prio = rtcm_sched_rules[i].prio;
+      break;
+    }
+  }
+
+  return slot;
+}
+
+/**
+ * @brief 이번 프레임이 송신 주기에 해당하는지
+ *
+ * 수신기 출력 주기의 흔들림 때문에 한 epoch 씩 밀리지 않도록
+ * 예정 시각보다 주기의 1/4 까지 일찍 온 프레임도 받아준다.
+ */
+static bool rtcm_sched_due(const rtcm_sched_slot_t *slot, rtcm_sink_t sink, TickType_t now) {
+  if (slot->period_ms == RTCM_SCHED_PERIOD_OFF) {
+    return false;
+  }
+
+  if (slot->period_ms == 0 || !slot->started[sink]) {
+    return true;
+  }
+
+  TickType_t early = pdMS_TO_TICKS(slot->period_ms / 4);
+  return (int32_t)(now - (slot->next_due[sink] - early)) >= 0;
+}
+
+/**
+ * @brief 송신 완료 후 다음 예정 시각 갱신
+ *
+ * 예정 시각 기준으로 주기를 더해 평균 주기를 유지하고,
+ * 한 주기 이상 밀렸으면 현재 시각으로 다시 맞춘다.
+ */
+static void rtcm_sched_commit(rtcm_sched_slot_t *slot, rtcm_sink_t sink, TickType_t now) {
+  if (slot->period_ms == 0 || slot->period_ms == RTCM_SCHED_PERIOD_OFF) {
+    return;
+  }
+
+  TickType_t period = pdMS_TO_TICKS(slot->period_ms);
+
+  if (!slot->started[sink] || (int32_t)(now - slot->next_due[sink]) >= (int32_t)period) {
+    slot->next_due[sink] = now + period;
+  } else {
+    slot->next_due[sink] += period;
+  }
+  slot->started[sink] = true;
+}
+
+bool rtcm_sched_set_period(uint16_t msg_type, uint32_t period_ms) {
+  taskENTER_CRITICAL();
+  rtcm_sched_slot_t *slot = rtcm_sched_slot(msg_type);
+  if (slot) {
+    slot->period_ms = period_ms;
+    memset(slot->started, 0, sizeof(slot->started));
+  }
+  taskEXIT_CRITICAL();
+
+  if (!slot) {
+    LOG_ERR("RTCM scheduler table full (type=%d)", msg_type);
+    return false;
+  }
+
+  LOG_INFO("RTCM type %d period -> %lu ms", msg_type, period_ms);
+  return true;
+}
+
+bool rtcm_sched_take(rtcm_sink_t sink, uint16_t msg_type) {
+  TickType_t now = xTaskGetTickCount();
+  bool due = true;
+
+  if (sink == RTCM_SINK_LORA || sink >= RTCM_SINK_MAX) {
+    return false;
+  }
+
+  taskENTER_CRITICAL();
+  rtcm_sched_slot_t *slot = rtcm_sched_slot(msg_type);
+  if (slot) {
+    due = rtcm_sched_due(slot, sink, now);
+    if (due) {
+      rtcm_sched_commit(slot, sink, now);
+    }
+  }
+  taskEXIT_CRITICAL();
+
+  return due;
+}
+
 void rtcm_tx_task_init(void) {
   // No task needed anymore - direct async transmission
   LOG_INFO("RTCM async transmission initialized (no task)");
 }
 
+/**
+ * @brief MSM 메시지 타입인지 (1071~1137, 위성군마다 xx1~xx7)
+ */
+static bool rtcm_is_msm(uint16_t type) {
+  return type >= 1071 && type <= 1137 && (type % 10) >= 1 && (type % 10) <= 7;
+}
+
+/**
+ * @brief 프레임의 지정 구간을 dst 로 복사
+ */
+static void rtcm_frame_copy(const gps_frame_t *frame, size_t offset, size_t len,
+                            uint8_t *dst) {
+  const uint8_t *src = rtcm_frame_fragment(frame, offset, len, dst);
+
+  if (src != dst) {
+    memcpy(dst, src, len);
+  }
+}
+
+/**
+ * @brief MSM 헤더의 multiple message bit
+ *
+ * payload 기준 type(12) + station id(12) + epoch time(30) 다음 비트.
+ * 0 이면 이번 epoch 의 마지막 MSM 메시지다.
+ *
+ * @return true: 같은 epoch 의 메시지가 더 온다
+ */
+static bool rtcm_msm_more_follows(const gps_frame_t *frame, size_t rtcm_len) {
+  uint8_t b;
+
+  if (rtcm_len <= 3 + 6 + 3) {
+    return false;
+  }
+
+  rtcm_frame_copy(frame, 3 + 6, 1, &b);
+  return (b >> 1) & 0x01;
+}
+
+/**
+ * @brief 현재 epoch 을 닫고 다음 epoch 번호로 넘어감
+ */
+static void rtcm_pack_next_epoch(void) {
+  rtcm_pack.len = 0;
+  rtcm_pack.seq++;
+  rtcm_pack.idx = 0;
+  rtcm_pack.fec_cnt = 0;
+  rtcm_pack.fec = rtcm_fec_group;
+}
+
+/**
+ * @brief 그룹 XOR 패리티 fragment 송신
+ *
+ * payload: [first idx][cnt | epoch 끝][마지막 fragment 길이][XOR(데이터, 0 패딩)]
+ * 그룹에서 fragment 하나가 빠지면 로버가 나머지와 XOR 해서 복원한다.
+ *
+ * @param[in] epoch_end 그룹이 epoch 의 마지막 fragment 를 포함
+ */
+static void rtcm_pack_send_parity(bool epoch_end) {
+  uint8_t frag[RTCM_MAX_FRAGMENT_SIZE];
+
+  frag[0] = rtcm_pack.seq;
+  frag[1] = RTCM_FRAG_PARITY;
+  frag[2] = rtcm_pack.fec_first;
+  frag[3] = rtcm_pack.fec_cnt | (epoch_end ? RTCM_FRAG_LAST : 0);
+  frag[4] = rtcm_pack.fec_last_len;
+  memcpy(&frag[RTCM_FEC_HDR_SIZE], rtcm_pack.parity, RTCM_FEC_DATA_SIZE);
+
+  LOG_DEBUG("RTCM parity: seq=%d idx %d..%d", rtcm_pack.seq, rtcm_pack.fec_first,
+            rtcm_pack.fec_first + rtcm_pack.fec_cnt - 1);
+
+  bool ret = lora_send_p2p_raw_async(frag, sizeof(frag), 0, rtcm_fragment_callback, NULL);
+  lora_stats_tx_queued(ret, false);
+  if (!ret) {
+    LOG_WARN("Failed to queue RTCM parity (seq=%d)", rtcm_pack.seq);
+  }
+
+  rtcm_pack.fec_cnt = 0;
+}
+
+/**
+ * @brief 송신한 데이터 fragment 를 패리티 그룹에 누적
+ */
+static void rtcm_pack_fec_add(const uint8_t *data, size_t len) {
+  if (rtcm_pack.fec_cnt == 0) {
+    rtcm_pack.fec_first = rtcm_pack.idx;
+    memset(rtcm_pack.parity, 0, sizeof(rtcm_pack.parity));
+  }
+
+  for (size_t i = 0; i < len; i++) {
+    rtcm_pack.parity[i] ^= data[i];
+  }
+  rtcm_pack.fec_cnt++;
+  rtcm_pack.fec_last_len = (uint8_t)len;
+}
+
+bool rtcm_set_fec_group(uint8_t group) {
+  if (group > RTCM_FEC_MAX_GROUP) {
+    LOG_ERR("RTCM FEC group %d > %d", group, RTCM_FEC_MAX_GROUP);
+    return false;
+  }
+
+  // 진행 중인 epoch 은 그대로 두고 다음 epoch 부터 적용
+  rtcm_fec_group = group;
+  LOG_INFO("RTCM FEC group -> %d%s", group, group ? "" : " (off)");
+  return true;
+}
+
+void rtcm_set_msm_compact(bool enable) {
+  rtcm_msm_compact_on = enable;
+  LOG_INFO("RTCM MSM compact -> %s", enable ? "on (MSM4)" : "off");
+}
+
+bool rtcm_set_msm_signals(uint16_t msm_type, uint32_t keep_mask) {
+  int gnss = rtcm_msm_gnss(msm_type);
+
+  if (gnss < 0) {
+    LOG_ERR("RTCM type %d is not MSM", msm_type);
+    return false;
+  }
+
+  rtcm_msm_sig_keep[gnss] = keep_mask;
+  LOG_INFO("RTCM MSM %d0 signals -> %08lX", msm_type / 10, keep_mask);
+  return true;
+}
+
+/**
+ * @brief 켜져 있으면 MSM 프레임을 MSM4 로 줄여서 frame 을 바꿈
+ *
+ * @param[inout] frame 원본 프레임, 바꾸면 rtcm_msm_out 을 가리킨다
+ * @param[inout] rtcm_len 프레임 길이
+ * @param[inout] msg_type 메시지 타입
+ */
+static void rtcm_msm_compact_frame(gps_frame_t *frame, size_t *rtcm_len,
+                                   uint16_t *msg_type) {
+  int gnss = rtcm_msm_gnss(*msg_type);
+
+  if (!rtcm_msm_compact_on || gnss < 0 || (*msg_type % 10) < 4 ||
+      *rtcm_len > sizeof(rtcm_msm_in)) {
+    return;
+  }
+
+  const uint8_t *src = rtcm_frame_fragment(frame, 0, *rtcm_len, rtcm_msm_in);
+  size_t n = rtcm_msm_compact(src, *rtcm_len, rtcm_msm_sig_keep[gnss],
+                              rtcm_msm_out, sizeof(rtcm_msm_out));
+  if (n == 0) {
+    return;
+  }
+
+  uint16_t type = *msg_type - (*msg_type % 10) + 4;
+  LOG_DEBUG("RTCM MSM compact: %d -> %d, %d -> %d bytes", *msg_type, type,
+            *rtcm_len, n);
+
+  frame->seg[0] = rtcm_msm_out;
+  frame->len[0] = n;
+  frame->seg[1] = NULL;
+  frame->len[1] = 0;
+  *rtcm_len = n;
+  *msg_type = type;
+}
+
+/**
+ * @brief 모아 둔 바이트를 LoRa fragment 하나로 송신
+ *
+ * 앞에 [epoch seq][last | frag index] 헤더를 붙인다. 로버는 index 가
+ * 끊기면 그 epoch 만 버리고 다음 index 0 에서 다시 맞춘다.
+ *
+ * @param[in] epoch_end epoch 마지막 fragment 면 완료 로그 콜백을 붙인다
+ * @return true: 큐 추가 성공
+ */
+static bool rtcm_pack_flush(bool epoch_end) {
+  if (rtcm_pack.len == 0) {
+    return true;
+  }
+
+  if (rtcm_pack.idx == RTCM_FRAG_IDX_MASK && !epoch_end) {
+    // index 범위를 넘으면 로버가 구분할 수 없으므로 여기서 epoch 을 끊는다
+    LOG_WARN("RTCM epoch too long - splitting (seq=%d)", rtcm_pack.seq);
+    epoch_end = true;
+  }
+
+  rtcm_pack.buf[0] = rtcm_pack.seq;
+  rtcm_pack.buf[1] = rtcm_pack.idx | (epoch_end ? RTCM_FRAG_LAST : 0);
+  size_t frag_len = RTCM_FRAG_HDR_SIZE + rtcm_pack.len;
+
+  void *user_data = epoch_end ? (void *)(uintptr_t)(rtcm_pack.last_type | RTCM_CB_LAST) : NULL;
+
+  LOG_DEBUG("RTCM pack flush: seq=%d idx=%d, %d bytes (last type=%d)",
+            rtcm_pack.seq, rtcm_pack.idx, rtcm_pack.len, rtcm_pack.last_type);
+
+  bool ret = lora_send_p2p_raw_async(rtcm_pack.buf, frag_len, 0, rtcm_fragment_callback,
+                                     user_data);
+  lora_stats_tx_queued(ret, epoch_end);
+  if (!ret) {
+    LOG_ERR("Failed to queue RTCM pack (%d bytes) - LoRa TX queue full?",
+            rtcm_pack.len);
+  } else if (rtcm_pack.fec) {
+    rtcm_pack_fec_add(&rtcm_pack.buf[RTCM_FRAG_HDR_SIZE], rtcm_pack.len);
+    if (rtcm_pack.fec_cnt >= rtcm_pack.fec || epoch_end) {
+      rtcm_pack_send_parity(epoch_end);
+    }
+  }
+
+  if (epoch_end || !ret) {
+    // 빠진 fragment 뒤로 이어 보내면 로버가 어차피 버리므로 새 epoch 로 시작
+    rtcm_pack_next_epoch();
+  } else {
+    rtcm_pack.len = 0;
+    rtcm_pack.idx++;
+  }
+  return ret;
+}
+
+TickType_t rtcm_epoch_poll(void) {
+  if (rtcm_pack.len == 0) {
+    return portMAX_DELAY;
+  }
+
+  TickType_t timeout = pdMS_TO_TICKS(RTCM_EPOCH_FLUSH_MS);
+  TickType_t elapsed = xTaskGetTickCount() - rtcm_pack.first_tick;
+
+  if (elapsed < timeout) {
+    return timeout - elapsed;
+  }
+
+  if (lora_get_tx_queue_space() == 0) {
+    LOG_WARN("RTCM pack dropped: LoRa queue full (%d bytes)", rtcm_pack.len);
+    lora_stats_tx_dropped();
+    rtcm_pack_next_epoch();
+    return portMAX_DELAY;
+  }
+
+  rtcm_pack_flush(true);
+  return portMAX_DELAY;
+}
+
 bool rtcm_send_to_lora(gps_t *gps) {
   if (!gps) {
     LOG_ERR("GPS handle is NULL");
@@ -71,42 +588,118 @@ bool rtcm_send_to_lora(gps_t *gps) {
   // RTCM packet total length
   size_t rtcm_len = gps->rtcm.total_len;
 
+  // 링 모드가 아니면 payload에 프레임 전체가 들어 있음
+  gps_frame_t frame;
+  if (!gps_get_frame(gps, &frame)) {
+    frame.seg[0] = (const uint8_t *)gps->payload;
+    frame.len[0] = rtcm_len;
+    frame.seg[1] = NULL;
+    frame.len[1] = 0;
+  }
+
   if (rtcm_len == 0) {
     LOG_ERR("RTCM length is zero");
     return false;
   }
 
-  // Calculate total fragments needed
-  uint8_t total_fragments = (rtcm_len + RTCM_MAX_FRAGMENT_SIZE - 1) / RTCM_MAX_FRAGMENT_SIZE;
+  uint16_t msg_type = gps->rtcm.msg_type;
+  TickType_t now = xTaskGetTickCount();
+  rtcm_sched_prio_t prio = RTCM_SCHED_PRIO_LOW;
+  bool due = true;
 
-  LOG_INFO("RTCM TX: type=%d, len=%d, fragments=%d",
-           gps->rtcm.msg_type, rtcm_len, total_fragments);
+  taskENTER_CRITICAL();
+  rtcm_sched_slot_t *slot = rtcm_sched_slot(msg_type);
+  if (slot) {
+    prio = slot->prio;
+    due = rtcm_sched_due(slot, RTCM_SINK_LORA, now);
+    if (!due) {
+      slot->dropped++;
+    }
+  }
+  taskEXIT_CRITICAL();
 
-  // Queue all fragments at once
-  for (uint8_t i = 0; i < total_fragments; i++) {
-    size_t offset = i * RTCM_MAX_FRAGMENT_SIZE;
-    size_t fragment_len = (rtcm_len - offset > RTCM_MAX_FRAGMENT_SIZE)
-                          ? RTCM_MAX_FRAGMENT_SIZE
-                          : (rtcm_len - offset);
+  if (!due) {
+    LOG_DEBUG("RTCM type %d skipped (not due)", msg_type);
+    return false;
+  }
 
-    uint32_t toa_ms = calculate_lora_toa(fragment_len);
+  // 스케줄은 원래 타입 기준, 분할과 예산 계산은 줄인 프레임 기준
+  rtcm_msm_compact_frame(&frame, &rtcm_len, &msg_type);
 
-    LOG_DEBUG("Queueing fragment %d/%d: %d bytes",
-             i + 1, total_fragments, fragment_len);
+  // 마지막 MSM 이 아니면 같은 epoch 의 다음 메시지와 이어 붙여 꽉 찬 fragment 로 보낸다
+  bool epoch_end = rtcm_is_msm(msg_type) && !rtcm_msm_more_follows(&frame, rtcm_len);
+  size_t packed = rtcm_pack.len + rtcm_len;
+  size_t cap = rtcm_pack_cap();
+  uint32_t need = packed / cap;
+  if (epoch_end && (packed % cap) != 0) {
+    need++;
+  }
+  if (rtcm_pack.fec) {
+    // 그룹이 차거나 epoch 이 끝날 때마다 패리티 하나
+    uint32_t grouped = rtcm_pack.fec_cnt + need;
+    uint32_t parity = grouped / rtcm_pack.fec;
+    if (epoch_end && (grouped % rtcm_pack.fec) != 0) {
+      parity++;
+    }
+    need += parity;
+  }
 
-    // Last fragment gets callback for logging
-    bool is_last = (i == total_fragments - 1);
-    lora_command_callback_t callback = is_last ? rtcm_last_fragment_callback : NULL;
-    void *user_data = is_last ? (void*)(uintptr_t)gps->rtcm.msg_type : NULL;
+  // 큐가 밀리면 fragment 일부만 들어가거나 GPS task 가 블록되므로 미리 거른다.
+  // 링크 점유 예산도 같은 우선순위 여유로 본다 (fragment 는 꽉 찬 크기로 계산).
+  // 버린 타입은 예정 시각을 유지해서 다음 프레임이 바로 나간다.
+  uint32_t space = lora_get_tx_queue_space();
+  uint32_t frag_us = lora_get_p2p_toa_us(RTCM_MAX_FRAGMENT_SIZE);
+  uint32_t airtime = lora_airtime_available_us();
+  uint32_t slots = need + rtcm_sched_reserve[prio];
+  if (space < slots || airtime < slots * frag_us) {
+    if (slot) {
+      taskENTER_CRITICAL();
+      slot->dropped++;
+      taskEXIT_CRITICAL();
+    }
+    LOG_WARN("RTCM type %d dropped: LoRa queue space %lu, airtime %lu us, need %lu (prio %d)",
+             msg_type, space, airtime, slots, prio);
+    lora_stats_tx_dropped();
+    return false;
+  }
+
+  LOG_INFO("RTCM TX: type=%d, len=%d, packed=%d, fragments=%lu%s",
+           msg_type, rtcm_len, rtcm_pack.len, need, epoch_end ? " (epoch end)" : "");
+
+  for (size_t offset = 0; offset < rtcm_len;) {
+    size_t n = cap - rtcm_pack.len;
+    if (n > rtcm_len - offset) {
+      n = rtcm_len - offset;
+    }
+
+    if (rtcm_pack.len == 0) {
+      rtcm_pack.first_tick = now;
+    }
+
+    rtcm_frame_copy(&frame, offset, n, &rtcm_pack.buf[RTCM_FRAG_HDR_SIZE + rtcm_pack.len]);
+    rtcm_pack.len += n;
+    offset += n;
 
-    if (!lora_send_p2p_raw_async(&gps->payload[offset], fragment_len, toa_ms,
-                                  callback, user_data)) {
-      LOG_ERR("Failed to queue fragment %d/%d - LoRa TX queue full?", i + 1, total_fragments);
-      return false;
+    if (rtcm_pack.len == cap) {
+      rtcm_pack.last_type = msg_type;
+      bool last = epoch_end && offset == rtcm_len;
+      if (!rtcm_pack_flush(last)) {
+        return false;
+      }
     }
   }
 
-  // All fragments queued successfully - return immediately (non-blocking)
-  LOG_INFO("All %d fragments queued to LoRa TX task", total_fragments);
+  rtcm_pack.last_type = msg_type;
+
+  if (epoch_end && !rtcm_pack_flush(true)) {
+    return false;
+  }
+
+  if (slot) {
+    taskENTER_CRITICAL();
+    rtcm_sched_commit(slot, RTCM_SINK_LORA, now);
+    taskEXIT_CRITICAL();
+  }
+
   return true;
 }
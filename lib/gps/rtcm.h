@@ -3,7 +3,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
-#include "gps.h"
+#include <stddef.h>
 
 typedef struct
 {
@@ -11,8 +11,110 @@ typedef struct
     uint16_t msg_type;     // RTCM 메시지 타입 (12비트)
     uint16_t payload_cnt;  // 현재까지 받은 페이로드 바이트 수
     uint16_t total_len;    // 전체 패킷 길이 (헤더 3 + 페이로드 + CRC 3)
+    uint32_t crc;          // 수신 중 누적한 CRC24Q (헤더 + 페이로드)
+    uint32_t crc_rx;       // 패킷 끝에 실려 온 CRC24Q
 }gps_rtcm_parser_t;
 
+/* gps.h가 gps_rtcm_parser_t를 사용하므로 typedef 뒤에 include */
+#include "gps.h"
+
+/**
+ * @brief RTCM3 CRC24Q 누적 계산 (테이블 방식)
+ *
+ * 이전 결과를 crc로 넘기면 조각 단위로 이어서 계산할 수 있다.
+ * 처음 계산 시 crc = 0
+ *
+ * @param[in] crc 이전까지의 CRC 값
+ * @param[in] buf 데이터 버퍼
+ * @param[in] len 데이터 길이
+ * @return uint32_t 24-bit CRC 값
+ */
+uint32_t rtcm_crc24q_update(uint32_t crc, const uint8_t *buf, size_t len);
+
+/**
+ * @brief 스케줄러 주기 특수값: 해당 타입은 보내지 않음
+ */
+#define RTCM_SCHED_PERIOD_OFF 0xFFFFFFFFu
+
+/**
+ * @brief LoRa 큐가 밀릴 때 먼저 살아남는 순서 (작을수록 우선)
+ */
+typedef enum
+{
+    RTCM_SCHED_PRIO_HIGH = 0,   // 기준국 좌표, GPS MSM
+    RTCM_SCHED_PRIO_NORMAL,     // 다른 위성군 MSM
+    RTCM_SCHED_PRIO_LOW,        // 1230, 궤도력, 미등록 타입
+} rtcm_sched_prio_t;
+
+/**
+ * @brief 스케줄러를 따로 쓰는 출력 (타입별 주기는 같고 예정 시각만 따로)
+ */
+typedef enum
+{
+    RTCM_SINK_LORA = 0,
+    RTCM_SINK_NTRIP,            // NTRIP server (캐스터 업로드)
+    RTCM_SINK_MAX,
+} rtcm_sink_t;
+
+/**
+ * @brief 타입별 송신 주기 변경
+ *
+ * 기본값은 1005/1006/1033 10초, MSM 1초, 1230 5초, 궤도력 30초
+ * 0이면 들어오는 프레임을 모두 보내고 RTCM_SCHED_PERIOD_OFF면 보내지 않는다.
+ *
+ * @param[in] msg_type RTCM 메시지 타입
+ * @param[in] period_ms 송신 주기 (ms)
+ * @return true: 설정됨, false: 타입 테이블 가득 참
+ */
+bool rtcm_sched_set_period(uint16_t msg_type, uint32_t period_ms);
+
+/**
+ * @brief 이 출력으로 보낼 차례인지 보고, 맞으면 바로 다음 예정 시각으로 넘김
+ *
+ * LoRa 는 큐/링크 예산을 본 뒤에 넘기므로 rtcm_send_to_lora 가 따로 처리하고,
+ * 큐 여유를 따로 볼 필요 없는 출력 (NTRIP server) 이 쓴다.
+ *
+ * @param[in] sink RTCM_SINK_LORA 가 아닌 출력
+ * @param[in] msg_type RTCM 메시지 타입
+ * @return true: 보냄, false: 주기에 안 맞음 (또는 꺼진 타입)
+ */
+bool rtcm_sched_take(rtcm_sink_t sink, uint16_t msg_type);
+
+/**
+ * @brief LoRa RTCM 스트림 XOR 패리티(FEC) 그룹 크기 설정
+ *
+ * 데이터 fragment group 개마다 패리티 fragment 하나를 더 보내서
+ * 그룹 안에서 하나가 빠지면 로버가 재전송 없이 복원한다.
+ * 진행 중인 epoch 이 끝난 뒤부터 적용된다.
+ *
+ * @param[in] group 그룹 크기 (0: 끔, 최대 RTCM_FEC_MAX_GROUP)
+ * @return true: 설정됨
+ */
+bool rtcm_set_fec_group(uint8_t group);
+
+/**
+ * @brief LoRa 로 보내기 전 MSM5/6/7 을 MSM4 로 재인코딩
+ *
+ * Doppler 와 확장 해상도를 빼서 epoch 당 바이트를 대략 절반으로 줄인다.
+ * 로버는 표준 MSM4 를 받으므로 수신기 설정을 바꿀 필요 없다.
+ * 다음 프레임부터 적용된다.
+ *
+ * @param[in] enable true: 켬
+ */
+void rtcm_set_msm_compact(bool enable);
+
+/**
+ * @brief 재인코딩 시 남길 신호 (위성군 단위)
+ *
+ * 마스크에 없는 신호는 셀 마스크에서 지운다. MSM4 입력에도 적용된다.
+ * 기본값은 RTCM_MSM_SIG_ALL.
+ *
+ * @param[in] msm_type 위성군의 MSM 타입 아무거나 (예: GPS 1074/1077)
+ * @param[in] keep_mask 남길 signal ID (DF395 비트 배치, MSB 가 signal ID 1)
+ * @return true: 설정됨, false: MSM 타입 아님
+ */
+bool rtcm_set_msm_signals(uint16_t msm_type, uint32_t keep_mask);
+
 /**
  * @brief RTCM 전송 초기화 (task 없음)
  *
@@ -26,15 +128,25 @@ void rtcm_tx_task_init(void);
  *
  * - 완전 비동기 전송: 즉시 리턴 (GPS Task 블록 안 됨)
  * - HEX ASCII 변환으로 인해 최대 118바이트씩 전송
- * - 118바이트 초과 시 자동으로 여러 fragment로 분할
- * - ToA(Time on Air) 자동 계산: (bytes / 118) * 350ms * 1.2
+ * - 한 epoch 의 메시지를 이어 붙여 118바이트를 꽉 채운 fragment 로 분할
+ * - MSM multiple message bit 가 0 인 메시지(epoch 끝)에서 남은 바이트 송신
+ * - ToA 는 LoRa 변조 설정으로 계산하고, 링크 점유 예산이 모자라면 우선순위 낮은 타입부터 버림
  * - 모든 fragment를 LoRa TX 큐에 추가 (순차 처리)
- * - 모든 RTCM 타입 전송 (1074, 1084, 1124 등)
- * - LoRa TX 큐가 가득 찬 경우에만 실패
+ * - 타입별 주기에 맞춰 솎아내고, 큐 여유가 부족하면 우선순위 낮은 타입부터 버림
  *
  * @param gps GPS 핸들
- * @return true: 큐 추가 성공, false: 큐 full 또는 에러
+ * @return true: 큐 추가 성공, false: 스케줄러가 버렸거나 큐 full 또는 에러
  */
 bool rtcm_send_to_lora(gps_t *gps);
 
+/**
+ * @brief epoch 묶음 타임아웃 처리 (GPS RX task 루프에서 호출)
+ *
+ * epoch 끝 메시지가 오지 않아도 RTCM_EPOCH_FLUSH_MS 가 지나면
+ * 모아 둔 바이트를 보낸다.
+ *
+ * @return 다음 호출까지 기다릴 tick (모아 둔 바이트가 없으면 portMAX_DELAY)
+ */
+TickType_t rtcm_epoch_poll(void);
+
 #endif
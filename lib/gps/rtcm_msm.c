@@ -0,0 +1,385 @@
+#include "rtcm_msm.h"
+#include "rtcm.h"
+#include <string.h>
+
+/*
+ * MSM 메시지 구조 (RTCM 10403.3, payload 기준 비트)
+ *
+ * 헤더: type(12) station(12) epoch(30) mm(1) IODS(3) reserved(7) clk(2)
+ *       ext clk(2) smooth(1) smooth int(3) = 73, 위성 마스크(64),
+ *       신호 마스크(32), 셀 마스크(Nsat * Nsig)
+ * 위성: MSM4/6 DF397(8) DF398(10), MSM5/7 은 DF397 뒤 확장정보(4),
+ *       DF398 뒤 DF399(14) 추가. 필드마다 위성 수만큼 연속으로 놓인다.
+ * 신호: 셀 수만큼 필드별로 연속, 폭은 rtcm_msm_sig_width 참고.
+ */
+#define MSM_HDR_FIXED_BITS 73
+#define MSM_SAT_MASK_POS MSM_HDR_FIXED_BITS
+#define MSM_SIG_MASK_POS (MSM_SAT_MASK_POS + 64)
+#define MSM_CELL_MASK_POS (MSM_SIG_MASK_POS + 32)
+#define MSM_MAX_CELLS 64
+
+#define MSM4_SAT_BITS (8 + 10)
+#define MSM4_CELL_BITS (15 + 22 + 4 + 1 + 6)
+
+#define RTCM_HDR_SIZE 3
+#define RTCM_CRC_SIZE 3
+#define RTCM_MAX_PAYLOAD 1023
+
+typedef enum {
+  MSM_SIG_PR = 0,  // fine pseudorange (DF400 / DF405)
+  MSM_SIG_CP,      // fine phaserange (DF401 / DF406)
+  MSM_SIG_LOCK,    // lock time indicator (DF402 / DF407)
+  MSM_SIG_HALF,    // half-cycle ambiguity (DF420)
+  MSM_SIG_CNR,     // CNR (DF403 / DF408)
+  MSM_SIG_RATE,    // fine phaserange rate (DF404)
+  MSM_SIG_FIELDS,
+} msm_sig_field_t;
+
+/**
+ * @brief MSM4~7 신호 필드 폭 (0: 없음)
+ */
+static const uint8_t rtcm_msm_sig_width[4][MSM_SIG_FIELDS] = {
+  { 15, 22, 4, 1, 6, 0 },     // MSM4
+  { 15, 22, 4, 1, 6, 15 },    // MSM5
+  { 20, 24, 10, 1, 10, 0 },   // MSM6
+  { 20, 24, 10, 1, 10, 15 },  // MSM7
+};
+
+/**
+ * @brief 입력 MSM 의 위치 정보
+ */
+typedef struct {
+  uint8_t sub;          // 4~7
+  uint8_t nsat;
+  uint8_t nsig;
+  uint8_t ncell;
+  uint64_t sat_mask;
+  uint32_t sig_mask;
+  uint64_t cell_mask;   // 첫 셀이 bit (nsat * nsig - 1)
+  size_t sat_pos;       // 위성 데이터 시작 비트
+  size_t sig_pos[MSM_SIG_FIELDS];
+  size_t bits;          // payload 에 필요한 전체 비트
+} msm_layout_t;
+
+static uint32_t msm_get(const uint8_t *b, size_t pos, uint8_t len) {
+  uint32_t v = 0;
+
+  for (uint8_t i = 0; i < len; i++, pos++) {
+    v = (v << 1) | ((b[pos >> 3] >> (7 - (pos & 7))) & 0x01u);
+  }
+  return v;
+}
+
+static int32_t msm_get_signed(const uint8_t *b, size_t pos, uint8_t len) {
+  uint32_t v = msm_get(b, pos, len);
+
+  if (len < 32 && (v >> (len - 1)) & 0x01u) {
+    v |= ~0u << len;
+  }
+  return (int32_t)v;
+}
+
+static void msm_put(uint8_t *b, size_t pos, uint8_t len, uint32_t v) {
+  for (uint8_t i = 0; i < len; i++, pos++) {
+    uint8_t mask = 0x80 >> (pos & 7);
+
+    if ((v >> (len - 1 - i)) & 0x01u) {
+      b[pos >> 3] |= mask;
+    } else {
+      b[pos >> 3] &= ~mask;
+    }
+  }
+}
+
+static uint8_t msm_popcount(uint64_t v) {
+  uint8_t n = 0;
+
+  for (; v; v &= v - 1) {
+    n++;
+  }
+  return n;
+}
+
+int rtcm_msm_gnss(uint16_t msg_type) {
+  if (msg_type < 1071 || msg_type > 1137 || (msg_type % 10) == 0 ||
+      (msg_type % 10) > 7) {
+    return -1;
+  }
+  return msg_type / 10 - 107;
+}
+
+/**
+ * @brief MSM4~7 payload 의 마스크를 읽고 필드 위치 계산
+ */
+static bool msm_layout(const uint8_t *p, size_t payload_len, msm_layout_t *l) {
+  uint16_t type = (uint16_t)msm_get(p, 0, 12);
+
+  if (rtcm_msm_gnss(type) < 0 || (type % 10) < 4) {
+    return false;
+  }
+
+  l->sub = type % 10;
+  l->sat_mask = ((uint64_t)msm_get(p, MSM_SAT_MASK_POS, 32) << 32) |
+                msm_get(p, MSM_SAT_MASK_POS + 32, 32);
+  l->sig_mask = msm_get(p, MSM_SIG_MASK_POS, 32);
+  l->nsat = msm_popcount(l->sat_mask);
+  l->nsig = msm_popcount(l->sig_mask);
+
+  uint16_t cells = (uint16_t)l->nsat * l->nsig;
+  if (cells > MSM_MAX_CELLS) {
+    return false;
+  }
+
+  l->cell_mask = 0;
+  for (uint16_t i = 0; i < cells; i++) {
+    l->cell_mask = (l->cell_mask << 1) | msm_get(p, MSM_CELL_MASK_POS + i, 1);
+  }
+  l->ncell = msm_popcount(l->cell_mask);
+
+  bool ext_sat = (l->sub == 5 || l->sub == 7);
+  l->sat_pos = MSM_CELL_MASK_POS + cells;
+
+  size_t pos = l->sat_pos + (size_t)l->nsat * (ext_sat ? 36 : MSM4_SAT_BITS);
+  const uint8_t *w = rtcm_msm_sig_width[l->sub - 4];
+  for (int f = 0; f < MSM_SIG_FIELDS; f++) {
+    l->sig_pos[f] = pos;
+    pos += (size_t)l->ncell * w[f];
+  }
+  l->bits = pos;
+
+  return l->bits <= payload_len * 8;
+}
+
+/**
+ * @brief DF407(확장 lock time) -> 최소 lock time (ms)
+ */
+static uint32_t msm_lock_ext_ms(uint32_t i) {
+  if (i < 64) {
+    return i;
+  }
+  if (i >= 704) {
+    return 67108864;
+  }
+
+  uint32_t k = i / 32 - 1;
+  return (i - 32 * k) << k;
+}
+
+/**
+ * @brief 최소 lock time (ms) -> DF402
+ *
+ * DF402 i 는 lock time >= 2^(i+4) ms (i=0 은 32 ms 미만). 보수적으로 내림.
+ */
+static uint32_t msm_lock_ind(uint32_t ms) {
+  uint32_t i = 0;
+
+  while (i < 15 && ms >= (32u << i)) {
+    i++;
+  }
+  return i;
+}
+
+/**
+ * @brief 확장 해상도 값을 shift 비트 줄이고 반올림 (무효값과 범위 초과 처리)
+ */
+static uint32_t msm_reduce(int32_t v, uint8_t in_bits, uint8_t out_bits) {
+  int32_t in_invalid = -(1 << (in_bits - 1));
+  int32_t out_max = (1 << (out_bits - 1)) - 1;
+  uint8_t shift = in_bits - out_bits;
+  uint32_t out_mask = (1u << out_bits) - 1;
+
+  if (v == in_invalid) {
+    return (uint32_t)(-(out_max + 1)) & out_mask;
+  }
+
+  v = (v + (1 << (shift - 1))) >> shift;
+  if (v > out_max) {
+    v = out_max;
+  } else if (v < -out_max) {
+    v = -out_max;
+  }
+  return (uint32_t)v & out_mask;
+}
+
+/**
+ * @brief 셀 하나의 신호 필드를 MSM4 해상도로 변환
+ */
+static uint32_t msm_cell_field(const uint8_t *p, const msm_layout_t *l,
+                               msm_sig_field_t f, uint8_t cell) {
+  uint8_t w = rtcm_msm_sig_width[l->sub - 4][f];
+  size_t pos = l->sig_pos[f] + (size_t)cell * w;
+  bool ext = l->sub >= 6;
+
+  if (!ext) {
+    return msm_get(p, pos, w);
+  }
+
+  switch (f) {
+  case MSM_SIG_PR:
+    return msm_reduce(msm_get_signed(p, pos, w), w, 15);
+  case MSM_SIG_CP:
+    return msm_reduce(msm_get_signed(p, pos, w), w, 22);
+  case MSM_SIG_LOCK:
+    return msm_lock_ind(msm_lock_ext_ms(msm_get(p, pos, w)));
+  case MSM_SIG_CNR: {
+    uint32_t cnr = (msm_get(p, pos, w) + 8) >> 4;
+    return cnr > 63 ? 63 : cnr;
+  }
+  default:
+    return msm_get(p, pos, w);
+  }
+}
+
+size_t rtcm_msm_compact(const uint8_t *in, size_t len, uint32_t sig_keep,
+                        uint8_t *out, size_t size) {
+  if (!in || !out || len < RTCM_HDR_SIZE + RTCM_CRC_SIZE || in[0] != 0xD3) {
+    return 0;
+  }
+
+  size_t payload_len = ((in[1] & 0x03) << 8) | in[2];
+  if (len < payload_len + RTCM_HDR_SIZE + RTCM_CRC_SIZE) {
+    return 0;
+  }
+
+  const uint8_t *p = &in[RTCM_HDR_SIZE];
+  msm_layout_t l;
+  if (!msm_layout(p, payload_len, &l)) {
+    return 0;
+  }
+
+  // 남길 신호: 필터를 통과하고 실제 셀이 하나라도 있는 것
+  bool sig_used[32] = { false };
+  bool sat_used[64] = { false };
+  int8_t cell_idx[MSM_MAX_CELLS];
+  uint8_t cells = l.nsat * l.nsig;
+  uint8_t c = 0;
+
+  for (uint8_t s = 0; s < l.nsat; s++) {
+    uint8_t sig = 0;
+    for (uint8_t bit = 0; bit < 32; bit++) {
+      if (!((l.sig_mask >> (31 - bit)) & 0x01u)) {
+        continue;
+      }
+      uint8_t i = s * l.nsig + sig;
+      bool present = (l.cell_mask >> (cells - 1 - i)) & 0x01u;
+      cell_idx[i] = present ? (int8_t)c++ : -1;
+      if (present && ((sig_keep >> (31 - bit)) & 0x01u)) {
+        sig_used[sig] = true;
+        sat_used[s] = true;
+      }
+      sig++;
+    }
+  }
+
+  uint64_t sat_mask = 0;
+  uint32_t sig_mask = 0;
+  uint8_t nsat = 0;
+  uint8_t nsig = 0;
+  uint8_t s = 0;
+  for (uint8_t bit = 0; bit < 64; bit++) {
+    if ((l.sat_mask >> (63 - bit)) & 0x01u) {
+      if (sat_used[s]) {
+        sat_mask |= 1ULL << (63 - bit);
+        nsat++;
+      }
+      s++;
+    }
+  }
+  uint8_t sig = 0;
+  for (uint8_t bit = 0; bit < 32; bit++) {
+    if ((l.sig_mask >> (31 - bit)) & 0x01u) {
+      if (sig_used[sig]) {
+        sig_mask |= 1u << (31 - bit);
+        nsig++;
+      }
+      sig++;
+    }
+  }
+
+  if (l.sub == 4 && sat_mask == l.sat_mask && sig_mask == l.sig_mask) {
+    return 0;
+  }
+
+  // 새 셀 목록 (위성 순, 위성 안에서 신호 순)
+  uint8_t keep[MSM_MAX_CELLS];
+  uint8_t new_cells = nsat * nsig;
+  uint8_t ncell = 0;
+  uint64_t cell_mask = 0;
+  for (s = 0; s < l.nsat; s++) {
+    if (!sat_used[s]) {
+      continue;
+    }
+    for (sig = 0; sig < l.nsig; sig++) {
+      if (!sig_used[sig]) {
+        continue;
+      }
+      int8_t idx = cell_idx[s * l.nsig + sig];
+      cell_mask <<= 1;
+      if (idx >= 0) {
+        cell_mask |= 1;
+        keep[ncell++] = (uint8_t)idx;
+      }
+    }
+  }
+
+  size_t bits = MSM_CELL_MASK_POS + new_cells + (size_t)nsat * MSM4_SAT_BITS +
+                (size_t)ncell * MSM4_CELL_BITS;
+  size_t out_payload = (bits + 7) / 8;
+  size_t out_len = RTCM_HDR_SIZE + out_payload + RTCM_CRC_SIZE;
+  if (out_payload > RTCM_MAX_PAYLOAD || out_len > size) {
+    return 0;
+  }
+
+  uint8_t *q = &out[RTCM_HDR_SIZE];
+  memset(q, 0, out_payload);
+
+  uint16_t type = (uint16_t)msm_get(p, 0, 12);
+  msm_put(q, 0, 12, type - (l.sub - 4));
+  for (size_t pos = 12; pos < MSM_HDR_FIXED_BITS; pos += 8) {
+    uint8_t n = MSM_HDR_FIXED_BITS - pos < 8 ? MSM_HDR_FIXED_BITS - pos : 8;
+    msm_put(q, pos, n, msm_get(p, pos, n));
+  }
+  msm_put(q, MSM_SAT_MASK_POS, 32, (uint32_t)(sat_mask >> 32));
+  msm_put(q, MSM_SAT_MASK_POS + 32, 32, (uint32_t)sat_mask);
+  msm_put(q, MSM_SIG_MASK_POS, 32, sig_mask);
+  for (uint8_t i = 0; i < new_cells; i++) {
+    msm_put(q, MSM_CELL_MASK_POS + i, 1, (cell_mask >> (new_cells - 1 - i)) & 0x01u);
+  }
+
+  // 위성 데이터: DF397 전체 다음 DF398 전체
+  bool ext_sat = (l.sub == 5 || l.sub == 7);
+  size_t mod_pos = l.sat_pos + (size_t)l.nsat * (ext_sat ? 12 : 8);
+  size_t wpos = MSM_CELL_MASK_POS + new_cells;
+  for (s = 0; s < l.nsat; s++) {
+    if (sat_used[s]) {
+      msm_put(q, wpos, 8, msm_get(p, l.sat_pos + (size_t)s * 8, 8));
+      wpos += 8;
+    }
+  }
+  for (s = 0; s < l.nsat; s++) {
+    if (sat_used[s]) {
+      msm_put(q, wpos, 10, msm_get(p, mod_pos + (size_t)s * 10, 10));
+      wpos += 10;
+    }
+  }
+
+  // 신호 데이터: DF400, DF401, DF402, DF420, DF403 순으로 셀마다
+  for (int f = 0; f < MSM_SIG_RATE; f++) {
+    uint8_t w = rtcm_msm_sig_width[0][f];
+    for (uint8_t i = 0; i < ncell; i++) {
+      msm_put(q, wpos, w, msm_cell_field(p, &l, (msm_sig_field_t)f, keep[i]));
+      wpos += w;
+    }
+  }
+
+  out[0] = 0xD3;
+  out[1] = (out_payload >> 8) & 0x03;
+  out[2] = out_payload & 0xFF;
+
+  uint32_t crc = rtcm_crc24q_update(0, out, RTCM_HDR_SIZE + out_payload);
+  out[RTCM_HDR_SIZE + out_payload] = (crc >> 16) & 0xFF;
+  out[RTCM_HDR_SIZE + out_payload + 1] = (crc >> 8) & 0xFF;
+  out[RTCM_HDR_SIZE + out_payload + 2] = crc & 0xFF;
+
+  return out_len;
+}
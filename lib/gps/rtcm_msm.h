@@ -0,0 +1,46 @@
+#ifndef RTCM_MSM_H
+#define RTCM_MSM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief MSM 위성군 수 (GPS, GLO, GAL, SBAS, QZSS, BDS, NavIC)
+ */
+#define RTCM_MSM_GNSS_MAX 7
+
+/**
+ * @brief 신호 마스크 기본값 (모든 신호 유지)
+ *
+ * 비트 배치는 DF395 그대로: MSB(bit 31) 가 signal ID 1, LSB 가 signal ID 32.
+ */
+#define RTCM_MSM_SIG_ALL 0xFFFFFFFFu
+
+/**
+ * @brief MSM 타입의 위성군 index (1071~1077 -> 0, ..., 1131~1137 -> 6)
+ *
+ * @return 위성군 index, MSM 이 아니면 -1
+ */
+int rtcm_msm_gnss(uint16_t msg_type);
+
+/**
+ * @brief MSM5/6/7 프레임을 MSM4 로 다시 인코딩
+ *
+ * Doppler(DF399/DF404)와 위성 확장 정보를 빼고 pseudorange/phaserange,
+ * lock time, CNR 을 MSM4 해상도로 줄인다. sig_keep 에 없는 신호는
+ * 신호/셀 마스크에서 지우고, 남은 셀이 없는 위성은 위성 마스크에서 지운다.
+ * MSM4 입력은 신호 필터만 적용한다. 헤더의 epoch, multiple message bit,
+ * IODS 등은 그대로 두므로 로버에는 표준 RTCM 으로 보인다.
+ *
+ * @param[in] in 입력 프레임 (0xD3 헤더 ~ CRC)
+ * @param[in] len 입력 프레임 길이
+ * @param[in] sig_keep 유지할 신호 (DF395 비트 배치)
+ * @param[out] out 출력 프레임 버퍼 (in 과 겹치면 안 됨)
+ * @param[in] size 출력 버퍼 크기 (len 이상이면 충분)
+ * @return 출력 프레임 길이, 바꿀 게 없거나 해석할 수 없으면 0
+ */
+size_t rtcm_msm_compact(const uint8_t *in, size_t len, uint32_t sig_keep,
+                        uint8_t *out, size_t size);
+
+#endif
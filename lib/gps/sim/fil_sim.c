@@ -0,0 +1,576 @@
+/**
+ * @file fil_sim.c
+ * @brief 기준국 보정 경로 호스트 시뮬레이터 (GNSS UART -> RTCM -> LoRa)
+ *
+ * gps.c 파서와 rtcm.c 를 pthread shim 위에서 그대로 돌린다. 수신기 UART 는
+ * 캡처 파일을 baud 속도로 DMA 링에 흘려 IDLE/HT/TC 에서 깨우고, LoRa 모듈은
+ * 명령 UART 전송 시간 + ToA 만큼 붙잡는 TX 태스크로 흉내낸다. 태스크 구성과
+ * 큐 깊이는 펌웨어 (gps_process_task, lora_tx_task) 와 같게 맞췄다.
+ *
+ * 출력: 보정 지연 (RTCM 프레임 마지막 byte 가 UART 에 도착 -> 그 프레임을 담은
+ * fragment 송신 끝), 태스크별 CPU 시간, 큐 최대 깊이, 스케줄러가 버린 수.
+ * 로버 쪽 NTRIP/GSM 구간은 lib/gsm/sim/gsm_sim.c 가 같은 shim 으로 잰다.
+ * 펌웨어 빌드에서는 제외되며 호스트 gcc로 직접 빌드한다.
+ *
+ * 빌드 (repo 루트에서):
+ *   gcc -O2 -std=gnu11 -pthread -Ilib/gsm/sim/shim -Ilib/gps -Ilib/parser \
+ *       -Ilib/log -Ilib/crc -Ilib/simd -Ilib/lora -Imodules/lora -Iconfig \
+ *       -DUSE_GPS_ALL_DECODERS -o fil_sim lib/gps/sim/fil_sim.c lib/gps/gps*.c \
+ *       lib/gps/rtcm*.c lib/parser/parser.c lib/crc/crc.c lib/simd/simd.c \
+ *       lib/lora/lora.c -lm
+ *
+ * 실행:
+ *   ./fil_sim [-b baud] [-r rate] [-p period_ms] [-R ring] [-s sf] [-w bw]
+ *             [-L lora_baud] [-f fec] [-C] [-t sec] base_capture.bin
+ *
+ *   -b : 수신기 UART 속도 (기본 115200)
+ *   -r : 평균 출력 속도 B/s, period 마다 몰아서 보냄. 0 이면 쉬지 않고 (기본 0)
+ *   -p : 수신기 epoch 주기 ms (기본 1000)
+ *   -R : DMA 링 크기 (기본 GPS1_RX_RING_SIZE)
+ *   -s, -w : LoRa SF, BW (0:125k 1:250k 2:500k, 기본 7, 2)
+ *   -L : LoRa 모듈 명령 UART 속도 (기본 460800)
+ *   -f : RTCM FEC 그룹 크기 (기본 0)
+ *   -C : MSM -> MSM4 재인코딩
+ *   -t : 최대 실행 시간 초 (기본 60)
+ *
+ * 캡처는 기준국 수신기 UART 를 그대로 저장한 raw 바이너리 (RTCM3 + NMEA 등).
+ */
+
+#include "gps.h"
+#include "rtcm.h"
+#include "lora_app.h"
+#include "board_config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define SIM_LORA_QUEUE_SIZE 25 // lora_app.c LORA_CMD_QUEUE_SIZE
+#define SIM_LORA_MAX_RAW 118   // lora_app.c LORA_P2P_MAX_RAW
+#define SIM_LORA_CMD_OVERHEAD 19 // "at+send=lorap2p:" + "\r\n" + 여유
+#define SIM_AIRTIME_PERMILLE 900 // lora_app.c LORA_AIRTIME_BUDGET_PERMILLE
+#define SIM_STEP_US 200
+
+SIM_SHIM_STATE;
+
+typedef struct {
+  uint32_t baud;
+  uint32_t rate;
+  uint32_t period_ms;
+  size_t ring;
+  uint32_t lora_baud;
+  lora_modem_params_t lora;
+  uint8_t fec;
+  bool compact;
+  uint32_t timeout_s;
+} sim_cfg_t;
+
+static sim_cfg_t cfg = {
+    .baud = 115200,
+    .rate = 0,
+    .period_ms = 1000,
+    .ring = GPS1_RX_RING_SIZE,
+    .lora_baud = 460800,
+    .lora = {.sf = 7, .bw = 2, .cr = 1, .preamble = 8},
+    .fec = 0,
+    .compact = false,
+    .timeout_s = 60,
+};
+
+static uint8_t *src;
+static size_t src_len;
+
+/**
+ * @brief 시뮬레이터 수신기 UART (DMA circular)
+ *
+ * count 는 지금까지 DMA 가 쓴 byte 수 (gps_port_get_rx_count 와 같은 뜻).
+ */
+static struct {
+  pthread_mutex_t lock;
+  uint8_t *ring;
+  uint64_t count;
+  SemaphoreHandle_t sem; // IDLE/HT/TC
+  uint64_t *arr_us;      // byte 별 도착 시각
+  bool done;
+} uart = {.lock = PTHREAD_MUTEX_INITIALIZER};
+
+typedef struct {
+  uint8_t data[SIM_LORA_MAX_RAW];
+  size_t len;
+  lora_command_callback_t cb;
+  void *user_data;
+  uint64_t stamp_us; // fragment 에 담긴 가장 오래된 프레임의 도착 시각
+} sim_lora_cmd_t;
+
+static QueueHandle_t lora_queue;
+static gps_t gps;
+
+static struct {
+  uint64_t start_us;
+  uint64_t end_us;
+  uint64_t parse_count; // 이번 파싱 구간 시작의 count
+  size_t parse_from;    // 이번 파싱 구간 시작의 링 위치
+  uint64_t frame_us;    // 처리 중인 RTCM 프레임 도착 시각
+  uint64_t oldest_us;   // 아직 fragment 로 안 나간 가장 오래된 프레임 (0: 없음)
+  uint32_t rtcm_frames;
+  uint32_t queued;
+  uint32_t queue_full;
+  uint32_t sched_dropped;
+  uint32_t sent;
+  uint64_t air_us;
+  int64_t airtime_us;
+  uint64_t airtime_last_us;
+  uint32_t overruns;
+  volatile bool parsed_all;
+  uint32_t *lat_us;
+  size_t lat_cnt;
+  size_t lat_cap;
+} st;
+
+static uint64_t now_us(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+static void sleep_us(uint64_t us) {
+  struct timespec ts = {.tv_sec = (time_t)(us / 1000000u),
+                        .tv_nsec = (long)(us % 1000000u) * 1000L};
+  nanosleep(&ts, NULL);
+}
+
+/* ---- 수신기 UART ---- */
+
+/**
+ * @brief 캡처를 baud 속도로 링에 쓰고 IDLE/HT/TC 에서 수신 태스크를 깨움
+ *
+ * rate 가 있으면 period 마다 rate * period 만큼 몰아서 보내고 쉰다 (epoch 출력).
+ */
+static void uart_task(void *arg) {
+  size_t burst = cfg.rate ? (size_t)cfg.rate * cfg.period_ms / 1000u : src_len;
+  size_t half = cfg.ring / 2;
+  uint64_t next_burst = now_us();
+  size_t pos = 0;
+
+  (void)arg;
+
+  if (burst == 0) {
+    burst = 1;
+  }
+
+  while (pos < src_len) {
+    size_t start = pos;
+    size_t end = pos + burst < src_len ? pos + burst : src_len;
+    uint64_t t0 = now_us();
+
+    while (pos < end) {
+      sleep_us(SIM_STEP_US);
+
+      // 8N1 10 bit/byte
+      size_t due = start + (size_t)((now_us() - t0) * cfg.baud / 10u / 1000000u);
+      bool wake = false;
+
+      if (due > end) {
+        due = end;
+      }
+
+      pthread_mutex_lock(&uart.lock);
+      for (; pos < due; pos++) {
+        uart.ring[uart.count % cfg.ring] = src[pos];
+        uart.arr_us[pos] = t0 + (uint64_t)(pos - start + 1) * 10u * 1000000u / cfg.baud;
+        uart.count++;
+        if (uart.count % half == 0) {
+          wake = true; // HT/TC
+        }
+      }
+      pthread_mutex_unlock(&uart.lock);
+
+      if (wake) {
+        xSemaphoreGive(uart.sem);
+      }
+    }
+
+    // 한 문자 시간 쉬면 IDLE
+    sleep_us(10u * 1000000u / cfg.baud + 1);
+    xSemaphoreGive(uart.sem);
+
+    if (cfg.rate) {
+      next_burst += (uint64_t)cfg.period_ms * 1000u;
+      uint64_t now = now_us();
+      if (next_burst > now) {
+        sleep_us(next_burst - now);
+      }
+    }
+  }
+
+  pthread_mutex_lock(&uart.lock);
+  uart.done = true;
+  pthread_mutex_unlock(&uart.lock);
+  xSemaphoreGive(uart.sem);
+
+  // 태스크가 끝나면 CPU 시간을 못 읽으므로 남아 있는다
+  while (1) {
+    vTaskDelay(1000);
+  }
+}
+
+/* ---- GPS 수신 태스크 (gps_process_task 와 같은 흐름) ---- */
+
+/**
+ * @brief RTCM 프레임 (GPS_SUB_ANY): 도착 시각을 남기고 LoRa 로 보냄
+ */
+static void sim_on_rtcm(gps_t *g, gps_procotol_t protocol, gps_msg_t msg,
+                        void *ctx) {
+  size_t off = (size_t)(g->cur - g->ring);
+  uint64_t last;
+
+  (void)protocol;
+  (void)msg;
+  (void)ctx;
+
+  // 프레임 마지막 byte 의 누적 위치 (gps_app.c gps_frame_rx_count 와 같은 계산)
+  off = (off + g->ring_size - st.parse_from) % g->ring_size;
+  last = st.parse_count + off;
+
+  pthread_mutex_lock(&uart.lock);
+  st.frame_us = last < src_len ? uart.arr_us[last] : now_us();
+  pthread_mutex_unlock(&uart.lock);
+  if (st.oldest_us == 0) {
+    st.oldest_us = st.frame_us;
+  }
+
+  st.rtcm_frames++;
+  rtcm_send_to_lora(g);
+}
+
+static void gps_rx_task(void *arg) {
+  uint64_t consumed = 0;
+  size_t old_pos = 0;
+
+  (void)arg;
+
+  gps_subscribe(&gps, GPS_PROTOCOL_RTCM, GPS_SUB_ANY, sim_on_rtcm, NULL);
+
+  while (1) {
+    TickType_t wait = rtcm_epoch_poll();
+    uint64_t count;
+    bool done;
+
+    xSemaphoreTake(uart.sem, wait);
+
+    pthread_mutex_lock(&uart.lock);
+    count = uart.count;
+    done = uart.done;
+    pthread_mutex_unlock(&uart.lock);
+
+    xSemaphoreTake(gps.mutex, portMAX_DELAY);
+    uint64_t pending = count - consumed;
+
+    if (pending >= cfg.ring) {
+      uint64_t lost = pending - cfg.ring / 2;
+
+      st.overruns++;
+      gps_parse_overrun(&gps, (uint32_t)lost);
+      old_pos = (old_pos + lost) % cfg.ring;
+      consumed += lost;
+      pending -= lost;
+    }
+
+    if (pending > 0) {
+      size_t pos = (old_pos + pending) % cfg.ring;
+
+      st.parse_count = consumed;
+      st.parse_from = old_pos;
+      gps_parse_ring(&gps, uart.ring, cfg.ring, old_pos, pos);
+      old_pos = pos;
+      consumed += pending;
+    }
+    xSemaphoreGive(gps.mutex);
+
+    if (done && consumed == count) {
+      st.parsed_all = true;
+    }
+  }
+}
+
+/* ---- LoRa (lora_app.c 대신) ---- */
+
+static uint32_t lora_uart_us(size_t bytes) {
+  return (uint32_t)((uint64_t)bytes * 10u * 1000000u / cfg.lora_baud);
+}
+
+static void airtime_refill(void) {
+  uint64_t now = now_us();
+  int64_t budget = 1000LL * SIM_AIRTIME_PERMILLE;
+
+  st.airtime_us += (int64_t)(now - st.airtime_last_us) * SIM_AIRTIME_PERMILLE / 1000;
+  st.airtime_last_us = now;
+  if (st.airtime_us > budget) {
+    st.airtime_us = budget;
+  }
+}
+
+bool lora_send_p2p_raw_async(const uint8_t *data, size_t len, uint32_t timeout_ms,
+                             lora_command_callback_t callback, void *user_data) {
+  sim_lora_cmd_t cmd;
+
+  (void)timeout_ms;
+
+  if (!data || len == 0 || len > SIM_LORA_MAX_RAW) {
+    return false;
+  }
+
+  memcpy(cmd.data, data, len);
+  cmd.len = len;
+  cmd.cb = callback;
+  cmd.user_data = user_data;
+  cmd.stamp_us = st.oldest_us ? st.oldest_us : st.frame_us;
+
+  if (xQueueSend(lora_queue, &cmd, 0) != pdTRUE) {
+    st.queue_full++;
+    return false;
+  }
+
+  // 처리 중인 프레임의 남은 byte 는 다음 fragment 로 (epoch 끝이면 lora_stats_tx_queued 에서 비움)
+  st.oldest_us = st.frame_us;
+  st.queued++;
+  return true;
+}
+
+uint32_t lora_get_tx_queue_space(void) {
+  return (uint32_t)(SIM_LORA_QUEUE_SIZE - uxQueueMessagesWaiting(lora_queue));
+}
+
+uint32_t lora_get_p2p_toa_us(size_t len) {
+  return lora_calc_toa_us(&cfg.lora, len);
+}
+
+uint32_t lora_airtime_available_us(void) {
+  int64_t avail;
+
+  taskENTER_CRITICAL();
+  airtime_refill();
+  avail = st.airtime_us;
+  taskEXIT_CRITICAL();
+
+  return avail > 0 ? (uint32_t)avail : 0;
+}
+
+void lora_stats_tx_queued(bool queued, bool epoch_end) {
+  if (queued && epoch_end) {
+    st.oldest_us = 0;
+  }
+}
+
+void lora_stats_tx_done(bool success) { (void)success; }
+
+void lora_stats_tx_dropped(void) { st.sched_dropped++; }
+
+/**
+ * @brief LoRa TX 태스크: 명령 UART 전송 + ToA 동안 모듈이 바쁨
+ */
+static void lora_tx_task(void *arg) {
+  sim_lora_cmd_t cmd;
+
+  (void)arg;
+
+  while (1) {
+    if (xQueueReceive(lora_queue, &cmd, portMAX_DELAY) != pdTRUE) {
+      continue;
+    }
+
+    uint32_t busy = lora_uart_us(SIM_LORA_CMD_OVERHEAD + cmd.len * 2) +
+                    lora_get_p2p_toa_us(cmd.len);
+
+    taskENTER_CRITICAL();
+    airtime_refill();
+    st.airtime_us -= busy;
+    taskEXIT_CRITICAL();
+
+    sleep_us(busy);
+
+    uint64_t now = now_us();
+    if (st.lat_cnt == st.lat_cap) {
+      st.lat_cap = st.lat_cap ? st.lat_cap * 2 : 1024;
+      st.lat_us = realloc(st.lat_us, st.lat_cap * sizeof(*st.lat_us));
+    }
+    st.lat_us[st.lat_cnt++] = (uint32_t)(now - cmd.stamp_us);
+    st.air_us += busy;
+    st.sent++;
+
+    if (cmd.cb) {
+      cmd.cb(true, cmd.user_data);
+    }
+  }
+}
+
+/* ---- 측정 ---- */
+
+static int cmp_u32(const void *a, const void *b) {
+  uint32_t x = *(const uint32_t *)a;
+  uint32_t y = *(const uint32_t *)b;
+  return (x > y) - (x < y);
+}
+
+static void report(void) {
+  uint64_t end = st.end_us ? st.end_us : now_us();
+  double sec = (double)(end - st.start_us) / 1e6;
+
+  if (sec <= 0) {
+    sec = 1e-6;
+  }
+
+  printf("== %u baud, rate %u B/s per %u ms, ring %zu, LoRa SF%u BW%u, "
+         "fec %u%s\n",
+         cfg.baud, cfg.rate, cfg.period_ms, cfg.ring, cfg.lora.sf, cfg.lora.bw,
+         cfg.fec, cfg.compact ? ", MSM4" : "");
+  printf("rx   %zu bytes in %.2f s, RTCM frames %u, ring overruns %u\n", src_len,
+         sec, st.rtcm_frames, st.overruns);
+  printf("lora queued %u sent %u, queue full %u, scheduler dropped %u, "
+         "busy %.1f%%\n",
+         st.queued, st.sent, st.queue_full, st.sched_dropped,
+         (double)st.air_us / 1e4 / sec);
+
+  if (st.lat_cnt) {
+    uint64_t sum = 0;
+
+    qsort(st.lat_us, st.lat_cnt, sizeof(*st.lat_us), cmp_u32);
+    for (size_t i = 0; i < st.lat_cnt; i++) {
+      sum += st.lat_us[i];
+    }
+    printf("lat  min %.1f avg %.1f p50 %.1f p99 %.1f max %.1f ms (n=%zu)\n",
+           st.lat_us[0] / 1000.0, (double)sum / st.lat_cnt / 1000.0,
+           st.lat_us[st.lat_cnt / 2] / 1000.0,
+           st.lat_us[st.lat_cnt * 99 / 100] / 1000.0,
+           st.lat_us[st.lat_cnt - 1] / 1000.0, st.lat_cnt);
+  }
+
+  sim_shim_report(sec);
+}
+
+static uint8_t *load_capture(const char *path, size_t *len) {
+  FILE *fp = fopen(path, "rb");
+  if (!fp) {
+    perror(path);
+    return NULL;
+  }
+
+  fseek(fp, 0, SEEK_END);
+  long size = ftell(fp);
+  fseek(fp, 0, SEEK_SET);
+
+  uint8_t *buf = NULL;
+  if (size > 0) {
+    buf = malloc((size_t)size);
+  }
+  if (!buf || fread(buf, 1, (size_t)size, fp) != (size_t)size) {
+    fprintf(stderr, "%s: read failed\n", path);
+    free(buf);
+    fclose(fp);
+    return NULL;
+  }
+
+  fclose(fp);
+  *len = (size_t)size;
+  return buf;
+}
+
+int main(int argc, char **argv) {
+  const char *path = NULL;
+  int i = 1;
+
+  for (; i < argc; i++) {
+    const char *o = argv[i];
+    const char *v = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+    if (o[0] != '-') {
+      path = o;
+      continue;
+    }
+    if (!strcmp(o, "-C")) {
+      cfg.compact = true;
+      continue;
+    }
+    if (!v) {
+      break;
+    }
+    i++;
+    if (!strcmp(o, "-b")) {
+      cfg.baud = (uint32_t)atol(v);
+    } else if (!strcmp(o, "-r")) {
+      cfg.rate = (uint32_t)atol(v);
+    } else if (!strcmp(o, "-p")) {
+      cfg.period_ms = (uint32_t)atol(v);
+    } else if (!strcmp(o, "-R")) {
+      cfg.ring = (size_t)atol(v);
+    } else if (!strcmp(o, "-s")) {
+      cfg.lora.sf = (uint8_t)atoi(v);
+    } else if (!strcmp(o, "-w")) {
+      cfg.lora.bw = (uint8_t)atoi(v);
+    } else if (!strcmp(o, "-L")) {
+      cfg.lora_baud = (uint32_t)atol(v);
+    } else if (!strcmp(o, "-f")) {
+      cfg.fec = (uint8_t)atoi(v);
+    } else if (!strcmp(o, "-t")) {
+      cfg.timeout_s = (uint32_t)atol(v);
+    } else {
+      break;
+    }
+  }
+
+  if (i < argc || !path || cfg.baud == 0 || cfg.lora_baud == 0 ||
+      cfg.period_ms == 0 || cfg.ring < 64 || (cfg.ring & (cfg.ring - 1)) ||
+      lora_calc_toa_us(&cfg.lora, 1) == 0 || !rtcm_set_fec_group(cfg.fec)) {
+    fprintf(stderr,
+            "usage: %s [-b baud] [-r rate] [-p period_ms] [-R ring] [-s sf] "
+            "[-w bw] [-L lora_baud] [-f fec] [-C] [-t sec] base_capture.bin\n",
+            argv[0]);
+    return 1;
+  }
+
+  src = load_capture(path, &src_len);
+  if (!src) {
+    return 1;
+  }
+
+  uart.ring = calloc(1, cfg.ring);
+  uart.arr_us = calloc(src_len, sizeof(*uart.arr_us));
+  uart.sem = xSemaphoreCreateBinary();
+  lora_queue = xQueueCreate(SIM_LORA_QUEUE_SIZE, sizeof(sim_lora_cmd_t));
+  if (!uart.ring || !uart.arr_us || !uart.sem || !lora_queue) {
+    return 1;
+  }
+  vQueueAddToRegistry(lora_queue, "lora_cmd");
+
+  gps_init(&gps);
+  rtcm_set_msm_compact(cfg.compact);
+  rtcm_tx_task_init();
+
+  st.start_us = now_us();
+  st.airtime_last_us = st.start_us;
+  st.airtime_us = 1000LL * SIM_AIRTIME_PERMILLE;
+
+  xTaskCreate(lora_tx_task, "lora_tx", 0, NULL, 0, NULL);
+  xTaskCreate(gps_rx_task, "gps_rx", 0, NULL, 0, NULL);
+  xTaskCreate(uart_task, "gnss_uart", 0, NULL, 0, NULL);
+
+  uint64_t deadline = st.start_us + (uint64_t)cfg.timeout_s * 1000000u;
+
+  // 캡처를 다 파싱하고 epoch 묶음 타임아웃이 지난 뒤 LoRa 큐가 빌 때까지
+  uint64_t parsed_us = 0;
+
+  while (now_us() < deadline) {
+    if (st.parsed_all && !parsed_us) {
+      parsed_us = now_us();
+    }
+    if (parsed_us && now_us() - parsed_us > 200000u &&
+        uxQueueMessagesWaiting(lora_queue) == 0 && st.sent == st.queued) {
+      break;
+    }
+    vTaskDelay(10);
+  }
+  st.end_us = now_us();
+
+  report();
+  return 0;
+}
@@ -0,0 +1,530 @@
+#include "cmux.h"
+#include <string.h>
+
+// 수신 상태
+enum {
+  RX_HUNT = 0, ///< 여는 flag 찾기 (그 전 바이트는 raw)
+  RX_ADDR,
+  RX_CTRL,
+  RX_LEN,
+  RX_LEN2,
+  RX_INFO,
+  RX_FCS,
+  RX_END,
+};
+
+// DLC 0 제어 메시지 종류 (EA 포함, C/R 제외)
+#define CMUX_MSG_CR 0x02
+#define CMUX_MSG_PSC 0x41
+#define CMUX_MSG_CLD 0xC1
+#define CMUX_MSG_TEST 0x21
+#define CMUX_MSG_FCON 0xA1
+#define CMUX_MSG_FCOFF 0x61
+#define CMUX_MSG_MSC 0xE1
+#define CMUX_MSG_NSC 0x11
+
+#define CMUX_FCS_GOOD 0xCF // FCS 까지 넣고 계산한 나머지
+
+static uint8_t cmux_crc(uint8_t crc, const uint8_t *p, size_t len) {
+  while (len--) {
+    crc ^= *p++;
+    for (int i = 0; i < 8; i++) {
+      crc = (crc & 1) ? (uint8_t)((crc >> 1) ^ 0xE0) : (uint8_t)(crc >> 1);
+    }
+  }
+  return crc;
+}
+
+static bool cmux_is_uih(uint8_t ctrl) {
+  ctrl &= (uint8_t)~CMUX_PF;
+  return ctrl == CMUX_UIH || ctrl == CMUX_UI;
+}
+
+/**
+ * @brief 헤더 (여는 flag ~ 길이) 만들기
+ *
+ * @param cr 주소 C/R (우리 명령과 UIH 는 1, 모뎀 명령에 대한 응답은 0)
+ * @return 헤더 길이
+ */
+static size_t cmux_header(uint8_t *hdr, uint8_t dlci, bool cr, uint8_t ctrl,
+                          size_t len) {
+  size_t n = 0;
+
+  hdr[n++] = CMUX_FLAG;
+  hdr[n++] = (uint8_t)((dlci << 2) | (cr ? 0x02 : 0) | 0x01);
+  hdr[n++] = ctrl;
+  if (len < 128) {
+    hdr[n++] = (uint8_t)((len << 1) | 0x01);
+  } else {
+    hdr[n++] = (uint8_t)((len & 0x7F) << 1);
+    hdr[n++] = (uint8_t)(len >> 7);
+  }
+  return n;
+}
+
+static int cmux_send_frame(cmux_t *mux, uint8_t dlci, bool cr, uint8_t ctrl,
+                           const void *info, size_t len) {
+  uint8_t hdr[CMUX_HDR_MAX];
+  uint8_t tail[2];
+  cmux_seg_t seg[3];
+  size_t cnt = 0;
+  size_t n = cmux_header(hdr, dlci, cr, ctrl, len);
+  uint8_t crc = cmux_crc(0xFF, &hdr[1], n - 1);
+
+  if (!cmux_is_uih(ctrl) && len) {
+    crc = cmux_crc(crc, info, len);
+  }
+  tail[0] = (uint8_t)(0xFF - crc);
+  tail[1] = CMUX_FLAG;
+
+  seg[cnt++] = (cmux_seg_t){hdr, n};
+  if (len) {
+    seg[cnt++] = (cmux_seg_t){info, len};
+  }
+  seg[cnt++] = (cmux_seg_t){tail, sizeof(tail)};
+
+  if (mux->ops->write(mux->ctx, seg, cnt) != 0) {
+    return -1;
+  }
+
+  mux->dlc[dlci].tx_frames++;
+  mux->dlc[dlci].tx_bytes += len;
+  return 0;
+}
+
+/**
+ * @brief DLC 0 제어 메시지 송신
+ *
+ * @param cmd true: 명령, false: 모뎀 명령에 대한 응답
+ */
+static int cmux_send_msg(cmux_t *mux, uint8_t type, bool cmd,
+                         const uint8_t *val, uint8_t len) {
+  uint8_t msg[2 + 8];
+
+  if (len > sizeof(msg) - 2) {
+    len = sizeof(msg) - 2;
+  }
+  msg[0] = (uint8_t)(type | (cmd ? CMUX_MSG_CR : 0));
+  msg[1] = (uint8_t)((len << 1) | 0x01);
+  if (len) {
+    memcpy(&msg[2], val, len);
+  }
+
+  return cmux_send_frame(mux, 0, true, CMUX_UIH, msg, (size_t)len + 2);
+}
+
+static void cmux_event(cmux_t *mux, uint8_t dlci, cmux_evt_t evt) {
+  if (mux->ops->event) {
+    mux->ops->event(mux->ctx, dlci, evt);
+  }
+}
+
+/**
+ * @brief 모든 DLC 닫힘 처리 (CLD, DLC 0 DISC, cmux_stop)
+ */
+static void cmux_close_all(cmux_t *mux) {
+  mux->active = false;
+  mux->fc = false;
+  mux->rx_state = RX_HUNT;
+
+  for (uint8_t i = 0; i < CMUX_DLC_MAX; i++) {
+    cmux_dlc_state_t prev = mux->dlc[i].state;
+
+    mux->dlc[i].state = CMUX_DLC_CLOSED;
+    mux->dlc[i].v24 = 0;
+    if (prev != CMUX_DLC_CLOSED) {
+      cmux_event(mux, i, CMUX_EVT_CLOSED);
+    }
+  }
+}
+
+/**
+ * @brief DLC 0 UIH 안의 제어 메시지들 처리
+ */
+static void cmux_control(cmux_t *mux, const uint8_t *p, size_t len) {
+  size_t pos = 0;
+
+  while (pos + 2 <= len) {
+    uint8_t type = p[pos++];
+    size_t mlen = p[pos] >> 1;
+
+    if (!(p[pos++] & 0x01)) {
+      if (pos >= len) {
+        return;
+      }
+      mlen |= (size_t)p[pos++] << 7;
+    }
+    if (pos + mlen > len) {
+      return;
+    }
+
+    const uint8_t *v = &p[pos];
+    pos += mlen;
+
+    if (!(type & CMUX_MSG_CR)) {
+      continue; // 우리 명령에 대한 응답
+    }
+    type &= (uint8_t)~CMUX_MSG_CR;
+
+    switch (type) {
+    case CMUX_MSG_MSC:
+      if (mlen >= 2 && (v[0] >> 2) < CMUX_DLC_MAX) {
+        cmux_dlc_t *d = &mux->dlc[v[0] >> 2];
+        uint8_t prev = d->v24;
+
+        d->v24 = v[1];
+        cmux_send_msg(mux, type, false, v, 2);
+        if (prev != d->v24) {
+          cmux_event(mux, v[0] >> 2, CMUX_EVT_V24);
+        }
+      }
+      break;
+
+    case CMUX_MSG_FCON:
+    case CMUX_MSG_FCOFF:
+      mux->fc = type == CMUX_MSG_FCOFF;
+      cmux_send_msg(mux, type, false, NULL, 0);
+      break;
+
+    case CMUX_MSG_TEST:
+    case CMUX_MSG_PSC:
+      cmux_send_msg(mux, type, false, v, (uint8_t)(mlen < 8 ? mlen : 8));
+      break;
+
+    case CMUX_MSG_CLD:
+      cmux_send_msg(mux, type, false, NULL, 0);
+      cmux_close_all(mux);
+      return;
+
+    default: {
+      uint8_t t = (uint8_t)(type | CMUX_MSG_CR);
+      cmux_send_msg(mux, CMUX_MSG_NSC, false, &t, 1);
+      break;
+    }
+    }
+  }
+}
+
+/**
+ * @brief FCS 가 맞는 프레임 하나 처리
+ */
+static void cmux_frame(cmux_t *mux) {
+  uint8_t dlci = mux->hdr[0] >> 2;
+  uint8_t ctrl = mux->hdr[1] & (uint8_t)~CMUX_PF;
+  cmux_dlc_t *d = &mux->dlc[dlci];
+
+  d->rx_frames++;
+
+  switch (ctrl) {
+  case CMUX_UA:
+    if (d->state == CMUX_DLC_OPENING) {
+      d->state = CMUX_DLC_OPEN;
+      cmux_event(mux, dlci, CMUX_EVT_OPEN);
+    } else if (d->state == CMUX_DLC_CLOSING) {
+      d->state = CMUX_DLC_CLOSED;
+      cmux_event(mux, dlci, CMUX_EVT_CLOSED);
+      if (dlci == 0) {
+        cmux_close_all(mux);
+      }
+    }
+    break;
+
+  case CMUX_DM:
+    if (d->state == CMUX_DLC_OPENING) {
+      d->state = CMUX_DLC_CLOSED;
+      cmux_event(mux, dlci, CMUX_EVT_REFUSED);
+    } else if (d->state != CMUX_DLC_CLOSED) {
+      d->state = CMUX_DLC_CLOSED;
+      cmux_event(mux, dlci, CMUX_EVT_CLOSED);
+    }
+    break;
+
+  case CMUX_SABM:
+    cmux_send_frame(mux, dlci, false, CMUX_UA | CMUX_PF, NULL, 0);
+    if (d->state != CMUX_DLC_OPEN) {
+      d->state = CMUX_DLC_OPEN;
+      cmux_event(mux, dlci, CMUX_EVT_OPEN);
+    }
+    break;
+
+  case CMUX_DISC:
+    cmux_send_frame(mux, dlci, false, CMUX_UA | CMUX_PF, NULL, 0);
+    if (dlci == 0) {
+      cmux_close_all(mux);
+    } else if (d->state != CMUX_DLC_CLOSED) {
+      d->state = CMUX_DLC_CLOSED;
+      cmux_event(mux, dlci, CMUX_EVT_CLOSED);
+    }
+    break;
+
+  case CMUX_UIH:
+  case CMUX_UI:
+    d->rx_bytes += mux->info_len;
+    if (dlci == 0) {
+      cmux_control(mux, mux->info, mux->info_len);
+    } else if (mux->info_len && mux->ops->recv) {
+      mux->ops->recv(mux->ctx, dlci, mux->info, mux->info_len);
+    }
+    break;
+
+  default:
+    mux->stats.bad_frame++;
+    break;
+  }
+}
+
+/**
+ * @brief 헤더가 맞지 않을 때 지금까지 모은 바이트를 raw 로 돌리고 flag 찾기
+ */
+static void cmux_rx_reject(cmux_t *mux, uint8_t b) {
+  uint8_t buf[CMUX_HDR_MAX];
+  size_t n = mux->hdr_len;
+
+  memcpy(buf, mux->hdr, n);
+  buf[n++] = b;
+  mux->stats.raw_bytes += n;
+  if (mux->ops->raw) {
+    mux->ops->raw(mux->ctx, buf, n);
+  }
+  mux->rx_state = RX_HUNT;
+}
+
+void cmux_init(cmux_t *mux, const cmux_ops_t *ops, void *ctx, uint16_t n1) {
+  memset(mux, 0, sizeof(*mux));
+  mux->ops = ops;
+  mux->ctx = ctx;
+  mux->n1 = n1 == 0 || n1 > CMUX_INFO_MAX ? CMUX_INFO_MAX : n1;
+  mux->rx_state = RX_HUNT;
+}
+
+void cmux_start(cmux_t *mux) {
+  for (uint8_t i = 0; i < CMUX_DLC_MAX; i++) {
+    mux->dlc[i].state = CMUX_DLC_CLOSED;
+    mux->dlc[i].v24 = 0;
+  }
+  mux->fc = false;
+  mux->rx_state = RX_HUNT;
+  mux->active = true;
+}
+
+void cmux_stop(cmux_t *mux, bool send) {
+  if (!mux->active) {
+    return;
+  }
+  if (send) {
+    cmux_send_msg(mux, CMUX_MSG_CLD, true, NULL, 0);
+  }
+  cmux_close_all(mux);
+}
+
+void cmux_input(cmux_t *mux, const uint8_t *data, size_t len) {
+  const uint8_t *d = data;
+  const uint8_t *end = data + len;
+
+  if (!mux->active) {
+    if (len && mux->ops->raw) {
+      mux->ops->raw(mux->ctx, data, len);
+    }
+    return;
+  }
+
+  while (d < end) {
+    uint8_t b;
+
+    switch (mux->rx_state) {
+    case RX_HUNT: {
+      // flag 전까지는 한 번에 raw 로
+      const uint8_t *f = memchr(d, CMUX_FLAG, (size_t)(end - d));
+      const uint8_t *stop = f ? f : end;
+
+      if (stop > d) {
+        mux->stats.raw_bytes += (uint32_t)(stop - d);
+        if (mux->ops->raw) {
+          mux->ops->raw(mux->ctx, d, (size_t)(stop - d));
+        }
+      }
+      d = stop;
+      if (f) {
+        d++;
+        mux->rx_state = RX_ADDR;
+      }
+      break;
+    }
+
+    case RX_ADDR:
+      b = *d++;
+      mux->hdr_len = 0;
+      if (b == CMUX_FLAG) {
+        break; // 연속 flag
+      }
+      if (!(b & 0x01) || (b >> 2) >= CMUX_DLC_MAX) {
+        cmux_rx_reject(mux, b);
+        break;
+      }
+      mux->hdr[mux->hdr_len++] = b;
+      mux->rx_state = RX_CTRL;
+      break;
+
+    case RX_CTRL: {
+      uint8_t t;
+
+      b = *d++;
+      t = b & (uint8_t)~CMUX_PF;
+      if (t != CMUX_SABM && t != CMUX_UA && t != CMUX_DM && t != CMUX_DISC &&
+          t != CMUX_UIH && t != CMUX_UI) {
+        cmux_rx_reject(mux, b);
+        break;
+      }
+      mux->hdr[mux->hdr_len++] = b;
+      mux->rx_state = RX_LEN;
+      break;
+    }
+
+    case RX_LEN:
+      b = *d++;
+      mux->hdr[mux->hdr_len++] = b;
+      mux->info_len = b >> 1;
+      mux->info_pos = 0;
+      if (!(b & 0x01)) {
+        mux->rx_state = RX_LEN2;
+      } else {
+        mux->rx_state = mux->info_len ? RX_INFO : RX_FCS;
+      }
+      break;
+
+    case RX_LEN2:
+      b = *d++;
+      mux->hdr[mux->hdr_len++] = b;
+      mux->info_len |= (uint16_t)(b << 7);
+      if (mux->info_len > CMUX_INFO_MAX) {
+        mux->stats.too_long++;
+        mux->rx_state = RX_HUNT;
+        break;
+      }
+      mux->rx_state = mux->info_len ? RX_INFO : RX_FCS;
+      break;
+
+    case RX_INFO: {
+      size_t n = (size_t)(mux->info_len - mux->info_pos);
+
+      if (n > (size_t)(end - d)) {
+        n = (size_t)(end - d);
+      }
+      memcpy(&mux->info[mux->info_pos], d, n);
+      mux->info_pos += (uint16_t)n;
+      d += n;
+      if (mux->info_pos >= mux->info_len) {
+        mux->rx_state = RX_FCS;
+      }
+      break;
+    }
+
+    case RX_FCS: {
+      uint8_t crc = cmux_crc(0xFF, mux->hdr, mux->hdr_len);
+
+      if (!cmux_is_uih(mux->hdr[1])) {
+        crc = cmux_crc(crc, mux->info, mux->info_len);
+      }
+      b = *d++;
+      crc = cmux_crc(crc, &b, 1);
+      // 맞지 않으면 닫는 flag 에서 버린다
+      mux->hdr_len = crc == CMUX_FCS_GOOD ? mux->hdr_len : 0;
+      mux->rx_state = RX_END;
+      break;
+    }
+
+    case RX_END:
+      b = *d++;
+      if (b != CMUX_FLAG) {
+        mux->stats.bad_frame++;
+        mux->rx_state = RX_HUNT;
+        break;
+      }
+      // 닫는 flag 는 다음 프레임의 여는 flag 도 된다
+      mux->rx_state = RX_ADDR;
+      if (mux->hdr_len == 0) {
+        mux->stats.fcs_err++;
+        break;
+      }
+      cmux_frame(mux);
+      break;
+
+    default:
+      mux->rx_state = RX_HUNT;
+      break;
+    }
+  }
+}
+
+int cmux_open(cmux_t *mux, uint8_t dlci) {
+  if (!mux->active || dlci >= CMUX_DLC_MAX ||
+      mux->dlc[dlci].state == CMUX_DLC_OPEN ||
+      mux->dlc[dlci].state == CMUX_DLC_OPENING) {
+    return -1;
+  }
+
+  mux->dlc[dlci].state = CMUX_DLC_OPENING;
+  if (cmux_send_frame(mux, dlci, true, CMUX_SABM | CMUX_PF, NULL, 0) != 0) {
+    mux->dlc[dlci].state = CMUX_DLC_CLOSED;
+    return -1;
+  }
+  return 0;
+}
+
+int cmux_close(cmux_t *mux, uint8_t dlci) {
+  if (!mux->active || dlci >= CMUX_DLC_MAX ||
+      mux->dlc[dlci].state == CMUX_DLC_CLOSED) {
+    return -1;
+  }
+
+  mux->dlc[dlci].state = CMUX_DLC_CLOSING;
+  return cmux_send_frame(mux, dlci, true, CMUX_DISC | CMUX_PF, NULL, 0);
+}
+
+int cmux_write(cmux_t *mux, uint8_t dlci, const void *data, size_t len) {
+  const uint8_t *p = data;
+
+  if (!mux->active || dlci == 0 || dlci >= CMUX_DLC_MAX ||
+      mux->dlc[dlci].state != CMUX_DLC_OPEN) {
+    return -1;
+  }
+
+  while (len > 0) {
+    size_t n = len < mux->n1 ? len : mux->n1;
+
+    if (cmux_send_frame(mux, dlci, true, CMUX_UIH, p, n) != 0) {
+      return -1;
+    }
+    p += n;
+    len -= n;
+  }
+  return 0;
+}
+
+int cmux_msc(cmux_t *mux, uint8_t dlci, uint8_t v24) {
+  uint8_t v[2];
+
+  if (!mux->active || dlci >= CMUX_DLC_MAX) {
+    return -1;
+  }
+
+  v[0] = (uint8_t)((dlci << 2) | 0x02 | 0x01);
+  v[1] = (uint8_t)(v24 | 0x01);
+  return cmux_send_msg(mux, CMUX_MSG_MSC, true, v, sizeof(v));
+}
+
+bool cmux_writable(const cmux_t *mux, uint8_t dlci) {
+  return mux->active && !mux->fc && dlci < CMUX_DLC_MAX &&
+         mux->dlc[dlci].state == CMUX_DLC_OPEN &&
+         !(mux->dlc[dlci].v24 & CMUX_V24_FC);
+}
+
+size_t cmux_frame_cld(uint8_t *buf) {
+  static const uint8_t msg[2] = {CMUX_MSG_CLD | CMUX_MSG_CR, 0x01};
+  size_t n = cmux_header(buf, 0, true, CMUX_UIH, sizeof(msg));
+
+  memcpy(&buf[n], msg, sizeof(msg));
+  buf[n + 2] = (uint8_t)(0xFF - cmux_crc(0xFF, &buf[1], n - 1));
+  buf[n + 3] = CMUX_FLAG;
+  return n + 4;
+}
@@ -0,0 +1,168 @@
+#ifndef CMUX_H
+#define CMUX_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief 3GPP TS 27.010 basic option 다중화 (UART 하나에 가상 채널 여러 개)
+ *
+ * 프레임: F9 | addr | ctrl | len (1~2) | info | FCS | F9
+ *   addr = DLCI << 2 | C/R << 1 | EA
+ *   FCS  = CRC-8 (다항식 0x07 반사, init 0xFF, 보수), UIH 는 addr~len 만
+ *
+ * DLC 0 은 제어 채널이라 MSC/FC/CLD 같은 제어 메시지만 오간다. 우리가
+ * initiator 라 명령은 C/R 1, 모뎀 명령에 대한 응답은 C/R 0 으로 보낸다.
+ *
+ * 모든 상태는 인스턴스에 있고 RTOS 를 쓰지 않는다. cmux_input 은 한
+ * 태스크에서만 부르고, 송신 함수는 ops->write 가 프레임 하나를 끊기지 않게
+ * 내보내면 여러 태스크에서 불러도 된다 (통계는 잠그지 않음).
+ */
+#define CMUX_FLAG 0xF9
+#define CMUX_DLC_MAX 4       ///< DLC 0 (제어) + 1~3
+#define CMUX_INFO_MAX 512    ///< 받을 수 있는 최대 info 길이 (AT+CMUX N1)
+#define CMUX_HDR_MAX 5       ///< F9 addr ctrl len len
+
+// 프레임 종류 (P/F 비트 제외)
+#define CMUX_SABM 0x2F
+#define CMUX_UA 0x63
+#define CMUX_DM 0x0F
+#define CMUX_DISC 0x43
+#define CMUX_UIH 0xEF
+#define CMUX_UI 0x03
+#define CMUX_PF 0x10
+
+// MSC V.24 신호 (EA 비트 포함)
+#define CMUX_V24_FC 0x02  ///< 흐름 제어 (1: 받을 수 없음)
+#define CMUX_V24_RTC 0x04 ///< DTR/DSR
+#define CMUX_V24_RTR 0x08 ///< RTS/CTS
+#define CMUX_V24_RI 0x40
+#define CMUX_V24_DV 0x80  ///< DCD (데이터 연결 있음)
+
+typedef enum {
+  CMUX_DLC_CLOSED = 0,
+  CMUX_DLC_OPENING, ///< SABM 보냄, UA 대기
+  CMUX_DLC_OPEN,
+  CMUX_DLC_CLOSING, ///< DISC 보냄
+} cmux_dlc_state_t;
+
+typedef enum {
+  CMUX_EVT_OPEN = 0, ///< UA 로 열림
+  CMUX_EVT_REFUSED,  ///< SABM 에 DM
+  CMUX_EVT_CLOSED,   ///< DISC/DM/CLD 로 닫힘
+  CMUX_EVT_V24,      ///< 모뎀 MSC 로 V.24 신호가 바뀜
+} cmux_evt_t;
+
+typedef struct {
+  const void *data;
+  size_t len;
+} cmux_seg_t;
+
+typedef struct {
+  /// 프레임 하나 (seg 1~3 개) 송신, 다른 프레임과 섞이지 않아야 한다
+  int (*write)(void *ctx, const cmux_seg_t *seg, size_t cnt);
+  /// DLC 1~ 의 UIH 데이터
+  void (*recv)(void *ctx, uint8_t dlci, const uint8_t *data, size_t len);
+  /// 프레임 밖에서 받은 바이트 (모뎀이 다중화를 끝낸 뒤의 RDY 등)
+  void (*raw)(void *ctx, const uint8_t *data, size_t len);
+  void (*event)(void *ctx, uint8_t dlci, cmux_evt_t evt);
+} cmux_ops_t;
+
+typedef struct {
+  cmux_dlc_state_t state;
+  uint8_t v24; ///< 모뎀이 마지막 MSC 로 보낸 신호
+  uint32_t rx_frames;
+  uint32_t tx_frames;
+  uint32_t rx_bytes; ///< info byte
+  uint32_t tx_bytes;
+} cmux_dlc_t;
+
+typedef struct {
+  uint32_t fcs_err;   ///< FCS 불일치로 버린 프레임
+  uint32_t too_long;  ///< CMUX_INFO_MAX 를 넘어 버린 프레임
+  uint32_t bad_frame; ///< 닫는 flag 없음, 모르는 DLCI/종류
+  uint32_t raw_bytes; ///< 프레임 밖 바이트 (flag 제외)
+} cmux_stats_t;
+
+typedef struct {
+  const cmux_ops_t *ops;
+  void *ctx;
+  uint16_t n1; ///< 보낼 info 최대 길이 (AT+CMUX 에 준 값)
+  bool active; ///< 모뎀이 다중화 중 (AT+CMUX OK 이후)
+  bool fc;     ///< 모뎀이 FCoff 로 전체 송신을 멈춤
+
+  cmux_dlc_t dlc[CMUX_DLC_MAX];
+  cmux_stats_t stats;
+
+  // 수신 상태 (cmux_input 만 씀)
+  uint8_t rx_state;
+  uint8_t hdr[CMUX_HDR_MAX - 1]; ///< addr ctrl len [len]
+  uint8_t hdr_len;
+  uint16_t info_len;
+  uint16_t info_pos;
+  uint8_t info[CMUX_INFO_MAX];
+} cmux_t;
+
+/**
+ * @brief 인스턴스 초기화 (다중화는 cmux_start 전까지 꺼짐)
+ *
+ * @param n1 보낼 info 최대 길이 (CMUX_INFO_MAX 이하로 잘림)
+ */
+void cmux_init(cmux_t *mux, const cmux_ops_t *ops, void *ctx, uint16_t n1);
+
+/**
+ * @brief 다중화 시작 (AT+CMUX OK 뒤) - 이후 입력은 프레임으로 푼다
+ */
+void cmux_start(cmux_t *mux);
+
+/**
+ * @brief 다중화 끝 (모든 DLC 닫힘, 이후 입력은 raw)
+ *
+ * @param send true: 모뎀에 CLD 를 보낸다, false: 모뎀이 이미 리셋됨
+ */
+void cmux_stop(cmux_t *mux, bool send);
+
+/**
+ * @brief 수신 chunk 처리 (chunk 경계는 어디든 됨)
+ */
+void cmux_input(cmux_t *mux, const uint8_t *data, size_t len);
+
+/**
+ * @brief DLC 열기 (SABM), 결과는 CMUX_EVT_OPEN/REFUSED
+ *
+ * @return 0: 보냄, -1: 잘못된 DLCI 또는 이미 열림/여는 중
+ */
+int cmux_open(cmux_t *mux, uint8_t dlci);
+
+/**
+ * @brief DLC 닫기 (DISC)
+ */
+int cmux_close(cmux_t *mux, uint8_t dlci);
+
+/**
+ * @brief UIH 로 데이터 송신 (n1 단위로 나눔)
+ *
+ * @return 0: 성공, -1: DLC 가 열려 있지 않거나 write 실패
+ */
+int cmux_write(cmux_t *mux, uint8_t dlci, const void *data, size_t len);
+
+/**
+ * @brief MSC 로 우리 쪽 V.24 신호 알림
+ */
+int cmux_msc(cmux_t *mux, uint8_t dlci, uint8_t v24);
+
+/**
+ * @brief DLC 가 데이터를 받을 수 있는지 (열림, FC/FCoff 아님)
+ */
+bool cmux_writable(const cmux_t *mux, uint8_t dlci);
+
+/**
+ * @brief 다중화 종료 (CLD) 프레임 만들기 (인스턴스 없이, 부팅 직후 정리용)
+ *
+ * @param buf 최소 8 byte
+ * @return 프레임 길이
+ */
+size_t cmux_frame_cld(uint8_t *buf);
+
+#endif
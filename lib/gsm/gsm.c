@@ -1,7 +1,14 @@
 #include "gsm.h"
 #include "parser.h" // parser.c 함수 사용
+#if GSM_PPP_ENABLE
+#include "gsm_ppp.h"
+#endif
+#include "mem_section.h"
+#include "simd.h"
+#include "heap_track.h"
+#include "dma_copy.h"
+#include "trace_marker.h"
 #include "stm32f4xx_hal.h"
-#include "stm32f4xx_ll_usart.h"
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
@@ -15,6 +22,11 @@
 #define IS_ASCII(x) (((x) >= 32 && (x) <= 126) || (x) == '\r' || (x) == '\n')
 
 void handle_urc_qcfg(gsm_t *gsm, const char *data, size_t len);
+static bool tcp_deliver(gsm_t *gsm, uint8_t cid, const uint8_t *data,
+                        size_t len);
+static bool gsm_mux_connect(gsm_t *gsm);
+static uint8_t gsm_mux_alloc(gsm_t *gsm, uint8_t cid);
+static void gsm_mux_release(gsm_t *gsm, gsm_tcp_socket_t *socket);
 
 void handle_urc_rdy(gsm_t *gsm, const char *data, size_t len)
 {
@@ -38,7 +50,54 @@ void handle_urc_powered_down(gsm_t *gsm, const char *data, size_t len)
 
 void handle_urc_cmee(gsm_t *gsm, const char *data, size_t len)
 {
+  if (gsm->current_cmd && gsm->current_cmd->cmd == GSM_CMD_PROBE)
+  {
+    const char *p = data;
+    gsm->current_cmd->msg.probe.cmee = parse_uint32(&p);
+  }
+}
 
+/**
+ * @brief +CGATT 응답 핸들러 (상태 일괄 조회 전용)
+ * 형식: +CGATT: <state>
+ */
+void handle_urc_cgatt(gsm_t *gsm, const char *data, size_t len) {
+  if (gsm->current_cmd && gsm->current_cmd->cmd == GSM_CMD_PROBE) {
+    const char *p = data;
+    gsm->current_cmd->msg.probe.cgatt = parse_uint32(&p);
+  }
+}
+
+/**
+ * @brief +CGACT 응답 핸들러 (상태 일괄 조회 전용, context 마다 한 줄)
+ * 형식: +CGACT: <cid>,<state>
+ */
+void handle_urc_cgact(gsm_t *gsm, const char *data, size_t len) {
+  if (gsm->current_cmd && gsm->current_cmd->cmd == GSM_CMD_PROBE) {
+    const char *p = data;
+    uint32_t cid = parse_uint32(&p);
+    uint32_t state = parse_uint32(&p);
+
+    if (cid < 8 && state == 1) {
+      gsm->current_cmd->msg.probe.pdp_mask |= (uint8_t)(1u << cid);
+    }
+  }
+}
+
+/**
+ * @brief +QICFG 응답 핸들러 (상태 일괄 조회 전용)
+ * 형식: +QICFG: "tcp/keepalive",<enable>,<idle>,<interval>,<count>
+ */
+void handle_urc_qicfg(gsm_t *gsm, const char *data, size_t len) {
+  if (gsm->current_cmd && gsm->current_cmd->cmd == GSM_CMD_PROBE) {
+    const char *p = data;
+    char name[16] = {0};
+
+    parse_string_quoted(&p, name, sizeof(name));
+    if (strcmp(name, "tcp/keepalive") == 0) {
+      gsm->current_cmd->msg.probe.keepalive = parse_uint32(&p) == 1;
+    }
+  }
 }
 
 void handle_urc_cgdcont(gsm_t *gsm, const char *data, size_t len)
@@ -102,6 +161,11 @@ void handle_urc_cpin(gsm_t *gsm, const char *data, size_t len) {
     parse_string(&p, target->cpin.code, sizeof(target->cpin.code));
   }
 
+  if (gsm->current_cmd && gsm->current_cmd->cmd == GSM_CMD_PROBE) {
+    gsm->current_cmd->msg.probe.sim_ready =
+        strncmp(data, "READY", 5) == 0;
+  }
+
   if (is_urc) {
 
   }
@@ -167,6 +231,8 @@ void handle_urc_qiopen(gsm_t *gsm, const char *data, size_t len) {
       if (target->qiopen.result == 0) {
         // 연결 성공
         socket->state = GSM_TCP_STATE_CONNECTED;
+        socket->opens++;
+        socket->rx_pend = 0;
 
         if (is_urc && gsm->evt_handler.handler) {
           gsm->evt_handler.handler(GSM_EVT_TCP_CONNECTED, &cid);
@@ -218,6 +284,8 @@ void handle_urc_qiclose(gsm_t *gsm, const char *data, size_t len) {
       socket->state = GSM_TCP_STATE_CLOSED;
       socket->on_recv = NULL;
       socket->on_close = NULL;
+      socket->sink = NULL;
+      gsm_mux_release(gsm, socket);
 
       xSemaphoreGive(gsm->tcp.tcp_mutex);
 
@@ -275,13 +343,17 @@ void handle_urc_qird(gsm_t *gsm, const char *data, size_t len) {
   gsm_msg_t *target;
   gsm_msg_t local_msg = {0};
   uint8_t connect_id = 0;
+  uint16_t req_length = 0;
 
   if (gsm->current_cmd && gsm->current_cmd->cmd == GSM_CMD_QIRD) {
     target = &gsm->current_cmd->msg;
 
-    // params에서 connect_id 추출: "0,1460" → connect_id=0
+    // params 에서 connect_id, 요청 길이 추출: "0,1460"
     const char *param_p = gsm->current_cmd->params;
     connect_id = parse_uint32(&param_p);
+    if (*param_p == ',') {
+      req_length = parse_uint32(&param_p);
+    }
   } else {
     target = &local_msg;
   }
@@ -290,12 +362,14 @@ void handle_urc_qird(gsm_t *gsm, const char *data, size_t len) {
   const char *p = data;
   target->qird.read_actual_length = parse_uint32(&p);
   target->qird.connect_id = connect_id;
+  target->qird.req_length = req_length;
 
   gsm->tcp.buffer.is_reading_data = true;
   gsm->tcp.buffer.expected_data_len = target->qird.read_actual_length;
   gsm->tcp.buffer.read_data_len = 0;
   gsm->tcp.buffer.rx_len = 0;
   gsm->tcp.buffer.current_connect_id = connect_id;
+  gsm->tcp.buffer.is_push = false;
 }
 
 /**
@@ -339,11 +413,67 @@ void handle_urc_qistate(gsm_t *gsm, const char *data, size_t len) {
   (void)is_urc;
 }
 
+/* gsm_tcp_socket_t.rx_pend */
+#define TCP_RX_READING 0x01U // QIRD 가 TCP 이벤트 큐에 있거나 진행 중
+#define TCP_RX_AGAIN 0x02U   // 그 QIRD 를 보낸 뒤 +QIURC: "recv" 가 또 옴
+
+/**
+ * @brief +QIURC: "recv" 하나 (파서 태스크)
+ *
+ * 소켓마다 QIRD 는 하나만 걸어 둔다. 이미 걸려 있으면 표시만 하고, 그 QIRD 가
+ * 끝날 때 (tcp_rx_done) 한 번 더 읽는다. 알림이 N 개 몰려도 QIRD 는 많아야 2 번.
+ *
+ * @return bool false: 이벤트 큐가 가득 참
+ */
+static bool tcp_rx_notify(gsm_t *gsm, uint8_t cid) {
+  gsm_tcp_socket_t *socket = &gsm->tcp.sockets[cid];
+  uint8_t old = __atomic_fetch_or(&socket->rx_pend, TCP_RX_READING | TCP_RX_AGAIN,
+                                  __ATOMIC_ACQ_REL);
+
+  if (old & TCP_RX_READING) {
+    return true;
+  }
+
+  tcp_event_t evt = {.type = TCP_EVT_RECV_NOTIFY, .connect_id = cid};
+  if (xQueueSend(gsm->tcp.event_queue, &evt, pdMS_TO_TICKS(10)) != pdTRUE) {
+    __atomic_store_n(&socket->rx_pend, 0, __ATOMIC_RELEASE);
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief QIRD 하나가 끝남 (파서 태스크 또는 producer 타임아웃)
+ *
+ * @param more 요청 길이를 다 채워 읽음 (모뎀 버퍼에 더 있을 수 있음)
+ */
+static void tcp_rx_done(gsm_t *gsm, uint8_t cid, bool more) {
+  gsm_tcp_socket_t *socket = &gsm->tcp.sockets[cid];
+  uint8_t old = __atomic_load_n(&socket->rx_pend, __ATOMIC_ACQUIRE);
+
+  // 읽는 동안 알림이 없었을 때만 내려놓는다 (내려놓은 뒤 알림은 새로 건다)
+  while (!more) {
+    if (old & TCP_RX_AGAIN) {
+      more = true;
+    } else if (__atomic_compare_exchange_n(&socket->rx_pend, &old, 0, false,
+                                           __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+      return;
+    }
+  }
+
+  tcp_event_t evt = {.type = TCP_EVT_CONTINUE_READ, .connect_id = cid};
+  if (xQueueSend(gsm->tcp.event_queue, &evt, 0) != pdTRUE) {
+    __atomic_store_n(&socket->rx_pend, 0, __ATOMIC_RELEASE);
+  }
+}
+
 /**
  * @brief +QIURC URC 핸들러
  * 형식:
  * - +QIURC: "recv",<connectID>  (데이터 수신 알림)
+ * - +QIURC: "recv",<connectID>,<len>  (direct push, 다음 바이트부터 데이터)
  * - +QIURC: "closed",<connectID>  (연결 종료 알림)
+ * - +QIURC: "dnsgip",<err>,<IP_count>,<DNS_ttl> 뒤에 "dnsgip","<addr>" 반복
  */
 void handle_urc_qiurc(gsm_t *gsm, const char *data, size_t len) {
   const char *p = data;
@@ -361,13 +491,29 @@ void handle_urc_qiurc(gsm_t *gsm, const char *data, size_t len) {
   if (strcmp(type, "recv") == 0) {
     uint8_t connect_id = parse_uint32(&p);
 
-    if (connect_id < GSM_TCP_MAX_SOCKETS) {
-      tcp_event_t evt = {.type = TCP_EVT_RECV_NOTIFY, .connect_id = connect_id};
-      if (xQueueSend(gsm->tcp.event_queue, &evt, pdMS_TO_TICKS(10)) != pdTRUE) {
+    if (connect_id < GSM_TCP_MAX_SOCKETS && *p == ',') {
+      // direct push: QIRD 없이 이 라인 바로 뒤에 len 바이트가 온다
+      size_t push_len = parse_uint32(&p);
+      gsm_tcp_buffer_t *b = &gsm->tcp.buffer;
+
+      if (push_len > GSM_TCP_RX_BUFFER_SIZE) {
+        LOG_ERR("+QIURC: \"recv\" push 길이 초과 %d (connect_id=%d)",
+                (int)push_len, connect_id);
+      }
+      b->is_reading_data = push_len > 0;
+      b->expected_data_len = push_len;
+      b->read_data_len = 0;
+      b->rx_len = 0;
+      b->current_connect_id = connect_id;
+      b->is_push = true;
+
+      if (gsm->evt_handler.handler) {
+        gsm->evt_handler.handler(GSM_EVT_TCP_DATA_RECV, &connect_id);
+      }
+    } else if (connect_id < GSM_TCP_MAX_SOCKETS) {
+      if (!tcp_rx_notify(gsm, connect_id)) {
         LOG_ERR("+QIURC: \"recv\" 이벤트 큐 오버플로우! (connect_id=%d)",
                 connect_id);
-      } else {
-
       }
 
       if (gsm->evt_handler.handler) {
@@ -402,6 +548,30 @@ void handle_urc_qiurc(gsm_t *gsm, const char *data, size_t len) {
       LOG_ERR("+QIURC: \"closed\" 잘못된 connect_id=%d (최대=%d)", connect_id,
               GSM_TCP_MAX_SOCKETS);
     }
+  } else if (strcmp(type, "dnsgip") == 0) {
+    if (!gsm->dns.pending) {
+      return;
+    }
+
+    if (*p == ',') {
+      p++;
+    }
+    if (*p == '"') {
+      // 주소 줄: 첫 번째 것만 쓴다
+      parse_string_quoted(&p, gsm->dns.addr, sizeof(gsm->dns.addr));
+      gsm->dns.err = 0;
+    } else {
+      int32_t err = parse_int32(&p);
+      uint32_t cnt = parse_uint32(&p);
+
+      if (err == 0 && cnt > 0) {
+        return; // 주소 줄을 기다린다
+      }
+      gsm->dns.err = err ? err : -1;
+    }
+
+    gsm->dns.pending = false;
+    xSemaphoreGive(gsm->dns.sem);
   } else if (strcmp(type, "pdpdeact") == 0) {
     uint8_t context_id = parse_uint32(&p);
     LOG_WARN("+QIURC: \"pdpdeact\",%d - PDP context 비활성화", context_id);
@@ -429,24 +599,28 @@ void handle_urc_qcfg(gsm_t *gsm, const char *data, size_t len) {
 
 }
 
+/* prefix 사전순 정렬 유지 (urc_lookup 이진 탐색) */
 const urc_handler_entry_t urc_status_handlers[] = {
-    {"RDY", handle_urc_rdy},
-    {"POWERED DOWN", handle_urc_powered_down},
-    {NULL, NULL}};
+    GSM_URC_ENTRY("POWERED DOWN", handle_urc_powered_down),
+    GSM_URC_ENTRY("RDY", handle_urc_rdy),
+    {NULL, 0, NULL}};
 
 const urc_handler_entry_t urc_info_handlers[] = {
-    {"+CMEE: ", handle_urc_cmee},       ///< 2.23
-    {"+CGDCONT: ", handle_urc_cgdcont}, ///< 10.2
-    {"+CPIN: ", handle_urc_cpin},       ///< 5.3
-    {"+COPS: ", handle_urc_cops},       ///< 6.1
-    {"+QIOPEN: ", handle_urc_qiopen},   ///< 2.3.6
-    {"+QICLOSE: ", handle_urc_qiclose}, ///< 2.3.7
-    {"+QISEND: ", handle_urc_qisend},   ///< 2.3.9
-    {"+QIRD: ", handle_urc_qird},       ///< 2.3.10
-    {"+QISTATE: ", handle_urc_qistate}, ///< 2.3.8
-    {"+QIURC: ", handle_urc_qiurc},     
-    {"+QCFG: ", handle_urc_qcfg}, 
-    {NULL, NULL}};
+    GSM_URC_ENTRY("+CGACT: ", handle_urc_cgact),     ///< 10.5
+    GSM_URC_ENTRY("+CGATT: ", handle_urc_cgatt),     ///< 10.4
+    GSM_URC_ENTRY("+CGDCONT: ", handle_urc_cgdcont), ///< 10.2
+    GSM_URC_ENTRY("+CMEE: ", handle_urc_cmee),       ///< 2.23
+    GSM_URC_ENTRY("+COPS: ", handle_urc_cops),       ///< 6.1
+    GSM_URC_ENTRY("+CPIN: ", handle_urc_cpin),       ///< 5.3
+    GSM_URC_ENTRY("+QCFG: ", handle_urc_qcfg),
+    GSM_URC_ENTRY("+QICFG: ", handle_urc_qicfg),
+    GSM_URC_ENTRY("+QICLOSE: ", handle_urc_qiclose), ///< 2.3.7
+    GSM_URC_ENTRY("+QIOPEN: ", handle_urc_qiopen),   ///< 2.3.6
+    GSM_URC_ENTRY("+QIRD: ", handle_urc_qird),       ///< 2.3.10
+    GSM_URC_ENTRY("+QISEND: ", handle_urc_qisend),   ///< 2.3.9
+    GSM_URC_ENTRY("+QISTATE: ", handle_urc_qistate), ///< 2.3.8
+    GSM_URC_ENTRY("+QIURC: ", handle_urc_qiurc),
+    {NULL, 0, NULL}};
 
 const gsm_at_cmd_entry_t gsm_at_cmd_handlers[] = {
     {GSM_CMD_NONE, NULL, NULL, 0},
@@ -459,6 +633,9 @@ const gsm_at_cmd_entry_t gsm_at_cmd_handlers[] = {
     {GSM_CMD_CPIN, "AT+CPIN", "+CPIN: ", 5000},
     {GSM_CMD_COPS, "AT+COPS", "+COPS: ", 180000},
     {GSM_CMD_QPOWD, "AT+QPOWD", NULL, 40000},
+    {GSM_CMD_IPR, "AT+IPR", "+IPR: ", 300},
+    {GSM_CMD_PROBE, "AT+CMEE?;+QICFG=\"tcp/keepalive\";+CPIN?;+CGATT?;+CGACT?",
+     NULL, 5000},
 
     /* EC25 TCP 명령어 */
     {GSM_CMD_QIOPEN, "AT+QIOPEN", "+QIOPEN: ", 150000},
@@ -467,17 +644,24 @@ const gsm_at_cmd_entry_t gsm_at_cmd_handlers[] = {
     {GSM_CMD_QIRD, "AT+QIRD", "+QIRD: ", 5000},
     {GSM_CMD_QISDE, "AT+QISDE", "+QISDE: ", 300},
     {GSM_CMD_QISTATE, "AT+QISTATE", "+QISTATE: ", 300},
+    {GSM_CMD_QIDNSGIP, "AT+QIDNSGIP", NULL, 300},
 
     {GSM_CMD_QICFG, "AT+QICFG", "+QICFG: ", 300},
     {GSM_CMD_QCFG, "AT+QCFG", "+QCFG: ", 300},
+    {GSM_CMD_CMUX, "AT+CMUX", NULL, 300},
+    {GSM_CMD_ATD, "ATD", NULL, 30000},
 
     {GSM_CMD_NONE, NULL, NULL, 0}};
 
-static inline void add_payload(gsm_t *gsm, char ch) {
-  if (gsm->recv.len < GSM_PAYLOAD_SIZE - 1) {
-    gsm->recv.data[gsm->recv.len] = ch;
-    gsm->recv.data[++gsm->recv.len] = '\0';
+static inline void add_payload_run(gsm_t *gsm, const uint8_t *s, size_t n) {
+  size_t room = GSM_PAYLOAD_SIZE - 1 - gsm->recv.len;
+
+  if (n > room) {
+    n = room;
   }
+  memcpy(&gsm->recv.data[gsm->recv.len], s, n);
+  gsm->recv.len += n;
+  gsm->recv.data[gsm->recv.len] = '\0';
 }
 
 static inline void clear_payload(gsm_t *gsm) {
@@ -487,20 +671,63 @@ static inline void clear_payload(gsm_t *gsm) {
 
 static inline size_t recv_payload_len(gsm_t *gsm) { return gsm->recv.len; }
 
-static void handle_urc_status(gsm_t *gsm) {
-  const urc_handler_entry_t *entry = gsm->urc_stat_tbl;
+/**
+ * @brief 정렬된 URC 테이블에서 line 의 prefix 항목 찾기 (이진 탐색)
+ *
+ * prefix 끼리 서로의 앞부분이 아니므로 맞는 항목은 최대 하나이고,
+ * 비교는 항목 prefix 길이만큼의 memcmp 한 번이다.
+ */
+static const urc_handler_entry_t *urc_lookup(const urc_handler_entry_t *tbl,
+                                             uint8_t cnt, const char *line,
+                                             size_t len) {
+  uint8_t lo = 0;
+  uint8_t hi = cnt;
+
+  while (lo < hi) {
+    uint8_t mid = (uint8_t)((lo + hi) / 2);
+    const urc_handler_entry_t *e = &tbl[mid];
+    size_t n = e->prefix_len < len ? e->prefix_len : len;
+    int c = memcmp(line, e->prefix, n);
+
+    if (c == 0) {
+      if (len >= e->prefix_len) {
+        return e;
+      }
+      c = -1; // line 이 prefix 보다 짧음
+    }
 
-  while (entry->prefix != NULL) {
-    const char *prefix = entry->prefix;
-    size_t prefix_len = strlen(entry->prefix);
+    if (c < 0) {
+      hi = mid;
+    } else {
+      lo = mid + 1;
+    }
+  }
 
-    if (strncmp(gsm->recv.data, prefix, prefix_len) == 0) {
-      if (entry->handler) {
-        entry->handler(gsm, NULL, 0);
-      }
-      return;
+  return NULL;
+}
+
+/**
+ * @brief 테이블 항목 수 세고 정렬 순서 확인 (gsm_init 에서 한 번)
+ */
+static uint8_t urc_table_count(const urc_handler_entry_t *tbl) {
+  uint8_t cnt = 0;
+
+  for (; tbl[cnt].prefix != NULL; cnt++) {
+    if (cnt > 0 && strcmp(tbl[cnt - 1].prefix, tbl[cnt].prefix) >= 0) {
+      LOG_ERR("URC 테이블 정렬 오류: \"%s\" >= \"%s\"", tbl[cnt - 1].prefix,
+              tbl[cnt].prefix);
     }
-    entry++;
+  }
+
+  return cnt;
+}
+
+static void handle_urc_status(gsm_t *gsm) {
+  const urc_handler_entry_t *entry = urc_lookup(
+      gsm->urc_stat_tbl, gsm->urc_stat_cnt, gsm->recv.data, gsm->recv.len);
+
+  if (entry && entry->handler) {
+    entry->handler(gsm, NULL, 0);
   }
 }
 
@@ -509,49 +736,77 @@ static void handle_urc_status(gsm_t *gsm) {
  *
  */
 static void handle_urc_info(gsm_t *gsm) {
-  const urc_handler_entry_t *entry = gsm->urc_info_tbl;
-
   LOG_DEBUG("handle_urc_info: recv.data=\"%s\" (len=%d)", gsm->recv.data,
             gsm->recv.len);
 
-  while (entry->prefix != NULL) {
-    const char *resp = entry->prefix;
-    size_t resp_len = strlen(entry->prefix);
+  const urc_handler_entry_t *entry = urc_lookup(
+      gsm->urc_info_tbl, gsm->urc_info_cnt, gsm->recv.data, gsm->recv.len);
 
-    if (strncmp(gsm->recv.data, resp, resp_len) == 0)
-    {
-      if (entry->handler)
-      {
-        const char *data_start = &gsm->recv.data[resp_len];
-        size_t data_len =
-            ((gsm->recv.len > resp_len) ? gsm->recv.len - resp_len : 0);
-
-
-        if (gsm->cmd_mutex &&
-            xSemaphoreTake(gsm->cmd_mutex, portMAX_DELAY) == pdTRUE)
-        {
-          entry->handler(gsm, data_start, data_len);
-          xSemaphoreGive(gsm->cmd_mutex);
-        }
-        else
-        {
-          LOG_ERR("URC 핸들러 뮤텍스 획득 실패!");
-        }
-      }
+  if (!entry) {
+    LOG_ERR("URC info 핸들러 매칭 실패: recv.data=\"%s\"", gsm->recv.data);
+    return;
+  }
 
-      return;
-    }
+  if (entry->handler) {
+    size_t resp_len = entry->prefix_len;
+    const char *data_start = &gsm->recv.data[resp_len];
+    size_t data_len =
+        ((gsm->recv.len > resp_len) ? gsm->recv.len - resp_len : 0);
 
-    entry++;
+    if (gsm->cmd_mutex &&
+        xSemaphoreTake(gsm->cmd_mutex, portMAX_DELAY) == pdTRUE) {
+      entry->handler(gsm, data_start, data_len);
+      xSemaphoreGive(gsm->cmd_mutex);
+    } else {
+      LOG_ERR("URC 핸들러 뮤텍스 획득 실패!");
+    }
   }
+}
 
-  LOG_ERR("URC info 핸들러 매칭 실패: recv.data=\"%s\"", gsm->recv.data);
+typedef enum {
+  GSM_LINE_OTHER = 0, ///< 상태 URC (RDY 등)
+  GSM_LINE_OK,        ///< OK, SEND OK
+  GSM_LINE_ERROR,     ///< ERROR, SEND FAIL, NO CARRIER
+  GSM_LINE_INFO,      ///< +XXX: 응답/URC
+  GSM_LINE_CONNECT,   ///< transparent QIOPEN, ATD 성공
+} gsm_line_kind_t;
+
+/**
+ * @brief 첫 문자로 라인 종류 분류 (비교는 후보 하나만)
+ */
+static gsm_line_kind_t gsm_line_kind(const char *line) {
+  switch (line[0]) {
+  case 'O':
+    return line[1] == 'K' ? GSM_LINE_OK : GSM_LINE_OTHER;
+  case 'S':
+    if (!strncmp(line, "SEND OK", 7)) {
+      return GSM_LINE_OK;
+    }
+    return !strncmp(line, "SEND FAIL", 9) ? GSM_LINE_ERROR : GSM_LINE_OTHER;
+  case 'E':
+    return !strncmp(line, "ERROR", 5) ? GSM_LINE_ERROR : GSM_LINE_OTHER;
+  case 'N':
+    // ATD 실패
+    return !strncmp(line, "NO CARRIER", 10) ? GSM_LINE_ERROR : GSM_LINE_OTHER;
+  case 'C':
+    return !strncmp(line, "CONNECT", 7) ? GSM_LINE_CONNECT : GSM_LINE_OTHER;
+  case '+':
+    return GSM_LINE_INFO;
+  default:
+    return GSM_LINE_OTHER;
+  }
 }
 
 void gsm_parse_response(gsm_t *gsm) {
   char *line = gsm->recv.data;
+  gsm_line_kind_t kind = gsm_line_kind(line);
+
+  if (kind == GSM_LINE_CONNECT) {
+    // 데이터 채널의 QIOPEN, ATD 는 OK 대신 CONNECT 로 끝난다
+    kind = gsm_mux_connect(gsm) ? GSM_LINE_OK : GSM_LINE_OTHER;
+  }
 
-  if (!strncmp(line, "OK", 2) || !strncmp(line, "SEND OK", 7)) {
+  if (kind == GSM_LINE_OK) {
     gsm->status.is_ok = 1;
     gsm->status.is_err = 0;
 
@@ -561,6 +816,8 @@ void gsm_parse_response(gsm_t *gsm) {
         at_cmd_handler callback = gsm->current_cmd->callback;
         gsm_cmd_t cmd_backup = gsm->current_cmd->cmd;
         tcp_pbuf_t *tx_pbuf = gsm->current_cmd->tx_pbuf;
+        uint8_t tx_cid = gsm->current_cmd->tx_cid;
+        uint8_t tx_batch = gsm->current_cmd->tx_batch;
 
         gsm_msg_t msg_backup;
         memcpy(&msg_backup, &gsm->current_cmd->msg, sizeof(msg_backup));
@@ -582,12 +839,15 @@ void gsm_parse_response(gsm_t *gsm) {
         if (tx_pbuf) {
           tcp_pbuf_free(tx_pbuf);
         }
+        if (tx_batch) {
+          gsm_tcp_tx_complete(gsm, tx_cid, tx_batch, true);
+        }
 
         return;
       }
       xSemaphoreGive(gsm->cmd_mutex);
     }
-  } else if (!strncmp(line, "ERROR", 5)) {
+  } else if (kind == GSM_LINE_ERROR) {
     gsm->status.is_ok = 0;
     gsm->status.is_err = 1;
 
@@ -597,6 +857,8 @@ void gsm_parse_response(gsm_t *gsm) {
         at_cmd_handler callback = gsm->current_cmd->callback;
         gsm_cmd_t cmd_backup = gsm->current_cmd->cmd;
         tcp_pbuf_t *tx_pbuf = gsm->current_cmd->tx_pbuf;
+        uint8_t tx_cid = gsm->current_cmd->tx_cid;
+        uint8_t tx_batch = gsm->current_cmd->tx_batch;
 
         gsm->current_cmd = NULL;
 
@@ -615,87 +877,763 @@ void gsm_parse_response(gsm_t *gsm) {
         if (tx_pbuf) {
           tcp_pbuf_free(tx_pbuf);
         }
+        if (tx_batch) {
+          gsm_tcp_tx_complete(gsm, tx_cid, tx_batch, false);
+        }
 
         return;
       }
       xSemaphoreGive(gsm->cmd_mutex);
     }
-  } else if (line[0] == '+') {
+  } else if (kind == GSM_LINE_INFO) {
     handle_urc_info(gsm);
   } else {
     handle_urc_status(gsm);
   }
 }
 
-void gsm_parse_process(gsm_t *gsm, const void *data, size_t len) {
-  const uint8_t *d = data;
-  static char ch_prev1 = 0;
+/**
+ * @brief QIRD 바이너리 데이터를 한 번에 복사
+ *
+ * 파서 태스크에서만 읽고 쓰는 상태라 완료 시 current_cmd 보호용
+ * cmd_mutex 하나만 잡는다.
+ *
+ * @return 소비한 바이트 수 (0 이면 읽기 종료, 현재 바이트는 텍스트로 처리)
+ */
+static size_t gsm_parse_qird_data(gsm_t *gsm, const uint8_t *d, size_t len) {
+  gsm_tcp_buffer_t *b = &gsm->tcp.buffer;
 
-  for (; len > 0; ++d, --len) {
-    if (gsm->tcp.buffer.is_reading_data) {
-      if (gsm->tcp.buffer.read_data_len < gsm->tcp.buffer.expected_data_len &&
-          gsm->tcp.buffer.rx_len < GSM_TCP_RX_BUFFER_SIZE) {
-        gsm->tcp.buffer.rx_buf[gsm->tcp.buffer.rx_len++] = *d;
-        gsm->tcp.buffer.read_data_len++;
-
-        if (gsm->tcp.buffer.read_data_len >=
-            gsm->tcp.buffer.expected_data_len) {
-          if (xSemaphoreTake(gsm->tcp.tcp_mutex, portMAX_DELAY) == pdTRUE) {
-            if (gsm->cmd_mutex &&
-                xSemaphoreTake(gsm->cmd_mutex, portMAX_DELAY) == pdTRUE) {
-              if (gsm->current_cmd && gsm->current_cmd->cmd == GSM_CMD_QIRD) {
-                  gsm->current_cmd->msg.qird.data = gsm->tcp.buffer.rx_buf;
-                  gsm->current_cmd->msg.qird.read_actual_length =
-                  gsm->tcp.buffer.rx_len;
-                  gsm->current_cmd->msg.qird.connect_id =
-                  gsm->tcp.buffer.current_connect_id;
-              }
-              xSemaphoreGive(gsm->cmd_mutex);
-            }
+  if (b->read_data_len >= b->expected_data_len ||
+      b->rx_len >= GSM_TCP_RX_BUFFER_SIZE) {
+    b->is_reading_data = false;
+    return 0;
+  }
 
-            gsm->tcp.buffer.is_reading_data = false;
-            xSemaphoreGive(gsm->tcp.tcp_mutex);
+  size_t n = b->expected_data_len - b->read_data_len;
+  if (n > GSM_TCP_RX_BUFFER_SIZE - b->rx_len) {
+    n = GSM_TCP_RX_BUFFER_SIZE - b->rx_len;
+  }
+  if (n > len) {
+    n = len;
+  }
+
+  memcpy(&b->rx_buf[b->rx_len], d, n);
+  b->rx_len += n;
+  b->read_data_len += n;
+
+  if (b->read_data_len >= b->expected_data_len) {
+    TRACE_MARK(TRACE_MARK_QIRD);
+  }
+
+  if (b->read_data_len >= b->expected_data_len && b->is_push) {
+    // 파서 태스크에서 바로 소켓으로 넘긴다 (tcp_read_complete_callback 과 같은 경로)
+    b->is_reading_data = false;
+    tcp_deliver(gsm, b->current_connect_id, b->rx_buf, b->rx_len);
+  } else if (b->read_data_len >= b->expected_data_len) {
+    if (gsm->cmd_mutex &&
+        xSemaphoreTake(gsm->cmd_mutex, portMAX_DELAY) == pdTRUE) {
+      if (gsm->current_cmd && gsm->current_cmd->cmd == GSM_CMD_QIRD) {
+        gsm->current_cmd->msg.qird.data = b->rx_buf;
+        gsm->current_cmd->msg.qird.read_actual_length = b->rx_len;
+        gsm->current_cmd->msg.qird.connect_id = b->current_connect_id;
+      }
+      xSemaphoreGive(gsm->cmd_mutex);
+    }
+    b->is_reading_data = false;
+  }
+
+  return n;
+}
+
+/**
+ * @brief QISEND '>' 프롬프트 처리
+ */
+static void gsm_parse_prompt(gsm_t *gsm) {
+  if (xSemaphoreTake(gsm->cmd_mutex, portMAX_DELAY) == pdTRUE) {
+    if (gsm->current_cmd && gsm->current_cmd->cmd == GSM_CMD_QISEND &&
+        gsm->current_cmd->wait_type == GSM_WAIT_PROMPT) {
+      if (gsm->current_cmd->tx_pbuf) {
+        tcp_pbuf_t *pbuf = gsm->current_cmd->tx_pbuf;
+        gsm_at_send(gsm, gsm->current_cmd, pbuf->payload, pbuf->len);
+      } else if (gsm->current_cmd->tx_batch &&
+                 gsm->current_cmd->tx_cid < GSM_TCP_MAX_SOCKETS) {
+        // 묶인 쓰기들은 완료 전까지 대기열에서 빠지지 않으므로 잠금 없이 읽는다
+        gsm_tcp_socket_t *socket = &gsm->tcp.sockets[gsm->current_cmd->tx_cid];
+
+        for (uint8_t i = 0; i < gsm->current_cmd->tx_batch; i++) {
+          gsm_tcp_tx_t *tx =
+              &socket->tx[(gsm->current_cmd->tx_first + i) %
+                          GSM_TCP_TX_QUEUE_DEPTH];
+
+          for (tcp_pbuf_t *p = tx->chain; p; p = p->next) {
+            gsm_at_send(gsm, gsm->current_cmd, p->payload, p->len);
           }
         }
+      }
+      gsm->current_cmd->wait_type = GSM_WAIT_EXPECTED;
+    }
+    xSemaphoreGive(gsm->cmd_mutex);
+  }
+}
+
+/**
+ * @brief AT 채널 chunk 파싱
+ *
+ * 라인은 LF 를 memchr 로 찾아 구간 단위로 모으고 CR LF 에서 처리한다.
+ * +QIRD 뒤의 바이너리는 길이만큼 한 번에 복사한다. 상태는 모두 gsm
+ * 인스턴스에 있으므로 chunk 가 어디서 끊겨도 이어서 파싱된다.
+ */
+RAM_FUNC static void gsm_parse_at(gsm_t *gsm, const uint8_t *data,
+                                  size_t len) {
+  const uint8_t *d = data;
+  const uint8_t *end = d + len;
+
+  while (d < end) {
+    if (gsm->tcp.buffer.is_reading_data) {
+      size_t n = gsm_parse_qird_data(gsm, d, (size_t)(end - d));
+      if (n) {
+        d += n;
         continue;
-      } else {
-        if (xSemaphoreTake(gsm->tcp.tcp_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-          gsm->tcp.buffer.is_reading_data = false;
-          xSemaphoreGive(gsm->tcp.tcp_mutex);
+      }
+    }
+
+    // 빈 라인에서는 '>' 프롬프트가 올 수 있어 첫 문자가 쌓일 때까지 한 바이트씩
+    if (recv_payload_len(gsm) == 0) {
+      if (*d == '>') {
+        gsm_parse_prompt(gsm);
+        d++;
+        continue;
+      }
+      if (*d == '\r' || *d == '\n' || !IS_ASCII(*d)) {
+        gsm->recv.prev = *d++;
+        continue;
+      }
+    }
+
+    // 출력 가능한 문자는 한 번에 붙이고 CR/LF/제어 문자에서 멈춤
+    size_t n = simd_span_text(d, (size_t)(end - d));
+    if (n) {
+      add_payload_run(gsm, d, n);
+      d += n;
+      gsm->recv.prev = d[-1];
+      continue;
+    }
+
+    if (*d == '\n') {
+      if (gsm->recv.prev == '\r' && recv_payload_len(gsm)) {
+        gsm_parse_response(gsm);
+        clear_payload(gsm);
+      }
+      gsm->recv.prev = '\n';
+    } else {
+      // CR 과 ASCII 가 아닌 바이트는 줄에 넣지 않음
+      gsm->recv.prev = *d;
+    }
+    d++;
+  }
+}
+
+RAM_FUNC void gsm_parse_process(gsm_t *gsm, const void *data, size_t len) {
+#if GSM_CMUX_ENABLE
+  if (gsm->mux.cmux.active) {
+    cmux_input(&gsm->mux.cmux, data, len);
+    return;
+  }
+#endif
+  gsm_parse_at(gsm, data, len);
+}
+
+static gsm_at_lane_t gsm_at_cmd_lane(gsm_cmd_t cmd) {
+  switch (cmd) {
+  case GSM_CMD_QIRD:
+  case GSM_CMD_QISEND:
+    return GSM_AT_LANE_DATA;
+  default:
+    return GSM_AT_LANE_CTRL;
+  }
+}
+
+/**
+ * @brief 명령 종류에 맞는 lane 에 넣고 처리 태스크를 깨운다
+ */
+static void gsm_at_cmd_enqueue(gsm_t *gsm, gsm_at_cmd_t *msg) {
+  msg->enq_tick = xTaskGetTickCount();
+  xQueueSend(gsm->at_cmd_queue[gsm_at_cmd_lane(msg->cmd)], msg, portMAX_DELAY);
+  xSemaphoreGive(gsm->at_cmd_signal);
+}
+
+bool gsm_at_cmd_receive(gsm_t *gsm, gsm_at_cmd_t *out, TickType_t wait) {
+  for (;;) {
+    for (int lane = 0; lane < GSM_AT_LANE_MAX; lane++) {
+      QueueHandle_t q = gsm->at_cmd_queue[lane];
+      uint32_t depth = uxQueueMessagesWaiting(q);
+
+      if (xQueueReceive(q, out, 0) != pdTRUE) {
+        continue;
+      }
+
+      gsm_at_lane_stats_t *st = &gsm->at_lane_stats[lane];
+      uint32_t wait_ms =
+          (xTaskGetTickCount() - out->enq_tick) * portTICK_PERIOD_MS;
+
+      st->count++;
+      st->wait_sum_ms += wait_ms;
+      if (wait_ms > st->wait_max_ms) {
+        st->wait_max_ms = wait_ms;
+      }
+      if (depth > st->max_depth) {
+        st->max_depth = depth;
+      }
+      return true;
+    }
+
+    // 신호는 큐에 넣은 뒤 give 하므로 여기서 놓치는 명령은 없다
+    if (xSemaphoreTake(gsm->at_cmd_signal, wait) != pdTRUE) {
+      return false;
+    }
+  }
+}
+
+/**
+ * @brief 송신 완료 콜백 호출 및 풀 체인 반납 (잠금 밖에서)
+ */
+static void tcp_tx_finish(uint8_t cid, gsm_tcp_tx_t *done, uint8_t n,
+                          bool ok) {
+  for (uint8_t i = 0; i < n; i++) {
+    if (done[i].cb) {
+      done[i].cb(cid, ok, done[i].ctx);
+    }
+    if (done[i].pool) {
+      tcp_pbuf_free_chain(done[i].chain);
+    }
+  }
+}
+
+/**
+ * @brief 아직 QISEND 로 나가지 않은 쓰기를 모두 실패로 끝낸다
+ *
+ * 이미 나간 쓰기는 SEND OK/ERROR 또는 타임아웃으로 끝난다.
+ */
+static void tcp_tx_flush(gsm_t *gsm, uint8_t cid) {
+  gsm_tcp_tx_t done[GSM_TCP_TX_QUEUE_DEPTH];
+  uint8_t n = 0;
+
+  if (cid >= GSM_TCP_MAX_SOCKETS) {
+    return;
+  }
+
+  if (xSemaphoreTake(gsm->tcp.tcp_mutex, portMAX_DELAY) == pdTRUE) {
+    gsm_tcp_socket_t *socket = &gsm->tcp.sockets[cid];
+
+    // 뒤에서부터 빼지만 콜백은 들어온 순서대로 부른다
+    while (socket->tx_count > socket->tx_busy) {
+      socket->tx_count--;
+      n++;
+      done[GSM_TCP_TX_QUEUE_DEPTH - n] =
+          socket->tx[(socket->tx_head + socket->tx_count) %
+                     GSM_TCP_TX_QUEUE_DEPTH];
+    }
+    xSemaphoreGive(gsm->tcp.tcp_mutex);
+  }
+
+  if (n) {
+    LOG_WARN("TCP 송신 대기 %d건 취소 (cid=%d)", n, cid);
+  }
+  tcp_tx_finish(cid, &done[GSM_TCP_TX_QUEUE_DEPTH - n], n, false);
+}
+
+/**
+ * @brief 비동기 QISEND 를 DATA lane 에 넣는다
+ */
+static bool tcp_tx_post(gsm_t *gsm, uint8_t cid, TickType_t wait) {
+  gsm_at_cmd_t msg = {
+      .at_mode = GSM_AT_WRITE,
+      .cmd = GSM_CMD_QISEND,
+      .wait_type = GSM_WAIT_PROMPT,
+      .callback = NULL,
+      .sem = NULL,
+      .tx_pbuf = NULL,
+      .tx_deferred = true,
+      .tx_cid = cid,
+  };
+
+  msg.enq_tick = xTaskGetTickCount();
+  if (xQueueSend(gsm->at_cmd_queue[GSM_AT_LANE_DATA], &msg, wait) != pdTRUE) {
+    return false;
+  }
+  xSemaphoreGive(gsm->at_cmd_signal);
+  return true;
+}
+
+uint32_t gsm_at_cmd_flush(gsm_t *gsm) {
+  gsm_at_cmd_t dummy;
+  uint32_t cnt = 0;
+
+  for (int lane = 0; lane < GSM_AT_LANE_MAX; lane++) {
+    while (gsm->at_cmd_queue[lane] &&
+           xQueueReceive(gsm->at_cmd_queue[lane], &dummy, 0) == pdTRUE) {
+      if (dummy.tx_deferred && dummy.tx_cid < GSM_TCP_MAX_SOCKETS &&
+          xSemaphoreTake(gsm->tcp.tcp_mutex, portMAX_DELAY) == pdTRUE) {
+        gsm_tcp_socket_t *socket = &gsm->tcp.sockets[dummy.tx_cid];
+        if (socket->tx_cmds) {
+          socket->tx_cmds--;
         }
+        xSemaphoreGive(gsm->tcp.tcp_mutex);
+
+        // 이 QISEND 에 묶일 쓰기는 더 나갈 길이 없으므로 실패로 끝낸다
+        tcp_tx_flush(gsm, dummy.tx_cid);
+      }
+      if (dummy.cmd == GSM_CMD_QIRD && dummy.callback) {
+        // 완료 콜백이 오지 않으므로 걸어 둔 읽기를 내려놓는다
+        for (int i = 0; i < GSM_TCP_MAX_SOCKETS; i++) {
+          __atomic_store_n(&gsm->tcp.sockets[i].rx_pend, 0, __ATOMIC_RELEASE);
+        }
+      }
+      cnt++;
+    }
+  }
+
+  return cnt;
+}
+
+bool gsm_at_get_lane_stats(gsm_t *gsm, gsm_at_lane_t lane,
+                           gsm_at_lane_stats_t *out) {
+  if (!gsm || lane >= GSM_AT_LANE_MAX || !out) {
+    return false;
+  }
+
+  *out = gsm->at_lane_stats[lane];
+  return true;
+}
+
+/*
+ * CMUX 채널 처리
+ */
+
+#if GSM_CMUX_ENABLE
+static int gsm_mux_write(void *ctx, const cmux_seg_t *seg, size_t cnt) {
+  gsm_t *gsm = ctx;
+
+  if (gsm->ops->sendv) {
+    return gsm->ops->sendv(seg, cnt);
+  }
+
+  // 구간마다 따로 나가므로 다른 태스크의 프레임과 섞일 수 있다 (시뮬레이터용)
+  for (size_t i = 0; i < cnt; i++) {
+    if (gsm->ops->send(seg[i].data, seg[i].len) != 0) {
+      return -1;
+    }
+  }
+  return 0;
+}
+
+/**
+ * @brief 데이터 모드 채널 수신을 소켓으로
+ */
+static void gsm_mux_deliver(gsm_t *gsm, uint8_t dlc, const uint8_t *data,
+                            size_t len) {
+  uint8_t cid = gsm->mux.cid[dlc];
+
+#if GSM_PPP_ENABLE
+  if (dlc == GSM_CMUX_DLC_PPP) {
+    gsm_ppp_input(gsm, data, len);
+    return;
+  }
+#endif
+
+  tcp_deliver(gsm, cid, data, len);
+
+  if (gsm->evt_handler.handler) {
+    gsm->evt_handler.handler(GSM_EVT_TCP_DATA_RECV, &cid);
+  }
+}
+
+/**
+ * @brief 데이터 채널의 명령 모드 바이트 (QIOPEN 응답)
+ *
+ * 채널마다 라인 버퍼를 따로 쓰고, 응답을 기다리는 명령을 그 채널로 보냈을
+ * 때만 파서로 넘긴다 (에코, 연결이 끝난 뒤의 NO CARRIER 등은 버림).
+ * CONNECT 라인 뒤의 바이트는 같은 프레임이어도 이미 TCP 데이터다.
+ */
+static void gsm_mux_parse_cmd(gsm_t *gsm, uint8_t dlc, const uint8_t *data,
+                              size_t len) {
+  const uint8_t *d = data;
+  const uint8_t *end = data + len;
+
+  while (d < end) {
+    if (gsm->mux.data[dlc]) {
+      gsm_mux_deliver(gsm, dlc, d, (size_t)(end - d));
+      return;
+    }
+
+    const uint8_t *lf = memchr(d, '\n', (size_t)(end - d));
+    const uint8_t *stop = lf ? lf + 1 : end;
+
+    if (gsm->mux.at_dlc == dlc) {
+      gsm_recv_t at_line = gsm->recv;
+
+      gsm->recv = gsm->mux.recv[dlc];
+      gsm->mux.rx_dlc = dlc;
+      gsm_parse_at(gsm, d, (size_t)(stop - d));
+      gsm->mux.rx_dlc = GSM_CMUX_DLC_AT;
+      gsm->mux.recv[dlc] = gsm->recv;
+      gsm->recv = at_line;
+    }
+    d = stop;
+  }
+}
+
+static void gsm_mux_recv(void *ctx, uint8_t dlci, const uint8_t *data,
+                         size_t len) {
+  gsm_t *gsm = ctx;
+
+  if (dlci == GSM_CMUX_DLC_AT) {
+    gsm_parse_at(gsm, data, len);
+  } else if (gsm->mux.data[dlci]) {
+    gsm_mux_deliver(gsm, dlci, data, len);
+  } else {
+    gsm_mux_parse_cmd(gsm, dlci, data, len);
+  }
+}
+
+/**
+ * @brief 프레임 밖 바이트 (다중화가 풀린 모뎀의 RDY 등) 는 AT 로 본다
+ */
+static void gsm_mux_raw(void *ctx, const uint8_t *data, size_t len) {
+  gsm_parse_at(ctx, data, len);
+}
+
+/**
+ * @brief 데이터 채널 DCD 가 내려감 (연결 끝, 채널은 명령 모드로)
+ */
+static void gsm_mux_carrier_lost(gsm_t *gsm, uint8_t dlc) {
+  uint8_t cid = gsm->mux.cid[dlc];
+  bool notify = false;
+
+  if (!gsm->mux.data[dlc]) {
+    return;
+  }
+  gsm->mux.data[dlc] = false;
+  gsm->mux.recv[dlc].len = 0;
+
+#if GSM_PPP_ENABLE
+  if (dlc == GSM_CMUX_DLC_PPP) {
+    gsm_ppp_carrier_lost(gsm, true);
+    return;
+  }
+#endif
+
+  if (cid < GSM_TCP_MAX_SOCKETS &&
+      xSemaphoreTake(gsm->tcp.tcp_mutex, portMAX_DELAY) == pdTRUE) {
+    gsm_tcp_socket_t *socket = &gsm->tcp.sockets[cid];
+
+    // 우리가 닫는 중이면 QICLOSE 쪽에서 정리한다
+    notify = socket->dlc == dlc && socket->state == GSM_TCP_STATE_CONNECTED;
+    xSemaphoreGive(gsm->tcp.tcp_mutex);
+  }
+
+  if (notify) {
+    LOG_WARN("CMUX DLC%d 연결 끊김 (cid=%d)", dlc, cid);
+    gsm_tcp_notify_closed(gsm, cid);
+  }
+}
+
+static void gsm_mux_done(gsm_t *gsm, bool ok) {
+  void (*done)(gsm_t *gsm, bool ok) = gsm->mux.done;
+
+  gsm->mux.done = NULL;
+  if (done) {
+    done(gsm, ok);
+  }
+}
+
+static void gsm_mux_event(void *ctx, uint8_t dlci, cmux_evt_t evt) {
+  gsm_t *gsm = ctx;
+  gsm_mux_t *m = &gsm->mux;
+
+  switch (evt) {
+  case CMUX_EVT_OPEN:
+    LOG_INFO("CMUX DLC%d 열림", dlci);
+    if (dlci > 0) {
+      cmux_msc(&m->cmux, dlci, CMUX_V24_RTC | CMUX_V24_RTR | CMUX_V24_DV);
+    }
+    if (dlci == GSM_CMUX_DLC_AT) {
+      m->up = true;
+      xSemaphoreGive(m->open_sem);
+      gsm_mux_done(gsm, true);
+    }
+    if (dlci + 1 < CMUX_DLC_MAX) {
+      cmux_open(&m->cmux, dlci + 1);
+    }
+    break;
+
+  case CMUX_EVT_REFUSED:
+    if (dlci <= GSM_CMUX_DLC_AT) {
+      LOG_ERR("CMUX DLC%d 거절", dlci);
+      gsm_mux_done(gsm, false);
+    } else {
+      // 데이터 채널이 없으면 그 소켓은 AT 로 주고받는다
+      LOG_WARN("CMUX DLC%d 거절", dlci);
+      if (dlci + 1 < CMUX_DLC_MAX) {
+        cmux_open(&m->cmux, dlci + 1);
       }
     }
+    break;
+
+  case CMUX_EVT_CLOSED:
+    if (dlci == GSM_CMUX_DLC_AT) {
+      m->up = false;
+    } else if (dlci >= GSM_CMUX_DLC_DATA) {
+      gsm_mux_carrier_lost(gsm, dlci);
+    }
+    break;
+
+  case CMUX_EVT_V24:
+    if (dlci >= GSM_CMUX_DLC_DATA && !(m->cmux.dlc[dlci].v24 & CMUX_V24_DV)) {
+      gsm_mux_carrier_lost(gsm, dlci);
+    }
+    break;
+
+  default:
+    break;
+  }
+}
+
+static const cmux_ops_t gsm_mux_ops = {
+    .write = gsm_mux_write,
+    .recv = gsm_mux_recv,
+    .raw = gsm_mux_raw,
+    .event = gsm_mux_event,
+};
+
+/**
+ * @brief 빈 데이터 채널을 소켓에 배정 (tcp_mutex 안에서)
+ *
+ * @return 채널 번호, 0: 없음 (AT 로 연다)
+ */
+static uint8_t gsm_mux_alloc(gsm_t *gsm, uint8_t cid) {
+  if (!gsm->mux.up) {
+    return 0;
+  }
+
+  for (uint8_t dlc = GSM_CMUX_DLC_DATA; dlc < CMUX_DLC_MAX; dlc++) {
+    bool busy = gsm->mux.data[dlc] ||
+                gsm->mux.cmux.dlc[dlc].state != CMUX_DLC_OPEN ||
+                (GSM_PPP_ENABLE && dlc == GSM_CMUX_DLC_PPP);
+
+    for (uint8_t i = 0; i < GSM_TCP_MAX_SOCKETS && !busy; i++) {
+      busy = i != cid && gsm->tcp.sockets[i].dlc == dlc &&
+             gsm->tcp.sockets[i].state != GSM_TCP_STATE_CLOSED;
+    }
+    if (!busy) {
+      gsm->mux.cid[dlc] = cid;
+      return dlc;
+    }
+  }
+  return 0;
+}
+
+/**
+ * @brief 닫힌 소켓의 데이터 채널 반납 (tcp_mutex 안에서)
+ *
+ * 우리가 QICLOSE 로 닫으면 DCD 가 늦게 내려오거나 안 올 수 있어 여기서 푼다.
+ */
+static void gsm_mux_release(gsm_t *gsm, gsm_tcp_socket_t *socket) {
+  if (socket->dlc) {
+    gsm->mux.data[socket->dlc] = false;
+    gsm->mux.recv[socket->dlc].len = 0;
+    socket->dlc = 0;
+  }
+}
+
+/**
+ * @brief 데이터 채널의 CONNECT (gsm_parse_response 에서)
+ *
+ * @return true: QIOPEN/ATD 완료로 처리, false: 데이터 채널 응답이 아님
+ */
+static bool gsm_mux_connect(gsm_t *gsm) {
+  uint8_t dlc = gsm->mux.rx_dlc;
+  uint8_t cid = gsm->mux.cid[dlc];
+
+#if GSM_PPP_ENABLE
+  if (dlc == GSM_CMUX_DLC_PPP) {
+    LOG_INFO("CMUX DLC%d PPP 연결", dlc);
+    gsm->mux.data[dlc] = true;
+    gsm_ppp_connected(gsm);
+    return true;
+  }
+#endif
+
+  if (dlc < GSM_CMUX_DLC_DATA || cid >= GSM_TCP_MAX_SOCKETS) {
+    return false;
+  }
+
+  if (xSemaphoreTake(gsm->tcp.tcp_mutex, portMAX_DELAY) == pdTRUE) {
+    gsm_tcp_socket_t *socket = &gsm->tcp.sockets[cid];
+
+    socket->state = GSM_TCP_STATE_CONNECTED;
+    socket->opens++;
+    socket->rx_pend = 0;
+    socket->dlc = dlc;
+    gsm->mux.data[dlc] = true;
+    if (socket->open_sem) {
+      xSemaphoreGive(socket->open_sem);
+    }
+    xSemaphoreGive(gsm->tcp.tcp_mutex);
+  }
+
+  LOG_INFO("CMUX DLC%d transparent 연결 (cid=%d)", dlc, cid);
+  if (gsm->evt_handler.handler) {
+    gsm->evt_handler.handler(GSM_EVT_TCP_CONNECTED, &cid);
+  }
+  return true;
+}
+
+/**
+ * @brief transparent 소켓 송신 (AT 큐를 거치지 않고 바로 채널로)
+ *
+ * @return 0: 보냄 (완료 콜백은 여기서 부름), -1: 모뎀이 흐름 제어 중
+ */
+static int gsm_mux_send_chain(gsm_t *gsm, uint8_t cid, uint8_t dlc,
+                              tcp_pbuf_t *chain, uint16_t len, bool pool,
+                              tcp_sent_cb_t cb, void *ctx) {
+  gsm_tcp_tx_t done = {
+      .chain = chain, .len = len, .pool = pool, .cb = cb, .ctx = ctx};
+  bool ok = true;
+
+  if (!cmux_writable(&gsm->mux.cmux, dlc)) {
+    return -1;
+  }
+
+  for (tcp_pbuf_t *p = chain; p && ok; p = p->next) {
+    ok = cmux_write(&gsm->mux.cmux, dlc, p->payload, p->len) == 0;
+  }
+
+  tcp_tx_finish(cid, &done, 1, ok);
+  return 0;
+}
+#else
+static bool gsm_mux_connect(gsm_t *gsm) { return false; }
+static uint8_t gsm_mux_alloc(gsm_t *gsm, uint8_t cid) { return 0; }
+static void gsm_mux_release(gsm_t *gsm, gsm_tcp_socket_t *socket) {
+  socket->dlc = 0;
+}
+#endif
+
+int gsm_at_send(gsm_t *gsm, const gsm_at_cmd_t *cmd, const void *data,
+                size_t len) {
+#if GSM_CMUX_ENABLE
+  gsm_mux_t *m = &gsm->mux;
+
+  if (m->cmux.active) {
+    uint8_t dlc = (cmd && cmd->dlc) ? cmd->dlc : GSM_CMUX_DLC_AT;
+
+    if (!m->up && dlc == GSM_CMUX_DLC_AT) {
+      // SABM 응답 대기 (거절되면 gsm_mux_start 의 done 이 다중화를 끈다)
+      xSemaphoreTake(m->open_sem, pdMS_TO_TICKS(GSM_CMUX_OPEN_TIMEOUT_MS));
+    }
+    if (m->cmux.active) {
+      m->at_dlc = dlc;
+      return cmux_write(&m->cmux, dlc, data, len);
+    }
+  }
+#endif
+  return gsm->ops->send(data, len);
+}
+
+void gsm_mux_start(gsm_t *gsm, void (*done)(gsm_t *gsm, bool ok)) {
+#if GSM_CMUX_ENABLE
+  gsm_mux_t *m = &gsm->mux;
+
+  m->done = done;
+  m->up = false;
+  m->at_dlc = GSM_CMUX_DLC_AT;
+  m->rx_dlc = GSM_CMUX_DLC_AT;
+  memset((void *)m->data, 0, sizeof(m->data));
+  memset(m->recv, 0, sizeof(m->recv));
+  xSemaphoreTake(m->open_sem, 0);
+
+  cmux_start(&m->cmux);
+  if (cmux_open(&m->cmux, 0) != 0) {
+    gsm_mux_done(gsm, false);
+  }
+#else
+  if (done) {
+    done(gsm, false);
+  }
+#endif
+}
+
+void gsm_mux_stop(gsm_t *gsm, bool send) {
+#if GSM_CMUX_ENABLE
+  gsm_mux_t *m = &gsm->mux;
+
+  if (!m->cmux.active) {
+    return;
+  }
+
+  LOG_INFO("CMUX 종료%s", send ? " (CLD)" : "");
+  m->done = NULL;
+  cmux_stop(&m->cmux, send);
+  m->up = false;
+#if GSM_PPP_ENABLE
+  // 다시 초기화하는 중이므로 PDP_DEACT 는 알리지 않는다
+  m->data[GSM_CMUX_DLC_PPP] = false;
+  gsm_ppp_carrier_lost(gsm, false);
+#endif
+  // DLC 1 을 기다리던 송신은 UART 로 바로 나간다
+  xSemaphoreGive(m->open_sem);
+#endif
+}
+
+void gsm_mux_set_dtr(gsm_t *gsm, uint8_t dlc, bool on) {
+#if GSM_CMUX_ENABLE
+  if (gsm->mux.cmux.active && dlc > 0 && dlc < CMUX_DLC_MAX) {
+    cmux_msc(&gsm->mux.cmux, dlc,
+             (on ? CMUX_V24_RTC : 0) | CMUX_V24_RTR | CMUX_V24_DV);
+  }
+#endif
+}
 
-    if (*d == '>' && recv_payload_len(gsm) == 0) {
-      if (xSemaphoreTake(gsm->cmd_mutex, portMAX_DELAY) == pdTRUE) {
-        if (gsm->current_cmd && gsm->current_cmd->cmd == GSM_CMD_QISEND &&
-            gsm->current_cmd->wait_type == GSM_WAIT_PROMPT) {
-          if (gsm->current_cmd->tx_pbuf) {
-            tcp_pbuf_t *pbuf = gsm->current_cmd->tx_pbuf;
-            gsm->ops->send((const char *)pbuf->payload, pbuf->len);
-          }
-          gsm->current_cmd->wait_type = GSM_WAIT_EXPECTED;
-        }
-        xSemaphoreGive(gsm->cmd_mutex);
-      }
-      continue;
-    }
+bool gsm_mux_is_up(gsm_t *gsm) {
+#if GSM_CMUX_ENABLE
+  return gsm->mux.up;
+#else
+  return false;
+#endif
+}
 
-    if (*d != '\r' && *d != '\n') {
-      if (IS_ASCII(*d)) {
-        add_payload(gsm, *d);
-      }
-    }
+void gsm_send_at_cmux(gsm_t *gsm, uint32_t baudrate, at_cmd_handler callback) {
+  // 27.007 port_speed: 1 9600 ~ 8 921600
+  static const uint32_t speeds[] = {9600,   19200,  38400,  57600,
+                                    115200, 230400, 460800, 921600};
+  char params[24];
+  int speed = 5;
 
-    if (ch_prev1 == '\r' && *d == '\n') {
-      if (recv_payload_len(gsm)) {
-        gsm_parse_response(gsm);
-        clear_payload(gsm);
-      }
+  for (size_t i = 0; i < sizeof(speeds) / sizeof(speeds[0]); i++) {
+    if (speeds[i] == baudrate) {
+      speed = (int)i + 1;
     }
-
-    ch_prev1 = *d;
   }
+
+  snprintf(params, sizeof(params), "0,0,%d,%d", speed, GSM_CMUX_N1);
+  gsm_send_at_cmd(gsm, GSM_CMD_CMUX, GSM_AT_WRITE, params, callback);
+}
+
+void gsm_send_at_dial(gsm_t *gsm, uint8_t dlc, uint8_t cid,
+                      at_cmd_handler callback) {
+  gsm_at_cmd_t msg = {
+      .at_mode = GSM_AT_EXECUTE,
+      .cmd = GSM_CMD_ATD,
+      .wait_type = GSM_WAIT_NONE,
+      .callback = callback,
+      .sem = NULL,
+      .tx_pbuf = NULL,
+      .dlc = dlc,
+  };
+
+  snprintf(msg.params, GSM_AT_CMD_PARAM_SIZE, "*99***%d#", cid);
+  gsm_at_cmd_enqueue(gsm, &msg);
 }
 
 /**
@@ -726,16 +1664,16 @@ void gsm_send_at_cmd(gsm_t *gsm, gsm_cmd_t cmd, gsm_at_mode_t at_mode,
 
   if (callback) {
     msg.callback = callback;
-    xQueueSend(gsm->at_cmd_queue, &msg, portMAX_DELAY);
+    gsm_at_cmd_enqueue(gsm, &msg);
   } else {
     gsm->status.is_ok = 0;
     gsm->status.is_err = 0;
     gsm->status.is_timeout = 0;
 
-    msg.sem = xSemaphoreCreateBinary();
+    msg.sem = HEAP_TRACK(HEAP_TAG_CMD_SEM, xSemaphoreCreateBinary());
     SemaphoreHandle_t sem = msg.sem;
 
-    xQueueSend(gsm->at_cmd_queue, &msg, portMAX_DELAY);
+    gsm_at_cmd_enqueue(gsm, &msg);
 
     uint32_t timeout_ms = gsm->at_tbl[cmd].timeout_ms;
     if (timeout_ms == 0)
@@ -806,16 +1744,16 @@ void gsm_send_at_cgdcont(gsm_t *gsm, gsm_at_mode_t at_mode,
 
   if (callback) {
     msg.callback = callback;
-    xQueueSend(gsm->at_cmd_queue, &msg, portMAX_DELAY);
+    gsm_at_cmd_enqueue(gsm, &msg);
   } else {
     gsm->status.is_ok = 0;
     gsm->status.is_err = 0;
     gsm->status.is_timeout = 0;
 
-    msg.sem = xSemaphoreCreateBinary();
+    msg.sem = HEAP_TRACK(HEAP_TAG_CMD_SEM, xSemaphoreCreateBinary());
     SemaphoreHandle_t sem = msg.sem;
 
-    xQueueSend(gsm->at_cmd_queue, &msg, portMAX_DELAY);
+    gsm_at_cmd_enqueue(gsm, &msg);
 
     uint32_t timeout_ms = gsm->at_tbl[GSM_CMD_CGDCONT].timeout_ms;
     if (timeout_ms == 0)
@@ -835,23 +1773,16 @@ void gsm_send_at_cgdcont(gsm_t *gsm, gsm_at_mode_t at_mode,
   }
 }
 
-int gsm_uart_send(const char *data, size_t len) {
-  for (int i = 0; i < len; i++) {
-    while (!LL_USART_IsActiveFlag_TXE(USART1))
-      ;
-    LL_USART_TransmitData8(USART1, *(data + i));
-  }
-
-  while (!LL_USART_IsActiveFlag_TC(USART1))
-    ;
-
-  return 0;
-}
-
 extern int gsm_port_reset(void);
+extern int gsm_port_send(const char *data, size_t len);
+extern int gsm_port_sendv(const cmux_seg_t *seg, size_t cnt);
+extern int gsm_port_set_baudrate(uint32_t baudrate);
 
-static const gsm_hal_ops_t stm32_hal_ops = {.reset = gsm_port_reset,
-                                            .send = gsm_uart_send};
+static const gsm_hal_ops_t stm32_hal_ops = {
+    .reset = gsm_port_reset,
+    .send = gsm_port_send,
+    .sendv = gsm_port_sendv,
+    .set_baudrate = gsm_port_set_baudrate};
 
 void gsm_init(gsm_t *gsm, evt_handler_t handler, void *args) {
   memset(gsm, 0, sizeof(gsm_t));
@@ -867,21 +1798,140 @@ void gsm_init(gsm_t *gsm, evt_handler_t handler, void *args) {
   gsm->at_tbl = gsm_at_cmd_handlers;
   gsm->urc_stat_tbl = urc_status_handlers;
   gsm->urc_info_tbl = urc_info_handlers;
+  gsm->urc_stat_cnt = urc_table_count(urc_status_handlers);
+  gsm->urc_info_cnt = urc_table_count(urc_info_handlers);
 
   gsm->ops = &stm32_hal_ops;
-  gsm->at_cmd_queue = xQueueCreate(9, sizeof(gsm_at_cmd_t));
+  tcp_pbuf_pool_init();
+  gsm->at_cmd_queue[GSM_AT_LANE_DATA] =
+      xQueueCreate(GSM_AT_QUEUE_DATA_DEPTH, sizeof(gsm_at_cmd_t));
+  gsm->at_cmd_queue[GSM_AT_LANE_CTRL] =
+      xQueueCreate(GSM_AT_QUEUE_CTRL_DEPTH, sizeof(gsm_at_cmd_t));
+  gsm->at_cmd_signal = xSemaphoreCreateBinary();
+  gsm->dns.sem = xSemaphoreCreateBinary();
+  gsm->dns.pending = false;
+  memset(gsm->at_lane_stats, 0, sizeof(gsm->at_lane_stats));
+
+#if GSM_CMUX_ENABLE
+  cmux_init(&gsm->mux.cmux, &gsm_mux_ops, gsm, GSM_CMUX_N1);
+  gsm->mux.open_sem = xSemaphoreCreateBinary();
+  gsm->mux.at_dlc = GSM_CMUX_DLC_AT;
+  gsm->mux.rx_dlc = GSM_CMUX_DLC_AT;
+#endif
 
   gsm_tcp_init(gsm);
+#if GSM_PPP_ENABLE
+  gsm_ppp_init(gsm);
+#endif
+}
+
+/**
+ * @brief pbuf 풀
+ *
+ * 헤더는 SRAM, payload 는 CCM 에 둔다. 송신 pbuf 는 uart_tx_send() 가
+ * CCM 버퍼를 bounce 로 복사해서 DMA 하므로 CCM 이어도 된다.
+ * 빈 블록은 pbuf->next 로 등급별 free list 를 이룬다.
+ */
+#define TCP_PBUF_POOL_CNT                                                      \
+  (GSM_TCP_PBUF_SMALL_CNT + GSM_TCP_PBUF_MID_CNT + GSM_TCP_PBUF_LARGE_CNT)
+
+CCM_BSS static uint8_t
+    tcp_pbuf_small_mem[GSM_TCP_PBUF_SMALL_CNT][GSM_TCP_PBUF_SMALL_SIZE];
+CCM_BSS static uint8_t
+    tcp_pbuf_mid_mem[GSM_TCP_PBUF_MID_CNT][GSM_TCP_PBUF_MID_SIZE];
+// large 등급(약 19KB)은 CCM 예산을 넘기므로 SRAM
+static uint8_t
+    tcp_pbuf_large_mem[GSM_TCP_PBUF_LARGE_CNT][GSM_TCP_PBUF_LARGE_SIZE];
+
+static tcp_pbuf_t tcp_pbuf_hdr[TCP_PBUF_POOL_CNT];
+
+static struct {
+  tcp_pbuf_t *free_list;
+  uint16_t first; ///< tcp_pbuf_hdr 에서 이 등급의 시작 index
+  tcp_pbuf_pool_stats_t stats;
+} tcp_pbuf_pool[GSM_TCP_PBUF_CLASS_CNT] = {
+    {.first = 0,
+     .stats = {.size = GSM_TCP_PBUF_SMALL_SIZE,
+               .total = GSM_TCP_PBUF_SMALL_CNT}},
+    {.first = GSM_TCP_PBUF_SMALL_CNT,
+     .stats = {.size = GSM_TCP_PBUF_MID_SIZE, .total = GSM_TCP_PBUF_MID_CNT}},
+    {.first = GSM_TCP_PBUF_SMALL_CNT + GSM_TCP_PBUF_MID_CNT,
+     .stats = {.size = GSM_TCP_PBUF_LARGE_SIZE,
+               .total = GSM_TCP_PBUF_LARGE_CNT}},
+};
+
+static bool tcp_pbuf_pool_ready;
+
+/**
+ * @brief 블록 시작 주소 (PPP 수신은 payload 를 IP/TCP 헤더 뒤로 옮겨 넘긴다)
+ */
+static uint8_t *tcp_pbuf_mem(uint8_t c, uint16_t i) {
+  if (c == 0) {
+    return tcp_pbuf_small_mem[i];
+  } else if (c == 1) {
+    return tcp_pbuf_mid_mem[i];
+  }
+  return tcp_pbuf_large_mem[i];
+}
+
+void tcp_pbuf_pool_init(void) {
+  if (tcp_pbuf_pool_ready) {
+    return;
+  }
+
+  for (uint8_t c = 0; c < GSM_TCP_PBUF_CLASS_CNT; c++) {
+    tcp_pbuf_pool[c].free_list = NULL;
+
+    for (uint16_t i = 0; i < tcp_pbuf_pool[c].stats.total; i++) {
+      tcp_pbuf_t *pbuf = &tcp_pbuf_hdr[tcp_pbuf_pool[c].first + i];
+
+      pbuf->payload = tcp_pbuf_mem(c, i);
+      pbuf->len = 0;
+      pbuf->tot_len = 0;
+      pbuf->next = tcp_pbuf_pool[c].free_list;
+      tcp_pbuf_pool[c].free_list = pbuf;
+    }
+    tcp_pbuf_pool[c].stats.free = tcp_pbuf_pool[c].stats.total;
+    tcp_pbuf_pool[c].stats.min_free = tcp_pbuf_pool[c].stats.total;
+  }
+
+  tcp_pbuf_pool_ready = true;
 }
 
 tcp_pbuf_t *tcp_pbuf_alloc(size_t len) {
-  tcp_pbuf_t *pbuf = (tcp_pbuf_t *)pvPortMalloc(sizeof(tcp_pbuf_t));
-  if (!pbuf)
+  tcp_pbuf_t *pbuf = NULL;
+  uint8_t c = 0;
+
+  while (c < GSM_TCP_PBUF_CLASS_CNT && len > tcp_pbuf_pool[c].stats.size) {
+    c++;
+  }
+  if (c == GSM_TCP_PBUF_CLASS_CNT || !tcp_pbuf_pool_ready) {
     return NULL;
+  }
+
+  // BASEPRI 마스크만 쓰므로 태스크/ISR 어디서 불러도 된다
+  UBaseType_t saved = taskENTER_CRITICAL_FROM_ISR();
+  for (uint8_t k = c; k < GSM_TCP_PBUF_CLASS_CNT; k++) {
+    pbuf = tcp_pbuf_pool[k].free_list;
+    if (pbuf) {
+      tcp_pbuf_pool_stats_t *st = &tcp_pbuf_pool[k].stats;
+
+      tcp_pbuf_pool[k].free_list = pbuf->next;
+      if (--st->free < st->min_free) {
+        st->min_free = st->free;
+      }
+      if (k != c) {
+        tcp_pbuf_pool[c].stats.borrowed++;
+      }
+      break;
+    }
+  }
+  if (!pbuf) {
+    tcp_pbuf_pool[c].stats.exhausted++;
+  }
+  taskEXIT_CRITICAL_FROM_ISR(saved);
 
-  pbuf->payload = (uint8_t *)pvPortMalloc(len);
-  if (!pbuf->payload) {
-    vPortFree(pbuf);
+  if (!pbuf) {
     return NULL;
   }
 
@@ -896,10 +1946,34 @@ void tcp_pbuf_free(tcp_pbuf_t *pbuf) {
   if (!pbuf)
     return;
 
-  if (pbuf->payload) {
-    vPortFree(pbuf->payload);
+  if (pbuf < &tcp_pbuf_hdr[0] || pbuf >= &tcp_pbuf_hdr[TCP_PBUF_POOL_CNT]) {
+    return;
+  }
+
+  uint16_t idx = (uint16_t)(pbuf - tcp_pbuf_hdr);
+  uint8_t c = GSM_TCP_PBUF_CLASS_CNT - 1;
+  while (c > 0 && idx < tcp_pbuf_pool[c].first) {
+    c--;
+  }
+
+  pbuf->payload = tcp_pbuf_mem(c, (uint16_t)(idx - tcp_pbuf_pool[c].first));
+
+  UBaseType_t saved = taskENTER_CRITICAL_FROM_ISR();
+  pbuf->next = tcp_pbuf_pool[c].free_list;
+  tcp_pbuf_pool[c].free_list = pbuf;
+  tcp_pbuf_pool[c].stats.free++;
+  taskEXIT_CRITICAL_FROM_ISR(saved);
+}
+
+bool tcp_pbuf_pool_get_stats(uint8_t cls, tcp_pbuf_pool_stats_t *out) {
+  if (cls >= GSM_TCP_PBUF_CLASS_CNT || !out) {
+    return false;
   }
-  vPortFree(pbuf);
+
+  UBaseType_t saved = taskENTER_CRITICAL_FROM_ISR();
+  *out = tcp_pbuf_pool[cls].stats;
+  taskEXIT_CRITICAL_FROM_ISR(saved);
+  return true;
 }
 
 void tcp_pbuf_free_chain(tcp_pbuf_t *pbuf) {
@@ -957,40 +2031,112 @@ tcp_pbuf_t *tcp_pbuf_dequeue(gsm_tcp_socket_t *socket) {
   return pbuf;
 }
 
-static void tcp_read_complete_callback(gsm_t *gsm, gsm_cmd_t cmd, void *msg,
-                                       bool is_ok) {
-  if (!is_ok || !msg || cmd != GSM_CMD_QIRD)
-    return;
+/**
+ * @brief 소켓 사용량 누적 (파서/AT/호출 태스크가 함께 쓰므로 원자적으로)
+ */
+void gsm_tcp_usage_add(gsm_tcp_socket_t *socket, bool rx, size_t len) {
+  __atomic_fetch_add(rx ? &socket->rx_bytes : &socket->tx_bytes, (uint32_t)len,
+                     __ATOMIC_RELAXED);
+  __atomic_fetch_add(rx ? &socket->rx_segs : &socket->tx_segs, 1, __ATOMIC_RELAXED);
+}
 
-  gsm_msg_t *m = (gsm_msg_t *)msg;
+/**
+ * @brief 수신 데이터를 sink 또는 소켓 pbuf 큐로 전달
+ *
+ * QIRD 완료 콜백과 direct push 완료 시 모두 파서 태스크에서 불린다.
+ *
+ * @return true: 전달됨, false: 잘못된 소켓이거나 pbuf pool 이 비어 버림
+ */
+static bool tcp_deliver(gsm_t *gsm, uint8_t cid, const uint8_t *data,
+                        size_t len) {
+  if (cid >= GSM_TCP_MAX_SOCKETS || len == 0) {
+    return false;
+  }
+
+  // 버려도 모뎀은 이미 받았으므로 먼저 센다
+  gsm_tcp_usage_add(&gsm->tcp.sockets[cid], true, len);
 
   if (xSemaphoreTake(gsm->tcp.tcp_mutex, portMAX_DELAY) == pdTRUE) {
-    uint8_t cid = m->qird.connect_id;
+    gsm_tcp_socket_t *socket = &gsm->tcp.sockets[cid];
+    tcp_sink_t sink = socket->sink;
 
-    if (cid < GSM_TCP_MAX_SOCKETS && m->qird.read_actual_length > 0) {
-      gsm_tcp_socket_t *socket = &gsm->tcp.sockets[cid];
+    if (sink) {
+      // pbuf 할당/복사 없이 수신 버퍼에서 바로 넘긴다
+      void *ctx = socket->sink_ctx;
 
-      // pbuf 할당 및 데이터 복사
-      tcp_pbuf_t *pbuf = tcp_pbuf_alloc(m->qird.read_actual_length);
-      if (pbuf) {
-        memcpy(pbuf->payload, m->qird.data, m->qird.read_actual_length);
+      xSemaphoreGive(gsm->tcp.tcp_mutex);
 
-        tcp_pbuf_enqueue(socket, pbuf);
+      sink(data, len, ctx);
+      return true;
+    }
 
-        tcp_recv_callback_t on_recv = socket->on_recv;
+    // pbuf 할당 및 데이터 복사 (large 등급은 SRAM 이라 긴 segment 는 DMA)
+    tcp_pbuf_t *pbuf = tcp_pbuf_alloc(len);
+    if (pbuf) {
+      dma_copy(pbuf->payload, data, len);
 
-        xSemaphoreGive(gsm->tcp.tcp_mutex);
+      tcp_pbuf_enqueue(socket, pbuf);
 
-        if (on_recv) {
-          on_recv(cid);
-        }
-        tcp_event_t evt = {.type = TCP_EVT_CONTINUE_READ, .connect_id = cid};
-        xQueueSend(gsm->tcp.event_queue, &evt, 0);  // ⭐ 추가
-        return;
+      tcp_recv_callback_t on_recv = socket->on_recv;
+
+      xSemaphoreGive(gsm->tcp.tcp_mutex);
+
+      if (on_recv) {
+        on_recv(cid);
       }
+      return true;
     }
+    LOG_WARN("TCP pbuf pool empty - dropped %u bytes (cid=%d)",
+             (unsigned)len, cid);
     xSemaphoreGive(gsm->tcp.tcp_mutex);
   }
+
+  return false;
+}
+
+bool gsm_tcp_get_usage(gsm_t *gsm, uint8_t connect_id, gsm_tcp_usage_t *out) {
+  if (!gsm || connect_id >= GSM_TCP_MAX_SOCKETS) {
+    return false;
+  }
+
+  const gsm_tcp_socket_t *socket = &gsm->tcp.sockets[connect_id];
+
+  out->rx_bytes = socket->rx_bytes;
+  out->tx_bytes = socket->tx_bytes;
+  out->rx_segs = socket->rx_segs;
+  out->tx_segs = socket->tx_segs;
+  out->opens = socket->opens;
+  return true;
+}
+
+static void tcp_read_complete_callback(gsm_t *gsm, gsm_cmd_t cmd, void *msg,
+                                       bool is_ok) {
+  gsm_msg_t *m = (gsm_msg_t *)msg;
+
+  if (cmd != GSM_CMD_QIRD)
+    return;
+
+  // ERROR/타임아웃은 어느 소켓인지 모르므로 걸린 소켓을 모두 내려놓는다
+  // (아직 남은 QIRD 는 끝날 때 다시 내려놓을 뿐)
+  if (!is_ok || !m) {
+    for (uint8_t i = 0; i < GSM_TCP_MAX_SOCKETS; i++) {
+      if (gsm->tcp.sockets[i].rx_pend & TCP_RX_READING) {
+        tcp_rx_done(gsm, i, false);
+      }
+    }
+    return;
+  }
+
+  uint8_t cid = m->qird.connect_id;
+
+  // 요청보다 적게 왔으면 모뎀 버퍼가 비었고, 다음 데이터는 새 +QIURC "recv"
+  // 로 알려 온다. 다 채워 왔을 때만 남은 것을 이어 읽어서 빈 QIRD 왕복을 없앤다.
+  bool more = tcp_deliver(gsm, cid, m->qird.data, m->qird.read_actual_length) &&
+              m->qird.read_actual_length >= m->qird.req_length;
+
+  if (cid < GSM_TCP_MAX_SOCKETS) {
+    tcp_rx_done(gsm, cid, more);
+  }
 }
 
 
@@ -1001,9 +2147,17 @@ static void gsm_tcp_task(void *arg) {
   while (1) {
     if (xQueueReceive(gsm->tcp.event_queue, &evt, portMAX_DELAY) == pdTRUE) {
       switch (evt.type) {
-      case TCP_EVT_RECV_NOTIFY: {
+      case TCP_EVT_RECV_NOTIFY:
+      case TCP_EVT_CONTINUE_READ: {
         if (evt.connect_id < GSM_TCP_MAX_SOCKETS) {
-          gsm_tcp_read(gsm, evt.connect_id, 1460, tcp_read_complete_callback);
+          gsm_tcp_socket_t *socket = &gsm->tcp.sockets[evt.connect_id];
+
+          // 여기까지 온 알림은 이 QIRD 한 번이 다 읽는다
+          __atomic_fetch_and(&socket->rx_pend, (uint8_t)~TCP_RX_AGAIN, __ATOMIC_ACQ_REL);
+          if (gsm_tcp_read(gsm, evt.connect_id, GSM_TCP_READ_MAX,
+                           tcp_read_complete_callback) != 0) {
+            __atomic_store_n(&socket->rx_pend, 0, __ATOMIC_RELEASE);
+          }
         }
         break;
       }
@@ -1021,12 +2175,17 @@ static void gsm_tcp_task(void *arg) {
 
             // 소켓 초기화
             socket->state = GSM_TCP_STATE_CLOSED;
+            socket->rx_pend = 0;
             tcp_close_callback_t on_close = socket->on_close;
             socket->on_recv = NULL;
             socket->on_close = NULL;
+            socket->sink = NULL;
+            gsm_mux_release(gsm, socket);
 
             xSemaphoreGive(gsm->tcp.tcp_mutex);
 
+            tcp_tx_flush(gsm, evt.connect_id);
+
             if (on_close) {
               on_close(evt.connect_id);
             }
@@ -1037,13 +2196,6 @@ static void gsm_tcp_task(void *arg) {
         break;
       }
 
-      case TCP_EVT_CONTINUE_READ: {
-        if (evt.connect_id < GSM_TCP_MAX_SOCKETS) {
-          gsm_tcp_read(gsm, evt.connect_id, 1460, tcp_read_complete_callback);
-        }
-        break;
-      }
-
       default:
         break;
       }
@@ -1063,19 +2215,26 @@ void gsm_tcp_init(gsm_t *gsm) {
     gsm->tcp.sockets[i].remote_ip[0] = '\0';
     gsm->tcp.sockets[i].remote_port = 0;
     gsm->tcp.sockets[i].local_port = 0;
+    gsm->tcp.sockets[i].access_mode = GSM_TCP_ACCESS_BUFFER;
     gsm->tcp.sockets[i].pbuf_head = NULL;
     gsm->tcp.sockets[i].pbuf_tail = NULL;
     gsm->tcp.sockets[i].pbuf_total_len = 0;
     gsm->tcp.sockets[i].on_recv = NULL;
     gsm->tcp.sockets[i].on_close = NULL;
+    gsm->tcp.sockets[i].sink = NULL;
+    gsm->tcp.sockets[i].sink_ctx = NULL;
+    gsm->tcp.sockets[i].tx_head = 0;
+    gsm->tcp.sockets[i].tx_count = 0;
+    gsm->tcp.sockets[i].tx_busy = 0;
+    gsm->tcp.sockets[i].tx_cmds = 0;
   }
 
   memset(&gsm->tcp.buffer, 0, sizeof(gsm_tcp_buffer_t));
 
   gsm->tcp.event_queue = xQueueCreate(10, sizeof(tcp_event_t));
 
-  xTaskCreate(gsm_tcp_task, "gsm_tcp", 1536, gsm, tskIDLE_PRIORITY + 3,
-              &gsm->tcp.task_handle);
+  HEAP_TRACK(HEAP_TAG_TASK, xTaskCreate(gsm_tcp_task, "gsm_tcp", 1536, gsm,
+                                        tskIDLE_PRIORITY + 3, &gsm->tcp.task_handle));
 }
 
 gsm_tcp_socket_t *gsm_tcp_get_socket(gsm_t *gsm, uint8_t connect_id) {
@@ -1086,6 +2245,23 @@ gsm_tcp_socket_t *gsm_tcp_get_socket(gsm_t *gsm, uint8_t connect_id) {
   return &gsm->tcp.sockets[connect_id];
 }
 
+int gsm_tcp_notify_closed(gsm_t *gsm, uint8_t connect_id) {
+  if (!gsm || connect_id >= GSM_TCP_MAX_SOCKETS) {
+    return -1;
+  }
+
+  tcp_event_t evt = {.type = TCP_EVT_CLOSED_NOTIFY, .connect_id = connect_id};
+  if (xQueueSend(gsm->tcp.event_queue, &evt, pdMS_TO_TICKS(10)) != pdTRUE) {
+    return -1;
+  }
+
+  if (gsm->evt_handler.handler) {
+    gsm->evt_handler.handler(GSM_EVT_TCP_CLOSED, &connect_id);
+  }
+
+  return 0;
+}
+
 int gsm_tcp_open(gsm_t *gsm, uint8_t connect_id, uint8_t context_id,
                  const char *remote_ip, uint16_t remote_port,
                  uint16_t local_port, tcp_recv_callback_t on_recv,
@@ -1109,8 +2285,13 @@ int gsm_tcp_open(gsm_t *gsm, uint8_t connect_id, uint8_t context_id,
     socket->local_port = local_port;
     socket->on_recv = on_recv;
     socket->on_close = on_close;
+    socket->sink = NULL;
+    socket->sink_ctx = NULL;
+    socket->dlc = socket->access_mode == GSM_TCP_ACCESS_PUSH
+                      ? gsm_mux_alloc(gsm, connect_id)
+                      : 0;
 
-    socket->open_sem = xSemaphoreCreateBinary();
+    socket->open_sem = HEAP_TRACK(HEAP_TAG_CMD_SEM, xSemaphoreCreateBinary());
 
     xSemaphoreGive(gsm->tcp.tcp_mutex);
   }
@@ -1122,23 +2303,28 @@ int gsm_tcp_open(gsm_t *gsm, uint8_t connect_id, uint8_t context_id,
       .callback = callback,
       .sem = NULL,
       .tx_pbuf = NULL,
+      .tx_cid = connect_id,
+      .dlc = socket->dlc,
   };
 
-  snprintf(msg.params, GSM_AT_CMD_PARAM_SIZE, "%d,%d,\"TCP\",\"%s\",%d,%d,0",
-           context_id, connect_id, remote_ip, remote_port, local_port);
+  // 데이터 채널을 받았으면 그 채널에서 transparent 로 연다 (CONNECT 응답)
+  snprintf(msg.params, GSM_AT_CMD_PARAM_SIZE, "%d,%d,\"TCP\",\"%s\",%d,%d,%d",
+           context_id, connect_id, remote_ip, remote_port, local_port,
+           socket->dlc ? (int)GSM_TCP_ACCESS_TRANSPARENT
+                       : (int)socket->access_mode);
 
   if (callback) {
-    xQueueSend(gsm->at_cmd_queue, &msg, portMAX_DELAY);
+    gsm_at_cmd_enqueue(gsm, &msg);
     return 0;
   } else {
     gsm->status.is_ok = 0;
     gsm->status.is_err = 0;
     gsm->status.is_timeout = 0;
 
-    msg.sem = xSemaphoreCreateBinary();
+    msg.sem = HEAP_TRACK(HEAP_TAG_CMD_SEM, xSemaphoreCreateBinary());
     SemaphoreHandle_t sem = msg.sem;
 
-    xQueueSend(gsm->at_cmd_queue, &msg, portMAX_DELAY);
+    gsm_at_cmd_enqueue(gsm, &msg);
 
     uint32_t timeout_ms = gsm->at_tbl[GSM_CMD_QIOPEN].timeout_ms;
     if (timeout_ms == 0)
@@ -1198,10 +2384,13 @@ int gsm_tcp_close(gsm_t *gsm, uint8_t connect_id, at_cmd_handler callback) {
       vSemaphoreDelete(socket->close_sem);
     }
 
-    socket->close_sem = xSemaphoreCreateBinary();
+    socket->close_sem = HEAP_TRACK(HEAP_TAG_CMD_SEM, xSemaphoreCreateBinary());
     xSemaphoreGive(gsm->tcp.tcp_mutex);
   }
 
+  // CLOSING 이후로는 새 쓰기가 들어오지 않는다
+  tcp_tx_flush(gsm, connect_id);
+
   gsm_at_cmd_t msg = {
       .at_mode = GSM_AT_WRITE,
       .cmd = GSM_CMD_QICLOSE,
@@ -1214,17 +2403,17 @@ int gsm_tcp_close(gsm_t *gsm, uint8_t connect_id, at_cmd_handler callback) {
   snprintf(msg.params, GSM_AT_CMD_PARAM_SIZE, "%d,0", connect_id);
 
   if (callback) {
-    xQueueSend(gsm->at_cmd_queue, &msg, portMAX_DELAY);
+    gsm_at_cmd_enqueue(gsm, &msg);
     return 0;
   } else {
     gsm->status.is_ok = 0;
     gsm->status.is_err = 0;
     gsm->status.is_timeout = 0;
 
-    msg.sem = xSemaphoreCreateBinary();
+    msg.sem = HEAP_TRACK(HEAP_TAG_CMD_SEM, xSemaphoreCreateBinary());
     SemaphoreHandle_t sem = msg.sem;
 
-    xQueueSend(gsm->at_cmd_queue, &msg, portMAX_DELAY);
+    gsm_at_cmd_enqueue(gsm, &msg);
 
     uint32_t timeout_ms = gsm->at_tbl[GSM_CMD_QICLOSE].timeout_ms;
     if (timeout_ms == 0)
@@ -1272,6 +2461,73 @@ int gsm_tcp_close(gsm_t *gsm, uint8_t connect_id, at_cmd_handler callback) {
   return 0;
 }
 
+void gsm_tcp_set_sink(gsm_t *gsm, uint8_t connect_id, tcp_sink_t sink,
+                      void *ctx) {
+  if (!gsm || connect_id >= GSM_TCP_MAX_SOCKETS) {
+    return;
+  }
+
+  if (xSemaphoreTake(gsm->tcp.tcp_mutex, portMAX_DELAY) == pdTRUE) {
+    gsm->tcp.sockets[connect_id].sink_ctx = ctx;
+    gsm->tcp.sockets[connect_id].sink = sink;
+    xSemaphoreGive(gsm->tcp.tcp_mutex);
+  }
+}
+
+int gsm_dns_resolve(gsm_t *gsm, uint8_t context_id, const char *host,
+                    char *addr, size_t size, uint32_t timeout_ms) {
+#if GSM_PPP_ENABLE
+  // 모뎀 소켓을 쓰지 않으므로 IPCP 로 받은 DNS 서버에 직접 묻는다
+  (void)context_id;
+  return gsm_ppp_dns_resolve(gsm, host, addr, size, timeout_ms);
+#else
+  char params[GSM_AT_CMD_PARAM_SIZE];
+
+  if (!gsm || !host || !addr || size == 0 || !gsm->dns.sem) {
+    return -1;
+  }
+
+  if (snprintf(params, sizeof(params), "%d,\"%s\"", context_id, host) >=
+      (int)sizeof(params)) {
+    return -1;
+  }
+
+  // 이전 조회의 늦은 결과 정리
+  xSemaphoreTake(gsm->dns.sem, 0);
+  gsm->dns.addr[0] = '\0';
+  gsm->dns.err = -1;
+  gsm->dns.pending = true;
+
+  gsm_send_at_cmd(gsm, GSM_CMD_QIDNSGIP, GSM_AT_WRITE, params, NULL);
+
+  if (!gsm->status.is_ok ||
+      xSemaphoreTake(gsm->dns.sem, pdMS_TO_TICKS(timeout_ms)) != pdTRUE) {
+    gsm->dns.pending = false;
+    return -1;
+  }
+
+  if (gsm->dns.err != 0 || gsm->dns.addr[0] == '\0') {
+    LOG_WARN("DNS 조회 실패: %s (err=%ld)", host, (long)gsm->dns.err);
+    return -1;
+  }
+
+  snprintf(addr, size, "%s", gsm->dns.addr);
+  return 0;
+#endif
+}
+
+void gsm_tcp_set_access_mode(gsm_t *gsm, uint8_t connect_id,
+                             gsm_tcp_access_t mode) {
+  if (!gsm || connect_id >= GSM_TCP_MAX_SOCKETS) {
+    return;
+  }
+
+  if (xSemaphoreTake(gsm->tcp.tcp_mutex, portMAX_DELAY) == pdTRUE) {
+    gsm->tcp.sockets[connect_id].access_mode = mode;
+    xSemaphoreGive(gsm->tcp.tcp_mutex);
+  }
+}
+
 int gsm_tcp_close_force(gsm_t *gsm, uint8_t connect_id) {
 
   if (!gsm || connect_id >= GSM_TCP_MAX_SOCKETS) {
@@ -1289,10 +2545,13 @@ int gsm_tcp_close_force(gsm_t *gsm, uint8_t connect_id) {
       vSemaphoreDelete(socket->close_sem);
     }
 
-    socket->close_sem = xSemaphoreCreateBinary();
+    socket->close_sem = HEAP_TRACK(HEAP_TAG_CMD_SEM, xSemaphoreCreateBinary());
     xSemaphoreGive(gsm->tcp.tcp_mutex);
   }
 
+  // CLOSING 이후로는 새 쓰기가 들어오지 않는다
+  tcp_tx_flush(gsm, connect_id);
+
   gsm_at_cmd_t msg = {
       .at_mode = GSM_AT_WRITE,
       .cmd = GSM_CMD_QICLOSE,
@@ -1306,9 +2565,9 @@ int gsm_tcp_close_force(gsm_t *gsm, uint8_t connect_id) {
   gsm->status.is_ok = 0;
   gsm->status.is_err = 0;
   gsm->status.is_timeout = 0;
-  msg.sem = xSemaphoreCreateBinary();
+  msg.sem = HEAP_TRACK(HEAP_TAG_CMD_SEM, xSemaphoreCreateBinary());
   SemaphoreHandle_t sem = msg.sem;
-  xQueueSend(gsm->at_cmd_queue, &msg, portMAX_DELAY);
+  gsm_at_cmd_enqueue(gsm, &msg);
 
   TickType_t timeout_ticks = pdMS_TO_TICKS(11000);
   BaseType_t result = xSemaphoreTake(sem, timeout_ticks);
@@ -1362,6 +2621,23 @@ int gsm_tcp_send(gsm_t *gsm, uint8_t connect_id, const uint8_t *data,
     return -1;
   }
 
+#if GSM_CMUX_ENABLE
+  if (socket->dlc && gsm->mux.data[socket->dlc]) {
+    int ret = cmux_writable(&gsm->mux.cmux, socket->dlc)
+                  ? cmux_write(&gsm->mux.cmux, socket->dlc, data, len)
+                  : -1;
+
+    if (ret == 0) {
+      gsm_tcp_usage_add(socket, false, len);
+    }
+
+    if (callback) {
+      callback(gsm, GSM_CMD_QISEND, NULL, ret == 0);
+    }
+    return ret;
+  }
+#endif
+
   tcp_pbuf_t *tx_pbuf = tcp_pbuf_alloc(len);
   if (!tx_pbuf) {
     return -1;
@@ -1379,19 +2655,20 @@ int gsm_tcp_send(gsm_t *gsm, uint8_t connect_id, const uint8_t *data,
   };
 
   snprintf(msg.params, GSM_AT_CMD_PARAM_SIZE, "%d,%u", connect_id, len);
+  gsm_tcp_usage_add(socket, false, len);
 
   if (callback) {
-    xQueueSend(gsm->at_cmd_queue, &msg, portMAX_DELAY);
+    gsm_at_cmd_enqueue(gsm, &msg);
     return 0;
   } else {
     gsm->status.is_ok = 0;
     gsm->status.is_err = 0;
     gsm->status.is_timeout = 0;
 
-    msg.sem = xSemaphoreCreateBinary();
+    msg.sem = HEAP_TRACK(HEAP_TAG_CMD_SEM, xSemaphoreCreateBinary());
     SemaphoreHandle_t sem = msg.sem;
 
-    xQueueSend(gsm->at_cmd_queue, &msg, portMAX_DELAY);
+    gsm_at_cmd_enqueue(gsm, &msg);
 
     uint32_t timeout_ms = gsm->at_tbl[GSM_CMD_QISEND].timeout_ms;
     if (timeout_ms == 0)
@@ -1411,6 +2688,162 @@ int gsm_tcp_send(gsm_t *gsm, uint8_t connect_id, const uint8_t *data,
   }
 }
 
+int gsm_tcp_send_pbuf(gsm_t *gsm, uint8_t connect_id, tcp_pbuf_t *chain,
+                      bool pool, tcp_sent_cb_t cb, void *ctx) {
+  size_t len = 0;
+  bool post;
+
+  if (!gsm || connect_id >= GSM_TCP_MAX_SOCKETS || !chain) {
+    return -1;
+  }
+
+  for (tcp_pbuf_t *p = chain; p; p = p->next) {
+    len += p->len;
+  }
+  if (len == 0 || len > GSM_TCP_SEND_MAX) {
+    return -1;
+  }
+
+  gsm_tcp_socket_t *socket = &gsm->tcp.sockets[connect_id];
+
+  if (xSemaphoreTake(gsm->tcp.tcp_mutex, portMAX_DELAY) != pdTRUE) {
+    return -1;
+  }
+
+  if (socket->state != GSM_TCP_STATE_CONNECTED ||
+      socket->tx_count >= GSM_TCP_TX_QUEUE_DEPTH) {
+    xSemaphoreGive(gsm->tcp.tcp_mutex);
+    return -1;
+  }
+
+#if GSM_CMUX_ENABLE
+  // transparent 채널은 AT 대기열을 거치지 않는다
+  uint8_t dlc = socket->dlc;
+
+  if (dlc && gsm->mux.data[dlc]) {
+    xSemaphoreGive(gsm->tcp.tcp_mutex);
+    int ret = gsm_mux_send_chain(gsm, connect_id, dlc, chain, (uint16_t)len,
+                                 pool, cb, ctx);
+    if (ret == 0) {
+      gsm_tcp_usage_add(socket, false, len);
+    }
+    return ret;
+  }
+#endif
+
+  gsm_tcp_tx_t *tx = &socket->tx[(socket->tx_head + socket->tx_count) %
+                                 GSM_TCP_TX_QUEUE_DEPTH];
+  tx->chain = chain;
+  tx->len = len;
+  tx->pool = pool;
+  tx->cb = cb;
+  tx->ctx = ctx;
+  socket->tx_count++;
+  gsm_tcp_usage_add(socket, false, len);
+
+  // 아직 꺼내지 않은 QISEND 가 있으면 그 명령에 묶여 나간다
+  post = socket->tx_cmds == 0;
+  if (post) {
+    socket->tx_cmds++;
+  }
+  xSemaphoreGive(gsm->tcp.tcp_mutex);
+
+  if (post) {
+    tcp_tx_post(gsm, connect_id, portMAX_DELAY);
+  }
+
+  return 0;
+}
+
+bool gsm_at_cmd_prepare(gsm_t *gsm, gsm_at_cmd_t *cmd) {
+  size_t len = 0;
+  uint8_t first;
+  uint8_t n = 0;
+  bool more = false;
+
+  if (cmd->cmd != GSM_CMD_QISEND || !cmd->tx_deferred) {
+    return true;
+  }
+  if (cmd->tx_cid >= GSM_TCP_MAX_SOCKETS) {
+    return false;
+  }
+
+  gsm_tcp_socket_t *socket = &gsm->tcp.sockets[cmd->tx_cid];
+
+  if (xSemaphoreTake(gsm->tcp.tcp_mutex, portMAX_DELAY) != pdTRUE) {
+    return false;
+  }
+
+  if (socket->tx_cmds) {
+    socket->tx_cmds--;
+  }
+
+  // 앞 QISEND 의 완료 처리가 아직이면 그 뒤부터 묶는다
+  first = (socket->tx_head + socket->tx_busy) % GSM_TCP_TX_QUEUE_DEPTH;
+  while (socket->tx_busy + n < socket->tx_count) {
+    gsm_tcp_tx_t *tx = &socket->tx[(first + n) % GSM_TCP_TX_QUEUE_DEPTH];
+
+    if (len + tx->len > GSM_TCP_SEND_MAX) {
+      break;
+    }
+    len += tx->len;
+    n++;
+  }
+  socket->tx_busy += n;
+
+  // 한 번에 못 보낸 쓰기는 QISEND 를 하나 더 올린다
+  if (socket->tx_busy < socket->tx_count && socket->tx_cmds == 0) {
+    socket->tx_cmds++;
+    more = true;
+  }
+  xSemaphoreGive(gsm->tcp.tcp_mutex);
+
+  // 처리 태스크 자신이 넣으므로 기다리지 않는다 (실패하면 다음 쓰기 때 올라감)
+  if (more && !tcp_tx_post(gsm, cmd->tx_cid, 0) &&
+      xSemaphoreTake(gsm->tcp.tcp_mutex, portMAX_DELAY) == pdTRUE) {
+    socket->tx_cmds--;
+    xSemaphoreGive(gsm->tcp.tcp_mutex);
+  }
+
+  if (n == 0) {
+    // 앞 QISEND 에 이미 묶여 나갔거나 소켓 종료로 취소됨
+    return false;
+  }
+
+  cmd->tx_first = first;
+  cmd->tx_batch = n;
+  snprintf(cmd->params, GSM_AT_CMD_PARAM_SIZE, "%d,%u", cmd->tx_cid,
+           (unsigned)len);
+  return true;
+}
+
+void gsm_tcp_tx_complete(gsm_t *gsm, uint8_t connect_id, uint8_t batch,
+                         bool ok) {
+  gsm_tcp_tx_t done[GSM_TCP_TX_QUEUE_DEPTH];
+  uint8_t n = 0;
+
+  if (!gsm || connect_id >= GSM_TCP_MAX_SOCKETS) {
+    return;
+  }
+
+  if (xSemaphoreTake(gsm->tcp.tcp_mutex, portMAX_DELAY) == pdTRUE) {
+    gsm_tcp_socket_t *socket = &gsm->tcp.sockets[connect_id];
+
+    while (n < batch && socket->tx_busy > 0) {
+      done[n++] = socket->tx[socket->tx_head];
+      socket->tx_head = (socket->tx_head + 1) % GSM_TCP_TX_QUEUE_DEPTH;
+      socket->tx_count--;
+      socket->tx_busy--;
+    }
+    xSemaphoreGive(gsm->tcp.tcp_mutex);
+  }
+
+  if (!ok) {
+    LOG_WARN("TCP 송신 실패 %d건 (cid=%d)", n, connect_id);
+  }
+  tcp_tx_finish(connect_id, done, n, ok);
+}
+
 int gsm_tcp_read(gsm_t *gsm, uint8_t connect_id, size_t max_len,
                  at_cmd_handler callback) {
   if (!gsm || connect_id >= GSM_TCP_MAX_SOCKETS || max_len == 0 ||
@@ -1436,17 +2869,17 @@ int gsm_tcp_read(gsm_t *gsm, uint8_t connect_id, size_t max_len,
   snprintf(msg.params, GSM_AT_CMD_PARAM_SIZE, "%d,%u", connect_id, max_len);
 
   if (callback) {
-    xQueueSend(gsm->at_cmd_queue, &msg, portMAX_DELAY);
+    gsm_at_cmd_enqueue(gsm, &msg);
     return 0;
   } else {
     gsm->status.is_ok = 0;
     gsm->status.is_err = 0;
     gsm->status.is_timeout = 0;
 
-    msg.sem = xSemaphoreCreateBinary();
+    msg.sem = HEAP_TRACK(HEAP_TAG_CMD_SEM, xSemaphoreCreateBinary());
     SemaphoreHandle_t sem = msg.sem;
 
-    xQueueSend(gsm->at_cmd_queue, &msg, portMAX_DELAY);
+    gsm_at_cmd_enqueue(gsm, &msg);
 
     uint32_t timeout_ms = gsm->at_tbl[GSM_CMD_QIRD].timeout_ms;
     if (timeout_ms == 0)
@@ -1519,6 +2952,12 @@ void gsm_send_at_qpowd(gsm_t *gsm, uint8_t mode, at_cmd_handler callback) {
   gsm_send_at_cmd(gsm, GSM_CMD_QPOWD, GSM_AT_WRITE, params, callback);
 }
 
+void gsm_send_at_ipr(gsm_t *gsm, uint32_t baudrate, at_cmd_handler callback) {
+  char params[12] = {0};
+  snprintf(params, sizeof(params), "%lu", (unsigned long)baudrate);
+  gsm_send_at_cmd(gsm, GSM_CMD_IPR, GSM_AT_WRITE, params, callback);
+}
+
 void gsm_send_at_qcfg_airplanecontrol(gsm_t *gsm, uint8_t mode, at_cmd_handler callback) {
 
   char params[32] = {0};
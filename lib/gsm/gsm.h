@@ -2,6 +2,7 @@
 #define GSM_H
 
 #include "FreeRTOS.h"
+#include "cmux.h"
 #include "queue.h"
 #include "semphr.h"
 #include <stdbool.h>
@@ -11,13 +12,67 @@
 #define GSM_PAYLOAD_SIZE 128
 #define GSM_AT_CMD_PARAM_SIZE 64
 
+// AT 명령 큐 lane 깊이 (데이터 lane 이 먼저 나간다)
+#define GSM_AT_QUEUE_DATA_DEPTH 4
+#define GSM_AT_QUEUE_CTRL_DEPTH 9
+
+#define GSM_DNS_ADDR_SIZE 40 ///< 조회한 주소 문자열 (IPv6 포함)
+
 // TCP 관련 정의
-#define GSM_TCP_MAX_SOCKETS 2       ///< EC25는 최대 12개 소켓 지원
+#define GSM_TCP_MAX_SOCKETS 4       ///< NTRIP 주/보조 캐스터 + NTRIP server + telemetry (EC25는 최대 12개)
 #define GSM_TCP_RX_BUFFER_SIZE 1500 ///< TCP RX 버퍼 (1460 + 여유)
 #define GSM_TCP_TX_BUFFER_SIZE 1500 ///< TCP TX 버퍼 (1460 + 여유)
+#define GSM_TCP_SEND_MAX 1460       ///< QISEND 한 번 최대 길이
+#define GSM_TCP_READ_MAX 1460       ///< QIRD 한 번 요청 길이 (pbuf large 등급)
+#define GSM_TCP_TX_QUEUE_DEPTH 4    ///< 소켓당 비동기 송신 대기 수
 
 #define GSM_TCP_PBUF_MAX_LEN (16 * 1024) // 소켓당 최대 16KB
 
+// pbuf 풀 크기 등급 (작은 등급이 비면 큰 등급에서 꺼낸다)
+#define GSM_TCP_PBUF_SMALL_SIZE 128
+#define GSM_TCP_PBUF_SMALL_CNT 16
+#define GSM_TCP_PBUF_MID_SIZE 512
+#define GSM_TCP_PBUF_MID_CNT 8
+#define GSM_TCP_PBUF_LARGE_SIZE 1460
+/// 소켓 하나의 GSM_TCP_PBUF_MAX_LEN 을 1460 바이트 읽기로 채우고 송신 1개 여유
+#define GSM_TCP_PBUF_LARGE_CNT                                                 \
+  ((GSM_TCP_PBUF_MAX_LEN + GSM_TCP_PBUF_LARGE_SIZE - 1) /                      \
+       GSM_TCP_PBUF_LARGE_SIZE +                                               \
+   1)
+#define GSM_TCP_PBUF_CLASS_CNT 3
+
+/**
+ * @brief CMUX (27.010) 다중화
+ *
+ * 초기화 중 AT+CMUX 로 UART 를 가상 채널로 나눈다. DLC 1 은 모든 AT 명령과
+ * URC 가 지나는 제어 채널이고, DLC 2~ 는 PUSH 소켓을 transparent mode 로 열어
+ * TCP 데이터만 흐른다 (QIRD/QISEND 없음, AT 큐를 기다리지 않음). 남는 데이터
+ * 채널이 없거나 다중화가 안 되면 예전처럼 DLC 1 (또는 UART) 의 AT 로 주고받는다.
+ */
+#ifndef GSM_CMUX_ENABLE
+#define GSM_CMUX_ENABLE 1
+#endif
+#define GSM_CMUX_N1 CMUX_INFO_MAX  ///< UIH info 최대 (AT+CMUX N1)
+#define GSM_CMUX_DLC_AT 1          ///< 제어 AT 채널
+#define GSM_CMUX_DLC_DATA 2        ///< 첫 transparent 소켓 채널
+#define GSM_CMUX_OPEN_TIMEOUT_MS 3000 ///< DLC 1 이 열리기를 AT 송신이 기다리는 시간
+
+/**
+ * @brief PPP 전송 (선택)
+ *
+ * 켜면 마지막 CMUX 채널을 ATD*99# 로 데이터 호출에 두고 MCU 의 작은 TCP/IP
+ * 스택 (ppp.c, netstack.c, gsm_ppp.c) 이 모든 소켓을 그 위로 주고받는다.
+ * QIOPEN/QISEND/QIRD 와 +QIURC "recv" 가 없어지고, 수신은 pbuf 풀에 바로
+ * 풀려 TCP 창으로 흐름 제어된다. tcp_socket.h API 는 그대로다.
+ */
+#ifndef GSM_PPP_ENABLE
+#define GSM_PPP_ENABLE 0
+#endif
+#if GSM_PPP_ENABLE && !GSM_CMUX_ENABLE
+#error "GSM_PPP_ENABLE 은 GSM_CMUX_ENABLE 이 필요함 (AT 는 DLC 1 로 계속 주고받음)"
+#endif
+#define GSM_CMUX_DLC_PPP (CMUX_DLC_MAX - 1) ///< PPP 데이터 채널 (transparent 소켓에 주지 않음)
+
 typedef struct gsm_s gsm_t;
 
 typedef enum {
@@ -30,6 +85,8 @@ typedef enum {
   GSM_CMD_CPIN,    ///< SIM 장착 확인
   GSM_CMD_COPS,    ///< 선택된 네트워크 OPERATOR 확인
   GSM_CMD_QPOWD,   ///< 전원 OFF (AT+QPOWD)
+  GSM_CMD_IPR,     ///< UART 보드레이트 설정
+  GSM_CMD_PROBE,   ///< 상태 일괄 조회 (CMEE/keepalive/CPIN/CGATT/CGACT)
 
   // TCP
   GSM_CMD_QIOPEN,  ///< 소켓 open
@@ -38,10 +95,13 @@ typedef enum {
   GSM_CMD_QIRD,    ///< 소켓 읽기
   GSM_CMD_QISDE,   ///< 소켓 데이터 에코 설정
   GSM_CMD_QISTATE, ///< 소켓 상태 조회
+  GSM_CMD_QIDNSGIP, ///< 호스트 이름 조회
 
   // 설정
   GSM_CMD_QICFG,
   GSM_CMD_QCFG,
+  GSM_CMD_CMUX, ///< 다중화 시작
+  GSM_CMD_ATD,  ///< 데이터 호출 (PPP)
   GSM_CMD_MAX
 } gsm_cmd_t;
 
@@ -56,6 +116,7 @@ typedef enum {
   GSM_EVT_TCP_DATA_RECV, ///< TCP 데이터 수신
   GSM_EVT_TCP_SEND_OK,   ///< TCP 전송 완료
   GSM_EVT_PDP_DEACT,
+  GSM_EVT_PPP_UP,        ///< PPP 링크에서 IP 사용 가능 (GSM_PPP_ENABLE)
 } gsm_evt_t;
 
 typedef void (*urc_handler_t)(gsm_t *gsm, const char *data,
@@ -71,11 +132,32 @@ typedef struct tcp_pbuf_s {
   struct tcp_pbuf_s *next; ///< 다음 pbuf
 } tcp_pbuf_t;
 
+/**
+ * @brief pbuf 풀 등급별 통계
+ */
+typedef struct {
+  uint16_t size;      ///< 블록 payload 크기
+  uint16_t total;     ///< 블록 수
+  uint16_t free;      ///< 현재 남은 블록
+  uint16_t min_free;  ///< 부팅 후 최소 남은 블록
+  uint32_t borrowed;  ///< 이 등급이 비어서 큰 등급에서 꺼낸 횟수
+  uint32_t exhausted; ///< 이 등급 이상이 모두 비어 할당 실패한 횟수
+} tcp_pbuf_pool_stats_t;
+
 typedef struct {
   const char *prefix;    ///< GSM 명령어
+  uint8_t prefix_len;    ///< strlen(prefix) (GSM_URC_ENTRY 가 컴파일 시 계산)
   urc_handler_t handler; ///< GSM 명령어 처리 핸들러
 } urc_handler_entry_t;
 
+/**
+ * @brief URC 테이블 항목 (prefix 는 문자열 리터럴)
+ *
+ * 테이블은 prefix 사전순으로 정렬하고, 한 prefix 가 다른 prefix 의
+ * 앞부분이 되지 않게 둔다 (이진 탐색).
+ */
+#define GSM_URC_ENTRY(prefix, handler) {(prefix), sizeof(prefix) - 1, (handler)}
+
 typedef struct {
   gsm_cmd_t cmd;
   const char *at_str;
@@ -152,6 +234,15 @@ typedef union {
     char code[16]; // "READY", "SIM PIN", etc.
   } cpin;
 
+  // 상태 일괄 조회 결과 (GSM_CMD_PROBE)
+  struct {
+    uint8_t cmee;      // AT+CMEE? 값
+    bool keepalive;    // tcp/keepalive 켜짐
+    bool sim_ready;    // +CPIN: READY
+    uint8_t cgatt;     // 1: PS 도메인 attach
+    uint8_t pdp_mask;  // 활성 PDP context (bit n = cid n)
+  } probe;
+
   // AT+QIOPEN 결과
   struct {
     uint8_t connect_id;
@@ -174,6 +265,7 @@ typedef union {
   // AT+QIRD 결과
   struct {
     uint8_t connect_id;
+    uint16_t req_length; // 요청한 길이 (다 채워 왔으면 모뎀에 더 남았을 수 있음)
     uint16_t read_actual_length;
     uint8_t *data; // TCP 버퍼를 가리킴
   } qird;
@@ -203,17 +295,49 @@ typedef struct {
   gsm_at_mode_t at_mode;
   SemaphoreHandle_t sem;
   uint32_t timeout_ms;
+  TickType_t enq_tick; ///< 큐에 넣은 시각 (lane 대기 시간 통계)
 
   gsm_msg_t msg; ///< 명령어별 파싱 결과
 
   // ★ TCP 전송용 데이터 (QISEND 전용)
   tcp_pbuf_t *tx_pbuf; ///< 전송할 데이터 (pbuf로 관리, 전송 완료 후 해제)
+
+  // 비동기 송신 (gsm_tcp_send_pbuf) - 길이는 처리 태스크가 꺼낼 때 정한다
+  bool tx_deferred; ///< true: 소켓 송신 대기열에서 묶어 보냄
+  uint8_t tx_cid;   ///< 대기열 소켓 ID
+  uint8_t tx_first; ///< 이 QISEND 로 나가는 첫 쓰기 (대기열 index)
+  uint8_t tx_batch; ///< 이 QISEND 로 나가는 쓰기 수
+
+  uint8_t dlc; ///< CMUX 채널 (0: 제어 AT 채널, transparent QIOPEN 은 데이터 채널)
 } gsm_at_cmd_t;
 
+/**
+ * @brief AT 명령 큐 lane
+ *
+ * 처리 태스크는 명령 경계마다 DATA lane 을 먼저 비우므로 QIRD/QISEND 가
+ * QISTATE 폴링 같은 관리 명령 뒤에서 기다리지 않는다.
+ */
+typedef enum {
+  GSM_AT_LANE_DATA = 0, ///< QIRD, QISEND
+  GSM_AT_LANE_CTRL,     ///< 나머지 모든 명령
+  GSM_AT_LANE_MAX,
+} gsm_at_lane_t;
+
+/**
+ * @brief lane 별 통계 (처리 태스크에서만 갱신)
+ */
+typedef struct {
+  uint32_t count;       ///< 꺼낸 명령 수
+  uint32_t max_depth;   ///< 꺼낼 때 본 최대 큐 깊이 (자신 포함)
+  uint32_t wait_max_ms; ///< 큐 대기 최대 시간
+  uint32_t wait_sum_ms; ///< 큐 대기 시간 합 (평균 = wait_sum_ms / count)
+} gsm_at_lane_stats_t;
+
 typedef struct {
   char data[GSM_PAYLOAD_SIZE]; ///< 수신받은 GSM 명령어 패킷
   size_t len;                  ///< 수신받은 GSM 명령어 패킷 길이
   uint8_t data_offset; ///< URC 등 명령어를 제외한 실제 데이터가 있는 위치
+  uint8_t prev;        ///< 직전 바이트 (chunk 경계의 CR/LF 판정용)
 } gsm_recv_t;
 
 typedef struct {
@@ -242,7 +366,9 @@ typedef struct {
   int (*init)(void);
   int (*reset)(void);
   int (*send)(const char *data, size_t len);
+  int (*sendv)(const cmux_seg_t *seg, size_t cnt); ///< 구간들을 끊김 없이 (NULL 가능)
   int (*recv)(char *buf, size_t len);
+  int (*set_baudrate)(uint32_t baudrate);
 } gsm_hal_ops_t;
 
 typedef enum {
@@ -255,11 +381,42 @@ typedef enum {
 typedef void (*tcp_recv_callback_t)(uint8_t connect_id);
 typedef void (*tcp_close_callback_t)(uint8_t connect_id);
 
+/**
+ * @brief 수신 데이터 직접 전달 콜백 (pbuf 없이 QIRD 버퍼를 그대로 넘김)
+ *
+ * GSM 태스크에서 tcp_mutex 없이 불린다. data 는 리턴 후 재사용되므로
+ * 필요하면 콜백 안에서 복사해야 하고, 블로킹하면 안 된다.
+ */
+typedef void (*tcp_sink_t)(const uint8_t *data, size_t len, void *ctx);
+
+/**
+ * @brief 비동기 송신 완료 콜백
+ *
+ * SEND OK, SEND FAIL/ERROR/타임아웃, 소켓 종료 시 AT 처리 태스크나 파서
+ * 태스크, GSM TCP 태스크에서 불린다. 블로킹하면 안 된다.
+ *
+ * @param connect_id 소켓 ID
+ * @param ok true: SEND OK
+ * @param ctx gsm_tcp_send_pbuf() 에 넘긴 값
+ */
+typedef void (*tcp_sent_cb_t)(uint8_t connect_id, bool ok, void *ctx);
+
+/**
+ * @brief 송신 대기열 항목 (쓰기 하나)
+ */
+typedef struct {
+  tcp_pbuf_t *chain; ///< 보낼 pbuf 체인
+  uint16_t len;      ///< 체인 전체 길이
+  bool pool;         ///< true: 완료 후 풀에 반납, false: 호출자 소유
+  tcp_sent_cb_t cb;
+  void *ctx;
+} gsm_tcp_tx_t;
+
 // TCP 이벤트 타입
 typedef enum {
-  TCP_EVT_RECV_NOTIFY = 0, ///< +QIURC: "recv" 수신 알림
+  TCP_EVT_RECV_NOTIFY = 0, ///< +QIURC: "recv" 수신 알림 (소켓마다 하나만)
   TCP_EVT_CLOSED_NOTIFY,   ///< +QIURC: "closed" 종료 알림
-  TCP_EVT_CONTINUE_READ, ///< EC25 버퍼 드레인 계속 (QIURC 방지용) ⭐ 추가
+  TCP_EVT_CONTINUE_READ, ///< 요청 길이를 다 채워 읽었을 때 모뎀 버퍼 이어 읽기
 } tcp_event_type_t;
 
 // TCP 이벤트 구조체
@@ -268,6 +425,20 @@ typedef struct {
   uint8_t connect_id;
 } tcp_event_t;
 
+/**
+ * @brief QIOPEN access mode
+ *
+ * BUFFER 는 +QIURC: "recv" 알림마다 AT+QIRD 로 읽어 온다.
+ * PUSH 는 모뎀이 +QIURC: "recv",<id>,<len> 뒤에 데이터를 바로 붙여 보내므로
+ * 조각마다 AT 명령 왕복이 없다. 대신 흐름 제어가 없어 받는 쪽이 늦으면
+ * 데이터를 버린다.
+ */
+typedef enum {
+  GSM_TCP_ACCESS_BUFFER = 0, ///< buffer access mode (기본값)
+  GSM_TCP_ACCESS_PUSH = 1,   ///< direct push mode
+  GSM_TCP_ACCESS_TRANSPARENT = 2, ///< CMUX 데이터 채널 (PUSH 소켓이 자동으로 씀)
+} gsm_tcp_access_t;
+
 // TCP 소켓 상태
 typedef enum {
   GSM_TCP_STATE_CLOSED = 0,
@@ -283,6 +454,8 @@ typedef struct {
   char remote_ip[64];    ///< 원격 IP 주소
   uint16_t remote_port;  ///< 원격 포트
   uint16_t local_port;   ///< 로컬 포트
+  gsm_tcp_access_t access_mode; ///< 다음 open 에 쓸 access mode (닫아도 유지)
+  uint8_t dlc; ///< transparent 로 열린 CMUX 채널 (0: AT 로 주고받음)
 
   // 수신 버퍼 큐 (lwcell 방식)
   tcp_pbuf_t *pbuf_head; ///< 수신 pbuf 체인 헤드
@@ -292,11 +465,44 @@ typedef struct {
   // 콜백
   tcp_recv_callback_t on_recv;   ///< 데이터 수신 콜백
   tcp_close_callback_t on_close; ///< 연결 종료 콜백
+  tcp_sink_t sink;               ///< 설정되면 pbuf 대신 직접 전달
+  void *sink_ctx;
+
+  // 비동기 송신 대기열 (앞에서부터 GSM_TCP_SEND_MAX 까지 QISEND 하나로 묶음)
+  gsm_tcp_tx_t tx[GSM_TCP_TX_QUEUE_DEPTH];
+  uint8_t tx_head;  ///< 가장 오래된 쓰기
+  uint8_t tx_count; ///< 대기 + 전송 중 쓰기 수
+  uint8_t tx_busy;  ///< QISEND 로 나가 완료를 기다리는 쓰기 수 (앞쪽부터)
+  uint8_t tx_cmds;  ///< 큐에 있지만 아직 꺼내지 않은 QISEND 수
+
+  // +QIURC: "recv" 합치기 (TCP_RX_READING | TCP_RX_AGAIN, gsm.c)
+  volatile uint8_t rx_pend;
 
   SemaphoreHandle_t open_sem;
   SemaphoreHandle_t close_sem;
+
+  // 누적 사용량 (다시 열어도 유지, gsm_tcp_get_usage)
+  uint32_t rx_bytes; ///< 소켓으로 넘긴 수신 payload
+  uint32_t tx_bytes; ///< 송신 대기열/채널에 넣은 payload
+  uint32_t rx_segs;  ///< 수신 조각 수 (QIRD/push/채널 수신 한 번)
+  uint32_t tx_segs;  ///< 송신 쓰기 수
+  uint32_t opens;    ///< 연결 성공 횟수 (핸드셰이크 추정용)
 } gsm_tcp_socket_t;
 
+/**
+ * @brief 소켓 누적 사용량 (gsm_tcp_get_usage)
+ *
+ * payload 만 센다. 조각/쓰기 수는 호출자가 IP/TCP 헤더를 추정하는 데 쓴다
+ * (모뎀 버퍼가 조각을 합치거나 나누므로 정확한 세그먼트 수는 아님).
+ */
+typedef struct {
+  uint32_t rx_bytes;
+  uint32_t tx_bytes;
+  uint32_t rx_segs;
+  uint32_t tx_segs;
+  uint32_t opens;
+} gsm_tcp_usage_t;
+
 // TCP 버퍼 구조체
 typedef struct {
   uint8_t rx_buf[GSM_TCP_RX_BUFFER_SIZE]; ///< RX 버퍼
@@ -309,6 +515,7 @@ typedef struct {
   size_t expected_data_len;      ///< 예상 데이터 길이
   size_t read_data_len;          ///< 읽은 데이터 길이
   uint8_t current_connect_id;    ///< 현재 읽기 중인 소켓 ID
+  bool is_push;                  ///< QIRD 응답이 아닌 direct push 데이터
 } gsm_tcp_buffer_t;
 
 // TCP 관리 구조체
@@ -322,6 +529,25 @@ typedef struct {
   TaskHandle_t task_handle;  ///< TCP 태스크 핸들
 } gsm_tcp_t;
 
+/**
+ * @brief CMUX 상태
+ *
+ * 데이터 채널은 CONNECT 전까지 명령 모드라 QIOPEN 응답을 파서로 넘기고
+ * (라인 버퍼는 채널마다 따로), CONNECT 뒤에는 받은 바이트를 그대로 소켓에
+ * 넘긴다. 모뎀이 MSC 로 DCD 를 내리면 연결이 끝난 것이다.
+ */
+typedef struct {
+  cmux_t cmux;
+  volatile bool up;          ///< DLC 1 열림 (AT 가 DLC 1 로 간다)
+  SemaphoreHandle_t open_sem; ///< DLC 1 UA/DM
+  volatile uint8_t at_dlc;   ///< 응답을 기다리는 명령을 보낸 채널
+  uint8_t rx_dlc;            ///< 지금 파싱 중인 라인이 온 채널
+  uint8_t cid[CMUX_DLC_MAX]; ///< 데이터 채널을 쓰는 소켓
+  volatile bool data[CMUX_DLC_MAX]; ///< CONNECT 뒤 데이터 모드
+  gsm_recv_t recv[CMUX_DLC_MAX];    ///< 데이터 채널 명령 모드 라인 버퍼
+  void (*done)(gsm_t *gsm, bool ok); ///< gsm_mux_start 결과 (DLC 1 기준)
+} gsm_mux_t;
+
 typedef struct gsm_s {
   gsm_recv_t recv;
   gsm_status_t status;
@@ -337,14 +563,114 @@ typedef struct gsm_s {
   const gsm_at_cmd_entry_t *at_tbl;
   const urc_handler_entry_t *urc_stat_tbl;
   const urc_handler_entry_t *urc_info_tbl;
-  QueueHandle_t at_cmd_queue;
+  uint8_t urc_stat_cnt;
+  uint8_t urc_info_cnt;
+  QueueHandle_t at_cmd_queue[GSM_AT_LANE_MAX]; ///< lane 별 AT 명령 큐
+  SemaphoreHandle_t at_cmd_signal; ///< 어느 lane 이든 명령이 들어오면 give
+  gsm_at_lane_stats_t at_lane_stats[GSM_AT_LANE_MAX];
 
   gsm_tcp_t tcp; ///< TCP 관리 구조체
+
+#if GSM_CMUX_ENABLE
+  gsm_mux_t mux;
+#endif
+
+  // AT+QIDNSGIP 결과 (+QIURC: "dnsgip" 로 비동기 도착)
+  struct {
+    SemaphoreHandle_t sem;        ///< 첫 주소 또는 실패 시 give
+    volatile bool pending;        ///< 조회 중
+    int32_t err;                  ///< 0: 성공
+    char addr[GSM_DNS_ADDR_SIZE]; ///< 첫 번째 주소
+  } dns;
 } gsm_t;
 
 void gsm_init(gsm_t *gsm, evt_handler_t handler, void *args);
+
+/**
+ * @brief 모뎀 수신 chunk 처리
+ *
+ * 다중화 중이면 CMUX 프레임을 풀어 채널별로 넘기고, 아니면 바로 AT 파싱.
+ */
 void gsm_parse_process(gsm_t *gsm, const void *data, size_t len);
 
+/**
+ * @brief AT 명령 조각 송신 (처리 태스크, '>' 프롬프트)
+ *
+ * 다중화 중이면 cmd->dlc 채널 (0 이면 DLC 1) 로, 아니면 UART 로 바로 보낸다.
+ * DLC 1 이 아직 열리는 중이면 GSM_CMUX_OPEN_TIMEOUT_MS 까지 기다린다.
+ *
+ * @return 0: 성공, -1: 채널이 열리지 않음 또는 송신 실패
+ */
+int gsm_at_send(gsm_t *gsm, const gsm_at_cmd_t *cmd, const void *data,
+                size_t len);
+
+/**
+ * @brief CMUX 시작 (AT+CMUX OK 콜백에서)
+ *
+ * DLC 0~3 을 차례로 SABM 으로 연다. DLC 1 이 열리거나 거절되면 done 을
+ * 파서 태스크에서 부른다. 데이터 채널은 그 뒤에 열리며 실패해도 AT 로 돈다.
+ */
+void gsm_mux_start(gsm_t *gsm, void (*done)(gsm_t *gsm, bool ok));
+
+/**
+ * @brief CMUX 끝 (CLD 를 보내 모뎀을 AT 모드로)
+ *
+ * @param send false: 모뎀을 리셋했거나 이미 AT 모드
+ */
+void gsm_mux_stop(gsm_t *gsm, bool send);
+
+/**
+ * @brief CMUX 동작 중 (DLC 1 열림)
+ */
+bool gsm_mux_is_up(gsm_t *gsm);
+
+/**
+ * @brief 채널의 DTR (MSC RTC) 설정
+ *
+ * 데이터 호출 중인 채널에서 내리면 모뎀이 호출을 끊고 명령 모드로 돌아간다.
+ */
+void gsm_mux_set_dtr(gsm_t *gsm, uint8_t dlc, bool on);
+
+/**
+ * @brief AT+CMUX 파라미터 ("0,0,<speed>,<N1>")
+ *
+ * @param baudrate 지금 UART 속도 (port_speed 로 바꿈)
+ */
+void gsm_send_at_cmux(gsm_t *gsm, uint32_t baudrate, at_cmd_handler callback);
+
+/**
+ * @brief ATD*99***<cid># 를 CMUX 채널 dlc 로 (CONNECT 를 OK 로 받음)
+ *
+ * @param cid PDP context (AT+CGDCONT 로 APN 을 설정한 것)
+ */
+void gsm_send_at_dial(gsm_t *gsm, uint8_t dlc, uint8_t cid,
+                      at_cmd_handler callback);
+
+/**
+ * @brief 다음 AT 명령 꺼내기 (DATA lane 우선)
+ *
+ * @param gsm GSM 핸들
+ * @param out 꺼낸 명령
+ * @param wait 두 lane 이 모두 비었을 때 기다릴 tick
+ * @return true: 꺼냄, false: 대기 시간 초과
+ */
+bool gsm_at_cmd_receive(gsm_t *gsm, gsm_at_cmd_t *out, TickType_t wait);
+
+/**
+ * @brief 모든 lane 의 대기 중인 AT 명령 버리기
+ *
+ * @return 버린 명령 수
+ */
+uint32_t gsm_at_cmd_flush(gsm_t *gsm);
+
+/**
+ * @brief lane 별 대기 통계 조회
+ *
+ * @return true: 유효한 lane
+ */
+bool gsm_at_get_lane_stats(gsm_t *gsm, gsm_at_lane_t lane,
+                           gsm_at_lane_stats_t *out);
+
 // TCP API 함수들
 /**
  * @brief TCP 소켓 초기화
@@ -384,6 +710,48 @@ int gsm_tcp_close(gsm_t *gsm, uint8_t connect_id, at_cmd_handler callback);
 
 int gsm_tcp_close_force(gsm_t *gsm, uint8_t connect_id);
 
+/**
+ * @brief 수신 데이터를 pbuf 큐 대신 sink 로 바로 넘기도록 설정
+ *
+ * 소켓이 닫히거나 다시 열리면 해제되므로 연결할 때마다 설정한다.
+ *
+ * @param gsm GSM 핸들
+ * @param connect_id 소켓 ID
+ * @param sink 전달 콜백 (NULL 이면 pbuf 큐 방식으로 복귀)
+ * @param ctx 콜백 인자
+ */
+void gsm_tcp_set_sink(gsm_t *gsm, uint8_t connect_id, tcp_sink_t sink,
+                      void *ctx);
+
+/**
+ * @brief 호스트 이름을 IP 주소로 조회 (동기식)
+ *
+ * 결과 주소는 첫 번째 것만 돌려준다. 동시에 한 조회만 가능하다.
+ *
+ * @param gsm GSM 핸들
+ * @param context_id PDP context ID (활성 상태여야 함)
+ * @param host 호스트 이름
+ * @param addr 주소 문자열 출력
+ * @param size addr 크기
+ * @param timeout_ms +QIURC: "dnsgip" 대기 시간
+ * @return int 0: 성공, -1: 실패
+ */
+int gsm_dns_resolve(gsm_t *gsm, uint8_t context_id, const char *host,
+                    char *addr, size_t size, uint32_t timeout_ms);
+
+/**
+ * @brief 소켓 access mode 설정
+ *
+ * 다음 gsm_tcp_open() 부터 적용되고 소켓을 닫아도 유지된다. PUSH 는 CMUX
+ * 데이터 채널이 남아 있으면 그 채널에서 transparent 로 열린다.
+ *
+ * @param gsm GSM 핸들
+ * @param connect_id 소켓 ID
+ * @param mode GSM_TCP_ACCESS_BUFFER 또는 GSM_TCP_ACCESS_PUSH
+ */
+void gsm_tcp_set_access_mode(gsm_t *gsm, uint8_t connect_id,
+                             gsm_tcp_access_t mode);
+
 /**
  * @brief TCP 데이터 전송
  *
@@ -397,6 +765,61 @@ int gsm_tcp_close_force(gsm_t *gsm, uint8_t connect_id);
 int gsm_tcp_send(gsm_t *gsm, uint8_t connect_id, const uint8_t *data,
                  size_t len, at_cmd_handler callback);
 
+/**
+ * @brief pbuf 체인 비동기 전송 (복사 없음)
+ *
+ * 소켓 송신 대기열에 넣고 바로 리턴한다. 아직 처리 태스크가 꺼내지 않은
+ * QISEND 가 있으면 거기에 묶여서, 함께 쌓인 작은 쓰기들(GGA 등)은
+ * GSM_TCP_SEND_MAX 까지 QISEND 한 번으로 나간다.
+ * 성공을 리턴한 뒤에는 완료 콜백이 불릴 때까지 체인을 건드리면 안 된다.
+ *
+ * @param gsm GSM 핸들
+ * @param connect_id 소켓 ID
+ * @param chain 보낼 pbuf 체인 (len 합이 GSM_TCP_SEND_MAX 이하)
+ * @param pool true: 완료 후 tcp_pbuf_free_chain, false: 호출자가 계속 소유
+ * @param cb 완료 콜백 (NULL 가능)
+ * @param ctx 콜백 인자
+ * @return int 0: 대기열에 들어감, -1: 실패 (체인 소유권은 호출자에게 남음)
+ */
+int gsm_tcp_send_pbuf(gsm_t *gsm, uint8_t connect_id, tcp_pbuf_t *chain,
+                      bool pool, tcp_sent_cb_t cb, void *ctx);
+
+/**
+ * @brief 소켓 누적 사용량 읽기 (잠금 없음, 값마다 따로 읽음)
+ *
+ * @return false: 잘못된 소켓 ID
+ */
+bool gsm_tcp_get_usage(gsm_t *gsm, uint8_t connect_id, gsm_tcp_usage_t *out);
+
+/**
+ * @brief 소켓 사용량 누적 (원자적, 송수신 경로에서 부름)
+ *
+ * @param rx true: 수신, false: 송신
+ */
+void gsm_tcp_usage_add(gsm_tcp_socket_t *socket, bool rx, size_t len);
+
+/**
+ * @brief AT 명령 전송 직전 처리 (처리 태스크에서 호출)
+ *
+ * 비동기 QISEND 면 대기열에서 이번에 보낼 쓰기를 정해 params 를 채운다.
+ *
+ * @return true: 전송, false: 보낼 것이 없으니 건너뜀
+ */
+bool gsm_at_cmd_prepare(gsm_t *gsm, gsm_at_cmd_t *cmd);
+
+/**
+ * @brief 비동기 QISEND 완료 처리
+ *
+ * 대기열 앞의 batch 개 쓰기를 꺼내 완료 콜백을 부르고 풀 체인은 반납한다.
+ *
+ * @param gsm GSM 핸들
+ * @param connect_id 소켓 ID
+ * @param batch gsm_at_cmd_t::tx_batch
+ * @param ok true: SEND OK
+ */
+void gsm_tcp_tx_complete(gsm_t *gsm, uint8_t connect_id, uint8_t batch,
+                         bool ok);
+
 /**
  * @brief TCP 데이터 읽기
  *
@@ -418,22 +841,47 @@ int gsm_tcp_read(gsm_t *gsm, uint8_t connect_id, size_t max_len,
  */
 gsm_tcp_socket_t *gsm_tcp_get_socket(gsm_t *gsm, uint8_t connect_id);
 
+/**
+ * @brief 모뎀 쪽에서 이미 사라진 소켓을 닫힘으로 처리
+ *
+ * +QIURC: "closed" 를 놓쳤을 때 (QISTATE 로 확인) 같은 경로로 정리한다.
+ *
+ * @param gsm GSM 핸들
+ * @param connect_id 소켓 ID
+ * @return int 0: 성공, -1: 잘못된 ID 또는 이벤트 큐 가득 참
+ */
+int gsm_tcp_notify_closed(gsm_t *gsm, uint8_t connect_id);
+
 // TCP pbuf 관리 함수들
 /**
- * @brief pbuf 할당
+ * @brief pbuf 풀 초기화 (gsm_init 에서 호출, 태스크 시작 전)
+ */
+void tcp_pbuf_pool_init(void);
+
+/**
+ * @brief pbuf 할당 (정적 풀, O(1), ISR 에서도 호출 가능)
  *
- * @param len 데이터 길이
+ * @param len 데이터 길이 (최대 GSM_TCP_PBUF_LARGE_SIZE)
  * @return tcp_pbuf_t* 할당된 pbuf (NULL이면 실패)
  */
 tcp_pbuf_t *tcp_pbuf_alloc(size_t len);
 
 /**
- * @brief pbuf 해제
+ * @brief pbuf 해제 (풀에 반환, ISR 에서도 호출 가능)
  *
  * @param pbuf 해제할 pbuf
  */
 void tcp_pbuf_free(tcp_pbuf_t *pbuf);
 
+/**
+ * @brief pbuf 풀 등급별 통계 조회
+ *
+ * @param cls 등급 (0: small, 1: mid, 2: large)
+ * @param out 출력
+ * @return true 유효한 등급
+ */
+bool tcp_pbuf_pool_get_stats(uint8_t cls, tcp_pbuf_pool_stats_t *out);
+
 /**
  * @brief pbuf 체인 전체 해제
  *
@@ -538,6 +986,18 @@ void gsm_send_at_qicfg_keepalive(gsm_t *gsm, uint8_t enable, uint16_t keepidle,
  * @param callback 완료 콜백 (NULL이면 동기식)
  */
 void gsm_send_at_qpowd(gsm_t *gsm, uint8_t mode, at_cmd_handler callback);
+
+/**
+ * @brief AT+IPR 전송 (모뎀 UART 보드레이트 변경)
+ *
+ * 모뎀은 OK 를 기존 속도로 보낸 뒤 바로 새 속도로 바뀐다.
+ * AT&W 를 보내지 않으므로 모뎀 리셋/전원 재인가 시 기본 속도로 돌아간다.
+ *
+ * @param gsm GSM 핸들
+ * @param baudrate 보드레이트
+ * @param callback 완료 콜백 (NULL이면 동기식)
+ */
+void gsm_send_at_ipr(gsm_t *gsm, uint32_t baudrate, at_cmd_handler callback);
 void gsm_send_at_qcfg_airplanecontrol(gsm_t *gsm, uint8_t mode, at_cmd_handler callback);
 
 #endif
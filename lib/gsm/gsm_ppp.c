@@ -0,0 +1,663 @@
+#include "gsm_ppp.h"
+
+#if GSM_PPP_ENABLE
+
+#include "heap_track.h"
+#include "netstack.h"
+#include "ppp.h"
+#include "stm32f4xx_hal.h"
+#include <stdio.h>
+#include <string.h>
+
+#ifndef TAG
+  #define TAG "GSM_PPP"
+#endif
+
+#include "log.h"
+
+// 태스크가 잠금 밖에서 알릴 링크 이벤트
+#define GSM_PPP_PEND_UP 0x01
+#define GSM_PPP_PEND_DOWN 0x02
+
+static struct {
+  SemaphoreHandle_t lock; ///< ppp, net, pcb[], 아래 플래그
+  TaskHandle_t task;
+  ppp_t ppp;
+  net_t net;
+  net_tcp_t *pcb[GSM_TCP_MAX_SOCKETS]; ///< 소켓에 붙은 연결
+  bool link;     ///< CONNECT 뒤 아직 끊기지 않음 (PDP_DEACT 알릴 대상)
+  uint8_t pend;  ///< GSM_PPP_PEND_*
+  bool dns_wait; ///< 조회가 끝나면 gsm->dns.sem give
+} g_ppp;
+
+static inline void gsm_ppp_lock(void) {
+  xSemaphoreTake(g_ppp.lock, portMAX_DELAY);
+}
+
+static inline void gsm_ppp_unlock(void) { xSemaphoreGive(g_ppp.lock); }
+
+/**
+ * @brief 태스크 깨우기 (이벤트/완료를 잠금 밖에서 넘기도록)
+ */
+static inline void gsm_ppp_kick(void) {
+  if (g_ppp.task) {
+    xTaskNotifyGive(g_ppp.task);
+  }
+}
+
+/*
+ * ppp.c / netstack.c 콜백 (잠금 안)
+ */
+
+static int gsm_ppp_write(void *ctx, const void *data, size_t len) {
+  gsm_t *gsm = ctx;
+
+  // 모뎀이 흐름 제어 중이면 버린다 (프레임이 깨져 FCS 로 버려지고 TCP 가 다시 보냄)
+  if (!cmux_writable(&gsm->mux.cmux, GSM_CMUX_DLC_PPP)) {
+    return -1;
+  }
+  return cmux_write(&gsm->mux.cmux, GSM_CMUX_DLC_PPP, data, len);
+}
+
+static void gsm_ppp_ip_input(void *ctx, tcp_pbuf_t *p) {
+  (void)ctx;
+  net_input(&g_ppp.net, p);
+}
+
+static void gsm_ppp_link_event(void *ctx, ppp_evt_t evt) {
+  gsm_t *gsm = ctx;
+
+  if (evt == PPP_EVT_UP) {
+    net_up(&g_ppp.net, g_ppp.ppp.addr, g_ppp.ppp.dns);
+    g_ppp.pend |= GSM_PPP_PEND_UP;
+    return;
+  }
+
+  // 협상 실패, Terminate, echo 응답 없음: DTR 을 내려 모뎀도 호출을 끊게 한다
+  net_down(&g_ppp.net);
+  gsm_mux_set_dtr(gsm, GSM_CMUX_DLC_PPP, false);
+  if (g_ppp.link) {
+    g_ppp.link = false;
+    g_ppp.pend |= GSM_PPP_PEND_DOWN;
+  }
+}
+
+static int gsm_ppp_ip_output(void *ctx, const ppp_seg_t *seg, size_t cnt) {
+  (void)ctx;
+  return ppp_output_ip(&g_ppp.ppp, seg, cnt);
+}
+
+static const ppp_ops_t gsm_ppp_link_ops = {
+    .write = gsm_ppp_write,
+    .input = gsm_ppp_ip_input,
+    .event = gsm_ppp_link_event,
+};
+
+static const net_ops_t gsm_ppp_net_ops = {
+    .output = gsm_ppp_ip_output,
+};
+
+/*
+ * 태스크 (소켓 콜백은 모두 여기서)
+ */
+
+static void gsm_ppp_emit(gsm_t *gsm, gsm_evt_t evt, void *args) {
+  if (gsm->evt_handler.handler) {
+    gsm->evt_handler.handler(evt, args);
+  }
+}
+
+static void gsm_ppp_tcp_connected(gsm_t *gsm, uint8_t cid) {
+  gsm_tcp_socket_t *socket = &gsm->tcp.sockets[cid];
+  bool opening = false;
+
+  if (xSemaphoreTake(gsm->tcp.tcp_mutex, portMAX_DELAY) == pdTRUE) {
+    // 기다리다 포기한 연결은 gsm_ppp_tcp_close 가 이미 떼어 냈다
+    opening = socket->state == GSM_TCP_STATE_OPENING;
+    if (opening) {
+      socket->state = GSM_TCP_STATE_CONNECTED;
+      socket->opens++;
+      if (socket->open_sem) {
+        xSemaphoreGive(socket->open_sem);
+      }
+    }
+    xSemaphoreGive(gsm->tcp.tcp_mutex);
+  }
+
+  if (opening) {
+    LOG_INFO("TCP 연결 (cid=%d)", cid);
+    gsm_ppp_emit(gsm, GSM_EVT_TCP_CONNECTED, &cid);
+  }
+}
+
+/**
+ * @brief 수신 큐를 sink 로 비우거나 on_recv 로 알림
+ *
+ * sink 는 잠금 밖에서 부르므로 꺼낸 pbuf 를 모아서 넘긴 뒤 창을 연다.
+ */
+static void gsm_ppp_tcp_recv(gsm_t *gsm, uint8_t cid, net_tcp_t *pcb) {
+  gsm_tcp_socket_t *socket = &gsm->tcp.sockets[cid];
+  tcp_recv_callback_t on_recv = NULL;
+  tcp_sink_t sink = NULL;
+  void *ctx = NULL;
+
+  if (xSemaphoreTake(gsm->tcp.tcp_mutex, portMAX_DELAY) == pdTRUE) {
+    on_recv = socket->on_recv;
+    sink = socket->sink;
+    ctx = socket->sink_ctx;
+    xSemaphoreGive(gsm->tcp.tcp_mutex);
+  }
+
+  if (sink) {
+    tcp_pbuf_t *head = NULL;
+    tcp_pbuf_t **tail = &head;
+    size_t len = 0;
+    bool more = false;
+
+    gsm_ppp_lock();
+    if (g_ppp.pcb[cid] == pcb) {
+      tcp_pbuf_t *p;
+
+      while ((p = net_tcp_pull(&g_ppp.net, pcb)) != NULL) {
+        *tail = p;
+        tail = &p->next;
+      }
+    }
+    gsm_ppp_unlock();
+
+    for (tcp_pbuf_t *p = head; p; p = p->next) {
+      gsm_tcp_usage_add(socket, true, p->len);
+      sink(p->payload, p->len, ctx);
+      len += p->len;
+    }
+    tcp_pbuf_free_chain(head);
+
+    gsm_ppp_lock();
+    if (g_ppp.pcb[cid] == pcb) {
+      net_tcp_recved(&g_ppp.net, pcb, len);
+      // 마지막 pbuf 를 꺼내며 생긴 EOF 는 다음 바퀴에서
+      more = pcb->events != 0;
+    }
+    gsm_ppp_unlock();
+
+    if (more) {
+      gsm_ppp_kick();
+    }
+  } else if (on_recv) {
+    on_recv(cid);
+  }
+
+  gsm_ppp_emit(gsm, GSM_EVT_TCP_DATA_RECV, &cid);
+}
+
+/**
+ * @brief 상대가 닫음, RST, 타임아웃 또는 링크 끊김
+ *
+ * 연결은 떼어 내 혼자 마무리하게 두고 소켓은 QIURC "closed" 와 같이 정리한다.
+ */
+static void gsm_ppp_tcp_closed(gsm_t *gsm, uint8_t cid, net_tcp_t *pcb) {
+  gsm_tcp_socket_t *socket = &gsm->tcp.sockets[cid];
+  tcp_close_callback_t on_close = NULL;
+  bool opening = false;
+
+  gsm_ppp_lock();
+  if (g_ppp.pcb[cid] != pcb) {
+    gsm_ppp_unlock();
+    return;
+  }
+  g_ppp.pcb[cid] = NULL;
+  net_tcp_close(&g_ppp.net, pcb);
+  gsm_ppp_unlock();
+
+  if (xSemaphoreTake(gsm->tcp.tcp_mutex, portMAX_DELAY) == pdTRUE) {
+    opening = socket->state == GSM_TCP_STATE_OPENING;
+    if (opening) {
+      // 연결 실패: gsm_ppp_tcp_open 이 깨어나 CLOSED 를 본다
+      if (socket->open_sem) {
+        xSemaphoreGive(socket->open_sem);
+      }
+    } else {
+      on_close = socket->on_close;
+    }
+    socket->state = GSM_TCP_STATE_CLOSED;
+    socket->on_recv = NULL;
+    socket->on_close = NULL;
+    socket->sink = NULL;
+    xSemaphoreGive(gsm->tcp.tcp_mutex);
+  }
+
+  if (opening) {
+    LOG_WARN("TCP 연결 실패 (cid=%d)", cid);
+    return;
+  }
+
+  if (on_close) {
+    on_close(cid);
+  }
+  gsm_ppp_emit(gsm, GSM_EVT_TCP_CLOSED, &cid);
+}
+
+/**
+ * @brief 연결 하나의 송신 완료와 이벤트 처리
+ *
+ * 소켓에서 떼어 낸 연결도 남은 쓰기 완료를 꺼내야 슬롯이 풀린다.
+ */
+static void gsm_ppp_tcp_dispatch(gsm_t *gsm, net_tcp_t *pcb) {
+  gsm_tcp_tx_t done[NET_TCP_SNDQ];
+  bool ok[NET_TCP_SNDQ];
+  uint8_t n = 0;
+  uint8_t ev = 0;
+  uint8_t cid;
+
+  gsm_ppp_lock();
+  if (!pcb->used) {
+    gsm_ppp_unlock();
+    return;
+  }
+  cid = pcb->cid;
+  if (g_ppp.pcb[cid] == pcb) {
+    ev = net_tcp_events(pcb);
+  }
+  while (n < NET_TCP_SNDQ &&
+         net_tcp_sent_pop(&g_ppp.net, pcb, &done[n], &ok[n])) {
+    n++;
+  }
+  gsm_ppp_unlock();
+
+  for (uint8_t i = 0; i < n; i++) {
+    if (done[i].cb) {
+      done[i].cb(cid, ok[i], done[i].ctx);
+    }
+    if (done[i].pool) {
+      tcp_pbuf_free_chain(done[i].chain);
+    }
+  }
+
+  if (ev & NET_TCP_EV_CONNECTED) {
+    gsm_ppp_tcp_connected(gsm, cid);
+  }
+  if (ev & NET_TCP_EV_RECV) {
+    gsm_ppp_tcp_recv(gsm, cid, pcb);
+  }
+  if (ev & NET_TCP_EV_CLOSED) {
+    gsm_ppp_tcp_closed(gsm, cid, pcb);
+  }
+}
+
+static void gsm_ppp_dispatch(gsm_t *gsm) {
+  uint8_t pend;
+  bool dns_done;
+
+  for (uint8_t i = 0; i < NET_TCP_PCB_CNT; i++) {
+    gsm_ppp_tcp_dispatch(gsm, &g_ppp.net.pcb[i]);
+  }
+
+  gsm_ppp_lock();
+  pend = g_ppp.pend;
+  g_ppp.pend = 0;
+  dns_done = g_ppp.dns_wait && g_ppp.net.dns.state != NET_DNS_BUSY;
+  if (dns_done) {
+    g_ppp.dns_wait = false;
+  }
+  gsm_ppp_unlock();
+
+  if (dns_done) {
+    xSemaphoreGive(gsm->dns.sem);
+  }
+
+  if (pend & GSM_PPP_PEND_UP) {
+    LOG_INFO("PPP 연결: %lu.%lu.%lu.%lu (DNS %lu.%lu.%lu.%lu)",
+             g_ppp.ppp.addr >> 24, (g_ppp.ppp.addr >> 16) & 0xFF,
+             (g_ppp.ppp.addr >> 8) & 0xFF, g_ppp.ppp.addr & 0xFF,
+             g_ppp.ppp.dns[0] >> 24, (g_ppp.ppp.dns[0] >> 16) & 0xFF,
+             (g_ppp.ppp.dns[0] >> 8) & 0xFF, g_ppp.ppp.dns[0] & 0xFF);
+    gsm_ppp_emit(gsm, GSM_EVT_PPP_UP, NULL);
+  }
+  if (pend & GSM_PPP_PEND_DOWN) {
+    uint8_t context_id = GSM_PPP_CID;
+
+    LOG_WARN("PPP 링크 끊김 (rx %lu, fcs %lu, rexmit %lu)",
+             g_ppp.ppp.stats.rx_frames, g_ppp.ppp.stats.fcs_err,
+             g_ppp.net.stats.rexmit);
+    gsm_ppp_emit(gsm, GSM_EVT_PDP_DEACT, &context_id);
+  }
+}
+
+static void gsm_ppp_task(void *arg) {
+  gsm_t *gsm = (gsm_t *)arg;
+  TickType_t last = xTaskGetTickCount();
+
+  while (1) {
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(GSM_PPP_TICK_MS));
+
+    TickType_t now = xTaskGetTickCount();
+    uint32_t elapsed_ms = (uint32_t)(now - last) * portTICK_PERIOD_MS;
+
+    // 수신마다 깨어나도 타이머는 GSM_PPP_TICK_MS 단위로만
+    if (elapsed_ms >= GSM_PPP_TICK_MS) {
+      last = now;
+      gsm_ppp_lock();
+      ppp_tick(&g_ppp.ppp, elapsed_ms);
+      net_tick(&g_ppp.net, elapsed_ms);
+      gsm_ppp_unlock();
+    }
+
+    gsm_ppp_dispatch(gsm);
+  }
+}
+
+/**
+ * @brief 점 표기 IPv4 주소
+ */
+static bool gsm_ppp_parse_ip(const char *s, uint32_t *ip) {
+  uint32_t v = 0;
+
+  for (uint8_t i = 0; i < 4; i++) {
+    uint32_t part = 0;
+    uint8_t digits = 0;
+
+    while (*s >= '0' && *s <= '9' && digits < 3) {
+      part = part * 10 + (uint32_t)(*s++ - '0');
+      digits++;
+    }
+    if (digits == 0 || part > 255 || (i < 3 && *s++ != '.')) {
+      return false;
+    }
+    v = (v << 8) | part;
+  }
+  if (*s != '\0') {
+    return false;
+  }
+
+  *ip = v;
+  return true;
+}
+
+/*
+ * 공개 API
+ */
+
+void gsm_ppp_init(gsm_t *gsm) {
+  g_ppp.lock = xSemaphoreCreateMutex();
+  ppp_init(&g_ppp.ppp, &gsm_ppp_link_ops, gsm, "", "");
+  net_init(&g_ppp.net, &gsm_ppp_net_ops, gsm,
+           HAL_GetUIDw0() ^ HAL_GetUIDw1() ^ HAL_GetUIDw2());
+
+  HEAP_TRACK(HEAP_TAG_TASK, xTaskCreate(gsm_ppp_task, "gsm_ppp", 1024, gsm,
+                                        tskIDLE_PRIORITY + 3, &g_ppp.task));
+}
+
+void gsm_ppp_dial(gsm_t *gsm, at_cmd_handler callback) {
+  LOG_INFO("PPP 호출 (DLC%d, cid %d)", GSM_CMUX_DLC_PPP, GSM_PPP_CID);
+
+  // 지난 링크를 DTR 로 끊었으면 다시 올린다
+  gsm_mux_set_dtr(gsm, GSM_CMUX_DLC_PPP, true);
+  gsm_send_at_dial(gsm, GSM_CMUX_DLC_PPP, GSM_PPP_CID, callback);
+}
+
+bool gsm_ppp_is_up(void) { return ppp_is_up(&g_ppp.ppp); }
+
+void gsm_ppp_connected(gsm_t *gsm) {
+  (void)gsm;
+
+  gsm_ppp_lock();
+  g_ppp.link = true;
+  // 부팅마다 같은 포트/ISN 이 나오지 않게 CONNECT 타이밍을 섞는다
+  net_seed(&g_ppp.net, DWT->CYCCNT);
+  ppp_start(&g_ppp.ppp, DWT->CYCCNT * 2654435761u);
+  gsm_ppp_unlock();
+}
+
+void gsm_ppp_input(gsm_t *gsm, const uint8_t *data, size_t len) {
+  (void)gsm;
+
+  gsm_ppp_lock();
+  ppp_input(&g_ppp.ppp, data, len);
+  net_flush(&g_ppp.net);
+  gsm_ppp_unlock();
+  gsm_ppp_kick();
+}
+
+void gsm_ppp_carrier_lost(gsm_t *gsm, bool notify) {
+  bool link;
+
+  (void)gsm;
+
+  gsm_ppp_lock();
+  link = g_ppp.link;
+  g_ppp.link = false;
+  ppp_abort(&g_ppp.ppp);
+  net_down(&g_ppp.net);
+  if (link && notify) {
+    g_ppp.pend |= GSM_PPP_PEND_DOWN;
+  }
+  gsm_ppp_unlock();
+
+  if (link) {
+    LOG_WARN("PPP 채널 캐리어 끊김");
+  }
+  gsm_ppp_kick();
+}
+
+int gsm_ppp_dns_resolve(gsm_t *gsm, const char *host, char *addr, size_t size,
+                        uint32_t timeout_ms) {
+  uint32_t ip = 0;
+  int ret;
+
+  if (!gsm || !host || !addr || size == 0) {
+    return -1;
+  }
+
+  if (gsm_ppp_parse_ip(host, &ip)) {
+    snprintf(addr, size, "%s", host);
+    return 0;
+  }
+
+  // 이전 조회의 늦은 결과 정리
+  xSemaphoreTake(gsm->dns.sem, 0);
+
+  gsm_ppp_lock();
+  ret = net_dns_query(&g_ppp.net, host);
+  g_ppp.dns_wait = ret == 0;
+  gsm_ppp_unlock();
+
+  if (ret != 0) {
+    LOG_WARN("DNS 조회 못 함: %s", host);
+    return -1;
+  }
+
+  bool done = xSemaphoreTake(gsm->dns.sem, pdMS_TO_TICKS(timeout_ms)) == pdTRUE;
+
+  gsm_ppp_lock();
+  g_ppp.dns_wait = false;
+  if (done && g_ppp.net.dns.state == NET_DNS_DONE) {
+    ip = g_ppp.net.dns.addr;
+  }
+  gsm_ppp_unlock();
+
+  if (ip == 0) {
+    LOG_WARN("DNS 조회 실패: %s", host);
+    return -1;
+  }
+
+  snprintf(addr, size, "%lu.%lu.%lu.%lu", (unsigned long)(ip >> 24),
+           (unsigned long)((ip >> 16) & 0xFF), (unsigned long)((ip >> 8) & 0xFF),
+           (unsigned long)(ip & 0xFF));
+  return 0;
+}
+
+int gsm_ppp_tcp_open(gsm_t *gsm, uint8_t connect_id, const char *remote_ip,
+                     uint16_t remote_port, tcp_recv_callback_t on_recv,
+                     tcp_close_callback_t on_close, uint32_t timeout_ms) {
+  char addr[GSM_DNS_ADDR_SIZE];
+  uint32_t ip;
+  net_tcp_t *pcb;
+  bool ok = false;
+
+  if (!gsm || connect_id >= GSM_TCP_MAX_SOCKETS || !remote_ip) {
+    return -1;
+  }
+
+  if (!gsm_ppp_parse_ip(remote_ip, &ip)) {
+    if (gsm_ppp_dns_resolve(gsm, remote_ip, addr, sizeof(addr),
+                            GSM_PPP_DNS_TIMEOUT_MS) != 0 ||
+        !gsm_ppp_parse_ip(addr, &ip)) {
+      return -1;
+    }
+  }
+
+  gsm_tcp_socket_t *socket = &gsm->tcp.sockets[connect_id];
+
+  if (xSemaphoreTake(gsm->tcp.tcp_mutex, portMAX_DELAY) == pdTRUE) {
+    if (socket->state != GSM_TCP_STATE_CLOSED) {
+      xSemaphoreGive(gsm->tcp.tcp_mutex);
+      return -1;
+    }
+
+    socket->state = GSM_TCP_STATE_OPENING;
+    snprintf(socket->remote_ip, sizeof(socket->remote_ip), "%s", remote_ip);
+    socket->remote_port = remote_port;
+    socket->on_recv = on_recv;
+    socket->on_close = on_close;
+    socket->sink = NULL;
+    socket->sink_ctx = NULL;
+    socket->open_sem = HEAP_TRACK(HEAP_TAG_CMD_SEM, xSemaphoreCreateBinary());
+    xSemaphoreGive(gsm->tcp.tcp_mutex);
+  }
+
+  gsm_ppp_lock();
+  pcb = net_tcp_connect(&g_ppp.net, connect_id, ip, remote_port);
+  g_ppp.pcb[connect_id] = pcb;
+  gsm_ppp_unlock();
+
+  if (pcb) {
+    ok = xSemaphoreTake(socket->open_sem,
+                        pdMS_TO_TICKS(timeout_ms ? timeout_ms
+                                                 : GSM_PPP_CONNECT_TIMEOUT_MS)) ==
+         pdTRUE;
+  } else {
+    LOG_WARN("TCP 연결 못 함 (cid=%d, 링크 %s)", connect_id,
+             g_ppp.net.up ? "있음" : "없음");
+  }
+
+  if (xSemaphoreTake(gsm->tcp.tcp_mutex, portMAX_DELAY) == pdTRUE) {
+    ok = ok && socket->state == GSM_TCP_STATE_CONNECTED;
+    if (socket->open_sem) {
+      vSemaphoreDelete(socket->open_sem);
+      socket->open_sem = NULL;
+    }
+    xSemaphoreGive(gsm->tcp.tcp_mutex);
+  }
+
+  if (!ok) {
+    gsm_ppp_tcp_close(gsm, connect_id, true);
+    return -1;
+  }
+  return 0;
+}
+
+int gsm_ppp_tcp_send(gsm_t *gsm, uint8_t connect_id, tcp_pbuf_t *chain,
+                     bool pool, tcp_sent_cb_t cb, void *ctx) {
+  gsm_tcp_tx_t tx = {.chain = chain, .pool = pool, .cb = cb, .ctx = ctx};
+  size_t len = 0;
+  int ret = -1;
+
+  if (!gsm || connect_id >= GSM_TCP_MAX_SOCKETS || !chain) {
+    return -1;
+  }
+
+  for (tcp_pbuf_t *p = chain; p; p = p->next) {
+    len += p->len;
+  }
+  if (len == 0 || len > UINT16_MAX) {
+    return -1;
+  }
+  tx.len = (uint16_t)len;
+
+  gsm_ppp_lock();
+  if (g_ppp.pcb[connect_id]) {
+    ret = net_tcp_write(&g_ppp.net, g_ppp.pcb[connect_id], &tx);
+  }
+  gsm_ppp_unlock();
+
+  if (ret == 0) {
+    gsm_tcp_usage_add(&gsm->tcp.sockets[connect_id], false, len);
+  }
+
+  return ret;
+}
+
+int gsm_ppp_tcp_close(gsm_t *gsm, uint8_t connect_id, bool abort) {
+  net_tcp_t *pcb;
+
+  if (!gsm || connect_id >= GSM_TCP_MAX_SOCKETS) {
+    return -1;
+  }
+
+  gsm_ppp_lock();
+  pcb = g_ppp.pcb[connect_id];
+  g_ppp.pcb[connect_id] = NULL;
+  if (pcb) {
+    if (abort) {
+      net_tcp_abort(&g_ppp.net, pcb);
+    } else {
+      net_tcp_close(&g_ppp.net, pcb);
+    }
+  }
+  gsm_ppp_unlock();
+
+  // 실패로 끝난 쓰기 완료는 태스크가 부른다
+  gsm_ppp_kick();
+
+  gsm_tcp_socket_t *socket = &gsm->tcp.sockets[connect_id];
+
+  if (xSemaphoreTake(gsm->tcp.tcp_mutex, portMAX_DELAY) == pdTRUE) {
+    socket->state = GSM_TCP_STATE_CLOSED;
+    socket->on_recv = NULL;
+    socket->on_close = NULL;
+    socket->sink = NULL;
+    xSemaphoreGive(gsm->tcp.tcp_mutex);
+  }
+
+  return 0;
+}
+
+tcp_pbuf_t *gsm_ppp_tcp_pull(gsm_t *gsm, uint8_t connect_id) {
+  tcp_pbuf_t *p = NULL;
+  bool more = false;
+
+  if (!gsm || connect_id >= GSM_TCP_MAX_SOCKETS) {
+    return NULL;
+  }
+
+  gsm_ppp_lock();
+  net_tcp_t *pcb = g_ppp.pcb[connect_id];
+  if (pcb) {
+    p = net_tcp_pull(&g_ppp.net, pcb);
+    more = pcb->events != 0;
+  }
+  gsm_ppp_unlock();
+
+  if (p) {
+    gsm_tcp_usage_add(&gsm->tcp.sockets[connect_id], true, p->len);
+  }
+  // 다 읽은 뒤의 EOF
+  if (more) {
+    gsm_ppp_kick();
+  }
+  return p;
+}
+
+void gsm_ppp_tcp_recved(gsm_t *gsm, uint8_t connect_id, size_t len) {
+  if (!gsm || connect_id >= GSM_TCP_MAX_SOCKETS) {
+    return;
+  }
+
+  gsm_ppp_lock();
+  if (g_ppp.pcb[connect_id]) {
+    net_tcp_recved(&g_ppp.net, g_ppp.pcb[connect_id], len);
+  }
+  gsm_ppp_unlock();
+}
+
+#endif
@@ -0,0 +1,115 @@
+#ifndef GSM_PPP_H
+#define GSM_PPP_H
+
+#include "gsm.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief PPP 전송 (GSM_PPP_ENABLE)
+ *
+ * GSM_CMUX_DLC_PPP 채널을 ATD 로 데이터 모드에 두고 ppp.c + netstack.c 를
+ * 돌린다. 수신 바이트는 파서 태스크에서 ppp_input 으로 바로 들어가고, 타이머와
+ * 소켓 콜백 (연결, 수신, 송신 완료, 종료) 은 "gsm_ppp" 태스크가 잠금 밖에서
+ * 부른다. 스택 전체를 뮤텍스 하나로 감싼다.
+ *
+ * tcp_socket.c 가 gsm_tcp_* 대신 이 함수들을 쓰고, 소켓 상태와 콜백은
+ * gsm->tcp.sockets[] 에 그대로 둔다 (tcp_get_socket_state 등 호환).
+ */
+#define GSM_PPP_CID 1 ///< ATD*99***<cid># 로 쓸 PDP context
+#define GSM_PPP_TICK_MS 100 ///< 재전송/echo 타이머 주기
+#define GSM_PPP_CONNECT_TIMEOUT_MS 75000 ///< tcp_connect timeout 0 일 때
+#define GSM_PPP_DNS_TIMEOUT_MS 10000 ///< 호스트 이름으로 연결할 때 조회 대기
+
+/**
+ * @brief 잠금, 태스크 생성 (gsm_init 에서)
+ */
+void gsm_ppp_init(gsm_t *gsm);
+
+/**
+ * @brief PPP 채널 호출 (ATD, CONNECT 뒤 LCP 시작)
+ *
+ * 콜백은 CONNECT (ok) 또는 NO CARRIER/ERROR/타임아웃 에서 불린다. IPCP 가
+ * 열리면 GSM_EVT_PPP_UP, CONNECT 뒤 링크가 끊기면 (협상 실패 포함)
+ * GSM_EVT_PDP_DEACT.
+ */
+void gsm_ppp_dial(gsm_t *gsm, at_cmd_handler callback);
+
+/**
+ * @brief IP 를 주고받을 수 있음
+ */
+bool gsm_ppp_is_up(void);
+
+/*
+ * gsm.c (CMUX) 에서 부름
+ */
+
+/**
+ * @brief PPP 채널의 CONNECT (파서 태스크)
+ */
+void gsm_ppp_connected(gsm_t *gsm);
+
+/**
+ * @brief PPP 채널 수신 chunk (파서 태스크)
+ */
+void gsm_ppp_input(gsm_t *gsm, const uint8_t *data, size_t len);
+
+/**
+ * @brief PPP 채널 DCD 내려감 또는 다중화 끝
+ *
+ * @param notify true: 링크가 올라와 있었으면 GSM_EVT_PDP_DEACT
+ */
+void gsm_ppp_carrier_lost(gsm_t *gsm, bool notify);
+
+/**
+ * @brief DNS A 레코드 조회 (IPCP 로 받은 서버, 동기식)
+ *
+ * gsm_dns_resolve 와 같은 약속 (gsm->dns.sem 으로 기다림).
+ */
+int gsm_ppp_dns_resolve(gsm_t *gsm, const char *host, char *addr, size_t size,
+                        uint32_t timeout_ms);
+
+/*
+ * tcp_socket.c 에서 부름
+ */
+
+/**
+ * @brief TCP 연결 (SYN-ACK 또는 실패까지 기다림)
+ *
+ * @param remote_ip 점 표기 주소 (아니면 DNS 로 조회)
+ * @param timeout_ms 0: GSM_PPP_CONNECT_TIMEOUT_MS
+ * @return 0: 연결됨, -1: 링크 없음, 소켓 사용 중, 거절 또는 타임아웃
+ */
+int gsm_ppp_tcp_open(gsm_t *gsm, uint8_t connect_id, const char *remote_ip,
+                     uint16_t remote_port, tcp_recv_callback_t on_recv,
+                     tcp_close_callback_t on_close, uint32_t timeout_ms);
+
+/**
+ * @brief pbuf 체인 송신 대기열에 넣기 (ACK 를 받으면 완료 콜백)
+ *
+ * @return 0: 넣음, -1: 연결 안 됨 또는 대기열 가득 (소유권은 호출자에게)
+ */
+int gsm_ppp_tcp_send(gsm_t *gsm, uint8_t connect_id, tcp_pbuf_t *chain,
+                     bool pool, tcp_sent_cb_t cb, void *ctx);
+
+/**
+ * @brief 연결 닫기 (소켓은 바로 CLOSED)
+ *
+ * @param abort false: 남은 데이터를 보낸 뒤 FIN, true: RST
+ */
+int gsm_ppp_tcp_close(gsm_t *gsm, uint8_t connect_id, bool abort);
+
+/**
+ * @brief 수신 큐에서 pbuf 하나 꺼내기 (on_recv 에서)
+ *
+ * 꺼낸 바이트는 gsm_ppp_tcp_recved 전까지 수신 창에서 빠진다.
+ */
+tcp_pbuf_t *gsm_ppp_tcp_pull(gsm_t *gsm, uint8_t connect_id);
+
+/**
+ * @brief 꺼낸 바이트를 앱이 가져감 (창 열기)
+ */
+void gsm_ppp_tcp_recved(gsm_t *gsm, uint8_t connect_id, size_t len);
+
+#endif
@@ -0,0 +1,1320 @@
+#include "netstack.h"
+
+#if GSM_PPP_ENABLE
+
+#include <string.h>
+
+#ifndef TAG
+  #define TAG "NET"
+#endif
+
+#include "log.h"
+
+#define IP_PROTO_TCP 6
+#define IP_PROTO_UDP 17
+#define IP_HDR_LEN 20
+#define UDP_HDR_LEN 8
+#define TCP_HDR_LEN 20
+#define TCP_OPT_MSS_LEN 4
+
+#define TCP_FIN 0x01
+#define TCP_SYN 0x02
+#define TCP_RST 0x04
+#define TCP_PSH 0x08
+#define TCP_ACK 0x10
+
+#define DNS_PORT 53
+#define DNS_HDR_LEN 12
+
+#define SEQ_LT(a, b) ((int32_t)((a) - (b)) < 0)
+#define SEQ_LEQ(a, b) ((int32_t)((a) - (b)) <= 0)
+#define SEQ_GT(a, b) ((int32_t)((a) - (b)) > 0)
+#define SEQ_GEQ(a, b) ((int32_t)((a) - (b)) >= 0)
+
+static inline uint16_t get16(const uint8_t *p) {
+  return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+static inline uint32_t get32(const uint8_t *p) {
+  return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+         ((uint32_t)p[2] << 8) | p[3];
+}
+
+static inline void put16(uint8_t *p, uint16_t v) {
+  p[0] = (uint8_t)(v >> 8);
+  p[1] = (uint8_t)v;
+}
+
+static inline void put32(uint8_t *p, uint32_t v) {
+  p[0] = (uint8_t)(v >> 24);
+  p[1] = (uint8_t)(v >> 16);
+  p[2] = (uint8_t)(v >> 8);
+  p[3] = (uint8_t)v;
+}
+
+static inline uint32_t min32(uint32_t a, uint32_t b) { return a < b ? a : b; }
+
+static inline uint32_t max32(uint32_t a, uint32_t b) { return a > b ? a : b; }
+
+static uint32_t net_rand(net_t *net) {
+  uint32_t x = net->rand;
+
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  net->rand = x;
+  return x;
+}
+
+/*
+ * 체크섬 (구간 경계가 홀수여도 이어서 더함)
+ */
+
+typedef struct {
+  uint32_t sum;
+  bool odd;
+} net_csum_t;
+
+static void net_csum_add(net_csum_t *c, const uint8_t *p, size_t len) {
+  if (c->odd && len) {
+    c->sum += *p++;
+    len--;
+    c->odd = false;
+  }
+  while (len >= 2) {
+    c->sum += get16(p);
+    p += 2;
+    len -= 2;
+  }
+  if (len) {
+    c->sum += (uint32_t)*p << 8;
+    c->odd = true;
+  }
+}
+
+static void net_csum_pseudo(net_csum_t *c, uint32_t src, uint32_t dst,
+                            uint8_t proto, size_t len) {
+  c->sum += (src >> 16) + (src & 0xFFFF) + (dst >> 16) + (dst & 0xFFFF);
+  c->sum += proto + (uint32_t)len;
+}
+
+static uint16_t net_csum_fold(const net_csum_t *c) {
+  uint32_t sum = c->sum;
+
+  while (sum >> 16) {
+    sum = (sum & 0xFFFF) + (sum >> 16);
+  }
+  return (uint16_t)~sum;
+}
+
+/**
+ * @brief IP 헤더를 채워 송신
+ *
+ * @param ip seg[0] 앞 IP_HDR_LEN 바이트 (seg[0] 에 포함)
+ */
+static int net_ip_output(net_t *net, uint8_t *ip, uint32_t dst, uint8_t proto,
+                         const ppp_seg_t *seg, size_t cnt) {
+  net_csum_t c = {0};
+  size_t len = 0;
+
+  if (!net->up) {
+    return -1;
+  }
+
+  for (size_t i = 0; i < cnt; i++) {
+    len += seg[i].len;
+  }
+
+  ip[0] = 0x45;
+  ip[1] = 0;
+  put16(&ip[2], (uint16_t)len);
+  put16(&ip[4], net->ip_id++);
+  put16(&ip[6], 0x4000); // DF
+  ip[8] = 64;
+  ip[9] = proto;
+  put16(&ip[10], 0);
+  put32(&ip[12], net->addr);
+  put32(&ip[16], dst);
+  net_csum_add(&c, ip, IP_HDR_LEN);
+  put16(&ip[10], net_csum_fold(&c));
+
+  net->stats.ip_tx++;
+  return net->ops->output(net->ctx, seg, cnt);
+}
+
+/*
+ * TCP 송신
+ */
+
+static net_tcp_t *net_tcp_find(net_t *net, uint32_t rip, uint16_t rport,
+                               uint16_t lport) {
+  for (uint8_t i = 0; i < NET_TCP_PCB_CNT; i++) {
+    net_tcp_t *pcb = &net->pcb[i];
+
+    if (pcb->used && pcb->state != NET_TCP_CLOSED && pcb->rip == rip &&
+        pcb->rport == rport && pcb->lport == lport) {
+      return pcb;
+    }
+  }
+  return NULL;
+}
+
+/**
+ * @brief 지금 알릴 수신 창 (알려 준 오른쪽 끝은 당기지 않음)
+ */
+static uint32_t net_tcp_rcv_wnd(const net_tcp_t *pcb) {
+  uint32_t wnd = pcb->rcv_held < NET_TCP_WND ? NET_TCP_WND - pcb->rcv_held : 0;
+
+  if (SEQ_LT(pcb->rcv_nxt + wnd, pcb->rcv_adv)) {
+    wnd = pcb->rcv_adv - pcb->rcv_nxt;
+  }
+  return wnd;
+}
+
+/**
+ * @brief 세그먼트 하나 송신 (seq 부터 n 바이트, 대기열 pbuf 를 그대로 모음)
+ *
+ * @return 실제로 담은 데이터 (구간 수가 모자라면 n 보다 작음)
+ */
+static uint32_t net_tcp_send(net_t *net, net_tcp_t *pcb, uint32_t seq,
+                             uint32_t n, uint8_t flags) {
+  uint8_t hdr[IP_HDR_LEN + TCP_HDR_LEN + TCP_OPT_MSS_LEN];
+  ppp_seg_t seg[1 + NET_TCP_SEG_MAX];
+  size_t cnt = 1;
+  size_t hlen = TCP_HDR_LEN;
+  uint8_t *t = &hdr[IP_HDR_LEN];
+  net_csum_t c = {0};
+
+  if (n) {
+    // 완료되지 않은 첫 쓰기의 wr_off 가 snd_una
+    uint32_t skip = seq - pcb->snd_una + pcb->wr_off;
+    uint32_t want = n;
+
+    n = 0;
+    for (uint8_t i = pcb->wr_acked; i < pcb->wr_cnt && want; i++) {
+      const gsm_tcp_tx_t *tx = &pcb->wr[(pcb->wr_head + i) % NET_TCP_SNDQ].tx;
+
+      for (tcp_pbuf_t *p = tx->chain; p && want && cnt < 1 + NET_TCP_SEG_MAX;
+           p = p->next) {
+        if (skip >= p->len) {
+          skip -= (uint32_t)p->len;
+          continue;
+        }
+
+        uint32_t take = min32((uint32_t)p->len - skip, want);
+
+        seg[cnt].data = &p->payload[skip];
+        seg[cnt].len = take;
+        cnt++;
+        skip = 0;
+        want -= take;
+        n += take;
+      }
+    }
+  }
+
+  if (flags & TCP_SYN) {
+    hlen += TCP_OPT_MSS_LEN;
+    t[20] = 2;
+    t[21] = 4;
+    put16(&t[22], NET_TCP_MSS);
+  }
+
+  uint32_t wnd = net_tcp_rcv_wnd(pcb);
+
+  put16(&t[0], pcb->lport);
+  put16(&t[2], pcb->rport);
+  put32(&t[4], seq);
+  put32(&t[8], (flags & TCP_ACK) ? pcb->rcv_nxt : 0);
+  t[12] = (uint8_t)((hlen / 4) << 4);
+  t[13] = flags;
+  put16(&t[14], (uint16_t)min32(wnd, 0xFFFF));
+  put16(&t[16], 0);
+  put16(&t[18], 0);
+
+  net_csum_pseudo(&c, net->addr, pcb->rip, IP_PROTO_TCP, hlen + n);
+  net_csum_add(&c, t, hlen);
+  for (size_t i = 1; i < cnt; i++) {
+    net_csum_add(&c, seg[i].data, seg[i].len);
+  }
+  put16(&t[16], net_csum_fold(&c));
+
+  seg[0].data = hdr;
+  seg[0].len = IP_HDR_LEN + hlen;
+
+  if (flags & TCP_ACK) {
+    pcb->rcv_adv = pcb->rcv_nxt + min32(wnd, 0xFFFF);
+    pcb->ack_pend = 0;
+  }
+  net_ip_output(net, hdr, pcb->rip, IP_PROTO_TCP, seg, cnt);
+  return n;
+}
+
+static void net_tcp_send_ack(net_t *net, net_tcp_t *pcb) {
+  net_tcp_send(net, pcb, pcb->snd_nxt, 0, TCP_ACK);
+}
+
+/**
+ * @brief 연결 없는 세그먼트에 RST 로 답함
+ */
+static void net_tcp_send_rst(net_t *net, uint32_t dst, uint16_t dport,
+                             uint16_t sport, uint32_t seq, uint32_t ack,
+                             uint8_t flags) {
+  uint8_t hdr[IP_HDR_LEN + TCP_HDR_LEN];
+  ppp_seg_t seg = {hdr, sizeof(hdr)};
+  uint8_t *t = &hdr[IP_HDR_LEN];
+  net_csum_t c = {0};
+
+  memset(t, 0, TCP_HDR_LEN);
+  put16(&t[0], sport);
+  put16(&t[2], dport);
+  put32(&t[4], seq);
+  put32(&t[8], ack);
+  t[12] = (TCP_HDR_LEN / 4) << 4;
+  t[13] = flags;
+
+  net_csum_pseudo(&c, net->addr, dst, IP_PROTO_TCP, TCP_HDR_LEN);
+  net_csum_add(&c, t, TCP_HDR_LEN);
+  put16(&t[16], net_csum_fold(&c));
+  net_ip_output(net, hdr, dst, IP_PROTO_TCP, &seg, 1);
+}
+
+/**
+ * @brief 창과 혼잡 창이 허락하는 만큼 데이터, 그 뒤 FIN, 없으면 미룬 ACK
+ */
+static void net_tcp_output(net_t *net, net_tcp_t *pcb) {
+  uint32_t data_end = pcb->snd_una + pcb->snd_buf;
+  bool sent = false;
+
+  if (pcb->state == NET_TCP_CLOSED || pcb->state == NET_TCP_SYN_SENT) {
+    return;
+  }
+
+  while (SEQ_LT(pcb->snd_nxt, data_end)) {
+    uint32_t avail = data_end - pcb->snd_nxt;
+    uint32_t flight = pcb->snd_nxt - pcb->snd_una;
+    uint32_t wnd = min32(pcb->snd_wnd, pcb->cwnd);
+
+    if (flight >= wnd) {
+      break;
+    }
+
+    uint32_t n = min32(min32(avail, wnd - flight), pcb->mss);
+
+    // 작은 조각으로 창을 채우지 않는다 (보낸 것이 없으면 예외)
+    if (n < avail && n < pcb->mss && flight > 0) {
+      break;
+    }
+
+    if (!pcb->rtt_on && pcb->snd_nxt == pcb->snd_max) {
+      pcb->rtt_on = true;
+      pcb->rtt_seq = pcb->snd_nxt;
+      pcb->rtt_ms = 0;
+    }
+    n = net_tcp_send(net, pcb, pcb->snd_nxt, n,
+                     TCP_ACK | (n == avail ? TCP_PSH : 0));
+    if (n == 0) {
+      break;
+    }
+    pcb->snd_nxt += n;
+    if (SEQ_GT(pcb->snd_nxt, pcb->snd_max)) {
+      pcb->snd_max = pcb->snd_nxt;
+    }
+    sent = true;
+  }
+
+  if (pcb->fin_queued && pcb->snd_nxt == data_end &&
+      (pcb->state == NET_TCP_FIN_WAIT_1 || pcb->state == NET_TCP_CLOSING ||
+       pcb->state == NET_TCP_LAST_ACK)) {
+    net_tcp_send(net, pcb, data_end, 0, TCP_FIN | TCP_ACK);
+    pcb->snd_nxt = data_end + 1;
+    if (SEQ_GT(pcb->snd_nxt, pcb->snd_max)) {
+      pcb->snd_max = pcb->snd_nxt;
+    }
+    sent = true;
+  }
+
+  if (sent && pcb->rto_ms == 0) {
+    pcb->rto_ms = pcb->rto;
+  } else if (!sent && pcb->snd_wnd == 0 && pcb->snd_nxt == pcb->snd_una &&
+             pcb->snd_buf && pcb->rto_ms == 0) {
+    // 창 0: probe 타이머
+    pcb->rto_ms = pcb->rto;
+  }
+
+  if (!sent && pcb->ack_pend) {
+    net_tcp_send_ack(net, pcb);
+  }
+}
+
+/*
+ * 연결 상태
+ */
+
+static void net_tcp_rxq_free(net_tcp_t *pcb) {
+  tcp_pbuf_free_chain(pcb->rxq_head);
+  pcb->rxq_head = NULL;
+  pcb->rxq_tail = NULL;
+}
+
+/**
+ * @brief 떼어 냈고 가져갈 완료가 없으면 슬롯을 비움
+ */
+static void net_tcp_gc(net_tcp_t *pcb) {
+  if (pcb->used && !pcb->attached && pcb->state == NET_TCP_CLOSED &&
+      pcb->wr_cnt == 0) {
+    net_tcp_rxq_free(pcb);
+    memset(pcb, 0, sizeof(*pcb));
+  }
+}
+
+/**
+ * @brief 남은 쓰기를 모두 실패로 완료
+ */
+static void net_tcp_fail_writes(net_tcp_t *pcb) {
+  for (uint8_t i = pcb->wr_acked; i < pcb->wr_cnt; i++) {
+    pcb->wr[(pcb->wr_head + i) % NET_TCP_SNDQ].done = 2;
+  }
+  if (pcb->wr_acked < pcb->wr_cnt) {
+    pcb->events |= NET_TCP_EV_SENT;
+  }
+  pcb->wr_acked = pcb->wr_cnt;
+  pcb->wr_off = 0;
+  pcb->snd_buf = 0;
+}
+
+/**
+ * @brief 바로 CLOSED (RST, 타임아웃, 링크 끊김)
+ */
+static void net_tcp_kill(net_tcp_t *pcb, net_tcp_err_t err) {
+  if (pcb->state == NET_TCP_CLOSED) {
+    return;
+  }
+
+  if (pcb->attached) {
+    LOG_WARN("TCP cid=%d 끊김 (err=%d)", pcb->cid, (int)err);
+    pcb->events |= NET_TCP_EV_CLOSED;
+  }
+  pcb->state = NET_TCP_CLOSED;
+  pcb->err = err;
+  pcb->rto_ms = 0;
+  net_tcp_fail_writes(pcb);
+  net_tcp_gc(pcb);
+}
+
+static void net_tcp_time_wait(net_tcp_t *pcb) {
+  pcb->state = NET_TCP_TIME_WAIT;
+  pcb->wait_ms = NET_TCP_TIME_WAIT_MS;
+  pcb->rto_ms = 0;
+}
+
+/**
+ * @brief 상대가 닫았고 수신 큐를 다 읽었으면 CLOSED 알림
+ */
+static void net_tcp_check_eof(net_tcp_t *pcb) {
+  if (pcb->attached && pcb->fin_rcvd && !pcb->rxq_head) {
+    pcb->events |= NET_TCP_EV_CLOSED;
+  }
+}
+
+static void net_tcp_rtt(net_tcp_t *pcb, uint32_t m) {
+  if (pcb->srtt == 0) {
+    pcb->srtt = m << 3;
+    pcb->rttvar = m << 1;
+  } else {
+    int32_t delta = (int32_t)m - (int32_t)(pcb->srtt >> 3);
+
+    pcb->srtt = (uint32_t)((int32_t)pcb->srtt + delta);
+    if (delta < 0) {
+      delta = -delta;
+    }
+    delta -= (int32_t)(pcb->rttvar >> 2);
+    pcb->rttvar = (uint32_t)((int32_t)pcb->rttvar + delta);
+  }
+
+  pcb->rto = max32(NET_TCP_RTO_MIN_MS,
+                   min32((pcb->srtt >> 3) + pcb->rttvar, NET_TCP_RTO_MAX_MS));
+}
+
+/**
+ * @brief ACK 받은 바이트만큼 쓰기 완료
+ */
+static void net_tcp_consume(net_tcp_t *pcb, uint32_t n) {
+  pcb->snd_buf -= n;
+
+  while (n && pcb->wr_acked < pcb->wr_cnt) {
+    net_tcp_wr_t *w = &pcb->wr[(pcb->wr_head + pcb->wr_acked) % NET_TCP_SNDQ];
+    uint32_t rem = (uint32_t)w->tx.len - pcb->wr_off;
+
+    if (n < rem) {
+      pcb->wr_off += (uint16_t)n;
+      return;
+    }
+    n -= rem;
+    w->done = 1;
+    pcb->wr_acked++;
+    pcb->wr_off = 0;
+    pcb->events |= NET_TCP_EV_SENT;
+  }
+}
+
+/**
+ * @brief ACK 필드 처리
+ *
+ * @return false: 세그먼트를 더 볼 필요 없음 (버림 또는 연결 닫힘)
+ */
+static bool net_tcp_ack(net_t *net, net_tcp_t *pcb, uint32_t seq, uint32_t ack,
+                        uint32_t win, uint32_t dlen, uint8_t flags) {
+  if (SEQ_GT(ack, pcb->snd_max)) {
+    // 보내지 않은 것에 대한 ACK
+    net_tcp_send_ack(net, pcb);
+    return false;
+  }
+
+  // 창 갱신이나 데이터가 실린 것은 중복 ACK 가 아니다
+  bool dup = ack == pcb->snd_una && dlen == 0 && !(flags & TCP_FIN) &&
+             win == pcb->snd_wnd && pcb->snd_max != pcb->snd_una;
+  uint32_t flight = pcb->snd_nxt - pcb->snd_una;
+
+  if (SEQ_LT(pcb->snd_wl1, seq) ||
+      (pcb->snd_wl1 == seq && SEQ_LEQ(pcb->snd_wl2, ack))) {
+    pcb->snd_wnd = win;
+    pcb->snd_wl1 = seq;
+    pcb->snd_wl2 = ack;
+  }
+
+  if (ack == pcb->snd_una) {
+    if (dup) {
+      if (++pcb->dupacks == 3) {
+        // 빠른 재전송: 빠진 세그먼트 하나만 다시
+        pcb->ssthresh = max32(flight / 2, 2u * pcb->mss);
+        pcb->cwnd = pcb->ssthresh + 3u * pcb->mss;
+        pcb->rtt_on = false;
+        net->stats.rexmit++;
+        if (pcb->snd_buf) {
+          net_tcp_send(net, pcb, pcb->snd_una, min32(pcb->snd_buf, pcb->mss),
+                       TCP_ACK);
+        }
+      } else if (pcb->dupacks > 3) {
+        pcb->cwnd += pcb->mss;
+      }
+    }
+    return true;
+  }
+
+  if (SEQ_LT(ack, pcb->snd_una)) {
+    return true; // 오래된 ACK
+  }
+
+  // 새 ACK
+  uint32_t acked = ack - pcb->snd_una;
+  bool fin_acked = acked > pcb->snd_buf;
+
+  net_tcp_consume(pcb, min32(acked, pcb->snd_buf));
+  pcb->snd_una = ack;
+  if (SEQ_LT(pcb->snd_nxt, ack)) {
+    pcb->snd_nxt = ack;
+  }
+
+  if (pcb->rtt_on && SEQ_GT(ack, pcb->rtt_seq)) {
+    pcb->rtt_on = false;
+    net_tcp_rtt(pcb, pcb->rtt_ms);
+  }
+
+  if (pcb->dupacks >= 3) {
+    pcb->cwnd = pcb->ssthresh; // 빠른 회복 끝
+  } else if (pcb->cwnd < pcb->ssthresh) {
+    pcb->cwnd += pcb->mss;
+  } else {
+    pcb->cwnd += max32(1, (uint32_t)pcb->mss * pcb->mss / pcb->cwnd);
+  }
+  pcb->dupacks = 0;
+  pcb->retries = 0;
+  pcb->rto_ms = pcb->snd_nxt != pcb->snd_una ? pcb->rto : 0;
+
+  if (fin_acked) {
+    switch (pcb->state) {
+    case NET_TCP_FIN_WAIT_1:
+      pcb->state = NET_TCP_FIN_WAIT_2;
+      break;
+    case NET_TCP_CLOSING:
+      net_tcp_time_wait(pcb);
+      break;
+    case NET_TCP_LAST_ACK:
+      pcb->state = NET_TCP_CLOSED;
+      net_tcp_gc(pcb);
+      return false;
+    default:
+      break;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief 받은 payload 를 큐에 (작으면 작은 등급으로 옮기고 IP 프레임 블록은 반납)
+ */
+static tcp_pbuf_t *net_tcp_take(net_t *net, tcp_pbuf_t *p, uint8_t *data,
+                                size_t len) {
+  if (len <= NET_TCP_COPY_MAX) {
+    tcp_pbuf_t *q = tcp_pbuf_alloc(len);
+
+    if (q) {
+      memcpy(q->payload, data, len);
+      tcp_pbuf_free(p);
+      return q;
+    }
+    net->stats.no_pbuf++;
+  }
+
+  p->payload = data;
+  p->len = len;
+  p->tot_len = len;
+  p->next = NULL;
+  return p;
+}
+
+static void net_tcp_input(net_t *net, tcp_pbuf_t *p, size_t ihl, size_t tot,
+                          uint32_t src) {
+  uint8_t *t = &p->payload[ihl];
+  size_t tlen = tot - ihl;
+  net_csum_t c = {0};
+
+  if (tlen < TCP_HDR_LEN || (size_t)(t[12] >> 4) * 4 < TCP_HDR_LEN ||
+      (size_t)(t[12] >> 4) * 4 > tlen) {
+    net->stats.bad++;
+    tcp_pbuf_free(p);
+    return;
+  }
+
+  net_csum_pseudo(&c, src, net->addr, IP_PROTO_TCP, tlen);
+  net_csum_add(&c, t, tlen);
+  if (net_csum_fold(&c) != 0) {
+    net->stats.bad++;
+    tcp_pbuf_free(p);
+    return;
+  }
+
+  size_t off = (size_t)(t[12] >> 4) * 4;
+  uint16_t sport = get16(&t[0]);
+  uint16_t dport = get16(&t[2]);
+  uint32_t seq = get32(&t[4]);
+  uint32_t ack = get32(&t[8]);
+  uint8_t flags = t[13];
+  uint32_t win = get16(&t[14]);
+  uint8_t *data = &t[off];
+  uint32_t dlen = (uint32_t)(tlen - off);
+  net_tcp_t *pcb = net_tcp_find(net, src, sport, dport);
+
+  if (!pcb) {
+    net->stats.no_pcb++;
+    if (!(flags & TCP_RST)) {
+      if (flags & TCP_ACK) {
+        net_tcp_send_rst(net, src, sport, dport, ack, 0, TCP_RST);
+      } else {
+        net_tcp_send_rst(net, src, sport, dport, 0,
+                         seq + dlen + !!(flags & TCP_SYN) + !!(flags & TCP_FIN),
+                         TCP_RST | TCP_ACK);
+      }
+    }
+    tcp_pbuf_free(p);
+    return;
+  }
+
+  if (pcb->state == NET_TCP_SYN_SENT) {
+    if ((flags & TCP_ACK) && ack != pcb->iss + 1) {
+      if (!(flags & TCP_RST)) {
+        net_tcp_send_rst(net, src, sport, dport, ack, 0, TCP_RST);
+      }
+    } else if (flags & TCP_RST) {
+      if (flags & TCP_ACK) {
+        net_tcp_kill(pcb, NET_TCP_ERR_RESET);
+      }
+    } else if ((flags & (TCP_SYN | TCP_ACK)) == (TCP_SYN | TCP_ACK)) {
+      uint16_t mss = 536;
+
+      // MSS 옵션
+      for (size_t i = TCP_HDR_LEN; i + 1 < off;) {
+        if (t[i] == 0) {
+          break;
+        }
+        if (t[i] == 1) {
+          i++;
+          continue;
+        }
+        if (t[i + 1] < 2) {
+          break;
+        }
+        if (t[i] == 2 && t[i + 1] == 4 && i + 4 <= off) {
+          mss = get16(&t[i + 2]);
+        }
+        i += t[i + 1];
+      }
+
+      pcb->irs = seq;
+      pcb->rcv_nxt = seq + 1;
+      pcb->rcv_adv = pcb->rcv_nxt;
+      pcb->snd_una = ack;
+      pcb->snd_wnd = win;
+      pcb->snd_wl1 = seq;
+      pcb->snd_wl2 = ack;
+      pcb->mss = (uint16_t)min32(mss, NET_TCP_MSS);
+      pcb->cwnd = min32(4u * pcb->mss, max32(2u * pcb->mss, 4380));
+      pcb->ssthresh = 0xFFFF;
+      if (pcb->rtt_on && pcb->retries == 0) {
+        net_tcp_rtt(pcb, pcb->rtt_ms);
+      }
+      pcb->rtt_on = false;
+      pcb->retries = 0;
+      pcb->rto_ms = 0;
+      pcb->state = NET_TCP_ESTABLISHED;
+      pcb->events |= NET_TCP_EV_CONNECTED;
+      net_tcp_send_ack(net, pcb);
+    }
+    tcp_pbuf_free(p);
+    return;
+  }
+
+  // 순번 확인 (RFC 793 acceptance test)
+  uint32_t wnd = pcb->rcv_adv - pcb->rcv_nxt;
+  uint32_t seg_len = dlen + !!(flags & TCP_SYN) + !!(flags & TCP_FIN);
+  bool ok;
+
+  if (seg_len == 0) {
+    ok = wnd == 0 ? seq == pcb->rcv_nxt
+                  : SEQ_GEQ(seq, pcb->rcv_nxt) &&
+                        SEQ_LT(seq, pcb->rcv_nxt + wnd);
+  } else {
+    ok = wnd != 0 && ((SEQ_GEQ(seq, pcb->rcv_nxt) &&
+                       SEQ_LT(seq, pcb->rcv_nxt + wnd)) ||
+                      (SEQ_GEQ(seq + seg_len - 1, pcb->rcv_nxt) &&
+                       SEQ_LT(seq + seg_len - 1, pcb->rcv_nxt + wnd)));
+  }
+  // 창 0 이어도 지금 순번의 ACK/FIN 은 본다
+  if (!ok && seq == pcb->rcv_nxt && dlen == 0) {
+    ok = true;
+  }
+
+  if (!ok) {
+    if (!(flags & TCP_RST)) {
+      if (SEQ_GT(seq, pcb->rcv_nxt)) {
+        net->stats.ooseq++;
+      }
+      net_tcp_send_ack(net, pcb);
+    }
+    tcp_pbuf_free(p);
+    return;
+  }
+
+  if (flags & (TCP_RST | TCP_SYN)) {
+    if (flags & TCP_SYN) {
+      net_tcp_send(net, pcb, pcb->snd_nxt, 0, TCP_RST);
+    }
+    net_tcp_kill(pcb, NET_TCP_ERR_RESET);
+    tcp_pbuf_free(p);
+    return;
+  }
+
+  if (!(flags & TCP_ACK) ||
+      !net_tcp_ack(net, pcb, seq, ack, win, dlen, flags)) {
+    tcp_pbuf_free(p);
+    return;
+  }
+
+  // 앞부분이 이미 받은 것이면 잘라 냄, 뒤에 빈 곳이 있으면 버리고 중복 ACK
+  bool fin = (flags & TCP_FIN) != 0;
+
+  if (SEQ_LT(seq, pcb->rcv_nxt)) {
+    uint32_t skip = pcb->rcv_nxt - seq;
+
+    if (skip > dlen) {
+      // FIN 까지 이미 받음
+      net_tcp_send_ack(net, pcb);
+      tcp_pbuf_free(p);
+      return;
+    }
+    data += skip;
+    dlen -= skip;
+  } else if (SEQ_GT(seq, pcb->rcv_nxt)) {
+    net->stats.ooseq++;
+    net_tcp_send_ack(net, pcb);
+    tcp_pbuf_free(p);
+    return;
+  }
+  if (dlen > wnd) {
+    dlen = wnd;
+    fin = false;
+  }
+
+  bool queued = false;
+
+  if (dlen && !pcb->fin_rcvd) {
+    if (pcb->attached) {
+      tcp_pbuf_t *q = net_tcp_take(net, p, data, dlen);
+
+      if (pcb->rxq_tail) {
+        pcb->rxq_tail->next = q;
+      } else {
+        pcb->rxq_head = q;
+      }
+      pcb->rxq_tail = q;
+      pcb->rcv_held += dlen;
+      pcb->events |= NET_TCP_EV_RECV;
+      queued = true;
+    }
+    // 닫은 뒤 온 데이터는 읽을 곳이 없으니 ACK 만 한다
+    pcb->rcv_nxt += dlen;
+    if (++pcb->ack_pend >= 2) {
+      net_tcp_send_ack(net, pcb);
+    }
+  }
+
+  if (!queued) {
+    tcp_pbuf_free(p);
+  }
+
+  if (fin && !pcb->fin_rcvd) {
+    pcb->rcv_nxt++;
+    pcb->fin_rcvd = true;
+    switch (pcb->state) {
+    case NET_TCP_ESTABLISHED:
+      pcb->state = NET_TCP_CLOSE_WAIT;
+      break;
+    case NET_TCP_FIN_WAIT_1:
+      pcb->state = NET_TCP_CLOSING;
+      break;
+    case NET_TCP_FIN_WAIT_2:
+      net_tcp_time_wait(pcb);
+      break;
+    default:
+      break;
+    }
+    net_tcp_send_ack(net, pcb);
+    net_tcp_check_eof(pcb);
+  } else if (fin && pcb->state == NET_TCP_TIME_WAIT) {
+    net_tcp_send_ack(net, pcb);
+    pcb->wait_ms = NET_TCP_TIME_WAIT_MS;
+  }
+
+  net_tcp_output(net, pcb);
+}
+
+/*
+ * DNS (UDP)
+ */
+
+static void net_dns_send(net_t *net) {
+  uint8_t hdr[IP_HDR_LEN + UDP_HDR_LEN];
+  uint8_t msg[DNS_HDR_LEN + NET_DNS_HOST_MAX + 2 + 4];
+  ppp_seg_t seg[2] = {{hdr, sizeof(hdr)}, {msg, 0}};
+  uint8_t *u = &hdr[IP_HDR_LEN];
+  uint32_t dst = net->dns_srv[net->dns.srv];
+  size_t n = DNS_HDR_LEN;
+  const char *h = net->dns.host;
+  net_csum_t c = {0};
+
+  memset(msg, 0, DNS_HDR_LEN);
+  put16(&msg[0], net->dns.id);
+  put16(&msg[2], 0x0100); // RD
+  put16(&msg[4], 1);
+
+  // "a.b.c" -> 1a1b1c0
+  while (*h) {
+    const char *dot = strchr(h, '.');
+    size_t l = dot ? (size_t)(dot - h) : strlen(h);
+
+    msg[n++] = (uint8_t)l;
+    memcpy(&msg[n], h, l);
+    n += l;
+    h += l + (dot ? 1 : 0);
+  }
+  msg[n++] = 0;
+  put16(&msg[n], 1); // A
+  put16(&msg[n + 2], 1); // IN
+  n += 4;
+  seg[1].len = n;
+
+  put16(&u[0], net->dns.port);
+  put16(&u[2], DNS_PORT);
+  put16(&u[4], (uint16_t)(UDP_HDR_LEN + n));
+  put16(&u[6], 0);
+  net_csum_pseudo(&c, net->addr, dst, IP_PROTO_UDP, UDP_HDR_LEN + n);
+  net_csum_add(&c, u, UDP_HDR_LEN);
+  net_csum_add(&c, msg, n);
+  uint16_t sum = net_csum_fold(&c);
+
+  put16(&u[6], sum ? sum : 0xFFFF); // 0 은 "체크섬 없음"
+
+  net->dns.timer_ms = NET_DNS_TIMEOUT_MS;
+  net_ip_output(net, hdr, dst, IP_PROTO_UDP, seg, 2);
+}
+
+/**
+ * @brief 압축 포함 이름 건너뛰기
+ *
+ * @return 다음 위치, 0: 잘못된 메시지
+ */
+static size_t net_dns_skip_name(const uint8_t *m, size_t len, size_t i) {
+  while (i < len) {
+    if ((m[i] & 0xC0) == 0xC0) {
+      return i + 2 <= len ? i + 2 : 0;
+    }
+    if (m[i] == 0) {
+      return i + 1;
+    }
+    i += (size_t)m[i] + 1;
+  }
+  return 0;
+}
+
+static void net_dns_input(net_t *net, const uint8_t *m, size_t len) {
+  if (net->dns.state != NET_DNS_BUSY || len < DNS_HDR_LEN ||
+      get16(&m[0]) != net->dns.id || !(m[2] & 0x80)) {
+    return;
+  }
+
+  uint16_t qd = get16(&m[4]);
+  uint16_t an = get16(&m[6]);
+  size_t i = DNS_HDR_LEN;
+
+  for (uint16_t k = 0; k < qd && i; k++) {
+    i = net_dns_skip_name(m, len, i);
+    i = i && i + 4 <= len ? i + 4 : 0;
+  }
+
+  for (uint16_t k = 0; k < an && i; k++) {
+    i = net_dns_skip_name(m, len, i);
+    if (!i || i + 10 > len) {
+      break;
+    }
+
+    uint16_t type = get16(&m[i]);
+    uint16_t cls = get16(&m[i + 2]);
+    uint16_t rdlen = get16(&m[i + 8]);
+
+    i += 10;
+    if (i + rdlen > len) {
+      break;
+    }
+    if (type == 1 && cls == 1 && rdlen == 4) {
+      net->dns.addr = get32(&m[i]);
+      net->dns.state = NET_DNS_DONE;
+      net->dns.timer_ms = 0;
+      return;
+    }
+    i += rdlen;
+  }
+
+  LOG_WARN("DNS %s: A 레코드 없음 (rcode=%d)", net->dns.host, m[3] & 0x0F);
+  net->dns.state = NET_DNS_FAIL;
+  net->dns.timer_ms = 0;
+}
+
+static void net_udp_input(net_t *net, const uint8_t *u, size_t ulen,
+                          uint32_t src) {
+  if (ulen < UDP_HDR_LEN || get16(&u[4]) < UDP_HDR_LEN ||
+      get16(&u[4]) > ulen) {
+    net->stats.bad++;
+    return;
+  }
+
+  ulen = get16(&u[4]);
+  if (get16(&u[6]) != 0) {
+    net_csum_t c = {0};
+
+    net_csum_pseudo(&c, src, net->addr, IP_PROTO_UDP, ulen);
+    net_csum_add(&c, u, ulen);
+    if (net_csum_fold(&c) != 0) {
+      net->stats.bad++;
+      return;
+    }
+  }
+
+  if (get16(&u[0]) == DNS_PORT && get16(&u[2]) == net->dns.port &&
+      src == net->dns_srv[net->dns.srv]) {
+    net_dns_input(net, &u[UDP_HDR_LEN], ulen - UDP_HDR_LEN);
+  }
+}
+
+/*
+ * 공개 API
+ */
+
+void net_init(net_t *net, const net_ops_t *ops, void *ctx, uint32_t seed) {
+  memset(net, 0, sizeof(*net));
+  net->ops = ops;
+  net->ctx = ctx;
+  net->rand = seed ? seed : 0x2545F491u;
+  net->ip_id = (uint16_t)net_rand(net);
+}
+
+void net_seed(net_t *net, uint32_t seed) {
+  net->rand ^= seed;
+  if (net->rand == 0) {
+    net->rand = 0x2545F491u;
+  }
+  net_rand(net);
+}
+
+void net_up(net_t *net, uint32_t addr, const uint32_t dns[2]) {
+  net->addr = addr;
+  net->dns_srv[0] = dns[0] ? dns[0] : dns[1];
+  net->dns_srv[1] = dns[0] ? dns[1] : 0;
+  net->up = true;
+}
+
+void net_down(net_t *net) {
+  net->up = false;
+
+  for (uint8_t i = 0; i < NET_TCP_PCB_CNT; i++) {
+    if (net->pcb[i].used) {
+      net_tcp_kill(&net->pcb[i], NET_TCP_ERR_LINK);
+    }
+  }
+
+  if (net->dns.state == NET_DNS_BUSY) {
+    net->dns.state = NET_DNS_FAIL;
+    net->dns.timer_ms = 0;
+  }
+}
+
+void net_input(net_t *net, tcp_pbuf_t *p) {
+  const uint8_t *d = p->payload;
+  size_t len = p->len;
+  size_t ihl;
+  size_t tot;
+  net_csum_t c = {0};
+
+  if (!net->up || len < IP_HDR_LEN || (d[0] >> 4) != 4) {
+    goto bad;
+  }
+
+  ihl = (size_t)(d[0] & 0x0F) * 4;
+  tot = get16(&d[2]);
+  if (ihl < IP_HDR_LEN || tot < ihl || tot > len) {
+    goto bad;
+  }
+
+  net_csum_add(&c, d, ihl);
+  // 조각은 받지 않는다 (DF 로 보내고 MSS 가 MRU 안)
+  if (net_csum_fold(&c) != 0 || (get16(&d[6]) & 0x3FFF) != 0 ||
+      get32(&d[16]) != net->addr) {
+    goto bad;
+  }
+
+  net->stats.ip_rx++;
+  switch (d[9]) {
+  case IP_PROTO_TCP:
+    net_tcp_input(net, p, ihl, tot, get32(&d[12]));
+    return;
+  case IP_PROTO_UDP:
+    net_udp_input(net, &d[ihl], tot - ihl, get32(&d[12]));
+    break;
+  default:
+    break;
+  }
+  tcp_pbuf_free(p);
+  return;
+
+bad:
+  net->stats.bad++;
+  tcp_pbuf_free(p);
+}
+
+void net_flush(net_t *net) {
+  for (uint8_t i = 0; i < NET_TCP_PCB_CNT; i++) {
+    net_tcp_t *pcb = &net->pcb[i];
+
+    if (pcb->used && pcb->ack_pend && pcb->state != NET_TCP_CLOSED) {
+      net_tcp_send_ack(net, pcb);
+    }
+  }
+}
+
+/**
+ * @brief 재전송 타이머 만료
+ */
+static void net_tcp_timeout(net_t *net, net_tcp_t *pcb) {
+  if (pcb->state == NET_TCP_SYN_SENT) {
+    if (pcb->retries >= NET_TCP_SYN_RETRIES) {
+      net_tcp_kill(pcb, NET_TCP_ERR_TIMEOUT);
+      return;
+    }
+    pcb->retries++;
+    pcb->rtt_on = false;
+    pcb->rto = min32(pcb->rto * 2, NET_TCP_RTO_MAX_MS);
+    pcb->rto_ms = pcb->rto;
+    net->stats.rexmit++;
+    net_tcp_send(net, pcb, pcb->iss, 0, TCP_SYN);
+    return;
+  }
+
+  bool probe = pcb->snd_wnd == 0;
+
+  // 창 0 probe 는 상대가 살아 있으면 끝없이 계속한다
+  if (!probe && pcb->retries >= NET_TCP_MAX_RETRIES) {
+    net_tcp_kill(pcb, NET_TCP_ERR_TIMEOUT);
+    return;
+  }
+  if (!probe) {
+    pcb->retries++;
+  }
+
+  uint32_t flight = pcb->snd_nxt - pcb->snd_una;
+
+  pcb->ssthresh = max32(flight / 2, 2u * pcb->mss);
+  pcb->cwnd = pcb->mss;
+  pcb->dupacks = 0;
+  pcb->rtt_on = false;
+  pcb->rto = min32(pcb->rto * 2, NET_TCP_RTO_MAX_MS);
+  pcb->rto_ms = pcb->rto;
+  net->stats.rexmit++;
+
+  if (probe && pcb->snd_buf) {
+    // 창이 열렸는지 1 바이트로 확인 (받으면 ACK 가 창을 알려 준다)
+    pcb->snd_nxt = pcb->snd_una + net_tcp_send(net, pcb, pcb->snd_una, 1,
+                                               TCP_ACK);
+    if (SEQ_GT(pcb->snd_nxt, pcb->snd_max)) {
+      pcb->snd_max = pcb->snd_nxt;
+    }
+    return;
+  }
+
+  // 처음부터 다시 보냄 (go-back-N, 창이 작아 한두 세그먼트)
+  pcb->snd_nxt = pcb->snd_una;
+  net_tcp_output(net, pcb);
+}
+
+void net_tick(net_t *net, uint32_t elapsed_ms) {
+  for (uint8_t i = 0; i < NET_TCP_PCB_CNT; i++) {
+    net_tcp_t *pcb = &net->pcb[i];
+
+    if (!pcb->used || pcb->state == NET_TCP_CLOSED) {
+      continue;
+    }
+
+    if (pcb->rtt_on) {
+      pcb->rtt_ms += elapsed_ms;
+    }
+
+    if (pcb->state == NET_TCP_TIME_WAIT) {
+      if (pcb->wait_ms <= elapsed_ms) {
+        pcb->state = NET_TCP_CLOSED;
+        net_tcp_gc(pcb);
+      } else {
+        pcb->wait_ms -= elapsed_ms;
+      }
+      continue;
+    }
+
+    if (pcb->rto_ms) {
+      if (pcb->rto_ms <= elapsed_ms) {
+        pcb->rto_ms = 0;
+        net_tcp_timeout(net, pcb);
+      } else {
+        pcb->rto_ms -= elapsed_ms;
+      }
+    }
+  }
+
+  if (net->dns.state == NET_DNS_BUSY && net->dns.timer_ms) {
+    if (net->dns.timer_ms > elapsed_ms) {
+      net->dns.timer_ms -= elapsed_ms;
+    } else if (++net->dns.tries < NET_DNS_TRIES) {
+      net_dns_send(net);
+    } else if (net->dns.srv == 0 && net->dns_srv[1]) {
+      net->dns.srv = 1;
+      net->dns.tries = 0;
+      net_dns_send(net);
+    } else {
+      LOG_WARN("DNS %s: 응답 없음", net->dns.host);
+      net->dns.state = NET_DNS_FAIL;
+      net->dns.timer_ms = 0;
+    }
+  }
+}
+
+int net_dns_query(net_t *net, const char *host) {
+  size_t len = strlen(host);
+
+  if (!net->up || !net->dns_srv[0] || net->dns.state == NET_DNS_BUSY ||
+      len == 0 || len >= NET_DNS_HOST_MAX) {
+    return -1;
+  }
+
+  memcpy(net->dns.host, host, len + 1);
+  net->dns.id = (uint16_t)net_rand(net);
+  net->dns.port = (uint16_t)(49152 + net_rand(net) % 16384);
+  net->dns.srv = 0;
+  net->dns.tries = 0;
+  net->dns.addr = 0;
+  net->dns.state = NET_DNS_BUSY;
+  net_dns_send(net);
+  return 0;
+}
+
+net_tcp_t *net_tcp_connect(net_t *net, uint8_t cid, uint32_t ip,
+                           uint16_t port) {
+  net_tcp_t *pcb = NULL;
+
+  if (!net->up) {
+    return NULL;
+  }
+
+  for (uint8_t i = 0; i < NET_TCP_PCB_CNT && !pcb; i++) {
+    if (!net->pcb[i].used) {
+      pcb = &net->pcb[i];
+    }
+  }
+  if (!pcb) {
+    return NULL;
+  }
+
+  memset(pcb, 0, sizeof(*pcb));
+  pcb->used = true;
+  pcb->attached = true;
+  pcb->cid = cid;
+  pcb->rip = ip;
+  pcb->rport = port;
+  do {
+    pcb->lport = (uint16_t)(49152 + net_rand(net) % 16384);
+  } while (net_tcp_find(net, ip, port, pcb->lport));
+
+  pcb->iss = net_rand(net);
+  pcb->snd_una = pcb->iss;
+  pcb->snd_nxt = pcb->iss + 1;
+  pcb->snd_max = pcb->snd_nxt;
+  pcb->mss = NET_TCP_MSS;
+  pcb->rto = NET_TCP_RTO_INIT_MS;
+  pcb->rto_ms = pcb->rto;
+  pcb->rtt_on = true;
+  pcb->rtt_seq = pcb->iss;
+  pcb->state = NET_TCP_SYN_SENT;
+
+  net_tcp_send(net, pcb, pcb->iss, 0, TCP_SYN);
+  return pcb;
+}
+
+int net_tcp_write(net_t *net, net_tcp_t *pcb, const gsm_tcp_tx_t *tx) {
+  if (!pcb->attached || pcb->fin_queued || pcb->wr_cnt >= NET_TCP_SNDQ ||
+      (pcb->state != NET_TCP_ESTABLISHED && pcb->state != NET_TCP_CLOSE_WAIT)) {
+    return -1;
+  }
+
+  net_tcp_wr_t *w = &pcb->wr[(pcb->wr_head + pcb->wr_cnt) % NET_TCP_SNDQ];
+
+  w->tx = *tx;
+  w->done = 0;
+  pcb->wr_cnt++;
+  pcb->snd_buf += tx->len;
+  net_tcp_output(net, pcb);
+  return 0;
+}
+
+void net_tcp_close(net_t *net, net_tcp_t *pcb) {
+  pcb->attached = false;
+  pcb->events = 0;
+  net_tcp_rxq_free(pcb);
+  pcb->rcv_held = 0;
+
+  switch (pcb->state) {
+  case NET_TCP_SYN_SENT:
+    pcb->state = NET_TCP_CLOSED;
+    break;
+  case NET_TCP_ESTABLISHED:
+    pcb->state = NET_TCP_FIN_WAIT_1;
+    pcb->fin_queued = true;
+    break;
+  case NET_TCP_CLOSE_WAIT:
+    pcb->state = NET_TCP_LAST_ACK;
+    pcb->fin_queued = true;
+    break;
+  default:
+    break;
+  }
+
+  net_tcp_output(net, pcb);
+  net_tcp_gc(pcb);
+}
+
+void net_tcp_abort(net_t *net, net_tcp_t *pcb) {
+  if (pcb->state != NET_TCP_CLOSED && pcb->state != NET_TCP_TIME_WAIT &&
+      pcb->state != NET_TCP_SYN_SENT) {
+    net_tcp_send(net, pcb, pcb->snd_nxt, 0, TCP_RST | TCP_ACK);
+  }
+
+  pcb->attached = false;
+  pcb->events = 0;
+  net_tcp_rxq_free(pcb);
+  pcb->rcv_held = 0;
+  pcb->state = NET_TCP_CLOSED;
+  pcb->err = NET_TCP_ERR_ABORT;
+  pcb->rto_ms = 0;
+  net_tcp_fail_writes(pcb);
+  net_tcp_gc(pcb);
+}
+
+uint8_t net_tcp_events(net_tcp_t *pcb) {
+  uint8_t ev = pcb->events;
+
+  pcb->events = 0;
+  return ev;
+}
+
+bool net_tcp_sent_pop(net_t *net, net_tcp_t *pcb, gsm_tcp_tx_t *out,
+                      bool *ok) {
+  (void)net;
+
+  if (!pcb->used || pcb->wr_acked == 0) {
+    return false;
+  }
+
+  net_tcp_wr_t *w = &pcb->wr[pcb->wr_head];
+
+  *out = w->tx;
+  *ok = w->done == 1;
+  pcb->wr_head = (uint8_t)((pcb->wr_head + 1) % NET_TCP_SNDQ);
+  pcb->wr_cnt--;
+  pcb->wr_acked--;
+  net_tcp_gc(pcb);
+  return true;
+}
+
+tcp_pbuf_t *net_tcp_pull(net_t *net, net_tcp_t *pcb) {
+  tcp_pbuf_t *p = pcb->rxq_head;
+
+  (void)net;
+
+  if (!p) {
+    return NULL;
+  }
+
+  pcb->rxq_head = p->next;
+  if (!pcb->rxq_head) {
+    pcb->rxq_tail = NULL;
+  }
+  p->next = NULL;
+  net_tcp_check_eof(pcb);
+  return p;
+}
+
+void net_tcp_recved(net_t *net, net_tcp_t *pcb, size_t len) {
+  uint32_t before = pcb->rcv_adv - pcb->rcv_nxt;
+
+  pcb->rcv_held = len < pcb->rcv_held ? pcb->rcv_held - (uint32_t)len : 0;
+
+  if (!pcb->attached || pcb->fin_rcvd ||
+      (pcb->state != NET_TCP_ESTABLISHED && pcb->state != NET_TCP_FIN_WAIT_1 &&
+       pcb->state != NET_TCP_FIN_WAIT_2)) {
+    return;
+  }
+
+  // 창이 MSS 나 절반 이상 넓어질 때만 갱신 ACK (작은 창 알림 방지)
+  uint32_t wnd = net_tcp_rcv_wnd(pcb);
+
+  if (wnd > before && wnd - before >= min32(pcb->mss, NET_TCP_WND / 2)) {
+    net_tcp_send_ack(net, pcb);
+  }
+}
+
+#endif
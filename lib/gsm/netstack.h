@@ -0,0 +1,272 @@
+#ifndef NETSTACK_H
+#define NETSTACK_H
+
+#include "gsm.h"
+#include "ppp.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief PPP 위 최소 IPv4 스택 (TCP 클라이언트 + DNS 조회)
+ *
+ * 우리가 여는 연결만 있다 (listen, IP 조각, 옵션, ICMP 없음). 받은 IP 프레임
+ * pbuf 는 헤더만 건너뛰어 그대로 소켓 수신 큐에 넣고 (작은 조각만 작은 등급으로
+ * 옮김), 송신은 pbuf 체인 구간을 ppp_seg_t 로 모아 HDLC 로 바로 감싼다.
+ *
+ * 수신 창은 NET_TCP_WND 에서 소켓이 아직 읽지 않은 바이트를 뺀 값이라 읽는
+ * 쪽이 늦으면 캐스터가 기다린다. 송신은 slow start/혼잡 회피, 중복 ACK 3 개
+ * 빠른 재전송, RFC 6298 RTO (Karn), 창 0 probe 를 한다.
+ *
+ * 모든 상태는 인스턴스에 있고 RTOS 를 쓰지 않는다. 호출자가 모든 함수를 한
+ * 잠금 안에서 부르고, 이벤트/송신 완료는 net_tcp_events, net_tcp_sent_pop 으로
+ * 잠금 밖에 넘긴다.
+ */
+#define NET_TCP_MSS (PPP_MRU - 40) ///< 우리가 받을 최대 세그먼트 (IP/TCP 헤더 40)
+#define NET_TCP_WND (4 * NET_TCP_MSS) ///< 수신 창 (large pbuf 4 개)
+#define NET_TCP_PCB_CNT (GSM_TCP_MAX_SOCKETS * 2) ///< 닫히는 연결이 혼자 마무리할 여유
+#define NET_TCP_SNDQ GSM_TCP_TX_QUEUE_DEPTH ///< 연결당 송신 대기 쓰기 수
+#define NET_TCP_SEG_MAX 8 ///< 세그먼트 하나에 모을 pbuf 구간 수
+#define NET_TCP_COPY_MAX GSM_TCP_PBUF_MID_SIZE ///< 이하 payload 는 작은 등급으로 복사
+
+#define NET_TCP_RTO_INIT_MS 3000
+#define NET_TCP_RTO_MIN_MS 500
+#define NET_TCP_RTO_MAX_MS 60000
+#define NET_TCP_SYN_RETRIES 4  ///< SYN 재전송 (3+6+12+24+48 초)
+#define NET_TCP_MAX_RETRIES 8  ///< 데이터/FIN 재전송
+#define NET_TCP_TIME_WAIT_MS 2000 ///< 짧은 TIME_WAIT (포트는 매번 새로 고름)
+
+#define NET_DNS_TIMEOUT_MS 2000
+#define NET_DNS_TRIES 2 ///< 서버마다 질의 수
+#define NET_DNS_HOST_MAX 64
+
+typedef enum {
+  NET_TCP_CLOSED = 0,
+  NET_TCP_SYN_SENT,
+  NET_TCP_ESTABLISHED,
+  NET_TCP_FIN_WAIT_1,
+  NET_TCP_FIN_WAIT_2,
+  NET_TCP_CLOSE_WAIT,
+  NET_TCP_CLOSING,
+  NET_TCP_LAST_ACK,
+  NET_TCP_TIME_WAIT,
+} net_tcp_state_t;
+
+// net_tcp_events 비트
+#define NET_TCP_EV_CONNECTED 0x01
+#define NET_TCP_EV_RECV 0x02 ///< 수신 큐에 데이터
+#define NET_TCP_EV_SENT 0x04 ///< 완료된 쓰기 (net_tcp_sent_pop)
+#define NET_TCP_EV_CLOSED 0x08 ///< 상대가 닫음 (수신 큐를 다 읽은 뒤), RST, 타임아웃
+
+typedef enum {
+  NET_TCP_ERR_NONE = 0, ///< FIN 으로 정상 종료
+  NET_TCP_ERR_RESET,    ///< RST
+  NET_TCP_ERR_TIMEOUT,  ///< 재전송 한도
+  NET_TCP_ERR_LINK,     ///< PPP 링크 끊김
+  NET_TCP_ERR_ABORT,    ///< net_tcp_abort
+} net_tcp_err_t;
+
+typedef struct {
+  gsm_tcp_tx_t tx;
+  uint8_t done; ///< 0: 대기, 1: ACK 받음, 2: 실패
+} net_tcp_wr_t;
+
+typedef struct {
+  net_tcp_state_t state;
+  bool used;
+  bool attached; ///< 소켓이 붙어 있음 (false: 닫은 뒤 혼자 마무리)
+  uint8_t cid;
+  uint8_t events;
+  net_tcp_err_t err;
+
+  uint32_t rip;
+  uint16_t rport;
+  uint16_t lport;
+
+  // 송신 (데이터는 snd_una 부터 snd_buf 바이트, FIN 은 그 다음 순번)
+  uint32_t iss;
+  uint32_t snd_una;
+  uint32_t snd_nxt;
+  uint32_t snd_max; ///< 보낸 적 있는 최대 순번 (RTO 뒤 다시 보내는 중 구분)
+  uint32_t snd_wnd;
+  uint32_t snd_wl1;
+  uint32_t snd_wl2;
+  uint32_t snd_buf; ///< ACK 받지 않은 데이터
+  uint16_t mss;     ///< 보낼 세그먼트 최대 (상대 MSS, PPP MRU)
+  uint32_t cwnd;
+  uint32_t ssthresh;
+  uint8_t dupacks;
+  bool fin_queued;
+  net_tcp_wr_t wr[NET_TCP_SNDQ];
+  uint8_t wr_head;
+  uint8_t wr_cnt;   ///< 완료를 가져가지 않은 쓰기 (완료된 것 포함)
+  uint8_t wr_acked; ///< 앞에서부터 완료된 쓰기
+  uint16_t wr_off;  ///< 완료되지 않은 첫 쓰기에서 ACK 받은 바이트
+
+  // 재전송 타이머
+  uint32_t rto;
+  uint32_t srtt;   ///< ms << 3
+  uint32_t rttvar; ///< ms << 2
+  uint32_t rto_ms; ///< 만료까지 (0: 꺼짐), 창 0 이면 probe 타이머
+  uint8_t retries;
+  bool rtt_on;
+  uint32_t rtt_seq;
+  uint32_t rtt_ms;
+
+  // 수신
+  uint32_t irs;
+  uint32_t rcv_nxt;
+  uint32_t rcv_adv;  ///< 알려 준 창 오른쪽 끝
+  uint32_t rcv_held; ///< 큐에 있거나 꺼냈지만 net_tcp_recved 전인 바이트
+  tcp_pbuf_t *rxq_head;
+  tcp_pbuf_t *rxq_tail;
+  bool fin_rcvd;
+  uint8_t ack_pend; ///< ACK 하지 않은 세그먼트 (net_flush 에서 보냄)
+  uint32_t wait_ms; ///< TIME_WAIT 남은 시간
+} net_tcp_t;
+
+typedef enum {
+  NET_DNS_IDLE = 0,
+  NET_DNS_BUSY,
+  NET_DNS_DONE,
+  NET_DNS_FAIL,
+} net_dns_state_t;
+
+typedef struct {
+  /// IP 데이터그램 하나 송신 (구간들을 이어서)
+  int (*output)(void *ctx, const ppp_seg_t *seg, size_t cnt);
+} net_ops_t;
+
+typedef struct {
+  uint32_t ip_rx;
+  uint32_t ip_tx;
+  uint32_t bad;      ///< 체크섬/길이 오류, 조각, 다른 주소
+  uint32_t no_pcb;   ///< 맞는 연결이 없어 RST 로 답한 세그먼트
+  uint32_t ooseq;    ///< 순서가 틀려 버린 세그먼트
+  uint32_t rexmit;   ///< 재전송한 세그먼트
+  uint32_t no_pbuf;  ///< 복사할 pbuf 가 없어 버린 세그먼트
+} net_stats_t;
+
+typedef struct {
+  const net_ops_t *ops;
+  void *ctx;
+  bool up;
+  uint32_t addr;   ///< 우리 주소 (a.b.c.d = a<<24 ...)
+  uint32_t dns_srv[2];
+  uint32_t rand;   ///< xorshift 상태 (ISN, 포트, DNS id)
+  uint16_t ip_id;
+  net_stats_t stats;
+  net_tcp_t pcb[NET_TCP_PCB_CNT];
+
+  struct {
+    net_dns_state_t state;
+    uint16_t id;
+    uint16_t port;
+    uint8_t srv;
+    uint8_t tries;
+    uint32_t timer_ms;
+    uint32_t addr; ///< 결과 (NET_DNS_DONE)
+    char host[NET_DNS_HOST_MAX];
+  } dns;
+} net_t;
+
+/**
+ * @brief 인스턴스 초기화
+ *
+ * @param seed 난수 시작값 (부팅마다 달라야 함)
+ */
+void net_init(net_t *net, const net_ops_t *ops, void *ctx, uint32_t seed);
+
+/**
+ * @brief 난수 상태에 값 섞기 (링크를 올릴 때 타이밍 값으로)
+ */
+void net_seed(net_t *net, uint32_t seed);
+
+/**
+ * @brief IPCP 로 주소를 받음
+ *
+ * @param dns 주/보조 DNS (0: 없음)
+ */
+void net_up(net_t *net, uint32_t addr, const uint32_t dns[2]);
+
+/**
+ * @brief 링크 끊김 - 모든 연결을 NET_TCP_ERR_LINK 로 닫고 DNS 실패
+ */
+void net_down(net_t *net);
+
+/**
+ * @brief 받은 IP 데이터그램 (pbuf 소유권을 가져감)
+ */
+void net_input(net_t *net, tcp_pbuf_t *p);
+
+/**
+ * @brief 입력 chunk 처리 뒤 미룬 ACK 송신
+ */
+void net_flush(net_t *net);
+
+/**
+ * @brief 재전송/TIME_WAIT/DNS 타이머
+ */
+void net_tick(net_t *net, uint32_t elapsed_ms);
+
+/**
+ * @brief A 레코드 조회 시작 (결과는 net->dns.state / addr)
+ *
+ * @return 0: 보냄, -1: 링크 없음, DNS 서버 없음, 조회 중 또는 이름이 김
+ */
+int net_dns_query(net_t *net, const char *host);
+
+/**
+ * @brief 연결 시작 (SYN)
+ *
+ * @param cid 소켓 ID (이벤트/완료 콜백에 넘김)
+ * @return 연결, NULL: 링크 없음 또는 빈 연결 없음
+ */
+net_tcp_t *net_tcp_connect(net_t *net, uint8_t cid, uint32_t ip,
+                           uint16_t port);
+
+/**
+ * @brief 쓰기 하나 대기열에 넣고 보낼 수 있는 만큼 송신
+ *
+ * @return 0: 넣음, -1: 연결 안 됨, 이미 닫는 중 또는 대기열 가득
+ */
+int net_tcp_write(net_t *net, net_tcp_t *pcb, const gsm_tcp_tx_t *tx);
+
+/**
+ * @brief 남은 데이터를 보낸 뒤 FIN (소켓에서 떼어 혼자 마무리)
+ *
+ * 수신 큐는 버리고, 남은 쓰기의 완료는 그대로 net_tcp_sent_pop 으로 나온다.
+ */
+void net_tcp_close(net_t *net, net_tcp_t *pcb);
+
+/**
+ * @brief RST 를 보내고 바로 닫음 (남은 쓰기는 실패로 완료)
+ */
+void net_tcp_abort(net_t *net, net_tcp_t *pcb);
+
+/**
+ * @brief 쌓인 이벤트 비트를 가져오고 지움
+ */
+uint8_t net_tcp_events(net_tcp_t *pcb);
+
+/**
+ * @brief 완료된 쓰기 하나 꺼내기 (순서대로)
+ *
+ * 떼어 낸 연결은 마지막 완료를 꺼낼 때 풀린다.
+ *
+ * @return true: out/ok 채움
+ */
+bool net_tcp_sent_pop(net_t *net, net_tcp_t *pcb, gsm_tcp_tx_t *out,
+                      bool *ok);
+
+/**
+ * @brief 수신 큐에서 pbuf 하나 꺼내기 (창은 net_tcp_recved 까지 닫혀 있음)
+ */
+tcp_pbuf_t *net_tcp_pull(net_t *net, net_tcp_t *pcb);
+
+/**
+ * @brief 꺼낸 바이트를 다 읽음 - 창을 열고 필요하면 창 갱신 ACK
+ */
+void net_tcp_recved(net_t *net, net_tcp_t *pcb, size_t len);
+
+#endif
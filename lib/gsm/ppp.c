@@ -0,0 +1,1019 @@
+#include "ppp.h"
+
+#if GSM_PPP_ENABLE
+
+#include <string.h>
+
+#ifndef TAG
+  #define TAG "PPP"
+#endif
+
+#include "log.h"
+
+// 수신 상태
+enum {
+  RX_HUNT = 0, ///< 여는 flag 찾기
+  RX_ADDR,     ///< FF 또는 (ACFC) protocol 첫 byte
+  RX_CTRL,
+  RX_PROTO,
+  RX_PROTO2,
+  RX_INFO,
+  RX_DROP,     ///< 이 프레임은 버림 (다음 flag 까지)
+};
+
+// LCP/IPCP code
+#define CP_CONF_REQ 1
+#define CP_CONF_ACK 2
+#define CP_CONF_NAK 3
+#define CP_CONF_REJ 4
+#define CP_TERM_REQ 5
+#define CP_TERM_ACK 6
+#define CP_CODE_REJ 7
+#define LCP_PROTO_REJ 8
+#define LCP_ECHO_REQ 9
+#define LCP_ECHO_REP 10
+#define LCP_DISCARD 11
+
+// LCP 옵션
+#define LCP_OPT_MRU 1
+#define LCP_OPT_ACCM 2
+#define LCP_OPT_AUTH 3
+#define LCP_OPT_MAGIC 5
+#define LCP_OPT_PFC 7
+#define LCP_OPT_ACFC 8
+
+// IPCP 옵션
+#define IPCP_OPT_ADDR 3
+#define IPCP_OPT_DNS1 129
+#define IPCP_OPT_DNS2 131
+
+// 우리 Configure-Request 에 넣을 옵션 (lcp_opts / ipcp_opts bit)
+#define REQ_MRU 0x01
+#define REQ_ACCM 0x02
+#define REQ_MAGIC 0x04
+#define REQ_ADDR 0x01
+#define REQ_DNS1 0x02
+#define REQ_DNS2 0x04
+
+#define PPP_FCS_INIT 0xFFFF
+#define PPP_FCS_GOOD 0xF0B8 // FCS 까지 넣고 계산한 나머지
+#define PPP_ACCM_ALL 0xFFFFFFFFu // LCP 는 협상과 상관없이 제어 문자를 모두 escape
+
+#define PAP_REQ 1
+#define PAP_ACK 2
+#define PAP_NAK 3
+
+// FCS-16 (x^16 + x^12 + x^5 + 1 반사) 4 bit 표
+static const uint16_t ppp_fcs_tab[16] = {
+    0x0000, 0x1081, 0x2102, 0x3183, 0x4204, 0x5285, 0x6306, 0x7387,
+    0x8408, 0x9489, 0xA50A, 0xB58B, 0xC60C, 0xD68D, 0xE70E, 0xF78F};
+
+static inline uint16_t ppp_fcs(uint16_t fcs, uint8_t b) {
+  fcs = (uint16_t)((fcs >> 4) ^ ppp_fcs_tab[(fcs ^ b) & 0x0F]);
+  return (uint16_t)((fcs >> 4) ^ ppp_fcs_tab[(fcs ^ (b >> 4)) & 0x0F]);
+}
+
+static inline uint16_t get16(const uint8_t *p) {
+  return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+static inline uint32_t get32(const uint8_t *p) {
+  return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+         ((uint32_t)p[2] << 8) | p[3];
+}
+
+static inline void put16(uint8_t *p, uint16_t v) {
+  p[0] = (uint8_t)(v >> 8);
+  p[1] = (uint8_t)v;
+}
+
+static inline void put32(uint8_t *p, uint32_t v) {
+  p[0] = (uint8_t)(v >> 24);
+  p[1] = (uint8_t)(v >> 16);
+  p[2] = (uint8_t)(v >> 8);
+  p[3] = (uint8_t)v;
+}
+
+/*
+ * 송신 (HDLC)
+ */
+
+static int ppp_tx_flush(ppp_t *ppp) {
+  int ret = 0;
+
+  if (ppp->tx_len) {
+    ret = ppp->ops->write(ppp->ctx, ppp->tx, ppp->tx_len);
+    ppp->tx_len = 0;
+  }
+  return ret;
+}
+
+static inline int ppp_tx_raw(ppp_t *ppp, uint8_t b) {
+  ppp->tx[ppp->tx_len++] = b;
+  return ppp->tx_len == sizeof(ppp->tx) ? ppp_tx_flush(ppp) : 0;
+}
+
+static int ppp_tx_byte(ppp_t *ppp, uint8_t b, uint32_t accm) {
+  int ret = 0;
+
+  ppp->tx_fcs = ppp_fcs(ppp->tx_fcs, b);
+  if (b == PPP_FLAG || b == PPP_ESC || (b < 0x20 && (accm & (1u << b)))) {
+    ret |= ppp_tx_raw(ppp, PPP_ESC);
+    b ^= 0x20;
+  }
+  return ret | ppp_tx_raw(ppp, b);
+}
+
+static int ppp_tx_bytes(ppp_t *ppp, const uint8_t *p, size_t len,
+                        uint32_t accm) {
+  int ret = 0;
+
+  while (len--) {
+    ret |= ppp_tx_byte(ppp, *p++, accm);
+  }
+  return ret;
+}
+
+/**
+ * @brief 프레임 하나 송신 (주소/제어, protocol, 구간들, FCS)
+ */
+static int ppp_send_frame(ppp_t *ppp, uint16_t proto, const ppp_seg_t *seg,
+                          size_t cnt, uint32_t accm) {
+  uint8_t hdr[4] = {0xFF, 0x03, (uint8_t)(proto >> 8), (uint8_t)proto};
+  int ret;
+
+  ppp->tx_fcs = PPP_FCS_INIT;
+  ppp->tx_len = 0;
+  ret = ppp_tx_raw(ppp, PPP_FLAG);
+  ret |= ppp_tx_bytes(ppp, hdr, sizeof(hdr), accm);
+  for (size_t i = 0; i < cnt; i++) {
+    ret |= ppp_tx_bytes(ppp, seg[i].data, seg[i].len, accm);
+  }
+
+  uint16_t fcs = (uint16_t)~ppp->tx_fcs;
+  ret |= ppp_tx_byte(ppp, (uint8_t)fcs, accm);
+  ret |= ppp_tx_byte(ppp, (uint8_t)(fcs >> 8), accm);
+  ret |= ppp_tx_raw(ppp, PPP_FLAG);
+  ret |= ppp_tx_flush(ppp);
+
+  if (ret == 0) {
+    ppp->stats.tx_frames++;
+  }
+  return ret ? -1 : 0;
+}
+
+/**
+ * @brief LCP/PAP/IPCP 패킷 송신 (code, id, length 헤더를 붙임)
+ */
+static int ppp_send_ctl(ppp_t *ppp, uint16_t proto, uint8_t code, uint8_t id,
+                        const uint8_t *data, size_t len) {
+  uint8_t hdr[4] = {code, id};
+  ppp_seg_t seg[2] = {{hdr, sizeof(hdr)}, {data, len}};
+
+  put16(&hdr[2], (uint16_t)(len + sizeof(hdr)));
+  return ppp_send_frame(ppp, proto, seg, len ? 2 : 1,
+                        proto == PPP_PROTO_LCP ? PPP_ACCM_ALL : ppp->peer_accm);
+}
+
+int ppp_output_ip(ppp_t *ppp, const ppp_seg_t *seg, size_t cnt) {
+  size_t len = 0;
+
+  if (ppp->phase != PPP_PHASE_RUNNING) {
+    return -1;
+  }
+  for (size_t i = 0; i < cnt; i++) {
+    len += seg[i].len;
+  }
+  if (len > ppp->peer_mru) {
+    return -1;
+  }
+  return ppp_send_frame(ppp, PPP_PROTO_IP, seg, cnt, ppp->peer_accm);
+}
+
+/*
+ * 링크 단계
+ */
+
+static void ppp_event(ppp_t *ppp, ppp_evt_t evt) {
+  if (ppp->ops->event) {
+    ppp->ops->event(ppp->ctx, evt);
+  }
+}
+
+/**
+ * @brief 링크 끝 (협상 실패, Terminate, echo 응답 없음)
+ */
+static void ppp_down(ppp_t *ppp, const char *why) {
+  if (ppp->phase == PPP_PHASE_DEAD) {
+    return;
+  }
+
+  LOG_WARN("PPP 링크 끊김: %s", why);
+  ppp_abort(ppp);
+  ppp_event(ppp, PPP_EVT_DOWN);
+}
+
+static ppp_fsm_t *ppp_fsm(ppp_t *ppp, uint16_t proto) {
+  return proto == PPP_PROTO_LCP ? &ppp->lcp : &ppp->ipcp;
+}
+
+static void ppp_send_conf_req(ppp_t *ppp, uint16_t proto) {
+  ppp_fsm_t *f = ppp_fsm(ppp, proto);
+  uint8_t opt[18];
+  size_t n = 0;
+
+  if (proto == PPP_PROTO_LCP) {
+    if (ppp->lcp_opts & REQ_MRU) {
+      opt[n++] = LCP_OPT_MRU;
+      opt[n++] = 4;
+      put16(&opt[n], PPP_MRU);
+      n += 2;
+    }
+    if (ppp->lcp_opts & REQ_ACCM) {
+      opt[n++] = LCP_OPT_ACCM;
+      opt[n++] = 6;
+      put32(&opt[n], 0);
+      n += 4;
+    }
+    if (ppp->lcp_opts & REQ_MAGIC) {
+      opt[n++] = LCP_OPT_MAGIC;
+      opt[n++] = 6;
+      put32(&opt[n], ppp->magic);
+      n += 4;
+    }
+  } else {
+    static const uint8_t type[3] = {IPCP_OPT_ADDR, IPCP_OPT_DNS1, IPCP_OPT_DNS2};
+    const uint32_t val[3] = {ppp->addr, ppp->dns[0], ppp->dns[1]};
+
+    for (uint8_t i = 0; i < 3; i++) {
+      if (ppp->ipcp_opts & (1u << i)) {
+        opt[n++] = type[i];
+        opt[n++] = 6;
+        put32(&opt[n], val[i]);
+        n += 4;
+      }
+    }
+  }
+
+  f->id = ppp->next_id++;
+  f->timer_ms = PPP_RESTART_MS;
+  ppp_send_ctl(ppp, proto, CP_CONF_REQ, f->id, opt, n);
+}
+
+static void ppp_fsm_open(ppp_t *ppp, uint16_t proto) {
+  ppp_fsm_t *f = ppp_fsm(ppp, proto);
+
+  f->state = PPP_FSM_REQ_SENT;
+  f->retries = PPP_MAX_CONFIGURE;
+  ppp_send_conf_req(ppp, proto);
+}
+
+static void ppp_send_pap(ppp_t *ppp) {
+  uint8_t buf[2 + 2 * 32];
+  size_t ulen = strnlen(ppp->user, 32);
+  size_t plen = strnlen(ppp->pass, 32);
+  size_t n = 0;
+
+  buf[n++] = (uint8_t)ulen;
+  memcpy(&buf[n], ppp->user, ulen);
+  n += ulen;
+  buf[n++] = (uint8_t)plen;
+  memcpy(&buf[n], ppp->pass, plen);
+  n += plen;
+
+  ppp->pap_id = ppp->next_id++;
+  ppp->pap_ms = PPP_RESTART_MS;
+  ppp_send_ctl(ppp, PPP_PROTO_PAP, PAP_REQ, ppp->pap_id, buf, n);
+}
+
+static void ppp_network_start(ppp_t *ppp) {
+  ppp->phase = PPP_PHASE_NETWORK;
+  ppp->ipcp_opts = REQ_ADDR | REQ_DNS1 | REQ_DNS2;
+  ppp->addr = 0;
+  ppp->dns[0] = 0;
+  ppp->dns[1] = 0;
+  ppp_fsm_open(ppp, PPP_PROTO_IPCP);
+}
+
+/**
+ * @brief LCP/IPCP 가 열림 (this-layer-up)
+ */
+static void ppp_layer_up(ppp_t *ppp, uint16_t proto) {
+  ppp_fsm(ppp, proto)->timer_ms = 0;
+
+  if (proto == PPP_PROTO_LCP) {
+    LOG_INFO("LCP 열림 (peer MRU %u%s)", ppp->peer_mru,
+             ppp->auth_pap ? ", PAP" : "");
+    if (ppp->auth_pap) {
+      ppp->phase = PPP_PHASE_AUTH;
+      ppp->pap_retries = PPP_MAX_CONFIGURE;
+      ppp_send_pap(ppp);
+    } else {
+      ppp_network_start(ppp);
+    }
+    return;
+  }
+
+  if (ppp->addr == 0) {
+    ppp_down(ppp, "IPCP 주소 없음");
+    return;
+  }
+
+  LOG_INFO("IPCP 열림: %lu.%lu.%lu.%lu, DNS %lu.%lu.%lu.%lu",
+           ppp->addr >> 24, (ppp->addr >> 16) & 0xFF, (ppp->addr >> 8) & 0xFF,
+           ppp->addr & 0xFF, ppp->dns[0] >> 24, (ppp->dns[0] >> 16) & 0xFF,
+           (ppp->dns[0] >> 8) & 0xFF, ppp->dns[0] & 0xFF);
+  ppp->phase = PPP_PHASE_RUNNING;
+  ppp->echo_pending = 0;
+  ppp->echo_ms = PPP_ECHO_INTERVAL_MS;
+  ppp_event(ppp, PPP_EVT_UP);
+}
+
+/*
+ * Configure-Request 처리
+ */
+
+/**
+ * @brief 모뎀 LCP 옵션 검사
+ *
+ * @return CP_CONF_ACK, CP_CONF_NAK (out 에 고친 값), CP_CONF_REJ (out 에 거절 옵션)
+ */
+static uint8_t ppp_lcp_check(ppp_t *ppp, const uint8_t *opt, size_t len,
+                             uint8_t *out, size_t *out_len, bool apply) {
+  uint8_t code = CP_CONF_ACK;
+  size_t n = 0;
+
+  while (len >= 2) {
+    uint8_t type = opt[0];
+    uint8_t olen = opt[1];
+
+    if (olen < 2 || olen > len) {
+      break;
+    }
+
+    bool ok = false;
+
+    switch (type) {
+    case LCP_OPT_MRU:
+      ok = olen == 4;
+      if (ok && apply) {
+        ppp->peer_mru = get16(&opt[2]);
+      }
+      break;
+    case LCP_OPT_ACCM:
+      ok = olen == 6;
+      if (ok && apply) {
+        ppp->peer_accm = get32(&opt[2]);
+      }
+      break;
+    case LCP_OPT_AUTH:
+      if (olen >= 4 && get16(&opt[2]) == PPP_PROTO_PAP) {
+        ok = true;
+        if (apply) {
+          ppp->auth_pap = true;
+        }
+      } else if (olen >= 4 && code != CP_CONF_REJ) {
+        // CHAP 등은 PAP 로 바꿔 달라고 한다
+        if (code == CP_CONF_ACK) {
+          n = 0;
+        }
+        code = CP_CONF_NAK;
+        out[n++] = LCP_OPT_AUTH;
+        out[n++] = 4;
+        put16(&out[n], PPP_PROTO_PAP);
+        n += 2;
+        ok = true; // 거절은 아님
+      }
+      break;
+    case LCP_OPT_MAGIC:
+      ok = olen == 6;
+      break;
+    case LCP_OPT_PFC:
+    case LCP_OPT_ACFC:
+      // 모뎀이 압축 프레임을 받을 수 있다는 뜻 (우리는 압축하지 않고 보냄)
+      ok = olen == 2;
+      break;
+    default:
+      break;
+    }
+
+    if (!ok) {
+      if (code != CP_CONF_REJ) {
+        code = CP_CONF_REJ;
+        n = 0;
+      }
+      if (n + olen <= PPP_CTL_MAX) {
+        memcpy(&out[n], opt, olen);
+        n += olen;
+      }
+    }
+
+    opt += olen;
+    len -= olen;
+  }
+
+  *out_len = n;
+  return code;
+}
+
+static uint8_t ppp_ipcp_check(ppp_t *ppp, const uint8_t *opt, size_t len,
+                              uint8_t *out, size_t *out_len, bool apply) {
+  uint8_t code = CP_CONF_ACK;
+  size_t n = 0;
+
+  while (len >= 2) {
+    uint8_t olen = opt[1];
+
+    if (olen < 2 || olen > len) {
+      break;
+    }
+
+    if (opt[0] == IPCP_OPT_ADDR && olen == 6) {
+      if (apply) {
+        ppp->peer = get32(&opt[2]);
+      }
+    } else {
+      // 헤더 압축 등은 쓰지 않는다
+      if (code != CP_CONF_REJ) {
+        code = CP_CONF_REJ;
+        n = 0;
+      }
+      if (n + olen <= PPP_CTL_MAX) {
+        memcpy(&out[n], opt, olen);
+        n += olen;
+      }
+    }
+
+    opt += olen;
+    len -= olen;
+  }
+
+  *out_len = n;
+  return code;
+}
+
+static void ppp_rcv_conf_req(ppp_t *ppp, uint16_t proto, uint8_t id,
+                             const uint8_t *opt, size_t len) {
+  ppp_fsm_t *f = ppp_fsm(ppp, proto);
+  uint8_t out[PPP_CTL_MAX];
+  size_t n;
+  uint8_t code;
+
+  if (f->state == PPP_FSM_CLOSED || f->state == PPP_FSM_CLOSING) {
+    return;
+  }
+
+  if (proto == PPP_PROTO_LCP) {
+    code = ppp_lcp_check(ppp, opt, len, out, &n, false);
+    if (code == CP_CONF_ACK) {
+      ppp_lcp_check(ppp, opt, len, out, &n, true);
+    }
+  } else {
+    code = ppp_ipcp_check(ppp, opt, len, out, &n, false);
+    if (code == CP_CONF_ACK) {
+      ppp_ipcp_check(ppp, opt, len, out, &n, true);
+    }
+  }
+
+  if (f->state == PPP_FSM_OPENED) {
+    // 재협상은 하지 않는다: 링크를 내리고 다시 다이얼한다
+    ppp_down(ppp, proto == PPP_PROTO_LCP ? "LCP 재협상" : "IPCP 재협상");
+    return;
+  }
+
+  if (code == CP_CONF_ACK) {
+    ppp_send_ctl(ppp, proto, CP_CONF_ACK, id, opt, len);
+    if (f->state == PPP_FSM_ACK_RCVD) {
+      f->state = PPP_FSM_OPENED;
+      ppp_layer_up(ppp, proto);
+    } else {
+      f->state = PPP_FSM_ACK_SENT;
+    }
+  } else {
+    ppp_send_ctl(ppp, proto, code, id, out, n);
+    if (f->state == PPP_FSM_ACK_SENT) {
+      f->state = PPP_FSM_REQ_SENT;
+    }
+  }
+}
+
+static void ppp_rcv_conf_ack(ppp_t *ppp, uint16_t proto, uint8_t id) {
+  ppp_fsm_t *f = ppp_fsm(ppp, proto);
+
+  if (id != f->id) {
+    return;
+  }
+
+  switch (f->state) {
+  case PPP_FSM_REQ_SENT:
+    f->state = PPP_FSM_ACK_RCVD;
+    f->retries = PPP_MAX_CONFIGURE;
+    break;
+  case PPP_FSM_ACK_SENT:
+    f->state = PPP_FSM_OPENED;
+    ppp_layer_up(ppp, proto);
+    break;
+  case PPP_FSM_ACK_RCVD:
+    // 같은 요청에 ACK 가 두 번: 다시 협상
+    f->state = PPP_FSM_REQ_SENT;
+    ppp_send_conf_req(ppp, proto);
+    break;
+  case PPP_FSM_OPENED:
+    ppp_down(ppp, "열린 뒤 Configure-Ack");
+    break;
+  default:
+    break;
+  }
+}
+
+/**
+ * @brief 우리 요청에 대한 Nak/Reject 반영
+ */
+static void ppp_rcv_conf_nak(ppp_t *ppp, uint16_t proto, uint8_t code,
+                             uint8_t id, const uint8_t *opt, size_t len) {
+  ppp_fsm_t *f = ppp_fsm(ppp, proto);
+  bool rej = code == CP_CONF_REJ;
+
+  if (id != f->id) {
+    return;
+  }
+
+  while (len >= 2) {
+    uint8_t type = opt[0];
+    uint8_t olen = opt[1];
+
+    if (olen < 2 || olen > len) {
+      break;
+    }
+
+    if (proto == PPP_PROTO_LCP) {
+      if (type == LCP_OPT_MRU) {
+        // 빼도 TCP MSS 가 세그먼트를 PPP_MRU 안으로 막는다
+        ppp->lcp_opts &= (uint8_t)~REQ_MRU;
+      } else if (type == LCP_OPT_ACCM) {
+        // 모뎀이 더 escape 해서 보내도 받는 쪽은 모두 풀어낸다
+        ppp->lcp_opts &= (uint8_t)~REQ_ACCM;
+      } else if (type == LCP_OPT_MAGIC) {
+        if (rej) {
+          ppp->lcp_opts &= (uint8_t)~REQ_MAGIC;
+        } else {
+          ppp->magic = ppp->magic * 1103515245u + 12345u;
+        }
+      }
+    } else if (olen == 6) {
+      uint32_t val = get32(&opt[2]);
+      uint8_t bit = type == IPCP_OPT_ADDR   ? REQ_ADDR
+                    : type == IPCP_OPT_DNS1 ? REQ_DNS1
+                    : type == IPCP_OPT_DNS2 ? REQ_DNS2
+                                            : 0;
+
+      if (rej) {
+        ppp->ipcp_opts &= (uint8_t)~bit;
+      } else if (bit == REQ_ADDR) {
+        ppp->addr = val;
+      } else if (bit == REQ_DNS1) {
+        ppp->dns[0] = val;
+      } else if (bit == REQ_DNS2) {
+        ppp->dns[1] = val;
+      }
+    }
+
+    opt += olen;
+    len -= olen;
+  }
+
+  switch (f->state) {
+  case PPP_FSM_REQ_SENT:
+  case PPP_FSM_ACK_SENT:
+    f->retries = PPP_MAX_CONFIGURE;
+    ppp_send_conf_req(ppp, proto);
+    break;
+  case PPP_FSM_ACK_RCVD:
+    f->state = PPP_FSM_REQ_SENT;
+    ppp_send_conf_req(ppp, proto);
+    break;
+  case PPP_FSM_OPENED:
+    ppp_down(ppp, "열린 뒤 Configure-Nak");
+    break;
+  default:
+    break;
+  }
+}
+
+/**
+ * @brief LCP/IPCP 패킷
+ */
+static void ppp_rcv_cp(ppp_t *ppp, uint16_t proto, const uint8_t *p,
+                       size_t len) {
+  ppp_fsm_t *f = ppp_fsm(ppp, proto);
+
+  if (len < 4 || get16(&p[2]) < 4 || get16(&p[2]) > len) {
+    return;
+  }
+
+  uint8_t code = p[0];
+  uint8_t id = p[1];
+  const uint8_t *data = &p[4];
+  size_t dlen = (size_t)get16(&p[2]) - 4;
+
+  switch (code) {
+  case CP_CONF_REQ:
+    ppp_rcv_conf_req(ppp, proto, id, data, dlen);
+    break;
+  case CP_CONF_ACK:
+    ppp_rcv_conf_ack(ppp, proto, id);
+    break;
+  case CP_CONF_NAK:
+  case CP_CONF_REJ:
+    ppp_rcv_conf_nak(ppp, proto, code, id, data, dlen);
+    break;
+  case CP_TERM_REQ:
+    ppp_send_ctl(ppp, proto, CP_TERM_ACK, id, NULL, 0);
+    ppp_down(ppp, proto == PPP_PROTO_LCP ? "LCP Terminate" : "IPCP Terminate");
+    break;
+  case CP_TERM_ACK:
+    if (f->state == PPP_FSM_CLOSING) {
+      ppp_down(ppp, "ppp_close");
+    }
+    break;
+  case LCP_PROTO_REJ:
+    if (proto == PPP_PROTO_LCP && dlen >= 2 &&
+        get16(data) == PPP_PROTO_IPCP) {
+      ppp_down(ppp, "IPCP 거절");
+    }
+    break;
+  case LCP_ECHO_REQ:
+    if (proto == PPP_PROTO_LCP && f->state == PPP_FSM_OPENED && dlen >= 4) {
+      uint8_t rep[PPP_CTL_MAX];
+
+      put32(rep, ppp->magic);
+      memcpy(&rep[4], &data[4], dlen - 4);
+      ppp_send_ctl(ppp, PPP_PROTO_LCP, LCP_ECHO_REP, id, rep, dlen);
+    }
+    break;
+  case LCP_ECHO_REP:
+    ppp->echo_pending = 0;
+    break;
+  default:
+    // Code-Reject, Discard-Request 등
+    break;
+  }
+}
+
+static void ppp_rcv_pap(ppp_t *ppp, const uint8_t *p, size_t len) {
+  if (ppp->phase != PPP_PHASE_AUTH || len < 4 || p[1] != ppp->pap_id) {
+    return;
+  }
+
+  if (p[0] == PAP_ACK) {
+    LOG_INFO("PAP 인증 완료");
+    ppp->pap_ms = 0;
+    ppp_network_start(ppp);
+  } else if (p[0] == PAP_NAK) {
+    ppp_down(ppp, "PAP 거절");
+  }
+}
+
+static void ppp_send_proto_rej(ppp_t *ppp, uint16_t proto, const uint8_t *p,
+                               size_t len) {
+  uint8_t buf[PPP_CTL_MAX];
+
+  if (len > sizeof(buf) - 2) {
+    len = sizeof(buf) - 2;
+  }
+  put16(buf, proto);
+  memcpy(&buf[2], p, len);
+  ppp->stats.proto_rej++;
+  ppp_send_ctl(ppp, PPP_PROTO_LCP, LCP_PROTO_REJ, ppp->next_id++, buf, len + 2);
+}
+
+/**
+ * @brief FCS 가 맞은 제어 프레임
+ */
+static void ppp_rcv_ctl(ppp_t *ppp, uint16_t proto, const uint8_t *p,
+                        size_t len) {
+  bool lcp_open = ppp->lcp.state == PPP_FSM_OPENED;
+
+  switch (proto) {
+  case PPP_PROTO_LCP:
+    ppp_rcv_cp(ppp, proto, p, len);
+    break;
+  case PPP_PROTO_PAP:
+    ppp_rcv_pap(ppp, p, len);
+    break;
+  case PPP_PROTO_IPCP:
+    // LCP 가 열리기 전의 NCP 패킷은 조용히 버린다
+    if (lcp_open && ppp->phase >= PPP_PHASE_NETWORK) {
+      ppp_rcv_cp(ppp, proto, p, len);
+    }
+    break;
+  default:
+    // IPv6CP, CCP 등 (IP 는 RUNNING 전이면 버린다)
+    if (lcp_open && proto != PPP_PROTO_IP) {
+      ppp_send_proto_rej(ppp, proto, p, len);
+    }
+    break;
+  }
+}
+
+/*
+ * 수신 (HDLC)
+ */
+
+/**
+ * @brief 닫는 flag: FCS 확인 후 넘기기
+ */
+static void ppp_rx_end(ppp_t *ppp) {
+  tcp_pbuf_t *p = ppp->rx_p;
+
+  ppp->rx_p = NULL;
+
+  if (ppp->rx_state == RX_INFO && ppp->rx_len >= 2) {
+    if (ppp->rx_fcs != PPP_FCS_GOOD) {
+      ppp->stats.fcs_err++;
+    } else {
+      size_t len = (size_t)ppp->rx_len - 2;
+
+      ppp->stats.rx_frames++;
+      // 받는 게 있으면 링크는 살아 있다 (echo 는 조용할 때만)
+      ppp->echo_pending = 0;
+      ppp->echo_ms = PPP_ECHO_INTERVAL_MS;
+
+      if (p) {
+        p->len = len;
+        p->tot_len = len;
+        ppp->ops->input(ppp->ctx, p);
+        p = NULL;
+      } else {
+        ppp_rcv_ctl(ppp, ppp->rx_proto, ppp->rx_ctl, len);
+      }
+    }
+  } else if (ppp->rx_state > RX_ADDR && ppp->rx_state != RX_DROP) {
+    ppp->stats.fcs_err++;
+  }
+
+  tcp_pbuf_free(p);
+  ppp->rx_state = RX_ADDR;
+  ppp->rx_fcs = PPP_FCS_INIT;
+  ppp->rx_len = 0;
+}
+
+/**
+ * @brief escape 를 푼 프레임 byte 하나
+ */
+static void ppp_rx_byte(ppp_t *ppp, uint8_t b) {
+  ppp->rx_fcs = ppp_fcs(ppp->rx_fcs, b);
+
+  switch (ppp->rx_state) {
+  case RX_ADDR:
+    if (b == 0xFF) {
+      ppp->rx_state = RX_CTRL;
+      return;
+    }
+    // 주소/제어 압축 (ACFC)
+    ppp->rx_state = RX_PROTO;
+    // fall through
+  case RX_PROTO:
+    if (b & 0x01) {
+      // protocol 압축 (PFC): 한 byte
+      ppp->rx_proto = b;
+      ppp->rx_state = RX_INFO;
+    } else {
+      ppp->rx_proto = (uint16_t)(b << 8);
+      ppp->rx_state = RX_PROTO2;
+    }
+    break;
+  case RX_CTRL:
+    ppp->rx_state = b == 0x03 ? RX_PROTO : RX_DROP;
+    return;
+  case RX_PROTO2:
+    ppp->rx_proto |= b;
+    ppp->rx_state = RX_INFO;
+    break;
+  case RX_INFO:
+    if (ppp->rx_p) {
+      if (ppp->rx_len >= PPP_MRU + 2) {
+        ppp->stats.too_long++;
+        tcp_pbuf_free(ppp->rx_p);
+        ppp->rx_p = NULL;
+        ppp->rx_state = RX_DROP;
+        return;
+      }
+      ppp->rx_p->payload[ppp->rx_len++] = b;
+    } else {
+      if (ppp->rx_len >= sizeof(ppp->rx_ctl)) {
+        ppp->stats.too_long++;
+        ppp->rx_state = RX_DROP;
+        return;
+      }
+      ppp->rx_ctl[ppp->rx_len++] = b;
+    }
+    return;
+  default:
+    return;
+  }
+
+  if (ppp->rx_state == RX_INFO && ppp->rx_proto == PPP_PROTO_IP) {
+    if (ppp->phase != PPP_PHASE_RUNNING) {
+      ppp->rx_state = RX_DROP;
+      return;
+    }
+    // IP 데이터그램은 풀 블록에 바로 푼다 (FCS 2 byte 포함)
+    ppp->rx_p = tcp_pbuf_alloc(GSM_TCP_PBUF_LARGE_SIZE);
+    if (!ppp->rx_p) {
+      ppp->stats.no_pbuf++;
+      ppp->rx_state = RX_DROP;
+    }
+  }
+}
+
+void ppp_input(ppp_t *ppp, const uint8_t *data, size_t len) {
+  if (ppp->phase == PPP_PHASE_DEAD) {
+    return;
+  }
+
+  for (size_t i = 0; i < len; i++) {
+    uint8_t b = data[i];
+
+    if (b == PPP_FLAG) {
+      if (ppp->rx_state != RX_HUNT && !ppp->rx_esc) {
+        ppp_rx_end(ppp);
+      } else {
+        // 7D 7E 는 프레임 중단
+        tcp_pbuf_free(ppp->rx_p);
+        ppp->rx_p = NULL;
+        ppp->rx_state = RX_ADDR;
+        ppp->rx_fcs = PPP_FCS_INIT;
+        ppp->rx_len = 0;
+      }
+      ppp->rx_esc = false;
+      continue;
+    }
+
+    if (ppp->rx_state == RX_HUNT || ppp->rx_state == RX_DROP) {
+      continue;
+    }
+    if (b == PPP_ESC) {
+      ppp->rx_esc = true;
+      continue;
+    }
+    if (ppp->rx_esc) {
+      ppp->rx_esc = false;
+      b ^= 0x20;
+    } else if (b < 0x20) {
+      // ACCM 0 을 요청했지만 모뎀이 넣은 제어 문자는 버린다 (XON/XOFF 등)
+      if (ppp->lcp.state != PPP_FSM_OPENED || (ppp->lcp_opts & REQ_ACCM) == 0) {
+        continue;
+      }
+    }
+    ppp_rx_byte(ppp, b);
+  }
+}
+
+/*
+ * 공개 API
+ */
+
+void ppp_init(ppp_t *ppp, const ppp_ops_t *ops, void *ctx, const char *user,
+              const char *pass) {
+  memset(ppp, 0, sizeof(*ppp));
+  ppp->ops = ops;
+  ppp->ctx = ctx;
+  ppp->user = user ? user : "";
+  ppp->pass = pass ? pass : "";
+  ppp->phase = PPP_PHASE_DEAD;
+}
+
+void ppp_start(ppp_t *ppp, uint32_t magic) {
+  tcp_pbuf_free(ppp->rx_p);
+  ppp->rx_p = NULL;
+  ppp->rx_state = RX_HUNT;
+  ppp->rx_esc = false;
+
+  ppp->phase = PPP_PHASE_ESTABLISH;
+  ppp->magic = magic ? magic : 0x5A5A0001u;
+  ppp->peer_accm = PPP_ACCM_ALL;
+  ppp->peer_mru = 1500;
+  ppp->lcp_opts = REQ_MRU | REQ_ACCM | REQ_MAGIC;
+  ppp->auth_pap = false;
+  ppp->ipcp.state = PPP_FSM_CLOSED;
+  ppp->ipcp.timer_ms = 0;
+  ppp->pap_ms = 0;
+  ppp->echo_ms = 0;
+
+  LOG_INFO("PPP 시작 (LCP)");
+  ppp_fsm_open(ppp, PPP_PROTO_LCP);
+}
+
+void ppp_close(ppp_t *ppp) {
+  if (ppp->phase == PPP_PHASE_DEAD || ppp->phase == PPP_PHASE_TERMINATE) {
+    return;
+  }
+
+  ppp->phase = PPP_PHASE_TERMINATE;
+  ppp->ipcp.state = PPP_FSM_CLOSED;
+  ppp->ipcp.timer_ms = 0;
+  ppp->pap_ms = 0;
+  ppp->echo_ms = 0;
+  ppp->lcp.state = PPP_FSM_CLOSING;
+  ppp->lcp.retries = PPP_MAX_TERMINATE;
+  ppp->lcp.id = ppp->next_id++;
+  ppp->lcp.timer_ms = PPP_RESTART_MS;
+  ppp_send_ctl(ppp, PPP_PROTO_LCP, CP_TERM_REQ, ppp->lcp.id, NULL, 0);
+}
+
+void ppp_abort(ppp_t *ppp) {
+  tcp_pbuf_free(ppp->rx_p);
+  ppp->rx_p = NULL;
+  ppp->rx_state = RX_HUNT;
+  ppp->phase = PPP_PHASE_DEAD;
+  ppp->lcp.state = PPP_FSM_CLOSED;
+  ppp->lcp.timer_ms = 0;
+  ppp->ipcp.state = PPP_FSM_CLOSED;
+  ppp->ipcp.timer_ms = 0;
+  ppp->pap_ms = 0;
+  ppp->echo_ms = 0;
+}
+
+/**
+ * @brief 재전송 타이머 만료 (TO+ / TO-)
+ */
+static void ppp_fsm_timeout(ppp_t *ppp, uint16_t proto) {
+  ppp_fsm_t *f = ppp_fsm(ppp, proto);
+
+  if (f->retries == 0) {
+    ppp_down(ppp, f->state == PPP_FSM_CLOSING
+                      ? "ppp_close"
+                      : (proto == PPP_PROTO_LCP ? "LCP 응답 없음"
+                                                : "IPCP 응답 없음"));
+    return;
+  }
+  f->retries--;
+
+  if (f->state == PPP_FSM_CLOSING) {
+    f->id = ppp->next_id++;
+    f->timer_ms = PPP_RESTART_MS;
+    ppp_send_ctl(ppp, PPP_PROTO_LCP, CP_TERM_REQ, f->id, NULL, 0);
+    return;
+  }
+  if (f->state == PPP_FSM_ACK_RCVD) {
+    f->state = PPP_FSM_REQ_SENT;
+  }
+  ppp_send_conf_req(ppp, proto);
+}
+
+/**
+ * @brief 남은 시간 줄이기
+ *
+ * @return true: 만료
+ */
+static bool ppp_timer(uint32_t *ms, uint32_t elapsed_ms) {
+  if (*ms == 0) {
+    return false;
+  }
+  if (*ms > elapsed_ms) {
+    *ms -= elapsed_ms;
+    return false;
+  }
+  *ms = 0;
+  return true;
+}
+
+void ppp_tick(ppp_t *ppp, uint32_t elapsed_ms) {
+  if (ppp->phase == PPP_PHASE_DEAD) {
+    return;
+  }
+
+  if (ppp_timer(&ppp->lcp.timer_ms, elapsed_ms)) {
+    ppp_fsm_timeout(ppp, PPP_PROTO_LCP);
+  }
+  if (ppp_timer(&ppp->ipcp.timer_ms, elapsed_ms)) {
+    ppp_fsm_timeout(ppp, PPP_PROTO_IPCP);
+  }
+  if (ppp_timer(&ppp->pap_ms, elapsed_ms)) {
+    if (ppp->pap_retries-- == 0) {
+      ppp_down(ppp, "PAP 응답 없음");
+    } else {
+      ppp_send_pap(ppp);
+    }
+  }
+  if (ppp_timer(&ppp->echo_ms, elapsed_ms) &&
+      ppp->phase == PPP_PHASE_RUNNING) {
+    if (ppp->echo_pending >= PPP_ECHO_FAILS) {
+      ppp_down(ppp, "LCP echo 응답 없음");
+      return;
+    }
+
+    uint8_t magic[4];
+
+    put32(magic, ppp->magic);
+    ppp->echo_pending++;
+    ppp->echo_ms = PPP_ECHO_INTERVAL_MS;
+    ppp_send_ctl(ppp, PPP_PROTO_LCP, LCP_ECHO_REQ, ppp->echo_id++, magic,
+                 sizeof(magic));
+  }
+}
+
+bool ppp_is_up(const ppp_t *ppp) { return ppp->phase == PPP_PHASE_RUNNING; }
+
+#endif
@@ -0,0 +1,193 @@
+#ifndef PPP_H
+#define PPP_H
+
+#include "gsm.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief PPP (RFC 1661/1662) 링크 - 모뎀 데이터 채널 위 IPv4 전송
+ *
+ * 프레임: 7E | FF 03 | protocol | info | FCS-16 | 7E (0x7D escape)
+ *
+ * 우리가 먼저 LCP Configure-Request 를 보내고 (MRU, ACCM 0, magic), 모뎀이
+ * 인증을 요구하면 PAP 로 답한 뒤 IPCP 로 주소와 DNS 를 받는다. 받는 쪽은
+ * 주소/제어 필드, protocol 필드 압축을 모두 받아 주지만 보낼 때는 압축하지
+ * 않는다. IP 데이터그램은 풀에서 꺼낸 pbuf 에 바로 풀어 넘긴다 (복사 없음).
+ *
+ * 모든 상태는 인스턴스에 있고 RTOS 를 쓰지 않는다. 호출자가 ppp_input,
+ * ppp_tick, 송신 함수를 한 잠금 안에서 부른다.
+ */
+#define PPP_FLAG 0x7E
+#define PPP_ESC 0x7D
+/// 받을 info 최대 길이 (FCS 2 byte 까지 pbuf large 블록 하나에 들어간다)
+#define PPP_MRU (GSM_TCP_PBUF_LARGE_SIZE - 2)
+#define PPP_CTL_MAX 128 ///< LCP/PAP/IPCP 패킷 수신 버퍼 (넘으면 버림)
+#define PPP_TX_CHUNK GSM_CMUX_N1 ///< escape 한 송신 바이트를 모아 ops->write 하는 단위 (UIH 하나)
+
+#define PPP_PROTO_IP 0x0021
+#define PPP_PROTO_LCP 0xC021
+#define PPP_PROTO_PAP 0xC023
+#define PPP_PROTO_CHAP 0xC223
+#define PPP_PROTO_IPCP 0x8021
+
+#define PPP_RESTART_MS 3000   ///< Configure/Terminate-Request 재전송 간격
+#define PPP_MAX_CONFIGURE 10  ///< Configure-Request 최대 재전송
+#define PPP_MAX_TERMINATE 2   ///< Terminate-Request 최대 재전송
+#define PPP_ECHO_INTERVAL_MS 10000 ///< LCP Echo-Request 주기 (링크 살아 있는지)
+#define PPP_ECHO_FAILS 3      ///< 연속으로 답이 없으면 링크 끊김
+
+typedef enum {
+  PPP_PHASE_DEAD = 0,  ///< 데이터 채널 없음
+  PPP_PHASE_ESTABLISH, ///< LCP 협상
+  PPP_PHASE_AUTH,      ///< PAP
+  PPP_PHASE_NETWORK,   ///< IPCP 협상
+  PPP_PHASE_RUNNING,   ///< IP 송수신 가능
+  PPP_PHASE_TERMINATE, ///< Terminate-Request 보냄
+} ppp_phase_t;
+
+typedef enum {
+  PPP_EVT_UP = 0, ///< IPCP 열림 (주소 확정)
+  PPP_EVT_DOWN,   ///< 협상 실패, Terminate, echo 응답 없음 또는 ppp_close 완료
+} ppp_evt_t;
+
+/**
+ * @brief LCP/IPCP 상태 (RFC 1661 automaton 에서 능동 open 쪽만)
+ */
+typedef enum {
+  PPP_FSM_CLOSED = 0,
+  PPP_FSM_REQ_SENT,
+  PPP_FSM_ACK_RCVD,
+  PPP_FSM_ACK_SENT,
+  PPP_FSM_OPENED,
+  PPP_FSM_CLOSING,
+} ppp_fsm_state_t;
+
+typedef struct {
+  ppp_fsm_state_t state;
+  uint8_t id;       ///< 마지막으로 보낸 Configure/Terminate-Request id
+  uint8_t retries;  ///< 남은 재전송
+  uint32_t timer_ms; ///< 재전송까지 남은 시간 (0: 꺼짐)
+} ppp_fsm_t;
+
+typedef struct {
+  const void *data;
+  size_t len;
+} ppp_seg_t;
+
+typedef struct {
+  /// HDLC 로 감싼 바이트 송신 (한 프레임이 여러 번에 나뉘어 온다)
+  int (*write)(void *ctx, const void *data, size_t len);
+  /// 받은 IP 데이터그램 (pbuf 소유권을 넘김)
+  void (*input)(void *ctx, tcp_pbuf_t *p);
+  void (*event)(void *ctx, ppp_evt_t evt);
+} ppp_ops_t;
+
+typedef struct {
+  uint32_t rx_frames;  ///< FCS 가 맞은 프레임
+  uint32_t tx_frames;
+  uint32_t fcs_err;    ///< FCS 불일치로 버린 프레임
+  uint32_t too_long;   ///< MRU/PPP_CTL_MAX 를 넘어 버린 프레임
+  uint32_t no_pbuf;    ///< pbuf 풀이 비어 버린 IP 프레임
+  uint32_t proto_rej;  ///< 모르는 protocol 로 Protocol-Reject 보낸 수
+} ppp_stats_t;
+
+typedef struct {
+  const ppp_ops_t *ops;
+  void *ctx;
+  ppp_phase_t phase;
+  ppp_stats_t stats;
+
+  // LCP
+  ppp_fsm_t lcp;
+  uint32_t magic;     ///< 우리 magic number
+  uint32_t peer_accm; ///< 모뎀이 받고 싶은 ACCM (송신 escape)
+  uint16_t peer_mru;  ///< 모뎀이 받을 수 있는 최대 info
+  uint8_t lcp_opts;   ///< 보낼 옵션 (거절된 것은 뺌)
+  bool auth_pap;      ///< 모뎀이 PAP 를 요구함
+  uint8_t echo_id;
+  uint8_t echo_pending; ///< 답이 없는 Echo-Request 수
+  uint32_t echo_ms;     ///< 다음 Echo-Request 까지
+
+  // PAP
+  const char *user;
+  const char *pass;
+  uint8_t pap_id;
+  uint8_t pap_retries;
+  uint32_t pap_ms;
+
+  // IPCP
+  ppp_fsm_t ipcp;
+  uint8_t ipcp_opts;
+  uint32_t addr;    ///< 우리 IPv4 (network order 아님, a.b.c.d = a<<24 ...)
+  uint32_t peer;    ///< 모뎀 쪽 주소
+  uint32_t dns[2];  ///< 주/보조 DNS (0: 받지 못함)
+  uint8_t next_id;
+
+  // 수신 상태 (ppp_input 만 씀)
+  uint8_t rx_state;
+  bool rx_esc;
+  uint16_t rx_fcs;
+  uint16_t rx_proto;
+  uint16_t rx_len;   ///< info + FCS 바이트
+  tcp_pbuf_t *rx_p;  ///< IP 프레임이면 여기에 바로 쓴다
+  uint8_t rx_ctl[PPP_CTL_MAX + 2];
+
+  // 송신 (ppp_output_* 안에서만)
+  uint16_t tx_fcs;
+  size_t tx_len;
+  uint8_t tx[PPP_TX_CHUNK];
+} ppp_t;
+
+/**
+ * @brief 인스턴스 초기화 (링크는 ppp_start 전까지 DEAD)
+ *
+ * @param user PAP 사용자 (모뎀이 PAP 를 요구할 때만, 수명 동안 유효해야 함)
+ * @param pass PAP 암호
+ */
+void ppp_init(ppp_t *ppp, const ppp_ops_t *ops, void *ctx, const char *user,
+              const char *pass);
+
+/**
+ * @brief 데이터 채널 CONNECT 뒤 LCP 시작
+ *
+ * @param magic LCP magic number (0 이 아닌 난수)
+ */
+void ppp_start(ppp_t *ppp, uint32_t magic);
+
+/**
+ * @brief LCP Terminate-Request 로 링크 닫기 (끝나면 PPP_EVT_DOWN)
+ */
+void ppp_close(ppp_t *ppp);
+
+/**
+ * @brief 캐리어가 끊김 - 바로 DEAD (이벤트 없음, 받던 프레임 버림)
+ */
+void ppp_abort(ppp_t *ppp);
+
+/**
+ * @brief 데이터 채널 수신 chunk (chunk 경계는 어디든 됨)
+ */
+void ppp_input(ppp_t *ppp, const uint8_t *data, size_t len);
+
+/**
+ * @brief 재전송/echo 타이머
+ *
+ * @param elapsed_ms 지난 호출 이후 시간
+ */
+void ppp_tick(ppp_t *ppp, uint32_t elapsed_ms);
+
+/**
+ * @brief IP 데이터그램 송신 (구간들을 이어 한 프레임으로)
+ *
+ * @return 0: 보냄, -1: 링크가 RUNNING 이 아님, 너무 김 또는 write 실패
+ */
+int ppp_output_ip(ppp_t *ppp, const ppp_seg_t *seg, size_t cnt);
+
+/**
+ * @brief IP 를 주고받을 수 있음 (IPCP 열림)
+ */
+bool ppp_is_up(const ppp_t *ppp);
+
+#endif
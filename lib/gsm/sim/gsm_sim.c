@@ -0,0 +1,908 @@
+/**
+ * @file gsm_sim.c
+ * @brief EC25 AT 모뎀 호스트 시뮬레이터 (GSM/NTRIP 처리량 측정)
+ *
+ * gsm.c 와 tcp_socket.c 를 pthread shim 위에서 그대로 돌리고, 모뎀 쪽은
+ * QIOPEN/QIRD/QISEND 와 +QIURC 를 스크립트로 흉내낸다. 캐스터 스트림(녹화
+ * 파일 또는 합성 데이터)을 소켓으로 흘려 UART chunk -> gsm_parse_process()
+ * -> sink 까지의 처리량과 지연을 잰다. 동시에 GGA + keepalive 를 비동기
+ * 송신해서 QISEND 묶음 비율도 본다.
+ * 펌웨어 빌드에서는 제외되며 호스트 gcc로 직접 빌드한다.
+ *
+ * 빌드 (repo 루트에서):
+ *   gcc -O2 -std=gnu11 -pthread -Ilib/gsm/sim/shim -Ilib/gsm -Ilib/parser \
+ *       -Ilib/simd -Ilib/log -Iconfig -o gsm_sim lib/gsm/sim/gsm_sim.c \
+ *       lib/gsm/gsm.c lib/gsm/cmux.c lib/gsm/tcp_socket.c lib/parser/parser.c \
+ *       lib/simd/simd.c
+ *
+ * 실행:
+ *   ./gsm_sim [-m buffer|push] [-b baud] [-r rate] [-s seg] [-n bytes]
+ *             [-l lat_ms] [-j jitter_ms] [-c chunk] [-d drop] [-F fail]
+ *             [-g gga_ms] [-u urc] [-t sec] [caster.bin]
+ *
+ *   -m : QIOPEN access mode (기본 buffer)
+ *   -b : 모뎀 UART 속도, 0 이면 속도 제한 없음 (기본 115200)
+ *   -r : 캐스터 송신 속도 B/s, 0 이면 흐름 제어가 허락하는 만큼 (기본 0)
+ *   -s : 캐스터 TCP segment 크기 (기본 536)
+ *   -n : 합성 스트림 길이 (파일이 없을 때, 기본 200000)
+ *   -l : AT 응답 지연 ms, -j : 지연 흔들림 ms (기본 20, 0)
+ *   -c : UART chunk 최대 크기, 1 ~ c 사이 난수 (DMA IDLE/HT/TC, 기본 64)
+ *   -d : UART chunk 를 버릴 확률 (1/1000, 기본 0)
+ *   -F : SEND FAIL 확률 (1/1000, 기본 0)
+ *   -g : GGA 송신 주기 ms, 0 이면 송신 안 함 (기본 1000)
+ *   -u : 1 이면 buffer 모드에서 segment 도착마다 +QIURC: "recv" (URC 몰림,
+ *        기본 0: 버퍼를 비울 때까지 한 번)
+ *   -t : 최대 실행 시간 초 (기본 60)
+ *
+ * 캐스터 파일은 NTRIP 응답 헤더 뒤의 raw 보정 데이터 (RTCM3).
+ */
+
+#include "gsm.h"
+#include "tcp_socket.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define SIM_CID 0
+#define SIM_MODEM_BUF (16 * 1024) // EC25 소켓 수신 버퍼
+#define SIM_PUSH_WINDOW 4096     // push 모드에서 UART 앞에 쌓아 둘 최대 바이트
+#define SIM_IDLE_US 200
+
+SIM_SHIM_STATE;
+
+typedef struct sim_seg_s {
+  struct sim_seg_s *next;
+  uint64_t due_us;
+  size_t len;
+  size_t pos;
+  uint8_t data[];
+} sim_seg_t;
+
+typedef struct {
+  gsm_tcp_access_t mode;
+  uint32_t baud;
+  uint32_t rate;
+  size_t seg;
+  uint32_t lat_ms;
+  uint32_t jitter_ms;
+  size_t chunk;
+  uint32_t drop;
+  uint32_t fail;
+  uint32_t gga_ms;
+  uint32_t urc_each;
+  uint32_t timeout_s;
+} sim_cfg_t;
+
+static sim_cfg_t cfg = {
+    .mode = GSM_TCP_ACCESS_BUFFER,
+    .baud = 115200,
+    .rate = 0,
+    .seg = 536,
+    .lat_ms = 20,
+    .jitter_ms = 0,
+    .chunk = 64,
+    .drop = 0,
+    .fail = 0,
+    .gga_ms = 1000,
+    .urc_each = 0,
+    .timeout_s = 60,
+};
+
+static gsm_t gsm;
+
+static uint8_t *src;
+static size_t src_len;
+
+/**
+ * @brief 시뮬레이터 모뎀
+ *
+ * 모뎀 태스크는 파서 태스크 역할도 한다 (gsm_parse_process 를 여기서 부름).
+ * gsm_port_send() 는 AT 처리 태스크와 파서 태스크('>' 프롬프트)에서 온다.
+ */
+static struct {
+  pthread_mutex_t lock;
+
+  // 호스트 -> 모뎀
+  uint8_t in[4096];
+  size_t in_len;
+  size_t send_left; // QISEND 데이터 모드에서 남은 바이트
+
+  // 모뎀 -> 호스트
+  sim_seg_t *out_head;
+  sim_seg_t *out_tail;
+  size_t out_bytes;
+  uint64_t out_last_due;
+  uint64_t uart_free_us;
+
+  // 소켓
+  bool open;
+  bool streaming;
+  uint8_t store[SIM_MODEM_BUF];
+  size_t store_head;
+  size_t store_len;
+  bool notified;
+
+  // 캐스터
+  size_t src_pos;
+  uint64_t next_arrival_us;
+  size_t *arr_off; // segment 별 도착 시각 (지연 계산)
+  uint64_t *arr_us;
+  size_t arr_cnt;
+  bool stalled;
+} modem = {.lock = PTHREAD_MUTEX_INITIALIZER};
+
+static struct {
+  uint64_t start_us;
+  uint64_t end_us;
+  size_t rx_bytes;
+  size_t mismatch;
+  uint32_t *lat_us;
+  size_t lat_cnt;
+  size_t lat_cap;
+  uint32_t uart_chunks;
+  uint32_t uart_dropped;
+  uint64_t uart_bytes;
+  uint32_t stalls;
+  uint32_t qird;
+  uint64_t qird_bytes;
+  uint32_t qisend;
+  uint64_t qisend_bytes;
+  uint32_t urc_recv;
+  uint32_t tx_writes;
+  uint32_t tx_rejected;
+  volatile uint32_t tx_ok;
+  volatile uint32_t tx_fail;
+} st;
+
+static uint64_t now_us(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+static bool chance(uint32_t per_mille) {
+  return per_mille && (uint32_t)(rand() % 1000) < per_mille;
+}
+
+/* ---- 모뎀 출력 (lock 안) ---- */
+
+static void out_push(const void *data, size_t len, uint64_t delay_us) {
+  sim_seg_t *seg = malloc(sizeof(*seg) + len);
+  uint64_t due = now_us() + delay_us;
+
+  if (!seg) {
+    return;
+  }
+
+  // 모뎀 출력 순서는 지연과 상관없이 유지된다
+  if (due < modem.out_last_due) {
+    due = modem.out_last_due;
+  }
+  modem.out_last_due = due;
+
+  seg->next = NULL;
+  seg->due_us = due;
+  seg->len = len;
+  seg->pos = 0;
+  memcpy(seg->data, data, len);
+
+  if (modem.out_tail) {
+    modem.out_tail->next = seg;
+  } else {
+    modem.out_head = seg;
+  }
+  modem.out_tail = seg;
+  modem.out_bytes += len;
+}
+
+static uint64_t at_delay_us(void) {
+  uint32_t ms = cfg.lat_ms;
+
+  if (cfg.jitter_ms) {
+    ms += (uint32_t)rand() % (cfg.jitter_ms + 1);
+  }
+  return (uint64_t)ms * 1000u;
+}
+
+static void out_str(const char *s) { out_push(s, strlen(s), at_delay_us()); }
+
+/**
+ * @brief 모뎀 버퍼에서 n 바이트 꺼내기
+ */
+static size_t store_take(uint8_t *dst, size_t n) {
+  if (n > modem.store_len) {
+    n = modem.store_len;
+  }
+  for (size_t i = 0; i < n; i++) {
+    dst[i] = modem.store[(modem.store_head + i) % SIM_MODEM_BUF];
+  }
+  modem.store_head = (modem.store_head + n) % SIM_MODEM_BUF;
+  modem.store_len -= n;
+  return n;
+}
+
+/* ---- AT 명령 처리 (lock 안) ---- */
+
+static void modem_cmd_qird(const char *args) {
+  static uint8_t resp[GSM_TCP_RX_BUFFER_SIZE + 64];
+  int cid = 0;
+  int max = 0;
+
+  sscanf(args, "%d,%d", &cid, &max);
+  if (max < 0) {
+    max = 0;
+  }
+
+  int hdr = snprintf((char *)resp, sizeof(resp), "\r\n+QIRD: %u\r\n",
+                     (unsigned)(modem.store_len < (size_t)max ? modem.store_len
+                                                              : (size_t)max));
+  size_t n = store_take(&resp[hdr], (size_t)max);
+  memcpy(&resp[hdr + n], "\r\n\r\nOK\r\n", 8);
+  out_push(resp, hdr + n + 8, at_delay_us());
+
+  st.qird++;
+  st.qird_bytes += n;
+  if (n == 0) {
+    // 다음 도착 때 다시 +QIURC: "recv" 를 보낸다
+    modem.notified = false;
+  }
+}
+
+static void modem_cmd(const char *line) {
+  char buf[96];
+
+  if (!strncmp(line, "AT+QIOPEN=", 10)) {
+    int ctx = 0;
+    int cid = 0;
+    int mode = 0;
+
+    sscanf(&line[10], "%d,%d,\"TCP\",\"%*[^\"]\",%*d,%*d,%d", &ctx, &cid,
+           &mode);
+    modem.open = true;
+    modem.store_len = 0;
+    modem.notified = false;
+    out_str("\r\nOK\r\n");
+    snprintf(buf, sizeof(buf), "\r\n+QIOPEN: %d,0\r\n", cid);
+    out_str(buf);
+  } else if (!strncmp(line, "AT+QIRD=", 8)) {
+    modem_cmd_qird(&line[8]);
+  } else if (!strncmp(line, "AT+QISEND=", 10)) {
+    int cid = 0;
+    int len = 0;
+
+    sscanf(&line[10], "%d,%d", &cid, &len);
+    if (!modem.open || len <= 0 || len > GSM_TCP_SEND_MAX) {
+      out_str("\r\nERROR\r\n");
+      return;
+    }
+    st.qisend++;
+    modem.send_left = (size_t)len;
+    out_str("> ");
+  } else if (!strncmp(line, "AT+QICLOSE=", 11)) {
+    modem.open = false;
+    out_str("\r\nOK\r\n");
+  } else {
+    out_str("\r\nOK\r\n");
+  }
+}
+
+/**
+ * @brief 호스트가 보낸 바이트 처리 (lock 안)
+ */
+static void modem_input(void) {
+  size_t pos = 0;
+
+  while (pos < modem.in_len) {
+    if (modem.send_left) {
+      size_t n = modem.in_len - pos;
+
+      if (n > modem.send_left) {
+        n = modem.send_left;
+      }
+      st.qisend_bytes += n;
+      modem.send_left -= n;
+      pos += n;
+      if (modem.send_left == 0) {
+        out_str(chance(cfg.fail) ? "\r\nSEND FAIL\r\n" : "\r\nSEND OK\r\n");
+      }
+      continue;
+    }
+
+    uint8_t *lf = memchr(&modem.in[pos], '\n', modem.in_len - pos);
+    if (!lf) {
+      break;
+    }
+
+    size_t end = (size_t)(lf - modem.in);
+    char line[GSM_AT_CMD_PARAM_SIZE + 32];
+    size_t n = end - pos;
+
+    if (n && modem.in[end - 1] == '\r') {
+      n--;
+    }
+    if (n >= sizeof(line)) {
+      n = sizeof(line) - 1;
+    }
+    memcpy(line, &modem.in[pos], n);
+    line[n] = '\0';
+    pos = end + 1;
+
+    if (n) {
+      modem_cmd(line);
+    }
+  }
+
+  memmove(modem.in, &modem.in[pos], modem.in_len - pos);
+  modem.in_len -= pos;
+}
+
+/**
+ * @brief 흐름 제어로 캐스터가 막힘 (막힐 때마다 한 번 센다)
+ */
+static void modem_stall(void) {
+  if (!modem.stalled) {
+    modem.stalled = true;
+    st.stalls++;
+  }
+}
+
+/**
+ * @brief 캐스터에서 segment 도착 (lock 안)
+ */
+static void modem_caster(uint64_t now) {
+  static uint8_t push[GSM_TCP_RX_BUFFER_SIZE + 48];
+
+  while (modem.streaming && modem.open && modem.src_pos < src_len &&
+         now >= modem.next_arrival_us) {
+    size_t n = src_len - modem.src_pos;
+
+    if (n > cfg.seg) {
+      n = cfg.seg;
+    }
+
+    if (cfg.mode == GSM_TCP_ACCESS_PUSH) {
+      if (modem.out_bytes > SIM_PUSH_WINDOW) {
+        modem_stall();
+        break;
+      }
+      int hdr = snprintf((char *)push, sizeof(push),
+                         "\r\n+QIURC: \"recv\",%d,%u\r\n", SIM_CID,
+                         (unsigned)n);
+      memcpy(&push[hdr], &src[modem.src_pos], n);
+      out_push(push, hdr + n, 0);
+      st.urc_recv++;
+    } else {
+      if (SIM_MODEM_BUF - modem.store_len < n) {
+        // TCP 윈도가 닫힌 셈 (캐스터가 기다린다)
+        modem_stall();
+        break;
+      }
+      for (size_t i = 0; i < n; i++) {
+        modem.store[(modem.store_head + modem.store_len + i) % SIM_MODEM_BUF] =
+            src[modem.src_pos + i];
+      }
+      modem.store_len += n;
+      if (!modem.notified || cfg.urc_each) {
+        static const char urc[] = "\r\n+QIURC: \"recv\",0\r\n";
+        out_push(urc, sizeof(urc) - 1, 0);
+        modem.notified = true;
+        st.urc_recv++;
+      }
+    }
+
+    modem.stalled = false;
+    modem.arr_off[modem.arr_cnt] = modem.src_pos;
+    modem.arr_us[modem.arr_cnt] = now;
+    modem.arr_cnt++;
+    modem.src_pos += n;
+
+    if (cfg.rate) {
+      modem.next_arrival_us += (uint64_t)n * 1000000u / cfg.rate;
+    } else {
+      modem.next_arrival_us = now;
+    }
+  }
+}
+
+/**
+ * @brief 출력할 UART chunk 하나 꺼내기 (lock 안)
+ *
+ * @return chunk 길이 (0: 아직 보낼 것이 없음)
+ */
+static size_t modem_uart_chunk(uint8_t *buf, uint64_t now) {
+  size_t want = 1 + (size_t)rand() % cfg.chunk;
+  size_t n = 0;
+
+  if (now < modem.uart_free_us) {
+    return 0;
+  }
+
+  while (n < want && modem.out_head && modem.out_head->due_us <= now) {
+    sim_seg_t *seg = modem.out_head;
+    size_t k = seg->len - seg->pos;
+
+    if (k > want - n) {
+      k = want - n;
+    }
+    memcpy(&buf[n], &seg->data[seg->pos], k);
+    seg->pos += k;
+    n += k;
+
+    if (seg->pos == seg->len) {
+      modem.out_head = seg->next;
+      if (!modem.out_head) {
+        modem.out_tail = NULL;
+      }
+      free(seg);
+    }
+  }
+
+  modem.out_bytes -= n;
+  if (n && cfg.baud) {
+    // 8N1 10 bit/byte
+    uint64_t t = (uint64_t)n * 10u * 1000000u / cfg.baud;
+    modem.uart_free_us = (modem.uart_free_us > now ? modem.uart_free_us : now) + t;
+  }
+  return n;
+}
+
+static void modem_task(void *arg) {
+  uint8_t chunk[1024];
+
+  (void)arg;
+
+  while (1) {
+    uint64_t now = now_us();
+    size_t n;
+
+    pthread_mutex_lock(&modem.lock);
+    modem_input();
+    modem_caster(now);
+    n = modem_uart_chunk(chunk, now);
+    pthread_mutex_unlock(&modem.lock);
+
+    if (n == 0) {
+      struct timespec ts = {.tv_sec = 0, .tv_nsec = SIM_IDLE_US * 1000};
+      nanosleep(&ts, NULL);
+      continue;
+    }
+
+    st.uart_chunks++;
+    st.uart_bytes += n;
+    if (chance(cfg.drop)) {
+      st.uart_dropped++;
+      continue;
+    }
+    gsm_parse_process(&gsm, chunk, n);
+  }
+}
+
+/* ---- gsm.c 포트 ---- */
+
+int gsm_port_send(const char *data, size_t len) {
+  pthread_mutex_lock(&modem.lock);
+  if (len > sizeof(modem.in) - modem.in_len) {
+    len = sizeof(modem.in) - modem.in_len;
+  }
+  memcpy(&modem.in[modem.in_len], data, len);
+  modem.in_len += len;
+  pthread_mutex_unlock(&modem.lock);
+  return 0;
+}
+
+// 시뮬레이터 모뎀은 AT+CMUX 를 모르므로 다중화가 켜지지 않는다
+int gsm_port_sendv(const cmux_seg_t *seg, size_t cnt) {
+  for (size_t i = 0; i < cnt; i++) {
+    gsm_port_send(seg[i].data, seg[i].len);
+  }
+  return 0;
+}
+
+int gsm_port_reset(void) { return 0; }
+
+int gsm_port_set_baudrate(uint32_t baudrate) {
+  cfg.baud = baudrate;
+  return 0;
+}
+
+/**
+ * @brief AT 명령 처리 태스크 (gsm_app.c 와 같은 흐름)
+ */
+static void sim_at_task(void *arg) {
+  gsm_at_cmd_t at_cmd;
+
+  (void)arg;
+
+  while (1) {
+    if (!gsm_at_cmd_receive(&gsm, &at_cmd, portMAX_DELAY)) {
+      continue;
+    }
+    if (!gsm_at_cmd_prepare(&gsm, &at_cmd)) {
+      continue;
+    }
+
+    xSemaphoreTake(gsm.cmd_mutex, portMAX_DELAY);
+    gsm.current_cmd = &at_cmd;
+    memset(&at_cmd.msg, 0, sizeof(at_cmd.msg));
+    xSemaphoreGive(gsm.cmd_mutex);
+
+    const char *at_mode = at_cmd.at_mode == GSM_AT_WRITE  ? "="
+                          : at_cmd.at_mode == GSM_AT_READ ? "?"
+                          : at_cmd.at_mode == GSM_AT_TEST ? "=?"
+                                                          : "";
+    const char *at_str = gsm.at_tbl[at_cmd.cmd].at_str;
+
+    gsm_port_send(at_str, strlen(at_str));
+    gsm_port_send(at_mode, strlen(at_mode));
+    gsm_port_send(at_cmd.params, strlen(at_cmd.params));
+    gsm_port_send("\r\n", 2);
+
+    uint32_t timeout_ms = gsm.at_tbl[at_cmd.cmd].timeout_ms;
+    if (timeout_ms == 0) {
+      timeout_ms = 5000;
+    }
+
+    if (xSemaphoreTake(gsm.producer_sem, pdMS_TO_TICKS(timeout_ms)) ==
+        pdTRUE) {
+      continue;
+    }
+
+    bool mine = false;
+
+    xSemaphoreTake(gsm.cmd_mutex, portMAX_DELAY);
+    if (gsm.current_cmd == &at_cmd) {
+      gsm.current_cmd = NULL;
+      gsm.status.is_ok = 0;
+      gsm.status.is_err = 1;
+      mine = true;
+      if (at_cmd.sem) {
+        xSemaphoreGive(at_cmd.sem);
+      } else if (at_cmd.callback) {
+        at_cmd.callback(&gsm, at_cmd.cmd, NULL, false);
+      }
+      if (at_cmd.tx_pbuf) {
+        tcp_pbuf_free(at_cmd.tx_pbuf);
+      }
+    }
+    xSemaphoreGive(gsm.cmd_mutex);
+
+    fprintf(stderr, "AT 타임아웃: %s%s%s\n", at_str, at_mode, at_cmd.params);
+    if (mine && at_cmd.tx_batch) {
+      gsm_tcp_tx_complete(&gsm, at_cmd.tx_cid, at_cmd.tx_batch, false);
+    }
+  }
+}
+
+/* ---- 측정 ---- */
+
+/**
+ * @brief 보정 데이터 sink (파서 태스크)
+ */
+static void sim_sink(const uint8_t *data, size_t len, void *ctx) {
+  uint64_t now = now_us();
+  size_t last;
+  size_t lo = 0;
+  size_t hi;
+
+  (void)ctx;
+
+  for (size_t i = 0; i < len; i++) {
+    size_t off = st.rx_bytes + i;
+    if (off >= src_len || data[i] != src[off]) {
+      st.mismatch++;
+    }
+  }
+  st.rx_bytes += len;
+
+  // 마지막 바이트가 모뎀에 도착한 시각부터
+  last = st.rx_bytes - 1;
+  pthread_mutex_lock(&modem.lock);
+  hi = modem.arr_cnt;
+  while (hi - lo > 1) {
+    size_t mid = (lo + hi) / 2;
+    if (modem.arr_off[mid] <= last) {
+      lo = mid;
+    } else {
+      hi = mid;
+    }
+  }
+  uint64_t arrived = modem.arr_cnt ? modem.arr_us[lo] : now;
+  pthread_mutex_unlock(&modem.lock);
+
+  if (st.lat_cnt == st.lat_cap) {
+    st.lat_cap = st.lat_cap ? st.lat_cap * 2 : 1024;
+    st.lat_us = realloc(st.lat_us, st.lat_cap * sizeof(*st.lat_us));
+  }
+  st.lat_us[st.lat_cnt++] = (uint32_t)(now - arrived);
+
+  if (st.rx_bytes >= src_len && !st.end_us) {
+    st.end_us = now;
+  }
+}
+
+static void sim_sent_cb(uint8_t connect_id, bool ok, void *ctx) {
+  (void)connect_id;
+  (void)ctx;
+
+  if (ok) {
+    st.tx_ok++;
+  } else {
+    st.tx_fail++;
+  }
+}
+
+/**
+ * @brief GGA 와 keepalive 를 같은 순간에 비동기로 넣는다
+ */
+static void sim_send_gga(tcp_socket_t *sock) {
+  static const char gga[] =
+      "$GPGGA,092725.00,4717.11399,N,00833.91590,E,1,08,1.01,499.6,M,48.0,M,,"
+      "*5B\r\n";
+  static const char keepalive[] = "\r\n";
+  const char *msgs[] = {gga, keepalive};
+  size_t lens[] = {sizeof(gga) - 1, sizeof(keepalive) - 1};
+
+  for (int i = 0; i < 2; i++) {
+    tcp_pbuf_t *p = tcp_pbuf_alloc(lens[i]);
+
+    if (!p) {
+      st.tx_rejected++;
+      continue;
+    }
+    memcpy(p->payload, msgs[i], lens[i]);
+    if (tcp_send_async(sock, p, true, sim_sent_cb, NULL) != 0) {
+      tcp_pbuf_free(p);
+      st.tx_rejected++;
+      continue;
+    }
+    st.tx_writes++;
+  }
+}
+
+static int cmp_u32(const void *a, const void *b) {
+  uint32_t x = *(const uint32_t *)a;
+  uint32_t y = *(const uint32_t *)b;
+  return (x > y) - (x < y);
+}
+
+static void report(void) {
+  uint64_t end = st.end_us ? st.end_us : now_us();
+  double sec = (double)(end - st.start_us) / 1e6;
+
+  if (sec <= 0) {
+    sec = 1e-6;
+  }
+
+  printf("== %s, %u baud, seg %zu, rate %u B/s, lat %u+%u ms, chunk %zu, "
+         "drop %u/1000\n",
+         cfg.mode == GSM_TCP_ACCESS_PUSH ? "push" : "buffer", cfg.baud, cfg.seg,
+         cfg.rate, cfg.lat_ms, cfg.jitter_ms, cfg.chunk, cfg.drop);
+  printf("rx   %zu/%zu bytes in %.2f s, %.1f kB/s", st.rx_bytes, src_len, sec,
+         (double)st.rx_bytes / sec / 1000.0);
+  if (cfg.baud) {
+    printf(" (UART %.0f%%)",
+           (double)st.uart_bytes * 10.0 / cfg.baud / sec * 100.0);
+  }
+  printf("\n");
+
+  if (st.lat_cnt) {
+    uint64_t sum = 0;
+
+    qsort(st.lat_us, st.lat_cnt, sizeof(*st.lat_us), cmp_u32);
+    for (size_t i = 0; i < st.lat_cnt; i++) {
+      sum += st.lat_us[i];
+    }
+    printf("lat  min %.1f avg %.1f p50 %.1f p99 %.1f max %.1f ms (n=%zu)\n",
+           st.lat_us[0] / 1000.0, (double)sum / st.lat_cnt / 1000.0,
+           st.lat_us[st.lat_cnt / 2] / 1000.0,
+           st.lat_us[st.lat_cnt * 99 / 100] / 1000.0,
+           st.lat_us[st.lat_cnt - 1] / 1000.0, st.lat_cnt);
+  }
+
+  printf("err  mismatch %zu bytes, UART chunks dropped %u/%u, caster stalls "
+         "%u\n",
+         st.mismatch, st.uart_dropped, st.uart_chunks, st.stalls);
+  printf("at   QIRD %u (avg %.0f B), URC recv %u\n", st.qird,
+         st.qird ? (double)st.qird_bytes / st.qird : 0.0, st.urc_recv);
+  printf("tx   writes %u (rejected %u) ok %u fail %u, QISEND %u (%llu B), "
+         "%.2f writes/QISEND\n",
+         st.tx_writes, st.tx_rejected, st.tx_ok, st.tx_fail, st.qisend,
+         (unsigned long long)st.qisend_bytes,
+         st.qisend ? (double)st.tx_writes / st.qisend : 0.0);
+
+  for (uint8_t c = 0; c < GSM_TCP_PBUF_CLASS_CNT; c++) {
+    tcp_pbuf_pool_stats_t ps;
+
+    if (tcp_pbuf_pool_get_stats(c, &ps)) {
+      printf("pool %4u B: min_free %u/%u borrowed %u exhausted %u\n", ps.size,
+             ps.min_free, ps.total, (unsigned)ps.borrowed,
+             (unsigned)ps.exhausted);
+    }
+  }
+
+  sim_shim_report(sec);
+}
+
+static uint8_t *load_capture(const char *path, size_t *len) {
+  FILE *fp = fopen(path, "rb");
+  if (!fp) {
+    perror(path);
+    return NULL;
+  }
+
+  fseek(fp, 0, SEEK_END);
+  long size = ftell(fp);
+  fseek(fp, 0, SEEK_SET);
+
+  uint8_t *buf = NULL;
+  if (size > 0) {
+    buf = malloc((size_t)size);
+  }
+  if (!buf || fread(buf, 1, (size_t)size, fp) != (size_t)size) {
+    fprintf(stderr, "%s: read failed\n", path);
+    free(buf);
+    fclose(fp);
+    return NULL;
+  }
+
+  fclose(fp);
+  *len = (size_t)size;
+  return buf;
+}
+
+/**
+ * @brief RTCM3 모양의 합성 스트림 (0xD3 + 길이 + 의사 난수 payload)
+ */
+static uint8_t *make_stream(size_t len) {
+  uint8_t *buf = malloc(len);
+  size_t pos = 0;
+
+  if (!buf) {
+    return NULL;
+  }
+
+  srand(1);
+  while (pos < len) {
+    size_t payload = 20 + (size_t)rand() % 280;
+    size_t frame = 3 + payload + 3;
+
+    for (size_t i = 0; i < frame && pos + i < len; i++) {
+      uint8_t b = (uint8_t)rand();
+
+      if (i == 0) {
+        b = 0xD3;
+      } else if (i == 1) {
+        b = (uint8_t)(payload >> 8);
+      } else if (i == 2) {
+        b = (uint8_t)payload;
+      }
+      buf[pos + i] = b;
+    }
+    pos += frame;
+  }
+
+  return buf;
+}
+
+int main(int argc, char **argv) {
+  size_t synth_len = 200000;
+  const char *path = NULL;
+  int i = 1;
+
+  for (; i < argc; i++) {
+    const char *o = argv[i];
+    const char *v = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+    if (o[0] != '-') {
+      path = o;
+      continue;
+    }
+    if (!v) {
+      break;
+    }
+    i++;
+    if (!strcmp(o, "-m")) {
+      cfg.mode = strcmp(v, "push") ? GSM_TCP_ACCESS_BUFFER : GSM_TCP_ACCESS_PUSH;
+    } else if (!strcmp(o, "-b")) {
+      cfg.baud = (uint32_t)atol(v);
+    } else if (!strcmp(o, "-r")) {
+      cfg.rate = (uint32_t)atol(v);
+    } else if (!strcmp(o, "-s")) {
+      cfg.seg = (size_t)atol(v);
+    } else if (!strcmp(o, "-n")) {
+      synth_len = (size_t)atol(v);
+    } else if (!strcmp(o, "-l")) {
+      cfg.lat_ms = (uint32_t)atol(v);
+    } else if (!strcmp(o, "-j")) {
+      cfg.jitter_ms = (uint32_t)atol(v);
+    } else if (!strcmp(o, "-c")) {
+      cfg.chunk = (size_t)atol(v);
+    } else if (!strcmp(o, "-d")) {
+      cfg.drop = (uint32_t)atol(v);
+    } else if (!strcmp(o, "-F")) {
+      cfg.fail = (uint32_t)atol(v);
+    } else if (!strcmp(o, "-g")) {
+      cfg.gga_ms = (uint32_t)atol(v);
+    } else if (!strcmp(o, "-u")) {
+      cfg.urc_each = (uint32_t)atol(v);
+    } else if (!strcmp(o, "-t")) {
+      cfg.timeout_s = (uint32_t)atol(v);
+    } else {
+      break;
+    }
+  }
+
+  if (i < argc || cfg.seg == 0 || cfg.seg > GSM_TCP_RX_BUFFER_SIZE - 40 ||
+      cfg.chunk == 0 || cfg.chunk > 1024) {
+    fprintf(stderr,
+            "usage: %s [-m buffer|push] [-b baud] [-r rate] [-s seg] "
+            "[-n bytes] [-l lat_ms] [-j jitter_ms] [-c chunk] [-d drop] "
+            "[-F fail] [-g gga_ms] [-u urc] [-t sec] [caster.bin]\n",
+            argv[0]);
+    return 1;
+  }
+
+  src = path ? load_capture(path, &src_len) : make_stream(synth_len);
+  if (!path) {
+    src_len = synth_len;
+  }
+  if (!src || src_len == 0) {
+    return 1;
+  }
+
+  modem.arr_off = malloc((src_len / cfg.seg + 1) * sizeof(*modem.arr_off));
+  modem.arr_us = malloc((src_len / cfg.seg + 1) * sizeof(*modem.arr_us));
+  if (!modem.arr_off || !modem.arr_us) {
+    return 1;
+  }
+
+  gsm_init(&gsm, NULL, NULL);
+  xTaskCreate(modem_task, "modem", 0, NULL, 0, NULL);
+  xTaskCreate(sim_at_task, "gsm_at", 0, NULL, 0, NULL);
+
+  tcp_socket_t *sock = tcp_socket_create(&gsm, SIM_CID);
+  tcp_set_access_mode(sock, cfg.mode);
+  if (tcp_connect(sock, 1, "caster.sim", 2101, 5000) != 0) {
+    fprintf(stderr, "QIOPEN 실패\n");
+    return 1;
+  }
+  tcp_set_sink(sock, sim_sink, NULL);
+
+  pthread_mutex_lock(&modem.lock);
+  st.start_us = now_us();
+  modem.next_arrival_us = st.start_us;
+  modem.streaming = true;
+  pthread_mutex_unlock(&modem.lock);
+
+  uint64_t deadline = st.start_us + (uint64_t)cfg.timeout_s * 1000000u;
+  uint64_t next_gga = st.start_us;
+  uint64_t idle_since = 0;
+  size_t last_rx = 0;
+
+  while (now_us() < deadline && !st.end_us) {
+    uint64_t now = now_us();
+
+    if (cfg.gga_ms && now >= next_gga) {
+      sim_send_gga(sock);
+      next_gga += (uint64_t)cfg.gga_ms * 1000u;
+    }
+
+    // 손실로 끝까지 못 받으면 2초 동안 진척이 없을 때 끝낸다
+    if (st.rx_bytes != last_rx) {
+      last_rx = st.rx_bytes;
+      idle_since = now;
+    } else if (modem.src_pos >= src_len && idle_since &&
+               now - idle_since > 2000000u) {
+      break;
+    }
+
+    vTaskDelay(1);
+  }
+
+  // 남은 송신 완료 대기
+  vTaskDelay(pdMS_TO_TICKS(cfg.lat_ms * 4 + 100));
+
+  report();
+  return (st.rx_bytes == src_len && st.mismatch == 0) ? 0 : 2;
+}
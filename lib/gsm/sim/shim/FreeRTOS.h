@@ -0,0 +1,383 @@
+#ifndef SIM_FREERTOS_H
+#define SIM_FREERTOS_H
+
+/*
+ * 호스트 시뮬레이터 빌드용 FreeRTOS shim (pthread)
+ * gsm.c / tcp_socket.c / gps.c / rtcm.c 가 쓰는 태스크, 큐, 세마포어, tick 만
+ * 흉내낸다. mutex 도 binary 세마포어로 처리한다 (우선순위 상속 없음).
+ *
+ * 태스크마다 CPU 시간과 registry 에 올린 큐의 최대 깊이를 모아
+ * sim_shim_report() 로 출력한다. 상태 변수는 시뮬레이터 .c 에서
+ * SIM_SHIM_STATE 로 한 번 정의한다.
+ */
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+typedef uint32_t TickType_t;
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+typedef void (*TaskFunction_t)(void *);
+
+typedef struct sim_sem_s {
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+  unsigned count;
+  unsigned max;
+} *SemaphoreHandle_t;
+
+typedef struct sim_queue_s {
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+  uint8_t *buf;
+  size_t item;
+  size_t len;
+  size_t head;
+  size_t cnt;
+  size_t hwm;       // 최대 깊이
+  const char *name; // vQueueAddToRegistry 로 올린 이름
+} *QueueHandle_t;
+
+typedef pthread_t *TaskHandle_t;
+
+#define SIM_TASK_MAX 16
+#define SIM_QUEUE_MAX 16
+
+typedef struct {
+  const char *name;
+  pthread_t th;
+} sim_task_info_t;
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS 1
+#define pdFAIL 0
+#define portMAX_DELAY 0xFFFFFFFFUL
+#define configTICK_RATE_HZ 1000
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define tskIDLE_PRIORITY 0
+
+/* pbuf 풀 등 critical section 은 프로세스 전체 잠금 하나 */
+extern pthread_mutex_t sim_critical_lock;
+
+/* 보고용 태스크/큐 목록 (sim_critical_lock 으로 보호) */
+extern sim_task_info_t sim_tasks[SIM_TASK_MAX];
+extern unsigned sim_task_cnt;
+extern QueueHandle_t sim_queues[SIM_QUEUE_MAX];
+extern unsigned sim_queue_cnt;
+
+#define SIM_SHIM_STATE                                                         \
+  pthread_mutex_t sim_critical_lock = PTHREAD_MUTEX_INITIALIZER;               \
+  sim_task_info_t sim_tasks[SIM_TASK_MAX];                                     \
+  unsigned sim_task_cnt;                                                       \
+  QueueHandle_t sim_queues[SIM_QUEUE_MAX];                                     \
+  unsigned sim_queue_cnt
+
+#define taskENTER_CRITICAL() pthread_mutex_lock(&sim_critical_lock)
+#define taskEXIT_CRITICAL() pthread_mutex_unlock(&sim_critical_lock)
+#define taskENTER_CRITICAL_FROM_ISR() (pthread_mutex_lock(&sim_critical_lock), 0)
+#define taskEXIT_CRITICAL_FROM_ISR(x)                                          \
+  ((void)(x), pthread_mutex_unlock(&sim_critical_lock))
+
+static inline void *pvPortMalloc(size_t size) { return malloc(size); }
+static inline void vPortFree(void *p) { free(p); }
+
+static inline TickType_t xTaskGetTickCount(void) {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (TickType_t)(ts.tv_sec * 1000u + ts.tv_nsec / 1000000u);
+}
+
+static inline void vTaskDelay(TickType_t ticks) {
+  struct timespec ts = {.tv_sec = ticks / 1000,
+                        .tv_nsec = (long)(ticks % 1000) * 1000000L};
+  nanosleep(&ts, NULL);
+}
+
+/**
+ * @brief 대기 마감 시각 (pthread_cond_timedwait 용, CLOCK_REALTIME)
+ */
+static inline struct timespec sim_deadline(TickType_t ticks) {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_REALTIME, &ts);
+  ts.tv_sec += ticks / 1000;
+  ts.tv_nsec += (long)(ticks % 1000) * 1000000L;
+  if (ts.tv_nsec >= 1000000000L) {
+    ts.tv_sec++;
+    ts.tv_nsec -= 1000000000L;
+  }
+  return ts;
+}
+
+/**
+ * @brief cond 대기 (lock 잡은 상태, 0 이면 마감 지남)
+ */
+static inline int sim_wait(pthread_cond_t *cond, pthread_mutex_t *lock,
+                           TickType_t ticks, const struct timespec *until) {
+  if (ticks == 0) {
+    return 0;
+  }
+  if (ticks == portMAX_DELAY) {
+    pthread_cond_wait(cond, lock);
+    return 1;
+  }
+  return pthread_cond_timedwait(cond, lock, until) == 0;
+}
+
+/* ---- 세마포어 ---- */
+
+static inline SemaphoreHandle_t sim_sem_create(unsigned max, unsigned init) {
+  SemaphoreHandle_t s = calloc(1, sizeof(*s));
+
+  if (s) {
+    pthread_mutex_init(&s->lock, NULL);
+    pthread_cond_init(&s->cond, NULL);
+    s->max = max;
+    s->count = init;
+  }
+  return s;
+}
+
+static inline BaseType_t xSemaphoreTake(SemaphoreHandle_t s, TickType_t t) {
+  struct timespec until = sim_deadline(t);
+  BaseType_t ret = pdFALSE;
+
+  if (!s) {
+    return pdFALSE;
+  }
+  pthread_mutex_lock(&s->lock);
+  while (s->count == 0) {
+    if (!sim_wait(&s->cond, &s->lock, t, &until) && s->count == 0) {
+      break;
+    }
+  }
+  if (s->count > 0) {
+    s->count--;
+    ret = pdTRUE;
+  }
+  pthread_mutex_unlock(&s->lock);
+  return ret;
+}
+
+static inline BaseType_t xSemaphoreGive(SemaphoreHandle_t s) {
+  BaseType_t ret = pdFALSE;
+
+  if (!s) {
+    return pdFALSE;
+  }
+  pthread_mutex_lock(&s->lock);
+  if (s->count < s->max) {
+    s->count++;
+    ret = pdTRUE;
+    pthread_cond_signal(&s->cond);
+  }
+  pthread_mutex_unlock(&s->lock);
+  return ret;
+}
+
+static inline void vSemaphoreDelete(SemaphoreHandle_t s) {
+  if (s) {
+    pthread_mutex_destroy(&s->lock);
+    pthread_cond_destroy(&s->cond);
+    free(s);
+  }
+}
+
+#define xSemaphoreCreateMutex() sim_sem_create(1, 1)
+#define xSemaphoreCreateBinary() sim_sem_create(1, 0)
+
+/* ---- 큐 ---- */
+
+static inline QueueHandle_t xQueueCreate(size_t len, size_t item) {
+  QueueHandle_t q = calloc(1, sizeof(*q));
+
+  if (q) {
+    q->buf = calloc(len, item);
+    pthread_mutex_init(&q->lock, NULL);
+    pthread_cond_init(&q->cond, NULL);
+    q->item = item;
+    q->len = len;
+  }
+  return q;
+}
+
+static inline BaseType_t xQueueSend(QueueHandle_t q, const void *item,
+                                    TickType_t t) {
+  struct timespec until = sim_deadline(t);
+  BaseType_t ret = pdFALSE;
+
+  pthread_mutex_lock(&q->lock);
+  while (q->cnt == q->len) {
+    if (!sim_wait(&q->cond, &q->lock, t, &until) && q->cnt == q->len) {
+      break;
+    }
+  }
+  if (q->cnt < q->len) {
+    memcpy(&q->buf[((q->head + q->cnt) % q->len) * q->item], item, q->item);
+    q->cnt++;
+    if (q->cnt > q->hwm) {
+      q->hwm = q->cnt;
+    }
+    ret = pdTRUE;
+    pthread_cond_broadcast(&q->cond);
+  }
+  pthread_mutex_unlock(&q->lock);
+  return ret;
+}
+
+static inline BaseType_t xQueueReceive(QueueHandle_t q, void *item,
+                                       TickType_t t) {
+  struct timespec until = sim_deadline(t);
+  BaseType_t ret = pdFALSE;
+
+  pthread_mutex_lock(&q->lock);
+  while (q->cnt == 0) {
+    if (!sim_wait(&q->cond, &q->lock, t, &until) && q->cnt == 0) {
+      break;
+    }
+  }
+  if (q->cnt > 0) {
+    memcpy(item, &q->buf[q->head * q->item], q->item);
+    q->head = (q->head + 1) % q->len;
+    q->cnt--;
+    ret = pdTRUE;
+    pthread_cond_broadcast(&q->cond);
+  }
+  pthread_mutex_unlock(&q->lock);
+  return ret;
+}
+
+static inline UBaseType_t uxQueueMessagesWaiting(QueueHandle_t q) {
+  UBaseType_t n;
+
+  pthread_mutex_lock(&q->lock);
+  n = q->cnt;
+  pthread_mutex_unlock(&q->lock);
+  return n;
+}
+
+static inline void vQueueAddToRegistry(QueueHandle_t q, const char *name) {
+  pthread_mutex_lock(&sim_critical_lock);
+  q->name = name;
+  if (sim_queue_cnt < SIM_QUEUE_MAX) {
+    sim_queues[sim_queue_cnt++] = q;
+  }
+  pthread_mutex_unlock(&sim_critical_lock);
+}
+
+static inline void vQueueDelete(QueueHandle_t q) {
+  if (q) {
+    pthread_mutex_lock(&sim_critical_lock);
+    for (unsigned i = 0; i < sim_queue_cnt; i++) {
+      if (sim_queues[i] == q) {
+        sim_queues[i] = sim_queues[--sim_queue_cnt];
+        break;
+      }
+    }
+    pthread_mutex_unlock(&sim_critical_lock);
+    pthread_mutex_destroy(&q->lock);
+    pthread_cond_destroy(&q->cond);
+    free(q->buf);
+    free(q);
+  }
+}
+
+/* ---- 태스크 ---- */
+
+typedef struct {
+  TaskFunction_t fn;
+  void *arg;
+} sim_task_start_t;
+
+static inline void *sim_task_entry(void *p) {
+  sim_task_start_t start = *(sim_task_start_t *)p;
+
+  free(p);
+  start.fn(start.arg);
+  return NULL;
+}
+
+static inline BaseType_t xTaskCreate(TaskFunction_t fn, const char *name,
+                                     uint32_t depth, void *arg,
+                                     UBaseType_t prio, TaskHandle_t *out) {
+  sim_task_start_t *start = malloc(sizeof(*start));
+  pthread_t *th = malloc(sizeof(*th));
+
+  (void)depth;
+  (void)prio;
+
+  if (!start || !th) {
+    free(start);
+    free(th);
+    return pdFAIL;
+  }
+  start->fn = fn;
+  start->arg = arg;
+  if (pthread_create(th, NULL, sim_task_entry, start) != 0) {
+    free(start);
+    free(th);
+    return pdFAIL;
+  }
+  pthread_detach(*th);
+  pthread_mutex_lock(&sim_critical_lock);
+  if (sim_task_cnt < SIM_TASK_MAX) {
+    sim_tasks[sim_task_cnt].name = name;
+    sim_tasks[sim_task_cnt].th = *th;
+    sim_task_cnt++;
+  }
+  pthread_mutex_unlock(&sim_critical_lock);
+  if (out) {
+    *out = th;
+  }
+  return pdPASS;
+}
+
+static inline void vTaskDelete(TaskHandle_t t) {
+  if (t == NULL) {
+    pthread_exit(NULL);
+  }
+}
+
+/* ---- 보고 ---- */
+
+/**
+ * @brief 태스크별 CPU 시간과 큐 최대 깊이 출력
+ *
+ * 호스트 CPU 기준이라 절대값보다 태스크 사이 비율과 변경 전후 차이를 본다.
+ *
+ * @param wall_sec 측정 구간 길이 [s] (점유율 계산)
+ */
+static inline void sim_shim_report(double wall_sec) {
+  pthread_mutex_lock(&sim_critical_lock);
+  for (unsigned i = 0; i < sim_task_cnt; i++) {
+    clockid_t cid;
+    struct timespec ts;
+    double ms = 0;
+
+    if (pthread_getcpuclockid(sim_tasks[i].th, &cid) == 0 &&
+        clock_gettime(cid, &ts) == 0) {
+      ms = ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+    }
+    printf("task %-12s cpu %9.1f ms (%5.1f%%)\n", sim_tasks[i].name, ms,
+           wall_sec > 0 ? ms / 10.0 / wall_sec : 0.0);
+  }
+  for (unsigned i = 0; i < sim_queue_cnt; i++) {
+    QueueHandle_t q = sim_queues[i];
+
+    pthread_mutex_lock(&q->lock);
+    printf("queue %-11s depth %zu max %zu/%zu\n", q->name, q->cnt, q->hwm,
+           q->len);
+    pthread_mutex_unlock(&q->lock);
+  }
+  pthread_mutex_unlock(&sim_critical_lock);
+}
+
+#endif
@@ -0,0 +1,11 @@
+#ifndef SIM_DMA_COPY_H
+#define SIM_DMA_COPY_H
+
+#include <string.h>
+
+/* 호스트 시뮬레이터에는 DMA 가 없으므로 memcpy */
+static inline void dma_copy(void *dst, const void *src, size_t len) {
+  memcpy(dst, src, len);
+}
+
+#endif
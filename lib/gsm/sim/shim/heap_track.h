@@ -0,0 +1,16 @@
+#ifndef SIM_HEAP_TRACK_H
+#define SIM_HEAP_TRACK_H
+
+/* 호스트 시뮬레이터에서는 태그 기록 없이 expr 만 평가 */
+typedef enum {
+  HEAP_TAG_OTHER = 0,
+  HEAP_TAG_TASK,
+  HEAP_TAG_CMD_SEM,
+  HEAP_TAG_SOCKET,
+  HEAP_TAG_STATS,
+  HEAP_TAG_COUNT
+} heap_tag_t;
+
+#define HEAP_TRACK(tag, expr) (expr)
+
+#endif
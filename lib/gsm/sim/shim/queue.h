@@ -0,0 +1,6 @@
+#ifndef SIM_QUEUE_H
+#define SIM_QUEUE_H
+
+#include "FreeRTOS.h"
+
+#endif
@@ -0,0 +1,6 @@
+#ifndef SIM_SEMPHR_H
+#define SIM_SEMPHR_H
+
+#include "FreeRTOS.h"
+
+#endif
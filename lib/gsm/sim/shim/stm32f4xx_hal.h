@@ -0,0 +1,8 @@
+#ifndef SIM_STM32F4XX_HAL_H
+#define SIM_STM32F4XX_HAL_H
+
+#include "FreeRTOS.h"
+
+static inline uint32_t HAL_GetTick(void) { return xTaskGetTickCount(); }
+
+#endif
@@ -0,0 +1,6 @@
+#ifndef SIM_TASK_H
+#define SIM_TASK_H
+
+#include "FreeRTOS.h"
+
+#endif
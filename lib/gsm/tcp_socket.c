@@ -1,4 +1,9 @@
 #include "tcp_socket.h"
+#include "heap_track.h"
+#include "dma_copy.h"
+#if GSM_PPP_ENABLE
+#include "gsm_ppp.h"
+#endif
 #include <stdlib.h>
 #include <string.h>
 
@@ -19,6 +24,13 @@ struct tcp_socket_s {
   SemaphoreHandle_t mutex;
 
   uint32_t default_recv_timeout;
+
+  tcp_sink_t sink;
+  void *sink_ctx;
+
+  // tcp_recv() 가 버퍼보다 큰 pbuf 를 받으면 남은 부분 (수신 태스크 전용)
+  tcp_pbuf_t *rx_partial;
+  size_t rx_offset;
 };
 
 static void _internal_recv_callback(uint8_t connect_id);
@@ -26,12 +38,71 @@ static void _internal_close_callback(uint8_t connect_id);
 
 static tcp_socket_t *g_sockets[GSM_TCP_MAX_SOCKETS] = {NULL};
 
+#if GSM_PPP_ENABLE
+/**
+ * @brief 연결 수신 큐에서 rx_queue 로 옮기기 (PPP)
+ *
+ * 닫힘 표시 자리 하나는 남긴다. 못 옮긴 바이트는 TCP 창을 닫아 상대를
+ * 멈추고, 앱이 rx_queue 에서 꺼낼 때마다 다시 채운다.
+ */
+static void tcp_rx_fill(tcp_socket_t *sock) {
+  if (xSemaphoreTake(sock->mutex, portMAX_DELAY) != pdTRUE) {
+    return;
+  }
+
+  while (!sock->sink && uxQueueSpacesAvailable(sock->rx_queue) > 1) {
+    tcp_pbuf_t *pbuf = gsm_ppp_tcp_pull(sock->gsm, sock->connect_id);
+
+    if (!pbuf) {
+      break;
+    }
+    xQueueSend(sock->rx_queue, &pbuf, 0);
+  }
+
+  xSemaphoreGive(sock->mutex);
+}
+
+/**
+ * @brief 데이터를 풀 pbuf 체인으로 복사해 송신 대기열에 넣기 (PPP)
+ */
+static int tcp_send_copy(tcp_socket_t *sock, const uint8_t *data, size_t len) {
+  tcp_pbuf_t *chain = NULL;
+  tcp_pbuf_t **tail = &chain;
+
+  for (size_t off = 0; off < len;) {
+    size_t n = len - off;
+
+    if (n > GSM_TCP_PBUF_LARGE_SIZE) {
+      n = GSM_TCP_PBUF_LARGE_SIZE;
+    }
+
+    tcp_pbuf_t *pbuf = tcp_pbuf_alloc(n);
+    if (!pbuf) {
+      tcp_pbuf_free_chain(chain);
+      return -1;
+    }
+    memcpy(pbuf->payload, &data[off], n);
+    *tail = pbuf;
+    tail = &pbuf->next;
+    off += n;
+  }
+
+  if (gsm_ppp_tcp_send(sock->gsm, sock->connect_id, chain, true, NULL,
+                       NULL) != 0) {
+    tcp_pbuf_free_chain(chain);
+    return -1;
+  }
+  return 0;
+}
+#endif
+
 tcp_socket_t *tcp_socket_create(gsm_t *gsm, uint8_t connect_id) {
   if (!gsm || connect_id >= GSM_TCP_MAX_SOCKETS) {
     return NULL;
   }
 
-  tcp_socket_t *sock = (tcp_socket_t *)pvPortMalloc(sizeof(tcp_socket_t));
+  tcp_socket_t *sock =
+      HEAP_TRACK(HEAP_TAG_SOCKET, (tcp_socket_t *)pvPortMalloc(sizeof(tcp_socket_t)));
   if (!sock) {
     return NULL;
   }
@@ -43,13 +114,13 @@ tcp_socket_t *tcp_socket_create(gsm_t *gsm, uint8_t connect_id) {
   sock->is_closed_by_peer = false;
   sock->default_recv_timeout = 5000;
 
-  sock->rx_queue = xQueueCreate(10, sizeof(tcp_pbuf_t *));
+  sock->rx_queue = HEAP_TRACK(HEAP_TAG_SOCKET, xQueueCreate(10, sizeof(tcp_pbuf_t *)));
   if (!sock->rx_queue) {
     vPortFree(sock);
     return NULL;
   }
 
-  sock->mutex = xSemaphoreCreateMutex();
+  sock->mutex = HEAP_TRACK(HEAP_TAG_SOCKET, xSemaphoreCreateMutex());
   if (!sock->mutex) {
     vQueueDelete(sock->rx_queue);
     vPortFree(sock);
@@ -67,13 +138,25 @@ int tcp_connect(tcp_socket_t *sock, uint8_t context_id, const char *remote_ip,
     return -1;
   }
 
+#if GSM_PPP_ENABLE
+  (void)context_id;
+  int ret = gsm_ppp_tcp_open(sock->gsm, sock->connect_id, remote_ip,
+                             remote_port, _internal_recv_callback,
+                             _internal_close_callback, timeout_ms);
+#else
   int ret = gsm_tcp_open(sock->gsm, sock->connect_id, context_id, remote_ip,
                          remote_port,
                          0,
                          _internal_recv_callback, _internal_close_callback,
                          NULL);
+#endif
 
   if (ret == 0) {
+    // 이전 연결에서 읽다 남은 데이터는 버린다
+    tcp_pbuf_free(sock->rx_partial);
+    sock->rx_partial = NULL;
+    sock->rx_offset = 0;
+
     if (xSemaphoreTake(sock->mutex, portMAX_DELAY) == pdTRUE) {
       sock->is_connected = true;
       sock->is_closed_by_peer = false;
@@ -93,7 +176,12 @@ int tcp_send(tcp_socket_t *sock, const uint8_t *data, size_t len) {
     return -1;
   }
 
+#if GSM_PPP_ENABLE
+  // ACK 까지 기다리지 않는다 (AT 경로도 SEND OK 는 모뎀 버퍼에 들어간 것까지)
+  int ret = tcp_send_copy(sock, data, len);
+#else
   int ret = gsm_tcp_send(sock->gsm, sock->connect_id, data, len, NULL);
+#endif
 
   if (ret == 0) {
     return (int)len;
@@ -102,6 +190,19 @@ int tcp_send(tcp_socket_t *sock, const uint8_t *data, size_t len) {
   }
 }
 
+int tcp_send_async(tcp_socket_t *sock, tcp_pbuf_t *chain, bool pool,
+                   tcp_sent_cb_t cb, void *ctx) {
+  if (!sock || !chain || !sock->is_connected) {
+    return -1;
+  }
+
+#if GSM_PPP_ENABLE
+  return gsm_ppp_tcp_send(sock->gsm, sock->connect_id, chain, pool, cb, ctx);
+#else
+  return gsm_tcp_send_pbuf(sock->gsm, sock->connect_id, chain, pool, cb, ctx);
+#endif
+}
+
 void tcp_set_recv_timeout(tcp_socket_t *sock, uint32_t timeout_ms) {
   if (!sock) {
     return;
@@ -113,12 +214,13 @@ void tcp_set_recv_timeout(tcp_socket_t *sock, uint32_t timeout_ms) {
   }
 }
 
-int tcp_recv(tcp_socket_t *sock, uint8_t *buf, size_t len,
-             uint32_t timeout_ms) {
-  if (!sock || !buf || len == 0) {
-    return -1;
-  }
-
+/**
+ * @brief rx_queue 에서 pbuf 하나 대기
+ *
+ * @return 1: 수신, 0: 타임아웃, -1: 연결 종료
+ */
+static int tcp_recv_wait(tcp_socket_t *sock, uint32_t timeout_ms,
+                         tcp_pbuf_t **out) {
   if (timeout_ms == 0) {
     if (xSemaphoreTake(sock->mutex, portMAX_DELAY) == pdTRUE) {
       timeout_ms = sock->default_recv_timeout;
@@ -132,23 +234,90 @@ int tcp_recv(tcp_socket_t *sock, uint8_t *buf, size_t len,
       (timeout_ms == 0) ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
 
   tcp_pbuf_t *pbuf = NULL;
-  if (xQueueReceive(sock->rx_queue, &pbuf, timeout_ticks) == pdTRUE) {
-    if (!pbuf) {
-      return -1; 
+  if (xQueueReceive(sock->rx_queue, &pbuf, timeout_ticks) != pdTRUE) {
+    return 0;
+  }
+  if (!pbuf) {
+    return -1;
+  }
+
+#if GSM_PPP_ENABLE
+  // 앱이 가져간 만큼 창을 열고 빈 자리를 채운다
+  gsm_ppp_tcp_recved(sock->gsm, sock->connect_id, pbuf->len);
+  tcp_rx_fill(sock);
+#endif
+
+  *out = pbuf;
+  return 1;
+}
+
+int tcp_recv(tcp_socket_t *sock, uint8_t *buf, size_t len,
+             uint32_t timeout_ms) {
+  if (!sock || !buf || len == 0) {
+    return -1;
+  }
+
+  tcp_pbuf_t *pbuf = sock->rx_partial;
+  size_t offset = sock->rx_offset;
+
+  if (!pbuf) {
+    int ret = tcp_recv_wait(sock, timeout_ms, &pbuf);
+    if (ret == 0) {
+      LOG_ERR("tcp_recv: 타임아웃");
+      return 0;
+    }
+    if (ret < 0) {
+      return -1;
     }
+    offset = 0;
+  }
 
-    size_t copy_len = (pbuf->len < len) ? pbuf->len : len;
-    memcpy(buf, pbuf->payload, copy_len);
+  size_t remain = pbuf->len - offset;
+  size_t copy_len = (remain < len) ? remain : len;
+  dma_copy(buf, &pbuf->payload[offset], copy_len);
 
+  if (copy_len < remain) {
+    // 버퍼보다 큰 pbuf 는 남겨 두고 다음 호출에서 이어서 준다
+    sock->rx_partial = pbuf;
+    sock->rx_offset = offset + copy_len;
+  } else {
+    sock->rx_partial = NULL;
+    sock->rx_offset = 0;
     tcp_pbuf_free(pbuf);
+  }
+
+  return (int)copy_len;
+}
+
+int tcp_recv_pbuf(tcp_socket_t *sock, tcp_pbuf_t **pbuf, uint32_t timeout_ms) {
+  if (!sock || !pbuf) {
+    return -1;
+  }
 
-    return (int)copy_len;
+  *pbuf = NULL;
+
+  tcp_pbuf_t *p = sock->rx_partial;
+  if (p) {
+    // tcp_recv() 로 읽다 남은 부분을 앞으로 당겨서 넘긴다
+    size_t remain = p->len - sock->rx_offset;
+    memmove(p->payload, &p->payload[sock->rx_offset], remain);
+    p->len = remain;
+    p->tot_len = remain;
+    sock->rx_partial = NULL;
+    sock->rx_offset = 0;
   } else {
-    LOG_ERR("tcp_recv: 타임아웃");
-    return 0;
+    int ret = tcp_recv_wait(sock, timeout_ms, &p);
+    if (ret <= 0) {
+      return ret;
+    }
   }
+
+  *pbuf = p;
+  return (int)p->len;
 }
 
+void tcp_recv_release(tcp_pbuf_t *pbuf) { tcp_pbuf_free_chain(pbuf); }
+
 int tcp_close(tcp_socket_t *sock) {
   if (!sock) {
     return -1;
@@ -158,7 +327,11 @@ int tcp_close(tcp_socket_t *sock) {
     return 0;
   }
 
+#if GSM_PPP_ENABLE
+  int ret = gsm_ppp_tcp_close(sock->gsm, sock->connect_id, false);
+#else
   int ret = gsm_tcp_close(sock->gsm, sock->connect_id, NULL);
+#endif
 
   if (xSemaphoreTake(sock->mutex, portMAX_DELAY) == pdTRUE) {
     sock->is_connected = false;
@@ -174,7 +347,11 @@ int tcp_close_force(tcp_socket_t *sock) {
     return -1;
   }
 
+#if GSM_PPP_ENABLE
+  int ret = gsm_ppp_tcp_close(sock->gsm, sock->connect_id, true);
+#else
   int ret = gsm_tcp_close_force(sock->gsm, sock->connect_id);
+#endif
 
   if (xSemaphoreTake(sock->mutex, portMAX_DELAY) == pdTRUE) {
     sock->is_connected = false;
@@ -184,6 +361,28 @@ int tcp_close_force(tcp_socket_t *sock) {
 
   return ret;
 }
+void tcp_set_sink(tcp_socket_t *sock, tcp_sink_t sink, void *ctx) {
+  if (!sock) {
+    return;
+  }
+
+  if (xSemaphoreTake(sock->mutex, portMAX_DELAY) == pdTRUE) {
+    sock->sink = sink;
+    sock->sink_ctx = ctx;
+    xSemaphoreGive(sock->mutex);
+  }
+
+  gsm_tcp_set_sink(sock->gsm, sock->connect_id, sink, ctx);
+}
+
+void tcp_set_access_mode(tcp_socket_t *sock, gsm_tcp_access_t mode) {
+  if (!sock) {
+    return;
+  }
+
+  gsm_tcp_set_access_mode(sock->gsm, sock->connect_id, mode);
+}
+
 void tcp_socket_destroy(tcp_socket_t *sock) {
   if (!sock) {
     return;
@@ -193,6 +392,9 @@ void tcp_socket_destroy(tcp_socket_t *sock) {
     tcp_close(sock);
   }
 
+  tcp_pbuf_free(sock->rx_partial);
+  sock->rx_partial = NULL;
+
   tcp_pbuf_t *pbuf;
   while (xQueueReceive(sock->rx_queue, &pbuf, 0) == pdTRUE) {
     if (pbuf) {
@@ -212,7 +414,7 @@ size_t tcp_available(tcp_socket_t *sock) {
     return 0;
   }
 
-  return uxQueueMessagesWaiting(sock->rx_queue);
+  return uxQueueMessagesWaiting(sock->rx_queue) + (sock->rx_partial ? 1 : 0);
 }
 
 
@@ -226,6 +428,11 @@ static void _internal_recv_callback(uint8_t connect_id) {
     return;
   }
 
+#if GSM_PPP_ENABLE
+  tcp_rx_fill(sock);
+  return;
+#endif
+
   tcp_pbuf_t *pbuf = NULL;
   if (xSemaphoreTake(sock->gsm->tcp.tcp_mutex, portMAX_DELAY) == pdTRUE) {
     pbuf = tcp_pbuf_dequeue(&sock->gsm->tcp.sockets[connect_id]);
@@ -251,12 +458,23 @@ static void _internal_close_callback(uint8_t connect_id) {
     return;
   }
 
+  tcp_sink_t sink = NULL;
+  void *ctx = NULL;
+
   if (xSemaphoreTake(sock->mutex, portMAX_DELAY) == pdTRUE) {
     sock->is_connected = false;
     sock->is_closed_by_peer = true;
+    sink = sock->sink;
+    ctx = sock->sink_ctx;
+    sock->sink = NULL;
     xSemaphoreGive(sock->mutex);
   }
 
+  // sink 모드에서는 rx_queue 를 읽지 않으므로 종료도 sink 로 알린다
+  if (sink) {
+    sink(NULL, 0, ctx);
+  }
+
   tcp_pbuf_t *null_pbuf = NULL;
   xQueueSend(sock->rx_queue, &null_pbuf, 0);
 }
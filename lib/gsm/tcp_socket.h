@@ -43,6 +43,21 @@ int tcp_connect(tcp_socket_t *sock, uint8_t context_id, const char *remote_ip,
  */
 int tcp_send(tcp_socket_t *sock, const uint8_t *data, size_t len);
 
+/**
+ * @brief pbuf 체인 비동기 전송 (SEND OK 를 기다리지 않음)
+ *
+ * gsm_tcp_send_pbuf() 참고. 함께 쌓인 쓰기는 QISEND 하나로 묶여 나간다.
+ *
+ * @param sock 소켓 핸들
+ * @param chain 전송할 pbuf 체인
+ * @param pool true: 완료 후 풀에 반납, false: 완료 콜백까지 호출자가 유지
+ * @param cb 완료 콜백 (NULL 가능)
+ * @param ctx 콜백 인자
+ * @return int 0: 대기열에 들어감, -1: 실패 (체인은 호출자가 정리)
+ */
+int tcp_send_async(tcp_socket_t *sock, tcp_pbuf_t *chain, bool pool,
+                   tcp_sent_cb_t cb, void *ctx);
+
 /**
  * @brief 소켓 기본 수신 타임아웃 설정
  *
@@ -62,9 +77,53 @@ void tcp_set_recv_timeout(tcp_socket_t *sock, uint32_t timeout_ms);
  *
  * @note timeout_ms=0이면 소켓의 기본 timeout 사용
  *       기본값은 tcp_set_recv_timeout()으로 설정 (기본: 5000ms)
+ * @note 받은 pbuf 가 len 보다 크면 나머지는 다음 호출에서 이어서 리턴
  */
 int tcp_recv(tcp_socket_t *sock, uint8_t *buf, size_t len, uint32_t timeout_ms);
 
+/**
+ * @brief TCP 데이터 수신 (블로킹, 복사 없이 pbuf 소유권 전달)
+ *
+ * 받은 pbuf 는 호출한 쪽이 tcp_recv_release() 로 반환한다.
+ * payload 는 pbuf->len 바이트이고 종료 문자는 없다.
+ *
+ * @param sock 소켓 핸들
+ * @param pbuf 수신 pbuf (타임아웃/에러면 NULL)
+ * @param timeout_ms 타임아웃 (ms, 0=소켓 기본값 사용)
+ * @return int 수신된 바이트 수 (0=타임아웃, -1=연결 종료/에러)
+ */
+int tcp_recv_pbuf(tcp_socket_t *sock, tcp_pbuf_t **pbuf, uint32_t timeout_ms);
+
+/**
+ * @brief tcp_recv_pbuf() 로 받은 pbuf (체인) 반환
+ *
+ * @param pbuf 반환할 pbuf (NULL 가능)
+ */
+void tcp_recv_release(tcp_pbuf_t *pbuf);
+
+/**
+ * @brief 수신 데이터를 큐 대신 sink 로 바로 받기
+ *
+ * 설정 후에는 tcp_recv() 로 데이터가 오지 않는다. 상대가 연결을 끊으면
+ * sink(NULL, 0, ctx) 가 한 번 불리고 해제된다. 재연결 후 다시 설정한다.
+ *
+ * @param sock 소켓 핸들
+ * @param sink 전달 콜백 (NULL=해제)
+ * @param ctx 콜백 인자
+ */
+void tcp_set_sink(tcp_socket_t *sock, tcp_sink_t sink, void *ctx);
+
+/**
+ * @brief 수신 방식 설정 (gsm_tcp_access_t)
+ *
+ * 다음 tcp_connect() 부터 적용된다. PUSH 는 조각마다 AT+QIRD 왕복이
+ * 없어 지연이 짧지만 pbuf pool 이 비면 데이터를 버린다.
+ *
+ * @param sock 소켓 핸들
+ * @param mode GSM_TCP_ACCESS_BUFFER 또는 GSM_TCP_ACCESS_PUSH
+ */
+void tcp_set_access_mode(tcp_socket_t *sock, gsm_tcp_access_t mode);
+
 /**
  * @brief TCP 연결 종료
  *
@@ -0,0 +1,165 @@
+#include "init_seq.h"
+#include <string.h>
+
+#ifndef TAG
+#define TAG "INIT_SEQ"
+#endif
+
+#include "log.h"
+
+/* 명령 끝 CR/LF 는 빼고 로그 */
+#define STEP_FMT "%.*s"
+#define STEP_ARG(step) (int)strcspn((step)->cmd ? (step)->cmd : "", "\r\n"), \
+                       ((step)->cmd ? (step)->cmd : "")
+
+static void init_seq_finish(init_seq_t *seq, bool ok) {
+  // done 안에서 다시 시작할 수 있게 먼저 내림
+  seq->running = false;
+  if (seq->ops->done) {
+    seq->ops->done(seq, ok);
+  }
+}
+
+/**
+ * @brief 지금 단계부터 건너뛸 것은 건너뛰고 명령 보내기
+ *
+ * @return false 못 보냄 (호출자가 실패 처리)
+ */
+static bool init_seq_send(init_seq_t *seq) {
+  const init_seq_step_t *step;
+
+  while (seq->idx < seq->count) {
+    step = &seq->steps[seq->idx];
+    if (!step->skip || !step->skip(seq)) {
+      break;
+    }
+    LOG_DEBUG("%s %d/%d skip: " STEP_FMT, seq->name, seq->idx + 1, seq->count,
+              STEP_ARG(step));
+    seq->idx++;
+    seq->attempt = 0;
+  }
+
+  if (seq->idx >= seq->count) {
+    init_seq_finish(seq, true);
+    return true;
+  }
+
+  return seq->ops->send(seq, &seq->steps[seq->idx]);
+}
+
+/**
+ * @brief 보내기 실패나 RETRY 응답: 재시도가 남았으면 다시, 아니면 실패
+ */
+static void init_seq_fail_step(init_seq_t *seq) {
+  for (;;) {
+    const init_seq_step_t *step = &seq->steps[seq->idx];
+
+    if (seq->attempt >= step->retries && step->optional) {
+      LOG_WARN("%s %d/%d failed, continuing: " STEP_FMT, seq->name, seq->idx + 1,
+               seq->count, STEP_ARG(step));
+      seq->idx++;
+      seq->attempt = 0;
+      if (init_seq_send(seq)) {
+        return;
+      }
+      continue;
+    }
+
+    if (seq->attempt >= step->retries) {
+      LOG_ERR("%s %d/%d failed after %d tries: " STEP_FMT, seq->name, seq->idx + 1,
+              seq->count, seq->attempt + 1, STEP_ARG(step));
+      init_seq_finish(seq, false);
+      return;
+    }
+
+    seq->attempt++;
+    LOG_WARN("%s %d/%d retry %d/%d: " STEP_FMT, seq->name, seq->idx + 1, seq->count,
+             seq->attempt, step->retries, STEP_ARG(step));
+
+    if (seq->ops->retry) {
+      seq->ops->retry(seq, step);
+    }
+    if (step->retry_ms && seq->ops->defer && seq->ops->defer(seq, step->retry_ms)) {
+      return;
+    }
+    if (seq->ops->send(seq, step)) {
+      return;
+    }
+  }
+}
+
+bool init_seq_start(init_seq_t *seq, const init_seq_step_t *steps, uint8_t count,
+                    uint8_t first) {
+  if (seq->running) {
+    LOG_WARN("%s already running", seq->name);
+    return false;
+  }
+
+  seq->steps = steps;
+  seq->count = count;
+  seq->idx = first;
+  seq->attempt = 0;
+  seq->running = true;
+
+  LOG_INFO("%s start (%d/%d)", seq->name, first + 1, count);
+
+  if (!init_seq_send(seq)) {
+    LOG_ERR("%s: first command not sent", seq->name);
+    seq->running = false;
+    return false;
+  }
+
+  return true;
+}
+
+void init_seq_result(init_seq_t *seq, bool ok, const void *resp) {
+  const init_seq_step_t *step;
+  init_seq_res_t res;
+
+  if (!seq->running || seq->idx >= seq->count) {
+    return;
+  }
+
+  step = &seq->steps[seq->idx];
+  res = ok ? (step->check ? step->check(seq, resp) : INIT_SEQ_NEXT) : INIT_SEQ_RETRY;
+
+  switch (res) {
+  case INIT_SEQ_NEXT:
+    LOG_INFO("%s %d/%d OK: " STEP_FMT, seq->name, seq->idx + 1, seq->count,
+             STEP_ARG(step));
+    seq->idx++;
+    seq->attempt = 0;
+    if (!init_seq_send(seq)) {
+      init_seq_fail_step(seq);
+    }
+    break;
+
+  case INIT_SEQ_FINISH:
+    LOG_INFO("%s %d/%d OK, done", seq->name, seq->idx + 1, seq->count);
+    init_seq_finish(seq, true);
+    break;
+
+  case INIT_SEQ_FAIL:
+    LOG_ERR("%s %d/%d failed: " STEP_FMT, seq->name, seq->idx + 1, seq->count,
+            STEP_ARG(step));
+    init_seq_finish(seq, false);
+    break;
+
+  case INIT_SEQ_RETRY:
+  default:
+    init_seq_fail_step(seq);
+    break;
+  }
+}
+
+void init_seq_resume(init_seq_t *seq) {
+  if (!seq->running || seq->idx >= seq->count) {
+    return;
+  }
+
+  if (!seq->ops->send(seq, &seq->steps[seq->idx])) {
+    init_seq_fail_step(seq);
+  }
+}
+
+void init_seq_stop(init_seq_t *seq) { seq->running = false; }
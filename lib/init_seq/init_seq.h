@@ -0,0 +1,108 @@
+#ifndef INIT_SEQ_H
+#define INIT_SEQ_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief 표로 적는 명령/응답 초기화 순서
+ *
+ * 단계 (명령, 기대 응답, 타임아웃, 재시도, 건너뛰기 조건) 를 const 표로 두고
+ * 정적 init_seq_t 하나로 돌린다. 명령을 실제로 보내는 것과 응답 판정은
+ * 모듈의 전송층 (ops->send, 응답 콜백) 몫이고, 엔진은 몇 번째 단계인지,
+ * 몇 번째 시도인지와 다음에 할 일만 정한다.
+ *
+ * 응답 콜백에서 init_seq_result() 를 부르면 같은 컨텍스트에서 다음 단계를
+ * 보낸다. 한 순서는 한 번에 하나의 명령만 걸고, 엔진에 잠금은 없으므로
+ * 시작/결과/재개는 모듈이 정한 한 흐름 (TX 태스크 콜백 등) 에서 부른다.
+ */
+
+typedef struct init_seq_s init_seq_t;
+
+/**
+ * @brief 단계 응답 판정 결과
+ */
+typedef enum {
+  INIT_SEQ_NEXT = 0, // 다음 단계
+  INIT_SEQ_RETRY,    // 같은 단계 다시 (재시도를 다 쓰면 실패)
+  INIT_SEQ_FINISH,   // 남은 단계 없이 성공으로 끝
+  INIT_SEQ_FAIL,     // 재시도 없이 실패로 끝
+} init_seq_res_t;
+
+typedef struct {
+  const char *cmd;     // 보낼 명령 (로그 이름 겸, 전송층이 해석)
+  const char *expect;  // 기대 응답 (전송층이 해석, NULL: 응답 없음)
+  uint32_t timeout_ms; // 응답 대기 (0: 전송층 기본)
+  uint8_t retries;     // 실패 뒤 다시 보낼 횟수
+  uint32_t retry_ms;   // 다시 보내기 전 대기 (ops->defer 로, 0: 바로)
+  uint8_t tag;         // 모듈 값 (상태 번호 등)
+  bool optional;       // 재시도를 다 써도 다음 단계로 (조회 등)
+
+  /// true 면 이 단계를 보내지 않고 다음으로 (NULL: 항상 보냄)
+  bool (*skip)(init_seq_t *seq);
+  /// 성공 응답 판정 (NULL: INIT_SEQ_NEXT), resp 는 전송층이 넘긴 값
+  init_seq_res_t (*check)(init_seq_t *seq, const void *resp);
+} init_seq_step_t;
+
+typedef struct {
+  /// 단계 명령 보내기 시작, 결과는 init_seq_result() 로 (false: 못 보냄)
+  bool (*send)(init_seq_t *seq, const init_seq_step_t *step);
+  /// 같은 단계를 다시 보내기 전 (NULL 가능)
+  void (*retry)(init_seq_t *seq, const init_seq_step_t *step);
+  /// retry_ms 뒤 init_seq_resume() 예약 (NULL 이거나 false 면 바로 보냄)
+  bool (*defer)(init_seq_t *seq, uint32_t ms);
+  /// 끝 (실패면 init_seq_step() 이 실패한 단계)
+  void (*done)(init_seq_t *seq, bool ok);
+} init_seq_ops_t;
+
+struct init_seq_s {
+  const char *name; // 로그용
+  const init_seq_ops_t *ops;
+  void *user;
+
+  /* 엔진 상태 */
+  const init_seq_step_t *steps;
+  uint8_t count;
+  uint8_t idx;
+  uint8_t attempt; // 이 단계의 재시도 번호 (0: 처음)
+  volatile bool running;
+};
+
+#define INIT_SEQ_INIT(name, ops, user) {(name), (ops), (user), NULL, 0, 0, 0, false}
+
+#define INIT_SEQ_COUNT(steps) ((uint8_t)(sizeof(steps) / sizeof((steps)[0])))
+
+/**
+ * @brief first 번째 단계부터 시작
+ *
+ * @return false 이미 도는 중이거나 첫 명령을 못 보냄 (done 은 안 불림)
+ */
+bool init_seq_start(init_seq_t *seq, const init_seq_step_t *steps, uint8_t count,
+                    uint8_t first);
+
+/**
+ * @brief 지금 단계의 응답 (전송층 콜백에서)
+ *
+ * @param[in] ok 전송층 판정 (OK/ERROR, 타임아웃이면 false)
+ * @param[in] resp step->check 로 넘길 값 (파싱 결과 등, NULL 가능)
+ */
+void init_seq_result(init_seq_t *seq, bool ok, const void *resp);
+
+/**
+ * @brief defer 로 미룬 재시도 보내기
+ */
+void init_seq_resume(init_seq_t *seq);
+
+/**
+ * @brief 멈춤 (done 은 안 불림, 걸린 응답은 무시)
+ */
+void init_seq_stop(init_seq_t *seq);
+
+static inline const init_seq_step_t *init_seq_step(const init_seq_t *seq) {
+  return seq->idx < seq->count ? &seq->steps[seq->idx] : NULL;
+}
+
+static inline bool init_seq_running(const init_seq_t *seq) { return seq->running; }
+
+#endif
@@ -0,0 +1,388 @@
+#include "log.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "rtos_static.h"
+#include "SEGGER_RTT.h"
+#include <stdarg.h>
+#include <stdbool.h>
+#include <string.h>
+
+#if (LOG_RING_SLOTS & (LOG_RING_SLOTS - 1)) != 0
+#error "LOG_RING_SLOTS must be a power of two"
+#endif
+
+#define LOG_RTT_CHANNEL 0
+#define LOG_POLL_MS 10   // 예약만 되고 아직 쓰는 중인 슬롯 재확인
+#define LOG_STALL_MS 100 // RTT 버퍼가 가득 참 (호스트가 안 읽음)
+#define LOG_LINE_MAX (LOG_MSG_MAX + 48) // 머리말 + 색상 코드
+
+typedef struct {
+  uint32_t seq; // 다 쓰면 예약 번호 + 1 (release)
+  uint32_t tick;
+  const char *tag;
+  uint8_t level;
+  uint16_t len;
+  char text[LOG_MSG_MAX];
+} log_slot_t;
+
+// 약 4KB, CCM 예산이 빠듯해서 SRAM
+static log_slot_t log_ring[LOG_RING_SLOTS];
+static uint32_t log_head;    // 다음 예약 번호 (생산자들이 CAS)
+static uint32_t log_tail;    // 다음에 내보낼 번호 (log 태스크만 씀)
+static uint32_t log_dropped; // 링이 가득 차서 버린 줄
+
+RTOS_STATIC_TASK(log_task, 256);
+static TaskHandle_t log_task_handle;
+static uint32_t log_parked; // log 태스크가 알림을 기다리는 중 (tickless 에서 안 깨어나게)
+static log_mirror_t log_mirror;
+
+/* 실행 중 레벨 규칙 (쓰는 쪽은 명령 태스크, 읽는 쪽은 아무 곳이나) */
+static struct {
+  char name[LOG_RULE_NAME_MAX];
+  uint8_t level;
+  bool used;
+} log_rules[LOG_RULE_MAX];
+static uint8_t log_default_level = LOG_LEVEL_DEBUG;
+static uint8_t log_cap = LOG_LEVEL_DEBUG;
+volatile uint32_t log_level_gen = 1;
+
+/**
+ * @brief 규칙이 tag 에 맞으면 맞은 길이 (정확히 맞으면 가장 김), 아니면 -1
+ */
+static int log_rule_match(const char *rule, const char *tag) {
+  size_t n = strlen(rule);
+
+  if (n > 0 && rule[n - 1] == '*') {
+    return strncmp(rule, tag, n - 1) == 0 ? (int)n - 1 : -1;
+  }
+  return strcmp(rule, tag) == 0 ? LOG_RULE_NAME_MAX : -1;
+}
+
+void log_module_refresh(log_module_t *m) {
+  UBaseType_t saved = taskENTER_CRITICAL_FROM_ISR();
+  uint8_t level = log_default_level;
+  int best = -1;
+
+  for (int i = 0; i < LOG_RULE_MAX; i++) {
+    int len;
+
+    if (!log_rules[i].used) {
+      continue;
+    }
+    len = log_rule_match(log_rules[i].name, m->tag);
+    if (len > best) {
+      best = len;
+      level = log_rules[i].level;
+    }
+  }
+
+  m->level = level < log_cap ? level : log_cap;
+  m->gen = log_level_gen;
+  taskEXIT_CRITICAL_FROM_ISR(saved);
+}
+
+bool log_set_level(const char *pattern, uint8_t level) {
+  int slot = -1;
+  bool ok = true;
+
+  if (!pattern || level > LOG_LEVEL_DEBUG || strlen(pattern) >= LOG_RULE_NAME_MAX) {
+    return false;
+  }
+
+  taskENTER_CRITICAL();
+  if (strcmp(pattern, "*") == 0) {
+    log_default_level = level;
+    memset(log_rules, 0, sizeof(log_rules));
+  } else {
+    for (int i = 0; i < LOG_RULE_MAX; i++) {
+      if (log_rules[i].used && strcmp(log_rules[i].name, pattern) == 0) {
+        slot = i;
+        break;
+      }
+      if (!log_rules[i].used && slot < 0) {
+        slot = i;
+      }
+    }
+
+    if (slot >= 0) {
+      strcpy(log_rules[slot].name, pattern);
+      log_rules[slot].level = level;
+      log_rules[slot].used = true;
+    } else {
+      ok = false;
+    }
+  }
+  log_level_gen++;
+  taskEXIT_CRITICAL();
+
+  return ok;
+}
+
+void log_set_cap(uint8_t level) {
+  taskENTER_CRITICAL();
+  if (log_cap != level) {
+    log_cap = level;
+    log_level_gen++;
+  }
+  taskEXIT_CRITICAL();
+}
+
+size_t log_format_levels(char *buf, size_t size) {
+  __typeof__(log_rules) rules;
+  uint8_t cap;
+  uint8_t def;
+  size_t pos;
+  int n;
+
+  taskENTER_CRITICAL();
+  memcpy(rules, log_rules, sizeof(rules));
+  def = log_default_level;
+  cap = log_cap;
+  taskEXIT_CRITICAL();
+
+  n = snprintf(buf, size, "+LOGLV,*=%u", (unsigned)def);
+  pos = n < 0 ? size : (size_t)n;
+  for (int i = 0; i < LOG_RULE_MAX && pos < size; i++) {
+    if (rules[i].used) {
+      n = snprintf(&buf[pos], size - pos, ",%s=%u", rules[i].name,
+                   (unsigned)rules[i].level);
+      pos = n < 0 ? size : pos + n;
+    }
+  }
+  if (cap < LOG_LEVEL_DEBUG && pos < size) {
+    n = snprintf(&buf[pos], size - pos, ",cap=%u", (unsigned)cap);
+    pos = n < 0 ? size : pos + n;
+  }
+
+  if (pos >= size) {
+    return 0;
+  }
+  n = snprintf(&buf[pos], size - pos, "\n\r");
+  if (n < 0 || (size_t)n >= size - pos) {
+    return 0;
+  }
+
+  return pos + n;
+}
+
+/**
+ * @brief 슬롯 하나 예약 (lock-free, ISR 에서도 됨)
+ *
+ * @return NULL 이면 링이 가득 참 (버린 수만 셈)
+ */
+static log_slot_t *log_reserve(uint32_t *seq) {
+  uint32_t head = __atomic_load_n(&log_head, __ATOMIC_RELAXED);
+
+  do {
+    if (head - __atomic_load_n(&log_tail, __ATOMIC_ACQUIRE) >= LOG_RING_SLOTS) {
+      __atomic_add_fetch(&log_dropped, 1, __ATOMIC_RELAXED);
+      return NULL;
+    }
+  } while (!__atomic_compare_exchange_n(&log_head, &head, head + 1, true,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_RELAXED));
+
+  *seq = head;
+  return &log_ring[head & (LOG_RING_SLOTS - 1)];
+}
+
+static void log_commit(log_slot_t *slot, uint32_t seq, uint8_t level,
+                       const char *tag, int len) {
+  if (len < 0) {
+    len = 0;
+  } else if (len >= LOG_MSG_MAX) {
+    len = LOG_MSG_MAX - 1;
+  }
+
+  slot->tick = HAL_GetTick();
+  slot->tag = tag;
+  slot->level = level;
+  slot->len = (uint16_t)len;
+  __atomic_store_n(&slot->seq, seq + 1, __ATOMIC_RELEASE);
+
+  // 잠든 log 태스크만 한 번 깨움 (돌고 있으면 알아서 가져감)
+  if (__atomic_exchange_n(&log_parked, 0, __ATOMIC_SEQ_CST) && log_task_handle) {
+    if (xPortIsInsideInterrupt()) {
+      vTaskNotifyGiveFromISR(log_task_handle, NULL);
+    } else {
+      xTaskNotifyGive(log_task_handle);
+    }
+  }
+}
+
+void log_write(uint8_t level, const char *tag, const char *fmt, ...) {
+  uint32_t seq;
+  log_slot_t *slot = log_reserve(&seq);
+  va_list ap;
+  int n;
+
+  if (!slot) {
+    return;
+  }
+
+  va_start(ap, fmt);
+  n = vsnprintf(slot->text, LOG_MSG_MAX, fmt, ap);
+  va_end(ap);
+
+  log_commit(slot, seq, level, tag, n);
+}
+
+void log_write_hex(const char *tag, const char *prefix, const void *data, size_t len) {
+  const uint8_t *d = data;
+  size_t show = len > LOG_RAW_MAX ? LOG_RAW_MAX : len;
+  uint32_t seq;
+  log_slot_t *slot = log_reserve(&seq);
+  int pos;
+
+  if (!slot) {
+    return;
+  }
+
+  pos = snprintf(slot->text, LOG_MSG_MAX, "%s[%u]:", prefix, (unsigned)len);
+  for (size_t i = 0; i < show && pos > 0 && pos < LOG_MSG_MAX - 4; i++) {
+    pos += snprintf(&slot->text[pos], LOG_MSG_MAX - pos, " %02X", d[i]);
+  }
+  if (show < len && pos > 0 && pos < LOG_MSG_MAX - 4) {
+    pos += snprintf(&slot->text[pos], LOG_MSG_MAX - pos, " ..");
+  }
+
+  log_commit(slot, seq, LOG_LEVEL_DEBUG, tag, pos);
+}
+
+void log_write_raw(const char *tag, const char *prefix, const void *data, size_t len) {
+  const uint8_t *d = data;
+  size_t show = len > LOG_RAW_MAX ? LOG_RAW_MAX : len;
+  uint32_t seq;
+  log_slot_t *slot = log_reserve(&seq);
+  int pos;
+
+  if (!slot) {
+    return;
+  }
+
+  pos = snprintf(slot->text, LOG_MSG_MAX, "%s[%u]", prefix, (unsigned)len);
+  for (size_t i = 0; i < show && pos > 0 && pos < LOG_MSG_MAX - 5; i++) {
+    uint8_t c = d[i];
+
+    if (c == '\r' || c == '\n' || (c >= 0x20 && c < 0x7F)) {
+      slot->text[pos++] = (char)c;
+      slot->text[pos] = '\0';
+    } else {
+      pos += snprintf(&slot->text[pos], LOG_MSG_MAX - pos, "<%02X>", c);
+    }
+  }
+
+  log_commit(slot, seq, LOG_LEVEL_DEBUG, tag, pos);
+}
+
+/**
+ * @brief RTT 와 mirror 로 (어느 쪽에도 못 보냈으면 false, 다음 poll 에 다시)
+ *
+ * 디버거가 없으면 RTT 가 차 있으므로 mirror 가 받았으면 보낸 것으로 친다.
+ */
+static bool log_out(const char *line, size_t n) {
+  log_mirror_t mirror = __atomic_load_n(&log_mirror, __ATOMIC_ACQUIRE);
+  bool sent = mirror && mirror(line, n);
+
+  if (SEGGER_RTT_GetAvailWriteSpace(LOG_RTT_CHANNEL) < (unsigned)n) {
+    return sent;
+  }
+
+  SEGGER_RTT_Write(LOG_RTT_CHANNEL, line, (unsigned)n);
+  return true;
+}
+
+/**
+ * @brief 한 줄을 RTT (와 mirror) 로 (자리가 없으면 false, 다음 poll 에 다시)
+ */
+static bool log_emit(const log_slot_t *slot) {
+  static const char level_char[] = {'-', 'E', 'W', 'I', 'D'};
+  static const char *const level_color[] = {"", COLOR_RED, COLOR_YELLOW, "",
+                                            COLOR_GREEN};
+  char line[LOG_LINE_MAX];
+  uint8_t lv = slot->level <= LOG_LEVEL_DEBUG ? slot->level : LOG_LEVEL_DEBUG;
+  const char *reset = level_color[lv][0] ? COLOR_RESET : "";
+  int n;
+
+  n = snprintf(line, sizeof(line), "%s[%u][%c][%s]%.*s%s\r\n", level_color[lv],
+               (unsigned)slot->tick, level_char[lv], slot->tag, (int)slot->len,
+               slot->text, reset);
+  if (n < 0) {
+    return true;
+  }
+  if ((size_t)n >= sizeof(line)) {
+    n = sizeof(line) - 1;
+  }
+
+  return log_out(line, (size_t)n);
+}
+
+static void log_task(void *pvParameter) {
+  uint32_t reported = 0;
+
+  (void)pvParameter;
+
+  for (;;) {
+    uint32_t tail = log_tail;
+    bool stalled = false;
+
+    while (tail != __atomic_load_n(&log_head, __ATOMIC_ACQUIRE)) {
+      log_slot_t *slot = &log_ring[tail & (LOG_RING_SLOTS - 1)];
+
+      // 예약만 되고 아직 쓰는 중
+      if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != tail + 1) {
+        break;
+      }
+      if (!log_emit(slot)) {
+        stalled = true;
+        break;
+      }
+
+      tail++;
+      __atomic_store_n(&log_tail, tail, __ATOMIC_RELEASE);
+    }
+
+    uint32_t dropped = __atomic_load_n(&log_dropped, __ATOMIC_RELAXED);
+    if (dropped != reported) {
+      char line[48];
+      int n = snprintf(line, sizeof(line), COLOR_YELLOW "[log] %lu dropped" COLOR_RESET "\r\n",
+                       (unsigned long)(dropped - reported));
+
+      if (n > 0 && log_out(line, (size_t)n)) {
+        reported = dropped;
+      } else {
+        stalled = true;
+      }
+    }
+
+    if (stalled) {
+      vTaskDelay(pdMS_TO_TICKS(LOG_STALL_MS));
+      continue;
+    }
+
+    // 링이 비었으면 다음 commit 의 알림까지 잠듦. parked 를 먼저 세우고
+    // head 를 다시 봐야 그 사이에 들어온 줄을 놓치지 않는다.
+    __atomic_store_n(&log_parked, 1, __ATOMIC_SEQ_CST);
+    if (tail == __atomic_load_n(&log_head, __ATOMIC_SEQ_CST)) {
+      ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    } else {
+      vTaskDelay(pdMS_TO_TICKS(LOG_POLL_MS));
+    }
+  }
+}
+
+void log_init(void) {
+  if (log_task_handle) {
+    return;
+  }
+
+  log_task_handle = RTOS_TASK_CREATE_STATIC(log_task, log_task, "log", NULL,
+                                            tskIDLE_PRIORITY + 1);
+}
+
+void log_set_mirror(log_mirror_t fn) {
+  __atomic_store_n(&log_mirror, fn, __ATOMIC_RELEASE);
+}
+
+uint32_t log_get_dropped(void) {
+  return __atomic_load_n(&log_dropped, __ATOMIC_RELAXED);
+}
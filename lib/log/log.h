@@ -2,6 +2,9 @@
 #define LOG_H
 
 #include "stm32f4xx_hal.h"
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 
 #ifndef TAG
@@ -20,47 +23,124 @@
 #define LOG_LEVEL_INFO 3
 #define LOG_LEVEL_DEBUG 4
 
+/**
+ * @brief 컴파일 시 레벨
+ *
+ * LOG_LEVEL_DEFAULT 는 빌드 전체 기본값, 파일마다 log.h 앞에 LOG_LEVEL 을
+ * 정의하면 그 모듈만 바꿀 수 있다. 이 레벨보다 높은 로그는 코드와 문자열이
+ * 생기지 않는다.
+ */
+#ifndef LOG_LEVEL_DEFAULT
+#define LOG_LEVEL_DEFAULT LOG_LEVEL_NONE
+#endif
+
 #ifndef LOG_LEVEL
-	#define LOG_LEVEL LOG_LEVEL_NONE
+	#define LOG_LEVEL LOG_LEVEL_DEFAULT
+#endif
+
+/**
+ * @brief 지연 로거
+ *
+ * LOG_* 는 호출한 곳에서 한 줄을 lock-free 링 슬롯에 포맷만 하고 바로
+ * 돌아온다 (ISR 에서도 됨). 낮은 우선순위 log 태스크가 링을 SEGGER RTT
+ * 채널 0 으로 내보낸다. 링이 가득 차면 기다리지 않고 버린 수를 센다.
+ */
+#define LOG_RING_SLOTS 32  // 링 슬롯 수 (2 의 거듭제곱)
+#define LOG_MSG_MAX 120    // 한 줄 최대 길이 (넘으면 잘림)
+#define LOG_RAW_MAX 48     // HEX/RAW 로 보여 줄 최대 바이트
+
+/**
+ * @brief log 태스크 시작 (그 전에 쌓인 줄은 링에 남아 있다가 나감)
+ */
+void log_init(void);
+
+/**
+ * @brief RTT 말고도 줄을 받을 곳 (USB 등, log 태스크에서 불림)
+ *
+ * 블로킹 없이 한 줄을 통째로 넣거나 false. NULL 이면 끔.
+ */
+typedef bool (*log_mirror_t)(const char *line, size_t len);
+
+void log_set_mirror(log_mirror_t fn);
+
+/**
+ * @brief 링이 가득 차서 버린 줄 수 (누적)
+ */
+uint32_t log_get_dropped(void);
+
+/**
+ * @brief 실행 중 TAG 별 레벨 (컴파일된 로그만 더 걸러냄)
+ *
+ * 규칙은 "GSM" 처럼 정확한 TAG 또는 "GSM*" 처럼 앞부분이고, 여럿이 맞으면
+ * 긴 쪽이 이긴다. 맞는 규칙이 없으면 기본 레벨 ("*", 처음엔 DEBUG).
+ * 파일마다 있는 log_module 이 결과를 캐시하고 규칙이 바뀌면 다시 찾는다.
+ */
+#define LOG_RULE_MAX 8
+#define LOG_RULE_NAME_MAX 16
+
+typedef struct {
+  const char *tag;
+  uint32_t gen;  // log_level_gen 과 다르면 다시 찾음
+  uint8_t level;
+} log_module_t;
+
+extern volatile uint32_t log_level_gen;
+
+void log_module_refresh(log_module_t *m);
+
+static inline uint8_t log_module_level(log_module_t *m) {
+  if (m->gen != log_level_gen) {
+    log_module_refresh(m);
+  }
+  return m->level;
+}
+
+/**
+ * @brief 규칙 추가/변경 ("*" 이면 기본 레벨을 바꾸고 규칙을 모두 지움)
+ *
+ * @return false 이름이 너무 길거나 규칙 자리가 없음, 레벨이 범위 밖
+ */
+bool log_set_level(const char *pattern, uint8_t level);
+
+/**
+ * @brief 규칙과 상관없이 모든 TAG 의 상한 (과부하 때 DEBUG 끄기, 처음엔 DEBUG)
+ *
+ * 규칙은 그대로 두므로 상한을 되돌리면 원래 레벨로 돌아간다.
+ */
+void log_set_cap(uint8_t level);
+
+/**
+ * @brief 기본 레벨과 규칙 목록 (+LOGLV,*=3,GSM*=4\n\r, 상한이 걸려 있으면 ,cap=3)
+ */
+size_t log_format_levels(char *buf, size_t size);
+
+void log_write(uint8_t level, const char *tag, const char *fmt, ...)
+    __attribute__((format(printf, 3, 4)));
+void log_write_hex(const char *tag, const char *prefix, const void *data, size_t len);
+void log_write_raw(const char *tag, const char *prefix, const void *data, size_t len);
+
+#if LOG_LEVEL > LOG_LEVEL_NONE
+static log_module_t log_module __attribute__((unused)) = {TAG, 0, 0};
 #endif
 
+#define LOG_ENABLED(lv) ((lv) <= log_module_level(&log_module))
+
 #if LOG_LEVEL >= LOG_LEVEL_DEBUG
 #define LOG_DEBUG(fmt, ...)                                                    \
   do {                                                                         \
-    printf(COLOR_GREEN "[%u][D][%s]" fmt COLOR_RESET "\r\n",                   \
-           (unsigned)HAL_GetTick(), TAG, ##__VA_ARGS__);                       \
+    if (LOG_ENABLED(LOG_LEVEL_DEBUG))                                          \
+      log_write(LOG_LEVEL_DEBUG, TAG, fmt, ##__VA_ARGS__);                     \
   } while (0)
-
 #define LOG_DEBUG_HEX(prefix, data, len)                                       \
   do {                                                                         \
-    printf(COLOR_GREEN "[%u][D][%s]%s[%u]:", (unsigned)HAL_GetTick(), TAG,     \
-           prefix, (unsigned)len);                                             \
-    for (size_t i = 0; i < (len); i++) {                                       \
-      printf(" %02X", ((uint8_t *)(data))[i]);                                 \
-    }                                                                          \
-    printf(COLOR_RESET "\r\n");                                                \
+    if (LOG_ENABLED(LOG_LEVEL_DEBUG))                                          \
+      log_write_hex(TAG, prefix, data, len);                                   \
   } while (0)
-
 #define LOG_DEBUG_RAW(prefix, data, len)                                       \
   do {                                                                         \
-    printf(COLOR_GREEN "[%u][D][%s]%s[%u]", (unsigned)HAL_GetTick(), TAG,      \
-           prefix, (unsigned)len);                                             \
-    for (size_t i = 0; i < (len); i++) {                                       \
-      uint8_t c = ((uint8_t *)(data))[i];                                      \
-      if (c == '\r') {                                                         \
-        printf("\r");                                                          \
-        continue;                                                              \
-      } else if (c == '\n') {                                                  \
-        printf("\n");                                                          \
-        continue;                                                              \
-      } else if (c >= 0x20 && c < 0x7F)                                        \
-        printf("%c", c);                                                       \
-      else                                                                     \
-        printf("<%02X>", c);                                                   \
-    }                                                                          \
-    printf(COLOR_RESET "\r\n");                                                \
+    if (LOG_ENABLED(LOG_LEVEL_DEBUG))                                          \
+      log_write_raw(TAG, prefix, data, len);                                   \
   } while (0)
-
 #else
 #define LOG_DEBUG(fmt, ...)
 #define LOG_DEBUG_HEX(prefix, data, len)
@@ -70,10 +150,9 @@
 #if LOG_LEVEL >= LOG_LEVEL_INFO
 #define LOG_INFO(fmt, ...)                                                     \
   do {                                                                         \
-    printf("[%u][I][%s]" fmt "\r\n", (unsigned)HAL_GetTick(), TAG,             \
-           ##__VA_ARGS__);                                                     \
+    if (LOG_ENABLED(LOG_LEVEL_INFO))                                           \
+      log_write(LOG_LEVEL_INFO, TAG, fmt, ##__VA_ARGS__);                      \
   } while (0)
-
 #else
 #define LOG_INFO(fmt, ...)
 #endif
@@ -81,10 +160,9 @@
 #if LOG_LEVEL >= LOG_LEVEL_WARNING
 #define LOG_WARN(fmt, ...)                                                     \
   do {                                                                         \
-    printf(COLOR_YELLOW "[%u][W][%s]" fmt COLOR_RESET "\r\n",                  \
-           (unsigned)HAL_GetTick(), TAG, ##__VA_ARGS__);                       \
+    if (LOG_ENABLED(LOG_LEVEL_WARNING))                                        \
+      log_write(LOG_LEVEL_WARNING, TAG, fmt, ##__VA_ARGS__);                   \
   } while (0)
-
 #else
 #define LOG_WARN(fmt, ...)
 #endif
@@ -92,10 +170,9 @@
 #if LOG_LEVEL >= LOG_LEVEL_ERROR
 #define LOG_ERR(fmt, ...)                                                      \
   do {                                                                         \
-    printf(COLOR_RED "[%u][E][%s]" fmt COLOR_RESET "\r\n",                     \
-           (unsigned)HAL_GetTick(), TAG, ##__VA_ARGS__);                       \
+    if (LOG_ENABLED(LOG_LEVEL_ERROR))                                          \
+      log_write(LOG_LEVEL_ERROR, TAG, fmt, ##__VA_ARGS__);                     \
   } while (0)
-
 #else
 #define LOG_ERR(fmt, ...)
 #endif
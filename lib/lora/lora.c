@@ -10,3 +10,32 @@ void lora_init(lora_t* handle)
 {
 
 }
+
+uint32_t lora_calc_toa_us(const lora_modem_params_t *params, size_t payload_len)
+{
+	static const uint32_t bw_hz[] = { 125000, 250000, 500000 };
+
+	if (!params || params->sf < 6 || params->sf > 12 || params->bw > 2 ||
+	    params->cr < 1 || params->cr > 4)
+	{
+		return 0;
+	}
+
+	int32_t sf = params->sf;
+	uint32_t t_sym_us = (1UL << sf) * 1000000UL / bw_hz[params->bw];
+	int32_t de = (t_sym_us >= 16000) ? 1 : 0;
+
+	// payloadSymbNb = 8 + max(ceil((8PL - 4SF + 28 + 16CRC - 20IH) / 4(SF - 2DE)) * (CR + 4), 0)
+	int32_t num = 8 * (int32_t)payload_len - 4 * sf + 28 + 16;
+	int32_t den = 4 * (sf - 2 * de);
+	int32_t payload_sym = 8;
+	if (num > 0)
+	{
+		payload_sym += ((num + den - 1) / den) * (params->cr + 4);
+	}
+
+	// preamble: (n + 4.25) 심볼
+	uint32_t preamble_us = ((uint32_t)params->preamble * 4 + 17) * t_sym_us / 4;
+
+	return preamble_us + (uint32_t)payload_sym * t_sym_us;
+}
@@ -2,6 +2,8 @@
 #define LORA_H
 
 #include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
 
 typedef struct {
   int (*init)(void);
@@ -10,14 +12,40 @@ typedef struct {
   int (*reset)(void);
   int (*send)(const char *data, size_t len);
   int (*recv)(char *buf, size_t len);
+  int (*set_baudrate)(uint32_t baudrate);
 } lora_hal_ops_t;
 
+struct lora_radio_s;
+
 typedef struct
 {
 	const lora_hal_ops_t *ops;
+	struct lora_radio_s *radio; // SPI 무선칩 (lora_radio.h), NULL 이면 ops 의 AT 모듈
 }lora_t;
 
+/**
+ * @brief LoRa 변조 설정 (RAK AT+set_config=lorap2p 값 그대로)
+ */
+typedef struct
+{
+	uint8_t sf;        // Spreading Factor (7~12)
+	uint8_t bw;        // Bandwidth (0:125kHz, 1:250kHz, 2:500kHz)
+	uint8_t cr;        // Coding Rate (1:4/5 ~ 4:4/8)
+	uint16_t preamble; // Preamble 길이 (심볼)
+}lora_modem_params_t;
+
 void lora_init(lora_t* handle);
 
+/**
+ * @brief LoRa 패킷 Time on Air (Semtech SX127x 데이터시트 공식)
+ *
+ * explicit header, CRC on, 심볼 시간 16ms 이상이면 low data rate optimize 적용
+ *
+ * @param[in] params 변조 설정
+ * @param[in] payload_len 무선으로 나가는 payload 바이트 수
+ * @return uint32_t Time on Air (us), 설정이 잘못되면 0
+ */
+uint32_t lora_calc_toa_us(const lora_modem_params_t *params, size_t payload_len);
+
 
 #endif
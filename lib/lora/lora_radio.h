@@ -0,0 +1,93 @@
+#ifndef LORA_RADIO_H
+#define LORA_RADIO_H
+
+#include "lora.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief SPI 로 직접 붙인 Semtech LoRa 칩 공통 인터페이스
+ *
+ * RAK 모듈의 AT 펌웨어 대신 칩을 직접 다룬다. 바이너리 payload 를 그대로
+ * FIFO 에 쓰고 (HEX 변환 없음, 최대 LORA_RADIO_PAYLOAD_MAX), 송신/수신
+ * 완료와 CAD 결과는 DIO 인터럽트로 안다.
+ *
+ * DIO 인터럽트에서는 태스크만 깨우고, 태스크가 ops->irq() 를 불러 칩의
+ * IRQ 상태를 읽는다. 이벤트 콜백은 그 안에서 불린다. SPI 는 한 태스크
+ * (또는 호출자가 잠금) 에서만 쓴다.
+ *
+ * 변조 값은 RAK lorap2p 설정과 같은 lora_modem_params_t 를 쓰고, 헤더는
+ * explicit, CRC 켬, sync word 는 private (0x12) 로 RAK 모듈과 무선으로
+ * 섞어 쓸 수 있다.
+ */
+#define LORA_RADIO_PAYLOAD_MAX 255
+
+typedef struct lora_radio_s lora_radio_t;
+
+typedef enum {
+  LORA_RADIO_EVT_TX_DONE = 0,
+  LORA_RADIO_EVT_RX_DONE,  ///< pkt 유효
+  LORA_RADIO_EVT_RX_ERROR, ///< CRC/헤더 오류 (수신은 계속)
+  LORA_RADIO_EVT_CAD_CLEAR,
+  LORA_RADIO_EVT_CAD_BUSY, ///< 채널에서 LoRa preamble 감지
+} lora_radio_evt_t;
+
+typedef struct {
+  const uint8_t *data; ///< 드라이버 버퍼 (콜백 안에서만 유효)
+  uint8_t len;
+  int16_t rssi; ///< dBm
+  int16_t snr;  ///< dB
+} lora_radio_pkt_t;
+
+typedef void (*lora_radio_cb_t)(void *user, lora_radio_evt_t evt,
+                                const lora_radio_pkt_t *pkt);
+
+/**
+ * @brief 보드 쪽 SPI/GPIO (lora_port.c)
+ */
+typedef struct {
+  /// NSS 를 내리고 len byte 주고받은 뒤 올림 (rx NULL 가능)
+  int (*xfer)(const uint8_t *tx, uint8_t *rx, size_t len);
+  /// NSS 를 내린 채 헤더 뒤에 data 를 이어서 씀/읽음 (tx NULL 이면 0 송신)
+  int (*xfer2)(const uint8_t *hdr, size_t hdr_len, const uint8_t *tx,
+               uint8_t *rx, size_t len);
+  void (*reset)(bool assert); ///< NRESET (true: 리셋 중)
+  bool (*busy)(void);         ///< SX126x BUSY (SX127x 는 NULL)
+  void (*delay_ms)(uint32_t ms);
+} lora_radio_bus_t;
+
+typedef struct {
+  int (*init)(lora_radio_t *r);
+  /// 주파수 [Hz], 변조, 송신 출력 [dBm] (대기 상태에서)
+  int (*config)(lora_radio_t *r, uint32_t freq, const lora_modem_params_t *mp,
+                int8_t power);
+  /// 송신 시작, 끝나면 LORA_RADIO_EVT_TX_DONE 후 대기 상태
+  int (*send)(lora_radio_t *r, const uint8_t *data, size_t len);
+  /// 연속 수신 시작
+  int (*receive)(lora_radio_t *r);
+  /// CAD 한 번, 결과는 CAD_CLEAR/CAD_BUSY 후 대기 상태
+  int (*cad)(lora_radio_t *r);
+  int (*standby)(lora_radio_t *r);
+  /// 수신 중 순간 RSSI [dBm] (LBT 용, receive 뒤에 읽음, 없으면 NULL)
+  int (*rssi)(lora_radio_t *r, int16_t *dbm);
+  /// DIO 인터럽트 뒤 태스크에서: IRQ 상태 읽고 이벤트 콜백
+  void (*irq)(lora_radio_t *r);
+} lora_radio_ops_t;
+
+struct lora_radio_s {
+  const lora_radio_ops_t *ops;
+  const lora_radio_bus_t *bus;
+  lora_radio_cb_t cb;
+  void *user;
+
+  bool rx_cont;      ///< 연속 수신 중 (송신/CAD 뒤 다시 켜지 않음, 호출자 몫)
+  uint8_t sf;        ///< 지금 SF (CAD 설정용)
+  uint16_t preamble; ///< 지금 preamble (SX126x 는 송신마다 PacketParams 를 씀)
+  uint32_t tx_count;
+  uint32_t rx_count;
+  uint32_t rx_err;
+  uint8_t buf[LORA_RADIO_PAYLOAD_MAX];
+};
+
+#endif
@@ -0,0 +1,378 @@
+#include "sx126x.h"
+
+#ifndef TAG
+#define TAG "SX126X"
+#endif
+
+#include "log.h"
+
+// 명령 (SX1261/2 데이터시트 13 장)
+#define SX126X_SET_STANDBY 0x80
+#define SX126X_SET_TX 0x83
+#define SX126X_SET_RX 0x82
+#define SX126X_SET_CAD 0xC5
+#define SX126X_SET_REGULATOR 0x96
+#define SX126X_CALIBRATE 0x89
+#define SX126X_CALIBRATE_IMAGE 0x98
+#define SX126X_SET_PA_CONFIG 0x95
+#define SX126X_SET_DIO_IRQ 0x08
+#define SX126X_GET_IRQ_STATUS 0x12
+#define SX126X_CLR_IRQ_STATUS 0x02
+#define SX126X_SET_DIO2_RF_SWITCH 0x9D
+#define SX126X_SET_DIO3_TCXO 0x97
+#define SX126X_SET_RF_FREQ 0x86
+#define SX126X_SET_PACKET_TYPE 0x8A
+#define SX126X_SET_TX_PARAMS 0x8E
+#define SX126X_SET_MOD_PARAMS 0x8B
+#define SX126X_SET_PKT_PARAMS 0x8C
+#define SX126X_SET_CAD_PARAMS 0x88
+#define SX126X_SET_BUF_BASE 0x8F
+#define SX126X_GET_RX_BUF_STATUS 0x13
+#define SX126X_GET_PKT_STATUS 0x14
+#define SX126X_GET_RSSI_INST 0x15
+#define SX126X_WRITE_REG 0x0D
+#define SX126X_READ_REG 0x1D
+#define SX126X_WRITE_BUF 0x0E
+#define SX126X_READ_BUF 0x1E
+
+#define SX126X_REG_SYNC_WORD 0x0740
+#define SX126X_REG_IQ_POLARITY 0x0736
+#define SX126X_REG_TX_MOD 0x0889
+
+#define SX126X_IRQ_TX_DONE 0x0001
+#define SX126X_IRQ_RX_DONE 0x0002
+#define SX126X_IRQ_HEADER_ERR 0x0020
+#define SX126X_IRQ_CRC_ERR 0x0040
+#define SX126X_IRQ_CAD_DONE 0x0080
+#define SX126X_IRQ_CAD_DETECTED 0x0100
+#define SX126X_IRQ_MASK                                                        \
+  (SX126X_IRQ_TX_DONE | SX126X_IRQ_RX_DONE | SX126X_IRQ_HEADER_ERR |           \
+   SX126X_IRQ_CRC_ERR | SX126X_IRQ_CAD_DONE | SX126X_IRQ_CAD_DETECTED)
+
+#define SX126X_XTAL_HZ 32000000ULL
+#define SX126X_BUSY_SPIN 2000 // 이만큼 폴링해도 BUSY 면 1 ms 씩 대기
+#define SX126X_BUSY_WAIT_MS 10
+
+/**
+ * @brief BUSY 가 내려갈 때까지 대기 (보통 수 us, 교정/모드 전환은 ms 단위)
+ */
+static int sx126x_wait(lora_radio_t *r)
+{
+  if (!r->bus->busy) {
+    return 0;
+  }
+  for (uint32_t i = 0; i < SX126X_BUSY_SPIN; i++) {
+    if (!r->bus->busy()) {
+      return 0;
+    }
+  }
+  for (uint32_t ms = 0; ms < SX126X_BUSY_WAIT_MS; ms++) {
+    r->bus->delay_ms(1);
+    if (!r->bus->busy()) {
+      return 0;
+    }
+  }
+  LOG_ERR("SX126x BUSY stuck");
+  return -1;
+}
+
+static int sx126x_cmd(lora_radio_t *r, uint8_t op, const uint8_t *arg,
+                      size_t len)
+{
+  if (sx126x_wait(r) != 0) {
+    return -1;
+  }
+  return r->bus->xfer2(&op, 1, arg, NULL, len);
+}
+
+/**
+ * @brief 읽기 명령: op, NOP(status) 뒤 len byte
+ */
+static int sx126x_get(lora_radio_t *r, uint8_t op, uint8_t *out, size_t len)
+{
+  uint8_t hdr[2] = {op, 0};
+
+  if (sx126x_wait(r) != 0) {
+    return -1;
+  }
+  return r->bus->xfer2(hdr, sizeof(hdr), NULL, out, len);
+}
+
+static int sx126x_write_reg(lora_radio_t *r, uint16_t addr,
+                            const uint8_t *data, size_t len)
+{
+  uint8_t hdr[3] = {SX126X_WRITE_REG, addr >> 8, addr & 0xFF};
+
+  if (sx126x_wait(r) != 0) {
+    return -1;
+  }
+  return r->bus->xfer2(hdr, sizeof(hdr), data, NULL, len);
+}
+
+static int sx126x_read_reg(lora_radio_t *r, uint16_t addr, uint8_t *out)
+{
+  uint8_t hdr[4] = {SX126X_READ_REG, addr >> 8, addr & 0xFF, 0};
+
+  if (sx126x_wait(r) != 0) {
+    return -1;
+  }
+  return r->bus->xfer2(hdr, sizeof(hdr), NULL, out, 1);
+}
+
+static int sx126x_update_reg(lora_radio_t *r, uint16_t addr, uint8_t clr,
+                             uint8_t set)
+{
+  uint8_t v;
+
+  if (sx126x_read_reg(r, addr, &v) != 0) {
+    return -1;
+  }
+  v = (v & ~clr) | set;
+  return sx126x_write_reg(r, addr, &v, 1);
+}
+
+static int sx126x_standby(lora_radio_t *r)
+{
+  uint8_t rc = 0; // STDBY_RC
+
+  r->rx_cont = false;
+  return sx126x_cmd(r, SX126X_SET_STANDBY, &rc, 1);
+}
+
+static int sx126x_init(lora_radio_t *r)
+{
+  r->bus->reset(true);
+  r->bus->delay_ms(1);
+  r->bus->reset(false);
+  r->bus->delay_ms(10);
+
+  if (sx126x_standby(r) != 0) {
+    return -1;
+  }
+
+  uint8_t one = 1;
+  sx126x_cmd(r, SX126X_SET_REGULATOR, &one, 1); // DC-DC
+  sx126x_cmd(r, SX126X_SET_DIO2_RF_SWITCH, &one, 1);
+#ifdef SX126X_TCXO_VOLTAGE
+  // 시작 대기 5 ms (15.625 us 단위)
+  const uint8_t tcxo[4] = {SX126X_TCXO_VOLTAGE, 0x00, 0x01, 0x40};
+  sx126x_cmd(r, SX126X_SET_DIO3_TCXO, tcxo, sizeof(tcxo));
+#endif
+  uint8_t cal = 0x7F; // 모든 블록
+  sx126x_cmd(r, SX126X_CALIBRATE, &cal, 1);
+  sx126x_cmd(r, SX126X_SET_PACKET_TYPE, &one, 1); // LoRa
+
+  const uint8_t base[2] = {0, 0}; // TX, RX 모두 0 (반이중)
+  sx126x_cmd(r, SX126X_SET_BUF_BASE, base, sizeof(base));
+
+  const uint8_t sync[2] = {0x14, 0x24}; // private 0x12
+  sx126x_write_reg(r, SX126X_REG_SYNC_WORD, sync, sizeof(sync));
+
+  const uint8_t irq[8] = {SX126X_IRQ_MASK >> 8, SX126X_IRQ_MASK & 0xFF,
+                          SX126X_IRQ_MASK >> 8, SX126X_IRQ_MASK & 0xFF, // DIO1
+                          0, 0, 0, 0};
+  sx126x_cmd(r, SX126X_SET_DIO_IRQ, irq, sizeof(irq));
+
+  // 표준 IQ 에서 0x0736 bit2 를 켠다 (데이터시트 15.4 errata)
+  if (sx126x_update_reg(r, SX126X_REG_IQ_POLARITY, 0, 0x04) != 0) {
+    LOG_ERR("SX126x not responding");
+    return -1;
+  }
+
+  LOG_INFO("SX126x ready");
+  return 0;
+}
+
+/**
+ * @brief 이미지 교정 대역 (데이터시트 9.2.1, 주파수 대역 하나씩)
+ */
+static void sx126x_calibrate_image(lora_radio_t *r, uint32_t freq)
+{
+  uint8_t band[2];
+
+  if (freq > 900000000) {
+    band[0] = 0xE1, band[1] = 0xE9;
+  } else if (freq > 850000000) {
+    band[0] = 0xD7, band[1] = 0xDB;
+  } else if (freq > 770000000) {
+    band[0] = 0xC1, band[1] = 0xC5;
+  } else if (freq > 460000000) {
+    band[0] = 0x75, band[1] = 0x81;
+  } else {
+    band[0] = 0x6B, band[1] = 0x6F;
+  }
+  sx126x_cmd(r, SX126X_CALIBRATE_IMAGE, band, sizeof(band));
+}
+
+static int sx126x_packet_params(lora_radio_t *r, uint16_t preamble,
+                                uint8_t len)
+{
+  // preamble, explicit header, 길이, CRC 켬, 표준 IQ
+  const uint8_t pkt[6] = {preamble >> 8, preamble & 0xFF, 0, len, 1, 0};
+
+  return sx126x_cmd(r, SX126X_SET_PKT_PARAMS, pkt, sizeof(pkt));
+}
+
+static int sx126x_config(lora_radio_t *r, uint32_t freq,
+                         const lora_modem_params_t *mp, int8_t power)
+{
+  static const uint8_t bw_code[] = {0x04, 0x05, 0x06}; // 125k, 250k, 500k
+  static const uint32_t bw_hz[] = {125000, 250000, 500000};
+
+  if (mp->sf < 5 || mp->sf > 12 || mp->bw > 2 || mp->cr < 1 || mp->cr > 4) {
+    return -1;
+  }
+  if (power > 22) {
+    power = 22;
+  } else if (power < -9) {
+    power = -9;
+  }
+
+  sx126x_standby(r);
+  sx126x_calibrate_image(r, freq);
+
+  uint32_t frf = (uint32_t)(((uint64_t)freq << 25) / SX126X_XTAL_HZ);
+  const uint8_t rf[4] = {frf >> 24, frf >> 16, frf >> 8, frf};
+  sx126x_cmd(r, SX126X_SET_RF_FREQ, rf, sizeof(rf));
+
+  const uint8_t pa[4] = {0x04, 0x07, 0x00, 0x01}; // SX1262 +22 dBm 최적
+  sx126x_cmd(r, SX126X_SET_PA_CONFIG, pa, sizeof(pa));
+  const uint8_t tx[2] = {(uint8_t)power, 0x04}; // ramp 200 us
+  sx126x_cmd(r, SX126X_SET_TX_PARAMS, tx, sizeof(tx));
+
+  // 심볼 16 ms 이상이면 low data rate optimize (lora_calc_toa_us 와 같게)
+  uint32_t t_sym_us = (1UL << mp->sf) * 1000000UL / bw_hz[mp->bw];
+  const uint8_t mod[4] = {mp->sf, bw_code[mp->bw], mp->cr,
+                          t_sym_us >= 16000 ? 1 : 0};
+  sx126x_cmd(r, SX126X_SET_MOD_PARAMS, mod, sizeof(mod));
+  sx126x_packet_params(r, mp->preamble, LORA_RADIO_PAYLOAD_MAX);
+
+  // 500 kHz 가 아니면 0x0889 bit2 를 켠다 (데이터시트 15.1 errata)
+  r->sf = mp->sf;
+  r->preamble = mp->preamble;
+  return sx126x_update_reg(r, SX126X_REG_TX_MOD, 0x04, mp->bw == 2 ? 0 : 0x04);
+}
+
+static int sx126x_send(lora_radio_t *r, const uint8_t *data, size_t len)
+{
+  const uint8_t hdr[2] = {SX126X_WRITE_BUF, 0};
+
+  if (len == 0 || len > LORA_RADIO_PAYLOAD_MAX) {
+    return -1;
+  }
+
+  sx126x_standby(r);
+  if (sx126x_wait(r) != 0 ||
+      r->bus->xfer2(hdr, sizeof(hdr), data, NULL, len) != 0) {
+    return -1;
+  }
+
+  // PacketParams 는 통째로 다시 쓰므로 preamble 은 config 때 값
+  if (sx126x_packet_params(r, r->preamble, (uint8_t)len) != 0) {
+    return -1;
+  }
+
+  const uint8_t timeout[3] = {0, 0, 0}; // 시간 제한 없음
+  r->tx_count++;
+  return sx126x_cmd(r, SX126X_SET_TX, timeout, sizeof(timeout));
+}
+
+static int sx126x_receive(lora_radio_t *r)
+{
+  const uint8_t timeout[3] = {0xFF, 0xFF, 0xFF}; // 연속 수신
+
+  sx126x_standby(r);
+  sx126x_packet_params(r, r->preamble, LORA_RADIO_PAYLOAD_MAX);
+  if (sx126x_cmd(r, SX126X_SET_RX, timeout, sizeof(timeout)) != 0) {
+    return -1;
+  }
+  r->rx_cont = true;
+  return 0;
+}
+
+static int sx126x_cad(lora_radio_t *r)
+{
+  // AN1200.48 권장: 4 심볼, detPeak 는 SF 를 따라 올림, CAD_ONLY
+  uint8_t peak = (uint8_t)(r->sf < 9 ? 22 : r->sf + 14);
+  const uint8_t cad[7] = {0x02, peak, 10, 0x00, 0, 0, 0};
+
+  sx126x_standby(r);
+  sx126x_cmd(r, SX126X_SET_CAD_PARAMS, cad, sizeof(cad));
+  return sx126x_cmd(r, SX126X_SET_CAD, NULL, 0);
+}
+
+static int sx126x_rssi(lora_radio_t *r, int16_t *dbm)
+{
+  uint8_t st[1];
+
+  if (sx126x_get(r, SX126X_GET_RSSI_INST, st, sizeof(st)) != 0) {
+    return -1;
+  }
+  *dbm = -(int16_t)st[0] / 2;
+  return 0;
+}
+
+static void sx126x_irq(lora_radio_t *r)
+{
+  uint8_t st[2];
+
+  if (sx126x_get(r, SX126X_GET_IRQ_STATUS, st, sizeof(st)) != 0) {
+    return;
+  }
+  uint16_t irq = (uint16_t)(st[0] << 8 | st[1]);
+  if (irq == 0) {
+    return;
+  }
+  sx126x_cmd(r, SX126X_CLR_IRQ_STATUS, st, sizeof(st));
+
+  if (irq & SX126X_IRQ_TX_DONE) {
+    r->cb(r->user, LORA_RADIO_EVT_TX_DONE, NULL);
+  }
+
+  if (irq & SX126X_IRQ_CAD_DONE) {
+    r->cb(r->user, (irq & SX126X_IRQ_CAD_DETECTED) ? LORA_RADIO_EVT_CAD_BUSY
+                                                   : LORA_RADIO_EVT_CAD_CLEAR,
+          NULL);
+  }
+
+  if (irq & (SX126X_IRQ_HEADER_ERR | SX126X_IRQ_CRC_ERR)) {
+    r->rx_err++;
+    r->cb(r->user, LORA_RADIO_EVT_RX_ERROR, NULL);
+    return;
+  }
+
+  if (irq & SX126X_IRQ_RX_DONE) {
+    uint8_t bs[2]; // 길이, 시작 위치
+    uint8_t ps[3]; // RssiPkt, SnrPkt, SignalRssiPkt
+    lora_radio_pkt_t pkt;
+
+    if (sx126x_get(r, SX126X_GET_RX_BUF_STATUS, bs, sizeof(bs)) != 0 ||
+        sx126x_get(r, SX126X_GET_PKT_STATUS, ps, sizeof(ps)) != 0) {
+      return;
+    }
+
+    const uint8_t hdr[3] = {SX126X_READ_BUF, bs[1], 0};
+    if (bs[0] == 0 || sx126x_wait(r) != 0 ||
+        r->bus->xfer2(hdr, sizeof(hdr), NULL, r->buf, bs[0]) != 0) {
+      return;
+    }
+
+    pkt.data = r->buf;
+    pkt.len = bs[0];
+    pkt.rssi = -(int16_t)ps[0] / 2;
+    pkt.snr = (int8_t)ps[1] / 4;
+    r->rx_count++;
+    r->cb(r->user, LORA_RADIO_EVT_RX_DONE, &pkt);
+  }
+}
+
+const lora_radio_ops_t sx126x_ops = {
+    .init = sx126x_init,
+    .config = sx126x_config,
+    .send = sx126x_send,
+    .receive = sx126x_receive,
+    .cad = sx126x_cad,
+    .standby = sx126x_standby,
+    .rssi = sx126x_rssi,
+    .irq = sx126x_irq,
+};
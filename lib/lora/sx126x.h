@@ -0,0 +1,17 @@
+#ifndef SX126X_H
+#define SX126X_H
+
+#include "lora_radio.h"
+
+/**
+ * @brief Semtech SX1261/SX1262 드라이버 (lora_radio_ops_t)
+ *
+ * 명령마다 BUSY 가 내려가길 기다린다. IRQ 는 모두 DIO1 로, DIO2 는 RF 스위치,
+ * 레귤레이터는 DC-DC. 송신 출력은 SX1262 PA 설정 (최대 +22 dBm).
+ *
+ * TCXO 를 DIO3 로 켜는 모듈은 보드에서 SX126X_TCXO_VOLTAGE 에 전압 코드
+ * (0: 1.6 V ~ 7: 3.3 V, SetDIO3AsTCXOCtrl) 를 준다.
+ */
+extern const lora_radio_ops_t sx126x_ops;
+
+#endif
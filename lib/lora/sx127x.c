@@ -0,0 +1,283 @@
+#include "sx127x.h"
+
+#ifndef TAG
+#define TAG "SX127X"
+#endif
+
+#include "log.h"
+
+// 레지스터 (LoRa 모드, SX1276 데이터시트 6.4)
+#define SX127X_REG_FIFO 0x00
+#define SX127X_REG_OP_MODE 0x01
+#define SX127X_REG_FRF_MSB 0x06
+#define SX127X_REG_PA_CONFIG 0x09
+#define SX127X_REG_OCP 0x0B
+#define SX127X_REG_LNA 0x0C
+#define SX127X_REG_FIFO_ADDR_PTR 0x0D
+#define SX127X_REG_FIFO_TX_BASE 0x0E
+#define SX127X_REG_FIFO_RX_BASE 0x0F
+#define SX127X_REG_FIFO_RX_CURRENT 0x10
+#define SX127X_REG_IRQ_FLAGS 0x12
+#define SX127X_REG_RX_NB_BYTES 0x13
+#define SX127X_REG_PKT_SNR 0x19
+#define SX127X_REG_PKT_RSSI 0x1A
+#define SX127X_REG_RSSI 0x1B
+#define SX127X_REG_MODEM_CONFIG1 0x1D
+#define SX127X_REG_MODEM_CONFIG2 0x1E
+#define SX127X_REG_PREAMBLE_MSB 0x20
+#define SX127X_REG_PAYLOAD_LEN 0x22
+#define SX127X_REG_MAX_PAYLOAD_LEN 0x23
+#define SX127X_REG_MODEM_CONFIG3 0x26
+#define SX127X_REG_DETECT_OPTIMIZE 0x31
+#define SX127X_REG_HIGH_BW_OPT1 0x36
+#define SX127X_REG_DETECTION_THRESHOLD 0x37
+#define SX127X_REG_SYNC_WORD 0x39
+#define SX127X_REG_HIGH_BW_OPT2 0x3A
+#define SX127X_REG_DIO_MAPPING1 0x40
+#define SX127X_REG_VERSION 0x42
+#define SX127X_REG_PA_DAC 0x4D
+
+#define SX127X_WRITE 0x80
+
+#define SX127X_MODE_LORA 0x80
+#define SX127X_MODE_SLEEP 0x00
+#define SX127X_MODE_STDBY 0x01
+#define SX127X_MODE_TX 0x03
+#define SX127X_MODE_RX_CONT 0x05
+#define SX127X_MODE_CAD 0x07
+
+#define SX127X_IRQ_RX_DONE 0x40
+#define SX127X_IRQ_CRC_ERR 0x20
+#define SX127X_IRQ_TX_DONE 0x08
+#define SX127X_IRQ_CAD_DONE 0x04
+#define SX127X_IRQ_CAD_DETECTED 0x01
+
+// DIO0 매핑 (RegDioMapping1 bit 7~6)
+#define SX127X_DIO0_RX_DONE 0x00
+#define SX127X_DIO0_TX_DONE 0x40
+#define SX127X_DIO0_CAD_DONE 0x80
+
+#define SX127X_VERSION 0x12
+#define SX127X_XTAL_HZ 32000000ULL
+#define SX127X_RSSI_OFFSET_HF 157
+
+static int sx127x_write(lora_radio_t *r, uint8_t addr, uint8_t v)
+{
+  const uint8_t tx[2] = {addr | SX127X_WRITE, v};
+
+  return r->bus->xfer(tx, NULL, sizeof(tx));
+}
+
+static uint8_t sx127x_read(lora_radio_t *r, uint8_t addr)
+{
+  const uint8_t tx[2] = {addr, 0};
+  uint8_t rx[2] = {0, 0};
+
+  r->bus->xfer(tx, rx, sizeof(tx));
+  return rx[1];
+}
+
+static int sx127x_mode(lora_radio_t *r, uint8_t mode)
+{
+  return sx127x_write(r, SX127X_REG_OP_MODE, SX127X_MODE_LORA | mode);
+}
+
+static int sx127x_standby(lora_radio_t *r)
+{
+  r->rx_cont = false;
+  return sx127x_mode(r, SX127X_MODE_STDBY);
+}
+
+static int sx127x_init(lora_radio_t *r)
+{
+  r->bus->reset(true);
+  r->bus->delay_ms(1);
+  r->bus->reset(false);
+  r->bus->delay_ms(10);
+
+  uint8_t ver = sx127x_read(r, SX127X_REG_VERSION);
+  if (ver != SX127X_VERSION) {
+    LOG_ERR("SX127x not found (version 0x%02X)", ver);
+    return -1;
+  }
+
+  // LoRa 모드는 sleep 에서만 바꿀 수 있다
+  sx127x_write(r, SX127X_REG_OP_MODE, SX127X_MODE_SLEEP);
+  sx127x_mode(r, SX127X_MODE_SLEEP);
+  sx127x_standby(r);
+
+  sx127x_write(r, SX127X_REG_FIFO_TX_BASE, 0);
+  sx127x_write(r, SX127X_REG_FIFO_RX_BASE, 0);
+  sx127x_write(r, SX127X_REG_MAX_PAYLOAD_LEN, LORA_RADIO_PAYLOAD_MAX);
+  sx127x_write(r, SX127X_REG_LNA, 0x23);        // 최대 이득, HF boost
+  sx127x_write(r, SX127X_REG_OCP, 0x2B);        // 100 mA
+  sx127x_write(r, SX127X_REG_SYNC_WORD, 0x12);  // private
+  sx127x_write(r, SX127X_REG_DETECT_OPTIMIZE, 0xC3);
+  sx127x_write(r, SX127X_REG_DETECTION_THRESHOLD, 0x0A);
+
+  LOG_INFO("SX127x ready");
+  return 0;
+}
+
+static int sx127x_config(lora_radio_t *r, uint32_t freq,
+                         const lora_modem_params_t *mp, int8_t power)
+{
+  static const uint8_t bw_code[] = {7, 8, 9}; // 125k, 250k, 500k
+  static const uint32_t bw_hz[] = {125000, 250000, 500000};
+
+  // SF6 은 implicit header 만 되므로 RAK 모듈과 같은 7 부터
+  if (mp->sf < 7 || mp->sf > 12 || mp->bw > 2 || mp->cr < 1 || mp->cr > 4) {
+    return -1;
+  }
+  if (power > 20) {
+    power = 20;
+  } else if (power < 2) {
+    power = 2;
+  }
+
+  sx127x_standby(r);
+
+  uint32_t frf = (uint32_t)(((uint64_t)freq << 19) / SX127X_XTAL_HZ);
+  sx127x_write(r, SX127X_REG_FRF_MSB, (uint8_t)(frf >> 16));
+  sx127x_write(r, SX127X_REG_FRF_MSB + 1, (uint8_t)(frf >> 8));
+  sx127x_write(r, SX127X_REG_FRF_MSB + 2, (uint8_t)frf);
+
+  // PA_BOOST, MaxPower 7. 17 dBm 위는 PaDac 로 +3 dB
+  if (power > 17) {
+    sx127x_write(r, SX127X_REG_PA_DAC, 0x87);
+    sx127x_write(r, SX127X_REG_PA_CONFIG, 0xF0 | (uint8_t)(power - 5));
+  } else {
+    sx127x_write(r, SX127X_REG_PA_DAC, 0x84);
+    sx127x_write(r, SX127X_REG_PA_CONFIG, 0xF0 | (uint8_t)(power - 2));
+  }
+
+  // explicit header, CRC 켬, 심볼 16 ms 이상이면 LDRO (lora_calc_toa_us 와 같게)
+  uint32_t t_sym_us = (1UL << mp->sf) * 1000000UL / bw_hz[mp->bw];
+  sx127x_write(r, SX127X_REG_MODEM_CONFIG1,
+               (uint8_t)(bw_code[mp->bw] << 4 | mp->cr << 1));
+  sx127x_write(r, SX127X_REG_MODEM_CONFIG2, (uint8_t)(mp->sf << 4 | 0x04));
+  sx127x_write(r, SX127X_REG_MODEM_CONFIG3,
+               (t_sym_us >= 16000 ? 0x08 : 0) | 0x04); // AGC 자동
+  sx127x_write(r, SX127X_REG_PREAMBLE_MSB, (uint8_t)(mp->preamble >> 8));
+  sx127x_write(r, SX127X_REG_PREAMBLE_MSB + 1, (uint8_t)mp->preamble);
+
+  // 500 kHz 감도 errata (SX1276 errata 2.1)
+  if (mp->bw == 2 && freq > 525000000) {
+    sx127x_write(r, SX127X_REG_HIGH_BW_OPT1, 0x02);
+    sx127x_write(r, SX127X_REG_HIGH_BW_OPT2, 0x64);
+  } else {
+    sx127x_write(r, SX127X_REG_HIGH_BW_OPT1, 0x03);
+  }
+
+  r->sf = mp->sf;
+  r->preamble = mp->preamble;
+  return 0;
+}
+
+static int sx127x_send(lora_radio_t *r, const uint8_t *data, size_t len)
+{
+  const uint8_t hdr = SX127X_REG_FIFO | SX127X_WRITE;
+
+  if (len == 0 || len > LORA_RADIO_PAYLOAD_MAX) {
+    return -1;
+  }
+
+  sx127x_standby(r);
+  sx127x_write(r, SX127X_REG_FIFO_ADDR_PTR, 0);
+  if (r->bus->xfer2(&hdr, 1, data, NULL, len) != 0) {
+    return -1;
+  }
+  sx127x_write(r, SX127X_REG_PAYLOAD_LEN, (uint8_t)len);
+  sx127x_write(r, SX127X_REG_DIO_MAPPING1, SX127X_DIO0_TX_DONE);
+  sx127x_write(r, SX127X_REG_IRQ_FLAGS, 0xFF);
+
+  r->tx_count++;
+  return sx127x_mode(r, SX127X_MODE_TX);
+}
+
+static int sx127x_receive(lora_radio_t *r)
+{
+  sx127x_standby(r);
+  sx127x_write(r, SX127X_REG_FIFO_ADDR_PTR, 0);
+  sx127x_write(r, SX127X_REG_DIO_MAPPING1, SX127X_DIO0_RX_DONE);
+  sx127x_write(r, SX127X_REG_IRQ_FLAGS, 0xFF);
+  if (sx127x_mode(r, SX127X_MODE_RX_CONT) != 0) {
+    return -1;
+  }
+  r->rx_cont = true;
+  return 0;
+}
+
+static int sx127x_cad(lora_radio_t *r)
+{
+  sx127x_standby(r);
+  sx127x_write(r, SX127X_REG_DIO_MAPPING1, SX127X_DIO0_CAD_DONE);
+  sx127x_write(r, SX127X_REG_IRQ_FLAGS, 0xFF);
+  return sx127x_mode(r, SX127X_MODE_CAD);
+}
+
+static int sx127x_rssi(lora_radio_t *r, int16_t *dbm)
+{
+  *dbm = (int16_t)sx127x_read(r, SX127X_REG_RSSI) - SX127X_RSSI_OFFSET_HF;
+  return 0;
+}
+
+static void sx127x_irq(lora_radio_t *r)
+{
+  uint8_t irq = sx127x_read(r, SX127X_REG_IRQ_FLAGS);
+
+  if (irq == 0) {
+    return;
+  }
+  sx127x_write(r, SX127X_REG_IRQ_FLAGS, irq);
+
+  if (irq & SX127X_IRQ_TX_DONE) {
+    r->cb(r->user, LORA_RADIO_EVT_TX_DONE, NULL);
+  }
+
+  if (irq & SX127X_IRQ_CAD_DONE) {
+    r->cb(r->user, (irq & SX127X_IRQ_CAD_DETECTED) ? LORA_RADIO_EVT_CAD_BUSY
+                                                   : LORA_RADIO_EVT_CAD_CLEAR,
+          NULL);
+  }
+
+  if (!(irq & SX127X_IRQ_RX_DONE)) {
+    return;
+  }
+  if (irq & SX127X_IRQ_CRC_ERR) {
+    r->rx_err++;
+    r->cb(r->user, LORA_RADIO_EVT_RX_ERROR, NULL);
+    return;
+  }
+
+  const uint8_t hdr = SX127X_REG_FIFO;
+  lora_radio_pkt_t pkt;
+  uint8_t len = sx127x_read(r, SX127X_REG_RX_NB_BYTES);
+
+  sx127x_write(r, SX127X_REG_FIFO_ADDR_PTR,
+               sx127x_read(r, SX127X_REG_FIFO_RX_CURRENT));
+  if (len == 0 || r->bus->xfer2(&hdr, 1, NULL, r->buf, len) != 0) {
+    return;
+  }
+
+  pkt.data = r->buf;
+  pkt.len = len;
+  pkt.snr = (int8_t)sx127x_read(r, SX127X_REG_PKT_SNR) / 4;
+  pkt.rssi = (int16_t)sx127x_read(r, SX127X_REG_PKT_RSSI) - SX127X_RSSI_OFFSET_HF;
+  if (pkt.snr < 0) {
+    pkt.rssi += pkt.snr;
+  }
+  r->rx_count++;
+  r->cb(r->user, LORA_RADIO_EVT_RX_DONE, &pkt);
+}
+
+const lora_radio_ops_t sx127x_ops = {
+    .init = sx127x_init,
+    .config = sx127x_config,
+    .send = sx127x_send,
+    .receive = sx127x_receive,
+    .cad = sx127x_cad,
+    .standby = sx127x_standby,
+    .rssi = sx127x_rssi,
+    .irq = sx127x_irq,
+};
@@ -0,0 +1,15 @@
+#ifndef SX127X_H
+#define SX127X_H
+
+#include "lora_radio.h"
+
+/**
+ * @brief Semtech SX1276/SX1277/SX1278/SX1279 드라이버 (lora_radio_ops_t)
+ *
+ * 레지스터 접근만 쓴다. DIO0 하나로 RxDone/TxDone/CadDone 을 받으므로
+ * 모드를 바꿀 때마다 DIO0 매핑을 바꾼다. 송신은 PA_BOOST 핀 (+2 ~ +20 dBm),
+ * 주파수 레지스터는 HF 포트 기준 RSSI 보정 (-157) 을 쓴다.
+ */
+extern const lora_radio_ops_t sx127x_ops;
+
+#endif
@@ -212,3 +212,62 @@ uint8_t parse_string_quoted(const char **src, char *dst, size_t len) {
 
   return 1;
 }
+
+/**
+ * @brief HEX 문자 -> 값 + 1 (0: HEX 문자 아님)
+ */
+static const uint8_t parser_hex_val[256] = {
+    ['0'] = 1,  ['1'] = 2,  ['2'] = 3,  ['3'] = 4,  ['4'] = 5,  ['5'] = 6,
+    ['6'] = 7,  ['7'] = 8,  ['8'] = 9,  ['9'] = 10, ['A'] = 11, ['B'] = 12,
+    ['C'] = 13, ['D'] = 14, ['E'] = 15, ['F'] = 16, ['a'] = 11, ['b'] = 12,
+    ['c'] = 13, ['d'] = 14, ['e'] = 15, ['f'] = 16,
+};
+
+static const char parser_hex_digit[16] = "0123456789ABCDEF";
+
+/**
+ * @brief HEX 문자열을 바이너리로 변환
+ *
+ * 2문자씩 len 바이트까지 변환하고, HEX 가 아닌 문자나 문자열 끝에서 멈춘다.
+ *
+ * @param[inout] str 변환한 문자 뒤로 이동
+ * @param[out] dst 출력 버퍼 (len 이상)
+ * @param[in] len 변환할 최대 바이트 수
+ * @return size_t 변환한 바이트 수
+ */
+size_t parse_hex_bytes(const char **str, uint8_t *dst, size_t len) {
+  const uint8_t *p = (const uint8_t *)*str;
+  size_t i = 0;
+
+  for (; i < len; i++, p += 2) {
+    uint8_t hi = parser_hex_val[p[0]];
+    if (!hi) {
+      break;
+    }
+    uint8_t lo = parser_hex_val[p[1]];
+    if (!lo) {
+      break;
+    }
+    dst[i] = (uint8_t)(((hi - 1) << 4) | (lo - 1));
+  }
+  *str = (const char *)p;
+
+  return i;
+}
+
+/**
+ * @brief 바이너리를 대문자 HEX 문자열로 변환 (종료 문자 없음)
+ *
+ * @param[out] dst 출력 버퍼 (len * 2 이상)
+ * @param[in] src 입력 데이터
+ * @param[in] len 입력 바이트 수
+ * @return char* 마지막으로 쓴 문자 다음 위치
+ */
+char *parser_hex_encode(char *dst, const uint8_t *src, size_t len) {
+  for (size_t i = 0; i < len; i++) {
+    *dst++ = parser_hex_digit[src[i] >> 4];
+    *dst++ = parser_hex_digit[src[i] & 0x0F];
+  }
+
+  return dst;
+}
@@ -25,5 +25,7 @@ double parse_double(const char **str);
 char parse_char(const char **str);
 uint8_t parse_string(const char **src, char *dst, size_t len);
 uint8_t parse_string_quoted(const char **src, char *dst, size_t len);
+size_t parse_hex_bytes(const char **str, uint8_t *dst, size_t len);
+char *parser_hex_encode(char *dst, const uint8_t *src, size_t len);
 
 #endif
@@ -10,7 +10,7 @@
 #include "task.h"
 
 // Some internal define
-#if USE_SOFTUART
+#if USE_SOFTUART && !SOFTUART_USE_DMA
 #if(SoftUart_PARITY)
 #define SoftUart_IDEF_LEN_C1 (SoftUart_DATA_LEN+2)
 #else
@@ -15,6 +15,18 @@
 #define SOFT_UART_TX_Pin GPIO_PIN_2
 #define SOFT_UART_TX_GPIO_Port GPIOD
 
+/* RX 시작 edge 를 받는 EXTI (SOFT_UART_RX_Pin 에 맞춘다) */
+#define SOFT_UART_RX_EXTI_IRQn 		EXTI15_10_IRQn
+#define SOFT_UART_RX_EXTI_IRQHandler 	EXTI15_10_IRQHandler
+
+/*
+ * 1: TIM1 update/CC1 에서 DMA2 로 BSRR 를 쓰고 IDR 을 읽는 엔진 (softuart_dma.c)
+ * 0: 5배속 TIM1 인터럽트에서 SoftUartHandler() 를 부르는 원래 엔진
+ */
+#ifndef SOFTUART_USE_DMA
+#define SOFTUART_USE_DMA 		1
+#endif
+
 #define 	Number_Of_SoftUarts 	1 	// Max 8
 
 #define 	SoftUartTxBufferSize	128
@@ -23,6 +35,7 @@
 #define 	SoftUart_DATA_LEN   	8 	// Max 8 Bit
 #define 	SoftUart_PARITY     	0   // 0=None 1=odd 2=even
 #define 	SoftUart_STOP_Bit   	1   // Number of stop bits
+#define 	SoftUart_BAUD       	9600 // DMA 엔진에서 TIM1 주기 계산용
 
 typedef enum {
 	SoftUart_OK,
@@ -51,8 +64,10 @@ typedef struct {
 	uint8_t 		RxBitOffset;
 } SoftUart_S;
 
+#if !SOFTUART_USE_DMA
 //Call Every (0.2)*(1/9600) = 20.83 uS
 void 		SoftUartHandler(void);
+#endif
 
 void 		SoftUartWaitUntilTxComplate(uint8_t SoftUartNumber);
 uint8_t 	SoftUartRxAlavailable(uint8_t SoftUartNumber);
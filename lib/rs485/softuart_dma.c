@@ -0,0 +1,451 @@
+/**
+ * @file softuart_dma.c
+ * @brief 타이머 + DMA soft UART 엔진 (softuart.h API 그대로)
+ *
+ * TX: 비트마다 BSRR 값을 미리 만들어 두고 TIM1 update 마다 DMA2 가
+ *     TX 핀의 BSRR 에 한 word 씩 쓴다. SU_TX_CHUNK 바이트씩 두 버퍼를
+ *     번갈아 쓰므로 인터럽트는 구간당 한 번이다.
+ * RX: 시작 edge 를 EXTI 로 받아 TIM1 CC1 을 비트 중앙에 맞추고, CC1 마다
+ *     DMA2 가 RX 포트 IDR 을 한 프레임(start ~ stop) 만큼 읽는다.
+ *     디코딩은 프레임 끝 DMA 완료 인터럽트에서 한 번만 한다.
+ *
+ * 5배속 TIM1 인터럽트(비트당 5회) 대신 바이트당 인터럽트 2~3회로 줄어든다.
+ * ISR 들은 RTOS API 를 쓰지 않으므로 원래 TIM1 과 같은 최고 우선순위로 둔다.
+ */
+
+#include "board_config.h"
+#include "softuart.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "stm32f4xx_ll_bus.h"
+#include "stm32f4xx_ll_dma.h"
+#include "stm32f4xx_ll_tim.h"
+#include <string.h>
+
+#if USE_SOFTUART && SOFTUART_USE_DMA
+
+#if Number_Of_SoftUarts != 1
+#error "DMA soft UART engine supports a single channel (TIM1 + DMA2)"
+#endif
+
+#define SU_TIM TIM1
+#define SU_DMA DMA2
+#define SU_DMA_CHANNEL LL_DMA_CHANNEL_6
+#define SU_TX_STREAM LL_DMA_STREAM_5 /* TIM1_UP */
+#define SU_TX_IRQn DMA2_Stream5_IRQn
+#define SU_RX_STREAM LL_DMA_STREAM_3 /* TIM1_CH1 */
+#define SU_RX_IRQn DMA2_Stream3_IRQn
+
+/* start + data + parity + stop */
+#define SU_FRAME_BITS                                                          \
+  (1 + SoftUart_DATA_LEN + (SoftUart_PARITY ? 1 : 0) + SoftUart_STOP_Bit)
+
+/**
+ * @brief TX DMA 한 번에 싣는 바이트 수
+ */
+#define SU_TX_CHUNK 16
+
+/* 마지막 구간은 stop bit 를 한 비트 더 유지하는 word 를 붙인다 */
+#define SU_TX_WORDS (SU_TX_CHUNK * SU_FRAME_BITS + 1)
+
+SoftUart_S SUart[Number_Of_SoftUarts];
+SoftUartBuffer_S SUBuffer[Number_Of_SoftUarts];
+
+static uint32_t su_tx_words[2][SU_TX_WORDS];
+static volatile uint16_t su_tx_len[2];
+static volatile uint8_t su_tx_cur;
+
+static uint16_t su_rx_samples[SU_FRAME_BITS];
+static uint32_t su_rx_line; /**< EXTI line 마스크 (핀 마스크와 같다) */
+static uint32_t su_bit_ticks;
+
+static uint32_t su_tim_clock(void) {
+  uint32_t clk = HAL_RCC_GetPCLK2Freq();
+
+  // APB2 가 분주되어 있으면 타이머 클럭은 2배
+  if ((RCC->CFGR & RCC_CFGR_PPRE2) != RCC_CFGR_PPRE2_DIV1) {
+    clk *= 2;
+  }
+  return clk;
+}
+
+/**
+ * @brief 남은 TX 바이트를 BSRR word 로 바꿈 (최대 SU_TX_CHUNK 바이트)
+ *
+ * @return uint16_t word 수 (0 이면 보낼 것 없음)
+ */
+static uint16_t su_tx_encode(SoftUart_S *su, uint32_t *out) {
+  uint32_t hi = su->TxPin;
+  uint32_t lo = (uint32_t)su->TxPin << 16;
+  uint16_t n = 0;
+
+  while (su->TxIndex < su->TxSize && n + SU_FRAME_BITS < SU_TX_WORDS) {
+    uint8_t b = su->Buffer->Tx[su->TxIndex++];
+    uint8_t ones = 0;
+
+    out[n++] = lo;
+    for (uint8_t i = 0; i < SoftUart_DATA_LEN; i++) {
+      uint8_t bit = (b >> i) & 0x01;
+
+      ones += bit;
+      out[n++] = bit ? hi : lo;
+    }
+#if SoftUart_PARITY
+    {
+      uint8_t p = ones & 0x01;
+
+      if (SoftUart_PARITY == 1) {
+        p = !p;
+      }
+      out[n++] = p ? hi : lo;
+    }
+#else
+    (void)ones;
+#endif
+    for (uint8_t i = 0; i < SoftUart_STOP_Bit; i++) {
+      out[n++] = hi;
+    }
+  }
+
+  // DMA 완료 시점에 마지막 stop bit 가 다 나가 있도록
+  if (n > 0 && su->TxIndex >= su->TxSize) {
+    out[n++] = hi;
+  }
+  return n;
+}
+
+/**
+ * @brief 버퍼 하나 송신 시작 - 다음 update 부터 한 비트씩 나간다
+ *
+ * stream 을 켠 뒤에 UDE 를 켜야 첫 word 가 update 경계에 맞춰 나간다.
+ */
+static void su_tx_start(uint8_t idx) {
+  LL_DMA_ClearFlag_TC5(SU_DMA);
+  LL_DMA_ClearFlag_HT5(SU_DMA);
+  LL_DMA_ClearFlag_TE5(SU_DMA);
+  LL_DMA_ClearFlag_DME5(SU_DMA);
+  LL_DMA_ClearFlag_FE5(SU_DMA);
+  LL_DMA_SetMemoryAddress(SU_DMA, SU_TX_STREAM, (uint32_t)su_tx_words[idx]);
+  LL_DMA_SetDataLength(SU_DMA, SU_TX_STREAM, su_tx_len[idx]);
+  LL_DMA_EnableStream(SU_DMA, SU_TX_STREAM);
+  LL_TIM_EnableDMAReq_UPDATE(SU_TIM);
+}
+
+static void su_tx_finish(SoftUart_S *su) {
+  su->TxPort->BSRR = su->TxPin; // idle high
+  su->TxEnable = 0;
+  su->TxNComplated = 0;
+}
+
+static void su_rx_arm(SoftUart_S *su) {
+  EXTI->PR = su_rx_line;
+  if (su->RxEnable) {
+    EXTI->IMR |= su_rx_line;
+  }
+}
+
+/**
+ * @brief 시작 edge - CC1 을 start bit 중앙에 맞추고 프레임 샘플링 시작
+ */
+static void su_rx_start(void) {
+  uint32_t ccr = LL_TIM_GetCounter(SU_TIM) + su_bit_ticks / 2;
+
+  if (ccr >= su_bit_ticks) {
+    ccr -= su_bit_ticks;
+  }
+
+  // 프레임 안의 edge 는 무시
+  EXTI->IMR &= ~su_rx_line;
+
+  LL_TIM_OC_SetCompareCH1(SU_TIM, ccr);
+  LL_DMA_ClearFlag_TC3(SU_DMA);
+  LL_DMA_ClearFlag_HT3(SU_DMA);
+  LL_DMA_ClearFlag_TE3(SU_DMA);
+  LL_DMA_ClearFlag_DME3(SU_DMA);
+  LL_DMA_ClearFlag_FE3(SU_DMA);
+  LL_DMA_SetDataLength(SU_DMA, SU_RX_STREAM, SU_FRAME_BITS);
+  LL_DMA_EnableStream(SU_DMA, SU_RX_STREAM);
+  LL_TIM_ClearFlag_CC1(SU_TIM);
+  LL_TIM_EnableDMAReq_CC1(SU_TIM);
+}
+
+static void su_rx_decode(SoftUart_S *su) {
+  uint16_t pin = su->RxPin;
+  uint8_t b = 0;
+
+  // start 는 0, 마지막 stop 은 1 이어야 한다 (아니면 버림)
+  if ((su_rx_samples[0] & pin) || !(su_rx_samples[SU_FRAME_BITS - 1] & pin)) {
+    return;
+  }
+
+  for (uint8_t i = 0; i < SoftUart_DATA_LEN; i++) {
+    if (su_rx_samples[1 + i] & pin) {
+      b |= 1U << i;
+    }
+  }
+
+  if (su->RxIndex < (SoftUartRxBufferSize - 1)) {
+    su->Buffer->Rx[su->RxIndex] = b;
+    su->RxIndex++;
+  }
+}
+
+static void su_timer_init(void) {
+  LL_TIM_DisableIT_UPDATE(SU_TIM);
+  LL_TIM_DisableDMAReq_UPDATE(SU_TIM);
+  LL_TIM_DisableDMAReq_CC1(SU_TIM);
+
+  su_bit_ticks =
+      su_tim_clock() / (LL_TIM_GetPrescaler(SU_TIM) + 1) / SoftUart_BAUD;
+  LL_TIM_SetAutoReload(SU_TIM, su_bit_ticks - 1);
+  LL_TIM_OC_SetMode(SU_TIM, LL_TIM_CHANNEL_CH1, LL_TIM_OCMODE_FROZEN);
+  LL_TIM_GenerateEvent_UPDATE(SU_TIM);
+  LL_TIM_ClearFlag_UPDATE(SU_TIM);
+  LL_TIM_EnableCounter(SU_TIM);
+}
+
+static void su_dma_init(SoftUart_S *su) {
+  LL_AHB1_GRP1_EnableClock(LL_AHB1_GRP1_PERIPH_DMA2);
+
+  /* TX: memory -> TX 포트 BSRR, word */
+  LL_DMA_DisableStream(SU_DMA, SU_TX_STREAM);
+  LL_DMA_SetChannelSelection(SU_DMA, SU_TX_STREAM, SU_DMA_CHANNEL);
+  LL_DMA_SetDataTransferDirection(SU_DMA, SU_TX_STREAM,
+                                  LL_DMA_DIRECTION_MEMORY_TO_PERIPH);
+  LL_DMA_SetStreamPriorityLevel(SU_DMA, SU_TX_STREAM, LL_DMA_PRIORITY_VERYHIGH);
+  LL_DMA_SetMode(SU_DMA, SU_TX_STREAM, LL_DMA_MODE_NORMAL);
+  LL_DMA_SetPeriphIncMode(SU_DMA, SU_TX_STREAM, LL_DMA_PERIPH_NOINCREMENT);
+  LL_DMA_SetMemoryIncMode(SU_DMA, SU_TX_STREAM, LL_DMA_MEMORY_INCREMENT);
+  LL_DMA_SetPeriphSize(SU_DMA, SU_TX_STREAM, LL_DMA_PDATAALIGN_WORD);
+  LL_DMA_SetMemorySize(SU_DMA, SU_TX_STREAM, LL_DMA_MDATAALIGN_WORD);
+  LL_DMA_DisableFifoMode(SU_DMA, SU_TX_STREAM);
+  LL_DMA_SetPeriphAddress(SU_DMA, SU_TX_STREAM, (uint32_t)&su->TxPort->BSRR);
+  LL_DMA_EnableIT_TC(SU_DMA, SU_TX_STREAM);
+  LL_DMA_EnableIT_TE(SU_DMA, SU_TX_STREAM);
+
+  /* RX: RX 포트 IDR -> 샘플 버퍼, half-word */
+  LL_DMA_DisableStream(SU_DMA, SU_RX_STREAM);
+  LL_DMA_SetChannelSelection(SU_DMA, SU_RX_STREAM, SU_DMA_CHANNEL);
+  LL_DMA_SetDataTransferDirection(SU_DMA, SU_RX_STREAM,
+                                  LL_DMA_DIRECTION_PERIPH_TO_MEMORY);
+  LL_DMA_SetStreamPriorityLevel(SU_DMA, SU_RX_STREAM, LL_DMA_PRIORITY_VERYHIGH);
+  LL_DMA_SetMode(SU_DMA, SU_RX_STREAM, LL_DMA_MODE_NORMAL);
+  LL_DMA_SetPeriphIncMode(SU_DMA, SU_RX_STREAM, LL_DMA_PERIPH_NOINCREMENT);
+  LL_DMA_SetMemoryIncMode(SU_DMA, SU_RX_STREAM, LL_DMA_MEMORY_INCREMENT);
+  LL_DMA_SetPeriphSize(SU_DMA, SU_RX_STREAM, LL_DMA_PDATAALIGN_HALFWORD);
+  LL_DMA_SetMemorySize(SU_DMA, SU_RX_STREAM, LL_DMA_MDATAALIGN_HALFWORD);
+  LL_DMA_DisableFifoMode(SU_DMA, SU_RX_STREAM);
+  LL_DMA_SetPeriphAddress(SU_DMA, SU_RX_STREAM, (uint32_t)&su->RxPort->IDR);
+  LL_DMA_SetMemoryAddress(SU_DMA, SU_RX_STREAM, (uint32_t)su_rx_samples);
+  LL_DMA_EnableIT_TC(SU_DMA, SU_RX_STREAM);
+  LL_DMA_EnableIT_TE(SU_DMA, SU_RX_STREAM);
+
+  NVIC_SetPriority(SU_TX_IRQn,
+                   NVIC_EncodePriority(NVIC_GetPriorityGrouping(), 0, 0));
+  NVIC_EnableIRQ(SU_TX_IRQn);
+  NVIC_SetPriority(SU_RX_IRQn,
+                   NVIC_EncodePriority(NVIC_GetPriorityGrouping(), 0, 0));
+  NVIC_EnableIRQ(SU_RX_IRQn);
+}
+
+static void su_exti_init(SoftUart_S *su) {
+  uint32_t line = __builtin_ctz(su->RxPin);
+  uint32_t port = ((uint32_t)su->RxPort - GPIOA_BASE) / (GPIOB_BASE - GPIOA_BASE);
+  uint32_t shift = (line & 0x03) * 4;
+
+  LL_APB2_GRP1_EnableClock(LL_APB2_GRP1_PERIPH_SYSCFG);
+  SYSCFG->EXTICR[line >> 2] =
+      (SYSCFG->EXTICR[line >> 2] & ~(0x0FU << shift)) | (port << shift);
+
+  su_rx_line = su->RxPin;
+  EXTI->IMR &= ~su_rx_line;
+  EXTI->EMR &= ~su_rx_line;
+  EXTI->RTSR &= ~su_rx_line;
+  EXTI->FTSR |= su_rx_line;
+  EXTI->PR = su_rx_line;
+
+  NVIC_SetPriority(SOFT_UART_RX_EXTI_IRQn,
+                   NVIC_EncodePriority(NVIC_GetPriorityGrouping(), 0, 0));
+  NVIC_EnableIRQ(SOFT_UART_RX_EXTI_IRQn);
+}
+
+SoftUartState_E SoftUartInit(uint8_t SoftUartNumber, GPIO_TypeDef *TxPort,
+                             uint16_t TxPin, GPIO_TypeDef *RxPort,
+                             uint16_t RxPin) {
+  SoftUart_S *su;
+
+  if (SoftUartNumber >= Number_Of_SoftUarts) {
+    return SoftUart_Error;
+  }
+
+  su = &SUart[SoftUartNumber];
+  memset(su, 0, sizeof(*su));
+  su->Buffer = &SUBuffer[SoftUartNumber];
+  su->TxPort = TxPort;
+  su->TxPin = TxPin;
+  su->RxPort = RxPort;
+  su->RxPin = RxPin;
+
+  TxPort->BSRR = TxPin; // idle high
+
+  su_timer_init();
+  su_dma_init(su);
+  su_exti_init(su);
+
+  return SoftUart_OK;
+}
+
+SoftUartState_E SoftUartEnableRx(uint8_t SoftUartNumber) {
+  if (SoftUartNumber >= Number_Of_SoftUarts) {
+    return SoftUart_Error;
+  }
+  SUart[SoftUartNumber].RxEnable = 1;
+  su_rx_arm(&SUart[SoftUartNumber]);
+  return SoftUart_OK;
+}
+
+SoftUartState_E SoftUartDisableRx(uint8_t SoftUartNumber) {
+  if (SoftUartNumber >= Number_Of_SoftUarts) {
+    return SoftUart_Error;
+  }
+  SUart[SoftUartNumber].RxEnable = 0;
+  EXTI->IMR &= ~su_rx_line;
+  return SoftUart_OK;
+}
+
+uint8_t SoftUartRxAlavailable(uint8_t SoftUartNumber) {
+  return SUart[SoftUartNumber].RxIndex;
+}
+
+SoftUartState_E SoftUartReadRxBuffer(uint8_t SoftUartNumber, uint8_t *Buffer,
+                                     uint8_t Len) {
+  SoftUart_S *su;
+  uint32_t primask;
+
+  if (SoftUartNumber >= Number_Of_SoftUarts) {
+    return SoftUart_Error;
+  }
+
+  su = &SUart[SoftUartNumber];
+  if (Len > su->RxIndex) {
+    Len = su->RxIndex;
+  }
+
+  // ISR 은 RxIndex 뒤에만 쓰므로 앞쪽은 그냥 복사해도 된다
+  memcpy(Buffer, su->Buffer->Rx, Len);
+
+  // RX ISR 이 최고 우선순위라 taskENTER_CRITICAL 로는 막히지 않는다
+  primask = __get_PRIMASK();
+  __disable_irq();
+  memmove(su->Buffer->Rx, &su->Buffer->Rx[Len], su->RxIndex - Len);
+  su->RxIndex -= Len;
+  __set_PRIMASK(primask);
+
+  return SoftUart_OK;
+}
+
+void SoftUartWaitUntilTxComplate(uint8_t SoftUartNumber) {
+  while (SUart[SoftUartNumber].TxNComplated) {
+    vTaskDelay(pdMS_TO_TICKS(3));
+  }
+}
+
+SoftUartState_E SoftUartPuts(uint8_t SoftUartNumber, uint8_t *Data,
+                             uint8_t Len) {
+  SoftUart_S *su;
+
+  if (SoftUartNumber >= Number_Of_SoftUarts) {
+    return SoftUart_Error;
+  }
+
+  su = &SUart[SoftUartNumber];
+  if (su->TxNComplated || Len > SoftUartTxBufferSize) {
+    return SoftUart_Error;
+  }
+  if (Len == 0) {
+    return SoftUart_OK;
+  }
+
+  memcpy(su->Buffer->Tx, Data, Len);
+  su->TxIndex = 0;
+  su->TxSize = Len;
+  su->TxNComplated = 1;
+  su->TxEnable = 1;
+
+  // 두 번째 구간은 첫 구간이 나가는 동안 바로 이어 걸 수 있게 미리 만든다
+  su_tx_len[0] = su_tx_encode(su, su_tx_words[0]);
+  su_tx_len[1] = su_tx_encode(su, su_tx_words[1]);
+  su_tx_cur = 0;
+  su_tx_start(0);
+
+  return SoftUart_OK;
+}
+
+/**
+ * @brief TX DMA (TIM1_UP) - 구간 끝, 다음 버퍼를 이어 걸고 빈 버퍼를 채움
+ */
+void DMA2_Stream5_IRQHandler(void) {
+  SoftUart_S *su = &SUart[0];
+
+  if (LL_DMA_IsActiveFlag_TE5(SU_DMA)) {
+    LL_DMA_ClearFlag_TE5(SU_DMA);
+    LL_TIM_DisableDMAReq_UPDATE(SU_TIM);
+    LL_DMA_DisableStream(SU_DMA, SU_TX_STREAM);
+    su_tx_finish(su);
+    return;
+  }
+
+  if (LL_DMA_IsActiveFlag_TC5(SU_DMA)) {
+    uint8_t done = su_tx_cur;
+    uint8_t next = done ^ 1;
+
+    LL_DMA_ClearFlag_TC5(SU_DMA);
+    LL_TIM_DisableDMAReq_UPDATE(SU_TIM);
+
+    // 다음 update 전에 걸어서 비트 사이가 벌어지지 않게 한다
+    if (su_tx_len[next] > 0) {
+      su_tx_cur = next;
+      su_tx_start(next);
+      su_tx_len[done] = su_tx_encode(su, su_tx_words[done]);
+    } else {
+      su_tx_len[done] = 0;
+      su_tx_finish(su);
+    }
+  }
+}
+
+/**
+ * @brief RX DMA (TIM1_CH1) - 한 프레임 샘플 완료
+ */
+void DMA2_Stream3_IRQHandler(void) {
+  SoftUart_S *su = &SUart[0];
+
+  if (LL_DMA_IsActiveFlag_TE3(SU_DMA)) {
+    LL_DMA_ClearFlag_TE3(SU_DMA);
+    LL_TIM_DisableDMAReq_CC1(SU_TIM);
+    LL_DMA_DisableStream(SU_DMA, SU_RX_STREAM);
+    su_rx_arm(su);
+    return;
+  }
+
+  if (LL_DMA_IsActiveFlag_TC3(SU_DMA)) {
+    LL_DMA_ClearFlag_TC3(SU_DMA);
+    LL_TIM_DisableDMAReq_CC1(SU_TIM);
+    if (su->RxEnable) {
+      su_rx_decode(su);
+    }
+    su_rx_arm(su);
+  }
+}
+
+/**
+ * @brief RX 시작 edge (falling)
+ */
+void SOFT_UART_RX_EXTI_IRQHandler(void) {
+  if (EXTI->PR & su_rx_line) {
+    EXTI->PR = su_rx_line;
+    su_rx_start();
+  }
+}
+
+#endif
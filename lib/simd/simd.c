@@ -0,0 +1,208 @@
+#include "simd.h"
+#include "mem_section.h"
+
+#if defined(__ARM_FEATURE_DSP)
+#include "stm32f4xx.h"
+#define SIMD_DSP 1
+#else
+#define SIMD_DSP 0
+#endif
+
+#if SIMD_DSP
+/* 0 이 아닌 워드에서 0 이 아닌 첫 바이트 (little endian: 낮은 바이트가 앞) */
+static inline uint32_t first_byte(uint32_t mask) { return __CLZ(__RBIT(mask)) >> 3; }
+
+/* 바이트마다 0 이면 1 (1 - x 포화 빼기) */
+static inline uint32_t zero_bytes(uint32_t x) { return __UQSUB8(0x01010101U, x); }
+
+/**
+ * @brief 니블 4개 (바이트마다 0~15) -> HEX 문자 4개
+ */
+static inline uint32_t hex_digits4(uint32_t n) {
+  __USUB8(n, 0x0A0A0A0AU); // GE: n >= 10
+  return __UADD8(n, __SEL(0x37373737U, 0x30303030U));
+}
+
+/**
+ * @brief HEX 문자 4개 -> 니블 4개
+ *
+ * 대문자는 0x20 을 켜서 소문자로 맞추고, 숫자/문자 구간별로 뺀 값이 범위
+ * 안인지 본다. 0x10~0x19 는 0x20 을 켜면 숫자가 되므로 원래 0x20 이
+ * 켜져 있었는지도 본다.
+ *
+ * @return false 하나라도 HEX 가 아님
+ */
+static inline bool hex_nibbles4(uint32_t w, uint32_t *out) {
+  uint32_t v = w | 0x20202020U;
+  uint32_t alpha, n, ok;
+
+  __USUB8(v, 0x3A3A3A3AU); // GE: ':' 이상 (문자 구간)
+  alpha = __SEL(0xFFFFFFFFU, 0);
+  n = __USUB8(v, __SEL(0x57575757U, 0x30303030U));
+  ok = __SEL(0xFFFFFFFFU, 0); // 빼기 넘침 없음
+  __USUB8(0x0F0F0F0FU, n);
+  ok = __SEL(ok, 0); // n <= 15
+  __USUB8(n, 0x0A0A0A0AU);
+  ok = __SEL(ok, ok & ~alpha); // 문자 구간이면 n >= 10
+  ok &= alpha | (((w >> 5) & 0x01010101U) * 0xFFU); // 숫자 구간이면 원래 0x20
+
+  *out = n;
+  return ok == 0xFFFFFFFFU;
+}
+#endif
+
+static inline int hex_val(uint8_t c) {
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  }
+  c |= 0x20;
+  if (c >= 'a' && c <= 'f') {
+    return c - 'a' + 10;
+  }
+  return -1;
+}
+
+RAM_FUNC size_t simd_find_any4(const uint8_t *d, size_t len, uint32_t set) {
+  size_t i = 0;
+
+#if SIMD_DSP
+  const uint32_t k0 = (set & 0xFFU) * 0x01010101U;
+  const uint32_t k1 = ((set >> 8) & 0xFFU) * 0x01010101U;
+  const uint32_t k2 = ((set >> 16) & 0xFFU) * 0x01010101U;
+  const uint32_t k3 = (set >> 24) * 0x01010101U;
+
+  for (; i + 4 <= len; i += 4) {
+    uint32_t w = __UNALIGNED_UINT32_READ(&d[i]);
+    uint32_t m = zero_bytes(w ^ k0) | zero_bytes(w ^ k1) | zero_bytes(w ^ k2) |
+                 zero_bytes(w ^ k3);
+
+    if (m) {
+      return i + first_byte(m);
+    }
+  }
+#endif
+
+  for (; i < len; i++) {
+    if (d[i] == (uint8_t)set || d[i] == (uint8_t)(set >> 8) ||
+        d[i] == (uint8_t)(set >> 16) || d[i] == (uint8_t)(set >> 24)) {
+      return i;
+    }
+  }
+
+  return len;
+}
+
+RAM_FUNC size_t simd_span_text(const uint8_t *d, size_t len) {
+  size_t i = 0;
+
+#if SIMD_DSP
+  for (; i + 4 <= len; i += 4) {
+    uint32_t w = __UNALIGNED_UINT32_READ(&d[i]);
+    uint32_t bad;
+
+    __USUB8(w, 0x20202020U); // GE: 0x20 이상
+    bad = __SEL(0, 0xFFFFFFFFU);
+    __USUB8(0x7E7E7E7EU, w); // GE: 0x7E 이하
+    bad = __SEL(bad, 0xFFFFFFFFU);
+
+    if (bad) {
+      return i + first_byte(bad);
+    }
+  }
+#endif
+
+  for (; i < len; i++) {
+    if (d[i] < 0x20 || d[i] > 0x7E) {
+      return i;
+    }
+  }
+
+  return len;
+}
+
+char *simd_hex_encode(char *dst, const uint8_t *src, size_t len) {
+  static const char digit[16] = "0123456789ABCDEF";
+  size_t i = 0;
+
+#if SIMD_DSP
+  for (; i + 4 <= len; i += 4) {
+    uint32_t w = __UNALIGNED_UINT32_READ(&src[i]);
+    uint32_t hi = (w >> 4) & 0x0F0F0F0FU;
+    uint32_t lo = w & 0x0F0F0F0FU;
+    uint32_t p02 = __UXTB16(hi) | (__UXTB16(lo) << 8);           // h0 l0 h2 l2
+    uint32_t p13 = __UXTB16(hi >> 8) | (__UXTB16(lo >> 8) << 8); // h1 l1 h3 l3
+
+    __UNALIGNED_UINT32_WRITE(dst, hex_digits4(__PKHBT(p02, p13, 16)));
+    __UNALIGNED_UINT32_WRITE(dst + 4, hex_digits4(__PKHTB(p13, p02, 16)));
+    dst += 8;
+  }
+#endif
+
+  for (; i < len; i++) {
+    *dst++ = digit[src[i] >> 4];
+    *dst++ = digit[src[i] & 0x0F];
+  }
+
+  return dst;
+}
+
+size_t simd_hex_decode(uint8_t *dst, const char *src, size_t len) {
+  const uint8_t *s = (const uint8_t *)src;
+  size_t i = 0;
+
+#if SIMD_DSP
+  for (; i + 2 <= len; i += 2, s += 4) {
+    uint32_t n;
+
+    if (!hex_nibbles4(__UNALIGNED_UINT32_READ(s), &n)) {
+      break; // 아래에서 멈춘 자리를 바이트 단위로
+    }
+    n = (n << 4) | (n >> 8);
+    dst[i] = (uint8_t)n;
+    dst[i + 1] = (uint8_t)(n >> 16);
+  }
+#endif
+
+  for (; i < len; i++, s += 2) {
+    int hi = hex_val(s[0]);
+    if (hi < 0) {
+      break;
+    }
+    int lo = hex_val(s[1]);
+    if (lo < 0) {
+      break;
+    }
+    dst[i] = (uint8_t)((hi << 4) | lo);
+  }
+
+  return i;
+}
+
+RAM_FUNC void simd_fletcher8(const uint8_t *d, size_t len, uint8_t *ck_a, uint8_t *ck_b) {
+  /* 32 비트에서 넘쳐도 mod 256 은 그대로 */
+  uint32_t a = *ck_a;
+  uint32_t b = *ck_b;
+  size_t i = 0;
+
+  /* 4 바이트: b += 4a + 4d0 + 3d1 + 2d2 + d3, a += d0 + d1 + d2 + d3 */
+  for (; i + 4 <= len; i += 4) {
+#if SIMD_DSP
+    uint32_t w = __UNALIGNED_UINT32_READ(&d[i]);
+
+    b += (a << 2) + __SMLAD(__UXTB16(w), 0x00020004U,
+                            __SMLAD(__UXTB16(w >> 8), 0x00010003U, 0));
+    a += __USAD8(w, 0);
+#else
+    b += (a << 2) + 4U * d[i] + 3U * d[i + 1] + 2U * d[i + 2] + d[i + 3];
+    a += (uint32_t)d[i] + d[i + 1] + d[i + 2] + d[i + 3];
+#endif
+  }
+
+  for (; i < len; i++) {
+    a += d[i];
+    b += a;
+  }
+
+  *ck_a = (uint8_t)a;
+  *ck_b = (uint8_t)b;
+}
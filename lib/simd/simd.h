@@ -0,0 +1,65 @@
+#ifndef SIMD_H
+#define SIMD_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief 바이트 스캔/체크섬/HEX 커널 (Cortex-M4 DSP SIMD)
+ *
+ * M4 의 4x8 비트 SIMD 명령 (UQSUB8, USUB8/SEL, UADD8, USAD8) 으로 한 워드
+ * (4 바이트) 씩 처리한다. 입력 정렬은 상관없다 (M4 LDR 은 비정렬 허용).
+ * DSP 확장이 없는 빌드 (호스트 bench/sim) 는 같은 결과를 내는 바이트 단위
+ * C 구현을 쓴다.
+ */
+
+/**
+ * @brief 찾을 바이트 4개 (같은 값을 반복해 4개보다 적게 찾을 수 있음)
+ */
+#define SIMD_SET4(a, b, c, d)                                                  \
+  ((uint32_t)(uint8_t)(a) | ((uint32_t)(uint8_t)(b) << 8) |                    \
+   ((uint32_t)(uint8_t)(c) << 16) | ((uint32_t)(uint8_t)(d) << 24))
+
+/**
+ * @brief set 의 바이트 중 하나가 처음 나오는 위치
+ *
+ * @param[in] set SIMD_SET4()
+ * @return size_t 위치, 없으면 len
+ */
+size_t simd_find_any4(const uint8_t *d, size_t len, uint32_t set);
+
+/**
+ * @brief 앞에서부터 출력 가능한 ASCII (0x20~0x7E) 가 이어지는 길이
+ *
+ * 줄 파서에서 CR/LF (와 제어/바이너리 바이트) 까지 한 번에 건너뛰는 용도.
+ *
+ * @return size_t 첫 CR/LF/제어 문자 위치, 없으면 len
+ */
+size_t simd_span_text(const uint8_t *d, size_t len);
+
+/**
+ * @brief 바이너리를 대문자 HEX 로 (종료 문자 없음)
+ *
+ * @param[out] dst len * 2 이상
+ * @return char* 마지막으로 쓴 문자 다음
+ */
+char *simd_hex_encode(char *dst, const uint8_t *src, size_t len);
+
+/**
+ * @brief HEX 2문자씩 len 바이트까지 변환 (대소문자 모두)
+ *
+ * src 에서 len * 2 문자를 읽을 수 있어야 한다 (길이를 아는 버퍼만).
+ *
+ * @return size_t 변환한 바이트 수 (HEX 가 아닌 문자에서 멈춤)
+ */
+size_t simd_hex_decode(uint8_t *dst, const char *src, size_t len);
+
+/**
+ * @brief 8 비트 Fletcher (UBX 체크섬), ck_a/ck_b 에 이어서 누적
+ *
+ * *ck_a, *ck_b 를 0 으로 두고 부르면 새로 계산.
+ */
+void simd_fletcher8(const uint8_t *d, size_t len, uint8_t *ck_a, uint8_t *ck_b);
+
+#endif
@@ -0,0 +1,194 @@
+#include "tmo_wheel.h"
+#include "task.h"
+#include "rtos_static.h"
+
+// slot 폭 2^3 tick (8 ms), 64 slot 이면 한 바퀴 512 ms
+// 폭이 2 의 거듭제곱이라 tick 이 2^32 에서 wrap 해도 slot 번호가 이어진다
+#define TMO_WHEEL_SHIFT 3
+#define TMO_WHEEL_SLOTS 64
+#define TMO_SLOT(tick) (((tick) >> TMO_WHEEL_SHIFT) & (TMO_WHEEL_SLOTS - 1))
+
+static tmo_t *tmo_slot[TMO_WHEEL_SLOTS];
+static TickType_t tmo_cursor; // 다 본 slot 다음 (tick >> SHIFT)
+static TickType_t tmo_wake;   // 서비스가 깨기로 한 tick
+static bool tmo_sleeping;     // 걸린 것이 없어 무기한 대기 중
+static TaskHandle_t tmo_task_handle;
+
+RTOS_STATIC_TASK(tmo_wheel, 256);
+
+/* 아래 목록 함수는 critical section 안에서 부름 */
+
+static void tmo_link(tmo_t *tmo) {
+  tmo_t **head = &tmo_slot[TMO_SLOT(tmo->due)];
+
+  tmo->next = *head;
+  if (tmo->next) {
+    tmo->next->pprev = &tmo->next;
+  }
+  *head = tmo;
+  tmo->pprev = head;
+}
+
+static void tmo_unlink(tmo_t *tmo) {
+  *tmo->pprev = tmo->next;
+  if (tmo->next) {
+    tmo->next->pprev = tmo->pprev;
+  }
+  tmo->next = NULL;
+  tmo->pprev = NULL;
+}
+
+static tmo_t *tmo_pop_expired(uint32_t slot, TickType_t now) {
+  tmo_t *tmo;
+
+  taskENTER_CRITICAL();
+  for (tmo = tmo_slot[slot]; tmo; tmo = tmo->next) {
+    if ((int32_t)(tmo->due - now) <= 0) {
+      tmo_unlink(tmo);
+      break;
+    }
+  }
+  taskEXIT_CRITICAL();
+
+  return tmo;
+}
+
+/**
+ * @brief slot 하나에서 때가 된 것 만료 (다음 바퀴 것은 남김)
+ */
+static void tmo_expire_slot(uint32_t slot, TickType_t now) {
+  tmo_t *tmo;
+
+  // 콜백은 잠금 밖에서 (같은 항목을 다시 걸 수 있음)
+  while ((tmo = tmo_pop_expired(slot, now)) != NULL) {
+    if (tmo->fn) {
+      tmo->fn(tmo);
+    }
+  }
+}
+
+static void tmo_run(TickType_t now) {
+  TickType_t now_slot = now >> TMO_WHEEL_SHIFT;
+  uint32_t n = 0;
+
+  // 지난 slot (한 바퀴 이상 밀렸으면 한 바퀴만 보면 됨)
+  while ((int32_t)(now_slot - tmo_cursor) > 0) {
+    if (n++ < TMO_WHEEL_SLOTS) {
+      tmo_expire_slot(tmo_cursor & (TMO_WHEEL_SLOTS - 1), now);
+    }
+    tmo_cursor++;
+  }
+
+  // 지금 slot 은 만료 시각이 지난 것만
+  tmo_expire_slot(TMO_SLOT(now), now);
+}
+
+/**
+ * @brief 다음에 깰 때까지 tick
+ *
+ * 지금 slot 은 이번 바퀴 항목의 만료 시각, 그 뒤로는 첫 번째로 비지 않은
+ * slot 의 시작에 깬다 (다음 바퀴 항목이면 한 번 헛깸).
+ */
+static TickType_t tmo_next_wait(TickType_t now) {
+  TickType_t slot_end = ((now >> TMO_WHEEL_SHIFT) + 1) << TMO_WHEEL_SHIFT;
+  TickType_t wait = portMAX_DELAY;
+
+  taskENTER_CRITICAL();
+  for (tmo_t *tmo = tmo_slot[TMO_SLOT(now)]; tmo; tmo = tmo->next) {
+    TickType_t left = (int32_t)(tmo->due - now) > 0 ? tmo->due - now : 0;
+
+    if ((int32_t)(tmo->due - slot_end) < 0 && left < wait) {
+      wait = left;
+    }
+  }
+
+  if (wait == portMAX_DELAY) {
+    for (uint32_t i = 1; i < TMO_WHEEL_SLOTS; i++) {
+      if (tmo_slot[TMO_SLOT(now + (i << TMO_WHEEL_SHIFT))]) {
+        wait = ((i - 1) << TMO_WHEEL_SHIFT) + (slot_end - now);
+        break;
+      }
+    }
+  }
+
+  tmo_sleeping = wait == portMAX_DELAY;
+  tmo_wake = now + wait;
+  taskEXIT_CRITICAL();
+
+  return wait;
+}
+
+static void tmo_task(void *arg) {
+  (void)arg;
+
+  tmo_cursor = xTaskGetTickCount() >> TMO_WHEEL_SHIFT;
+
+  while (1) {
+    TickType_t now = xTaskGetTickCount();
+
+    tmo_run(now);
+
+    // 계산 뒤에 걸린 것은 notification 이 남아 있어 바로 다시 돈다
+    ulTaskNotifyTake(pdTRUE, tmo_next_wait(now));
+  }
+}
+
+void tmo_wheel_init(void) {
+  if (tmo_task_handle) {
+    return;
+  }
+
+  // 콜백은 깨우기만 하므로 엔진 태스크보다 위, timer 서비스 바로 아래
+  tmo_task_handle = RTOS_TASK_CREATE_STATIC(tmo_wheel, tmo_task, "tmo_wheel", NULL,
+                                            configTIMER_TASK_PRIORITY - 1);
+}
+
+void tmo_init(tmo_t *tmo, tmo_fn_t fn, void *arg) {
+  tmo->next = NULL;
+  tmo->pprev = NULL;
+  tmo->due = 0;
+  tmo->fn = fn;
+  tmo->arg = arg;
+}
+
+bool tmo_arm(tmo_t *tmo, uint32_t timeout_ms) {
+  TickType_t ticks = pdMS_TO_TICKS(timeout_ms);
+  bool wake;
+
+  if (!tmo_task_handle) {
+    return false;
+  }
+
+  taskENTER_CRITICAL();
+  if (tmo->pprev) {
+    tmo_unlink(tmo);
+  }
+  tmo->due = xTaskGetTickCount() + (ticks ? ticks : 1);
+  tmo_link(tmo);
+
+  // 서비스가 깨기로 한 때보다 먼저면 다시 계산하도록
+  wake = tmo_sleeping || (int32_t)(tmo->due - tmo_wake) < 0;
+  if (wake) {
+    tmo_sleeping = false;
+    tmo_wake = tmo->due;
+  }
+  taskEXIT_CRITICAL();
+
+  if (wake) {
+    xTaskNotifyGive(tmo_task_handle);
+  }
+  return true;
+}
+
+bool tmo_cancel(tmo_t *tmo) {
+  bool removed = false;
+
+  taskENTER_CRITICAL();
+  if (tmo->pprev) {
+    tmo_unlink(tmo);
+    removed = true;
+  }
+  taskEXIT_CRITICAL();
+
+  return removed;
+}
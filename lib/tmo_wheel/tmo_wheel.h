@@ -0,0 +1,64 @@
+#ifndef TMO_WHEEL_H
+#define TMO_WHEEL_H
+
+#include "FreeRTOS.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief 공용 타임아웃 휠 (명령/응답 엔진용)
+ *
+ * 명령을 보낼 때 걸고 응답이 오면 푸는 타임아웃을 FreeRTOS 타이머나 tick
+ * 폴링 없이 한 서비스 태스크가 모아서 처리한다. 만료 시각으로 slot 을 골라
+ * 양방향 목록에 넣으므로 걸기/풀기는 O(1) 이다.
+ *
+ * 만료 콜백은 서비스 태스크 (높은 우선순위) 에서 돈다. 엔진 태스크를 깨우거나
+ * 큐에 넣는 정도로 짧게 끝내고, 실제 처리는 엔진 태스크나 work_queue 에서 한다.
+ */
+
+typedef struct tmo tmo_t;
+
+typedef void (*tmo_fn_t)(tmo_t *tmo);
+
+struct tmo {
+  tmo_t *next;    // slot 목록 (내부)
+  tmo_t **pprev;  // NULL 이면 안 걸림 (내부)
+  TickType_t due; // 만료 tick (내부)
+  tmo_fn_t fn;
+  void *arg;
+};
+
+/**
+ * @brief 정적 초기화
+ */
+#define TMO_INIT(fn, arg) {NULL, NULL, 0, (fn), (arg)}
+
+/**
+ * @brief 서비스 태스크 생성 (스케줄러 시작 후 init 태스크, 타임아웃을 걸기 전)
+ */
+void tmo_wheel_init(void);
+
+/**
+ * @brief 타임아웃 항목 초기화 (안 걸려 있을 때만)
+ */
+void tmo_init(tmo_t *tmo, tmo_fn_t fn, void *arg);
+
+/**
+ * @brief timeout_ms 뒤 만료되도록 걸기 (태스크 컨텍스트)
+ *
+ * 이미 걸려 있으면 지금부터 다시 잰다. 0 은 다음 tick.
+ *
+ * @return false 서비스가 없음 (tmo_wheel_init 전)
+ */
+bool tmo_arm(tmo_t *tmo, uint32_t timeout_ms);
+
+/**
+ * @brief 걸린 타임아웃 풀기
+ *
+ * @return true 풀었음, false 안 걸려 있었음 (이미 만료돼 콜백이 돌았거나 도는 중)
+ */
+bool tmo_cancel(tmo_t *tmo);
+
+static inline bool tmo_armed(const tmo_t *tmo) { return tmo->pprev != NULL; }
+
+#endif
@@ -0,0 +1,160 @@
+#include "tx_pool.h"
+#include "mem_section.h"
+#include "task.h"
+#include <string.h>
+
+#define TX_POOL_CNT (TX_POOL_SMALL_CNT + TX_POOL_MID_CNT + TX_POOL_LARGE_CNT)
+
+// 모두 비었을 때 다시 볼 간격
+#define TX_POOL_RETRY_MS 2
+
+CCM_NOINIT static char tx_pool_small_mem[TX_POOL_SMALL_CNT][TX_POOL_SMALL_SIZE];
+CCM_NOINIT static char tx_pool_mid_mem[TX_POOL_MID_CNT][TX_POOL_MID_SIZE];
+CCM_NOINIT static char tx_pool_large_mem[TX_POOL_LARGE_CNT][TX_POOL_LARGE_SIZE];
+
+static tx_buf_t tx_pool_hdr[TX_POOL_CNT];
+
+static struct {
+  tx_buf_t *free_list;
+  uint16_t first; ///< tx_pool_hdr 에서 이 등급의 시작 index
+  tx_pool_stats_t stats;
+} tx_pool[TX_POOL_CLASS_CNT] = {
+    {.first = 0, .stats = {.size = TX_POOL_SMALL_SIZE, .total = TX_POOL_SMALL_CNT}},
+    {.first = TX_POOL_SMALL_CNT,
+     .stats = {.size = TX_POOL_MID_SIZE, .total = TX_POOL_MID_CNT}},
+    {.first = TX_POOL_SMALL_CNT + TX_POOL_MID_CNT,
+     .stats = {.size = TX_POOL_LARGE_SIZE, .total = TX_POOL_LARGE_CNT}},
+};
+
+static bool tx_pool_ready;
+
+void tx_pool_init(void) {
+  if (tx_pool_ready) {
+    return;
+  }
+
+  for (uint8_t c = 0; c < TX_POOL_CLASS_CNT; c++) {
+    tx_pool[c].free_list = NULL;
+
+    for (uint16_t i = 0; i < tx_pool[c].stats.total; i++) {
+      tx_buf_t *buf = &tx_pool_hdr[tx_pool[c].first + i];
+
+      if (c == 0) {
+        buf->data = tx_pool_small_mem[i];
+      } else if (c == 1) {
+        buf->data = tx_pool_mid_mem[i];
+      } else {
+        buf->data = tx_pool_large_mem[i];
+      }
+      buf->size = tx_pool[c].stats.size;
+      buf->next = tx_pool[c].free_list;
+      tx_pool[c].free_list = buf;
+    }
+    tx_pool[c].stats.free = tx_pool[c].stats.total;
+    tx_pool[c].stats.min_free = tx_pool[c].stats.total;
+  }
+
+  tx_pool_ready = true;
+}
+
+static tx_buf_t *tx_pool_take(uint8_t c, bool count_fail) {
+  tx_buf_t *buf = NULL;
+
+  taskENTER_CRITICAL();
+  for (uint8_t k = c; k < TX_POOL_CLASS_CNT; k++) {
+    buf = tx_pool[k].free_list;
+    if (buf) {
+      tx_pool_stats_t *st = &tx_pool[k].stats;
+
+      tx_pool[k].free_list = buf->next;
+      if (--st->free < st->min_free) {
+        st->min_free = st->free;
+      }
+      if (k != c) {
+        tx_pool[c].stats.borrowed++;
+      }
+      break;
+    }
+  }
+  if (!buf && count_fail) {
+    tx_pool[c].stats.exhausted++;
+  }
+  taskEXIT_CRITICAL();
+
+  return buf;
+}
+
+tx_buf_t *tx_buf_alloc(size_t size, TickType_t wait) {
+  TickType_t start = xTaskGetTickCount();
+  tx_buf_t *buf;
+  uint8_t c = 0;
+
+  while (c < TX_POOL_CLASS_CNT && size > tx_pool[c].stats.size) {
+    c++;
+  }
+  if (c == TX_POOL_CLASS_CNT || !tx_pool_ready) {
+    return NULL;
+  }
+
+  buf = tx_pool_take(c, true);
+
+  // 반납은 TX 태스크가 보낸 뒤에만 하므로 드묾, 잠깐씩 자면서 다시 봄
+  while (!buf && xTaskGetTickCount() - start < wait) {
+    vTaskDelay(pdMS_TO_TICKS(TX_POOL_RETRY_MS));
+    buf = tx_pool_take(c, false);
+  }
+
+  if (!buf) {
+    return NULL;
+  }
+
+  buf->len = 0;
+  buf->flags = 0;
+  buf->next = NULL;
+
+  return buf;
+}
+
+tx_buf_t *tx_buf_dup(const void *data, size_t len, TickType_t wait) {
+  tx_buf_t *buf = tx_buf_alloc(len, wait);
+
+  if (buf) {
+    memcpy(buf->data, data, len);
+    buf->len = len;
+  }
+
+  return buf;
+}
+
+void tx_buf_free(tx_buf_t *buf) {
+  if (!buf) {
+    return;
+  }
+
+  if (buf < &tx_pool_hdr[0] || buf >= &tx_pool_hdr[TX_POOL_CNT]) {
+    return;
+  }
+
+  uint16_t idx = (uint16_t)(buf - tx_pool_hdr);
+  uint8_t c = TX_POOL_CLASS_CNT - 1;
+  while (c > 0 && idx < tx_pool[c].first) {
+    c--;
+  }
+
+  taskENTER_CRITICAL();
+  buf->next = tx_pool[c].free_list;
+  tx_pool[c].free_list = buf;
+  tx_pool[c].stats.free++;
+  taskEXIT_CRITICAL();
+}
+
+bool tx_pool_get_stats(uint8_t cls, tx_pool_stats_t *out) {
+  if (cls >= TX_POOL_CLASS_CNT || !out) {
+    return false;
+  }
+
+  taskENTER_CRITICAL();
+  *out = tx_pool[cls].stats;
+  taskEXIT_CRITICAL();
+  return true;
+}
@@ -0,0 +1,83 @@
+#ifndef TX_POOL_H
+#define TX_POOL_H
+
+#include "FreeRTOS.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief 공용 송신 버퍼 풀 (BLE/RS485/GPS TX 큐)
+ *
+ * 모듈 TX 큐에는 버퍼 포인터만 넣고, 버퍼는 보낼 길이에 맞는 크기 등급에서
+ * 꺼낸다. 요청마다 최대 길이짜리 구조체를 큐에 넣고 빼며 두 번 복사하던 것이
+ * 보낼 데이터 한 번 복사로 줄고, 모듈마다 최대 길이 × 큐 깊이로 잡던 저장소를
+ * 풀 하나가 나눠 쓴다.
+ *
+ * 꺼낸 쪽이 큐에 넘기면 소유권도 넘어가고, 보낸 쪽 (TX 태스크) 이 반납한다.
+ */
+#define TX_POOL_SMALL_SIZE 64
+#define TX_POOL_SMALL_CNT 12
+#define TX_POOL_MID_SIZE 256
+#define TX_POOL_MID_CNT 6
+#define TX_POOL_LARGE_SIZE 512
+#define TX_POOL_LARGE_CNT 2
+#define TX_POOL_CLASS_CNT 3
+
+typedef struct tx_buf {
+  char *data;          ///< CCM (uart_tx 가 bounce 로 복사해서 DMA)
+  uint16_t size;       ///< data 크기
+  uint16_t len;        ///< 채운 길이
+  uint8_t flags;       ///< 모듈이 씀 (예: BLE AT 여부)
+  struct tx_buf *next; ///< 빈 목록 (내부)
+} tx_buf_t;
+
+/**
+ * @brief 풀 등급별 통계
+ */
+typedef struct {
+  uint16_t size;      ///< 블록 크기
+  uint16_t total;     ///< 블록 수
+  uint16_t free;      ///< 현재 남은 블록
+  uint16_t min_free;  ///< 부팅 후 최소 남은 블록
+  uint32_t borrowed;  ///< 이 등급이 비어서 큰 등급에서 꺼낸 횟수
+  uint32_t exhausted; ///< 이 등급 이상이 모두 비어 기다리거나 실패한 횟수
+} tx_pool_stats_t;
+
+/**
+ * @brief 풀 초기화 (main, 모듈 init 전)
+ */
+void tx_pool_init(void);
+
+/**
+ * @brief size 이상인 버퍼 꺼내기 (태스크 컨텍스트)
+ *
+ * 맞는 등급이 비었으면 더 큰 등급에서 꺼낸다. 모두 비었으면 TX 태스크가
+ * 반납할 때까지 짧게 자면서 wait 만큼 다시 본다 (모듈 큐가 가득 찼을 때
+ * 기다리던 것과 같은 역할).
+ *
+ * @param[in] size 필요한 byte (최대 TX_POOL_LARGE_SIZE)
+ * @param[in] wait tick
+ * @return tx_buf_t* len 0, flags 0 인 버퍼, 없으면 NULL
+ */
+tx_buf_t *tx_buf_alloc(size_t size, TickType_t wait);
+
+/**
+ * @brief 꺼내서 data 를 복사 (len 설정)
+ */
+tx_buf_t *tx_buf_dup(const void *data, size_t len, TickType_t wait);
+
+/**
+ * @brief 반납 (NULL 무시)
+ */
+void tx_buf_free(tx_buf_t *buf);
+
+/**
+ * @brief 등급별 통계 조회
+ *
+ * @param cls 등급 (0: small, 1: mid, 2: large)
+ * @return true 유효한 등급
+ */
+bool tx_pool_get_stats(uint8_t cls, tx_pool_stats_t *out);
+
+#endif
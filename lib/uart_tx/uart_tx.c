@@ -0,0 +1,765 @@
+#include "uart_tx.h"
+#include "stm32f4xx_ll_bus.h"
+#include "task.h"
+#include <string.h>
+
+#ifndef TAG
+#define TAG "UART_TX"
+#endif
+
+#include "log.h"
+
+#define CCMRAM_START 0x10000000UL
+#define CCMRAM_END 0x10010000UL
+
+#define DMA_MAX_XFER 0xFFFFU
+
+/* DMA LISR/HISR 안에서 stream 별 플래그 위치 (stream % 4) */
+static const uint8_t dma_flag_shift[4] = {0, 6, 16, 22};
+
+#define DMA_STREAM_FLAG_FE (1U << 0)
+#define DMA_STREAM_FLAG_DME (1U << 2)
+#define DMA_STREAM_FLAG_TE (1U << 3)
+#define DMA_STREAM_FLAG_HT (1U << 4)
+#define DMA_STREAM_FLAG_TC (1U << 5)
+#define DMA_STREAM_FLAG_ALL                                                    \
+  (DMA_STREAM_FLAG_FE | DMA_STREAM_FLAG_DME | DMA_STREAM_FLAG_TE |             \
+   DMA_STREAM_FLAG_HT | DMA_STREAM_FLAG_TC)
+
+static inline uint32_t dma_get_flags(const uart_tx_t *tx) {
+  uint32_t isr = (tx->stream < 4) ? tx->dma->LISR : tx->dma->HISR;
+  return (isr >> dma_flag_shift[tx->stream & 3]) & DMA_STREAM_FLAG_ALL;
+}
+
+static inline void dma_clear_flags(const uart_tx_t *tx, uint32_t flags) {
+  if (tx->stream < 4) {
+    tx->dma->LIFCR = flags << dma_flag_shift[tx->stream & 3];
+  } else {
+    tx->dma->HIFCR = flags << dma_flag_shift[tx->stream & 3];
+  }
+}
+
+static inline bool is_ccmram(const void *p) {
+  return (uint32_t)p >= CCMRAM_START && (uint32_t)p < CCMRAM_END;
+}
+
+/**
+ * @brief 세마포어로 잠들 수 있는 컨텍스트인지
+ *
+ * 스케줄러 시작 전(보드 초기화 중 보레이트 설정 등)이나 ISR 에서는
+ * 기존처럼 폴링으로 보낸다.
+ */
+static inline bool tx_can_block(void) {
+  return __get_IPSR() == 0 &&
+         xTaskGetSchedulerState() == taskSCHEDULER_RUNNING;
+}
+
+static void tx_poll(uart_tx_t *tx, const uint8_t *data, size_t len) {
+  for (size_t i = 0; i < len; i++) {
+    while (!LL_USART_IsActiveFlag_TXE(tx->uart))
+      ;
+    LL_USART_TransmitData8(tx->uart, data[i]);
+  }
+}
+
+static inline void tx_wait_tc(uart_tx_t *tx) {
+  while (!LL_USART_IsActiveFlag_TC(tx->uart))
+    ;
+}
+
+/**
+ * @brief 진행 중이던 스트림 구간을 보낸 것으로 치고 버림
+ *
+ * DMA 가 멈춘 뒤(강제 중단, 재초기화)에 불러야 한다.
+ */
+static void tx_stream_cancel(uart_tx_t *tx) {
+  uart_tx_stream_t *s = tx->ring;
+
+  if (s && s->chunk) {
+    s->tail += s->chunk;
+    s->chunk = 0;
+  }
+}
+
+static void tx_abort(uart_tx_t *tx) {
+  LL_DMA_DisableStream(tx->dma, tx->stream);
+  while (LL_DMA_IsEnabledStream(tx->dma, tx->stream))
+    ;
+  dma_clear_flags(tx, DMA_STREAM_FLAG_ALL);
+  tx->callback = NULL;
+  tx->inflight_len = 0;
+  tx_stream_cancel(tx);
+}
+
+/**
+ * @brief 진행 중인 DMA 전송이 끝날 때까지 대기 (lock 보유 상태에서 호출)
+ *
+ * 리턴 후 done_sem 은 호출자가 가지고 있고 DMA 는 유휴 상태다.
+ *
+ * @return true 직전 전송 정상 완료, false 에러 또는 타임아웃(강제 중단)
+ */
+static bool tx_wait_idle(uart_tx_t *tx) {
+  size_t len = tx->inflight_len;
+  bool ok;
+
+  // 스트림은 프레임 경계 (NORMAL 송신자면 yield_pos) 까지 이어 보낸다
+  if (tx->ring) {
+    len += tx->ring->head - tx->ring->tail;
+  }
+
+  TickType_t timeout = pdMS_TO_TICKS(UART_TX_TIMEOUT_MS(len));
+
+  // 스트림이 DMA 를 이어서 쓰고 있으면 넘길 자리까지만 보내고 넘겨받는다
+  tx->yield_req = true;
+  ok = xSemaphoreTake(tx->done_sem, timeout) == pdTRUE;
+  tx->yield_req = false;
+
+  if (!ok) {
+    LOG_ERR("TX DMA timeout (%u bytes)", (unsigned)tx->inflight_len);
+    tx_abort(tx);
+    return false;
+  }
+
+  return !tx->error;
+}
+
+static void tx_start(uart_tx_t *tx, const uint8_t *data, size_t len) {
+  tx->error = false;
+  tx->inflight_len = len;
+
+  dma_clear_flags(tx, DMA_STREAM_FLAG_ALL);
+  LL_DMA_SetMemoryAddress(tx->dma, tx->stream, (uint32_t)data);
+  LL_DMA_SetDataLength(tx->dma, tx->stream, len);
+  LL_USART_ClearFlag_TC(tx->uart);
+  LL_DMA_EnableStream(tx->dma, tx->stream);
+}
+
+/**
+ * @brief tail 이 지나간 송신 완료 표시를 꺼내 콜백 호출 (ISR 또는 critical)
+ */
+static void tx_stream_retire_marks(uart_tx_stream_t *s) {
+  while (s->mark_tail != s->mark_head) {
+    uint8_t i = s->mark_tail & (UART_TX_STREAM_MARKS - 1);
+
+    if ((intptr_t)(s->tail - s->marks[i].pos) < 0) {
+      break;
+    }
+    if (s->on_mark) {
+      s->on_mark(s->marks[i].tag, s->mark_ctx);
+    }
+    s->mark_tail++;
+  }
+}
+
+/**
+ * @brief tail 이 지나간 프레임 끝을 꺼냄 (ISR 또는 critical)
+ *
+ * @return true tail 이 프레임 경계 (프레임 없이 쓰는 스트림은 항상)
+ */
+static bool tx_stream_retire_frames(uart_tx_stream_t *s) {
+  bool at = false;
+
+  while (s->frame_tail != s->frame_head) {
+    size_t pos = s->frames[s->frame_tail & (UART_TX_STREAM_FRAMES - 1)];
+
+    if ((intptr_t)(s->tail - pos) < 0) {
+      return at;
+    }
+    at = pos == s->tail;
+    s->frame_tail++;
+  }
+
+  return true;
+}
+
+/**
+ * @brief 스트림 구간 하나가 끝난 뒤 기다리는 송신자에게 넘겨도 되는지 (ISR)
+ *
+ * 프레임 중간이면 안 되고, NORMAL 송신자는 기다리기 시작할 때 링에
+ * 있던 데이터가 다 나갈 때까지 기다린다.
+ */
+static bool tx_stream_can_yield(const uart_tx_t *tx, uart_tx_stream_t *s) {
+  if (!tx_stream_retire_frames(s)) {
+    return false;
+  }
+
+  return !tx->yield_wait || (intptr_t)(s->tail - tx->yield_pos) >= 0;
+}
+
+/**
+ * @brief 스트림 ring 에 쌓인 다음 구간 DMA 시작 (done_sem 보유 쪽에서 호출)
+ *
+ * ring 끝에서 감기는 부분은 다음 구간으로 나눠 보낸다.
+ *
+ * @return true DMA 시작됨 (done_sem 은 이 전송 완료 ISR 이 이어받음)
+ */
+static bool tx_stream_start(uart_tx_t *tx) {
+  uart_tx_stream_t *s = tx->ring;
+
+  if (!s || s->chunk) {
+    return false;
+  }
+
+  size_t avail = s->head - s->tail;
+  if (avail == 0) {
+    return false;
+  }
+
+  size_t off = s->tail & (s->size - 1);
+  size_t n = s->size - off;
+
+  if (n > avail) {
+    n = avail;
+  }
+  if (n > UART_TX_STREAM_CHUNK) {
+    n = UART_TX_STREAM_CHUNK;
+  }
+
+  // 구간을 프레임 끝에서 끊어야 그 자리에서 다른 송신자에게 넘길 수 있다
+  if (s->frame_tail != s->frame_head) {
+    size_t to = s->frames[s->frame_tail & (UART_TX_STREAM_FRAMES - 1)] - s->tail;
+
+    if ((intptr_t)to > 0 && n > to) {
+      n = to;
+    }
+  }
+
+  s->chunk = n;
+  tx->callback = NULL;
+  tx_start(tx, &s->buf[off], n);
+
+  return true;
+}
+
+/**
+ * @brief 유휴 채널이면 스트림 송신 시작 (태스크 컨텍스트, 블로킹 없음)
+ *
+ * 다른 송신자가 lock 이나 DMA 를 쓰는 중이면 그쪽이 끝날 때 이어서
+ * 시작하므로 여기서는 기다리지 않는다.
+ */
+static void tx_stream_kick(uart_tx_t *tx) {
+  uart_tx_stream_t *s = tx->ring;
+  bool started;
+
+  if (!s || s->chunk || s->head == s->tail || !tx_can_block()) {
+    return;
+  }
+
+  if (xSemaphoreTake(tx->lock, 0) != pdTRUE) {
+    return;
+  }
+
+  if (xSemaphoreTake(tx->done_sem, 0) == pdTRUE) {
+    taskENTER_CRITICAL();
+    started = tx_stream_start(tx);
+    taskEXIT_CRITICAL();
+
+    if (!started) {
+      xSemaphoreGive(tx->done_sem);
+    }
+  }
+
+  xSemaphoreGive(tx->lock);
+}
+
+/**
+ * @brief UART DMA 송신 채널 초기화
+ *
+ * USART 초기화 후에 호출. 채널은 RX 와 겹치지 않는 stream 을 써야 한다.
+ *
+ * @param[out] tx
+ * @param[in] uart USART 인스턴스
+ * @param[in] dma DMA1/DMA2
+ * @param[in] stream LL_DMA_STREAM_x
+ * @param[in] channel LL_DMA_CHANNEL_x
+ * @param[in] irq DMA stream IRQ 번호
+ * @param[in] dma_prio stream 중재 순위 (0 LOW ~ 3 VERY HIGH)
+ * @param[in] irq_prio NVIC 선점 순위
+ * @return true 성공
+ */
+bool uart_tx_init(uart_tx_t *tx, USART_TypeDef *uart, DMA_TypeDef *dma,
+                  uint32_t stream, uint32_t channel, IRQn_Type irq,
+                  uint8_t dma_prio, uint8_t irq_prio) {
+  tx->uart = uart;
+  tx->dma = dma;
+  tx->stream = stream;
+  tx->inflight_len = 0;
+  tx->error = false;
+  tx->callback = NULL;
+  tx->user_data = NULL;
+  tx->yield_req = false;
+  tx->yield_wait = false;
+  tx_stream_cancel(tx);
+
+  // 보레이트 변경 등으로 다시 초기화되는 경우 기존 세마포어 재사용
+  if (!tx->lock) {
+    tx->lock = xSemaphoreCreateMutex();
+  }
+  if (!tx->done_sem) {
+    tx->done_sem = xSemaphoreCreateBinary();
+    if (tx->done_sem) {
+      xSemaphoreGive(tx->done_sem);
+    }
+  }
+  if (!tx->lock || !tx->done_sem) {
+    LOG_ERR("UART TX semaphore create failed");
+    return false;
+  }
+
+  if (dma == DMA1) {
+    LL_AHB1_GRP1_EnableClock(LL_AHB1_GRP1_PERIPH_DMA1);
+  } else {
+    LL_AHB1_GRP1_EnableClock(LL_AHB1_GRP1_PERIPH_DMA2);
+  }
+
+  LL_DMA_DisableStream(dma, stream);
+  LL_DMA_SetChannelSelection(dma, stream, channel);
+  LL_DMA_SetDataTransferDirection(dma, stream,
+                                  LL_DMA_DIRECTION_MEMORY_TO_PERIPH);
+  LL_DMA_SetStreamPriorityLevel(dma, stream, UART_DMA_PRIO(dma_prio));
+  LL_DMA_SetMode(dma, stream, LL_DMA_MODE_NORMAL);
+  LL_DMA_SetPeriphIncMode(dma, stream, LL_DMA_PERIPH_NOINCREMENT);
+  LL_DMA_SetMemoryIncMode(dma, stream, LL_DMA_MEMORY_INCREMENT);
+  LL_DMA_SetPeriphSize(dma, stream, LL_DMA_PDATAALIGN_BYTE);
+  LL_DMA_SetMemorySize(dma, stream, LL_DMA_MDATAALIGN_BYTE);
+  LL_DMA_DisableFifoMode(dma, stream);
+  LL_DMA_SetPeriphAddress(dma, stream, (uint32_t)&uart->DR);
+
+  dma_clear_flags(tx, DMA_STREAM_FLAG_ALL);
+  LL_DMA_EnableIT_TC(dma, stream);
+  LL_DMA_EnableIT_TE(dma, stream);
+
+  NVIC_SetPriority(irq, UART_NVIC_PRIO(irq_prio));
+  NVIC_EnableIRQ(irq);
+
+  // stream 이 꺼져 있으면 TXE 요청은 무시되므로 폴링 송신과 같이 써도 된다
+  LL_USART_EnableDMAReq_TX(uart);
+
+  return true;
+}
+
+/**
+ * @brief 여러 구간을 순서대로 송신 (scatter-gather)
+ *
+ * 전송이 끝날 때까지 호출 태스크는 세마포어로 잠들어 있고 CPU 는 다른
+ * 태스크가 쓴다. 리턴 시점에 마지막 바이트까지 선로로 나간 상태
+ * (USART TC)이므로 버퍼는 스택이어도 되고 RS485 방향 전환도 바로 가능하다.
+ * 스트림이 붙어 있으면 다음 프레임 경계에서 끼어든다.
+ *
+ * @param[in] tx
+ * @param[in] segs 구간 배열
+ * @param[in] cnt 구간 개수
+ * @return int 0 성공, -1 실패
+ */
+int uart_tx_sendv(uart_tx_t *tx, const uart_tx_seg_t *segs, size_t cnt) {
+  return uart_tx_sendv_prio(tx, segs, cnt, UART_TX_PRIO_URGENT);
+}
+
+/**
+ * @brief 스트림과의 순위를 정해 송신 (uart_tx_sendv 참고)
+ *
+ * NORMAL 이면 lock 을 얻은 시점에 스트림 링에 있던 데이터가 다 나간
+ * 뒤에 보낸다. 스트림이 없는 채널에서는 uart_tx_sendv() 와 같다.
+ *
+ * @param[in] tx
+ * @param[in] segs 구간 배열
+ * @param[in] cnt 구간 개수
+ * @param[in] prio
+ * @return int 0 성공, -1 실패
+ */
+int uart_tx_sendv_prio(uart_tx_t *tx, const uart_tx_seg_t *segs, size_t cnt,
+                       uart_tx_prio_t prio) {
+  int ret = 0;
+
+  if (!tx->uart) {
+    return -1;
+  }
+
+  if (!tx->lock || !tx_can_block()) {
+    for (size_t i = 0; i < cnt; i++) {
+      tx_poll(tx, segs[i].data, segs[i].len);
+    }
+    tx_wait_tc(tx);
+    return 0;
+  }
+
+  xSemaphoreTake(tx->lock, portMAX_DELAY);
+
+  if (prio == UART_TX_PRIO_NORMAL && tx->ring) {
+    tx->yield_pos = tx->ring->head;
+    tx->yield_wait = true;
+  }
+
+  // 앞선 비동기 전송이 끝나야 done_sem 을 얻는다
+  tx_wait_idle(tx);
+  tx->yield_wait = false;
+
+  for (size_t i = 0; i < cnt && ret == 0; i++) {
+    const uint8_t *p = segs[i].data;
+    size_t remain = segs[i].len;
+
+    while (remain > 0) {
+      const uint8_t *src = p;
+      size_t n;
+
+      if (is_ccmram(p)) {
+        n = remain < UART_TX_BOUNCE_SIZE ? remain : UART_TX_BOUNCE_SIZE;
+        memcpy(tx->bounce, p, n);
+        src = tx->bounce;
+      } else {
+        n = remain < DMA_MAX_XFER ? remain : DMA_MAX_XFER;
+      }
+
+      tx->callback = NULL;
+      tx_start(tx, src, n);
+
+      if (!tx_wait_idle(tx)) {
+        ret = -1;
+        break;
+      }
+
+      p += n;
+      remain -= n;
+    }
+  }
+
+  tx_wait_tc(tx);
+  xSemaphoreGive(tx->done_sem);
+  xSemaphoreGive(tx->lock);
+
+  tx_stream_kick(tx);
+
+  return ret;
+}
+
+/**
+ * @brief 송신 (완료까지 태스크 sleep)
+ *
+ * @param[in] tx
+ * @param[in] data
+ * @param[in] len
+ * @return int 0 성공, -1 실패
+ */
+int uart_tx_send(uart_tx_t *tx, const void *data, size_t len) {
+  uart_tx_seg_t seg = {.data = data, .len = len};
+
+  return uart_tx_sendv(tx, &seg, 1);
+}
+
+/**
+ * @brief 비동기 송신
+ *
+ * 앞선 전송이 진행 중이면 끝날 때까지만 기다린 뒤 DMA 를 걸고 바로
+ * 리턴한다. data 는 callback 이 불릴 때까지 유지되어야 하며 CCM RAM 이면
+ * 안 된다.
+ *
+ * @param[in] tx
+ * @param[in] data
+ * @param[in] len 최대 65535
+ * @param[in] callback 완료 콜백 (ISR 컨텍스트, NULL 가능)
+ * @param[in] user_data
+ * @return true DMA 시작됨
+ */
+bool uart_tx_send_async(uart_tx_t *tx, const void *data, size_t len,
+                        uart_tx_callback_t callback, void *user_data) {
+  if (!tx->uart || len == 0 || len > DMA_MAX_XFER || is_ccmram(data)) {
+    LOG_ERR("Async TX invalid buffer %p (%u bytes)", data, (unsigned)len);
+    return false;
+  }
+
+  if (!tx->lock || !tx_can_block()) {
+    tx_poll(tx, data, len);
+    tx_wait_tc(tx);
+    if (callback) {
+      callback(true, user_data);
+    }
+    return true;
+  }
+
+  xSemaphoreTake(tx->lock, portMAX_DELAY);
+  tx_wait_idle(tx);
+
+  tx->callback = callback;
+  tx->user_data = user_data;
+  tx_start(tx, data, len);
+
+  xSemaphoreGive(tx->lock);
+
+  return true;
+}
+
+/**
+ * @brief 진행 중인 비동기 송신 완료 대기
+ *
+ * @param[in] tx
+ */
+void uart_tx_wait_complete(uart_tx_t *tx) {
+  if (!tx->lock || !tx_can_block()) {
+    return;
+  }
+
+  xSemaphoreTake(tx->lock, portMAX_DELAY);
+  tx_wait_idle(tx);
+  xSemaphoreGive(tx->done_sem);
+  xSemaphoreGive(tx->lock);
+
+  tx_stream_kick(tx);
+}
+
+/**
+ * @brief TX DMA stream IRQ 처리
+ *
+ * @param[in] tx
+ */
+void uart_tx_irq_handler(uart_tx_t *tx) {
+  uint32_t flags = dma_get_flags(tx);
+  BaseType_t woken = pdFALSE;
+
+  if (!flags) {
+    return;
+  }
+
+  dma_clear_flags(tx, flags);
+
+  if (!(flags & (DMA_STREAM_FLAG_TC | DMA_STREAM_FLAG_TE))) {
+    return;
+  }
+
+  if (flags & DMA_STREAM_FLAG_TE) {
+    LL_DMA_DisableStream(tx->dma, tx->stream);
+    tx->error = true;
+  }
+
+  uart_tx_callback_t cb = tx->callback;
+  tx->callback = NULL;
+  tx->inflight_len = 0;
+
+  if (cb) {
+    cb(!tx->error, tx->user_data);
+  }
+
+  uart_tx_stream_t *s = tx->ring;
+  bool yield = tx->yield_req;
+
+  if (s && s->chunk) {
+    // 에러가 난 구간도 다시 보내지 않는다 (보정 데이터는 다음 epoch 로 대체)
+    s->tail += s->chunk;
+    s->chunk = 0;
+    tx_stream_retire_marks(s);
+    if (!tx_stream_can_yield(tx, s)) {
+      yield = false;
+    }
+  }
+
+  // 기다리는 송신자가 없거나 아직 넘길 자리가 아니면 스트림을 이어 보낸다
+  if (!yield && tx_stream_start(tx)) {
+    return;
+  }
+
+  xSemaphoreGiveFromISR(tx->done_sem, &woken);
+  portYIELD_FROM_ISR(woken);
+}
+
+/**
+ * @brief 송신 채널에 스트림 ring 연결
+ *
+ * uart_tx_init() 후에 한 번 호출한다.
+ *
+ * @param[out] s
+ * @param[in] tx
+ * @param[in] buf SRAM 버퍼 (CCM RAM 불가)
+ * @param[in] size 버퍼 크기, 2의 거듭제곱
+ * @return true 성공
+ */
+bool uart_tx_stream_init(uart_tx_stream_t *s, uart_tx_t *tx, uint8_t *buf,
+                         size_t size) {
+  if (!s || !tx || !buf || size == 0 || (size & (size - 1)) ||
+      is_ccmram(buf)) {
+    LOG_ERR("TX stream invalid buffer %p (%u bytes)", buf, (unsigned)size);
+    return false;
+  }
+
+  s->tx = tx;
+  s->buf = buf;
+  s->size = size;
+  s->head = 0;
+  s->tail = 0;
+  s->chunk = 0;
+  s->dropped = 0;
+  s->mark_head = 0;
+  s->mark_tail = 0;
+  s->frame_head = 0;
+  s->frame_tail = 0;
+  tx->ring = s;
+
+  return true;
+}
+
+static void tx_stream_copy(uart_tx_stream_t *s, size_t head, const uint8_t *p,
+                           size_t n) {
+  size_t off = head & (s->size - 1);
+  size_t first = s->size - off;
+
+  if (first > n) {
+    first = n;
+  }
+  memcpy(&s->buf[off], p, first);
+  memcpy(s->buf, p + first, n - first);
+}
+
+/**
+ * @brief 스트림에 바이트 추가 (생산자 태스크 하나 전용, 블로킹 없음)
+ *
+ * ring 에 복사만 하고 DMA 는 채널이 비어 있을 때 바로, 아니면 앞선
+ * 전송이 끝나는 대로 ISR 에서 이어 건다. 남은 공간보다 길면 뒷부분은
+ * 버린다.
+ *
+ * @param[in] s
+ * @param[in] data
+ * @param[in] len
+ * @return size_t ring 에 들어간 바이트 수
+ */
+size_t uart_tx_stream_write(uart_tx_stream_t *s, const void *data, size_t len) {
+  const uint8_t *p = data;
+
+  if (!s || !s->buf || !data || len == 0) {
+    return 0;
+  }
+
+  size_t head = s->head;
+  size_t space = s->size - (head - s->tail);
+  size_t n = len < space ? len : space;
+
+  if (n < len) {
+    s->dropped += len - n;
+  }
+
+  tx_stream_copy(s, head, p, n);
+
+  // 데이터가 ring 에 다 써진 뒤에 ISR 이 새 head 를 보도록
+  __DMB();
+  s->head = head + n;
+
+  tx_stream_kick(s->tx);
+
+  return n;
+}
+
+/**
+ * @brief 스트림에 프레임 하나 추가 (생산자 태스크 하나 전용, 블로킹 없음)
+ *
+ * uart_tx_stream_write() 와 같지만 잘린 프레임은 받는 쪽에서 쓸모가
+ * 없으므로 공간이 모자라면 통째로 버린다. 다른 송신자는 프레임 사이에만
+ * 끼어든다.
+ *
+ * @param[in] s
+ * @param[in] data
+ * @param[in] len
+ * @return size_t len 또는 0 (버림)
+ */
+size_t uart_tx_stream_write_frame(uart_tx_stream_t *s, const void *data,
+                                  size_t len) {
+  uart_tx_seg_t seg = {.data = data, .len = len};
+
+  return uart_tx_stream_write_framev(s, &seg, 1);
+}
+
+/**
+ * @brief 여러 구간을 이어 프레임 하나로 추가 (링 버퍼에서 둘로 나뉜 프레임 등)
+ *
+ * uart_tx_stream_write_frame() 과 같고 구간 사이를 따로 모으지 않는다.
+ *
+ * @param[in] s
+ * @param[in] segs
+ * @param[in] cnt
+ * @return size_t 구간 길이 합 또는 0 (버림)
+ */
+size_t uart_tx_stream_write_framev(uart_tx_stream_t *s, const uart_tx_seg_t *segs,
+                                   size_t cnt) {
+  size_t len = 0;
+
+  if (!s || !s->buf || !segs) {
+    return 0;
+  }
+  for (size_t i = 0; i < cnt; i++) {
+    if (segs[i].len && !segs[i].data) {
+      return 0;
+    }
+    len += segs[i].len;
+  }
+  if (len == 0) {
+    return 0;
+  }
+
+  size_t head = s->head;
+  uint8_t fh = s->frame_head;
+
+  if (len > s->size - (head - s->tail) ||
+      (uint8_t)(fh - s->frame_tail) >= UART_TX_STREAM_FRAMES) {
+    s->dropped += len;
+    return 0;
+  }
+
+  size_t pos = head;
+  for (size_t i = 0; i < cnt; i++) {
+    tx_stream_copy(s, pos, segs[i].data, segs[i].len);
+    pos += segs[i].len;
+  }
+  s->frames[fh & (UART_TX_STREAM_FRAMES - 1)] = head + len;
+
+  // ISR 이 프레임 바이트를 보기 전에 끝 위치부터 보도록
+  __DMB();
+  s->frame_head = fh + 1;
+  __DMB();
+  s->head = head + len;
+
+  tx_stream_kick(s->tx);
+
+  return len;
+}
+
+/**
+ * @brief 송신 완료 표시 콜백 등록
+ *
+ * @param[in] s
+ * @param[in] cb DMA ISR 에서 호출됨
+ * @param[in] ctx
+ */
+void uart_tx_stream_set_mark_cb(uart_tx_stream_t *s, uart_tx_stream_mark_cb_t cb,
+                                void *ctx) {
+  s->mark_ctx = ctx;
+  s->on_mark = cb;
+}
+
+/**
+ * @brief 지금까지 쓴 바이트가 모두 DMA 로 나가면 on_mark(tag) 호출
+ *
+ * uart_tx_stream_write() 와 같은 생산자 태스크에서 부른다.
+ *
+ * @param[in] s
+ * @param[in] tag
+ * @return true 등록됨, false 표시 FIFO 가득참
+ */
+bool uart_tx_stream_mark(uart_tx_stream_t *s, uint32_t tag) {
+  uint8_t head = s->mark_head;
+
+  if ((uint8_t)(head - s->mark_tail) >= UART_TX_STREAM_MARKS) {
+    return false;
+  }
+
+  uint8_t i = head & (UART_TX_STREAM_MARKS - 1);
+  s->marks[i].pos = s->head;
+  s->marks[i].tag = tag;
+
+  __DMB();
+  s->mark_head = head + 1;
+
+  // 표시 전에 이미 다 나갔으면 다음 DMA 완료까지 기다리지 않는다
+  taskENTER_CRITICAL();
+  if (s->chunk == 0 && s->tail == s->head) {
+    tx_stream_retire_marks(s);
+  }
+  taskEXIT_CRITICAL();
+
+  return true;
+}
@@ -0,0 +1,172 @@
+#ifndef UART_TX_H
+#define UART_TX_H
+
+#include "FreeRTOS.h"
+#include "semphr.h"
+#include "stm32f4xx_ll_dma.h"
+#include "stm32f4xx_ll_usart.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief CCM RAM 버퍼 송신용 bounce 버퍼 크기
+ *
+ * CCM 은 DMA 가 접근할 수 없어서 SRAM 으로 나눠 복사해 보낸다.
+ */
+#define UART_TX_BOUNCE_SIZE 256
+
+/**
+ * @brief 한 번의 DMA 전송 완료 대기 시간 (9600bps 에서도 여유 있게)
+ */
+#define UART_TX_TIMEOUT_MS(len) ((uint32_t)(len) * 2 + 100)
+
+/**
+ * @brief 스트림 ring 에서 한 번에 거는 DMA 최대 길이
+ *
+ * 다른 송신자가 기다리는 시간이 이 길이 한 번으로 제한된다.
+ */
+#define UART_TX_STREAM_CHUNK 256
+
+/**
+ * @brief 스트림 송신 완료 표시 FIFO 크기 (2의 거듭제곱, 256 이하)
+ */
+#define UART_TX_STREAM_MARKS 16
+
+/**
+ * @brief 스트림 프레임 경계 FIFO 크기 (2의 거듭제곱, 256 이하)
+ *
+ * uart_tx_stream_write_frame() 으로 링에 들어가 아직 다 나가지 않은
+ * 프레임 최대 개수. 넘치면 프레임을 통째로 버린다.
+ */
+#define UART_TX_STREAM_FRAMES 32
+
+/**
+ * @brief 우선순위 순위 -> 레지스터 값 (board_config.h 의 *_DMA_PRIO, *_IRQ_PRIO)
+ */
+#define UART_DMA_PRIO(level) (((uint32_t)(level) & 0x3U) << DMA_SxCR_PL_Pos)
+#define UART_NVIC_PRIO(prio)                                                   \
+  NVIC_EncodePriority(NVIC_GetPriorityGrouping(), (prio), 0)
+
+/**
+ * @brief 비동기 송신 완료 콜백 (DMA ISR 에서 호출)
+ *
+ * @param[in] ok 정상 완료 여부 (DMA 전송 에러 시 false)
+ * @param[in] user_data
+ */
+typedef void (*uart_tx_callback_t)(bool ok, void *user_data);
+
+/**
+ * @brief 스트림이 붙은 채널에서 블로킹 송신자의 순위
+ *
+ * 어느 쪽이든 스트림은 프레임 경계에서만 채널을 넘긴다.
+ */
+typedef enum {
+  UART_TX_PRIO_URGENT = 0, /**< 스트림의 다음 프레임 경계에서 끼어듦 */
+  UART_TX_PRIO_NORMAL,     /**< 기다리기 시작할 때 링에 있던 데이터 뒤에 */
+} uart_tx_prio_t;
+
+/**
+ * @brief 스트림 표시 지점까지 송신 완료 콜백 (DMA ISR 에서 호출)
+ *
+ * @param[in] tag uart_tx_stream_mark() 에 넘긴 값
+ * @param[in] ctx
+ */
+typedef void (*uart_tx_stream_mark_cb_t)(uint32_t tag, void *ctx);
+
+/**
+ * @brief scatter-gather 송신 구간
+ *
+ */
+typedef struct {
+  const void *data;
+  size_t len;
+} uart_tx_seg_t;
+
+/**
+ * @brief UART DMA 송신 채널
+ *
+ * 포트마다 하나씩 static 으로 두고 해당 DMA stream IRQ 에서
+ * uart_tx_irq_handler() 를 불러준다.
+ */
+typedef struct {
+  USART_TypeDef *uart;
+  DMA_TypeDef *dma;
+  uint32_t stream;
+
+  SemaphoreHandle_t lock;     /**< 송신자 직렬화 */
+  SemaphoreHandle_t done_sem; /**< DMA 유휴 상태, 완료 시 ISR 에서 give */
+  volatile size_t inflight_len;
+  volatile bool error;
+
+  uart_tx_callback_t callback;
+  void *user_data;
+
+  struct uart_tx_stream_s *ring; /**< 연결된 스트림 ring (없으면 NULL) */
+  volatile bool yield_req;       /**< 대기 중인 송신자가 있으면 스트림 양보 */
+  volatile bool yield_wait;      /**< 양보 전에 yield_pos 까지는 스트림 먼저 */
+  volatile size_t yield_pos;
+
+  uint8_t bounce[UART_TX_BOUNCE_SIZE];
+} uart_tx_t;
+
+/**
+ * @brief 송신 채널에 붙는 단일 생산자 바이트 스트림 (lock-free SPSC ring)
+ *
+ * 쓰는 쪽 태스크 하나만 head 를, DMA 완료 ISR 만 tail 을 갱신한다.
+ * ring 자체를 DMA 가 읽으므로 버퍼는 SRAM 이어야 하고, 가득 차면
+ * 넘치는 바이트는 버리고 dropped 에 센다.
+ *
+ * 프레임 단위로 쓰면 (uart_tx_stream_write_frame) DMA 구간을 프레임 끝에서
+ * 끊고, 다른 송신자에게는 프레임 경계에서만 채널을 넘긴다. 한 스트림에서
+ * 바이트 쓰기와 프레임 쓰기를 섞지 않는다.
+ */
+typedef struct uart_tx_stream_s {
+  uart_tx_t *tx;
+  uint8_t *buf;
+  size_t size;           /**< 2의 거듭제곱 */
+  volatile size_t head;  /**< 누적 기록 바이트 (생산자) */
+  volatile size_t tail;  /**< 누적 송신 바이트 (ISR) */
+  volatile size_t chunk; /**< 진행 중인 DMA 길이, 0 이면 유휴 */
+  volatile uint32_t dropped;
+
+  /* 송신 완료 표시 (생산자가 mark_head, ISR 이 mark_tail 갱신) */
+  struct {
+    size_t pos;
+    uint32_t tag;
+  } marks[UART_TX_STREAM_MARKS];
+  volatile uint8_t mark_head;
+  volatile uint8_t mark_tail;
+  uart_tx_stream_mark_cb_t on_mark;
+  void *mark_ctx;
+
+  /* 프레임 끝 위치 (생산자가 frame_head, ISR 이 frame_tail 갱신) */
+  size_t frames[UART_TX_STREAM_FRAMES];
+  volatile uint8_t frame_head;
+  volatile uint8_t frame_tail;
+} uart_tx_stream_t;
+
+bool uart_tx_init(uart_tx_t *tx, USART_TypeDef *uart, DMA_TypeDef *dma,
+                  uint32_t stream, uint32_t channel, IRQn_Type irq,
+                  uint8_t dma_prio, uint8_t irq_prio);
+int uart_tx_send(uart_tx_t *tx, const void *data, size_t len);
+int uart_tx_sendv(uart_tx_t *tx, const uart_tx_seg_t *segs, size_t cnt);
+int uart_tx_sendv_prio(uart_tx_t *tx, const uart_tx_seg_t *segs, size_t cnt,
+                       uart_tx_prio_t prio);
+bool uart_tx_send_async(uart_tx_t *tx, const void *data, size_t len,
+                        uart_tx_callback_t callback, void *user_data);
+void uart_tx_wait_complete(uart_tx_t *tx);
+void uart_tx_irq_handler(uart_tx_t *tx);
+
+bool uart_tx_stream_init(uart_tx_stream_t *s, uart_tx_t *tx, uint8_t *buf,
+                         size_t size);
+size_t uart_tx_stream_write(uart_tx_stream_t *s, const void *data, size_t len);
+size_t uart_tx_stream_write_frame(uart_tx_stream_t *s, const void *data,
+                                  size_t len);
+size_t uart_tx_stream_write_framev(uart_tx_stream_t *s, const uart_tx_seg_t *segs,
+                                   size_t cnt);
+void uart_tx_stream_set_mark_cb(uart_tx_stream_t *s, uart_tx_stream_mark_cb_t cb,
+                                void *ctx);
+bool uart_tx_stream_mark(uart_tx_stream_t *s, uint32_t tag);
+
+#endif
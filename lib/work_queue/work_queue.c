@@ -0,0 +1,267 @@
+#include "work_queue.h"
+#include "task.h"
+#include "rtos_static.h"
+
+enum {
+  WORK_IDLE = 0,
+  WORK_READY,   // 실행 목록에 있음
+  WORK_DELAYED, // 지연 목록에 있음
+  WORK_RUNNING,
+};
+
+typedef struct {
+  TaskHandle_t task;
+  work_t *head; // 실행 목록 (FIFO)
+  work_t *tail;
+  work_t *delayed; // 지연 목록 (정렬 안 함, 항목이 몇 개 안 됨)
+} work_lane_t;
+
+static work_lane_t work_lanes[WORK_PRIO_COUNT];
+
+// LOW 는 로그 (float 포맷) 와 모듈 명령 대기를 하는 작업을 받으므로 넉넉히
+RTOS_STATIC_TASK(work_hi, 512);
+RTOS_STATIC_TASK(work_lo, 1024);
+
+/* 아래 목록 함수는 critical section 안에서 부름 */
+
+static void work_push_ready(work_lane_t *lane, work_t *work) {
+  work->next = NULL;
+  if (lane->tail) {
+    lane->tail->next = work;
+  } else {
+    lane->head = work;
+  }
+  lane->tail = work;
+  work->state = WORK_READY;
+}
+
+static void work_unlink(work_t **list, work_t *work) {
+  for (work_t **p = list; *p; p = &(*p)->next) {
+    if (*p == work) {
+      *p = work->next;
+      return;
+    }
+  }
+}
+
+static void work_unlink_ready(work_lane_t *lane, work_t *work) {
+  work_t *prev = NULL;
+
+  for (work_t *w = lane->head; w; prev = w, w = w->next) {
+    if (w == work) {
+      if (prev) {
+        prev->next = w->next;
+      } else {
+        lane->head = w->next;
+      }
+      if (lane->tail == w) {
+        lane->tail = prev;
+      }
+      return;
+    }
+  }
+}
+
+/**
+ * @brief 다음 작업 꺼내기 (때가 된 지연 작업은 실행 목록 뒤로)
+ *
+ * @param[out] wait 꺼낼 것이 없을 때 다음 지연 작업까지 tick
+ */
+static work_t *work_take(work_lane_t *lane, TickType_t *wait) {
+  TickType_t now = xTaskGetTickCount();
+  work_t *work;
+
+  *wait = portMAX_DELAY;
+
+  taskENTER_CRITICAL();
+  for (work_t **p = &lane->delayed; *p;) {
+    work_t *w = *p;
+    int32_t left = (int32_t)(w->due - now);
+
+    if (left <= 0) {
+      *p = w->next;
+      work_push_ready(lane, w);
+      continue;
+    }
+    if ((TickType_t)left < *wait) {
+      *wait = (TickType_t)left;
+    }
+    p = &w->next;
+  }
+
+  work = lane->head;
+  if (work) {
+    lane->head = work->next;
+    if (!lane->head) {
+      lane->tail = NULL;
+    }
+    work->state = WORK_RUNNING;
+  }
+  taskEXIT_CRITICAL();
+
+  return work;
+}
+
+static void work_task(void *arg) {
+  work_lane_t *lane = arg;
+
+  while (1) {
+    TickType_t wait;
+    work_t *work = work_take(lane, &wait);
+
+    if (!work) {
+      ulTaskNotifyTake(pdTRUE, wait);
+      continue;
+    }
+
+    work->fn(work);
+
+    // 도는 중에 다시 넣었으면 READY 그대로
+    taskENTER_CRITICAL();
+    if (work->state == WORK_RUNNING) {
+      work->state = WORK_IDLE;
+    }
+    taskEXIT_CRITICAL();
+  }
+}
+
+void work_queue_init(void) {
+  if (work_lanes[WORK_PRIO_HIGH].task) {
+    return;
+  }
+
+  work_lanes[WORK_PRIO_HIGH].task = RTOS_TASK_CREATE_STATIC(
+      work_hi, work_task, "work_hi", &work_lanes[WORK_PRIO_HIGH], tskIDLE_PRIORITY + 2);
+  work_lanes[WORK_PRIO_LOW].task = RTOS_TASK_CREATE_STATIC(
+      work_lo, work_task, "work_lo", &work_lanes[WORK_PRIO_LOW], tskIDLE_PRIORITY + 1);
+}
+
+void work_init(work_t *work, work_fn_t fn, void *arg, work_prio_t prio) {
+  work->fn = fn;
+  work->arg = arg;
+  work->next = NULL;
+  work->due = 0;
+  work->prio = prio < WORK_PRIO_COUNT ? prio : WORK_PRIO_LOW;
+  work->state = WORK_IDLE;
+}
+
+/**
+ * @brief 실행 목록에 넣기 (critical section 안)
+ *
+ * @return true 워커를 깨워야 함
+ */
+static bool work_queue_ready(work_lane_t *lane, work_t *work) {
+  switch (work->state) {
+  case WORK_READY:
+    return false;
+  case WORK_DELAYED:
+    work_unlink(&lane->delayed, work);
+    break;
+  default:
+    break;
+  }
+
+  work_push_ready(lane, work);
+  return true;
+}
+
+bool work_submit(work_t *work) {
+  work_lane_t *lane = &work_lanes[work->prio];
+  bool wake;
+
+  if (!lane->task) {
+    return false;
+  }
+
+  taskENTER_CRITICAL();
+  wake = work_queue_ready(lane, work);
+  taskEXIT_CRITICAL();
+
+  if (wake) {
+    xTaskNotifyGive(lane->task);
+  }
+  return true;
+}
+
+bool work_submit_from_isr(work_t *work, BaseType_t *woken) {
+  work_lane_t *lane = &work_lanes[work->prio];
+  BaseType_t yield = pdFALSE;
+  UBaseType_t saved;
+  bool wake;
+
+  if (!lane->task) {
+    return false;
+  }
+
+  saved = taskENTER_CRITICAL_FROM_ISR();
+  wake = work_queue_ready(lane, work);
+  taskEXIT_CRITICAL_FROM_ISR(saved);
+
+  if (wake) {
+    vTaskNotifyGiveFromISR(lane->task, &yield);
+  }
+  if (woken) {
+    if (yield) {
+      *woken = pdTRUE;
+    }
+  } else {
+    portYIELD_FROM_ISR(yield);
+  }
+  return true;
+}
+
+bool work_submit_delayed(work_t *work, uint32_t delay_ms) {
+  work_lane_t *lane = &work_lanes[work->prio];
+  bool wake = false;
+
+  if (!lane->task) {
+    return false;
+  }
+
+  if (delay_ms == 0) {
+    return work_submit(work);
+  }
+
+  taskENTER_CRITICAL();
+  if (work->state != WORK_READY && work->state != WORK_DELAYED) {
+    work->due = xTaskGetTickCount() + pdMS_TO_TICKS(delay_ms);
+    work->next = lane->delayed;
+    lane->delayed = work;
+    work->state = WORK_DELAYED;
+    wake = true;
+  }
+  taskEXIT_CRITICAL();
+
+  // 워커가 기다릴 시간을 다시 계산하도록
+  if (wake) {
+    xTaskNotifyGive(lane->task);
+  }
+  return true;
+}
+
+void work_timer_callback(TimerHandle_t timer) {
+  work_submit((work_t *)pvTimerGetTimerID(timer));
+}
+
+bool work_cancel(work_t *work) {
+  work_lane_t *lane = &work_lanes[work->prio];
+  bool removed = true;
+
+  taskENTER_CRITICAL();
+  switch (work->state) {
+  case WORK_READY:
+    work_unlink_ready(lane, work);
+    work->state = WORK_IDLE;
+    break;
+  case WORK_DELAYED:
+    work_unlink(&lane->delayed, work);
+    work->state = WORK_IDLE;
+    break;
+  default:
+    removed = false;
+    break;
+  }
+  taskEXIT_CRITICAL();
+
+  return removed;
+}
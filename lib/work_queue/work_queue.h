@@ -0,0 +1,97 @@
+#ifndef WORK_QUEUE_H
+#define WORK_QUEUE_H
+
+#include "FreeRTOS.h"
+#include "timers.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief 공용 작업 실행기 (우선순위별 워커 태스크)
+ *
+ * 거의 잠만 자다가 가끔 깨어 짧게 일하는 작업을 각자 태스크로 두지 않고
+ * 작업 항목 (work_t) 으로 만들어 워커에 넘긴다. 스택은 워커 것만 쓴다.
+ *
+ * HIGH 워커는 짧게 끝나는 작업, LOW 워커는 잠들거나 (vTaskDelay, 모듈 응답
+ * 대기) 오래 걸리는 작업용. 같은 워커의 작업은 넣은 순서대로 하나씩 돈다.
+ */
+
+typedef enum {
+  WORK_PRIO_HIGH = 0, // tskIDLE_PRIORITY + 2
+  WORK_PRIO_LOW,      // tskIDLE_PRIORITY + 1
+  WORK_PRIO_COUNT
+} work_prio_t;
+
+typedef struct work work_t;
+
+/**
+ * @brief 작업 함수 (워커 태스크)
+ *
+ * 도는 중에 다시 넣으면 끝난 뒤 한 번 더 돈다.
+ */
+typedef void (*work_fn_t)(work_t *work);
+
+struct work {
+  work_fn_t fn;
+  void *arg;
+  work_t *next;   // 워커 목록 (내부)
+  TickType_t due; // 지연 작업 실행 tick (내부)
+  uint8_t prio;   // work_prio_t
+  uint8_t state;  // 내부
+};
+
+/**
+ * @brief 정적 초기화
+ */
+#define WORK_INIT(fn, arg, prio) {(fn), (arg), NULL, 0, (prio), 0}
+
+/**
+ * @brief 워커 태스크 생성 (스케줄러 시작 후 init 태스크, 작업을 넣기 전)
+ */
+void work_queue_init(void);
+
+/**
+ * @brief 작업 항목 초기화 (대기 중이 아닐 때만)
+ */
+void work_init(work_t *work, work_fn_t fn, void *arg, work_prio_t prio);
+
+/**
+ * @brief 바로 실행하도록 넣기 (태스크 컨텍스트)
+ *
+ * 이미 실행 대기 중이면 한 번만 돈다. 지연 대기 중이면 앞당긴다.
+ *
+ * @return true 대기 중, false 워커가 없음 (work_queue_init 전)
+ */
+bool work_submit(work_t *work);
+
+/**
+ * @brief ISR 에서 넣기
+ *
+ * @param[out] woken portYIELD_FROM_ISR 용 (pdTRUE 로만 바꿈)
+ */
+bool work_submit_from_isr(work_t *work, BaseType_t *woken);
+
+/**
+ * @brief delay_ms 뒤에 실행하도록 넣기 (태스크 컨텍스트)
+ *
+ * 이미 대기 중 (바로 또는 지연) 이면 그 일정을 그대로 둔다.
+ */
+bool work_submit_delayed(work_t *work, uint32_t delay_ms);
+
+/**
+ * @brief 타이머 만료를 워커로 넘기는 콜백
+ *
+ * timer 서비스 태스크는 가장 높은 우선순위라 콜백이 일을 하면 다른 타이머와
+ * 파서가 모두 밀린다. xTimerCreate 에 timer ID 로 work_t 를, 콜백으로 이 함수를
+ * 주면 만료 때 작업을 넣기만 하고 실제 일은 워커가 한다.
+ */
+void work_timer_callback(TimerHandle_t timer);
+
+/**
+ * @brief 대기 중인 작업 빼기
+ *
+ * @return true 뺐음, false 대기 중이 아니었음 (도는 중이면 그대로 끝까지 돔)
+ */
+bool work_cancel(work_t *work);
+
+#endif
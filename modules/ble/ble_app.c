@@ -2,8 +2,20 @@
 #include "board_config.h"
 #include "ble.h"
 #include "ble_port.h"
+#include "ble_cmd.h"
 #include <string.h>
 #include "flash_params.h"
+#include "rtcm_router.h"
+#include "gps_app.h"
+#include "pos_out.h"
+#include "app_events.h"
+#include "rtos_static.h"
+#include "heap_track.h"
+#include "mem_watermark.h"
+#include "irq_latency.h"
+#include "dma_ring.h"
+#include "crc.h"
+#include "tx_pool.h"
 
 #ifndef TAG
 #define TAG "BLE_APP"
@@ -11,6 +23,9 @@
 
 #include "log.h"
 
+#define BLE_RTCM_PREAMBLE 0xD3
+#define BLE_RTCM_OVERHEAD 6 // header 3 + CRC 3
+
 static void ble_check_async_at_timeout(void);
 bool ble_set_advon_async(uint32_t timeout_ms);
 
@@ -72,35 +87,31 @@ void ble_cmd_parse_process(ble_instance_t *inst, const void *data, size_t len)
     }
     else if (inst->parse_stae == BLE_CMD_PARSE_STATE_DATA || inst->parse_stae == BLE_CMD_PARSE_STATE_APP)
     {
-      if (inst->parser.pos < sizeof(inst->parser.data) - 1)
-      {
-        inst->parser.data[inst->parser.pos++] = (char)(*d);
-        inst->parser.data[inst->parser.pos] = '\0';
-      }
-      else
+      if (!at_cmd_line_put(&inst->parser, (char)(*d)))
       {
-        inst->parser.pos = 0;
-        inst->parser.data[inst->parser.pos] = '\0';
-        inst->parser.prev_char = '\0';
+        // 너무 긴 줄은 버림
+        at_cmd_line_reset(&inst->parser);
         inst->parse_stae = BLE_CMD_PARSE_STATE_NONE;
+        continue;
       }
 
       if (*d == '\r' || *d == '\n')
       {
-        inst->parser.data[inst->parser.pos - 1] = '\0'; // \r 제거
+        size_t line_len = --inst->parser.pos;
+
+        inst->parser.data[line_len] = '\0'; // \r 제거
         LOG_INFO("BLE AT Command received: %s", inst->parser.data);
 
         if (inst->parse_stae == BLE_CMD_PARSE_STATE_DATA)
         {
-          ble_at_cmd_handler(inst);
+          ble_at_cmd_handler(inst, line_len);
         }
         else
         {
-          ble_app_cmd_handler(inst);
+          ble_app_cmd_handler(inst, line_len);
         }
 
-        inst->parser.prev_char = '\0';
-        inst->parser.pos = 0;
+        at_cmd_line_reset(&inst->parser);
         inst->parse_stae = BLE_CMD_PARSE_STATE_NONE;
       }
       inst->parser.prev_char = (char)(*d);
@@ -110,115 +121,850 @@ void ble_cmd_parse_process(ble_instance_t *inst, const void *data, size_t len)
 
 static ble_instance_t ble_instance = {0};
 
+#define BLE_RX_QUEUE_LEN 10
+#define BLE_TX_QUEUE_LEN 5
+#define BLE_TASK_STACK_WORDS 512
+
+RTOS_STATIC_TASK(ble_rx, BLE_TASK_STACK_WORDS);
+RTOS_STATIC_TASK(ble_tx, BLE_TASK_STACK_WORDS);
+RTOS_STATIC_QUEUE(ble_rx_queue, BLE_RX_QUEUE_LEN, sizeof(uint8_t));
+RTOS_STATIC_QUEUE(ble_tx_queue, BLE_TX_QUEUE_LEN, sizeof(tx_buf_t *));
+static StaticSemaphore_t ble_mutex_buf;
+
+/* 깨어날 때 링에 쌓여 있던 byte */
+static mem_wm_t ble_rx_wm = MEM_WM_INIT("ble_rx", BLE_UART_MAX_RECV_SIZE);
+
+/**
+ * @brief 위치 스트림 ring (GPS 태스크가 쓰고 BLE TX 태스크가 읽음)
+ *
+ * 레코드가 작고 자주 오므로 레코드마다 tx_pool 버퍼와 큐를 거치는 대신 짧은
+ * critical section 안에서 슬롯에 복사하고 MTU 단위로 묶어 보낸다.
+ */
+static struct
+{
+  uint8_t rec[BLE_STREAM_RING_RECS][BLE_STREAM_REC_MAX];
+  uint8_t len[BLE_STREAM_RING_RECS];
+  TickType_t tick[BLE_STREAM_RING_RECS]; // 레코드를 넣은 tick
+  uint8_t head;                          // 다음에 쓸 슬롯
+  uint8_t count;
+  uint16_t bytes;                        // ring 에 있는 바이트 합
+  uint32_t drops;                        // 가득 차서 버린 레코드
+  volatile bool enabled;
+} ble_stream;
+
+/* 연결 때 링크 파라미터 (TX 태스크가 비동기 AT 로 한 단계씩) */
+#define BLE_LINK_MTU 247       // ATT MTU (payload BLE_STREAM_MTU)
+#define BLE_LINK_DLE 251       // LL 데이터 길이 확장 (MTU 하나가 패킷 하나)
+#define BLE_LINK_CI_MIN 12     // 연결 간격 [1.25 ms] (15 ms)
+#define BLE_LINK_CI_MAX 24     // 30 ms (iOS 는 15 ms 배수만 받음)
+#define BLE_LINK_SUP_TMO 400   // supervision timeout [10 ms]
+#define BLE_LINK_DEF_CHUNK 20  // 기본 MTU 23 의 payload
+#define BLE_LINK_DELAY_MS 1000 // 연결 직후 폰이 서비스 탐색을 끝낼 때까지
+
+typedef enum
+{
+  BLE_LINK_IDLE, // 연결 없음 또는 끝남
+  BLE_LINK_WAIT, // 연결 직후 BLE_LINK_DELAY_MS
+  BLE_LINK_MTU_REQ,
+  BLE_LINK_DLE_REQ,
+  BLE_LINK_CI_REQ,
+} ble_link_step_t;
+
+static struct
+{
+  ble_link_step_t step;
+  bool sent;             // 이번 단계 명령을 보냄
+  volatile bool busy;    // 응답 (또는 타임아웃) 대기 중
+  volatile bool ok;      // 마지막 응답이 +OK
+  volatile bool changed; // 연결 상태가 바뀜 (GPIO 인터럽트)
+  TickType_t until;      // WAIT 끝 tick
+  bool mtu, dle, ci;     // 폰이 받아들인 것
+  volatile uint16_t chunk; // 스트림을 한 번에 쓰는 바이트 (MTU payload)
+  TickType_t conn_tick;
+  uint32_t tx_bytes;     // 이번 연결에서 모듈로 보낸 데이터 바이트
+} ble_link = {.chunk = BLE_LINK_DEF_CHUNK};
+
+static void ble_tx_send_request(ble_instance_t *inst, const tx_buf_t *tx_req)
+{
+  bool is_at = (tx_req->flags & BLE_TX_FLAG_AT) != 0;
+
+  LOG_DEBUG("BLE Sending %d bytes", tx_req->len);
+
+  xSemaphoreTake(inst->mutex, portMAX_DELAY);
+
+  if (inst->ble.ops && inst->ble.ops->send)
+  {
+    if (is_at)
+    {
+      inst->ble.ops->at_mode();
+    }
+    inst->ble.ops->send(tx_req->data, tx_req->len);
+
+    if (is_at)
+    {
+      vTaskDelay(pdMS_TO_TICKS(10));
+      inst->ble.ops->bypass_mode();
+    }
+    else
+    {
+      ble_link.tx_bytes += tx_req->len;
+    }
+    LOG_DEBUG("BLE TX complete");
+  }
+  else
+  {
+    LOG_ERR("BLE send ops not available");
+  }
+
+  xSemaphoreGive(inst->mutex);
+}
+
+/**
+ * @brief ring 에서 MTU 하나 분량 꺼내기 (ble_link.chunk, 협상 전에는 20)
+ *
+ * MTU 가 차지 않았고 가장 오래된 레코드가 BLE_STREAM_FLUSH_MS 를 안 넘었으면
+ * 꺼내지 않고 남은 시간만 알려 준다.
+ *
+ * @param[out] buf BLE_STREAM_MTU 바이트
+ * @param[out] wait 다음에 볼 때까지 기다릴 tick
+ * @return size_t 꺼낸 바이트 (0: 보낼 것 없음)
+ */
+static size_t ble_stream_take(uint8_t *buf, TickType_t *wait)
+{
+  TickType_t now = xTaskGetTickCount();
+  TickType_t flush = pdMS_TO_TICKS(BLE_STREAM_FLUSH_MS);
+  size_t chunk = ble_link.chunk;
+  size_t pos = 0;
+
+  taskENTER_CRITICAL();
+  if (ble_stream.count == 0)
+  {
+    taskEXIT_CRITICAL();
+    *wait = portMAX_DELAY;
+    return 0;
+  }
+
+  uint8_t tail = (ble_stream.head + BLE_STREAM_RING_RECS - ble_stream.count) % BLE_STREAM_RING_RECS;
+  TickType_t age = now - ble_stream.tick[tail];
+
+  if ((size_t)ble_stream.bytes + BLE_STREAM_REC_MAX <= chunk && age < flush)
+  {
+    taskEXIT_CRITICAL();
+    *wait = flush - age;
+    return 0;
+  }
+
+  // 레코드 하나가 chunk 보다 커도 (협상 전) 하나는 꺼냄: 모듈이 나눠 보냄
+  while (ble_stream.count > 0 && (pos == 0 || pos + ble_stream.len[tail] <= chunk))
+  {
+    memcpy(&buf[pos], ble_stream.rec[tail], ble_stream.len[tail]);
+    pos += ble_stream.len[tail];
+    ble_stream.bytes -= ble_stream.len[tail];
+    ble_stream.count--;
+    tail = (tail + 1) % BLE_STREAM_RING_RECS;
+  }
+  taskEXIT_CRITICAL();
+
+  *wait = 0;
+  return pos;
+}
+
+/**
+ * @brief 모인 스트림 레코드 전송 (TX 태스크)
+ *
+ * @return TickType_t 다음 flush 까지 기다릴 tick
+ */
+static TickType_t ble_stream_flush(ble_instance_t *inst)
+{
+  static uint8_t buf[BLE_STREAM_MTU];
+  TickType_t wait;
+  size_t len;
+
+  if (!ble_stream.enabled)
+  {
+    return portMAX_DELAY;
+  }
+
+  // AT 명령 중에는 모듈이 데이터를 명령으로 읽으므로 ring 에 둔 채 나중에 다시 봄
+  if (inst->current_mode == BLE_MODE_AT)
+  {
+    return pdMS_TO_TICKS(BLE_STREAM_FLUSH_MS);
+  }
+
+  while ((len = ble_stream_take(buf, &wait)) > 0)
+  {
+    xSemaphoreTake(inst->mutex, portMAX_DELAY);
+    if (inst->ble.ops && inst->ble.ops->send)
+    {
+      inst->ble.ops->send((const char *)buf, len);
+      ble_link.tx_bytes += len;
+    }
+    xSemaphoreGive(inst->mutex);
+  }
+
+  return wait;
+}
+
+/* 부팅 때 모듈 설정 (TX 태스크가 비동기 AT 로 한 단계씩 진행) */
+#define BLE_CFG_BAUD 115200
+#define BLE_CFG_AT_TIMEOUT_MS 300
+#define BLE_CFG_RESET_MS 2000 // AT+UART 뒤 모듈 재시작
+
+typedef enum
+{
+  BLE_CFG_IDLE,  // 안 함 또는 끝남
+  BLE_CFG_PROBE, // 지금 속도에서 AT (안 되면 다른 속도로 한 번 더)
+  BLE_CFG_UART,  // AT+UART=BLE_CFG_BAUD
+  BLE_CFG_RESET, // 모듈 재시작 대기 후 다시 PROBE
+  BLE_CFG_NAME,  // AT+MANUF=<ble_device_name>
+} ble_cfg_step_t;
+
+static struct
+{
+  ble_cfg_step_t step;
+  bool sent;          // 이번 단계 명령을 보냄
+  volatile bool busy; // 응답 (또는 타임아웃) 대기 중
+  volatile bool ok;   // 마지막 응답이 +OK
+  uint8_t tries;      // PROBE 에서 시도한 속도 수
+  TickType_t until;   // RESET 끝 tick
+  uint32_t name_crc;  // 설정할 이름의 crc32
+  ble_module_params_t done; // 설정이 확인된 값 (끝나면 저장)
+} ble_cfg;
+
+/**
+ * @brief 비동기 AT 완료 콜백 (RX 태스크, mutex 잡힌 채)
+ *
+ * 다음 명령은 mutex 를 다시 잡아야 하므로 여기서 보내지 않고 TX 태스크를 깨운다.
+ */
+static void ble_cfg_at_done(bool ok, void *user_data)
+{
+  (void)user_data;
+
+  ble_cfg.ok = ok;
+  ble_cfg.busy = false;
+  xTaskNotifyGive(ble_instance.tx_task);
+}
+
+static void ble_cfg_send(const char *at_cmd)
+{
+  ble_cfg.sent = true;
+  ble_cfg.busy = true;
+
+  if (!ble_send_at_cmd_truly_async(at_cmd, ble_cfg_at_done, NULL, BLE_CFG_AT_TIMEOUT_MS))
+  {
+    ble_cfg.ok = false;
+    ble_cfg.busy = false;
+  }
+}
+
+static void ble_cfg_next(ble_cfg_step_t step)
+{
+  ble_cfg.step = step;
+  ble_cfg.sent = false;
+}
+
+/**
+ * @brief 설정 끝: 확인된 값이 저장된 것과 다르면 저장
+ */
+static void ble_cfg_finish(void)
+{
+  const user_params_t *params = flash_params_snapshot(NULL);
+
+  ble_cfg_next(BLE_CFG_IDLE);
+
+  if (params->ble_module.baud != ble_cfg.done.baud ||
+      params->ble_module.name_crc != ble_cfg.done.name_crc)
+  {
+    flash_params_set_ble_module(&ble_cfg.done);
+    flash_params_save_async();
+  }
+
+  LOG_INFO("BLE module configured at %lu bps (name %s)", ble_cfg.done.baud,
+           ble_cfg.done.name_crc == ble_cfg.name_crc ? "ok" : "not set");
+}
+
+/**
+ * @brief 속도 단계 다음: 이름이 다르면 쓰고 아니면 끝
+ */
+static void ble_cfg_after_baud(void)
+{
+  if (ble_cfg.done.name_crc != ble_cfg.name_crc)
+  {
+    ble_cfg_next(BLE_CFG_NAME);
+  }
+  else
+  {
+    ble_cfg_finish();
+  }
+}
+
+/**
+ * @brief 모듈 설정 진행 (TX 태스크)
+ *
+ * @return TickType_t 다음에 볼 때까지 기다릴 tick (응답은 콜백이 깨움)
+ */
+static TickType_t ble_cfg_poll(void)
+{
+  if (ble_cfg.step == BLE_CFG_IDLE || ble_cfg.busy)
+  {
+    return portMAX_DELAY;
+  }
+
+  if (!ble_cfg.sent)
+  {
+    char at_cmd[64];
+
+    switch (ble_cfg.step)
+    {
+    case BLE_CFG_PROBE:
+      ble_cfg_send("AT\r");
+      break;
+    case BLE_CFG_UART:
+      snprintf(at_cmd, sizeof(at_cmd), "AT+UART=%lu\r", (unsigned long)BLE_CFG_BAUD);
+      ble_cfg_send(at_cmd);
+      break;
+    case BLE_CFG_RESET:
+      ble_cfg.sent = true;
+      ble_cfg.until = xTaskGetTickCount() + pdMS_TO_TICKS(BLE_CFG_RESET_MS);
+      break;
+    case BLE_CFG_NAME:
+      ble_cfg.sent = true;
+      ble_cfg.busy = true;
+      if (!ble_set_manuf_async(flash_params_snapshot(NULL)->ble_device_name, ble_cfg_at_done,
+                               NULL, BLE_CFG_AT_TIMEOUT_MS))
+      {
+        ble_cfg.ok = false;
+        ble_cfg.busy = false;
+      }
+      break;
+    default:
+      break;
+    }
+
+    if (ble_cfg.busy)
+    {
+      return portMAX_DELAY;
+    }
+  }
+
+  switch (ble_cfg.step)
+  {
+  case BLE_CFG_PROBE:
+    if (ble_cfg.ok)
+    {
+      ble_cfg.done.baud = ble_port_get_baudrate();
+      if (ble_cfg.done.baud != BLE_CFG_BAUD)
+      {
+        ble_cfg_next(BLE_CFG_UART);
+      }
+      else
+      {
+        ble_cfg_after_baud();
+      }
+    }
+    else if (++ble_cfg.tries < 2)
+    {
+      // 저장된 속도가 틀렸거나 (모듈 교체 등) 처음 부팅
+      ble_port_set_baudrate(ble_port_get_baudrate() == 9600 ? BLE_CFG_BAUD : 9600);
+      ble_cfg_next(BLE_CFG_PROBE);
+    }
+    else
+    {
+      LOG_WARN("BLE module not responding, configuration skipped");
+      ble_cfg_next(BLE_CFG_IDLE);
+    }
+    break;
+
+  case BLE_CFG_UART:
+    if (ble_cfg.ok)
+    {
+      ble_port_set_baudrate(BLE_CFG_BAUD);
+      ble_cfg.tries = 1; // 재시작 뒤 PROBE 가 실패하면 9600 으로 되돌리지 않고 끝
+      ble_cfg_next(BLE_CFG_RESET);
+    }
+    else
+    {
+      LOG_ERR("Failed to change BLE module baudrate, staying at %lu", ble_cfg.done.baud);
+      ble_cfg_after_baud();
+    }
+    break;
+
+  case BLE_CFG_RESET:
+  {
+    TickType_t left = ble_cfg.until - xTaskGetTickCount();
+
+    if ((int32_t)left > 0)
+    {
+      return left;
+    }
+    ble_cfg_next(BLE_CFG_PROBE);
+    break;
+  }
+
+  case BLE_CFG_NAME:
+    if (ble_cfg.ok)
+    {
+      ble_cfg.done.name_crc = ble_cfg.name_crc;
+    }
+    else
+    {
+      LOG_WARN("Failed to set BLE device name");
+    }
+    ble_cfg_finish();
+    break;
+
+  default:
+    break;
+  }
+
+  // 다음 단계는 바로
+  return 0;
+}
+
+/**
+ * @brief 모듈 설정 시작 여부 결정 (태스크 만들기 전)
+ *
+ * 저장된 속도와 이름이 지금 설정과 같으면 AT 를 하나도 보내지 않는다.
+ */
+static void ble_cfg_start(void)
+{
+  const user_params_t *params = flash_params_snapshot(NULL);
+  const char *name = params->ble_device_name;
+
+  ble_cfg.name_crc = crc32_update(0, (const uint8_t *)name, strnlen(name, sizeof(params->ble_device_name)));
+  ble_cfg.done = params->ble_module;
+  ble_cfg.tries = 0;
+
+  if (params->ble_module.baud == BLE_CFG_BAUD && params->ble_module.name_crc == ble_cfg.name_crc)
+  {
+    LOG_INFO("BLE module already configured, skipping");
+    ble_cfg_next(BLE_CFG_IDLE);
+    return;
+  }
+
+  ble_cfg_next(BLE_CFG_PROBE);
+}
+
+/**
+ * @brief 비동기 AT 완료 콜백 (RX 태스크, mutex 잡힌 채), ble_cfg_at_done 과 같이 깨우기만
+ */
+static void ble_link_at_done(bool ok, void *user_data)
+{
+  (void)user_data;
+
+  ble_link.ok = ok;
+  ble_link.busy = false;
+  xTaskNotifyGive(ble_instance.tx_task);
+}
+
+static void ble_link_next(ble_link_step_t step)
+{
+  ble_link.step = step;
+  ble_link.sent = false;
+}
+
+/**
+ * @brief 연결 때 MTU, 데이터 길이, 연결 간격 요청 (TX 태스크)
+ *
+ * 폰이 거절하면 (+ERROR 또는 타임아웃) 그 항목만 기본값으로 두고 다음으로
+ * 간다. MTU 가 안 되면 스트림은 20 바이트씩 쓴다 (모듈 UART 버퍼에서 ATT
+ * 패킷으로 나뉠 때 조각이 생기지 않게).
+ *
+ * @return TickType_t 다음에 볼 때까지 기다릴 tick
+ */
+static TickType_t ble_link_poll(void)
+{
+  char at_cmd[48];
+
+  if (ble_link.busy)
+  {
+    return portMAX_DELAY;
+  }
+
+  if (ble_link.changed)
+  {
+    ble_link.changed = false;
+    ble_link.mtu = ble_link.dle = ble_link.ci = false;
+    ble_link.chunk = BLE_LINK_DEF_CHUNK;
+
+    if (ble_instance.conn_state == BLE_CONN_CONNECTED)
+    {
+      ble_link.conn_tick = xTaskGetTickCount();
+      ble_link.tx_bytes = 0;
+      ble_link.until = ble_link.conn_tick + pdMS_TO_TICKS(BLE_LINK_DELAY_MS);
+      ble_link_next(BLE_LINK_WAIT);
+    }
+    else
+    {
+      ble_link_next(BLE_LINK_IDLE);
+    }
+  }
+
+  if (ble_link.step == BLE_LINK_IDLE)
+  {
+    return portMAX_DELAY;
+  }
+  if (ble_instance.conn_state != BLE_CONN_CONNECTED)
+  {
+    ble_link_next(BLE_LINK_IDLE);
+    return portMAX_DELAY;
+  }
+  // 부팅 설정과 비동기 AT 를 같이 쓰므로 끝난 뒤
+  if (ble_cfg.step != BLE_CFG_IDLE)
+  {
+    return pdMS_TO_TICKS(BLE_CFG_AT_TIMEOUT_MS);
+  }
+
+  if (!ble_link.sent)
+  {
+    switch (ble_link.step)
+    {
+    case BLE_LINK_WAIT:
+    {
+      TickType_t left = ble_link.until - xTaskGetTickCount();
+
+      if ((int32_t)left > 0)
+      {
+        return left;
+      }
+      ble_link_next(BLE_LINK_MTU_REQ);
+      return 0;
+    }
+    case BLE_LINK_MTU_REQ:
+      snprintf(at_cmd, sizeof(at_cmd), "AT+MTU=%d\r", BLE_LINK_MTU);
+      break;
+    case BLE_LINK_DLE_REQ:
+      snprintf(at_cmd, sizeof(at_cmd), "AT+DLE=%d\r", BLE_LINK_DLE);
+      break;
+    case BLE_LINK_CI_REQ:
+      snprintf(at_cmd, sizeof(at_cmd), "AT+CONNPARAM=%d,%d,0,%d\r", BLE_LINK_CI_MIN,
+               BLE_LINK_CI_MAX, BLE_LINK_SUP_TMO);
+      break;
+    default:
+      return portMAX_DELAY;
+    }
+
+    ble_link.sent = true;
+    ble_link.busy = true;
+    if (!ble_send_at_cmd_truly_async(at_cmd, ble_link_at_done, NULL, BLE_CFG_AT_TIMEOUT_MS))
+    {
+      ble_link.ok = false;
+      ble_link.busy = false;
+    }
+    if (ble_link.busy)
+    {
+      return portMAX_DELAY;
+    }
+  }
+
+  switch (ble_link.step)
+  {
+  case BLE_LINK_MTU_REQ:
+    ble_link.mtu = ble_link.ok;
+    ble_link.chunk = ble_link.ok ? BLE_STREAM_MTU : BLE_LINK_DEF_CHUNK;
+    ble_link_next(BLE_LINK_DLE_REQ);
+    break;
+
+  case BLE_LINK_DLE_REQ:
+    ble_link.dle = ble_link.ok;
+    ble_link_next(BLE_LINK_CI_REQ);
+    break;
+
+  case BLE_LINK_CI_REQ:
+    ble_link.ci = ble_link.ok;
+    ble_link_next(BLE_LINK_IDLE);
+    if (ble_link.mtu && ble_link.dle && ble_link.ci)
+    {
+      LOG_INFO("BLE link tuned (MTU %d, DLE %d, interval %d-%d)", BLE_LINK_MTU, BLE_LINK_DLE,
+               BLE_LINK_CI_MIN, BLE_LINK_CI_MAX);
+    }
+    else
+    {
+      LOG_WARN("BLE link partly rejected (mtu %d, dle %d, ci %d), chunk %u", ble_link.mtu,
+               ble_link.dle, ble_link.ci, ble_link.chunk);
+    }
+    break;
+
+  default:
+    break;
+  }
+
+  return 0;
+}
+
 static void ble_tx_task(void *pvParameter)
 {
   ble_instance_t *inst = (ble_instance_t *)pvParameter;
-  ble_tx_request_t tx_req;
+  tx_buf_t *tx_req;
+  TickType_t wait = portMAX_DELAY;
 
   LOG_INFO("BLE TX Task started");
-  user_params_t *params = flash_params_get_current();
 
   while (1)
   {
-    if (xQueueReceive(inst->tx_queue, &tx_req, portMAX_DELAY) == pdTRUE)
+    // ble_send() 와 ble_stream_push() 가 notify 로 깨움
+    ulTaskNotifyTake(pdTRUE, wait);
+
+    while (xQueueReceive(inst->tx_queue, &tx_req, 0) == pdTRUE)
+    {
+      ble_tx_send_request(inst, tx_req);
+      tx_buf_free(tx_req);
+    }
+
+    wait = ble_stream_flush(inst);
+
+    TickType_t cfg_wait = ble_cfg_poll();
+    if (cfg_wait < wait)
     {
-      LOG_DEBUG("BLE Sending %d bytes", tx_req.len);
+      wait = cfg_wait;
+    }
+
+    TickType_t link_wait = ble_link_poll();
+    if (link_wait < wait)
+    {
+      wait = link_wait;
+    }
+  }
+
+  vTaskDelete(NULL);
+}
+
+/**
+ * @brief 새 항법 해의 binary 위치 레코드 (pos_out sink, 스트림이 켜져 있을 때)
+ *
+ * 출력 형식이 평면 좌표 (ASCII/binary) 이고 켜져 있으면 평면 좌표 프레임.
+ */
+static bool ble_stream_emit(const uint8_t *data, size_t len)
+{
+  return ble_stream_push(data, len);
+}
 
-      xSemaphoreTake(inst->mutex, portMAX_DELAY);
+static pos_out_sink_t ble_stream_sink =
+    POS_OUT_SINK_INIT("ble", POS_OUT_FMT_USER_BINARY, NULL, NULL, ble_stream_emit, false);
 
-      if (inst->ble.ops && inst->ble.ops->send)
+void ble_stream_enable(bool enable)
+{
+  taskENTER_CRITICAL();
+  ble_stream.head = 0;
+  ble_stream.count = 0;
+  ble_stream.bytes = 0;
+  ble_stream.enabled = enable && ble_instance.enabled;
+  taskEXIT_CRITICAL();
+
+  pos_out_enable(&ble_stream_sink, ble_stream.enabled);
+
+  LOG_INFO("BLE position stream %s (drops %lu)", enable ? "on" : "off", ble_stream.drops);
+  ble_stream.drops = 0;
+}
+
+bool ble_stream_is_enabled(void)
+{
+  return ble_stream.enabled;
+}
+
+bool ble_stream_push(const uint8_t *rec, size_t len)
+{
+  TickType_t now = xTaskGetTickCount();
+  bool wake;
+
+  if (!ble_stream.enabled || !rec || len == 0 || len > BLE_STREAM_REC_MAX)
+  {
+    return false;
+  }
+
+  taskENTER_CRITICAL();
+  if (ble_stream.count == BLE_STREAM_RING_RECS)
+  {
+    // 오래된 위치보다 최신 위치가 중요하므로 가장 오래된 것을 버림
+    ble_stream.bytes -= ble_stream.len[ble_stream.head];
+    ble_stream.count--;
+    ble_stream.drops++;
+  }
+  memcpy(ble_stream.rec[ble_stream.head], rec, len);
+  ble_stream.len[ble_stream.head] = (uint8_t)len;
+  ble_stream.tick[ble_stream.head] = now;
+  ble_stream.head = (ble_stream.head + 1) % BLE_STREAM_RING_RECS;
+  ble_stream.count++;
+  ble_stream.bytes += len;
+  // 첫 레코드면 flush 시각을 잡도록, MTU 가 차면 바로 쓰도록 깨움
+  wake = ble_stream.count == 1 || ble_stream.bytes + BLE_STREAM_REC_MAX > ble_link.chunk;
+  taskEXIT_CRITICAL();
+
+  if (wake)
+  {
+    xTaskNotifyGive(ble_instance.tx_task);
+  }
+
+  return true;
+}
+
+/**
+ * @brief 바이패스 RTCM 입력 상태 (RX 태스크 전용)
+ */
+static struct
+{
+  bool enabled;    // 보정 데이터를 받는 보드 (GPS 있고 베이스 아님)
+  uint8_t hdr[3];  // 조각 경계에 걸친 프레임 헤더
+  uint8_t hdr_pos; // 받은 헤더 바이트 (3 이면 본문 수신 중)
+  uint16_t left;   // 라우터로 더 넘길 프레임 바이트
+} ble_rtcm;
+
+/**
+ * @brief 바이패스 수신 조각을 RTCM 프레임과 앱 커맨드로 나눔 (RX 태스크)
+ *
+ * 줄 시작에서 0xD3 이 오면 RTCM 프레임으로 보고 헤더의 길이만큼은 커맨드
+ * 파서에 넣지 않는다 (바이너리가 우연히 RS, SS 같은 커맨드로 읽히지 않게).
+ * 프레임 바이트는 UART5 DMA ring 을 가리키는 채로 보정 라우터에 넘기므로
+ * 조각 안에 통째로 든 프레임은 복사 없이 CRC 검증 후 GPS 송신 ring 으로 간다.
+ */
+static void ble_rx_dispatch(ble_instance_t *inst, const char *data, size_t len)
+{
+  const uint8_t *d = (const uint8_t *)data;
+  const uint8_t *end = d + len;
+
+  if (!ble_rtcm.enabled || inst->current_mode != BLE_MODE_BYPASS)
+  {
+    ble_rtcm.hdr_pos = 0;
+    ble_rtcm.left = 0;
+    ble_cmd_parse_process(inst, data, len);
+    return;
+  }
+
+  while (d < end)
+  {
+    if (ble_rtcm.hdr_pos == 0)
+    {
+      const uint8_t *p = memchr(d, BLE_RTCM_PREAMBLE, (size_t)(end - d));
+      size_t n = p ? (size_t)(p - d) : (size_t)(end - d);
+
+      if (n > 0)
       {
-        if (tx_req.is_at == true)
-        {
-          inst->ble.ops->at_mode();
-        }
-        inst->ble.ops->send(tx_req.data, tx_req.len);
+        ble_cmd_parse_process(inst, d, n);
+        d += n;
+      }
+      if (!p)
+      {
+        break;
+      }
+      if (inst->parse_stae != BLE_CMD_PARSE_STATE_NONE)
+      {
+        // 커맨드 줄 중간의 0xD3 은 커맨드 바이트
+        ble_cmd_parse_process(inst, d, 1);
+        d++;
+        continue;
+      }
+    }
 
-        if (tx_req.is_at == true)
-        {
-          vTaskDelay(pdMS_TO_TICKS(10));
-          inst->ble.ops->bypass_mode();
-        }
-        LOG_DEBUG("BLE TX complete");
+    const uint8_t *start = d;
+
+    if (ble_rtcm.hdr_pos < 3)
+    {
+      bool hdr_here = ble_rtcm.hdr_pos == 0;
+
+      while (ble_rtcm.hdr_pos < 3 && d < end)
+      {
+        ble_rtcm.hdr[ble_rtcm.hdr_pos++] = *d++;
       }
-      else
+      if (ble_rtcm.hdr_pos < 3)
+      {
+        break;
+      }
+
+      // reserved 6 bit 가 0 이 아니면 RTCM 이 아님: 0xD3 뒤 바이트는 파서로
+      if (ble_rtcm.hdr[1] & 0xFC)
+      {
+        ble_rtcm.hdr_pos = 0;
+        ble_cmd_parse_process(inst, &ble_rtcm.hdr[1], 2);
+        continue;
+      }
+
+      ble_rtcm.left = BLE_RTCM_OVERHEAD + (((ble_rtcm.hdr[1] & 0x03) << 8) | ble_rtcm.hdr[2]) - 3;
+
+      // 헤더가 이전 조각에서 시작했으면 헤더만 따로 넘김 (라우터가 이어 붙임)
+      if (!hdr_here)
       {
-        LOG_ERR("BLE send ops not available");
+        rtcm_router_input(RTCM_SRC_BLE, ble_rtcm.hdr, 3);
+        start = d;
       }
+    }
+
+    size_t n = (size_t)(end - d);
+    if (n > ble_rtcm.left)
+    {
+      n = ble_rtcm.left;
+    }
+    d += n;
+    ble_rtcm.left -= n;
+    rtcm_router_input(RTCM_SRC_BLE, start, (size_t)(d - start));
 
-      xSemaphoreGive(inst->mutex);
+    if (ble_rtcm.left == 0)
+    {
+      ble_rtcm.hdr_pos = 0;
     }
   }
+}
 
-  vTaskDelete(NULL);
+/**
+ * @brief 비동기 AT 타임아웃 만료 (타임아웃 휠 태스크)
+ *
+ * 콜백과 모드 복귀는 기존처럼 RX 태스크가 mutex 를 잡고 처리하도록 깨우기만 한다.
+ */
+static void ble_async_at_expired(tmo_t *tmo)
+{
+  uint8_t dummy = 0;
+
+  (void)tmo;
+  xQueueSend(ble_instance.rx_queue, &dummy, 0);
 }
 
 static void ble_rx_task(void *pvParameter)
 {
   ble_instance_t *inst = (ble_instance_t *)pvParameter;
 
-  size_t pos = 0;
-  size_t old_pos = 0;
+  dma_ring_t ring;
   uint8_t dummy = 0;
-  size_t total_received = 0;
 
+  dma_ring_init(&ring, ble_port_get_recv_buf(), BLE_UART_MAX_RECV_SIZE, 0, 0);
   LOG_INFO("BLE RX Task started");
 
   while (1)
   {
-    xQueueReceive(inst->rx_queue, &dummy, pdMS_TO_TICKS(100));
+    // UART IDLE/DMA 이벤트 또는 비동기 AT 타임아웃이 깨움
+    xQueueReceive(inst->rx_queue, &dummy, portMAX_DELAY);
+    irq_lat_task(IRQ_LAT_UART5);
     xSemaphoreTake(inst->mutex, portMAX_DELAY);
     ble_check_async_at_timeout();
 
-    pos = ble_port_get_rx_pos();
-    char *ble_recv = ble_port_get_recv_buf();
+    uint32_t lost;
+    uint32_t pending = dma_ring_update(&ring, ble_port_get_rx_count(), &lost);
+
+    if (lost)
+    {
+      LOG_WARN("RX ring overrun, %lu bytes lost", lost);
+    }
 
-    if (pos != old_pos)
+    if (pending > 0)
     {
-      if (pos > old_pos)
+      dma_ring_span_t span[2];
+      uint8_t n = dma_ring_spans(&ring, span);
+
+      for (uint8_t i = 0; i < n; i++)
       {
-        size_t len = pos - old_pos;
-        total_received = len;
-        LOG_DEBUG_RAW("BLE RX: ", &ble_recv[old_pos], len);
-        // 항상 파싱 (AT 응답 또는 앱 커맨드 처리)
-        ble_cmd_parse_process(inst, &ble_recv[old_pos], len);
-
-        // Bypass 모드에서는 콜백도 호출 (raw 데이터 전달)
-        if (inst->current_mode == BLE_MODE_BYPASS && inst->bypass_rx_callback != NULL)
-        {
-          inst->bypass_rx_callback((const uint8_t *)&ble_recv[old_pos], len);
-        }
+        LOG_DEBUG_RAW("BLE RX: ", span[i].p, span[i].len);
+        // 항상 파싱 (AT 응답 또는 앱 커맨드 처리, 바이패스 RTCM 은 보정 라우터로)
+        ble_rx_dispatch(inst, (const char *)span[i].p, span[i].len);
       }
-      else
-      {
-        size_t len1 = BLE_UART_MAX_RECV_SIZE - old_pos;
-        size_t len2 = pos;
-        total_received = len1 + len2;
-        LOG_DEBUG_RAW("BLE RX: ", &ble_recv[old_pos], len1);
-        // 항상 파싱 (AT 응답 또는 앱 커맨드 처리)
-        ble_cmd_parse_process(inst, &ble_recv[old_pos],
-                              BLE_UART_MAX_RECV_SIZE - old_pos);
-        if (pos > 0)
-        {
-          LOG_DEBUG_RAW("BLE RX: ", ble_recv, len2);
-          ble_cmd_parse_process(inst, ble_recv, pos);
-        }
 
-        // Bypass 모드에서는 콜백도 호출 (raw 데이터 전달)
-        if (inst->current_mode == BLE_MODE_BYPASS && inst->bypass_rx_callback != NULL)
+      // Bypass 모드에서는 콜백도 호출 (raw 데이터 전달)
+      if (inst->current_mode == BLE_MODE_BYPASS && inst->bypass_rx_callback != NULL)
+      {
+        for (uint8_t i = 0; i < n; i++)
         {
-          inst->bypass_rx_callback((const uint8_t *)&ble_recv[old_pos], len1);
-          if (pos > 0)
-          {
-            inst->bypass_rx_callback((const uint8_t *)ble_recv, len2);
-          }
+          inst->bypass_rx_callback(span[i].p, span[i].len);
         }
       }
-      old_pos = pos;
-      if (old_pos == BLE_UART_MAX_RECV_SIZE)
-      {
-        old_pos = 0;
-      }
+      mem_wm_update(&ble_rx_wm, pending + lost < ring.size ? pending + lost : ring.size);
+      dma_ring_consume(&ring, pending);
     }
 
     xSemaphoreGive(inst->mutex);
@@ -244,6 +990,8 @@ void ble_init_all(void)
   ble_instance.conn_state = BLE_CONN_DISCONNECTED; // 초기 연결 상태
   ble_instance.bypass_rx_callback = NULL;          // 콜백 초기화
   ble_instance.async_at_cmd.is_active = false;
+  ble_rtcm.enabled = config->gps_cnt > 0 && config->lora_mode != LORA_MODE_BASE;
+  ble_cmd_init();
 
   if (ble_port_init_instance(&ble_instance.ble) != 0)
   {
@@ -252,55 +1000,33 @@ void ble_init_all(void)
     return;
   }
 
-  ble_instance.rx_queue = xQueueCreate(10, sizeof(uint8_t));
-  if (ble_instance.rx_queue == NULL)
-  {
-    LOG_ERR("BLE RX 큐 생성 실패");
-    ble_instance.enabled = false;
-    return;
-  }
+  ble_instance.rx_queue = RTOS_QUEUE_CREATE_STATIC(ble_rx_queue, BLE_RX_QUEUE_LEN,
+                                                   sizeof(uint8_t));
 
   ble_port_set_queue(ble_instance.rx_queue);
+  mem_wm_register(&ble_rx_wm);
 
-  ble_instance.tx_queue = xQueueCreate(5, sizeof(ble_tx_request_t));
-  if (ble_instance.tx_queue == NULL)
-  {
-    LOG_ERR("BLE TX 큐 생성 실패");
-    ble_instance.enabled = false;
-    return;
-  }
+  ble_instance.tx_queue = RTOS_QUEUE_CREATE_STATIC(ble_tx_queue, BLE_TX_QUEUE_LEN,
+                                                   sizeof(tx_buf_t *));
+  ble_instance.mutex = xSemaphoreCreateMutexStatic(&ble_mutex_buf);
 
-  ble_instance.mutex = xSemaphoreCreateMutex();
-  if (ble_instance.mutex == NULL)
-  {
-    LOG_ERR("BLE mutex 생성 실패");
-    ble_instance.enabled = false;
-    return;
-  }
+  tmo_init(&ble_instance.async_at_tmo, ble_async_at_expired, NULL);
 
   ble_port_start(&ble_instance.ble);
+  ble_cfg_start();
 
-  BaseType_t ret = xTaskCreate(ble_rx_task, "ble_rx", 512,
-                               (void *)&ble_instance,
-                               tskIDLE_PRIORITY + 1, &ble_instance.rx_task);
+  ble_instance.rx_task = RTOS_TASK_CREATE_STATIC(ble_rx, ble_rx_task, "ble_rx",
+                                                 (void *)&ble_instance, tskIDLE_PRIORITY + 1);
+  ble_instance.tx_task = RTOS_TASK_CREATE_STATIC(ble_tx, ble_tx_task, "ble_tx",
+                                                 (void *)&ble_instance, tskIDLE_PRIORITY + 1);
 
-  if (ret != pdPASS)
+  // 설정할 것이 있으면 TX 태스크가 첫 AT 를 보내도록
+  if (ble_cfg.step != BLE_CFG_IDLE)
   {
-    LOG_ERR("BLE RX 태스크 생성 실패");
-    ble_instance.enabled = false;
-    return;
+    xTaskNotifyGive(ble_instance.tx_task);
   }
 
-  ret = xTaskCreate(ble_tx_task, "ble_tx", 512,
-                    (void *)&ble_instance,
-                    tskIDLE_PRIORITY + 1, &ble_instance.tx_task);
-
-  if (ret != pdPASS)
-  {
-    LOG_ERR("BLE TX 태스크 생성 실패");
-    ble_instance.enabled = false;
-    return;
-  }
+  pos_out_register(&ble_stream_sink);
 
   LOG_INFO("BLE 초기화 완료");
 }
@@ -320,15 +1046,43 @@ ble_instance_t *ble_get_instance(void)
   return &ble_instance;
 }
 
+/* ble_run_line() 중인 태스크의 응답 경로 */
+static ble_reply_t ble_reply;
+static TaskHandle_t ble_reply_task;
+
+bool ble_run_line(const char *line, size_t len, ble_reply_t reply)
+{
+  bool found;
+
+  if (!ble_instance.enabled || !ble_instance.mutex)
+  {
+    return false;
+  }
+
+  xSemaphoreTake(ble_instance.mutex, portMAX_DELAY);
+  ble_reply_task = xTaskGetCurrentTaskHandle();
+  ble_reply = reply;
+  found = ble_app_cmd_run(line, len);
+  ble_reply = NULL;
+  xSemaphoreGive(ble_instance.mutex);
+
+  return found;
+}
+
 bool ble_send(const char *data, size_t len, bool is_at)
 {
+  if (!is_at && ble_reply && ble_reply_task == xTaskGetCurrentTaskHandle())
+  {
+    return ble_reply(data, len);
+  }
+
   if (!ble_instance.enabled)
   {
     LOG_ERR("BLE not enabled");
     return false;
   }
 
-  if (!data || len == 0 || len > 512)
+  if (!data || len == 0 || len > TX_POOL_LARGE_SIZE)
   {
     LOG_ERR("BLE invalid send parameters");
     return false;
@@ -346,17 +1100,26 @@ bool ble_send(const char *data, size_t len, bool is_at)
     return false;
   }
 
-  ble_tx_request_t tx_req;
-  memcpy(tx_req.data, data, len);
-  tx_req.len = len;
-  tx_req.is_at = is_at;
+  tx_buf_t *tx_req = tx_buf_dup(data, len, pdMS_TO_TICKS(1000));
+  if (!tx_req)
+  {
+    LOG_ERR("BLE TX buffer pool empty");
+    return false;
+  }
+  tx_req->flags = is_at ? BLE_TX_FLAG_AT : 0;
 
   if (xQueueSend(ble_instance.tx_queue, &tx_req, pdMS_TO_TICKS(1000)) != pdTRUE)
   {
     LOG_ERR("BLE TX queue full");
+    tx_buf_free(tx_req);
     return false;
   }
 
+  if (ble_instance.tx_task)
+  {
+    xTaskNotifyGive(ble_instance.tx_task);
+  }
+
   return true;
 }
 
@@ -391,7 +1154,7 @@ ble_at_status_t ble_send_at_command_async(const char *at_cmd, const char *expect
   request.response_len = 0;
   request.status = BLE_AT_STATUS_PENDING;
   request.timeout_ticks = pdMS_TO_TICKS(timeout_ms);
-  request.wait_sem = xSemaphoreCreateBinary();
+  request.wait_sem = HEAP_TRACK(HEAP_TAG_CMD_SEM, xSemaphoreCreateBinary());
 
   if (request.wait_sem == NULL)
   {
@@ -588,6 +1351,19 @@ bool ble_set_uart_baudrate_async(uint32_t baudrate, uint32_t timeout_ms)
   return false;
 }
 
+size_t ble_link_format(char *buf, size_t size)
+{
+  bool conn = ble_get_connection_state() == BLE_CONN_CONNECTED;
+  uint32_t ms = conn ? (xTaskGetTickCount() - ble_link.conn_tick) * portTICK_PERIOD_MS : 0;
+  uint32_t bytes = ble_link.tx_bytes;
+  int n = snprintf(buf, size, "+BL,conn=%d,mtu=%d,dle=%d,ci=%d,chunk=%u,tx=%lu,bps=%lu\n\r",
+                   conn, ble_link.mtu ? BLE_LINK_MTU : 23, ble_link.dle, ble_link.ci,
+                   ble_link.chunk, (unsigned long)bytes,
+                   ms ? (unsigned long)((uint64_t)bytes * 8000U / ms) : 0UL);
+
+  return n < 0 || (size_t)n >= size ? 0 : (size_t)n;
+}
+
 // BLE 연결 상태 조회
 ble_connection_state_t ble_get_connection_state(void)
 {
@@ -615,6 +1391,23 @@ void ble_set_connection_state(ble_connection_state_t state)
   ble_instance.conn_state = state;
   //  xSemaphoreGive(ble_instance.mutex);
 
+  // 다음 연결의 앱이 원하지 않는 스트림을 받지 않도록 끊기면 끔 (ring 은 다음 켤 때 비움)
+  if (state == BLE_CONN_DISCONNECTED)
+  {
+    ble_stream.enabled = false;
+    pos_out_enable(&ble_stream_sink, false);
+  }
+
+  // 링크 파라미터는 TX 태스크가 다시 요청
+  if (ble_instance.tx_task)
+  {
+    BaseType_t woken = pdFALSE;
+
+    ble_link.changed = true;
+    vTaskNotifyGiveFromISR(ble_instance.tx_task, &woken);
+    portYIELD_FROM_ISR(woken);
+  }
+
   if (state == BLE_CONN_CONNECTED)
   {
     LOG_INFO("BLE Connected");
@@ -750,6 +1543,9 @@ bool ble_send_at_cmd_truly_async(const char *at_cmd, ble_at_command_callback_t c
 
   xSemaphoreGive(ble_instance.mutex);
 
+  // 0ms 타임아웃도 다음 tick 에 만료
+  tmo_arm(&ble_instance.async_at_tmo, timeout_ms);
+
   // AT 모드로 전환
 
   LOG_INFO("Switching to AT mode for async command");
@@ -783,6 +1579,8 @@ bool ble_send_at_cmd_truly_async(const char *at_cmd, ble_at_command_callback_t c
 
     xSemaphoreGive(ble_instance.mutex);
 
+    tmo_cancel(&ble_instance.async_at_tmo);
+
     // Bypass 모드로 복귀
 
     if (ble_instance.ble.ops && ble_instance.ble.ops->bypass_mode)
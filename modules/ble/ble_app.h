@@ -5,11 +5,15 @@
 #include "queue.h"
 #include "semphr.h"
 #include "task.h"
+#include "timers.h"
+#include "tmo_wheel.h"
 #include "ble.h"
+#include "at_cmd.h"
+#include "board_config.h"
 #include <stdbool.h>
 #include <stdint.h>
 
-#define BLE_UART_MAX_RECV_SIZE 1024
+#define BLE_UART_MAX_RECV_SIZE BLE_RX_RING_SIZE
 #define BLE_AT_RESPONSE_MAX_SIZE 256
 
 typedef enum
@@ -65,25 +69,20 @@ typedef struct
   TickType_t timeout_ticks; // 타임아웃 (ticks)
 } ble_async_at_request_t;
 
-typedef struct
-{
-  char data[512];
-  size_t len;
-  bool is_at;
-} ble_tx_request_t;
+// tx_queue 항목은 tx_buf_t * (tx_pool), flags 에 AT 여부
+#define BLE_TX_FLAG_AT 0x01
 
-typedef struct
-{
-  char data[100];
-  size_t pos;
-  char prev_char;
-} ble_cmd_parser_t;
+// 위치 스트림 (GS+1): tx_queue 대신 고정 크기 ring 에 레코드를 쌓고 MTU 단위로 묶어 씀
+#define BLE_STREAM_REC_MAX 40   // 레코드 하나 최대 바이트
+#define BLE_STREAM_RING_RECS 16 // ring 레코드 수 (가득 차면 가장 오래된 것부터 버림)
+#define BLE_STREAM_MTU 244      // 한 번에 쓰는 최대 바이트 (MTU 247 협상 때, 아니면 20)
+#define BLE_STREAM_FLUSH_MS 100 // MTU 가 안 차도 가장 오래된 레코드가 이만큼 기다리면 씀
 
 typedef struct
 {
   ble_t ble;
   ble_cmd_parse_state_t parse_stae;
-  ble_cmd_parser_t parser;
+  at_cmd_line_t parser;
   QueueHandle_t rx_queue;
   TaskHandle_t rx_task;
   bool enabled;
@@ -103,6 +102,7 @@ typedef struct
   // Bypass 모드 데이터 수신 콜백
   ble_bypass_rx_callback_t bypass_rx_callback;
   ble_async_at_cmd_t async_at_cmd;
+  tmo_t async_at_tmo; // async_at_cmd 타임아웃 (만료 시 RX 태스크 깨움)
 } ble_instance_t;
 
 void ble_init_all(void);
@@ -111,6 +111,19 @@ ble_t *ble_get_handle(void);
 ble_instance_t *ble_get_instance(void);
 bool ble_send(const char *data, size_t len, bool is_at);
 
+typedef bool (*ble_reply_t)(const char *data, size_t len);
+
+/**
+ * @brief 다른 포트 (USB) 에서 받은 앱 커맨드 줄 처리
+ *
+ * BLE RX 와 같은 잠금 안에서 돌고, 그동안 이 태스크의 ble_send(.., false)
+ * 는 reply 로 간다.
+ *
+ * @param line NUL 로 끝나는 줄 ("GN" 등)
+ * @return false BLE 꺼짐 또는 없는 커맨드
+ */
+bool ble_run_line(const char *line, size_t len, ble_reply_t reply);
+
 // 비동기 AT 커맨드 전송 (응답 대기)
 ble_at_status_t ble_send_at_command_async(const char *at_cmd, const char *expected_response,
                                           char *response_buf, size_t response_buf_size,
@@ -135,6 +148,16 @@ void ble_set_connection_state(ble_connection_state_t state);
 // 현재 모드 조회
 ble_mode_t ble_get_current_mode(void);
 
+// 링크 상태 +BL,conn=,mtu=,dle=,ci=,chunk=,tx=,bps= (bps 는 연결 이후 평균)
+size_t ble_link_format(char *buf, size_t size);
+
+// 위치 스트림 켜기/끄기 (연결이 끊기면 자동으로 꺼짐)
+void ble_stream_enable(bool enable);
+bool ble_stream_is_enabled(void);
+
+// 스트림 레코드 추가 (GPS 태스크, 스트림이 꺼져 있으면 false)
+bool ble_stream_push(const uint8_t *rec, size_t len);
+
 // Bypass 모드 RX 콜백 등록 (Bypass 모드에서 수신된 데이터를 전달받음)
 void ble_set_bypass_rx_callback(ble_bypass_rx_callback_t callback);
 bool ble_get_device_name_async(char *device_name_buf, size_t buf_size, uint32_t timeout_ms);
@@ -8,6 +8,31 @@
 #include "flash_params.h"
 #include "ble.h"
 #include "ble_app.h"
+#include "gps_app.h"
+#include "gps_tee.h"
+#include "gps_grid.h"
+#include "pos_out.h"
+#include "rtcm_loadgen.h"
+#include "gps_cycle_bench.h"
+#include "rtcm_router.h"
+#include "ntrip_monitor.h"
+#include "lora_stats.h"
+#include "lora_app.h"
+#include "rtos_stats.h"
+#include "irq_latency.h"
+#include "epoch_deadline.h"
+#include "boot_timeline.h"
+#include "boot_stage.h"
+#include "pm_trace.h"
+#include "heap_track.h"
+#include "mem_watermark.h"
+#include "load_gov.h"
+#include "soak.h"
+#include "data_usage.h"
+#include "diag_bundle.h"
+#include "telemetry.h"
+#include "track_log.h"
+#include "sd_log.h"
 
 #ifndef TAG
 #define TAG "BLE_CMD"
@@ -15,104 +40,201 @@
 
 #include "log.h"
 
-static const char *ble_resp_str_ok = "OK\n";
-static const char *ble_resp_str_invalid = "+E01\n";
-static const char *ble_resp_str_param_err = "+E02\n";
-static const char *ble_resp_str_not_rdy = "+E03\n";
-static const char *ble_resp_str_err = "+ERROR\n";
+static const at_resp_t ble_resp_ok = AT_RESP("OK\n");
+static const at_resp_t ble_resp_invalid = AT_RESP("+E01\n");
+static const at_resp_t ble_resp_param_err = AT_RESP("+E02\n");
+static const at_resp_t ble_resp_not_rdy = AT_RESP("+E03\n");
+static const at_resp_t ble_resp_err = AT_RESP("+ERROR\n");
 
 #define BLE_AT_RESP_SEND(data) ble_send(data, strlen(data), false)
-
-#define BLE_AT_RESP_SEND_OK() BLE_AT_RESP_SEND(ble_resp_str_ok)
-#define BLE_AT_RESP_SEND_INVALID() BLE_AT_RESP_SEND(ble_resp_str_invalid)
-#define BLE_AT_RESP_SEND_PARAM_ERR() BLE_AT_RESP_SEND(ble_resp_str_param_err)
-#define BLE_AT_RESP_SEND_NOT_RDY() BLE_AT_RESP_SEND(ble_resp_str_not_rdy)
-#define BLE_AT_RESP_SEND_ERR() BLE_AT_RESP_SEND(ble_resp_str_err)
-
-static void sd_handler(ble_instance_t *inst, const char *param);
-static void sc_handler(ble_instance_t *inst, const char *param);
-static void sm_handler(ble_instance_t *inst, const char *param);
-static void si_handler(ble_instance_t *inst, const char *param);
-static void sp_handler(ble_instance_t *inst, const char *param);
-static void sg_handler(ble_instance_t *inst, const char *param);
-static void ss_handler(ble_instance_t *inst, const char *param);
-static void gd_handler(ble_instance_t *inst, const char *param);
-static void gi_handler(ble_instance_t *inst, const char *param);
-static void gp_handler(ble_instance_t *inst, const char *param);
-static void gg_handler(ble_instance_t *inst, const char *param);
-static void rs_handler(ble_instance_t *inst, const char *param);
-
-void bot_ok_handler(ble_instance_t *inst, const char *param)
+#define BLE_AT_RESP_SEND_FIXED(resp) ble_send((resp).str, (resp).len, false)
+
+#define BLE_AT_RESP_SEND_OK() BLE_AT_RESP_SEND_FIXED(ble_resp_ok)
+#define BLE_AT_RESP_SEND_INVALID() BLE_AT_RESP_SEND_FIXED(ble_resp_invalid)
+#define BLE_AT_RESP_SEND_PARAM_ERR() BLE_AT_RESP_SEND_FIXED(ble_resp_param_err)
+#define BLE_AT_RESP_SEND_NOT_RDY() BLE_AT_RESP_SEND_FIXED(ble_resp_not_rdy)
+#define BLE_AT_RESP_SEND_ERR() BLE_AT_RESP_SEND_FIXED(ble_resp_err)
+
+// DG+<off> 한 번에 보내는 진단 묶음 조각
+#define BLE_DIAG_CHUNK 200
+
+static void sd_handler(void *ctx, const char *param, size_t param_len);
+static void sc_handler(void *ctx, const char *param, size_t param_len);
+static void sm_handler(void *ctx, const char *param, size_t param_len);
+static void si_handler(void *ctx, const char *param, size_t param_len);
+static void sp_handler(void *ctx, const char *param, size_t param_len);
+static void sg_handler(void *ctx, const char *param, size_t param_len);
+static void ss_handler(void *ctx, const char *param, size_t param_len);
+static void gd_handler(void *ctx, const char *param, size_t param_len);
+static void gi_handler(void *ctx, const char *param, size_t param_len);
+static void gp_handler(void *ctx, const char *param, size_t param_len);
+static void gg_handler(void *ctx, const char *param, size_t param_len);
+static void rs_handler(void *ctx, const char *param, size_t param_len);
+static void bm_handler(void *ctx, const char *param, size_t param_len);
+static void sf_handler(void *ctx, const char *param, size_t param_len);
+static void gn_handler(void *ctx, const char *param, size_t param_len);
+static void gs_handler(void *ctx, const char *param, size_t param_len);
+static void cl_handler(void *ctx, const char *param, size_t param_len);
+static void du_handler(void *ctx, const char *param, size_t param_len);
+static void du_set_handler(void *ctx, const char *param, size_t param_len);
+static void rd_handler(void *ctx, const char *param, size_t param_len);
+static void rb_handler(void *ctx, const char *param, size_t param_len);
+static void ns_handler(void *ctx, const char *param, size_t param_len);
+static void ls_handler(void *ctx, const char *param, size_t param_len);
+static void st_handler(void *ctx, const char *param, size_t param_len);
+static void ts_handler(void *ctx, const char *param, size_t param_len);
+static void lv_set_handler(void *ctx, const char *param, size_t param_len);
+static void lv_handler(void *ctx, const char *param, size_t param_len);
+static void lg_handler(void *ctx, const char *param, size_t param_len);
+static void sk_handler(void *ctx, const char *param, size_t param_len);
+static void sk_set_handler(void *ctx, const char *param, size_t param_len);
+static void bl_handler(void *ctx, const char *param, size_t param_len);
+static void bt_handler(void *ctx, const char *param, size_t param_len);
+static void hp_handler(void *ctx, const char *param, size_t param_len);
+static void pt_handler(void *ctx, const char *param, size_t param_len);
+static void wm_handler(void *ctx, const char *param, size_t param_len);
+static void il_handler(void *ctx, const char *param, size_t param_len);
+static void ed_handler(void *ctx, const char *param, size_t param_len);
+static void rt_set_handler(void *ctx, const char *param, size_t param_len);
+static void sv_handler(void *ctx, const char *param, size_t param_len);
+static void dg_handler(void *ctx, const char *param, size_t param_len);
+static void dg_set_handler(void *ctx, const char *param, size_t param_len);
+static void rg_handler(void *ctx, const char *param, size_t param_len);
+static void rg_set_handler(void *ctx, const char *param, size_t param_len);
+static void rt_handler(void *ctx, const char *param, size_t param_len);
+static void td_handler(void *ctx, const char *param, size_t param_len);
+static void tk_handler(void *ctx, const char *param, size_t param_len);
+static void tk_set_handler(void *ctx, const char *param, size_t param_len);
+static void rl_handler(void *ctx, const char *param, size_t param_len);
+static void rl_set_handler(void *ctx, const char *param, size_t param_len);
+static void ge_handler(void *ctx, const char *param, size_t param_len);
+static void gr_handler(void *ctx, const char *param, size_t param_len);
+static void gr_set_handler(void *ctx, const char *param, size_t param_len);
+
+void bot_ok_handler(void *ctx, const char *param, size_t param_len)
 {
     LOG_DEBUG("BLE AT OK received");
 }
 
-void bot_err_handler(ble_instance_t *inst, const char *param)
+void bot_err_handler(void *ctx, const char *param, size_t param_len)
 {
     LOG_DEBUG("BLE AT ERROR received");
 }
 
-void bot_rdy_handler(ble_instance_t *inst, const char *param)
+void bot_rdy_handler(void *ctx, const char *param, size_t param_len)
 {
     LOG_DEBUG("BLE AT READY received");
 }
 
-void bot_advertising_handler(ble_instance_t *inst, const char *param)
+void bot_advertising_handler(void *ctx, const char *param, size_t param_len)
 {
     LOG_DEBUG("BLE AT ADVERTISING");
 }
 
-void bot_connected_handler(ble_instance_t *inst, const char *param)
+void bot_connected_handler(void *ctx, const char *param, size_t param_len)
 {
     LOG_DEBUG("BLE AT CONNECTED");
 }
 
-void bot_disconnected_handler(ble_instance_t *inst, const char *param)
+void bot_disconnected_handler(void *ctx, const char *param, size_t param_len)
 {
     LOG_DEBUG("BLE AT DISCONNECTED");
 }
 
-// AT+UART=xxxx
-// AT+MANUF=xxxxxxxx
-static const ble_at_cmd_entry_t bot_cmd_table[] = {
-    {"+OK", bot_ok_handler},
-    {"+ERROR", bot_err_handler},
-    {"+READY", bot_rdy_handler},
-    {"+ADVERTISING", bot_advertising_handler},
-    {"+CONNECTED", bot_connected_handler},
-    {"+DISCONNECTED", bot_disconnected_handler},
+// 모듈 응답 (AT+UART=xxxx, AT+MANUF=xxxxxxxx 등), 이름 순으로 정렬해서 추가
+static const at_cmd_entry_t bot_cmd_entries[] = {
+    AT_CMD("+ADVERTISING", bot_advertising_handler),
+    AT_CMD("+CONNECTED", bot_connected_handler),
+    AT_CMD("+DISCONNECTED", bot_disconnected_handler),
+    AT_CMD("+ERROR", bot_err_handler),
+    AT_CMD("+OK", bot_ok_handler),
+    AT_CMD("+READY", bot_rdy_handler),
+};
+
+// 앱 커맨드, 이름 순으로 정렬해서 추가
+static const at_cmd_entry_t app_cmd_entries[] = {
+    AT_CMD("BL", bl_handler),
+    AT_CMD("BM", bm_handler),
+    AT_CMD("BT", bt_handler),
+    AT_CMD("CL", cl_handler),
+    AT_CMD("DG", dg_handler),
+    AT_CMD("DG+", dg_set_handler),
+    AT_CMD("DU", du_handler),
+    AT_CMD("DU+", du_set_handler),
+    AT_CMD("ED", ed_handler),
+    AT_CMD("GD", gd_handler),
+    AT_CMD("GE+", ge_handler),
+    AT_CMD("GG", gg_handler),
+    AT_CMD("GI", gi_handler),
+    AT_CMD("GN", gn_handler),
+    AT_CMD("GP", gp_handler),
+    AT_CMD("GR", gr_handler),
+    AT_CMD("GR+", gr_set_handler),
+    AT_CMD("GS+", gs_handler),
+    AT_CMD("HP", hp_handler),
+    AT_CMD("IL", il_handler),
+    AT_CMD("LG", lg_handler),
+    AT_CMD("LS", ls_handler),
+    AT_CMD("LV", lv_handler),
+    AT_CMD("LV+", lv_set_handler),
+    AT_CMD("NS", ns_handler),
+    AT_CMD("PT", pt_handler),
+    AT_CMD("RB", rb_handler),
+    AT_CMD("RD", rd_handler),
+    AT_CMD("RG", rg_handler),
+    AT_CMD("RG+", rg_set_handler),
+    AT_CMD("RL", rl_handler),
+    AT_CMD("RL+", rl_set_handler),
+    AT_CMD("RS", rs_handler),
+    AT_CMD("RT", rt_handler),
+    AT_CMD("RT+", rt_set_handler),
+    AT_CMD("SC+", sc_handler),
+    AT_CMD("SD+", sd_handler),
+    AT_CMD("SF+", sf_handler),
+    AT_CMD("SG+", sg_handler),
+    AT_CMD("SI+", si_handler),
+    AT_CMD("SK", sk_handler),
+    AT_CMD("SK+", sk_set_handler),
+    AT_CMD("SM+", sm_handler),
+    AT_CMD("SP+", sp_handler),
+    AT_CMD("SS", ss_handler),
+    AT_CMD("ST+", st_handler),
+    AT_CMD("SV", sv_handler),
+    AT_CMD("TD+", td_handler),
+    AT_CMD("TK", tk_handler),
+    AT_CMD("TK+", tk_set_handler),
+    AT_CMD("TS", ts_handler),
+    AT_CMD("WM", wm_handler),
 };
 
-static const ble_at_cmd_entry_t at_cmd_table[] = {
-    {"SD+", sd_handler},
-    {"SC+", sc_handler},
-    {"SM+", sm_handler},
-    {"SI+", si_handler},
-    {"SP+", sp_handler},
-    {"SG+", sg_handler},
-    {"SS", ss_handler},
-    {"GD", gd_handler},
-    {"GI", gi_handler},
-    {"GP", gp_handler},
-    {"GG", gg_handler},
-    {"RS", rs_handler},
-    {NULL, NULL}};
+static const at_cmd_table_t bot_cmd_table = AT_CMD_TABLE(bot_cmd_entries);
+static const at_cmd_table_t app_cmd_table = AT_CMD_TABLE(app_cmd_entries);
 
-void ble_app_cmd_handler(ble_instance_t *inst)
+void ble_cmd_init(void)
 {
-    for (int i = 0; at_cmd_table[i].name != NULL; i++)
-    {
-        size_t name_len = strlen(at_cmd_table[i].name);
+    int bad;
 
-        if (strncmp(inst->parser.data, at_cmd_table[i].name, name_len) == 0)
-        {
-            at_cmd_table[i].handler(inst, inst->parser.data + name_len);
-            return;
-        }
+    if ((bad = at_cmd_table_check(&bot_cmd_table)) >= 0)
+    {
+        LOG_ERR("BLE bot cmd table not sorted at %s", bot_cmd_entries[bad].name);
     }
+    if ((bad = at_cmd_table_check(&app_cmd_table)) >= 0)
+    {
+        LOG_ERR("BLE app cmd table not sorted at %s", app_cmd_entries[bad].name);
+    }
+}
+
+void ble_app_cmd_handler(ble_instance_t *inst, size_t len)
+{
+    at_cmd_dispatch(&app_cmd_table, inst, inst->parser.data, len);
+}
+
+bool ble_app_cmd_run(const char *line, size_t len)
+{
+    return at_cmd_dispatch(&app_cmd_table, ble_get_instance(), line, len);
 }
 
-void ble_at_cmd_handler(ble_instance_t *inst)
+void ble_at_cmd_handler(ble_instance_t *inst, size_t len)
 {
     if (inst->async_request != NULL && inst->async_request->status == BLE_AT_STATUS_PENDING)
     {
@@ -126,7 +248,7 @@ void ble_at_cmd_handler(ble_instance_t *inst)
 
             // 응답 저장
 
-            size_t data_len = strlen(inst->parser.data);
+            size_t data_len = len;
 
             if (data_len < BLE_AT_RESPONSE_MAX_SIZE)
             {
@@ -217,6 +339,8 @@ void ble_at_cmd_handler(ble_instance_t *inst)
 
             inst->async_at_cmd.is_active = false;
 
+            tmo_cancel(&inst->async_at_tmo);
+
             LOG_INFO("Switched back to bypass mode");
 
             return;
@@ -224,21 +348,11 @@ void ble_at_cmd_handler(ble_instance_t *inst)
     }
 
     // 비동기 요청이 없거나 매칭되지 않으면 기존 핸들러 실행
-    for (int i = 0; bot_cmd_table[i].name != NULL; i++)
-    {
-        size_t name_len = strlen(bot_cmd_table[i].name);
-
-        if (strncmp(inst->parser.data, bot_cmd_table[i].name, name_len) == 0)
-        {
-            bot_cmd_table[i].handler(inst, inst->parser.data + name_len);
-            return;
-        }
-    }
+    at_cmd_dispatch(&bot_cmd_table, inst, inst->parser.data, len);
 }
 
-static void sd_handler(ble_instance_t *inst, const char *param)
+static void sd_handler(void *ctx, const char *param, size_t param_len)
 {
-    user_params_t *params = flash_params_get_current();
     char buf[100];
     char device_name[32];
 
@@ -267,14 +381,13 @@ static void sd_handler(ble_instance_t *inst, const char *param)
     ble_get_handle()->ops->bypass_mode();
     
     flash_params_set_ble_device_name(device_name);
-    flash_params_erase();
-    flash_params_write(params);
+    flash_params_save_async();
 
     sprintf(buf, "Set %s Complete\n\r", device_name);
     ble_send((uint8_t *)buf, strlen(buf), false);
 }
 
-static void sc_handler(ble_instance_t *inst, const char *param)
+static void sc_handler(void *ctx, const char *param, size_t param_len)
 {
     user_params_t *params = flash_params_get_current();
     char buf[100];
@@ -298,7 +411,7 @@ static void sc_handler(ble_instance_t *inst, const char *param)
     sprintf(buf, "Set %s:%s Complete\n\r", params->ntrip_url, params->ntrip_port);
     ble_send((uint8_t *)buf, strlen(buf), false);
 }
-static void sm_handler(ble_instance_t *inst, const char *param)
+static void sm_handler(void *ctx, const char *param, size_t param_len)
 {
     user_params_t *params = flash_params_get_current();
     char buf[100];
@@ -312,7 +425,7 @@ static void sm_handler(ble_instance_t *inst, const char *param)
     sprintf(buf, "Set %s Complete\n\r", params->ntrip_mountpoint);
     ble_send((uint8_t *)buf, strlen(buf), false);
 }
-static void si_handler(ble_instance_t *inst, const char *param)
+static void si_handler(void *ctx, const char *param, size_t param_len)
 {
     user_params_t *params = flash_params_get_current();
     char buf[100];
@@ -327,7 +440,7 @@ static void si_handler(ble_instance_t *inst, const char *param)
     sprintf(buf, "Set %s Complete\n\r", params->ntrip_id);
     ble_send((uint8_t *)buf, strlen(buf), false);
 }
-static void sp_handler(ble_instance_t *inst, const char *param)
+static void sp_handler(void *ctx, const char *param, size_t param_len)
 {
     user_params_t *params = flash_params_get_current();
     char buf[100];
@@ -341,7 +454,7 @@ static void sp_handler(ble_instance_t *inst, const char *param)
     sprintf(buf, "Set %s Complete\n\r", params->ntrip_pw);
     ble_send((uint8_t *)buf, strlen(buf), false);
 }
-static void sg_handler(ble_instance_t *inst, const char *param)
+static void sg_handler(void *ctx, const char *param, size_t param_len)
 {
     char buf[100];
     int ret = 0;
@@ -388,18 +501,21 @@ static void sg_handler(ble_instance_t *inst, const char *param)
     }
 }
 
-static void ss_handler(ble_instance_t *inst, const char *param)
+static void ss_handler(void *ctx, const char *param, size_t param_len)
 {
     user_params_t *params = flash_params_get_current();
-    flash_params_erase();
-    flash_params_write(params);
+    flash_params_save(params);
 
     ble_send("Save Complete!\n\r", strlen("Save Complete!\n\r"), false);
-    vTaskDelay(pdMS_TO_TICKS(100));
-    NVIC_SystemReset();
+    // 바뀐 설정이 모두 바로 적용됐으면 (flash_params_watch) 재부팅하지 않음
+    if (flash_params_reboot_pending())
+    {
+        vTaskDelay(pdMS_TO_TICKS(100));
+        NVIC_SystemReset();
+    }
 }
 
-static void gd_handler(ble_instance_t *inst, const char *param)
+static void gd_handler(void *ctx, const char *param, size_t param_len)
 {
     user_params_t *params = flash_params_get_current();
     char device_name[40];
@@ -407,7 +523,7 @@ static void gd_handler(ble_instance_t *inst, const char *param)
     sprintf(device_name, "Get %s\n\r", params->ble_device_name);
     BLE_AT_RESP_SEND(device_name);
 }
-static void gi_handler(ble_instance_t *inst, const char *param)
+static void gi_handler(void *ctx, const char *param, size_t param_len)
 {
     user_params_t *params = flash_params_get_current();
     char id[40];
@@ -415,7 +531,7 @@ static void gi_handler(ble_instance_t *inst, const char *param)
     sprintf(id, "Get %s\n\r", params->ntrip_id);
     BLE_AT_RESP_SEND(id);
 }
-static void gp_handler(ble_instance_t *inst, const char *param)
+static void gp_handler(void *ctx, const char *param, size_t param_len)
 {
     user_params_t *params = flash_params_get_current();
     char pw[40];
@@ -423,7 +539,7 @@ static void gp_handler(ble_instance_t *inst, const char *param)
     sprintf(pw, "Get %s\n\r", params->ntrip_pw);
     BLE_AT_RESP_SEND(pw);
 }
-static void gg_handler(ble_instance_t *inst, const char *param)
+static void gg_handler(void *ctx, const char *param, size_t param_len)
 {
     user_params_t *params = flash_params_get_current();
     char loc[70];
@@ -431,9 +547,847 @@ static void gg_handler(ble_instance_t *inst, const char *param)
     sprintf(loc, "Get %s,%s,%s\n\r", params->lat, params->lon, params->alt);
     BLE_AT_RESP_SEND(loc);
 }
-static void rs_handler(ble_instance_t *inst, const char *param)
+static void rs_handler(void *ctx, const char *param, size_t param_len)
 {
     ble_get_handle()->ops->send("Device Reset\n", strlen("Device Reset\n"));
     vTaskDelay(pdMS_TO_TICKS(100));
     NVIC_SystemReset();
 }
+
+// 파서/CRC 커널 on-target 벤치마크 (byte당 DWT cycle)
+static void bm_handler(void *ctx, const char *param, size_t param_len)
+{
+    char buf[100];
+
+    if (!gps_cycle_bench_format(buf, sizeof(buf)))
+    {
+        BLE_AT_RESP_SEND_ERR();
+        return;
+    }
+
+    BLE_AT_RESP_SEND(buf);
+}
+
+// 위치 출력 형식 설정 (0: ASCII, 1: binary, 2/3: 평면 좌표 ASCII/binary), SS 로 저장
+static void sf_handler(void *ctx, const char *param, size_t param_len)
+{
+    char buf[40];
+    char *end;
+    long format = strtol(param, &end, 10);
+
+    if (end == param || format < 0 || format >= GPS_POS_FORMAT_COUNT)
+    {
+        BLE_AT_RESP_SEND_ERR();
+        return;
+    }
+
+    flash_params_set_pos_output_format((uint32_t)format);
+
+    sprintf(buf, "Set %ld Complete\n\r", format);
+    BLE_AT_RESP_SEND(buf);
+}
+
+// LoRa TDMA slot: ST+<slot>,<slot 수> (0,0 이면 끔), SS 로 저장하면 바로 적용
+static void st_handler(void *ctx, const char *param, size_t param_len)
+{
+    char buf[40];
+    char *end;
+    long slot = strtol(param, &end, 10);
+    long slots;
+
+    if (end == param || *end != ',')
+    {
+        BLE_AT_RESP_SEND_ERR();
+        return;
+    }
+
+    param = end + 1;
+    slots = strtol(param, &end, 10);
+    if (end == param || slot < 0 || slots < 0 || slots > LORA_TDMA_MAX_SLOTS || (slots != 0 && slot >= slots))
+    {
+        BLE_AT_RESP_SEND_ERR();
+        return;
+    }
+
+    flash_params_set_lora_tdma((uint32_t)slot, (uint32_t)slots);
+
+    sprintf(buf, "Set %ld/%ld Complete\n\r", slot, slots);
+    BLE_AT_RESP_SEND(buf);
+}
+
+// 현재 위치를 설정된 출력 형식으로 전송
+static void gn_handler(void *ctx, const char *param, size_t param_len)
+{
+    uint8_t buf[POS_OUT_BUF_SIZE];
+    size_t len = pos_out_get(POS_OUT_FMT_USER, buf, sizeof(buf));
+
+    if (len == 0)
+    {
+        BLE_AT_RESP_SEND_ERR();
+        return;
+    }
+
+    ble_send((const char *)buf, len, false);
+}
+
+// 위치 스트림: GS+1 이면 항법 해마다 binary 레코드를 MTU 단위로 묶어 보냄, GS+0 끔
+static void gs_handler(void *ctx, const char *param, size_t param_len)
+{
+    char buf[40];
+    char *end;
+    long enable = strtol(param, &end, 10);
+
+    if (end == param || (enable != 0 && enable != 1))
+    {
+        BLE_AT_RESP_SEND_ERR();
+        return;
+    }
+
+    // 응답이 스트림 레코드보다 먼저 가도록 켜기 전에 보냄
+    sprintf(buf, "Set %ld Complete\n\r", enable);
+    BLE_AT_RESP_SEND(buf);
+
+    ble_stream_enable(enable == 1);
+}
+
+// 보정 데이터 소스별 지연 통계 (CLR 이면 출력 후 초기화)
+static void cl_handler(void *ctx, const char *param, size_t param_len)
+{
+    char buf[512];
+    size_t len = rtcm_router_format_latency(buf, sizeof(buf));
+
+    if (len == 0)
+    {
+        BLE_AT_RESP_SEND_ERR();
+        return;
+    }
+
+    ble_send(buf, len, false);
+
+    if (param[0] == 'R')
+    {
+        rtcm_router_reset_latency();
+    }
+}
+
+// 들은 기준국과 거리, 고른 기준국 (sel)
+static void rb_handler(void *ctx, const char *param, size_t param_len)
+{
+    char buf[256];
+    size_t len = rtcm_router_format_bases(buf, sizeof(buf));
+
+    if (len == 0)
+    {
+        BLE_AT_RESP_SEND_ERR();
+        return;
+    }
+
+    ble_send(buf, len, false);
+}
+
+// 수신기 쪽 진단: 수신기가 쓴 보정 메시지 (+CENG) 와 포트 버퍼 (+RXC)
+static void rd_handler(void *ctx, const char *param, size_t param_len)
+{
+    static char buf[1280];
+    size_t len = rtcm_router_format_engine(buf, sizeof(buf));
+    size_t n = len ? gps_format_rx_comms(&buf[len], sizeof(buf) - len) : 0;
+
+    if (n == 0)
+    {
+        BLE_AT_RESP_SEND_ERR();
+        return;
+    }
+
+    ble_send(buf, len + n, false);
+}
+
+// NTRIP 스트림 처리량/끊김 통계 (NSR 이면 출력 후 초기화)
+static void ns_handler(void *ctx, const char *param, size_t param_len)
+{
+    char buf[400];
+    size_t len = ntrip_mon_format(buf, sizeof(buf));
+
+    if (len == 0)
+    {
+        BLE_AT_RESP_SEND_ERR();
+        return;
+    }
+
+    ble_send(buf, len, false);
+
+    if (param[0] == 'R')
+    {
+        ntrip_mon_reset();
+    }
+}
+
+// LoRa 보정 데이터 전달 통계 (LSR 이면 출력 후 초기화)
+static void ls_handler(void *ctx, const char *param, size_t param_len)
+{
+    // 타입이 많으면 700 바이트 넘음, 태스크 스택이 작아서 static
+    static char buf[768];
+    size_t len = lora_stats_format(buf, sizeof(buf));
+
+    if (len == 0)
+    {
+        BLE_AT_RESP_SEND_ERR();
+        return;
+    }
+
+    ble_send(buf, len, false);
+
+    if (param[0] == 'R')
+    {
+        lora_stats_reset();
+    }
+}
+
+// 궤적 기록 상태 (interval,first,last,pages,capacity,ram,records,bytes,dropped,errors)
+static void tk_handler(void *ctx, const char *param, size_t param_len)
+{
+    track_log_info_t info;
+    char buf[128];
+
+    track_log_get_info(&info);
+    sprintf(buf, "TK %lu,%lu,%lu,%lu,%lu,%u,%lu,%lu,%lu,%lu\n\r", info.interval_s,
+            info.first_seq, info.last_seq, info.pages, info.capacity, info.ram_records,
+            info.records, info.bytes, info.dropped_pages, info.write_errors);
+    BLE_AT_RESP_SEND(buf);
+}
+
+// 궤적 기록 간격 [s] (0 은 끔)
+static void tk_set_handler(void *ctx, const char *param, size_t param_len)
+{
+    char *end;
+    long sec = strtol(param, &end, 10);
+
+    if (end == param || sec < 0 || sec > TRACK_INTERVAL_MAX_S)
+    {
+        BLE_AT_RESP_SEND_ERR();
+        return;
+    }
+
+    flash_params_set_track_interval((uint32_t)sec);
+    BLE_AT_RESP_SEND_OK();
+}
+
+/*
+ * 궤적 페이지 내려받기 TD+<seq>,<count> (count 최대 32)
+ * "TD <n>" 뒤에 256 byte 페이지 n 개를 그대로, 끝에 OK (AT+TRKDL 과 같음)
+ */
+#define BLE_TRACK_DL_MAX 32
+
+static void td_handler(void *ctx, const char *param, size_t param_len)
+{
+    const uint8_t *pages[BLE_TRACK_DL_MAX];
+    char *end;
+    unsigned long seq = strtoul(param, &end, 10);
+    unsigned long count;
+    uint8_t n = 0;
+    char buf[24];
+
+    if (end == param || *end != ',')
+    {
+        BLE_AT_RESP_SEND_ERR();
+        return;
+    }
+    param = end + 1;
+    count = strtoul(param, &end, 10);
+    if (end == param || count == 0 || count > BLE_TRACK_DL_MAX)
+    {
+        BLE_AT_RESP_SEND_ERR();
+        return;
+    }
+
+    for (unsigned long i = 0; i < count; i++)
+    {
+        const uint8_t *page = track_log_page((uint32_t)(seq + i));
+
+        if (page)
+        {
+            pages[n++] = page;
+        }
+    }
+
+    sprintf(buf, "TD %u\n\r", n);
+    BLE_AT_RESP_SEND(buf);
+    for (uint8_t i = 0; i < n; i++)
+    {
+        ble_send((const char *)pages[i], TRACK_PAGE_SIZE, false);
+    }
+    BLE_AT_RESP_SEND_OK();
+}
+
+// SD raw 기록 (src,state,card_mb,epoch,next,chunks,bytes,dropped,errors,write_ms_max), AT+SDLOG? 와 같음
+static void rl_handler(void *ctx, const char *param, size_t param_len)
+{
+    sd_log_info_t info;
+    char buf[128];
+
+    sd_log_get_info(&info);
+    sprintf(buf, "RL %lu,%u,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu\n\r",
+            flash_params_get_current()->sd_log_src, info.state, info.card_mb, info.epoch,
+            info.next, info.chunks, info.bytes, info.dropped, info.write_errors,
+            info.write_ms_max);
+    BLE_AT_RESP_SEND(buf);
+}
+
+// RL+<src> 기록할 수신기 (0 끔, 1~ 수신기 번호 + 1) | RL+F 카드를 처음부터 (AT+SDFMT)
+static void rl_set_handler(void *ctx, const char *param, size_t param_len)
+{
+    char *end;
+    unsigned long src;
+
+    if (param[0] == 'F' && param[1] == '\0')
+    {
+        sd_log_format();
+        BLE_AT_RESP_SEND_OK();
+        return;
+    }
+
+    src = strtoul(param, &end, 10);
+    if (end == param || !sd_log_src_valid(src))
+    {
+        BLE_AT_RESP_SEND_ERR();
+        return;
+    }
+
+    flash_params_set_sd_log_src(src);
+    BLE_AT_RESP_SEND_OK();
+}
+
+// 평면 좌표 투영 GR+0 | GR+1[,zone] (UTM) | GR+2,lat0,lon0,k0,fe,fn (TM), AT+GRID 와 같음
+static void gr_set_handler(void *ctx, const char *param, size_t param_len)
+{
+    gps_grid_params_t grid = flash_params_get_current()->gps_grid;
+
+    if (!gps_grid_parse(param, &grid))
+    {
+        BLE_AT_RESP_SEND_ERR();
+        return;
+    }
+
+    flash_params_set_gps_grid(&grid);
+    BLE_AT_RESP_SEND_OK();
+}
+
+// 평면 좌표 datum GE+ell[,tx,ty,tz,rx,ry,rz,ds], AT+GRIDDS 와 같음
+static void ge_handler(void *ctx, const char *param, size_t param_len)
+{
+    gps_grid_params_t grid = flash_params_get_current()->gps_grid;
+
+    if (!gps_grid_parse_datum(param, &grid))
+    {
+        BLE_AT_RESP_SEND_ERR();
+        return;
+    }
+
+    flash_params_set_gps_grid(&grid);
+    BLE_AT_RESP_SEND_OK();
+}
+
+// 평면 좌표 상태 (mode,zone,ell,shift,valid,anchors,anchor_cyc,fwd_cyc)
+static void gr_handler(void *ctx, const char *param, size_t param_len)
+{
+    const gps_grid_params_t *grid = &flash_params_snapshot(NULL)->gps_grid;
+    gps_grid_info_t info;
+    bool shift = false;
+    char buf[96];
+
+    for (int i = 0; i < 7 && grid->mode <= GPS_GRID_TM; i++)
+    {
+        shift |= grid->shift[i] != 0.0;
+    }
+    gps_grid_get_info(&info);
+    sprintf(buf, "GR %lu,%lu,%lu,%d,%d,%lu,%lu,%lu\n\r", grid->mode, grid->zone, grid->ell,
+            shift, info.valid, info.anchors, info.anchor_cyc, info.fwd_cyc);
+    BLE_AT_RESP_SEND(buf);
+}
+
+// 태스크별 CPU/스택 여유, heap 상태 (TSR 이면 출력 후 CPU 구간 초기화)
+static void ts_handler(void *ctx, const char *param, size_t param_len)
+{
+    // 태스크 20개 가까이면 1KB 넘음, 태스크 스택이 작아서 static
+    static char buf[1280];
+    size_t len = rtos_stats_format(buf, sizeof(buf));
+
+    if (len == 0)
+    {
+        BLE_AT_RESP_SEND_ERR();
+        return;
+    }
+
+    ble_send(buf, len, false);
+
+    if (param[0] == 'R')
+    {
+        rtos_stats_reset();
+    }
+}
+
+// 실행 중 로그 레벨: LV+<TAG 또는 접두어*>,<0~4> ("*" 는 기본값, 규칙 초기화)
+static void lv_set_handler(void *ctx, const char *param, size_t param_len)
+{
+    char buf[48];
+    char tag[LOG_RULE_NAME_MAX];
+    const char *comma = memchr(param, ',', param_len);
+    char *end;
+    long level;
+
+    if (!comma || comma == param || (size_t)(comma - param) >= sizeof(tag))
+    {
+        BLE_AT_RESP_SEND_ERR();
+        return;
+    }
+
+    memcpy(tag, param, comma - param);
+    tag[comma - param] = '\0';
+    level = strtol(comma + 1, &end, 10);
+
+    if (end == comma + 1 || level < LOG_LEVEL_NONE || level > LOG_LEVEL_DEBUG ||
+        !log_set_level(tag, (uint8_t)level))
+    {
+        BLE_AT_RESP_SEND_ERR();
+        return;
+    }
+
+    sprintf(buf, "Set %s=%ld Complete\n\r", tag, level);
+    BLE_AT_RESP_SEND(buf);
+}
+
+static void lv_handler(void *ctx, const char *param, size_t param_len)
+{
+    char buf[256];
+    size_t len = log_format_levels(buf, sizeof(buf));
+
+    if (len == 0)
+    {
+        BLE_AT_RESP_SEND_ERR();
+        return;
+    }
+
+    ble_send(buf, len, false);
+}
+
+// 링크 파라미터 협상 결과와 이번 연결 평균 전송률
+static void bl_handler(void *ctx, const char *param, size_t param_len)
+{
+    char buf[96];
+    size_t len = ble_link_format(buf, sizeof(buf));
+
+    if (len == 0)
+    {
+        BLE_AT_RESP_SEND_ERR();
+        return;
+    }
+
+    ble_send(buf, len, false);
+}
+
+// LTE 데이터 사용량과 월 한도 단계 (data_usage.h)
+static void du_handler(void *ctx, const char *param, size_t param_len)
+{
+    char buf[256];
+    size_t len = data_usage_format(buf, sizeof(buf));
+
+    if (len == 0)
+    {
+        BLE_AT_RESP_SEND_ERR();
+        return;
+    }
+
+    ble_send(buf, len, false);
+}
+
+// 월 한도: DU+<MiB>[,<가벼운 마운트포인트>] (0 이면 정책 끔, 마운트포인트가 없으면 95 % 에서도 그대로), SS 로 저장
+static void du_set_handler(void *ctx, const char *param, size_t param_len)
+{
+    char *end;
+    uint32_t mb = strtoul(param, &end, 10);
+
+    if (end == param || (*end != '\0' && *end != ','))
+    {
+        BLE_AT_RESP_SEND_ERR();
+        return;
+    }
+
+    flash_params_set_lte_budget(mb, *end == ',' ? end + 1 : "");
+    BLE_AT_RESP_SEND_OK();
+}
+
+// 과부하 조절 단계 (load_gov.h)
+static void lg_handler(void *ctx, const char *param, size_t param_len)
+{
+    char buf[96];
+    size_t len = load_gov_format(buf, sizeof(buf));
+
+    if (len == 0)
+    {
+        BLE_AT_RESP_SEND_ERR();
+        return;
+    }
+
+    ble_send(buf, len, false);
+}
+
+// soak 추세 (soak.h): SK, SKS 는 시계열 원본
+static void sk_handler(void *ctx, const char *param, size_t param_len)
+{
+    static char buf[512];
+    uint16_t first = 0;
+    uint16_t next;
+    size_t len;
+
+    if (param[0] != 'S')
+    {
+        len = soak_format(buf, sizeof(buf));
+        if (len == 0)
+        {
+            BLE_AT_RESP_SEND_ERR();
+            return;
+        }
+        ble_send(buf, len, false);
+        return;
+    }
+
+    while ((len = soak_format_series(buf, sizeof(buf), first, &next)) > 0)
+    {
+        ble_send(buf, len, false);
+        first = next;
+    }
+
+    if (first == 0)
+    {
+        BLE_AT_RESP_SEND_ERR();
+    }
+}
+
+// soak 시작: SK+<분> (부하는 RG+ 로 먼저 켬), SK+0 이면 멈춤
+static void sk_set_handler(void *ctx, const char *param, size_t param_len)
+{
+    char *end;
+    uint32_t minutes = strtoul(param, &end, 10);
+
+    if (end == param || !soak_start(minutes))
+    {
+        BLE_AT_RESP_SEND_ERR();
+        return;
+    }
+
+    BLE_AT_RESP_SEND_OK();
+}
+
+// GNSS raw tee: RT+<mask>,<src>,<rate> (gps_tee.h, mask 0 이면 끔), SS 로 저장 후 적용
+static void rt_set_handler(void *ctx, const char *param, size_t param_len)
+{
+    gps_tee_params_t tee;
+    char *end;
+
+    tee.mask = strtoul(param, &end, 0);
+    if (end == param || *end != ',')
+    {
+        BLE_AT_RESP_SEND_ERR();
+        return;
+    }
+    param = end + 1;
+    tee.src = strtoul(param, &end, 10);
+    if (end == param || *end != ',')
+    {
+        BLE_AT_RESP_SEND_ERR();
+        return;
+    }
+    param = end + 1;
+    tee.rate = strtoul(param, &end, 10);
+    if (end == param || !gps_tee_params_valid(tee.mask, tee.src))
+    {
+        BLE_AT_RESP_SEND_ERR();
+        return;
+    }
+
+    flash_params_set_gps_tee(&tee);
+    BLE_AT_RESP_SEND_OK();
+}
+
+// 설정 (mask,src,rate) 과 누적 통계 (frames,bytes,limited,dropped)
+static void rt_handler(void *ctx, const char *param, size_t param_len)
+{
+    const gps_tee_params_t *tee = &flash_params_get_current()->gps_tee;
+    gps_tee_stats_t st;
+    char buf[96];
+
+    gps_tee_get_stats(&st);
+    sprintf(buf, "RT 0x%lX,%lu,%lu,%lu,%lu,%lu,%lu\n\r",
+            tee->mask, tee->src, tee->rate,
+            st.frames, st.bytes, st.limited, st.dropped);
+    BLE_AT_RESP_SEND(buf);
+}
+
+// RTCM 부하 생성 (rtcm_loadgen.h): RG+<period_ms>,<type>:<min>[-<max>],... , RG+0 이면 끔
+static void rg_set_handler(void *ctx, const char *param, size_t param_len)
+{
+    rtcm_loadgen_cfg_t cfg = {0};
+    char *end;
+
+    cfg.period_ms = strtoul(param, &end, 10);
+    if (end == param)
+    {
+        BLE_AT_RESP_SEND_ERR();
+        return;
+    }
+    param = end;
+    while (*param == ',' && cfg.cnt < RTCM_LOADGEN_TYPES_MAX)
+    {
+        rtcm_loadgen_type_t *t = &cfg.type[cfg.cnt++];
+
+        t->msg_type = (uint16_t)strtoul(param + 1, &end, 10);
+        if (*end != ':')
+        {
+            BLE_AT_RESP_SEND_ERR();
+            return;
+        }
+        param = end + 1;
+        t->len_min = (uint16_t)strtoul(param, &end, 10);
+        t->len_max = t->len_min;
+        if (end != param && *end == '-')
+        {
+            param = end + 1;
+            t->len_max = (uint16_t)strtoul(param, &end, 10);
+        }
+        if (end == param)
+        {
+            BLE_AT_RESP_SEND_ERR();
+            return;
+        }
+        param = end;
+    }
+
+    if ((*param != '\0' && *param != '\r' && *param != '\n') || !rtcm_loadgen_set(&cfg))
+    {
+        BLE_AT_RESP_SEND_ERR();
+        return;
+    }
+    BLE_AT_RESP_SEND_OK();
+}
+
+// 설정 (period,types) 과 누적 통계 (epochs,frames,bytes,deferred,skipped)
+static void rg_handler(void *ctx, const char *param, size_t param_len)
+{
+    rtcm_loadgen_cfg_t cfg;
+    rtcm_loadgen_stats_t st;
+    char buf[96];
+
+    rtcm_loadgen_get(&cfg, &st);
+    sprintf(buf, "RG %lu,%d,%lu,%lu,%lu,%lu,%lu\n\r",
+            cfg.period_ms, cfg.cnt,
+            st.epochs, st.frames, st.bytes, st.deferred, st.skipped);
+    BLE_AT_RESP_SEND(buf);
+}
+
+// 부팅 타임라인: BT (이번 부팅, 초기화 단계별 시간 포함), BTP (리셋 전 부팅)
+static void bt_handler(void *ctx, const char *param, size_t param_len)
+{
+    static char buf[512];
+    bool prev = param[0] == 'P';
+    size_t len = boot_timeline_format(buf, sizeof(buf), prev);
+
+    if (len == 0)
+    {
+        BLE_AT_RESP_SEND_ERR();
+        return;
+    }
+    if (!prev)
+    {
+        len += boot_stage_format(&buf[len], sizeof(buf) - len);
+    }
+
+    ble_send(buf, len, false);
+}
+
+// 사후 분석 이벤트 링: PT (이번 부팅), PTP (리셋 전 부팅), 버퍼 하나씩 나눠 보냄
+static void pt_handler(void *ctx, const char *param, size_t param_len)
+{
+    static char buf[512];
+    bool prev = param[0] == 'P';
+    uint16_t first = 0;
+    uint16_t next;
+    size_t len;
+
+    while ((len = pm_trace_format(buf, sizeof(buf), prev, first, &next)) > 0)
+    {
+        ble_send(buf, len, false);
+        first = next;
+    }
+
+    if (first == 0)
+    {
+        BLE_AT_RESP_SEND_ERR();
+    }
+}
+
+// heap 태그별 사용량: HP, HPR 은 peak/fail 을 지금 값으로 되돌린 뒤 출력
+static void hp_handler(void *ctx, const char *param, size_t param_len)
+{
+    static char buf[512];
+    size_t len;
+
+    if (param[0] == 'R')
+    {
+        heap_track_reset_peak();
+    }
+
+    len = heap_track_format(buf, sizeof(buf));
+    if (len == 0)
+    {
+        BLE_AT_RESP_SEND_ERR();
+        return;
+    }
+
+    ble_send(buf, len, false);
+}
+
+// UART IDLE -> 담당 태스크 처리 시작 지연 (us, USE_IRQ_LATENCY), ILR 은 출력 후 초기화
+static void il_handler(void *ctx, const char *param, size_t param_len)
+{
+    static char buf[384];
+    size_t len = irq_lat_format(buf, sizeof(buf));
+
+    if (len == 0)
+    {
+        BLE_AT_RESP_SEND_ERR();
+        return;
+    }
+
+    ble_send(buf, len, false);
+
+    if (param[0] == 'R')
+    {
+        irq_lat_reset();
+    }
+}
+
+// 항법 해 epoch -> 출력 소비자 완료 지연 (us) 과 마감 초과, EDR 은 출력 후 초기화
+static void ed_handler(void *ctx, const char *param, size_t param_len)
+{
+    static char buf[896];
+    size_t len = epoch_dl_format(buf, sizeof(buf));
+
+    if (len == 0)
+    {
+        BLE_AT_RESP_SEND_ERR();
+        return;
+    }
+
+    ble_send(buf, len, false);
+
+    if (param[0] == 'R')
+    {
+        epoch_dl_reset();
+    }
+}
+
+// 링/큐/풀 최대 사용량: WM, WMR 은 출력 후 링/큐 peak 를 0 으로
+static void wm_handler(void *ctx, const char *param, size_t param_len)
+{
+    // 버퍼 7개 + 큐 14개 + 풀 4줄이면 900 바이트 가까이
+    static char buf[1024];
+    size_t len = mem_wm_format(buf, sizeof(buf));
+
+    if (len == 0)
+    {
+        BLE_AT_RESP_SEND_ERR();
+        return;
+    }
+
+    ble_send(buf, len, false);
+
+    if (param[0] == 'R')
+    {
+        mem_wm_reset_peak();
+    }
+}
+
+// 수신기마다 위성계별 추적/사용 위성 수와 평균 C/N0
+static void sv_handler(void *ctx, const char *param, size_t param_len)
+{
+    char buf[GPS_ID_MAX * 128];
+    gps_sat_summary_t sum;
+    size_t pos = 0;
+
+    for (int id = 0; id < GPS_ID_MAX; id++)
+    {
+        gps_t *gps = gps_get_instance_handle((gps_id_t)id);
+        size_t len;
+
+        if (!gps)
+        {
+            continue;
+        }
+        gps_sat_summary(gps, &sum);
+        len = gps_sat_format((uint8_t)id, &sum, &buf[pos], sizeof(buf) - pos);
+        if (len == 0)
+        {
+            break;
+        }
+        pos += len;
+    }
+
+    if (pos == 0)
+    {
+        BLE_AT_RESP_SEND_ERR();
+        return;
+    }
+
+    ble_send(buf, pos, false);
+}
+
+// 진단 묶음 (diag_bundle.h) 을 새로 만들고 길이/CRC 를 알림, 내용은 DG+<off> 로 조각씩
+static void dg_handler(void *ctx, const char *param, size_t param_len)
+{
+    char buf[48];
+    uint16_t crc;
+    size_t len = diag_bundle_build(&crc);
+
+    if (len == 0)
+    {
+        BLE_AT_RESP_SEND_ERR();
+        return;
+    }
+
+    sprintf(buf, "+DG,len=%u,crc=%04X\n\r", (unsigned)len, crc);
+    BLE_AT_RESP_SEND(buf);
+}
+
+// DG+<off>: 묶음 조각 (+DG=<off>,<n> 줄 다음 n byte 그대로), DG+L: LTE telemetry 로 보냄
+static void dg_set_handler(void *ctx, const char *param, size_t param_len)
+{
+    static char buf[24 + BLE_DIAG_CHUNK];
+    uint8_t data[BLE_DIAG_CHUNK];
+    char *end;
+    unsigned long off;
+    size_t hdr, n;
+
+    if (param[0] == 'L')
+    {
+        if (telemetry_send_diag())
+        {
+            BLE_AT_RESP_SEND_OK();
+        }
+        else
+        {
+            BLE_AT_RESP_SEND_ERR();
+        }
+        return;
+    }
+
+    off = strtoul(param, &end, 10);
+    n = end == param ? 0 : diag_bundle_read(off, data, sizeof(data));
+    if (n == 0)
+    {
+        BLE_AT_RESP_SEND_ERR();
+        return;
+    }
+
+    hdr = (size_t)sprintf(buf, "+DG=%lu,%u\n\r", off, (unsigned)n);
+    memcpy(&buf[hdr], data, n);
+    ble_send(buf, hdr + n, false);
+}
@@ -1,11 +1,19 @@
+#ifndef BLE_CMD_H
+#define BLE_CMD_H
+
 #include "ble_app.h"
+#include "at_cmd.h"
+
+// 커맨드 테이블 정렬 확인 (초기화 때 한 번)
+void ble_cmd_init(void);
+
+// 모듈 응답 (+OK, +CONNECTED 등) 처리, len 은 parser.data 길이
+void ble_at_cmd_handler(ble_instance_t *inst, size_t len);
 
-typedef void (*ble_at_cmd_handler_t)(ble_instance_t *inst, const char *param);
+// 앱 커맨드 (SD+, GN 등) 처리
+void ble_app_cmd_handler(ble_instance_t *inst, size_t len);
 
-typedef struct
-{
-    const char* name;
-    ble_at_cmd_handler_t handler;
-}ble_at_cmd_entry_t;
+// parser 밖의 앱 커맨드 줄 처리 (ble_run_line), 없는 커맨드면 false
+bool ble_app_cmd_run(const char *line, size_t len);
 
-void ble_at_cmd_handler(ble_instance_t *inst);
\ No newline at end of file
+#endif
@@ -10,6 +10,9 @@
 #include "stm32f4xx_ll_usart.h"
 #include "FreeRTOS.h"
 #include "queue.h"
+#include "uart_tx.h"
+#include "irq_latency.h"
+#include "dma_ring.h"
 #include <string.h>
 #include "flash_params.h"
 
@@ -19,18 +22,23 @@
 
 #include "log.h"
 
-static int ble_uart5_change_baudrate(uint32_t baudrate);
-static int ble_send_at_command_sync(const char *at_cmd, const char *expected_response, uint32_t timeout_ms);
 int ble_uart5_recv_line_poll(char *buf, size_t buf_size, uint32_t timeout_ms);
-static int ble_send_uart_change_command(uint32_t baudrate, uint32_t timeout_ms);
-static int ble_configure_module(void);
 
 #define BLE_PORT_UART UART5
 #define BLE_PORT_UART_DMA DMA1
 #define BLE_PORT_UART_DMA_STREAM LL_DMA_STREAM_0
 
-static char ble_recv_buf[1][1024];
+static char ble_recv_buf[1][BLE_RX_RING_SIZE];
 static QueueHandle_t ble_queues[1] = {NULL};
+static uart_tx_t ble_uart5_tx;
+static volatile uint32_t ble_rx_laps; // RX DMA TC 횟수 (ble_port_get_rx_count)
+static uint32_t ble_uart5_baud = 9600; // MCU 쪽 UART5 속도
+#if USE_BLE
+/* GNSS raw tee 송신 링 (DMA 가 직접 읽으므로 SRAM) */
+static uint8_t ble_tee_buf[GPS_TEE_TX_RING_SIZE];
+static uart_tx_stream_t ble_tee;
+static bool ble_tee_ready;
+#endif
 
 int ble_set_at_cmd_mode(void);
 int ble_set_bypass_mode(void);
@@ -41,7 +49,7 @@ static void ble_uart5_dma_init(void)
   LL_AHB1_GRP1_EnableClock(LL_AHB1_GRP1_PERIPH_DMA1);
 
   /* DMA interrupt init - 우선순위만 설정, IRQ는 나중에 활성화 */
-  NVIC_SetPriority(DMA1_Stream0_IRQn, NVIC_EncodePriority(NVIC_GetPriorityGrouping(), 5, 0));
+  NVIC_SetPriority(DMA1_Stream0_IRQn, UART_NVIC_PRIO(UART5_RX_IRQ_PRIO));
   /* NVIC_EnableIRQ는 comm_start에서 호출 */
 }
 
@@ -86,7 +94,7 @@ static void ble_uart5_init(void)
   /* DMA 설정 (스트림은 아직 활성화하지 않음) */
   LL_DMA_SetChannelSelection(DMA1, LL_DMA_STREAM_0, LL_DMA_CHANNEL_4);
   LL_DMA_SetDataTransferDirection(DMA1, LL_DMA_STREAM_0, LL_DMA_DIRECTION_PERIPH_TO_MEMORY);
-  LL_DMA_SetStreamPriorityLevel(DMA1, LL_DMA_STREAM_0, LL_DMA_PRIORITY_LOW);
+  LL_DMA_SetStreamPriorityLevel(DMA1, LL_DMA_STREAM_0, UART_DMA_PRIO(UART5_RX_DMA_PRIO));
   LL_DMA_SetMode(DMA1, LL_DMA_STREAM_0, LL_DMA_MODE_CIRCULAR);
   LL_DMA_SetPeriphIncMode(DMA1, LL_DMA_STREAM_0, LL_DMA_PERIPH_NOINCREMENT);
   LL_DMA_SetMemoryIncMode(DMA1, LL_DMA_STREAM_0, LL_DMA_MEMORY_INCREMENT);
@@ -95,7 +103,7 @@ static void ble_uart5_init(void)
   LL_DMA_DisableFifoMode(DMA1, LL_DMA_STREAM_0);
 
   /* ★★★ 중요: UART 인터럽트 NVIC는 여기서 설정만 하고, 활성화는 comm_start에서 ★★★ */
-  NVIC_SetPriority(UART5_IRQn, NVIC_EncodePriority(NVIC_GetPriorityGrouping(), 5, 0));
+  NVIC_SetPriority(UART5_IRQn, UART_NVIC_PRIO(UART5_RX_IRQ_PRIO));
   /* NVIC_EnableIRQ(UART5_IRQn); ← 이것을 comm_start로 이동! */
 
   /* USART 설정 */
@@ -111,17 +119,25 @@ static void ble_uart5_init(void)
 }
 
 int ble_uart5_comm_start(void) {
-  /* ★★★ 태스크 컨텍스트에서 호출됨 - vTaskDelay 사용 가능 ★★★ */
-  
-  /* 1. BLE 모듈 설정 (baudrate 변경, advertising 시작 등) */
-  ble_configure_module();
-  
+  const user_params_t *params = flash_params_snapshot(NULL);
+
+  /* 1. 마지막으로 확인한 모듈 속도로 시작 (모르면 모듈 기본 9600)
+   *    모듈 설정은 RX/TX 태스크가 뜬 뒤 ble_app 이 비동기 AT 로 한다 */
+  if (params->ble_module.baud == 9600 || params->ble_module.baud == 115200) {
+    ble_uart5_baud = params->ble_module.baud;
+  }
+  LL_USART_SetBaudRate(UART5, HAL_RCC_GetPCLK1Freq(), LL_USART_OVERSAMPLING_16,
+                       ble_uart5_baud);
+
   /* 2. DMA 설정 */
   LL_DMA_SetPeriphAddress(DMA1, LL_DMA_STREAM_0, (uint32_t)&UART5->DR);
   LL_DMA_SetMemoryAddress(DMA1, LL_DMA_STREAM_0, (uint32_t)&ble_recv_buf[0]);
   LL_DMA_SetDataLength(DMA1, LL_DMA_STREAM_0, sizeof(ble_recv_buf[0]));
   
-  /* DMA 에러 인터럽트 활성화 */
+  /* DMA 완료 (링 한 바퀴) / 에러 인터럽트 활성화 */
+  ble_rx_laps = 0;
+  LL_DMA_ClearFlag_TC0(DMA1);
+  LL_DMA_EnableIT_TC(DMA1, LL_DMA_STREAM_0);
   LL_DMA_EnableIT_TE(DMA1, LL_DMA_STREAM_0);
   LL_DMA_EnableIT_FE(DMA1, LL_DMA_STREAM_0);
   LL_DMA_EnableIT_DME(DMA1, LL_DMA_STREAM_0);
@@ -155,6 +171,12 @@ int ble_uart5_hw_init(void) {
 
   // 2. UART 초기화 (NVIC 설정만, 활성화는 comm_start에서)
   ble_uart5_init();
+  uart_tx_init(&ble_uart5_tx, UART5, DMA1, LL_DMA_STREAM_7, LL_DMA_CHANNEL_4,
+               DMA1_Stream7_IRQn, UART5_TX_DMA_PRIO, UART5_TX_IRQ_PRIO);
+#if USE_BLE
+  ble_tee_ready = uart_tx_stream_init(&ble_tee, &ble_uart5_tx, ble_tee_buf,
+                                      sizeof(ble_tee_buf));
+#endif
   
   // 3. GPIO 초기 상태 설정 (Bypass 모드)
   ble_set_bypass_mode();
@@ -162,141 +184,13 @@ int ble_uart5_hw_init(void) {
   LOG_INFO("BLE hardware initialized (UART5 @ 9600 bps default)");
   
   // ★★★ 중요: 여기서는 폴링/딜레이 사용하지 않음! ★★★
-  // BLE 모듈 설정은 comm_start()에서 수행 (태스크 컨텍스트)
+  // BLE 모듈 설정은 태스크가 뜬 뒤 ble_app 에서 비동기로 수행
   
   return 0;
 }
 
-/*
- * 모듈 설정 (태스크 컨텍스트에서만 호출!)
- * - baudrate 변경, AT+ADVON 등
- */
-static int ble_configure_module(void) {
-  int ret;
-  uint32_t current_baudrate = 9600;
-
-  LOG_INFO("BLE module configuration started (task context)");
-
-  // 1. UART 활성화 (폴링 모드로 사용)
-  LL_USART_Enable(UART5);
-
-  // 2. AT 커맨드 모드로 전환
-  ble_set_bypass_mode();
-  vTaskDelay(pdMS_TO_TICKS(100));  // 이제 안전하게 사용 가능
-  ble_set_at_cmd_mode();
-  vTaskDelay(pdMS_TO_TICKS(300));
-
-  // 3. 부팅 메시지 버퍼 클리어
-  while (LL_USART_IsActiveFlag_RXNE(UART5)) {
-    (void)LL_USART_ReceiveData8(UART5);
-  }
-  LOG_INFO("UART RX buffer cleared");
-
-  // 4. 자동 baudrate 감지 및 설정
-  LOG_INFO("Auto-detecting BLE module baudrate...");
-  LOG_INFO("Testing 9600 bps...");
-
-  char buffer[20];
-  int buffer_len = 0;
-  ble_uart5_send("AT\r", strlen("AT\r"));
-  buffer_len = ble_uart5_recv_line_poll(buffer, sizeof(buffer), 20);
-  ble_uart5_send("AT\r", strlen("AT\r"));
-  buffer_len = ble_uart5_recv_line_poll(buffer, sizeof(buffer), 20);
-
-  if(strncmp(buffer, "+OK", 3) == 0)
-  {
-    ret = 0;
-  }
-  else
-  {
-    ret = 1;
-  }
-
-  if (ret == 0) {
-    LOG_INFO("9600 bps communication OK, changing to 115200 bps...");
-    vTaskDelay(pdMS_TO_TICKS(50));
-      ble_uart5_send("AT\r", strlen("AT\r"));
-  buffer_len = ble_uart5_recv_line_poll(buffer, sizeof(buffer), 2000);
-  vTaskDelay(pdMS_TO_TICKS(50));
-    ret = ble_send_uart_change_command(115200, 100);
-
-    if (ret == 0) {
-      LOG_INFO("Baudrate changed to 115200 successfully");
-      current_baudrate = 115200;
-    } else {
-      LOG_ERR("Failed to change BLE module baudrate, staying at 9600");
-      current_baudrate = 9600;
-    }
-  } else {
-    LOG_INFO("9600 bps no response, assuming 115200 bps...");
-    ble_uart5_change_baudrate(115200);
-    current_baudrate = 115200;
-    ble_uart5_send("AT\r", strlen("AT\r"));
-    buffer_len = ble_uart5_recv_line_poll(buffer, sizeof(buffer), 50);
-  }
-
-  LOG_INFO("BLE module configured at %lu bps", current_baudrate);
-
-  LOG_INFO("Reading BLE device name...");
-
-  char device_name[64];
-
-  vTaskDelay(pdMS_TO_TICKS(500));
- ble_uart5_send("AT\r", strlen("AT\r"));
- int name_len = ble_uart5_recv_line_poll(device_name, sizeof(device_name), 200);
-  // char temp_buffer1[20];
-  // ble_uart5_send("AT+DISCONNECT\r", strlen("AT+DISCONNECT\r"));
-  // name_len = ble_uart5_recv_line_poll(temp_buffer1, sizeof(temp_buffer1), 100);
-  vTaskDelay(pdMS_TO_TICKS(300));
-  ble_uart5_send("AT+MANUF?\r", strlen("AT+MANUF?\r"));
-  name_len = ble_uart5_recv_line_poll(device_name, sizeof(device_name), 200);
-
-  if (name_len > 0) {
-    if(strncmp(device_name, "+ERR", 4) == 0)
-    {
-    }
-    else
-    {
-        LOG_INFO("BLE Device Name: %s", device_name);
-        vTaskDelay(pdMS_TO_TICKS(200));
-        user_params_t* params = flash_params_get_current();
-        if(strncmp(params->ble_device_name, device_name, strlen(params->ble_device_name))!=0)
-        {
-          char temp_buf[100];
-          sprintf(temp_buf, "AT+MANUF=%s\r", params->ble_device_name);
-          ble_uart5_send(temp_buf, strlen(temp_buf));
-          name_len = ble_uart5_recv_line_poll(device_name, sizeof(device_name), 200);
-          vTaskDelay(pdMS_TO_TICKS(10));
-        }
-    }
-
-  } else {
-    LOG_WARN("Failed to read BLE device name (timeout)");
-  }
-
-
-  // ble_uart5_send("AT+MANUF=TEST\r", strlen("AT+MANUF=TEST\r"));
-
-  // vTaskDelay(pdMS_TO_TICKS(10));
-
-  // 6. UART 비활성화 (comm_start에서 DMA 모드로 다시 활성화)
-  LL_USART_Disable(UART5);
-  ble_set_bypass_mode();
-
-  return 0;
-}
-
 int ble_uart5_send(const char *data, size_t len) {
-  for (size_t i = 0; i < len; i++) {
-    while (!LL_USART_IsActiveFlag_TXE(UART5))
-      ;
-    LL_USART_TransmitData8(UART5, *(data + i));
-  }
-
-  while (!LL_USART_IsActiveFlag_TC(UART5))
-    ;
-
-  return 0;
+  return uart_tx_send(&ble_uart5_tx, data, len);
 }
 
 static int ble_uart5_recv_poll(uint8_t *byte, uint32_t timeout_ms) {
@@ -346,115 +240,18 @@ int ble_uart5_recv_line_poll(char *buf, size_t buf_size, uint32_t timeout_ms) {
   return pos;
 }
 
-static int ble_uart5_change_baudrate(uint32_t baudrate) {
+int ble_port_set_baudrate(uint32_t baudrate) {
   LL_USART_Disable(UART5);
   LL_USART_SetBaudRate(UART5, HAL_RCC_GetPCLK1Freq(), LL_USART_OVERSAMPLING_16, baudrate);
   LL_USART_Enable(UART5);
+  ble_uart5_baud = baudrate;
 
   LOG_INFO("UART5 baudrate changed to %lu", baudrate);
   return 0;
 }
 
-static int ble_send_at_command_sync(const char *at_cmd, const char *expected_response, uint32_t timeout_ms) {
-  char response[128];
-
-  LOG_INFO("Sending AT command (sync): %s", at_cmd);
-  ble_uart5_send(at_cmd, strlen(at_cmd));
-
-  uint32_t start = HAL_GetTick();
-
-  while ((HAL_GetTick() - start) < timeout_ms) {
-    int len = ble_uart5_recv_line_poll(response, sizeof(response), 100);
-
-    if (len > 0) {
-      LOG_INFO("Received response: %s", response);
-
-      if (strstr(response, expected_response) != NULL) {
-        LOG_INFO("AT command succeeded");
-        return 0;
-      }
-
-      if (strstr(response, "+ERROR") != NULL) {
-        LOG_ERR("AT command failed: %s", response);
-        return -1;
-      }
-    }
-    
-    // 와치도그 방지
-    taskYIELD();
-  }
-
-  LOG_ERR("AT command timeout");
-  return -1;
-}
-
-static int ble_send_uart_change_command(uint32_t baudrate, uint32_t timeout_ms) {
-  char at_cmd[32];
-  char response[128];
-
-  snprintf(at_cmd, sizeof(at_cmd), "AT+UART=%lu\r", baudrate);
-  LOG_INFO("Sending UART change command: %s", at_cmd);
-
-  ble_uart5_send(at_cmd, strlen(at_cmd));
-
-  uint32_t start = HAL_GetTick();
-  bool ok_received = false;
-
-  while ((HAL_GetTick() - start) < timeout_ms) {
-    int len = ble_uart5_recv_line_poll(response, sizeof(response), 100);
-
-    if (len > 0) {
-      LOG_INFO("Received response: %s", response);
-
-      if (strstr(response, "+OK") != NULL) {
-        LOG_INFO("UART change: +OK received");
-        ok_received = true;
-        break;
-      }
-
-      if (strstr(response, "+ERROR") != NULL) {
-        LOG_ERR("UART change failed: %s", response);
-        return -1;
-      }
-    }
-    taskYIELD();
-  }
-
-  if (!ok_received) {
-    LOG_ERR("UART change: +OK timeout");
-    return -1;
-  }
-
-  LOG_INFO("Changing MCU UART to %lu bps...", baudrate);
-  ble_uart5_change_baudrate(baudrate);
-
-  vTaskDelay(pdMS_TO_TICKS(100));
-  while (LL_USART_IsActiveFlag_RXNE(UART5)) {
-    (void)LL_USART_ReceiveData8(UART5);
-  }
-
-  LOG_INFO("Waiting 2 seconds for BLE module reset...");
-  vTaskDelay(pdMS_TO_TICKS(2000));
-
-  LOG_INFO("Waiting for +READY at new baudrate...");
-  start = HAL_GetTick();
-
-  while ((HAL_GetTick() - start) < timeout_ms) {
-    int len = ble_uart5_recv_line_poll(response, sizeof(response), 100);
-
-    if (len > 0) {
-      LOG_INFO("Received response: %s", response);
-
-      if (strstr(response, "+READY") != NULL) {
-        LOG_INFO("UART change: +READY received");
-        return 0;
-      }
-    }
-    taskYIELD();
-  }
-
-  LOG_WARN("UART change: +READY timeout (proceeding anyway)");
-  return 0;
+uint32_t ble_port_get_baudrate(void) {
+  return ble_uart5_baud;
 }
 
 int ble_set_at_cmd_mode(void)
@@ -480,13 +277,14 @@ static const ble_hal_ops_t ble_uart5_ops = {
     .bypass_mode = ble_set_bypass_mode,
 };
 
-#if defined(BOARD_TYPE_BASE_UNICORE) || defined(BOARD_TYPE_BASE_UBLOX)
+#if defined(BOARD_TYPE_BASE_UNICORE) || defined(BOARD_TYPE_BASE_UBLOX) || defined(BOARD_TYPE_REPEATER)
 
 void UART5_IRQHandler(void) {
   BaseType_t xHigherPriorityTaskWoken = pdFALSE;
 
   if (LL_USART_IsActiveFlag_IDLE(UART5)) {
     LL_USART_ClearFlag_IDLE(UART5);
+    irq_lat_isr(IRQ_LAT_UART5);
     
     /* ★★★ NULL 체크 추가 ★★★ */
     if (ble_queues[0] != NULL) {
@@ -513,6 +311,18 @@ void UART5_IRQHandler(void) {
 
 void DMA1_Stream0_IRQHandler(void)
 {
+  BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+  /* 링 한 바퀴: IDLE 없는 연속 수신에서도 태스크를 깨운다 */
+  if (LL_DMA_IsActiveFlag_TC0(DMA1)) {
+    LL_DMA_ClearFlag_TC0(DMA1);
+    ble_rx_laps++;
+    if (ble_queues[0] != NULL) {
+      uint8_t dummy = 0;
+      xQueueSendFromISR(ble_queues[0], &dummy, &xHigherPriorityTaskWoken);
+    }
+  }
+
   /* DMA 에러 처리 */
   if (LL_DMA_IsActiveFlag_TE0(DMA1)) {
     LL_DMA_ClearFlag_TE0(DMA1);
@@ -524,6 +334,13 @@ void DMA1_Stream0_IRQHandler(void)
   if (LL_DMA_IsActiveFlag_DME0(DMA1)) {
     LL_DMA_ClearFlag_DME0(DMA1);
   }
+
+  portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+void DMA1_Stream7_IRQHandler(void)
+{
+  uart_tx_irq_handler(&ble_uart5_tx);
 }
 
 void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin)
@@ -592,6 +409,20 @@ uint32_t ble_port_get_rx_pos(void) {
   return pos;
 }
 
+uint32_t ble_port_get_rx_count(void) {
+  uint32_t laps;
+  uint32_t pos;
+  bool tc_pending;
+
+  do {
+    laps = ble_rx_laps;
+    pos = ble_port_get_rx_pos();
+    tc_pending = LL_DMA_IsActiveFlag_TC0(BLE_PORT_UART_DMA);
+  } while (laps != ble_rx_laps);
+
+  return dma_ring_count(laps, pos, tc_pending, sizeof(ble_recv_buf[0]));
+}
+
 char *ble_port_get_recv_buf(void) {
   return ble_recv_buf[0];
 }
@@ -599,3 +430,33 @@ char *ble_port_get_recv_buf(void) {
 void ble_port_set_queue(QueueHandle_t queue) {
   ble_queues[0] = queue;
 }
+
+/**
+ * @brief GNSS raw tee 스트림 송신 (블로킹 없음, 쓰는 태스크는 하나)
+ *
+ * 연결된 동안만 보낸다. 연결 전에는 모듈이 AT 명령으로 받아들이기 때문.
+ *
+ * @return size_t 링에 들어간 바이트 수 (나머지는 버려짐)
+ */
+size_t ble_port_stream_write(const void *data, size_t len) {
+#if USE_BLE
+  if (!ble_tee_ready || ble_get_connection_state() != BLE_CONN_CONNECTED) {
+    return 0;
+  }
+
+  return uart_tx_stream_write(&ble_tee, data, len);
+#else
+  return 0;
+#endif
+}
+
+/**
+ * @brief 링이 가득 차서 버린 tee 누적 바이트
+ */
+uint32_t ble_port_stream_dropped(void) {
+#if USE_BLE
+  return ble_tee.dropped;
+#else
+  return 0;
+#endif
+}
@@ -12,8 +12,20 @@ void ble_port_start(ble_t *ble_handle);
 void ble_port_stop(ble_t *ble_handle);
 
 uint32_t ble_port_get_rx_pos(void);
+/**
+ * @brief RX DMA 가 지금까지 쓴 누적 byte 수 (dma_ring 용)
+ */
+uint32_t ble_port_get_rx_count(void);
 char *ble_port_get_recv_buf(void);
 
+/**
+ * @brief MCU 쪽 UART5 속도 변경 (모듈 AT+UART 응답 뒤, DMA 는 계속 돎)
+ */
+int ble_port_set_baudrate(uint32_t baudrate);
+uint32_t ble_port_get_baudrate(void);
+
 void ble_port_set_queue(QueueHandle_t queue);
+size_t ble_port_stream_write(const void *data, size_t len);
+uint32_t ble_port_stream_dropped(void);
 int ble_uart5_recv_line_poll(char *buf, size_t buf_size, uint32_t timeout_ms);
 #endif
@@ -0,0 +1,201 @@
+#include "can_app.h"
+#include "gps_app.h"
+#include "pos_out.h"
+#include "rtcm_router.h"
+#include "work_queue.h"
+#include <math.h>
+#include <string.h>
+
+#if USE_CAN
+
+#ifndef TAG
+#define TAG "CAN_APP"
+#endif
+
+#include "log.h"
+
+#define CAN_OUT_FRAMES 4
+
+static volatile uint8_t can_decim = 1;
+static uint8_t can_seq;
+
+static void can_work_fn(work_t *work);
+static work_t can_rx_work = WORK_INIT(can_work_fn, NULL, WORK_PRIO_HIGH);
+
+static inline void can_put16(uint8_t *p, uint16_t v) {
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)(v >> 8);
+}
+
+static inline void can_put32(uint8_t *p, uint32_t v) {
+  can_put16(p, (uint16_t)v);
+  can_put16(&p[2], (uint16_t)(v >> 16));
+}
+
+static uint16_t can_clip16(double v) {
+  if (!(v > 0)) {
+    return 0;
+  }
+  if (v >= 65535.0) {
+    return 65535;
+  }
+  return (uint16_t)lround(v);
+}
+
+static void can_frame_init(can_frame_t *f, uint16_t id) {
+  memset(f, 0, sizeof(*f));
+  f->id = id;
+  f->dlc = 8;
+}
+
+/**
+ * @brief 위치 하나를 프레임들로 (pos_out 이 항법 해마다 한 번)
+ */
+static size_t can_render(const gps_position_t *pos, uint8_t *buf, size_t size) {
+  can_frame_t fr[CAN_OUT_FRAMES];
+  can_frame_t *st;
+  rtcm_router_stats_t rs;
+  rtcm_src_t src = rtcm_router_get_active();
+  uint16_t corr_age = 0xFFFF;
+  uint8_t flags = 0;
+  size_t n = 0;
+
+  if (size < sizeof(fr)) {
+    return 0;
+  }
+
+  if (pos->tick != 0 && pos->fix > 0) {
+    double speed = sqrt((double)pos->vel_n * pos->vel_n + (double)pos->vel_e * pos->vel_e);
+
+    flags |= CAN_OUT_ST_POS_VALID;
+
+    can_frame_init(&fr[n], CAN_OUT_ID_POS);
+    can_put32(&fr[n].data[0], (uint32_t)(int32_t)(pos->llh.lat / 100));
+    can_put32(&fr[n].data[4], (uint32_t)(int32_t)(pos->llh.lon / 100));
+    n++;
+
+    can_frame_init(&fr[n], CAN_OUT_ID_ALT);
+    can_put32(&fr[n].data[0], (uint32_t)gps_llh_alt_to_mm(pos->llh.ellipsoid_alt));
+    can_put16(&fr[n].data[4], can_clip16(pos->h_acc * 1000.0));
+    can_put16(&fr[n].data[6], can_clip16(pos->v_acc * 1000.0));
+    n++;
+
+    can_frame_init(&fr[n], CAN_OUT_ID_NAV);
+    can_put32(&fr[n].data[0], pos->itow);
+    can_put16(&fr[n].data[4], (uint16_t)(lround(pos->heading * 100.0) % 36000));
+    can_put16(&fr[n].data[6], can_clip16(speed / 10.0));
+    n++;
+  }
+
+  if (src != RTCM_SRC_NONE && rtcm_router_get_stats(src, &rs)) {
+    corr_age = can_clip16(rs.age_ms / 100.0);
+    if (rs.age_ms < RTCM_ROUTER_STALE_MS) {
+      flags |= CAN_OUT_ST_CORR_OK;
+    }
+  }
+
+  st = &fr[n++];
+  can_frame_init(st, CAN_OUT_ID_STATUS);
+  st->data[0] = (uint8_t)pos->fix;
+  st->data[1] = (uint8_t)pos->sat_num;
+  can_put16(&st->data[2], can_clip16(pos->hdop * 100.0));
+  can_put16(&st->data[4], corr_age);
+  st->data[6] = flags;
+  st->data[7] = can_seq++;
+
+  memcpy(buf, fr, n * sizeof(can_frame_t));
+  return n * sizeof(can_frame_t);
+}
+
+/**
+ * @brief mailbox 링에 넣기만 (LOW lane, 블로킹 없음)
+ */
+static bool can_emit(const uint8_t *data, size_t len) {
+  can_frame_t f;
+  bool sent = false;
+
+  for (size_t off = 0; off + sizeof(f) <= len; off += sizeof(f)) {
+    memcpy(&f, &data[off], sizeof(f));
+    sent |= can_port_send(&f);
+  }
+  return sent;
+}
+
+static uint32_t can_get_decim(void) { return can_decim; }
+
+static pos_out_sink_t can_sink =
+    POS_OUT_SINK_INIT("can", POS_OUT_FMT_CAN, can_get_decim, NULL, can_emit, true);
+
+static void can_reply(uint8_t op, const uint8_t *data, uint8_t len) {
+  can_frame_t f = {.id = CAN_OUT_ID_RESP, .dlc = (uint8_t)(1 + len)};
+
+  f.data[0] = op | 0x80;
+  memcpy(&f.data[1], data, len);
+  can_port_send(&f);
+}
+
+static void can_handle_cmd(const can_frame_t *f) {
+  uint8_t op = f->dlc ? f->data[0] : 0;
+  uint8_t res = CAN_OUT_RES_OK;
+
+  switch (op) {
+  case CAN_OUT_OP_ENABLE:
+    if (f->dlc < 2 || f->data[1] > 1) {
+      res = CAN_OUT_RES_BAD_ARG;
+      break;
+    }
+    pos_out_enable(&can_sink, f->data[1] != 0);
+    break;
+  case CAN_OUT_OP_DECIM:
+    if (f->dlc < 2 || f->data[1] == 0 || f->data[1] > CAN_OUT_DECIM_MAX) {
+      res = CAN_OUT_RES_BAD_ARG;
+      break;
+    }
+    can_decim = f->data[1];
+    break;
+  case CAN_OUT_OP_STATUS: {
+    can_port_stats_t st;
+    uint8_t d[7];
+
+    can_port_get_stats(&st);
+    d[0] = can_sink.enabled ? 1 : 0;
+    d[1] = can_decim;
+    d[2] = st.tec;
+    d[3] = st.rec;
+    d[4] = st.err;
+    can_put16(&d[5], st.tx_drop > 0xFFFF ? 0xFFFF : (uint16_t)st.tx_drop);
+    can_reply(op, d, sizeof(d));
+    return;
+  }
+  default:
+    res = CAN_OUT_RES_BAD_OP;
+    break;
+  }
+
+  can_reply(op, &res, 1);
+}
+
+static void can_work_fn(work_t *work) {
+  can_frame_t f;
+
+  (void)work;
+  while (can_port_recv(&f)) {
+    if (f.id == CAN_OUT_ID_CMD) {
+      can_handle_cmd(&f);
+    }
+  }
+}
+
+void can_app_init(void) {
+  static const uint16_t ids[] = {CAN_OUT_ID_CMD};
+
+  if (can_port_init(CAN_BITRATE, ids, sizeof(ids) / sizeof(ids[0]), &can_rx_work) != 0) {
+    LOG_ERR("CAN 초기화 실패, 출력 안 함");
+    return;
+  }
+
+  pos_out_set_render(POS_OUT_FMT_CAN, can_render);
+  pos_out_register(&can_sink);
+}
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef CAN_APP_H
+#define CAN_APP_H
+
+#include "board_config.h"
+#include "can_port.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief CAN 위치 출력 (pos_out sink, USE_CAN 보드만)
+ *
+ * 항법 해마다 pos_out 이 위치 스냅샷에서 바로 프레임 4 개를 만든다 (문자열
+ * 변환 없음). 값은 little-endian, ID 는 CAN_OUT_BASE_ID 기준이다.
+ * 항법 해가 없으면 STATUS 만 나간다.
+ *
+ *  ID     byte
+ *  +0 POS    0 lat int32 [1e-7 deg], 4 lon int32 [1e-7 deg]
+ *  +1 ALT    0 타원체고 int32 [mm], 4 h_acc uint16 [mm], 6 v_acc uint16 [mm]
+ *  +2 NAV    0 iTOW uint32 [ms], 4 heading uint16 [0.01 deg], 6 지면 속도 uint16 [cm/s]
+ *  +3 STATUS 0 fix, 1 위성 수, 2 hdop uint16 [0.01], 4 보정 나이 uint16 [100 ms]
+ *            (0xFFFF 없음), 6 CAN_OUT_ST_* 비트, 7 epoch 순번
+ *
+ * 명령은 CAN_OUT_ID_CMD 하나만 filter 로 받고 (다른 ID 는 하드웨어에서 버림)
+ * data[0] 이 op, 응답은 CAN_OUT_ID_RESP 로 op | 0x80 과 결과를 보낸다.
+ * 바꾼 값은 RAM 에만 둔다 (재부팅하면 켜짐, 매 epoch).
+ */
+#define CAN_OUT_ID_POS (CAN_OUT_BASE_ID + 0)
+#define CAN_OUT_ID_ALT (CAN_OUT_BASE_ID + 1)
+#define CAN_OUT_ID_NAV (CAN_OUT_BASE_ID + 2)
+#define CAN_OUT_ID_STATUS (CAN_OUT_BASE_ID + 3)
+#define CAN_OUT_ID_CMD (CAN_OUT_BASE_ID + 0x10)
+#define CAN_OUT_ID_RESP (CAN_OUT_BASE_ID + 0x11)
+
+#define CAN_OUT_ST_POS_VALID (1U << 0) /**< 항법 해 있음, fix > 0 */
+#define CAN_OUT_ST_CORR_OK (1U << 1)   /**< 보정 데이터 끊기지 않음 */
+
+#define CAN_OUT_DECIM_MAX 20
+
+typedef enum {
+  CAN_OUT_OP_ENABLE = 1, /**< data[1] 0 끔, 1 켬 -> 결과 */
+  CAN_OUT_OP_DECIM = 2,  /**< data[1] 1~CAN_OUT_DECIM_MAX 번째 epoch 마다 -> 결과 */
+  CAN_OUT_OP_STATUS = 3, /**< -> 켬, decim, TEC, REC, ESR 오류 비트, tx_drop uint16 */
+} can_out_op_t;
+
+typedef enum {
+  CAN_OUT_RES_OK = 0,
+  CAN_OUT_RES_BAD_ARG = 1,
+  CAN_OUT_RES_BAD_OP = 2,
+} can_out_res_t;
+
+/**
+ * @brief CAN1 초기화, 포맷 함수와 sink 등록 (pos_out_init 뒤)
+ */
+void can_app_init(void);
+
+#endif
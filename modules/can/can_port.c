@@ -0,0 +1,259 @@
+#include "can_port.h"
+#include "board_config.h"
+#include "stm32f4xx_hal.h"
+#include "stm32f4xx_ll_bus.h"
+#include "stm32f4xx_ll_gpio.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+#if USE_CAN
+
+#ifndef TAG
+#define TAG "CAN_PORT"
+#endif
+
+#include "log.h"
+
+#define CAN_PORT_TQ 14 // 1 + TS1 11 + TS2 2, sample point 86 %
+#define CAN_PORT_TS1 11
+#define CAN_PORT_TS2 2
+#define CAN_PORT_INAK_TMO_MS 10
+
+_Static_assert((CAN_PORT_TX_RING & (CAN_PORT_TX_RING - 1)) == 0, "CAN_PORT_TX_RING 은 2 의 거듭제곱");
+_Static_assert((CAN_PORT_RX_RING & (CAN_PORT_RX_RING - 1)) == 0, "CAN_PORT_RX_RING 은 2 의 거듭제곱");
+
+static can_frame_t tx_ring[CAN_PORT_TX_RING];
+static volatile uint8_t tx_head, tx_tail; // head: 태스크, tail: 태스크 (critical) 와 TX IRQ
+static can_frame_t rx_ring[CAN_PORT_RX_RING];
+static volatile uint8_t rx_head, rx_tail; // head: RX IRQ, tail: 작업
+static work_t *rx_work;
+static can_port_stats_t stats;
+
+/**
+ * @brief 빈 mailbox 에 프레임 넣고 송신 요청 (TSR TME 가 있을 때만)
+ */
+static void can_port_load(const can_frame_t *f) {
+  CAN_TxMailBox_TypeDef *mb = &CAN1->sTxMailBox[(CAN1->TSR & CAN_TSR_CODE) >> CAN_TSR_CODE_Pos];
+  const uint8_t *d = f->data;
+
+  mb->TDTR = f->dlc & 0x0FU;
+  mb->TDLR = (uint32_t)d[0] | (uint32_t)d[1] << 8 | (uint32_t)d[2] << 16 | (uint32_t)d[3] << 24;
+  mb->TDHR = (uint32_t)d[4] | (uint32_t)d[5] << 8 | (uint32_t)d[6] << 16 | (uint32_t)d[7] << 24;
+  mb->TIR = ((uint32_t)f->id << CAN_TI0R_STID_Pos) | CAN_TI0R_TXRQ;
+  stats.tx++;
+}
+
+/**
+ * @brief 링에서 빈 mailbox 수만큼 (IRQ 또는 critical section 안)
+ */
+static void can_port_fill(void) {
+  while ((CAN1->TSR & (CAN_TSR_TME0 | CAN_TSR_TME1 | CAN_TSR_TME2)) && tx_tail != tx_head) {
+    can_port_load(&tx_ring[tx_tail & (CAN_PORT_TX_RING - 1)]);
+    tx_tail++;
+  }
+}
+
+/**
+ * @brief ID list 로 filter bank 0 을 FIFO0 에 (CAN2 가 쓰는 bank 는 건드리지 않음)
+ */
+static void can_port_filter(const uint16_t *ids, uint8_t n) {
+  uint16_t v[CAN_PORT_FILTER_MAX];
+
+  // 16 bit 칸: STID[15:5] RTR[4] IDE[3], 남는 칸은 첫 ID 로 채움
+  for (uint8_t i = 0; i < CAN_PORT_FILTER_MAX; i++) {
+    v[i] = (uint16_t)((ids[i < n ? i : 0] & 0x7FFU) << 5);
+  }
+
+  CAN1->FMR |= CAN_FMR_FINIT;
+  CAN1->FA1R &= ~CAN_FA1R_FACT0;
+  CAN1->FM1R |= CAN_FM1R_FBM0;    // list
+  CAN1->FS1R &= ~CAN_FS1R_FSC0;   // 16 bit x 4
+  CAN1->FFA1R &= ~CAN_FFA1R_FFA0; // FIFO0
+  CAN1->sFilterRegister[0].FR1 = (uint32_t)v[1] << 16 | v[0];
+  CAN1->sFilterRegister[0].FR2 = (uint32_t)v[3] << 16 | v[2];
+  CAN1->FA1R |= CAN_FA1R_FACT0;
+  CAN1->FMR &= ~CAN_FMR_FINIT;
+}
+
+static bool can_port_wait_inak(bool set) {
+  uint32_t start = HAL_GetTick();
+
+  while (((CAN1->MSR & CAN_MSR_INAK) != 0) != set) {
+    if (HAL_GetTick() - start > CAN_PORT_INAK_TMO_MS) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int can_port_init(uint32_t bitrate, const uint16_t *ids, uint8_t n, work_t *work) {
+  LL_GPIO_InitTypeDef gpio = {0};
+  uint32_t pclk = HAL_RCC_GetPCLK1Freq();
+  uint32_t brp;
+
+  if (bitrate == 0 || pclk % (CAN_PORT_TQ * bitrate) != 0) {
+    LOG_ERR("CAN bit rate %lu 불가 (PCLK1 %lu)", (unsigned long)bitrate, (unsigned long)pclk);
+    return -1;
+  }
+  brp = pclk / (CAN_PORT_TQ * bitrate);
+  if (brp == 0 || brp > 1024) {
+    return -1;
+  }
+
+  LL_AHB1_GRP1_EnableClock(CAN_PORT_GPIO_CLK);
+  LL_APB1_GRP1_EnableClock(LL_APB1_GRP1_PERIPH_CAN1);
+
+  gpio.Pin = CAN_PORT_RX_PIN | CAN_PORT_TX_PIN;
+  gpio.Mode = LL_GPIO_MODE_ALTERNATE;
+  gpio.Speed = LL_GPIO_SPEED_FREQ_HIGH;
+  gpio.OutputType = LL_GPIO_OUTPUT_PUSHPULL;
+  gpio.Pull = LL_GPIO_PULL_UP; // 트랜시버가 꺼져 있어도 RX 는 recessive
+  gpio.Alternate = CAN_PORT_AF;
+  LL_GPIO_Init(CAN_PORT_GPIO, &gpio);
+
+  CAN1->MCR = CAN_MCR_INRQ; // sleep 에서 나와 초기화 모드
+  if (!can_port_wait_inak(true)) {
+    LOG_ERR("CAN 초기화 모드 진입 실패");
+    return -1;
+  }
+
+  // bus-off 자동 복구, 송신은 요청 순서, 자동 재전송
+  CAN1->MCR = CAN_MCR_INRQ | CAN_MCR_ABOM | CAN_MCR_TXFP;
+  CAN1->BTR = ((CAN_PORT_TS2 - 1U) << CAN_BTR_TS2_Pos) | ((CAN_PORT_TS1 - 1U) << CAN_BTR_TS1_Pos) |
+              (brp - 1U);
+
+  rx_work = work;
+  can_port_filter(ids, n);
+
+  CAN1->IER = CAN_IER_TMEIE | CAN_IER_BOFIE | CAN_IER_ERRIE |
+              (work ? (CAN_IER_FMPIE0 | CAN_IER_FOVIE0) : 0);
+  NVIC_SetPriority(CAN1_TX_IRQn, NVIC_EncodePriority(NVIC_GetPriorityGrouping(), CAN_TX_IRQ_PRIO, 0));
+  NVIC_SetPriority(CAN1_RX0_IRQn, NVIC_EncodePriority(NVIC_GetPriorityGrouping(), CAN_RX_IRQ_PRIO, 0));
+  NVIC_SetPriority(CAN1_SCE_IRQn, NVIC_EncodePriority(NVIC_GetPriorityGrouping(), CAN_TX_IRQ_PRIO, 0));
+  NVIC_EnableIRQ(CAN1_TX_IRQn);
+  NVIC_EnableIRQ(CAN1_RX0_IRQn);
+  NVIC_EnableIRQ(CAN1_SCE_IRQn);
+
+  // 11 recessive bit 를 보면 bus 에 붙음 (bus 가 없어도 RX pull-up 으로)
+  CAN1->MCR &= ~CAN_MCR_INRQ;
+  if (!can_port_wait_inak(false)) {
+    LOG_ERR("CAN bus 연결 실패");
+    return -1;
+  }
+
+  LOG_INFO("CAN1 %lu bit/s, brp %lu", (unsigned long)bitrate, (unsigned long)brp);
+  return 0;
+}
+
+bool can_port_send(const can_frame_t *frame) {
+  bool ok = true;
+
+  taskENTER_CRITICAL();
+  if (tx_head == tx_tail && (CAN1->TSR & (CAN_TSR_TME0 | CAN_TSR_TME1 | CAN_TSR_TME2))) {
+    can_port_load(frame);
+  } else if ((uint8_t)(tx_head - tx_tail) >= CAN_PORT_TX_RING) {
+    stats.tx_drop++;
+    ok = false;
+  } else {
+    tx_ring[tx_head & (CAN_PORT_TX_RING - 1)] = *frame;
+    tx_head++;
+  }
+  taskEXIT_CRITICAL();
+
+  return ok;
+}
+
+bool can_port_recv(can_frame_t *frame) {
+  if (rx_tail == rx_head) {
+    return false;
+  }
+  *frame = rx_ring[rx_tail & (CAN_PORT_RX_RING - 1)];
+  __DMB();
+  rx_tail++;
+  return true;
+}
+
+void can_port_get_stats(can_port_stats_t *out) {
+  uint32_t esr = CAN1->ESR;
+
+  taskENTER_CRITICAL();
+  *out = stats;
+  taskEXIT_CRITICAL();
+
+  out->tec = (uint8_t)((esr & CAN_ESR_TEC) >> CAN_ESR_TEC_Pos);
+  out->rec = (uint8_t)((esr & CAN_ESR_REC) >> CAN_ESR_REC_Pos);
+  out->err = (uint8_t)(esr & (CAN_ESR_EWGF | CAN_ESR_EPVF | CAN_ESR_BOFF));
+  out->lec = (uint8_t)((esr & CAN_ESR_LEC) >> CAN_ESR_LEC_Pos);
+}
+
+/**
+ * @brief mailbox 송신 끝 (성공, 중재 패배 뒤 재전송 끝, 중단) - 링에서 다시 채움
+ */
+void CAN1_TX_IRQHandler(void) {
+  static const uint32_t rqcp[3] = {CAN_TSR_RQCP0, CAN_TSR_RQCP1, CAN_TSR_RQCP2};
+  static const uint32_t txok[3] = {CAN_TSR_TXOK0, CAN_TSR_TXOK1, CAN_TSR_TXOK2};
+  uint32_t tsr = CAN1->TSR;
+
+  for (int i = 0; i < 3; i++) {
+    if (tsr & rqcp[i]) {
+      if (!(tsr & txok[i])) {
+        stats.tx_abort++;
+      }
+      CAN1->TSR = rqcp[i]; // RQCP, TXOK, ALST, TERR 모두 지움
+    }
+  }
+  can_port_fill();
+}
+
+void CAN1_RX0_IRQHandler(void) {
+  BaseType_t woken = pdFALSE;
+  bool got = false;
+
+  while (CAN1->RF0R & CAN_RF0R_FMP0) {
+    const CAN_FIFOMailBox_TypeDef *mb = &CAN1->sFIFOMailBox[0];
+    uint32_t rir = mb->RIR;
+
+    // filter 가 표준 데이터 프레임만 통과시키지만 한 번 더
+    if (!(rir & (CAN_RI0R_IDE | CAN_RI0R_RTR))) {
+      if ((uint8_t)(rx_head - rx_tail) < CAN_PORT_RX_RING) {
+        can_frame_t *f = &rx_ring[rx_head & (CAN_PORT_RX_RING - 1)];
+        uint32_t lo = mb->RDLR, hi = mb->RDHR;
+
+        f->id = (uint16_t)(rir >> CAN_RI0R_STID_Pos);
+        f->dlc = (uint8_t)(mb->RDTR & CAN_RDT0R_DLC);
+        for (int i = 0; i < 4; i++) {
+          f->data[i] = (uint8_t)(lo >> (8 * i));
+          f->data[4 + i] = (uint8_t)(hi >> (8 * i));
+        }
+        __DMB();
+        rx_head++;
+        stats.rx++;
+        got = true;
+      } else {
+        stats.rx_drop++;
+      }
+    }
+    CAN1->RF0R = CAN_RF0R_RFOM0;
+  }
+  if (CAN1->RF0R & CAN_RF0R_FOVR0) {
+    CAN1->RF0R = CAN_RF0R_FOVR0;
+    stats.rx_ovr++;
+  }
+
+  if (got && rx_work) {
+    work_submit_from_isr(rx_work, &woken);
+  }
+  portYIELD_FROM_ISR(woken);
+}
+
+/**
+ * @brief 오류 상태 변화 - bus-off 만 세고 복구는 하드웨어에
+ */
+void CAN1_SCE_IRQHandler(void) {
+  if (CAN1->ESR & CAN_ESR_BOFF) {
+    stats.bus_off++;
+  }
+  CAN1->MSR = CAN_MSR_ERRI;
+}
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef CAN_PORT_H
+#define CAN_PORT_H
+
+#include "work_queue.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief bxCAN1 (레지스터 직접, HAL CAN 드라이버는 넣지 않음)
+ *
+ * 11 bit 표준 ID 데이터 프레임만. TX 는 mailbox 3 개를 요청 순서대로
+ * (TXFP) 쓰고 비면 TX 완료 IRQ 가 링에서 채운다. RX 는 acceptance filter
+ * (16 bit ID list) 에 넣은 ID 만 FIFO0 으로 받아 링에 두고 작업을 깨운다.
+ * bus-off 는 하드웨어가 스스로 복구 (ABOM).
+ */
+#define CAN_PORT_TX_RING 16 // 2 의 거듭제곱
+#define CAN_PORT_RX_RING 8
+#define CAN_PORT_FILTER_MAX 4 // filter bank 하나
+
+typedef struct {
+  uint16_t id;
+  uint8_t dlc;
+  uint8_t data[8];
+} can_frame_t;
+
+typedef struct {
+  uint32_t tx;       // mailbox 에 넣은 수
+  uint32_t tx_drop;  // 링이 차서 버림
+  uint32_t tx_abort; // 보내지 못한 채 끝난 mailbox
+  uint32_t rx;
+  uint32_t rx_drop;  // 링이 차서 버림
+  uint32_t rx_ovr;   // FIFO0 overrun
+  uint32_t bus_off;
+  uint8_t tec;       // 송신/수신 오류 카운터 (ESR)
+  uint8_t rec;
+  uint8_t err;       // ESR bit 0~2: EWGF EPVF BOFF
+  uint8_t lec;       // 마지막 오류 코드
+} can_port_stats_t;
+
+/**
+ * @brief 클럭, 핀, bit timing, filter, IRQ 설정 후 bus 에 붙음
+ *
+ * @param bitrate [bit/s], PCLK1 / 14 의 약수
+ * @param ids 받을 ID (n 이 CAN_PORT_FILTER_MAX 보다 크면 앞의 것만)
+ * @param rx_work 프레임을 받으면 넣을 작업 (NULL 이면 수신 IRQ 끔)
+ * @return int 0 성공, -1 bit rate 불가 또는 초기화 모드 시간 초과
+ */
+int can_port_init(uint32_t bitrate, const uint16_t *ids, uint8_t n, work_t *rx_work);
+
+/**
+ * @brief 프레임 하나 송신 대기열에 (태스크 컨텍스트, 블로킹 없음)
+ *
+ * @return false 링이 참 (tx_drop)
+ */
+bool can_port_send(const can_frame_t *frame);
+
+/**
+ * @brief 받은 프레임 하나 꺼냄
+ *
+ * @return false 없음
+ */
+bool can_port_recv(can_frame_t *frame);
+
+void can_port_get_stats(can_port_stats_t *out);
+
+#endif
@@ -1,11 +1,13 @@
 #include "base_auto_fix.h"
+#include "app_events.h"
 #include "gps_app.h"
 #include "ntrip_app.h"
+#include "telemetry.h"
+#include "gsm_app.h"
 #include "gsm_port.h"
 #include "ubx_init.h"
 #include "FreeRTOS.h"
 #include "task.h"
-#include "queue.h"
 #include "timers.h"
 #include <math.h>
 #include <string.h>
@@ -13,6 +15,11 @@
 #include "ble_app.h"
 #include "stdbool.h"
 #include "led.h"
+#include "flash_params.h"
+#include "board_config.h"
+#include "crc.h"
+#include "work_queue.h"
+#include <stddef.h>
 
 #ifndef TAG
 #define TAG "BASE_AUTO_FIX"
@@ -21,10 +28,21 @@
 #include "log.h"
 
 // 설정
-#define AVERAGING_DURATION_SEC 50     // 평균 계산 시간 (60초)
-#define MAX_SAMPLES 50               // 최대 샘플 수 (10Hz * 60초)
-#define MIN_SAMPLES 20                // 최소 샘플 수
+#define AVERAGING_DURATION_SEC 180    // 최대 평균 계산 시간 (수렴하면 조기 종료)
+#define MIN_SAMPLES 20                // 최소 샘플 수 (게이트/수렴 판정 시작)
 #define SIGMA_THRESHOLD 3.0           // 이상치 제거 임계값 (3σ)
+#define GATE_MIN_M 0.02               // 이상치 게이트 최소 반경 (m)
+#define MAX_CONSECUTIVE_REJECT 10     // 연속 제거 시 위치 점프로 보고 재시작
+#define MAX_H_ACC_M 0.10f             // 이보다 부정확한 샘플은 버림 (m)
+#define MIN_ACC_M 0.005f              // 가중치 계산용 정확도 하한 (m)
+#define CONVERGE_H_M 0.010            // 수평 신뢰구간 수렴 기준 (m)
+#define CONVERGE_V_M 0.020            // 수직 신뢰구간 수렴 기준 (m)
+#define CONFIDENCE_K 2.0              // 신뢰구간 배수 (약 95%)
+#define METERS_PER_DEG 111320.0       // 위도 1도 거리 (m)
+#define STORED_MAX_CI_H_M 0.05f       // 저장할 측량 결과의 수평 신뢰구간 상한 (m)
+#define STORED_MAX_CI_V_M 0.10f       // 저장할 측량 결과의 수직 신뢰구간 상한 (m)
+#define STORED_MATCH_M 10.0           // 재부팅 후 첫 위치와 저장 위치의 허용 거리 (m)
+#define STORED_MAX_H_ACC_M 5.0f       // 비교에 쓸 첫 위치의 수평 정확도 상한 (m)
 
 // 상태 관리
 static base_auto_fix_state_t state = BASE_AUTO_FIX_DISABLED;
@@ -32,29 +50,69 @@ static uint8_t gps_id = 0;
 static TimerHandle_t averaging_timer = NULL;
 static TimerHandle_t status_timer = NULL;
 
-// 워커 태스크 및 이벤트 큐
-static TaskHandle_t worker_task = NULL;
-static QueueHandle_t event_queue = NULL;
+// 블로킹 작업은 공용 LOW 워커에서 (거의 안 돌아서 전용 태스크를 두지 않음)
+static void base_auto_fix_work(work_t *work);
+static work_t worker_work = WORK_INIT(base_auto_fix_work, NULL, WORK_PRIO_LOW);
+static volatile uint32_t worker_events; // BASE_AUTO_FIX_EVENT_* 비트
 
 typedef enum {
-  BASE_AUTO_FIX_EVENT_AVERAGING_COMPLETE
+  BASE_AUTO_FIX_EVENT_AVERAGING_COMPLETE,
+  BASE_AUTO_FIX_EVENT_USE_STORED, // 저장된 위치가 현재 위치와 맞음
 } base_auto_fix_event_t;
 
-// 좌표 샘플 버퍼
-static coord_sample_t samples[MAX_SAMPLES];
+/**
+ * @brief 가중 Welford 누적기 (한 축)
+ */
+typedef struct {
+  double w_sum;  // 가중치 합
+  double w2_sum; // 가중치 제곱 합 (유효 샘플 수 계산용)
+  double mean;   // 가중 평균
+  double m2;     // 편차 제곱 가중 합
+} welford_t;
+
+/**
+ * @brief 스트리밍 좌표 추정기
+ *
+ * 첫 샘플을 기준점으로 북/동/상 (m) 오프셋을 누적하므로 메모리는 샘플 수와
+ * 무관하다. GPS 태스크가 로컬 복사본을 갱신한 뒤 critical section 안에서
+ * 반영하고, 워커는 같은 방식으로 스냅샷을 뜬다.
+ */
+typedef struct {
+  int64_t ref_lat; // 1e-9 deg
+  int64_t ref_lon; // 1e-9 deg
+  int32_t ref_alt; // 0.1 mm
+  double m_per_deg_lon;
+  welford_t n;
+  welford_t e;
+  welford_t u;
+  uint32_t count;
+  uint32_t rejected;
+  uint32_t consecutive_reject;
+} coord_estimator_t;
+
+static coord_estimator_t estimator;
+static volatile bool averaging_finished = false;
 static uint32_t sample_count = 0;
 
 // 평균 좌표 결과
 static coord_average_t avg_result = {0};
 
 // 내부 함수 선언
-static void averaging_timer_callback(TimerHandle_t xTimer);
+static void averaging_timeout(work_t *work);
 static bool calculate_average_with_outlier_removal(void);
+static void estimator_reset(void);
 static bool switch_to_base_fixed_mode(void);
 static void shutdown_ntrip_and_lte(void);
-static void base_auto_fix_worker_task(void *pvParameter);
+static bool worker_post(base_auto_fix_event_t event);
+
+static void status_report(work_t *work);
 
-static void status_timer_callback(TimerHandle_t xTimer);
+// 타이머는 만료 때 이 작업을 넣기만 함 (work_timer_callback, timer 태스크에서 일하지 않음)
+static work_t averaging_work = WORK_INIT(averaging_timeout, NULL, WORK_PRIO_LOW);
+static work_t status_work = WORK_INIT(status_report, NULL, WORK_PRIO_LOW);
+
+static void base_auto_fix_evt_handler(const event_msg_t *msg);
+static bool stored_survey_valid(const base_survey_t *survey);
 
 /**
 
@@ -73,8 +131,8 @@ bool base_auto_fix_init(uint8_t id) {
     averaging_timer = xTimerCreate("base_avg_timer",
                                     pdMS_TO_TICKS(AVERAGING_DURATION_SEC * 1000),
                                     pdFALSE,  // 원샷
-                                    NULL,
-                                    averaging_timer_callback);
+                                    &averaging_work,
+                                    work_timer_callback);
 
     if (averaging_timer == NULL) {
       LOG_ERR("타이머 생성 실패");
@@ -86,8 +144,8 @@ bool base_auto_fix_init(uint8_t id) {
     status_timer = xTimerCreate("status_timer",
                                     pdMS_TO_TICKS(10 * 1000),
                                     pdTRUE,
-                                    NULL,
-                                    status_timer_callback);
+                                    &status_work,
+                                    work_timer_callback);
 
     if (status_timer == NULL) {
       LOG_ERR("타이머 생성 실패");
@@ -97,27 +155,14 @@ bool base_auto_fix_init(uint8_t id) {
 
   xTimerStart(status_timer, 0);
 
-  // 이벤트 큐 생성
-  if (event_queue == NULL) {
-    event_queue = xQueueCreate(5, sizeof(base_auto_fix_event_t));
-    if (event_queue == NULL) {
-      LOG_ERR("이벤트 큐 생성 실패");
-      return false;
-    }
-  }
-
-  // 워커 태스크 생성
-  if (worker_task == NULL) {
-    BaseType_t ret = xTaskCreate(base_auto_fix_worker_task,
-                                  "base_auto_fix",
-                                  2048,  // 스택 크기 (블로킹 작업 포함)
-                                  NULL,
-                                  tskIDLE_PRIORITY + 2,
-                                  &worker_task);
-    if (ret != pdPASS) {
-      LOG_ERR("워커 태스크 생성 실패");
-      vQueueDelete(event_queue);
-      event_queue = NULL;
+  static bool subscribed = false;
+  if (!subscribed) {
+    subscribed = app_event_subscribe(APP_EVT_BIT(APP_EVT_GPS_FIX_CHANGED) |
+                                         APP_EVT_BIT(APP_EVT_GPS_RTK_SAMPLE) |
+                                         APP_EVT_BIT(APP_EVT_GPS_SOLUTION),
+                                     base_auto_fix_evt_handler, EVENT_BUS_LANE_HIGH);
+    if (!subscribed) {
+      LOG_ERR("이벤트 구독 실패");
       return false;
     }
   }
@@ -139,9 +184,17 @@ bool base_auto_fix_start(void) {
 
   LOG_INFO("Base Auto-Fix 모드 시작");
   state = BASE_AUTO_FIX_INIT;
-  sample_count = 0;
+  estimator_reset();
   memset(&avg_result, 0, sizeof(avg_result));
 
+  // 지난 측량 결과가 있으면 첫 위치로 같은 자리인지 먼저 확인
+  // (NTRIP 은 그동안 계속 연결해서 다르면 바로 측량으로 넘어간다)
+  if (stored_survey_valid(&flash_params_snapshot(NULL)->base_survey)) {
+    state = BASE_AUTO_FIX_VERIFY_STORED;
+    LOG_INFO("저장된 기준국 위치 확인 대기 중...");
+    return true;
+  }
+
   // NTRIP 연결 대기 상태로 전환
   state = BASE_AUTO_FIX_NTRIP_WAIT;
   LOG_INFO("NTRIP 연결 대기 중...");
@@ -160,14 +213,14 @@ void base_auto_fix_stop(void) {
 
   }
 
-  // 이벤트 큐 클리어
-  if (event_queue != NULL) {
-    xQueueReset(event_queue);
-  }
+  // 대기 중인 이벤트 버림
+  work_cancel(&averaging_work);
+  work_cancel(&worker_work);
+  worker_events = 0;
 
   state = BASE_AUTO_FIX_DISABLED;
 
-  sample_count = 0;
+  estimator_reset();
 
   LOG_INFO("Base Auto-Fix 모드 중지");
 
@@ -205,9 +258,9 @@ void base_auto_fix_on_gps_fix_changed(gps_fix_t fix) {
 
     LOG_INFO("RTK Fix 진입! 좌표 평균 계산 시작");
 
-    state = BASE_AUTO_FIX_AVERAGING;
+    estimator_reset();
 
-    sample_count = 0;
+    state = BASE_AUTO_FIX_AVERAGING;
 
 
 
@@ -224,34 +277,304 @@ void base_auto_fix_on_gps_fix_changed(gps_fix_t fix) {
     LOG_WARN("RTK Fix 이탈 (fix=%d), 평균 계산 중단", fix);
 
     xTimerStop(averaging_timer, 0);
+    work_cancel(&averaging_work);
 
     state = BASE_AUTO_FIX_WAIT_RTK_FIX;
 
-    sample_count = 0;
+    estimator_reset();
 
   }
 
 }
 
 
+static void estimator_reset(void) {
+  taskENTER_CRITICAL();
+  memset(&estimator, 0, sizeof(estimator));
+  sample_count = 0;
+  averaging_finished = false;
+  taskEXIT_CRITICAL();
+}
+
 /**
- * @brief GGA 데이터 업데이트
+ * @brief 가중 Welford 갱신 (West 1979)
  */
-void base_auto_fix_on_gga_update(double lat, double lon, double alt) {
+static void welford_add(welford_t *w, double x, double weight) {
+  double delta = x - w->mean;
 
-  if (state != BASE_AUTO_FIX_AVERAGING) {
+  w->w_sum += weight;
+  w->w2_sum += weight * weight;
+  w->mean += (weight / w->w_sum) * delta;
+  w->m2 += weight * delta * (x - w->mean);
+}
+
+/**
+ * @brief 가중 분산 (m^2)
+ */
+static double welford_var(const welford_t *w) {
+  return (w->w_sum > 0) ? w->m2 / w->w_sum : 0.0;
+}
+
+/**
+ * @brief 평균의 신뢰구간 (m)
+ *
+ * 가중치가 고르지 않으면 유효 샘플 수 (W^2 / ΣW^2) 로 나눈다.
+ */
+static double welford_ci(const welford_t *w) {
+  if (w->w2_sum <= 0) {
+    return INFINITY;
+  }
+
+  double n_eff = (w->w_sum * w->w_sum) / w->w2_sum;
+  return CONFIDENCE_K * sqrt(welford_var(w) / n_eff);
+}
+
+static double estimator_ci_h(const coord_estimator_t *est) {
+  double ci_n = welford_ci(&est->n);
+  double ci_e = welford_ci(&est->e);
+  return sqrt(ci_n * ci_n + ci_e * ci_e);
+}
+
+/**
+ * @brief 샘플 하나를 추정기에 반영
+ * @return true 반영됨, false 이상치로 제거됨
+ */
+static bool estimator_add(coord_estimator_t *est, int64_t lat, int64_t lon,
+                          int32_t alt, float h_acc, float v_acc) {
+  if (est->count == 0) {
+    est->ref_lat = lat;
+    est->ref_lon = lon;
+    est->ref_alt = alt;
+    est->m_per_deg_lon =
+        METERS_PER_DEG * cos(gps_llh_deg_to_double(lat) * M_PI / 180.0);
+  }
+
+  // 기준점과의 차이는 정수로 빼서 작은 값만 double 로 (큰 값끼리 빼지 않음)
+  double dn = gps_llh_deg_to_double(lat - est->ref_lat) * METERS_PER_DEG;
+  double de = gps_llh_deg_to_double(lon - est->ref_lon) * est->m_per_deg_lon;
+  double du = gps_llh_alt_to_double(alt - est->ref_alt);
+
+  // 충분히 쌓인 뒤부터 평균에서 3σ (+ 샘플 자체 정확도) 밖이면 제거
+  if (est->count >= MIN_SAMPLES) {
+    double off_n = dn - est->n.mean;
+    double off_e = de - est->e.mean;
+    double off_u = du - est->u.mean;
+    double var_h = welford_var(&est->n) + welford_var(&est->e);
+    double gate_h = SIGMA_THRESHOLD * sqrt(var_h + (double)h_acc * h_acc);
+    double gate_v = SIGMA_THRESHOLD * sqrt(welford_var(&est->u) + (double)v_acc * v_acc);
+
+    if (gate_h < GATE_MIN_M) {
+      gate_h = GATE_MIN_M;
+    }
+    if (gate_v < GATE_MIN_M) {
+      gate_v = GATE_MIN_M;
+    }
+
+    if (off_n * off_n + off_e * off_e > gate_h * gate_h || fabs(off_u) > gate_v) {
+      est->rejected++;
+      est->consecutive_reject++;
+      return false;
+    }
+  }
+
+  est->consecutive_reject = 0;
+
+  float acc_h = (h_acc > MIN_ACC_M) ? h_acc : MIN_ACC_M;
+  float acc_v = (v_acc > MIN_ACC_M) ? v_acc : MIN_ACC_M;
+  double w_h = 1.0 / ((double)acc_h * acc_h);
+  double w_v = 1.0 / ((double)acc_v * acc_v);
+
+  welford_add(&est->n, dn, w_h);
+  welford_add(&est->e, de, w_h);
+  welford_add(&est->u, du, w_v);
+  est->count++;
+
+  return true;
+}
+
+/**
+ * @brief 저장된 측량 결과의 signature (보드 종류 + signature 앞 필드)
+ */
+static uint32_t stored_survey_signature(const base_survey_t *survey) {
+  uint8_t board = (uint8_t)board_get_config()->board;
+  uint32_t crc = crc32_update(0, &board, 1);
+
+  return crc32_update(crc, (const uint8_t *)survey, offsetof(base_survey_t, signature));
+}
+
+static bool stored_survey_valid(const base_survey_t *survey) {
+  return survey->count > 0 && survey->signature == stored_survey_signature(survey);
+}
+
+/**
+ * @brief 측량 결과 저장 (품질이 기준 이상일 때만)
+ */
+static void stored_survey_save(void) {
+  base_survey_t survey;
+
+  if (!(avg_result.ci_h <= STORED_MAX_CI_H_M && avg_result.ci_v <= STORED_MAX_CI_V_M)) {
+    LOG_WARN("신뢰구간이 커서 측량 결과를 저장하지 않음 (h=%.4f v=%.4f m)",
+             avg_result.ci_h, avg_result.ci_v);
     return;
   }
 
-  if (sample_count < MAX_SAMPLES) {
-    samples[sample_count].lat = lat;
-    samples[sample_count].lon = lon;
-    samples[sample_count].alt = alt;
-    sample_count++;
+  memset(&survey, 0, sizeof(survey));
+  survey.lat = avg_result.lat;
+  survey.lon = avg_result.lon;
+  survey.alt = avg_result.alt;
+  survey.ci_h = avg_result.ci_h;
+  survey.ci_v = avg_result.ci_v;
+  survey.count = avg_result.count;
+  survey.signature = stored_survey_signature(&survey);
+
+  flash_params_set_base_survey(&survey);
+  flash_params_save_async();
+  LOG_INFO("측량 결과 저장");
+}
+
+/**
+ * @brief 저장 위치를 못 쓰면 일반 측량으로 (NTRIP 이 이미 붙었으면 RTK Fix 대기)
+ */
+static void stored_survey_fallback(void) {
+  state = ntrip_is_connected() ? BASE_AUTO_FIX_WAIT_RTK_FIX : BASE_AUTO_FIX_NTRIP_WAIT;
+}
+
+/**
+ * @brief 첫 standalone 위치와 저장된 측량 위치 비교
+ *
+ * 허용 거리 안이면 저장 위치로 바로 Fixed 모드 전환을 워커에 맡기고,
+ * 벗어나면 기준국이 옮겨진 것으로 보고 일반 측량을 시작한다.
+ */
+static void stored_survey_check(void) {
+  const base_survey_t *survey = &flash_params_snapshot(NULL)->base_survey;
+  gps_nav_data_t nav = {0};
 
-    char buf[30];
-    sprintf(buf, "Start Averaging %u%%\n\r", sample_count*2);
-    ble_send(buf, strlen(buf) ,false);
+  if (!gps_get_nav((gps_id_t)gps_id, &nav) || nav.fix == GPS_FIX_INVALID ||
+      !(nav.h_acc < STORED_MAX_H_ACC_M)) {
+    return;
+  }
+
+  double dn = (gps_llh_deg_to_double(nav.llh.lat) - survey->lat) * METERS_PER_DEG;
+  double de = (gps_llh_deg_to_double(nav.llh.lon) - survey->lon) * METERS_PER_DEG *
+              cos(survey->lat * M_PI / 180.0);
+  double dist = sqrt(dn * dn + de * de);
+
+  if (dist > STORED_MATCH_M) {
+    LOG_WARN("저장 위치와 %.1f m 떨어짐, 새로 측량", dist);
+    stored_survey_fallback();
+    return;
+  }
+
+  LOG_INFO("저장 위치와 %.1f m, 저장된 측량 결과 사용", dist);
+
+  avg_result.lat = survey->lat;
+  avg_result.lon = survey->lon;
+  avg_result.alt = survey->alt;
+  avg_result.count = survey->count;
+  avg_result.rejected = 0;
+  avg_result.ci_h = survey->ci_h;
+  avg_result.ci_v = survey->ci_v;
+
+  // 다음 해가 들어와도 다시 확인하지 않게 먼저 상태를 바꾼다
+  state = BASE_AUTO_FIX_SWITCHING;
+
+  if (!worker_post(BASE_AUTO_FIX_EVENT_USE_STORED)) {
+    LOG_ERR("워커에 이벤트 전송 실패");
+    stored_survey_fallback();
+  }
+}
+
+/**
+ * @brief 시스템 bus 핸들러 (fix 변화, RTK 위치 샘플)
+ */
+static void base_auto_fix_evt_handler(const event_msg_t *msg) {
+  switch (msg->type) {
+  case APP_EVT_GPS_FIX_CHANGED: {
+    const app_evt_gps_fix_t *evt = (const app_evt_gps_fix_t *)msg->data;
+    if (evt->id == gps_id) {
+      base_auto_fix_on_gps_fix_changed((gps_fix_t)evt->fix);
+    }
+    break;
+  }
+
+  case APP_EVT_GPS_RTK_SAMPLE: {
+    const app_evt_gps_sample_t *evt = (const app_evt_gps_sample_t *)msg->data;
+    base_auto_fix_on_gga_update(evt->lat, evt->lon, evt->alt, evt->h_acc, evt->v_acc);
+    break;
+  }
+
+  case APP_EVT_GPS_SOLUTION: {
+    const app_evt_gps_solution_t *evt = (const app_evt_gps_solution_t *)msg->data;
+    if (evt->id == gps_id && state == BASE_AUTO_FIX_VERIFY_STORED) {
+      stored_survey_check();
+    }
+    break;
+  }
+
+  default:
+    break;
+  }
+}
+
+/**
+ * @brief 위치 샘플 업데이트
+ *
+ * 신뢰구간이 기준 이하로 수렴하면 타이머 만료를 기다리지 않고 워커에
+ * 완료 이벤트를 보낸다.
+ */
+void base_auto_fix_on_gga_update(int64_t lat, int64_t lon, int32_t alt,
+                                 float h_acc, float v_acc) {
+
+  if (state != BASE_AUTO_FIX_AVERAGING || averaging_finished) {
+    return;
+  }
+
+  if (!(h_acc < MAX_H_ACC_M)) {
+    return;
+  }
+
+  coord_estimator_t est = estimator;
+  bool accepted = estimator_add(&est, lat, lon, alt, h_acc, v_acc);
+
+  if (est.consecutive_reject >= MAX_CONSECUTIVE_REJECT) {
+    LOG_WARN("연속 %lu개 이상치, 평균 재시작", est.consecutive_reject);
+    estimator_reset();
+    return;
+  }
+
+  taskENTER_CRITICAL();
+  estimator = est;
+  sample_count = est.count;
+  taskEXIT_CRITICAL();
+
+  if (!accepted) {
+    return;
+  }
+
+  double ci_h = estimator_ci_h(&est);
+  double ci_v = welford_ci(&est.u);
+
+  // 진행률은 수렴 정도 (수평/수직 중 느린 쪽)
+  uint32_t percent = 0;
+  if (est.count >= MIN_SAMPLES) {
+    double ratio = fmin(CONVERGE_H_M / ci_h, CONVERGE_V_M / ci_v);
+    percent = (ratio >= 1.0) ? 100 : (uint32_t)(ratio * 100.0);
+  }
+
+  char buf[30];
+  sprintf(buf, "Start Averaging %lu%%\n\r", percent);
+  ble_send(buf, strlen(buf) ,false);
+
+  if (percent >= 100) {
+    LOG_INFO("평균 수렴 (샘플 %lu, CI h=%.4f v=%.4f m)", est.count, ci_h, ci_v);
+
+    averaging_finished = true;
+    xTimerStop(averaging_timer, 0);
+
+    if (!worker_post(BASE_AUTO_FIX_EVENT_AVERAGING_COMPLETE)) {
+      LOG_ERR("워커에 이벤트 전송 실패");
+      state = BASE_AUTO_FIX_FAILED;
+    }
   }
 }
 
@@ -307,29 +630,37 @@ bool base_auto_fix_get_average_coord(coord_average_t *result) {
 
 /**
 
- * @brief 평균 계산 타이머 콜백 (60초 후 호출)
+ * @brief 평균 계산 타이머 만료 (60초 후, 워커)
  *
- * 타이머 콜백에서는 블로킹 작업을 하지 않고,
- * 워커 태스크에 이벤트만 전달합니다.
+ * 블로킹 작업은 하지 않고 평균 확정 이벤트만 전달합니다.
 
  */
 
-static void averaging_timer_callback(TimerHandle_t xTimer) {
+static void averaging_timeout(work_t *work) {
+  (void)work;
 
   LOG_INFO("평균 계산 타이머 만료 (샘플 수: %lu)", sample_count);
 
-  // 워커 태스크에 이벤트 전송
-  base_auto_fix_event_t event = BASE_AUTO_FIX_EVENT_AVERAGING_COMPLETE;
+  averaging_finished = true;
 
-  if (xQueueSend(event_queue, &event, 0) != pdTRUE) {
-    LOG_ERR("워커 태스크에 이벤트 전송 실패");
+  // 워커에 이벤트 전송
+  if (!worker_post(BASE_AUTO_FIX_EVENT_AVERAGING_COMPLETE)) {
+    LOG_ERR("워커에 이벤트 전송 실패");
     state = BASE_AUTO_FIX_FAILED;
   }
 }
 
-static void status_timer_callback(TimerHandle_t xTimer) {
+/**
+ * @brief NTRIP 접속/fix 상태 BLE 보고 (10초 주기 타이머, 워커)
+ *
+ * ble_send 가 TX 큐에서 기다릴 수 있어 timer 태스크에서 하지 않는다.
+ */
+static void status_report(work_t *work) {
+  (void)work;
 
-  uint8_t fix = gps_get_instance_handle(0)->nmea_data.gga.fix;
+  gps_nav_data_t nav = {0};
+  gps_get_nav(GPS_ID_BASE, &nav);
+  uint8_t fix = nav.fix;
   led_color_t gsm_status = led_get_color(LED_ID_1);
 
   bool ntrip_connected = ntrip_is_connected();
@@ -366,151 +697,37 @@ static void status_timer_callback(TimerHandle_t xTimer) {
 
 
 /**
- * @brief 이상치 제거 후 평균 계산 (3σ 방식)
+ * @brief 누적된 추정기로 평균 좌표 확정
+ *
+ * 이상치는 샘플이 들어올 때 이미 게이트에서 걸러졌으므로 여기서는
+ * 스냅샷을 떠서 기준점 + 평균 오프셋을 위경도로 되돌리기만 한다.
  */
 static bool calculate_average_with_outlier_removal(void) {
-  if (sample_count == 0) {
-    return false;
-  }
-
-  // 1차 평균 계산
-
-  double mean_lat = 0, mean_lon = 0, mean_alt = 0;
-
-  for (uint32_t i = 0; i < sample_count; i++) {
-
-    mean_lat += samples[i].lat;
-
-    mean_lon += samples[i].lon;
-
-    mean_alt += samples[i].alt;
-
-  }
-
-  mean_lat /= sample_count;
-
-  mean_lon /= sample_count;
-
-  mean_alt /= sample_count;
-
-
-
-  // 표준편차 계산
-
-  double var_lat = 0, var_lon = 0, var_alt = 0;
-
-  for (uint32_t i = 0; i < sample_count; i++) {
-
-    double diff_lat = samples[i].lat - mean_lat;
-
-    double diff_lon = samples[i].lon - mean_lon;
-
-    double diff_alt = samples[i].alt - mean_alt;
-
-    var_lat += diff_lat * diff_lat;
-
-    var_lon += diff_lon * diff_lon;
-
-    var_alt += diff_alt * diff_alt;
-
-  }
-
-  double std_lat = sqrt(var_lat / sample_count);
-
-  double std_lon = sqrt(var_lon / sample_count);
-
-  double std_alt = sqrt(var_alt / sample_count);
-
-
-
-  LOG_INFO("1차 평균: lat=%.9f, lon=%.9f, alt=%.3f", mean_lat, mean_lon, mean_alt);
-
-  LOG_INFO("표준편차: lat=%.9f, lon=%.9f, alt=%.3f", std_lat, std_lon, std_alt);
+  coord_estimator_t est;
 
+  taskENTER_CRITICAL();
+  est = estimator;
+  taskEXIT_CRITICAL();
 
-
-  // 3σ 밖의 샘플 제외하고 재계산
-
-  double final_lat = 0, final_lon = 0, final_alt = 0;
-
-  uint32_t valid_count = 0;
-
-  uint32_t rejected_count = 0;
-
-
-
-  for (uint32_t i = 0; i < sample_count; i++) {
-
-    double diff_lat = fabs(samples[i].lat - mean_lat);
-
-    double diff_lon = fabs(samples[i].lon - mean_lon);
-
-    double diff_alt = fabs(samples[i].alt - mean_alt);
-
-
-
-    // 3σ 이내 샘플만 사용
-
-    if (diff_lat < SIGMA_THRESHOLD * std_lat &&
-
-        diff_lon < SIGMA_THRESHOLD * std_lon &&
-
-        diff_alt < SIGMA_THRESHOLD * std_alt) {
-
-      final_lat += samples[i].lat;
-
-      final_lon += samples[i].lon;
-
-      final_alt += samples[i].alt;
-
-      valid_count++;
-
-    } else {
-
-      rejected_count++;
-
-    }
-
-  }
-
-
-
-  if (valid_count < MIN_SAMPLES) {
-
-    LOG_ERR("이상치 제거 후 유효 샘플 수 부족 (%lu < %d)", valid_count, MIN_SAMPLES);
-
+  if (est.count < MIN_SAMPLES) {
+    LOG_ERR("이상치 제거 후 유효 샘플 수 부족 (%lu < %d)", est.count, MIN_SAMPLES);
     return false;
-
   }
 
+  avg_result.lat = gps_llh_deg_to_double(est.ref_lat) + est.n.mean / METERS_PER_DEG;
+  avg_result.lon = gps_llh_deg_to_double(est.ref_lon) + est.e.mean / est.m_per_deg_lon;
+  avg_result.alt = gps_llh_alt_to_double(est.ref_alt) + est.u.mean;
+  avg_result.count = est.count;
+  avg_result.rejected = est.rejected;
+  avg_result.ci_h = (float)estimator_ci_h(&est);
+  avg_result.ci_v = (float)welford_ci(&est.u);
 
-
-  final_lat /= valid_count;
-
-  final_lon /= valid_count;
-
-  final_alt /= valid_count;
-
-
-
-  // 결과 저장
-
-  avg_result.lat = final_lat;
-
-  avg_result.lon = final_lon;
-
-  avg_result.alt = final_alt;
-
-  avg_result.count = valid_count;
-
-  avg_result.rejected = rejected_count;
-
-
-
-  LOG_INFO("이상치 제거: %lu개 제거, %lu개 유효", rejected_count, valid_count);
+  LOG_INFO("표준편차: n=%.4f, e=%.4f, u=%.4f m", sqrt(welford_var(&est.n)),
+           sqrt(welford_var(&est.e)), sqrt(welford_var(&est.u)));
+  LOG_INFO("신뢰구간: h=%.4f, v=%.4f m", avg_result.ci_h, avg_result.ci_v);
+  LOG_INFO("이상치 제거: %lu개 제거, %lu개 유효", est.rejected, est.count);
 
   return true;
-
 }
 
 
@@ -651,8 +868,8 @@ static bool switch_to_base_fixed_mode(void) {
 
 #endif
 
-  // shutdown_ntrip_and_lte()는 워커 태스크에서 처리
-  // state 변경도 워커 태스크에서 처리
+  // shutdown_ntrip_and_lte()는 워커에서 처리
+  // state 변경도 워커에서 처리
 
   return true;
 
@@ -664,6 +881,9 @@ static bool switch_to_base_fixed_mode(void) {
 
  * @brief NTRIP 및 LTE 통신 종료
 
+ * (캐스터 업로드가 설정돼 있으면 NTRIP client 만 끄고 server 로 넘김,
+ * telemetry 가 동작 중이면 LTE 는 켜 둠)
+
  */
 
 static void shutdown_ntrip_and_lte(void) {
@@ -678,6 +898,21 @@ static void shutdown_ntrip_and_lte(void) {
 
   LOG_INFO("NTRIP 종료 완료");
 
+  // 캐스터 업로드가 설정돼 있으면 LTE 를 켜 둔 채 고정 좌표 RTCM 을 올린다
+  if (gsm_start_ntrip_server()) {
+    LOG_INFO("NTRIP server 시작, LTE 유지");
+    return;
+  }
+
+  // 원격 모니터링 중이면 LTE 를 끄지 않는다 (NTRIP client 만 끔)
+  if (telemetry_is_running()) {
+    LOG_INFO("telemetry 동작 중, LTE 유지");
+    return;
+  }
+
+  // 소켓 침묵 감시 타이머도 멈춤 (꺼진 모뎀에 QISTATE 를 보내며 깨우지 않게)
+  gsm_socket_monitor_stop();
+
 
 
   // 2. EC25 Power Off (PWRKEY 핀)
@@ -689,66 +924,105 @@ static void shutdown_ntrip_and_lte(void) {
 }
 
 /**
- * @brief Base Auto-Fix 워커 태스크 (블로킹 작업 처리)
+ * @brief avg_result 로 Fixed 모드 전환 후 NTRIP/LTE 종료 (워커)
  *
- * 타이머 콜백에서 블로킹 작업을 직접 수행하지 않고,
- * 이 워커 태스크가 큐를 통해 이벤트를 받아서 처리합니다.
+ * @return false Fixed 모드 전환 실패 (state 는 호출자가 정함)
  */
-static void base_auto_fix_worker_task(void *pvParameter) {
-  base_auto_fix_event_t event;
-
-  LOG_INFO("Base Auto-Fix 워커 태스크 시작");
-
-  while (1) {
-    // 큐에서 이벤트 대기
-    if (xQueueReceive(event_queue, &event, portMAX_DELAY) == pdTRUE) {
-
-      if (event == BASE_AUTO_FIX_EVENT_AVERAGING_COMPLETE) {
-        LOG_INFO("평균 계산 완료 이벤트 수신");
-
-        // 샘플 수 확인
-        if (sample_count < MIN_SAMPLES) {
-          LOG_ERR("샘플 수 부족 (최소 %d개 필요, 현재 %lu개)", MIN_SAMPLES, sample_count);
-          state = BASE_AUTO_FIX_FAILED;
-          continue;
-        }
-
-        // 평균 계산 (이상치 제거 포함)
-        if (!calculate_average_with_outlier_removal()) {
-          LOG_ERR("평균 계산 실패");
-          state = BASE_AUTO_FIX_FAILED;
-          continue;
-        }
-
-        LOG_INFO("평균 좌표 계산 완료:");
-        LOG_INFO("  Lat: %.9f (유효: %lu, 제거: %lu)",
-                 avg_result.lat, avg_result.count, avg_result.rejected);
-        LOG_INFO("  Lon: %.9f", avg_result.lon);
-        LOG_INFO("  Alt: %.3f", avg_result.alt);
-
-        // Base Fixed 모드로 전환
-        state = BASE_AUTO_FIX_SWITCHING;
-        if (!switch_to_base_fixed_mode()) {
-          LOG_ERR("Base Fixed 모드 전환 실패");
-          state = BASE_AUTO_FIX_FAILED;
-          continue;
-        }
-        else
-        {
-          xTimerStop(status_timer, 0);
-        }
-
-        // NTRIP/LTE 종료 (블로킹 1.7초)
-        shutdown_ntrip_and_lte();
-
-        led_set_color(1, LED_COLOR_NONE);
-        led_set_state(1, false);
-
-        state = BASE_AUTO_FIX_COMPLETED;
-        LOG_INFO("Base Auto-Fix 완료!");
-      }
-    }
+static bool base_auto_fix_complete(void) {
+  if (!switch_to_base_fixed_mode()) {
+    LOG_ERR("Base Fixed 모드 전환 실패");
+    return false;
   }
+  xTimerStop(status_timer, 0);
+  work_cancel(&status_work);
 
-  vTaskDelete(NULL);
+  // NTRIP/LTE 종료 (블로킹 1.7초)
+  shutdown_ntrip_and_lte();
+
+  led_set_color(1, LED_COLOR_NONE);
+  led_set_state(1, false);
+
+  state = BASE_AUTO_FIX_COMPLETED;
+  LOG_INFO("Base Auto-Fix 완료!");
+
+  return true;
+}
+
+/**
+ * @brief 워커에 이벤트 넘기기 (같은 이벤트가 밀려 있으면 한 번만 처리)
+ */
+static bool worker_post(base_auto_fix_event_t event) {
+  taskENTER_CRITICAL();
+  worker_events |= 1UL << event;
+  taskEXIT_CRITICAL();
+
+  return work_submit(&worker_work);
+}
+
+/**
+ * @brief 평균 계산 완료 처리 (워커)
+ */
+static void worker_averaging_complete(void) {
+  LOG_INFO("평균 계산 완료 이벤트 수신");
+
+  // 수렴과 타이머 만료가 겹쳐 두 번 들어온 경우
+  if (state != BASE_AUTO_FIX_AVERAGING) {
+    return;
+  }
+
+  // 샘플 수 확인
+  if (sample_count < MIN_SAMPLES) {
+    LOG_ERR("샘플 수 부족 (최소 %d개 필요, 현재 %lu개)", MIN_SAMPLES, sample_count);
+    state = BASE_AUTO_FIX_FAILED;
+    return;
+  }
+
+  // 평균 계산 (이상치 제거 포함)
+  if (!calculate_average_with_outlier_removal()) {
+    LOG_ERR("평균 계산 실패");
+    state = BASE_AUTO_FIX_FAILED;
+    return;
+  }
+
+  LOG_INFO("평균 좌표 계산 완료:");
+  LOG_INFO("  Lat: %.9f (유효: %lu, 제거: %lu)",
+           avg_result.lat, avg_result.count, avg_result.rejected);
+  LOG_INFO("  Lon: %.9f", avg_result.lon);
+  LOG_INFO("  Alt: %.3f", avg_result.alt);
+
+  // Base Fixed 모드로 전환
+  state = BASE_AUTO_FIX_SWITCHING;
+  if (base_auto_fix_complete()) {
+    stored_survey_save();
+  } else {
+    state = BASE_AUTO_FIX_FAILED;
+  }
+}
+
+/**
+ * @brief Base Auto-Fix 워커 작업 (블로킹 작업 처리)
+ *
+ * 타이머 콜백과 이벤트 핸들러에서 블로킹 작업을 직접 수행하지 않고,
+ * 이벤트 비트만 남기고 공용 LOW 워커에서 이 작업이 처리합니다.
+ */
+static void base_auto_fix_work(work_t *work) {
+  uint32_t events;
+
+  (void)work;
+
+  taskENTER_CRITICAL();
+  events = worker_events;
+  worker_events = 0;
+  taskEXIT_CRITICAL();
+
+  if (events & (1UL << BASE_AUTO_FIX_EVENT_AVERAGING_COMPLETE)) {
+    worker_averaging_complete();
+  }
+
+  if ((events & (1UL << BASE_AUTO_FIX_EVENT_USE_STORED)) &&
+      state == BASE_AUTO_FIX_SWITCHING) {
+    if (!base_auto_fix_complete()) {
+      stored_survey_fallback();
+    }
+  }
 }
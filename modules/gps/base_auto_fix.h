@@ -9,6 +9,7 @@
   {
     BASE_AUTO_FIX_DISABLED,     // 비활성화 (일반 Base 모드)
     BASE_AUTO_FIX_INIT,         // 초기화
+    BASE_AUTO_FIX_VERIFY_STORED, // 저장된 측량 위치와 첫 위치 비교 대기
     BASE_AUTO_FIX_NTRIP_WAIT,   // NTRIP 연결 대기
     BASE_AUTO_FIX_WAIT_RTK_FIX, // RTK Fix 대기
     BASE_AUTO_FIX_AVERAGING,    // RTK Fix 후 1분간 평균 계산
@@ -17,16 +18,6 @@
     BASE_AUTO_FIX_FAILED        // 실패
   } base_auto_fix_state_t;
 
-  /**
-   * @brief 좌표 샘플
-   */
-  typedef struct
-  {
-    double lat; // 위도 (도)
-    double lon; // 경도 (도)
-    double alt; // 고도 (m)
-  } coord_sample_t;
-
   /**
 
    * @brief 평균 좌표 결과
@@ -40,6 +31,8 @@
     double alt; // 평균 고도
     uint32_t count; // 유효 샘플 수
     uint32_t rejected; // 이상치 제거 샘플 수
+    float ci_h; // 수평 평균 오차 신뢰구간 (m, 약 95%)
+    float ci_v; // 수직 평균 오차 신뢰구간 (m, 약 95%)
   } coord_average_t;
 
   /**
@@ -94,13 +87,16 @@
 
   /**
 
-   * @brief GGA 데이터 업데이트 (gps_app.c에서 호출)
-
-   * @param gga GGA 데이터
-
+   * @brief 위치 샘플 업데이트 (APP_EVT_GPS_RTK_SAMPLE 핸들러에서 호출)
+   * @param lat 위도 (1e-9 도)
+   * @param lon 경도 (1e-9 도)
+   * @param alt 고도 (0.1 mm)
+   * @param h_acc 수신기가 보고한 수평 정확도 (m, HPPOSLLH hAcc / BESTNAV dev)
+   * @param v_acc 수신기가 보고한 수직 정확도 (m)
    */
 
-void base_auto_fix_on_gga_update(double lat, double lon, double alt);
+void base_auto_fix_on_gga_update(int64_t lat, int64_t lon, int32_t alt,
+                                 float h_acc, float v_acc);
 
   /**
 
@@ -1,4 +1,7 @@
 #include "f9p_baudrate_config.h"
+#include "gps_config.h"
+#include "flash_params.h"
+#include "gps_rate.h"
 #include "stm32f4xx_ll_usart.h"
 #include "stm32f4xx_ll_bus.h"
 #include "stm32f4xx_hal.h"
@@ -9,6 +12,8 @@
 
 #include "log.h"
 
+#if defined(USE_GPS_UBLOX)
+
 
 #define UBX_SYNC1           0xB5
 #define UBX_SYNC2           0x62
@@ -21,6 +26,10 @@
  
 #define UBX_PORT_UART1      1
 
+#define F9P_DEFAULT_BAUD    38400
+#define F9P_POLL_MS         1000
+#define F9P_QUICK_POLL_MS   100     // 저장된 속도 확인용 (CFG-PRT 응답은 수십 ms)
+
 
 static void ubx_send_ll(USART_TypeDef *USARTx, uint8_t msg_class, uint8_t msg_id,
                         const uint8_t *payload, uint16_t payload_len)
@@ -300,7 +309,7 @@ static bool f9p_set_uart_baudrate(USART_TypeDef *USARTx, uint8_t f9p_port_id,
 
 static bool f9p_poll_uart_config(USART_TypeDef *USARTx, uint8_t f9p_port_id,
 
-                                  uint32_t *baudrate)
+                                  uint32_t *baudrate, uint32_t timeout_ms)
 
 {
 
@@ -328,7 +337,7 @@ static bool f9p_poll_uart_config(USART_TypeDef *USARTx, uint8_t f9p_port_id,
 
  
 
-    while ((HAL_GetTick() - start) < 1000) {
+    while ((HAL_GetTick() - start) < timeout_ms) {
 
         uint32_t byte_start = HAL_GetTick();
 
@@ -460,178 +469,182 @@ static void change_stm32_baudrate_ll(USART_TypeDef *USARTx, uint32_t new_baudrat
 
 /**
 
- * Base F9P UART1 보드레이트 초기화 (DMA 활성화 전)
+ * 마지막으로 확인된 속도로 한 번만 poll (맞으면 probe 생략)
 
- * gps_rtk_uart2_init()에서 호출됨
+ * 응답이 없으면 STM32 UART 를 기본 속도로 되돌리고 false
 
  */
 
-bool f9p_init_uart1_baudrate_115200(void)
+static bool f9p_try_cached_baud(USART_TypeDef *USARTx, gps_id_t id)
 
 {
 
+    uint32_t cached = flash_params_snapshot(NULL)->gps_baud[id];
+
     uint32_t current_baud = 0;
 
- 
 
-    LOG_INFO("=== F9P UART1 Init Baudrate to 115200 ===");
+    if (cached == 0 || cached == 0xFFFFFFFF)
 
- 
+    {
 
-    // Step 1: 현재 설정 확인 (38400)
+        return false;
 
-    LOG_INFO("[1] Current baudrate check...");
+    }
 
-    if (f9p_poll_uart_config(USART2, UBX_PORT_UART1, &current_baud)) {
 
-        LOG_INFO("    Current: %lu bps", current_baud);
+    LOG_INFO("[0] Cached %lu bps check...", cached);
 
-        if (current_baud == 115200) {
+    change_stm32_baudrate_ll(USARTx, cached);
 
-            LOG_INFO("    Already 115200, skipping...");
+    if (f9p_poll_uart_config(USARTx, UBX_PORT_UART1, &current_baud, F9P_QUICK_POLL_MS) &&
 
-            return true;
+        current_baud == cached)
 
-        }
+    {
 
-    } else {
+        LOG_INFO("    Cached baudrate confirmed, skipping probe");
 
-        LOG_WARN("    No response at 38400");
+        return true;
 
     }
 
- 
 
-    // Step 2: F9P UART1을 115200으로 변경 요청
+    LOG_WARN("    No response at cached baudrate, probing");
 
-    LOG_INFO("[2] Setting F9P UART1 to 115200...");
+    change_stm32_baudrate_ll(USARTx, F9P_DEFAULT_BAUD);
 
-    f9p_set_uart_baudrate(USART2, UBX_PORT_UART1, 115200);
+    return false;
 
-    HAL_Delay(100);
+}
 
- 
 
-    // Step 3: STM32 UART2도 115200으로 변경
+/**
 
-    LOG_INFO("[3] Switching STM32 UART2 to 115200...");
+ * 확인된 속도 저장 (바뀐 경우만, writer 태스크가 씀)
 
-    change_stm32_baudrate_ll(USART2, 115200);
+ */
 
-    HAL_Delay(200);
+static void f9p_store_baud(gps_id_t id, uint32_t baud)
 
- 
+{
 
-    // Step 4: 검증
+    if (flash_params_snapshot(NULL)->gps_baud[id] != baud)
 
-    LOG_INFO("[4] Verifying...");
+    {
 
-    if (f9p_poll_uart_config(USART2, UBX_PORT_UART1, &current_baud)) {
+        flash_params_set_gps_baud(id, baud);
 
-        if (current_baud == 115200) {
+        flash_params_save_async();
 
-            LOG_INFO("    SUCCESS! Baudrate: %lu bps", current_baud);
+    }
 
-            return true;
+}
 
-        } else {
 
-            LOG_ERR("    Wrong baudrate: %lu bps", current_baud);
+/**
 
-        }
+ * F9P UART1 을 항법 주기에 맞는 속도로 (DMA 활성화 전, gps_rate_uart_baud)
 
-    } else {
+ * 저장된 속도를 먼저 확인하고, 안 되면 38400 에서 전체 probe
 
-        LOG_ERR("    Verification failed, reverting...");
+ * gps_port 의 포트 초기화에서 포트마다 호출됨
 
-        change_stm32_baudrate_ll(USART2, 38400);
+ */
 
-        HAL_Delay(100);
+bool f9p_init_port_baudrate(USART_TypeDef *USARTx, gps_id_t id, const char *name)
 
-    }
+{
 
- 
+    uint32_t target = gps_rate_uart_baud(id, gps_rate_get_hz());
 
-    return false;
+    uint32_t from_baud = F9P_DEFAULT_BAUD;
 
-}
+    uint32_t current_baud = 0;
 
- 
 
-/**
+    LOG_INFO("=== %s Init Baudrate to %lu ===", name, target);
 
- * Rover F9P UART1 보드레이트 초기화 (DMA 활성화 전)
 
- * gps_rtk_uart4_init()에서 호출됨
+    if (f9p_try_cached_baud(USARTx, id))
 
- */
+    {
 
-bool f9p_init_rover_uart1_baudrate_115200(void)
+        from_baud = flash_params_snapshot(NULL)->gps_baud[id];
 
-{
+        if (from_baud == target)
 
-    uint32_t current_baud = 0;
+        {
 
- 
+            return true;
 
-    LOG_INFO("=== Rover F9P UART1 Init Baudrate to 115200 ===");
+        }
 
- 
+        // 주기를 바꿔 목표 속도가 달라짐: 지금 속도에서 바로 변경
 
-    // Step 1: 현재 설정 확인 (38400)
+        LOG_INFO("    Cached %lu bps, target %lu bps", from_baud, target);
 
-    LOG_INFO("[1] Current baudrate check...");
+    }
 
-    if (f9p_poll_uart_config(UART4, UBX_PORT_UART1, &current_baud)) {
+    else
 
-        LOG_INFO("    Current: %lu bps", current_baud);
+    {
 
-        if (current_baud == 115200) {
+        // Step 1: 현재 설정 확인 (38400)
 
-            LOG_INFO("    Already 115200, skipping...");
+        LOG_INFO("[1] Current baudrate check...");
 
-            return true;
+        if (f9p_poll_uart_config(USARTx, UBX_PORT_UART1, &current_baud, F9P_POLL_MS)) {
 
-        }
+            LOG_INFO("    Current: %lu bps", current_baud);
 
-    } else {
+            if (current_baud == target) {
 
-        LOG_WARN("    No response at 38400");
+                LOG_INFO("    Already %lu, skipping...", target);
+
+                return true;
+
+            }
+
+        } else {
+
+            LOG_WARN("    No response at 38400");
+
+        }
 
     }
 
- 
 
-    // Step 2: Rover F9P UART1을 115200으로 변경 요청
+    // Step 2: F9P UART1 속도 변경 요청
 
-    LOG_INFO("[2] Setting Rover F9P UART1 to 115200...");
+    LOG_INFO("[2] Setting %s UART1 to %lu...", name, target);
 
-    f9p_set_uart_baudrate(UART4, UBX_PORT_UART1, 115200);
+    f9p_set_uart_baudrate(USARTx, UBX_PORT_UART1, target);
 
     HAL_Delay(100);
 
- 
 
-    // Step 3: STM32 UART4도 115200으로 변경
+    // Step 3: STM32 UART도 같은 속도로
 
-    LOG_INFO("[3] Switching STM32 UART4 to 115200...");
+    LOG_INFO("[3] Switching STM32 UART to %lu...", target);
 
-    change_stm32_baudrate_ll(UART4, 115200);
+    change_stm32_baudrate_ll(USARTx, target);
 
     HAL_Delay(200);
 
- 
 
     // Step 4: 검증
 
     LOG_INFO("[4] Verifying...");
 
-    if (f9p_poll_uart_config(UART4, UBX_PORT_UART1, &current_baud)) {
+    if (f9p_poll_uart_config(USARTx, UBX_PORT_UART1, &current_baud, F9P_POLL_MS)) {
 
-        if (current_baud == 115200) {
+        if (current_baud == target) {
 
             LOG_INFO("    SUCCESS! Baudrate: %lu bps", current_baud);
 
+            f9p_store_baud(id, target);
+
             return true;
 
         } else {
@@ -644,14 +657,16 @@ bool f9p_init_rover_uart1_baudrate_115200(void)
 
         LOG_ERR("    Verification failed, reverting...");
 
-        change_stm32_baudrate_ll(UART4, 38400);
+        change_stm32_baudrate_ll(USARTx, from_baud);
 
         HAL_Delay(100);
 
     }
 
- 
 
     return false;
 
-}
\ No newline at end of file
+}
+
+
+#endif
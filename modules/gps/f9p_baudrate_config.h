@@ -2,39 +2,33 @@
 #define F9P_BAUDRATE_CONFIG_H
 
 
+#include "board_config.h"
+#include "stm32f4xx_ll_usart.h"
 #include <stdbool.h>
 
  
 
 /**
 
- * Base F9P UART1 보드레이트 초기화 (38400 → 115200)
+ * F9P UART1 보드레이트 초기화 (38400 → gps_rate_uart_baud, 기본 115200)
 
- * gps_rtk_uart2_init()에서 자동 호출됨 (DMA 활성화 전)
+ * gps_port 포트 초기화에서 자동 호출됨 (DMA 활성화 전)
 
- * STM32 UART2도 함께 115200으로 변경
+ * 마지막으로 확인된 속도(flash_params gps_baud)를 먼저 한 번 poll, 실패하면 전체 probe
 
- * @return true if success
-
- */
-
-bool f9p_init_uart1_baudrate_115200(void);
-
- 
-
-/**
+ * STM32 쪽 UART 도 같은 속도로 변경
 
- * Rover F9P UART1 보드레이트 초기화 (38400 → 115200)
+ * @param USARTx 수신기가 붙은 UART
 
- * gps_rtk_uart4_init()에서 자동 호출됨 (DMA 활성화 전)
+ * @param id 속도를 저장할 GPS ID
 
- * STM32 UART4도 함께 115200으로 변경
+ * @param name 로그용 이름
 
  * @return true if success
 
  */
 
-bool f9p_init_rover_uart1_baudrate_115200(void);
+bool f9p_init_port_baudrate(USART_TypeDef *USARTx, gps_id_t id, const char *name);
 
  
 
@@ -1,12 +1,33 @@
 #include "gps_app.h"
+#include "app_events.h"
+#include "rtos_static.h"
+#include "heap_track.h"
+#include "mem_watermark.h"
+#include "trace_marker.h"
+#include "boot_timeline.h"
+#include "pm_trace.h"
+#include "epoch_deadline.h"
 #include "board_config.h"
 #include "gps.h"
 #include "gps_port.h"
+#include "tx_pool.h"
+#include "gps_rate.h"
+#include "gps_fuse.h"
+#include "gps_time.h"
+#include "gps_tee.h"
+#include "gps_mb_bridge.h"
+#include "gps_grid.h"
+#include "pos_out.h"
+#include "rtcm_loadgen.h"
+#include "rtcm_router.h"
 #include "gps_unicore.h"
 #include "ubx_init.h"
 #include "ntrip_app.h"
 #include "rtcm.h"
 #include "led.h"
+#include "crc.h"
+#include "fmt.h"
+#include "timers.h"
 #include <string.h>
 #include <stdlib.h>
 #include "ubx_init.h"
@@ -15,6 +36,10 @@
 #include <stdio.h>
 #include "base_auto_fix.h"
 #include "ble_app.h"
+#include "adc.h"
+#include "irq_latency.h"
+#include "dma_ring.h"
+#include "init_seq.h"
 
 #ifndef TAG
   #define TAG "GPS_APP"
@@ -22,11 +47,22 @@
 
 #include "log.h"
 
-#define GPS_UART_MAX_RECV_SIZE 2048
+
+#define GPS_LED_ID 2
+#define GPS_LED_PERIOD_MS 500
+#define GPS_NAV_READ_RETRY 4
 
 #define GGA_AVG_SIZE 1
 #define HP_AVG_SIZE 1
 
+#define GPS_INIT_MAX_RETRY 3
+#define GPS_INIT_TIMEOUT_MS 1000
+#define GPS_INIT_WINDOW 4 // 응답을 동시에 기다리는 초기화 명령 수
+
+// RTK_BAT(ADC1_IN6) 정전 판단 값 (12bit, 보드 분압에 맞춤)
+#define GPS_POWER_FAIL_ADC_LOW 2400
+#define GPS_POWER_FAIL_ADC_HIGH 2600
+
 static bool gps_init_um982_base_fixed_async_internal(gps_id_t id, double lat, double lon, double alt,
 
                                                       gps_init_callback_t callback, void *user_data);
@@ -36,6 +72,34 @@ static bool gps_init_um982_base_surveyin_async_internal(gps_id_t id, uint32_t ti
                                                          gps_init_callback_t callback, void *user_data);
 
 
+/**
+ * @brief 응답 대기 중인 초기화 명령 (파이프라인 한 칸)
+ */
+typedef struct {
+  uint8_t step;                      // cmd_list 인덱스
+  uint8_t retry_count;
+  bool busy;
+  TickType_t sent_tick;
+  volatile gps_unicore_resp_t resp;  // RX 태스크가 echo 매칭 후 기록
+} gps_init_slot_t;
+
+/**
+ * @brief UM982 초기화 명령 파이프라인
+ *
+ * TX 태스크가 최대 GPS_INIT_WINDOW 개의 명령을 응답 없이 먼저 보내고,
+ * RX 태스크는 응답의 명령 echo 로 칸을 찾아 결과를 적은 뒤 TX 태스크에
+ * notification 을 준다. 인스턴스에 고정으로 두므로 힙을 쓰지 않는다.
+ */
+typedef struct {
+  const char **cmd_list;
+  uint8_t cmd_count;
+  uint8_t next_step;  // 다음에 보낼 명령
+  uint8_t done_count; // OK 받은 명령 수
+  gps_init_callback_t callback;
+  gps_init_slot_t slot[GPS_INIT_WINDOW];
+  volatile bool active;
+} gps_init_seq_t;
+
 typedef struct {
   int32_t lon[HP_AVG_SIZE];
   int32_t lat[HP_AVG_SIZE];
@@ -47,97 +111,147 @@ typedef struct {
   int8_t msl_hp[HP_AVG_SIZE];
   uint32_t hacc;
   uint32_t vacc;
-  double lon_avg;
-  double lat_avg;
-  double height_avg;
-  double msl_avg;
-  uint8_t pos;
-  uint8_t len;
+  /* 윈도우 running sum (lat/lon 1e-9 deg, height/msl 0.1mm) */
+  int64_t lon_sum;
+  int64_t lat_sum;
+  int64_t height_sum;
+  int64_t msl_sum;
+  gps_llh_t avg;
+  uint16_t pos;
+  uint16_t len;
   bool can_read;
 } ubx_hp_avg_data_t;
 
 typedef struct {
   gps_t gps;
-  QueueHandle_t queue;
   TaskHandle_t task;
   gps_type_t type;
   gps_id_t id;
   bool enabled;
 
+#if defined(USE_GPS_UBLOX)
   ubx_hp_avg_data_t ubx_hp_avg;
+#endif
 
   struct {
-    double lat[GGA_AVG_SIZE];
-    double lon[GGA_AVG_SIZE];
-    double alt[GGA_AVG_SIZE];
+    int64_t lat[GGA_AVG_SIZE]; // 1e-9 deg
+    int64_t lon[GGA_AVG_SIZE]; // 1e-9 deg
+    int32_t alt[GGA_AVG_SIZE]; // mm
+    int64_t lat_sum;
+    int64_t lon_sum;
+    int64_t alt_sum;
     double lat_avg;
     double lon_avg;
     double alt_avg;
-    uint8_t pos;
-    uint8_t len;
+    uint16_t pos;
+    uint16_t len;
     bool can_read;
   } gga_avg_data;
 
   QueueHandle_t cmd_queue;
   TaskHandle_t tx_task;
   gps_cmd_request_t *current_cmd_req;
+  gps_init_seq_t init_seq;
 
   gps_fix_t last_fix;
-  uint8_t gga_ntrip_counter;
-} gps_instance_t;
 
-static gps_instance_t gps_instances[GPS_ID_MAX] = {0};
+  volatile bool rx_activity; /**< LED 타이머 주기 동안 수신 여부 */
+  mem_wm_t rx_wm;            /**< 파싱 시점에 링에 쌓인 최대 byte */
+  uint32_t rx_parsed;        /**< 파서에 넘긴 누적 byte */
+  uint32_t epoch_mark;       /**< 직전 항법 해 때의 rx_parsed (gps_rate_note_epoch) */
+  uint32_t parse_count;      /**< 파싱 중인 구간 시작의 gps_port_get_rx_count() 값 */
+  uint32_t parse_from;       /**< 파싱 중인 구간 시작의 링 위치 */
+#if defined(USE_GPS_UBLOX)
+  bool hpposllh_seen;       /**< HPPOSLLH 수신 중이면 그것을 epoch 알림으로 (NAV-PVT 는 fix 만) */
+  volatile bool power_fail; /**< ADC 정전 감지 상태 (ISR 이 기록) */
+  bool sos_saved;           /**< 이번 정전에서 UPD-SOS 백업을 보냄 */
+  gps_ubx_mon_comms_t comms; /**< 마지막 MON-COMMS (읽는 쪽은 critical 로 복사) */
+  TickType_t comms_tick;     /**< 0: 아직 없음 */
+#endif
+} gps_instance_t;
 
+// 파서 상태는 매 바이트 접근하므로 CCM (DMA 링은 gps_port.c 의 SRAM)
+CCM_BSS static gps_instance_t gps_instances[GPS_ID_MAX];
+
+/* 마지막 NAV-PVT 의 UTC 날짜 yyyymmdd (0: 모름) */
+static volatile uint32_t gps_utc_date;
+
+/* base 수동 위치: 초기화가 끝났는지, 저장한 새 위치가 남았는지 (base RX 태스크가 적용) */
+static volatile bool gps_base_ready;
+static volatile bool gps_base_pos_dirty;
+
+#define GPS_RX_STACK_WORDS 1024
+#define GPS_TX_STACK_WORDS 512
+#define GPS_CMD_QUEUE_LEN 5
+
+/* 인스턴스별 정적 태스크/큐 저장소 */
+static StackType_t gps_rx_stack[GPS_ID_MAX][GPS_RX_STACK_WORDS] CCM_NOINIT;
+static StackType_t gps_tx_stack[GPS_ID_MAX][GPS_TX_STACK_WORDS] CCM_NOINIT;
+static uint8_t gps_cmd_queue_storage[GPS_ID_MAX][GPS_CMD_QUEUE_LEN * sizeof(gps_cmd_request_t)] CCM_NOINIT;
+static StaticTask_t gps_rx_tcb[GPS_ID_MAX];
+static StaticTask_t gps_tx_tcb[GPS_ID_MAX];
+static StaticQueue_t gps_cmd_queue_qcb[GPS_ID_MAX];
+static const char *const gps_rx_wm_names[GPS_ID_MAX] = {"gps_rx_0", "gps_rx_1"};
+static const char *const gps_cmd_wm_names[GPS_ID_MAX] = {"gps_cmd_0", "gps_cmd_1"};
+static TimerHandle_t gps_led_timer = NULL;
+
+/*
+ * 평균기는 정수 running sum 으로 유지한다. 새 샘플을 더하고 밀려나는 샘플을
+ * 빼므로 윈도우 크기와 상관없이 샘플당 비용이 같고, 정수 연산이라 오차가
+ * 누적되지 않아 주기적으로 다시 합산할 필요가 없다.
+ */
 void _add_gga_avg_data(gps_instance_t *inst, double lat, double lon,
                        double alt) {
-  uint8_t pos = inst->gga_avg_data.pos;
-  double lat_temp = 0.0, lon_temp = 0.0, alt_temp = 0.0;
-
-  inst->gga_avg_data.lat[pos] = lat;
-  inst->gga_avg_data.lon[pos] = lon;
-  inst->gga_avg_data.alt[pos] = alt;
-
-  inst->gga_avg_data.pos = (inst->gga_avg_data.pos + 1) % GGA_AVG_SIZE;
-
-  /* 정확도를 중시한 코드 */
-  if (inst->gga_avg_data.len < GGA_AVG_SIZE) {
+  uint16_t pos = inst->gga_avg_data.pos;
+  int64_t lat_ndeg = llround(lat * 1e9);
+  int64_t lon_ndeg = llround(lon * 1e9);
+  int32_t alt_mm = (int32_t)lround(alt * 1000.0);
+
+  if (inst->gga_avg_data.len == GGA_AVG_SIZE) {
+    inst->gga_avg_data.lat_sum -= inst->gga_avg_data.lat[pos];
+    inst->gga_avg_data.lon_sum -= inst->gga_avg_data.lon[pos];
+    inst->gga_avg_data.alt_sum -= inst->gga_avg_data.alt[pos];
+  } else {
     inst->gga_avg_data.len++;
+  }
 
-    if (inst->gga_avg_data.len == GGA_AVG_SIZE) {
-
-      for (int i = 0; i < GGA_AVG_SIZE; i++) {
-        lat_temp += inst->gga_avg_data.lat[i];
-        lon_temp += inst->gga_avg_data.lon[i];
-        alt_temp += inst->gga_avg_data.alt[i];
-      }
+  inst->gga_avg_data.lat[pos] = lat_ndeg;
+  inst->gga_avg_data.lon[pos] = lon_ndeg;
+  inst->gga_avg_data.alt[pos] = alt_mm;
+  inst->gga_avg_data.lat_sum += lat_ndeg;
+  inst->gga_avg_data.lon_sum += lon_ndeg;
+  inst->gga_avg_data.alt_sum += alt_mm;
 
-      inst->gga_avg_data.lat_avg = lat_temp / (double)GGA_AVG_SIZE;
-      inst->gga_avg_data.lon_avg = lon_temp / (double)GGA_AVG_SIZE;
-      inst->gga_avg_data.alt_avg = alt_temp / (double)GGA_AVG_SIZE;
+  inst->gga_avg_data.pos = (pos + 1) % GGA_AVG_SIZE;
 
-      inst->gga_avg_data.can_read = true;
-    }
-  } else {
-    for (int i = 0; i < GGA_AVG_SIZE; i++) {
-      lat_temp += inst->gga_avg_data.lat[i];
-      lon_temp += inst->gga_avg_data.lon[i];
-      alt_temp += inst->gga_avg_data.alt[i];
-    }
+  /* 윈도우가 다 찬 뒤부터 평균 제공 */
+  if (inst->gga_avg_data.len == GGA_AVG_SIZE) {
+    inst->gga_avg_data.lat_avg =
+        (double)inst->gga_avg_data.lat_sum / ((double)GGA_AVG_SIZE * 1e9);
+    inst->gga_avg_data.lon_avg =
+        (double)inst->gga_avg_data.lon_sum / ((double)GGA_AVG_SIZE * 1e9);
+    inst->gga_avg_data.alt_avg =
+        (double)inst->gga_avg_data.alt_sum / ((double)GGA_AVG_SIZE * 1000.0);
 
-    inst->gga_avg_data.lat_avg = lat_temp / (double)GGA_AVG_SIZE;
-    inst->gga_avg_data.lon_avg = lon_temp / (double)GGA_AVG_SIZE;
-    inst->gga_avg_data.alt_avg = alt_temp / (double)GGA_AVG_SIZE;
+    inst->gga_avg_data.can_read = true;
   }
 }
 
+#if defined(USE_GPS_UBLOX)
 void _add_hp_avg_data(gps_instance_t *inst) {
   gps_t *gps = &inst->gps;
-  uint8_t pos = inst->ubx_hp_avg.pos;
+  uint16_t pos = inst->ubx_hp_avg.pos;
   gps_ubx_nav_hpposllh_t *data = &gps->ubx_data.hpposllh;
   ubx_hp_avg_data_t *avg_data = &inst->ubx_hp_avg;
 
-  int64_t lat_sum = 0, lon_sum = 0, height_sum = 0, msl_sum = 0;
-  int16_t lat_hp_sum = 0, lon_hp_sum = 0, height_hp_sum = 0, msl_hp_sum = 0;
+  if (avg_data->len == HP_AVG_SIZE) {
+    avg_data->lon_sum -= gps_llh_from_ubx_deg(avg_data->lon[pos], avg_data->lon_hp[pos]);
+    avg_data->lat_sum -= gps_llh_from_ubx_deg(avg_data->lat[pos], avg_data->lat_hp[pos]);
+    avg_data->height_sum -= gps_llh_from_ubx_alt(avg_data->height[pos], avg_data->height_hp[pos]);
+    avg_data->msl_sum -= gps_llh_from_ubx_alt(avg_data->msl[pos], avg_data->msl_hp[pos]);
+  } else {
+    avg_data->len++;
+  }
 
   avg_data->lon[pos] = data->lon;
   avg_data->lat[pos] = data->lat;
@@ -150,61 +264,27 @@ void _add_hp_avg_data(gps_instance_t *inst) {
   avg_data->hacc = data->hacc;
   avg_data->vacc = data->vacc;
 
-  avg_data->pos = (avg_data->pos + 1) % HP_AVG_SIZE;
-
-  if (avg_data->len < HP_AVG_SIZE) {
-    avg_data->len++;
-
-    if (avg_data->len == HP_AVG_SIZE) {
-      for (int i = 0; i < HP_AVG_SIZE; i++) {
-        lon_sum += avg_data->lon[i];
-        lat_sum += avg_data->lat[i];
-        height_sum += avg_data->height[i];
-        msl_sum += avg_data->msl[i];
-        lon_hp_sum += avg_data->lon_hp[i];
-        lat_hp_sum += avg_data->lat_hp[i];
-        height_hp_sum += avg_data->height_hp[i];
-        msl_hp_sum += avg_data->msl_hp[i];
-      }
+  avg_data->lon_sum += gps_llh_from_ubx_deg(data->lon, data->lon_hp);
+  avg_data->lat_sum += gps_llh_from_ubx_deg(data->lat, data->lat_hp);
+  avg_data->height_sum += gps_llh_from_ubx_alt(data->height, data->height_hp);
+  avg_data->msl_sum += gps_llh_from_ubx_alt(data->msl, data->msl_hp);
 
-      avg_data->lon_avg = (lon_sum / (double)HP_AVG_SIZE) +
-                          (lon_hp_sum / (double)HP_AVG_SIZE / (double)100);
-      avg_data->lat_avg = (lat_sum / (double)HP_AVG_SIZE) +
-                          (lat_hp_sum / (double)HP_AVG_SIZE / (double)100);
-      avg_data->height_avg = (height_sum / (double)HP_AVG_SIZE) +
-                             (height_hp_sum / (double)HP_AVG_SIZE / (double)10);
-      avg_data->msl_avg = (msl_sum / (double)HP_AVG_SIZE) +
-                          (msl_hp_sum / (double)HP_AVG_SIZE / (double)10);
+  avg_data->pos = (pos + 1) % HP_AVG_SIZE;
 
-      avg_data->can_read = true;
-    }
-  } else if (avg_data->len == HP_AVG_SIZE) {
-    for (int i = 0; i < HP_AVG_SIZE; i++) {
-      lon_sum += avg_data->lon[i];
-      lat_sum += avg_data->lat[i];
-      height_sum += avg_data->height[i];
-      msl_sum += avg_data->msl[i];
-      lon_hp_sum += avg_data->lon_hp[i];
-      lat_hp_sum += avg_data->lat_hp[i];
-      height_hp_sum += avg_data->height_hp[i];
-      msl_hp_sum += avg_data->msl_hp[i];
-    }
+  if (avg_data->len == HP_AVG_SIZE) {
+    avg_data->avg.lon = avg_data->lon_sum / HP_AVG_SIZE;
+    avg_data->avg.lat = avg_data->lat_sum / HP_AVG_SIZE;
+    avg_data->avg.ellipsoid_alt = (int32_t)(avg_data->height_sum / HP_AVG_SIZE);
+    avg_data->avg.msl_alt = (int32_t)(avg_data->msl_sum / HP_AVG_SIZE);
 
-    avg_data->lon_avg = (lon_sum / (double)HP_AVG_SIZE) +
-                        (lon_hp_sum / (double)HP_AVG_SIZE / (double)100);
-    avg_data->lat_avg = (lat_sum / (double)HP_AVG_SIZE) +
-                        (lat_hp_sum / (double)HP_AVG_SIZE / (double)100);
-    avg_data->height_avg = (height_sum / (double)HP_AVG_SIZE) +
-                           (height_hp_sum / (double)HP_AVG_SIZE / (double)10);
-    avg_data->msl_avg = (msl_sum / (double)HP_AVG_SIZE) +
-                        (msl_hp_sum / (double)HP_AVG_SIZE / (double)10);
-  } else {
-    LOG_ERR("HP AVG LEN mismatch");
+    avg_data->can_read = true;
   }
 }
+#endif
 
-#define GPS_INIT_MAX_RETRY 3
-#define GPS_INIT_TIMEOUT_MS 1000
+/* 항법 주기마다 내보내는 log (gps_init_um982_rover_async 에서 gps_rate 주기로 채움) */
+static char um982_rover_heading_cmd[32];
+static char um982_rover_bestnav_cmd[32];
 
 #define UM982_BASE_CMD_COUNT (sizeof(um982_base_cmds) / sizeof(um982_base_cmds[0]))
 
@@ -241,11 +321,18 @@ static const char *um982_rover_cmds[] = {
   "unmask GLO\r\n",
   "unmask GAL\r\n",
   "unmask QZSS\r\n",
+#if defined(USE_UM982_BINARY_ONLY)
+  // 이전에 저장된 NMEA 출력도 끈다 (fix/위성수는 BESTNAVB, heading 은 UNIHEADINGB)
+  "unlog com1 gpgga\r\n",
+  "unlog com1 gpths\r\n",
+  "PVTSLNB 1\r\n", // dop, 속도
+#else
   "gpgga com1 1\r\n",
+#endif
   // "gpgsv com1 1\r\n",
-  "gpths com1 0.05\r\n",
+  um982_rover_heading_cmd,
   // "OBSVHA COM1 1\r\n", // slave antenna
-  "BESTNAVB 0.05\r\n",
+  um982_rover_bestnav_cmd,
   "CONFIG HEADING FIXLENGTH\r\n"
 
   // "CONFIG PVTALG MULTI\r\n",
@@ -259,17 +346,6 @@ static const char *um982_rover_cmds[] = {
 
 #define UM982_ROVER_CMD_COUNT (sizeof(um982_rover_cmds) / sizeof(um982_rover_cmds[0]))
 
-typedef void (*gps_init_callback_t)(bool success, void *user_data);
-
-typedef struct {
-  gps_id_t gps_id;
-  uint8_t current_step;
-  uint8_t retry_count;
-  const char **cmd_list;
-  uint8_t cmd_count;
-  gps_init_callback_t callback;
-} gps_init_context_t;
-
 /**
  * @brief UM982 Base 스테이션을 Fixed 모드로 설정 (비동기)
  */
@@ -319,7 +395,7 @@ static bool gps_init_um982_base_surveyin_async_internal(gps_id_t id, uint32_t ti
  * @brief UM982 Base 스테이션 모드를 user_params 기반으로 설정 (비동기)
  */
 bool gps_configure_um982_base_mode_async(gps_id_t id, gps_init_callback_t callback, void *user_data) {
-  user_params_t* params = flash_params_get_current();
+  const user_params_t* params = flash_params_snapshot(NULL);
 
     // Fixed base station mode with manual position
     double lat = strtod(params->lat, NULL);
@@ -342,7 +418,7 @@ static void baseline_init_complete(bool success, void *user_data) {
 
  void gps_set_heading_length()
 {
-  user_params_t* params = flash_params_get_current();
+  const user_params_t* params = flash_params_snapshot(NULL);
   gps_config_heading_length_async(0, params->baseline_len, params->baseline_len*0.2, baseline_init_complete, (void*)0);
 }
 
@@ -368,9 +444,11 @@ static void overall_init_complete(bool success, void *user_data) {
   LOG_INFO("GPS[%d] Overall init %s", id, success ? "succeeded" : "failed");
 
   const board_config_t *config = board_get_config();
-  user_params_t* params = flash_params_get_current();
+  const user_params_t* params = flash_params_snapshot(NULL);
   if(config->board == BOARD_TYPE_BASE_UM982)
   {
+    gps_base_pos_dirty = false;
+    gps_base_ready = true;
     if(params->use_manual_position)
     {
       gps_configure_um982_base_mode_async(id, basestation_init_complete, (void *)(uintptr_t)id);
@@ -385,261 +463,726 @@ static void overall_init_complete(bool success, void *user_data) {
 
 #endif
 
-static void gps_init_command_callback(bool success, void *user_data) {
-  gps_init_context_t *ctx = (gps_init_context_t *)user_data;
+#if defined(USE_GPS_UNICORE)
+/**
+ * @brief 응답 echo 와 보낸 명령 비교 (대소문자, 끝의 \r\n 무시)
+ *
+ * echo 는 파서 term 크기에서 잘리므로 잘린 길이만큼만 비교한다.
+ */
+static bool gps_init_echo_match(const char *cmd, const char *echo) {
+  size_t echo_len = strlen(echo);
+  size_t cmd_len = strcspn(cmd, "\r\n");
+
+  if (echo_len == 0) {
+    return false;
+  }
 
-  if (!ctx) {
-    LOG_ERR("GPS init context is NULL");
-    return;
+  if (echo_len < GPS_UNICORE_TERM_SIZE - 1 && echo_len != cmd_len) {
+    return false;
+  }
+
+  return echo_len <= cmd_len && strncasecmp(cmd, echo, echo_len) == 0;
+}
+
+/**
+ * @brief 초기화 명령 응답 처리 (RX 태스크, 응답 구독 콜백에서 호출)
+ *
+ * @return true 대기 중인 초기화 명령의 응답이었음
+ */
+static bool gps_init_seq_on_response(gps_instance_t *inst, const char *echo,
+                                     gps_unicore_resp_t resp) {
+  gps_init_seq_t *seq = &inst->init_seq;
+
+  for (uint8_t i = 0; i < GPS_INIT_WINDOW; i++) {
+    gps_init_slot_t *slot = &seq->slot[i];
+
+    if (slot->busy && slot->resp == GPS_UNICORE_RESP_NONE &&
+        gps_init_echo_match(seq->cmd_list[slot->step], echo)) {
+      slot->resp = resp;
+      xTaskNotifyGive(inst->tx_task);
+      return true;
+    }
+  }
+
+  return false;
+}
+#endif
+
+/**
+ * @brief 명령 프레임 송신 (TX 잠금만 잡음, 파싱과 겹쳐도 됨)
+ *
+ * 보정 링이 붙은 포트는 보정 프레임 경계에서 끼어든다. URGENT 는 진행 중인
+ * 보정 프레임 바로 뒤, NORMAL 은 이미 쌓여 있던 보정 데이터 뒤에 나간다.
+ *
+ * @return false TX 잠금 타임아웃 (보내지 않음)
+ */
+static bool gps_tx_frame(gps_instance_t *inst, const char *data, size_t len,
+                         uart_tx_prio_t prio, TickType_t wait) {
+  if (xSemaphoreTake(inst->gps.tx_mutex, wait) != pdTRUE) {
+    return false;
+  }
+
+  if (gps_port_has_stream(inst->id)) {
+    gps_port_send_prio(inst->id, data, len, prio);
+  } else {
+    inst->gps.ops->send(data, len);
   }
+  xSemaphoreGive(inst->gps.tx_mutex);
+
+  return true;
+}
+
+static void gps_init_seq_send(gps_instance_t *inst, gps_init_slot_t *slot) {
+  const char *cmd = inst->init_seq.cmd_list[slot->step];
 
+  slot->resp = GPS_UNICORE_RESP_NONE;
+  slot->busy = true;
+  slot->sent_tick = xTaskGetTickCount();
+
+  // 응답 타임아웃이 빠듯하므로 보정 데이터보다 먼저
+  gps_tx_frame(inst, cmd, strlen(cmd), UART_TX_PRIO_URGENT, pdMS_TO_TICKS(1000));
+}
+
+static void gps_init_seq_finish(gps_id_t id, gps_instance_t *inst, bool success) {
+  gps_init_seq_t *seq = &inst->init_seq;
+
+  seq->active = false;
   if (success) {
-    LOG_INFO("GPS[%d] Init step %d/%d OK: %s",
-             ctx->gps_id, ctx->current_step + 1, ctx->cmd_count,
-             ctx->cmd_list[ctx->current_step]);
+    boot_timeline_mark(BOOT_MARK_GPS_CONFIG);
+  }
+
+  if (seq->callback) {
+    seq->callback(success, (void *)(uintptr_t)id);
+  }
+}
 
-    ctx->current_step++;
-    ctx->retry_count = 0;
+/**
+ * @brief 초기화 명령 파이프라인 실행 (TX 태스크, 끝날 때까지 블로킹)
+ *
+ * 빈 칸이 생기는 대로 다음 명령을 보내고, 응답 또는 가장 빠른 타임아웃까지
+ * notification 을 기다린다. ERROR/타임아웃은 그 명령만 다시 보내며
+ * GPS_INIT_MAX_RETRY 번 실패하면 시퀀스 전체를 실패로 끝낸다.
+ */
+static void gps_init_seq_run(gps_id_t id, gps_instance_t *inst) {
+  gps_init_seq_t *seq = &inst->init_seq;
+  const TickType_t timeout = pdMS_TO_TICKS(GPS_INIT_TIMEOUT_MS);
+
+  if (!inst->gps.ops || !inst->gps.ops->send) {
+    LOG_ERR("GPS[%d] send ops not available", id);
+    gps_init_seq_finish(id, inst, false);
+    return;
+  }
+
+  ulTaskNotifyTake(pdTRUE, 0);
 
-    if (ctx->current_step >= ctx->cmd_count) {
-      LOG_INFO("GPS[%d] Init sequence complete!", ctx->gps_id);
-      if (ctx->callback) {
-        ctx->callback(true, NULL);
+  while (seq->active) {
+    for (uint8_t i = 0; i < GPS_INIT_WINDOW && seq->next_step < seq->cmd_count; i++) {
+      gps_init_slot_t *slot = &seq->slot[i];
+
+      if (!slot->busy) {
+        slot->step = seq->next_step++;
+        slot->retry_count = 0;
+        gps_init_seq_send(inst, slot);
       }
+    }
+
+    // 가장 먼저 타임아웃 나는 칸까지 대기
+    TickType_t now = xTaskGetTickCount();
+    TickType_t wait = timeout;
+
+    for (uint8_t i = 0; i < GPS_INIT_WINDOW; i++) {
+      gps_init_slot_t *slot = &seq->slot[i];
 
-      vPortFree(ctx);
-      return;
+      if (slot->busy && slot->resp == GPS_UNICORE_RESP_NONE) {
+        TickType_t elapsed = now - slot->sent_tick;
+        TickType_t remain = (elapsed < timeout) ? timeout - elapsed : 0;
+
+        if (remain < wait) {
+          wait = remain;
+        }
+      }
     }
 
+    ulTaskNotifyTake(pdTRUE, wait);
+    now = xTaskGetTickCount();
 
-    gps_send_command_async(ctx->gps_id, ctx->cmd_list[ctx->current_step],
-                           GPS_INIT_TIMEOUT_MS, gps_init_command_callback, ctx);
-  } else {
+    for (uint8_t i = 0; i < GPS_INIT_WINDOW && seq->active; i++) {
+      gps_init_slot_t *slot = &seq->slot[i];
+      gps_unicore_resp_t resp = slot->resp;
 
-    ctx->retry_count++;
+      if (!slot->busy) {
+        continue;
+      }
 
-    if (ctx->retry_count < GPS_INIT_MAX_RETRY) {
+      if (resp == GPS_UNICORE_RESP_OK) {
+        LOG_INFO("GPS[%d] Init step %d/%d OK: %s", id, slot->step + 1,
+                 seq->cmd_count, seq->cmd_list[slot->step]);
+        slot->busy = false;
+        seq->done_count++;
+        continue;
+      }
 
-      LOG_WARN("GPS[%d] Init step %d/%d failed, retrying (%d/%d): %s",
-               ctx->gps_id, ctx->current_step + 1, ctx->cmd_count,
-               ctx->retry_count, GPS_INIT_MAX_RETRY,
-               ctx->cmd_list[ctx->current_step]);
+      if (resp == GPS_UNICORE_RESP_NONE && now - slot->sent_tick < timeout) {
+        continue;
+      }
 
-      
-      gps_send_command_async(ctx->gps_id, ctx->cmd_list[ctx->current_step],
-                             GPS_INIT_TIMEOUT_MS, gps_init_command_callback, ctx);
-    } else {
-      LOG_ERR("GPS[%d] Init failed at step %d/%d after %d retries: %s",
-              ctx->gps_id, ctx->current_step + 1, ctx->cmd_count,
-              GPS_INIT_MAX_RETRY, ctx->cmd_list[ctx->current_step]);
+      slot->retry_count++;
 
-      if (ctx->callback) {
-        ctx->callback(false, NULL);
+      if (slot->retry_count < GPS_INIT_MAX_RETRY) {
+        LOG_WARN("GPS[%d] Init step %d/%d %s, retrying (%d/%d): %s", id,
+                 slot->step + 1, seq->cmd_count,
+                 (resp == GPS_UNICORE_RESP_NONE) ? "timeout" : "failed",
+                 slot->retry_count, GPS_INIT_MAX_RETRY, seq->cmd_list[slot->step]);
+        gps_init_seq_send(inst, slot);
+      } else {
+        LOG_ERR("GPS[%d] Init failed at step %d/%d after %d retries: %s", id,
+                slot->step + 1, seq->cmd_count, GPS_INIT_MAX_RETRY,
+                seq->cmd_list[slot->step]);
+        gps_init_seq_finish(id, inst, false);
       }
-      
-      vPortFree(ctx);
+    }
+
+    if (seq->active && seq->done_count >= seq->cmd_count) {
+      LOG_INFO("GPS[%d] Init sequence complete!", id);
+      gps_init_seq_finish(id, inst, true);
     }
   }
+
+  memset(seq->slot, 0, sizeof(seq->slot));
 }
 
 /**
- * @brief GPS UM982 Base 모드 초기화 (비동기)
+ * @brief 초기화 명령 파이프라인 시작
+ *
+ * 시퀀스는 TX 태스크가 실행하므로 빈 명령 요청으로 깨우기만 한다.
  */
-bool gps_init_um982_base_async(gps_id_t id, gps_init_callback_t callback) {
+static bool gps_init_seq_start(gps_id_t id, const char **cmd_list, uint8_t cmd_count,
+                               gps_init_callback_t callback) {
   if (id >= GPS_ID_MAX || !gps_instances[id].enabled) {
     LOG_ERR("GPS[%d] invalid or disabled", id);
     return false;
   }
 
-  // 초기화 컨텍스트 생성 (동적 할당)
-  gps_init_context_t *ctx = (gps_init_context_t *)pvPortMalloc(sizeof(gps_init_context_t));
-  if (!ctx) {
-    LOG_ERR("GPS[%d] failed to allocate init context", id);
+  gps_instance_t *inst = &gps_instances[id];
+  gps_init_seq_t *seq = &inst->init_seq;
+
+  if (seq->active) {
+    LOG_ERR("GPS[%d] init sequence already running", id);
     return false;
   }
 
-  // 컨텍스트 초기화
-  ctx->gps_id = id;
-  ctx->current_step = 0;
-  ctx->retry_count = 0;
-  ctx->cmd_list = um982_base_cmds;
-  ctx->cmd_count = UM982_BASE_CMD_COUNT;
-  ctx->callback = callback;
+  memset(seq, 0, sizeof(*seq));
+  seq->cmd_list = cmd_list;
+  seq->cmd_count = cmd_count;
+  seq->callback = callback;
+  seq->active = true;
 
-  LOG_DEBUG("GPS[%d] Starting UM982 base init sequence (%d commands)",
-           id, ctx->cmd_count);
+  gps_cmd_request_t wake = {0};
 
-  // 첫 번째 명령어 전송
-  if (!gps_send_command_async(id, ctx->cmd_list[0], GPS_INIT_TIMEOUT_MS,
-                               gps_init_command_callback, ctx)) {
+  if (xQueueSend(inst->cmd_queue, &wake, pdMS_TO_TICKS(1000)) != pdTRUE) {
     LOG_ERR("GPS[%d] failed to start init sequence", id);
-    vPortFree(ctx);
+    seq->active = false;
     return false;
   }
 
   return true;
 }
 
+/**
+ * @brief GPS UM982 Base 모드 초기화 (비동기)
+ */
+bool gps_init_um982_base_async(gps_id_t id, gps_init_callback_t callback) {
+  LOG_DEBUG("GPS[%d] Starting UM982 base init sequence (%d commands)",
+           id, UM982_BASE_CMD_COUNT);
+
+  return gps_init_seq_start(id, um982_base_cmds, UM982_BASE_CMD_COUNT, callback);
+}
+
 /**
  * @brief GPS UM982 Rover 모드 초기화 (비동기)
  */
 bool gps_init_um982_rover_async(gps_id_t id, gps_init_callback_t callback) {
-  if (id >= GPS_ID_MAX || !gps_instances[id].enabled) {
-    LOG_ERR("GPS[%d] invalid or disabled", id);
+  char period[8];
+
+  gps_rate_period_str(gps_rate_get_hz(), period, sizeof(period));
+#if defined(USE_UM982_BINARY_ONLY)
+  snprintf(um982_rover_heading_cmd, sizeof(um982_rover_heading_cmd), "UNIHEADINGB %s\r\n", period);
+#else
+  snprintf(um982_rover_heading_cmd, sizeof(um982_rover_heading_cmd), "gpths com1 %s\r\n", period);
+#endif
+  snprintf(um982_rover_bestnav_cmd, sizeof(um982_rover_bestnav_cmd), "BESTNAVB %s\r\n", period);
+
+  LOG_DEBUG("GPS[%d] Starting UM982 rover init sequence (%d commands)",
+           id, UM982_ROVER_CMD_COUNT);
+
+  return gps_init_seq_start(id, um982_rover_cmds, UM982_ROVER_CMD_COUNT, callback);
+}
+
+/**
+ * @brief 캐스터 VRS 위치용 GGA (pos_out sink, fix 가 있을 때 업로드 간격마다)
+ *
+ * 수신기 NMEA 대신 pos_out 이 epoch 에 한 번 만든 GGA 를 쓴다.
+ */
+static bool gps_gga_emit(const uint8_t *data, size_t len) {
+  event_bus_t *bus = app_bus();
+  gps_nav_data_t nav = {0};
+  event_msg_t *msg;
+  app_evt_gps_gga_t *evt;
+
+  if (!event_bus_has_subscriber(bus, APP_EVT_GPS_GGA)) {
     return false;
   }
+  gps_get_nav(GPS_ID_BASE, &nav);
 
-  // 초기화 컨텍스트 생성 (동적 할당)
-  gps_init_context_t *ctx = (gps_init_context_t *)pvPortMalloc(sizeof(gps_init_context_t));
-  if (!ctx) {
-    LOG_ERR("GPS[%d] failed to allocate init context", id);
+  msg = event_bus_loan(bus, sizeof(*evt) + len);
+  if (!msg) {
     return false;
   }
 
-  // 컨텍스트 초기화
-  ctx->gps_id = id;
-  ctx->current_step = 0;
-  ctx->retry_count = 0;
-  ctx->cmd_list = um982_rover_cmds;
-  ctx->cmd_count = UM982_ROVER_CMD_COUNT;
-  ctx->callback = callback;
+  evt = (app_evt_gps_gga_t *)msg->data;
+  evt->id = GPS_ID_BASE;
+  evt->fix = nav.fix;
+  evt->len = (uint8_t)len;
+  evt->epoch = pos_out_epoch();
+  memcpy(evt->raw, data, len);
 
-  LOG_DEBUG("GPS[%d] Starting UM982 rover init sequence (%d commands)",
-           id, ctx->cmd_count);
+  event_bus_commit(bus, msg, APP_EVT_GPS_GGA);
+  return true;
+}
 
-  if (!gps_send_command_async(id, ctx->cmd_list[0], GPS_INIT_TIMEOUT_MS,
-                               gps_init_command_callback, ctx)) {
-    LOG_ERR("GPS[%d] failed to start init sequence", id);
-    vPortFree(ctx);
-    return false;
+static pos_out_sink_t gps_gga_sink = POS_OUT_SINK_INIT(
+    "gga", POS_OUT_FMT_NMEA_GGA, NULL, ntrip_get_gga_interval, gps_gga_emit, true);
+
+/**
+ * @brief 항법 해를 출력용 위치로 (heading 은 nav 값 그대로)
+ */
+static void gps_position_from_nav(const gps_nav_data_t *nav, gps_position_t *pos) {
+  pos->llh = nav->llh;
+  pos->heading = nav->heading;
+  pos->itow = nav->itow;
+  pos->fix = nav->fix;
+  pos->sat_num = nav->sat_num;
+  pos->hdop = nav->hdop;
+  pos->h_acc = nav->h_acc;
+  pos->v_acc = nav->v_acc;
+  pos->vel_n = nav->vel_n;
+  pos->vel_e = nav->vel_e;
+  pos->vel_d = nav->vel_d;
+  pos->tick = nav->itow_tick;
+}
+
+/**
+ * @brief 지금 파싱한 프레임 마지막 byte 까지의 누적 수신 byte (파서 콜백 안)
+ */
+static uint32_t gps_frame_rx_count(const gps_instance_t *inst) {
+  const gps_t *gps = &inst->gps;
+  size_t off = (size_t)(gps->cur - gps->ring);
+
+  off = (off + gps->ring_size - inst->parse_from) % gps->ring_size;
+  return inst->parse_count + (uint32_t)off + 1U;
+}
+
+/**
+ * @brief 새 항법 해 알림 (위치는 GPS_ID_BASE 수신기 기준, gps_get_position)
+ */
+static void gps_on_new_solution(gps_instance_t *inst) {
+  app_evt_gps_solution_t evt = { .id = inst->id };
+
+  gps_rate_note_epoch(inst->id, inst->rx_parsed - inst->epoch_mark);
+  inst->epoch_mark = inst->rx_parsed;
+  gps_time_note_epoch(inst->id, inst->gps.nav.data.itow, gps_frame_rx_count(inst));
+
+  if (inst->id != GPS_ID_BASE) {
+    return;
   }
+  evt.epoch = epoch_dl_begin();
 
-  return true;
+  if (BOARD_IS(BOARD_TYPE_ROVER_F9P)) {
+    // heading 반쪽과 iTOW 를 맞춘 뒤 gps_fuse 가 알린다
+    gps_position_t pos;
+
+    gps_position_from_nav(&inst->gps.nav.data, &pos);
+    gps_fuse_add_position(&pos);
+  } else {
+    app_event_publish(APP_EVT_GPS_SOLUTION, &evt, sizeof(evt));
+  }
 }
 
-void gps_evt_handler(gps_t *gps, gps_event_t event, gps_procotol_t protocol,
-                     gps_msg_t msg) {
-  gps_instance_t *inst = NULL;
-  const board_config_t *config = board_get_config();
+/**
+ * @brief fix 가 바뀌었으면 알림
+ */
+static void gps_check_fix_changed(gps_instance_t *inst, gps_fix_t fix) {
+  app_evt_gps_fix_t evt;
 
-  for (uint8_t i = 0; i < GPS_CNT; i++) {
-    if (gps_instances[i].enabled && &gps_instances[i].gps == gps) {
-      inst = &gps_instances[i];
-      break;
+  if (fix == inst->last_fix) {
+    return;
+  }
+
+  evt.id = inst->id;
+  evt.fix = fix;
+  evt.prev = inst->last_fix;
+  pm_trace(PM_EVT_GPS_FIX, inst->id, ((uint32_t)inst->last_fix << 8) | fix);
+  inst->last_fix = fix;
+
+  if (inst->id == GPS_ID_BASE) {
+    if (fix == GPS_FIX_RTK_FLOAT) {
+      boot_timeline_mark(BOOT_MARK_RTK_FLOAT);
+    } else if (fix == GPS_FIX_RTK_FIX) {
+      boot_timeline_mark(BOOT_MARK_RTK_FIX);
     }
   }
 
-  if (!inst)
+  app_event_publish(APP_EVT_GPS_FIX_CHANGED, &evt, sizeof(evt));
+}
+
+/**
+ * @brief RTK FIX 위치 샘플 (base 좌표 평균용)
+ */
+static void gps_publish_rtk_sample(int64_t lat, int64_t lon, int32_t alt, float h_acc,
+                                   float v_acc) {
+  app_evt_gps_sample_t evt = {
+    .lat = lat, .lon = lon, .alt = alt, .h_acc = h_acc, .v_acc = v_acc,
+  };
+
+  app_event_publish(APP_EVT_GPS_RTK_SAMPLE, &evt, sizeof(evt));
+}
+
+/**
+ * @brief RTCM 프레임 원문 (구독자가 있을 때만 복사)
+ *
+ * LoRa 전달은 RX 태스크 전용 묶음 버퍼를 쓰므로 여기서 하지 않는다.
+ */
+static void gps_publish_rtcm(gps_instance_t *inst, gps_t *gps) {
+  event_bus_t *bus = app_bus();
+  size_t len = gps->rtcm.total_len;
+  gps_frame_t frame;
+  event_msg_t *msg;
+  app_evt_rtcm_frame_t *evt;
+
+  if (len == 0 || sizeof(*evt) + len > EVENT_DATA_MAX_SIZE ||
+      !event_bus_has_subscriber(bus, APP_EVT_RTCM_FRAME)) {
+    return;
+  }
+
+  if (!gps_get_frame(gps, &frame)) {
+    frame.seg[0] = (const uint8_t *)gps->payload;
+    frame.len[0] = len;
+    frame.seg[1] = NULL;
+    frame.len[1] = 0;
+  }
+
+  msg = event_bus_loan(bus, sizeof(*evt) + len);
+  if (!msg) {
     return;
+  }
 
-  switch (protocol) {
-  case GPS_PROTOCOL_NMEA:
-    if (msg.nmea == GPS_NMEA_MSG_GGA) {
-    	if(config->board == BOARD_TYPE_BASE_F9P || config->board == BOARD_TYPE_BASE_UM982)
-    	{
-          if (gps->nmea_data.gga.fix != inst->last_fix) {
-    	        base_auto_fix_on_gps_fix_changed(gps->nmea_data.gga.fix);
-    	        inst->last_fix = gps->nmea_data.gga.fix;
-    	    }
-      }
+  evt = (app_evt_rtcm_frame_t *)msg->data;
+  evt->id = inst->id;
+  evt->type = gps->rtcm.msg_type;
+  evt->len = (uint16_t)len;
+  memcpy(evt->data, frame.seg[0], frame.len[0]);
+  if (frame.len[1]) {
+    memcpy(evt->data + frame.len[0], frame.seg[1], frame.len[1]);
+  }
 
-      if (gps->nmea_data.gga_is_rdy)
-      {
-        if(config->board == BOARD_TYPE_ROVER_F9P)
-        {
-          if(inst->id == GPS_ID_BASE)
-          {
-                  if(ntrip_gga_send_queue_initialized() && gps->nmea_data.gga.fix >= GPS_FIX_GPS)
-                  {
-                    ntrip_send_gga_data(gps->nmea_data.gga_raw,
-                                     gps->nmea_data.gga_raw_pos);
-                  }
-              
+  event_bus_commit(bus, msg, APP_EVT_RTCM_FRAME);
+}
 
-          }
-        }
-        else
-        {
-            if(ntrip_gga_send_queue_initialized() && gps->nmea_data.gga.fix >= GPS_FIX_GPS)
-            {
-                ntrip_send_gga_data(gps->nmea_data.gga_raw,
-                                    gps->nmea_data.gga_raw_pos);
-            }
-        }
-      }
+#if defined(USE_GPS_UBLOX)
+/**
+ * @brief UPD-SOS 결과 처리
+ *
+ * 복원에 성공했으면 백업을 지워서 다음 정전 전에 리셋되더라도 오래된
+ * 항법 데이터로 시작하지 않게 한다.
+ */
+static void gps_on_sos_result(gps_instance_t *inst, const gps_ubx_upd_sos_t *sos) {
+  if (sos->cmd == UBX_SOS_CMD_SAVE_ACK) {
+    LOG_INFO("GPS[%d] 정전 백업 %s", inst->id, sos->response ? "완료" : "실패");
+  } else if (sos->cmd == UBX_SOS_CMD_RESTORED) {
+    LOG_INFO("GPS[%d] 백업 복원 결과 %d", inst->id, sos->response);
+
+    if (sos->response == UBX_SOS_RESTORE_OK) {
+      ubx_sos_clear(&inst->gps);
     }
-    break;
+  }
+}
 
-  case GPS_PROTOCOL_UBX:
-    if (msg.ubx.id == GPS_UBX_NAV_ID_HPPOSLLH) {
-      if(config->board == BOARD_TYPE_BASE_F9P)
-      {
-        if (gps->nmea_data.gga.fix == GPS_FIX_RTK_FIX) {
-          // _add_hp_avg_data(inst);
-          double lat = gps->ubx_data.hpposllh.lat * 1e-7 + gps->ubx_data.hpposllh.lat_hp * 1e-9;
-          double lon = gps->ubx_data.hpposllh.lon * 1e-7 + gps->ubx_data.hpposllh.lon_hp * 1e-9;
-          double alt = (gps->ubx_data.hpposllh.height + gps->ubx_data.hpposllh.height * 1e-2)/(double)1000.0;
-          base_auto_fix_on_gga_update(lat, lon, alt);
-        }
-      }
-    }
+/**
+ * @brief ADC 정전 감지 콜백 (ISR)
+ *
+ * 실제 백업은 GPS 수신 태스크가 보낸다.
+ */
+static void gps_power_fail_isr(bool fail) {
+  BaseType_t woken = pdFALSE;
 
-  case GPS_PROTOCOL_UNICORE:
-    if (inst->current_cmd_req != NULL) {
-      gps_unicore_resp_t resp = gps_get_unicore_response(gps);
-      if (resp == GPS_UNICORE_RESP_OK) {
-        if (inst->current_cmd_req->is_async) {
-          inst->current_cmd_req->async_result = true;
-        } else {
-          *(inst->current_cmd_req->result) = true;
-        }
-        xSemaphoreGive(inst->current_cmd_req->response_sem);
-      } else if (resp == GPS_UNICORE_RESP_ERROR || resp == GPS_UNICORE_RESP_UNKNOWN) {
-        if (inst->current_cmd_req->is_async) {
-          inst->current_cmd_req->async_result = false;
-        } else {
-          *(inst->current_cmd_req->result) = false;
-        }
-        xSemaphoreGive(inst->current_cmd_req->response_sem);
-      }
+  for (uint8_t i = 0; i < GPS_CNT; i++) {
+    gps_instance_t *inst = &gps_instances[i];
+
+    if (inst->enabled && inst->type == GPS_TYPE_F9P && inst->task) {
+      inst->power_fail = fail;
+      vTaskNotifyGiveFromISR(inst->task, &woken);
     }
+  }
+  portYIELD_FROM_ISR(woken);
+}
 
-    break;
+/**
+ * @brief 정전 상태에 맞춰 UPD-SOS 백업 / GNSS 재시작 (수신 태스크)
+ */
+static void gps_power_fail_process(gps_instance_t *inst) {
+  if (inst->power_fail && !inst->sos_saved) {
+    LOG_WARN("GPS[%d] 정전 감지, 항법 데이터 백업", inst->id);
+    ubx_sos_save(&inst->gps);
+    inst->sos_saved = true;
+  } else if (!inst->power_fail && inst->sos_saved) {
+    // 리셋 없이 전원이 돌아옴 - 멈춘 GNSS 다시 시작
+    LOG_INFO("GPS[%d] 전원 회복, GNSS 재시작", inst->id);
+    ubx_gnss_start(&inst->gps);
+    inst->sos_saved = false;
+  }
+}
+#endif
 
-case GPS_PROTOCOL_UNICORE_BIN:
-    switch (msg.unicore_bin.msg) {
-      case GPS_UNICORE_BIN_MSG_BESTNAV: {
-        if(config->board == BOARD_TYPE_BASE_UM982)
-        {
-          if (gps->nmea_data.gga.fix == GPS_FIX_RTK_FIX)
-          {
-            hpd_unicore_bestnavb_t *bestnav = &gps->unicore_bin_data.bestnav;
-            base_auto_fix_on_gga_update(bestnav->lat, bestnav->lon, bestnav->height);
-          }
-        }
-      }
-    }
+/*
+ * 메시지별 수신 콜백 (gps_subscribe, ctx = gps_instance_t)
+ *
+ * 필요한 메시지만 구독하므로 다른 프레임은 파서에서 바로 지나간다.
+ */
+static void gps_on_nmea_gga(gps_t *gps, gps_procotol_t protocol, gps_msg_t msg,
+                            void *ctx) {
+  gps_check_fix_changed(ctx, gps->nmea_data.gga.fix);
+}
+
+/**
+ * @brief 항법 해의 보정 나이를 라우터에 알림 (수신기가 보정을 못 쓰면 소스 강등)
+ *
+ * 위치가 없으면 보정과 무관하므로 알리지 않고, 단독 측위면 보정을 안 쓰는
+ * 것이므로 UINT32_MAX 로 바꾼다.
+ *
+ * @param age_ms 수신기가 알려준 보정 나이 (0: 모름)
+ */
+static void gps_report_diff_age(gps_instance_t *inst, uint32_t age_ms) {
+  switch (inst->last_fix) {
+  case GPS_FIX_GPS:
+    rtcm_router_diff_age(inst->id, UINT32_MAX);
     break;
-  case GPS_PROTOCOL_RTCM:
-    if(config->lora_mode == LORA_MODE_BASE)
-    {
-      if(gps->nmea_data.gga.fix == GPS_FIX_MANUAL_POS)
-      {
-        rtcm_send_to_lora(gps);
-      }
-      else if(config->board == BOARD_TYPE_BASE_F9P && gps->nmea_data.gga.hdop>=99.0)
-      {
-        rtcm_send_to_lora(gps);
-      }
-    }
+  case GPS_FIX_DGPS:
+  case GPS_FIX_RTK_FIX:
+  case GPS_FIX_RTK_FLOAT:
+    rtcm_router_diff_age(inst->id, age_ms);
     break;
-
   default:
     break;
   }
 }
 
-static void gps_tx_task(void *pvParameter) {
+#if defined(USE_GPS_UBLOX)
+static void gps_on_ubx_sos(gps_t *gps, gps_procotol_t protocol, gps_msg_t msg,
+                           void *ctx) {
+  gps_on_sos_result(ctx, &gps->ubx_data.sos);
+}
+
+/**
+ * @brief 수신기가 보정 메시지를 받을 때마다 (RXM-RTCM) 라우터에 결과 전달
+ */
+static void gps_on_ubx_rxm_rtcm(gps_t *gps, gps_procotol_t protocol,
+                                gps_msg_t msg, void *ctx) {
+  gps_instance_t *inst = ctx;
+  const gps_ubx_rxm_rtcm_t *r = &gps->ubx_data.rxm_rtcm;
+  rtcm_engine_result_t res = RTCM_ENGINE_UNKNOWN;
+
+  if (r->flags & UBX_RTCM_FLAG_CRC_FAILED) {
+    res = RTCM_ENGINE_CRC_ERR;
+  } else if (UBX_RTCM_USED(r->flags) == UBX_RTCM_USED_YES) {
+    res = RTCM_ENGINE_USED;
+  } else if (UBX_RTCM_USED(r->flags) == UBX_RTCM_USED_NO) {
+    res = RTCM_ENGINE_UNUSED;
+  }
+  rtcm_router_engine_feedback(inst->id, r->msg_type, r->ref_station, res);
+}
+
+static void gps_on_ubx_mon_comms(gps_t *gps, gps_procotol_t protocol,
+                                 gps_msg_t msg, void *ctx) {
+  gps_instance_t *inst = ctx;
+
+  taskENTER_CRITICAL();
+  inst->comms = gps->ubx_data.mon_comms;
+  inst->comms_tick = xTaskGetTickCount();
+  taskEXIT_CRITICAL();
+}
+
+/* NAV-PVT flags3 lastCorrectionAge (bit 1~4) 구간의 상한 [ms], 0 은 정보 없음 */
+static const uint32_t ubx_corr_age_ms[16] = {
+    0, 1000, 2000, 5000, 10000, 15000, 20000, 30000, 45000, 60000, 90000, 120000,
+    UINT32_MAX - 1, UINT32_MAX - 1, UINT32_MAX - 1, UINT32_MAX - 1,
+};
+
+static void gps_on_ubx_pvt(gps_t *gps, gps_procotol_t protocol, gps_msg_t msg,
+                           void *ctx) {
+  gps_instance_t *inst = ctx;
+
+  // NMEA 없이도 fix 변화를 알 수 있게, 위치 알림은 HPPOSLLH 가 없을 때만
+  gps_check_fix_changed(inst, gps->nav.data.fix);
+  gps_report_diff_age(inst, ubx_corr_age_ms[(gps->ubx_data.pvt.flags3 >> 1) & 0x0F]);
+
+  if ((gps->ubx_data.pvt.valid & 0x05) == 0x05) { // validDate, fullyResolved
+    gps_utc_date = gps->ubx_data.pvt.year * 10000U + gps->ubx_data.pvt.month * 100U +
+                   gps->ubx_data.pvt.day;
+  }
+
+  if (!inst->hpposllh_seen) {
+    gps_on_new_solution(inst);
+  }
+}
+
+static void gps_on_ubx_relposned(gps_t *gps, gps_procotol_t protocol,
+                                 gps_msg_t msg, void *ctx) {
+  gps_fuse_add_heading(gps->ubx_data.relposned.tow, gps->nav.data.heading);
+}
+
+static void gps_on_ubx_hpposllh(gps_t *gps, gps_procotol_t protocol,
+                                gps_msg_t msg, void *ctx) {
+  gps_instance_t *inst = ctx;
+
+  inst->hpposllh_seen = true;
+  gps_on_new_solution(inst);
+
+  if (inst->last_fix == GPS_FIX_RTK_FIX) {
+    // _add_hp_avg_data(inst);
+    const gps_ubx_nav_hpposllh_t *hp = &gps->ubx_data.hpposllh;
+    gps_publish_rtk_sample(gps_llh_from_ubx_deg(hp->lat, hp->lat_hp),
+                           gps_llh_from_ubx_deg(hp->lon, hp->lon_hp),
+                           gps_llh_from_ubx_alt(hp->height, hp->height_hp),
+                           hp->hacc * 1e-4f, hp->vacc * 1e-4f);
+  }
+}
+#endif
+
+#if defined(USE_GPS_UNICORE)
+static void gps_on_unicore_resp(gps_t *gps, gps_procotol_t protocol,
+                                gps_msg_t msg, void *ctx) {
+  gps_instance_t *inst = ctx;
+
+  if (inst->init_seq.active) {
+    gps_init_seq_on_response(inst, gps_get_unicore_echo(gps),
+                             gps_get_unicore_response(gps));
+  } else if (inst->current_cmd_req != NULL) {
+    gps_unicore_resp_t resp = gps_get_unicore_response(gps);
+    if (resp == GPS_UNICORE_RESP_OK) {
+      if (inst->current_cmd_req->is_async) {
+        inst->current_cmd_req->async_result = true;
+      } else {
+        *(inst->current_cmd_req->result) = true;
+      }
+      xTaskNotifyGive(inst->tx_task);
+    } else if (resp == GPS_UNICORE_RESP_ERROR || resp == GPS_UNICORE_RESP_UNKNOWN) {
+      if (inst->current_cmd_req->is_async) {
+        inst->current_cmd_req->async_result = false;
+      } else {
+        *(inst->current_cmd_req->result) = false;
+      }
+      xTaskNotifyGive(inst->tx_task);
+    }
+  }
+}
+
+static void gps_on_unicore_bestnav(gps_t *gps, gps_procotol_t protocol,
+                                   gps_msg_t msg, void *ctx) {
+  gps_instance_t *inst = ctx;
+
+  // NMEA 를 끈 경우에도 fix 변화를 알 수 있게 binary 해의 fix 로
+  gps_check_fix_changed(inst, gps->nav.data.fix);
+  gps_on_new_solution(inst);
+  gps_report_diff_age(inst, (uint32_t)(gps->unicore_bin_data.bestnav.diff_age * 1000.0f));
+
+  if (inst->last_fix == GPS_FIX_RTK_FIX)
+  {
+    hpd_unicore_bestnavb_t *bestnav = &gps->unicore_bin_data.bestnav;
+    float h_acc = sqrtf(bestnav->lat_dev * bestnav->lat_dev +
+                        bestnav->lon_dev * bestnav->lon_dev);
+    gps_publish_rtk_sample(gps_llh_deg_from_double(bestnav->lat),
+                           gps_llh_deg_from_double(bestnav->lon),
+                           gps_llh_alt_from_double(bestnav->height),
+                           h_acc, bestnav->height_dev);
+  }
+}
+#endif
+
+static void gps_on_rtcm(gps_t *gps, gps_procotol_t protocol, gps_msg_t msg,
+                        void *ctx) {
+  bool synthetic = rtcm_loadgen_injecting();
+
+  // LoRa 로 보내는 보정은 시간이 중요하고 RX 태스크 전용 상태를 써서 직접 처리
+  if(BOARD_LORA_IS(LORA_MODE_BASE))
+  {
+    TRACE_MARK_START(TRACE_MARK_RTCM_LORA);
+    if(synthetic)
+    {
+      rtcm_send_to_lora(gps);
+    }
+    else if(rtcm_loadgen_active())
+    {
+      // 부하 시험 중에는 수신기 보정을 LoRa 로 보내지 않음
+    }
+    else if(gps->nmea_data.gga.fix == GPS_FIX_MANUAL_POS)
+    {
+      rtcm_send_to_lora(gps);
+    }
+    else if(BOARD_IS(BOARD_TYPE_BASE_F9P) && gps->nmea_data.gga.hdop>=99.0)
+    {
+      rtcm_send_to_lora(gps);
+    }
+    TRACE_MARK_STOP(TRACE_MARK_RTCM_LORA);
+  }
+  if(!synthetic)
+  {
+    gps_publish_rtcm(ctx, gps);
+  }
+}
+
+/**
+ * @brief 인스턴스가 쓰는 메시지 구독 등록 (수신 태스크 시작 시)
+ */
+static void gps_subscribe_msgs(gps_instance_t *inst) {
+  gps_t *gps = &inst->gps;
+
+  gps_subscribe(gps, GPS_PROTOCOL_NMEA, GPS_NMEA_MSG_GGA, gps_on_nmea_gga, inst);
+#if defined(USE_GPS_UBLOX)
+  gps_subscribe(gps, GPS_PROTOCOL_UBX,
+                GPS_UBX_KEY(GPS_UBX_CLASS_UPD, GPS_UBX_UPD_ID_SOS),
+                gps_on_ubx_sos, inst);
+  gps_subscribe(gps, GPS_PROTOCOL_UBX,
+                GPS_UBX_KEY(GPS_UBX_CLASS_NAV, GPS_UBX_NAV_ID_PVT),
+                gps_on_ubx_pvt, inst);
+  gps_subscribe(gps, GPS_PROTOCOL_UBX,
+                GPS_UBX_KEY(GPS_UBX_CLASS_NAV, GPS_UBX_NAV_ID_HPPOSLLH),
+                gps_on_ubx_hpposllh, inst);
+  gps_subscribe(gps, GPS_PROTOCOL_UBX,
+                GPS_UBX_KEY(GPS_UBX_CLASS_RXM, GPS_UBX_RXM_ID_RTCM),
+                gps_on_ubx_rxm_rtcm, inst);
+  gps_subscribe(gps, GPS_PROTOCOL_UBX,
+                GPS_UBX_KEY(GPS_UBX_CLASS_MON, GPS_UBX_MON_ID_COMMS),
+                gps_on_ubx_mon_comms, inst);
+  if (BOARD_IS(BOARD_TYPE_ROVER_F9P) && inst->id == GPS_ID_ROVER) {
+    gps_subscribe(gps, GPS_PROTOCOL_UBX,
+                  GPS_UBX_KEY(GPS_UBX_CLASS_NAV, GPS_UBX_NAV_ID_RELPOSNED),
+                  gps_on_ubx_relposned, inst);
+  }
+#endif
+#if defined(USE_GPS_UNICORE)
+  gps_subscribe(gps, GPS_PROTOCOL_UNICORE, GPS_SUB_ANY, gps_on_unicore_resp, inst);
+  gps_subscribe(gps, GPS_PROTOCOL_UNICORE_BIN, GPS_UNICORE_BIN_MSG_BESTNAV,
+                gps_on_unicore_bestnav, inst);
+  gps_subscribe(gps, GPS_PROTOCOL_UNICORE_BIN, GPS_UNICORE_BIN_MSG_ADRNAV,
+                gps_on_unicore_bestnav, inst);
+#endif
+  // 다리가 먼저 (heading 지연), 그 뒤 이벤트 발행
+  gps_mb_bridge_attach(gps, inst->id);
+  gps_subscribe(gps, GPS_PROTOCOL_RTCM, GPS_SUB_ANY, gps_on_rtcm, inst);
+  gps_tee_attach(gps, inst->id);
+}
+
+static void gps_tx_task(void *pvParameter) {
   gps_id_t id = (gps_id_t)(uintptr_t)pvParameter;
   gps_instance_t *inst = &gps_instances[id];
   gps_cmd_request_t cmd_req;
@@ -648,7 +1191,19 @@ static void gps_tx_task(void *pvParameter) {
 
   while (1) {
     if (xQueueReceive(inst->cmd_queue, &cmd_req, portMAX_DELAY) == pdTRUE) {
-      LOG_INFO("GPS[%d] Sending command: %s", id, cmd_req.cmd);
+      // 빈 명령은 초기화 파이프라인 시작 요청
+      if (cmd_req.cmd == NULL) {
+        // 응답 타임아웃이 빠듯하니 그 동안 flash 쓰기는 미룸
+        flash_params_hold();
+        gps_init_seq_run(id, inst);
+        flash_params_release();
+        continue;
+      }
+
+      LOG_INFO("GPS[%d] Sending command: %s", id, cmd_req.cmd->data);
+
+      // 이전 명령의 늦은 응답 notification 제거
+      ulTaskNotifyTake(pdTRUE, 0);
 
       // 현재 명령어 요청 저장 (RX Task에서 응답 처리용)
       inst->current_cmd_req = &cmd_req;
@@ -660,9 +1215,14 @@ static void gps_tx_task(void *pvParameter) {
 
       // 명령어 전송
       if (inst->gps.ops && inst->gps.ops->send) {
-        xSemaphoreTake(inst->gps.mutex, pdMS_TO_TICKS(1000));
-        inst->gps.ops->send(cmd_req.cmd, strlen(cmd_req.cmd));
-        xSemaphoreGive(inst->gps.mutex);
+        // 기다리는 호출자가 있는 동기 명령만 보정 프레임 사이로 끼어든다
+        uart_tx_prio_t prio =
+            cmd_req.is_async ? UART_TX_PRIO_NORMAL : UART_TX_PRIO_URGENT;
+
+        if (!gps_tx_frame(inst, cmd_req.cmd->data, cmd_req.cmd->len, prio,
+                          pdMS_TO_TICKS(1000))) {
+          LOG_ERR("GPS[%d] TX 잠금 타임아웃", id);
+        }
       } else {
         LOG_ERR("GPS[%d] send ops not available", id);
         inst->current_cmd_req = NULL;
@@ -671,18 +1231,18 @@ static void gps_tx_task(void *pvParameter) {
           if (cmd_req.callback) {
             cmd_req.callback(false, cmd_req.user_data);
           }
-          vSemaphoreDelete(cmd_req.response_sem);
         } else {
           *(cmd_req.result) = false;
           xSemaphoreGive(cmd_req.response_sem);
         }
         inst->current_cmd_req = NULL;
+        tx_buf_free(cmd_req.cmd);
         continue;
       }
 
       // 응답 대기 (타임아웃 적용)
-      if (xSemaphoreTake(cmd_req.response_sem, pdMS_TO_TICKS(cmd_req.timeout_ms)) == pdTRUE) {
-        // 응답 수신 완료 (RX Task가 세마포어를 줌)
+      if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(cmd_req.timeout_ms)) != 0) {
+        // 응답 수신 완료 (RX Task가 notification 을 줌)
         if (cmd_req.is_async) {
           LOG_INFO("GPS[%d] Response received: %s", id,
                    cmd_req.async_result ? "OK" : "ERROR");
@@ -692,6 +1252,7 @@ static void gps_tx_task(void *pvParameter) {
         }
       } else {
         LOG_WARN("GPS[%d] Command timeout", id);
+        pm_trace(PM_EVT_GPS_CMD_TMO, id, 0);
         if (cmd_req.is_async) {
           cmd_req.async_result = false;
         } else {
@@ -701,15 +1262,13 @@ static void gps_tx_task(void *pvParameter) {
 
       // 현재 명령어 요청 초기화
       inst->current_cmd_req = NULL;
+      tx_buf_free(cmd_req.cmd);
 
       // 비동기: 콜백 호출
       if (cmd_req.is_async) {
         if (cmd_req.callback) {
           cmd_req.callback(cmd_req.async_result, cmd_req.user_data);
         }
-
-        // 비동기는 세마포어를 TX Task에서 삭제
-        vSemaphoreDelete(cmd_req.response_sem);
       } else {
         // 동기: 외부 호출자에게 처리 완료 알림 (세마포어 반환)
         xSemaphoreGive(cmd_req.response_sem);
@@ -742,24 +1301,118 @@ void base_station_cb(bool success, size_t failed_step, void *user_data)
 }
 
 
+/**
+ * @brief fix 상태에 따른 상태 LED 색상
+ *
+ * base : quality 0,1,2 -> red, 4,5 -> yellow, 7 -> green, etc -> none
+ * rover : quality 0,1,2 -> red, 5 -> yellow, 4 -> green, etc -> none
+ */
+static led_color_t gps_led_color(const board_config_t *config,
+                                 const gps_nav_data_t *nav) {
+  if (config->board == BOARD_TYPE_BASE_F9P && nav->hdop >= 99.0) {
+    return LED_COLOR_GREEN;
+  }
+
+  switch (nav->fix) {
+  case GPS_FIX_RTK_FLOAT:
+    return LED_COLOR_YELLOW;
+  case GPS_FIX_RTK_FIX:
+    if (config->board == BOARD_TYPE_BASE_F9P ||
+        config->board == BOARD_TYPE_BASE_UM982) {
+      return LED_COLOR_YELLOW;
+    }
+    return LED_COLOR_GREEN;
+  case GPS_FIX_MANUAL_POS:
+    return LED_COLOR_GREEN;
+  default:
+    return nav->fix <= GPS_FIX_DGPS ? LED_COLOR_RED : LED_COLOR_NONE;
+  }
+}
+
+/**
+ * @brief 상태 LED 주기 갱신 (timer 서비스 태스크)
+ *
+ * 수신 경로에서 LED/보드 설정 조회를 빼기 위해 주기적으로 GGA 를 보고
+ * 색상을 정한다. 주기 동안 수신이 있을 때만 토글해서 데이터가 끊기면
+ * 깜빡임이 멈춘다.
+ */
+static void gps_led_timer_callback(TimerHandle_t timer) {
+  (void)timer;
+  gps_instance_t *inst = &gps_instances[GPS_ID_BASE];
+
+  if (!inst->enabled || !inst->rx_activity) {
+    return;
+  }
+  inst->rx_activity = false;
+
+  // 타이머 콜백은 블록하면 안 되므로 갱신 중이면 다음 주기에 처리
+  gps_nav_data_t nav;
+  if (!gps_nav_read(&inst->gps, &nav)) {
+    return;
+  }
+
+  led_set_color(GPS_LED_ID, gps_led_color(board_get_config(), &nav));
+  led_set_toggle(GPS_LED_ID);
+}
+
+/**
+ * @brief 저장한 base 수동 위치를 수신기에 다시 설정 (base RX 태스크)
+ */
+static void gps_base_pos_apply(gps_instance_t *inst) {
+  LOG_INFO("GPS[%d] Base 위치 변경, 다시 설정", inst->id);
+#if defined(BOARD_TYPE_BASE_UBLOX)
+  const user_params_t *params = flash_params_snapshot(NULL);
+
+  ubx_set_fixed_position_async(&inst->gps, params->lat, params->lon, params->alt,
+                               base_station_cb, NULL);
+#elif defined(BOARD_TYPE_BASE_UNICORE)
+  gps_configure_um982_base_mode_async(inst->id, basestation_init_complete,
+                                      (void *)(uintptr_t)inst->id);
+#else
+  (void)inst;
+#endif
+}
+
+/**
+ * @brief base 수동 위치 저장 (flash_params_watch, 게시한 태스크)
+ *
+ * 켜져 있으면 base RX 태스크가 초기화 뒤에 다시 설정한다 (초기화 전이면 초기화가
+ * 새 값을 읽음). 수동 위치를 끄는 것은 재부팅에 맡긴다.
+ */
+static bool gps_base_pos_changed(const user_params_t *params, void *ctx) {
+  TaskHandle_t task = gps_instances[GPS_ID_BASE].task;
+
+  (void)ctx;
+
+  if (!params->use_manual_position) {
+    return false;
+  }
+
+  gps_base_pos_dirty = true;
+  if (task) {
+    xTaskNotifyGive(task);
+  }
+  return true;
+}
+
 static void gps_process_task(void *pvParameter) {
   gps_id_t id = (gps_id_t)(uintptr_t)pvParameter;
   gps_instance_t *inst = &gps_instances[id];
 
-  size_t pos = 0;
-  size_t old_pos = 0;
-  uint8_t dummy = 0;
-  size_t total_received = 0;
+  dma_ring_t ring; // count 는 gps_port_get_rx_count()
 
-  gps_set_evt_handler(&inst->gps, gps_evt_handler);
+  dma_ring_init(&ring, gps_port_get_recv_buf(id), gps_port_get_rx_size(id), 0, 0);
+  gps_subscribe_msgs(inst);
   memset(&inst->gga_avg_data, 0, sizeof(inst->gga_avg_data));
+#if defined(USE_GPS_UBLOX)
   memset(&inst->ubx_hp_avg, 0, sizeof(ubx_hp_avg_data_t));
+#endif
 
   bool use_led = (id == GPS_ID_BASE ? 1 : 0);
 
   if (use_led) {
-    led_set_color(2, LED_COLOR_RED);
-    led_set_state(2, true);
+    led_set_color(GPS_LED_ID, LED_COLOR_RED);
+    led_set_state(GPS_LED_ID, true);
   }
 
   vTaskDelay(pdMS_TO_TICKS(500));
@@ -782,20 +1435,30 @@ static void gps_process_task(void *pvParameter) {
     ubx_rover_init(&inst->gps);
   }
 #endif
+#if defined(USE_GPS_UBLOX)
   bool init_done = false;
-  const board_config_t *config = board_get_config();
-  
+#endif
+
   while (1) {
+#if defined(USE_GPS_UBLOX)
+    gps_power_fail_process(inst);
+    ubx_cmd_poll(&inst->gps); // 응답 없는 UBX 명령 타임아웃 콜백
     ubx_init_async_process(&inst->gps);
 
     if (!init_done) {
             ubx_init_state_t state = ubx_init_async_get_state(&inst->gps);
             if (state == UBX_INIT_STATE_DONE) {
                 printf("✓ UBX initialization completed!\n");
+                boot_timeline_mark(BOOT_MARK_GPS_CONFIG);
+
+                // 지난 정전 때 백업한 항법 데이터가 복원됐는지 확인
+                ubx_sos_poll(&inst->gps);
                 
-                if(config->board == BOARD_TYPE_BASE_F9P)
+                if(BOARD_IS(BOARD_TYPE_BASE_F9P))
                 {
-                  user_params_t* params = flash_params_get_current();
+                  gps_base_pos_dirty = false;
+                  gps_base_ready = true;
+                  const user_params_t* params = flash_params_snapshot(NULL);
                   if(params->use_manual_position)
                   {
                     ubx_set_fixed_position_async(&inst->gps, params->lat, params->lon,
@@ -812,79 +1475,63 @@ static void gps_process_task(void *pvParameter) {
                 init_done = true;
             }
     }
+#endif
 
-    xQueueReceive(inst->queue, &dummy,
-                  portMAX_DELAY);
-
-    // base : quality 0,1,2 -> red, 4,5 -> yellow, 7 -> green, etc -> none
-    // rover : quality 0,1,2 -> red, 5 -> yellow, 4 -> green, etc -> none
-          	if(config->board == BOARD_TYPE_BASE_F9P && inst->gps.nmea_data.gga.hdop>=99.0)
-    	          {
-    	              led_set_color(2, LED_COLOR_GREEN);
-    	    	   }
-    else if (inst->gps.nmea_data.gga.fix <= GPS_FIX_DGPS) {
-      if (use_led) {
-        led_set_color(2, LED_COLOR_RED);
-      }
-    } else if (inst->gps.nmea_data.gga.fix == GPS_FIX_RTK_FLOAT) {
-      if (use_led) {
-        led_set_color(2, LED_COLOR_YELLOW);
-      }
-    } else if (inst->gps.nmea_data.gga.fix ==  GPS_FIX_RTK_FIX) {
-      if (use_led) {
-        if(config->board == BOARD_TYPE_ROVER_F9P || config->board == BOARD_TYPE_ROVER_UM982)
-        {
-            led_set_color(2, LED_COLOR_GREEN);
-        }
-        else if(config->board == BOARD_TYPE_BASE_F9P || config->board == BOARD_TYPE_BASE_UM982)
-        {
-            led_set_color(2, LED_COLOR_YELLOW);
-        }
-      }
-    } else if(inst->gps.nmea_data.gga.fix == GPS_FIX_MANUAL_POS)
-    {
-      if (use_led) {
-        led_set_color(2, LED_COLOR_GREEN);
-      }
+    if (id == GPS_ID_BASE && gps_base_ready && gps_base_pos_dirty) {
+      gps_base_pos_dirty = false;
+      gps_base_pos_apply(inst);
     }
-    else {
-      if (use_led) {
-        led_set_color(2, LED_COLOR_NONE);
+
+    // UART IDLE 또는 DMA HT/TC ISR의 notification 대기
+    // (기준국은 RTCM epoch 묶음 타임아웃까지만)
+    TickType_t wait = portMAX_DELAY;
+    if (BOARD_LORA_IS(LORA_MODE_BASE)) {
+      wait = rtcm_epoch_poll();
+
+      TickType_t gen = rtcm_loadgen_wait();
+      if (gen < wait) {
+        wait = gen;
       }
     }
+    ulTaskNotifyTake(pdTRUE, wait);
+    irq_lat_task((irq_lat_port_t)(IRQ_LAT_GPS1 + id));
+
+    xSemaphoreTake(inst->gps.mutex, portMAX_DELAY);
+    uint32_t lost;
+    uint32_t pending = dma_ring_update(&ring, gps_port_get_rx_count(id), &lost);
+
+    // peak 가 size 면 한 번 이상 overrun
+    mem_wm_update(&inst->rx_wm, pending + lost < ring.size ? pending + lost : ring.size);
 
-    if (use_led) {
-      led_set_toggle(2);
+    if (lost) {
+      LOG_WARN("[%d] RX ring overrun, %lu bytes lost", id, lost);
+      gps_parse_overrun(&inst->gps, lost);
     }
 
-    xSemaphoreTake(inst->gps.mutex, portMAX_DELAY);
-    pos = gps_port_get_rx_pos(id);
-    char *gps_recv = gps_port_get_recv_buf(id);
-
-    if (pos != old_pos) {
-      if (pos > old_pos) {
-        size_t len = pos - old_pos;
-        total_received = len;
-        LOG_DEBUG("[%d] %d received", id, (int)len);
-        LOG_DEBUG_RAW("RAW: ", &gps_recv[old_pos], len);
-        gps_parse_process(&inst->gps, &gps_recv[old_pos], pos - old_pos);
-      } else {
-        size_t len1 = GPS_UART_MAX_RECV_SIZE - old_pos;
-        size_t len2 = pos;
-        total_received = len1 + len2;
-        LOG_DEBUG("[%d] %d received (wrap around)", id, (int)(len1 + len2));
-        LOG_DEBUG_RAW("RAW: ", &gps_recv[old_pos], len1);
-        gps_parse_process(&inst->gps, &gps_recv[old_pos],
-                          GPS_UART_MAX_RECV_SIZE - old_pos);
-        if (pos > 0) {
-          LOG_DEBUG_RAW("RAW: ", gps_recv, len2);
-          gps_parse_process(&inst->gps, gps_recv, pos);
-        }
-      }
-      old_pos = pos;
-      if (old_pos == GPS_UART_MAX_RECV_SIZE) {
-        old_pos = 0;
+    if (pending > 0) {
+      dma_ring_span_t span[2];
+      uint8_t n = dma_ring_spans(&ring, span);
+      size_t from = ring.tail;
+      size_t to = (ring.tail + pending) % ring.size;
+
+      LOG_DEBUG("[%d] %lu received", id, pending);
+      for (uint8_t i = 0; i < n; i++) {
+        LOG_DEBUG_RAW("RAW: ", span[i].p, span[i].len);
       }
+
+      // 링에서 바로 파싱 (핸들러는 gps_get_frame()으로 프레임을 복사 없이 참조)
+      inst->parse_count = ring.consumed;
+      inst->parse_from = from;
+      TRACE_MARK_START(TRACE_MARK_GPS_PARSE);
+      gps_parse_ring(&inst->gps, ring.buf, ring.size, from, to);
+      TRACE_MARK_STOP(TRACE_MARK_GPS_PARSE);
+      gps_tee_raw(id, (const char *)ring.buf, ring.size, from, to);
+      inst->rx_activity = true;
+      inst->rx_parsed += pending;
+      dma_ring_consume(&ring, pending);
+    }
+    if (BOARD_LORA_IS(LORA_MODE_BASE)) {
+      rtcm_loadgen_poll(&inst->gps);
     }
     xSemaphoreGive(inst->gps.mutex);
   }
@@ -927,56 +1574,69 @@ void gps_init_all(void) {
       continue;
     }
 
-    gps_instances[i].queue = xQueueCreate(10, sizeof(uint8_t));
-    if (gps_instances[i].queue == NULL) {
-      LOG_ERR("GPS[%d] 큐 생성 실패", i);
-      gps_instances[i].enabled = false;
-      continue;
-    }
-
-    gps_port_set_queue((gps_id_t)i, gps_instances[i].queue);
+    gps_instances[i].cmd_queue = mem_wm_register_queue(
+        xQueueCreateStatic(GPS_CMD_QUEUE_LEN, sizeof(gps_cmd_request_t),
+                           gps_cmd_queue_storage[i], &gps_cmd_queue_qcb[i]),
+        gps_cmd_wm_names[i]);
 
-    gps_instances[i].cmd_queue = xQueueCreate(5, sizeof(gps_cmd_request_t));
-    if (gps_instances[i].cmd_queue == NULL) {
-      LOG_ERR("GPS[%d] TX 큐 생성 실패", i);
-      gps_instances[i].enabled = false;
-      continue;
-    }
+    gps_instances[i].rx_wm.name = gps_rx_wm_names[i];
+    gps_instances[i].rx_wm.size = gps_port_get_rx_size((gps_id_t)i);
+    mem_wm_register(&gps_instances[i].rx_wm);
 
     gps_port_start(&gps_instances[i].gps);
 
     char task_name[16];
     snprintf(task_name, sizeof(task_name), "gps_rx_%d", i);
 
-    BaseType_t ret =
-        xTaskCreate(gps_process_task, task_name, 1024,
-                    (void *)(uintptr_t)i, // GPS ID
-                    tskIDLE_PRIORITY + 1, &gps_instances[i].task);
+    gps_instances[i].task =
+        xTaskCreateStatic(gps_process_task, task_name, GPS_RX_STACK_WORDS,
+                          (void *)(uintptr_t)i, // GPS ID
+                          tskIDLE_PRIORITY + 1, gps_rx_stack[i], &gps_rx_tcb[i]);
 
-    if (ret != pdPASS) {
-      LOG_ERR("GPS[%d] RX 태스크 생성 실패", i);
-      gps_instances[i].enabled = false;
-      continue;
+    gps_port_set_task((gps_id_t)i, gps_instances[i].task);
+
+    if (i == GPS_ID_BASE) {
+      if (BOARD_IS(BOARD_TYPE_ROVER_F9P)) {
+        gps_fuse_init();
+      }
+      pos_out_register(&gps_gga_sink);
+      if (gps_led_timer == NULL) {
+        gps_led_timer = xTimerCreate("gps_led", pdMS_TO_TICKS(GPS_LED_PERIOD_MS),
+                                     pdTRUE, NULL, gps_led_timer_callback);
+      }
+      if (gps_led_timer == NULL) {
+        LOG_ERR("GPS LED 타이머 생성 실패");
+      } else {
+        xTimerStart(gps_led_timer, 0);
+      }
     }
 
     snprintf(task_name, sizeof(task_name), "gps_tx_%d", i);
-    ret = xTaskCreate(gps_tx_task, task_name, 512,
-                      (void *)(uintptr_t)i, // GPS ID를 파라미터로 전달
-                      tskIDLE_PRIORITY + 1, &gps_instances[i].tx_task);
-
-    if (ret != pdPASS) {
-      LOG_ERR("GPS[%d] TX 태스크 생성 실패", i);
-      gps_instances[i].enabled = false;
-      continue;
-    }
+    gps_instances[i].tx_task =
+        xTaskCreateStatic(gps_tx_task, task_name, GPS_TX_STACK_WORDS,
+                          (void *)(uintptr_t)i, // GPS ID를 파라미터로 전달
+                          tskIDLE_PRIORITY + 1, gps_tx_stack[i], &gps_tx_tcb[i]);
 
     LOG_INFO("GPS[%d] 인스턴스 초기화 완료", i);
 
   }
 
   LOG_INFO("GPS 전체 인스턴스 초기화 완료");
+  boot_timeline_mark(BOOT_MARK_GPS_INIT);
+#if defined(USE_GPS_UBLOX)
+  adc_power_fail_start(GPS_POWER_FAIL_ADC_LOW, GPS_POWER_FAIL_ADC_HIGH, gps_power_fail_isr);
+#endif
   if (config->board == BOARD_TYPE_BASE_F9P || config->board == BOARD_TYPE_BASE_UM982) {
-    user_params_t *params = flash_params_get_current();
+    static bool base_pos_watched;
+    const user_params_t *params = flash_params_snapshot(NULL);
+
+    if (!base_pos_watched) {
+      flash_params_watch(FLASH_PARAMS_FIELD(use_manual_position), gps_base_pos_changed, NULL);
+      flash_params_watch(FLASH_PARAMS_FIELD(lat), gps_base_pos_changed, NULL);
+      flash_params_watch(FLASH_PARAMS_FIELD(lon), gps_base_pos_changed, NULL);
+      flash_params_watch(FLASH_PARAMS_FIELD(alt), gps_base_pos_changed, NULL);
+      base_pos_watched = true;
+    }
     if (params->base_auto_fix_enabled) {
       LOG_INFO("Base Auto-Fix 모드 활성화");
 
@@ -1042,6 +1702,147 @@ bool gps_get_gga_avg(gps_id_t id, double *lat, double *lon, double *alt) {
   return true;
 }
 
+/**
+ * @brief 최신 항법 해 스냅샷 가져오기 (lock/critical section 없음)
+ *
+ * 파서가 쓰는 도중이면 한 tick 양보한 뒤 다시 읽는다. 쓰기 구간은 짧아서
+ * 보통 첫 시도에 성공한다.
+ *
+ * @param id GPS ID
+ * @param nav 출력
+ * @return true: 성공, false: 비활성 인스턴스 또는 재시도 초과
+ */
+bool gps_get_nav(gps_id_t id, gps_nav_data_t *nav) {
+  if (id >= GPS_ID_MAX || !gps_instances[id].enabled || !nav) {
+    return false;
+  }
+
+  for (uint8_t retry = 0; retry < GPS_NAV_READ_RETRY; retry++) {
+    if (gps_nav_read(&gps_instances[id].gps, nav)) {
+      return true;
+    }
+    // 우선순위가 낮은 RX 태스크가 쓰다가 선점된 경우 끝낼 수 있게 양보
+    vTaskDelay(1);
+  }
+
+  return false;
+}
+
+#if defined(USE_GPS_UBLOX)
+static const char *gps_comms_port_name(uint16_t port_id) {
+  switch (port_id) {
+  case UBX_MON_COMMS_PORT_I2C:
+    return "I2C";
+  case UBX_MON_COMMS_PORT_UART1:
+    return "UART1";
+  case UBX_MON_COMMS_PORT_UART2:
+    return "UART2";
+  case UBX_MON_COMMS_PORT_USB:
+    return "USB";
+  case UBX_MON_COMMS_PORT_SPI:
+    return "SPI";
+  default:
+    return "?";
+  }
+}
+#endif
+
+/**
+ * @brief 수신기 포트 상태 응답 문자열 (UBX-MON-COMMS, 받은 GPS 마다)
+ *
+ * +RXC,<gps>,age=<ms>,txerr=<flags>
+ * +RXC,<gps>,<포트>,tx=<사용률>/<최대>,<대기 byte>,rx=<사용률>/<최대>,<대기 byte>,
+ *      ovr=<overrun 구간>,skip=<버린 byte>
+ * 사용률은 %. tx 사용률이 100 에 닿으면 수신기가 출력을 버리고 있는 것이다.
+ * moving base 다리가 있으면 +MBB,fwd=<프레임>,bytes=<byte>,drop=<버린 프레임> 도.
+ *
+ * @return size_t 문자열 길이 (0 이면 버퍼 부족)
+ */
+size_t gps_format_rx_comms(char *buf, size_t size) {
+  size_t pos = 0;
+  int n;
+
+#if defined(USE_GPS_UBLOX)
+  for (int i = 0; i < GPS_ID_MAX; i++) {
+    gps_instance_t *inst = &gps_instances[i];
+    gps_ubx_mon_comms_t mc;
+    TickType_t tick;
+
+    if (!inst->enabled) {
+      continue;
+    }
+    taskENTER_CRITICAL();
+    mc = inst->comms;
+    tick = inst->comms_tick;
+    taskEXIT_CRITICAL();
+    if (tick == 0) {
+      continue;
+    }
+
+    n = snprintf(&buf[pos], size - pos, "+RXC,%d,age=%lu,txerr=%u\n\r", i,
+                 (uint32_t)((xTaskGetTickCount() - tick) * portTICK_PERIOD_MS),
+                 mc.tx_errors);
+    if (n < 0 || (size_t)n >= size - pos) {
+      return 0;
+    }
+    pos += n;
+
+    for (int k = 0; k < mc.n_ports; k++) {
+      const gps_ubx_mon_comms_port_t *p = &mc.port[k];
+
+      n = snprintf(&buf[pos], size - pos,
+                   "+RXC,%d,%s,tx=%u/%u,%u,rx=%u/%u,%u,ovr=%u,skip=%lu\n\r", i,
+                   gps_comms_port_name(p->port_id), p->tx_usage,
+                   p->tx_peak_usage, p->tx_pending, p->rx_usage,
+                   p->rx_peak_usage, p->rx_pending, p->overrun_errs,
+                   p->skipped);
+      if (n < 0 || (size_t)n >= size - pos) {
+        return 0;
+      }
+      pos += n;
+    }
+  }
+#endif
+
+  if (gps_mb_bridge_active()) {
+    gps_mb_bridge_stats_t mb;
+
+    gps_mb_bridge_get_stats(&mb);
+    n = snprintf(&buf[pos], size - pos, "+MBB,fwd=%lu,bytes=%lu,drop=%lu\n\r",
+                 (unsigned long)mb.frames, (unsigned long)mb.bytes,
+                 (unsigned long)mb.dropped);
+    if (n < 0 || (size_t)n >= size - pos) {
+      return 0;
+    }
+    pos += n;
+  }
+
+  if (pos == 0) {
+    n = snprintf(buf, size, "+RXC,none\n\r");
+    if (n < 0 || (size_t)n >= size) {
+      return 0;
+    }
+    pos = n;
+  }
+
+  return pos;
+}
+
+/**
+ * @brief 명령 문자열을 풀 버퍼로 (NUL 포함 복사, len 은 NUL 제외)
+ *
+ * @return tx_buf_t* 너무 길거나 풀이 비었으면 NULL
+ */
+static tx_buf_t *gps_cmd_buf(const char *cmd) {
+  size_t len = strlen(cmd);
+  tx_buf_t *buf = tx_buf_dup(cmd, len + 1, pdMS_TO_TICKS(1000));
+
+  if (buf) {
+    buf->len = len;
+  }
+  return buf;
+}
+
 bool gps_send_command_sync(gps_id_t id, const char *cmd, uint32_t timeout_ms) {
   if (id >= GPS_ID_MAX || !gps_instances[id].enabled) {
     LOG_ERR("GPS[%d] invalid or disabled", id);
@@ -1056,7 +1857,7 @@ bool gps_send_command_sync(gps_id_t id, const char *cmd, uint32_t timeout_ms) {
   gps_instance_t *inst = &gps_instances[id];
 
   // 세마포어 생성 (응답 대기용)
-  SemaphoreHandle_t response_sem = xSemaphoreCreateBinary();
+  SemaphoreHandle_t response_sem = HEAP_TRACK(HEAP_TAG_CMD_SEM, xSemaphoreCreateBinary());
   if (response_sem == NULL) {
     LOG_ERR("GPS[%d] failed to create semaphore", id);
     return false;
@@ -1073,11 +1874,16 @@ bool gps_send_command_sync(gps_id_t id, const char *cmd, uint32_t timeout_ms) {
       .user_data = NULL,
   };
 
-  strncpy(cmd_req.cmd, cmd, sizeof(cmd_req.cmd) - 1);
-  cmd_req.cmd[sizeof(cmd_req.cmd) - 1] = '\0';
+  cmd_req.cmd = gps_cmd_buf(cmd);
+  if (cmd_req.cmd == NULL) {
+    LOG_ERR("GPS[%d] TX buffer unavailable (len %u)", id, (unsigned)strlen(cmd));
+    vSemaphoreDelete(response_sem);
+    return false;
+  }
 
   if (xQueueSend(inst->cmd_queue, &cmd_req, pdMS_TO_TICKS(1000)) != pdTRUE) {
     LOG_ERR("GPS[%d] failed to send command to TX task", id);
+    tx_buf_free(cmd_req.cmd);
     vSemaphoreDelete(response_sem);
     return false;
   }
@@ -1107,30 +1913,26 @@ bool gps_send_command_async(gps_id_t id, const char *cmd, uint32_t timeout_ms,
 
   gps_instance_t *inst = &gps_instances[id];
 
-  // 세마포어 생성 (TX Task 내부에서 응답 대기용)
-  SemaphoreHandle_t response_sem = xSemaphoreCreateBinary();
-  if (response_sem == NULL) {
-    LOG_ERR("GPS[%d] 세마포어 생성 실패", id);
-    return false;
-  }
-
-  // 명령어 요청 구조체 생성 (비동기 방식)
+  // 명령어 요청 구조체 생성 (비동기 방식, 응답은 TX Task notification 으로 받음)
   gps_cmd_request_t cmd_req = {
       .timeout_ms = timeout_ms,
       .is_async = true,
-      .response_sem = response_sem,
+      .response_sem = NULL,
       .result = NULL,
       .callback = callback,
       .user_data = user_data,
       .async_result = false,
   };
 
-  strncpy(cmd_req.cmd, cmd, sizeof(cmd_req.cmd) - 1);
-  cmd_req.cmd[sizeof(cmd_req.cmd) - 1] = '\0';
+  cmd_req.cmd = gps_cmd_buf(cmd);
+  if (cmd_req.cmd == NULL) {
+    LOG_ERR("GPS[%d] TX buffer unavailable (len %u)", id, (unsigned)strlen(cmd));
+    return false;
+  }
 
   if (xQueueSend(inst->cmd_queue, &cmd_req, pdMS_TO_TICKS(1000)) != pdTRUE) {
     LOG_ERR("GPS[%d] 메시지큐 전송 실패", id);
-    vSemaphoreDelete(response_sem);
+    tx_buf_free(cmd_req.cmd);
     return false;
   }
 
@@ -1156,9 +1958,8 @@ bool gps_send_raw_data(gps_id_t id, const uint8_t *data, size_t len) {
     return false;
   }
 
-  if (xSemaphoreTake(inst->gps.mutex, pdMS_TO_TICKS(2000)) == pdTRUE) {
-    inst->gps.ops->send((const char *)data, len);
-    xSemaphoreGive(inst->gps.mutex);
+  if (gps_tx_frame(inst, (const char *)data, len, UART_TX_PRIO_NORMAL,
+                   pdMS_TO_TICKS(2000))) {
     LOG_DEBUG("GPS[%d] 송신 %d 바이트", id, len);
     return true;
   } else {
@@ -1167,6 +1968,64 @@ bool gps_send_raw_data(gps_id_t id, const uint8_t *data, size_t len) {
   }
 }
 
+/**
+ * @brief 보정 데이터(RTCM) 스트림 송신
+ *
+ * gps_send_raw_data() 와 달리 뮤텍스도 DMA 완료도 기다리지 않는다.
+ * 송신 링에 복사만 하고 리턴하므로 수신 콜백 안에서 불러도 된다.
+ * 링의 생산자는 하나여야 하므로 rtcm_router 를 거쳐서 부른다.
+ * 송신 링이 없는 포트는 gps_send_raw_data() 로 대신 보낸다 (블로킹).
+ *
+ * @param[in] id
+ * @param[in] data
+ * @param[in] len
+ * @return size_t 송신 링에 들어간 바이트 수
+ */
+size_t gps_send_corrections(gps_id_t id, const uint8_t *data, size_t len) {
+  if (id >= GPS_ID_MAX || !gps_instances[id].enabled || !data || len == 0) {
+    return 0;
+  }
+
+  if (!gps_port_has_stream(id)) {
+    return gps_send_raw_data(id, data, len) ? len : 0;
+  }
+
+  size_t n = gps_port_stream_write(id, data, len);
+  if (n < len) {
+    LOG_WARN("GPS[%d] 보정 링 가득참, %u 바이트 버림 (누적 %lu)", id,
+             (unsigned)(len - n), gps_port_stream_dropped(id));
+  }
+
+  return n;
+}
+
+uint32_t gps_get_utc_date(void)
+{
+  return gps_utc_date;
+}
+
+/**
+ * @brief 측정 주기만 잠깐 바꿈 (F9P, RAM 레이어, 설정값 gps_rate 는 그대로)
+ */
+bool gps_set_nav_rate_async(gps_id_t id, uint32_t hz)
+{
+  if (id >= GPS_ID_MAX || !gps_instances[id].enabled) {
+    return false;
+  }
+
+  gps_instance_t *inst = &gps_instances[id];
+
+  if (inst->type != GPS_TYPE_F9P) {
+    return false;
+  }
+
+#if defined(USE_GPS_UBLOX)
+  return ubx_set_meas_rate_async(&inst->gps, hz);
+#else
+  (void)hz;
+  return false;
+#endif
+}
 
 bool gps_factory_reset_async(gps_id_t id, gps_init_callback_t callback, void *user_data)
 {
@@ -1184,6 +2043,7 @@ bool gps_factory_reset_async(gps_id_t id, gps_init_callback_t callback, void *us
     return false;
   }
 
+#if defined(USE_GPS_UBLOX)
   if (!ubx_factory_reset(&inst->gps, callback, user_data)) {
 
     LOG_ERR("GPS[%d] 팩토리 리셋 실패", id);
@@ -1191,6 +2051,7 @@ bool gps_factory_reset_async(gps_id_t id, gps_init_callback_t callback, void *us
     return false;
 
   }
+#endif
 
  
 
@@ -1199,316 +2060,482 @@ bool gps_factory_reset_async(gps_id_t id, gps_init_callback_t callback, void *us
 
 
 /**
- * @brief GPS 위치 데이터 포맷팅
- *
- * 포맷: +GPS,lat,N/S,lon,E/W,msl_alt,ellipsoid_alt,heading,fix\r\n
+ * @brief 출력용 위치 값 모으기
  *
  * GPS 타입별 데이터 소스:
- * - Unicore UM982: BESTNAV (lat, lon, height, geoid, trk_gnd)
- * - Ublox F9P: HPPOSLLH (lat, lon, height, msl) + RELPOSNED (heading)
+ * - Unicore UM982: BESTNAV (lat, lon, height, geoid) + THS (heading)
+ * - Ublox F9P: HPPOSLLH (lat, lon, height, msl) + RELPOSNED (heading),
+ *   Rover F9P 는 gps_fuse 가 iTOW 로 맞춘 epoch (첫 epoch 전에는 최신 값)
  */
-bool gps_format_position_data(char *buffer)
+void gps_get_position(gps_position_t *pos)
 {
-  gps_instance_t *inst = &gps_instances[0];
-  gps_instance_t *heading_inst = &gps_instances[1];
-  const board_config_t *config = board_get_config();
-  double lat, lon, msl_alt, ellipsoid_alt, heading;
-  char ns = 'N', ew = 'E';
-  int fix;
-  int sat_num;
+  gps_nav_data_t nav = {0};
 
-  char ns_str[2] = {ns, '\0'};
-  char ew_str[2] = {ew, '\0'};
-
-  taskENTER_CRITICAL();
-  if(config->board == BOARD_TYPE_ROVER_F9P)
-  {
-    lat = inst->gps.ubx_data.hpposllh.lat * 1e-7 + inst->gps.ubx_data.hpposllh.lat_hp * 1e-9;
-    lon = inst->gps.ubx_data.hpposllh.lon * 1e-7 + inst->gps.ubx_data.hpposllh.lon_hp * 1e-9;
-    ellipsoid_alt = (inst->gps.ubx_data.hpposllh.height + inst->gps.ubx_data.hpposllh.height_hp * (double)0.1) / (double)1000.0;
-    msl_alt = (inst->gps.ubx_data.hpposllh.msl + inst->gps.ubx_data.hpposllh.msl_hp * (double)0.1) / (double)1000.0;
-    heading = heading_inst->gps.ubx_data.relposned.rel_pos_heading * 1e-5;
-    ns = inst->gps.nmea_data.gga.ns;
-    ew = inst->gps.nmea_data.gga.ew;
-    fix = inst->gps.nmea_data.gga.fix;
-    sat_num = inst->gps.nmea_data.gga.sat_num;
-  }
-  else if (config->board == BOARD_TYPE_ROVER_UM982) 
+  // 위치와 heading 이 같은 epoch 로 맞춰진 값
+  if (BOARD_IS(BOARD_TYPE_ROVER_F9P) && gps_fuse_get(pos))
   {
-    lat = inst->gps.unicore_bin_data.bestnav.lat;
-    lon = inst->gps.unicore_bin_data.bestnav.lon;
-    heading = inst->gps.nmea_data.ths.heading;
-    ns = inst->gps.nmea_data.gga.ns;
-    ew = inst->gps.nmea_data.gga.ew;
-    fix = inst->gps.nmea_data.gga.fix;
-    if(fix == 0)
-    {
-      ellipsoid_alt = 0;
-      msl_alt = 0;
-    }
-    else
-    {
-      ellipsoid_alt = inst->gps.unicore_bin_data.bestnav.height;
-      msl_alt = ellipsoid_alt - inst->gps.unicore_bin_data.bestnav.geoid;
-    }
-    sat_num = inst->gps.nmea_data.gga.sat_num;
+    return;
   }
-  taskEXIT_CRITICAL();
 
-  // 포맷팅 (뮤텍스 밖에서 수행)
-  int written = sprintf(buffer,
-                         "+GPS,%.9lf,%s,%.9lf,%s,%.4lf,%.4lf,%.5lf,%d,%d\n\r",
-                        lat, ns_str, lon, ew_str,
-                        msl_alt,
-                        ellipsoid_alt,
-                        heading,
-                        fix,
-                        sat_num);
+  // 파서가 게시한 스냅샷만 읽으므로 인터럽트를 막지 않는다
+  gps_get_nav(GPS_ID_BASE, &nav);
+  gps_position_from_nav(&nav, pos);
 
-  return true;
+  if(BOARD_IS(BOARD_TYPE_ROVER_F9P))
+  {
+    // heading 은 moving base 쪽 RELPOSNED
+    gps_nav_data_t heading_nav = {0};
+    gps_get_nav(GPS_ID_ROVER, &heading_nav);
+    pos->heading = heading_nav.heading;
+  }
+  else if (BOARD_IS(BOARD_TYPE_ROVER_UM982) && pos->fix == 0)
+  {
+    pos->llh.ellipsoid_alt = 0;
+    pos->llh.msl_alt = 0;
+  }
 }
 
+/**
+ * @brief 위치를 지금 시각으로 외삽 (출력 지연 보상)
+ *
+ * epoch 시각은 gps_time 이 PPS/UART IDLE 로 잰 값이다. 속도가 같은 epoch
+ * 값이라 가정하고 지난 시간만큼 위치를 옮기며, iTOW 도 같이 민다.
+ * epoch 시각을 모르거나 너무 오래된 해는 그대로 둔다.
+ *
+ * @param[inout] pos
+ */
+static void gps_position_compensate(gps_position_t *pos)
+{
+  uint32_t age_us;
 
-typedef struct {
-
-  gps_id_t gps_id;
+  if (pos->fix == GPS_FIX_INVALID ||
+      !gps_time_epoch_age(GPS_ID_BASE, pos->itow, &age_us) ||
+      age_us > GPS_POS_COMP_MAX_MS * 1000U)
+  {
+    return;
+  }
 
-  uint8_t current_step;  // 0: config heading length, 1: CONFIG HEADING FIXLENGTH
+  // 짧은 거리라 국소 평면으로 충분 (구면 반지름)
+  double dt = age_us * 1e-6;
+  double lat_rad = gps_llh_deg_to_double(pos->llh.lat) * (M_PI / 180.0);
+  double dn = pos->vel_n * 1e-3 * dt;
+  double de = pos->vel_e * 1e-3 * dt;
+  double rad_to_llh = (180.0 / M_PI) * GPS_LLH_DEG_SCALE / GPS_POS_EARTH_RADIUS_M;
 
-  gps_command_callback_t user_callback;
+  pos->llh.lat += llround(dn * rad_to_llh);
+  if (fabs(lat_rad) < (89.0 * M_PI / 180.0))
+  {
+    pos->llh.lon += llround(de * rad_to_llh / cos(lat_rad));
+  }
+  int32_t dalt = (int32_t)lround(-pos->vel_d * 1e-3 * dt * GPS_LLH_ALT_SCALE);
+  pos->llh.ellipsoid_alt += dalt;
+  pos->llh.msl_alt += dalt;
+  pos->itow = (pos->itow + (age_us + 500U) / 1000U) % GPS_WEEK_MS;
+}
 
-  void *user_data;
+/**
+ * @brief 출력할 위치 (pos_latency_comp 가 켜져 있으면 지금 시각으로 보상)
+ */
+void gps_get_output_position(gps_position_t *pos)
+{
+  gps_get_position(pos);
 
-  char cmd_buffer[128];
+  if (flash_params_snapshot(NULL)->pos_latency_comp == 1)
+  {
+    gps_position_compensate(pos);
+  }
+}
 
-} gps_config_heading_context_t;
+/**
+ * @brief GPS 위치 데이터 포맷팅 (ASCII)
+ *
+ * 포맷: +GPS,lat,N/S,lon,E/W,msl_alt,ellipsoid_alt,heading,fix,sat\n\r
+ */
+static bool gps_render_ascii(const gps_position_t *p, char *buffer)
+{
+  const gps_position_t pos = *p;
+  fmt_t f;
+
+  // printf %lf 대신 고정소수점 (자릿수는 예전 %.9lf/%.4lf/%.5lf 와 같음)
+  // 위도/경도는 부호 있는 값이라 방향 문자는 항상 N/E
+  fmt_init(&f, buffer, GPS_POS_ASCII_MAX_LEN);
+  fmt_str(&f, "+GPS,");
+  fmt_fixed(&f, pos.llh.lat, 9);
+  fmt_str(&f, ",N,");
+  fmt_fixed(&f, pos.llh.lon, 9);
+  fmt_str(&f, ",E,");
+  fmt_fixed(&f, pos.llh.msl_alt, 4);
+  fmt_char(&f, ',');
+  fmt_fixed(&f, pos.llh.ellipsoid_alt, 4);
+  fmt_char(&f, ',');
+  fmt_fixed(&f, llround(pos.heading * 1e5), 5);
+  fmt_char(&f, ',');
+  fmt_i32(&f, pos.fix);
+  fmt_char(&f, ',');
+  fmt_i32(&f, pos.sat_num);
+  fmt_str(&f, "\n\r");
+
+  return fmt_end(&f) > 0;
+}
 
- 
+bool gps_format_position_data(char *buffer)
+{
+  gps_position_t pos;
 
-static void gps_config_heading_callback(bool success, void *user_data)
+  gps_get_output_position(&pos);
+  return gps_render_ascii(&pos, buffer);
+}
 
+static inline void put_le16(uint8_t *p, uint16_t v)
 {
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)(v >> 8);
+}
 
-  gps_config_heading_context_t *ctx = (gps_config_heading_context_t *)user_data;
-
- 
+static inline void put_le32(uint8_t *p, uint32_t v)
+{
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)(v >> 8);
+  p[2] = (uint8_t)(v >> 16);
+  p[3] = (uint8_t)(v >> 24);
+}
 
-  if (!success) {
+/**
+ * @brief GPS 위치 데이터 포맷팅 (binary)
+ *
+ * printf 없이 고정소수점으로 채운다. 필드는 little-endian.
+ *
+ *  off size
+ *   0  1   sync1 0xA5
+ *   1  1   sync2 0x5A
+ *   2  1   payload 길이 (28)
+ *   3  4   iTOW [ms]
+ *   7  4   lat [1e-7 deg]
+ *  11  4   lon [1e-7 deg]
+ *  15  1   lat_hp [1e-9 deg]
+ *  16  1   lon_hp [1e-9 deg]
+ *  17  4   msl_alt [mm]
+ *  21  4   ellipsoid_alt [mm]
+ *  25  4   heading [1e-5 deg]
+ *  29  1   fix
+ *  30  1   sat
+ *  31  2   CRC16-CCITT (init 0xFFFF, 길이 바이트부터 sat 까지)
+ *
+ * @param[out] buf
+ * @param[in] size buf 크기 (GPS_POS_BIN_FRAME_LEN 이상)
+ * @return size_t 프레임 길이, 버퍼 부족 시 0
+ */
+static size_t gps_render_bin(const gps_position_t *p, uint8_t *buf, size_t size)
+{
+  const gps_position_t pos = *p;
 
-    LOG_ERR("GPS[%d] Heading config step %d failed", ctx->gps_id, ctx->current_step);
+  if (size < GPS_POS_BIN_FRAME_LEN) {
+    return 0;
+  }
 
- 
+  int64_t lat = pos.llh.lat;
+  int64_t lon = pos.llh.lon;
 
-    // 실패 시 사용자 콜백 호출 후 컨텍스트 해제
+  buf[0] = GPS_POS_BIN_SYNC1;
+  buf[1] = GPS_POS_BIN_SYNC2;
+  buf[2] = GPS_POS_BIN_PAYLOAD_LEN;
+  put_le32(&buf[3], pos.itow);
+  put_le32(&buf[7], (uint32_t)(int32_t)(lat / 100));
+  put_le32(&buf[11], (uint32_t)(int32_t)(lon / 100));
+  buf[15] = (uint8_t)(int8_t)(lat % 100);
+  buf[16] = (uint8_t)(int8_t)(lon % 100);
+  put_le32(&buf[17], (uint32_t)gps_llh_alt_to_mm(pos.llh.msl_alt));
+  put_le32(&buf[21], (uint32_t)gps_llh_alt_to_mm(pos.llh.ellipsoid_alt));
+  put_le32(&buf[25], (uint32_t)lround(pos.heading * 1e5));
+  buf[29] = (uint8_t)pos.fix;
+  buf[30] = (uint8_t)pos.sat_num;
 
-    if (ctx->user_callback) {
+  uint16_t crc = crc16_ccitt_update(0xFFFF, &buf[2], GPS_POS_BIN_PAYLOAD_LEN + 1);
+  put_le16(&buf[31], crc);
 
-      ctx->user_callback(false, ctx->user_data);
+  return GPS_POS_BIN_FRAME_LEN;
+}
 
-    }
+size_t gps_format_position_bin(uint8_t *buf, size_t size)
+{
+  gps_position_t pos;
 
-    vPortFree(ctx);
+  gps_get_output_position(&pos);
+  return gps_render_bin(&pos, buf, size);
+}
 
-    return;
+static inline void put_le64(uint8_t *p, uint64_t v)
+{
+  put_le32(p, (uint32_t)v);
+  put_le32(&p[4], (uint32_t)(v >> 32));
+}
 
+/**
+ * @brief 평면 좌표 위치 포맷팅 (ASCII)
+ *
+ * 포맷: +GRD,easting,northing,msl_alt,h,zone,fix,sat\n\r
+ * h 는 투영 datum 의 타원체고, zone 은 UTM 이면 52N 처럼 (TM 은 0).
+ * 평면 좌표를 못 구하면 (fix 없음, 설정 오류) easting/northing/h 는 0.
+ */
+static bool gps_render_grid_ascii(const gps_position_t *p, char *buffer)
+{
+  const gps_position_t pos = *p;
+  gps_proj_xy_t xy = {0};
+  fmt_t f;
+
+  gps_grid_convert(&pos, &xy);
+
+  fmt_init(&f, buffer, GPS_POS_ASCII_MAX_LEN);
+  fmt_str(&f, "+GRD,");
+  fmt_fixed(&f, xy.e, 4);
+  fmt_char(&f, ',');
+  fmt_fixed(&f, xy.n, 4);
+  fmt_char(&f, ',');
+  fmt_fixed(&f, pos.llh.msl_alt, 4);
+  fmt_char(&f, ',');
+  fmt_fixed(&f, xy.h, 4);
+  fmt_char(&f, ',');
+  fmt_u32(&f, xy.zone);
+  if (xy.zone)
+  {
+    fmt_char(&f, xy.south ? 'S' : 'N');
   }
+  fmt_char(&f, ',');
+  fmt_i32(&f, pos.fix);
+  fmt_char(&f, ',');
+  fmt_i32(&f, pos.sat_num);
+  fmt_str(&f, "\n\r");
 
- 
+  return fmt_end(&f) > 0;
+}
 
-  LOG_INFO("GPS[%d] Heading config step %d OK", ctx->gps_id, ctx->current_step);
+bool gps_format_grid_data(char *buffer)
+{
+  gps_position_t pos;
 
- 
+  gps_get_output_position(&pos);
+  return gps_render_grid_ascii(&pos, buffer);
+}
 
-  ctx->current_step++;
+/**
+ * @brief 평면 좌표 위치 포맷팅 (binary)
+ *
+ *  off size
+ *   0  1   sync1 0xA5
+ *   1  1   sync2 0x5C
+ *   2  1   payload 길이 (31)
+ *   3  4   iTOW [ms]
+ *   7  8   easting [0.1 mm]
+ *  15  8   northing [0.1 mm]
+ *  23  4   msl_alt [mm]
+ *  27  4   h [mm] (투영 datum 타원체고)
+ *  31  1   UTM zone (bit7: 남반구), TM 은 0
+ *  32  1   fix
+ *  33  1   sat
+ *  34  2   CRC16-CCITT (init 0xFFFF, 길이 바이트부터 sat 까지)
+ *
+ * 평면 좌표를 못 구하면 easting/northing/h 는 0.
+ *
+ * @param[out] buf
+ * @param[in] size buf 크기 (GPS_GRID_BIN_FRAME_LEN 이상)
+ * @return size_t 프레임 길이, 버퍼 부족 시 0
+ */
+static size_t gps_render_grid_bin(const gps_position_t *p, uint8_t *buf, size_t size)
+{
+  const gps_position_t pos = *p;
+  gps_proj_xy_t xy = {0};
 
- 
+  if (size < GPS_GRID_BIN_FRAME_LEN) {
+    return 0;
+  }
 
-  if (ctx->current_step == 1) {
+  gps_grid_convert(&pos, &xy);
 
-    // 두 번째 명령어: CONFIG HEADING FIXLENGTH
+  buf[0] = GPS_POS_BIN_SYNC1;
+  buf[1] = GPS_GRID_BIN_SYNC2;
+  buf[2] = GPS_GRID_BIN_PAYLOAD_LEN;
+  put_le32(&buf[3], pos.itow);
+  put_le64(&buf[7], (uint64_t)xy.e);
+  put_le64(&buf[15], (uint64_t)xy.n);
+  put_le32(&buf[23], (uint32_t)gps_llh_alt_to_mm(pos.llh.msl_alt));
+  put_le32(&buf[27], (uint32_t)gps_llh_alt_to_mm(xy.h));
+  buf[31] = (uint8_t)(xy.zone | (xy.south ? 0x80 : 0));
+  buf[32] = (uint8_t)pos.fix;
+  buf[33] = (uint8_t)pos.sat_num;
 
-    gps_send_command_async(ctx->gps_id, "CONFIG HEADING FIXLENGTH\r\n",
+  uint16_t crc = crc16_ccitt_update(0xFFFF, &buf[2], GPS_GRID_BIN_PAYLOAD_LEN + 1);
+  put_le16(&buf[34], crc);
 
-                          3000, gps_config_heading_callback, ctx);
+  return GPS_GRID_BIN_FRAME_LEN;
+}
 
-  } else {
+size_t gps_format_grid_bin(uint8_t *buf, size_t size)
+{
+  gps_position_t pos;
 
-    // 모든 명령어 완료
+  gps_get_output_position(&pos);
+  return gps_render_grid_bin(&pos, buf, size);
+}
 
-    LOG_INFO("GPS[%d] Heading config complete!", ctx->gps_id);
+/**
+ * @brief 설정된 출력 형식 (pos_output_format) 을 실제로 낼 형식으로
+ *
+ * 평면 좌표 형식인데 평면 좌표 출력이 꺼져 있으면 같은 종류 (ASCII/binary) 의
+ * 위경도 형식으로 보낸다.
+ *
+ * @param[in] binary ASCII 설정이어도 같은 좌표의 binary 형식으로
+ * @return uint32_t GPS_POS_FORMAT_*
+ */
+uint32_t gps_pos_format_resolve(bool binary)
+{
+  uint32_t format = flash_params_snapshot(NULL)->pos_output_format;
+  bool grid = (format == GPS_POS_FORMAT_GRID_ASCII || format == GPS_POS_FORMAT_GRID_BINARY) &&
+              gps_grid_enabled();
 
- 
+  if (binary || format == GPS_POS_FORMAT_BINARY || format == GPS_POS_FORMAT_GRID_BINARY) {
+    return grid ? GPS_POS_FORMAT_GRID_BINARY : GPS_POS_FORMAT_BINARY;
+  }
 
-    if (ctx->user_callback) {
+  return grid ? GPS_POS_FORMAT_GRID_ASCII : GPS_POS_FORMAT_ASCII;
+}
 
-      ctx->user_callback(true, ctx->user_data);
+/**
+ * @brief 위치 하나를 정해진 형식으로 포맷팅 (출력 관리자가 epoch 마다 한 번)
+ *
+ * @param[in] format GPS_POS_FORMAT_*
+ * @param[in] pos gps_get_output_position() 값
+ * @param[out] buf
+ * @param[in] size buf 크기 (ASCII 는 GPS_POS_ASCII_MAX_LEN 이상)
+ * @return size_t 보낼 길이, 실패 시 0
+ */
+size_t gps_render_position(uint32_t format, const gps_position_t *pos, uint8_t *buf,
+                           size_t size)
+{
+  bool ok;
 
-    }
+  if (format == GPS_POS_FORMAT_BINARY) {
+    return gps_render_bin(pos, buf, size);
+  }
+  if (format == GPS_POS_FORMAT_GRID_BINARY) {
+    return gps_render_grid_bin(pos, buf, size);
+  }
 
-    vPortFree(ctx);
+  if (size < GPS_POS_ASCII_MAX_LEN) {
+    return 0;
+  }
 
+  if (format == GPS_POS_FORMAT_GRID_ASCII) {
+    ok = gps_render_grid_ascii(pos, (char *)buf);
+  } else {
+    ok = gps_render_ascii(pos, (char *)buf);
+  }
+  if (!ok) {
+    return 0;
   }
 
+  return strlen((char *)buf);
 }
 
- 
-
-bool gps_config_heading_length_async(gps_id_t id, float baseline_len, float slave_distance,
-
-                                     gps_command_callback_t callback, void *user_data)
-
+/**
+ * @brief 설정된 출력 형식(pos_output_format)으로 위치 데이터 포맷팅
+ *
+ * 지금 위치로 새로 만든다. 항법 해마다 나가는 출력은 pos_out 이 epoch 당
+ * 한 번 만든 것을 같이 쓴다.
+ *
+ * @param[out] buf
+ * @param[in] size buf 크기 (ASCII 는 GPS_POS_ASCII_MAX_LEN 이상)
+ * @return size_t 보낼 길이, 실패 시 0
+ */
+size_t gps_format_position(uint8_t *buf, size_t size)
 {
+  gps_position_t pos;
 
-  if (id >= GPS_ID_MAX || !gps_instances[id].enabled) {
+  gps_get_output_position(&pos);
+  return gps_render_position(gps_pos_format_resolve(false), &pos, buf, size);
+}
 
-    LOG_ERR("GPS[%d] invalid", id);
 
-    return false;
+/**
+ * @brief heading 설정 순서 (UM982)
+ *
+ * 첫 명령은 기선 길이로 만들어서 인스턴스 버퍼에 두고 (cmd NULL), 둘째는 고정.
+ */
+static const init_seq_step_t gps_heading_steps[] = {
+    {.cmd = NULL, .expect = "OK", .timeout_ms = 3000},                          // config heading length
+    {.cmd = "CONFIG HEADING FIXLENGTH\r\n", .expect = "OK", .timeout_ms = 3000},
+};
 
-  }
+typedef struct {
+  init_seq_t seq;
+  gps_id_t gps_id;
+  gps_command_callback_t user_callback;
+  void *user_data;
+  char cmd_buffer[128];
+} gps_heading_seq_t;
 
- 
+static gps_heading_seq_t gps_heading_seq[GPS_ID_MAX];
 
-  gps_instance_t *inst = &gps_instances[id];
+static void gps_heading_seq_cb(bool success, void *user_data)
+{
+  init_seq_result((init_seq_t *)user_data, success, NULL);
+}
 
- 
+static bool gps_heading_seq_send(init_seq_t *seq, const init_seq_step_t *step)
+{
+  gps_heading_seq_t *hs = seq->user;
 
- 
+  return gps_send_command_async(hs->gps_id, step->cmd ? step->cmd : hs->cmd_buffer,
+                                step->timeout_ms, gps_heading_seq_cb, seq);
+}
 
- 
+static void gps_heading_seq_done(init_seq_t *seq, bool ok)
+{
+  gps_heading_seq_t *hs = seq->user;
 
-  // UM982만 지원
+  if (hs->user_callback) {
+    hs->user_callback(ok, hs->user_data);
+  }
+}
 
- 
+static const init_seq_ops_t gps_heading_seq_ops = {
+    .send = gps_heading_seq_send,
+    .done = gps_heading_seq_done,
+};
 
-  if (inst->type != GPS_TYPE_UM982) {
+bool gps_config_heading_length_async(gps_id_t id, float baseline_len, float slave_distance,
+                                     gps_command_callback_t callback, void *user_data)
+{
+  gps_heading_seq_t *hs;
 
- 
+  if (id >= GPS_ID_MAX || !gps_instances[id].enabled) {
+    LOG_ERR("GPS[%d] invalid", id);
+    return false;
+  }
 
+  // UM982만 지원
+  if (gps_instances[id].type != GPS_TYPE_UM982) {
     LOG_ERR("GPS[%d] Only UM982 supports heading config", id);
-
- 
-
     return false;
-
- 
-
   }
 
- 
-
- 
-
- 
-
-  // 컨텍스트 동적 할당
-
- 
-
-  gps_config_heading_context_t *ctx = pvPortMalloc(sizeof(gps_config_heading_context_t));
-
- 
-
-  if (!ctx) {
-
- 
-
-    LOG_ERR("GPS[%d] Failed to allocate heading config context", id);
-
- 
-
+  hs = &gps_heading_seq[id];
+  if (init_seq_running(&hs->seq)) {
+    LOG_WARN("GPS[%d] heading config already running", id);
     return false;
-
- 
-
   }
 
- 
-
- 
-
- 
-
-  // 컨텍스트 초기화
-
- 
-
-  ctx->gps_id = id;
-
- 
-
-  ctx->current_step = 0;
-
- 
-
-  ctx->user_callback = callback;
-
- 
-
-  ctx->user_data = user_data;
-
- 
-
- 
-
- 
+  hs->seq = (init_seq_t)INIT_SEQ_INIT("GPS heading", &gps_heading_seq_ops, hs);
+  hs->gps_id = id;
+  hs->user_callback = callback;
+  hs->user_data = user_data;
 
   // 첫 번째 명령어: config heading length [baseline] [slave_distance]
-
- 
-
-  snprintf(ctx->cmd_buffer, sizeof(ctx->cmd_buffer),
-
- 
-
+  snprintf(hs->cmd_buffer, sizeof(hs->cmd_buffer),
            "config heading length %.4f %.4f\r\n", baseline_len, slave_distance);
 
- 
-
- 
-
- 
-
-  LOG_INFO("GPS[%d] Starting heading config: %s", id, ctx->cmd_buffer);
-
- 
-
- 
-
- 
-
-  // 첫 번째 명령어 전송
-
- 
-
-  if (!gps_send_command_async(id, ctx->cmd_buffer, 3000, gps_config_heading_callback, ctx)) {
-
- 
-
-    LOG_ERR("GPS[%d] Failed to send heading length command", id);
-
- 
-
-    vPortFree(ctx);
-
- 
-
-    return false;
-
- 
-
-  }
-
- 
-
- 
-
- 
-
-  return true;
-
- 
+  LOG_INFO("GPS[%d] Starting heading config: %s", id, hs->cmd_buffer);
 
+  return init_seq_start(&hs->seq, gps_heading_steps, INIT_SEQ_COUNT(gps_heading_steps), 0);
 }
 
  
@@ -1555,9 +2582,15 @@ bool gps_cleanup_instance(gps_id_t id)
 
   if (use_led) {
 
-    led_set_color(2, LED_COLOR_NONE);
+    if (gps_led_timer != NULL) {
+
+      xTimerStop(gps_led_timer, 0);
+
+    }
+
+    led_set_color(GPS_LED_ID, LED_COLOR_NONE);
 
-    led_set_state(2, false);
+    led_set_state(GPS_LED_ID, false);
 
   }
 
@@ -1597,18 +2630,6 @@ LOG_INFO("GPS[%d] RX 태스크 삭제 요청", id);
   LOG_INFO("GPS[%d] 태스크 정리 대기 완료", id);
  
 
-  if (inst->queue != NULL) {
-
-    vQueueDelete(inst->queue);
-
-    inst->queue = NULL;
-
-    LOG_INFO("GPS[%d] 큐 삭제 완료", id);
-
-  }
-
- 
-
   if (inst->cmd_queue != NULL) {
 
     vQueueDelete(inst->cmd_queue);
@@ -1631,6 +2652,11 @@ LOG_INFO("GPS[%d] RX 태스크 삭제 요청", id);
 
   }
 
+  if (inst->gps.tx_mutex != NULL) {
+    vSemaphoreDelete(inst->gps.tx_mutex);
+    inst->gps.tx_mutex = NULL;
+  }
+
  
 
   memset(inst, 0, sizeof(gps_instance_t));
@@ -8,14 +8,16 @@
 #include "semphr.h"
 #include "task.h"
 
+struct tx_buf; // tx_pool.h (호스트 벤치 빌드에 tx_pool 이 없어도 되게)
+
 typedef void (*gps_command_callback_t)(bool success, void *user_data);
 
 typedef struct {
-  char cmd[128];                  // 전송할 명령어
+  struct tx_buf *cmd;             // 전송할 명령어 (NUL 종료, NULL: 초기화 파이프라인 시작)
   uint32_t timeout_ms;            // 타임아웃 (ms)
   bool is_async;                  // true: 비동기, false: 동기
 
-  SemaphoreHandle_t response_sem; // 응답 대기용 세마포어
+  SemaphoreHandle_t response_sem; // 동기 호출자 완료 알림용 (비동기는 NULL)
   bool *result;                   // 응답 결과 (true: OK, false: ERROR/TIMEOUT)
 
   gps_command_callback_t callback; // 완료 콜백
@@ -23,11 +25,44 @@ typedef struct {
   bool async_result;               // 비동기 결과 저장용
 } gps_cmd_request_t;
 
+/**
+ * @brief 위치 출력 형식 (user_params_t.pos_output_format)
+ */
+typedef enum {
+  GPS_POS_FORMAT_ASCII = 0,       // +GPS,... 텍스트 (약 100 byte)
+  GPS_POS_FORMAT_BINARY = 1,      // 고정소수점 binary 프레임 (33 byte)
+  GPS_POS_FORMAT_GRID_ASCII = 2,  // +GRD,... 평면 좌표 텍스트 (gps_grid.h)
+  GPS_POS_FORMAT_GRID_BINARY = 3, // 평면 좌표 binary 프레임 (36 byte)
+  GPS_POS_FORMAT_COUNT
+} gps_pos_format_t;
+
+#define GPS_POS_ASCII_MAX_LEN 120
+
+#define GPS_POS_BIN_SYNC1 0xA5
+#define GPS_POS_BIN_SYNC2 0x5A
+#define GPS_POS_BIN_PAYLOAD_LEN 28
+#define GPS_POS_BIN_FRAME_LEN (3 + GPS_POS_BIN_PAYLOAD_LEN + 2)
+
+#define GPS_GRID_BIN_SYNC2 0x5C
+#define GPS_GRID_BIN_PAYLOAD_LEN 31
+#define GPS_GRID_BIN_FRAME_LEN (3 + GPS_GRID_BIN_PAYLOAD_LEN + 2)
+
+/*
+ * 출력 지연 보상 (user_params_t.pos_latency_comp)
+ *
+ * 위치를 보내는 순간까지 속도로 외삽한다. epoch 가 이보다 오래됐으면
+ * (수신 끊김 등) 외삽하지 않고 그대로 보낸다.
+ */
+#define GPS_POS_COMP_MAX_MS 200
+#define GPS_POS_EARTH_RADIUS_M 6371000.0
+#define GPS_WEEK_MS 604800000U
+
 bool gps_send_command_sync(gps_id_t id, const char *cmd, uint32_t timeout_ms);
 bool gps_send_command_async(gps_id_t id, const char *cmd, uint32_t timeout_ms,
                              gps_command_callback_t callback, void *user_data);
 
 bool gps_send_raw_data(gps_id_t id, const uint8_t *data, size_t len);
+size_t gps_send_corrections(gps_id_t id, const uint8_t *data, size_t len);
 
 typedef void (*gps_init_callback_t)(bool success, void *user_data);
 
@@ -83,8 +118,38 @@ bool gps_gga_avg_can_read(gps_id_t id);
  * @return true: 성공, false: 실패
  */
 bool gps_get_gga_avg(gps_id_t id, double *lat, double *lon, double *alt);
+bool gps_get_nav(gps_id_t id, gps_nav_data_t *nav);
+
+/**
+ * @brief 출력용 위치 (GPS_ID_BASE 기준, 보드별 heading/고도 보정 적용)
+ */
+typedef struct {
+  gps_llh_t llh;
+  double heading;
+  double hdop;
+  float h_acc, v_acc; // m
+  int32_t vel_n, vel_e, vel_d; // NED 속도 [mm/s]
+  uint32_t itow;
+  TickType_t tick;    // 위치를 게시한 tick (0: 아직 없음)
+  int fix;
+  int sat_num;
+} gps_position_t;
+
+void gps_get_position(gps_position_t *pos);
+void gps_get_output_position(gps_position_t *pos);
+uint32_t gps_pos_format_resolve(bool binary);
+size_t gps_render_position(uint32_t format, const gps_position_t *pos, uint8_t *buf,
+                           size_t size);
 bool gps_factory_reset_async(gps_id_t id, gps_init_callback_t callback, void *user_data);
+bool gps_set_nav_rate_async(gps_id_t id, uint32_t hz);
+/* UTC 날짜 yyyymmdd (F9P NAV-PVT, 아직 모르면 0) */
+uint32_t gps_get_utc_date(void);
 bool gps_format_position_data(char *buffer);
+size_t gps_format_position_bin(uint8_t *buf, size_t size);
+bool gps_format_grid_data(char *buffer);
+size_t gps_format_grid_bin(uint8_t *buf, size_t size);
+size_t gps_format_position(uint8_t *buf, size_t size);
+size_t gps_format_rx_comms(char *buf, size_t size);
 bool gps_config_heading_length_async(gps_id_t id, float baseline_len, float slave_distance,
                                      gps_command_callback_t callback, void *user_data);
 
@@ -0,0 +1,155 @@
+#include "gps_cycle_bench.h"
+#include "gps.h"
+#include "crc.h"
+#include "stm32f4xx.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdio.h>
+#include <string.h>
+
+#ifndef TAG
+#define TAG "GPS_BENCH"
+#endif
+
+#include "log.h"
+
+#define BENCH_PASS_CNT 20
+
+/**
+ * @brief 테스트 벡터 (const -> flash)
+ *
+ * GGA, UBX NAV-HPPOSLLH, RTCM 1005, GSA(미등록 sentence, GSV 와 같은 길이),
+ * Unicore binary(미등록 id) 순서. 체크섬/CRC 모두 유효.
+ * 보드에 빠진 디코더의 프레임은 벡터에서도 뺀다 (gps_config.h).
+ */
+static const uint8_t bench_vector[] = {
+    0x24, 0x47, 0x50, 0x47, 0x47, 0x41, 0x2C, 0x30, 0x39, 0x32, 0x37, 0x32,
+    0x35, 0x2E, 0x30, 0x30, 0x2C, 0x34, 0x37, 0x31, 0x37, 0x2E, 0x31, 0x31,
+    0x33, 0x39, 0x39, 0x2C, 0x4E, 0x2C, 0x30, 0x30, 0x38, 0x33, 0x33, 0x2E,
+    0x39, 0x31, 0x35, 0x39, 0x30, 0x2C, 0x45, 0x2C, 0x34, 0x2C, 0x31, 0x32,
+    0x2C, 0x30, 0x2E, 0x36, 0x31, 0x2C, 0x34, 0x39, 0x39, 0x2E, 0x36, 0x2C,
+    0x4D, 0x2C, 0x34, 0x38, 0x2E, 0x30, 0x2C, 0x4D, 0x2C, 0x31, 0x2E, 0x30,
+    0x2C, 0x30, 0x30, 0x30, 0x30, 0x2A, 0x37, 0x44, 0x0D, 0x0A,
+#if defined(USE_GPS_UBLOX)
+    0xB5, 0x62, 0x01, 0x14, 0x24, 0x00, 0x00, 0x07, 0x0E, 0x15, 0x1C, 0x23,
+    0x2A, 0x31, 0x38, 0x3F, 0x46, 0x4D, 0x54, 0x5B, 0x62, 0x69, 0x70, 0x77,
+    0x7E, 0x85, 0x8C, 0x93, 0x9A, 0xA1, 0xA8, 0xAF, 0xB6, 0xBD, 0xC4, 0xCB,
+    0xD2, 0xD9, 0xE0, 0xE7, 0xEE, 0xF5, 0x73, 0x02,
+#endif
+    0xD3, 0x00, 0x13, 0x3E, 0xD0, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06,
+    0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0x10, 0x9F, 0x1E,
+    0xF7, 0x24, 0x47, 0x50, 0x47, 0x53, 0x41, 0x2C, 0x33, 0x2C, 0x31, 0x2C,
+    0x31, 0x31, 0x2C, 0x30, 0x33, 0x2C, 0x30, 0x33, 0x2C, 0x31, 0x31, 0x31,
+    0x2C, 0x30, 0x30, 0x2C, 0x30, 0x34, 0x2C, 0x31, 0x35, 0x2C, 0x32, 0x37,
+    0x30, 0x2C, 0x30, 0x30, 0x2C, 0x30, 0x36, 0x2C, 0x30, 0x31, 0x2C, 0x30,
+    0x31, 0x30, 0x2C, 0x30, 0x30, 0x2C, 0x31, 0x33, 0x2C, 0x30, 0x36, 0x2C,
+    0x32, 0x39, 0x32, 0x2C, 0x30, 0x30, 0x2A, 0x36, 0x33, 0x0D, 0x0A,
+#if defined(USE_GPS_UNICORE)
+    0xAA, 0x44, 0xB5, 0x00, 0x0F, 0x27, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B,
+    0x0C, 0x0D, 0x0E, 0x0F, 0x20, 0x6C, 0x77, 0xE1,
+#endif
+};
+
+/* 테스트 벡터 안의 정상 프레임 수 (GGA, UBX, RTCM, Unicore binary) */
+#define BENCH_VECTOR_FRAME_CNT (2 + GPS_DECODER_UBLOX + GPS_DECODER_UNICORE)
+
+static gps_t bench_gps;
+static char bench_frame_buf[256]; // 벡터의 가장 긴 프레임보다 크게
+static bool bench_gps_inited;
+static uint32_t bench_frame_cnt;
+
+static void bench_msg_cb(gps_t *gps, gps_procotol_t protocol, gps_msg_t msg,
+                         void *ctx) {
+  bench_frame_cnt++;
+}
+
+/**
+ * @brief 측정값을 byte당 cycle x100 으로 변환
+ */
+static uint32_t cycles_per_byte_x100(uint32_t cycles, uint32_t bytes) {
+  return (uint32_t)(((uint64_t)cycles * 100U) / bytes);
+}
+
+bool gps_cycle_bench_run(gps_cycle_bench_result_t *result) {
+  const uint32_t len = sizeof(bench_vector);
+  const uint32_t total = len * BENCH_PASS_CNT;
+  uint32_t cyc_parse = 0, cyc_crc32 = 0, cyc_ubx = 0, cyc_crc24q = 0;
+  volatile uint32_t sink = 0;
+#if defined(USE_GPS_UBLOX)
+  uint8_t ck_a, ck_b;
+#endif
+  uint32_t start;
+
+  /* 실제 GPS 인스턴스와 별개인 파서 (mutex는 최초 1회만 생성) */
+  if (!bench_gps_inited) {
+    gps_init(&bench_gps);
+    gps_set_frame_buf(&bench_gps, bench_frame_buf, sizeof(bench_frame_buf));
+    for (int p = GPS_PROTOCOL_NMEA; p < GPS_STATS_PROTOCOL_CNT; p++) {
+      gps_subscribe(&bench_gps, (gps_procotol_t)p, GPS_SUB_ANY, bench_msg_cb, NULL);
+    }
+    bench_gps_inited = true;
+  }
+  bench_gps.protocol = GPS_PROTOCOL_NONE;
+  bench_gps.state = GPS_PARSE_STATE_NONE;
+  bench_frame_cnt = 0;
+
+  for (int i = 0; i < BENCH_PASS_CNT; i++) {
+    taskENTER_CRITICAL();
+    start = DWT->CYCCNT;
+    gps_parse_process(&bench_gps, bench_vector, len);
+    cyc_parse += DWT->CYCCNT - start;
+
+    start = DWT->CYCCNT;
+    sink ^= crc32_update(0, bench_vector, len);
+    cyc_crc32 += DWT->CYCCNT - start;
+
+#if defined(USE_GPS_UBLOX)
+    start = DWT->CYCCNT;
+    ubx_calc_checksum(bench_vector, len, &ck_a, &ck_b);
+    cyc_ubx += DWT->CYCCNT - start;
+    sink ^= ck_a | (ck_b << 8);
+#endif
+
+    start = DWT->CYCCNT;
+    sink ^= rtcm_crc24q_update(0, bench_vector, len);
+    cyc_crc24q += DWT->CYCCNT - start;
+    taskEXIT_CRITICAL();
+  }
+  (void)sink;
+
+  result->parse = cycles_per_byte_x100(cyc_parse, total);
+  result->crc32 = cycles_per_byte_x100(cyc_crc32, total);
+  result->ubx = cycles_per_byte_x100(cyc_ubx, total);
+  result->crc24q = cycles_per_byte_x100(cyc_crc24q, total);
+  result->bytes = len;
+
+  if (bench_frame_cnt != BENCH_VECTOR_FRAME_CNT * BENCH_PASS_CNT) {
+    LOG_ERR("bench frame count mismatch: %u (expected %u)",
+            (unsigned)bench_frame_cnt,
+            (unsigned)(BENCH_VECTOR_FRAME_CNT * BENCH_PASS_CNT));
+    return false;
+  }
+
+  return true;
+}
+
+bool gps_cycle_bench_format(char *buf, size_t size) {
+  gps_cycle_bench_result_t r;
+
+  if (!gps_cycle_bench_run(&r)) {
+    return false;
+  }
+
+  int written = snprintf(buf, size,
+                         "+BENCH,%u,parse=%u.%02u,crc32=%u.%02u,ubx=%u.%02u,"
+                         "crc24q=%u.%02u cyc/B\n\r",
+                         (unsigned)r.bytes,
+                         (unsigned)(r.parse / 100), (unsigned)(r.parse % 100),
+                         (unsigned)(r.crc32 / 100), (unsigned)(r.crc32 % 100),
+                         (unsigned)(r.ubx / 100), (unsigned)(r.ubx % 100),
+                         (unsigned)(r.crc24q / 100), (unsigned)(r.crc24q % 100));
+
+  return written > 0 && (size_t)written < size;
+}
@@ -0,0 +1,41 @@
+#ifndef GPS_CYCLE_BENCH_H
+#define GPS_CYCLE_BENCH_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief 커널별 측정 결과 (byte당 DWT cycle x100)
+ */
+typedef struct {
+  uint32_t parse;   // gps_parse_process()
+  uint32_t crc32;   // crc32_update() (Unicore binary)
+  uint32_t ubx;     // ubx_calc_checksum() (UBX 디코더 없는 보드는 0)
+  uint32_t crc24q;  // rtcm_crc24q_update()
+  uint32_t bytes;   // 테스트 벡터 크기
+} gps_cycle_bench_result_t;
+
+/**
+ * @brief 파서/CRC 커널 on-target 벤치마크
+ *
+ * flash에 있는 테스트 벡터로 각 커널을 반복 실행하고 DWT cycle을 측정한다.
+ * 측정 중에는 critical section으로 선점을 막는다.
+ *
+ * @param[out] result
+ * @return true: 성공, false: 파싱 결과 불일치
+ */
+bool gps_cycle_bench_run(gps_cycle_bench_result_t *result);
+
+/**
+ * @brief 벤치마크 실행 후 결과 문자열 작성
+ *
+ * 포맷: +BENCH,<bytes>,parse=x.xx,crc32=x.xx,ubx=x.xx,crc24q=x.xx cyc/B\n\r
+ *
+ * @param[out] buf
+ * @param[in] size
+ * @return true: 성공, false: 실패
+ */
+bool gps_cycle_bench_format(char *buf, size_t size);
+
+#endif
@@ -0,0 +1,136 @@
+#include "gps_fuse.h"
+#include "app_events.h"
+#include "epoch_deadline.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+#include <string.h>
+
+#ifndef TAG
+#define TAG "GPS_FUSE"
+#endif
+
+#include "log.h"
+
+#define GPS_FUSE_POSITION 0x01U
+#define GPS_FUSE_HEADING 0x02U
+#define GPS_FUSE_BOTH (GPS_FUSE_POSITION | GPS_FUSE_HEADING)
+
+/* 두 RX 태스크와 타이머 태스크가 critical section 안에서만 접근 */
+static gps_position_t fuse_pending; // 모으는 중인 epoch
+static uint8_t fuse_have;           // 모인 반쪽 (GPS_FUSE_*)
+static gps_position_t fuse_out;     // 마지막으로 내보낸 epoch
+static bool fuse_out_valid;
+static TimerHandle_t fuse_timer;
+
+/**
+ * @brief 모으던 epoch 를 확정 (critical section 안)
+ */
+static void fuse_commit_locked(void) {
+  fuse_out = fuse_pending;
+  fuse_out_valid = true;
+  fuse_have = 0;
+}
+
+static void fuse_publish(uint8_t count) {
+  // 마지막 위치 epoch 순번 (heading 반쪽을 기다린 시간도 지연에 들어감)
+  app_evt_gps_solution_t evt = {.id = GPS_ID_BASE, .epoch = epoch_dl_seq()};
+
+  while (count--) {
+    app_event_publish(APP_EVT_GPS_SOLUTION, &evt, sizeof(evt));
+  }
+}
+
+/**
+ * @brief 반쪽 하나 추가, 이번 호출로 확정된 epoch 수를 알림
+ *
+ * 다른 iTOW 가 오면 모으던 epoch 는 빠진 반쪽을 직전 값으로 둔 채 확정한다.
+ */
+static void fuse_add(uint8_t half, uint32_t itow, const gps_position_t *pos, double heading) {
+  uint8_t committed = 0;
+  bool pending;
+
+  taskENTER_CRITICAL();
+  if (fuse_have != 0 && fuse_pending.itow != itow) {
+    fuse_commit_locked();
+    committed++;
+  }
+  if (fuse_have == 0) {
+    // 빠질 수 있는 반쪽은 직전 epoch 값으로 시작
+    fuse_pending = fuse_out;
+    fuse_pending.itow = itow;
+  }
+
+  if (half == GPS_FUSE_POSITION) {
+    double prev_heading = fuse_pending.heading;
+
+    fuse_pending = *pos;
+    fuse_pending.heading = prev_heading;
+  } else {
+    fuse_pending.heading = heading;
+  }
+  fuse_have |= half;
+
+  if (fuse_have == GPS_FUSE_BOTH) {
+    fuse_commit_locked();
+    committed++;
+  }
+  pending = fuse_have != 0;
+  taskEXIT_CRITICAL();
+
+  if (fuse_timer != NULL) {
+    if (pending) {
+      xTimerReset(fuse_timer, 0);
+    } else {
+      xTimerStop(fuse_timer, 0);
+    }
+  }
+
+  fuse_publish(committed);
+}
+
+static void fuse_timer_callback(TimerHandle_t timer) {
+  uint8_t committed = 0;
+
+  (void)timer;
+
+  taskENTER_CRITICAL();
+  if (fuse_have != 0) {
+    fuse_commit_locked();
+    committed++;
+  }
+  taskEXIT_CRITICAL();
+
+  fuse_publish(committed);
+}
+
+void gps_fuse_init(void) {
+  if (fuse_timer != NULL) {
+    return;
+  }
+
+  fuse_timer = xTimerCreate("gps_fuse", pdMS_TO_TICKS(GPS_FUSE_TIMEOUT_MS), pdFALSE, NULL,
+                            fuse_timer_callback);
+  if (fuse_timer == NULL) {
+    LOG_ERR("fuse 타이머 생성 실패, 다음 epoch 에서 확정");
+  }
+}
+
+void gps_fuse_add_position(const gps_position_t *pos) {
+  fuse_add(GPS_FUSE_POSITION, pos->itow, pos, 0.0);
+}
+
+void gps_fuse_add_heading(uint32_t itow, double heading) {
+  fuse_add(GPS_FUSE_HEADING, itow, NULL, heading);
+}
+
+bool gps_fuse_get(gps_position_t *pos) {
+  bool valid;
+
+  taskENTER_CRITICAL();
+  *pos = fuse_out;
+  valid = fuse_out_valid;
+  taskEXIT_CRITICAL();
+
+  return valid;
+}
@@ -0,0 +1,41 @@
+#ifndef GPS_FUSE_H
+#define GPS_FUSE_H
+
+#include "gps_app.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Rover F9P 의 두 수신기 항법 해를 iTOW 로 맞춰 한 epoch 로 내보낸다
+ *
+ * 위치는 GPS_ID_BASE (moving base) HPPOSLLH, heading 은 GPS_ID_ROVER
+ * RELPOSNED 에서 온다. 두 반쪽이 같은 iTOW 로 다 모이면 바로, 한쪽만
+ * 오면 GPS_FUSE_TIMEOUT_MS 뒤 또는 다음 epoch 가 시작될 때 직전 값을
+ * 채워서 내보낸다. 내보낼 때마다 APP_EVT_GPS_SOLUTION 을 한 번 게시한다.
+ */
+#define GPS_FUSE_TIMEOUT_MS 30
+
+/**
+ * @brief 타임아웃 타이머 생성 (gps_init_all, Rover F9P 에서만)
+ */
+void gps_fuse_init(void);
+
+/**
+ * @brief 위치 반쪽 (GPS_ID_BASE RX 태스크, pos->itow 기준)
+ */
+void gps_fuse_add_position(const gps_position_t *pos);
+
+/**
+ * @brief heading 반쪽 (GPS_ID_ROVER RX 태스크)
+ *
+ * @param[in] itow RELPOSNED iTOW [ms]
+ * @param[in] heading [deg]
+ */
+void gps_fuse_add_heading(uint32_t itow, double heading);
+
+/**
+ * @brief 마지막으로 내보낸 epoch (아직 없으면 false)
+ */
+bool gps_fuse_get(gps_position_t *pos);
+
+#endif
@@ -0,0 +1,89 @@
+#include "gps_gga.h"
+#include "crc.h"
+#include "fmt.h"
+
+/* GPS - UTC (2017-01-01 부터, IERS 가 바꾸면 갱신) */
+#define GPS_UTC_LEAP_S 18
+
+#define GGA_MS_PER_DAY 86400000UL
+
+/**
+ * @brief width 자리로 0 을 채운 10진수
+ */
+static void gga_put_u(fmt_t *f, uint32_t v, uint8_t width) {
+  uint32_t limit = 1;
+
+  for (uint8_t i = 1; i < width; i++) {
+    limit *= 10;
+  }
+  for (; limit > 1 && v < limit; limit /= 10) {
+    fmt_char(f, '0');
+  }
+  fmt_u32(f, v);
+}
+
+/**
+ * @brief 1e-9 deg 를 (d)ddmm.mmmmmmm 과 반구 문자로
+ */
+static void gga_put_coord(fmt_t *f, int64_t v, uint8_t deg_width, char pos, char neg) {
+  uint64_t a = v < 0 ? (uint64_t)(-v) : (uint64_t)v;
+  uint32_t deg = (uint32_t)(a / 1000000000ULL);
+  uint64_t min_e7 = (a % 1000000000ULL) * 60 / 100; // 1e-7 분
+
+  gga_put_u(f, deg, deg_width);
+  if (min_e7 < 100000000ULL) {
+    fmt_char(f, '0');
+  }
+  fmt_fixed(f, (int64_t)min_e7, 7);
+  fmt_char(f, ',');
+  fmt_char(f, v < 0 ? neg : pos);
+  fmt_char(f, ',');
+}
+
+size_t gps_gga_build(const gps_nav_data_t *nav, char *buf, size_t size) {
+  static const char hex[] = "0123456789ABCDEF";
+  uint32_t utc_ms;
+  float dop;
+  uint8_t cs;
+  fmt_t f;
+
+  if (nav->itow_tick == 0) {
+    return 0;
+  }
+
+  utc_ms = (nav->itow + GGA_MS_PER_DAY - GPS_UTC_LEAP_S * 1000UL) % GGA_MS_PER_DAY;
+  dop = nav->hdop > 0 ? (float)nav->hdop : nav->pdop;
+
+  fmt_init(&f, buf, size);
+  fmt_str(&f, "$GPGGA,");
+  gga_put_u(&f, utc_ms / 3600000, 2);
+  gga_put_u(&f, utc_ms / 60000 % 60, 2);
+  gga_put_u(&f, utc_ms / 1000 % 60, 2);
+  fmt_char(&f, '.');
+  gga_put_u(&f, utc_ms % 1000 / 10, 2);
+  fmt_char(&f, ',');
+  gga_put_coord(&f, nav->llh.lat, 2, 'N', 'S');
+  gga_put_coord(&f, nav->llh.lon, 3, 'E', 'W');
+  fmt_u32(&f, nav->fix);
+  fmt_char(&f, ',');
+  gga_put_u(&f, nav->sat_num, 2);
+  fmt_char(&f, ',');
+  fmt_fixed(&f, (int64_t)(dop * 10 + 0.5f), 1);
+  fmt_char(&f, ',');
+  fmt_fixed(&f, gps_llh_alt_to_mm(nav->llh.msl_alt), 3);
+  fmt_str(&f, ",M,");
+  fmt_fixed(&f, gps_llh_alt_to_mm(nav->llh.ellipsoid_alt - nav->llh.msl_alt), 3);
+  fmt_str(&f, ",M,,");
+
+  if (f.overflow || f.len + 6 > size) {
+    return 0;
+  }
+
+  cs = nmea_checksum(buf + 1, f.len - 1);
+  fmt_char(&f, '*');
+  fmt_char(&f, hex[cs >> 4]);
+  fmt_char(&f, hex[cs & 0x0F]);
+  fmt_str(&f, "\r\n");
+
+  return fmt_end(&f);
+}
@@ -0,0 +1,23 @@
+#ifndef GPS_GGA_H
+#define GPS_GGA_H
+
+#include "gps_nav.h"
+#include <stddef.h>
+
+/* 생성하는 GGA 최대 길이 (NUL 제외, NTRIP_GGA_MAX_LEN 보다 작게) */
+#define GPS_GGA_MAX_LEN 96
+
+/**
+ * @brief 바이너리 항법 해로 GGA 문장 생성 (수신기 NMEA 없이 캐스터 업로드용)
+ *
+ * 시간은 itow 에서 GPS-UTC 윤초를 빼서, 위치는 nav 의 고정소수점 값을
+ * 그대로 (분 소수 7 자리) 쓴다. hdop 이 없으면 (NMEA 끔) pdop 을 넣는다.
+ *
+ * @param[in] nav 항법 해 (fix 가 있어야 함)
+ * @param[out] buf "\r\n" 까지 들어간 문장
+ * @param[in] size buf 크기
+ * @return size_t 문장 길이 (NUL 제외), 실패하면 0
+ */
+size_t gps_gga_build(const gps_nav_data_t *nav, char *buf, size_t size);
+
+#endif
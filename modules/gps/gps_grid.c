@@ -0,0 +1,221 @@
+#include "gps_grid.h"
+#include "flash_params.h"
+#include "stm32f4xx.h"
+#include "FreeRTOS.h"
+#include "semphr.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef TAG
+#define TAG "GPS_GRID"
+#endif
+
+#include "log.h"
+
+/* 기준점 (grid_proj) 을 고치므로 변환은 하나씩 */
+static SemaphoreHandle_t grid_mutex;
+static StaticSemaphore_t grid_mutex_buf;
+
+static gps_proj_t grid_proj;
+static gps_grid_params_t grid_cfg; // grid_proj 에 반영한 설정
+static uint32_t grid_version;
+static bool grid_loaded;
+static bool grid_valid;
+static uint32_t grid_anchor_cyc;
+static uint32_t grid_fwd_cyc;
+
+/**
+ * @brief 저장된 설정으로 grid_proj 다시 만들기
+ */
+static void gps_grid_load(const gps_grid_params_t *cfg) {
+  gps_proj_def_t def = {0};
+
+  def.utm = cfg->mode == GPS_GRID_UTM;
+  if (def.utm) {
+    uint32_t zone = cfg->zone;
+
+    def.south = zone > GPS_GRID_ZONE_SOUTH;
+    if (def.south) {
+      zone -= GPS_GRID_ZONE_SOUTH;
+    }
+    def.zone = (uint8_t)(zone <= 60 ? zone : UINT8_MAX); // 범위 밖은 setup 에서 거름
+  }
+  def.lat0 = cfg->lat0;
+  def.lon0 = cfg->lon0;
+  def.k0 = cfg->k0;
+  def.fe = cfg->fe;
+  def.fn = cfg->fn;
+  def.ell = (uint8_t)(cfg->ell < GPS_PROJ_ELL_MAX ? cfg->ell : GPS_PROJ_ELL_MAX);
+
+  for (int i = 0; i < 7; i++) {
+    def.helmert |= cfg->shift[i] != 0.0;
+  }
+  def.tx = cfg->shift[0];
+  def.ty = cfg->shift[1];
+  def.tz = cfg->shift[2];
+  def.rx = cfg->shift[3];
+  def.ry = cfg->shift[4];
+  def.rz = cfg->shift[5];
+  def.ds = cfg->shift[6];
+
+  grid_valid = gps_proj_setup(&grid_proj, &def);
+  if (!grid_valid) {
+    LOG_WARN("grid: bad projection (mode %lu zone %lu ell %lu)", cfg->mode, cfg->zone,
+             cfg->ell);
+  }
+}
+
+void gps_grid_init(void) {
+  grid_mutex = xSemaphoreCreateMutexStatic(&grid_mutex_buf);
+}
+
+bool gps_grid_enabled(void) {
+  uint32_t mode = flash_params_snapshot(NULL)->gps_grid.mode;
+
+  return mode == GPS_GRID_UTM || mode == GPS_GRID_TM;
+}
+
+bool gps_grid_convert(const gps_position_t *pos, gps_proj_xy_t *out) {
+  bool ok = false;
+
+  if (!grid_mutex || pos->fix <= 0 || !gps_grid_enabled()) {
+    return false;
+  }
+
+  xSemaphoreTake(grid_mutex, portMAX_DELAY);
+
+  if (!grid_loaded || flash_params_changed(&grid_version)) {
+    const gps_grid_params_t *cfg = &flash_params_snapshot(NULL)->gps_grid;
+
+    // 다른 설정만 바뀐 것이면 기준점을 그대로 둔다
+    if (!grid_loaded || memcmp(cfg, &grid_cfg, sizeof(grid_cfg)) != 0) {
+      grid_cfg = *cfg;
+      gps_grid_load(&grid_cfg);
+      grid_loaded = true;
+    }
+  }
+
+  if (grid_valid) {
+    uint32_t anchors = grid_proj.anchors;
+    uint32_t start = DWT->CYCCNT;
+
+    gps_proj_forward(&grid_proj, &pos->llh, out);
+
+    uint32_t cyc = DWT->CYCCNT - start;
+    if (grid_proj.anchors != anchors) {
+      grid_anchor_cyc = cyc;
+    } else {
+      grid_fwd_cyc = cyc;
+    }
+    ok = true;
+  }
+
+  xSemaphoreGive(grid_mutex);
+
+  return ok;
+}
+
+void gps_grid_get_info(gps_grid_info_t *out) {
+  out->anchors = grid_proj.anchors;
+  out->anchor_cyc = grid_anchor_cyc;
+  out->fwd_cyc = grid_fwd_cyc;
+  out->valid = grid_loaded && grid_valid && gps_grid_enabled();
+}
+
+/** ',' 뒤의 숫자 하나 */
+static bool gps_grid_next(const char **s, double *v) {
+  char *end;
+
+  if (**s != ',') {
+    return false;
+  }
+  *v = strtod(*s + 1, &end);
+  if (end == *s + 1 || !isfinite(*v)) {
+    return false;
+  }
+  *s = end;
+  return true;
+}
+
+/** 이전 버전 flash (0xFF, double 은 NaN) 면 0 부터 */
+static void gps_grid_clean(gps_grid_params_t *g) {
+  if (g->mode > GPS_GRID_TM) {
+    memset(g, 0, sizeof(*g));
+  }
+}
+
+bool gps_grid_parse(const char *s, gps_grid_params_t *cfg) {
+  gps_grid_params_t g = *cfg;
+  char *end;
+  unsigned long mode = strtoul(s, &end, 10);
+
+  if (end == s) {
+    return false;
+  }
+  s = end;
+  gps_grid_clean(&g);
+  g.mode = (uint32_t)mode;
+
+  if (mode == GPS_GRID_UTM) {
+    unsigned long zone = 0;
+
+    if (*s == ',') {
+      zone = strtoul(s + 1, &end, 10);
+      if (end == s + 1) {
+        return false;
+      }
+    }
+    if (zone > GPS_GRID_ZONE_SOUTH + 60 || (zone > 60 && zone <= GPS_GRID_ZONE_SOUTH)) {
+      return false;
+    }
+    g.zone = (uint32_t)zone;
+  } else if (mode == GPS_GRID_TM) {
+    double v[5];
+
+    for (int i = 0; i < 5; i++) {
+      if (!gps_grid_next(&s, &v[i])) {
+        return false;
+      }
+    }
+    if (fabs(v[0]) > 90.0 || fabs(v[1]) > 180.0 || !(v[2] > 0.5 && v[2] < 1.5)) {
+      return false;
+    }
+    g.lat0 = v[0];
+    g.lon0 = v[1];
+    g.k0 = v[2];
+    g.fe = v[3];
+    g.fn = v[4];
+  } else if (mode != GPS_GRID_OFF) {
+    return false;
+  }
+
+  *cfg = g;
+  return true;
+}
+
+bool gps_grid_parse_datum(const char *s, gps_grid_params_t *cfg) {
+  // 변환 값 한계: 이동 [m], 회전 [arcsec], 축척 [ppm] (실제 datum 보다 넉넉히)
+  static const double limit[7] = {5000, 5000, 5000, 100, 100, 100, 1000};
+  double shift[7] = {0};
+  char *end;
+  unsigned long ell = strtoul(s, &end, 10);
+
+  if (end == s || ell >= GPS_PROJ_ELL_MAX) {
+    return false;
+  }
+  s = end;
+
+  if (*s == ',') {
+    for (int i = 0; i < 7; i++) {
+      if (!gps_grid_next(&s, &shift[i]) || fabs(shift[i]) > limit[i]) {
+        return false;
+      }
+    }
+  }
+
+  gps_grid_clean(cfg);
+  cfg->ell = (uint32_t)ell;
+  memcpy(cfg->shift, shift, sizeof(shift));
+  return true;
+}
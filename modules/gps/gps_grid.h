@@ -0,0 +1,74 @@
+#ifndef GPS_GRID_H
+#define GPS_GRID_H
+
+#include "gps_app.h"
+#include "gps_proj.h"
+#include "flash_params.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * 평면 좌표 (TM/UTM) 출력
+ *
+ * 출력용 위치를 user_params_t.gps_grid 설정으로 투영한다 (필요하면 7 변수
+ * datum 변환 포함). 계산은 gps_proj.h 의 기준점 다항식이라 해마다 float 몇
+ * 십 번이고, 기준점을 새로 잡을 때만 double 로 약 1 ms 든다.
+ * 설정은 AT+GRID / AT+GRIDDS (BLE GR+ / GE+) 이고 저장하면 바로 적용된다.
+ */
+typedef enum {
+  GPS_GRID_OFF = 0,
+  GPS_GRID_UTM = 1,
+  GPS_GRID_TM = 2,
+} gps_grid_mode_t;
+
+/* gps_grid_params_t.zone: 남반구 고정 zone */
+#define GPS_GRID_ZONE_SOUTH 100
+
+typedef struct {
+  uint32_t anchors;    // 기준점을 잡은 횟수
+  uint32_t anchor_cyc; // 마지막 기준점 계산 [DWT cycle]
+  uint32_t fwd_cyc;    // 마지막 변환 (기준점 안) [DWT cycle]
+  bool valid;          // 설정이 올바름 (꺼져 있으면 false)
+} gps_grid_info_t;
+
+/**
+ * @brief 잠금 생성 (flash_params_init 뒤)
+ */
+void gps_grid_init(void);
+
+/**
+ * @brief 설정으로 평면 좌표 출력이 켜져 있는지
+ */
+bool gps_grid_enabled(void);
+
+/**
+ * @brief 위치를 평면 좌표로 (여러 태스크에서 불러도 됨)
+ *
+ * @return false 꺼져 있음, 설정이 잘못됨, 또는 fix 없음
+ */
+bool gps_grid_convert(const gps_position_t *pos, gps_proj_xy_t *out);
+
+void gps_grid_get_info(gps_grid_info_t *out);
+
+/**
+ * @brief 투영 설정 문자열 (AT+GRID= / GR+) 을 cfg 에 반영
+ *
+ * 형식: 0 (끔) | 1[,zone] (UTM, zone 0 자동, 1~60, 101~160 남반구)
+ *       | 2,lat0,lon0,k0,fe,fn (TM, [deg], [m])
+ * datum (ell/shift) 은 그대로 둔다.
+ *
+ * @return false 형식/범위 오류 (cfg 는 그대로)
+ */
+bool gps_grid_parse(const char *s, gps_grid_params_t *cfg);
+
+/**
+ * @brief datum 설정 문자열 (AT+GRIDDS= / GE+) 을 cfg 에 반영
+ *
+ * 형식: ell[,tx,ty,tz,rx,ry,rz,ds] (gps_proj_ell_t, [m], [arcsec], [ppm])
+ * 변환 값이 없으면 datum 변환 없이 ell 타원체로 투영한다.
+ *
+ * @return false 형식/범위 오류 (cfg 는 그대로)
+ */
+bool gps_grid_parse_datum(const char *s, gps_grid_params_t *cfg);
+
+#endif
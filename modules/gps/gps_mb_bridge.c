@@ -0,0 +1,70 @@
+#include "gps_mb_bridge.h"
+#include "gps_port.h"
+
+#ifndef TAG
+#define TAG "GPS_MB"
+#endif
+
+#include "log.h"
+
+/* GPS1 RX 태스크 하나만 쓴다 (AT 쪽은 읽기만) */
+static gps_mb_bridge_stats_t mb_stats;
+
+/**
+ * @brief rover 가 moving base 로 heading 을 푸는 데 쓰는 메시지
+ */
+static inline bool gps_mb_bridge_type(uint16_t type) {
+  if (type == 4072 || type == 1005 || type == 1006 || type == 1230) {
+    return true;
+  }
+  return type >= 1071 && type <= 1137 && (type % 10) >= 1 && (type % 10) <= 7;
+}
+
+/**
+ * @brief 검증된 RTCM 프레임 하나를 다리로 (GPS_SUB_ANY 구독 콜백)
+ */
+static void gps_mb_bridge_on_rtcm(gps_t *gps, gps_procotol_t protocol, gps_msg_t msg,
+                                  void *ctx) {
+  gps_frame_t f;
+
+  (void)protocol;
+  (void)ctx;
+
+  if (!gps_mb_bridge_type(msg.rtcm.msg_type) || !gps_get_frame(gps, &f)) {
+    return;
+  }
+
+  // 링 끝에서 나뉜 프레임도 송신 링에는 이어서 한 프레임으로
+  uart_tx_seg_t segs[2] = {
+      {.data = f.seg[0], .len = f.len[0]},
+      {.data = f.seg[1], .len = f.len[1]},
+  };
+  size_t n = gps_port_bridge_write(GPS_ID_ROVER, segs, f.len[1] ? 2 : 1);
+
+  if (n == 0) {
+    mb_stats.dropped++;
+    return;
+  }
+  mb_stats.frames++;
+  mb_stats.bytes += n;
+}
+
+void gps_mb_bridge_attach(gps_t *gps, gps_id_t id) {
+  if (!USE_GPS_MB_BRIDGE || id != GPS_ID_BASE) {
+    return;
+  }
+
+  if (!gps_subscribe(gps, GPS_PROTOCOL_RTCM, GPS_SUB_ANY, gps_mb_bridge_on_rtcm, NULL)) {
+    LOG_WARN("GPS[%d] moving base bridge subscribe failed", id);
+  }
+}
+
+bool gps_mb_bridge_active(void) {
+#if USE_GPS_MB_BRIDGE
+  return gps_port_has_bridge(GPS_ID_ROVER);
+#else
+  return false;
+#endif
+}
+
+void gps_mb_bridge_get_stats(gps_mb_bridge_stats_t *stats) { *stats = mb_stats; }
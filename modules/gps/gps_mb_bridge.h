@@ -0,0 +1,37 @@
+#ifndef GPS_MB_BRIDGE_H
+#define GPS_MB_BRIDGE_H
+
+#include "gps.h"
+#include "board_config.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * moving base RTCM 다리 (USE_GPS_MB_BRIDGE, GPS1 -> GPS2)
+ *
+ * GPS1 RX 태스크의 RTCM 구독 콜백에서 파서가 헤더/CRC 만 본 프레임 가운데
+ * heading 에 필요한 것 (4072.x, 1005/1006, MSM, 1230) 을 골라 RX 링 구간
+ * 그대로 GPS2 UART 송신 링에 프레임 하나로 넣는다. 이벤트 버스와 TX 태스크
+ * (gps_send_raw_data) 를 거치지 않고 DMA 가 프레임 경계에서 보내므로 지연은
+ * 링 복사 한 번이다. 링이 모자라면 프레임을 통째로 버리고 센다.
+ */
+
+typedef struct {
+  uint32_t frames;  /**< 보낸 프레임 */
+  uint32_t bytes;   /**< 송신 링에 넣은 byte */
+  uint32_t dropped; /**< 송신 링이 모자라 버린 프레임 */
+} gps_mb_bridge_stats_t;
+
+/**
+ * @brief 수신기 구독 등록 (RX 태스크 시작 때, 수신기마다, 다리가 없으면 무시)
+ */
+void gps_mb_bridge_attach(gps_t *gps, gps_id_t id);
+
+/**
+ * @return bool 다리가 켜져 있음 (통계가 의미 있음)
+ */
+bool gps_mb_bridge_active(void);
+
+void gps_mb_bridge_get_stats(gps_mb_bridge_stats_t *stats);
+
+#endif
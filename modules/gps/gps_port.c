@@ -11,6 +11,11 @@
 #include "stm32f4xx_ll_usart.h"
 #include "stm32f4xx_ll_utils.h"
 #include "f9p_baudrate_config.h"
+#include "uart_tx.h"
+#include "irq_latency.h"
+#include "trace_marker.h"
+#include "boot_timeline.h"
+#include "dma_ring.h"
 
 #ifndef TAG
 #define TAG "GPS_PORT"
@@ -18,135 +23,304 @@
 
 #include "log.h"
 
-static char gps_recv_buf[GPS_CNT][2048];
-static QueueHandle_t gps_queues[GPS_CNT] = {NULL};
+/* 부팅 직후 수신기 기본 속도 (F9P 는 38400 에서 gps_rate_uart_baud 로 올린다) */
+#define GPS_PORT_BOOT_BAUD(type) ((type) == GPS_TYPE_F9P ? 38400U : 115200U)
 
-static gps_type_t uart2_gps_type = GPS_TYPE_F9P;
-static gps_type_t uart4_gps_type = GPS_TYPE_F9P;
-static gps_id_t uart2_gps_id = GPS_ID_BASE;
-static gps_id_t uart4_gps_id = GPS_ID_ROVER;
+/* DMA LISR/HISR 안에서 stream 별 플래그 위치 (stream % 4) */
+static const uint8_t dma_flag_shift[4] = {0, 6, 16, 22};
 
-
-static const gps_hal_ops_t gps_rtk_uart4_ops;
+#define DMA_STREAM_FLAG_FE (1U << 0)
+#define DMA_STREAM_FLAG_DME (1U << 2)
+#define DMA_STREAM_FLAG_TE (1U << 3)
+#define DMA_STREAM_FLAG_HT (1U << 4)
+#define DMA_STREAM_FLAG_TC (1U << 5)
+#define DMA_STREAM_FLAG_ALL                                                    \
+  (DMA_STREAM_FLAG_FE | DMA_STREAM_FLAG_DME | DMA_STREAM_FLAG_TE |             \
+   DMA_STREAM_FLAG_HT | DMA_STREAM_FLAG_TC)
 
 /**
- * @brief USART2 Initialization Function
- * @param None
- * @retval None
+ * @brief GPS 수신기 하나가 붙는 UART 포트 기술자
+ *
+ * 수신기 수만큼 gps_port_desc[] 에 두고 init/ISR/cleanup 은 이 값으로만
+ * 동작한다. 수신기를 늘릴 때는 링 크기, 항목 하나, 벡터 wrapper 만 추가한다.
  */
-static void gps_uart2_init(void)
-{
-  /* USER CODE BEGIN USART2_Init 0 */
-  /* USER CODE END USART2_Init 0 */
-
-  LL_USART_InitTypeDef USART_InitStruct = {0};
-
-  LL_GPIO_InitTypeDef GPIO_InitStruct = {0};
-
-  /* Peripheral clock enable */
-  LL_APB1_GRP1_EnableClock(LL_APB1_GRP1_PERIPH_USART2);
-
-  LL_AHB1_GRP1_EnableClock(LL_AHB1_GRP1_PERIPH_GPIOA);
-  /**USART2 GPIO Configuration
-  PA2   ------> USART2_TX
-  PA3   ------> USART2_RX
-  */
-  GPIO_InitStruct.Pin = LL_GPIO_PIN_2 | LL_GPIO_PIN_3;
-  GPIO_InitStruct.Mode = LL_GPIO_MODE_ALTERNATE;
-  GPIO_InitStruct.Speed = LL_GPIO_SPEED_FREQ_VERY_HIGH;
-  GPIO_InitStruct.OutputType = LL_GPIO_OUTPUT_PUSHPULL;
-  GPIO_InitStruct.Pull = LL_GPIO_PULL_NO;
-  GPIO_InitStruct.Alternate = LL_GPIO_AF_7;
-  LL_GPIO_Init(GPIOA, &GPIO_InitStruct);
+typedef struct {
+  const char *name;
+  USART_TypeDef *uart;
+  uint32_t uart_clk; /**< LL_APB1_GRP1_PERIPH_xxx */
+  IRQn_Type uart_irq;
+
+  GPIO_TypeDef *gpio; /**< TX/RX 핀 포트 */
+  uint32_t gpio_clk;  /**< LL_AHB1_GRP1_PERIPH_GPIOx */
+  uint32_t pins;      /**< TX | RX */
+  uint32_t af;
+  GPIO_TypeDef *reset_gpio; /**< 수신기 RESET 핀 (high = 동작) */
+  uint16_t reset_pin;
+
+  DMA_TypeDef *dma;
+  uint32_t dma_clk; /**< LL_AHB1_GRP1_PERIPH_DMAx */
+  uint32_t rx_stream;
+  uint32_t rx_channel;
+  IRQn_Type rx_irq;
+  uint32_t tx_stream;
+  uint32_t tx_channel;
+  IRQn_Type tx_irq;
+
+  char *ring;
+  uint32_t ring_size;
+  uint32_t baud; /**< 부팅 직후 속도 */
+  bool corr;     /**< 보정 데이터 송신 링 연결 */
+  bool bridge;   /**< moving base RTCM 다리 송신 링 연결 (USE_GPS_MB_BRIDGE) */
+} gps_port_desc_t;
+
+/* IDLE 시각 기록 개수 (수신 태스크가 밀려도 직전 burst 몇 개는 찾을 수 있게) */
+#define GPS_PORT_IDLE_STAMPS 4
 
-  /* USART2 DMA Init */
-
-  /* USART2_RX Init */
-  LL_DMA_SetChannelSelection(DMA1, LL_DMA_STREAM_5, LL_DMA_CHANNEL_4);
-
-  LL_DMA_SetDataTransferDirection(DMA1, LL_DMA_STREAM_5,
-                                  LL_DMA_DIRECTION_PERIPH_TO_MEMORY);
-
-  LL_DMA_SetStreamPriorityLevel(DMA1, LL_DMA_STREAM_5, LL_DMA_PRIORITY_LOW);
-
-  LL_DMA_SetMode(DMA1, LL_DMA_STREAM_5, LL_DMA_MODE_CIRCULAR);
-
-  LL_DMA_SetPeriphIncMode(DMA1, LL_DMA_STREAM_5, LL_DMA_PERIPH_NOINCREMENT);
+/**
+ * @brief UART IDLE 시각
+ *
+ * IDLE 은 마지막 byte 뒤 한 문자 시간이 지나서 뜬다. 그 burst 안의 byte 는
+ * 모두 끊김 없이 왔으므로 count 와의 차이로 각 byte 의 도착 시각을 거꾸로
+ * 계산할 수 있다.
+ */
+typedef struct {
+  uint32_t count; /**< IDLE 때 gps_port_get_rx_count() */
+  uint32_t cyc;   /**< IDLE 때 DWT->CYCCNT */
+} gps_port_idle_stamp_t;
 
-  LL_DMA_SetMemoryIncMode(DMA1, LL_DMA_STREAM_5, LL_DMA_MEMORY_INCREMENT);
+/**
+ * @brief 포트 런타임 상태
+ *
+ */
+typedef struct {
+  uart_tx_t tx;
+  gps_type_t type;
+  /* DMA TC (링 끝 도달) 횟수, 수신 태스크가 한 바퀴 이상 밀렸는지 판단용 */
+  volatile uint32_t laps;
+  TaskHandle_t task;
+  gps_port_idle_stamp_t idle[GPS_PORT_IDLE_STAMPS];
+  volatile uint32_t idle_seq; /**< 기록한 IDLE 수 (다음 칸 = idle_seq % N) */
+} gps_port_state_t;
+
+#if GPS_CNT > 0
+static char gps1_recv_buf[GPS1_RX_RING_SIZE];
+#endif
+#if GPS_CNT > 1
+static char gps2_recv_buf[GPS2_RX_RING_SIZE];
+#endif
 
-  LL_DMA_SetPeriphSize(DMA1, LL_DMA_STREAM_5, LL_DMA_PDATAALIGN_BYTE);
+/* GPS ID 순서 (GPS1 = GPS_ID_BASE, GPS2 = GPS_ID_ROVER) */
+static const gps_port_desc_t gps_port_desc[GPS_ID_MAX] = {
+#if GPS_CNT > 0
+    [GPS_ID_BASE] =
+        {
+            .name = "USART2",
+            .uart = USART2,
+            .uart_clk = LL_APB1_GRP1_PERIPH_USART2,
+            .uart_irq = USART2_IRQn,
+            .gpio = GPIOA, // PA2 TX, PA3 RX
+            .gpio_clk = LL_AHB1_GRP1_PERIPH_GPIOA,
+            .pins = LL_GPIO_PIN_2 | LL_GPIO_PIN_3,
+            .af = LL_GPIO_AF_7,
+            .reset_gpio = GPIOA,
+            .reset_pin = GPIO_PIN_5,
+            .dma = DMA1,
+            .dma_clk = LL_AHB1_GRP1_PERIPH_DMA1,
+            .rx_stream = LL_DMA_STREAM_5,
+            .rx_channel = LL_DMA_CHANNEL_4,
+            .rx_irq = DMA1_Stream5_IRQn,
+            .tx_stream = LL_DMA_STREAM_6,
+            .tx_channel = LL_DMA_CHANNEL_4,
+            .tx_irq = DMA1_Stream6_IRQn,
+            .ring = gps1_recv_buf,
+            .ring_size = GPS1_RX_RING_SIZE,
+            .baud = GPS_PORT_BOOT_BAUD(GPS1_TYPE),
+            .corr = true,
+        },
+#endif
+#if GPS_CNT > 1
+    [GPS_ID_ROVER] =
+        {
+            .name = "UART4",
+            .uart = UART4,
+            .uart_clk = LL_APB1_GRP1_PERIPH_UART4,
+            .uart_irq = UART4_IRQn,
+            .gpio = GPIOA, // PA0 TX, PA1 RX
+            .gpio_clk = LL_AHB1_GRP1_PERIPH_GPIOA,
+            .pins = LL_GPIO_PIN_0 | LL_GPIO_PIN_1,
+            .af = LL_GPIO_AF_8,
+            .reset_gpio = GPIOA,
+            .reset_pin = GPIO_PIN_8,
+            .dma = DMA1,
+            .dma_clk = LL_AHB1_GRP1_PERIPH_DMA1,
+            .rx_stream = LL_DMA_STREAM_2,
+            .rx_channel = LL_DMA_CHANNEL_4,
+            .rx_irq = DMA1_Stream2_IRQn,
+            .tx_stream = LL_DMA_STREAM_4,
+            .tx_channel = LL_DMA_CHANNEL_4,
+            .tx_irq = DMA1_Stream4_IRQn,
+            .ring = gps2_recv_buf,
+            .ring_size = GPS2_RX_RING_SIZE,
+            .baud = GPS_PORT_BOOT_BAUD(GPS2_TYPE),
+            .corr = false,
+            .bridge = USE_GPS_MB_BRIDGE,
+        },
+#endif
+};
 
-  LL_DMA_SetMemorySize(DMA1, LL_DMA_STREAM_5, LL_DMA_MDATAALIGN_BYTE);
+_Static_assert(GPS_CNT <= GPS_ID_MAX, "GPS_CNT exceeds GPS_ID_MAX");
 
-  LL_DMA_DisableFifoMode(DMA1, LL_DMA_STREAM_5);
+static gps_port_state_t gps_port_state[GPS_ID_MAX];
+static uint8_t gps_corr_tx_buf[GPS_CORR_TX_RING_SIZE];
+static uart_tx_stream_t gps_corr;
+static gps_id_t gps_corr_id = GPS_ID_MAX;
+#if USE_GPS_MB_BRIDGE
+static uint8_t gps_mb_tx_buf[GPS_MB_TX_RING_SIZE];
+static uart_tx_stream_t gps_mb;
+#endif
+static volatile gps_id_t gps_mb_id = GPS_ID_MAX;
 
-  /* USART2 interrupt Init */
-  NVIC_SetPriority(USART2_IRQn,
-                   NVIC_EncodePriority(NVIC_GetPriorityGrouping(), 5, 0));
-  NVIC_EnableIRQ(USART2_IRQn);
+static inline const gps_port_desc_t *gps_port_get_desc(gps_id_t id)
+{
+  if (id >= GPS_CNT || !gps_port_desc[id].uart)
+  {
+    return NULL;
+  }
+  return &gps_port_desc[id];
+}
 
-  /* USER CODE BEGIN USART2_Init 1 */
+static inline uint32_t dma_rx_get_flags(const gps_port_desc_t *d)
+{
+  uint32_t isr = (d->rx_stream < 4) ? d->dma->LISR : d->dma->HISR;
+  return (isr >> dma_flag_shift[d->rx_stream & 3]) & DMA_STREAM_FLAG_ALL;
+}
 
-  /* USER CODE END USART2_Init 1 */
-  const board_config_t *config = board_get_config();
-  if(config->board == BOARD_TYPE_ROVER_F9P || config->board == BOARD_TYPE_BASE_F9P)
+static inline void dma_rx_clear_flags(const gps_port_desc_t *d, uint32_t flags)
+{
+  if (d->rx_stream < 4)
   {
-    USART_InitStruct.BaudRate = 38400;
+    d->dma->LIFCR = flags << dma_flag_shift[d->rx_stream & 3];
   }
   else
   {
-    USART_InitStruct.BaudRate = 115200;
+    d->dma->HIFCR = flags << dma_flag_shift[d->rx_stream & 3];
   }
-  USART_InitStruct.DataWidth = LL_USART_DATAWIDTH_8B;
-  USART_InitStruct.StopBits = LL_USART_STOPBITS_1;
-  USART_InitStruct.Parity = LL_USART_PARITY_NONE;
-  USART_InitStruct.TransferDirection = LL_USART_DIRECTION_TX_RX;
-  USART_InitStruct.HardwareFlowControl = LL_USART_HWCONTROL_NONE;
-  USART_InitStruct.OverSampling = LL_USART_OVERSAMPLING_16;
-  LL_USART_Init(USART2, &USART_InitStruct);
-  LL_USART_ConfigAsyncMode(USART2);
-  /* USER CODE BEGIN USART2_Init 2 */
+}
 
-  /* USER CODE END USART2_Init 2 */
+/**
+ * @brief 수신 태스크 깨우기 (ISR 전용)
+ *
+ * 태스크 notification 값만 올리므로 여러 번 불려도 한번에 처리된다.
+ *
+ * @param id GPS ID
+ * @param woken portYIELD_FROM_ISR 용 플래그
+ */
+static inline void gps_port_notify_from_isr(gps_id_t id, BaseType_t *woken)
+{
+  if (id < GPS_CNT && gps_port_state[id].task)
+  {
+    vTaskNotifyGiveFromISR(gps_port_state[id].task, woken);
+  }
 }
 
 /**
- * Enable DMA controller clock
+ * @brief UART, GPIO, RX DMA 설정
+ *
  */
-static void gps_uart2_dma_init(void)
+static void gps_port_hw_config(const gps_port_desc_t *d)
 {
+  LL_USART_InitTypeDef USART_InitStruct = {0};
+  LL_GPIO_InitTypeDef GPIO_InitStruct = {0};
 
   /* DMA controller clock enable */
-  __HAL_RCC_DMA1_CLK_ENABLE();
+  LL_AHB1_GRP1_EnableClock(d->dma_clk);
+  NVIC_SetPriority(d->rx_irq, UART_NVIC_PRIO(GPS_RX_IRQ_PRIO));
+  NVIC_EnableIRQ(d->rx_irq);
+
+  /* Peripheral clock enable */
+  LL_APB1_GRP1_EnableClock(d->uart_clk);
+  LL_AHB1_GRP1_EnableClock(d->gpio_clk);
+
+  GPIO_InitStruct.Pin = d->pins;
+  GPIO_InitStruct.Mode = LL_GPIO_MODE_ALTERNATE;
+  GPIO_InitStruct.Speed = LL_GPIO_SPEED_FREQ_VERY_HIGH;
+  GPIO_InitStruct.OutputType = LL_GPIO_OUTPUT_PUSHPULL;
+  GPIO_InitStruct.Pull = LL_GPIO_PULL_NO;
+  GPIO_InitStruct.Alternate = d->af;
+  LL_GPIO_Init(d->gpio, &GPIO_InitStruct);
 
-  /* DMA interrupt init */
-  /* DMA1_Stream5_IRQn interrupt configuration */
-  NVIC_SetPriority(DMA1_Stream5_IRQn,
-                   NVIC_EncodePriority(NVIC_GetPriorityGrouping(), 5, 0));
-  NVIC_EnableIRQ(DMA1_Stream5_IRQn);
+  /* RX DMA Init */
+  LL_DMA_SetChannelSelection(d->dma, d->rx_stream, d->rx_channel);
+  LL_DMA_SetDataTransferDirection(d->dma, d->rx_stream,
+                                  LL_DMA_DIRECTION_PERIPH_TO_MEMORY);
+  LL_DMA_SetStreamPriorityLevel(d->dma, d->rx_stream,
+                                UART_DMA_PRIO(GPS_RX_DMA_PRIO));
+  LL_DMA_SetMode(d->dma, d->rx_stream, LL_DMA_MODE_CIRCULAR);
+  LL_DMA_SetPeriphIncMode(d->dma, d->rx_stream, LL_DMA_PERIPH_NOINCREMENT);
+  LL_DMA_SetMemoryIncMode(d->dma, d->rx_stream, LL_DMA_MEMORY_INCREMENT);
+  LL_DMA_SetPeriphSize(d->dma, d->rx_stream, LL_DMA_PDATAALIGN_BYTE);
+  LL_DMA_SetMemorySize(d->dma, d->rx_stream, LL_DMA_MDATAALIGN_BYTE);
+  LL_DMA_DisableFifoMode(d->dma, d->rx_stream);
+
+  /* UART interrupt Init */
+  NVIC_SetPriority(d->uart_irq, UART_NVIC_PRIO(GPS_RX_IRQ_PRIO));
+  NVIC_EnableIRQ(d->uart_irq);
+
+  USART_InitStruct.BaudRate = d->baud;
+  USART_InitStruct.DataWidth = LL_USART_DATAWIDTH_8B;
+  USART_InitStruct.StopBits = LL_USART_STOPBITS_1;
+  USART_InitStruct.Parity = LL_USART_PARITY_NONE;
+  USART_InitStruct.TransferDirection = LL_USART_DIRECTION_TX_RX;
+  USART_InitStruct.HardwareFlowControl = LL_USART_HWCONTROL_NONE;
+  USART_InitStruct.OverSampling = LL_USART_OVERSAMPLING_16;
+  LL_USART_Init(d->uart, &USART_InitStruct);
+  LL_USART_ConfigAsyncMode(d->uart);
 }
 
 /**
  * @brief GPS 하드웨어 초기화
  *
  */
-int gps_rtk_uart2_init(void)
+static int gps_port_hw_init(gps_id_t id)
 {
-  gps_uart2_dma_init();
-  gps_uart2_init();
+  const gps_port_desc_t *d = gps_port_get_desc(id);
+  gps_port_state_t *st = &gps_port_state[id];
 
-  const board_config_t *config = board_get_config();
-  if(config->board == BOARD_TYPE_ROVER_F9P || config->board == BOARD_TYPE_BASE_F9P)
+  if (!d)
   {
-    // F9P 보드일 경우 보드레이트를 115200으로 변경 (DMA 활성화 전)
-    LOG_INFO("Changing F9P UART1 baudrate to 115200...");
-    gps_rtk_gpio_start();
-    LL_USART_Enable(USART2);
-    f9p_init_uart1_baudrate_115200();
-    LL_USART_Disable(USART2);
+    return -1;
   }
 
+  gps_port_hw_config(d);
+  uart_tx_init(&st->tx, d->uart, d->dma, d->tx_stream, d->tx_channel,
+               d->tx_irq, GPS_TX_DMA_PRIO, GPS_TX_IRQ_PRIO);
+  if (d->corr)
+  {
+    uart_tx_stream_init(&gps_corr, &st->tx, gps_corr_tx_buf,
+                        sizeof(gps_corr_tx_buf));
+    gps_corr_id = id;
+  }
+#if USE_GPS_MB_BRIDGE
+  if (d->bridge)
+  {
+    uart_tx_stream_init(&gps_mb, &st->tx, gps_mb_tx_buf, sizeof(gps_mb_tx_buf));
+    gps_mb_id = id;
+  }
+#endif
+
+#if defined(USE_GPS_UBLOX)
+  if (st->type == GPS_TYPE_F9P)
+  {
+    // F9P 일 경우 항법 주기에 맞는 보드레이트로 변경 (DMA 활성화 전)
+    LOG_INFO("Changing F9P %s baudrate...", d->name);
+    HAL_GPIO_WritePin(d->reset_gpio, d->reset_pin, GPIO_PIN_SET);
+    LL_USART_Enable(d->uart);
+    f9p_init_port_baudrate(d->uart, id, d->name);
+    LL_USART_Disable(d->uart);
+    boot_timeline_mark(BOOT_MARK_GPS_BAUD);
+  }
+#endif
+
   return 0;
 }
 
@@ -154,415 +328,359 @@ int gps_rtk_uart2_init(void)
  * @brief GPS 통신 시작
  *
  */
-void gps_uart2_comm_start(void)
+static int gps_port_hw_start(gps_id_t id)
 {
-  LL_DMA_SetPeriphAddress(DMA1, LL_DMA_STREAM_5, (uint32_t)&USART2->DR);
-  LL_DMA_SetMemoryAddress(DMA1, LL_DMA_STREAM_5,
-                          (uint32_t)&gps_recv_buf[uart2_gps_id]);
-  LL_DMA_SetDataLength(DMA1, LL_DMA_STREAM_5,
-                       sizeof(gps_recv_buf[uart2_gps_id]));
-  //  LL_DMA_EnableIT_HT(DMA2, LL_DMA_STREAM_1);
-  //  LL_DMA_EnableIT_TC(DMA2, LL_DMA_STREAM_1);
-  LL_DMA_EnableIT_TE(DMA1, LL_DMA_STREAM_5);
-  LL_DMA_EnableIT_FE(DMA1, LL_DMA_STREAM_5);
-  LL_DMA_EnableIT_DME(DMA1, LL_DMA_STREAM_5);
+  const gps_port_desc_t *d = gps_port_get_desc(id);
 
-  LL_USART_EnableIT_IDLE(USART2);
-  LL_USART_EnableIT_PE(USART2);
-  LL_USART_EnableIT_ERROR(USART2);
-  LL_USART_EnableDMAReq_RX(USART2);
-
-  LL_DMA_EnableStream(DMA1, LL_DMA_STREAM_5);
-  LL_USART_Enable(USART2);
-}
+  if (!d)
+  {
+    return -1;
+  }
 
-/**
- * @brief GPS GPIO 핀 동작
- *
- */
-void gps_rtk_gpio_start(void)
-{
-  HAL_GPIO_WritePin(GPIOA, GPIO_PIN_5, GPIO_PIN_SET); // RTK Reset pin
-  //  HAL_GPIO_WritePin(GPIOB, GPIO_PIN_1, GPIO_PIN_RESET); // RTK WAKEUP pin
-}
+  LL_DMA_SetPeriphAddress(d->dma, d->rx_stream, (uint32_t)&d->uart->DR);
+  LL_DMA_SetMemoryAddress(d->dma, d->rx_stream, (uint32_t)d->ring);
+  LL_DMA_SetDataLength(d->dma, d->rx_stream, d->ring_size);
+  gps_port_state[id].laps = 0;
+  // 링 절반/끝 도달 시에도 깨워서 IDLE 없는 긴 burst가 링을 넘기 전에 파싱
+  LL_DMA_EnableIT_HT(d->dma, d->rx_stream);
+  LL_DMA_EnableIT_TC(d->dma, d->rx_stream);
+  LL_DMA_EnableIT_TE(d->dma, d->rx_stream);
+  LL_DMA_EnableIT_FE(d->dma, d->rx_stream);
+  LL_DMA_EnableIT_DME(d->dma, d->rx_stream);
 
-int gps_rtk_reset(void)
-{
-  HAL_GPIO_WritePin(GPIOA, GPIO_PIN_5, GPIO_PIN_RESET);
-  HAL_Delay(500);
-  HAL_GPIO_WritePin(GPIOA, GPIO_PIN_5, GPIO_PIN_SET);
+  LL_USART_EnableIT_IDLE(d->uart);
+  LL_USART_EnableIT_PE(d->uart);
+  LL_USART_EnableIT_ERROR(d->uart);
+  LL_USART_EnableDMAReq_RX(d->uart);
 
-  return 0;
-}
+  LL_DMA_EnableStream(d->dma, d->rx_stream);
+  LL_USART_Enable(d->uart);
 
-/**
- * @brief GPS enable
- *
- */
-int gps_rtk_start(void)
-{
-  gps_uart2_comm_start();
-  gps_rtk_gpio_start();
+  HAL_GPIO_WritePin(d->reset_gpio, d->reset_pin, GPIO_PIN_SET); // RTK Reset pin
 
   return 0;
 }
 
-int gps_uart2_send(const char *data, size_t len)
+static int gps_port_hw_reset(gps_id_t id)
 {
-  for (int i = 0; i < len; i++)
+  const gps_port_desc_t *d = gps_port_get_desc(id);
+
+  if (!d)
   {
-    while (!LL_USART_IsActiveFlag_TXE(USART2))
-      ;
-    LL_USART_TransmitData8(USART2, *(data + i));
+    return -1;
   }
 
-  while (!LL_USART_IsActiveFlag_TC(USART2))
-    ;
+  HAL_GPIO_WritePin(d->reset_gpio, d->reset_pin, GPIO_PIN_RESET);
+  HAL_Delay(500);
+  HAL_GPIO_WritePin(d->reset_gpio, d->reset_pin, GPIO_PIN_SET);
 
   return 0;
 }
 
-static const gps_hal_ops_t gps_rtk_uart2_ops = {
-    .init = gps_rtk_uart2_init,
-    .reset = gps_rtk_reset,
-    .start = gps_rtk_start,
-    .stop = NULL,
-    .send = gps_uart2_send,
-    .recv = NULL,
-};
+static int gps_port_hw_send(gps_id_t id, const char *data, size_t len)
+{
+  return uart_tx_send(&gps_port_state[id].tx, data, len);
+}
 
 /**
- * @brief This function handles USART2 global interrupt.
+ * @brief UART IDLE/에러 인터럽트 공통 처리
+ *
  */
-void USART2_IRQHandler(void)
+static void gps_port_uart_isr(gps_id_t id)
 {
+  uint32_t cyc = DWT->CYCCNT;
+  USART_TypeDef *uart = gps_port_desc[id].uart;
   BaseType_t xHigherPriorityTaskWoken = pdFALSE;
 
-  if (LL_USART_IsActiveFlag_IDLE(USART2))
+  if (LL_USART_IsActiveFlag_IDLE(uart))
   {
-    uint8_t dummy = 0;
+    gps_port_state_t *st = &gps_port_state[id];
+    gps_port_idle_stamp_t *stamp = &st->idle[st->idle_seq % GPS_PORT_IDLE_STAMPS];
 
-    if (gps_queues[uart2_gps_id])
-    {
-      xQueueSendFromISR(gps_queues[uart2_gps_id], &dummy, &xHigherPriorityTaskWoken);
-    }
+    stamp->count = gps_port_get_rx_count(id);
+    stamp->cyc = cyc;
+    st->idle_seq++;
+    irq_lat_isr((irq_lat_port_t)(IRQ_LAT_GPS1 + id));
 
-    LL_USART_ClearFlag_IDLE(USART2);
+    gps_port_notify_from_isr(id, &xHigherPriorityTaskWoken);
+    LL_USART_ClearFlag_IDLE(uart);
   }
 
-  if (LL_USART_IsActiveFlag_PE(USART2))
+  if (LL_USART_IsActiveFlag_PE(uart))
   {
-    LL_USART_ClearFlag_PE(USART2);
+    LL_USART_ClearFlag_PE(uart);
   }
-  if (LL_USART_IsActiveFlag_FE(USART2))
+  if (LL_USART_IsActiveFlag_FE(uart))
   {
-    LL_USART_ClearFlag_FE(USART2);
+    LL_USART_ClearFlag_FE(uart);
   }
-  if (LL_USART_IsActiveFlag_ORE(USART2))
+  if (LL_USART_IsActiveFlag_ORE(uart))
   {
-    LL_USART_ClearFlag_ORE(USART2);
+    LL_USART_ClearFlag_ORE(uart);
   }
-  if (LL_USART_IsActiveFlag_NE(USART2))
+  if (LL_USART_IsActiveFlag_NE(uart))
   {
-    LL_USART_ClearFlag_NE(USART2);
+    LL_USART_ClearFlag_NE(uart);
   }
 
   portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
 }
 
 /**
- * @brief This function handles DMA1 stream5 global interrupt.
+ * @brief RX DMA 인터럽트 공통 처리 (HT/TC 에서 수신 태스크 깨움)
+ *
  */
-void DMA1_Stream5_IRQHandler(void) {}
-
-int gps_port_init_instance(gps_t *gps_handle, gps_id_t id, gps_type_t type)
+static void gps_port_rx_dma_isr(gps_id_t id)
 {
-  if (id >= GPS_ID_MAX)
-    return -1;
-
-  const board_config_t *config = board_get_config();
+  const gps_port_desc_t *d = &gps_port_desc[id];
+  BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+  uint32_t flags = dma_rx_get_flags(d);
 
-  LOG_INFO("GPS[%d] Port 초기화 시작 (보드: %d, GPS 타입: %s)", id,
-           config->board, type == GPS_TYPE_F9P ? "F9P" : "UM982");
+  dma_rx_clear_flags(d, flags);
 
-  if (config->board == BOARD_TYPE_BASE_UM982 ||
-      config->board == BOARD_TYPE_BASE_F9P)
+  if (flags & DMA_STREAM_FLAG_TC)
   {
-    // Base 보드: 항상 USART2
-    uart2_gps_type = type;
-    uart2_gps_id = id;
-    gps_handle->ops = &gps_rtk_uart2_ops;
-    if (gps_handle->ops->init)
-    {
-      gps_handle->ops->init();
-    }
-    LOG_INFO("GPS[%d] USART2 할당 및 초기화 완료", id);
+    gps_port_state[id].laps++;
   }
-  else if (config->board == BOARD_TYPE_ROVER_UM982)
+  if (flags & (DMA_STREAM_FLAG_HT | DMA_STREAM_FLAG_TC))
   {
-    uart2_gps_type = type;
-    uart2_gps_id = id;
-    gps_handle->ops = &gps_rtk_uart2_ops;
-    if (gps_handle->ops->init)
-    {
-      gps_handle->ops->init();
-    }
-    LOG_INFO("GPS[%d] USART2 할당 및 초기화 완료", id);
-  }
-  else if (config->board == BOARD_TYPE_ROVER_F9P)
-  {
-    // Rover Ublox: 첫 번째는 USART2, 두 번째는 UART4
-    if (id == GPS_ID_BASE)
-    {
-      uart2_gps_type = type;
-      uart2_gps_id = id;
-      gps_handle->ops = &gps_rtk_uart2_ops;
-      if (gps_handle->ops->init)
-      {
-        gps_handle->ops->init();
-      }
-      LOG_INFO("GPS[%d] USART2 할당 및 초기화 완료 (Rover F9P 첫 번째)", id);
-    }
-    else if (id == GPS_ID_ROVER)
-    {
-      uart4_gps_type = type;
-      uart4_gps_id = id;
-      gps_handle->ops = &gps_rtk_uart4_ops;
-      if (gps_handle->ops->init)
-      {
-        gps_handle->ops->init();
-      }
-      LOG_INFO("GPS[%d] UART4 할당 및 초기화 완료 (Rover F9P 두 번째)",
-               id);
-    }
+    gps_port_notify_from_isr(id, &xHigherPriorityTaskWoken);
   }
 
-  return 0;
+  portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
 }
 
-static void gps_uart4_init(void)
-{
-
-  /* USER CODE BEGIN UART4_Init 0 */
-
-  /* USER CODE END UART4_Init 0 */
-
-  LL_USART_InitTypeDef USART_InitStruct = {0};
-
-  LL_GPIO_InitTypeDef GPIO_InitStruct = {0};
-
-  /* Peripheral clock enable */
-  LL_APB1_GRP1_EnableClock(LL_APB1_GRP1_PERIPH_UART4);
-
-  LL_AHB1_GRP1_EnableClock(LL_AHB1_GRP1_PERIPH_GPIOA);
-  /**UART4 GPIO Configuration
-  PA0-WKUP   ------> UART4_TX
-  PA1   ------> UART4_RX
-  */
-  GPIO_InitStruct.Pin = LL_GPIO_PIN_0 | LL_GPIO_PIN_1;
-  GPIO_InitStruct.Mode = LL_GPIO_MODE_ALTERNATE;
-  GPIO_InitStruct.Speed = LL_GPIO_SPEED_FREQ_VERY_HIGH;
-  GPIO_InitStruct.OutputType = LL_GPIO_OUTPUT_PUSHPULL;
-  GPIO_InitStruct.Pull = LL_GPIO_PULL_NO;
-  GPIO_InitStruct.Alternate = LL_GPIO_AF_8;
-  LL_GPIO_Init(GPIOA, &GPIO_InitStruct);
-
-  /* UART4 DMA Init */
-
-  /* UART4_RX Init */
-  LL_DMA_SetChannelSelection(DMA1, LL_DMA_STREAM_2, LL_DMA_CHANNEL_4);
-
-  LL_DMA_SetDataTransferDirection(DMA1, LL_DMA_STREAM_2, LL_DMA_DIRECTION_PERIPH_TO_MEMORY);
-
-  LL_DMA_SetStreamPriorityLevel(DMA1, LL_DMA_STREAM_2, LL_DMA_PRIORITY_LOW);
-
-  LL_DMA_SetMode(DMA1, LL_DMA_STREAM_2, LL_DMA_MODE_CIRCULAR);
-
-  LL_DMA_SetPeriphIncMode(DMA1, LL_DMA_STREAM_2, LL_DMA_PERIPH_NOINCREMENT);
-
-  LL_DMA_SetMemoryIncMode(DMA1, LL_DMA_STREAM_2, LL_DMA_MEMORY_INCREMENT);
+/*
+ * gps_hal_ops_t 는 인자가 없으므로 포트마다 ID 를 묶은 wrapper 를 만든다.
+ */
+#define GPS_PORT_DEFINE_OPS(n)                                                 \
+  static int gps_port##n##_init(void) { return gps_port_hw_init(n); }          \
+  static int gps_port##n##_start(void) { return gps_port_hw_start(n); }        \
+  static int gps_port##n##_reset(void) { return gps_port_hw_reset(n); }        \
+  static int gps_port##n##_send(const char *data, size_t len)                  \
+  {                                                                            \
+    return gps_port_hw_send(n, data, len);                                     \
+  }                                                                            \
+  static const gps_hal_ops_t gps_port##n##_ops = {                             \
+      .init = gps_port##n##_init,                                              \
+      .reset = gps_port##n##_reset,                                            \
+      .start = gps_port##n##_start,                                            \
+      .stop = NULL,                                                            \
+      .send = gps_port##n##_send,                                              \
+      .recv = NULL,                                                            \
+  }
 
-  LL_DMA_SetPeriphSize(DMA1, LL_DMA_STREAM_2, LL_DMA_PDATAALIGN_BYTE);
+#if GPS_CNT > 0
+GPS_PORT_DEFINE_OPS(0);
 
-  LL_DMA_SetMemorySize(DMA1, LL_DMA_STREAM_2, LL_DMA_MDATAALIGN_BYTE);
+/**
+ * @brief This function handles USART2 global interrupt.
+ */
+void USART2_IRQHandler(void)
+{
+  gps_port_uart_isr(GPS_ID_BASE);
+}
 
-  LL_DMA_DisableFifoMode(DMA1, LL_DMA_STREAM_2);
+/**
+ * @brief This function handles DMA1 stream5 global interrupt (USART2_RX).
+ */
+void DMA1_Stream5_IRQHandler(void)
+{
+  gps_port_rx_dma_isr(GPS_ID_BASE);
+}
 
-  /* UART4 interrupt Init */
-  NVIC_SetPriority(UART4_IRQn, NVIC_EncodePriority(NVIC_GetPriorityGrouping(), 5, 0));
-  NVIC_EnableIRQ(UART4_IRQn);
+/**
+ * @brief This function handles DMA1 stream6 global interrupt (USART2_TX).
+ */
+void DMA1_Stream6_IRQHandler(void)
+{
+  uart_tx_irq_handler(&gps_port_state[GPS_ID_BASE].tx);
+}
+#endif
 
-  /* USER CODE BEGIN UART4_Init 1 */
+#if GPS_CNT > 1
+GPS_PORT_DEFINE_OPS(1);
 
-  /* USER CODE END UART4_Init 1 */
-  const board_config_t *config = board_get_config();
-  if(config->board == BOARD_TYPE_ROVER_F9P || config->board == BOARD_TYPE_BASE_F9P)
-  {
-    USART_InitStruct.BaudRate = 38400;
-  }
-  else
-  {
-    USART_InitStruct.BaudRate = 115200;
-  }
-  
-  USART_InitStruct.DataWidth = LL_USART_DATAWIDTH_8B;
-  USART_InitStruct.StopBits = LL_USART_STOPBITS_1;
-  USART_InitStruct.Parity = LL_USART_PARITY_NONE;
-  USART_InitStruct.TransferDirection = LL_USART_DIRECTION_TX_RX;
-  USART_InitStruct.HardwareFlowControl = LL_USART_HWCONTROL_NONE;
-  USART_InitStruct.OverSampling = LL_USART_OVERSAMPLING_16;
-  LL_USART_Init(UART4, &USART_InitStruct);
-  LL_USART_ConfigAsyncMode(UART4);
-  /* USER CODE BEGIN UART4_Init 2 */
-
-  /* USER CODE END UART4_Init 2 */
+/**
+ * @brief This function handles UART4 global interrupt.
+ */
+void UART4_IRQHandler(void)
+{
+  gps_port_uart_isr(GPS_ID_ROVER);
 }
 
-static void gps_uart4_dma_init(void)
+/**
+ * @brief This function handles DMA1 stream2 global interrupt (UART4_RX).
+ */
+void DMA1_Stream2_IRQHandler(void)
 {
-  /* Init with LL driver */
-  /* DMA controller clock enable */
-  LL_AHB1_GRP1_EnableClock(LL_AHB1_GRP1_PERIPH_DMA1);
-
-  /* DMA interrupt init */
-  /* DMA1_Stream2_IRQn interrupt configuration */
-  NVIC_SetPriority(DMA1_Stream2_IRQn, NVIC_EncodePriority(NVIC_GetPriorityGrouping(), 5, 0));
-  NVIC_EnableIRQ(DMA1_Stream2_IRQn);
+  gps_port_rx_dma_isr(GPS_ID_ROVER);
 }
 
-int gps_rtk_uart4_init(void)
+/**
+ * @brief This function handles DMA1 stream4 global interrupt (UART4_TX).
+ */
+void DMA1_Stream4_IRQHandler(void)
 {
-  gps_uart4_dma_init();
-  gps_uart4_init();
-
-  const board_config_t *config = board_get_config();
+  uart_tx_irq_handler(&gps_port_state[GPS_ID_ROVER].tx);
+}
+#endif
 
-  if(config->board == BOARD_TYPE_ROVER_F9P || config->board == BOARD_TYPE_BASE_F9P)
+static const gps_hal_ops_t *const gps_port_ops[GPS_ID_MAX] = {
+#if GPS_CNT > 0
+    [GPS_ID_BASE] = &gps_port0_ops,
+#endif
+#if GPS_CNT > 1
+    [GPS_ID_ROVER] = &gps_port1_ops,
+#endif
+};
 
+/**
+ * @brief 보정 데이터 스트림 송신 (블로킹 없음)
+ *
+ * 보정 데이터는 corr 로 표시된 포트 (USART2) 의 GPS 로만 들어간다. 링에
+ * 복사만 하고 DMA 가 알아서 비운다. 쓰는 태스크는 하나여야 한다.
+ * 한 번 호출이 프레임 하나이고, 명령 송신은 프레임 사이에만 끼어든다.
+ *
+ * @param[in] id
+ * @param[in] data 프레임 하나
+ * @param[in] len
+ * @return size_t len, 링 공간이 모자라면 0 (통째로 버려짐)
+ */
+size_t gps_port_stream_write(gps_id_t id, const void *data, size_t len)
+{
+  if (id != gps_corr_id)
   {
-
-    // F9P 보드일 경우 보드레이트를 115200으로 변경 (DMA 활성화 전)
-
-    LOG_INFO("Changing F9P UART2 baudrate to 115200...");
-    gps_rtk_uart4_gpio_start();
-    LL_USART_Enable(UART4);
-    f9p_init_rover_uart1_baudrate_115200();
-    LL_USART_Disable(UART4);
+    return 0;
   }
 
-  return 0;
+  TRACE_MARK_START(TRACE_MARK_GPS_TX);
+  size_t n = uart_tx_stream_write_frame(&gps_corr, data, len);
+  TRACE_MARK_STOP(TRACE_MARK_GPS_TX);
+
+  return n;
 }
 
-void gps_uart4_comm_start(void)
+/**
+ * @brief 보정 스트림과 순위를 정해 블로킹 송신
+ *
+ * URGENT 는 진행 중인 보정 프레임이 끝나는 대로, NORMAL 은 이미 링에
+ * 쌓인 보정 데이터 뒤에 나간다. 보정 링이 없는 포트는 순위와 관계없다.
+ *
+ * @param[in] id
+ * @param[in] data
+ * @param[in] len
+ * @param[in] prio
+ * @return int 0 성공, -1 실패
+ */
+int gps_port_send_prio(gps_id_t id, const void *data, size_t len,
+                       uart_tx_prio_t prio)
 {
-  LL_DMA_SetPeriphAddress(DMA1, LL_DMA_STREAM_2, (uint32_t)&UART4->DR);
-  LL_DMA_SetMemoryAddress(DMA1, LL_DMA_STREAM_2,
-                          (uint32_t)&gps_recv_buf[uart4_gps_id]);
-  LL_DMA_SetDataLength(DMA1, LL_DMA_STREAM_2,
-                       sizeof(gps_recv_buf[uart4_gps_id]));
-  //  LL_DMA_EnableIT_HT(DMA2, LL_DMA_STREAM_1);
-  //  LL_DMA_EnableIT_TC(DMA2, LL_DMA_STREAM_1);
-  LL_DMA_EnableIT_TE(DMA1, LL_DMA_STREAM_2);
-  LL_DMA_EnableIT_FE(DMA1, LL_DMA_STREAM_2);
-  LL_DMA_EnableIT_DME(DMA1, LL_DMA_STREAM_2);
+  uart_tx_seg_t seg = {.data = data, .len = len};
 
-  LL_USART_EnableIT_IDLE(UART4);
-  LL_USART_EnableIT_PE(UART4);
-  LL_USART_EnableIT_ERROR(UART4);
-  LL_USART_EnableDMAReq_RX(UART4);
+  if (!gps_port_get_desc(id))
+  {
+    return -1;
+  }
 
-  LL_DMA_EnableStream(DMA1, LL_DMA_STREAM_2);
-  LL_USART_Enable(UART4);
+  return uart_tx_sendv_prio(&gps_port_state[id].tx, &seg, 1, prio);
 }
 
-void gps_rtk_uart4_gpio_start(void)
+/**
+ * @brief 보정 데이터 송신 링이 붙은 GPS 인지
+ *
+ */
+bool gps_port_has_stream(gps_id_t id)
 {
-  HAL_GPIO_WritePin(GPIOA, GPIO_PIN_8, GPIO_PIN_SET); // RTK Reset pin
-  //  HAL_GPIO_WritePin(GPIOB, GPIO_PIN_1, GPIO_PIN_RESET); // RTK WAKEUP pin
+  return id == gps_corr_id;
 }
 
-int gps_rtk_uart4_reset(void)
+/**
+ * @brief 지금까지 링에 쓴 보정 데이터가 다 나가면 cb(tag) 호출 (DMA ISR)
+ *
+ * 콜백은 gps_port_stream_set_mark_cb() 로 등록한다.
+ */
+bool gps_port_stream_mark(gps_id_t id, uint32_t tag)
 {
-  HAL_GPIO_WritePin(GPIOA, GPIO_PIN_8, GPIO_PIN_RESET);
-  HAL_Delay(500);
-  HAL_GPIO_WritePin(GPIOA, GPIO_PIN_8, GPIO_PIN_SET);
+  if (id != gps_corr_id)
+  {
+    return false;
+  }
 
-  return 0;
+  return uart_tx_stream_mark(&gps_corr, tag);
 }
 
-int gps_rtk_uart4_start(void)
+void gps_port_stream_set_mark_cb(gps_id_t id, uart_tx_stream_mark_cb_t cb, void *ctx)
 {
-  gps_uart4_comm_start();
-  gps_rtk_uart4_gpio_start();
+  if (id == gps_corr_id)
+  {
+    uart_tx_stream_set_mark_cb(&gps_corr, cb, ctx);
+  }
+}
 
-  return 0;
+/**
+ * @brief 링이 가득 차서 버린 보정 데이터 누적 바이트
+ *
+ */
+uint32_t gps_port_stream_dropped(gps_id_t id)
+{
+  return (id == gps_corr_id) ? gps_corr.dropped : 0;
 }
 
-int gps_uart4_send(const char *data, size_t len)
+/**
+ * @brief moving base RTCM 프레임 하나를 다리 송신 링으로 (블로킹 없음)
+ *
+ * 다리가 붙은 포트 (USE_GPS_MB_BRIDGE 의 GPS2) 만 받는다. 구간은 수신 링의
+ * 프레임 조각 그대로이고 링에 한 번 복사한 뒤 DMA 가 프레임 경계에서 끊어
+ * 보낸다. 쓰는 태스크는 GPS1 RX 태스크 하나다.
+ *
+ * @return size_t 프레임 길이, 링이 모자라거나 다리가 없으면 0 (통째로 버려짐)
+ */
+size_t gps_port_bridge_write(gps_id_t id, const uart_tx_seg_t *segs, size_t cnt)
 {
-  for (int i = 0; i < len; i++)
+#if USE_GPS_MB_BRIDGE
+  if (id != gps_mb_id)
   {
-    while (!LL_USART_IsActiveFlag_TXE(UART4))
-      ;
-    LL_USART_TransmitData8(UART4, *(data + i));
+    return 0;
   }
 
-  while (!LL_USART_IsActiveFlag_TC(UART4))
-    ;
+  TRACE_MARK_START(TRACE_MARK_GPS_TX);
+  size_t n = uart_tx_stream_write_framev(&gps_mb, segs, cnt);
+  TRACE_MARK_STOP(TRACE_MARK_GPS_TX);
 
+  return n;
+#else
+  (void)id;
+  (void)segs;
+  (void)cnt;
   return 0;
+#endif
 }
 
-static const gps_hal_ops_t gps_rtk_uart4_ops = {
-    .init = gps_rtk_uart4_init,
-    .reset = gps_rtk_uart4_reset,
-    .start = gps_rtk_uart4_start,
-    .stop = NULL,
-    .send = gps_uart4_send,
-    .recv = NULL,
-};
-
-void DMA1_Stream2_IRQHandler(void)
+bool gps_port_has_bridge(gps_id_t id)
 {
+  return id == gps_mb_id;
 }
 
-/**
- * @brief This function handles UART4 global interrupt.
- */
-void UART4_IRQHandler(void)
+int gps_port_init_instance(gps_t *gps_handle, gps_id_t id, gps_type_t type)
 {
-  BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+  const gps_port_desc_t *d = gps_port_get_desc(id);
 
-  if (LL_USART_IsActiveFlag_IDLE(UART4))
-  {
-    uint8_t dummy = 0;
-
-    if (gps_queues[uart4_gps_id])
-    {
-      xQueueSendFromISR(gps_queues[uart4_gps_id], &dummy, &xHigherPriorityTaskWoken);
-    }
+  if (!d)
+    return -1;
 
-    LL_USART_ClearFlag_IDLE(UART4);
-  }
+  LOG_INFO("GPS[%d] Port 초기화 시작 (보드: %d, GPS 타입: %s)", id,
+           board_get_config()->board, type == GPS_TYPE_F9P ? "F9P" : "UM982");
 
-  if (LL_USART_IsActiveFlag_PE(UART4))
+  gps_port_state[id].type = type;
+  gps_handle->ops = gps_port_ops[id];
+  if (gps_handle->ops->init)
   {
-    LL_USART_ClearFlag_PE(UART4);
-  }
-  if (LL_USART_IsActiveFlag_FE(UART4))
-  {
-    LL_USART_ClearFlag_FE(UART4);
-  }
-  if (LL_USART_IsActiveFlag_ORE(UART4))
-  {
-    LL_USART_ClearFlag_ORE(UART4);
-  }
-  if (LL_USART_IsActiveFlag_NE(UART4))
-  {
-    LL_USART_ClearFlag_NE(UART4);
+    gps_handle->ops->init();
   }
+  LOG_INFO("GPS[%d] %s 할당 및 초기화 완료", id, d->name);
 
-  portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+  return 0;
 }
 
 /**
@@ -598,209 +716,161 @@ void gps_port_stop(gps_t *gps_handle)
  */
 uint32_t gps_port_get_rx_pos(gps_id_t id)
 {
-  if (id >= GPS_CNT)
-    return 0;
-
-  //  const board_config_t *config = board_get_config();
-  uint32_t dma_stream_num = 0;
-
-  if(id == GPS_ID_BASE)
-{
-    dma_stream_num = LL_DMA_STREAM_5;
-}
-else if(id == GPS_ID_ROVER)
-{
-    dma_stream_num = LL_DMA_STREAM_2;
-}
+  const gps_port_desc_t *d = gps_port_get_desc(id);
 
-  return sizeof(gps_recv_buf[id]) - LL_DMA_GetDataLength(DMA1, dma_stream_num);
-}
+  if (!d)
+    return 0;
 
-/**
- * @brief GPS 수신 버퍼 포인터 가져오기
- */
-char *gps_port_get_recv_buf(gps_id_t id)
-{
-  if (id >= GPS_CNT)
-    return NULL;
-  return gps_recv_buf[id];
+  return d->ring_size - LL_DMA_GetDataLength(d->dma, d->rx_stream);
 }
 
 /**
- * @brief GPS 인터럽트 핸들러용 큐 설정
+ * @brief 통신 시작 이후 DMA 가 링에 쓴 누적 바이트 수 (2^32 에서 wrap)
+ *
+ * 이전 값과의 차이가 링 크기 이상이면 읽지 않은 데이터가 덮어써진 것이다.
+ * TC 가 났지만 아직 ISR 이 돌기 전이면 (NDTR 은 이미 reload) 한 바퀴를
+ * 더해 준다.
  */
-void gps_port_set_queue(gps_id_t id, QueueHandle_t queue)
-{
-  if (id < GPS_CNT)
-  {
-    gps_queues[id] = queue;
-  }
-}
-
-void gps_port_cleanup_instance(gps_id_t id)
-
+uint32_t gps_port_get_rx_count(gps_id_t id)
 {
+  const gps_port_desc_t *d = gps_port_get_desc(id);
 
-  if (id >= GPS_CNT)
-
-    return;
-
- 
-
-  const board_config_t *config = board_get_config();
-
- 
-
-  LOG_INFO("GPS[%d] Port 정리 시작", id);
-
- 
-
-  if (config->board == BOARD_TYPE_BASE_UM982 ||
-
-      config->board == BOARD_TYPE_BASE_F9P)
-
-  {
-
-    if (id == GPS_ID_BASE && uart2_gps_id == id)
-
-    {
-
-      LL_USART_Disable(USART2);
-
-      LL_DMA_DisableStream(DMA1, LL_DMA_STREAM_5);
-
-      LL_USART_DisableDMAReq_RX(USART2);
-
-      LL_USART_DisableIT_IDLE(USART2);
-
-      LL_USART_DisableIT_PE(USART2);
-
-      LL_USART_DisableIT_ERROR(USART2);
-
-      NVIC_DisableIRQ(USART2_IRQn);
-
-      NVIC_DisableIRQ(DMA1_Stream5_IRQn);
-
- 
-
-      HAL_GPIO_WritePin(GPIOA, GPIO_PIN_5, GPIO_PIN_RESET);
-
- 
-
-      gps_queues[id] = NULL;
-
-      LOG_INFO("GPS[%d] USART2 정리 완료", id);
-
-    }
-
-  }
+  if (!d)
+    return 0;
 
-  else if (config->board == BOARD_TYPE_ROVER_UM982)
+  uint32_t laps;
+  uint32_t pos;
+  bool tc_pending;
 
+  do
   {
+    laps = gps_port_state[id].laps;
+    pos = gps_port_get_rx_pos(id);
+    tc_pending = (dma_rx_get_flags(d) & DMA_STREAM_FLAG_TC) != 0;
+  } while (laps != gps_port_state[id].laps);
 
-    if (id == GPS_ID_BASE && uart2_gps_id == id)
-
-    {
-
-      LL_USART_Disable(USART2);
-
-      LL_DMA_DisableStream(DMA1, LL_DMA_STREAM_5);
-
-      LL_USART_DisableDMAReq_RX(USART2);
-
-      LL_USART_DisableIT_IDLE(USART2);
-
-      LL_USART_DisableIT_PE(USART2);
-
-      LL_USART_DisableIT_ERROR(USART2);
-
-      NVIC_DisableIRQ(USART2_IRQn);
-
-      NVIC_DisableIRQ(DMA1_Stream5_IRQn);
-
- 
-
-      HAL_GPIO_WritePin(GPIOA, GPIO_PIN_5, GPIO_PIN_RESET);
-
- 
-
-      gps_queues[id] = NULL;
-
-      LOG_INFO("GPS[%d] USART2 정리 완료", id);
-
-    }
+  return dma_ring_count(laps, pos, tc_pending, d->ring_size);
+}
 
-  }
+/**
+ * @brief 누적 count 번째 byte 까지 다 들어온 시각 (DWT cycle)
+ *
+ * count 를 덮는 첫 IDLE 에서 남은 byte 수만큼 문자 시간을 빼서 구한다.
+ * 그 IDLE 이 아직 안 떴으면 (HT/TC 로 깨어나 burst 중간을 파싱) 모른다.
+ *
+ * @param id GPS ID
+ * @param count 프레임 마지막 byte 까지의 gps_port_get_rx_count() 값
+ * @param[out] cyc
+ * @return true 시각을 구함
+ */
+bool gps_port_rx_time(gps_id_t id, uint32_t count, uint32_t *cyc)
+{
+  const gps_port_desc_t *d = gps_port_get_desc(id);
+  gps_port_state_t *st = &gps_port_state[id];
+  gps_port_idle_stamp_t found;
+  uint32_t seq;
+  bool ok;
 
-  else if (config->board == BOARD_TYPE_ROVER_F9P)
+  if (!d)
+    return false;
 
+  do
   {
-
-    if (id == GPS_ID_BASE && uart2_gps_id == id)
-
+    seq = st->idle_seq;
+    ok = false;
+    // 오래된 것부터 보고 count 를 덮는 첫 IDLE 을 쓴다
+    for (uint32_t n = GPS_PORT_IDLE_STAMPS; n > 0 && !ok; n--)
     {
+      if (seq < n)
+        continue;
 
-      LL_USART_Disable(USART2);
-
-      LL_DMA_DisableStream(DMA1, LL_DMA_STREAM_5);
-
-      LL_USART_DisableDMAReq_RX(USART2);
-
-      LL_USART_DisableIT_IDLE(USART2);
-
-      LL_USART_DisableIT_PE(USART2);
-
-      LL_USART_DisableIT_ERROR(USART2);
-
-      NVIC_DisableIRQ(USART2_IRQn);
-
-      NVIC_DisableIRQ(DMA1_Stream5_IRQn);
-
- 
-
-      HAL_GPIO_WritePin(GPIOA, GPIO_PIN_5, GPIO_PIN_RESET);
-
- 
-
-      gps_queues[id] = NULL;
-
-      LOG_INFO("GPS[%d] USART2 정리 완료", id);
-
+      found = st->idle[(seq - n) % GPS_PORT_IDLE_STAMPS];
+      ok = (int32_t)(found.count - count) >= 0;
+      // 가장 오래된 칸이면 그 앞 IDLE 이 이미 지워졌을 수 있다
+      if (ok && n == GPS_PORT_IDLE_STAMPS && seq > n)
+      {
+        return false;
+      }
     }
+  } while (seq != st->idle_seq);
 
-    else if (id == GPS_ID_ROVER && uart4_gps_id == id)
-
-    {
+  if (!ok)
+    return false;
 
-      LL_USART_Disable(UART4);
+  uint32_t baud = LL_USART_GetBaudRate(d->uart, HAL_RCC_GetPCLK1Freq(),
+                                       LL_USART_OVERSAMPLING_16);
+  if (baud == 0)
+    return false;
 
-      LL_DMA_DisableStream(DMA1, LL_DMA_STREAM_2);
+  // 8N1 = 10 bit, IDLE 은 마지막 byte 뒤 한 문자 시간 더
+  uint32_t byte_cyc = (uint32_t)((uint64_t)SystemCoreClock * 10U / baud);
+  *cyc = found.cyc - (found.count - count + 1U) * byte_cyc;
 
-      LL_USART_DisableDMAReq_RX(UART4);
+  return true;
+}
 
-      LL_USART_DisableIT_IDLE(UART4);
+/**
+ * @brief GPS 수신 링 크기
+ */
+uint32_t gps_port_get_rx_size(gps_id_t id)
+{
+  const gps_port_desc_t *d = gps_port_get_desc(id);
 
-      LL_USART_DisableIT_PE(UART4);
+  return d ? d->ring_size : 0;
+}
 
-      LL_USART_DisableIT_ERROR(UART4);
+/**
+ * @brief 지금 UART 속도 [bps] (F9P 는 f9p_init_port_baudrate 로 올린 뒤 값)
+ */
+uint32_t gps_port_get_baud(gps_id_t id)
+{
+  const gps_port_desc_t *d = gps_port_get_desc(id);
 
-      NVIC_DisableIRQ(UART4_IRQn);
+  return d ? LL_USART_GetBaudRate(d->uart, HAL_RCC_GetPCLK1Freq(), LL_USART_OVERSAMPLING_16)
+           : 0;
+}
 
-      NVIC_DisableIRQ(DMA1_Stream2_IRQn);
+/**
+ * @brief GPS 수신 버퍼 포인터 가져오기
+ */
+char *gps_port_get_recv_buf(gps_id_t id)
+{
+  const gps_port_desc_t *d = gps_port_get_desc(id);
 
- 
+  return d ? d->ring : NULL;
+}
 
-      HAL_GPIO_WritePin(GPIOA, GPIO_PIN_8, GPIO_PIN_RESET);
+/**
+ * @brief GPS 인터럽트에서 깨울 수신 태스크 설정
+ */
+void gps_port_set_task(gps_id_t id, TaskHandle_t task)
+{
+  if (id < GPS_CNT)
+  {
+    gps_port_state[id].task = task;
+  }
+}
 
- 
+void gps_port_cleanup_instance(gps_id_t id)
+{
+  const gps_port_desc_t *d = gps_port_get_desc(id);
 
-      gps_queues[id] = NULL;
+  if (!d)
+    return;
 
-      LOG_INFO("GPS[%d] UART4 정리 완료", id);
+  LOG_INFO("GPS[%d] Port 정리 시작", id);
 
-    }
+  LL_USART_Disable(d->uart);
+  LL_DMA_DisableStream(d->dma, d->rx_stream);
+  LL_USART_DisableDMAReq_RX(d->uart);
+  LL_USART_DisableIT_IDLE(d->uart);
+  LL_USART_DisableIT_PE(d->uart);
+  LL_USART_DisableIT_ERROR(d->uart);
+  NVIC_DisableIRQ(d->uart_irq);
+  NVIC_DisableIRQ(d->rx_irq);
 
-  }
+  HAL_GPIO_WritePin(d->reset_gpio, d->reset_pin, GPIO_PIN_RESET);
 
-}
\ No newline at end of file
+  gps_port_state[id].task = NULL;
+  LOG_INFO("GPS[%d] %s 정리 완료", id, d->name);
+}
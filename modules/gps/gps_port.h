@@ -5,14 +5,28 @@
 #include "gps_app.h"
 #include "queue.h"
 #include "task.h"
+#include "uart_tx.h"
 
 int gps_port_init_instance(gps_t *gps_handle, gps_id_t id, gps_type_t type);
 void gps_port_start(gps_t *gps_handle);
 void gps_port_stop(gps_t *gps_handle);
 uint32_t gps_port_get_rx_pos(gps_id_t id);
+uint32_t gps_port_get_rx_count(gps_id_t id);
+uint32_t gps_port_get_rx_size(gps_id_t id);
+uint32_t gps_port_get_baud(gps_id_t id);
+bool gps_port_rx_time(gps_id_t id, uint32_t count, uint32_t *cyc);
 char *gps_port_get_recv_buf(gps_id_t id);
-void gps_port_set_queue(gps_id_t id, QueueHandle_t queue);
+void gps_port_set_task(gps_id_t id, TaskHandle_t task);
 void gps_port_cleanup_instance(gps_id_t id);
+bool gps_port_has_stream(gps_id_t id);
+int gps_port_send_prio(gps_id_t id, const void *data, size_t len,
+                       uart_tx_prio_t prio);
+size_t gps_port_stream_write(gps_id_t id, const void *data, size_t len);
+uint32_t gps_port_stream_dropped(gps_id_t id);
+bool gps_port_stream_mark(gps_id_t id, uint32_t tag);
+void gps_port_stream_set_mark_cb(gps_id_t id, uart_tx_stream_mark_cb_t cb, void *ctx);
+bool gps_port_has_bridge(gps_id_t id);
+size_t gps_port_bridge_write(gps_id_t id, const uart_tx_seg_t *segs, size_t cnt);
 
 
 #endif
@@ -0,0 +1,212 @@
+#include "gps_rate.h"
+#include "flash_params.h"
+#include "gps_config.h"
+#include "gps_port.h"
+#include "ubx_init.h"
+#include <stdio.h>
+
+#define GPS_RATE_BAUD_DEFAULT 115200
+
+/* F9P UART1 후보 속도 (낮은 것부터, STM32 APB1 42 MHz 로 모두 오차 1% 안) */
+static const uint32_t gps_rate_bauds[] = {115200, 230400, 460800};
+
+/**
+ * @brief 수신기별 예상 출력 (측정 전, 그리고 부팅 때 속도를 고르는 기준)
+ *
+ * epoch 는 항법 해마다 나오는 메시지, fixed 는 1 Hz 로 유지하는 메시지
+ * (GGA, RTCM 안테나 위치 등) 의 초당 byte. 여유를 두고 잡는다.
+ * F9P 는 설정 테이블 기준 ubx_cfg_uart1_load 가 대신한다.
+ */
+typedef struct {
+  uint16_t epoch;
+  uint16_t fixed;
+} gps_rate_load_t;
+
+static uint32_t active_hz;
+static volatile uint32_t epoch_avg_x8[GPS_ID_MAX]; // 평균 byte * 8 (EWMA 1/8)
+
+static bool gps_rate_supported(void) {
+  return BOARD_IS(BOARD_TYPE_ROVER_F9P) || BOARD_IS(BOARD_TYPE_ROVER_UM982);
+}
+
+static gps_rate_load_t gps_rate_estimate(gps_id_t id) {
+  if (BOARD_IS(BOARD_TYPE_ROVER_UM982)) {
+#if defined(USE_UM982_BINARY_ONLY)
+    return (gps_rate_load_t){.epoch = 240, .fixed = 300}; // BESTNAVB + UNIHEADINGB, PVTSLNB
+#else
+    return (gps_rate_load_t){.epoch = 180, .fixed = 100}; // BESTNAVB + GPTHS, GGA
+#endif
+  }
+  if (id == GPS_ID_BASE) {
+    return (gps_rate_load_t){.epoch = 60, .fixed = 100}; // moving base HPPOSLLH, GGA
+  }
+  return (gps_rate_load_t){.epoch = 80, .fixed = 100}; // RELPOSNED, GGA
+}
+
+static uint32_t gps_rate_bytes_per_s(gps_id_t id, uint32_t hz, bool measured) {
+  gps_rate_load_t est = gps_rate_estimate(id);
+  uint32_t bytes = est.epoch * hz + est.fixed;
+
+#if defined(USE_GPS_UBLOX)
+  // F9P 는 실제로 보낼 설정 테이블을 메시지 크기 모델로 센다
+  if (board_get_config()->gps[id] == GPS_TYPE_F9P) {
+    bytes = ubx_cfg_uart1_load(id, hz);
+  }
+#endif
+
+  // 측정값은 지금 주기의 1 Hz 메시지가 epoch 마다 나뉘어 있어 올릴 때는 약간 크게 나옴
+  if (measured && gps_rate_epoch_bytes(id) * hz > bytes) {
+    bytes = gps_rate_epoch_bytes(id) * hz;
+  }
+
+  return bytes;
+}
+
+static bool gps_rate_load_ok(uint32_t bytes_per_s, uint32_t baud) {
+  return bytes_per_s * 10 * 100 <= baud * GPS_RATE_MAX_LOAD_PCT;
+}
+
+static bool gps_rate_ring_ok(gps_id_t id, uint32_t baud) {
+  return gps_port_get_rx_size(id) >= baud / 10 * GPS_RATE_RING_MIN_MS / 1000;
+}
+
+bool gps_rate_is_valid(uint32_t hz) {
+  return hz == 1 || hz == 2 || hz == 5 || hz == 10 || hz == 20;
+}
+
+uint32_t gps_rate_get_hz(void) {
+  if (active_hz == 0) {
+    uint32_t hz = flash_params_snapshot(NULL)->nav_rate_hz;
+
+    if (!gps_rate_supported()) {
+      hz = 1;
+    } else if (!gps_rate_is_valid(hz)) {
+      hz = GPS_NAV_RATE_DEFAULT_HZ;
+    }
+    active_hz = hz;
+  }
+
+  return active_hz;
+}
+
+uint16_t gps_rate_meas_ms(uint32_t hz) {
+  return (uint16_t)(1000 / (hz ? hz : 1));
+}
+
+void gps_rate_period_str(uint32_t hz, char *buf, size_t size) {
+  uint32_t ms = gps_rate_meas_ms(hz);
+
+  if (ms % 1000 == 0) {
+    snprintf(buf, size, "%lu", (unsigned long)(ms / 1000));
+  } else if (ms % 100 == 0) {
+    snprintf(buf, size, "0.%lu", (unsigned long)(ms / 100));
+  } else {
+    snprintf(buf, size, "0.%02lu", (unsigned long)(ms / 10));
+  }
+}
+
+static uint32_t gps_rate_pick_baud(gps_id_t id, uint32_t hz, bool *ring_limited) {
+  size_t count = board_get_config()->gps[id] == GPS_TYPE_F9P
+                     ? sizeof(gps_rate_bauds) / sizeof(gps_rate_bauds[0])
+                     : 1;
+  uint32_t bytes = gps_rate_bytes_per_s(id, hz, false);
+
+  *ring_limited = false;
+  for (size_t i = 0; i < count; i++) {
+    if (!gps_rate_ring_ok(id, gps_rate_bauds[i])) {
+      *ring_limited = true;
+      break;
+    }
+    if (gps_rate_load_ok(bytes, gps_rate_bauds[i])) {
+      return gps_rate_bauds[i];
+    }
+  }
+
+  return 0;
+}
+
+uint32_t gps_rate_uart_baud(gps_id_t id, uint32_t hz) {
+  bool ring_limited;
+  uint32_t baud;
+
+  if (!gps_rate_supported()) {
+    return GPS_RATE_BAUD_DEFAULT;
+  }
+
+  // 설정 때 gps_rate_check 로 걸렀으므로 0 이면 예상치가 바뀐 경우, 기본 속도로
+  baud = gps_rate_pick_baud(id, hz, &ring_limited);
+  return baud ? baud : GPS_RATE_BAUD_DEFAULT;
+}
+
+gps_rate_result_t gps_rate_check(uint32_t hz) {
+  const board_config_t *config = board_get_config();
+
+  if (!gps_rate_is_valid(hz)) {
+    return GPS_RATE_ERR_INVALID;
+  }
+  if (!gps_rate_supported()) {
+    return hz == 1 ? GPS_RATE_OK : GPS_RATE_ERR_UNSUPPORTED;
+  }
+
+  for (int i = 0; i < GPS_ID_MAX; i++) {
+    bool ring_limited;
+    uint32_t baud;
+
+    if (config->gps[i] == GPS_TYPE_NONE) {
+      continue;
+    }
+
+    baud = gps_rate_pick_baud((gps_id_t)i, hz, &ring_limited);
+    if (baud == 0) {
+      return ring_limited ? GPS_RATE_ERR_RING : GPS_RATE_ERR_UART;
+    }
+
+    // 실제로 받고 있는 양으로 다시 확인 (메시지를 더 켠 경우)
+    if (!gps_rate_load_ok(gps_rate_bytes_per_s((gps_id_t)i, hz, true), baud)) {
+      return GPS_RATE_ERR_UART;
+    }
+  }
+
+  return GPS_RATE_OK;
+}
+
+const char *gps_rate_result_str(gps_rate_result_t res) {
+  switch (res) {
+  case GPS_RATE_OK:
+    return "ok";
+  case GPS_RATE_ERR_INVALID:
+    return "invalid rate";
+  case GPS_RATE_ERR_UNSUPPORTED:
+    return "base station is fixed at 1 Hz";
+  case GPS_RATE_ERR_RING:
+    return "RX ring too small for required baud";
+  case GPS_RATE_ERR_UART:
+    return "UART bandwidth exceeded";
+  }
+  return "?";
+}
+
+void gps_rate_note_epoch(gps_id_t id, uint32_t bytes) {
+  uint32_t avg;
+
+  if (id >= GPS_ID_MAX) {
+    return;
+  }
+
+  avg = epoch_avg_x8[id];
+  epoch_avg_x8[id] = avg ? avg - avg / 8 + bytes : bytes * 8;
+}
+
+uint32_t gps_rate_epoch_bytes(gps_id_t id) {
+  return id < GPS_ID_MAX ? epoch_avg_x8[id] / 8 : 0;
+}
+
+uint32_t gps_rate_min_decim(uint32_t hz, uint32_t line_len, uint32_t baud) {
+  uint32_t capacity = baud * GPS_RATE_MAX_LOAD_PCT / 100; // bit/s
+  uint32_t need = hz * line_len * 10;
+
+  if (capacity == 0) {
+    return 1;
+  }
+  return need > capacity ? (need + capacity - 1) / capacity : 1;
+}
@@ -0,0 +1,78 @@
+#ifndef GPS_RATE_H
+#define GPS_RATE_H
+
+#include "board_config.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * 항법 해 주기 (user_params_t.nav_rate_hz)
+ *
+ * rover 보드만 바꿀 수 있고 기준국은 1 Hz 고정 (RTCM 출력 주기가 LoRa/NTRIP
+ * 대역을 정한다). 수신기 설정과 UART 속도는 부팅 때 정해지므로 바꾼 값은
+ * 저장 후 재부팅부터 적용된다.
+ */
+#define GPS_NAV_RATE_DEFAULT_HZ 20 /**< rover 기본 (기존 50 ms 고정값) */
+
+/* UART 가 이 비율 이상 차는 조합은 받지 않는다 (NMEA/RTCM 묶음이 몰리는 여유) */
+#define GPS_RATE_MAX_LOAD_PCT 60
+
+/* 링이 최소 이만큼의 최대 속도 수신을 담아야 함 (HT 인터럽트 후 태스크가 깨는 여유) */
+#define GPS_RATE_RING_MIN_MS 50
+
+typedef enum {
+  GPS_RATE_OK = 0,
+  GPS_RATE_ERR_INVALID,     /**< 1/2/5/10/20 Hz 가 아님 */
+  GPS_RATE_ERR_UNSUPPORTED, /**< 기준국 보드 */
+  GPS_RATE_ERR_RING,        /**< 링에 맞는 UART 속도가 없음 */
+  GPS_RATE_ERR_UART,        /**< UART 대역으로 못 보냄 */
+} gps_rate_result_t;
+
+bool gps_rate_is_valid(uint32_t hz);
+
+/**
+ * @brief 이번 부팅에 적용된 항법 주기 [Hz] (처음 부를 때 설정에서 읽어 고정)
+ */
+uint32_t gps_rate_get_hz(void);
+
+/**
+ * @brief 측정 주기 [ms] (UBX CFG-RATE-MEAS)
+ */
+uint16_t gps_rate_meas_ms(uint32_t hz);
+
+/**
+ * @brief UM982 log 주기 문자열 ("0.05", "0.1", "1" ...)
+ */
+void gps_rate_period_str(uint32_t hz, char *buf, size_t size);
+
+/**
+ * @brief hz 에서 쓸 수신기 UART 속도
+ *
+ * 링 크기와 예상 부하가 허용하는 가장 낮은 속도. 맞는 속도가 없으면 0.
+ * UM982 는 아직 속도를 바꾸지 않으므로 115200 만 본다.
+ */
+uint32_t gps_rate_uart_baud(gps_id_t id, uint32_t hz);
+
+/**
+ * @brief hz 로 바꿔도 되는지 (예상치와 지금 측정한 epoch 당 byte 기준)
+ */
+gps_rate_result_t gps_rate_check(uint32_t hz);
+const char *gps_rate_result_str(gps_rate_result_t res);
+
+/**
+ * @brief 한 epoch 동안 받은 byte 기록 (GPS RX 태스크, 항법 해마다)
+ */
+void gps_rate_note_epoch(gps_id_t id, uint32_t bytes);
+
+/**
+ * @brief epoch 당 평균 수신 byte (아직 없으면 0)
+ */
+uint32_t gps_rate_epoch_bytes(gps_id_t id);
+
+/**
+ * @brief line_len byte 출력을 baud 링크로 hz 마다 보낼 때 필요한 최소 decimation
+ */
+uint32_t gps_rate_min_decim(uint32_t hz, uint32_t line_len, uint32_t baud);
+
+#endif
@@ -0,0 +1,190 @@
+#include "gps_tee.h"
+#include "flash_params.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#if USE_RS485
+#include "rs485_port.h"
+#elif USE_BLE
+#include "ble_port.h"
+#endif
+#if USE_USB
+#include "usb_app.h"
+#endif
+#if USE_SD_LOG
+#include "sd_log.h"
+#endif
+
+#ifndef TAG
+#define TAG "GPS_TEE"
+#endif
+
+#include "log.h"
+
+/* source 수신기의 RX 태스크 하나만 쓴다 (AT 쪽은 읽기만) */
+static gps_tee_stats_t tee_stats;
+static uint32_t tee_tokens; // 속도 제한 bucket [byte]
+static TickType_t tee_last;
+
+static inline size_t gps_tee_port_write(const void *data, size_t len) {
+#if USE_USB
+  if (usb_app_stream_on()) {
+    return usb_app_stream_write(data, len);
+  }
+#endif
+#if USE_RS485
+  return rs485_port_stream_write(data, len);
+#elif USE_BLE
+  return ble_port_stream_write(data, len);
+#else
+  (void)data;
+  (void)len;
+  return 0;
+#endif
+}
+
+static inline uint32_t gps_tee_port_dropped(void) {
+#if USE_USB
+  if (usb_app_stream_on()) {
+    return usb_app_stream_dropped();
+  }
+#endif
+#if USE_RS485
+  return rs485_port_stream_dropped();
+#elif USE_BLE
+  return ble_port_stream_dropped();
+#else
+  return 0;
+#endif
+}
+
+/**
+ * @brief 속도 제한 bucket 에서 len 만큼 꺼냄
+ *
+ * @param rate [byte/s], 0 이면 제한 없음
+ * @param len 보낼 길이
+ * @param partial true: 남은 만큼이라도 (RAW), false: 다 되거나 0 (프레임)
+ * @return size_t 보내도 되는 길이
+ */
+static size_t gps_tee_take(uint32_t rate, size_t len, bool partial) {
+  if (rate == 0) {
+    return len;
+  }
+
+  TickType_t now = xTaskGetTickCount();
+  uint32_t cap = rate / 1000U * GPS_TEE_BURST_MS;
+  uint64_t fill = (uint64_t)tee_tokens + (uint64_t)rate * (now - tee_last) / configTICK_RATE_HZ;
+
+  // 프레임 하나는 언제나 들어가야 통째로 보낼 수 있다
+  if (cap < GPS_PAYLOAD_SIZE + 2U) {
+    cap = GPS_PAYLOAD_SIZE + 2U;
+  }
+  tee_tokens = fill > cap ? cap : (uint32_t)fill;
+  tee_last = now;
+
+  if (len > tee_tokens) {
+    len = partial ? tee_tokens : 0;
+  }
+  tee_tokens -= (uint32_t)len;
+
+  return len;
+}
+
+static void gps_tee_write(const void *data, size_t len) {
+  size_t n = gps_tee_port_write(data, len);
+
+  tee_stats.bytes += n;
+}
+
+/**
+ * @brief 검증된 프레임 하나 송신 (GPS_SUB_ANY 구독 콜백)
+ */
+static void gps_tee_on_frame(gps_t *gps, gps_procotol_t protocol, gps_msg_t msg,
+                             void *ctx) {
+  const gps_tee_params_t *cfg = &flash_params_snapshot(NULL)->gps_tee;
+  gps_frame_t f;
+
+  if (cfg->src != (uint32_t)(uintptr_t)ctx || (cfg->mask & GPS_TEE_RAW) ||
+      !(cfg->mask & GPS_TEE_PROTO(protocol)) || !gps_get_frame(gps, &f)) {
+    return;
+  }
+
+  // NMEA/Unicore ASCII 는 '\r' 에서 끝나므로 '\n' 을 붙여 원래 줄로 만든다
+  bool ascii = (protocol == GPS_PROTOCOL_NMEA || protocol == GPS_PROTOCOL_UNICORE);
+  size_t len = f.len[0] + f.len[1] + (ascii ? 1U : 0U);
+
+  if (gps_tee_take(cfg->rate, len, false) == 0) {
+    tee_stats.limited += len;
+    return;
+  }
+
+  gps_tee_write(f.seg[0], f.len[0]);
+  if (f.len[1]) {
+    gps_tee_write(f.seg[1], f.len[1]);
+  }
+  if (ascii) {
+    gps_tee_write("\n", 1);
+  }
+  tee_stats.frames++;
+}
+
+void gps_tee_attach(gps_t *gps, gps_id_t id) {
+  static const gps_procotol_t protos[] = {
+      GPS_PROTOCOL_NMEA, GPS_PROTOCOL_UBX, GPS_PROTOCOL_UNICORE_BIN,
+      GPS_PROTOCOL_UNICORE, GPS_PROTOCOL_RTCM,
+  };
+
+  if (!USE_BLE && !USE_RS485 && !USE_USB) {
+    return;
+  }
+
+  for (size_t i = 0; i < sizeof(protos) / sizeof(protos[0]); i++) {
+    if (!gps_subscribe(gps, protos[i], GPS_SUB_ANY, gps_tee_on_frame,
+                       (void *)(uintptr_t)id)) {
+      LOG_WARN("GPS[%d] tee subscribe failed (protocol %d)", id, protos[i]);
+    }
+  }
+}
+
+void gps_tee_raw(gps_id_t id, const void *ring, size_t size, size_t from, size_t to) {
+  const gps_tee_params_t *cfg = &flash_params_snapshot(NULL)->gps_tee;
+  const uint8_t *r = ring;
+  size_t len;
+  size_t n;
+
+#if USE_SD_LOG
+  // SD 기록은 tee 설정과 따로 (수신 byte 전부, 속도 제한 없음)
+  sd_log_raw(id, ring, size, from, to);
+#endif
+
+  if (cfg->src != (uint32_t)id || !(cfg->mask & GPS_TEE_RAW) || from == to) {
+    return;
+  }
+
+  len = (to > from) ? to - from : size - from + to;
+  n = gps_tee_take(cfg->rate, len, true);
+  tee_stats.limited += len - n;
+  if (n == 0) {
+    return;
+  }
+
+  // 링 끝에서 나뉘면 두 구간
+  if (from + n <= size) {
+    gps_tee_write(&r[from], n);
+  } else {
+    gps_tee_write(&r[from], size - from);
+    gps_tee_write(r, n - (size - from));
+  }
+  tee_stats.frames++;
+}
+
+void gps_tee_get_stats(gps_tee_stats_t *stats) {
+  *stats = tee_stats;
+  stats->dropped = gps_tee_port_dropped();
+}
+
+/**
+ * @brief 설정 값 검사 (알 수 없는 비트, 없는 수신기)
+ */
+bool gps_tee_params_valid(uint32_t mask, uint32_t src) {
+  return (mask & ~GPS_TEE_MASK_ALL) == 0 && src < GPS_CNT;
+}
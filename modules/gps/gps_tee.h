@@ -0,0 +1,55 @@
+#ifndef GPS_TEE_H
+#define GPS_TEE_H
+
+#include "gps.h"
+#include "board_config.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * GNSS raw tee: 수신기 스트림을 외부 포트 (BLE 또는 RS485, 보드에 있는 쪽) 로
+ * (USB 포트가 USB+RAW 모드면 그쪽으로)
+ *
+ * 후처리용으로 선택한 프로토콜의 프레임 (또는 수신 byte 전부) 을 그대로
+ * 내보낸다. 프레임은 RX 링에서 바로 외부 포트의 송신 링으로 구간 복사하고
+ * DMA 가 비우므로 byte 단위 CPU 작업은 없다. 설정은 user_params_t.gps_tee
+ * (AT+GTEE / BLE RT+) 이고 저장하면 바로 적용된다.
+ *
+ * SD 카드 기록 (sd_log.h) 도 gps_tee_raw 에서 같은 구간을 받는다.
+ */
+
+/* gps_tee_params_t.mask: 프로토콜별 프레임 (1 << gps_procotol_t) */
+#define GPS_TEE_PROTO(p) (1UL << (p))
+/* gps_tee_params_t.mask: 프레임 구분 없이 수신 byte 전부 (다른 비트는 무시) */
+#define GPS_TEE_RAW (1UL << 15)
+#define GPS_TEE_MASK_ALL                                                       \
+  (GPS_TEE_PROTO(GPS_PROTOCOL_NMEA) | GPS_TEE_PROTO(GPS_PROTOCOL_UBX) |        \
+   GPS_TEE_PROTO(GPS_PROTOCOL_UNICORE_BIN) |                                   \
+   GPS_TEE_PROTO(GPS_PROTOCOL_UNICORE) | GPS_TEE_PROTO(GPS_PROTOCOL_RTCM) |    \
+   GPS_TEE_RAW)
+
+/* 속도 제한 bucket 크기: 이 시간 분량 또는 RTCM 최대 프레임 중 큰 쪽 [ms] */
+#define GPS_TEE_BURST_MS 250
+
+typedef struct {
+  uint32_t frames;  /**< 보낸 프레임 (RAW 는 RX 구간) */
+  uint32_t bytes;   /**< 송신 링에 넣은 byte */
+  uint32_t limited; /**< 속도 제한으로 버린 byte */
+  uint32_t dropped; /**< 송신 링이 가득 차서 버린 byte (포트 누적) */
+} gps_tee_stats_t;
+
+/**
+ * @brief 수신기 구독 등록 (RX 태스크 시작 때, 수신기마다)
+ */
+void gps_tee_attach(gps_t *gps, gps_id_t id);
+
+/**
+ * @brief RAW 모드 구간 송신 (RX 태스크, 파싱한 링 구간마다)
+ */
+void gps_tee_raw(gps_id_t id, const void *ring, size_t size, size_t from, size_t to);
+
+void gps_tee_get_stats(gps_tee_stats_t *stats);
+bool gps_tee_params_valid(uint32_t mask, uint32_t src);
+
+#endif
@@ -0,0 +1,223 @@
+#include "gps_time.h"
+#include "gps_port.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "stm32f4xx.h"
+
+/* epoch 기록 개수 (gps_fuse 가 늦게 확정해도 찾을 수 있게) */
+#define GPS_TIME_EPOCHS 8
+/* 이 수만큼 연속으로 간격이 맞은 PPS 부터 믿음 */
+#define GPS_TIME_PPS_LOCK 2
+/* 출력 지연이 이보다 길면 (PPS 를 잘못 짝지음) 버림 [ms] */
+#define GPS_TIME_LATENCY_MAX_MS 500
+#define GPS_TIME_WEEK_MS 604800000U
+
+typedef struct {
+  uint32_t itow; // [ms]
+  uint32_t cyc;  // epoch 시각 (DWT)
+} gps_time_epoch_t;
+
+typedef struct {
+  /* PPS ISR 이 쓰고 태스크는 critical section 안에서 읽음 */
+  uint32_t pps_cyc;     // 마지막 PPS (DWT)
+  uint32_t cyc_per_sec; // PPS 간격으로 잰 코어 클럭 (0: 모름)
+  uint8_t pps_lock;     // 연속으로 간격이 맞은 PPS 수
+
+  /* 아래는 RX 태스크가 쓰고 출력 태스크가 critical section 안에서 읽음 */
+  uint32_t latency_cyc; // epoch -> 프레임 도착 (평균, 0: 모름)
+  gps_time_epoch_t epoch[GPS_TIME_EPOCHS];
+  uint8_t head;
+} gps_time_state_t;
+
+static gps_time_state_t gps_time_state[GPS_ID_MAX];
+
+static inline uint32_t gps_time_cps(const gps_time_state_t *st) {
+  return st->cyc_per_sec ? st->cyc_per_sec : SystemCoreClock;
+}
+
+static inline int64_t floor_div(int64_t a, int64_t b) {
+  return (a >= 0) ? a / b : -((-a + b - 1) / b);
+}
+
+void gps_time_pps_isr(gps_id_t id) {
+  uint32_t cyc = DWT->CYCCNT;
+  gps_time_state_t *st;
+
+  if (id >= GPS_ID_MAX) {
+    return;
+  }
+
+  st = &gps_time_state[id];
+  uint32_t period = cyc - st->pps_cyc;
+  uint32_t tol = SystemCoreClock / (1000000U / GPS_TIME_PPS_TOL_PPM);
+
+  if (period + tol - SystemCoreClock <= 2U * tol) {
+    // 코어 클럭 오차도 PPS 로 같이 잰다 (1/8 평균)
+    if (st->cyc_per_sec == 0) {
+      st->cyc_per_sec = period;
+    } else {
+      st->cyc_per_sec += ((int32_t)(period - st->cyc_per_sec)) / 8;
+    }
+    if (st->pps_lock < UINT8_MAX) {
+      st->pps_lock++;
+    }
+  } else {
+    st->pps_lock = 0;
+  }
+  st->pps_cyc = cyc;
+}
+
+/**
+ * @brief PPS 기준 epoch 시각
+ *
+ * 프레임 도착 시각 arr 직전 PPS 를 GPS 초 S 의 경계로 보고, 출력 지연이
+ * 1 s 보다 짧다는 가정으로 S 를 고른다.
+ *   arr = PPS + e [ms], epoch 는 arr 보다 앞이고 1 s 안
+ *   -> S*1000 은 (itow - e, itow - e + 1000] 안의 유일한 1000 배수
+ */
+static bool gps_time_epoch_from_pps(uint32_t pps_cyc, uint32_t cps, uint32_t itow,
+                                    uint32_t arr, uint32_t *epoch) {
+  uint32_t since = arr - pps_cyc;
+
+  if (since > cps + cps / 2) {
+    return false; // PPS 가 끊김
+  }
+
+  int64_t e_ms = (int64_t)since * 1000 / cps;
+  int64_t sec_ms = floor_div((int64_t)itow - e_ms + 999, 1000) * 1000;
+  int64_t off_ms = (int64_t)itow - sec_ms; // PPS 기준 epoch 위치 (음수: PPS 앞)
+
+  *epoch = pps_cyc + (uint32_t)(int32_t)(off_ms * cps / 1000);
+  return true;
+}
+
+void gps_time_note_epoch(gps_id_t id, uint32_t itow, uint32_t rx_count) {
+  gps_time_state_t *st;
+  uint32_t arr;
+  uint32_t pps_cyc;
+  uint32_t cps;
+  uint32_t epoch;
+  bool locked;
+
+  if (id >= GPS_ID_MAX) {
+    return;
+  }
+  st = &gps_time_state[id];
+
+  if (!gps_port_rx_time(id, rx_count, &arr)) {
+    arr = DWT->CYCCNT; // IDLE 전에 파싱됨, 파싱 지연만큼 늦게 잡힘
+  }
+
+  taskENTER_CRITICAL();
+  pps_cyc = st->pps_cyc;
+  cps = gps_time_cps(st);
+  locked = st->pps_lock >= GPS_TIME_PPS_LOCK;
+  taskEXIT_CRITICAL();
+
+  if (locked && gps_time_epoch_from_pps(pps_cyc, cps, itow, arr, &epoch)) {
+    uint32_t latency = arr - epoch;
+
+    if (latency < cps / 1000 * GPS_TIME_LATENCY_MAX_MS) {
+      // PPS 가 빠질 때 쓸 출력 지연 (1/8 평균)
+      if (st->latency_cyc == 0) {
+        st->latency_cyc = latency;
+      } else {
+        st->latency_cyc += ((int32_t)(latency - st->latency_cyc)) / 8;
+      }
+    }
+  } else {
+    epoch = arr - st->latency_cyc;
+  }
+
+  taskENTER_CRITICAL();
+  st->epoch[st->head].itow = itow;
+  st->epoch[st->head].cyc = epoch;
+  st->head = (st->head + 1) % GPS_TIME_EPOCHS;
+  taskEXIT_CRITICAL();
+}
+
+bool gps_time_epoch_age(gps_id_t id, uint32_t itow, uint32_t *age_us) {
+  gps_time_state_t *st;
+  uint32_t cyc = 0;
+  uint32_t cps;
+  bool found = false;
+
+  if (id >= GPS_ID_MAX) {
+    return false;
+  }
+  st = &gps_time_state[id];
+
+  taskENTER_CRITICAL();
+  for (uint8_t i = 0; i < GPS_TIME_EPOCHS && !found; i++) {
+    const gps_time_epoch_t *ep = &st->epoch[(st->head + GPS_TIME_EPOCHS - 1 - i) % GPS_TIME_EPOCHS];
+
+    if (ep->cyc != 0 && ep->itow == itow) {
+      cyc = ep->cyc;
+      found = true;
+    }
+  }
+  cps = gps_time_cps(st);
+  taskEXIT_CRITICAL();
+
+  if (!found) {
+    return false;
+  }
+
+  uint32_t age = DWT->CYCCNT - cyc;
+  if (age > cps) {
+    return false; // 1 s 넘게 지난 epoch (DWT 가 한 바퀴 돌았을 수도)
+  }
+
+  *age_us = (uint32_t)((uint64_t)age * 1000000U / cps);
+  return true;
+}
+
+bool gps_time_now_tow(gps_id_t id, uint32_t *tow_ms) {
+  gps_time_state_t *st;
+  gps_time_epoch_t ep;
+  uint32_t cps;
+
+  if (id >= GPS_ID_MAX) {
+    return false;
+  }
+  st = &gps_time_state[id];
+
+  taskENTER_CRITICAL();
+  ep = st->epoch[(st->head + GPS_TIME_EPOCHS - 1) % GPS_TIME_EPOCHS];
+  cps = gps_time_cps(st);
+  taskEXIT_CRITICAL();
+
+  uint32_t age = DWT->CYCCNT - ep.cyc;
+  if (ep.cyc == 0 || age > 2 * cps) {
+    return false;
+  }
+
+  *tow_ms = (ep.itow + (uint32_t)((uint64_t)age * 1000U / cps)) % GPS_TIME_WEEK_MS;
+  return true;
+}
+
+bool gps_time_pps_locked(gps_id_t id) {
+  gps_time_state_t *st;
+  bool locked;
+
+  if (id >= GPS_ID_MAX) {
+    return false;
+  }
+  st = &gps_time_state[id];
+
+  taskENTER_CRITICAL();
+  uint32_t cps = gps_time_cps(st);
+  locked = st->pps_lock >= GPS_TIME_PPS_LOCK && DWT->CYCCNT - st->pps_cyc <= cps + cps / 2;
+  taskEXIT_CRITICAL();
+
+  return locked;
+}
+
+uint32_t gps_time_latency_us(gps_id_t id) {
+  if (id >= GPS_ID_MAX) {
+    return 0;
+  }
+
+  const gps_time_state_t *st = &gps_time_state[id];
+  return (uint32_t)((uint64_t)st->latency_cyc * 1000000U / gps_time_cps(st));
+}
@@ -0,0 +1,65 @@
+#ifndef GPS_TIME_H
+#define GPS_TIME_H
+
+#include "board_config.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * 수신기 GPS 시각(iTOW) <-> 로컬 시각(DWT cycle) 대응
+ *
+ * 수신기 PPS (RTK_INT/RTK2_INT, rising edge = GPS 초 경계) 를 EXTI 에서
+ * DWT 로 찍고, 항법 해 프레임이 다 들어온 시각은 UART IDLE 시각에서
+ * 거꾸로 구한다 (gps_port_rx_time). PPS 가 잡혀 있으면 해의 epoch 시각을
+ * PPS 기준으로 바로 알고, 그 동안 재 둔 출력 지연 (epoch -> 프레임 도착)
+ * 으로 PPS 가 없을 때도 epoch 시각을 추정한다.
+ *
+ * PA4/PA7 에는 타이머 채널이 없어 input capture 대신 EXTI 진입 시각을 쓴다
+ * (지터는 인터럽트 지연, critical section 길이 정도).
+ */
+
+/* PPS 간격이 코어 클럭에서 이 이상 벗어나면 (ppm) PPS 로 보지 않음 */
+#define GPS_TIME_PPS_TOL_PPM 1000
+
+/**
+ * @brief PPS rising edge (EXTI ISR 첫머리에서 호출)
+ */
+void gps_time_pps_isr(gps_id_t id);
+
+/**
+ * @brief 항법 해 epoch 기록 (RX 태스크, 해를 게시할 때)
+ *
+ * @param id GPS ID
+ * @param itow 해의 iTOW [ms]
+ * @param rx_count 해 프레임 마지막 byte 까지의 gps_port_get_rx_count() 값
+ */
+void gps_time_note_epoch(gps_id_t id, uint32_t itow, uint32_t rx_count);
+
+/**
+ * @brief 최근 epoch 가 지금부터 얼마 전인지 [us]
+ *
+ * @param id GPS ID
+ * @param itow 해의 iTOW [ms] (최근 몇 epoch 안이어야 함)
+ * @param[out] age_us
+ * @return true: 해당 epoch 의 시각을 앎
+ */
+bool gps_time_epoch_age(gps_id_t id, uint32_t itow, uint32_t *age_us);
+
+/**
+ * @brief 지금 GPS 시각 [ms, 주 안] (최근 epoch iTOW + 그 뒤 지난 시간)
+ *
+ * @return false: 최근 2 초 안에 항법 해가 없음
+ */
+bool gps_time_now_tow(gps_id_t id, uint32_t *tow_ms);
+
+/**
+ * @brief PPS 로 시각을 맞추고 있는지
+ */
+bool gps_time_pps_locked(gps_id_t id);
+
+/**
+ * @brief 재 둔 출력 지연 (epoch -> 프레임 도착) [us], 모르면 0
+ */
+uint32_t gps_time_latency_us(gps_id_t id);
+
+#endif
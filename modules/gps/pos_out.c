@@ -0,0 +1,255 @@
+#include "pos_out.h"
+#include "app_events.h"
+#include "epoch_deadline.h"
+#include "gps_gga.h"
+#include "semphr.h"
+#include "task.h"
+#include <string.h>
+
+#ifndef TAG
+#define TAG "POS_OUT"
+#endif
+
+#include "log.h"
+
+typedef struct {
+  uint8_t buf[POS_OUT_BUF_SIZE];
+  uint16_t len;
+  uint32_t epoch; // 만든 epoch (0: 아직 없음)
+} pos_out_slot_t;
+
+/* 형식 버퍼, sink 목록, epoch 위치 (lock) */
+static SemaphoreHandle_t po_lock;
+static StaticSemaphore_t po_lock_buf;
+
+static pos_out_sink_t *po_sinks[POS_OUT_SINK_MAX];
+static uint8_t po_sink_cnt;
+static pos_out_render_t po_render[POS_OUT_FMT_COUNT];
+static pos_out_slot_t po_slot[POS_OUT_FMT_COUNT];
+static gps_position_t po_pos;
+static uint32_t po_epoch;
+static pos_out_stats_t po_stats;
+static volatile uint32_t po_shed = 1; // 과부하 솎기 배수 (pos_out_set_shed)
+static uint16_t po_dl_epoch;            // 이번 epoch 의 epoch_dl 순번
+static int po_dl_fanout = -1;
+
+static size_t pos_out_render_gga(const gps_position_t *pos, uint8_t *buf, size_t size) {
+  gps_nav_data_t nav;
+
+  (void)pos;
+
+  // GGA 는 위치 외에 hdop/pdop, geoid 가 필요해서 항법 해 그대로
+  if (!gps_get_nav(GPS_ID_BASE, &nav) || nav.fix < GPS_FIX_GPS) {
+    return 0;
+  }
+
+  return gps_gga_build(&nav, (char *)buf, size);
+}
+
+static uint8_t pos_out_resolve(uint8_t fmt) {
+  if (fmt == POS_OUT_FMT_USER) {
+    return (uint8_t)gps_pos_format_resolve(false);
+  }
+  if (fmt == POS_OUT_FMT_USER_BINARY) {
+    return (uint8_t)gps_pos_format_resolve(true);
+  }
+
+  return fmt;
+}
+
+/**
+ * @brief 형식 하나를 이번 epoch 에 아직 안 만들었으면 만듦 (lock 보유)
+ *
+ * 항법 해 전 (epoch 0) 에는 캐시하지 않고 매번 만든다.
+ */
+static const pos_out_slot_t *pos_out_render(uint8_t fmt) {
+  pos_out_slot_t *slot;
+  size_t len = 0;
+
+  if (fmt >= POS_OUT_FMT_COUNT) {
+    return NULL;
+  }
+
+  slot = &po_slot[fmt];
+  if (po_epoch != 0 && slot->epoch == po_epoch) {
+    return slot;
+  }
+
+  if (fmt < GPS_POS_FORMAT_COUNT) {
+    len = gps_render_position(fmt, &po_pos, slot->buf, sizeof(slot->buf));
+  } else if (po_render[fmt]) {
+    len = po_render[fmt](&po_pos, slot->buf, sizeof(slot->buf));
+  }
+
+  slot->len = (uint16_t)len;
+  slot->epoch = po_epoch;
+  po_stats.renders[fmt]++;
+
+  return slot;
+}
+
+/**
+ * @brief 이번 epoch 에 보낼 차례인지 (decim 번째마다, period 가 지났으면)
+ */
+static bool pos_out_due(pos_out_sink_t *s, TickType_t now) {
+  uint32_t decim = s->decim ? s->decim() : 1;
+
+  if (decim == 0) {
+    decim = 1;
+  }
+  // period 로 도는 sink (caster GGA) 는 이미 드물어 솎지 않음
+  if (!s->period_ms) {
+    decim *= po_shed;
+  }
+  if (++s->cnt < decim) {
+    return false;
+  }
+
+  if (s->period_ms && s->sent_once &&
+      now - s->last < pdMS_TO_TICKS(s->period_ms())) {
+    return false;
+  }
+
+  s->cnt = 0;
+  return true;
+}
+
+static void pos_out_on_solution(const event_msg_t *msg) {
+  const app_evt_gps_solution_t *evt = (const app_evt_gps_solution_t *)msg->data;
+  TickType_t now = xTaskGetTickCount();
+
+  epoch_dl_done(po_dl_fanout, evt->epoch);
+
+  xSemaphoreTake(po_lock, portMAX_DELAY);
+  po_dl_epoch = evt->epoch;
+
+  po_epoch++;
+  if (po_epoch == 0) {
+    po_epoch = 1;
+  }
+  gps_get_output_position(&po_pos);
+  po_stats.epochs++;
+
+  for (uint8_t i = 0; i < po_sink_cnt; i++) {
+    pos_out_sink_t *s = po_sinks[i];
+
+    if (!s->enabled || !pos_out_due(s, now)) {
+      continue;
+    }
+
+    const pos_out_slot_t *slot = pos_out_render(pos_out_resolve(s->fmt));
+    if (!slot || slot->len == 0) {
+      continue;
+    }
+
+    if (s->emit(slot->buf, slot->len)) {
+      s->last = now;
+      s->sent_once = true;
+      s->sent++;
+      po_stats.emits++;
+      epoch_dl_done(s->dl, evt->epoch);
+    }
+  }
+
+  xSemaphoreGive(po_lock);
+}
+
+void pos_out_init(void) {
+  po_lock = xSemaphoreCreateMutexStatic(&po_lock_buf);
+  po_render[POS_OUT_FMT_NMEA_GGA] = pos_out_render_gga;
+  po_dl_fanout = epoch_dl_register("fanout", true);
+
+  // 포맷팅과 sink 큐 복사라 LOW lane
+  app_event_subscribe(APP_EVT_BIT(APP_EVT_GPS_SOLUTION), pos_out_on_solution,
+                      EVENT_BUS_LANE_LOW);
+}
+
+bool pos_out_register(pos_out_sink_t *sink) {
+  bool ok = true;
+
+  if (!po_lock || !sink || !sink->emit) {
+    return false;
+  }
+
+  xSemaphoreTake(po_lock, portMAX_DELAY);
+  for (uint8_t i = 0; i < po_sink_cnt; i++) {
+    if (po_sinks[i] == sink) {
+      xSemaphoreGive(po_lock);
+      return true;
+    }
+  }
+  if (po_sink_cnt < POS_OUT_SINK_MAX) {
+    sink->dl = (int8_t)epoch_dl_register(sink->name, false);
+    po_sinks[po_sink_cnt++] = sink;
+  } else {
+    ok = false;
+  }
+  xSemaphoreGive(po_lock);
+
+  if (!ok) {
+    LOG_ERR("sink %s: table full", sink->name);
+  }
+  return ok;
+}
+
+void pos_out_enable(pos_out_sink_t *sink, bool on) {
+  sink->cnt = 0;
+  sink->enabled = on;
+}
+
+void pos_out_set_shed(uint32_t mult) { po_shed = mult ? mult : 1; }
+
+void pos_out_set_render(pos_out_fmt_t fmt, pos_out_render_t render) {
+  if (fmt < POS_OUT_FMT_COUNT) {
+    po_render[fmt] = render;
+  }
+}
+
+size_t pos_out_get(uint8_t fmt, uint8_t *buf, size_t size) {
+  const pos_out_slot_t *slot;
+  size_t len = 0;
+
+  if (!po_lock) {
+    return 0;
+  }
+
+  xSemaphoreTake(po_lock, portMAX_DELAY);
+  if (po_epoch == 0) {
+    gps_get_output_position(&po_pos);
+  }
+  slot = pos_out_render(pos_out_resolve(fmt));
+  if (slot && slot->len <= size) {
+    len = slot->len;
+    memcpy(buf, slot->buf, len);
+  }
+  xSemaphoreGive(po_lock);
+
+  return len;
+}
+
+void pos_out_position(gps_position_t *pos) {
+  if (!po_lock) {
+    gps_get_output_position(pos);
+    return;
+  }
+
+  xSemaphoreTake(po_lock, portMAX_DELAY);
+  if (po_epoch == 0) {
+    gps_get_output_position(&po_pos);
+  }
+  *pos = po_pos;
+  xSemaphoreGive(po_lock);
+}
+
+void pos_out_get_stats(pos_out_stats_t *out) {
+  if (!po_lock) {
+    memset(out, 0, sizeof(*out));
+    return;
+  }
+
+  xSemaphoreTake(po_lock, portMAX_DELAY);
+  *out = po_stats;
+  xSemaphoreGive(po_lock);
+}
+
+uint16_t pos_out_epoch(void) { return po_dl_epoch; }
@@ -0,0 +1,133 @@
+#ifndef POS_OUT_H
+#define POS_OUT_H
+
+#include "gps_app.h"
+#include "FreeRTOS.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * 위치 출력 관리자
+ *
+ * 항법 해 (APP_EVT_GPS_SOLUTION) 하나를 LOW lane 에서 한 번 받아 출력 위치를
+ * 한 번 읽고, 등록된 출력 (sink) 중 차례가 된 것의 형식만 epoch 당 한 번
+ * 포맷팅해 공유 버퍼에 둔다. 같은 형식의 sink 는 그 버퍼를 같이 보내므로
+ * 포맷 비용은 sink 수가 아니라 형식 수에 비례하고, 모든 sink 가 같은
+ * 위치/같은 시점으로 나간다.
+ *
+ * 요청이 올 때 보내는 출력 (BLE GN, Modbus 읽기) 은 pos_out_get() 으로
+ * 이번 epoch 에 만든 것을 받는다 (아직 없으면 이때 만든다).
+ *
+ * 항법 해를 받은 때 (fan-out) 와 sink 마다 emit 을 마친 때를 epoch_dl 에
+ * 소비자 "fanout" 과 sink 이름으로 기록한다.
+ */
+typedef enum {
+  POS_OUT_FMT_ASCII = GPS_POS_FORMAT_ASCII,             // +GPS
+  POS_OUT_FMT_BINARY = GPS_POS_FORMAT_BINARY,           // 0xA5 0x5A 프레임
+  POS_OUT_FMT_GRID_ASCII = GPS_POS_FORMAT_GRID_ASCII,   // +GRD
+  POS_OUT_FMT_GRID_BINARY = GPS_POS_FORMAT_GRID_BINARY, // 0xA5 0x5C 프레임
+  POS_OUT_FMT_NMEA_GGA,                                 // GGA 문장 (gps_gga_build)
+  POS_OUT_FMT_MODBUS,  // 입력 레지스터 이미지 (pos_out_set_render 로 등록)
+  POS_OUT_FMT_CAN,     // can_frame_t 배열 (can_app 이 등록)
+  POS_OUT_FMT_COUNT,
+
+  /* sink 용: epoch 마다 pos_output_format 설정으로 위 형식 중 하나로 */
+  POS_OUT_FMT_USER = POS_OUT_FMT_COUNT,
+  POS_OUT_FMT_USER_BINARY, // 설정과 같은 좌표의 binary
+} pos_out_fmt_t;
+
+/* 형식 하나의 공유 버퍼 크기 */
+#define POS_OUT_BUF_SIZE GPS_POS_ASCII_MAX_LEN
+
+#define POS_OUT_SINK_MAX 8
+
+/**
+ * @brief 형식 하나 포맷팅 (관리자 잠금 안에서 불림)
+ *
+ * @return size_t 길이, 보낼 것이 없으면 0 (fix 없음 등)
+ */
+typedef size_t (*pos_out_render_t)(const gps_position_t *pos, uint8_t *buf, size_t size);
+
+typedef struct pos_out_sink_s pos_out_sink_t;
+
+/**
+ * @brief 출력 하나
+ *
+ * static 으로 두고 POS_OUT_SINK_INIT 로 채운다. emit 은 관리자 잠금 안,
+ * LOW lane 에서 불리고 data 는 그 안에서만 유효하므로 블로킹 없이 큐에
+ * 복사해 넣는다. false 를 돌려주면 보낸 것으로 치지 않는다 (period 기준).
+ */
+struct pos_out_sink_s {
+  const char *name;
+  uint8_t fmt;                 // pos_out_fmt_t
+  uint32_t (*decim)(void);     // N 번째 epoch 마다 (NULL: 매 epoch)
+  uint32_t (*period_ms)(void); // 보낸 뒤 최소 간격 (NULL: 없음)
+  bool (*emit)(const uint8_t *data, size_t len);
+  volatile bool enabled;
+
+  /* 관리자 상태 */
+  uint32_t cnt;
+  TickType_t last;
+  bool sent_once;
+  uint32_t sent;
+  int8_t dl; // epoch_dl 소비자
+};
+
+#define POS_OUT_SINK_INIT(name, fmt, decim, period_ms, emit, on)                \
+  {(name), (fmt), (decim), (period_ms), (emit), (on), 0, 0, false, 0, -1}
+
+typedef struct {
+  uint32_t epochs;                    // 받은 항법 해
+  uint32_t renders[POS_OUT_FMT_COUNT]; // 형식별 포맷팅 횟수
+  uint32_t emits;                     // sink 로 보낸 횟수
+} pos_out_stats_t;
+
+/**
+ * @brief 잠금 생성, 항법 해 구독 (app_events_init 뒤, sink 등록 전)
+ */
+void pos_out_init(void);
+
+/**
+ * @brief sink 등록 (같은 sink 를 다시 넘기면 무시)
+ */
+bool pos_out_register(pos_out_sink_t *sink);
+
+/**
+ * @brief sink 켜고 끄기 (켤 때 decimation 을 처음부터)
+ */
+void pos_out_enable(pos_out_sink_t *sink, bool on);
+
+/**
+ * @brief 과부하 때 sink 출력 솎기 (각 sink 의 decim 에 곱함, 1: 끔)
+ *
+ * period_ms 가 있는 sink 는 그대로 둔다.
+ */
+void pos_out_set_shed(uint32_t mult);
+
+/**
+ * @brief 내장이 아닌 형식 (POS_OUT_FMT_MODBUS, CAN) 의 포맷 함수 등록
+ */
+void pos_out_set_render(pos_out_fmt_t fmt, pos_out_render_t render);
+
+/**
+ * @brief 이번 epoch 의 출력 복사 (요청 응답용, 아직 없으면 지금 만듦)
+ *
+ * @param[in] fmt POS_OUT_FMT_USER 등 sink 용 값도 됨
+ * @return size_t 길이, 실패 시 0
+ */
+size_t pos_out_get(uint8_t fmt, uint8_t *buf, size_t size);
+
+/**
+ * @brief 이번 epoch 에 쓴 출력 위치 (항법 해 전이면 지금 위치)
+ */
+void pos_out_position(gps_position_t *pos);
+
+void pos_out_get_stats(pos_out_stats_t *out);
+
+/**
+ * @brief 지금 내보내는 epoch 의 epoch_dl 순번 (sink emit 안에서)
+ */
+uint16_t pos_out_epoch(void);
+
+#endif
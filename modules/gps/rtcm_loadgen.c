@@ -0,0 +1,217 @@
+#include "rtcm_loadgen.h"
+#include "rtcm.h"
+#include "rtcm_msm.h"
+#include "task.h"
+#include <string.h>
+
+#ifndef TAG
+#define TAG "RTCM_GEN"
+#endif
+
+#include "log.h"
+
+#define RTCM_PREAMBLE 0xD3
+
+/* 설정은 AT 쪽 태스크가 쓰고 RX 태스크가 critical section 안에서 복사 */
+static rtcm_loadgen_cfg_t lg_cfg;
+static bool lg_restart;
+static rtcm_loadgen_stats_t lg_stats;
+
+/* 아래는 GPS RX 태스크만 씀 */
+static TickType_t lg_next;
+static bool lg_injecting;
+static bool lg_deferred;
+static uint32_t lg_rand = 0x2545F491U;
+static uint8_t lg_buf[GPS_PAYLOAD_SIZE]; // 파서가 링으로 보는 프레임 하나
+
+static uint32_t rtcm_loadgen_rand(void) {
+  // xorshift32, 내용은 아무 값이면 되고 CRC 만 맞으면 된다
+  lg_rand ^= lg_rand << 13;
+  lg_rand ^= lg_rand >> 17;
+  lg_rand ^= lg_rand << 5;
+  return lg_rand;
+}
+
+/**
+ * @brief payload 의 pos 비트부터 n 비트 (MSB 먼저) 기록
+ */
+static void rtcm_loadgen_put_bits(uint8_t *p, uint32_t pos, uint8_t n, uint32_t val) {
+  for (uint8_t i = 0; i < n; i++, pos++) {
+    uint8_t mask = (uint8_t)(0x80U >> (pos % 8));
+
+    if ((val >> (n - 1 - i)) & 1U) {
+      p[pos / 8] |= mask;
+    } else {
+      p[pos / 8] &= (uint8_t)~mask;
+    }
+  }
+}
+
+/**
+ * @brief 합성 프레임 하나 생성
+ *
+ * @param more MSM multiple message bit (같은 epoch 의 MSM 이 뒤에 더 있음)
+ * @return size_t 프레임 길이 (헤더 3 + payload + CRC 3)
+ */
+static size_t rtcm_loadgen_build(const rtcm_loadgen_type_t *t, uint32_t epoch_ms,
+                                 bool more) {
+  uint16_t len = t->len_min;
+  uint8_t *p = &lg_buf[3];
+
+  if (t->len_max > t->len_min) {
+    len += (uint16_t)(rtcm_loadgen_rand() % (uint32_t)(t->len_max - t->len_min + 1U));
+  }
+
+  for (uint16_t i = 0; i < len; i += 4) {
+    uint32_t r = rtcm_loadgen_rand();
+    memcpy(&p[i], &r, (len - i) < 4 ? (size_t)(len - i) : 4U);
+  }
+
+  lg_buf[0] = RTCM_PREAMBLE;
+  lg_buf[1] = (uint8_t)((len >> 8) & 0x03);
+  lg_buf[2] = (uint8_t)(len & 0xFF);
+  rtcm_loadgen_put_bits(p, 0, 12, t->msg_type);
+  rtcm_loadgen_put_bits(p, 12, 12, 0); // station id
+  if (rtcm_msm_gnss(t->msg_type) >= 0) {
+    // 로버 쪽 epoch 구분에 쓰는 필드만 맞춘다 (위성/신호 마스크는 임의 값)
+    rtcm_loadgen_put_bits(p, 24, 30, epoch_ms);
+    rtcm_loadgen_put_bits(p, 54, 1, more ? 1U : 0U);
+  }
+
+  uint32_t crc = rtcm_crc24q_update(0, lg_buf, 3U + len);
+  lg_buf[3 + len] = (uint8_t)(crc >> 16);
+  lg_buf[4 + len] = (uint8_t)(crc >> 8);
+  lg_buf[5 + len] = (uint8_t)crc;
+
+  return 6U + len;
+}
+
+static bool rtcm_loadgen_type_valid(const rtcm_loadgen_type_t *t) {
+  uint16_t min = rtcm_msm_gnss(t->msg_type) >= 0 ? RTCM_LOADGEN_MSM_MIN_LEN
+                                                  : RTCM_LOADGEN_MIN_LEN;
+
+  return t->msg_type != 0 && t->msg_type <= 4095 && t->len_min >= min &&
+         t->len_min <= t->len_max && t->len_max <= RTCM_LOADGEN_MAX_LEN;
+}
+
+bool rtcm_loadgen_set(const rtcm_loadgen_cfg_t *cfg) {
+  if (cfg->cnt > RTCM_LOADGEN_TYPES_MAX || (cfg->period_ms != 0 && cfg->cnt == 0)) {
+    return false;
+  }
+  for (uint8_t i = 0; i < cfg->cnt; i++) {
+    if (!rtcm_loadgen_type_valid(&cfg->type[i])) {
+      return false;
+    }
+  }
+
+  taskENTER_CRITICAL();
+  lg_cfg = *cfg;
+  lg_restart = true;
+  memset(&lg_stats, 0, sizeof(lg_stats));
+  taskEXIT_CRITICAL();
+
+  LOG_INFO("RTCM load generator: period %lu ms, %d types", cfg->period_ms, cfg->cnt);
+  return true;
+}
+
+void rtcm_loadgen_get(rtcm_loadgen_cfg_t *cfg, rtcm_loadgen_stats_t *stats) {
+  taskENTER_CRITICAL();
+  if (cfg) {
+    *cfg = lg_cfg;
+  }
+  if (stats) {
+    *stats = lg_stats;
+  }
+  taskEXIT_CRITICAL();
+}
+
+bool rtcm_loadgen_active(void) {
+  return lg_cfg.period_ms != 0;
+}
+
+bool rtcm_loadgen_injecting(void) {
+  return lg_injecting;
+}
+
+TickType_t rtcm_loadgen_wait(void) {
+  if (!rtcm_loadgen_active()) {
+    return portMAX_DELAY;
+  }
+  if (lg_restart || lg_deferred) {
+    return 1; // 켠 직후, 또는 수신기 프레임이 끝나기를 기다리는 중
+  }
+
+  int32_t left = (int32_t)(lg_next - xTaskGetTickCount());
+  return left > 0 ? (TickType_t)left : 1;
+}
+
+void rtcm_loadgen_poll(gps_t *gps) {
+  rtcm_loadgen_cfg_t cfg;
+  bool restart;
+
+  taskENTER_CRITICAL();
+  cfg = lg_cfg;
+  restart = lg_restart;
+  lg_restart = false;
+  taskEXIT_CRITICAL();
+
+  TickType_t now = xTaskGetTickCount();
+  if (restart) {
+    lg_next = now;
+    lg_deferred = false;
+  }
+  if (cfg.period_ms == 0 || (int32_t)(now - lg_next) < 0) {
+    return;
+  }
+
+  // 수신기 프레임 중간에 끼우면 둘 다 깨지므로 파서가 쉬고 있을 때만
+  if (gps->protocol != GPS_PROTOCOL_NONE) {
+    if (!lg_deferred) {
+      taskENTER_CRITICAL();
+      lg_stats.deferred++;
+      taskEXIT_CRITICAL();
+    }
+    lg_deferred = true;
+    return;
+  }
+  lg_deferred = false;
+
+  int8_t last_msm = -1;
+  for (uint8_t i = 0; i < cfg.cnt; i++) {
+    if (rtcm_msm_gnss(cfg.type[i].msg_type) >= 0) {
+      last_msm = (int8_t)i;
+    }
+  }
+
+  uint32_t epoch_ms = (uint32_t)(now * portTICK_PERIOD_MS) & 0x3FFFFFFFU;
+  uint32_t bytes = 0;
+
+  lg_injecting = true;
+  for (uint8_t i = 0; i < cfg.cnt; i++) {
+    size_t n = rtcm_loadgen_build(&cfg.type[i], epoch_ms, (int8_t)i < last_msm);
+
+    // 수신 링 대신 생성 버퍼를 링으로 보고 파싱 (CRC 검사와 구독 콜백 그대로)
+    gps_parse_ring(gps, lg_buf, sizeof(lg_buf), 0, n);
+    bytes += n;
+  }
+  lg_injecting = false;
+
+  // 늦었으면 밀린 epoch 은 몰아서 넣지 않고 건너뛴다 (실제 수신기처럼)
+  TickType_t period = pdMS_TO_TICKS(cfg.period_ms);
+  uint32_t skipped = 0;
+  if (period == 0) {
+    period = 1;
+  }
+  lg_next += period;
+  if ((int32_t)(now - lg_next) >= 0) {
+    skipped = (now - lg_next) / period + 1;
+    lg_next += skipped * period;
+  }
+
+  taskENTER_CRITICAL();
+  lg_stats.epochs++;
+  lg_stats.frames += cfg.cnt;
+  lg_stats.bytes += bytes;
+  lg_stats.skipped += skipped;
+  taskEXIT_CRITICAL();
+}
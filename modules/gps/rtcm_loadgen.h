@@ -0,0 +1,77 @@
+#ifndef RTCM_LOADGEN_H
+#define RTCM_LOADGEN_H
+
+#include "gps.h"
+#include "FreeRTOS.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * 기준국 RTCM 부하 생성기 (LoRa/로버 경로 시험용)
+ *
+ * 설정한 타입 구성으로 CRC24Q 가 맞는 합성 RTCM3 프레임을 주기마다 만들어
+ * 기준국 수신기의 파서에 넣는다. 수신기에서 온 프레임과 같은 RTCM 이벤트
+ * 경로 (구독 -> rtcm_send_to_lora -> 스케줄러/분할) 를 지나므로 하늘 상태와
+ * 관계없이 LoRa 설정별 최대 보정 속도를 로버 통계 (lora_stats) 로 잴 수 있다.
+ *
+ * 켜져 있는 동안 수신기의 실제 RTCM 은 LoRa 로 보내지 않고, 합성 프레임은
+ * NTRIP 으로 올리지 않는다. 시험 모드라 저장하지 않으며 재부팅하면 꺼진다.
+ */
+
+/* 한 epoch 에 넣는 타입 수 */
+#define RTCM_LOADGEN_TYPES_MAX 8
+
+/* MSM 은 헤더 (169 bit) 가 들어가는 길이부터 */
+#define RTCM_LOADGEN_MSM_MIN_LEN 22
+#define RTCM_LOADGEN_MIN_LEN 2
+#define RTCM_LOADGEN_MAX_LEN 1023
+
+typedef struct {
+  uint16_t msg_type;
+  uint16_t len_min; /**< payload 길이 [byte], epoch 마다 [min, max] 에서 고름 */
+  uint16_t len_max;
+} rtcm_loadgen_type_t;
+
+typedef struct {
+  uint32_t period_ms; /**< epoch 간격, 0: 끔 */
+  uint8_t cnt;
+  rtcm_loadgen_type_t type[RTCM_LOADGEN_TYPES_MAX]; /**< epoch 안 순서 그대로 */
+} rtcm_loadgen_cfg_t;
+
+typedef struct {
+  uint32_t epochs;   /**< 넣은 epoch */
+  uint32_t frames;   /**< 넣은 프레임 */
+  uint32_t bytes;    /**< 넣은 byte (헤더, CRC 포함) */
+  uint32_t deferred; /**< 파서가 수신기 프레임 중간이라 미룬 횟수 */
+  uint32_t skipped;  /**< 늦어서 건너뛴 epoch */
+} rtcm_loadgen_stats_t;
+
+/**
+ * @brief 설정 변경 (다른 태스크, 다음 epoch 부터 적용)
+ *
+ * MSM 타입은 epoch 의 마지막 MSM 만 multiple message bit 가 0 이다.
+ * 통계는 새로 시작한다.
+ *
+ * @return true: 설정됨, false: 타입 수나 길이 범위가 맞지 않음
+ */
+bool rtcm_loadgen_set(const rtcm_loadgen_cfg_t *cfg);
+void rtcm_loadgen_get(rtcm_loadgen_cfg_t *cfg, rtcm_loadgen_stats_t *stats);
+bool rtcm_loadgen_active(void);
+
+/**
+ * @brief 지금 디스패치 중인 RTCM 프레임이 합성 프레임인지 (구독 콜백에서)
+ */
+bool rtcm_loadgen_injecting(void);
+
+/**
+ * @brief 다음 epoch 까지 남은 tick (GPS RX 태스크 대기 전, 꺼져 있으면 portMAX_DELAY)
+ */
+TickType_t rtcm_loadgen_wait(void);
+
+/**
+ * @brief 때가 된 epoch 를 파서에 넣음 (GPS RX 태스크, gps->mutex 잡은 상태)
+ */
+void rtcm_loadgen_poll(gps_t *gps);
+
+#endif
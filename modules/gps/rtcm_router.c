@@ -0,0 +1,1330 @@
+#include "rtcm_router.h"
+#include "FreeRTOS.h"
+#include "gps_port.h"
+#include "gps_time.h"
+#include "mem_section.h"
+#include "rtcm.h"
+#include "boot_timeline.h"
+#include "pm_trace.h"
+#include "semphr.h"
+#include "task.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifndef TAG
+#define TAG "RTCM_ROUTER"
+#endif
+
+#include "log.h"
+
+#define RTCM_PREAMBLE 0xD3
+#define RTCM_FRAME_OVERHEAD 6 /* header 3 + CRC 3 */
+#define RTCM_FRAME_MAX (RTCM_FRAME_OVERHEAD + 1023)
+
+#define RTCM_ROUTER_DEDUP_PROBE 4
+#define RTCM_ROUTER_LOCK_MS 50
+
+/* 송신 완료 대기 중인 프레임 기록, 표시 FIFO 보다 커야 재사용이 안전하다 */
+#define RTCM_ROUTER_PEND (2 * UART_TX_STREAM_MARKS)
+
+/* 기준국 정보 캐시: 1005/1006 ARP, 1033 안테나/수신기, 1230 GLONASS 바이어스 */
+#define RTCM_ROUTER_CACHE_TYPES 4
+#define RTCM_ROUTER_CACHE_FRAME 192 /* 1033 문자열이 모두 31 자여도 들어감 */
+#define RTCM_ROUTER_CACHE_AGE_MS 600000
+
+/**
+ * @brief 스트림 입력을 RTCM 프레임으로 자르는 버퍼 (소스마다 하나)
+ *
+ * 소스마다 입력 태스크가 하나라서 lock 없이 쓴다. DMA 와 무관하므로
+ * CCM 에 둔다.
+ */
+typedef struct {
+  uint8_t buf[RTCM_FRAME_MAX];
+  size_t pos;
+  size_t need;        /**< 프레임 전체 길이, 0 이면 헤더 대기 */
+  TickType_t rx_tick; /**< 프레임 첫 바이트 수신 시각 */
+} rtcm_framer_t;
+
+typedef struct {
+  TickType_t last_rx;
+  bool seen;
+  uint8_t cur_msm;  /**< 진행 중 epoch 의 관측 메시지 개수 */
+  uint8_t last_msm; /**< 직전 완료 epoch 의 관측 메시지 개수 */
+  uint8_t better;   /**< 활성 소스보다 앞선 연속 epoch 수 */
+  uint16_t station; /**< 마지막 관측 메시지의 기준국 ID (0xFFFF=없음) */
+  bool demoted;
+  TickType_t demote_until;
+  rtcm_router_stats_t stats;
+} rtcm_router_src_t;
+
+/**
+ * @brief 보낸 관측 메시지 (중복 제거 hash set 한 칸)
+ */
+typedef struct {
+  bool used;
+  uint8_t src;     /**< 먼저 보낸 소스 */
+  uint16_t type;
+  uint32_t epoch;
+  uint32_t crc;    /**< CRC24Q */
+  TickType_t tick; /**< 보낸 (라우팅한) 시각 */
+} rtcm_router_seen_t;
+
+typedef struct {
+  uint16_t len; /**< 0 이면 비어 있음 */
+  TickType_t tick;
+  uint8_t frame[RTCM_ROUTER_CACHE_FRAME];
+} rtcm_router_cache_t;
+
+/**
+ * @brief 기준국 ID 별 정보 (가까운 기준국 고르기)
+ */
+typedef struct {
+  bool used;
+  bool arp;            /**< ecef 유효 (1005/1006 받음) */
+  uint16_t id;
+  uint8_t srcs;        /**< 들은 소스 (bit: rtcm_src_t) */
+  float ecef[3];       /**< ARP [m] */
+  float dist_m;        /**< 로버까지 거리, 모르면 음수 */
+  TickType_t obs_tick; /**< 마지막 관측 메시지 */
+} rtcm_router_base_t;
+
+typedef struct {
+  rtcm_src_t src;
+  TickType_t rx_tick;
+  TickType_t done_tick; /**< 프레임 완성(라우팅) 시각 */
+} rtcm_router_pend_t;
+
+static struct {
+  SemaphoreHandle_t lock;
+  rtcm_src_t active;
+  TickType_t active_tick; /**< 활성 소스로 바뀐 시각 */
+  uint32_t targets;
+
+  /* 활성 소스에 대한 수신기 결과 (소스가 바뀌면 처음부터) */
+  bool eng_seen;
+  TickType_t eng_used_tick; /**< 마지막으로 쓴 메시지 결과 시각 */
+  uint16_t eng_bad;         /**< 그 뒤 안 쓴/CRC 실패 결과 수 */
+  bool inject;              /**< 활성 소스의 다음 프레임 전에 캐시를 보냄 */
+  volatile bool shed;       /**< 과부하: RTK 에 꼭 필요한 메시지만 보냄 */
+
+  rtcm_router_src_t src[RTCM_SRC_MAX];
+  rtcm_router_seen_t seen[RTCM_ROUTER_DEDUP_SLOTS];
+
+  /* REASM 은 라우터 태스크, UART/TOTAL 은 DMA ISR 에서 갱신 */
+  rtcm_lat_stat_t lat[RTCM_SRC_MAX][RTCM_LAT_STAGE_MAX];
+  rtcm_router_pend_t pend[RTCM_ROUTER_PEND];
+  uint32_t pend_next;
+  bool mark_cb_set;
+  rtcm_router_frame_cb_t frame_cb;
+
+  rtcm_router_base_t base[RTCM_ROUTER_BASES];
+  uint16_t pick; /**< 고른 기준국 ID (0xFFFF=없음, 거르지 않음) */
+  TickType_t pick_tick;
+} router = {
+    .active = RTCM_SRC_NONE,
+    .pick = 0xFFFF,
+    .targets = 1U << GPS_ID_BASE,
+    .src =
+        {
+            [RTCM_SRC_LORA] = {.station = 0xFFFF},
+            [RTCM_SRC_NTRIP] = {.station = 0xFFFF},
+            [RTCM_SRC_BLE] = {.station = 0xFFFF},
+        },
+};
+
+CCM_BSS static rtcm_framer_t framers[RTCM_SRC_MAX];
+CCM_BSS static rtcm_router_cache_t cache[RTCM_SRC_MAX][RTCM_ROUTER_CACHE_TYPES];
+
+static const uint16_t cache_types[RTCM_ROUTER_CACHE_TYPES] = {
+    1005, 1006, 1033, 1230,
+};
+
+static const char *const src_names[RTCM_SRC_MAX + 1] = {
+    [RTCM_SRC_LORA] = "LoRa",
+    [RTCM_SRC_NTRIP] = "NTRIP",
+    [RTCM_SRC_BLE] = "BLE",
+    [RTCM_SRC_NONE] = "none",
+};
+
+static inline uint16_t rtcm_frame_type(const uint8_t *frame) {
+  return ((uint16_t)frame[3] << 4) | (frame[4] >> 4);
+}
+
+static inline uint16_t rtcm_frame_station(const uint8_t *frame) {
+  return ((uint16_t)(frame[4] & 0x0F) << 8) | frame[5];
+}
+
+/**
+ * @brief epoch 단위 관측 메시지인지 (MSM, GPS 1001~1004)
+ *
+ * 둘 다 type 12, station 12, epoch 30 bit 다음에 multiple message(sync)
+ * bit 가 온다.
+ */
+static inline bool rtcm_type_is_obs(uint16_t type) {
+  if (type >= 1001 && type <= 1004) {
+    return true;
+  }
+  return type >= 1071 && type <= 1137 && (type % 10) >= 1 && (type % 10) <= 7;
+}
+
+/**
+ * @brief 관측 메시지 헤더의 epoch time (payload bit 24, 30 bit)
+ *
+ * 위성군마다 시간 기준이 다르지만 타입별로만 비교하므로 그대로 쓴다.
+ */
+static inline uint32_t rtcm_obs_epoch(const uint8_t *frame) {
+  uint32_t w = ((uint32_t)frame[6] << 24) | ((uint32_t)frame[7] << 16) |
+               ((uint32_t)frame[8] << 8) | frame[9];
+
+  return (w >> 2) & 0x3FFFFFFFU;
+}
+
+/**
+ * @brief multiple message bit (payload bit 54), 0 이면 epoch 마지막
+ */
+static inline bool rtcm_obs_more_follows(const uint8_t *frame) {
+  return (frame[9] & 0x02) != 0;
+}
+
+/**
+ * @brief 기준국 ID 가 헤더에 있는 메시지 (관측, ARP, 안테나, GLONASS 바이어스)
+ *
+ * 궤도력 (1019/1020/1042...) 과 u-blox 4072 는 기준국 ID 가 없어 거르지 않는다.
+ */
+static inline bool rtcm_type_has_station(uint16_t type) {
+  return rtcm_type_is_obs(type) || type == 1005 || type == 1006 || type == 1007 ||
+         type == 1008 || type == 1033 || type == 1230;
+}
+
+/**
+ * @brief payload bit pos 부터 38 bit 부호 있는 값 (1005/1006 ECEF, 0.1 mm)
+ */
+static int64_t rtcm_frame_s38(const uint8_t *frame, uint32_t pos) {
+  const uint8_t *p = &frame[3 + pos / 8];
+  uint64_t w = 0;
+
+  for (int i = 0; i < 6; i++) {
+    w = (w << 8) | p[i];
+  }
+  // 6 byte 창 (48 bit) 의 위쪽부터 pos % 8 bit 뒤
+  w = (w >> (10 - pos % 8)) & ((1ULL << 38) - 1);
+
+  return (int64_t)(w << 26) >> 26;
+}
+
+static const uint32_t lat_bucket_ms[RTCM_LAT_BUCKETS - 1] = {
+    10, 20, 50, 100, 200, 500, 1000,
+};
+
+static const char *const lat_stage_names[RTCM_LAT_STAGE_MAX] = {
+    [RTCM_LAT_REASM] = "reasm",
+    [RTCM_LAT_UART] = "uart",
+    [RTCM_LAT_TOTAL] = "total",
+    [RTCM_LAT_EPOCH] = "epoch",
+    [RTCM_LAT_LEAD] = "lead",
+};
+
+static void lat_record(rtcm_lat_stat_t *st, TickType_t ticks) {
+  uint32_t ms = (uint32_t)ticks * portTICK_PERIOD_MS;
+  int b = 0;
+
+  while (b < RTCM_LAT_BUCKETS - 1 && ms >= lat_bucket_ms[b]) {
+    b++;
+  }
+
+  if (st->count == 0 || ms < st->min_ms) {
+    st->min_ms = ms;
+  }
+  if (ms > st->max_ms) {
+    st->max_ms = ms;
+  }
+  st->count++;
+  st->sum_ms += ms;
+  st->hist[b]++;
+}
+
+/**
+ * @brief GPS UART 로 프레임이 다 나감 (DMA ISR)
+ */
+static void router_on_sent(uint32_t tag, void *ctx) {
+  (void)ctx;
+
+  const rtcm_router_pend_t *p = &router.pend[tag % RTCM_ROUTER_PEND];
+  TickType_t now = xTaskGetTickCountFromISR();
+
+  lat_record(&router.lat[p->src][RTCM_LAT_UART], now - p->done_tick);
+  lat_record(&router.lat[p->src][RTCM_LAT_TOTAL], now - p->rx_tick);
+}
+
+/**
+ * @brief 프레임 하나를 대상 GPS 들로 송신하고 지연 측정 등록 (lock 보유)
+ *
+ * 지연은 첫 번째 대상 기준으로만 잰다. 송신 링이 있으면 DMA 완료 때,
+ * 없으면 블로킹 송신이 끝난 시점에 기록한다.
+ */
+static void router_forward(rtcm_src_t src, const uint8_t *frame, size_t len,
+                           TickType_t rx_tick, TickType_t now) {
+  bool timed = false;
+
+  lat_record(&router.lat[src][RTCM_LAT_REASM], now - rx_tick);
+  boot_timeline_mark(BOOT_MARK_RTCM_FWD);
+
+  for (int i = 0; i < GPS_ID_MAX; i++) {
+    gps_id_t id = (gps_id_t)i;
+
+    if (!(router.targets & (1U << id))) {
+      continue;
+    }
+
+    if (timed) {
+      gps_send_corrections(id, frame, len);
+      continue;
+    }
+    timed = true;
+
+    if (!gps_port_has_stream(id)) {
+      gps_send_corrections(id, frame, len);
+
+      TickType_t sent = xTaskGetTickCount();
+      taskENTER_CRITICAL();
+      lat_record(&router.lat[src][RTCM_LAT_UART], sent - now);
+      lat_record(&router.lat[src][RTCM_LAT_TOTAL], sent - rx_tick);
+      taskEXIT_CRITICAL();
+      continue;
+    }
+
+    if (!router.mark_cb_set) {
+      gps_port_stream_set_mark_cb(id, router_on_sent, NULL);
+      router.mark_cb_set = true;
+    }
+
+    // ISR 가 바로 꺼내 볼 수 있으므로 표시 전에 기록을 채운다
+    uint32_t tag = router.pend_next;
+    rtcm_router_pend_t *p = &router.pend[tag % RTCM_ROUTER_PEND];
+    p->src = src;
+    p->rx_tick = rx_tick;
+    p->done_tick = now;
+
+    if (gps_send_corrections(id, frame, len) == len &&
+        gps_port_stream_mark(id, tag)) {
+      router.pend_next++;
+    }
+  }
+}
+
+static inline bool router_is_stale(const rtcm_router_src_t *s, TickType_t now) {
+  return !s->seen || (now - s->last_rx) > pdMS_TO_TICKS(RTCM_ROUTER_STALE_MS);
+}
+
+static inline bool router_is_demoted(const rtcm_router_src_t *s,
+                                     TickType_t now) {
+  return s->demoted && (int32_t)(now - s->demote_until) < 0;
+}
+
+static void router_switch(rtcm_src_t to, TickType_t now) {
+  LOG_INFO("보정 소스 전환 %s -> %s", src_names[router.active], src_names[to]);
+  pm_trace(PM_EVT_RTCM_SRC, to, router.active);
+
+  router.active = to;
+  router.active_tick = now;
+  router.eng_seen = false;
+  router.eng_bad = 0;
+  router.inject = true;
+  for (int i = 0; i < RTCM_SRC_MAX; i++) {
+    router.src[i].better = 0;
+  }
+}
+
+/**
+ * @brief 수신기가 활성 소스를 못 쓰고 있으면 강등하고 다른 소스로 (lock 보유)
+ *
+ * 살아 있고 강등되지 않은 소스 중 관측 메시지가 많은(같으면 우선순위가
+ * 높은) 소스로 바로 넘어간다. 없으면 활성 소스를 그대로 두고, 다른 소스의
+ * 프레임이 들어오는 대로 router_select 가 넘긴다.
+ */
+static void router_demote(const char *why, TickType_t now) {
+  rtcm_src_t act = router.active;
+  rtcm_src_t best = RTCM_SRC_NONE;
+
+  if (act == RTCM_SRC_NONE ||
+      (now - router.active_tick) < pdMS_TO_TICKS(RTCM_ROUTER_JUDGE_MS) ||
+      router_is_stale(&router.src[act], now)) {
+    return;
+  }
+
+  LOG_WARN("보정 소스 %s 강등 (%s)", src_names[act], why);
+
+  router.src[act].demoted = true;
+  router.src[act].demote_until = now + pdMS_TO_TICKS(RTCM_ROUTER_DEMOTE_MS);
+  router.src[act].stats.demoted++;
+  // 바로 다시 판단하지 않게 (대체 소스가 없을 때)
+  router.active_tick = now;
+  router.eng_seen = false;
+  router.eng_bad = 0;
+
+  for (rtcm_src_t i = 0; i < RTCM_SRC_MAX; i++) {
+    const rtcm_router_src_t *c = &router.src[i];
+
+    if (i == act || router_is_stale(c, now) || router_is_demoted(c, now)) {
+      continue;
+    }
+    if (best == RTCM_SRC_NONE || c->last_msm > router.src[best].last_msm) {
+      best = i;
+    }
+  }
+
+  if (best != RTCM_SRC_NONE) {
+    router_switch(best, now);
+  }
+}
+
+/**
+ * @brief 활성 소스 선택
+ *
+ * 활성 소스가 끊기거나 강등돼 있으면 프레임이 들어온 소스로 바로 넘어간다.
+ * 둘 다 살아 있으면 epoch 당 관측 메시지 개수가 더 많은(같으면 우선순위가
+ * 높은) 소스가 RTCM_ROUTER_SWITCH_EPOCHS 번 연속 앞설 때만 넘어간다.
+ */
+static void router_select(rtcm_src_t src, bool epoch_end, TickType_t now) {
+  rtcm_src_t act = router.active;
+  rtcm_router_src_t *s = &router.src[src];
+
+  if (act == src) {
+    return;
+  }
+
+  if (act == RTCM_SRC_NONE || router_is_stale(&router.src[act], now)) {
+    router_switch(src, now);
+    return;
+  }
+
+  // 수신기가 못 쓰던 소스는 강등 기간 동안 끊긴 소스 대신으로만 쓴다
+  if (router_is_demoted(s, now)) {
+    return;
+  }
+  if (router_is_demoted(&router.src[act], now)) {
+    router_switch(src, now);
+    return;
+  }
+
+  if (!epoch_end) {
+    return;
+  }
+
+  uint8_t act_msm = router.src[act].last_msm;
+
+  if (s->last_msm > act_msm || (s->last_msm == act_msm && src < act)) {
+    if (++s->better >= RTCM_ROUTER_SWITCH_EPOCHS) {
+      router_switch(src, now);
+    }
+  } else {
+    s->better = 0;
+  }
+}
+
+/**
+ * @brief 같은 타입, 같은 epoch 의 관측 메시지를 이미 보냈는지 (아니면 기록)
+ *
+ * 칸은 (타입, epoch) 로 찾고 CRC 로 같은 내용인지 본다. 내용이 달라도 같은
+ * epoch 를 수신기에 두 번 주지 않도록 먼저 온 것만 보낸다. 찾는 칸이 다
+ * 차 있으면 가장 오래된 칸에 쓴다.
+ */
+static bool router_is_dup(rtcm_src_t src, uint16_t type, uint32_t epoch,
+                          uint32_t crc, TickType_t now) {
+  // epoch 는 보통 1000 ms 배수라 곱의 위쪽 bit 를 쓴다
+  uint32_t h = ((epoch * 2654435761U) >> 24) ^ type;
+  rtcm_router_seen_t *slot = NULL;
+  bool slot_live = false;
+
+  for (int i = 0; i < RTCM_ROUTER_DEDUP_PROBE; i++) {
+    rtcm_router_seen_t *e = &router.seen[(h + i) & (RTCM_ROUTER_DEDUP_SLOTS - 1)];
+    bool live = e->used && (now - e->tick) <= pdMS_TO_TICKS(RTCM_ROUTER_DEDUP_MS);
+
+    if (live && e->type == type && e->epoch == epoch) {
+      if (e->crc != crc) {
+        router.src[src].stats.dup_diff++;
+      }
+      if (e->src != src) {
+        router.src[e->src].stats.won++;
+        lat_record(&router.lat[e->src][RTCM_LAT_LEAD], now - e->tick);
+      }
+      return true;
+    }
+    if (!live) {
+      if (!slot || slot_live) {
+        slot = e;
+        slot_live = false;
+      }
+    } else if (!slot || (slot_live && (now - e->tick) > (now - slot->tick))) {
+      slot = e;
+      slot_live = true;
+    }
+  }
+
+  slot->used = true;
+  slot->src = (uint8_t)src;
+  slot->type = type;
+  slot->epoch = epoch;
+  slot->crc = crc;
+  slot->tick = now;
+
+  return false;
+}
+
+/**
+ * @brief 기준국 정보 메시지면 소스별 캐시에 보관 (lock 보유)
+ */
+static void router_cache_store(rtcm_src_t src, uint16_t type,
+                               const uint8_t *frame, size_t len,
+                               TickType_t now) {
+  if (len > RTCM_ROUTER_CACHE_FRAME) {
+    return;
+  }
+
+  for (int i = 0; i < RTCM_ROUTER_CACHE_TYPES; i++) {
+    if (cache_types[i] == type) {
+      rtcm_router_cache_t *c = &cache[src][i];
+
+      memcpy(c->frame, frame, len);
+      c->len = (uint16_t)len;
+      c->tick = now;
+      return;
+    }
+  }
+}
+
+/**
+ * @brief 소스가 (다시) 활성이 될 때 캐시한 기준국 정보를 먼저 보냄 (lock 보유)
+ *
+ * 수신기는 ARP 와 안테나/바이어스 정보가 있어야 MSM 으로 RTK 를 푸는데
+ * 기준국은 이것을 보통 10 초쯤에 한 번 보낸다. 전환 뒤 첫 프레임 앞에 넣어
+ * 그만큼 재수렴을 앞당긴다. 지금 프레임과 같은 타입, MSM 기준국 ID 가 다른
+ * 것, RTCM_ROUTER_CACHE_AGE_MS 보다 오래된 것은 보내지 않는다.
+ */
+static void router_cache_inject(rtcm_src_t src, uint16_t skip_type,
+                                TickType_t now) {
+  rtcm_router_src_t *s = &router.src[src];
+
+  for (int i = 0; i < RTCM_ROUTER_CACHE_TYPES; i++) {
+    const rtcm_router_cache_t *c = &cache[src][i];
+
+    if (c->len == 0 || cache_types[i] == skip_type ||
+        (now - c->tick) > pdMS_TO_TICKS(RTCM_ROUTER_CACHE_AGE_MS) ||
+        (s->station != 0xFFFF && rtcm_frame_station(c->frame) != s->station)) {
+      continue;
+    }
+
+    for (int id = 0; id < GPS_ID_MAX; id++) {
+      if (router.targets & (1U << id)) {
+        gps_send_corrections((gps_id_t)id, c->frame, c->len);
+      }
+    }
+    s->stats.cached++;
+  }
+}
+
+/**
+ * @brief 과부하 때도 보내는 메시지 (관측, ARP, GLONASS 바이어스, u-blox 4072)
+ *
+ * 궤도력 (1019/1020/1042/1046...) 과 안테나 설명 (1033) 은 수신기가 방송
+ * 궤도력/기본값으로 버틸 수 있어 잠깐 빼도 된다.
+ */
+static bool router_type_essential(uint16_t type) {
+  return rtcm_type_is_obs(type) || type == 1005 || type == 1006 || type == 1230 ||
+         type == 4072;
+}
+
+/**
+ * @brief 기준국 ID 의 자리 (없으면 비었거나 가장 오래 안 들린 자리를 씀)
+ */
+static rtcm_router_base_t *router_base_get(uint16_t id) {
+  rtcm_router_base_t *old = NULL;
+
+  for (int i = 0; i < RTCM_ROUTER_BASES; i++) {
+    rtcm_router_base_t *b = &router.base[i];
+
+    if (b->used && b->id == id) {
+      return b;
+    }
+    if (!old || (old->used && (!b->used || (int32_t)(b->obs_tick - old->obs_tick) < 0))) {
+      old = b;
+    }
+  }
+
+  memset(old, 0, sizeof(*old));
+  old->used = true;
+  old->id = id;
+  old->dist_m = -1.0f;
+
+  return old;
+}
+
+/**
+ * @brief 기준국 ID 가 있는 프레임마다 (lock 보유)
+ */
+static void router_base_note(rtcm_src_t src, uint16_t type, const uint8_t *frame,
+                             size_t len, bool obs, TickType_t now) {
+  rtcm_router_base_t *b = router_base_get(rtcm_frame_station(frame));
+
+  b->srcs |= 1U << src;
+  if (obs) {
+    b->obs_tick = now;
+  }
+  // 1005: type 12, station 12, ITRF 6, 표시 4, X 38, 2, Y 38, 2, Z 38
+  if ((type == 1005 || type == 1006) && len >= RTCM_FRAME_OVERHEAD + 19) {
+    b->ecef[0] = (float)rtcm_frame_s38(frame, 34) * 1e-4f;
+    b->ecef[1] = (float)rtcm_frame_s38(frame, 74) * 1e-4f;
+    b->ecef[2] = (float)rtcm_frame_s38(frame, 114) * 1e-4f;
+    b->arp = true;
+  }
+}
+
+static inline bool router_base_alive(const rtcm_router_base_t *b, TickType_t now) {
+  return b->used && b->obs_tick != 0 &&
+         (now - b->obs_tick) <= pdMS_TO_TICKS(RTCM_ROUTER_STALE_MS);
+}
+
+/**
+ * @brief 보정 대상 수신기의 위치를 ECEF 로 (단정밀도, 기준선 길이용)
+ */
+static bool router_rover_ecef(float out[3]) {
+  gps_nav_data_t nav;
+  gps_t *gps = NULL;
+
+  for (int id = 0; id < GPS_ID_MAX && !gps; id++) {
+    if (router.targets & (1U << id)) {
+      gps = gps_get_instance_handle((gps_id_t)id);
+    }
+  }
+  if (!gps || !gps_nav_read(gps, &nav) || nav.fix == GPS_FIX_INVALID) {
+    return false;
+  }
+
+  // WGS84
+  const float a = 6378137.0f, e2 = 6.69437999e-3f;
+  float lat = (float)nav.llh.lat * (1e-9f * (float)M_PI / 180.0f);
+  float lon = (float)nav.llh.lon * (1e-9f * (float)M_PI / 180.0f);
+  float h = (float)nav.llh.ellipsoid_alt * 1e-4f;
+  float sl = sinf(lat), cl = cosf(lat);
+  float n = a / sqrtf(1.0f - e2 * sl * sl);
+
+  out[0] = (n + h) * cl * cosf(lon);
+  out[1] = (n + h) * cl * sinf(lon);
+  out[2] = (n * (1.0f - e2) + h) * sl;
+
+  return true;
+}
+
+/**
+ * @brief 거리를 다시 재고 기준국을 고름 (lock 보유)
+ *
+ * 로버 위치나 ARP 를 아직 모르면 거리 없이 살아 있는 기준국 하나를 골라
+ * 기준국이 섞이지 않게 한다. 살아 있는 기준국이 없으면 거르지 않는다.
+ */
+static void router_base_pick(TickType_t now) {
+  rtcm_router_base_t *cur = NULL, *best = NULL, *any = NULL;
+  float rov[3];
+  bool pos = router_rover_ecef(rov);
+  uint16_t pick = router.pick;
+
+  for (int i = 0; i < RTCM_ROUTER_BASES; i++) {
+    rtcm_router_base_t *b = &router.base[i];
+
+    if (pos && b->used && b->arp) {
+      float dx = b->ecef[0] - rov[0], dy = b->ecef[1] - rov[1], dz = b->ecef[2] - rov[2];
+
+      b->dist_m = sqrtf(dx * dx + dy * dy + dz * dz);
+    }
+    if (!router_base_alive(b, now)) {
+      continue;
+    }
+    if (b->id == router.pick) {
+      cur = b;
+    }
+    if (!any) {
+      any = b;
+    }
+    if (b->dist_m >= 0.0f && (!best || b->dist_m < best->dist_m)) {
+      best = b;
+    }
+  }
+
+  if (!cur) {
+    pick = best ? best->id : any ? any->id : 0xFFFF;
+  } else if (best && best != cur &&
+             (cur->dist_m < 0.0f || best->dist_m + RTCM_ROUTER_BASE_HYST_M < cur->dist_m)) {
+    pick = best->id;
+  }
+
+  if (pick != router.pick) {
+    const rtcm_router_base_t *p = best && pick == best->id ? best : NULL;
+    uint32_t dist = p ? (uint32_t)p->dist_m : 0;
+
+    LOG_INFO("기준국 %u -> %u (%lu m)", router.pick, pick, dist);
+    pm_trace(PM_EVT_RTCM_BASE, pick, dist);
+    router.pick = pick;
+    // 다른 기준국의 같은 epoch 가 중복으로 버려지지 않게
+    memset(router.seen, 0, sizeof(router.seen));
+  }
+}
+
+#define RTCM_DAY_MS 86400000U
+#define RTCM_WEEK_MS 604800000U
+
+/**
+ * @brief 관측 메시지 epoch 가 로버 GNSS 시각보다 얼마나 앞인지 [ms]
+ *
+ * GPS/Galileo/QZSS/SBAS 는 주 안 ms, BeiDou 는 BDT (GPST - 14 s), GLONASS 는
+ * 요일 3 bit + 하루 안 ms (UTC(SU) = UTC + 3 h) 라 하루 안에서 비교한다.
+ *
+ * @return false: 로버 시각을 모름, 또는 epoch 가 1 초 넘게 미래 (시각이 안 맞음)
+ */
+static bool router_obs_age(uint16_t type, uint32_t epoch, uint32_t *age_ms) {
+  uint32_t tow = 0, obs, period = RTCM_WEEK_MS;
+  bool known = false;
+
+  for (int i = 0; i < GPS_ID_MAX && !known; i++) {
+    known = (router.targets & (1U << i)) && gps_time_now_tow((gps_id_t)i, &tow);
+  }
+  if (!known) {
+    return false;
+  }
+
+  if (type >= 1081 && type <= 1087) {
+    period = RTCM_DAY_MS;
+    obs = ((epoch & 0x7FFFFFFU) + RTCM_DAY_MS - 3U * 3600000U + RTCM_ROUTER_LEAP_S * 1000U) %
+          RTCM_DAY_MS;
+    tow %= RTCM_DAY_MS;
+  } else if (type >= 1121 && type <= 1127) {
+    obs = (epoch + 14000U) % RTCM_WEEK_MS;
+  } else {
+    obs = epoch % RTCM_WEEK_MS;
+  }
+
+  uint32_t d = (tow + period - obs) % period;
+  if (d > period / 2) {
+    if (period - d > 1000) {
+      return false;
+    }
+    d = 0; // 로버 시각 추정 오차
+  }
+
+  *age_ms = d;
+  return true;
+}
+
+static void router_route(rtcm_src_t src, const uint8_t *frame, size_t len,
+                         TickType_t rx_tick) {
+  uint16_t type = rtcm_frame_type(frame);
+  bool obs = rtcm_type_is_obs(type) && len >= 10 + 3;
+  bool epoch_end = false;
+  rtcm_router_frame_cb_t frame_cb = router.frame_cb;
+
+  if (frame_cb) {
+    frame_cb(src, type, len);
+  }
+
+  if (!router.lock ||
+      xSemaphoreTake(router.lock, pdMS_TO_TICKS(RTCM_ROUTER_LOCK_MS)) !=
+          pdTRUE) {
+    return;
+  }
+
+  TickType_t now = xTaskGetTickCount();
+  rtcm_router_src_t *s = &router.src[src];
+  bool has_station = rtcm_type_has_station(type) && len >= RTCM_FRAME_OVERHEAD + 3;
+
+  if (has_station) {
+    router_base_note(src, type, frame, len, obs, now);
+  }
+  if ((now - router.pick_tick) >= pdMS_TO_TICKS(RTCM_ROUTER_BASE_EVAL_MS)) {
+    router.pick_tick = now;
+    router_base_pick(now);
+  }
+  // 고르지 않은 기준국: 소스 선택에도 넣지 않아 그 기준국만 나르는 소스는
+  // 끊긴 것으로 보이고, 활성 소스면 epoch 가 빈 것으로 봐서 넘어가게 한다
+  if (has_station && router.pick != 0xFFFF && rtcm_frame_station(frame) != router.pick) {
+    s->stats.other++;
+    if (obs && s->station != router.pick) {
+      s->last_msm = 0;
+      s->cur_msm = 0;
+    }
+    xSemaphoreGive(router.lock);
+    return;
+  }
+
+  uint32_t age_ms;
+  if (obs && router_obs_age(type, rtcm_obs_epoch(frame), &age_ms)) {
+    lat_record(&router.lat[src][RTCM_LAT_EPOCH], pdMS_TO_TICKS(age_ms));
+    if (age_ms > RTCM_ROUTER_OBS_AGE_MS) {
+      s->stats.stale++;
+      xSemaphoreGive(router.lock);
+      return;
+    }
+  }
+
+  // 끊겼던 활성 소스가 다시 들어와도 전환과 같이 캐시를 먼저 보낸다
+  if (src == router.active && router_is_stale(s, now)) {
+    router.inject = true;
+  }
+
+  s->last_rx = now;
+  s->seen = true;
+  s->stats.frames++;
+  router_cache_store(src, type, frame, len, now);
+
+  if (obs) {
+    s->station = rtcm_frame_station(frame);
+    s->cur_msm++;
+    if (!rtcm_obs_more_follows(frame)) {
+      s->last_msm = s->cur_msm;
+      s->cur_msm = 0;
+      epoch_end = true;
+    }
+  }
+
+  router_select(src, epoch_end, now);
+
+  // 같은 기준국을 다른 경로로도 받고 있으면 관측 메시지는 먼저 온 사본을
+  // 보낸다 (합쳐서 빈 곳도 채움). 기준국이 다르면 섞이면 안 되므로 활성
+  // 소스만 보낸다.
+  bool fwd = src == router.active ||
+             (obs && s->station == router.src[router.active].station);
+
+  if (src == router.active && router.inject) {
+    router.inject = false;
+    router_cache_inject(src, type, now);
+  }
+
+  if (fwd) {
+    uint32_t crc = ((uint32_t)frame[len - 3] << 16) |
+                   ((uint32_t)frame[len - 2] << 8) | frame[len - 1];
+
+    if (obs && router_is_dup(src, type, rtcm_obs_epoch(frame), crc, now)) {
+      s->stats.dup++;
+    } else if (router.shed && !router_type_essential(type)) {
+      s->stats.shed++;
+    } else {
+      router_forward(src, frame, len, rx_tick, now);
+      s->stats.forwarded++;
+    }
+  }
+
+  xSemaphoreGive(router.lock);
+}
+
+/**
+ * @brief buf[from..pos) 에서 다음 preamble 을 찾아 앞으로 당긴다
+ */
+static void framer_shift(rtcm_framer_t *f, size_t from) {
+  const uint8_t *p = NULL;
+
+  if (from < f->pos) {
+    p = memchr(&f->buf[from], RTCM_PREAMBLE, f->pos - from);
+  }
+
+  if (p) {
+    size_t off = (size_t)(p - f->buf);
+    memmove(f->buf, p, f->pos - off);
+    f->pos -= off;
+  } else {
+    f->pos = 0;
+  }
+  f->need = 0;
+}
+
+/**
+ * @brief 라우터 초기화 (스케줄러 시작 후, 입력 태스크 생성 전)
+ *
+ * @return true 성공
+ */
+bool rtcm_router_init(void) {
+  if (!router.lock) {
+    router.lock = xSemaphoreCreateMutex();
+  }
+  if (!router.lock) {
+    LOG_ERR("RTCM router mutex create failed");
+    return false;
+  }
+
+  return true;
+}
+
+/**
+ * @brief 프레임 관찰 콜백 등록 (NULL 이면 해제)
+ *
+ * @param[in] cb
+ */
+void rtcm_router_set_frame_cb(rtcm_router_frame_cb_t cb) {
+  router.frame_cb = cb;
+}
+
+/**
+ * @brief 바이트 스트림 입력 (NTRIP, BLE 등)
+ *
+ * 프레임 단위로 잘라 CRC 를 확인한 뒤 라우팅한다. RTCM 이 아닌 바이트는
+ * 버린다. 프레임이 data 안에 통째로 있으면 복사 없이 data 를 그대로 보내고,
+ * 호출 사이에 걸친 프레임만 framer 버퍼에 모은다. 소스마다 한 태스크에서만 불러야 한다. 호출 시각을 프레임 수신
+ * 시각으로 쓰므로 데이터를 받은 직후에 부른다.
+ *
+ * @param[in] src
+ * @param[in] data
+ * @param[in] len
+ */
+void rtcm_router_input(rtcm_src_t src, const uint8_t *data, size_t len) {
+  if (src >= RTCM_SRC_MAX || !data) {
+    return;
+  }
+
+  rtcm_framer_t *f = &framers[src];
+  TickType_t now = xTaskGetTickCount();
+
+  for (;;) {
+    if (f->pos == 0) {
+      const uint8_t *p = memchr(data, RTCM_PREAMBLE, len);
+      if (!p) {
+        return;
+      }
+      len -= (size_t)(p - data);
+      data = p;
+      f->rx_tick = now;
+
+      // 프레임이 입력 안에 통째로 있으면 버퍼에 복사하지 않고 그 자리에서 검증
+      if (len >= 3 && !(data[1] & 0xFC)) {
+        size_t flen = RTCM_FRAME_OVERHEAD + (((data[1] & 0x03) << 8) | data[2]);
+
+        if (len >= flen) {
+          uint32_t crc = ((uint32_t)data[flen - 3] << 16) |
+                         ((uint32_t)data[flen - 2] << 8) | data[flen - 1];
+
+          if (rtcm_crc24q_update(0, data, flen - 3) == crc) {
+            router_route(src, data, flen, now);
+            data += flen;
+            len -= flen;
+          } else {
+            router.src[src].stats.crc_err++;
+            data++;
+            len--;
+          }
+          continue;
+        }
+      }
+    }
+
+    size_t want = f->need ? f->need : 3;
+
+    if (f->pos < want) {
+      size_t n = want - f->pos;
+
+      if (n > len) {
+        n = len;
+      }
+      memcpy(&f->buf[f->pos], data, n);
+      f->pos += n;
+      data += n;
+      len -= n;
+
+      if (f->pos < want) {
+        return;
+      }
+    }
+
+    if (!f->need) {
+      // reserved 6 bit 가 0 이 아니면 preamble 이 아니었던 것
+      if (f->buf[1] & 0xFC) {
+        framer_shift(f, 1);
+        continue;
+      }
+      f->need = RTCM_FRAME_OVERHEAD + (((f->buf[1] & 0x03) << 8) | f->buf[2]);
+      continue;
+    }
+
+    size_t flen = f->need;
+    uint32_t crc = ((uint32_t)f->buf[flen - 3] << 16) |
+                   ((uint32_t)f->buf[flen - 2] << 8) | f->buf[flen - 1];
+
+    if (rtcm_crc24q_update(0, f->buf, flen - 3) == crc) {
+      router_route(src, f->buf, flen, f->rx_tick);
+      framer_shift(f, flen);
+    } else {
+      router.src[src].stats.crc_err++;
+      framer_shift(f, 1);
+    }
+  }
+}
+
+/**
+ * @brief 이미 CRC 검증된 프레임 하나 입력 (LoRa 재조립 결과 등)
+ *
+ * @param[in] src
+ * @param[in] frame 0xD3 부터 CRC 까지
+ * @param[in] len
+ * @param[in] rx_tick 프레임 첫 바이트를 받은 시각
+ */
+void rtcm_router_input_frame(rtcm_src_t src, const uint8_t *frame, size_t len,
+                             TickType_t rx_tick) {
+  if (src >= RTCM_SRC_MAX || !frame || len < RTCM_FRAME_OVERHEAD + 2 ||
+      frame[0] != RTCM_PREAMBLE) {
+    return;
+  }
+
+  router_route(src, frame, len, rx_tick);
+}
+
+/**
+ * @brief 보정 데이터를 받을 GPS 지정
+ *
+ * @param[in] gps_mask (1 << gps_id_t) 의 OR
+ */
+void rtcm_router_set_targets(uint32_t gps_mask) {
+  router.targets = gps_mask & ((1U << GPS_ID_MAX) - 1);
+}
+
+/**
+ * @brief 과부하 때 선택 메시지 (궤도력 등) 를 GPS 로 보내지 않음
+ *
+ * 캐시와 소스 판단은 그대로 한다.
+ */
+void rtcm_router_set_shed(bool on) { router.shed = on; }
+
+/**
+ * @brief 현재 GPS 로 보내고 있는 소스
+ *
+ * @return rtcm_src_t 활성 소스가 끊겼으면 RTCM_SRC_NONE
+ */
+rtcm_src_t rtcm_router_get_active(void) {
+  rtcm_src_t act = router.active;
+
+  if (act != RTCM_SRC_NONE &&
+      router_is_stale(&router.src[act], xTaskGetTickCount())) {
+    return RTCM_SRC_NONE;
+  }
+
+  return act;
+}
+
+/**
+ * @brief 소스별 통계 읽기
+ *
+ * @param[in] src
+ * @param[out] out
+ * @return true 성공
+ */
+bool rtcm_router_get_stats(rtcm_src_t src, rtcm_router_stats_t *out) {
+  if (src >= RTCM_SRC_MAX || !out || !router.lock) {
+    return false;
+  }
+
+  if (xSemaphoreTake(router.lock, pdMS_TO_TICKS(RTCM_ROUTER_LOCK_MS)) !=
+      pdTRUE) {
+    return false;
+  }
+
+  const rtcm_router_src_t *s = &router.src[src];
+
+  *out = s->stats;
+  out->epoch_msm = s->last_msm;
+  out->age_ms = s->seen ? (uint32_t)((xTaskGetTickCount() - s->last_rx) *
+                                     portTICK_PERIOD_MS)
+                        : UINT32_MAX;
+
+  xSemaphoreGive(router.lock);
+
+  return true;
+}
+
+/**
+ * @brief 구간별 지연 통계 읽기
+ *
+ * @param[in] src
+ * @param[in] stage
+ * @param[out] out
+ * @return true 성공
+ */
+bool rtcm_router_get_latency(rtcm_src_t src, rtcm_lat_stage_t stage,
+                             rtcm_lat_stat_t *out) {
+  if (src >= RTCM_SRC_MAX || stage >= RTCM_LAT_STAGE_MAX || !out) {
+    return false;
+  }
+
+  taskENTER_CRITICAL();
+  *out = router.lat[src][stage];
+  taskEXIT_CRITICAL();
+
+  return true;
+}
+
+void rtcm_router_reset_latency(void) {
+  taskENTER_CRITICAL();
+  memset(router.lat, 0, sizeof(router.lat));
+  taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief 수신기의 보정 메시지 처리 결과를 활성 소스 통계에 더함
+ *
+ * 수신기는 어느 경로로 온 메시지인지 모르므로 라우터가 보내는 GPS 의 결과만
+ * 받고, 기준국이 활성 소스와 다르면 (heading rover 가 UART2 로 받는 moving
+ * base 보정 등) 세지 않는다. 4072 는 moving base 전용이라 뺀다.
+ * RTCM_ROUTER_REJECT_MS 동안 쓴 메시지가 없으면 활성 소스를 강등한다.
+ *
+ * @param[in] id 결과를 보낸 GPS
+ * @param[in] type RTCM 메시지 타입
+ * @param[in] station 기준국 ID (없는 메시지는 0xFFFF)
+ * @param[in] result
+ */
+void rtcm_router_engine_feedback(gps_id_t id, uint16_t type, uint16_t station,
+                                 rtcm_engine_result_t result) {
+  if (id >= GPS_ID_MAX || !(router.targets & (1U << id)) || type == 4072 ||
+      result == RTCM_ENGINE_UNKNOWN || !router.lock) {
+    return;
+  }
+
+  if (xSemaphoreTake(router.lock, pdMS_TO_TICKS(RTCM_ROUTER_LOCK_MS)) !=
+      pdTRUE) {
+    return;
+  }
+
+  rtcm_src_t act = router.active;
+
+  if (act != RTCM_SRC_NONE &&
+      (station == 0xFFFF || station == router.src[act].station)) {
+    rtcm_router_stats_t *st = &router.src[act].stats;
+
+    TickType_t now = xTaskGetTickCount();
+
+    if (!router.eng_seen) {
+      router.eng_seen = true;
+      router.eng_used_tick = now;
+    }
+
+    if (result == RTCM_ENGINE_USED) {
+      st->eng_used++;
+      router.eng_used_tick = now;
+      router.eng_bad = 0;
+    } else {
+      if (result == RTCM_ENGINE_UNUSED) {
+        st->eng_unused++;
+      } else {
+        st->eng_crc++;
+      }
+      if (router.eng_bad < UINT16_MAX) {
+        router.eng_bad++;
+      }
+    }
+
+    if (router.eng_bad >= RTCM_ROUTER_REJECT_MIN &&
+        (now - router.eng_used_tick) > pdMS_TO_TICKS(RTCM_ROUTER_REJECT_MS)) {
+      router_demote(result == RTCM_ENGINE_CRC_ERR ? "수신기 CRC 실패"
+                                                  : "수신기가 안 씀",
+                    now);
+    }
+  }
+
+  xSemaphoreGive(router.lock);
+}
+
+/**
+ * @brief 항법 해의 보정 나이 (UM982 BESTNAV diff_age, F9P NAV-PVT flags3)
+ *
+ * 활성 소스 프레임은 들어오는데 보정 나이가 RTCM_ROUTER_DIFF_AGE_MS 를
+ * 넘으면 수신기가 그 보정을 못 쓰고 있는 것이므로 강등한다.
+ *
+ * @param[in] id 해를 낸 GPS
+ * @param[in] age_ms 보정 나이, 단독 측위면 UINT32_MAX
+ */
+void rtcm_router_diff_age(gps_id_t id, uint32_t age_ms) {
+  // 항법 해마다 불리므로 정상이면 lock 없이 끝낸다
+  if (age_ms <= RTCM_ROUTER_DIFF_AGE_MS || id >= GPS_ID_MAX ||
+      !(router.targets & (1U << id)) || router.active == RTCM_SRC_NONE ||
+      !router.lock) {
+    return;
+  }
+
+  if (xSemaphoreTake(router.lock, pdMS_TO_TICKS(RTCM_ROUTER_LOCK_MS)) !=
+      pdTRUE) {
+    return;
+  }
+
+  router_demote(age_ms == UINT32_MAX ? "보정 안 씀" : "보정 나이 초과",
+                xTaskGetTickCount());
+
+  xSemaphoreGive(router.lock);
+}
+
+/**
+ * @brief 수신기 처리 결과 응답 문자열 (결과가 있는 소스마다 한 줄)
+ *
+ * +CENG,<소스>,fwd=<보낸 프레임>,used=<n>,unused=<n>,crc=<n>,demote=<n>,
+ *   cache=<전환 때 캐시에서 보낸 기준국 메시지>
+ *
+ * @param[out] buf
+ * @param[in] size
+ * @return size_t 문자열 길이 (0 이면 버퍼 부족)
+ */
+size_t rtcm_router_format_engine(char *buf, size_t size) {
+  size_t pos = 0;
+  int n;
+
+  for (int i = 0; i < RTCM_SRC_MAX; i++) {
+    rtcm_router_stats_t st;
+
+    if (!rtcm_router_get_stats((rtcm_src_t)i, &st) ||
+        st.eng_used + st.eng_unused + st.eng_crc + st.demoted == 0) {
+      continue;
+    }
+
+    n = snprintf(&buf[pos], size - pos,
+                 "+CENG,%s,fwd=%lu,used=%lu,unused=%lu,crc=%lu,demote=%lu,"
+                 "cache=%lu\n\r",
+                 src_names[i], st.forwarded, st.eng_used, st.eng_unused,
+                 st.eng_crc, st.demoted, st.cached);
+    if (n < 0 || (size_t)n >= size - pos) {
+      return 0;
+    }
+    pos += n;
+  }
+
+  if (pos == 0) {
+    n = snprintf(buf, size, "+CENG,none\n\r");
+    if (n < 0 || (size_t)n >= size) {
+      return 0;
+    }
+    pos = n;
+  }
+
+  return pos;
+}
+
+/**
+ * @brief 지연 통계 응답 문자열 (소스마다 한 줄)
+ *
+ * +CLAT,<소스>,n=<개수>,reasm=min/avg/max,uart=...,total=...,epoch=...,lead=...,hist=...,
+ *   stale=<오래돼 버린 관측 메시지>,won=<먼저 와서 다른 경로 사본을 버린 수>,dup=<늦게 와서 버린 수>
+ * 값은 ms, hist 는 total 기준 RTCM_LAT_BUCKETS 칸.
+ *
+ * @param[out] buf
+ * @param[in] size
+ * @return size_t 문자열 길이 (0 이면 버퍼 부족)
+ */
+size_t rtcm_router_format_latency(char *buf, size_t size) {
+  size_t pos = 0;
+  int n;
+
+  for (int i = 0; i < RTCM_SRC_MAX; i++) {
+    rtcm_lat_stat_t st[RTCM_LAT_STAGE_MAX];
+
+    for (int k = 0; k < RTCM_LAT_STAGE_MAX; k++) {
+      rtcm_router_get_latency((rtcm_src_t)i, (rtcm_lat_stage_t)k, &st[k]);
+    }
+    // 모두 오래돼 버린 소스도 보이게
+    if (st[RTCM_LAT_TOTAL].count == 0 && st[RTCM_LAT_EPOCH].count == 0) {
+      continue;
+    }
+
+    n = snprintf(&buf[pos], size - pos, "+CLAT,%s,n=%lu", src_names[i],
+                 st[RTCM_LAT_TOTAL].count);
+    if (n < 0 || (size_t)n >= size - pos) {
+      return 0;
+    }
+    pos += n;
+
+    for (int k = 0; k < RTCM_LAT_STAGE_MAX; k++) {
+      const rtcm_lat_stat_t *t = &st[k];
+
+      n = snprintf(&buf[pos], size - pos, ",%s=%lu/%lu/%lu",
+                   lat_stage_names[k], t->min_ms,
+                   t->count ? t->sum_ms / t->count : 0, t->max_ms);
+      if (n < 0 || (size_t)n >= size - pos) {
+        return 0;
+      }
+      pos += n;
+    }
+
+    for (int b = 0; b < RTCM_LAT_BUCKETS; b++) {
+      n = snprintf(&buf[pos], size - pos, "%s%lu", b ? "/" : ",hist=",
+                   st[RTCM_LAT_TOTAL].hist[b]);
+      if (n < 0 || (size_t)n >= size - pos) {
+        return 0;
+      }
+      pos += n;
+    }
+
+    n = snprintf(&buf[pos], size - pos, ",stale=%lu,won=%lu,dup=%lu\n\r",
+                 router.src[i].stats.stale, router.src[i].stats.won, router.src[i].stats.dup);
+    if (n < 0 || (size_t)n >= size - pos) {
+      return 0;
+    }
+    pos += n;
+  }
+
+  if (pos == 0) {
+    n = snprintf(buf, size, "+CLAT,none\n\r");
+    if (n < 0 || (size_t)n >= size) {
+      return 0;
+    }
+    pos = n;
+  }
+
+  return pos;
+}
+
+/**
+ * @brief 들은 기준국 목록 (기준국마다 한 줄)
+ *
+ * +RBS,<기준국 ID>,dist=<m, 모르면 -1>,age=<마지막 관측 이후 ms>,src=<소스 bit>,
+ *   other=<버린 프레임, 모든 소스 합>[,sel]
+ *
+ * @param[out] buf
+ * @param[in] size
+ * @return size_t 문자열 길이 (0 이면 버퍼 부족)
+ */
+size_t rtcm_router_format_bases(char *buf, size_t size) {
+  rtcm_router_base_t base[RTCM_ROUTER_BASES];
+  uint32_t other = 0;
+  uint16_t pick;
+  TickType_t now;
+  size_t pos = 0;
+  int n;
+
+  if (!router.lock ||
+      xSemaphoreTake(router.lock, pdMS_TO_TICKS(RTCM_ROUTER_LOCK_MS)) != pdTRUE) {
+    return 0;
+  }
+  memcpy(base, router.base, sizeof(base));
+  pick = router.pick;
+  for (int i = 0; i < RTCM_SRC_MAX; i++) {
+    other += router.src[i].stats.other;
+  }
+  now = xTaskGetTickCount();
+  xSemaphoreGive(router.lock);
+
+  for (int i = 0; i < RTCM_ROUTER_BASES; i++) {
+    const rtcm_router_base_t *b = &base[i];
+
+    if (!b->used) {
+      continue;
+    }
+
+    n = snprintf(&buf[pos], size - pos, "+RBS,%u,dist=%ld,age=%lu,src=%X,other=%lu%s\n\r",
+                 b->id, b->dist_m >= 0.0f ? (long)b->dist_m : -1L,
+                 b->obs_tick ? (unsigned long)((now - b->obs_tick) * portTICK_PERIOD_MS)
+                             : UINT32_MAX,
+                 b->srcs, (unsigned long)other, b->id == pick ? ",sel" : "");
+    if (n < 0 || (size_t)n >= size - pos) {
+      return 0;
+    }
+    pos += n;
+  }
+
+  if (pos == 0) {
+    n = snprintf(buf, size, "+RBS,none\n\r");
+    if (n < 0 || (size_t)n >= size) {
+      return 0;
+    }
+    pos = n;
+  }
+
+  return pos;
+}
@@ -0,0 +1,168 @@
+#ifndef RTCM_ROUTER_H
+#define RTCM_ROUTER_H
+
+#include "FreeRTOS.h"
+#include "gps_app.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief 보정 데이터 입력 소스 (값이 작을수록 같은 조건에서 우선)
+ */
+typedef enum {
+  RTCM_SRC_LORA = 0,
+  RTCM_SRC_NTRIP,
+  RTCM_SRC_BLE,
+  RTCM_SRC_MAX,
+  RTCM_SRC_NONE = RTCM_SRC_MAX,
+} rtcm_src_t;
+
+/**
+ * @brief 이 시간 동안 유효 프레임이 없으면 소스가 끊긴 것으로 본다 (ms)
+ */
+#define RTCM_ROUTER_STALE_MS 3000
+
+/**
+ * @brief 더 완전한 소스로 넘어가기 전 연속으로 앞서야 하는 epoch 수
+ */
+#define RTCM_ROUTER_SWITCH_EPOCHS 3
+
+/**
+ * @brief 수신기 결과로 활성 소스를 강등하는 조건 (ms)
+ *
+ * 소스를 바꾼 뒤 JUDGE 동안은 수신기가 새 보정을 받아들일 시간이라 보지
+ * 않는다. 그 뒤 프레임은 들어오는데 REJECT 동안 수신기가 하나도 쓰지 않거나
+ * (RXM-RTCM), 항법 해의 보정 나이가 DIFF_AGE 를 넘으면 DEMOTE 동안 강등해서
+ * 살아 있는 다른 소스로 넘어간다. RTK fix 가 풀리기 전에 바꾸려는 값이다.
+ */
+#define RTCM_ROUTER_JUDGE_MS 10000
+#define RTCM_ROUTER_REJECT_MS 5000
+#define RTCM_ROUTER_REJECT_MIN 5 /* REJECT 판단에 필요한 안 쓴/CRC 실패 결과 수 */
+#define RTCM_ROUTER_DIFF_AGE_MS 5000
+#define RTCM_ROUTER_DEMOTE_MS 30000
+
+/**
+ * @brief 여러 기준국을 들을 때 가까운 기준국 고르기
+ *
+ * 기준국 ID 별로 1005/1006 ARP 와 마지막 관측 메시지 시각을 기억하고,
+ * BASE_EVAL 마다 로버 위치 (보정 대상 수신기의 항법 해) 와의 거리를 다시
+ * 잰다. 관측이 STALE 안에 들어오는 기준국 중 가장 가까운 곳을 고르고, 지금
+ * 고른 기준국보다 BASE_HYST 이상 가까워야 바꾼다. 고른 기준국이 있으면 다른
+ * 기준국의 기준국 ID 가 있는 메시지는 소스 선택 전에 버려서 GPS UART 로
+ * 가지 않는다 (그런 소스는 끊긴 것으로 보여 다른 소스로 넘어간다).
+ */
+#define RTCM_ROUTER_BASES 4
+#define RTCM_ROUTER_BASE_EVAL_MS 1000
+#define RTCM_ROUTER_BASE_HYST_M 1000
+
+/**
+ * @brief 관측 메시지 나이 (MSM/1001~1004 헤더 epoch 시각과 로버 GNSS 시각 차)
+ *
+ * 라우터에 닿은 때 기준이라 LoRa 조각 모으기, LTE 버퍼, 큐 대기가 모두
+ * 들어간다. OBS_AGE 보다 오래된 관측 메시지는 GPS UART 로 보내지 않고
+ * 버린다 (소스 선택에도 넣지 않아 그 소스만 늦으면 다른 소스로 넘어간다).
+ * GLONASS 시각은 UTC 라 윤초 LEAP_S 로 맞춘다.
+ */
+#define RTCM_ROUTER_OBS_AGE_MS 5000
+#define RTCM_ROUTER_LEAP_S 18
+
+/**
+ * @brief 여러 경로 중복 제거 (같은 기준국을 LoRa 와 LTE 로 함께 받을 때)
+ *
+ * 같은 기준국의 관측 메시지는 활성 소스가 아니어도 GPS 로 보내고, 최근에
+ * 보낸 (타입, epoch, CRC24Q) 를 작은 hash set 에 둬서 먼저 온 사본만
+ * 보낸다. 나중 사본이 오면 먼저 보낸 소스의 won 을 세고 앞선 시간을 그
+ * 소스의 RTCM_LAT_LEAD 에 넣는다. DEDUP_MS 보다 오래된 칸은 빈 것으로 본다.
+ */
+#define RTCM_ROUTER_DEDUP_SLOTS 32 /* 2 의 거듭제곱 */
+#define RTCM_ROUTER_DEDUP_MS RTCM_ROUTER_OBS_AGE_MS
+
+/**
+ * @brief 소스별 통계
+ */
+typedef struct {
+  uint32_t frames;    /**< CRC 통과 프레임 */
+  uint32_t crc_err;   /**< CRC 실패 (스트림 입력) */
+  uint32_t forwarded; /**< GPS 로 보낸 프레임 */
+  uint32_t dup;       /**< 다른 경로 (또는 같은 경로) 로 먼저 보낸 관측 메시지라 버림 */
+  uint32_t age_ms;    /**< 마지막 유효 프레임 이후 경과 시간 */
+  uint8_t epoch_msm;  /**< 직전 epoch 의 관측 메시지 개수 (완전성) */
+  uint32_t eng_used;   /**< 수신기가 항법에 썼다고 알린 메시지 */
+  uint32_t eng_unused; /**< 수신기가 받았지만 안 쓴 메시지 */
+  uint32_t eng_crc;    /**< 수신기 쪽 CRC 실패 (GPS UART 구간 손상) */
+  uint32_t demoted;    /**< 수신기 결과로 강등된 횟수 */
+  uint32_t cached;     /**< 전환 때 캐시에서 다시 보낸 기준국 정보 메시지 */
+  uint32_t shed;       /**< 과부하로 안 보낸 선택 메시지 (rtcm_router_set_shed) */
+  uint32_t other;      /**< 고르지 않은 기준국이라 버린 프레임 */
+  uint32_t stale;      /**< RTCM_ROUTER_OBS_AGE_MS 보다 오래돼 버린 관측 메시지 */
+  uint32_t won;        /**< 이 소스 것을 먼저 보내고 다른 경로 사본을 버린 관측 메시지 */
+  uint32_t dup_diff;   /**< dup 중 CRC 가 달랐던 것 (경로가 다시 인코딩) */
+} rtcm_router_stats_t;
+
+/**
+ * @brief 수신기가 알려준 보정 메시지 처리 결과 (F9P UBX-RXM-RTCM)
+ */
+typedef enum {
+  RTCM_ENGINE_UNKNOWN = 0,
+  RTCM_ENGINE_USED,
+  RTCM_ENGINE_UNUSED,
+  RTCM_ENGINE_CRC_ERR,
+} rtcm_engine_result_t;
+
+/**
+ * @brief 보정 데이터 지연 측정 구간
+ *
+ * 수신 시각은 NTRIP 은 QIRD 완료(sink 호출), LoRa 는 프레임 첫 바이트가
+ * 든 fragment 의 AT+RECV 파싱 시각이다. 송신 완료는 GPS UART DMA 완료.
+ */
+typedef enum {
+  RTCM_LAT_REASM = 0, /**< 수신 -> 프레임 완성 */
+  RTCM_LAT_UART,      /**< 프레임 완성 -> GPS UART 송신 완료 */
+  RTCM_LAT_TOTAL,     /**< 수신 -> GPS UART 송신 완료 (보정 데이터 나이) */
+  RTCM_LAT_EPOCH,     /**< 관측 epoch -> 라우터 (로버 GNSS 시각 기준, 관측 메시지만) */
+  RTCM_LAT_LEAD,      /**< 이 소스 사본을 보낸 뒤 다른 경로 사본이 올 때까지 (won 마다) */
+  RTCM_LAT_STAGE_MAX,
+} rtcm_lat_stage_t;
+
+/**
+ * @brief 지연 히스토그램 칸 수 (상한 10/20/50/100/200/500/1000 ms, 그 이상)
+ */
+#define RTCM_LAT_BUCKETS 8
+
+typedef struct {
+  uint32_t count;
+  uint32_t min_ms;
+  uint32_t max_ms;
+  uint32_t sum_ms;
+  uint32_t hist[RTCM_LAT_BUCKETS];
+} rtcm_lat_stat_t;
+
+/**
+ * @brief CRC 통과 프레임마다 불리는 관찰 콜백 (라우팅 전, 입력 태스크에서)
+ *
+ * 오래 걸리면 입력 경로가 늦어지므로 개수만 세는 정도로 짧게 쓴다.
+ */
+typedef void (*rtcm_router_frame_cb_t)(rtcm_src_t src, uint16_t msg_type,
+                                       size_t len);
+
+bool rtcm_router_init(void);
+void rtcm_router_set_frame_cb(rtcm_router_frame_cb_t cb);
+void rtcm_router_input(rtcm_src_t src, const uint8_t *data, size_t len);
+void rtcm_router_input_frame(rtcm_src_t src, const uint8_t *frame, size_t len,
+                             TickType_t rx_tick);
+void rtcm_router_set_targets(uint32_t gps_mask);
+void rtcm_router_set_shed(bool on);
+rtcm_src_t rtcm_router_get_active(void);
+bool rtcm_router_get_stats(rtcm_src_t src, rtcm_router_stats_t *out);
+bool rtcm_router_get_latency(rtcm_src_t src, rtcm_lat_stage_t stage,
+                             rtcm_lat_stat_t *out);
+void rtcm_router_reset_latency(void);
+void rtcm_router_engine_feedback(gps_id_t id, uint16_t type, uint16_t station,
+                                 rtcm_engine_result_t result);
+void rtcm_router_diff_age(gps_id_t id, uint32_t age_ms);
+size_t rtcm_router_format_engine(char *buf, size_t size);
+size_t rtcm_router_format_latency(char *buf, size_t size);
+size_t rtcm_router_format_bases(char *buf, size_t size);
+
+#endif
@@ -0,0 +1,473 @@
+#include "track_log.h"
+#include "app_events.h"
+#include "crc.h"
+#include "flash_params.h"
+#include "gps_app.h"
+#include "gps_types.h"
+#include "FreeRTOS.h"
+#include "semphr.h"
+#include "task.h"
+#include <string.h>
+
+#ifndef TAG
+#define TAG "TRACK"
+#endif
+
+#include "log.h"
+
+// sector 8~9 (링커 스크립트에서 코드 영역을 512K 로 줄여 비움)
+#define TRACK_SECTOR_SIZE 0x20000U
+#define TRACK_SECTOR_CNT 2
+#define TRACK_PAGES_PER_SECTOR (TRACK_SECTOR_SIZE / TRACK_PAGE_SIZE)
+#define TRACK_PAGE_CNT (TRACK_PAGES_PER_SECTOR * TRACK_SECTOR_CNT)
+
+#define TRACK_PAGE_HDR 8
+#define TRACK_PAGE_CRC_OFF (TRACK_PAGE_SIZE - 2)
+#define TRACK_PAGE_DATA (TRACK_PAGE_CRC_OFF - TRACK_PAGE_HDR)
+
+#define TRACK_KEY_LEN 19
+#define TRACK_REC_MAX 23 // flag + varint 5 x 4 + fix/sat
+
+// 간격이 길어도 이 시간이 지나면 덜 찬 페이지를 쓴다 (전원이 꺼져도 이만큼만 잃음)
+#define TRACK_PAGE_MAX_AGE_MS (10 * 60 * 1000)
+
+#define TRACK_WEEK_MS 604800000U
+
+static const struct {
+  uint32_t addr;
+  uint32_t sector;
+} track_sectors[TRACK_SECTOR_CNT] = {
+    {0x08080000U, FLASH_SECTOR_8},
+    {0x080A0000U, FLASH_SECTOR_9},
+};
+
+static struct {
+  // flash 쪽 (writer 태스크 작업만 바꿈, 통계는 critical section)
+  uint16_t write_idx; // 다음에 쓸 페이지 index
+  uint16_t last_idx;
+  uint32_t next_seq;
+  uint32_t last_seq;
+  uint32_t pages;
+
+  // 모으는 페이지 (mutex)
+  uint8_t page[TRACK_PAGE_SIZE];
+  uint16_t len;
+  uint8_t count;
+  TickType_t page_tick;
+  bool logged;         // 부팅 후 기록한 적 있음 (간격 판단)
+  uint32_t last_itow;  // 마지막으로 기록한 해
+  uint32_t prev_itow;  // 페이지 안에서 직전 레코드
+  int32_t prev_dt;
+  int32_t prev_lat;
+  int32_t prev_lon;
+  int32_t prev_alt;
+  uint8_t prev_fix;
+  uint8_t prev_sat;
+
+  // writer 로 넘긴 페이지 (쓰기가 끝나면 writer 가 비움)
+  uint8_t out[TRACK_PAGE_SIZE];
+  volatile bool out_busy;
+
+  uint32_t records;
+  uint32_t bytes;
+  uint32_t dropped_pages;
+  uint32_t write_errors;
+} trk;
+
+static SemaphoreHandle_t trk_mutex;
+static StaticSemaphore_t trk_mutex_buf;
+
+static void track_write_job(flash_job_t *job);
+static void track_clear_job(flash_job_t *job);
+static flash_job_t trk_write_job = FLASH_JOB_INIT(track_write_job);
+static flash_job_t trk_clear_job = FLASH_JOB_INIT(track_clear_job);
+
+static uint16_t get_le16(const uint8_t *p) {
+  return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get_le32(const uint8_t *p) {
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) |
+         ((uint32_t)p[3] << 24);
+}
+
+static void put_le16(uint8_t *p, uint16_t v) {
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_le32(uint8_t *p, uint32_t v) {
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)(v >> 8);
+  p[2] = (uint8_t)(v >> 16);
+  p[3] = (uint8_t)(v >> 24);
+}
+
+static uint8_t *put_varint(uint8_t *p, uint32_t v) {
+  while (v >= 0x80) {
+    *p++ = (uint8_t)(v | 0x80);
+    v >>= 7;
+  }
+  *p++ = (uint8_t)v;
+  return p;
+}
+
+static uint32_t zigzag(int32_t v) {
+  return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+/* 32 bit 로 감아서 뺀 값 (디코더는 더해서 감음) */
+static int32_t wrap_diff(int32_t a, int32_t b) {
+  return (int32_t)((uint32_t)a - (uint32_t)b);
+}
+
+static uint32_t itow_diff(uint32_t now, uint32_t prev) {
+  return now >= prev ? now - prev : now + TRACK_WEEK_MS - prev;
+}
+
+static const uint8_t *track_page_addr(uint16_t idx) {
+  return (const uint8_t *)(track_sectors[idx / TRACK_PAGES_PER_SECTOR].addr +
+                           (uint32_t)(idx % TRACK_PAGES_PER_SECTOR) * TRACK_PAGE_SIZE);
+}
+
+static bool track_blank(const uint8_t *p, uint32_t len) {
+  const uint32_t *w = (const uint32_t *)p;
+
+  for (uint32_t i = 0; i < len / 4; i++) {
+    if (w[i] != 0xFFFFFFFFU) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool track_page_used(uint16_t idx) {
+  return get_le16(track_page_addr(idx)) == TRACK_PAGE_MAGIC;
+}
+
+/* writer 태스크 */
+
+/**
+ * @brief sector 지우기 (그 안의 페이지 수만큼 pages 를 줄임)
+ */
+static void track_erase_sector(uint8_t s) {
+  uint32_t used = 0;
+
+  for (uint16_t i = 0; i < TRACK_PAGES_PER_SECTOR; i++) {
+    if (track_page_used(s * TRACK_PAGES_PER_SECTOR + i)) {
+      used++;
+    }
+  }
+
+  bool ok = flash_params_erase_sector(track_sectors[s].sector) == HAL_OK;
+
+  taskENTER_CRITICAL();
+  trk.pages = trk.pages > used ? trk.pages - used : 0;
+  if (!ok) {
+    trk.write_errors++;
+  }
+  taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief 넘겨받은 페이지에 번호/CRC 를 채워 한 번에 program (256 byte)
+ *
+ * sector 처음에 오면 그 sector (가장 오래된 기록) 를 먼저 지운다.
+ * 실패해도 자리는 넘긴다 (같은 곳에 다시 쓰지 않음).
+ */
+static void track_write_job(flash_job_t *job) {
+  uint16_t idx = trk.write_idx;
+  const uint8_t *dst = track_page_addr(idx);
+  uint32_t seq = trk.next_seq;
+  bool ok;
+
+  (void)job;
+
+  if (idx % TRACK_PAGES_PER_SECTOR == 0 && !track_blank(dst, TRACK_SECTOR_SIZE)) {
+    track_erase_sector((uint8_t)(idx / TRACK_PAGES_PER_SECTOR));
+  }
+
+  put_le32(&trk.out[2], seq);
+  put_le16(&trk.out[TRACK_PAGE_CRC_OFF], crc16_ccitt_update(0xFFFF, trk.out, TRACK_PAGE_CRC_OFF));
+
+  ok = track_blank(dst, TRACK_PAGE_SIZE) &&
+       flash_params_program((uint32_t)dst, trk.out, TRACK_PAGE_SIZE) == HAL_OK &&
+       memcmp(dst, trk.out, TRACK_PAGE_SIZE) == 0;
+
+  taskENTER_CRITICAL();
+  if (ok) {
+    trk.last_idx = idx;
+    trk.last_seq = seq;
+    trk.pages++;
+  } else {
+    trk.write_errors++;
+  }
+  trk.next_seq = seq + 1;
+  trk.write_idx = (uint16_t)((idx + 1) % TRACK_PAGE_CNT);
+  taskEXIT_CRITICAL();
+
+  trk.out_busy = false;
+}
+
+static void track_clear_job(flash_job_t *job) {
+  (void)job;
+
+  for (uint8_t s = 0; s < TRACK_SECTOR_CNT; s++) {
+    track_erase_sector(s);
+  }
+
+  taskENTER_CRITICAL();
+  trk.pages = 0;
+  trk.write_idx = 0;
+  taskEXIT_CRITICAL();
+
+  LOG_INFO("track log 지움");
+}
+
+/* 페이지 모으기 (mutex 안) */
+
+/**
+ * @brief 모으던 페이지를 writer 로 넘김 (앞 페이지를 아직 쓰는 중이면 버림)
+ */
+static void track_page_close(void) {
+  if (trk.count == 0) {
+    return;
+  }
+
+  put_le16(&trk.page[0], TRACK_PAGE_MAGIC);
+  trk.page[6] = trk.count;
+  trk.page[7] = (uint8_t)trk.len;
+  memset(&trk.page[TRACK_PAGE_HDR + trk.len], 0xFF, TRACK_PAGE_DATA - trk.len);
+
+  if (trk.out_busy) {
+    taskENTER_CRITICAL();
+    trk.dropped_pages++;
+    taskEXIT_CRITICAL();
+    LOG_WARN("track 페이지 버림 (writer 밀림)");
+  } else {
+    memcpy(trk.out, trk.page, TRACK_PAGE_SIZE);
+    trk.out_busy = true;
+    flash_params_submit_job(&trk_write_job);
+  }
+
+  trk.len = 0;
+  trk.count = 0;
+}
+
+/**
+ * @brief 레코드 하나 인코딩 (key 면 절대값, 아니면 직전과의 차이)
+ *
+ * @return 길이
+ */
+static uint8_t track_encode(uint8_t *rec, uint32_t itow, int32_t lat, int32_t lon, int32_t alt,
+                            uint8_t fix, uint8_t sat, bool key) {
+  uint8_t *p = rec;
+
+  if (key) {
+    *p++ = TRACK_REC_KEY | TRACK_REC_FIX;
+    put_le32(p, itow);
+    put_le32(p + 4, (uint32_t)lat);
+    put_le32(p + 8, (uint32_t)lon);
+    put_le32(p + 12, (uint32_t)alt);
+    p[16] = fix;
+    p[17] = sat;
+    return TRACK_KEY_LEN;
+  }
+
+  int32_t dt = (int32_t)itow_diff(itow, trk.prev_itow);
+  bool fix_changed = fix != trk.prev_fix || sat != trk.prev_sat;
+
+  *p++ = fix_changed ? TRACK_REC_FIX : 0;
+  p = put_varint(p, zigzag(dt - trk.prev_dt));
+  p = put_varint(p, zigzag(wrap_diff(lat, trk.prev_lat)));
+  p = put_varint(p, zigzag(wrap_diff(lon, trk.prev_lon)));
+  p = put_varint(p, zigzag(wrap_diff(alt, trk.prev_alt)));
+  if (fix_changed) {
+    *p++ = fix;
+    *p++ = sat;
+  }
+  return (uint8_t)(p - rec);
+}
+
+static void track_append(const gps_position_t *pos) {
+  uint8_t rec[TRACK_REC_MAX];
+  int32_t lat = (int32_t)(pos->llh.lat / 100);
+  int32_t lon = (int32_t)(pos->llh.lon / 100);
+  int32_t alt = gps_llh_alt_to_mm(pos->llh.msl_alt);
+  uint8_t fix = (uint8_t)pos->fix;
+  uint8_t sat = (uint8_t)pos->sat_num;
+  bool key = trk.count == 0;
+  uint8_t len = track_encode(rec, pos->itow, lat, lon, alt, fix, sat, key);
+
+  if (trk.len + len > TRACK_PAGE_DATA) {
+    track_page_close();
+    key = true;
+    len = track_encode(rec, pos->itow, lat, lon, alt, fix, sat, true);
+  }
+
+  if (key) {
+    trk.prev_dt = 0;
+    trk.page_tick = xTaskGetTickCount();
+  } else {
+    trk.prev_dt = (int32_t)itow_diff(pos->itow, trk.prev_itow);
+  }
+  trk.prev_itow = pos->itow;
+  trk.prev_lat = lat;
+  trk.prev_lon = lon;
+  trk.prev_alt = alt;
+  trk.prev_fix = fix;
+  trk.prev_sat = sat;
+
+  memcpy(&trk.page[TRACK_PAGE_HDR + trk.len], rec, len);
+  trk.len += len;
+  trk.count++;
+
+  taskENTER_CRITICAL();
+  trk.records++;
+  trk.bytes += len;
+  taskEXIT_CRITICAL();
+
+  if (xTaskGetTickCount() - trk.page_tick >= pdMS_TO_TICKS(TRACK_PAGE_MAX_AGE_MS)) {
+    track_page_close();
+  }
+}
+
+/**
+ * @brief 새 항법 해 - 간격이 지났고 fix 가 있으면 기록 (LOW lane)
+ */
+static void track_on_solution(const event_msg_t *msg) {
+  uint32_t interval = flash_params_snapshot(NULL)->track_interval_s;
+  gps_position_t pos;
+
+  (void)msg;
+
+  if (interval == 0 || interval > TRACK_INTERVAL_MAX_S) {
+    return;
+  }
+
+  gps_get_position(&pos);
+  if (pos.fix == 0) {
+    return;
+  }
+
+  if (trk.logged && itow_diff(pos.itow, trk.last_itow) < interval * 1000) {
+    return;
+  }
+  trk.logged = true;
+  trk.last_itow = pos.itow;
+
+  xSemaphoreTake(trk_mutex, portMAX_DELAY);
+  track_append(&pos);
+  xSemaphoreGive(trk_mutex);
+}
+
+void track_log_init(void) {
+  bool found = false;
+  uint32_t used = 0;
+
+  if (trk_mutex) {
+    return;
+  }
+
+  // 머리말만 보고 가장 최근 번호를 찾는다 (쓰다 끊긴 페이지는 읽을 때 CRC 로 거름)
+  for (uint16_t i = 0; i < TRACK_PAGE_CNT; i++) {
+    const uint8_t *p = track_page_addr(i);
+    uint32_t seq;
+
+    if (get_le16(p) != TRACK_PAGE_MAGIC) {
+      continue;
+    }
+    used++;
+    seq = get_le32(&p[2]);
+    if (!found || (int32_t)(seq - trk.last_seq) > 0) {
+      trk.last_seq = seq;
+      trk.last_idx = i;
+      found = true;
+    }
+  }
+
+  trk.pages = used;
+  trk.next_seq = found ? trk.last_seq + 1 : 1;
+  trk.write_idx = found ? (uint16_t)((trk.last_idx + 1) % TRACK_PAGE_CNT) : 0;
+
+  // 비어 있지 않은 자리면 다음 sector 처음으로 (쓸 때 지움)
+  while (trk.write_idx % TRACK_PAGES_PER_SECTOR != 0 &&
+         !track_blank(track_page_addr(trk.write_idx), TRACK_PAGE_SIZE)) {
+    trk.write_idx = (uint16_t)((trk.write_idx + 1) % TRACK_PAGE_CNT);
+  }
+
+  trk_mutex = xSemaphoreCreateMutexStatic(&trk_mutex_buf);
+
+  // flash 가 아닌 RAM 만 만지지만 gps_get_position 복사가 있어 LOW lane
+  app_event_subscribe(APP_EVT_BIT(APP_EVT_GPS_SOLUTION), track_on_solution, EVENT_BUS_LANE_LOW);
+
+  LOG_INFO("track log: %lu pages, next #%lu at %u", used, trk.next_seq, trk.write_idx);
+}
+
+void track_log_flush(void) {
+  if (!trk_mutex) {
+    return;
+  }
+
+  xSemaphoreTake(trk_mutex, portMAX_DELAY);
+  track_page_close();
+  xSemaphoreGive(trk_mutex);
+}
+
+void track_log_clear(void) {
+  if (!trk_mutex) {
+    return;
+  }
+
+  xSemaphoreTake(trk_mutex, portMAX_DELAY);
+  trk.len = 0;
+  trk.count = 0;
+  xSemaphoreGive(trk_mutex);
+
+  flash_params_submit_job(&trk_clear_job);
+}
+
+void track_log_get_info(track_log_info_t *out) {
+  uint32_t interval = flash_params_snapshot(NULL)->track_interval_s;
+
+  out->enabled = interval != 0 && interval <= TRACK_INTERVAL_MAX_S;
+  out->interval_s = out->enabled ? interval : 0;
+  out->capacity = TRACK_PAGE_CNT;
+
+  taskENTER_CRITICAL();
+  out->pages = trk.pages;
+  out->last_seq = trk.last_seq;
+  out->ram_records = trk.count;
+  out->records = trk.records;
+  out->bytes = trk.bytes;
+  out->dropped_pages = trk.dropped_pages;
+  out->write_errors = trk.write_errors;
+  taskEXIT_CRITICAL();
+
+  out->first_seq = out->pages ? out->last_seq - out->pages + 1 : 0;
+}
+
+const uint8_t *track_log_page(uint32_t seq) {
+  uint32_t last_seq;
+  uint32_t back;
+  uint16_t idx;
+  const uint8_t *p;
+
+  taskENTER_CRITICAL();
+  last_seq = trk.last_seq;
+  back = trk.last_seq - seq;
+  idx = trk.last_idx;
+  taskEXIT_CRITICAL();
+
+  if (trk.pages == 0 || (int32_t)(seq - last_seq) > 0 || back >= TRACK_PAGE_CNT) {
+    return NULL;
+  }
+
+  p = track_page_addr((uint16_t)((idx + TRACK_PAGE_CNT - back) % TRACK_PAGE_CNT));
+  if (get_le16(p) != TRACK_PAGE_MAGIC || get_le32(&p[2]) != seq ||
+      get_le16(&p[TRACK_PAGE_CRC_OFF]) != crc16_ccitt_update(0xFFFF, p, TRACK_PAGE_CRC_OFF)) {
+    return NULL;
+  }
+
+  return p;
+}
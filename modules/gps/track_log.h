@@ -0,0 +1,78 @@
+#ifndef TRACK_LOG_H
+#define TRACK_LOG_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief 위치 궤적 기록 (내부 flash sector 8~9, 순환)
+ *
+ * track_interval_s 마다 fix 가 있는 해를 256 byte 페이지에 모아 페이지 단위로
+ * flash writer 에 넘긴다. 페이지 첫 레코드만 절대값이고 나머지는 직전 레코드와의
+ * 차이를 zig-zag varint 로 적는다 (정지/보행이면 레코드당 5~7 byte, 절대값은 19).
+ * 두 sector 가 차면 오래된 sector 를 지우고 이어 쓴다.
+ *
+ * 페이지 (little-endian, 페이지마다 따로 풀 수 있음):
+ *
+ *  off size
+ *   0  2   magic 0x4B54 ("TK")
+ *   2  4   페이지 번호 (부팅 후에도 이어짐)
+ *   6  1   레코드 수
+ *   7  1   레코드 영역 길이
+ *   8  246 레코드 (남은 곳 0xFF)
+ * 254  2   CRC16-CCITT (init 0xFFFF, 0~253)
+ *
+ * 레코드 첫 byte 는 flag:
+ *   TRACK_REC_KEY  itow(4) lat(4) lon(4) [1e-7 deg] msl(4) [mm] fix(1) sat(1)
+ *   (없으면)       varint zz(dt - 직전 dt) [ms], zz(dlat), zz(dlon), zz(dalt)
+ *                  TRACK_REC_FIX 이면 뒤에 fix(1) sat(1)
+ * dt 는 iTOW 차이 (주가 바뀌면 604800000 을 더함), 위도/경도/높이 차이는
+ * 32 bit 로 감아서 뺀 값이다. 주 번호는 항법 해에 없어 싣지 않는다.
+ */
+#define TRACK_PAGE_SIZE 256
+#define TRACK_PAGE_MAGIC 0x4B54
+
+#define TRACK_REC_KEY 0x01
+#define TRACK_REC_FIX 0x02
+
+#define TRACK_INTERVAL_MAX_S 3600
+
+typedef struct {
+  bool enabled;
+  uint32_t interval_s;
+  uint32_t first_seq;     // flash 에 남은 가장 오래된 페이지 번호
+  uint32_t last_seq;      // 가장 최근 페이지 번호 (pages 0 이면 의미 없음)
+  uint32_t pages;         // flash 에 남은 페이지 수
+  uint32_t capacity;      // 전체 페이지 수 (쓰는 중인 sector 포함)
+  uint16_t ram_records;   // 아직 flash 에 안 쓴 레코드
+  uint32_t records;       // 부팅 후 기록한 레코드
+  uint32_t bytes;         // 그 레코드들의 byte (절대값이면 19 x records)
+  uint32_t dropped_pages; // writer 가 밀려 버린 페이지
+  uint32_t write_errors;
+} track_log_info_t;
+
+/**
+ * @brief flash 에서 이어 쓸 자리를 찾고 항법 해 구독 (flash_params_init 뒤)
+ */
+void track_log_init(void);
+
+/**
+ * @brief 모으던 페이지를 바로 flash 로 (채워지지 않았어도)
+ */
+void track_log_flush(void);
+
+/**
+ * @brief 기록을 모두 지움 (writer 태스크에서 두 sector erase)
+ */
+void track_log_clear(void);
+
+void track_log_get_info(track_log_info_t *out);
+
+/**
+ * @brief 페이지 번호로 flash 의 페이지 찾기 (복사 없이 flash 주소)
+ *
+ * @return NULL 이미 덮였거나 아직 안 쓴 번호, 또는 CRC 가 맞지 않음
+ */
+const uint8_t *track_log_page(uint32_t seq);
+
+#endif
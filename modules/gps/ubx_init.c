@@ -2,6 +2,8 @@
 #include <stdbool.h>
 #include "gps_ubx.h"
 #include "ubx_init.h"
+#include "gps_rate.h"
+#include "gps_port.h"
 #include <stdlib.h>
 #include <string.h>
 
@@ -11,6 +13,8 @@
 
 #include "log.h"
 
+#if defined(USE_GPS_UBLOX)
+
 #define CFG_GGA_UART1 (0x209100bbU)
 #define CFG_GLL_UART1 (0x209100caU)
 #define CFG_GSA_UART1 (0x209100c0U)
@@ -18,8 +22,12 @@
 #define CFG_RMC_UART1 (0x209100acU)
 #define CFG_VTG_UART1 (0x209100b1U)
 
+#define CFG_NAV_PVT_UART1 (0x20910007U)
 #define CFG_NAV_HPPOSLLH_UART1 (0x20910034U)
 #define CFG_NAV_RELPOSNED_UART1 (0x2091008eU)
+#define CFG_RXM_RTCM_UART1 (0x20910269U) // 받은 RTCM 마다 (값은 1 만 의미 있음)
+#define CFG_MON_COMMS_UART1 (0x20910350U)
+#define CFG_NAV_SAT_UART1 (0x20910016U)
 
 #define CFG_RTCM_1005_UART1 (0x209102beU) // antenna
 #define CFG_RTCM_1005_UART2 (0x209102bfU) // antenna
@@ -31,9 +39,18 @@
 #define CFG_RTCM_1094_UART2 (0x2091036aU) // GALLILEO
 #define CFG_RTCM_1124_UART1 (0x2091036eU) // BEIDU
 #define CFG_RTCM_1124_UART2 (0x2091036fU) // BEIDU
+#define CFG_RTCM_4072_0_UART1 (0x209102ffU) // RTCM4072_0
 #define CFG_RTCM_4072_0_UART2 (0x20910300U) // RTCM4072_0
+#define CFG_RTCM_4072_1_UART1 (0x20910382U) // RTCM4072_1
 #define CFG_RTCM_4072_1_UART2 (0x20910383U) // RTCM4072_1
 
+/* moving base RTCM 출력 포트: 다리 (USE_GPS_MB_BRIDGE) 면 MCU 쪽 UART1 */
+#if USE_GPS_MB_BRIDGE
+#define CFG_MB_RTCM(msg) CFG_RTCM_##msg##_UART1
+#else
+#define CFG_MB_RTCM(msg) CFG_RTCM_##msg##_UART2
+#endif
+
 #define CFG_BAUDRATE_UART1 (0x40520001U) // 4바이트
 #define CFG_BAUDRATE_UART2 (0x40530001U) // 4바이트
 
@@ -44,6 +61,13 @@
 
 #define CFG_RATE_MEAS (0x30210001U)
 
+/* CFG-MSGOUT 그룹 (값은 몇 번째 항법 해마다 내보낼지) */
+#define CFG_KEY_GROUP(key) (((key) >> 16) & 0xFFFU)
+#define CFG_GROUP_MSGOUT 0x091U
+
+/* rover/moving base 테이블의 기준 주기 (RATE_MEAS 50 ms, 출력 비율도 이 기준) */
+#define UBX_TABLE_RATE_HZ 20
+
 /* base station */
 #define CFG_TMODE_MODE (0x20030001U) // 0 disable 1 survey 2 fixed
 #define CFG_TMODE_POS_TYPE (0x20030002U) // 0 ecef 1 llh
@@ -93,6 +117,18 @@ static const ubx_cfg_item_t ublox_base_configs[] = {
         .value_len = 1,
     },
 
+    {
+        .key_id = CFG_MON_COMMS_UART1,
+        .value = {5}, // 1 Hz 기준 5 초
+        .value_len = 1,
+    },
+
+    {
+        .key_id = CFG_NAV_SAT_UART1,
+        .value = {5}, // 1 Hz 기준 5 초
+        .value_len = 1,
+    },
+
     /* RTCM 설정 */
     {
         .key_id = CFG_RTCM_1005_UART1,
@@ -213,6 +249,25 @@ static const ubx_cfg_item_t ublox_rover_configs[] = {
         .value_len = 1,
     },
 
+    /* 수신기 쪽 보정 수신/포트 진단 */
+    {
+        .key_id = CFG_RXM_RTCM_UART1,
+        .value = {1},
+        .value_len = 1,
+    },
+
+    {
+        .key_id = CFG_MON_COMMS_UART1,
+        .value = {100}, // 5 초
+        .value_len = 1,
+    },
+
+    {
+        .key_id = CFG_NAV_SAT_UART1,
+        .value = {100}, // 5 초
+        .value_len = 1,
+    },
+
     /* UART2 포트 설정 */
     {
         .key_id = CFG_UART2INPROT_RTCM3X,
@@ -284,16 +339,34 @@ static const ubx_cfg_item_t ublox_moving_base_configs[] = {
         .value = {1},
         .value_len = 1,
     },
+
+    {
+        .key_id = CFG_RXM_RTCM_UART1,
+        .value = {1},
+        .value_len = 1,
+    },
+
+    {
+        .key_id = CFG_MON_COMMS_UART1,
+        .value = {100}, // 5 초
+        .value_len = 1,
+    },
+
+    {
+        .key_id = CFG_NAV_SAT_UART1,
+        .value = {100}, // 5 초
+        .value_len = 1,
+    },
     
     /* RTCM 설정 */
     {
-        .key_id = CFG_RTCM_1005_UART2,
+        .key_id = CFG_MB_RTCM(1005),
         .value = {200},
         .value_len = 1,
     },
 
     {
-        .key_id = CFG_RTCM_1074_UART2,
+        .key_id = CFG_MB_RTCM(1074),
         .value = {20},
         .value_len = 1,
     },
@@ -305,25 +378,25 @@ static const ubx_cfg_item_t ublox_moving_base_configs[] = {
     // },
 
     {
-        .key_id = CFG_RTCM_1094_UART2,
+        .key_id = CFG_MB_RTCM(1094),
         .value = {20},
         .value_len = 1,
     },
 
     {
-        .key_id = CFG_RTCM_1124_UART2,
+        .key_id = CFG_MB_RTCM(1124),
         .value = {20},
         .value_len = 1,
     },
 
     {
-        .key_id = CFG_RTCM_4072_0_UART2,
+        .key_id = CFG_MB_RTCM(4072_0),
         .value = {20},
         .value_len = 1,
     },
 
     {
-        .key_id = CFG_RTCM_4072_1_UART2,
+        .key_id = CFG_MB_RTCM(4072_1),
         .value = {20},
         .value_len = 1,
     },
@@ -348,6 +421,294 @@ static const ubx_cfg_item_t ublox_moving_base_configs[] = {
     },
 };
 
+/* 주기와 대역 예산을 반영한 테이블 사본 (ubx_init_async_start 가 포인터만 들고 있음) */
+static ubx_cfg_item_t ublox_base_rate_configs[sizeof(ublox_base_configs) / sizeof(ublox_base_configs[0])];
+static ubx_cfg_item_t ublox_rover_rate_configs[sizeof(ublox_rover_configs) / sizeof(ublox_rover_configs[0])];
+static ubx_cfg_item_t ublox_moving_base_rate_configs[sizeof(ublox_moving_base_configs) / sizeof(ublox_moving_base_configs[0])];
+
+/* 위성계 (크기 모델에서 위성 수를 곱할 때) */
+#define UBX_GNSS_GPS 0x01U
+#define UBX_GNSS_GLO 0x02U
+#define UBX_GNSS_GAL 0x04U
+#define UBX_GNSS_BDS 0x08U
+#define UBX_GNSS_COUNT 4
+
+/* 켜진 위성계: 테이블이 CFG-SIGNAL 을 건드리지 않으므로 F9P 기본값 (네 개 모두) */
+#define UBX_BUDGET_GNSS (UBX_GNSS_GPS | UBX_GNSS_GLO | UBX_GNSS_GAL | UBX_GNSS_BDS)
+
+/* 위성계마다 보통 보이는 위성 수 (트인 하늘, 여유 있게) */
+static const uint8_t ubx_gnss_sats[UBX_GNSS_COUNT] = {12, 9, 10, 14};
+
+/* RXM-RTCM 은 받은 보정 메시지마다 (1005 + MSM 3~4 개 + 1230) */
+#define UBX_BUDGET_RTCM_IN_HZ 8
+
+/* UART2 속도를 테이블에서 정하지 않으면 F9P 기본값 */
+#define UBX_UART2_DEFAULT_BAUD 38400
+
+/**
+ * @brief 출력 메시지 크기 모델 (수신기 UART 대역 예산)
+ *
+ * 한 번 나갈 때 byte = fixed + per_gnss * 켜진 위성계 수 + per_sat * 그 위성계
+ * 위성 수 (gnss 가 0 이면 켜진 위성계 전부). 프레임 (UBX 8, RTCM 6, NMEA
+ * $..*hh\r\n) 포함, MSM 은 F9P 기본 신호 두 개 기준.
+ *
+ * prune 은 대역이 모자랄 때 끄는 순서 (작은 것부터), 0 은 끄지 않음.
+ */
+typedef struct
+{
+    uint32_t key_id;
+    const char *name;
+    uint8_t port;     // 1: UART1 (MCU), 2: UART2
+    uint16_t fixed;
+    uint8_t per_gnss;
+    uint8_t per_sat;
+    uint8_t gnss;
+    uint8_t fixed_hz; // 0 이 아니면 항법 주기와 상관없이 초당 이만큼 (켜고 끄기만)
+    uint8_t prune;
+} ubx_msg_model_t;
+
+static const ubx_msg_model_t ubx_msg_models[] = {
+    {CFG_GGA_UART1, "GGA", 1, 82, 0, 0, 0, 0, 0},
+    {CFG_GLL_UART1, "GLL", 1, 52, 0, 0, 0, 0, 2},
+    {CFG_GSA_UART1, "GSA", 1, 0, 68, 0, 0, 0, 2},
+    {CFG_GSV_UART1, "GSV", 1, 0, 0, 18, 0, 0, 1},
+    {CFG_RMC_UART1, "RMC", 1, 76, 0, 0, 0, 0, 2},
+    {CFG_VTG_UART1, "VTG", 1, 40, 0, 0, 0, 0, 2},
+    {CFG_NAV_PVT_UART1, "NAV-PVT", 1, 100, 0, 0, 0, 0, 5},
+    {CFG_NAV_HPPOSLLH_UART1, "NAV-HPPOSLLH", 1, 44, 0, 0, 0, 0, 0},
+    {CFG_NAV_RELPOSNED_UART1, "NAV-RELPOSNED", 1, 72, 0, 0, 0, 0, 0},
+    {CFG_RXM_RTCM_UART1, "RXM-RTCM", 1, 16, 0, 0, 0, UBX_BUDGET_RTCM_IN_HZ, 4},
+    {CFG_MON_COMMS_UART1, "MON-COMMS", 1, 176, 0, 0, 0, 0, 3},
+    {CFG_NAV_SAT_UART1, "NAV-SAT", 1, 16, 0, 12, 0, 0, 1},
+    {CFG_RTCM_1005_UART1, "RTCM1005", 1, 25, 0, 0, 0, 0, 0},
+    {CFG_RTCM_1005_UART2, "RTCM1005", 2, 25, 0, 0, 0, 0, 0},
+    {CFG_RTCM_1074_UART1, "RTCM1074", 1, 27, 0, 15, UBX_GNSS_GPS, 0, 0},
+    {CFG_RTCM_1074_UART2, "RTCM1074", 2, 27, 0, 15, UBX_GNSS_GPS, 0, 0},
+    {CFG_RTCM_1084_UART1, "RTCM1084", 1, 27, 0, 15, UBX_GNSS_GLO, 0, 0},
+    {CFG_RTCM_1084_UART2, "RTCM1084", 2, 27, 0, 15, UBX_GNSS_GLO, 0, 0},
+    {CFG_RTCM_1094_UART1, "RTCM1094", 1, 27, 0, 15, UBX_GNSS_GAL, 0, 0},
+    {CFG_RTCM_1094_UART2, "RTCM1094", 2, 27, 0, 15, UBX_GNSS_GAL, 0, 0},
+    {CFG_RTCM_1124_UART1, "RTCM1124", 1, 27, 0, 15, UBX_GNSS_BDS, 0, 0},
+    {CFG_RTCM_1124_UART2, "RTCM1124", 2, 27, 0, 15, UBX_GNSS_BDS, 0, 0},
+    {CFG_RTCM_4072_0_UART1, "RTCM4072.0", 1, 60, 0, 0, 0, 0, 0},
+    {CFG_RTCM_4072_0_UART2, "RTCM4072.0", 2, 60, 0, 0, 0, 0, 0},
+    {CFG_RTCM_4072_1_UART1, "RTCM4072.1", 1, 30, 0, 0, 0, 0, 0},
+    {CFG_RTCM_4072_1_UART2, "RTCM4072.1", 2, 30, 0, 0, 0, 0, 0},
+};
+
+/**
+ * @brief 1 보다 큰 출력 비율을 hz 주기로 (초 단위 주기가 그대로 남게)
+ */
+static uint8_t ubx_scale_ratio(uint8_t ratio, uint32_t hz)
+{
+    uint32_t scaled;
+
+    if (ratio <= 1)
+    {
+        return ratio;
+    }
+
+    scaled = (ratio * hz + UBX_TABLE_RATE_HZ / 2) / UBX_TABLE_RATE_HZ;
+    return scaled < 1 ? 1 : scaled > 255 ? 255 : (uint8_t)scaled;
+}
+
+/**
+ * @brief 테이블을 hz 주기로 바꿔 복사
+ *
+ * RATE_MEAS 는 1000/hz ms, 1 보다 큰 출력 비율은 초 단위 주기가 그대로
+ * 남도록 (GGA 1 Hz, 1005 10 초) 비례해서 줄이거나 늘린다.
+ */
+static const ubx_cfg_item_t *ubx_apply_nav_rate(ubx_cfg_item_t *dst, const ubx_cfg_item_t *src,
+                                               size_t count, uint32_t hz)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        dst[i] = src[i];
+
+        if (dst[i].key_id == CFG_RATE_MEAS)
+        {
+            uint16_t ms = gps_rate_meas_ms(hz);
+
+            dst[i].value[0] = ms & 0xFF;
+            dst[i].value[1] = (ms >> 8) & 0xFF;
+        }
+        else if (CFG_KEY_GROUP(dst[i].key_id) == CFG_GROUP_MSGOUT)
+        {
+            dst[i].value[0] = ubx_scale_ratio(dst[i].value[0], hz);
+        }
+    }
+
+    return dst;
+}
+
+static const ubx_msg_model_t *ubx_msg_model(uint32_t key_id)
+{
+    for (size_t i = 0; i < sizeof(ubx_msg_models) / sizeof(ubx_msg_models[0]); i++)
+    {
+        if (ubx_msg_models[i].key_id == key_id)
+        {
+            return &ubx_msg_models[i];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief 메시지 하나가 hz 주기에 ratio 비율로 내보내는 양 [byte/s]
+ */
+static uint32_t ubx_msg_load(const ubx_msg_model_t *m, uint8_t ratio, uint32_t hz)
+{
+    uint32_t bytes = m->fixed;
+
+    // 꺼진 위성계의 MSM 은 나오지 않음
+    if (ratio == 0 || (m->gnss && !(UBX_BUDGET_GNSS & m->gnss)))
+    {
+        return 0;
+    }
+
+    for (int g = 0; g < UBX_GNSS_COUNT; g++)
+    {
+        uint8_t bit = 1U << g;
+
+        if (!(UBX_BUDGET_GNSS & bit) || (m->gnss && !(m->gnss & bit)))
+        {
+            continue;
+        }
+        bytes += m->per_gnss + m->per_sat * ubx_gnss_sats[g];
+    }
+
+    if (m->fixed_hz)
+    {
+        return bytes * m->fixed_hz;
+    }
+    return (bytes * hz + ratio - 1) / ratio;
+}
+
+/**
+ * @brief 테이블이 port 로 내보낼 양 [byte/s]
+ *
+ * @param scale true: 20 Hz 기준 원본 테이블 (비율을 hz 로 바꿔 셈)
+ */
+static uint32_t ubx_table_load(const ubx_cfg_item_t *tbl, size_t count, uint32_t hz, bool scale,
+                               uint8_t port)
+{
+    uint32_t load = 0;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        const ubx_msg_model_t *m;
+
+        if (CFG_KEY_GROUP(tbl[i].key_id) != CFG_GROUP_MSGOUT)
+        {
+            continue;
+        }
+        m = ubx_msg_model(tbl[i].key_id);
+        if (!m)
+        {
+            LOG_DEBUG("no size model for key %08lX", tbl[i].key_id);
+            continue;
+        }
+        if (m->port == port)
+        {
+            load += ubx_msg_load(m, scale ? ubx_scale_ratio(tbl[i].value[0], hz) : tbl[i].value[0],
+                                 hz);
+        }
+    }
+
+    return load;
+}
+
+static uint32_t ubx_table_uart2_baud(const ubx_cfg_item_t *tbl, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        if (tbl[i].key_id == CFG_BAUDRATE_UART2)
+        {
+            return tbl[i].value[0] | tbl[i].value[1] << 8 | (uint32_t)tbl[i].value[2] << 16 |
+                   (uint32_t)tbl[i].value[3] << 24;
+        }
+    }
+
+    return UBX_UART2_DEFAULT_BAUD;
+}
+
+static bool ubx_budget_ok(uint32_t bytes_per_s, uint32_t baud)
+{
+    return bytes_per_s * 10 * 100 <= baud * GPS_RATE_MAX_LOAD_PCT;
+}
+
+/**
+ * @brief 포트마다 예상 출력을 속도와 비교해 넘치면 우선순위 낮은 메시지부터 끔
+ *
+ * UART1 속도는 f9p_init_port_baudrate 가 ubx_cfg_uart1_load 로 이미 올린
+ * 값이라 여기서 넘치면 올릴 수 있는 데까지 올린 뒤다.
+ */
+static void ubx_budget_fit(ubx_cfg_item_t *tbl, size_t count, uint32_t hz, gps_id_t id)
+{
+    for (uint8_t port = 1; port <= 2; port++)
+    {
+        uint32_t baud = port == 1 ? gps_port_get_baud(id) : ubx_table_uart2_baud(tbl, count);
+        uint32_t load = ubx_table_load(tbl, count, hz, false, port);
+
+        if (baud == 0 || load == 0)
+        {
+            continue;
+        }
+
+        while (!ubx_budget_ok(load, baud))
+        {
+            ubx_cfg_item_t *victim = NULL;
+            const ubx_msg_model_t *vm = NULL;
+
+            for (size_t i = 0; i < count; i++)
+            {
+                const ubx_msg_model_t *m = ubx_msg_model(tbl[i].key_id);
+
+                if (m && m->port == port && m->prune && tbl[i].value[0] &&
+                    (!vm || m->prune < vm->prune))
+                {
+                    victim = &tbl[i];
+                    vm = m;
+                }
+            }
+            if (!victim)
+            {
+                LOG_ERR("UART%u %lu B/s over budget at %lu bps, nothing left to prune", port,
+                        load, baud);
+                break;
+            }
+
+            LOG_WARN("UART%u %lu B/s over budget at %lu bps, %s off", port, load, baud, vm->name);
+            victim->value[0] = 0;
+            load = ubx_table_load(tbl, count, hz, false, port);
+        }
+
+        LOG_INFO("UART%u %lu B/s at %lu bps (%lu%%)", port, load, baud,
+                 load * 10 * 100 / baud);
+    }
+}
+
+uint32_t ubx_cfg_uart1_load(gps_id_t id, uint32_t hz)
+{
+    // 기준국 테이블은 1 Hz 기준이라 비율을 바꾸지 않음
+    if (BOARD_IS(BOARD_TYPE_BASE_F9P))
+    {
+        return ubx_table_load(ublox_base_configs,
+                              sizeof(ublox_base_configs) / sizeof(ublox_base_configs[0]), 1,
+                              false, 1);
+    }
+    if (id == GPS_ID_BASE)
+    {
+        return ubx_table_load(ublox_moving_base_configs,
+                              sizeof(ublox_moving_base_configs) / sizeof(ublox_moving_base_configs[0]),
+                              hz, true, 1);
+    }
+    return ubx_table_load(ublox_rover_configs,
+                          sizeof(ublox_rover_configs) / sizeof(ublox_rover_configs[0]), hz, true,
+                          1);
+}
+
 static void on_init_complete(bool success, size_t failed_step, void *user_data)
 {
     if (success)
@@ -362,27 +723,39 @@ static void on_init_complete(bool success, size_t failed_step, void *user_data)
 
 bool ubx_rover_init(gps_t* gps)
 {
-    ubx_init_async_start(gps, UBX_CFG_LAYER_RAM,
-                          ublox_rover_configs, sizeof(ublox_rover_configs) / sizeof(ublox_rover_configs[0]),
-        on_init_complete, NULL);
+    size_t count = sizeof(ublox_rover_configs) / sizeof(ublox_rover_configs[0]);
+    uint32_t hz = gps_rate_get_hz();
+
+    ubx_apply_nav_rate(ublox_rover_rate_configs, ublox_rover_configs, count, hz);
+    ubx_budget_fit(ublox_rover_rate_configs, count, hz, GPS_ID_ROVER);
+    ubx_init_async_start(gps, UBX_CFG_LAYER_RAM, ublox_rover_rate_configs, count,
+                          on_init_complete, NULL);
 }
 
 bool ubx_base_init(gps_t* gps)
 {
-    ubx_init_async_start(gps, UBX_CFG_LAYER_RAM,
-                          ublox_base_configs, sizeof(ublox_base_configs) / sizeof(ublox_base_configs[0]),
-        on_init_complete, NULL);
+    size_t count = sizeof(ublox_base_configs) / sizeof(ublox_base_configs[0]);
+
+    memcpy(ublox_base_rate_configs, ublox_base_configs, sizeof(ublox_base_configs));
+    ubx_budget_fit(ublox_base_rate_configs, count, 1, GPS_ID_BASE);
+    ubx_init_async_start(gps, UBX_CFG_LAYER_RAM, ublox_base_rate_configs, count,
+                          on_init_complete, NULL);
 }
 
 bool ubx_moving_base_init(gps_t* gps)
 {
-    ubx_init_async_start(gps, UBX_CFG_LAYER_RAM,
-                          ublox_moving_base_configs, sizeof(ublox_moving_base_configs) / sizeof(ublox_moving_base_configs[0]),
-        on_init_complete, NULL);
+    size_t count = sizeof(ublox_moving_base_configs) / sizeof(ublox_moving_base_configs[0]);
+    uint32_t hz = gps_rate_get_hz();
+
+    ubx_apply_nav_rate(ublox_moving_base_rate_configs, ublox_moving_base_configs, count, hz);
+    ubx_budget_fit(ublox_moving_base_rate_configs, count, hz, GPS_ID_BASE);
+    ubx_init_async_start(gps, UBX_CFG_LAYER_RAM, ublox_moving_base_rate_configs, count,
+                          on_init_complete, NULL);
 }
 
-static void on_factory_reset_complete(bool ack, void *user_data)
+static void on_factory_reset_complete(ubx_cmd_state_t result, void *user_data)
 {
+    bool ack = (result == UBX_CMD_STATE_ACK);
     gps_t *gps = (gps_t *)user_data;
     ubx_init_context_t *ctx = &gps->ubx_init_ctx;
 
@@ -473,6 +846,7 @@ typedef struct {
     ubx_cfg_item_t mode_config;          // MODE
     ubx_init_complete_callback_t user_callback;
     void* user_data;
+    bool position_ok;
     char lat_str[16];
     char lon_str[16];
     char alt_str[16];
@@ -480,8 +854,9 @@ typedef struct {
 
 static tmode_async_context_t g_tmode_ctx;
 
-static void on_mode_enable_complete(bool ack, void *user_data)
+static void on_mode_enable_complete(ubx_cmd_state_t result, void *user_data)
 {
+    bool ack = (result == UBX_CMD_STATE_ACK);
     tmode_async_context_t *ctx = (tmode_async_context_t *)user_data;
 
     if (ack) {
@@ -492,38 +867,29 @@ static void on_mode_enable_complete(bool ack, void *user_data)
     } else {
         LOG_ERR("Failed to enable fixed mode\n");
         if (ctx->user_callback) {
-            ctx->user_callback(false, 1, ctx->user_data);
+            ctx->user_callback(false, ctx->position_ok ? 1 : 0, ctx->user_data);
         }
     }
 }
 
 
-static void on_position_set_complete(bool ack, void *user_data)
+/*
+ * 위치와 모드는 한 transaction (BEGIN -> APPLY) 으로 이어 보내므로 결과는
+ * 모드 쪽 응답에서 알린다. 위치가 실패하면 transaction 이 버려져 모드도 실패한다.
+ */
+static void on_position_set_complete(ubx_cmd_state_t result, void *user_data)
 {
     tmode_async_context_t *ctx = (tmode_async_context_t *)user_data;
 
-    if (!ack) {
-        LOG_ERR("Failed to set position coordinates\n");
-        if (ctx->user_callback) {
-            ctx->user_callback(false, 0, ctx->user_data);
-        }
+    ctx->position_ok = (result == UBX_CMD_STATE_ACK);
 
+    if (!ctx->position_ok) {
+        LOG_ERR("Failed to set position coordinates\n");
         return;
     }
 
     LOG_DEBUG("Position set (lat: %s, lon: %s, alt: %s m)\n",
               ctx->lat_str, ctx->lon_str, ctx->alt_str);
-
-    bool result = ubx_send_valset_cb(ctx->gps, UBX_CFG_LAYER_RAM,
-                                     &ctx->mode_config, 1,
-                                     on_mode_enable_complete, ctx);
-
-    if (!result) {
-        LOG_ERR("Failed to send mode enable command\n");
-        if (ctx->user_callback) {
-            ctx->user_callback(false, 1, ctx->user_data);
-        }
-    }
 }
 
 
@@ -551,6 +917,7 @@ bool ubx_set_fixed_position_async(gps_t* gps, const char* lat_str, const char* l
     g_tmode_ctx.gps = gps;
     g_tmode_ctx.user_callback = callback;
     g_tmode_ctx.user_data = user_data;
+    g_tmode_ctx.position_ok = false;
 
     // 문자열 저장 (로그용)
     snprintf(g_tmode_ctx.lat_str, sizeof(g_tmode_ctx.lat_str), "%s", lat_str);
@@ -594,16 +961,25 @@ bool ubx_set_fixed_position_async(gps_t* gps, const char* lat_str, const char* l
     g_tmode_ctx.mode_config.value[0] = 2;  // Fixed mode
     g_tmode_ctx.mode_config.value_len = 1;
 
-    // STEP 1 실행: 위치 정보 전송
-    bool result = ubx_send_valset_cb(gps, UBX_CFG_LAYER_RAM,
-                                     g_tmode_ctx.position_configs, 3,
-                                     on_position_set_complete, &g_tmode_ctx);
+    // 위치와 모드를 ACK 를 기다리지 않고 이어 보냄 (모드 메시지에서 함께 적용)
+    bool result = ubx_send_valset_txn_cb(gps, UBX_CFG_LAYER_RAM, UBX_VALSET_TRANSACTION_BEGIN,
+                                         g_tmode_ctx.position_configs, 3,
+                                         on_position_set_complete, &g_tmode_ctx);
 
     if (!result) {
         LOG_ERR("Failed to send position config command\n");
         return false;
     }
 
+    result = ubx_send_valset_txn_cb(gps, UBX_CFG_LAYER_RAM, UBX_VALSET_TRANSACTION_APPLY,
+                                    &g_tmode_ctx.mode_config, 1,
+                                    on_mode_enable_complete, &g_tmode_ctx);
+
+    if (!result) {
+        LOG_ERR("Failed to send mode enable command\n");
+        return false;
+    }
+
     LOG_DEBUG("Fixed position async started\n");
 
     return true;
@@ -620,8 +996,9 @@ typedef struct {
 
 static survey_async_context_t g_survey_ctx;
 
-static void on_survey_in_complete(bool ack, void *user_data)
+static void on_survey_in_complete(ubx_cmd_state_t result, void *user_data)
 {
+    bool ack = (result == UBX_CMD_STATE_ACK);
     survey_async_context_t *ctx = (survey_async_context_t *)user_data;
 
     if (ack) {
@@ -684,3 +1061,34 @@ bool ubx_set_survey_in_mode_async(gps_t* gps, uint32_t min_duration, uint32_t ac
 
     return true;
 }
+
+static void on_meas_rate_complete(ubx_cmd_state_t result, void *user_data)
+{
+    if (result != UBX_CMD_STATE_ACK) {
+        LOG_ERR("Failed to set meas rate %u Hz\n", (unsigned)(uintptr_t)user_data);
+    }
+}
+
+/**
+ * @brief 측정 주기만 RAM 레이어에서 바꿈 (과부하 때 낮추고 되돌림)
+ *
+ * 출력 비율은 그대로라 epoch 당 메시지는 같고 epoch 수만 줄어든다. 재시작하면
+ * 설정 테이블 주기로 돌아간다.
+ */
+bool ubx_set_meas_rate_async(gps_t* gps, uint32_t hz)
+{
+    static ubx_cfg_item_t item = {.key_id = CFG_RATE_MEAS, .value_len = 2};
+    uint16_t ms = gps_rate_meas_ms(hz);
+
+    if (!gps) {
+        return false;
+    }
+
+    item.value[0] = ms & 0xFF;
+    item.value[1] = (ms >> 8) & 0xFF;
+
+    return ubx_send_valset_cb(gps, UBX_CFG_LAYER_RAM, &item, 1, on_meas_rate_complete,
+                              (void *)(uintptr_t)hz);
+}
+
+#endif
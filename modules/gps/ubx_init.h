@@ -8,6 +8,15 @@ bool ubx_rover_init(gps_t* gps);
 bool ubx_base_init(gps_t* gps);
 bool ubx_moving_base_init(gps_t* gps);
 
+/**
+ * @brief 이 보드가 id 수신기에 쓸 설정 테이블의 UART1 예상 출력 [byte/s]
+ *
+ * 메시지마다 크기 모델 (켜진 위성계와 보이는 위성 수) x 출력 주기로 센다.
+ * gps_rate 가 F9P UART1 속도를 고를 때 쓰고, 초기화 때 테이블을 보내기
+ * 전에도 같은 모델로 포트 속도와 비교해 넘치면 낮은 우선순위부터 끈다.
+ */
+uint32_t ubx_cfg_uart1_load(gps_id_t id, uint32_t hz);
+
 bool ubx_factory_reset(gps_t* gps, ubx_init_complete_callback_t callback, void *user_data);
 
 bool ubx_set_fixed_position_async(gps_t* gps, const char* lat_str, const char* lon_str,
@@ -17,4 +26,6 @@ bool ubx_set_fixed_position_async(gps_t* gps, const char* lat_str, const char* l
 bool ubx_set_survey_in_mode_async(gps_t* gps, uint32_t min_duration, uint32_t accuracy_limit,
                                    ubx_init_complete_callback_t callback, void *user_data);
 
+bool ubx_set_meas_rate_async(gps_t* gps, uint32_t hz);
+
 #endif
@@ -0,0 +1,256 @@
+#include "data_usage.h"
+#include "flash_params.h"
+#include "gps_app.h"
+#include "ntrip_app.h"
+#include "telemetry.h"
+#include "work_queue.h"
+#include <stdio.h>
+#include <string.h>
+
+#ifndef TAG
+#define TAG "DATA_USAGE"
+#endif
+
+#include "log.h"
+
+static void data_usage_work(work_t *work);
+
+static struct
+{
+  gsm_t *gsm;
+  work_t work;
+  gsm_tcp_usage_t last[GSM_TCP_MAX_SOCKETS]; // 직전에 읽은 누적값
+  lte_usage_params_t usage;                  // 저장할 값 (work 에서만 고침)
+  uint32_t carry;                            // KiB 에 못 미친 byte
+  bool dirty;
+  TickType_t saved_tick;
+  volatile uint8_t level;
+  uint32_t gga_ms; // GGA_SLOW 전 간격 (내려갈 때 되돌림)
+} g_du = {
+    .work = WORK_INIT(data_usage_work, NULL, WORK_PRIO_LOW),
+};
+
+static uint32_t du_delta(uint32_t now, uint32_t prev)
+{
+  // gsm_tcp_init 을 다시 거쳐 0 부터 세면 지금 값이 차이
+  return now >= prev ? now - prev : now;
+}
+
+/**
+ * @brief 이번 주기 사용량 [byte] (추정 헤더 포함)
+ */
+static uint32_t du_collect(void)
+{
+  uint32_t bytes = 0;
+
+  for (uint8_t cid = 0; cid < GSM_TCP_MAX_SOCKETS; cid++)
+  {
+    gsm_tcp_usage_t now;
+    gsm_tcp_usage_t *prev = &g_du.last[cid];
+
+    if (!gsm_tcp_get_usage(g_du.gsm, cid, &now))
+    {
+      continue;
+    }
+
+    uint32_t rx_segs = du_delta(now.rx_segs, prev->rx_segs);
+    uint32_t tx_segs = du_delta(now.tx_segs, prev->tx_segs);
+
+    bytes += du_delta(now.rx_bytes, prev->rx_bytes) + du_delta(now.tx_bytes, prev->tx_bytes) +
+             (rx_segs + tx_segs) * (DATA_USAGE_SEG_OVH + DATA_USAGE_ACK_OVH) +
+             du_delta(now.opens, prev->opens) * DATA_USAGE_OPEN_OVH;
+    *prev = now;
+  }
+
+  return bytes;
+}
+
+/**
+ * @brief UTC 날짜가 바뀌었으면 일/월 사용량을 새로
+ *
+ * @return true 바뀜 (바로 저장)
+ */
+static bool du_rollover(void)
+{
+  uint32_t date = gps_get_utc_date();
+  lte_usage_params_t *u = &g_du.usage;
+
+  if (date == 0 || date == u->date)
+  {
+    return false;
+  }
+
+  // 처음 날짜를 알게 된 경우는 부팅 전 사용량을 오늘/이번 달로 본다
+  if (u->date != 0)
+  {
+    if (date / 100 != u->date / 100)
+    {
+      LOG_INFO("월 사용량 %lu KiB (%lu)", u->month_kb, u->date / 100);
+      u->month_kb = 0;
+    }
+    u->day_kb = 0;
+  }
+  u->date = date;
+
+  return true;
+}
+
+static uint32_t du_budget_mb(void)
+{
+  uint32_t mb = flash_params_snapshot(NULL)->lte_budget_mb;
+
+  return mb == 0xFFFFFFFF ? 0 : mb;
+}
+
+static data_usage_level_t du_level(void)
+{
+  uint32_t mb = du_budget_mb();
+  uint32_t pct;
+
+  if (mb == 0)
+  {
+    return DATA_USAGE_NORMAL;
+  }
+
+  pct = (uint32_t)((uint64_t)g_du.usage.month_kb * 100U / ((uint64_t)mb * 1024U));
+
+  return pct >= DATA_USAGE_THIN_PCT    ? DATA_USAGE_THIN
+         : pct >= DATA_USAGE_TELEM_PCT ? DATA_USAGE_NO_TELEM
+         : pct >= DATA_USAGE_SLOW_PCT  ? DATA_USAGE_GGA_SLOW
+                                       : DATA_USAGE_NORMAL;
+}
+
+/**
+ * @brief 단계가 바뀐 만큼 동작을 켜고 끔
+ */
+static void du_apply(data_usage_level_t from, data_usage_level_t to)
+{
+  bool up = to > from;
+
+  if ((from < DATA_USAGE_GGA_SLOW) != (to < DATA_USAGE_GGA_SLOW))
+  {
+    if (up)
+    {
+      g_du.gga_ms = ntrip_get_gga_interval();
+      if (g_du.gga_ms < DATA_USAGE_GGA_SLOW_MS)
+      {
+        ntrip_set_gga_interval(DATA_USAGE_GGA_SLOW_MS);
+      }
+    }
+    else
+    {
+      ntrip_set_gga_interval(g_du.gga_ms);
+    }
+  }
+  if ((from < DATA_USAGE_NO_TELEM) != (to < DATA_USAGE_NO_TELEM))
+  {
+    telemetry_set_paused(up);
+  }
+  if ((from < DATA_USAGE_THIN) != (to < DATA_USAGE_THIN))
+  {
+    ntrip_set_thin(up);
+  }
+}
+
+static void data_usage_work(work_t *work)
+{
+  lte_usage_params_t *u = &g_du.usage;
+  uint32_t bytes = du_collect() + g_du.carry;
+  uint32_t kb = bytes / 1024U;
+  bool now_save = du_rollover();
+  TickType_t now = xTaskGetTickCount();
+  data_usage_level_t level;
+
+  g_du.carry = bytes % 1024U;
+  if (kb)
+  {
+    u->day_kb += kb;
+    u->month_kb += kb;
+    u->total_kb += kb;
+    g_du.dirty = true;
+  }
+
+  level = du_level();
+  if (level != g_du.level)
+  {
+    LOG_WARN("데이터 한도 단계 %u -> %u (이번 달 %lu KiB / %lu MiB)", g_du.level, level,
+             u->month_kb, du_budget_mb());
+    du_apply((data_usage_level_t)g_du.level, level);
+    g_du.level = level;
+  }
+
+  if (now_save ||
+      (g_du.dirty && now - g_du.saved_tick >= pdMS_TO_TICKS(DATA_USAGE_SAVE_MS)))
+  {
+    flash_params_set_lte_usage(u);
+    flash_params_save_async();
+    g_du.dirty = false;
+    g_du.saved_tick = now;
+  }
+
+  work_submit_delayed(work, DATA_USAGE_PERIOD_MS);
+}
+
+void data_usage_start(gsm_t *gsm)
+{
+  if (g_du.gsm)
+  {
+    return; // 이미 세는 중 (LTE 재초기화)
+  }
+
+  g_du.usage = flash_params_snapshot(NULL)->lte_usage;
+  // 이전 버전 flash 는 0xFF 로 남아 있음
+  if (g_du.usage.date == 0xFFFFFFFF)
+  {
+    memset(&g_du.usage, 0, sizeof(g_du.usage));
+  }
+
+  for (uint8_t cid = 0; cid < GSM_TCP_MAX_SOCKETS; cid++)
+  {
+    gsm_tcp_get_usage(gsm, cid, &g_du.last[cid]);
+  }
+  g_du.saved_tick = xTaskGetTickCount();
+  g_du.gsm = gsm;
+
+  work_submit_delayed(&g_du.work, DATA_USAGE_PERIOD_MS);
+}
+
+data_usage_level_t data_usage_get_level(void)
+{
+  return (data_usage_level_t)g_du.level;
+}
+
+size_t data_usage_format(char *buf, size_t size)
+{
+  lte_usage_params_t u = g_du.usage;
+  size_t pos = 0;
+  int n;
+
+  n = snprintf(buf, size, "+DU,day=%lu,month=%lu,total=%lu,budget=%lu,lv=%u,date=%lu\n\r",
+               u.day_kb, u.month_kb, u.total_kb, du_budget_mb(), g_du.level, u.date);
+  if (n < 0 || (size_t)n >= size)
+  {
+    return 0;
+  }
+  pos = n;
+
+  for (uint8_t cid = 0; g_du.gsm && cid < GSM_TCP_MAX_SOCKETS; cid++)
+  {
+    gsm_tcp_usage_t s;
+
+    if (!gsm_tcp_get_usage(g_du.gsm, cid, &s) || s.rx_bytes + s.tx_bytes == 0)
+    {
+      continue;
+    }
+
+    n = snprintf(&buf[pos], size - pos, "+DU,%u,rx=%lu,tx=%lu,open=%lu\n\r", cid, s.rx_bytes,
+                 s.tx_bytes, s.opens);
+    if (n < 0 || (size_t)n >= size - pos)
+    {
+      return 0;
+    }
+    pos += n;
+  }
+
+  return pos;
+}
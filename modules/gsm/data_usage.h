@@ -0,0 +1,55 @@
+#ifndef DATA_USAGE_H
+#define DATA_USAGE_H
+
+#include "gsm.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief LTE 데이터 사용량 집계와 월 한도 정책
+ *
+ * 소켓별 누적 payload (gsm_tcp_get_usage) 를 주기적으로 읽어 차이에 추정
+ * IP/TCP 헤더 (조각마다 헤더 + 상대 쪽 ACK, 연결마다 핸드셰이크/종료) 를
+ * 더해 일/월/전체 사용량으로 쌓고, params 로 저장해 재부팅해도 이어 센다.
+ * 날짜는 GPS UTC 라 아직 모르면 바뀐 것으로 보지 않는다.
+ *
+ * lte_budget_mb 가 있으면 월 사용량 비율에 따라 단계가 오르며 아래 동작이
+ * 쌓인다. 새 달이 되거나 한도를 늘리면 내려간다.
+ */
+typedef enum
+{
+  DATA_USAGE_NORMAL = 0,
+  DATA_USAGE_GGA_SLOW, /**< DATA_USAGE_SLOW_PCT: GGA 업로드 간격을 DATA_USAGE_GGA_SLOW_MS 로 */
+  DATA_USAGE_NO_TELEM, /**< DATA_USAGE_TELEM_PCT: telemetry 멈춤 */
+  DATA_USAGE_THIN,     /**< DATA_USAGE_THIN_PCT: 주 캐스터를 가벼운 마운트포인트로 */
+} data_usage_level_t;
+
+#define DATA_USAGE_PERIOD_MS 10000
+#define DATA_USAGE_SAVE_MS (30U * 60U * 1000U) // 바뀌었으면 이 간격으로 저장 (날짜가 바뀌면 바로)
+#define DATA_USAGE_SEG_OVH 40   // 조각마다 IPv4 + TCP 헤더 [byte]
+#define DATA_USAGE_ACK_OVH 20   // 상대 조각마다 ACK (delayed ACK 로 두 개에 하나)
+#define DATA_USAGE_OPEN_OVH 400 // 연결마다 SYN/FIN 교환
+#define DATA_USAGE_SLOW_PCT 70
+#define DATA_USAGE_TELEM_PCT 85
+#define DATA_USAGE_THIN_PCT 95
+#define DATA_USAGE_GGA_SLOW_MS 10000
+
+/**
+ * @brief 집계 시작 (LTE 초기화가 끝날 때마다 불러도 됨)
+ */
+void data_usage_start(gsm_t *gsm);
+
+data_usage_level_t data_usage_get_level(void);
+
+/**
+ * @brief 사용량 문자열
+ *
+ * +DU,day=<KiB>,month=<KiB>,total=<KiB>,budget=<MiB>,lv=<단계>,date=<yyyymmdd>
+ * 다음에 센 적이 있는 소켓마다 +DU,<cid>,rx=,tx=,open= (payload byte, 부팅 이후)
+ *
+ * @return size_t 길이, 버퍼 부족이면 0
+ */
+size_t data_usage_format(char *buf, size_t size);
+
+#endif
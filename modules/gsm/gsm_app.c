@@ -2,10 +2,22 @@
 #include "FreeRTOS.h"
 #include "gsm.h"
 #include "gsm_port.h"
+#include "heap_track.h"
+#include "mem_watermark.h"
+#include "board_config.h"
+#include "data_usage.h"
 #include "led.h"
 #include "lte_init.h"
 #include "ntrip_app.h"
+#include "ntrip_server.h"
+#include "telemetry.h"
 #include "timers.h"
+#include "irq_latency.h"
+#include "dma_ring.h"
+#include "work_queue.h"
+#if GSM_PPP_ENABLE
+#include "gsm_ppp.h"
+#endif
 #include <string.h>
 
 #define TAG "GSM"
@@ -14,14 +26,18 @@
 
 void gsm_socket_monitor_start(void);
 
-char gsm_mem[2048];
+char gsm_mem[GSM_RX_RING_SIZE];
 
 gsm_t gsm_handle;
 QueueHandle_t gsm_queue;
 static bool gsm_task_created = false;
 
+/* 깨어날 때 링에 쌓여 있던 byte */
+static mem_wm_t gsm_rx_wm = MEM_WM_INIT("gsm_rx", GSM_RX_RING_SIZE);
+
 void gsm_socket_monitor_stop(void);
 void gsm_socket_update_recv_time(uint8_t connect_id);
+static void gsm_socket_forget(uint8_t connect_id);
 
 static void gsm_process_task(void *pvParameter);
 static void gsm_at_cmd_process_task(void *pvParameters);
@@ -34,7 +50,8 @@ static bool ntrip_should_restart = false;
  */
 void gsm_task_create(void *arg) {
   if (!gsm_task_created) {
-    xTaskCreate(gsm_process_task, "gsm", 1536, arg, tskIDLE_PRIORITY + 1, NULL);
+    HEAP_TRACK(HEAP_TAG_TASK, xTaskCreate(gsm_process_task, "gsm", 1536, arg,
+                                          tskIDLE_PRIORITY + 1, NULL));
     gsm_task_created = true;
   }
 }
@@ -62,6 +79,57 @@ void gsm_start_rover(void) {
 
 static TaskHandle_t ntrip_task_handle = NULL;
 
+bool gsm_start_ntrip_server(void) {
+  return ntrip_server_start(&gsm_handle);
+}
+
+/**
+ * @brief 데이터 경로가 열린 뒤 NTRIP/원격 모니터링 시작
+ */
+static void gsm_app_start(void) {
+  if (ntrip_server_is_running()) {
+    // 고정 좌표 base 의 캐스터 업로드: 업로드 태스크가 알아서 다시 붙는다
+    ntrip_should_restart = false;
+    LOG_INFO("NTRIP server 유지");
+  } else if (!ntrip_should_restart) {
+    ntrip_task_create(&gsm_handle);
+  } else {
+    // 재시작 플래그가 설정된 경우
+    ntrip_should_restart = false;
+    ntrip_task_create(&gsm_handle);
+    led_set_color(LED_ID_1, LED_COLOR_GREEN);
+    LOG_INFO("NTRIP 태스크 재생성 완료");
+  }
+  // 원격 모니터링: 한 번 시작하면 태스크가 알아서 다시 붙는다
+  if (telemetry_configured()) {
+    telemetry_start(&gsm_handle);
+  }
+  data_usage_start(&gsm_handle);
+}
+
+#if GSM_PPP_ENABLE
+#define GSM_PPP_REDIAL_MS 5000 // ATD 실패 뒤 다시 걸 때까지
+
+static void gsm_ppp_redial(work_t *work);
+static work_t gsm_ppp_redial_work =
+    WORK_INIT(gsm_ppp_redial, NULL, WORK_PRIO_LOW);
+
+static void gsm_ppp_dial_callback(gsm_t *gsm, gsm_cmd_t cmd, void *msg,
+                                  bool is_ok) {
+  if (!is_ok) {
+    LOG_ERR("PPP 호출 실패, %dms 뒤 재시도", GSM_PPP_REDIAL_MS);
+    work_submit_delayed(&gsm_ppp_redial_work, GSM_PPP_REDIAL_MS);
+  }
+}
+
+static void gsm_ppp_redial(work_t *work) {
+  if (gsm_port_get_airplane_mode() || gsm_ppp_is_up()) {
+    return;
+  }
+  gsm_ppp_dial(&gsm_handle, gsm_ppp_dial_callback);
+}
+#endif
+
 
 static void gsm_evt_handler(gsm_evt_t evt, void *args) {
   switch (evt) {
@@ -86,19 +154,24 @@ static void gsm_evt_handler(gsm_evt_t evt, void *args) {
 
   case GSM_EVT_INIT_OK: {
     LOG_INFO("LTE 초기화 성공");
-    // 여기서 추가 작업 수행 가능 (예: TCP 연결 등)
-    if (!ntrip_should_restart) {
-      ntrip_task_create(&gsm_handle);
-    } else {
-      // 재시작 플래그가 설정된 경우
-      ntrip_should_restart = false;
-      ntrip_task_create(&gsm_handle);
-      led_set_color(LED_ID_1, LED_COLOR_GREEN);
-      LOG_INFO("NTRIP 태스크 재생성 완료");
-    }
+#if GSM_PPP_ENABLE
+    // 소켓은 PPP 위에서 열린다 (QISTATE 감시는 모뎀 소켓 전용)
+    work_cancel(&gsm_ppp_redial_work);
+    gsm_ppp_dial(&gsm_handle, gsm_ppp_dial_callback);
+#else
+    gsm_socket_monitor_start();
+    gsm_app_start();
+#endif
     break;
   }
 
+#if GSM_PPP_ENABLE
+  case GSM_EVT_PPP_UP:
+    LOG_INFO("PPP 링크 열림");
+    gsm_app_start();
+    break;
+#endif
+
   case GSM_EVT_INIT_FAIL: {
     LOG_ERR("LTE 초기화 실패");
     led_set_color(LED_ID_1, LED_COLOR_RED);
@@ -106,9 +179,16 @@ static void gsm_evt_handler(gsm_evt_t evt, void *args) {
     break;
   }
 
+  case GSM_EVT_TCP_DATA_RECV:
+    if (args) {
+      gsm_socket_update_recv_time(*(uint8_t *)args);
+    }
+    break;
+
   case GSM_EVT_TCP_CLOSED:
     uint8_t connect_id = args ? *(uint8_t *)args : 0;
     LOG_WARN("TCP 연결 종료 (connect_id=%d)", connect_id);
+    gsm_socket_forget(connect_id);
 
     // NTRIP 소켓이 닫힌 경우 LED 노란색
     if (connect_id == 0) { // NTRIP_CONNECT_ID
@@ -119,6 +199,13 @@ static void gsm_evt_handler(gsm_evt_t evt, void *args) {
   case GSM_EVT_PDP_DEACT:
     uint8_t context_id = args ? *(uint8_t *)args : 0;
     LOG_ERR("PDP context 비활성화 (context_id=%d)", context_id);
+#if GSM_PPP_ENABLE
+    work_cancel(&gsm_ppp_redial_work);
+#endif
+
+    for (uint8_t i = 0; i < GSM_TCP_MAX_SOCKETS; i++) {
+      gsm_socket_forget(i);
+    }
 
     if (gsm_port_get_airplane_mode()) {
       LOG_INFO("Airplane 모드 활성화 중 - 재연결 로직 실행 안 함");
@@ -152,65 +239,69 @@ static void gsm_evt_handler(gsm_evt_t evt, void *args) {
  * @param pvParameter
  */
 static void gsm_process_task(void *pvParameter) {
-  size_t pos = 0;
-  size_t old_pos = 0;
+  dma_ring_t ring;
   uint8_t dummy = 0;
-  size_t total_received = 0;
 
-  gsm_queue = xQueueCreate(10, 1);
+  gsm_queue = mem_wm_register_queue(xQueueCreate(10, 1), "gsm_queue");
+  mem_wm_register(&gsm_rx_wm);
 
   // 네트워크 체크 타이머 생성 (한 번만, 재사용)
   TimerHandle_t network_timer =
       xTimerCreate("lte_net_chk", pdMS_TO_TICKS(LTE_NETWORK_CHECK_INTERVAL_MS),
                    pdFALSE, // one-shot
-                   NULL, lte_network_check_timer_callback);
+                   &lte_network_check_work, work_timer_callback);
+
+  static const uint32_t lte_bauds[] = LTE_UART_BAUD_LIST;
+  uint32_t warm_baud;
 
   gsm_init(&gsm_handle, gsm_evt_handler, NULL);
+  mem_wm_register_queue(gsm_handle.at_cmd_queue[GSM_AT_LANE_DATA], "gsm_at_data");
+  mem_wm_register_queue(gsm_handle.at_cmd_queue[GSM_AT_LANE_CTRL], "gsm_at_ctrl");
+  mem_wm_register_queue(gsm_handle.tcp.event_queue, "gsm_tcp_evt");
   gsm_port_init();
-  gsm_start();
+  warm_baud = gsm_start(lte_bauds, sizeof(lte_bauds) / sizeof(lte_bauds[0]));
+
+  // 부팅 확인용 AT 응답은 파서에 넘기지 않는다 (다음 명령의 응답으로 오인)
+  dma_ring_init(&ring, gsm_mem, sizeof(gsm_mem), 0, gsm_get_rx_count());
 
   // LTE 초기화 모듈 설정
   lte_set_gsm_handle(&gsm_handle);
   lte_set_network_check_timer(network_timer);
 
   // AT 커맨드 처리 태스크 생성
-  xTaskCreate(gsm_at_cmd_process_task, "gsm_at_cmd", 1536, &gsm_handle,
-              tskIDLE_PRIORITY + 2, NULL);
+  HEAP_TRACK(HEAP_TAG_TASK, xTaskCreate(gsm_at_cmd_process_task, "gsm_at_cmd", 1536,
+                                        &gsm_handle, tskIDLE_PRIORITY + 2, NULL));
+
+  if (warm_baud != 0) {
+    // 모뎀이 이미 켜져 있어 RDY 가 오지 않음
+    lte_init_start_warm(warm_baud);
+  }
 
   led_set_color(LED_ID_1, LED_COLOR_RED);
   led_set_state(LED_ID_1, true);
 
   while (1) {
     xQueueReceive(gsm_queue, &dummy, portMAX_DELAY);
+    irq_lat_task(IRQ_LAT_GSM);
     led_set_toggle(LED_ID_1);
-    pos = gsm_get_rx_pos();
-
-    if (pos != old_pos) {
-      if (pos > old_pos) {
-        size_t len = pos - old_pos;
-        total_received = len;
-        LOG_DEBUG("RX: %u bytes", len);
-//        LOG_DEBUG_RAW("RAW: ", &gsm_mem[old_pos], len);
-        gsm_parse_process(&gsm_handle, &gsm_mem[old_pos], pos - old_pos);
-      } else {
-        size_t len1 = sizeof(gsm_mem) - old_pos;
-        size_t len2 = pos;
-        total_received = len1 + len2;
-        LOG_DEBUG("RX: %u bytes (wrapped: %u+%u)", total_received, len1, len2);
-
-//        LOG_DEBUG_RAW("RAW: ", &gsm_mem[old_pos], len1);
-        gsm_parse_process(&gsm_handle, &gsm_mem[old_pos],
-                          sizeof(gsm_mem) - old_pos);
-        if (pos > 0) {
-//          LOG_DEBUG_RAW("RAW: ", gsm_mem, len2);
-
-          gsm_parse_process(&gsm_handle, gsm_mem, pos);
-        }
-      }
-      old_pos = pos;
-      if (old_pos == sizeof(gsm_mem)) {
-        old_pos = 0;
+    uint32_t lost;
+    uint32_t pending = dma_ring_update(&ring, gsm_get_rx_count(), &lost);
+
+    if (lost) {
+      LOG_WARN("RX ring overrun, %lu bytes lost", lost);
+    }
+
+    if (pending > 0) {
+      dma_ring_span_t span[2];
+      uint8_t n = dma_ring_spans(&ring, span);
+
+      LOG_DEBUG("RX: %lu bytes (%u spans)", pending, n);
+      for (uint8_t i = 0; i < n; i++) {
+//        LOG_DEBUG_RAW("RAW: ", span[i].p, span[i].len);
+        gsm_parse_process(&gsm_handle, span[i].p, span[i].len);
       }
+      mem_wm_update(&gsm_rx_wm, pending + lost < ring.size ? pending + lost : ring.size);
+      dma_ring_consume(&ring, pending);
     }
   }
 
@@ -222,7 +313,7 @@ static void gsm_at_cmd_process_task(void *pvParameters) {
   gsm_at_cmd_t at_cmd;
 
   while (1) {
-    if (xQueueReceive(gsm->at_cmd_queue, &at_cmd, portMAX_DELAY) == pdTRUE) {
+    if (gsm_at_cmd_receive(gsm, &at_cmd, portMAX_DELAY)) {
       // 1. 수신 받은 커맨드가 정상인지 확인
       if ((at_cmd.cmd >= GSM_CMD_MAX) || (at_cmd.cmd == GSM_CMD_NONE)) {
         if (at_cmd.sem != NULL) {
@@ -233,6 +324,11 @@ static void gsm_at_cmd_process_task(void *pvParameters) {
         continue;
       }
 
+      // 비동기 QISEND 는 지금 대기열에 쌓인 쓰기를 묶어 길이를 정한다
+      if (!gsm_at_cmd_prepare(gsm, &at_cmd)) {
+        continue;
+      }
+
       // 2. current_cmd 설정 (스택 변수를 직접 가리킴)
       // ★ 중요: AT 명령 전송 전에 current_cmd를 먼저 설정해야 함
       //          빠른 응답 수신 시 current_cmd가 NULL이면 응답을 놓칠 수 있음
@@ -271,17 +367,18 @@ static void gsm_at_cmd_process_task(void *pvParameters) {
         break;
       }
 
-      gsm->ops->send(gsm->at_tbl[at_cmd.cmd].at_str,
-                     strlen(gsm->at_tbl[at_cmd.cmd].at_str));
+      // CMUX 중이면 at_cmd.dlc 채널로 (transparent QIOPEN 은 데이터 채널)
+      gsm_at_send(gsm, &at_cmd, gsm->at_tbl[at_cmd.cmd].at_str,
+                  strlen(gsm->at_tbl[at_cmd.cmd].at_str));
 
       if (at_mode != NULL) {
-        gsm->ops->send(at_mode, strlen(at_mode));
+        gsm_at_send(gsm, &at_cmd, at_mode, strlen(at_mode));
       }
 
       if (at_cmd.params[0] != '\0') {
-        gsm->ops->send(at_cmd.params, strlen(at_cmd.params));
+        gsm_at_send(gsm, &at_cmd, at_cmd.params, strlen(at_cmd.params));
       }
-      gsm->ops->send("\r\n", 2);
+      gsm_at_send(gsm, &at_cmd, "\r\n", 2);
 
       uint32_t timeout_ms = gsm->at_tbl[at_cmd.cmd].timeout_ms;
       if (timeout_ms == 0) {
@@ -318,9 +415,16 @@ static void gsm_at_cmd_process_task(void *pvParameters) {
             if (at_cmd.tx_pbuf) {
               tcp_pbuf_free(at_cmd.tx_pbuf);
             }
+          } else {
+            // 그 사이 OK/ERROR 로 끝났으면 완료 처리도 거기서 했다
+            at_cmd.tx_batch = 0;
           }
           xSemaphoreGive(gsm->cmd_mutex);
         }
+
+        if (at_cmd.tx_batch) {
+          gsm_tcp_tx_complete(gsm, at_cmd.tx_cid, at_cmd.tx_batch, false);
+        }
       }
 
       // 응답 완료 (또는 타임아웃)
@@ -331,20 +435,34 @@ static void gsm_at_cmd_process_task(void *pvParameters) {
   vTaskDelete(NULL);
 }
 
-// 소켓 상태 모니터링 (AT 커맨드 동작 확인 + 소켓 상태)
+// 소켓 상태 모니터링 (수신이 끊긴 소켓만 QISTATE 로 확인)
+//
+// 종료는 +QIURC: "closed" / "pdpdeact" 로 먼저 알 수 있으므로 주기 폴링은
+// 하지 않는다. 수신 때마다 시각만 남기고, 타이머는 가장 먼저 침묵 시간이
+// 차는 소켓 기준으로 한 번만 울린다.
 
 //=============================================================================
 
-#define SOCKET_STATE_CHECK_INTERVAL_MS 10000 // 10초마다 상태 확인
+#define SOCKET_SILENCE_DEFAULT_MS 10000 // 이 시간 수신이 없으면 QISTATE 확인
 
 static TimerHandle_t socket_state_timer = NULL;
 
-static TickType_t last_recv_tick[GSM_TCP_MAX_SOCKETS] = {0};
+// QISTATE 요청은 AT 큐에 넣다가 막힐 수 있어 timer 태스크 대신 워커에서
+static void socket_state_check(work_t *work);
+static work_t socket_state_work = WORK_INIT(socket_state_check, NULL, WORK_PRIO_LOW);
+
+static TickType_t last_recv_tick[GSM_TCP_MAX_SOCKETS] = {0}; // 0: 감시 안 함
+
+static uint32_t socket_silence_ms = SOCKET_SILENCE_DEFAULT_MS;
+
+static volatile int8_t qistate_probe_cid = -1; // 응답 대기 중인 소켓
 
 static TickType_t last_qistate_request_tick = 0; // 요청 시간 기록
 
 static uint32_t qistate_timeout_count = 0; // 연속 타임아웃 횟수
 
+static void socket_state_timer_arm(void);
+
 // 소켓 상태 문자열 변환
 
 static const char *socket_state_to_str(uint8_t state) {
@@ -377,10 +495,13 @@ static void socket_state_check_callback(gsm_t *gsm, gsm_cmd_t cmd, void *msg,
                                         bool is_ok) {
 
   TickType_t now = xTaskGetTickCount();
+  int8_t cid = qistate_probe_cid;
 
   uint32_t response_time_ms =
       (now - last_qistate_request_tick) * portTICK_PERIOD_MS;
 
+  qistate_probe_cid = -1;
+
   if (!is_ok) {
 
     qistate_timeout_count++;
@@ -394,6 +515,7 @@ static void socket_state_check_callback(gsm_t *gsm, gsm_cmd_t cmd, void *msg,
       LOG_ERR("🚨 AT 커맨드 3회 연속 실패 - 시스템 점검 필요!");
     }
 
+    socket_state_timer_arm();
     return;
   }
 
@@ -403,57 +525,104 @@ static void socket_state_check_callback(gsm_t *gsm, gsm_cmd_t cmd, void *msg,
 
   LOG_INFO("✅ AT 응답 정상 (응답시간: %lums)", response_time_ms);
 
-  if (!msg || cmd != GSM_CMD_QISTATE) {
-
-    LOG_INFO("   소켓 상태: 활성 소켓 없음");
-
+  if (cid < 0) {
+    socket_state_timer_arm();
     return;
   }
 
   gsm_msg_t *m = (gsm_msg_t *)msg;
+  gsm_tcp_socket_t *sock = gsm_tcp_get_socket(gsm, (uint8_t)cid);
 
-  LOG_INFO("   [소켓 %d] %s | %s:%d | 상태: %s",
+  if (!m || m->qistate.service_type[0] == '\0') {
+    // +QISTATE 줄이 없음: 모뎀에는 소켓이 없다
+    LOG_WARN("   [소켓 %d] 모뎀에 없음 (closed URC 누락)", cid);
+  } else {
+    LOG_INFO("   [소켓 %d] %s | %s:%d | 상태: %s",
 
-           m->qistate.connect_id,
+             m->qistate.connect_id,
 
-           m->qistate.service_type,
+             m->qistate.service_type,
 
-           m->qistate.remote_ip,
+             m->qistate.remote_ip,
 
-           m->qistate.remote_port,
+             m->qistate.remote_port,
 
-           socket_state_to_str(m->qistate.socket_state));
+             socket_state_to_str(m->qistate.socket_state));
+  }
 
-  // 마지막 수신 시간 확인
+  if (sock && sock->state == GSM_TCP_STATE_CONNECTED &&
+      (m == NULL || m->qistate.service_type[0] == '\0' ||
+       m->qistate.socket_state > 2)) {
+    // 호스트는 연결로 알고 있는데 모뎀은 닫힘 → closed URC 와 같은 경로로 정리
+    last_recv_tick[cid] = 0;
+    gsm_tcp_notify_closed(gsm, (uint8_t)cid);
+  } else if (last_recv_tick[cid] != 0) {
+    // 연결은 살아 있고 데이터만 없음: 다음 침묵 구간 뒤 다시 확인
+    LOG_WARN("   ⚠️ %lu초 이상 데이터 수신 없음",
+             (unsigned long)((now - last_recv_tick[cid]) * portTICK_PERIOD_MS / 1000));
+    last_recv_tick[cid] = now;
+  }
 
-  uint8_t cid = m->qistate.connect_id;
+  socket_state_timer_arm();
+}
 
-  if (cid < GSM_TCP_MAX_SOCKETS && last_recv_tick[cid] != 0) {
+// 가장 먼저 침묵 시간이 차는 소켓 기준으로 타이머 설정
 
-    uint32_t elapsed_ms = (now - last_recv_tick[cid]) * portTICK_PERIOD_MS;
+static void socket_state_timer_arm(void) {
+  TickType_t now = xTaskGetTickCount();
+  TickType_t silence = pdMS_TO_TICKS(socket_silence_ms);
+  TickType_t next = portMAX_DELAY;
 
-    LOG_INFO("   마지막 데이터 수신: %lu초 전", elapsed_ms / 1000);
+  if (socket_state_timer == NULL) {
+    return;
+  }
 
-    // 경고: 30초 이상 데이터 없음
+  for (uint8_t i = 0; i < GSM_TCP_MAX_SOCKETS; i++) {
+    if (last_recv_tick[i] == 0) {
+      continue;
+    }
 
-    if (elapsed_ms > 30000 && m->qistate.socket_state == 2) {
+    TickType_t elapsed = now - last_recv_tick[i];
+    TickType_t remain = elapsed < silence ? silence - elapsed : 1;
 
-      LOG_WARN("   ⚠️ 30초 이상 데이터 수신 없음!");
+    if (remain < next) {
+      next = remain;
     }
   }
+
+  if (next == portMAX_DELAY) {
+    xTimerStop(socket_state_timer, 0);
+    return;
+  }
+
+  xTimerChangePeriod(socket_state_timer, next, 0);
 }
 
-// 타이머 콜백 - 소켓 상태 확인 요청
+// 타이머 만료 후 워커 - 침묵 시간이 찬 소켓만 상태 확인 요청
+
+static void socket_state_check(work_t *work) {
+  (void)work;
 
-static void socket_state_timer_callback(TimerHandle_t xTimer) {
+  TickType_t now = xTaskGetTickCount();
+  TickType_t silence = pdMS_TO_TICKS(socket_silence_ms);
+
+  if (qistate_probe_cid >= 0) {
+    return; // 응답 콜백에서 다시 설정
+  }
 
-  last_qistate_request_tick = xTaskGetTickCount();
+  for (uint8_t i = 0; i < GSM_TCP_MAX_SOCKETS; i++) {
+    if (last_recv_tick[i] != 0 && (now - last_recv_tick[i]) >= silence) {
+      qistate_probe_cid = (int8_t)i;
+      last_qistate_request_tick = now;
 
-  LOG_DEBUG("📡 AT+QISTATE 요청 전송...");
+      LOG_DEBUG("📡 AT+QISTATE 요청 전송 (소켓 %d 침묵)", i);
 
-  // 비동기로 상태 확인 (connect_id=0 기준)
+      gsm_send_at_qistate(&gsm_handle, 1, i, socket_state_check_callback);
+      return;
+    }
+  }
 
-  gsm_send_at_qistate(&gsm_handle, 1, 0, socket_state_check_callback);
+  socket_state_timer_arm();
 }
 
 // 소켓 상태 모니터링 시작
@@ -466,13 +635,11 @@ void gsm_socket_monitor_start(void) {
 
         "sock_mon",
 
-        pdMS_TO_TICKS(SOCKET_STATE_CHECK_INTERVAL_MS),
-
-        pdTRUE, // auto-reload
+        pdMS_TO_TICKS(socket_silence_ms),
 
-        NULL,
+        pdFALSE, // one-shot, 매번 다시 설정
 
-        socket_state_timer_callback
+        &socket_state_work, work_timer_callback
 
     );
   }
@@ -481,10 +648,9 @@ void gsm_socket_monitor_start(void) {
 
     qistate_timeout_count = 0;
 
-    xTimerStart(socket_state_timer, 0);
+    socket_state_timer_arm();
 
-    LOG_INFO("소켓 상태 모니터링 시작 (주기: %dms)",
-             SOCKET_STATE_CHECK_INTERVAL_MS);
+    LOG_INFO("소켓 상태 모니터링 시작 (침묵 기준: %lums)", socket_silence_ms);
   }
 }
 
@@ -495,21 +661,48 @@ void gsm_socket_monitor_stop(void) {
   if (socket_state_timer != NULL) {
 
     xTimerStop(socket_state_timer, 0);
+    work_cancel(&socket_state_work);
 
     LOG_INFO("소켓 상태 모니터링 중지");
   }
 }
 
-// 수신 시간 업데이트 (외부에서 호출)
+// 침묵 기준 시간 변경
+
+void gsm_socket_monitor_set_silence(uint32_t silence_ms) {
+  if (silence_ms == 0) {
+    return;
+  }
+
+  socket_silence_ms = silence_ms;
+  socket_state_timer_arm();
+}
+
+// 수신 시간 업데이트 (수신 URC 마다 호출)
 
 void gsm_socket_update_recv_time(uint8_t connect_id) {
 
   if (connect_id < GSM_TCP_MAX_SOCKETS) {
+    bool first = last_recv_tick[connect_id] == 0;
+    TickType_t now = xTaskGetTickCount();
+
+    // tick 0 은 "감시 안 함" 표시라 피한다
+    last_recv_tick[connect_id] = now ? now : 1;
 
-    last_recv_tick[connect_id] = xTaskGetTickCount();
+    // 처음 감시하는 소켓만 타이머를 건드린다 (그 외는 만료 시 다시 계산)
+    if (first) {
+      socket_state_timer_arm();
+    }
   }
 }
 
+// 소켓 감시 해제 (closed / pdpdeact)
+
+static void gsm_socket_forget(uint8_t connect_id) {
+  if (connect_id < GSM_TCP_MAX_SOCKETS) {
+    last_recv_tick[connect_id] = 0;
+  }
+}
 
 void gsm_at_power_off(uint8_t mode)
 {
@@ -4,11 +4,31 @@
 #include "FreeRTOS.h"
 #include "queue.h"
 #include "task.h"
+#include <stdbool.h>
 
 extern QueueHandle_t gsm_queue;
 
 void gsm_task_create(void *arg);
 void gsm_socket_monitor_start(void);
+void gsm_socket_monitor_stop(void);
+
+/**
+ * @brief 소켓 침묵 기준 시간 설정
+ *
+ * 수신이 이 시간 동안 없을 때만 AT+QISTATE 로 소켓을 확인한다.
+ *
+ * @param silence_ms 침묵 기준 (ms, 0 이면 무시)
+ */
+void gsm_socket_monitor_set_silence(uint32_t silence_ms);
 void gsm_start_rover(void);
+
+/**
+ * @brief NTRIP server (캐스터 업로드) 시작, LTE 가 올라와 있어야 함
+ *
+ * 시작한 뒤에는 LTE 가 다시 초기화돼도 NTRIP client 대신 이것을 유지한다.
+ *
+ * @return false 업로드 설정 없음 또는 태스크 생성 실패
+ */
+bool gsm_start_ntrip_server(void);
 void gsm_at_power_off(uint8_t mode);
 #endif
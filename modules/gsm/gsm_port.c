@@ -1,5 +1,6 @@
 #include "gsm_port.h"
 #include "FreeRTOS.h"
+#include "board_config.h"
 #include "stm32f4xx_hal.h"
 #include "stm32f4xx_ll_bus.h"
 #include "stm32f4xx_ll_cortex.h"
@@ -11,10 +12,16 @@
 #include "stm32f4xx_ll_usart.h"
 #include "stm32f4xx_ll_utils.h"
 #include "task.h"
+#include "uart_tx.h"
+#include "irq_latency.h"
+#include "dma_ring.h"
+#include "gsm.h"
 
 #define GSM_PORT_UART USART1
 #define GSM_PORT_UART_DMA DMA2
 #define GSM_PORT_UART_DMA_STREAM LL_DMA_STREAM_2
+#define GSM_PORT_UART_BAUD_DEFAULT 115200 // EC25 전원 인가/리셋 직후 속도
+#define GSM_PORT_PROBE_WAIT_MS 100         // 부팅 시 AT 응답 대기
 
 #define GSM_PORT_GPIO_PORT GPIOB
 #define GSM_PORT_GPIO_PWR_PIN GPIO_PIN_3
@@ -22,7 +29,10 @@
 #define GSM_PORT_GPIO_AIRPLANE_PIN GPIO_PIN_5
 #define GSM_PORT_GPIO_WAKEUP_PIN GPIO_PIN_6
 
-extern char gsm_mem[2048];
+extern char gsm_mem[GSM_RX_RING_SIZE];
+static volatile uint32_t gsm_rx_laps; // RX DMA TC 횟수 (gsm_get_rx_count)
+
+static uart_tx_t gsm_uart_tx;
 
 /**
  * Enable DMA controller clock
@@ -33,8 +43,7 @@ void gsm_dma_init(void) {
   __HAL_RCC_DMA2_CLK_ENABLE();
 
   /* DMA2_Stream2_IRQn interrupt configuration */
-  NVIC_SetPriority(DMA2_Stream2_IRQn,
-                   NVIC_EncodePriority(NVIC_GetPriorityGrouping(), 5, 0));
+  NVIC_SetPriority(DMA2_Stream2_IRQn, UART_NVIC_PRIO(GSM_RX_IRQ_PRIO));
   NVIC_EnableIRQ(DMA2_Stream2_IRQn);
 }
 
@@ -72,7 +81,7 @@ void gsm_uart_init(void) {
   LL_DMA_SetDataTransferDirection(DMA2, LL_DMA_STREAM_2,
                                   LL_DMA_DIRECTION_PERIPH_TO_MEMORY);
 
-  LL_DMA_SetStreamPriorityLevel(DMA2, LL_DMA_STREAM_2, LL_DMA_PRIORITY_LOW);
+  LL_DMA_SetStreamPriorityLevel(DMA2, LL_DMA_STREAM_2, UART_DMA_PRIO(GSM_RX_DMA_PRIO));
 
   LL_DMA_SetMode(DMA2, LL_DMA_STREAM_2, LL_DMA_MODE_CIRCULAR);
 
@@ -87,14 +96,13 @@ void gsm_uart_init(void) {
   LL_DMA_DisableFifoMode(DMA2, LL_DMA_STREAM_2);
 
   /* USART1 interrupt Init */
-  NVIC_SetPriority(USART1_IRQn,
-                   NVIC_EncodePriority(NVIC_GetPriorityGrouping(), 5, 0));
+  NVIC_SetPriority(USART1_IRQn, UART_NVIC_PRIO(GSM_RX_IRQ_PRIO));
   NVIC_EnableIRQ(USART1_IRQn);
 
   /* USER CODE BEGIN USART1_Init 1 */
 
   /* USER CODE END USART1_Init 1 */
-  USART_InitStruct.BaudRate = 115200;
+  USART_InitStruct.BaudRate = GSM_PORT_UART_BAUD_DEFAULT;
   USART_InitStruct.DataWidth = LL_USART_DATAWIDTH_8B;
   USART_InitStruct.StopBits = LL_USART_STOPBITS_1;
   USART_InitStruct.Parity = LL_USART_PARITY_NONE;
@@ -116,6 +124,8 @@ void gsm_port_comm_start(void) {
                           (uint32_t)&gsm_mem);
   LL_DMA_SetDataLength(GSM_PORT_UART_DMA, GSM_PORT_UART_DMA_STREAM,
                        sizeof(gsm_mem));
+  gsm_rx_laps = 0;
+  LL_DMA_ClearFlag_TC2(GSM_PORT_UART_DMA);
   LL_DMA_EnableIT_HT(GSM_PORT_UART_DMA, GSM_PORT_UART_DMA_STREAM);
   LL_DMA_EnableIT_TC(GSM_PORT_UART_DMA, GSM_PORT_UART_DMA_STREAM);
   LL_DMA_EnableIT_TE(GSM_PORT_UART_DMA, GSM_PORT_UART_DMA_STREAM);
@@ -131,6 +141,16 @@ void gsm_port_comm_start(void) {
   LL_USART_Enable(GSM_PORT_UART);
 }
 
+/**
+ * @brief wake up / airplane 핀 기본값 (정상 동작)
+ */
+static void gsm_port_gpio_mode_init(void) {
+  HAL_GPIO_WritePin(GSM_PORT_GPIO_PORT, GSM_PORT_GPIO_AIRPLANE_PIN,
+                    GPIO_PIN_RESET); // airplane mode
+  HAL_GPIO_WritePin(GSM_PORT_GPIO_PORT, GSM_PORT_GPIO_WAKEUP_PIN,
+                    GPIO_PIN_RESET); // wakeup
+}
+
 void gsm_port_gpio_start(void) {
   /* power on */
   HAL_GPIO_WritePin(GSM_PORT_GPIO_PORT, GSM_PORT_GPIO_RST_PIN,
@@ -145,10 +165,10 @@ void gsm_port_gpio_start(void) {
                     GPIO_PIN_RESET); // pwr
 
   /* wake up mode & airplane mode setting */
-  HAL_GPIO_WritePin(GSM_PORT_GPIO_PORT, GSM_PORT_GPIO_AIRPLANE_PIN,
-                    GPIO_PIN_RESET); // airplane mode
-  HAL_GPIO_WritePin(GSM_PORT_GPIO_PORT, GSM_PORT_GPIO_WAKEUP_PIN,
-                    GPIO_PIN_RESET); // wakeup
+  gsm_port_gpio_mode_init();
+
+  /* 전원 재인가 시 모뎀은 기본 속도로 돌아온다 */
+  gsm_port_set_baudrate(GSM_PORT_UART_BAUD_DEFAULT);
 }
 
 int gsm_port_power_on(void) {
@@ -173,14 +193,91 @@ uint32_t gsm_get_rx_pos(void) {
          LL_DMA_GetDataLength(GSM_PORT_UART_DMA, GSM_PORT_UART_DMA_STREAM);
 }
 
+/**
+ * @brief RX DMA 가 지금까지 쓴 누적 byte 수 (dma_ring 용)
+ *
+ * @return uint32_t
+ */
+uint32_t gsm_get_rx_count(void) {
+  uint32_t laps;
+  uint32_t pos;
+  bool tc_pending;
+
+  do {
+    laps = gsm_rx_laps;
+    pos = gsm_get_rx_pos();
+    tc_pending = LL_DMA_IsActiveFlag_TC2(GSM_PORT_UART_DMA);
+  } while (laps != gsm_rx_laps);
+
+  return dma_ring_count(laps, pos, tc_pending, sizeof(gsm_mem));
+}
+
 void gsm_port_init(void) {
   gsm_dma_init();
   gsm_uart_init();
+  uart_tx_init(&gsm_uart_tx, GSM_PORT_UART, DMA2, LL_DMA_STREAM_7,
+               LL_DMA_CHANNEL_4, DMA2_Stream7_IRQn, GSM_TX_DMA_PRIO,
+               GSM_TX_IRQ_PRIO);
 }
 
-void gsm_start(void) {
+/**
+ * @brief 주어진 속도로 AT 를 보내서 OK 가 오는지 확인 (파서 시작 전 전용)
+ *
+ * RX DMA ring 을 직접 본다. 받은 바이트는 나중에 파서가 다시 읽지만
+ * 진행 중인 명령이 없으므로 무시된다.
+ */
+static bool gsm_port_probe_at(uint32_t baudrate) {
+  size_t pos;
+  size_t end;
+  char prev = 0;
+
+  if (gsm_port_set_baudrate(baudrate) != 0) {
+    return false;
+  }
+
+#if GSM_CMUX_ENABLE
+  {
+    // MCU 만 리셋되면 모뎀은 아직 다중화 중이라 AT 를 프레임 밖 바이트로 버린다
+    uint8_t cld[8];
+
+    gsm_port_send((const char *)cld, cmux_frame_cld(cld));
+    vTaskDelay(pdMS_TO_TICKS(20));
+  }
+#endif
+
+  pos = gsm_get_rx_pos() % sizeof(gsm_mem);
+  gsm_port_send("AT\r\n", 4);
+  vTaskDelay(pdMS_TO_TICKS(GSM_PORT_PROBE_WAIT_MS));
+  end = gsm_get_rx_pos() % sizeof(gsm_mem);
+
+  while (pos != end) {
+    if (prev == 'O' && gsm_mem[pos] == 'K') {
+      return true;
+    }
+    prev = gsm_mem[pos];
+    pos = (pos + 1) % sizeof(gsm_mem);
+  }
+
+  return false;
+}
+
+uint32_t gsm_start(const uint32_t *baud_list, size_t cnt) {
   gsm_port_comm_start();
+
+  /* MCU 만 리셋된 경우 모뎀은 켜져 있고 PWRKEY 를 누르면 오히려 꺼진다 */
+  if (gsm_port_probe_at(GSM_PORT_UART_BAUD_DEFAULT)) {
+    gsm_port_gpio_mode_init();
+    return GSM_PORT_UART_BAUD_DEFAULT;
+  }
+  for (size_t i = 0; i < cnt; i++) {
+    if (gsm_port_probe_at(baud_list[i])) {
+      gsm_port_gpio_mode_init();
+      return baud_list[i];
+    }
+  }
+
   gsm_port_gpio_start();
+  return 0;
 }
 
 /**
@@ -200,6 +297,9 @@ int gsm_port_reset(void) {
   // RST 핀 LOW: 정상 동작 모드로 전환
   HAL_GPIO_WritePin(GSM_PORT_GPIO_PORT, GSM_PORT_GPIO_RST_PIN, GPIO_PIN_RESET);
 
+  // AT+IPR 은 저장하지 않으므로 리셋 후 모뎀은 기본 속도
+  gsm_port_set_baudrate(GSM_PORT_UART_BAUD_DEFAULT);
+
   // 부팅 초기 대기 (3초)
   // 참고: RDY URC는 약 13초 후 자동 수신됨
   vTaskDelay(pdMS_TO_TICKS(3000));
@@ -207,6 +307,60 @@ int gsm_port_reset(void) {
   return 0;
 }
 
+/**
+ * @brief AT 커맨드/데이터 송신 (HAL ops 콜백)
+ *
+ * DMA 로 보내고 완료까지 호출 태스크는 대기 (CPU 점유 없음)
+ *
+ * @param[in] data
+ * @param[in] len
+ * @return int 0: 성공
+ */
+int gsm_port_send(const char *data, size_t len) {
+  return uart_tx_send(&gsm_uart_tx, data, len);
+}
+
+int gsm_port_sendv(const cmux_seg_t *seg, size_t cnt) {
+  uart_tx_seg_t segs[4];
+
+  if (cnt > sizeof(segs) / sizeof(segs[0])) {
+    return -1;
+  }
+  for (size_t i = 0; i < cnt; i++) {
+    segs[i].data = seg[i].data;
+    segs[i].len = seg[i].len;
+  }
+  return uart_tx_sendv(&gsm_uart_tx, segs, cnt);
+}
+
+/**
+ * @brief USART1 보드레이트 변경 (HAL ops 콜백)
+ *
+ * 송신 중인 마지막 바이트가 나간 뒤 바꾼다. RX DMA 는 그대로 둔다.
+ *
+ * @param[in] baudrate
+ * @return int 0: 성공, -1: 송신 완료 대기 시간 초과
+ */
+int gsm_port_set_baudrate(uint32_t baudrate) {
+  LL_RCC_ClocksTypeDef clocks;
+  TickType_t start = xTaskGetTickCount();
+
+  while (!LL_USART_IsActiveFlag_TC(GSM_PORT_UART)) {
+    if ((xTaskGetTickCount() - start) > pdMS_TO_TICKS(10)) {
+      return -1;
+    }
+  }
+
+  LL_RCC_GetSystemClocksFreq(&clocks);
+
+  LL_USART_Disable(GSM_PORT_UART);
+  LL_USART_SetBaudRate(GSM_PORT_UART, clocks.PCLK2_Frequency,
+                       LL_USART_OVERSAMPLING_16, baudrate);
+  LL_USART_Enable(GSM_PORT_UART);
+
+  return 0;
+}
+
 /**
  * @brief This function handles USART1 global interrupt.
  */
@@ -214,6 +368,7 @@ void USART1_IRQHandler(void) {
   BaseType_t xHigherPriorityTaskWoken = pdFALSE;
 
   if (LL_USART_IsActiveFlag_IDLE(GSM_PORT_UART)) {
+    irq_lat_isr(IRQ_LAT_GSM);
     if (gsm_queue != NULL) {
       uint8_t dummy = 0;
       xQueueSendFromISR(gsm_queue, &dummy, &xHigherPriorityTaskWoken);
@@ -247,7 +402,10 @@ void USART1_IRQHandler(void) {
  */
 void DMA2_Stream2_IRQHandler(void) {
   /* USER CODE BEGIN DMA2_Stream2_IRQn 0 */
-  LL_DMA_ClearFlag_TC2(GSM_PORT_UART_DMA);
+  if (LL_DMA_IsActiveFlag_TC2(GSM_PORT_UART_DMA)) {
+    LL_DMA_ClearFlag_TC2(GSM_PORT_UART_DMA);
+    gsm_rx_laps++;
+  }
   LL_DMA_ClearFlag_HT2(GSM_PORT_UART_DMA);
 
   if (gsm_queue != NULL) {
@@ -262,6 +420,13 @@ void DMA2_Stream2_IRQHandler(void) {
   /* USER CODE END DMA2_Stream2_IRQn 1 */
 }
 
+/**
+ * @brief This function handles DMA2 stream7 global interrupt (USART1_TX).
+ */
+void DMA2_Stream7_IRQHandler(void) {
+  uart_tx_irq_handler(&gsm_uart_tx);
+}
+
 void gsm_port_power_off(void) {
   HAL_GPIO_WritePin(GSM_PORT_GPIO_PORT, GSM_PORT_GPIO_PWR_PIN, GPIO_PIN_SET);
   vTaskDelay(pdMS_TO_TICKS(800));
@@ -2,6 +2,7 @@
 #define GSM_PORT_H
 
 #include <stdbool.h>
+#include "cmux.h"
 #include "gsm_app.h"
 
 void gsm_dma_init(void);
@@ -9,8 +10,20 @@ void gsm_uart_init(void);
 void gsm_port_comm_start(void);
 void gsm_port_gpio_start(void);
 uint32_t gsm_get_rx_pos(void);
+uint32_t gsm_get_rx_count(void);
 void gsm_port_init(void);
-void gsm_start(void);
+
+/**
+ * @brief UART 통신 시작 후 모뎀 전원 인가
+ *
+ * 기본 속도와 baud_list 의 속도로 AT 를 보내 모뎀이 이미 켜져 있으면
+ * (MCU 만 리셋된 경우) 전원 키를 누르지 않고 그 속도에 맞춘다.
+ *
+ * @param baud_list 기본 속도 외에 확인할 속도
+ * @param cnt baud_list 개수
+ * @return uint32_t 모뎀이 응답한 속도, 0: 응답 없어 전원 인가함 (RDY 대기)
+ */
+uint32_t gsm_start(const uint32_t *baud_list, size_t cnt);
 
 void gsm_port_power_off(void);
 int gsm_port_power_on(void);
@@ -24,6 +37,22 @@ int gsm_port_power_on(void);
  * @return int 0: 성공
  */
 int gsm_port_reset(void);
+int gsm_port_send(const char *data, size_t len);
+
+/**
+ * @brief 구간 여러 개를 끊김 없이 송신 (CMUX 프레임, HAL ops 콜백)
+ *
+ * @return int 0: 성공
+ */
+int gsm_port_sendv(const cmux_seg_t *seg, size_t cnt);
+
+/**
+ * @brief USART1 보드레이트 변경 (HAL ops 콜백)
+ *
+ * @param baudrate
+ * @return int 0: 성공
+ */
+int gsm_port_set_baudrate(uint32_t baudrate);
 void gsm_port_set_airplane_mode(uint8_t enable);
 bool gsm_port_get_airplane_mode(void);
 
@@ -1,5 +1,9 @@
 #include "lte_init.h"
 #include "gsm.h"
+#include "boot_timeline.h"
+#include "init_seq.h"
+#include "pm_trace.h"
+#include <stdio.h>
 #include <string.h>
 
 #ifndef TAG
@@ -11,32 +15,60 @@
 // LTE 초기화 상태 및 재시도 카운터
 static lte_init_state_t lte_init_state = LTE_INIT_IDLE;
 static uint8_t lte_init_retry_count = 0;
-static uint8_t lte_network_check_count = 0;
 static TimerHandle_t lte_network_check_timer = NULL;
 static gsm_t *gsm_handle_ptr = NULL;
 
+// UART 보드레이트 단계 (모뎀 리셋 후에도 유지, 실패한 속도는 다시 시도 안 함)
+static const uint32_t lte_baud_list[] = LTE_UART_BAUD_LIST;
+static uint8_t lte_baud_idx = 0;
+static uint32_t lte_baudrate = LTE_UART_BAUD_DEFAULT;
+
+#define LTE_APN "m2m-router.lguplus.co.kr" // internet.lguplus.co.kr
+
 // 내부 콜백 함수 선언
 static void lte_init_fail_with_retry(const char *error_msg);
 static void lte_at_test_callback(gsm_t *gsm, gsm_cmd_t cmd, void *msg,
                                  bool is_ok);
-static void lte_echo_off_callback(gsm_t *gsm, gsm_cmd_t cmd, void *msg,
-                                  bool is_ok);
-static void lte_cmee_set_callback(gsm_t *gsm, gsm_cmd_t cmd, void *msg,
-                                  bool is_ok);
-static void lte_qisde_off_callback(gsm_t *gsm, gsm_cmd_t cmd, void *msg,
-                                   bool is_ok);
-static void lte_airplane_ctrl_set_callback(gsm_t *gsm, gsm_cmd_t cmd, void *msg,
-                                           bool is_ok);
-static void lte_cpin_check_callback(gsm_t *gsm, gsm_cmd_t cmd, void *msg,
-                                    bool is_ok);
-static void lte_apn_set_callback(gsm_t *gsm, gsm_cmd_t cmd, void *msg,
+static void lte_ipr_set_callback(gsm_t *gsm, gsm_cmd_t cmd, void *msg,
                                  bool is_ok);
-static void lte_apn_verify_callback(gsm_t *gsm, gsm_cmd_t cmd, void *msg,
-                                    bool is_ok);
-static void lte_network_check_callback(gsm_t *gsm, gsm_cmd_t cmd, void *msg,
-                                       bool is_ok);
-static void lte_keepalive_set_callback(gsm_t *gsm, gsm_cmd_t cmd, void *msg,
-                                       bool is_ok);
+static void lte_baud_verify_callback(gsm_t *gsm, gsm_cmd_t cmd, void *msg,
+                                     bool is_ok);
+#if GSM_CMUX_ENABLE
+static void lte_cmux_callback(gsm_t *gsm, gsm_cmd_t cmd, void *msg,
+                              bool is_ok);
+#endif
+static void lte_config_start(uint8_t first);
+
+/**
+ * @brief 설정 단계 (보드레이트/CMUX 뒤, 상태 조회부터 네트워크 등록까지)
+ *
+ * 한 단계라도 실패하면 lte_init_fail_with_retry() 로 AT 테스트부터 다시 한다.
+ */
+enum {
+  LTE_STEP_PROBE = 0,
+  LTE_STEP_ECHO_OFF,
+  LTE_STEP_CMEE,
+  LTE_STEP_QISDE,
+  LTE_STEP_AIRPLANE_CTRL,
+  LTE_STEP_KEEPALIVE,
+  LTE_STEP_CPIN,
+  LTE_STEP_APN_SET,
+  LTE_STEP_APN_VERIFY,
+  LTE_STEP_NETWORK,
+  LTE_STEP_COUNT,
+};
+
+static bool lte_seq_send(init_seq_t *seq, const init_seq_step_t *step);
+static bool lte_seq_defer(init_seq_t *seq, uint32_t ms);
+static void lte_seq_done(init_seq_t *seq, bool ok);
+
+static const init_seq_ops_t lte_seq_ops = {
+    .send = lte_seq_send,
+    .defer = lte_seq_defer,
+    .done = lte_seq_done,
+};
+
+static init_seq_t lte_seq = INIT_SEQ_INIT("LTE init", &lte_seq_ops, NULL);
 
 /**
  * @brief GSM 핸들 설정
@@ -82,7 +114,9 @@ static void lte_init_fail_with_retry(const char *error_msg) {
     LOG_ERR("%s (최대 재시도 초과)", error_msg);
     // EC25 모듈 하드웨어 리셋 (HAL ops 콜백 사용)
     if (gsm_handle_ptr && gsm_handle_ptr->ops && gsm_handle_ptr->ops->reset) {
+      gsm_mux_stop(gsm_handle_ptr, false);
       gsm_handle_ptr->ops->reset();
+      lte_baudrate = LTE_UART_BAUD_DEFAULT;
       LOG_INFO("EC25 모듈 리셋 완료");
     } else {
       LOG_ERR("리셋 함수가 설정되지 않음");
@@ -91,9 +125,6 @@ static void lte_init_fail_with_retry(const char *error_msg) {
     lte_init_retry_count++; // 4로 증가
     lte_init_state = LTE_INIT_IDLE;
 
-    // 네트워크 체크 카운터도 리셋
-    lte_network_check_count = 0;
-
     // RDY 이벤트가 올 때까지 대기하므로 여기서는 lte_init_start() 호출 안 함
     // RDY 이벤트 핸들러에서 자동으로 초기화 시작됨
   } else {
@@ -107,6 +138,34 @@ static void lte_init_fail_with_retry(const char *error_msg) {
   }
 }
 
+/**
+ * @brief 초기화 완료 처리 (이벤트 통보)
+ */
+static void lte_init_done(gsm_t *gsm) {
+  lte_init_state = LTE_INIT_DONE;
+  lte_init_retry_count = 0;
+
+  if (lte_network_check_timer != NULL) {
+    xTimerStop(lte_network_check_timer, 0);
+  }
+
+  // 초기화 완료 이벤트
+  if (gsm && gsm->evt_handler.handler) {
+    gsm->evt_handler.handler(GSM_EVT_INIT_OK, NULL);
+  }
+}
+
+/**
+ * @brief 이미 켜져 있는 모뎀으로 LTE 초기화 시작
+ */
+void lte_init_start_warm(uint32_t baudrate) {
+  LOG_INFO("모뎀 응답 확인 (%lu bps), RDY 없이 초기화 시작", baudrate);
+
+  lte_baudrate = baudrate;
+  lte_init_state = LTE_INIT_IDLE;
+  lte_init_start();
+}
+
 /**
  * @brief LTE 초기화 시작
  */
@@ -121,6 +180,10 @@ void lte_init_start(void) {
     return;
   }
 
+  // 재시도/RDY 뒤에는 AT 모드에서 다시 시작 (보드레이트 단계 뒤에 다시 켬)
+  init_seq_stop(&lte_seq);
+  gsm_mux_stop(gsm_handle_ptr, true);
+
   lte_init_state = LTE_INIT_AT_TEST;
 
   gsm_send_at_cmd(gsm_handle_ptr, GSM_CMD_AT, GSM_AT_EXECUTE, NULL,
@@ -128,262 +191,408 @@ void lte_init_start(void) {
 }
 
 /**
- * @brief AT 테스트 완료 콜백
+ * @brief 호스트 UART 보드레이트 변경
  */
-static void lte_at_test_callback(gsm_t *gsm, gsm_cmd_t cmd, void *msg,
-                                 bool is_ok) {
-  if (!is_ok) {
-    lte_init_fail_with_retry("AT 통신 실패");
-    return;
+static int lte_set_host_baudrate(gsm_t *gsm, uint32_t baudrate) {
+  if (!gsm->ops || !gsm->ops->set_baudrate) {
+    return -1;
   }
 
-  LOG_INFO("AT 통신 성공");
-
-  lte_init_state = LTE_INIT_ECHO_OFF;
+  if (gsm->ops->set_baudrate(baudrate) != 0) {
+    return -1;
+  }
 
-  gsm_send_at_ate(gsm, 0, lte_echo_off_callback);
+  lte_baudrate = baudrate;
+  return 0;
 }
 
+#if GSM_CMUX_ENABLE
 /**
-
- * @brief ATE0 에코 비활성화 완료 콜백
-
+ * @brief CMUX 완료 (DLC 1 열림/거절)
  */
+static void lte_cmux_done(gsm_t *gsm, bool ok) {
+  if (!ok) {
+    LOG_WARN("CMUX 채널 열기 실패, 다중화 없이 진행");
+    gsm_mux_stop(gsm, true);
+  }
+  lte_config_start(LTE_STEP_PROBE);
+}
+#endif
 
-static void lte_echo_off_callback(gsm_t *gsm, gsm_cmd_t cmd, void *msg,
-                                  bool is_ok)
+/**
+ * @brief AT+CMUX 로 UART 다중화 시작 (보드레이트가 정해진 뒤)
+ *
+ * 이후 AT/URC 는 DLC 1, PUSH 소켓은 DLC 2~ 에서 transparent 로 주고받는다.
+ */
+static void lte_cmux_start(gsm_t *gsm) {
+#if GSM_CMUX_ENABLE
+  lte_init_state = LTE_INIT_CMUX;
 
-{
+  gsm_send_at_cmux(gsm, lte_baudrate, lte_cmux_callback);
+#else
+  lte_config_start(LTE_STEP_PROBE);
+#endif
+}
 
-  if (!is_ok) {
-    lte_init_fail_with_retry("ATE0 설정 실패");
+/**
+ * @brief 다음 보드레이트 단계 시도 (남은 단계가 없으면 CMUX 로 진행)
+ */
+static void lte_baud_upgrade_start(gsm_t *gsm) {
+  if (!gsm->ops || !gsm->ops->set_baudrate ||
+      lte_baud_idx >= sizeof(lte_baud_list) / sizeof(lte_baud_list[0]) ||
+      lte_baudrate == lte_baud_list[lte_baud_idx]) {
+    lte_cmux_start(gsm);
     return;
   }
 
-  LOG_INFO("ATE0 OK");
-  lte_init_state = LTE_INIT_CMEE_SET;
+  LOG_INFO("AT+IPR=%lu 시도", lte_baud_list[lte_baud_idx]);
+  lte_init_state = LTE_INIT_BAUD_SET;
 
-  gsm_send_at_cmee(gsm, GSM_AT_WRITE, GSM_CMEE_ENABLE_VERBOSE,
-                   lte_cmee_set_callback);
+  gsm_send_at_ipr(gsm, lte_baud_list[lte_baud_idx], lte_ipr_set_callback);
 }
 
 /**
- * @brief AT+CMEE=2 설정 완료 콜백
+ * @brief AT 테스트 완료 콜백
  */
-static void lte_cmee_set_callback(gsm_t *gsm, gsm_cmd_t cmd, void *msg,
-                                  bool is_ok) {
+static void lte_at_test_callback(gsm_t *gsm, gsm_cmd_t cmd, void *msg,
+                                 bool is_ok) {
   if (!is_ok) {
-    lte_init_fail_with_retry("AT+CMEE=2 설정 실패");
+    if (lte_baudrate != LTE_UART_BAUD_DEFAULT &&
+        lte_set_host_baudrate(gsm, LTE_UART_BAUD_DEFAULT) == 0) {
+      // 모뎀이 전원 재인가 등으로 기본 속도로 돌아간 경우
+      LOG_WARN("AT 무응답, %d bps 로 재시도", LTE_UART_BAUD_DEFAULT);
+      gsm_send_at_cmd(gsm, GSM_CMD_AT, GSM_AT_EXECUTE, NULL,
+                      lte_at_test_callback);
+      return;
+    }
 
+    lte_init_fail_with_retry("AT 통신 실패");
     return;
   }
 
-  LOG_INFO("AT+CMEE=2 OK");
-
-  lte_init_state = LTE_INIT_QISDE_OFF;
+  LOG_INFO("AT 통신 성공");
 
-  gsm_send_at_qisde(gsm, GSM_AT_WRITE, 0, lte_qisde_off_callback);
+  lte_baud_upgrade_start(gsm);
 }
 
 /**
- * @brief AT+QISDE=0 소켓 데이터 에코 비활성화 완료 콜백
+ * @brief AT+IPR 완료 콜백
+ *
+ * 모뎀은 OK 를 보낸 직후 새 속도로 바뀌므로 호스트도 바로 따라간다.
  */
-static void lte_qisde_off_callback(gsm_t *gsm, gsm_cmd_t cmd, void *msg,
-                                   bool is_ok) {
+static void lte_ipr_set_callback(gsm_t *gsm, gsm_cmd_t cmd, void *msg,
+                                 bool is_ok) {
+  uint32_t baudrate = lte_baud_list[lte_baud_idx];
+
   if (!is_ok) {
-    lte_init_fail_with_retry("AT+QISDE=0 설정 실패");
+    // 모뎀이 속도를 거부함: 기존 속도 그대로이므로 다음 단계 시도
+    LOG_WARN("AT+IPR=%lu 거부", baudrate);
+    lte_baud_idx++;
+    lte_baud_upgrade_start(gsm);
     return;
   }
 
-  LOG_INFO("AT+QISDE=0 OK");
-  lte_init_state = LTE_INIT_AIRPLANE_CTRL_SET;
+  lte_set_host_baudrate(gsm, baudrate);
+  vTaskDelay(pdMS_TO_TICKS(LTE_UART_BAUD_SETTLE_MS));
 
-  gsm_send_at_qcfg_airplanecontrol(gsm, 1, lte_airplane_ctrl_set_callback);
+  lte_init_state = LTE_INIT_BAUD_VERIFY;
+  gsm_send_at_cmd(gsm, GSM_CMD_AT, GSM_AT_EXECUTE, NULL,
+                  lte_baud_verify_callback);
 }
 
-static void lte_airplane_ctrl_set_callback(gsm_t *gsm, gsm_cmd_t cmd, void *msg,
-                                           bool is_ok) {
-  if (!is_ok) {
-    lte_init_fail_with_retry("AT+QCFG=\"airplanecontrol\" 설정 실패");
+/**
+ * @brief 새 보드레이트 AT 확인 콜백
+ *
+ * 실패하면 모뎀이 어느 속도에 있는지 알 수 없으므로 하드웨어 리셋으로
+ * 기본 속도에 맞춘다 (AT&W 를 안 했으니 리셋 시 기본 속도).
+ * 재시도 카운터는 건드리지 않고 RDY 후 다음 단계부터 다시 시작한다.
+ */
+static void lte_baud_verify_callback(gsm_t *gsm, gsm_cmd_t cmd, void *msg,
+                                     bool is_ok) {
+  if (is_ok) {
+    LOG_INFO("UART %lu bps 확인", lte_baudrate);
+    lte_cmux_start(gsm);
     return;
   }
 
-  LOG_INFO("Airplane mode GPIO control OK");
-  lte_init_state = LTE_INIT_KEEPALIVE_SET;
+  LOG_WARN("UART %lu bps 확인 실패, 모뎀 리셋 후 다음 단계 시도",
+           lte_baud_list[lte_baud_idx]);
+  lte_baud_idx++;
 
-  gsm_send_at_qicfg_keepalive(gsm, 1, 2, 30, 3, lte_keepalive_set_callback);
+  if (gsm->ops->reset) {
+    gsm->ops->reset();
+    lte_baudrate = LTE_UART_BAUD_DEFAULT;
+    lte_init_state = LTE_INIT_IDLE;
+    // RDY 이벤트 핸들러에서 초기화 재시작
+    return;
+  }
 
+  lte_set_host_baudrate(gsm, LTE_UART_BAUD_DEFAULT);
+  lte_init_fail_with_retry("보드레이트 확인 실패");
 }
 
+#if GSM_CMUX_ENABLE
 /**
- * @brief AT+CPIN? 확인 완료 콜백
+ * @brief AT+CMUX 완료 콜백
+ *
+ * OK 직후부터 모뎀 출력은 프레임이므로 바로 다중화를 켜고 DLC 를 연다.
+ * 거부되면 (다른 포트가 이미 다중화 중 등) 다중화 없이 진행한다.
  */
-static void lte_cpin_check_callback(gsm_t *gsm, gsm_cmd_t cmd, void *msg,
-                                    bool is_ok) {
+static void lte_cmux_callback(gsm_t *gsm, gsm_cmd_t cmd, void *msg,
+                              bool is_ok) {
   if (!is_ok) {
-    lte_init_fail_with_retry("AT+CPIN? 실패");
+    LOG_WARN("AT+CMUX 거부, 다중화 없이 진행");
+    lte_config_start(LTE_STEP_PROBE);
     return;
   }
 
-  // SIM 상태 확인
-  gsm_msg_t *m = (gsm_msg_t *)msg;
-  if (m && strlen(m->cpin.code) > 0) {
+  gsm_mux_start(gsm, lte_cmux_done);
+}
+#endif
 
-    if (strcmp(m->cpin.code, "READY") != 0) {
-      LOG_WARN("SIM 인식 불가: %s", m->cpin.code);
-      // READY가 아니어도 계속 진행 (SIM PIN 입력 등은 별도 처리)
-    }
-  } else {
-    LOG_INFO("SIM 상태 확인 완료");
+/* 상태 조회 결과 (이번 초기화에서 조회가 됐을 때만 valid) */
+static struct {
+  bool valid;
+  uint8_t cmee;
+  bool keepalive;
+} lte_probe;
+
+/**
+ * @brief 상태 일괄 조회 판정
+ *
+ * CMEE=2 와 keep-alive 는 설정 단계의 처음과 끝이므로 둘 다 켜져 있으면
+ * 이전 초기화가 끝까지 돈 것으로 본다. SIM 준비, attach, cid 1 PDP 활성까지
+ * 맞으면 바로 완료, 아니면 ATE0 부터 (이미 맞는 설정은 건너뛰며) 진행한다.
+ * SIM 미장착 등으로 ERROR 가 와도 (optional) 전체 단계에서 다시 확인한다.
+ */
+static init_seq_res_t lte_probe_check(init_seq_t *seq, const void *resp) {
+  const gsm_msg_t *m = resp;
+
+  if (!m) {
+    return INIT_SEQ_NEXT;
   }
 
-  lte_init_state = LTE_INIT_APN_SET;
+  lte_probe.valid = true;
+  lte_probe.cmee = m->probe.cmee;
+  lte_probe.keepalive = m->probe.keepalive;
 
+  if (m->probe.cmee == GSM_CMEE_ENABLE_VERBOSE && m->probe.keepalive &&
+      m->probe.sim_ready && m->probe.cgatt == 1 &&
+      (m->probe.pdp_mask & (1u << 1))) {
+    LOG_INFO("모뎀 설정/PDP 유지됨, 초기화 단계 생략");
+    return INIT_SEQ_FINISH;
+  }
+
+  LOG_INFO("상태 조회: cmee=%d keepalive=%d sim=%d cgatt=%d pdp=0x%02X",
+           m->probe.cmee, m->probe.keepalive, m->probe.sim_ready,
+           m->probe.cgatt, m->probe.pdp_mask);
+  return INIT_SEQ_NEXT;
+}
 
-  gsm_pdp_context_t ctx = {
-      .cid = 1, .type = GSM_PDP_TYPE_IP, .apn = "m2m-router.lguplus.co.kr"};
-  gsm_send_at_cgdcont(gsm, GSM_AT_WRITE, &ctx, lte_apn_set_callback); // internet.lguplus.co.kr
+static bool lte_skip_cmee(init_seq_t *seq) {
+  return lte_probe.valid && lte_probe.cmee == GSM_CMEE_ENABLE_VERBOSE;
+}
+
+static bool lte_skip_keepalive(init_seq_t *seq) {
+  return lte_probe.valid && lte_probe.keepalive;
 }
 
 /**
- * @brief APN 설정 완료 콜백
+ * @brief AT+CPIN? 판정 (READY 가 아니어도 진행, SIM PIN 입력 등은 별도 처리)
  */
-static void lte_apn_set_callback(gsm_t *gsm, gsm_cmd_t cmd, void *msg,
-                                 bool is_ok) {
-  if (!is_ok) {
-    lte_init_fail_with_retry("APN 설정 실패");
-    return;
-  }
+static init_seq_res_t lte_cpin_check(init_seq_t *seq, const void *resp) {
+  const gsm_msg_t *m = resp;
 
-  LOG_INFO("APN 설정 OK");
-  lte_init_state = LTE_INIT_APN_VERIFY;
+  if (m && strlen(m->cpin.code) > 0) {
+    if (strcmp(m->cpin.code, "READY") != 0) {
+      LOG_WARN("SIM 인식 불가: %s", m->cpin.code);
+    }
+  } else {
+    LOG_INFO("SIM 상태 확인 완료");
+  }
 
-  gsm_send_at_cgdcont(gsm, GSM_AT_READ, NULL, lte_apn_verify_callback);
+  return INIT_SEQ_NEXT;
 }
 
 /**
- * @brief APN 확인 완료 콜백
+ * @brief AT+CGDCONT? 판정 (cid 1 이 설정한 APN 인지)
  */
-static void lte_apn_verify_callback(gsm_t *gsm, gsm_cmd_t cmd, void *msg,
-                                    bool is_ok) {
-  if (!is_ok) {
-    lte_init_fail_with_retry("APN 확인 실패");
-    return;
-  }
+static init_seq_res_t lte_apn_check(init_seq_t *seq, const void *resp) {
+  const gsm_msg_t *m = resp;
 
-  // APN 설정 확인
-  gsm_msg_t *m = (gsm_msg_t *)msg;
-  if (m && m->cgdcont.count > 0) {
-    for (size_t i = 0; i < m->cgdcont.count; i++) {
-      gsm_pdp_context_t *ctx = &m->cgdcont.contexts[i];
-      LOG_INFO("CID %d: type=%d, apn=%s", ctx->cid, ctx->type, ctx->apn);
-    }
+  if (!m || m->cgdcont.count == 0) {
+    return INIT_SEQ_FAIL;
+  }
 
-    // 설정한 APN이 맞는지 확인
-    gsm_pdp_context_t *ctx = &m->cgdcont.contexts[0];
-    if (ctx->cid == 1 && strcmp(ctx->apn, "m2m-router.lguplus.co.kr") == 0) { // internet.lguplus.co.kr
-      LOG_INFO("APN 등록 완료: %s", ctx->apn);
-      lte_init_state = LTE_INIT_NETWORK_CHECK;
+  for (size_t i = 0; i < m->cgdcont.count; i++) {
+    const gsm_pdp_context_t *ctx = &m->cgdcont.contexts[i];
+    LOG_INFO("CID %d: type=%d, apn=%s", ctx->cid, ctx->type, ctx->apn);
+  }
 
-      lte_network_check_count = 0;
-      gsm_send_at_cmd(gsm, GSM_CMD_COPS, GSM_AT_READ, NULL,
-                      lte_network_check_callback);
-      return;
-    } else {
-      LOG_WARN("APN 불일치: cid=%d, apn=%s", ctx->cid, ctx->apn);
-    }
+  const gsm_pdp_context_t *ctx = &m->cgdcont.contexts[0];
+  if (ctx->cid != 1 || strcmp(ctx->apn, LTE_APN) != 0) {
+    LOG_WARN("APN 불일치: cid=%d, apn=%s", ctx->cid, ctx->apn);
+    return INIT_SEQ_FAIL;
   }
 
-  // APN 확인 실패
-  lte_init_fail_with_retry("APN 확인 실패");
+  LOG_INFO("APN 등록 완료: %s", ctx->apn);
+  return INIT_SEQ_NEXT;
 }
 
 /**
- * @brief 네트워크 등록 확인 콜백
+ * @brief AT+COPS? 판정 (미등록이면 LTE_NETWORK_CHECK_INTERVAL_MS 뒤 다시)
  */
-static void lte_network_check_callback(gsm_t *gsm, gsm_cmd_t cmd, void *msg,
-                                       bool is_ok) {
-  lte_network_check_count++;
-
-  if (!is_ok) {
-    if (lte_network_check_count >= LTE_NETWORK_CHECK_MAX_RETRY) {
-      lte_init_fail_with_retry("apn 등록 확인 실패");
-      return;
-    }
+static init_seq_res_t lte_network_check(init_seq_t *seq, const void *resp) {
+  const gsm_msg_t *m = resp;
 
-    if (lte_network_check_timer != NULL) {
-      xTimerStart(lte_network_check_timer, 0);
-    }
-
-    return;
+  if (m && strlen(m->cops.oper) > 0) {
+    LOG_INFO("apn 등록: %s (mode=%d, act=%d)", m->cops.oper, m->cops.mode,
+             m->cops.act);
+    LOG_INFO("LTE 초기화 완료, 네트워크: %s", m->cops.oper);
+    boot_timeline_mark(BOOT_MARK_LTE_REG);
+    return INIT_SEQ_NEXT;
   }
 
-  // 네트워크 상태 확인
-  gsm_msg_t *m = (gsm_msg_t *)msg;
-  if (m && strlen(m->cops.oper) > 0) {
-    LOG_INFO("apn 등록: %s (mode=%d, act=%d)", m->cops.oper,
-             m->cops.mode, m->cops.act);
+  LOG_INFO("네트워크 미등록 (%d/%d) 재시도...", seq->attempt + 1,
+           LTE_NETWORK_CHECK_MAX_RETRY);
+  return INIT_SEQ_RETRY;
+}
 
-    lte_init_state = LTE_INIT_DONE;
-    lte_init_retry_count = 0;
-    lte_network_check_count = 0;
+/* cmd 는 로그/실패 메시지용 이름, 실제 명령은 lte_seq_send() 가 tag 로 고름 */
+static const init_seq_step_t lte_steps[LTE_STEP_COUNT] = {
+    [LTE_STEP_PROBE] = {.cmd = "상태 조회", .expect = "OK",
+                        .tag = LTE_INIT_STATE_PROBE, .optional = true,
+                        .check = lte_probe_check},
+    [LTE_STEP_ECHO_OFF] = {.cmd = "ATE0", .expect = "OK",
+                           .tag = LTE_INIT_ECHO_OFF},
+    [LTE_STEP_CMEE] = {.cmd = "AT+CMEE=2", .expect = "OK",
+                       .tag = LTE_INIT_CMEE_SET, .skip = lte_skip_cmee},
+    [LTE_STEP_QISDE] = {.cmd = "AT+QISDE=0", .expect = "OK",
+                        .tag = LTE_INIT_QISDE_OFF},
+    [LTE_STEP_AIRPLANE_CTRL] = {.cmd = "AT+QCFG=\"airplanecontrol\"",
+                                .expect = "OK",
+                                .tag = LTE_INIT_AIRPLANE_CTRL_SET},
+    [LTE_STEP_KEEPALIVE] = {.cmd = "AT+QICFG keep-alive", .expect = "OK",
+                            .tag = LTE_INIT_KEEPALIVE_SET,
+                            .skip = lte_skip_keepalive},
+    [LTE_STEP_CPIN] = {.cmd = "AT+CPIN?", .expect = "+CPIN",
+                       .tag = LTE_INIT_CPIN_CHECK, .check = lte_cpin_check},
+    [LTE_STEP_APN_SET] = {.cmd = "AT+CGDCONT", .expect = "OK",
+                          .tag = LTE_INIT_APN_SET},
+    [LTE_STEP_APN_VERIFY] = {.cmd = "AT+CGDCONT?", .expect = "+CGDCONT",
+                             .tag = LTE_INIT_APN_VERIFY,
+                             .check = lte_apn_check},
+    [LTE_STEP_NETWORK] = {.cmd = "AT+COPS?", .expect = "+COPS",
+                          .retries = LTE_NETWORK_CHECK_MAX_RETRY - 1,
+                          .retry_ms = LTE_NETWORK_CHECK_INTERVAL_MS,
+                          .tag = LTE_INIT_NETWORK_CHECK,
+                          .check = lte_network_check},
+};
 
-    if (lte_network_check_timer != NULL) {
-      xTimerStop(lte_network_check_timer, 0);
-    }
+/**
+ * @brief 설정 단계 AT 응답 (gsm 파서 태스크)
+ */
+static void lte_seq_callback(gsm_t *gsm, gsm_cmd_t cmd, void *msg,
+                             bool is_ok) {
+  init_seq_result(&lte_seq, is_ok, is_ok ? msg : NULL);
+}
 
-    LOG_INFO("LTE 초기화 완료, 네트워크: %s", m->cops.oper);
+static bool lte_seq_send(init_seq_t *seq, const init_seq_step_t *step) {
+  gsm_t *gsm = gsm_handle_ptr;
+  gsm_pdp_context_t ctx = {.cid = 1, .type = GSM_PDP_TYPE_IP, .apn = LTE_APN};
 
-    // 초기화 완료 이벤트
-    if (gsm && gsm->evt_handler.handler) {
-      gsm->evt_handler.handler(GSM_EVT_INIT_OK, NULL);
-    }
-    return;
+  if (!gsm) {
+    LOG_ERR("GSM 핸들이 설정되지 않음");
+    return false;
   }
 
-  // 네트워크 미등록 (재시도)
-  LOG_INFO("네트워크 미등록 (%d/%d) 재시도...",
-           lte_network_check_count, LTE_NETWORK_CHECK_MAX_RETRY);
-
-  // 최대 재시도 횟수 확인
-  if (lte_network_check_count >= LTE_NETWORK_CHECK_MAX_RETRY) {
-    lte_init_fail_with_retry("네트워크 등록 실패");
-    return;
+  lte_init_state = (lte_init_state_t)step->tag;
+
+  switch (step->tag) {
+  case LTE_INIT_STATE_PROBE:
+    // 한 줄로 CMEE, keep-alive, CPIN, CGATT, CGACT 를 물음
+    lte_probe.valid = false;
+    gsm_send_at_cmd(gsm, GSM_CMD_PROBE, GSM_AT_EXECUTE, NULL, lte_seq_callback);
+    break;
+  case LTE_INIT_ECHO_OFF:
+    gsm_send_at_ate(gsm, 0, lte_seq_callback);
+    break;
+  case LTE_INIT_CMEE_SET:
+    gsm_send_at_cmee(gsm, GSM_AT_WRITE, GSM_CMEE_ENABLE_VERBOSE,
+                     lte_seq_callback);
+    break;
+  case LTE_INIT_QISDE_OFF:
+    gsm_send_at_qisde(gsm, GSM_AT_WRITE, 0, lte_seq_callback);
+    break;
+  case LTE_INIT_AIRPLANE_CTRL_SET:
+    gsm_send_at_qcfg_airplanecontrol(gsm, 1, lte_seq_callback);
+    break;
+  case LTE_INIT_KEEPALIVE_SET:
+    gsm_send_at_qicfg_keepalive(gsm, 1, 2, 30, 3, lte_seq_callback);
+    break;
+  case LTE_INIT_CPIN_CHECK:
+    gsm_send_at_cmd(gsm, GSM_CMD_CPIN, GSM_AT_READ, NULL, lte_seq_callback);
+    break;
+  case LTE_INIT_APN_SET:
+    gsm_send_at_cgdcont(gsm, GSM_AT_WRITE, &ctx, lte_seq_callback);
+    break;
+  case LTE_INIT_APN_VERIFY:
+    gsm_send_at_cgdcont(gsm, GSM_AT_READ, NULL, lte_seq_callback);
+    break;
+  case LTE_INIT_NETWORK_CHECK:
+    gsm_send_at_cmd(gsm, GSM_CMD_COPS, GSM_AT_READ, NULL, lte_seq_callback);
+    break;
+  default:
+    return false;
   }
 
-  // 타이머로 재시도 (FreeRTOS 타이머는 스레드 안전)
-  if (lte_network_check_timer != NULL) {
-    xTimerStart(lte_network_check_timer, 0);
-  }
+  return true;
 }
 
 /**
- * @brief 네트워크 등록 체크 타이머 콜백
+ * @brief 네트워크 등록 재확인 예약 (FreeRTOS 타이머는 스레드 안전)
  */
-void lte_network_check_timer_callback(TimerHandle_t xTimer) {
-  if (!gsm_handle_ptr) {
-    LOG_ERR("GSM 핸들이 설정되지 않음");
-    return;
+static bool lte_seq_defer(init_seq_t *seq, uint32_t ms) {
+  if (lte_network_check_timer == NULL) {
+    return false;
   }
 
-  gsm_send_at_cmd(gsm_handle_ptr, GSM_CMD_COPS, GSM_AT_READ, NULL,
-                  lte_network_check_callback);
+  return xTimerChangePeriod(lte_network_check_timer, pdMS_TO_TICKS(ms), 0) ==
+         pdPASS;
 }
 
-static void lte_keepalive_set_callback(gsm_t *gsm, gsm_cmd_t cmd, void *msg,
-                                       bool is_ok) {
-  if (!is_ok) {
-    lte_init_fail_with_retry("AT+QICFG keep-alive 설정 실패");
+static void lte_seq_done(init_seq_t *seq, bool ok) {
+  const init_seq_step_t *step = init_seq_step(seq);
+  char msg[48];
+
+  pm_trace(PM_EVT_LTE_INIT, ok, step ? step->tag : 0);
+  if (ok) {
+    lte_init_done(gsm_handle_ptr);
     return;
   }
 
-  LOG_INFO("TCP keep-alive OK");
-  lte_init_state = LTE_INIT_CPIN_CHECK;
+  snprintf(msg, sizeof(msg), "%s 실패", step ? step->cmd : "설정");
+  lte_init_fail_with_retry(msg);
+}
 
-  gsm_send_at_cmd(gsm, GSM_CMD_CPIN, GSM_AT_READ, NULL,
-                  lte_cpin_check_callback);
+static void lte_config_start(uint8_t first) {
+  if (!init_seq_start(&lte_seq, lte_steps, LTE_STEP_COUNT, first)) {
+    lte_init_fail_with_retry("설정 단계 시작 실패");
+  }
 }
 
+/**
+ * @brief 네트워크 등록 체크 (타이머 만료 후 워커)
+ */
+static void lte_network_check_resume(work_t *work) {
+  (void)work;
+
+  init_seq_resume(&lte_seq);
+}
+
+work_t lte_network_check_work =
+    WORK_INIT(lte_network_check_resume, NULL, WORK_PRIO_LOW);
+
 void lte_reinit_from_apn(void) {
   if (!gsm_handle_ptr) {
     LOG_ERR("GSM 핸들이 설정되지 않음");
@@ -392,31 +601,28 @@ void lte_reinit_from_apn(void) {
 
   // 재시도 카운터 초기화 (pdpdeact는 네트워크 이슈이므로 별도 관리)
   lte_init_retry_count = 0;
-  lte_network_check_count = 0;
 
-  // APN 설정 단계로 이동
-  lte_init_state = LTE_INIT_APN_SET;
-
-  // APN 설정 시작
+  // APN 설정 단계부터
   LOG_INFO("AT+CGDCONT APN 설정");
-  gsm_pdp_context_t ctx = {
-      .cid = 1, .type = GSM_PDP_TYPE_IP, .apn = "m2m-router.lguplus.co.kr"};
-  gsm_send_at_cgdcont(gsm_handle_ptr, GSM_AT_WRITE, &ctx, lte_apn_set_callback);
+  init_seq_stop(&lte_seq);
+  lte_config_start(LTE_STEP_APN_SET);
 }
 
 void lte_reset_state(void) {
 
   LOG_INFO("LTE 상태 리셋");
 
+  init_seq_stop(&lte_seq);
+
   if (lte_network_check_timer != NULL) {
     xTimerStop(lte_network_check_timer, 0);
     LOG_INFO("네트워크 체크 타이머 중지");
   }
 
-  if (gsm_handle_ptr && gsm_handle_ptr->at_cmd_queue) {
-    gsm_at_cmd_t dummy_cmd;
-    while (xQueueReceive(gsm_handle_ptr->at_cmd_queue, &dummy_cmd, 0) == pdTRUE) {
-      LOG_DEBUG("AT 명령 큐 비우기");
+  if (gsm_handle_ptr) {
+    uint32_t flushed = gsm_at_cmd_flush(gsm_handle_ptr);
+    if (flushed) {
+      LOG_DEBUG("AT 명령 큐 비우기 (%lu개)", flushed);
     }
   }
 
@@ -426,5 +632,4 @@ void lte_reset_state(void) {
 
   lte_init_state = LTE_INIT_IDLE;
   lte_init_retry_count = 0;
-  lte_network_check_count = 0;
 }
@@ -4,6 +4,7 @@
 #include "FreeRTOS.h"
 #include "gsm.h"
 #include "timers.h"
+#include "work_queue.h"
 
 /**
  * @brief LTE 초기화 상태
@@ -11,6 +12,10 @@
 typedef enum {
   LTE_INIT_IDLE = 0,
   LTE_INIT_AT_TEST,       // AT 테스트
+  LTE_INIT_BAUD_SET,      // AT+IPR 보드레이트 변경
+  LTE_INIT_BAUD_VERIFY,   // 새 보드레이트로 AT 확인
+  LTE_INIT_CMUX,          // AT+CMUX 다중화, DLC 열기
+  LTE_INIT_STATE_PROBE,   // 설정/등록 상태 일괄 조회 (빠른 경로 판단)
   LTE_INIT_ECHO_OFF,      // ATE0 에코 비활성화
   LTE_INIT_CMEE_SET,      // AT+CMEE=2 설정
   LTE_INIT_QISDE_OFF,     // AT+QISDE=0 소켓 데이터 에코 비활성화
@@ -31,6 +36,16 @@ typedef enum {
 #define LTE_NETWORK_CHECK_MAX_RETRY 20 // 네트워크 등록 최대 20회 (약 2분)
 #define LTE_NETWORK_CHECK_INTERVAL_MS 6000 // 6초마다 체크
 
+/**
+ * @brief 모뎀 UART 보드레이트 (AT+IPR)
+ *
+ * 목록 앞쪽부터 시도하고, 새 속도에서 AT 확인이 안 되면 모뎀을 리셋해
+ * 기본 속도로 되돌린 뒤 다음 단계를 시도한다. 목록을 다 쓰면 기본 속도 유지.
+ */
+#define LTE_UART_BAUD_DEFAULT 115200
+#define LTE_UART_BAUD_LIST {921600, 460800}
+#define LTE_UART_BAUD_SETTLE_MS 20 // 속도 전환 후 첫 AT 까지 대기
+
 /**
  * @brief LTE 초기화 시작
  *
@@ -38,6 +53,16 @@ typedef enum {
  */
 void lte_init_start(void);
 
+/**
+ * @brief 이미 켜져 있는 모뎀으로 LTE 초기화 시작 (RDY 없이)
+ *
+ * MCU 만 리셋된 경우 호출. 상태 조회로 이전 설정과 PDP 가 살아 있으면
+ * 설정 단계를 건너뛰고 바로 GSM_EVT_INIT_OK 를 낸다.
+ *
+ * @param baudrate 모뎀이 응답한 UART 속도
+ */
+void lte_init_start_warm(uint32_t baudrate);
+
 /**
  * @brief LTE 초기화 상태 조회
  *
@@ -71,13 +96,11 @@ void lte_set_network_check_timer(TimerHandle_t timer);
 void lte_set_gsm_handle(gsm_t *gsm);
 
 /**
- * @brief 네트워크 체크 타이머 콜백
- *
- * FreeRTOS 타이머 콜백으로 사용 (gsm_process_task에서 타이머 생성 시 지정)
+ * @brief 네트워크 체크 작업 (공용 워커)
  *
- * @param xTimer 타이머 핸들
+ * gsm_process_task 가 만드는 타이머의 ID 로 넘긴다 (work_timer_callback).
  */
-void lte_network_check_timer_callback(TimerHandle_t xTimer);
+extern work_t lte_network_check_work;
 
 void lte_reinit_from_apn(void);
 
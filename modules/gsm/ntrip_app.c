@@ -1,11 +1,19 @@
 #include "ntrip_app.h"
+#include "ntrip_monitor.h"
+#include "app_events.h"
 #include "FreeRTOS.h"
 #include "gps_app.h"
+#include "rtcm_router.h"
 #include "led.h"
-#include "queue.h"
+#include "boot_timeline.h"
+#include "pm_trace.h"
+#include "epoch_deadline.h"
+#include "heap_track.h"
+#include "mem_section.h"
 #include "task.h"
 #include "tcp_socket.h"
 #include "flash_params.h"
+#include "fmt.h"
 #include <stdlib.h>
 #include <string.h>
 #include "base_auto_fix.h"
@@ -18,31 +26,37 @@
 #include "log.h"
 
 #define NTRIP_CONNECT_ID 0 // 소켓 ID (0-11)
+#define NTRIP_STANDBY_CONNECT_ID 1 // 보조 캐스터 소켓 ID
 #define NTRIP_CONTEXT_ID 1 // PDP context ID
+#define NTRIP_ACCESS_MODE GSM_TCP_ACCESS_PUSH // 조각마다 AT+QIRD 왕복 없이 바로 수신
 
 #define NTRIP_MAX_CONNECT_RETRY 3
 #define NTRIP_MAX_TIMEOUT_COUNT 3    // 연속 타임아웃 최대 허용 횟수
-#define NTRIP_RECONNECT_DELAY_MS 500 // 재연결 대기 시간 (ms)
+#define NTRIP_RECONNECT_DELAY_MS 500 // 재연결 실패 후 대기 기준 (ms)
+#define NTRIP_RECV_TIMEOUT_MS 5000   // 보정 데이터 무수신 판정 시간 (ms)
+#define NTRIP_DNS_TIMEOUT_MS 5000    // 캐스터 주소 조회 대기 시간 (ms)
 
-#define NTRIP_GGA_QUEUE_SIZE 10 // GGA 전송 큐 크기 (재연결 중 버퍼링)
 #define NTRIP_GGA_MAX_LEN 100   // GGA 문장 최대 길이
-#define NTRIP_GGA_SEND_BATCH 5  // 한 루프당 최대 GGA 전송 개수 (GSM 버퍼 보호)
+#define NTRIP_GGA_INTERVAL_DEFAULT_MS 1000 // GGA 업로드 최소 간격 (ms)
 #define NTRIP_INIT_RETRY_BASE_DELAY_MS 1000 // 초기화 재시도 기본 대기 시간 (백오프)
 #define NTRIP_INIT_MAX_RETRY 3
+#define NTRIP_STANDBY_RETRY_MS 10000 // 보조 캐스터 연결 실패 후 재시도 간격 (ms)
 
+#define NTRIP_LINK_PRIMARY 0
+#define NTRIP_LINK_STANDBY 1
+#define NTRIP_LINK_MAX 2
 
-// GGA 전송 큐 아이템
+
+// 보낼 GGA (최신 1개)
 typedef struct
 {
   char data[NTRIP_GGA_MAX_LEN];
   uint8_t len;
-} ntrip_gga_queue_item_t;
-
-static TaskHandle_t g_ntrip_recv_task_handle = NULL;
+} ntrip_gga_item_t;
 
 static const char base64_table[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
 
-static int base64_encode(const char *input, size_t input_len, char *output, size_t output_size)
+int ntrip_base64_encode(const char *input, size_t input_len, char *output, size_t output_size)
 {
 
   size_t output_len = 4 * ((input_len + 2) / 3);
@@ -84,29 +98,45 @@ static int base64_encode(const char *input, size_t input_len, char *output, size
   return output_len;
 }
 
+/**
+ * @brief 캐스터 접속 정보
+ */
+typedef struct
+{
+  const char *url;
+  const char *port;
+  const char *mountpoint;
+} ntrip_caster_cfg_t;
+
 /**
  * @brief NTRIP HTTP 요청 문자열 생성
+ * @param cfg 캐스터 설정 (계정은 주 캐스터 것을 쓴다)
  * @param buffer 출력 버퍼
  * @param buffer_size 버퍼 크기
  * @return 생성된 문자열 길이 (실패시 -1)
  */
 
-static int ntrip_build_http_request(char *buffer, size_t buffer_size)
+static int ntrip_build_http_request(const ntrip_caster_cfg_t *cfg, char *buffer, size_t buffer_size)
 {
 
-  user_params_t *params = flash_params_get_current();
+  const user_params_t *params = flash_params_snapshot(NULL);
 
   // ID:PW 문자열 생성
 
   char credentials[128];
+  fmt_t f;
 
-  snprintf(credentials, sizeof(credentials), "%s:%s", params->ntrip_id, params->ntrip_pw);
+  fmt_init(&f, credentials, sizeof(credentials));
+  fmt_str(&f, params->ntrip_id);
+  fmt_char(&f, ':');
+  fmt_str(&f, params->ntrip_pw);
+  fmt_end(&f);
 
   // Base64 인코딩
 
   char encoded_credentials[256];
 
-  int encoded_len = base64_encode(credentials, strlen(credentials), encoded_credentials, sizeof(encoded_credentials));
+  int encoded_len = ntrip_base64_encode(credentials, strlen(credentials), encoded_credentials, sizeof(encoded_credentials));
 
   if (encoded_len < 0)
   {
@@ -118,17 +148,25 @@ static int ntrip_build_http_request(char *buffer, size_t buffer_size)
 
   // HTTP 요청 생성
 
-  int len = snprintf(buffer, buffer_size,
-                     "GET /%s HTTP/1.1\r\n"
-                     "User-Agent: NTRIP GUGU SYSTEM\r\n"
-                     "Accept: */*\r\n"
-                     "Connection: keep-alive\r\n"
-                     "Authorization: Basic %s\r\n"
-                     "\r\n",
-                     params->ntrip_mountpoint,
-                     encoded_credentials);
-
-  if (len < 0 || len >= buffer_size)
+  fmt_init(&f, buffer, buffer_size);
+  fmt_str(&f, "GET /");
+  fmt_str(&f, cfg->mountpoint);
+  fmt_str(&f, " HTTP/1.1\r\n"
+              "Host: ");
+  fmt_str(&f, cfg->url);
+  // v2 캐스터는 chunked 로, v1 캐스터는 Ntrip-Version 을 무시하고 ICY 로 응답
+  fmt_str(&f, "\r\n"
+              "Ntrip-Version: Ntrip/2.0\r\n"
+              "User-Agent: NTRIP GUGU SYSTEM\r\n"
+              "Accept: */*\r\n"
+              "Connection: keep-alive\r\n"
+              "Authorization: Basic ");
+  fmt_str(&f, encoded_credentials);
+  fmt_str(&f, "\r\n\r\n");
+
+  int len = (int)fmt_end(&f);
+
+  if (len == 0)
   {
 
     LOG_ERR("HTTP 요청 생성 실패");
@@ -139,380 +177,868 @@ static int ntrip_build_http_request(char *buffer, size_t buffer_size)
   return len;
 }
 
-__attribute__((section(".ccmram"))) uint8_t recv_buf[1500];
+/**
+ * @brief NTRIP v2 chunked 본문 디코더 상태
+ *
+ * "크기(HEX)[;확장]\r\n 데이터 \r\n" 반복, 크기 0 이면 스트림 끝.
+ */
+typedef enum
+{
+  NTRIP_CHUNK_OFF = 0, // v1 (ICY) / 길이 그대로 스트림
+  NTRIP_CHUNK_HEAD,    // 첫 조각에 헤더 끝이 없었음, 빈 줄까지 버림
+  NTRIP_CHUNK_SIZE,    // 크기 HEX
+  NTRIP_CHUNK_EXT,     // 크기 뒤 확장/CR, LF 까지 버림
+  NTRIP_CHUNK_DATA,    // 데이터 (left 바이트 남음)
+  NTRIP_CHUNK_DATA_END,// 데이터 뒤 CRLF
+  NTRIP_CHUNK_END,     // 크기 0 (캐스터가 스트림을 닫음)
+  NTRIP_CHUNK_ERROR,   // 틀 어긋남, 재연결까지 버림
+} ntrip_chunk_state_t;
 
-__attribute__((section(".ccmram"))) static char g_ntrip_http_request[512]; // 동적으로 생성된 HTTP 요청 저장
+typedef struct
+{
+  uint8_t state;  // ntrip_chunk_state_t
+  uint8_t digits; // SIZE: 읽은 HEX 자리수, HEAD: 맞춘 "\r\n\r\n" 바이트 수
+  uint32_t left;  // SIZE: 읽는 중인 크기, DATA: 남은 데이터
+} ntrip_chunk_t;
 
-// NTRIP TCP 소켓 (GGA 전송용)
-static tcp_socket_t *g_ntrip_socket = NULL;
+/**
+ * @brief 캐스터 하나에 대한 연결 (소켓 + 수신 태스크)
+ *
+ * 두 link 가 같은 코드로 각자 연결을 유지하고, g_ntrip_active 인 쪽만
+ * 보정 데이터를 라우터로 넘기고 GGA 를 받는다. 대기 link 의 스트림은 버린다.
+ */
+typedef struct
+{
+  gsm_t *gsm;
+  uint8_t connect_id;
+  tcp_socket_t *sock;
+  TaskHandle_t task;
+  size_t request_len;                  // 0 이면 다시 생성
+  uint32_t params_version;             // 요청/주소를 만든 설정 version (flash_params_changed)
+  char addr[GSM_DNS_ADDR_SIZE];        // DNS 조회한 캐스터 주소 (비어 있으면 다음 연결 때 조회)
+  volatile uint32_t rx_bytes;          // sink 가 GSM 태스크에서 갱신
+  volatile bool peer_closed;
+  volatile bool ready;                 // HTTP 200 까지 끝나 스트림 수신 중
+  volatile bool remount;               // 캐스터 설정/마운트포인트가 바뀜, 태스크가 다시 붙음
+  ntrip_chunk_t chunk;                 // v2 chunked 디코더 (연결 시도마다 초기화)
+} ntrip_link_t;
+
+static ntrip_link_t g_ntrip_links[NTRIP_LINK_MAX];
+CCM_BSS static char g_ntrip_http_request[NTRIP_LINK_MAX][512]; // link 별 HTTP 요청
+
+// 보정 데이터를 라우터로 넘기고 GGA 를 보내는 link
+static volatile uint8_t g_ntrip_active = NTRIP_LINK_PRIMARY;
 static bool g_ntrip_connected = false;
 
-// GGA 전송 큐
-static QueueHandle_t g_gga_send_queue = NULL;
+// 아직 보내지 않은 최신 GGA (critical section 안에서만 만짐)
+static ntrip_gga_item_t g_gga_latest;
+static bool g_gga_pending = false;
+static volatile bool g_gga_inflight = false; // QISEND 대기열에 있는 GGA
+static TickType_t g_gga_last_sent = 0;
+static bool g_gga_sent_once = false;
+static volatile uint32_t g_gga_interval_ms = NTRIP_GGA_INTERVAL_DEFAULT_MS;
+static int g_gga_dl = -1; // epoch_dl 소비자 (GGA 를 보낼 큐에 넣은 때)
 
-// GGA 송신 태스크 핸들
-static TaskHandle_t g_gga_send_task_handle = NULL;
+// 데이터 한도 정책: 주 캐스터를 가벼운 마운트포인트로 (ntrip_set_thin)
+static volatile bool g_ntrip_thin = false;
 
 /**
- * @brief NTRIP 서버에 연결하고 HTTP 요청/응답 처리
- * @return 0: 성공, -1: 실패
+ * @brief link 에 해당하는 캐스터 설정
+ *
+ * @return false: 설정 없음
  */
-static int ntrip_connect_to_server(tcp_socket_t *sock)
+static bool ntrip_caster_cfg(uint8_t idx, ntrip_caster_cfg_t *cfg)
 {
-  int ret;
-  int retry_count = 0;
+  const user_params_t *params = flash_params_snapshot(NULL);
 
-  user_params_t *params = flash_params_get_current();
-  int ntrip_port = atoi(params->ntrip_port);
-
-  // HTTP 요청 생성
-  if (ntrip_build_http_request(g_ntrip_http_request, sizeof(g_ntrip_http_request)) < 0)
+  if (idx == NTRIP_LINK_STANDBY)
   {
-    LOG_ERR("HTTP 요청 생성 실패");
-    return -1;
+    cfg->url = params->ntrip2_url;
+    cfg->port = params->ntrip2_port;
+    cfg->mountpoint = params->ntrip2_mountpoint;
   }
-
-  LOG_DEBUG("HTTP 요청: %s", g_ntrip_http_request);
-
-  while (retry_count < NTRIP_MAX_CONNECT_RETRY)
+  else
   {
-    LOG_INFO("NTRIP 서버 연결 시도 [%d/%d]: %s:%d", retry_count + 1,
-             NTRIP_MAX_CONNECT_RETRY, params->ntrip_url, ntrip_port);
+    cfg->url = params->ntrip_url;
+    cfg->port = params->ntrip_port;
+    cfg->mountpoint = g_ntrip_thin && !flash_params_str_empty(params->ntrip_thin_mountpoint)
+                          ? params->ntrip_thin_mountpoint
+                          : params->ntrip_mountpoint;
+  }
 
-    led_set_color(LED_ID_1, LED_COLOR_YELLOW);  // 연결 시도 중
+  return !flash_params_str_empty(cfg->url) && !flash_params_str_empty(cfg->port);
+}
 
-    // TCP 연결
-    ret = tcp_connect(sock, NTRIP_CONTEXT_ID, params->ntrip_url, ntrip_port, 10000);
+static inline uint8_t ntrip_link_idx(const ntrip_link_t *link)
+{
+  return (uint8_t)(link - g_ntrip_links);
+}
 
-    if (ret != 0 || tcp_get_socket_state(sock, NTRIP_CONNECT_ID) != GSM_TCP_STATE_CONNECTED)
-    {
-      LOG_WARN("TCP 연결 실패 (ret=%d), 강제 닫기 후 재시도...", ret);
-      led_set_color(LED_ID_1, LED_COLOR_RED);  // 연결 실패
-      tcp_close_force(sock);
-      vTaskDelay(pdMS_TO_TICKS(1000));
-      retry_count++;
-      continue;
-    }
+static inline bool ntrip_link_is_active(const ntrip_link_t *link)
+{
+  return ntrip_link_idx(link) == g_ntrip_active;
+}
 
-    LOG_DEBUG("TCP 연결 성공");
+/**
+ * @brief 종료 문자 없는 버퍼에서 문자열 찾기
+ *
+ * @return 처음 나온 위치, 없으면 NULL
+ */
+static const char *ntrip_mem_find(const char *buf, size_t len, const char *pat)
+{
+  size_t pat_len = strlen(pat);
 
-    // HTTP 요청 전송
-    ret = tcp_send(sock, (const uint8_t *)g_ntrip_http_request, strlen(g_ntrip_http_request));
-    if (ret < 0)
+  for (size_t i = 0; i + pat_len <= len; i++)
+  {
+    if (buf[i] == pat[0] && memcmp(&buf[i], pat, pat_len) == 0)
     {
-      LOG_WARN("HTTP 요청 전송 실패: %d", ret);
-      tcp_close_force(sock);
-      vTaskDelay(pdMS_TO_TICKS(1000));
-      retry_count++;
-      continue;
+      return &buf[i];
     }
+  }
+  return NULL;
+}
 
-    LOG_DEBUG("HTTP 요청 전송 완료");
 
-    // HTTP 응답 수신
-    ret = tcp_recv(sock, recv_buf, sizeof(recv_buf), 0);
-    if (ret <= 0)
-    {
-      LOG_WARN("HTTP 응답 수신 실패: %d", ret);
-      tcp_close_force(sock);
-      vTaskDelay(pdMS_TO_TICKS(1000));
-      retry_count++;
-      continue;
-    }
+/**
+ * @brief 응답 헤더에 "Transfer-Encoding: chunked" 가 있는지 (대소문자 무시)
+ */
+static bool ntrip_header_chunked(const char *head, size_t len)
+{
+  static const char name[] = "Transfer-Encoding:";
+  const char *end = head + len;
 
-    // HTTP 응답 검증
-    recv_buf[ret] = '\0';
-    int log_len = ret > 200 ? 200 : ret;
-    LOG_DEBUG("HTTP 응답: %.*s", log_len, recv_buf);
+  for (const char *line = head; line < end;)
+  {
+    const char *eol = ntrip_mem_find(line, (size_t)(end - line), "\r\n");
+    size_t line_len = eol ? (size_t)(eol - line) : (size_t)(end - line);
 
-    if (strncmp((char *)recv_buf, "ICY 200", 7) == 0 ||
-        strstr((char *)recv_buf, "HTTP/1.0 200") != NULL ||
-        strstr((char *)recv_buf, "HTTP/1.1 200") != NULL)
+    if (line_len > sizeof(name) - 1 && strncasecmp(line, name, sizeof(name) - 1) == 0)
     {
-      LOG_INFO("NTRIP 서버 응답: 200 OK");
-      return 0; // 성공
+      for (size_t i = sizeof(name) - 1; i + 7 <= line_len; i++)
+      {
+        if (strncasecmp(&line[i], "chunked", 7) == 0)
+        {
+          return true;
+        }
+      }
     }
 
-    // 에러 응답 처리
-    char *status_line = strtok((char *)recv_buf, "\r\n");
-    if (status_line)
+    if (!eol)
     {
-      LOG_ERR("NTRIP 서버 에러 응답: %s", status_line);
-      if (strstr(status_line, "401"))
-      {
-        LOG_ERR("인증 실패 - ID/PW 확인 필요");
-      }
-      else if (strstr(status_line, "404"))
-      {
-        LOG_ERR("마운트포인트를 찾을 수 없음");
-      }
+      break;
     }
+    line = eol + 2;
+  }
+  return false;
+}
 
-    tcp_close_force(sock);
-    vTaskDelay(pdMS_TO_TICKS(1000));
-    retry_count++;
+/**
+ * @brief 보정 데이터 한 구간 (chunked 면 데이터 부분만)
+ *
+ * active link 의 데이터만 보정 라우터로 넘기고, 대기 link 는 바이트 수만 센다.
+ */
+static void ntrip_stream_input(ntrip_link_t *link, const uint8_t *data, size_t len)
+{
+  if (ntrip_link_is_active(link))
+  {
+    ntrip_mon_on_bytes(len);
+    rtcm_router_input(RTCM_SRC_NTRIP, data, len);
   }
+  link->rx_bytes += len;
+}
 
-  LOG_ERR("NTRIP 서버 연결 최대 재시도 횟수 초과");
+static inline int ntrip_hex_digit(uint8_t c)
+{
+  if (c >= '0' && c <= '9')
+  {
+    return c - '0';
+  }
+  c |= 0x20;
+  if (c >= 'a' && c <= 'f')
+  {
+    return c - 'a' + 10;
+  }
   return -1;
 }
 
 /**
- * @brief GGA 송신 전용 태스크
+ * @brief 받은 조각 하나를 chunked 디코더로 (복사 없음)
+ *
+ * 조각 안의 데이터 구간을 그대로 ntrip_stream_input() 으로 넘긴다. chunk 와
+ * 조각 경계는 어디서든 갈릴 수 있고 (크기 줄 중간, CRLF 사이 포함), RTCM
+ * 프레임이 chunk 경계에 걸쳐도 라우터가 구간을 이어서 프레임을 맞춘다.
  *
- * GGA 큐에서 데이터를 블로킹 대기하여 즉시 전송
- * - 폴링 없이 이벤트 기반 동작
- * - RTCM 수신과 완전히 독립적으로 동작
+ * @param deliver false 면 틀만 따라가고 데이터는 버림 (sink 전환 전 조각)
+ * @return false: 틀 어긋남이나 스트림 끝 (재연결 필요)
  */
-static void ntrip_gga_send_task(void *pvParameter)
+static bool ntrip_chunk_feed(ntrip_link_t *link, const uint8_t *data, size_t len, bool deliver)
 {
-  tcp_socket_t *sock = (tcp_socket_t *)pvParameter;
-  ntrip_gga_queue_item_t gga_item;
+  ntrip_chunk_t *ck = &link->chunk;
+  size_t i = 0;
 
-  LOG_INFO("GGA 송신 태스크 시작");
-
-  while (1)
+  if (ck->state == NTRIP_CHUNK_OFF)
   {
-    // GGA 큐에서 블로킹 대기 (데이터 도착 즉시 깨어남)
-    if (xQueueReceive(g_gga_send_queue, &gga_item, portMAX_DELAY) == pdTRUE)
+    if (deliver)
     {
+      ntrip_stream_input(link, data, len);
+    }
+    return true;
+  }
+
+  while (i < len)
+  {
+    uint8_t c = data[i];
 
-      // 연결 상태 확인
-      if (!g_ntrip_connected)
+    switch (ck->state)
+    {
+    case NTRIP_CHUNK_HEAD:
+      // "\r\n\r\n" 을 맞출 때까지
+      if (c == (uint8_t)"\r\n\r\n"[ck->digits])
       {
-        LOG_DEBUG("NTRIP 소켓 연결 안됨");
-        continue;
+        ck->digits++;
+      }
+      else
+      {
+        ck->digits = c == '\r' ? 1 : 0;
+      }
+      i++;
+      if (ck->digits == 4)
+      {
+        ck->state = NTRIP_CHUNK_SIZE;
+        ck->digits = 0;
+        ck->left = 0;
       }
+      break;
 
-      // GGA 전송
-      int ret = tcp_send(sock, (const uint8_t *)gga_item.data, gga_item.len);
+    case NTRIP_CHUNK_SIZE:
+    {
+      int v = ntrip_hex_digit(c);
 
-      if (ret > 0)
+      i++;
+      if (v >= 0 && ck->digits < 8)
       {
-        LOG_INFO("GGA 전송 완료 (%d bytes): %.*s",
-                 gga_item.len, gga_item.len, gga_item.data);
+        ck->left = (ck->left << 4) | (uint32_t)v;
+        ck->digits++;
+        break;
+      }
+      if (ck->digits == 0 || v >= 0)
+      {
+        // 자리수 없음, 32 비트 넘는 크기
+        ck->state = NTRIP_CHUNK_ERROR;
+      }
+      else if (c == '\n')
+      {
+        ck->state = ck->left ? NTRIP_CHUNK_DATA : NTRIP_CHUNK_END;
       }
       else
       {
-        LOG_WARN("GGA 전송 실패: %d", ret);
-        // 전송 실패해도 계속 진행 (다음 GGA는 다시 시도)
-        // 연결이 끊어진 경우 수신 태스크에서 재연결 처리
+        ck->state = NTRIP_CHUNK_EXT; // ';' 확장, 공백, CR
+      }
+      break;
+    }
+
+    case NTRIP_CHUNK_EXT:
+      i++;
+      if (c == '\n')
+      {
+        ck->state = ck->left ? NTRIP_CHUNK_DATA : NTRIP_CHUNK_END;
+      }
+      break;
+
+    case NTRIP_CHUNK_DATA:
+    {
+      size_t n = len - i;
+
+      if (n > ck->left)
+      {
+        n = ck->left;
+      }
+      if (deliver)
+      {
+        ntrip_stream_input(link, &data[i], n);
       }
+      i += n;
+      ck->left -= (uint32_t)n;
+      if (ck->left == 0)
+      {
+        ck->state = NTRIP_CHUNK_DATA_END;
+      }
+      break;
+    }
+
+    case NTRIP_CHUNK_DATA_END:
+      i++;
+      if (c == '\n')
+      {
+        ck->state = NTRIP_CHUNK_SIZE;
+        ck->digits = 0;
+        ck->left = 0;
+      }
+      else if (c != '\r')
+      {
+        ck->state = NTRIP_CHUNK_ERROR;
+      }
+      break;
+
+    case NTRIP_CHUNK_END:
+    case NTRIP_CHUNK_ERROR:
+    default:
+      return false;
     }
   }
+
+  return ck->state != NTRIP_CHUNK_END && ck->state != NTRIP_CHUNK_ERROR;
 }
 
 /**
- * @brief NTRIP TCP 수신 태스크
+ * @brief 캐스터 주소 (처음 한 번 DNS 조회 후 캐시)
+ *
+ * 조회에 실패하면 호스트 이름을 그대로 써서 모뎀이 조회하게 한다.
  */
-static void ntrip_tcp_recv_task(void *pvParameter)
+static const char *ntrip_caster_addr(ntrip_link_t *link, const char *host)
 {
-  gsm_t *gsm = (gsm_t *)pvParameter;
-  tcp_socket_t *sock = NULL;
-  gps_t *gps_handle = gps_get_instance_handle(0);
-
-  int ret;
-  int timeout_count = 0;   // 연속 타임아웃 카운터
-  int reconnect_count = 0; // 총 재연결 시도 횟수
+  if (link->addr[0] == '\0' &&
+      gsm_dns_resolve(link->gsm, NTRIP_CONTEXT_ID, host, link->addr,
+                      sizeof(link->addr), NTRIP_DNS_TIMEOUT_MS) == 0)
+  {
+    LOG_INFO("캐스터 주소 캐시: %s -> %s", host, link->addr);
+  }
 
-  LOG_INFO("NTRIP 태스크 시작");
-  led_set_color(LED_ID_1, LED_COLOR_YELLOW);  // 연결 시도 중
+  return link->addr[0] ? link->addr : host;
+}
 
-   if (!g_gga_send_queue)
+/**
+ * @brief TCP 연결 + HTTP 요청/응답 한 번 시도 (대기 없음)
+ * @return 0: 성공, -1: 실패 (소켓은 닫힌 상태)
+ */
+static int ntrip_try_connect(ntrip_link_t *link, const char *addr, int port)
+{
+  tcp_socket_t *sock = link->sock;
+  bool active = ntrip_link_is_active(link);
+  int ret;
 
+  if (active)
   {
+    led_set_color(LED_ID_1, LED_COLOR_YELLOW);  // 연결 시도 중
+  }
 
-    int queue_retry = 0;
-
-    while (queue_retry < NTRIP_INIT_MAX_RETRY)
+  // TCP 연결
+  tcp_set_access_mode(sock, NTRIP_ACCESS_MODE);
+  ret = tcp_connect(sock, NTRIP_CONTEXT_ID, addr, port, 10000);
 
+  if (ret != 0 || tcp_get_socket_state(sock, link->connect_id) != GSM_TCP_STATE_CONNECTED)
+  {
+    LOG_WARN("TCP 연결 실패 (ret=%d), 강제 닫기 후 재시도...", ret);
+    if (active)
     {
+      led_set_color(LED_ID_1, LED_COLOR_RED);  // 연결 실패
+    }
+    tcp_close_force(sock);
+    return -1;
+  }
 
-      g_gga_send_queue = xQueueCreate(NTRIP_GGA_QUEUE_SIZE, sizeof(ntrip_gga_queue_item_t));
-
-      if (g_gga_send_queue)
+  LOG_DEBUG("TCP 연결 성공");
 
-      {
+  // HTTP 요청 전송
+  ret = tcp_send(sock, (const uint8_t *)g_ntrip_http_request[ntrip_link_idx(link)], link->request_len);
+  if (ret < 0)
+  {
+    LOG_WARN("HTTP 요청 전송 실패: %d", ret);
+    tcp_close_force(sock);
+    return -1;
+  }
 
-        LOG_INFO("GGA 전송 큐 생성 완료");
+  LOG_DEBUG("HTTP 요청 전송 완료");
 
-        break;
+  // HTTP 응답 수신 (pbuf 를 그대로 검사)
+  tcp_pbuf_t *resp = NULL;
+  ret = tcp_recv_pbuf(sock, &resp, 0);
+  if (ret <= 0)
+  {
+    LOG_WARN("HTTP 응답 수신 실패: %d", ret);
+    tcp_close_force(sock);
+    return -1;
+  }
 
-      }
+  // HTTP 응답 검증
+  const char *head = (const char *)resp->payload;
+  size_t head_len = resp->len;
+  int log_len = ret > 200 ? 200 : ret;
+  LOG_DEBUG("HTTP 응답: %.*s", log_len, head);
 
- 
+  bool icy = head_len >= 7 && memcmp(head, "ICY 200", 7) == 0;
 
-      queue_retry++;
+  if (icy ||
+      ntrip_mem_find(head, head_len, "HTTP/1.0 200") != NULL ||
+      ntrip_mem_find(head, head_len, "HTTP/1.1 200") != NULL)
+  {
+    // v1 (ICY) 은 첫 줄 다음부터, HTTP 는 헤더 끝 빈 줄 다음부터 본문
+    const char *eoh = ntrip_mem_find(head, head_len, icy ? "\r\n" : "\r\n\r\n");
+    size_t body = eoh ? (size_t)(eoh - head) + (icy ? 2 : 4) : head_len;
 
-      LOG_ERR("GGA 전송 큐 생성 실패, 재시도 중... (%d/%d)", queue_retry, NTRIP_INIT_MAX_RETRY);
+    memset(&link->chunk, 0, sizeof(link->chunk));
+    if (!icy && ntrip_header_chunked(head, body))
+    {
+      // 헤더가 이 조각에서 안 끝났으면 나머지 헤더부터 건너뛴다
+      link->chunk.state = eoh ? NTRIP_CHUNK_SIZE : NTRIP_CHUNK_HEAD;
+    }
+    LOG_INFO("NTRIP 서버 응답: 200 OK (%s)",
+             icy ? "v1" : link->chunk.state != NTRIP_CHUNK_OFF ? "v2 chunked" : "HTTP");
 
-      vTaskDelay(pdMS_TO_TICKS(NTRIP_INIT_RETRY_BASE_DELAY_MS * queue_retry));
+    // 응답과 같은 세그먼트로 온 보정 데이터는 sink 전환 전에 넘긴다.
+    // v1 에서 남은 헤더 바이트는 라우터가 RTCM 프리앰블/CRC 로 걸러낸다.
+    if (body < head_len)
+    {
+      ntrip_chunk_feed(link, &resp->payload[body], head_len - body, true);
+    }
+    tcp_recv_release(resp);
+    return 0; // 성공
+  }
 
+  // 에러 응답 처리
+  const char *eol = ntrip_mem_find(head, head_len, "\r\n");
+  int line_len = (int)(eol ? (size_t)(eol - head) : head_len);
+  if (line_len > 0)
+  {
+    LOG_ERR("NTRIP 서버 에러 응답: %.*s", line_len, head);
+    if (ntrip_mem_find(head, (size_t)line_len, "401"))
+    {
+      LOG_ERR("인증 실패 - ID/PW 확인 필요");
+    }
+    else if (ntrip_mem_find(head, (size_t)line_len, "404"))
+    {
+      LOG_ERR("마운트포인트를 찾을 수 없음");
     }
+  }
+  tcp_recv_release(resp);
 
- 
+  tcp_close_force(sock);
+  return -1;
+}
 
-    if (!g_gga_send_queue)
+/**
+ * @brief NTRIP 서버에 연결하고 HTTP 요청/응답 처리
+ *
+ * HTTP 요청과 캐스터 주소는 처음 한 번만 만들고 재연결에 재사용한다
+ * (설정이 다시 게시되면 새로 만든다).
+ * 첫 시도는 대기 없이 바로 하고, 실패한 뒤부터 1초씩 쉰다.
+ * PDP context 는 건드리지 않는다.
+ *
+ * @return 0: 성공, -1: 실패
+ */
+static int ntrip_connect_to_server(ntrip_link_t *link)
+{
+  uint8_t idx = ntrip_link_idx(link);
+  int retry_count = 0;
+  ntrip_caster_cfg_t cfg;
 
-    {
+  // 캐스터나 계정이 바뀌었을 때만 요청과 주소를 다시 만든다
+  if (flash_params_changed(&link->params_version))
+  {
+    link->request_len = 0;
+    link->addr[0] = '\0';
+  }
 
-      LOG_ERR("GGA 전송 큐 생성 최종 실패 - 태스크 종료");
-      led_set_color(LED_ID_1, LED_COLOR_RED); 
-      g_ntrip_recv_task_handle = NULL; 
-      vTaskDelete(NULL);
+  if (!ntrip_caster_cfg(idx, &cfg))
+  {
+    LOG_ERR("캐스터 설정 없음 (link=%d)", idx);
+    return -1;
+  }
 
-      return;
+  int ntrip_port = atoi(cfg.port);
 
+  // HTTP 요청 생성 (ntrip_stop() 전까지 유지)
+  if (link->request_len == 0)
+  {
+    int len = ntrip_build_http_request(&cfg, g_ntrip_http_request[idx], sizeof(g_ntrip_http_request[idx]));
+    if (len < 0)
+    {
+      LOG_ERR("HTTP 요청 생성 실패");
+      return -1;
     }
-
+    link->request_len = (size_t)len;
+    LOG_DEBUG("HTTP 요청: %s", g_ntrip_http_request[idx]);
   }
 
- 
-
-  // ========================================
+  while (retry_count < NTRIP_MAX_CONNECT_RETRY)
+  {
+    const char *addr = ntrip_caster_addr(link, cfg.url);
 
-  // 2단계: 초기 연결 (소켓 생성 + 서버 연결 + HTTP 헤더 전송) - 재시도
+    LOG_INFO("NTRIP 서버 연결 시도 [%d/%d] (link=%d): %s:%d", retry_count + 1,
+             NTRIP_MAX_CONNECT_RETRY, idx, addr, ntrip_port);
 
-  // ========================================
+    if (ntrip_try_connect(link, addr, ntrip_port) == 0)
+    {
+      return 0;
+    }
 
-  int init_retry = 0;
+    // 캐시한 주소가 바뀌었을 수 있으니 다음 시도는 다시 조회
+    link->addr[0] = '\0';
 
-  bool init_success = false;
+    vTaskDelay(pdMS_TO_TICKS(1000));
+    retry_count++;
+  }
 
- 
+  LOG_ERR("NTRIP 서버 연결 최대 재시도 횟수 초과 (link=%d)", idx);
+  return -1;
+}
 
-  while (init_retry < NTRIP_INIT_MAX_RETRY && !init_success)
+/**
+ * @brief GGA 송신 완료 (AT 처리/파서 태스크)
+ */
+static void ntrip_gga_sent_cb(uint8_t connect_id, bool ok, void *ctx)
+{
+  (void)ctx;
 
+  g_gga_inflight = false;
+  if (!ok)
   {
+    // 다음 GGA 는 다시 시도, 끊긴 경우 재연결은 수신 태스크에서 처리
+    LOG_WARN("GGA 전송 실패 (cid=%d)", connect_id);
+  }
+}
 
-    LOG_INFO("초기 연결 시도 (%d/%d)", init_retry + 1, NTRIP_INIT_MAX_RETRY);
-
- 
+/**
+ * @brief 최신 GGA 를 active link 로 비동기 전송
+ *
+ * GPS 태스크(새 GGA)와 link 태스크(재연결)에서 불린다. SEND OK 를 기다리지
+ * 않으므로 호출한 태스크는 막히지 않는다.
+ * - g_gga_interval_ms 안에 들어온 GGA 는 최신값만 남았다가 다음 기회에 나간다
+ * - 앞 GGA 가 아직 QISEND 대기열에 있으면 새로 넣지 않는다
+ *
+ * @param force true: 간격 무시 (재연결 직후)
+ */
+static void ntrip_gga_flush(bool force)
+{
+  ntrip_gga_item_t item;
+  TickType_t now = xTaskGetTickCount();
+  bool due;
 
-    // 2-1. TCP 소켓 생성
+  if (!g_ntrip_connected)
+  {
+    return;
+  }
 
-    sock = tcp_socket_create(gsm, NTRIP_CONNECT_ID);
+  taskENTER_CRITICAL();
+  due = g_gga_pending && !g_gga_inflight &&
+        (force || !g_gga_sent_once ||
+         (now - g_gga_last_sent) >= pdMS_TO_TICKS(g_gga_interval_ms));
+  if (due)
+  {
+    memcpy(&item, &g_gga_latest, sizeof(item));
+    g_gga_pending = false;
+    g_gga_inflight = true;
+    g_gga_last_sent = now;
+    g_gga_sent_once = true;
+  }
+  taskEXIT_CRITICAL();
 
-    if (!sock)
+  if (!due)
+  {
+    return;
+  }
 
+  tcp_pbuf_t *pbuf = tcp_pbuf_alloc(item.len);
+  if (pbuf)
+  {
+    memcpy(pbuf->payload, item.data, item.len);
+    if (tcp_send_async(g_ntrip_links[g_ntrip_active].sock, pbuf, true,
+                       ntrip_gga_sent_cb, NULL) == 0)
     {
+      LOG_DEBUG("GGA 전송 요청 (%d bytes)", item.len);
+      return;
+    }
+    tcp_pbuf_free(pbuf);
+  }
 
-      init_retry++;
-
-      LOG_ERR("TCP 소켓 생성 실패, 재시도 대기... (%d/%d)", init_retry, NTRIP_INIT_MAX_RETRY);
-
-      vTaskDelay(pdMS_TO_TICKS(NTRIP_INIT_RETRY_BASE_DELAY_MS * init_retry));
+  g_gga_inflight = false;
+  LOG_WARN("GGA 전송 요청 실패 (pbuf=%d)", pbuf != NULL);
+}
 
-      continue;
+/**
+ * @brief 보정 데이터 sink (GSM 태스크 컨텍스트)
+ *
+ * active link 의 데이터만 보정 라우터로 바로 넘기고, 대기 link 는 바이트 수만
+ * 센다 (v2 chunked 면 데이터 구간만). 수신 태스크를 깨운다. data 가 NULL 이면
+ * 상대가 연결을 끊은 것이다.
+ */
+static void ntrip_corr_sink(const uint8_t *data, size_t len, void *ctx)
+{
+  ntrip_link_t *link = (ntrip_link_t *)ctx;
 
-    }
+  if (data == NULL || !ntrip_chunk_feed(link, data, len, true))
+  {
+    // chunked 틀이 어긋났거나 크기 0 chunk 도 끊긴 것으로 보고 재연결
+    link->peer_closed = true;
+  }
 
-    LOG_INFO("TCP 소켓 생성 완료");
+  if (link->task)
+  {
+    xTaskNotifyGive(link->task);
+  }
+}
 
-    g_ntrip_socket = sock;
+/**
+ * @brief 연결 직후 보정 데이터를 sink 로 받도록 전환
+ *
+ * 전환 전에 큐에 들어온 데이터는 버린다. 라우터의 NTRIP 입력을 GSM
+ * 태스크 하나로 유지하기 위해서다 (다음 프레임부터 다시 맞춘다).
+ * v2 chunked 는 버리는 조각도 디코더에 넣어 chunk 틀은 이어 간다.
+ */
+static void ntrip_stream_start(ntrip_link_t *link)
+{
+  tcp_socket_t *sock = link->sock;
 
- 
+  pm_trace(PM_EVT_NTRIP_UP, ntrip_link_idx(link), link->rx_bytes);
+  link->peer_closed = false;
+  tcp_set_sink(sock, ntrip_corr_sink, link);
 
-    // 2-2. 서버 연결 (TCP + HTTP 요청/응답)
-    if (ntrip_connect_to_server(sock) != 0)
+  while (tcp_available(sock) > 0)
+  {
+    tcp_pbuf_t *pbuf = NULL;
+    if (tcp_recv_pbuf(sock, &pbuf, 1) < 0)
     {
-      init_retry++;
-      LOG_ERR("서버 연결 실패, 재시도 대기... (%d/%d)", init_retry, NTRIP_INIT_MAX_RETRY);
-      tcp_socket_destroy(sock);
-      sock = NULL;
-      g_ntrip_socket = NULL;
-      vTaskDelay(pdMS_TO_TICKS(NTRIP_INIT_RETRY_BASE_DELAY_MS * init_retry));
-      continue;
+      // sink 설정 전에 끊긴 경우 종료 표시를 여기서 받는다
+      link->peer_closed = true;
+      break;
     }
+    if (!ntrip_chunk_feed(link, pbuf->payload, pbuf->len, false))
+    {
+      link->peer_closed = true;
+    }
+    tcp_recv_release(pbuf);
+  }
+}
 
-    LOG_INFO("서버 연결 완료");
-
- 
-
-    // 모든 초기화 단계 성공
+/**
+ * @brief active link 가 (다시) 스트림을 받기 시작했을 때 공통 처리
+ */
+static void ntrip_active_up(void)
+{
+  led_set_color(LED_ID_1, LED_COLOR_GREEN);
+  ntrip_mon_link_up();
+  g_ntrip_connected = true;
+  boot_timeline_mark(BOOT_MARK_NTRIP);
+  ntrip_gga_flush(true);
+  base_auto_fix_on_ntrip_connected(true);
+}
 
-    init_success = true;
+/**
+ * @brief active link 가 멈췄을 때 연결돼 있는 대기 link 로 넘긴다
+ *
+ * 대기 link 는 이미 HTTP 200 을 받고 스트림을 받고 있으므로 다음 조각부터
+ * 바로 라우터로 들어간다. 넘긴 뒤 원래 link 는 대기 link 로 재연결한다.
+ *
+ * @return true: 전환됨
+ */
+static bool ntrip_failover(ntrip_link_t *link)
+{
+  uint8_t from = ntrip_link_idx(link);
+  uint8_t to = (uint8_t)(NTRIP_LINK_MAX - 1 - from);
 
+  if (!ntrip_link_is_active(link) || !g_ntrip_links[to].ready)
+  {
+    return false;
   }
 
- 
+  g_ntrip_active = to;
+  LOG_WARN("보정 스트림 전환: link %d -> %d", from, to);
+  ntrip_mon_failover();
+  ntrip_active_up();
 
-  // 초기화 최종 실패 확인
+  return true;
+}
 
-  if (!init_success)
+/**
+ * @brief 끊긴 link 재연결
+ *
+ * @return true: 재연결 성공, 스트림 수신 중
+ */
+static bool ntrip_link_reconnect(ntrip_link_t *link)
+{
+  bool active = ntrip_link_is_active(link);
 
+  link->ready = false;
+  pm_trace(PM_EVT_NTRIP_DOWN, ntrip_link_idx(link), link->rx_bytes);
+  if (active)
   {
+    led_set_color(LED_ID_1, LED_COLOR_RED);
+    ntrip_mon_link_down();
+    g_ntrip_connected = false;
+  }
 
-    LOG_ERR("초기 연결 최종 실패 - 태스크 종료");
-led_set_color(LED_ID_1, LED_COLOR_RED); 
-    if (sock)
-
-    {
+  tcp_set_sink(link->sock, NULL, NULL);
+  tcp_close_force(link->sock);
 
-      tcp_socket_destroy(sock);
+  // 짧은 LTE 끊김이 대부분이라 대기 없이 바로 재연결 (실패 후에만 backoff)
+  if (ntrip_connect_to_server(link) != 0)
+  {
+    return false;
+  }
 
-      g_ntrip_socket = NULL;
+  link->ready = true;
+  // 재연결하는 동안 active 가 바뀌었을 수 있으므로 다시 확인
+  if (ntrip_link_is_active(link))
+  {
+    ntrip_active_up();
+  }
+  ntrip_stream_start(link);
 
-    }
-    g_ntrip_recv_task_handle = NULL;
+  return true;
+}
 
-    // board_config_t* config = board_get_config();
-    // if(config->use_rs485)
-    // {
-    //   RS485_Send("")
-    // }
-    vTaskDelete(NULL);
+/**
+ * @brief NTRIP link 수신 태스크 (주 캐스터, 보조 캐스터 각각 하나)
+ *
+ * 주 link 태스크는 GGA 큐/태스크도 맡는다. 대기 link 는 데이터가 없어도
+ * 소켓이 살아 있으면 재연결하지 않는다 (VRS 는 GGA 없이는 보내지 않음).
+ */
+static void ntrip_link_task(void *pvParameter)
+{
+  ntrip_link_t *link = (ntrip_link_t *)pvParameter;
+  uint8_t idx = ntrip_link_idx(link);
+  bool primary = idx == NTRIP_LINK_PRIMARY;
 
-    return;
+  int ret;
+  uint32_t rx_seen;
+  int timeout_count = 0;   // 연속 타임아웃 카운터
+  int reconnect_count = 0; // 총 재연결 시도 횟수
 
+  LOG_INFO("NTRIP 태스크 시작 (link=%d)", idx);
+  if (primary)
+  {
+    led_set_color(LED_ID_1, LED_COLOR_YELLOW);  // 연결 시도 중
   }
 
- 
-
   // ========================================
-
-  // 3단계: 연결 성공 후 상태 설정
-
+  // 초기 연결 (소켓 생성 + 서버 연결 + HTTP 헤더 전송) - 재시도
+  // 보조 캐스터가 있으면 주 캐스터도 한도 없이 재시도하고 그동안 보조로 넘긴다
   // ========================================
+  int init_retry = 0;
+  bool init_success = false;
+  bool retry_forever = !primary || g_ntrip_links[NTRIP_LINK_STANDBY].task != NULL;
 
-  LOG_INFO("NTRIP 초기 연결 완료!");
-
-  g_ntrip_connected = true;
-
-  base_auto_fix_on_ntrip_connected(true);
+  while (!init_success && (retry_forever || init_retry < NTRIP_INIT_MAX_RETRY))
+  {
+    TickType_t retry_delay = init_retry < NTRIP_INIT_MAX_RETRY && primary
+        ? pdMS_TO_TICKS(NTRIP_INIT_RETRY_BASE_DELAY_MS * (init_retry + 1))
+        : pdMS_TO_TICKS(NTRIP_STANDBY_RETRY_MS);
 
-  led_set_color(LED_ID_1, LED_COLOR_GREEN);
+    LOG_INFO("초기 연결 시도 (link=%d, %d회)", idx, init_retry + 1);
 
- 
+    if (!link->sock)
+    {
+      link->sock = tcp_socket_create(link->gsm, link->connect_id);
+      if (!link->sock)
+      {
+        init_retry++;
+        LOG_ERR("TCP 소켓 생성 실패, 재시도 대기... (link=%d)", idx);
+        vTaskDelay(retry_delay);
+        continue;
+      }
+      LOG_INFO("TCP 소켓 생성 완료");
+    }
 
-  // GGA 송신 태스크 생성
+    if (ntrip_connect_to_server(link) != 0)
+    {
+      init_retry++;
+      LOG_ERR("서버 연결 실패, 재시도 대기... (link=%d)", idx);
+      ntrip_failover(link);
+      vTaskDelay(retry_delay);
+      continue;
+    }
 
-  if (g_gga_send_task_handle == NULL)
+    LOG_INFO("서버 연결 완료 (link=%d)", idx);
+    init_success = true;
+  }
 
+  // 초기화 최종 실패 확인
+  if (!init_success)
   {
+    LOG_ERR("초기 연결 최종 실패 - 태스크 종료");
+    led_set_color(LED_ID_1, LED_COLOR_RED);
+    if (link->sock)
+    {
+      tcp_socket_destroy(link->sock);
+      link->sock = NULL;
+    }
+    link->task = NULL;
+    vTaskDelete(NULL);
+    return;
+  }
 
-    xTaskCreate(ntrip_gga_send_task, "gga_send", 1024, sock,
-
-                tskIDLE_PRIORITY + 2, &g_gga_send_task_handle);
-
-    LOG_INFO("GGA 송신 태스크 생성 완료");
+  // ========================================
+  // 연결 성공 후 상태 설정
+  // ========================================
+  LOG_INFO("NTRIP 초기 연결 완료! (link=%d)", idx);
+  link->ready = true;
 
+  if (ntrip_link_is_active(link))
+  {
+    ntrip_active_up();
   }
+  ntrip_stream_start(link);
+  rx_seen = link->rx_bytes;
 
   while (1)
   {
-    ret = tcp_recv(sock, recv_buf, sizeof(recv_buf), 0);
+    // 데이터는 sink 가 GPS 로 넘기고 여기서는 수신 여부만 본다
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(NTRIP_RECV_TIMEOUT_MS));
+
+    uint32_t rx_now = link->rx_bytes;
+    bool active = ntrip_link_is_active(link);
+
+    if (link->peer_closed)
+    {
+      ret = -1;
+    }
+    else
+    {
+      ret = (int)(rx_now - rx_seen);
+    }
+    rx_seen = rx_now;
+
+    // 캐스터 설정이나 마운트포인트가 바뀜: 끊긴 것이 아니므로 대기 link 로 넘기지 않고 다시 붙음
+    if (link->remount)
+    {
+      link->remount = false;
+      link->request_len = 0;
+      LOG_INFO("캐스터 설정 변경 (link=%d, thin=%d), 재연결", idx, g_ntrip_thin);
+      if (ntrip_link_reconnect(link))
+      {
+        timeout_count = 0;
+        rx_seen = link->rx_bytes;
+      }
+      continue;
+    }
 
     if (ret > 0)
     {
       // 수신 성공
-      led_set_color(LED_ID_1, LED_COLOR_GREEN);
+      if (active)
+      {
+        led_set_color(LED_ID_1, LED_COLOR_GREEN);
+      }
       timeout_count = 0;
-      LOG_DEBUG("수신 데이터 (%d bytes):", ret);
+      LOG_DEBUG("수신 데이터 (link=%d, %d bytes):", idx, ret);
+      continue;
+    }
 
-      gps_handle->ops->send((const char *)recv_buf, ret);
+    // 소켓 상태 확인
+    gsm_tcp_state_t state = tcp_get_socket_state(link->sock, link->connect_id);
+    bool sock_down = state == GSM_TCP_STATE_CLOSING || state == GSM_TCP_STATE_CLOSED;
+
+    if (ret == 0 && !active)
+    {
+      // 대기 link: 소켓만 살아 있으면 된다
+      if (!sock_down)
+      {
+        continue;
+      }
+      ret = -1;
     }
-    else if (ret == 0)
+
+    if (ret == 0)
     {
       // 타임아웃
       led_set_color(LED_ID_1, LED_COLOR_YELLOW);
@@ -520,292 +1046,311 @@ led_set_color(LED_ID_1, LED_COLOR_RED);
 
       LOG_WARN("수신 타임아웃 (%d/%d)", timeout_count, NTRIP_MAX_TIMEOUT_COUNT);
 
-      // 소켓 상태 확인
-      gsm_tcp_state_t state = tcp_get_socket_state(sock, NTRIP_CONNECT_ID);
-      if (state == GSM_TCP_STATE_CLOSING || state == GSM_TCP_STATE_CLOSED)
+      if (sock_down)
       {
         LOG_ERR("소켓 상태 비정상 (state=%d), 재연결 필요", state);
         timeout_count = NTRIP_MAX_TIMEOUT_COUNT; // 즉시 재연결
       }
 
-      // 연속 타임아웃 최대 횟수 초과 시 재연결
-      if (timeout_count >= NTRIP_MAX_TIMEOUT_COUNT)
+      // 대기 link 가 살아 있으면 타임아웃 한 번에 바로 넘기고 이 link 를 재연결
+      if (ntrip_failover(link))
       {
-        // 재연결 시작 전 큐 상태 확인
-        UBaseType_t queued_gga = uxQueueMessagesWaiting(g_gga_send_queue);
-        LOG_WARN("소켓 재연결 시도 (큐에 GGA %lu개 대기중)", queued_gga);
-        led_set_color(LED_ID_1, LED_COLOR_RED);
-
-        g_ntrip_connected = false;
-
-        tcp_close_force(sock);
-        vTaskDelay(pdMS_TO_TICKS(NTRIP_RECONNECT_DELAY_MS));
-
-        // 재연결 시도
-        if (ntrip_connect_to_server(sock) != 0)
-        {
-          reconnect_count++;
-          LOG_ERR("재연결 실패 (%d회)", reconnect_count);
+        timeout_count = NTRIP_MAX_TIMEOUT_COUNT;
+      }
 
-          // 재연결 실패 시 더 긴 대기
-          vTaskDelay(pdMS_TO_TICKS(NTRIP_RECONNECT_DELAY_MS * 2));
-        }
-        else
-        {
-          led_set_color(LED_ID_1, LED_COLOR_GREEN);
-          timeout_count = 0; // 타임아웃 카운터 리셋
-
-          // 재연결 중 쌓인 오래된 GGA 버리기 (최신 1개만 유지)
-          UBaseType_t queued_gga = uxQueueMessagesWaiting(g_gga_send_queue);
-          if (queued_gga > 1)
-          {
-            LOG_INFO("재연결 완료");
-
-            ntrip_gga_queue_item_t old_item;
-            while (queued_gga > 1)
-            {
-              xQueueReceive(g_gga_send_queue, &old_item, 0);
-              queued_gga--;
-            }
-          }
-          else if (queued_gga == 1)
-          {
-            LOG_INFO("재연결 완료");
-          }
-
-          g_ntrip_connected = true;
-          base_auto_fix_on_ntrip_connected(true);
-        }
+      // 연속 타임아웃 최대 횟수 초과 시 재연결
+      if (timeout_count < NTRIP_MAX_TIMEOUT_COUNT)
+      {
+        continue;
       }
+
+      LOG_WARN("소켓 재연결 시도 (link=%d)", idx);
     }
     else
     {
       // 에러
-      LOG_ERR("수신 에러: %d", ret);
-
-      // 소켓 상태 확인
-      gsm_tcp_state_t state = tcp_get_socket_state(sock, NTRIP_CONNECT_ID);
-      LOG_ERR("현재 소켓 상태: %d", state);
-
-      led_set_color(1, LED_COLOR_RED);
-
-      // ★ 연결 상태만 false로 설정 (태스크는 살려둠)
-      g_ntrip_connected = false;
-
-      tcp_close_force(sock);
-      vTaskDelay(pdMS_TO_TICKS(NTRIP_RECONNECT_DELAY_MS));
+      LOG_ERR("수신 에러 (link=%d): %d, 소켓 상태: %d", idx, ret, state);
+      ntrip_failover(link);
+    }
 
-      if (ntrip_connect_to_server(sock) != 0)
-      {
-        reconnect_count++;
-        LOG_ERR("재연결 실패 (%d회)", reconnect_count);
-        vTaskDelay(pdMS_TO_TICKS(NTRIP_RECONNECT_DELAY_MS * 2));
-      }
-      else
-      {
-        LOG_INFO("재연결 성공");
-        timeout_count = 0;
-        led_set_color(LED_ID_1, LED_COLOR_GREEN);
-        // 재연결 중 쌓인 오래된 GGA 버리기 (최신 1개만 유지)
-        UBaseType_t queued_gga = uxQueueMessagesWaiting(g_gga_send_queue);
-        if (queued_gga > 1)
-        {
-          LOG_INFO("재연결 완료");
-
-          // 오래된 데이터 모두 제거
-          ntrip_gga_queue_item_t old_item;
-          while (queued_gga > 1)
-          {
-            xQueueReceive(g_gga_send_queue, &old_item, 0);
-            queued_gga--;
-          }
-        }
-        else if (queued_gga == 1)
-        {
-          LOG_INFO("재연결 완료");
-        }
+    if (!ntrip_link_reconnect(link))
+    {
+      reconnect_count++;
+      LOG_ERR("재연결 실패 (link=%d, %d회)", idx, reconnect_count);
 
-        g_ntrip_connected = true;
-        base_auto_fix_on_ntrip_connected(true);
-      }
+      // 재연결 실패 시 더 긴 대기
+      vTaskDelay(pdMS_TO_TICKS(ntrip_link_is_active(link)
+                                   ? NTRIP_RECONNECT_DELAY_MS * 2
+                                   : NTRIP_STANDBY_RETRY_MS));
+    }
+    else
+    {
+      LOG_INFO("재연결 완료 (link=%d)", idx);
+      timeout_count = 0;
+      rx_seen = link->rx_bytes;
     }
   }
+}
 
-  LOG_WARN("TCP 연결 종료");
+/**
+ * @brief 라우터 프레임 관찰 콜백 (NTRIP 프레임만 모니터로)
+ */
+static void ntrip_frame_cb(rtcm_src_t src, uint16_t msg_type, size_t len)
+{
+  (void)len;
 
-  // GGA 송신 태스크 삭제
-  if (g_gga_send_task_handle != NULL)
+  if (src == RTCM_SRC_NTRIP)
   {
-    vTaskDelete(g_gga_send_task_handle);
-    g_gga_send_task_handle = NULL;
-    LOG_WARN("GGA 송신 태스크 삭제");
+    ntrip_mon_on_frame(msg_type);
   }
-
-  tcp_close(sock);
-  tcp_socket_destroy(sock);
-  g_ntrip_recv_task_handle = NULL; 
-  vTaskDelete(NULL);
-}
-
-void ntrip_task_create(gsm_t *gsm)
-{
-  xTaskCreate(ntrip_tcp_recv_task, "ntrip_recv", 1536, gsm,
-              tskIDLE_PRIORITY + 3, &g_ntrip_recv_task_handle);
 }
 
-int ntrip_send_gga_data(const char *data, uint8_t len)
+/**
+ * @brief GPS GGA 이벤트 - 최신 GGA 를 캐스터로 (LOW lane)
+ */
+static void ntrip_gga_evt_handler(const event_msg_t *msg)
 {
-  if (!data || len == 0 || len >= NTRIP_GGA_MAX_LEN)
-  {
-    LOG_ERR("유효하지 않은 GGA (len=%d)", len);
-    return -1;
-  }
+  const app_evt_gps_gga_t *evt = (const app_evt_gps_gga_t *)msg->data;
 
-  if (!g_gga_send_queue)
+  // 수신기가 둘인 Rover F9P 는 GPS_ID_BASE 위치만 보낸다
+  if (board_get_config()->board == BOARD_TYPE_ROVER_F9P && evt->id != GPS_ID_BASE)
   {
-    LOG_WARN("GGA 큐 초기화 필요");
-    return -2;
+    return;
   }
 
-  ntrip_gga_queue_item_t item;
-  memcpy(item.data, data, len);
-  item.data[len] = '\0';
-  item.len = len;
-
-  // 큐에 넣기 (블로킹 안 함, 큐가 가득 차면 실패)
-  if (xQueueSend(g_gga_send_queue, &item, 0) != pdTRUE)
+  if (ntrip_gga_send_queue_initialized())
   {
-    // 큐가 가득 참 - 오래된 데이터 하나 제거하고 다시 시도
-    ntrip_gga_queue_item_t old_item;
-    xQueueReceive(g_gga_send_queue, &old_item, 0);
-
-    if (xQueueSend(g_gga_send_queue, &item, 0) != pdTRUE)
-    {
-      LOG_WARN("GGA 전송 큐 가득참");
-      return -3;
-    }
-    LOG_DEBUG("GGA 전송 큐가 가득차 오래된 데이터 버림");
+    ntrip_send_gga_data(evt->raw, evt->len);
+    epoch_dl_done(g_gga_dl, evt->epoch);
   }
-
-  return len;
 }
 
-
-bool ntrip_gga_send_queue_initialized(void)
+/**
+ * @brief link 를 다시 붙이라고 요청 (link 태스크가 처리)
+ */
+static void ntrip_link_remount(ntrip_link_t *link)
 {
-  return g_gga_send_queue != NULL;
+  link->remount = true;
+  if (link->task)
+  {
+    xTaskNotifyGive(link->task);
+  }
 }
 
-void ntrip_stop(void)
+/**
+ * @brief 캐스터 설정 저장 (flash_params_watch, 게시한 태스크)
+ *
+ * ctx 는 바뀐 설정을 쓰는 link 의 bit. 돌고 있는 link 만 다시 붙이고, 보조 캐스터가
+ * 새로 생기거나 없어진 것은 태스크를 만들고 지워야 하므로 재부팅에 맡긴다.
+ * 주 link 가 아직 없으면 (NTRIP 시작 전) 시작할 때 새 설정을 읽는다.
+ */
+static bool ntrip_params_changed(const user_params_t *params, void *ctx)
 {
-    LOG_INFO("NTRIP 중지 시작...");
+  uint32_t links = (uint32_t)(uintptr_t)ctx;
+  ntrip_caster_cfg_t cfg;
+  bool ok = true;
 
-  g_ntrip_connected = false;
-
- 
-
-  // ★ 중요: 태스크를 먼저 삭제한 후 소켓/큐를 정리해야 함
-
- 
-
-  // 1. 수신 태스크 삭제 (tcp_recv를 더 이상 호출하지 않도록)
-
-  if (g_ntrip_recv_task_handle != NULL)
+  (void)params;
 
+  if ((links & (1U << NTRIP_LINK_PRIMARY)) && g_ntrip_links[NTRIP_LINK_PRIMARY].task)
   {
+    ntrip_link_remount(&g_ntrip_links[NTRIP_LINK_PRIMARY]);
+  }
 
-    // 태스크 유효성 확인 후 삭제
-
-    eTaskState state = eTaskGetState(g_ntrip_recv_task_handle);
-
-    if (state != eDeleted && state != eInvalid)
+  if (links & (1U << NTRIP_LINK_STANDBY))
+  {
+    ntrip_link_t *standby = &g_ntrip_links[NTRIP_LINK_STANDBY];
+    bool configured = ntrip_caster_cfg(NTRIP_LINK_STANDBY, &cfg);
 
+    if (standby->task && configured)
     {
-
-      vTaskDelete(g_ntrip_recv_task_handle);
-
-      LOG_INFO("NTRIP 수신 태스크 삭제");
-
+      ntrip_link_remount(standby);
     }
-
-    else
-
+    else if (g_ntrip_links[NTRIP_LINK_PRIMARY].task && (standby->task != NULL) != configured)
     {
-
-      LOG_INFO("NTRIP 수신 태스크 이미 종료됨");
-
+      ok = false;
     }
-
-    g_ntrip_recv_task_handle = NULL;
-
   }
+  return ok;
+}
 
- 
-
-  // 2. GGA 송신 태스크 삭제
+void ntrip_task_create(gsm_t *gsm)
+{
+  static bool gga_subscribed = false;
+  static bool params_watched = false;
+  ntrip_caster_cfg_t cfg;
 
-  if (g_gga_send_task_handle != NULL)
+  rtcm_router_set_frame_cb(ntrip_frame_cb);
 
+  if (!gga_subscribed)
   {
+    g_gga_dl = epoch_dl_register("caster", false);
+    gga_subscribed = app_event_subscribe(APP_EVT_BIT(APP_EVT_GPS_GGA), ntrip_gga_evt_handler,
+                                         EVENT_BUS_LANE_LOW);
+  }
 
-    // 태스크 유효성 확인 후 삭제
-
-    eTaskState state = eTaskGetState(g_gga_send_task_handle);
+  if (!params_watched)
+  {
+    void *primary = (void *)(uintptr_t)(1U << NTRIP_LINK_PRIMARY);
+    void *standby = (void *)(uintptr_t)(1U << NTRIP_LINK_STANDBY);
+    void *both = (void *)(uintptr_t)((1U << NTRIP_LINK_PRIMARY) | (1U << NTRIP_LINK_STANDBY));
+
+    flash_params_watch(FLASH_PARAMS_FIELD(ntrip_url), ntrip_params_changed, primary);
+    flash_params_watch(FLASH_PARAMS_FIELD(ntrip_port), ntrip_params_changed, primary);
+    flash_params_watch(FLASH_PARAMS_FIELD(ntrip_mountpoint), ntrip_params_changed, primary);
+    flash_params_watch(FLASH_PARAMS_FIELD(ntrip_thin_mountpoint), ntrip_params_changed, primary);
+    flash_params_watch(FLASH_PARAMS_FIELD(ntrip_id), ntrip_params_changed, both);
+    flash_params_watch(FLASH_PARAMS_FIELD(ntrip_pw), ntrip_params_changed, both);
+    flash_params_watch(FLASH_PARAMS_FIELD(ntrip2_url), ntrip_params_changed, standby);
+    flash_params_watch(FLASH_PARAMS_FIELD(ntrip2_port), ntrip_params_changed, standby);
+    flash_params_watch(FLASH_PARAMS_FIELD(ntrip2_mountpoint), ntrip_params_changed, standby);
+    params_watched = true;
+  }
 
-    if (state != eDeleted && state != eInvalid)
+  for (int i = 0; i < NTRIP_LINK_MAX; i++)
+  {
+    ntrip_link_t *link = &g_ntrip_links[i];
 
+    if (link->task != NULL)
     {
-
-      vTaskDelete(g_gga_send_task_handle);
-
-      LOG_INFO("GGA 송신 태스크 삭제");
-
+      continue; // 이미 동작 중
     }
+    memset(link, 0, sizeof(*link));
+    link->gsm = gsm;
+    link->connect_id = i == NTRIP_LINK_STANDBY ? NTRIP_STANDBY_CONNECT_ID : NTRIP_CONNECT_ID;
+  }
+  g_ntrip_active = NTRIP_LINK_PRIMARY;
 
-    else
+  HEAP_TRACK(HEAP_TAG_TASK,
+             xTaskCreate(ntrip_link_task, "ntrip_recv", 1536, &g_ntrip_links[NTRIP_LINK_PRIMARY],
+                         tskIDLE_PRIORITY + 3, &g_ntrip_links[NTRIP_LINK_PRIMARY].task));
 
-    {
+  if (ntrip_caster_cfg(NTRIP_LINK_STANDBY, &cfg))
+  {
+    LOG_INFO("보조 캐스터 대기 연결: %s:%s/%s", cfg.url, cfg.port, cfg.mountpoint);
+    HEAP_TRACK(HEAP_TAG_TASK,
+               xTaskCreate(ntrip_link_task, "ntrip_stby", 1536, &g_ntrip_links[NTRIP_LINK_STANDBY],
+                           tskIDLE_PRIORITY + 3, &g_ntrip_links[NTRIP_LINK_STANDBY].task));
+  }
+}
 
-      LOG_INFO("GGA 송신 태스크 이미 종료됨");
+int ntrip_send_gga_data(const char *data, uint8_t len)
+{
+  if (!data || len == 0 || len >= NTRIP_GGA_MAX_LEN)
+  {
+    LOG_ERR("유효하지 않은 GGA (len=%d)", len);
+    return -1;
+  }
 
-    }
+  if (g_ntrip_links[NTRIP_LINK_PRIMARY].task == NULL)
+  {
+    LOG_WARN("NTRIP 시작 전");
+    return -2;
+  }
 
-    g_gga_send_task_handle = NULL;
+  // 아직 보내지 않은 이전 GGA 는 덮어쓴다 (캐스터는 최신 위치 하나만 필요)
+  taskENTER_CRITICAL();
+  memcpy(g_gga_latest.data, data, len);
+  g_gga_latest.data[len] = '\0';
+  g_gga_latest.len = len;
+  g_gga_pending = true;
+  taskEXIT_CRITICAL();
 
-  }
+  ntrip_gga_flush(false);
 
- 
- 
+  return len;
+}
 
-  // 3. 모든 태스크가 종료된 후 소켓 정리
+void ntrip_set_gga_interval(uint32_t interval_ms)
+{
+  g_gga_interval_ms = interval_ms;
+}
 
-  if (g_ntrip_socket != NULL)
+uint32_t ntrip_get_gga_interval(void)
+{
+  return g_gga_interval_ms;
+}
 
-  {
+void ntrip_set_thin(bool thin)
+{
+  ntrip_link_t *link = &g_ntrip_links[NTRIP_LINK_PRIMARY];
 
-    tcp_close_force(g_ntrip_socket);
+  if (thin == g_ntrip_thin)
+  {
+    return;
+  }
+  g_ntrip_thin = thin;
 
-    tcp_socket_destroy(g_ntrip_socket);
+  if (flash_params_str_empty(flash_params_snapshot(NULL)->ntrip_thin_mountpoint))
+  {
+    return;
+  }
 
-    g_ntrip_socket = NULL;
+  ntrip_link_remount(link);
+}
 
-    LOG_INFO("NTRIP 소켓 닫기 및 파괴");
 
-  }
+bool ntrip_gga_send_queue_initialized(void)
+{
+  return g_ntrip_links[NTRIP_LINK_PRIMARY].task != NULL;
+}
 
- 
+void ntrip_stop(void)
+{
+    LOG_INFO("NTRIP 중지 시작...");
 
-  // 4. GGA 큐 정리 (큐 삭제는 하지 않음, 재시작 시 재사용)
+  ntrip_mon_link_down();
+  g_ntrip_connected = false;
 
-  if (g_gga_send_queue != NULL)
+  // ★ 중요: 태스크를 먼저 삭제한 후 소켓/큐를 정리해야 함
 
+  // 1. link 수신 태스크 삭제 (tcp_recv를 더 이상 호출하지 않도록)
+  for (int i = 0; i < NTRIP_LINK_MAX; i++)
   {
+    ntrip_link_t *link = &g_ntrip_links[i];
 
-    xQueueReset(g_gga_send_queue);
+    if (link->task != NULL)
+    {
+      // 태스크 유효성 확인 후 삭제
+      eTaskState state = eTaskGetState(link->task);
+      if (state != eDeleted && state != eInvalid)
+      {
+        vTaskDelete(link->task);
+        LOG_INFO("NTRIP 수신 태스크 삭제 (link=%d)", i);
+      }
+      else
+      {
+        LOG_INFO("NTRIP 수신 태스크 이미 종료됨 (link=%d)", i);
+      }
+      link->task = NULL;
+    }
+  }
 
-    LOG_INFO("GGA 큐 리셋");
+  // 2. 모든 태스크가 종료된 후 소켓 정리
+  //    HTTP 요청과 캐스터 주소는 설정이 바뀌었을 수 있으니 다음 시작 때 다시 만든다
+  for (int i = 0; i < NTRIP_LINK_MAX; i++)
+  {
+    ntrip_link_t *link = &g_ntrip_links[i];
 
+    if (link->sock != NULL)
+    {
+      tcp_set_sink(link->sock, NULL, NULL);
+      tcp_close_force(link->sock);
+      tcp_socket_destroy(link->sock);
+      link->sock = NULL;
+      LOG_INFO("NTRIP 소켓 닫기 및 파괴 (link=%d)", i);
+    }
+    link->ready = false;
+    link->request_len = 0;
+    link->addr[0] = '\0';
   }
+  g_ntrip_active = NTRIP_LINK_PRIMARY;
+
+  // 3. 남은 GGA 정리 (대기열에 있던 것은 소켓 닫을 때 완료 콜백으로 끝남)
+  taskENTER_CRITICAL();
+  g_gga_pending = false;
+  g_gga_sent_once = false;
+  taskEXIT_CRITICAL();
 
   led_set_color(LED_ID_1, LED_COLOR_NONE);
 
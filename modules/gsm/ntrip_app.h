@@ -11,8 +11,49 @@
  * @param gsm GSM 핸들
  */
 void ntrip_task_create(gsm_t *gsm);
+
+/**
+ * @brief 최신 GGA 를 캐스터로 보낸다 (비동기, SEND OK 를 기다리지 않음)
+ *
+ * 끊겨 있으면 최신 것 하나를 남겨 두었다가 재연결 직후 보낸다.
+ *
+ * @return int 받은 길이, 음수면 실패
+ */
 int ntrip_send_gga_data(const char *data, uint8_t len);
+
+/**
+ * @brief GGA 업로드 최소 간격 설정
+ *
+ * 간격 안에 들어온 GGA 는 최신 것 하나만 보낸다. 0 이면 들어오는 대로 보낸다.
+ *
+ * @param interval_ms 간격 (ms, 기본 1000)
+ */
+void ntrip_set_gga_interval(uint32_t interval_ms);
+
+/**
+ * @brief GGA 업로드 최소 간격 (GPS 쪽은 이 간격마다만 GGA 를 만든다)
+ */
+uint32_t ntrip_get_gga_interval(void);
+
+/**
+ * @brief 주 캐스터를 ntrip_thin_mountpoint 로 (데이터 한도 정책)
+ *
+ * 설정이 비어 있으면 아무것도 바꾸지 않는다. 연결 중이면 다시 붙는다.
+ */
+void ntrip_set_thin(bool thin);
+
+/**
+ * @brief GGA 를 받을 수 있는 상태인지 (NTRIP 시작됨)
+ */
 bool ntrip_gga_send_queue_initialized(void);
+
+/**
+ * @brief Basic 인증용 base64 (NTRIP server 도 씀)
+ *
+ * @return int 출력 길이 (NUL 제외), 버퍼가 모자라면 -1
+ */
+int ntrip_base64_encode(const char *input, size_t input_len, char *output, size_t output_size);
+
 void ntrip_stop(void);
 bool ntrip_is_connected(void);
 
@@ -0,0 +1,317 @@
+#include "ntrip_monitor.h"
+#include "app_events.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdio.h>
+#include <string.h>
+
+#ifndef TAG
+#define TAG "NTRIP_MON"
+#endif
+
+#include "log.h"
+
+/**
+ * @brief 초 단위 구간은 이벤트가 올 때와 읽을 때 밀어 낸다 (타이머 없음)
+ *
+ * 바이트/프레임은 GSM 태스크, 연결 상태는 NTRIP link 태스크, 읽기는
+ * BLE/RS485 태스크에서 오므로 모두 짧은 critical section 안에서만 만진다.
+ */
+static struct {
+  TickType_t sec_start;  /**< 진행 중인 1초 구간 시작 */
+  uint32_t sec_bytes;    /**< 진행 중인 1초 바이트 */
+  uint16_t sec_frames[NTRIP_MON_TYPES_MAX];
+  uint32_t window[NTRIP_MON_WINDOW_S];
+  uint8_t window_next;
+  uint8_t window_fill;
+  TickType_t last_rx;    /**< 0: 연결 후 아직 수신 없음 */
+  TickType_t last_obs;
+  TickType_t down_tick;  /**< 0: 끊김 없음 */
+  bool warned_drop;
+  bool warned_no_obs;
+  ntrip_mon_stats_t st;
+} mon;
+
+static inline bool mon_type_is_obs(uint16_t type) {
+  if (type >= 1001 && type <= 1004) {
+    return true;
+  }
+  return type >= 1071 && type <= 1137 && (type % 10) >= 1 && (type % 10) <= 7;
+}
+
+static uint32_t mon_window_avg(void) {
+  uint32_t sum = 0;
+
+  if (mon.window_fill == 0) {
+    return 0;
+  }
+  for (uint8_t i = 0; i < mon.window_fill; i++) {
+    sum += mon.window[i];
+  }
+  return sum / mon.window_fill;
+}
+
+/**
+ * @brief 지난 1초 구간들을 닫는다 (critical section 안)
+ */
+static void mon_roll(TickType_t now) {
+  TickType_t sec = pdMS_TO_TICKS(1000);
+
+  if (mon.sec_start == 0) {
+    mon.sec_start = now;
+    return;
+  }
+
+  while ((now - mon.sec_start) >= sec) {
+    uint32_t avg = mon_window_avg();
+    bool full = mon.window_fill == NTRIP_MON_WINDOW_S;
+
+    if (mon.st.connected && full &&
+        mon.sec_bytes * 100 < avg * NTRIP_MON_DROP_PCT) {
+      if (!mon.warned_drop) {
+        mon.st.drops++;
+        mon.warned_drop = true;
+      }
+    } else {
+      mon.warned_drop = false;
+    }
+
+    mon.window[mon.window_next] = mon.sec_bytes;
+    mon.window_next = (mon.window_next + 1) % NTRIP_MON_WINDOW_S;
+    if (mon.window_fill < NTRIP_MON_WINDOW_S) {
+      mon.window_fill++;
+    }
+    mon.st.bps_last = mon.sec_bytes;
+    mon.sec_bytes = 0;
+
+    for (uint8_t i = 0; i < mon.st.type_cnt; i++) {
+      mon.st.types[i].last_sec = mon.sec_frames[i];
+      mon.sec_frames[i] = 0;
+    }
+
+    mon.sec_start += sec;
+
+    // 오래 비어 있던 구간은 한 번에 건너뛴다 (나머지는 모두 0)
+    if ((now - mon.sec_start) >= sec * NTRIP_MON_WINDOW_S) {
+      memset(mon.window, 0, sizeof(mon.window));
+      mon.st.bps_last = 0;
+      for (uint8_t i = 0; i < mon.st.type_cnt; i++) {
+        mon.st.types[i].last_sec = 0;
+      }
+      mon.sec_start = now;
+    }
+  }
+}
+
+void ntrip_mon_on_bytes(size_t len) {
+  TickType_t now = xTaskGetTickCount();
+
+  taskENTER_CRITICAL();
+  mon_roll(now);
+
+  mon.sec_bytes += len;
+  mon.st.bytes_total += len;
+
+  if (mon.st.connected && mon.last_rx != 0) {
+    uint32_t gap_ms = (now - mon.last_rx) * portTICK_PERIOD_MS;
+
+    if (gap_ms > mon.st.gap_max_ms) {
+      mon.st.gap_max_ms = gap_ms;
+    }
+  }
+  mon.last_rx = now;
+  taskEXIT_CRITICAL();
+}
+
+void ntrip_mon_on_frame(uint16_t msg_type) {
+  TickType_t now = xTaskGetTickCount();
+  bool warn_end = false;
+
+  taskENTER_CRITICAL();
+  mon_roll(now);
+
+  uint8_t i = 0;
+  while (i < mon.st.type_cnt && mon.st.types[i].type != msg_type) {
+    i++;
+  }
+  if (i == mon.st.type_cnt && i < NTRIP_MON_TYPES_MAX) {
+    mon.st.types[i].type = msg_type;
+    mon.st.types[i].last_sec = 0;
+    mon.st.types[i].total = 0;
+    mon.sec_frames[i] = 0;
+    mon.st.type_cnt++;
+  }
+  if (i < mon.st.type_cnt) {
+    mon.st.types[i].total++;
+    mon.sec_frames[i]++;
+  }
+
+  if (mon_type_is_obs(msg_type)) {
+    mon.last_obs = now;
+    warn_end = mon.st.no_obs;
+    mon.st.no_obs = false;
+    mon.warned_no_obs = false;
+  } else if (mon.st.connected &&
+             (mon.last_obs == 0 ||
+              (now - mon.last_obs) >= pdMS_TO_TICKS(NTRIP_MON_NO_OBS_S * 1000))) {
+    // 관측 메시지 없이 기준국 정보 등만 계속 온다
+    mon.st.no_obs = true;
+  }
+
+  bool warn = mon.st.no_obs && !mon.warned_no_obs;
+  if (warn) {
+    mon.warned_no_obs = true;
+  }
+  taskEXIT_CRITICAL();
+
+  if (warn) {
+    LOG_WARN("관측 메시지 없이 %d 등만 수신 중 (%d초 이상)", msg_type,
+             NTRIP_MON_NO_OBS_S);
+  } else if (warn_end) {
+    LOG_INFO("관측 메시지 수신 재개");
+  }
+}
+
+/**
+ * @brief 링크 상태 변화 알림
+ */
+static void ntrip_mon_publish_link(bool up) {
+  app_evt_link_state_t evt = { .link = APP_LINK_NTRIP, .up = up };
+
+  app_event_publish(APP_EVT_LINK_STATE, &evt, sizeof(evt));
+}
+
+void ntrip_mon_link_down(void) {
+  TickType_t now = xTaskGetTickCount();
+  bool was_up;
+
+  taskENTER_CRITICAL();
+  was_up = mon.st.connected;
+  if (was_up) {
+    mon.st.connected = false;
+    mon.down_tick = now ? now : 1;
+  }
+  taskEXIT_CRITICAL();
+
+  if (was_up) {
+    ntrip_mon_publish_link(false);
+  }
+}
+
+void ntrip_mon_link_up(void) {
+  TickType_t now = xTaskGetTickCount();
+  uint32_t outage_ms = 0;
+  bool was_down;
+
+  taskENTER_CRITICAL();
+  was_down = mon.down_tick != 0;
+  if (was_down) {
+    outage_ms = (now - mon.down_tick) * portTICK_PERIOD_MS;
+    mon.st.reconnects++;
+    mon.st.outage_last_ms = outage_ms;
+    mon.st.outage_sum_ms += outage_ms;
+    if (outage_ms > mon.st.outage_max_ms) {
+      mon.st.outage_max_ms = outage_ms;
+    }
+    mon.down_tick = 0;
+  }
+  mon.st.connected = true;
+  // 끊긴 동안은 도착 간격에 넣지 않는다
+  mon.last_rx = 0;
+  mon.last_obs = now;
+  taskEXIT_CRITICAL();
+
+  if (was_down) {
+    LOG_INFO("보정 스트림 복구 (끊김 %lums)", outage_ms);
+  }
+  ntrip_mon_publish_link(true);
+}
+
+void ntrip_mon_failover(void) {
+  taskENTER_CRITICAL();
+  mon.st.failovers++;
+  taskEXIT_CRITICAL();
+}
+
+void ntrip_mon_get(ntrip_mon_stats_t *out) {
+  TickType_t now = xTaskGetTickCount();
+
+  if (!out) {
+    return;
+  }
+
+  taskENTER_CRITICAL();
+  mon_roll(now);
+
+  mon.st.bps_avg = mon_window_avg();
+  mon.st.bps_min = 0;
+  for (uint8_t i = 0; i < mon.window_fill; i++) {
+    if (i == 0 || mon.window[i] < mon.st.bps_min) {
+      mon.st.bps_min = mon.window[i];
+    }
+  }
+  mon.st.gap_cur_ms = (mon.st.connected && mon.last_rx != 0)
+                          ? (now - mon.last_rx) * portTICK_PERIOD_MS
+                          : 0;
+  if (mon.st.gap_cur_ms > mon.st.gap_max_ms) {
+    mon.st.gap_max_ms = mon.st.gap_cur_ms;
+  }
+
+  memcpy(out, &mon.st, sizeof(*out));
+  taskEXIT_CRITICAL();
+}
+
+void ntrip_mon_reset(void) {
+  taskENTER_CRITICAL();
+  bool connected = mon.st.connected;
+  TickType_t down_tick = mon.down_tick;
+
+  memset(&mon, 0, sizeof(mon));
+  mon.st.connected = connected;
+  mon.down_tick = down_tick;
+  mon.last_obs = xTaskGetTickCount();
+  taskEXIT_CRITICAL();
+}
+
+size_t ntrip_mon_format(char *buf, size_t size) {
+  ntrip_mon_stats_t st;
+  size_t pos;
+  int n;
+
+  ntrip_mon_get(&st);
+
+  n = snprintf(buf, size,
+               "+NSTAT,bps=%lu/%lu/%lu,bytes=%lu,gap=%lu/%lu,drop=%lu,rc=%lu,"
+               "out=%lu/%lu/%lu,fo=%lu,obs=%d\n\r",
+               st.bps_last, st.bps_avg, st.bps_min, st.bytes_total,
+               st.gap_cur_ms, st.gap_max_ms, st.drops, st.reconnects,
+               st.outage_last_ms, st.outage_max_ms, st.outage_sum_ms,
+               st.failovers, st.no_obs ? 0 : 1);
+  if (n < 0 || (size_t)n >= size) {
+    return 0;
+  }
+  pos = n;
+
+  n = snprintf(&buf[pos], size - pos, "+NTYPE");
+  if (n < 0 || (size_t)n >= size - pos) {
+    return 0;
+  }
+  pos += n;
+
+  for (uint8_t i = 0; i < st.type_cnt; i++) {
+    n = snprintf(&buf[pos], size - pos, ",%u=%u/%lu", st.types[i].type,
+                 st.types[i].last_sec, st.types[i].total);
+    if (n < 0 || (size_t)n >= size - pos) {
+      return 0;
+    }
+    pos += n;
+  }
+
+  n = snprintf(&buf[pos], size - pos, st.type_cnt ? "\n\r" : ",none\n\r");
+  if (n < 0 || (size_t)n >= size - pos) {
+    return 0;
+  }
+  pos += n;
+
+  return pos;
+}
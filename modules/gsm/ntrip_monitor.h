@@ -0,0 +1,97 @@
+#ifndef NTRIP_MONITOR_H
+#define NTRIP_MONITOR_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief 초당 바이트 수를 보관하는 구간 (초)
+ */
+#define NTRIP_MON_WINDOW_S 10
+
+/**
+ * @brief 타입별 프레임 수를 세는 최대 타입 수 (넘치는 타입은 무시)
+ */
+#define NTRIP_MON_TYPES_MAX 16
+
+/**
+ * @brief 직전 1초가 구간 평균의 이 비율(%) 미만이면 처리량 급감으로 센다
+ */
+#define NTRIP_MON_DROP_PCT 40
+
+/**
+ * @brief 1005/1006 등만 오고 관측 메시지가 이 시간 없으면 경고 (초)
+ */
+#define NTRIP_MON_NO_OBS_S 5
+
+typedef struct {
+  uint16_t type;     /**< RTCM 메시지 타입 */
+  uint16_t last_sec; /**< 직전 1초 프레임 수 */
+  uint32_t total;    /**< 누적 프레임 수 */
+} ntrip_mon_type_t;
+
+/**
+ * @brief active 스트림 통계
+ */
+typedef struct {
+  uint32_t bytes_total;
+  uint32_t bps_last;       /**< 직전 1초 바이트 */
+  uint32_t bps_avg;        /**< 최근 NTRIP_MON_WINDOW_S 초 평균 */
+  uint32_t bps_min;        /**< 최근 구간 최소 */
+  uint32_t gap_cur_ms;     /**< 마지막 수신 후 경과 (연결 중일 때) */
+  uint32_t gap_max_ms;     /**< 연결 중 최장 도착 간격 */
+  uint32_t drops;          /**< 처리량 급감 횟수 */
+  uint32_t reconnects;     /**< 끊긴 뒤 다시 받기 시작한 횟수 */
+  uint32_t failovers;      /**< 대기 캐스터로 넘긴 횟수 */
+  uint32_t outage_last_ms; /**< 마지막 끊김 시간 */
+  uint32_t outage_max_ms;
+  uint32_t outage_sum_ms;
+  bool connected;
+  bool no_obs; /**< 관측 메시지 없이 기준국 정보만 오는 중 */
+  uint8_t type_cnt;
+  ntrip_mon_type_t types[NTRIP_MON_TYPES_MAX];
+} ntrip_mon_stats_t;
+
+/**
+ * @brief active 스트림 바이트 수신 (보정 데이터 sink 에서)
+ */
+void ntrip_mon_on_bytes(size_t len);
+
+/**
+ * @brief active 스트림에서 CRC 통과한 RTCM 프레임 하나
+ */
+void ntrip_mon_on_frame(uint16_t msg_type);
+
+/**
+ * @brief active 스트림 끊김 (재연결 시작)
+ */
+void ntrip_mon_link_down(void);
+
+/**
+ * @brief active 스트림 수신 시작 (처음 연결, 재연결, 전환 모두)
+ */
+void ntrip_mon_link_up(void);
+
+/**
+ * @brief 대기 캐스터로 전환
+ */
+void ntrip_mon_failover(void);
+
+void ntrip_mon_get(ntrip_mon_stats_t *out);
+void ntrip_mon_reset(void);
+
+/**
+ * @brief 응답 문자열
+ *
+ * +NSTAT,bps=<직전>/<평균>/<최소>,bytes=<누적>,gap=<현재>/<최장>,drop=<n>,
+ * rc=<n>,out=<마지막>/<최장>/<합>,fo=<n>,obs=<0|1>
+ * +NTYPE,<타입>=<직전 1초>/<누적>,...
+ *
+ * @param[out] buf
+ * @param[in] size
+ * @return size_t 문자열 길이 (0 이면 버퍼 부족)
+ */
+size_t ntrip_mon_format(char *buf, size_t size);
+
+#endif
@@ -0,0 +1,696 @@
+#include "ntrip_server.h"
+#include "ntrip_app.h"
+#include "app_events.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "gps_app.h"
+#include "heap_track.h"
+#include "mem_section.h"
+#include "flash_params.h"
+#include "fmt.h"
+#include "rtcm.h"
+#include "tcp_socket.h"
+#include "work_queue.h"
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef TAG
+#define TAG "NTRIP_SRV"
+#endif
+
+#include "log.h"
+
+#define NTRIP_SRV_CONNECT_ID 2 // 소켓 ID (주/보조 캐스터 다음)
+#define NTRIP_SRV_CONTEXT_ID 1 // PDP context ID
+#define NTRIP_SRV_CONNECT_TIMEOUT_MS 10000
+#define NTRIP_SRV_RESP_TIMEOUT_MS 5000 // SOURCE/POST 응답 대기
+#define NTRIP_SRV_DNS_TIMEOUT_MS 5000
+#define NTRIP_SRV_CHECK_MS 5000       // 스트리밍 중 소켓 상태 확인 간격
+#define NTRIP_SRV_RETRY_MIN_MS 1000   // 연결 실패 후 대기 (실패할 때마다 두 배)
+#define NTRIP_SRV_RETRY_MAX_MS 30000
+#define NTRIP_SRV_BATCH_MS 100        // epoch 끝 MSM 이 안 와도 이 시간 뒤 보냄
+
+// v2 chunk 헤더 "5B4\r\n" (GSM_TCP_SEND_MAX 는 hex 3자리) + NUL, 꼬리 "\r\n"
+#define NTRIP_SRV_CHUNK_HDR_SIZE 8
+#define NTRIP_SRV_CHUNK_OVERHEAD 7
+
+static struct
+{
+  gsm_t *gsm;
+  tcp_socket_t *sock;
+  TaskHandle_t task;
+  bool v2;                      // 연결할 때 정함 (묶음을 chunk 로 감쌈)
+  volatile uint8_t state;       // ntrip_srv_state_t
+  volatile bool peer_closed;    // sink 가 GSM 태스크에서 세움
+  volatile bool send_failed;    // 완료 콜백이 세움
+  uint32_t params_version;      // 주소를 조회한 설정 version
+  char addr[GSM_DNS_ADDR_SIZE]; // DNS 조회한 캐스터 주소
+
+  // 모으는 중인 묶음 (이벤트 핸들러와 flush 작업이 critical section 안에서)
+  tcp_pbuf_t *batch_head;
+  tcp_pbuf_t *batch_tail;
+  uint16_t batch_frames;
+
+  ntrip_srv_stats_t stats; // critical section 안에서 갱신
+} g_srv;
+
+CCM_BSS static char g_srv_request[512];
+
+static void ntrip_srv_flush_work(work_t *work);
+static work_t g_srv_flush_work = WORK_INIT(ntrip_srv_flush_work, NULL, WORK_PRIO_LOW);
+
+bool ntrip_server_configured(void)
+{
+  const user_params_t *params = flash_params_snapshot(NULL);
+
+  return !flash_params_str_empty(params->ntrip_srv_url) &&
+         !flash_params_str_empty(params->ntrip_srv_port) &&
+         !flash_params_str_empty(params->ntrip_srv_mountpoint);
+}
+
+/**
+ * @brief 업로드 요청 생성
+ *
+ * 사용자 이름이 있으면 NTRIP v2 (POST, Basic 인증, chunked), 없으면
+ * v1 (SOURCE 비밀번호).
+ *
+ * @return 생성된 문자열 길이 (실패시 -1)
+ */
+static int ntrip_srv_build_request(const user_params_t *params, char *buffer, size_t buffer_size)
+{
+  fmt_t f;
+  int len;
+
+  g_srv.v2 = !flash_params_str_empty(params->ntrip_srv_user);
+
+  if (!g_srv.v2)
+  {
+    fmt_init(&f, buffer, buffer_size);
+    fmt_str(&f, "SOURCE ");
+    if (!flash_params_str_empty(params->ntrip_srv_pw))
+    {
+      fmt_str(&f, params->ntrip_srv_pw);
+    }
+    fmt_str(&f, " /");
+    fmt_str(&f, params->ntrip_srv_mountpoint);
+    fmt_str(&f, "\r\n"
+                "Source-Agent: NTRIP GUGU SYSTEM\r\n"
+                "\r\n");
+    len = (int)fmt_end(&f);
+    return len ? len : -1;
+  }
+
+  char credentials[80];
+  char encoded[112];
+
+  fmt_init(&f, credentials, sizeof(credentials));
+  fmt_str(&f, params->ntrip_srv_user);
+  fmt_char(&f, ':');
+  if (!flash_params_str_empty(params->ntrip_srv_pw))
+  {
+    fmt_str(&f, params->ntrip_srv_pw);
+  }
+  fmt_end(&f);
+
+  if (ntrip_base64_encode(credentials, strlen(credentials), encoded, sizeof(encoded)) < 0)
+  {
+    LOG_ERR("Base64 인코딩 실패");
+    return -1;
+  }
+
+  fmt_init(&f, buffer, buffer_size);
+  fmt_str(&f, "POST /");
+  fmt_str(&f, params->ntrip_srv_mountpoint);
+  fmt_str(&f, " HTTP/1.1\r\n"
+              "Host: ");
+  fmt_str(&f, params->ntrip_srv_url);
+  fmt_char(&f, ':');
+  fmt_str(&f, params->ntrip_srv_port);
+  fmt_str(&f, "\r\n"
+              "Ntrip-Version: Ntrip/2.0\r\n"
+              "User-Agent: NTRIP GUGU SYSTEM\r\n"
+              "Authorization: Basic ");
+  fmt_str(&f, encoded);
+  fmt_str(&f, "\r\n"
+              "Connection: close\r\n"
+              "Transfer-Encoding: chunked\r\n"
+              "\r\n");
+
+  len = (int)fmt_end(&f);
+  return len ? len : -1;
+}
+
+/**
+ * @brief 캐스터 응답이 수락인지 ("ICY 200 OK" 또는 "HTTP/1.x 200")
+ */
+static bool ntrip_srv_accepted(const char *head, size_t len)
+{
+  if (len >= 7 && memcmp(head, "ICY 200", 7) == 0)
+  {
+    return true;
+  }
+
+  return len >= 12 && memcmp(head, "HTTP/1.", 7) == 0 && memcmp(&head[8], " 200", 4) == 0;
+}
+
+/**
+ * @brief TCP 연결 + 업로드 요청/응답 한 번 시도
+ *
+ * @return 0: 성공, -1: 실패 (소켓은 닫힌 상태)
+ */
+static int ntrip_srv_connect(void)
+{
+  const user_params_t *params = flash_params_snapshot(NULL);
+  tcp_socket_t *sock = g_srv.sock;
+  tcp_pbuf_t *resp = NULL;
+  const char *addr;
+  int len;
+  int ret;
+
+  if (flash_params_changed(&g_srv.params_version))
+  {
+    g_srv.addr[0] = '\0';
+  }
+
+  if (flash_params_str_empty(params->ntrip_srv_url) ||
+      flash_params_str_empty(params->ntrip_srv_port))
+  {
+    LOG_ERR("캐스터 업로드 설정 없음");
+    return -1;
+  }
+
+  len = ntrip_srv_build_request(params, g_srv_request, sizeof(g_srv_request));
+  if (len < 0)
+  {
+    LOG_ERR("업로드 요청 생성 실패");
+    return -1;
+  }
+
+  if (g_srv.addr[0] == '\0' &&
+      gsm_dns_resolve(g_srv.gsm, NTRIP_SRV_CONTEXT_ID, params->ntrip_srv_url, g_srv.addr,
+                      sizeof(g_srv.addr), NTRIP_SRV_DNS_TIMEOUT_MS) == 0)
+  {
+    LOG_INFO("캐스터 주소 캐시: %s -> %s", params->ntrip_srv_url, g_srv.addr);
+  }
+  addr = g_srv.addr[0] ? g_srv.addr : params->ntrip_srv_url;
+
+  LOG_INFO("캐스터 업로드 연결 (%s): %s:%s/%s", g_srv.v2 ? "v2" : "v1", addr,
+           params->ntrip_srv_port, params->ntrip_srv_mountpoint);
+
+  tcp_set_access_mode(sock, GSM_TCP_ACCESS_PUSH);
+  ret = tcp_connect(sock, NTRIP_SRV_CONTEXT_ID, addr, atoi(params->ntrip_srv_port),
+                    NTRIP_SRV_CONNECT_TIMEOUT_MS);
+  if (ret != 0 || tcp_get_socket_state(sock, NTRIP_SRV_CONNECT_ID) != GSM_TCP_STATE_CONNECTED)
+  {
+    LOG_WARN("TCP 연결 실패 (ret=%d)", ret);
+    // 캐시한 주소가 바뀌었을 수 있으니 다음 시도는 다시 조회
+    g_srv.addr[0] = '\0';
+    tcp_close_force(sock);
+    return -1;
+  }
+
+  if (tcp_send(sock, (const uint8_t *)g_srv_request, (size_t)len) < 0)
+  {
+    LOG_WARN("업로드 요청 전송 실패");
+    tcp_close_force(sock);
+    return -1;
+  }
+
+  ret = tcp_recv_pbuf(sock, &resp, NTRIP_SRV_RESP_TIMEOUT_MS);
+  if (ret <= 0)
+  {
+    LOG_WARN("캐스터 응답 없음: %d", ret);
+    tcp_close_force(sock);
+    return -1;
+  }
+
+  const char *head = (const char *)resp->payload;
+  size_t head_len = resp->len;
+  bool ok = ntrip_srv_accepted(head, head_len);
+
+  if (!ok)
+  {
+    const char *eol = memchr(head, '\r', head_len);
+    int line_len = (int)(eol ? (size_t)(eol - head) : head_len);
+
+    // v1 은 "ERROR - Bad Password", v2 는 "HTTP/1.1 401" 등
+    LOG_ERR("캐스터 업로드 거절: %.*s", line_len > 80 ? 80 : line_len, head);
+    (void)line_len; // 로그를 빼고 빌드할 때
+  }
+  tcp_recv_release(resp);
+
+  if (!ok)
+  {
+    tcp_close_force(sock);
+    return -1;
+  }
+
+  return 0;
+}
+
+/**
+ * @brief 캐스터가 보내는 것 (GSM 태스크 컨텍스트)
+ *
+ * 업로드 중에는 받을 것이 없어 버리고, 상대가 끊었을 때 (data NULL) 만 본다.
+ */
+static void ntrip_srv_sink(const uint8_t *data, size_t len, void *ctx)
+{
+  (void)len;
+  (void)ctx;
+
+  if (data == NULL)
+  {
+    g_srv.peer_closed = true;
+    if (g_srv.task)
+    {
+      xTaskNotifyGive(g_srv.task);
+    }
+  }
+}
+
+/**
+ * @brief 묶음 송신 완료 (AT 처리/파서 태스크)
+ */
+static void ntrip_srv_sent_cb(uint8_t connect_id, bool ok, void *ctx)
+{
+  (void)ctx;
+
+  if (ok)
+  {
+    return;
+  }
+
+  LOG_WARN("RTCM 업로드 실패 (cid=%d)", connect_id);
+
+  taskENTER_CRITICAL();
+  g_srv.stats.send_errors++;
+  taskEXIT_CRITICAL();
+
+  // 재연결은 업로드 태스크에서
+  g_srv.send_failed = true;
+  if (g_srv.task)
+  {
+    xTaskNotifyGive(g_srv.task);
+  }
+}
+
+/**
+ * @brief 묶음 하나 최대 길이 (v2 는 chunk 헤더/꼬리 자리를 뺌)
+ */
+static size_t ntrip_srv_batch_max(void)
+{
+  return g_srv.v2 ? GSM_TCP_SEND_MAX - NTRIP_SRV_CHUNK_OVERHEAD : GSM_TCP_SEND_MAX;
+}
+
+/**
+ * @brief 모으던 묶음 떼어내기 (critical section 안)
+ */
+static tcp_pbuf_t *ntrip_srv_batch_take(tcp_pbuf_t **tail, uint16_t *frames)
+{
+  tcp_pbuf_t *head = g_srv.batch_head;
+
+  *tail = g_srv.batch_tail;
+  *frames = g_srv.batch_frames;
+  g_srv.batch_head = NULL;
+  g_srv.batch_tail = NULL;
+  g_srv.batch_frames = 0;
+
+  return head;
+}
+
+/**
+ * @brief v2 chunk 로 감싸기 ("<hex len>\r\n" + 묶음 + "\r\n")
+ *
+ * @return 감싼 체인 헤드, pbuf 가 모자라면 NULL (묶음은 그대로)
+ */
+static tcp_pbuf_t *ntrip_srv_chunk_wrap(tcp_pbuf_t *head, tcp_pbuf_t *tail)
+{
+  tcp_pbuf_t *hdr = tcp_pbuf_alloc(NTRIP_SRV_CHUNK_HDR_SIZE);
+  tcp_pbuf_t *trl = tcp_pbuf_alloc(2);
+  size_t len = head->tot_len;
+  fmt_t f;
+
+  if (!hdr || !trl)
+  {
+    tcp_pbuf_free(hdr);
+    tcp_pbuf_free(trl);
+    return NULL;
+  }
+
+  fmt_init(&f, (char *)hdr->payload, NTRIP_SRV_CHUNK_HDR_SIZE);
+  fmt_hex(&f, (uint32_t)len, 0);
+  fmt_str(&f, "\r\n");
+  hdr->len = fmt_end(&f);
+
+  trl->payload[0] = '\r';
+  trl->payload[1] = '\n';
+
+  for (tcp_pbuf_t *p = head; p; p = p->next)
+  {
+    p->tot_len += trl->len;
+  }
+  tail->next = trl;
+  hdr->next = head;
+  hdr->tot_len = hdr->len + head->tot_len;
+
+  return hdr;
+}
+
+/**
+ * @brief 묶음을 QISEND 대기열로 (실패하면 버림)
+ *
+ * 대기열에 먼저 쌓인 쓰기가 있으면 GSM 쪽에서 QISEND 하나로 더 묶인다.
+ */
+static void ntrip_srv_send(tcp_pbuf_t *head, tcp_pbuf_t *tail, uint16_t frames)
+{
+  size_t len = head->tot_len;
+  tcp_pbuf_t *chain = head;
+  bool sent = false;
+
+  if (g_srv.state == NTRIP_SRV_STREAMING)
+  {
+    if (g_srv.v2)
+    {
+      chain = ntrip_srv_chunk_wrap(head, tail);
+    }
+    if (chain)
+    {
+      sent = tcp_send_async(g_srv.sock, chain, true, ntrip_srv_sent_cb, NULL) == 0;
+    }
+  }
+
+  if (!sent)
+  {
+    tcp_pbuf_free_chain(chain ? chain : head);
+  }
+
+  taskENTER_CRITICAL();
+  if (sent)
+  {
+    g_srv.stats.frames += frames;
+    g_srv.stats.bytes += len;
+    g_srv.stats.batches++;
+  }
+  else
+  {
+    g_srv.stats.dropped += frames;
+  }
+  taskEXIT_CRITICAL();
+
+  if (!sent)
+  {
+    LOG_DEBUG("RTCM 업로드 묶음 버림 (%d frames, %u bytes)", frames, (unsigned)len);
+  }
+}
+
+/**
+ * @brief 모아 둔 묶음 보내기 (epoch 끝, 또는 flush 작업)
+ */
+static void ntrip_srv_flush(void)
+{
+  tcp_pbuf_t *head;
+  tcp_pbuf_t *tail;
+  uint16_t frames;
+
+  taskENTER_CRITICAL();
+  head = ntrip_srv_batch_take(&tail, &frames);
+  taskEXIT_CRITICAL();
+
+  if (head)
+  {
+    ntrip_srv_send(head, tail, frames);
+  }
+}
+
+static void ntrip_srv_flush_work(work_t *work)
+{
+  (void)work;
+
+  ntrip_srv_flush();
+}
+
+/**
+ * @brief 모아 둔 묶음 버리기 (끊겼을 때)
+ */
+static void ntrip_srv_batch_drop(void)
+{
+  tcp_pbuf_t *head;
+  tcp_pbuf_t *tail;
+  uint16_t frames;
+
+  work_cancel(&g_srv_flush_work);
+
+  taskENTER_CRITICAL();
+  head = ntrip_srv_batch_take(&tail, &frames);
+  g_srv.stats.dropped += frames;
+  taskEXIT_CRITICAL();
+
+  tcp_pbuf_free_chain(head);
+}
+
+/**
+ * @brief epoch 의 마지막 MSM 인지 (multiple message bit 0)
+ *
+ * payload 기준 type(12) + station id(12) + epoch time(30) 다음 비트.
+ */
+static bool ntrip_srv_epoch_end(const app_evt_rtcm_frame_t *evt)
+{
+  uint16_t type = evt->type;
+
+  if (type < 1071 || type > 1137 || (type % 10) < 1 || (type % 10) > 7 ||
+      evt->len <= 3 + 6 + 3)
+  {
+    return false;
+  }
+
+  return ((evt->data[3 + 6] >> 1) & 0x01) == 0;
+}
+
+/**
+ * @brief 수신기 RTCM 프레임 - 주기에 맞는 것만 묶음에 추가 (LOW lane)
+ *
+ * 프레임은 tcp pbuf 로 한 번만 복사하고, 묶음 체인을 그대로 QISEND 대기열에
+ * 넘긴다. 다음 프레임이 안 들어가면 그때까지 모은 것을 먼저 보낸다.
+ */
+static void ntrip_srv_rtcm_evt_handler(const event_msg_t *msg)
+{
+  const app_evt_rtcm_frame_t *evt = (const app_evt_rtcm_frame_t *)msg->data;
+  tcp_pbuf_t *full = NULL;
+  tcp_pbuf_t *full_tail = NULL;
+  uint16_t full_frames = 0;
+  tcp_pbuf_t *pbuf;
+  bool first;
+
+  if (evt->id != GPS_ID_BASE || g_srv.state != NTRIP_SRV_STREAMING)
+  {
+    return;
+  }
+
+  // 타입별 주기는 LoRa 와 같은 규칙, 예정 시각만 따로 센다
+  if (!rtcm_sched_take(RTCM_SINK_NTRIP, evt->type))
+  {
+    return;
+  }
+
+  pbuf = tcp_pbuf_alloc(evt->len);
+  if (!pbuf)
+  {
+    taskENTER_CRITICAL();
+    g_srv.stats.dropped++;
+    taskEXIT_CRITICAL();
+    return;
+  }
+  memcpy(pbuf->payload, evt->data, evt->len);
+
+  taskENTER_CRITICAL();
+  if (g_srv.batch_head && g_srv.batch_head->tot_len + evt->len > ntrip_srv_batch_max())
+  {
+    full = ntrip_srv_batch_take(&full_tail, &full_frames);
+  }
+
+  first = g_srv.batch_head == NULL;
+  if (first)
+  {
+    g_srv.batch_head = pbuf;
+  }
+  else
+  {
+    for (tcp_pbuf_t *p = g_srv.batch_head; p; p = p->next)
+    {
+      p->tot_len += pbuf->len;
+    }
+    g_srv.batch_tail->next = pbuf;
+  }
+  g_srv.batch_tail = pbuf;
+  g_srv.batch_frames++;
+  taskEXIT_CRITICAL();
+
+  if (full)
+  {
+    ntrip_srv_send(full, full_tail, full_frames);
+  }
+
+  if (ntrip_srv_epoch_end(evt))
+  {
+    work_cancel(&g_srv_flush_work);
+    ntrip_srv_flush();
+  }
+  else if (first)
+  {
+    work_submit_delayed(&g_srv_flush_work, NTRIP_SRV_BATCH_MS);
+  }
+}
+
+/**
+ * @brief 응답 뒤 sink 로 전환 (그 전에 큐에 들어온 것은 버림)
+ */
+static void ntrip_srv_stream_start(void)
+{
+  tcp_socket_t *sock = g_srv.sock;
+
+  g_srv.peer_closed = false;
+  g_srv.send_failed = false;
+  tcp_set_sink(sock, ntrip_srv_sink, NULL);
+
+  while (tcp_available(sock) > 0)
+  {
+    tcp_pbuf_t *pbuf = NULL;
+    if (tcp_recv_pbuf(sock, &pbuf, 1) < 0)
+    {
+      g_srv.peer_closed = true;
+      break;
+    }
+    tcp_recv_release(pbuf);
+  }
+}
+
+/**
+ * @brief 업로드 태스크 - 연결 유지만 하고 데이터는 이벤트 핸들러가 보낸다
+ */
+static void ntrip_srv_task(void *pvParameter)
+{
+  (void)pvParameter;
+
+  uint32_t retry_ms = NTRIP_SRV_RETRY_MIN_MS;
+  bool streamed = false;
+
+  LOG_INFO("NTRIP server 태스크 시작");
+
+  while (1)
+  {
+    g_srv.state = NTRIP_SRV_CONNECTING;
+
+    if (!g_srv.sock)
+    {
+      g_srv.sock = tcp_socket_create(g_srv.gsm, NTRIP_SRV_CONNECT_ID);
+    }
+
+    if (!g_srv.sock || ntrip_srv_connect() != 0)
+    {
+      LOG_WARN("캐스터 업로드 연결 실패, %lu ms 뒤 재시도", retry_ms);
+      vTaskDelay(pdMS_TO_TICKS(retry_ms));
+      retry_ms = retry_ms * 2 > NTRIP_SRV_RETRY_MAX_MS ? NTRIP_SRV_RETRY_MAX_MS : retry_ms * 2;
+      continue;
+    }
+
+    retry_ms = NTRIP_SRV_RETRY_MIN_MS;
+    ntrip_srv_stream_start();
+
+    taskENTER_CRITICAL();
+    if (streamed)
+    {
+      g_srv.stats.reconnects++;
+    }
+    taskEXIT_CRITICAL();
+    streamed = true;
+
+    g_srv.state = NTRIP_SRV_STREAMING;
+    LOG_INFO("캐스터 업로드 시작");
+
+    while (!g_srv.peer_closed && !g_srv.send_failed)
+    {
+      ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(NTRIP_SRV_CHECK_MS));
+
+      gsm_tcp_state_t state = tcp_get_socket_state(g_srv.sock, NTRIP_SRV_CONNECT_ID);
+      if (state == GSM_TCP_STATE_CLOSING || state == GSM_TCP_STATE_CLOSED)
+      {
+        break;
+      }
+    }
+
+    LOG_WARN("캐스터 업로드 끊김 (peer=%d, send=%d), 재연결", g_srv.peer_closed,
+             g_srv.send_failed);
+
+    g_srv.state = NTRIP_SRV_CONNECTING;
+    ntrip_srv_batch_drop();
+    tcp_set_sink(g_srv.sock, NULL, NULL);
+    tcp_close_force(g_srv.sock);
+  }
+}
+
+bool ntrip_server_start(gsm_t *gsm)
+{
+  static bool subscribed = false;
+
+  if (g_srv.task != NULL)
+  {
+    return true; // 이미 동작 중
+  }
+
+  if (!ntrip_server_configured())
+  {
+    return false;
+  }
+
+  if (!subscribed)
+  {
+    subscribed = app_event_subscribe(APP_EVT_BIT(APP_EVT_RTCM_FRAME), ntrip_srv_rtcm_evt_handler,
+                                     EVENT_BUS_LANE_LOW);
+  }
+
+  g_srv.gsm = gsm;
+  g_srv.addr[0] = '\0';
+
+  HEAP_TRACK(HEAP_TAG_TASK, xTaskCreate(ntrip_srv_task, "ntrip_srv", 1024, NULL,
+                                        tskIDLE_PRIORITY + 3, &g_srv.task));
+
+  return g_srv.task != NULL;
+}
+
+void ntrip_server_stop(void)
+{
+  // 핸들러가 더 넣지 않도록 상태부터
+  g_srv.state = NTRIP_SRV_IDLE;
+
+  if (g_srv.task != NULL)
+  {
+    vTaskDelete(g_srv.task);
+    g_srv.task = NULL;
+  }
+
+  ntrip_srv_batch_drop();
+
+  if (g_srv.sock != NULL)
+  {
+    tcp_set_sink(g_srv.sock, NULL, NULL);
+    tcp_close_force(g_srv.sock);
+    tcp_socket_destroy(g_srv.sock);
+    g_srv.sock = NULL;
+  }
+  g_srv.addr[0] = '\0';
+
+  LOG_INFO("NTRIP server 중지");
+}
+
+bool ntrip_server_is_running(void)
+{
+  return g_srv.task != NULL;
+}
+
+void ntrip_server_get_stats(ntrip_srv_stats_t *out)
+{
+  taskENTER_CRITICAL();
+  *out = g_srv.stats;
+  taskEXIT_CRITICAL();
+  out->state = g_srv.state;
+}
@@ -0,0 +1,62 @@
+#ifndef NTRIP_SERVER_H
+#define NTRIP_SERVER_H
+
+#include "gsm.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief NTRIP server (base 의 RTCM 을 캐스터로 업로드)
+ *
+ * 캐스터에 별도 소켓으로 붙어 (v1 SOURCE, 계정이 있으면 v2 POST) 수신기가
+ * 낸 RTCM 프레임 이벤트를 그대로 올린다. 타입별 주기는 LoRa 와 같은 스케줄러
+ * 규칙을 쓰되 예정 시각은 따로 센다. 한 epoch 의 프레임은 pbuf 체인 하나로
+ * 모아 QISEND 한 번에 보낸다.
+ */
+
+typedef enum
+{
+  NTRIP_SRV_IDLE = 0,   // 시작 안 함
+  NTRIP_SRV_CONNECTING, // 연결/인증 중 (실패하면 간격을 늘려 재시도)
+  NTRIP_SRV_STREAMING,  // 캐스터가 받는 중
+} ntrip_srv_state_t;
+
+typedef struct
+{
+  uint8_t state;        // ntrip_srv_state_t
+  uint32_t frames;      // 보낸 프레임 (QISEND 대기열에 넣은 것)
+  uint32_t bytes;       // 보낸 바이트 (v2 chunk 헤더 제외)
+  uint32_t batches;     // QISEND 대기열에 넣은 묶음
+  uint32_t dropped;     // 끊김/풀 부족/대기열 가득으로 버린 프레임
+  uint32_t send_errors; // 대기열에 넣은 뒤 QISEND 가 실패한 묶음
+  uint32_t reconnects;  // 스트리밍 중 끊겨 다시 붙은 횟수
+} ntrip_srv_stats_t;
+
+/**
+ * @brief 캐스터 업로드 설정이 있는지 (url, port)
+ */
+bool ntrip_server_configured(void);
+
+/**
+ * @brief 업로드 태스크 시작 (이미 동작 중이면 무시)
+ *
+ * LTE 초기화가 끝난 뒤 부른다. 끊기면 태스크가 알아서 다시 붙는다.
+ *
+ * @param gsm GSM 핸들
+ * @return false 설정 없음 또는 태스크 생성 실패
+ */
+bool ntrip_server_start(gsm_t *gsm);
+
+/**
+ * @brief 업로드 중지 (태스크 삭제, 소켓 정리)
+ */
+void ntrip_server_stop(void);
+
+/**
+ * @brief 시작된 상태인지 (LTE 재초기화 뒤 다시 시작할지 판단)
+ */
+bool ntrip_server_is_running(void);
+
+void ntrip_server_get_stats(ntrip_srv_stats_t *out);
+
+#endif
@@ -0,0 +1,813 @@
+#include "telemetry.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "crc.h"
+#include "diag_bundle.h"
+#include "gps_app.h"
+#include "heap_track.h"
+#include "pm_trace.h"
+#include "mem_section.h"
+#include "flash_params.h"
+#include "lora_stats.h"
+#include "ntrip_monitor.h"
+#include "rtcm_router.h"
+#include "rtos_stats.h"
+#include "tcp_socket.h"
+#include "stm32f4xx_ll_utils.h"
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef TAG
+#define TAG "TELEM"
+#endif
+
+#include "log.h"
+
+#define TELEM_CONNECT_ID 3 // 소켓 ID (주/보조 캐스터, NTRIP server 다음)
+#define TELEM_CONTEXT_ID 1 // PDP context ID
+#define TELEM_CONNECT_TIMEOUT_MS 10000
+#define TELEM_DNS_TIMEOUT_MS 5000
+#define TELEM_RETRY_MIN_MS 2000 // 연결 실패 후 대기 (실패할 때마다 두 배)
+#define TELEM_RETRY_MAX_MS 60000
+#define TELEM_SAMPLE_MS 1000    // 위치/보정 나이 레코드 간격
+
+#define TELEM_INTERVAL_DEFAULT_S 30
+#define TELEM_INTERVAL_MIN_S 5
+#define TELEM_INTERVAL_MAX_S 3600
+
+#define TELEM_HDR_LEN 20
+#define TELEM_CRC_LEN 2
+#define TELEM_REC_HDR_LEN 6
+#define TELEM_BATCH_REC_MAX (GSM_TCP_SEND_MAX - TELEM_HDR_LEN - TELEM_CRC_LEN)
+
+// 끊겨 있을 때 쌓아 둘 양 (30 초 간격 기준 묶음 서너 개)
+#define TELEM_RING_SIZE 4096
+
+// TELEM_REC_TRACE 레코드 하나에 넣는 pm_trace 레코드 (레코드 길이 255 이하)
+#define TELEM_TRACE_PER_REC 20
+
+// TELEM_REC_DIAG 레코드 하나에 넣는 진단 묶음 조각 (off/total 4 byte 포함 255 이하)
+#define TELEM_DIAG_CHUNK 248
+
+// 한 번 깰 때 보내는 최대 묶음 (재연결 뒤 밀린 것을 TX 대기열을 다 쓰지 않고 비움)
+#define TELEM_BATCHES_PER_WAKE 2
+
+static struct
+{
+  gsm_t *gsm;
+  tcp_socket_t *sock;
+  TaskHandle_t task;
+  volatile uint8_t state;    // telem_state_t
+  volatile bool peer_closed; // sink 가 GSM 태스크에서 세움
+  volatile bool send_failed; // 완료 콜백이 세움
+  volatile bool paused;      // 데이터 한도 정책 (telemetry_set_paused)
+  uint32_t params_version;   // 주소를 조회한 설정 version
+  char addr[GSM_DNS_ADDR_SIZE];
+  uint16_t seq;
+  rtos_load_t load;
+
+  // 진단 묶음 (telemetry_send_diag), 링과 따로 보냄
+  volatile bool diag_request;
+  bool diag_pending;
+  uint16_t diag_off;
+
+  // 링 (telemetry 태스크만 만짐)
+  uint16_t head;
+  uint16_t tail;
+  uint16_t used;
+  uint16_t count;
+
+  telem_stats_t stats; // critical section 안에서 갱신
+} g_telem;
+
+CCM_BSS static uint8_t g_telem_ring[TELEM_RING_SIZE];
+
+static void put_le16(uint8_t *p, uint16_t v)
+{
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_le32(uint8_t *p, uint32_t v)
+{
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)(v >> 8);
+  p[2] = (uint8_t)(v >> 16);
+  p[3] = (uint8_t)(v >> 24);
+}
+
+static uint16_t sat_u16(uint32_t v)
+{
+  return v > 0xFFFF ? 0xFFFF : (uint16_t)v;
+}
+
+bool telemetry_configured(void)
+{
+  const user_params_t *params = flash_params_snapshot(NULL);
+
+  return !flash_params_str_empty(params->telemetry_url) && !flash_params_str_empty(params->telemetry_port);
+}
+
+static uint32_t telem_interval_ms(void)
+{
+  uint32_t sec = flash_params_snapshot(NULL)->telemetry_interval_s;
+
+  if (sec == 0 || sec == 0xFFFFFFFF)
+  {
+    sec = TELEM_INTERVAL_DEFAULT_S;
+  }
+  else if (sec < TELEM_INTERVAL_MIN_S)
+  {
+    sec = TELEM_INTERVAL_MIN_S;
+  }
+  else if (sec > TELEM_INTERVAL_MAX_S)
+  {
+    sec = TELEM_INTERVAL_MAX_S;
+  }
+
+  return sec * 1000;
+}
+
+/* 링 */
+
+static void telem_ring_read(uint16_t pos, uint8_t *dst, uint16_t len)
+{
+  uint16_t first = TELEM_RING_SIZE - pos;
+
+  if (first > len)
+  {
+    first = len;
+  }
+  memcpy(dst, &g_telem_ring[pos], first);
+  memcpy(dst + first, g_telem_ring, len - first);
+}
+
+static void telem_ring_write(const uint8_t *src, uint16_t len)
+{
+  uint16_t first = TELEM_RING_SIZE - g_telem.head;
+
+  if (first > len)
+  {
+    first = len;
+  }
+  memcpy(&g_telem_ring[g_telem.head], src, first);
+  memcpy(g_telem_ring, src + first, len - first);
+  g_telem.head = (uint16_t)((g_telem.head + len) % TELEM_RING_SIZE);
+  g_telem.used += len;
+}
+
+/**
+ * @brief pos 의 레코드 전체 길이 (헤더 포함)
+ */
+static uint16_t telem_ring_rec_len(uint16_t pos)
+{
+  return TELEM_REC_HDR_LEN + g_telem_ring[(pos + 1) % TELEM_RING_SIZE];
+}
+
+static void telem_ring_reset(void)
+{
+  g_telem.head = 0;
+  g_telem.tail = 0;
+  g_telem.used = 0;
+  g_telem.count = 0;
+}
+
+/**
+ * @brief 레코드 하나 추가 (자리가 없으면 오래된 것부터 버림)
+ */
+static void telem_push(uint8_t type, const uint8_t *body, uint8_t len)
+{
+  uint8_t hdr[TELEM_REC_HDR_LEN];
+  uint16_t need = TELEM_REC_HDR_LEN + len;
+  uint32_t dropped = 0;
+
+  while (TELEM_RING_SIZE - g_telem.used < need)
+  {
+    uint16_t rec = telem_ring_rec_len(g_telem.tail);
+
+    g_telem.tail = (uint16_t)((g_telem.tail + rec) % TELEM_RING_SIZE);
+    g_telem.used -= rec;
+    g_telem.count--;
+    dropped++;
+  }
+
+  hdr[0] = type;
+  hdr[1] = len;
+  put_le32(&hdr[2], (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS));
+  telem_ring_write(hdr, sizeof(hdr));
+  telem_ring_write(body, len);
+  g_telem.count++;
+
+  taskENTER_CRITICAL();
+  g_telem.stats.records++;
+  g_telem.stats.overwritten += dropped;
+  taskEXIT_CRITICAL();
+}
+
+/* 레코드 */
+
+static void telem_sample_pos(void)
+{
+  gps_position_t pos;
+  uint8_t b[20];
+  float acc_mm;
+
+  gps_get_position(&pos);
+  acc_mm = pos.h_acc * 1000.0f;
+
+  put_le32(&b[0], pos.itow);
+  put_le32(&b[4], (uint32_t)(int32_t)(pos.llh.lat / 100));
+  put_le32(&b[8], (uint32_t)(int32_t)(pos.llh.lon / 100));
+  put_le32(&b[12], (uint32_t)gps_llh_alt_to_mm(pos.llh.msl_alt));
+  put_le16(&b[16], acc_mm >= 65535.0f || acc_mm < 0.0f ? 0xFFFF : (uint16_t)acc_mm);
+  b[18] = (uint8_t)pos.fix;
+  b[19] = (uint8_t)pos.sat_num;
+
+  telem_push(TELEM_REC_POS, b, sizeof(b));
+}
+
+static void telem_sample_corr(void)
+{
+  rtcm_router_stats_t st = {0};
+  rtcm_src_t src = rtcm_router_get_active();
+  uint8_t b[8];
+
+  if (!rtcm_router_get_stats(src, &st))
+  {
+    st.age_ms = 0xFFFFFFFF;
+  }
+
+  b[0] = (uint8_t)src;
+  b[1] = 0;
+  put_le16(&b[2], sat_u16(st.age_ms));
+  put_le32(&b[4], st.frames);
+
+  telem_push(TELEM_REC_CORR, b, sizeof(b));
+}
+
+static void telem_sample_link(void)
+{
+  ntrip_mon_stats_t nm;
+  lora_stats_t ls;
+  uint8_t b[20];
+
+  ntrip_mon_get(&nm);
+  lora_stats_get(&ls);
+
+  put_le32(&b[0], nm.bytes_total);
+  put_le16(&b[4], sat_u16(nm.reconnects));
+  b[6] = nm.connected;
+  b[7] = 0;
+  put_le32(&b[8], ls.tx_sent);
+  put_le32(&b[12], ls.rx_frags);
+  put_le32(&b[16], ls.rx_lost);
+
+  telem_push(TELEM_REC_LINK, b, sizeof(b));
+}
+
+static void telem_sample_sys(void)
+{
+  uint8_t b[12];
+
+  put_le16(&b[0], rtos_stats_cpu_load(&g_telem.load));
+  put_le16(&b[2], 0);
+  put_le32(&b[4], (uint32_t)xPortGetFreeHeapSize());
+  put_le32(&b[8], (uint32_t)xPortGetMinimumEverFreeHeapSize());
+
+  telem_push(TELEM_REC_SYS, b, sizeof(b));
+}
+
+static void telem_sample_sat(void)
+{
+  gps_t *gps = gps_get_instance_handle(GPS_ID_BASE);
+  gps_sat_summary_t sum;
+  uint8_t b[2 + GPS_SAT_GNSS_CNT * 4];
+  uint8_t len = 2;
+
+  if (!gps)
+  {
+    return;
+  }
+
+  gps_sat_summary(gps, &sum);
+  b[0] = sum.src;
+  b[1] = 0;
+  for (int g = 0; g < GPS_SAT_GNSS_CNT; g++)
+  {
+    if (sum.tracked[g] == 0)
+    {
+      continue;
+    }
+    b[len++] = (uint8_t)g;
+    b[len++] = sum.tracked[g];
+    b[len++] = sum.used[g];
+    b[len++] = sum.cno[g];
+  }
+
+  telem_push(TELEM_REC_SAT, b, len);
+}
+
+/**
+ * @brief 리셋 전 부팅의 pm_trace 를 링에 (리셋 원인을 서버에서 보게)
+ */
+static void telem_push_trace(void)
+{
+  pm_trace_rec_t rec[TELEM_TRACE_PER_REC];
+  uint8_t b[4 + TELEM_TRACE_PER_REC * 12];
+  uint32_t boot;
+  uint8_t reset;
+  uint16_t cnt = pm_trace_info(true, &boot, &reset);
+
+  for (uint16_t first = 0; first < cnt;)
+  {
+    size_t n = pm_trace_read(true, first, rec, TELEM_TRACE_PER_REC);
+
+    if (n == 0)
+    {
+      break;
+    }
+
+    put_le16(&b[0], (uint16_t)boot);
+    b[2] = reset;
+    b[3] = (uint8_t)first;
+    for (size_t i = 0; i < n; i++)
+    {
+      uint8_t *p = &b[4 + i * 12];
+
+      put_le32(&p[0], rec[i].cyc);
+      put_le16(&p[4], rec[i].id);
+      put_le16(&p[6], rec[i].a);
+      put_le32(&p[8], rec[i].b);
+    }
+
+    telem_push(TELEM_REC_TRACE, b, (uint8_t)(4 + n * 12));
+    first += (uint16_t)n;
+  }
+}
+
+/* 전송 */
+
+static void telem_sent_cb(uint8_t connect_id, bool ok, void *ctx)
+{
+  (void)ctx;
+
+  if (ok)
+  {
+    return;
+  }
+
+  LOG_WARN("telemetry 전송 실패 (cid=%d)", connect_id);
+
+  taskENTER_CRITICAL();
+  g_telem.stats.send_errors++;
+  taskEXIT_CRITICAL();
+
+  // 재연결은 telemetry 태스크에서
+  g_telem.send_failed = true;
+}
+
+/**
+ * @brief 레코드 영역을 채운 pbuf 에 묶음 헤더/CRC 를 붙여 QISEND 대기열로
+ *
+ * @param n 레코드 수
+ * @param len 레코드 영역 길이
+ * @return false 대기열에 못 넣음 (pbuf 는 해제됨)
+ */
+static bool telem_send_frame(tcp_pbuf_t *pbuf, uint8_t n, uint16_t len)
+{
+  uint8_t *p = pbuf->payload;
+
+  p[0] = TELEM_SYNC1;
+  p[1] = TELEM_SYNC2;
+  p[2] = TELEM_VERSION;
+  p[3] = n;
+  put_le32(&p[4], LL_GetUID_Word0());
+  put_le32(&p[8], LL_GetUID_Word1());
+  put_le32(&p[12], LL_GetUID_Word2());
+  put_le16(&p[16], g_telem.seq);
+  put_le16(&p[18], len);
+  put_le16(&p[TELEM_HDR_LEN + len],
+           crc16_ccitt_update(0xFFFF, &p[2], TELEM_HDR_LEN - 2 + len));
+
+  if (tcp_send_async(g_telem.sock, pbuf, true, telem_sent_cb, NULL) != 0)
+  {
+    tcp_pbuf_free(pbuf);
+    return false;
+  }
+
+  g_telem.seq++;
+
+  taskENTER_CRITICAL();
+  g_telem.stats.sent += n;
+  g_telem.stats.batches++;
+  g_telem.stats.bytes += TELEM_HDR_LEN + len + TELEM_CRC_LEN;
+  taskEXIT_CRITICAL();
+
+  return true;
+}
+
+/**
+ * @brief 링 앞쪽에서 한 묶음에 들어가는 만큼 QISEND 대기열로
+ *
+ * 대기열에 넣은 뒤에야 링에서 뺀다 (pbuf/대기열이 모자라면 다음에 다시).
+ *
+ * @return true 묶음 하나를 넣음
+ */
+static bool telem_send_batch(void)
+{
+  uint16_t pos = g_telem.tail;
+  uint16_t len = 0;
+  uint16_t n = 0;
+  tcp_pbuf_t *pbuf;
+
+  while (n < g_telem.count && n < 0xFF)
+  {
+    uint16_t rec = telem_ring_rec_len(pos);
+
+    if (len + rec > TELEM_BATCH_REC_MAX)
+    {
+      break;
+    }
+    len += rec;
+    pos = (uint16_t)((pos + rec) % TELEM_RING_SIZE);
+    n++;
+  }
+
+  if (n == 0)
+  {
+    return false;
+  }
+
+  pbuf = tcp_pbuf_alloc(TELEM_HDR_LEN + len + TELEM_CRC_LEN);
+  if (!pbuf)
+  {
+    return false;
+  }
+  telem_ring_read(g_telem.tail, &((uint8_t *)pbuf->payload)[TELEM_HDR_LEN], len);
+
+  if (!telem_send_frame(pbuf, (uint8_t)n, len))
+  {
+    return false;
+  }
+
+  g_telem.tail = pos;
+  g_telem.used -= len;
+  g_telem.count -= n;
+
+  return true;
+}
+
+/**
+ * @brief 진단 묶음 다음 조각들을 묶음 하나로 (링을 거치지 않아 쌓인 레코드를 밀어내지 않음)
+ *
+ * @return true 묶음 하나를 넣음 (남은 조각이 있으면 다음에 이어서)
+ */
+static bool telem_send_diag(void)
+{
+  size_t total = diag_bundle_len();
+  size_t off = g_telem.diag_off;
+  size_t left = total > off ? total - off : 0;
+  uint16_t len = 0;
+  uint8_t n = 0;
+  tcp_pbuf_t *pbuf;
+  uint8_t *p;
+
+  while (left > 0 && len + TELEM_REC_HDR_LEN + 4 + TELEM_DIAG_CHUNK <= TELEM_BATCH_REC_MAX)
+  {
+    size_t k = left < TELEM_DIAG_CHUNK ? left : TELEM_DIAG_CHUNK;
+
+    len += TELEM_REC_HDR_LEN + 4 + k;
+    left -= k;
+    n++;
+  }
+
+  if (n == 0)
+  {
+    g_telem.diag_pending = false;
+    return false;
+  }
+
+  pbuf = tcp_pbuf_alloc(TELEM_HDR_LEN + len + TELEM_CRC_LEN);
+  if (!pbuf)
+  {
+    return false;
+  }
+  p = &pbuf->payload[TELEM_HDR_LEN];
+
+  for (uint8_t i = 0; i < n; i++)
+  {
+    size_t k = diag_bundle_read(off, &p[TELEM_REC_HDR_LEN + 4], TELEM_DIAG_CHUNK);
+
+    // 다른 경로가 묶음을 다시 만드는 중이면 이번 요청은 접음
+    if (k == 0 || (k < TELEM_DIAG_CHUNK && off + k != total))
+    {
+      tcp_pbuf_free(pbuf);
+      g_telem.diag_pending = false;
+      return false;
+    }
+    p[0] = TELEM_REC_DIAG;
+    p[1] = (uint8_t)(4 + k);
+    put_le32(&p[2], (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS));
+    put_le16(&p[TELEM_REC_HDR_LEN], (uint16_t)off);
+    put_le16(&p[TELEM_REC_HDR_LEN + 2], (uint16_t)total);
+    p += TELEM_REC_HDR_LEN + 4 + k;
+    off += k;
+  }
+
+  if (!telem_send_frame(pbuf, n, len))
+  {
+    return false;
+  }
+
+  g_telem.diag_off = (uint16_t)off;
+  g_telem.diag_pending = off < total;
+
+  taskENTER_CRITICAL();
+  g_telem.stats.records += n;
+  taskEXIT_CRITICAL();
+
+  return true;
+}
+
+/* 연결 */
+
+/**
+ * @brief 서버가 보내는 것 (GSM 태스크 컨텍스트) - 버리고 끊김만 본다
+ */
+static void telem_sink(const uint8_t *data, size_t len, void *ctx)
+{
+  (void)len;
+  (void)ctx;
+
+  if (data == NULL)
+  {
+    g_telem.peer_closed = true;
+  }
+}
+
+/**
+ * @brief TCP 연결 한 번 시도
+ *
+ * @return 0: 성공, -1: 실패 (소켓은 닫힌 상태)
+ */
+static int telem_connect(void)
+{
+  const user_params_t *params = flash_params_snapshot(NULL);
+  const char *addr;
+  int ret;
+
+  if (flash_params_changed(&g_telem.params_version))
+  {
+    g_telem.addr[0] = '\0';
+  }
+
+  if (flash_params_str_empty(params->telemetry_url) || flash_params_str_empty(params->telemetry_port))
+  {
+    LOG_ERR("telemetry 서버 설정 없음");
+    return -1;
+  }
+
+  if (g_telem.addr[0] == '\0' &&
+      gsm_dns_resolve(g_telem.gsm, TELEM_CONTEXT_ID, params->telemetry_url, g_telem.addr,
+                      sizeof(g_telem.addr), TELEM_DNS_TIMEOUT_MS) == 0)
+  {
+    LOG_INFO("telemetry 주소 캐시: %s -> %s", params->telemetry_url, g_telem.addr);
+  }
+  addr = g_telem.addr[0] ? g_telem.addr : params->telemetry_url;
+
+  LOG_INFO("telemetry 연결: %s:%s", addr, params->telemetry_port);
+
+  tcp_set_access_mode(g_telem.sock, GSM_TCP_ACCESS_PUSH);
+  ret = tcp_connect(g_telem.sock, TELEM_CONTEXT_ID, addr, atoi(params->telemetry_port),
+                    TELEM_CONNECT_TIMEOUT_MS);
+  if (ret != 0 || tcp_get_socket_state(g_telem.sock, TELEM_CONNECT_ID) != GSM_TCP_STATE_CONNECTED)
+  {
+    LOG_WARN("TCP 연결 실패 (ret=%d)", ret);
+    g_telem.addr[0] = '\0';
+    tcp_close_force(g_telem.sock);
+    return -1;
+  }
+
+  g_telem.peer_closed = false;
+  g_telem.send_failed = false;
+  tcp_set_sink(g_telem.sock, telem_sink, NULL);
+
+  return 0;
+}
+
+static void telem_disconnect(void)
+{
+  tcp_set_sink(g_telem.sock, NULL, NULL);
+  tcp_close_force(g_telem.sock);
+}
+
+/**
+ * @brief 연결된 상태가 아직 유효한지 (상대가 끊음, 전송 실패, 소켓 닫힘)
+ */
+static bool telem_link_ok(void)
+{
+  gsm_tcp_state_t state;
+
+  if (g_telem.peer_closed || g_telem.send_failed)
+  {
+    return false;
+  }
+
+  state = tcp_get_socket_state(g_telem.sock, TELEM_CONNECT_ID);
+  return state != GSM_TCP_STATE_CLOSING && state != GSM_TCP_STATE_CLOSED;
+}
+
+/**
+ * @brief telemetry 태스크
+ *
+ * 1 초마다 위치/보정 나이, 간격마다 링크/CPU/heap 레코드를 링에 쌓는다.
+ * 간격이 지났거나 한 묶음만큼 차면 연결된 동안 링을 비운다. 연결이 안 돼 있어도
+ * 레코드는 계속 쌓는다.
+ */
+static void telem_task(void *pvParameter)
+{
+  (void)pvParameter;
+
+  TickType_t next_sample = xTaskGetTickCount();
+  TickType_t next_flush = next_sample + pdMS_TO_TICKS(telem_interval_ms());
+  TickType_t retry_at = next_sample;
+  uint32_t retry_ms = TELEM_RETRY_MIN_MS;
+  bool flush_due = false;
+  bool connected_once = false;
+
+  LOG_INFO("telemetry 태스크 시작");
+  telem_push_trace();
+
+  while (1)
+  {
+    xTaskDelayUntil(&next_sample, pdMS_TO_TICKS(TELEM_SAMPLE_MS));
+
+    TickType_t now = xTaskGetTickCount();
+
+    telem_sample_pos();
+    telem_sample_corr();
+
+    if ((int32_t)(now - next_flush) >= 0)
+    {
+      telem_sample_link();
+      telem_sample_sys();
+      telem_sample_sat();
+      next_flush = now + pdMS_TO_TICKS(telem_interval_ms());
+      flush_due = true;
+    }
+
+    // 멈춘 동안 레코드는 링에 쌓고 (차면 오래된 것부터 버림) 연결은 끊어 둠
+    if (g_telem.paused)
+    {
+      if (g_telem.state == TELEM_CONNECTED)
+      {
+        LOG_INFO("telemetry 멈춤 (데이터 한도)");
+        telem_disconnect();
+        g_telem.state = TELEM_CONNECTING;
+      }
+      retry_at = now;
+      continue;
+    }
+
+    if (g_telem.state == TELEM_CONNECTED && !telem_link_ok())
+    {
+      LOG_WARN("telemetry 끊김 (peer=%d, send=%d), 재연결", g_telem.peer_closed,
+               g_telem.send_failed);
+      telem_disconnect();
+      g_telem.state = TELEM_CONNECTING;
+      retry_at = now;
+    }
+
+    if (g_telem.state != TELEM_CONNECTED && (int32_t)(now - retry_at) >= 0)
+    {
+      if (!g_telem.sock)
+      {
+        g_telem.sock = tcp_socket_create(g_telem.gsm, TELEM_CONNECT_ID);
+      }
+
+      if (g_telem.sock && telem_connect() == 0)
+      {
+        retry_ms = TELEM_RETRY_MIN_MS;
+        taskENTER_CRITICAL();
+        if (connected_once)
+        {
+          g_telem.stats.reconnects++;
+        }
+        taskEXIT_CRITICAL();
+        connected_once = true;
+        g_telem.state = TELEM_CONNECTED;
+        LOG_INFO("telemetry 연결됨 (밀린 레코드 %d)", g_telem.count);
+      }
+      else
+      {
+        LOG_WARN("telemetry 연결 실패, %lu ms 뒤 재시도", retry_ms);
+        retry_at = xTaskGetTickCount() + pdMS_TO_TICKS(retry_ms);
+        retry_ms = retry_ms * 2 > TELEM_RETRY_MAX_MS ? TELEM_RETRY_MAX_MS : retry_ms * 2;
+      }
+
+      // 연결 시도로 막혀 있던 동안의 샘플을 몰아서 찍지 않게
+      next_sample = xTaskGetTickCount();
+    }
+
+    if (g_telem.diag_request)
+    {
+      g_telem.diag_request = false;
+      g_telem.diag_off = 0;
+      g_telem.diag_pending = diag_bundle_build(NULL) > 0;
+    }
+
+    if (g_telem.state != TELEM_CONNECTED ||
+        (!flush_due && !g_telem.diag_pending && g_telem.used < TELEM_BATCH_REC_MAX))
+    {
+      continue;
+    }
+
+    // 진단 묶음은 깰 때마다 한 묶음씩만 (TX 대기열을 다 쓰지 않게)
+    int sent = g_telem.diag_pending && telem_send_diag() ? 1 : 0;
+
+    for (int i = sent; i < TELEM_BATCHES_PER_WAKE && telem_send_batch(); i++)
+    {
+    }
+
+    // 밀린 것이 남았으면 다음에 이어서
+    flush_due = g_telem.count > 0;
+  }
+}
+
+bool telemetry_send_diag(void)
+{
+  if (g_telem.task == NULL)
+  {
+    return false;
+  }
+
+  g_telem.diag_request = true;
+  return true;
+}
+
+void telemetry_set_paused(bool paused)
+{
+  g_telem.paused = paused;
+}
+
+bool telemetry_start(gsm_t *gsm)
+{
+  if (g_telem.task != NULL)
+  {
+    return true; // 이미 동작 중
+  }
+
+  if (!telemetry_configured())
+  {
+    return false;
+  }
+
+  g_telem.gsm = gsm;
+  g_telem.addr[0] = '\0';
+  g_telem.state = TELEM_CONNECTING;
+  telem_ring_reset();
+
+  HEAP_TRACK(HEAP_TAG_TASK, xTaskCreate(telem_task, "telemetry", 768, NULL, tskIDLE_PRIORITY + 2,
+                                        &g_telem.task));
+
+  if (g_telem.task == NULL)
+  {
+    g_telem.state = TELEM_IDLE;
+    return false;
+  }
+  return true;
+}
+
+void telemetry_stop(void)
+{
+  if (g_telem.task != NULL)
+  {
+    vTaskDelete(g_telem.task);
+    g_telem.task = NULL;
+  }
+  g_telem.state = TELEM_IDLE;
+
+  if (g_telem.sock != NULL)
+  {
+    telem_disconnect();
+    tcp_socket_destroy(g_telem.sock);
+    g_telem.sock = NULL;
+  }
+  g_telem.addr[0] = '\0';
+  telem_ring_reset();
+
+  LOG_INFO("telemetry 중지");
+}
+
+bool telemetry_is_running(void)
+{
+  return g_telem.task != NULL;
+}
+
+void telemetry_get_stats(telem_stats_t *out)
+{
+  taskENTER_CRITICAL();
+  *out = g_telem.stats;
+  taskEXIT_CRITICAL();
+  out->state = g_telem.state;
+}
@@ -0,0 +1,108 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include "gsm.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief 원격 모니터링 (LTE 로 바이너리 telemetry 묶음 전송)
+ *
+ * 위치/보정 나이는 1 초마다, 링크 통계와 CPU/heap 은 묶음마다 한 번 레코드로
+ * 만들어 RAM 링에 쌓고, 설정한 간격마다 (또는 한 번에 보낼 만큼 차면) 묶음
+ * 하나를 QISEND 한 번으로 보낸다. 끊겨 있는 동안은 링이 차면 오래된 레코드부터
+ * 버린다.
+ *
+ * 묶음 (little-endian):
+ *
+ *  off size
+ *   0  1   sync1 0xA5
+ *   1  1   sync2 0x5B
+ *   2  1   version (1)
+ *   3  1   레코드 수
+ *   4  12  MCU UID
+ *  16  2   묶음 번호
+ *  18  2   레코드 영역 길이 N
+ *  20  N   레코드들
+ *  20+N 2  CRC16-CCITT (init 0xFFFF, version 부터 레코드 끝까지)
+ *
+ * 레코드: type(1) len(1) tick[ms](4) + len byte (telem_rec_type_t 참고)
+ */
+#define TELEM_SYNC1 0xA5
+#define TELEM_SYNC2 0x5B
+#define TELEM_VERSION 1
+
+typedef enum
+{
+  TELEM_REC_POS = 1,  // itow(4) lat(4) lon(4) [1e-7 deg] msl(4) [mm] h_acc(2) [mm] fix(1) sat(1)
+  TELEM_REC_CORR = 2, // src(1) 0(1) age(2) [ms, 포화] frames(4)
+  TELEM_REC_LINK = 3, // ntrip bytes(4) reconnects(2) connected(1) 0(1)
+                      // lora tx_sent(4) rx_frags(4) rx_lost(4)
+  TELEM_REC_SYS = 4,  // cpu(2) [0.1 %] 0(2) heap free(4) heap min(4)
+  TELEM_REC_TRACE = 5, // 리셋 전 부팅의 pm_trace (태스크 시작 때 한 번, 여러 레코드로 나눔)
+                       // boot(2) reset(1) first(1) + 12 바이트씩 cyc(4) id(2) a(2) b(4)
+  TELEM_REC_SAT = 6,   // GPS_ID_BASE 위성 요약: src(1) 0(1) + 위성이 있는 위성계마다
+                       // gnss(1) [UBX gnssId] tracked(1) used(1) cno(1) [dBHz]
+  TELEM_REC_DIAG = 7,  // 진단 묶음 조각 (telemetry_send_diag, diag_bundle.h)
+                       // off(2) total(2) + 최대 248 byte
+} telem_rec_type_t;
+
+typedef enum
+{
+  TELEM_IDLE = 0,   // 시작 안 함
+  TELEM_CONNECTING, // 서버에 안 붙음 (레코드는 계속 쌓음)
+  TELEM_CONNECTED,
+} telem_state_t;
+
+typedef struct
+{
+  uint8_t state;        // telem_state_t
+  uint32_t records;     // 링에 쌓은 레코드
+  uint32_t sent;        // QISEND 대기열에 넣은 레코드
+  uint32_t overwritten; // 링이 차서 보내기 전에 버린 레코드
+  uint32_t batches;     // QISEND 대기열에 넣은 묶음
+  uint32_t bytes;       // 보낸 바이트 (묶음 헤더/CRC 포함)
+  uint32_t send_errors; // 대기열에 넣은 뒤 QISEND 가 실패한 묶음
+  uint32_t reconnects;  // 연결된 뒤 끊겨 다시 붙은 횟수
+} telem_stats_t;
+
+/**
+ * @brief telemetry 서버 설정이 있는지 (url, port)
+ */
+bool telemetry_configured(void);
+
+/**
+ * @brief telemetry 태스크 시작 (이미 동작 중이면 무시)
+ *
+ * LTE 초기화가 끝난 뒤 부른다. 끊기면 태스크가 알아서 다시 붙는다.
+ *
+ * @param gsm GSM 핸들
+ * @return false 설정 없음 또는 태스크 생성 실패
+ */
+bool telemetry_start(gsm_t *gsm);
+
+/**
+ * @brief 중지 (태스크 삭제, 소켓 정리, 쌓인 레코드 버림)
+ */
+void telemetry_stop(void);
+
+bool telemetry_is_running(void);
+
+/**
+ * @brief 보내기 멈춤/재개 (데이터 한도 정책, 멈춘 동안 소켓을 닫음)
+ */
+void telemetry_set_paused(bool paused);
+
+void telemetry_get_stats(telem_stats_t *out);
+
+/**
+ * @brief 진단 묶음을 새로 만들어 TELEM_REC_DIAG 레코드로 보냄
+ *
+ * telemetry 태스크가 다음에 깰 때 만들고, 연결된 동안 깰 때마다 묶음 하나씩
+ * 보낸다 (레코드 링은 거치지 않음). 끊겨 있으면 연결된 뒤 이어서 보낸다.
+ *
+ * @return false telemetry 가 동작 중이 아님
+ */
+bool telemetry_send_diag(void);
+
+#endif
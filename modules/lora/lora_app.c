@@ -1,14 +1,30 @@
 #include "lora.h"
+#include "lora_radio.h"
 #include "lora_app.h"
 #include "lora_port.h"
 #include "board_config.h"
 #include "gps.h"
 #include "gps_app.h"
+#include "rtcm_router.h"
+#include "lora_stats.h"
+#include "rtcm_reassembly.h"
+#include "flash_params.h"
 #include "semphr.h"
+#include "rtos_static.h"
+#include "heap_track.h"
+#include "mem_watermark.h"
+#include "trace_marker.h"
+#include "pm_trace.h"
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include "led.h"
+#include "parser.h"
+#include "fmt.h"
+#include "irq_latency.h"
+#include "dma_ring.h"
+#include "init_seq.h"
+#include "simd.h"
 
 #ifndef TAG
 #define TAG "LORA_APP"
@@ -17,54 +33,142 @@
 #include "log.h"
 
 #define LORA_CMD_QUEUE_SIZE 25  // Increased for multiple RTCM types with fragmentation
+// 큐가 full 이어도 TX Task 가 처리 중인 요청 하나는 따로 있으므로 +1
+#define LORA_CMD_POOL_SIZE (LORA_CMD_QUEUE_SIZE + 1)
 #define LORA_AT_CMD_TIMEOUT_MS 2000
 #define LORA_INIT_MAX_RETRY 3
 #define LORA_INIT_TIMEOUT_MS 2000 // work_mode AT command timeout
 
-#define LORA_RECV_BUF_SIZE 1024
+#define LORA_RECV_BUF_SIZE LORA_RX_RING_SIZE
 
-static void lora_process_task(void *pvParameter);
-static void lora_tx_task(void *pvParameter);
-static void lora_tx_test_task(void *pvParameter);
+// 한 줄 최대 길이 (at+recv=<RSSI>,<SNR>,<LEN>: + 256 바이트 HEX)
+#define LORA_RX_LINE_MAX 576
 
 /**
- * @brief LoRa P2P BASE 모드 초기화 명령어
+ * @brief P2P 변조 설정 (초기화 명령어와 ToA 계산이 같은 값을 쓰도록 한 곳에 둠)
  */
-static const char *lora_p2p_base_cmds[] = {
-    "at+set_config=lora:work_mode:1\r\n",             // P2P 모드 (1=P2P, 0=LoRaWAN)
-    "at+set_config=lorap2p:922500000:7:2:1:8:14\r\n", // 922.5MHz, SF7, BW500kHz, CR4/5, Preamble8, 14dBm
-    "at+set_config=lorap2p:transfer_mode:2\r\n",      // Transfer mode 2 (BASE)
-};
+#define LORA_P2P_FREQ 922500000
+#define LORA_P2P_SF 7
+#define LORA_P2P_BW 2        // 500kHz
+#define LORA_P2P_CR 1        // 4/5
+#define LORA_P2P_PREAMBLE 8
+#define LORA_P2P_PWR 14      // dBm
+
+#define LORA_STR_(x) #x
+#define LORA_STR(x) LORA_STR_(x)
+#define LORA_P2P_CONFIG_CMD                                                    \
+  "at+set_config=lorap2p:" LORA_STR(LORA_P2P_FREQ) ":" LORA_STR(LORA_P2P_SF)  \
+  ":" LORA_STR(LORA_P2P_BW) ":" LORA_STR(LORA_P2P_CR) ":"                      \
+  LORA_STR(LORA_P2P_PREAMBLE) ":" LORA_STR(LORA_P2P_PWR) "\r\n"
+
+// 초기화 끝에 올려 보는 모듈 UART 속도 (확인이 안 되면 LORA_UART_BAUD_DEFAULT 유지)
+#define LORA_UART_BAUD_FAST 460800
+#define LORA_UART_BAUD_CMD "at+set_config=device:uart:1:" LORA_STR(LORA_UART_BAUD_FAST) "\r\n"
+#define LORA_UART_PROBE_CMD "at+version\r\n"
+#define LORA_UART_SWITCH_MS 20  // 모듈이 속도를 바꾸는 시간
+// 송신 명령 OK 응답 대기 여유 (ToA + UART 전송 시간에 더함)
+#define LORA_RAW_RESP_MARGIN_MS 100
+// 계산한 송신 종료 뒤 다음 명령 전 여유 (tick 반올림, 모듈 RX 전환)
+#define LORA_TX_GUARD_MS 2
+
+// at+send=lorap2p:<HEX>\r\n, HEX 변환으로 2배가 되므로 바이너리는 118 바이트까지
+#define LORA_P2P_CMD_PREFIX "at+send=lorap2p:"
+#define LORA_P2P_CMD_PREFIX_LEN (sizeof(LORA_P2P_CMD_PREFIX) - 1)
+#define LORA_P2P_MAX_RAW 118
+#define LORA_P2P_CMD_SIZE (LORA_P2P_CMD_PREFIX_LEN + LORA_P2P_MAX_RAW * 2 + 3)
 
 /**
- * @brief LoRa P2P ROVER 모드 초기화 명령어
+ * @brief 초당 쓸 수 있는 링크 점유 시간 (‰)
+ *
+ * 송신마다 ToA + 명령 UART 전송 시간을 빼고, 시간이 지나면 채워진다.
+ * 나머지는 설정 명령이나 응답 처리 몫.
  */
-static const char *lora_p2p_rover_cmds[] = {
-    "at+set_config=lora:work_mode:1\r\n",             // P2P 모드 (1=P2P, 0=LoRaWAN)
-    "at+set_config=lorap2p:922500000:7:2:1:8:14\r\n", // 922.5MHz, SF7, BW500kHz, CR4/5, Preamble8, 14dBm
-    "at+set_config=lorap2p:transfer_mode:1\r\n",      // Transfer mode 1 (ROVER)
-};
+#define LORA_AIRTIME_BUDGET_PERMILLE 900
 
-#define LORA_P2P_BASE_CMD_COUNT (sizeof(lora_p2p_base_cmds) / sizeof(lora_p2p_base_cmds[0]))
-#define LORA_P2P_ROVER_CMD_COUNT (sizeof(lora_p2p_rover_cmds) / sizeof(lora_p2p_rover_cmds[0]))
+/**
+ * @brief 링크 적응 설정
+ */
+#define LORA_LINK_POLL_MS 10000      // 베이스 POLL 주기
+#define LORA_LINK_FB_WINDOW_MS 800   // 응답 창 (로버 모드 전환 2번 + FEEDBACK ToA 2배 더함)
+#define LORA_LINK_LOST_POLLS 3       // 연속 무응답이면 가장 튼튼한 프로파일로
+#define LORA_LINK_MARGIN_DB 5        // 필요한 복조 SNR 여유
+#define LORA_LINK_HYST_DB 2          // 빨라질 때 추가로 필요한 여유
+#define LORA_LINK_SET_REPEAT 3       // 프로파일 변경 알림 반복 횟수
+#define LORA_LINK_MODE_SENDER "at+set_config=lorap2p:transfer_mode:2\r\n"
+#define LORA_LINK_MODE_RECEIVER "at+set_config=lorap2p:transfer_mode:1\r\n"
 
+/**
+ * @brief 중계 설정 (LORA_MODE_REPEATER, 중복 판정은 로버도 씀)
+ */
+#define LORA_RELAY_SEEN_MAX 64       // 중복 판정에 기억하는 최근 fragment 수
+#define LORA_RELAY_STALE_SEQ 4       // 이 안쪽의 이전 seq 는 늦게 온 중계 사본
+#define LORA_RELAY_QUIET_MS 50       // fragment 하나 송신 간격에 더하는 여유
+#define LORA_RELAY_SLOT_MS 250       // 중계 slot 폭
+#ifndef LORA_RELAY_SLOT
+#define LORA_RELAY_SLOT 0
+#endif
+#if LORA_MODE == LORA_MODE_REPEATER
+#define LORA_RELAY_MAX_FRAGS 16      // 한 epoch 에 모아 둘 fragment 수
+#else
+#define LORA_RELAY_MAX_FRAGS 1       // 중계기 보드가 아니면 쓰지 않음
+#endif
 
-typedef void (*lora_init_callback_t)(bool success, void *user_data);
+/**
+ * @brief SPI 무선칩 송신 (lora_t.radio, 보드 LORA_RADIO)
+ *
+ * 보내기 전에 순간 RSSI 와 CAD 로 채널을 듣고 (LORA_REG_*), 바쁘면 조금씩
+ * 늘려 기다렸다가 다시 듣는다. 끝까지 바쁘면 규정대로 보내지 않는다.
+ */
+#define LORA_RADIO_CAD_RETRY 3
+#define LORA_RADIO_CAD_TIMEOUT_MS 20   // CAD 한 번 (SF12/BW125 4 심볼도 충분)
+#define LORA_RADIO_CAD_BACKOFF_MS 5    // n 번째 바쁨 뒤 n x 이만큼 대기
+#define LORA_AT_P2P_CONFIG "at+set_config=lorap2p:"
+#define LORA_AT_P2P_MODE "at+set_config=lorap2p:transfer_mode:"
 
-typedef struct
-{
-  uint8_t current_step;          // 현재 단계 (0 ~ cmd_count-1)
-  uint8_t retry_count;           // 현재 단계 재시도 횟수
-  const char **cmd_list;         // 명령어 리스트
-  uint8_t cmd_count;             // 명령어 개수
-  lora_init_callback_t callback; // 완료 콜백
-} lora_init_context_t;
+/**
+ * @brief TDMA 설정 (베이스 송신 slot, GNSS 초 단위 frame)
+ */
+#define LORA_TDMA_FRAME_MS 1000          // frame 길이 (GNSS 1초)
+#define LORA_TDMA_GUARD_MS 30            // slot 끝 여유 (GNSS 시간 출력 지연, UART 오차)
+#define LORA_TDMA_TIME_MAX_AGE_MS 3000   // 이보다 오래된 itow 는 쓰지 않음
+
+static void lora_process_task(void *pvParameter);
+static void lora_tx_task(void *pvParameter);
+static TickType_t lora_link_poll(void);
+static bool lora_link_on_recv(const lora_p2p_recv_data_t *recv_data);
+static TickType_t lora_relay_poll(void);
+static bool lora_relay_is_dup(const uint8_t *hdr);
+static void lora_relay_on_frag(const uint8_t *data, size_t len);
+static void lora_tx_test_task(void *pvParameter);
+
+/**
+ * @brief LoRa P2P 초기화 순서
+ *
+ * work_mode 를 바꾸면 모듈이 재시작하며 "Initialization OK" 같은 줄을 내므로
+ * 응답을 보지 않고 타임아웃만큼 기다린다 (expect NULL).
+ */
+#define LORA_INIT_STEP(c, e)                                                   \
+  {.cmd = (c), .expect = (e), .timeout_ms = LORA_INIT_TIMEOUT_MS,       \
+   .retries = LORA_INIT_MAX_RETRY - 1}
+
+static const init_seq_step_t lora_p2p_base_steps[] = {
+    LORA_INIT_STEP("at+set_config=lora:work_mode:1\r\n", NULL),        // P2P 모드 (1=P2P, 0=LoRaWAN)
+    LORA_INIT_STEP(LORA_P2P_CONFIG_CMD, "OK"),                         // 922.5MHz, SF7, BW500kHz, CR4/5, Preamble8, 14dBm
+    LORA_INIT_STEP("at+set_config=lorap2p:transfer_mode:2\r\n", "OK"), // Transfer mode 2 (BASE)
+};
+
+static const init_seq_step_t lora_p2p_rover_steps[] = {
+    LORA_INIT_STEP("at+set_config=lora:work_mode:1\r\n", NULL),        // P2P 모드 (1=P2P, 0=LoRaWAN)
+    LORA_INIT_STEP(LORA_P2P_CONFIG_CMD, "OK"),                         // 922.5MHz, SF7, BW500kHz, CR4/5, Preamble8, 14dBm
+    LORA_INIT_STEP("at+set_config=lorap2p:transfer_mode:1\r\n", "OK"), // Transfer mode 1 (ROVER)
+};
 
 typedef struct
 {
   lora_t lora;
   QueueHandle_t queue;     // RX 이벤트 큐
-  QueueHandle_t cmd_queue; // TX 명령어 큐
+  QueueHandle_t cmd_queue; // TX 명령어 큐 (lora_cmd_request_t *)
+  QueueHandle_t cmd_free;  // 빈 요청 슬롯 (lora_cmd_request_t *)
   TaskHandle_t rx_task;    // RX Task
   TaskHandle_t tx_task;    // TX Task
   SemaphoreHandle_t mutex; // UART 송신 보호용 mutex
@@ -78,652 +182,1067 @@ typedef struct
   void *p2p_recv_user_data;                   // P2P 수신 콜백 사용자 데이터
 
   rtcm_reassembly_t rtcm_reassembly;          // RTCM fragment 재조립 버퍼
+
+  lora_modem_params_t p2p_params;             // 현재 P2P 변조 설정 (ToA 계산용)
+  int32_t airtime_us;                         // 남은 링크 점유 예산 (음수면 빚)
+  TickType_t airtime_tick;                    // 마지막 예산 갱신 시각
+
+  bool tx_busy;                               // 무선 송신 중 (tx_busy_until 까지)
+  TickType_t tx_busy_until;                   // 직전 송신이 끝나는 tick
+  bool tx_overlap;                            // 직전 송신 중에 다음 명령 UART 를 미리 보냄
+
+  uint32_t baud;                              // 호스트 UART 속도
+
+  // SPI 무선칩 (instance.lora.radio 가 있을 때)
+  bool radio_ready;                           // 칩 초기화 성공
+  bool radio_rx;                              // 대기 중 연속 수신 (transfer_mode:1)
+  volatile lora_radio_evt_t radio_evt;        // TX Task 가 기다리는 이벤트 결과
 } lora_app_instance_t;
 
 static lora_app_instance_t instance;
 
 /**
- * @brief LoRa 초기화 완료 콜백
+ * @brief 링크 적응 프로파일과 상태 (동작은 아래 lora_link_poll() 부근 참고)
  */
-static void lora_overall_init_complete(bool success, void *user_data)
+typedef struct
 {
+  uint8_t sf;
+  uint8_t bw;  // 0:125kHz, 1:250kHz, 2:500kHz
+} lora_link_profile_t;
 
-  const board_config_t *config = board_get_config();
-  if (config->lora_mode == LORA_MODE_BASE)
-  {
-    LOG_INFO("LoRa BASE init %s", success ? "succeeded" : "failed");
-  }
-  else if (config->lora_mode == LORA_MODE_ROVER)
-  {
-    LOG_INFO("LoRa ROVER init %s", success ? "succeeded" : "failed");
-  }
+// 빠른 순서 (0 이 초기화 명령어의 LORA_P2P_SF / LORA_P2P_BW)
+static const lora_link_profile_t lora_link_profiles[LORA_LINK_PROFILE_COUNT] = {
+    {7, 2}, {8, 2}, {9, 2}, {9, 1}, {10, 1}, {10, 0},
+};
 
-  if (success)
-  {
-    instance.init_complete = true;
-    LOG_INFO("LoRa init complete - now accepting P2P data");
+#define LORA_LINK_ROBUST (LORA_LINK_PROFILE_COUNT - 1)
 
-    led_set_color(3, LED_COLOR_GREEN);
-    led_set_state(3, true);
-  }
-  else
-  {
-    LOG_ERR("LoRa init failed");
-    led_set_color(3, LED_COLOR_RED);
-    led_set_state(3, true);
-  }
-}
+static struct
+{
+  bool enabled;
+  uint8_t profile;          // 지금 쓰는 프로파일
+  uint8_t poll_seq;
+  TickType_t next_poll;     // 베이스: 다음 POLL 시각
+  bool awaiting;            // 베이스: 응답 창 진행 중
+  bool window_done;         // 베이스: 응답 창 끝 (transfer_mode:2 완료)
+  bool fb_valid;            // 베이스: 이번 POLL 의 FEEDBACK 받음
+  lora_link_feedback_t fb;
+  uint8_t misses;           // 베이스: 연속 응답 없는 POLL 수
+
+  // 로버: 지난 FEEDBACK 이후 수신 통계
+  int32_t rssi_sum;
+  int32_t snr_sum;
+  int16_t snr_min;
+  uint16_t rx_count;
+  uint32_t dropped_base;    // 지난 FEEDBACK 때 dropped_epochs
+  TickType_t last_rx;
+
+  lora_link_status_t st;
+} lora_link;
 
 /**
- * @brief LoRa 초기화 명령어 콜백 (재귀적 호출)
+ * @brief 중계 상태 (동작은 아래 lora_relay_poll() 부근 참고)
+ *
+ * 중복 판정은 RX Task, 모은 epoch 송신은 TX Task 에서 한다.
+ * pending 동안은 RX Task 가 frag 를 건드리지 않는다.
  */
-static void lora_init_command_callback(bool success, void *user_data)
+static struct
 {
-  lora_init_context_t *ctx = (lora_init_context_t *)user_data;
+  // 중복 판정 (로버, 중계기)
+  uint16_t seen[LORA_RELAY_SEEN_MAX];  // (seq << 8) | 헤더 [1]
+  uint8_t seen_next;
+  uint8_t seen_cnt;
+  uint8_t newest_seq;
+  bool have_seq;
+
+  // 중계기: 모으는 중인 epoch
+  uint8_t slot;
+  bool collecting;
+  bool pending;             // 다 모음, due 에 송신
+  bool end_seen;            // epoch 끝 fragment 받음
+  bool fec;                 // 베이스가 패리티를 보냄 (데이터 끝 뒤에 패리티가 더 옴)
+  uint8_t seq;
+  uint8_t count;
+  TickType_t last_rx;
+  TickType_t due;
+  uint8_t frag[LORA_RELAY_MAX_FRAGS][LORA_P2P_MAX_RAW];
+  uint8_t frag_len[LORA_RELAY_MAX_FRAGS];
+
+  lora_relay_status_t st;
+} lora_relay = {.slot = LORA_RELAY_SLOT};
 
-  if (!ctx)
-  {
-    LOG_ERR("LoRa init context is NULL");
-    return;
-  }
+/**
+ * @brief TDMA 상태 (slots 0: 끔)
+ */
+static struct
+{
+  uint8_t slot;
+  uint8_t slots;
+  bool untimed;             // GNSS 시간이 없어 slot 없이 보내는 중 (로그 한 번)
+} lora_tdma;
 
-  if (success)
-  {
-    // 명령어 성공
-    LOG_INFO("LoRa init step %d/%d OK: %s",
-             ctx->current_step + 1, ctx->cmd_count,
-             ctx->cmd_list[ctx->current_step]);
+/**
+ * @brief 송신 규정 장부 (TX Task 만 고침, LORA_REG_*)
+ */
+#define LORA_REG_BUCKETS 60 // 1 분 칸, 최근 60 분
 
-    // 다음 단계로
-    ctx->current_step++;
-    ctx->retry_count = 0;
+static struct
+{
+  uint32_t cont_us;         // 지금 이어지는 연속 송신
+  TickType_t last_end;      // 마지막 송신이 끝난 (끝날) tick
+  uint32_t min_us[LORA_REG_BUCKETS];
+  uint8_t min_idx;
+  TickType_t min_tick;      // 지금 칸 시작
+  uint32_t hour_us;         // min_us 합
+  uint64_t toa_us;
+  lora_reg_status_t st;
+} lora_reg;
 
-    // 모든 단계 완료?
-    if (ctx->current_step >= ctx->cmd_count)
-    {
-      LOG_INFO("LoRa init sequence complete!");
-      if (ctx->callback)
-      {
-        ctx->callback(true, NULL);
-      }
-      // 컨텍스트 메모리 해제
-      vPortFree(ctx);
-      return;
-    }
+/**
+ * @brief 명령어 요청 슬롯 (큐에는 포인터만 오감)
+ *
+ * 비동기 요청은 TX Task 가 완료 콜백 뒤에 반납하고,
+ * 동기 요청은 결과를 받은 호출자가 반납한다.
+ */
+static lora_cmd_request_t lora_cmd_pool[LORA_CMD_POOL_SIZE];
 
-    // 다음 명령어 전송
-    // work_mode 명령어는 응답 파싱 건너뛰기
-    bool skip = (strstr(ctx->cmd_list[ctx->current_step], "work_mode") != NULL);
-    lora_send_command_async(ctx->cmd_list[ctx->current_step],
-                            LORA_INIT_TIMEOUT_MS, 0, lora_init_command_callback, ctx, skip);
-  }
-  else
-  {
-    // 명령어 실패
-    ctx->retry_count++;
+#define LORA_RX_QUEUE_LEN 10
+#define LORA_TASK_STACK_WORDS 1024
 
-    if (ctx->retry_count < LORA_INIT_MAX_RETRY)
-    {
-      // 재시도
-      LOG_WARN("LoRa init step %d/%d failed, retrying (%d/%d): %s",
-               ctx->current_step + 1, ctx->cmd_count,
-               ctx->retry_count, LORA_INIT_MAX_RETRY,
-               ctx->cmd_list[ctx->current_step]);
-
-      // 같은 명령어 재전송
-      // work_mode 명령어는 응답 파싱 건너뛰기
-      bool skip = (strstr(ctx->cmd_list[ctx->current_step], "work_mode") != NULL);
-      lora_send_command_async(ctx->cmd_list[ctx->current_step],
-                              LORA_INIT_TIMEOUT_MS, 0, lora_init_command_callback, ctx, skip);
-    }
-    else
-    {
-      // 최대 재시도 초과
-      LOG_ERR("LoRa init failed at step %d/%d after %d retries: %s",
-              ctx->current_step + 1, ctx->cmd_count,
-              LORA_INIT_MAX_RETRY, ctx->cmd_list[ctx->current_step]);
+RTOS_STATIC_TASK(lora_rx, LORA_TASK_STACK_WORDS);
+RTOS_STATIC_TASK(lora_tx, LORA_TASK_STACK_WORDS);
+RTOS_STATIC_QUEUE(lora_rx_queue, LORA_RX_QUEUE_LEN, sizeof(uint8_t));
+RTOS_STATIC_QUEUE(lora_cmd_queue, LORA_CMD_POOL_SIZE, sizeof(lora_cmd_request_t *));
+RTOS_STATIC_QUEUE(lora_cmd_free, LORA_CMD_POOL_SIZE, sizeof(lora_cmd_request_t *));
+static StaticSemaphore_t lora_mutex_buf;
 
-      if (ctx->callback)
-      {
-        ctx->callback(false, NULL);
-      }
-      // 컨텍스트 메모리 해제
-      vPortFree(ctx);
-    }
-  }
-}
+/* 링은 깨어날 때 쌓여 있던 byte, 재조립은 모인 byte (넘치면 size 로 기록) */
+static mem_wm_t lora_rx_wm = MEM_WM_INIT("lora_rx", LORA_RECV_BUF_SIZE);
 
 /**
- * @brief LoRa P2P BASE 모드 초기화 (비동기)
+ * @brief 빈 요청 슬롯 꺼내기
+ *
+ * @param wait 슬롯이 없을 때 기다릴 tick
+ * @return lora_cmd_request_t* 0 으로 채운 슬롯, 없으면 NULL
  */
-static bool lora_init_p2p_base_async(lora_init_callback_t callback)
+static lora_cmd_request_t *lora_cmd_alloc(TickType_t wait)
 {
-  // 초기화 컨텍스트 생성 (동적 할당)
-  lora_init_context_t *ctx = (lora_init_context_t *)pvPortMalloc(sizeof(lora_init_context_t));
-  if (!ctx)
+  lora_cmd_request_t *req = NULL;
+
+  if (instance.cmd_free == NULL ||
+      xQueueReceive(instance.cmd_free, &req, wait) != pdTRUE)
   {
-    LOG_ERR("Failed to allocate LoRa init context");
-    return false;
+    return NULL;
   }
 
-  // 컨텍스트 초기화
-  ctx->current_step = 0;
-  ctx->retry_count = 0;
-  ctx->cmd_list = lora_p2p_base_cmds;
-  ctx->cmd_count = LORA_P2P_BASE_CMD_COUNT;
-  ctx->callback = callback;
+  memset(req, 0, sizeof(*req));
+  return req;
+}
+
+static void lora_cmd_free(lora_cmd_request_t *req)
+{
+  xQueueSend(instance.cmd_free, &req, 0);
+}
+
+/**
+ * @brief 경과 시간만큼 링크 점유 예산 채우기 (critical section 안에서 호출)
+ */
+/**
+ * @brief 초당 점유 예산 (‰), TDMA 를 쓰면 자기 slot 몫만
+ */
+static uint32_t lora_airtime_permille(void)
+{
+  return lora_tdma.slots ? LORA_AIRTIME_BUDGET_PERMILLE / lora_tdma.slots
+                         : LORA_AIRTIME_BUDGET_PERMILLE;
+}
 
-  LOG_INFO("Starting LoRa P2P BASE init sequence (%d commands)", ctx->cmd_count);
+static void lora_airtime_refill(void)
+{
+  TickType_t now = xTaskGetTickCount();
+  uint32_t elapsed_ms = (now - instance.airtime_tick) * 1000 / configTICK_RATE_HZ;
 
-  // 첫 번째 명령어 전송
-  // work_mode 명령어는 응답 파싱 건너뛰기
-  bool skip = (strstr(ctx->cmd_list[0], "work_mode") != NULL);
-  if (!lora_send_command_async(ctx->cmd_list[0], LORA_INIT_TIMEOUT_MS, 0,
-                               lora_init_command_callback, ctx, skip))
+  if (elapsed_ms == 0)
   {
-    LOG_ERR("Failed to start LoRa init sequence");
-    vPortFree(ctx);
-    return false;
+    return;
   }
 
-  return true;
+  instance.airtime_tick = now;
+
+  uint32_t permille = lora_airtime_permille();
+  int64_t budget_us = 1000LL * permille;
+  int64_t refilled = (int64_t)instance.airtime_us + (int64_t)elapsed_ms * permille;
+  if (refilled > budget_us)
+  {
+    refilled = budget_us;
+  }
+  instance.airtime_us = (int32_t)refilled;
 }
 
 /**
- * @brief LoRa P2P ROVER 모드 초기화 (비동기)
+ * @brief 규정 위반 몫을 점유 예산에서 더 뺌 (한 초 몫 이상 빚지지 않음)
  */
-static bool lora_init_p2p_rover_async(lora_init_callback_t callback)
+static void lora_reg_penalize(uint32_t air_us)
 {
-  // 초기화 컨텍스트 생성 (동적 할당)
-  lora_init_context_t *ctx = (lora_init_context_t *)pvPortMalloc(sizeof(lora_init_context_t));
-  if (!ctx)
+  int32_t floor_us = -(int32_t)(1000 * lora_airtime_permille());
+
+  taskENTER_CRITICAL();
+  lora_airtime_refill();
+  instance.airtime_us -= (int32_t)(air_us * LORA_REG_PENALTY_FRAGS);
+  if (instance.airtime_us < floor_us)
   {
-    LOG_ERR("Failed to allocate LoRa init context");
-    return false;
+    instance.airtime_us = floor_us;
   }
+  taskEXIT_CRITICAL();
+}
 
-  // 컨텍스트 초기화
-  ctx->current_step = 0;
-  ctx->retry_count = 0;
-  ctx->cmd_list = lora_p2p_rover_cmds;
-  ctx->cmd_count = LORA_P2P_ROVER_CMD_COUNT;
-  ctx->callback = callback;
-
-  LOG_INFO("Starting LoRa P2P ROVER init sequence (%d commands)", ctx->cmd_count);
+/**
+ * @brief 지난 1 분 칸을 비우며 최근 60 분 창을 밀기
+ */
+static void lora_reg_roll(TickType_t now)
+{
+  const TickType_t minute = pdMS_TO_TICKS(60000);
 
-  // 첫 번째 명령어 전송
-  // work_mode 명령어는 응답 파싱 건너뛰기
-  bool skip = (strstr(ctx->cmd_list[0], "work_mode") != NULL);
-  if (!lora_send_command_async(ctx->cmd_list[0], LORA_INIT_TIMEOUT_MS, 0,
-                               lora_init_command_callback, ctx, skip))
+  if (now - lora_reg.min_tick >= LORA_REG_BUCKETS * minute)
   {
-    LOG_ERR("Failed to start LoRa init sequence");
-    vPortFree(ctx);
-    return false;
+    memset(lora_reg.min_us, 0, sizeof(lora_reg.min_us));
+    lora_reg.hour_us = 0;
+    lora_reg.min_tick = now;
+    return;
   }
 
-  return true;
+  while (now - lora_reg.min_tick >= minute)
+  {
+    lora_reg.min_idx = (lora_reg.min_idx + 1) % LORA_REG_BUCKETS;
+    lora_reg.hour_us -= lora_reg.min_us[lora_reg.min_idx];
+    lora_reg.min_us[lora_reg.min_idx] = 0;
+    lora_reg.min_tick += minute;
+  }
 }
 
 /**
- * @brief RTCM3 CRC24Q 계산
- *
- * @param buffer 데이터 버퍼
- * @param len 데이터 길이 (CRC 제외)
- * @return 24-bit CRC 값
+ * @brief 요청이 무선으로 나가는 시간 (송신이 아닌 설정 명령은 0)
  */
-static uint32_t rtcm_crc24q(const uint8_t *buffer, size_t len)
+static uint32_t lora_reg_air_us(const lora_cmd_request_t *cmd_req)
 {
-  // CRC24Q polynomial: 0x1864CFB
-  uint32_t crc = 0;
-
-  for (size_t i = 0; i < len; i++)
+  if (cmd_req->raw_len > 0)
   {
-    crc ^= ((uint32_t)buffer[i]) << 16;
-
-    for (int j = 0; j < 8; j++)
-    {
-      crc <<= 1;
-      if (crc & 0x1000000)
-      {
-        crc ^= 0x1864CFB;
-      }
-    }
+    return lora_get_p2p_toa_us(cmd_req->raw_len);
   }
-
-  return crc & 0xFFFFFF;
+  if (strncmp(cmd_req->cmd, LORA_P2P_CMD_PREFIX, LORA_P2P_CMD_PREFIX_LEN) == 0)
+  {
+    return lora_get_p2p_toa_us(strcspn(cmd_req->cmd + LORA_P2P_CMD_PREFIX_LEN, "\r\n") / 2);
+  }
+  return 0;
 }
 
 /**
- * @brief RTCM 패킷 검증 (헤더 및 CRC)
+ * @brief 보내기 직전 연속 송신/시간당 한도 확인 (TX Task)
  *
- * @param buffer RTCM 패킷 버퍼
- * @param len 패킷 전체 길이
- * @return true: 유효, false: 무효
+ * @return false: 시간당 한도로 보내지 않음
  */
-static bool rtcm_validate_packet(const uint8_t *buffer, size_t len)
+static bool lora_reg_before_tx(uint32_t air_us)
 {
-  // 최소 길이 확인 (preamble 1 + reserved+len 2 + CRC 3 = 6 bytes)
-  if (len < 6)
-  {
-    LOG_ERR("RTCM packet too short: %d bytes", len);
-    return false;
-  }
+  TickType_t now = xTaskGetTickCount();
 
-  // Preamble 확인
-  if (buffer[0] != 0xD3)
+  lora_reg_roll(now);
+  if (air_us == 0)
   {
-    LOG_ERR("Invalid RTCM preamble: 0x%02X (expected 0xD3)", buffer[0]);
-    return false;
+    return true;
   }
 
-  // Length 파싱 (10 bits, bytes 1-2)
-  uint16_t payload_len = ((buffer[1] & 0x03) << 8) | buffer[2];
-  uint16_t expected_total_len = 3 + payload_len + 3; // header(3) + payload + CRC(3)
-
-  if (len != expected_total_len)
+  if ((int32_t)(now - lora_reg.last_end) >= (int32_t)pdMS_TO_TICKS(LORA_REG_PAUSE_MS))
   {
-    LOG_ERR("RTCM length mismatch: got %d, expected %d (payload=%d)",
-            len, expected_total_len, payload_len);
-    return false;
+    lora_reg.cont_us = 0;
   }
+  if (lora_reg.cont_us + air_us > LORA_REG_MAX_CONT_MS * 1000U)
+  {
+    TickType_t wait = lora_reg.last_end + pdMS_TO_TICKS(LORA_REG_PAUSE_MS) - now;
 
-  // CRC24Q 검증
-  uint32_t calculated_crc = rtcm_crc24q(buffer, len - 3);
-  uint32_t received_crc = ((uint32_t)buffer[len - 3] << 16) |
-                          ((uint32_t)buffer[len - 2] << 8) |
-                          buffer[len - 1];
+    LOG_DEBUG("LoRa continuous TX %lu us, pause", lora_reg.cont_us);
+    vTaskDelay(wait);
+    lora_reg.cont_us = 0;
+    lora_reg.st.guard_waits++;
+    lora_reg_penalize(air_us);
+  }
 
-  if (calculated_crc != received_crc)
+  if (LORA_REG_HOUR_LIMIT_MS > 0 &&
+      lora_reg.hour_us + air_us > LORA_REG_HOUR_LIMIT_MS * 1000U)
   {
-    LOG_ERR("RTCM CRC mismatch: calculated 0x%06X, received 0x%06X",
-            calculated_crc, received_crc);
+    lora_reg.st.hour_limited++;
+    lora_reg_penalize(air_us);
     return false;
   }
 
-  LOG_INFO("RTCM packet valid: len=%d, payload=%d, CRC=0x%06X",
-           len, payload_len, received_crc);
   return true;
 }
 
 /**
- * @brief AT 명령어 응답 파싱 (OK/ERROR 감지)
+ * @brief 보낸 송신을 장부에 올림 (TX Task)
  *
- * @param data 응답 데이터
- * @param len 데이터 길이
- * @return true: OK, false: ERROR or 미감지
+ * @param end 송신이 끝난 (끝날) tick
  */
-static bool lora_parse_at_response(const char *data, size_t len)
+static void lora_reg_after_tx(uint32_t air_us, TickType_t end)
 {
-  // OK 응답 감지 (다양한 형식 지원)
-  // - "OK\r\n", "OK\n" (일반 응답)
-  // - "Initialization OK" (work_mode 변경 시)
-  // - 대소문자 무시
-  if (strstr(data, "OK") != NULL || strstr(data, "ok") != NULL)
+  if (air_us == 0)
   {
-    return true;
+    return;
   }
 
-  // ERROR 응답 감지
-  if (strstr(data, "ERROR") != NULL || strstr(data, "error") != NULL)
+  lora_reg.cont_us += air_us;
+  lora_reg.last_end = end;
+  lora_reg.min_us[lora_reg.min_idx] += air_us;
+  lora_reg.hour_us += air_us;
+  lora_reg.toa_us += air_us;
+  lora_reg.st.tx++;
+  if (lora_reg.cont_us / 1000 > lora_reg.st.cont_max_ms)
   {
-    return false;
+    lora_reg.st.cont_max_ms = lora_reg.cont_us / 1000;
   }
-
-  return false;
 }
 
-/**
- * @brief RTCM fragment 재조립 버퍼 초기화
- */
-static void rtcm_reassembly_reset(rtcm_reassembly_t *reasm)
+void lora_reg_get_status(lora_reg_status_t *out)
 {
-  reasm->buffer_pos = 0;
-  reasm->expected_len = 0;
-  reasm->has_header = false;
-  reasm->last_recv_tick = 0;
+  taskENTER_CRITICAL();
+  *out = lora_reg.st;
+  out->toa_ms = (uint32_t)(lora_reg.toa_us / 1000);
+  out->hour_ms = lora_reg.hour_us / 1000;
+  taskEXIT_CRITICAL();
+  out->lbt = instance.lora.radio != NULL && instance.lora.radio->ops->rssi != NULL;
 }
 
 /**
- * @brief RTCM fragment 처리 및 재조립 (개선된 버전)
- *
- * - Preamble(0xD3) 자동 탐색
- * - 완료 후 남은 데이터 자동 보존
- *
- * @param reasm 재조립 버퍼
- * @param data 수신된 fragment 데이터
- * @param len fragment 길이
- * @return true: 완전한 RTCM 패킷 재조립 완료, false: 더 많은 fragment 필요
+ * @brief LoRa 초기화 완료 콜백
  */
-static bool rtcm_reassembly_process(rtcm_reassembly_t *reasm, const uint8_t *data, size_t len)
+static void lora_overall_init_complete(bool success, void *user_data)
 {
-  TickType_t current_tick = xTaskGetTickCount();
 
-  // 타임아웃 체크 (마지막 수신 후 5초 경과 시 초기화)
-  if (reasm->buffer_pos > 0 && reasm->last_recv_tick > 0)
+  const board_config_t *config = board_get_config();
+  if (config->lora_mode == LORA_MODE_BASE)
   {
-    TickType_t elapsed_ms = (current_tick - reasm->last_recv_tick) * 1000 / configTICK_RATE_HZ;
-    if (elapsed_ms > RTCM_REASSEMBLY_TIMEOUT_MS)
-    {
-      LOG_WARN("RTCM reassembly timeout - resetting buffer");
-      rtcm_reassembly_reset(reasm);
-    }
+    LOG_INFO("LoRa BASE init %s", success ? "succeeded" : "failed");
   }
-
-  // 버퍼 오버플로우 체크
-  if (reasm->buffer_pos + len > RTCM_REASSEMBLY_BUF_SIZE)
+  else if (config->lora_mode == LORA_MODE_ROVER)
   {
-    LOG_ERR("RTCM reassembly buffer overflow - resetting");
-    rtcm_reassembly_reset(reasm);
-    return false;
+    LOG_INFO("LoRa ROVER init %s", success ? "succeeded" : "failed");
   }
-
-  // Fragment 데이터 추가
-  memcpy(&reasm->buffer[reasm->buffer_pos], data, len);
-  reasm->buffer_pos += len;
-  reasm->last_recv_tick = current_tick;
-
-  LOG_INFO("RTCM fragment received: %d bytes, total: %d bytes", len, reasm->buffer_pos);
-
-  // 헤더가 없으면 Preamble 스캔
-  if (!reasm->has_header)
+  else if (config->lora_mode == LORA_MODE_REPEATER)
   {
-    // 0xD3(Preamble)를 찾을 때까지 스캔
-    size_t preamble_pos = 0;
-    bool found = false;
-
-    for (size_t i = 0; i < reasm->buffer_pos; i++)
-    {
-      if (reasm->buffer[i] == 0xD3)
-      {
-        preamble_pos = i;
-        found = true;
-        LOG_INFO("RTCM preamble found at offset %d", i);
-        break;
-      }
-    }
-
-    if (!found)
-    {
-      // Preamble을 못 찾으면 마지막 바이트만 남기고 버림
-      // (다음 fragment에서 0xD3가 올 수 있음)
-      if (reasm->buffer_pos > 1)
-      {
-        LOG_WARN("No preamble found, keeping last byte");
-        reasm->buffer[0] = reasm->buffer[reasm->buffer_pos - 1];
-        reasm->buffer_pos = 1;
-      }
-      return false;
-    }
-
-    // Preamble이 중간에 있으면 앞으로 이동
-    if (preamble_pos > 0)
-    {
-      LOG_INFO("Moving preamble from offset %d to start", preamble_pos);
-      memmove(reasm->buffer, &reasm->buffer[preamble_pos], reasm->buffer_pos - preamble_pos);
-      reasm->buffer_pos -= preamble_pos;
-    }
-
-    // 헤더 파싱 시도 (최소 3바이트 필요: preamble + reserved+len)
-    if (reasm->buffer_pos >= 3)
-    {
-      // Payload 길이 파싱 (10 bits)
-      uint16_t payload_len = ((reasm->buffer[1] & 0x03) << 8) | reasm->buffer[2];
-      reasm->expected_len = 3 + payload_len + 3; // header(3) + payload + CRC(3)
-      reasm->has_header = true;
+    LOG_INFO("LoRa REPEATER init %s", success ? "succeeded" : "failed");
+  }
 
-      LOG_INFO("RTCM header parsed: payload=%d bytes, expected total=%d bytes",
-               payload_len, reasm->expected_len);
+  if (success)
+  {
+    instance.init_complete = true;
+    LOG_INFO("LoRa init complete - now accepting P2P data");
 
-      // 예상 길이가 비정상적으로 크면 리셋
-      if (reasm->expected_len > RTCM_REASSEMBLY_BUF_SIZE)
-      {
-        LOG_ERR("Invalid RTCM length: %d > %d - resetting",
-                reasm->expected_len, RTCM_REASSEMBLY_BUF_SIZE);
-        rtcm_reassembly_reset(reasm);
-        return false;
-      }
-    }
+    led_set_color(3, LED_COLOR_GREEN);
+    led_set_state(3, true);
   }
-
-  // 완전한 패킷 수신 체크
-  if (reasm->has_header && reasm->buffer_pos >= reasm->expected_len)
+  else
   {
-    LOG_INFO("RTCM packet reassembly complete: %d bytes (buffer has %d bytes)",
-             reasm->expected_len, reasm->buffer_pos);
-    return true;
+    LOG_ERR("LoRa init failed");
+    led_set_color(3, LED_COLOR_RED);
+    led_set_state(3, true);
   }
-
-  // 더 많은 fragment 필요
-  return false;
 }
 
 /**
- * @brief AT+RECV 응답 파싱
- *
- * Format: at+recv=<RSSI>,<SNR>,<Data Length>:<Data>
- * Example: at+recv=-50,10,5:48656C6C6F
- *
- * @param data 응답 데이터
- * @param recv_data 출력 구조체
- * @return true: 파싱 성공, false: 파싱 실패
+ * @brief 모듈 UART 로 bytes 를 보내는 시간 (us, 1바이트 10비트)
  */
-static bool lora_parse_p2p_recv(const char *data, lora_p2p_recv_data_t *recv_data)
+static uint32_t lora_uart_us(size_t bytes)
+{
+  return (uint32_t)(((uint64_t)bytes * 10 * 1000000 + instance.baud - 1) / instance.baud);
+}
+
+static void lora_uart_set_baud(uint32_t baud)
 {
-  // "at+recv=" 또는 "AT+RECV=" 찾기
-  const char *start = strstr(data, "at+recv=");
-  if (!start)
+  if (instance.lora.ops->set_baudrate && instance.lora.ops->set_baudrate(baud) == 0)
   {
-    start = strstr(data, "AT+RECV=");
+    instance.baud = baud;
   }
-  if (!start)
+}
+
+static void lora_uart_fallback_done(bool success, void *user_data)
+{
+  if (success)
   {
-    return false;
+    LOG_WARN("LoRa UART %d bps not confirmed, staying at %d bps",
+             LORA_UART_BAUD_FAST, LORA_UART_BAUD_DEFAULT);
   }
-
-  start += 8; // "at+recv=" 건너뛰기
-
-  // RSSI 파싱
-  char *end = NULL;
-  recv_data->rssi = (int16_t)strtol(start, &end, 10);
-  if (!end || *end != ',')
+  else
   {
-    return false;
+    LOG_ERR("LoRa UART no response at either rate");
   }
+  lora_overall_init_complete(success, NULL);
+}
 
-  // SNR 파싱
-  start = end + 1;
-  recv_data->snr = (int16_t)strtol(start, &end, 10);
-  if (!end || *end != ',')
+static void lora_uart_probe_done(bool success, void *user_data)
+{
+  if (success)
   {
-    return false;
+    LOG_INFO("LoRa UART %d bps", LORA_UART_BAUD_FAST);
+    lora_overall_init_complete(true, NULL);
+    return;
   }
 
-  // Data Length 파싱
-  start = end + 1;
-  recv_data->data_len = (uint16_t)strtol(start, &end, 10);
-  if (!end || *end != ':')
+  // 모듈이 속도 변경을 모르거나 실패: 기본 속도로 돌아가서 확인
+  lora_uart_set_baud(LORA_UART_BAUD_DEFAULT);
+  vTaskDelay(pdMS_TO_TICKS(LORA_UART_SWITCH_MS));
+  if (!lora_send_command_async(LORA_UART_PROBE_CMD, LORA_AT_CMD_TIMEOUT_MS, 0,
+                               lora_uart_fallback_done, NULL, false))
   {
-    return false;
+    lora_overall_init_complete(false, NULL);
   }
+}
 
-  // Data 파싱 (HEX string)
-  start = end + 1;
+static void lora_uart_baud_cmd_done(bool success, void *user_data)
+{
+  // OK 가 바뀌기 전 속도로 오거나 깨질 수 있으므로 결과와 상관없이 확인
+  vTaskDelay(pdMS_TO_TICKS(LORA_UART_SWITCH_MS));
+  lora_uart_set_baud(LORA_UART_BAUD_FAST);
+  if (!lora_send_command_async(LORA_UART_PROBE_CMD, LORA_AT_CMD_TIMEOUT_MS, 0,
+                               lora_uart_probe_done, NULL, false))
+  {
+    lora_uart_probe_done(false, NULL);
+  }
+}
 
-  // 데이터 길이 확인
-  if (recv_data->data_len > sizeof(recv_data->data) - 1)
+/**
+ * @brief 초기화 명령이 끝난 뒤 모듈 UART 속도 올리기 (TX Task 콜백 체인)
+ *
+ * 설정 명령 -> 호스트 속도 변경 -> at+version 확인. 확인이 안 되면 기본
+ * 속도로 돌아가 다시 확인한다. 이미 빠른 속도로 붙었으면 (모듈 재시작 없이
+ * MCU 만 재부팅) 건너뛴다. fragment 하나의 UART 시간이 ToA 의 큰 몫이라서
+ * 이 시간만큼 송신 간격이 줄어든다.
+ */
+static void lora_uart_upgrade(bool success, void *user_data)
+{
+  if (!success || instance.baud == LORA_UART_BAUD_FAST || !instance.lora.ops->set_baudrate)
   {
-    LOG_ERR("P2P recv data too long: %d bytes", recv_data->data_len);
-    return false;
+    lora_overall_init_complete(success, user_data);
+    return;
   }
 
-  // HEX string을 바이너리로 변환
-  for (uint16_t i = 0; i < recv_data->data_len; i++)
+  if (!lora_send_command_async(LORA_UART_BAUD_CMD, LORA_AT_CMD_TIMEOUT_MS, 0,
+                               lora_uart_baud_cmd_done, NULL, false))
   {
-    char hex[3] = {start[i * 2], start[i * 2 + 1], '\0'};
-    recv_data->data[i] = (char)strtol(hex, NULL, 16);
+    lora_overall_init_complete(true, user_data);
   }
-  recv_data->data[recv_data->data_len] = '\0';
+}
 
-  LOG_INFO("P2P recv: RSSI=%d, SNR=%d, Len=%d",
-           recv_data->rssi, recv_data->snr, recv_data->data_len);
+static void lora_init_seq_cb(bool success, void *user_data)
+{
+  init_seq_result((init_seq_t *)user_data, success, NULL);
+}
 
-  return true;
+static bool lora_init_seq_send(init_seq_t *seq, const init_seq_step_t *step)
+{
+  return lora_send_command_async(step->cmd, step->timeout_ms, 0, lora_init_seq_cb, seq,
+                                 step->expect == NULL);
 }
 
-/**
- * @brief LoRa TX Task (명령어 송신 및 응답 대기)
- */
-static void lora_tx_task(void *pvParameter)
+static void lora_init_seq_retry(init_seq_t *seq, const init_seq_step_t *step)
 {
-  lora_cmd_request_t cmd_req;
+  // 모듈이 지난번에 올린 속도에 남아 있을 수 있으므로 재시도마다 번갈아 씀
+  lora_uart_set_baud(instance.baud == LORA_UART_BAUD_DEFAULT ? LORA_UART_BAUD_FAST
+                                                             : LORA_UART_BAUD_DEFAULT);
+}
 
-  LOG_INFO("LoRa TX Task started");
+static void lora_init_seq_done(init_seq_t *seq, bool ok)
+{
+  lora_uart_upgrade(ok, NULL);
+}
 
-  // TX Task 준비 완료 플래그 설정
-  instance.tx_task_ready = true;
-  LOG_INFO("LoRa TX Task ready");
+static const init_seq_ops_t lora_init_seq_ops = {
+    .send = lora_init_seq_send,
+    .retry = lora_init_seq_retry,
+    .done = lora_init_seq_done,
+};
 
-  const board_config_t *config = board_get_config();
+/* 명령은 TX Task 콜백에서 이어지므로 한 번에 하나 */
+static init_seq_t lora_init_seq = INIT_SEQ_INIT("LoRa init", &lora_init_seq_ops, NULL);
+
+/**
+ * @brief LoRa P2P 초기화 (비동기, 끝나면 lora_uart_upgrade)
+ */
+static void lora_init_p2p_async(const init_seq_step_t *steps, uint8_t count)
+{
+  if (!init_seq_start(&lora_init_seq, steps, count, 0))
+  {
+    lora_uart_upgrade(false, NULL);
+  }
+}
+
+/**
+ * @brief 모듈에서 온 한 줄의 종류
+ */
+typedef enum
+{
+  LORA_LINE_OTHER = 0,
+  LORA_LINE_OK,
+  LORA_LINE_ERROR,
+  LORA_LINE_RECV,   // at+recv=...
+} lora_line_type_t;
+
+/**
+ * @brief 완성된 한 줄을 접두어로 한 번만 분류
+ *
+ * - "at+recv=", "AT+RECV=": P2P 수신
+ * - "OK", "ok" 로 시작 (일반 응답), "ERROR", "error" 로 시작
+ * - 그 밖에 OK 가 들어 있는 줄 ("Initialization OK", work_mode 변경 시)
+ *
+ * @param line '\0' 으로 끝나는 한 줄 (CR/LF 제외)
+ * @param len 줄 길이
+ * @return lora_line_type_t
+ */
+static lora_line_type_t lora_classify_line(const char *line, size_t len)
+{
+  if (len >= LORA_RECV_PREFIX_LEN &&
+      (strncmp(line, "at+recv=", LORA_RECV_PREFIX_LEN) == 0 ||
+       strncmp(line, "AT+RECV=", LORA_RECV_PREFIX_LEN) == 0))
+  {
+    return LORA_LINE_RECV;
+  }
+
+  if (strncmp(line, "OK", 2) == 0 || strncmp(line, "ok", 2) == 0)
+  {
+    return LORA_LINE_OK;
+  }
+
+  if (strncmp(line, "ERROR", 5) == 0 || strncmp(line, "error", 5) == 0)
+  {
+    return LORA_LINE_ERROR;
+  }
+
+  if (strstr(line, "OK") != NULL)
+  {
+    return LORA_LINE_OK;
+  }
+
+  return LORA_LINE_OTHER;
+}
+
+/**
+ * @brief 직전 송신의 ToA 가 끝날 때까지 대기 (TX Task)
+ *
+ * 모듈은 at+send 에 OK 만 주고 송신 완료는 알려 주지 않으므로
+ * 변조 설정으로 계산한 ToA + LORA_TX_GUARD_MS 까지 기다린다.
+ * tx_overlap 이면 다음 명령의 UART 시간만큼 일찍 깨서 명령 마지막
+ * 바이트가 송신 끝에 맞춰 도착하게 한다.
+ *
+ * @param lead_us 다음 명령 UART 시간
+ * @return true: 직전 송신이 끝나기 전에 보냄
+ */
+static bool lora_tx_wait_idle(uint32_t lead_us)
+{
+  if (!instance.tx_busy)
+  {
+    return false;
+  }
+
+  TickType_t lead = instance.tx_overlap ? pdMS_TO_TICKS(lead_us / 1000) : 0;
+  TickType_t remaining = instance.tx_busy_until - lead - xTaskGetTickCount();
+  if ((int32_t)remaining > 0)
+  {
+    vTaskDelay(remaining);
+  }
+  instance.tx_busy = false;
+  return lead > 0;
+}
+
+/**
+ * @brief 무선 송신을 자기 TDMA slot 안으로 미룸 (TX Task, 베이스)
+ *
+ * GNSS 초 (itow % LORA_TDMA_FRAME_MS) 를 slots 등분해 slot 번째 구간에서
+ * 명령 UART + ToA 가 slot 끝 LORA_TDMA_GUARD_MS 전까지 끝날 때만 보낸다.
+ * 현재 GNSS 시간은 마지막 HPPOSLLH/BESTNAV 의 itow 에 게시 후 경과를
+ * 더해 추정한다. itow 가 없거나 오래되면 slot 없이 보낸다.
+ */
+static void lora_tdma_wait(const lora_cmd_request_t *cmd_req)
+{
+  const board_config_t *config = board_get_config();
+  gps_nav_data_t nav;
+
+  if (lora_tdma.slots == 0 || config->lora_mode != LORA_MODE_BASE ||
+      (cmd_req->raw_len == 0 &&
+       strncmp(cmd_req->cmd, LORA_P2P_CMD_PREFIX, LORA_P2P_CMD_PREFIX_LEN) != 0))
+  {
+    return;
+  }
+
+  TickType_t now = xTaskGetTickCount();
+  if (!gps_get_nav(GPS_ID_BASE, &nav) || nav.itow_tick == 0 ||
+      now - nav.itow_tick > pdMS_TO_TICKS(LORA_TDMA_TIME_MAX_AGE_MS))
+  {
+    if (!lora_tdma.untimed)
+    {
+      LOG_WARN("LoRa TDMA: no GNSS time, sending without slot");
+      lora_tdma.untimed = true;
+    }
+    return;
+  }
+  if (lora_tdma.untimed)
+  {
+    LOG_INFO("LoRa TDMA: GNSS time acquired, slot %d/%d", lora_tdma.slot, lora_tdma.slots);
+    lora_tdma.untimed = false;
+  }
+
+  uint32_t width = LORA_TDMA_FRAME_MS / lora_tdma.slots;
+  uint32_t start = lora_tdma.slot * width;
+  uint32_t usable = width - LORA_TDMA_GUARD_MS;
+  uint32_t ms = (nav.itow + (now - nav.itow_tick) * portTICK_PERIOD_MS) % LORA_TDMA_FRAME_MS;
+
+  // slot 보다 긴 송신은 slot 시작에서만 보냄
+  uint32_t latest = start + (cmd_req->toa_ms < usable ? usable - cmd_req->toa_ms : 0);
+  if (ms >= start && ms <= latest)
+  {
+    return;
+  }
+
+  uint32_t delay_ms = (start + LORA_TDMA_FRAME_MS - ms) % LORA_TDMA_FRAME_MS;
+  vTaskDelay(pdMS_TO_TICKS(delay_ms));
+}
+
+/**
+ * @brief 무선칩 이벤트 (RX Task 의 ops->irq 안, mutex 잡은 채)
+ *
+ * 송신 완료와 CAD 결과는 TX Task 에 알리고, 수신 패킷은 복사만 해 두고
+ * mutex 를 놓은 뒤 RX Task 가 처리한다 (처리 중에 명령을 큐에 넣으므로).
+ */
+static lora_p2p_recv_data_t lora_radio_rx;
+static bool lora_radio_rx_ready;
+
+static void lora_radio_event(void *user, lora_radio_evt_t evt, const lora_radio_pkt_t *pkt)
+{
+  switch (evt)
+  {
+  case LORA_RADIO_EVT_RX_DONE:
+    memcpy(lora_radio_rx.data, pkt->data, pkt->len);
+    lora_radio_rx.data_len = pkt->len;
+    lora_radio_rx.rssi = pkt->rssi;
+    lora_radio_rx.snr = pkt->snr;
+    lora_radio_rx_ready = true;
+    break;
+
+  case LORA_RADIO_EVT_RX_ERROR:
+    LOG_DEBUG("LoRa radio RX CRC/header error");
+    break;
+
+  default:
+    instance.radio_evt = evt;
+    xTaskNotifyGive(instance.tx_task);
+    break;
+  }
+}
+
+/**
+ * @brief 무선칩 상태 전환 (mutex 안에서, SPI 는 TX/RX Task 가 같이 씀)
+ *
+ * @param op lora_radio_ops_t 의 인자 없는 op (cad, receive, standby)
+ */
+static int lora_radio_call(int (*op)(lora_radio_t *r))
+{
+  xSemaphoreTake(instance.mutex, portMAX_DELAY);
+  int rc = op(instance.lora.radio);
+  xSemaphoreGive(instance.mutex);
+  return rc;
+}
+
+/**
+ * @brief 수신 상태로 LORA_REG_LBT_SENSE_MS 동안 듣고 순간 RSSI 로 에너지 확인
+ *
+ * CAD 는 LoRa preamble 만 알아서 같은 대역의 다른 변조는 이것으로 본다.
+ * RSSI 를 못 읽는 칩은 CAD 만.
+ */
+static bool lora_radio_energy_busy(lora_radio_t *r)
+{
+  int16_t dbm;
+  int rc;
+
+  if (!r->ops->rssi)
+  {
+    return false;
+  }
+  if (!r->rx_cont)
+  {
+    lora_radio_call(r->ops->receive);
+  }
+  vTaskDelay(pdMS_TO_TICKS(LORA_REG_LBT_SENSE_MS));
+
+  xSemaphoreTake(instance.mutex, portMAX_DELAY);
+  rc = r->ops->rssi(r, &dbm);
+  xSemaphoreGive(instance.mutex);
+
+  return rc == 0 && dbm > LORA_REG_LBT_RSSI_DBM;
+}
+
+/**
+ * @brief LBT 로 채널 듣고 바이너리 송신, TX_DONE 까지 대기 (TX Task)
+ *
+ * 모듈과 달리 송신 완료를 인터럽트로 알 수 있어 ToA 를 계산해 기다리지
+ * 않는다. 수신 모드였으면 끝난 뒤 다시 연속 수신.
+ */
+static bool lora_radio_tx(const uint8_t *data, size_t len, uint32_t timeout_ms)
+{
+  lora_radio_t *r = instance.lora.radio;
+  uint32_t air_us = lora_get_p2p_toa_us(len);
+  bool busy = false;
+
+  if (!lora_reg_before_tx(air_us))
+  {
+    return false;
+  }
+
+  for (uint8_t i = 0; i < LORA_RADIO_CAD_RETRY; i++)
+  {
+    busy = lora_radio_energy_busy(r);
+    if (!busy)
+    {
+      ulTaskNotifyTake(pdTRUE, 0);
+      busy = lora_radio_call(r->ops->cad) == 0 &&
+             ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(LORA_RADIO_CAD_TIMEOUT_MS)) != 0 &&
+             instance.radio_evt == LORA_RADIO_EVT_CAD_BUSY;
+    }
+    if (!busy)
+    {
+      break;
+    }
+    lora_reg.st.lbt_busy++;
+    LOG_DEBUG("LoRa channel busy, backoff %d", i + 1);
+    vTaskDelay(pdMS_TO_TICKS(LORA_RADIO_CAD_BACKOFF_MS * (i + 1)));
+  }
+
+  if (busy)
+  {
+    LOG_WARN("LoRa channel busy, TX skipped (LBT)");
+    lora_reg.st.lbt_fail++;
+    lora_reg_penalize(air_us);
+    lora_radio_call(instance.radio_rx ? r->ops->receive : r->ops->standby);
+    return false;
+  }
+
+  ulTaskNotifyTake(pdTRUE, 0);
+  xSemaphoreTake(instance.mutex, portMAX_DELAY);
+  int rc = r->ops->send(r, data, len);
+  xSemaphoreGive(instance.mutex);
+
+  bool ok = rc == 0 && ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(timeout_ms)) != 0 &&
+            instance.radio_evt == LORA_RADIO_EVT_TX_DONE;
+  if (ok)
+  {
+    lora_reg_after_tx(air_us, xTaskGetTickCount());
+  }
+  else
+  {
+    LOG_WARN("LoRa radio TX timeout");
+    pm_trace(PM_EVT_LORA_TMO, 1, rc);
+    lora_radio_call(r->ops->standby);
+  }
+
+  if (instance.radio_rx)
+  {
+    lora_radio_call(r->ops->receive);
+  }
+  return ok;
+}
+
+/**
+ * @brief AT 명령 요청을 무선칩 동작으로 바꿔 실행 (TX Task)
+ *
+ * 초기화/링크 적응/중계는 RAK 모듈용 AT 문자열을 그대로 큐에 넣으므로
+ * 여기서 같은 뜻으로 바꾼다. lorap2p 설정, transfer_mode (1: 연속 수신,
+ * 2: 대기), HEX 송신 말고는 (work_mode, UART, version) 할 일이 없어 성공.
+ */
+static bool lora_radio_exec(const lora_cmd_request_t *cmd_req)
+{
+  const char *cmd = cmd_req->cmd;
+  lora_radio_t *r = instance.lora.radio;
+
+  if (!instance.radio_ready)
+  {
+    return false;
+  }
+
+  if (cmd_req->raw_len > 0)
+  {
+    return lora_radio_tx((const uint8_t *)cmd, cmd_req->raw_len, cmd_req->timeout_ms);
+  }
+
+  if (strncmp(cmd, LORA_P2P_CMD_PREFIX, LORA_P2P_CMD_PREFIX_LEN) == 0)
+  {
+    uint8_t buf[LORA_P2P_MAX_RAW];
+    const char *p = cmd + LORA_P2P_CMD_PREFIX_LEN;
+    size_t len = strlen(p) / 2;
+
+    // HEX 뒤 CR 에서 멈춤
+    len = simd_hex_decode(buf, p, len < sizeof(buf) ? len : sizeof(buf));
+
+    return len > 0 && lora_radio_tx(buf, len, cmd_req->timeout_ms);
+  }
+
+  if (strncmp(cmd, LORA_AT_P2P_MODE, sizeof(LORA_AT_P2P_MODE) - 1) == 0)
+  {
+    instance.radio_rx = cmd[sizeof(LORA_AT_P2P_MODE) - 1] == '1';
+    return lora_radio_call(instance.radio_rx ? r->ops->receive : r->ops->standby) == 0;
+  }
+
+  if (strncmp(cmd, LORA_AT_P2P_CONFIG, sizeof(LORA_AT_P2P_CONFIG) - 1) == 0)
+  {
+    const char *p = cmd + sizeof(LORA_AT_P2P_CONFIG) - 1;
+    lora_modem_params_t mp;
+
+    uint32_t freq = parse_uint32(&p);
+    p++;
+    mp.sf = (uint8_t)parse_uint32(&p);
+    p++;
+    mp.bw = (uint8_t)parse_uint32(&p);
+    p++;
+    mp.cr = (uint8_t)parse_uint32(&p);
+    p++;
+    mp.preamble = (uint16_t)parse_uint32(&p);
+    p++;
+    int8_t pwr = (int8_t)parse_uint32(&p);
+
+    xSemaphoreTake(instance.mutex, portMAX_DELAY);
+    int rc = r->ops->config(r, freq, &mp, pwr);
+    xSemaphoreGive(instance.mutex);
+    if (rc != 0)
+    {
+      return false;
+    }
+    return !instance.radio_rx || lora_radio_call(r->ops->receive) == 0;
+  }
+
+  return true;
+}
+
+/**
+ * @brief 무선칩으로 요청 하나 처리하고 완료 알림 (TX Task)
+ */
+static void lora_radio_run(lora_cmd_request_t *cmd_req)
+{
+  TRACE_MARK_START(TRACE_MARK_LORA_TX);
+  flash_params_hold();
+  lora_tdma_wait(cmd_req);
+  bool ok = lora_radio_exec(cmd_req);
+  TRACE_MARK_STOP(TRACE_MARK_LORA_TX);
+  flash_params_release();
+
+  if (cmd_req->is_async)
+  {
+    cmd_req->async_result = ok;
+    if (cmd_req->callback)
+    {
+      cmd_req->callback(ok, cmd_req->user_data);
+    }
+    lora_cmd_free(cmd_req);
+  }
+  else
+  {
+    *(cmd_req->result) = ok;
+    xSemaphoreGive(cmd_req->response_sem);
+  }
+}
+
+/**
+ * @brief LoRa TX Task (명령어 송신 및 응답 대기)
+ *
+ * OK 를 받으면 바로 완료 콜백을 부르고 다음 요청을 꺼낸다.
+ * ToA 대기는 다음 명령을 보내기 직전에만 하므로 그 사이 생산자는
+ * 다음 fragment 를 만들어 큐에 넣을 수 있다.
+ */
+static void lora_tx_task(void *pvParameter)
+{
+  lora_cmd_request_t *cmd_req;
+
+  LOG_INFO("LoRa TX Task started");
+
+  // TX Task 준비 완료 플래그 설정
+  instance.tx_task_ready = true;
+  LOG_INFO("LoRa TX Task ready");
+
+  const board_config_t *config = board_get_config();
+
+  while (1)
+  {
+    TickType_t wait = lora_link_poll();
+    TickType_t relay_wait = lora_relay_poll();
+
+    if (relay_wait < wait)
+    {
+      wait = relay_wait;
+    }
+
+    if (xQueueReceive(instance.cmd_queue, &cmd_req, wait) == pdTRUE)
+    {
+      // 빈 요청은 링크 적응/중계 상태 확인만
+      if (cmd_req == NULL)
+      {
+        continue;
+      }
 
-  while (1)
-  {
-    if (xQueueReceive(instance.cmd_queue, &cmd_req, portMAX_DELAY) == pdTRUE)
-    {
       if(config->lora_mode == LORA_MODE_BASE && instance.init_complete)
       {
         led_set_toggle(3);
       }
-      LOG_INFO("LoRa sending command: %s", cmd_req.cmd);
+
+      if (instance.lora.radio)
+      {
+        lora_radio_run(cmd_req);
+        continue;
+      }
+      LOG_INFO("LoRa sending command: %s", cmd_req->cmd);
+
+      // 이전 명령의 늦은 응답 notification 제거
+      ulTaskNotifyTake(pdTRUE, 0);
 
       // 현재 명령어 요청 저장 (RX Task에서 응답 처리용)
-      instance.current_cmd_req = &cmd_req;
-      if (cmd_req.is_async)
+      instance.current_cmd_req = cmd_req;
+      if (cmd_req->is_async)
       {
-        cmd_req.async_result = false;
+        cmd_req->async_result = false;
       }
       else
       {
-        *(cmd_req.result) = false;
+        *(cmd_req->result) = false;
       }
 
+      // 직전 송신이 아직 무선에 있으면 끝날 때까지 대기 (UART 시간만큼은 겹침)
+      size_t cmd_len = strlen(cmd_req->cmd);
+      bool overlapped = lora_tx_wait_idle(lora_uart_us(cmd_len));
+      lora_tdma_wait(cmd_req);
+      uint32_t air_us = lora_reg_air_us(cmd_req);
+      bool allowed = lora_reg_before_tx(air_us);
+
       // 시작 시간 기록 (ToA 계산용)
       TickType_t start_tick = xTaskGetTickCount();
+      TRACE_MARK_START(TRACE_MARK_LORA_TX);
+      flash_params_hold(); // 송신 ~ 응답 사이에 flash 쓰기로 멈추지 않게
 
       // 명령어 전송 (UART 충돌 방지를 위해 mutex 사용)
-      if (instance.lora.ops && instance.lora.ops->send)
+      if (allowed && instance.lora.ops && instance.lora.ops->send)
       {
         xSemaphoreTake(instance.mutex, portMAX_DELAY);
-        instance.lora.ops->send(cmd_req.cmd, strlen(cmd_req.cmd));
+        instance.lora.ops->send(cmd_req->cmd, cmd_len);
         xSemaphoreGive(instance.mutex);
       }
       else
       {
-        LOG_ERR("LoRa send ops not available");
+        if (allowed)
+        {
+          LOG_ERR("LoRa send ops not available");
+        }
+        else
+        {
+          LOG_WARN("LoRa TX skipped (hourly airtime limit)");
+        }
         instance.current_cmd_req = NULL;
-        if (cmd_req.is_async)
+        if (cmd_req->is_async)
         {
-          cmd_req.async_result = false;
-          if (cmd_req.callback)
+          cmd_req->async_result = false;
+          if (cmd_req->callback)
           {
-            cmd_req.callback(false, cmd_req.user_data);
+            cmd_req->callback(false, cmd_req->user_data);
           }
-          vSemaphoreDelete(cmd_req.response_sem);
+          lora_cmd_free(cmd_req);
         }
         else
         {
-          *(cmd_req.result) = false;
-          xSemaphoreGive(cmd_req.response_sem);
+          *(cmd_req->result) = false;
+          xSemaphoreGive(cmd_req->response_sem);
         }
+        TRACE_MARK_STOP(TRACE_MARK_LORA_TX);
+        flash_params_release();
         continue;
       }
 
       // skip_response이면 응답 파싱 건너뛰고 delay 후 성공 처리
-      if (cmd_req.skip_response)
+      if (cmd_req->skip_response)
       {
-        LOG_INFO("Skipping response check, waiting %d ms", cmd_req.timeout_ms);
-        vTaskDelay(pdMS_TO_TICKS(cmd_req.timeout_ms));
+        LOG_INFO("Skipping response check, waiting %d ms", cmd_req->timeout_ms);
+        vTaskDelay(pdMS_TO_TICKS(cmd_req->timeout_ms));
 
         // 성공으로 처리
-        if (cmd_req.is_async)
+        if (cmd_req->is_async)
         {
-          cmd_req.async_result = true;
+          cmd_req->async_result = true;
         }
         else
         {
-          *(cmd_req.result) = true;
+          *(cmd_req->result) = true;
         }
       }
       else
       {
         // 응답 대기 (타임아웃 적용)
-        if (xSemaphoreTake(cmd_req.response_sem, pdMS_TO_TICKS(cmd_req.timeout_ms)) == pdTRUE)
+        if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(cmd_req->timeout_ms)) != 0)
         {
-          // 응답 수신 완료 (RX Task가 세마포어를 줌)
-          if (cmd_req.is_async)
+          // 응답 수신 완료 (RX Task가 notification 을 줌)
+          if (cmd_req->is_async)
           {
             LOG_INFO("LoRa response received: %s",
-                     cmd_req.async_result ? "OK" : "ERROR");
+                     cmd_req->async_result ? "OK" : "ERROR");
           }
           else
           {
             LOG_INFO("LoRa response received: %s",
-                     *(cmd_req.result) ? "OK" : "ERROR");
+                     *(cmd_req->result) ? "OK" : "ERROR");
           }
 
-          // ToA 대기: AT 명령어 전송 시작 시점부터 ToA 경과 보장
-          if (cmd_req.toa_ms > 0)
+          // ToA: AT 명령어 전송 시작 시점부터 ToA 경과 보장 (다음 명령 전에 대기)
+          if (cmd_req->toa_ms > 0)
           {
-            TickType_t elapsed_tick = xTaskGetTickCount() - start_tick;
-            uint32_t elapsed_ms = elapsed_tick * 1000 / configTICK_RATE_HZ;
-
-            if (elapsed_ms < cmd_req.toa_ms)
-            {
-              uint32_t remaining_ms = cmd_req.toa_ms - elapsed_ms;
-              LOG_INFO("Waiting remaining ToA %dms (elapsed=%dms, total=%dms)",
-                       remaining_ms, elapsed_ms, cmd_req.toa_ms);
-              vTaskDelay(pdMS_TO_TICKS(remaining_ms));
-            }
-            else
-            {
-              LOG_INFO("ToA already satisfied: elapsed=%dms >= ToA=%dms",
-                       elapsed_ms, cmd_req.toa_ms);
-            }
+            instance.tx_busy_until =
+                start_tick + pdMS_TO_TICKS(cmd_req->toa_ms + LORA_TX_GUARD_MS);
+            instance.tx_busy = true;
           }
+          lora_reg_after_tx(air_us, start_tick + pdMS_TO_TICKS(cmd_req->toa_ms));
         }
         else
         {
           // 타임아웃
           LOG_WARN("LoRa command timeout");
-          if (cmd_req.is_async)
+          pm_trace(PM_EVT_LORA_TMO, 0, 0);
+          if (cmd_req->is_async)
           {
-            cmd_req.async_result = false;
+            cmd_req->async_result = false;
           }
           else
           {
-            *(cmd_req.result) = false;
+            *(cmd_req->result) = false;
           }
         }
       }
 
+      // 송신 중에 받은 명령을 모듈이 흘리면 겹쳐 보내기를 끔
+      bool ok = cmd_req->is_async ? cmd_req->async_result : *(cmd_req->result);
+      if (overlapped && !ok)
+      {
+        LOG_WARN("LoRa command failed while previous TX on air, overlap disabled");
+        instance.tx_overlap = false;
+      }
+
+      TRACE_MARK_STOP(TRACE_MARK_LORA_TX);
+      flash_params_release();
+
       // 현재 명령어 요청 초기화
       instance.current_cmd_req = NULL;
 
       // 비동기: 콜백 호출
-      if (cmd_req.is_async)
+      if (cmd_req->is_async)
       {
-        if (cmd_req.callback)
+        if (cmd_req->callback)
         {
-          cmd_req.callback(cmd_req.async_result, cmd_req.user_data);
+          cmd_req->callback(cmd_req->async_result, cmd_req->user_data);
         }
 
-        // 비동기는 세마포어를 TX Task에서 삭제
-        vSemaphoreDelete(cmd_req.response_sem);
+        // 비동기는 슬롯을 TX Task에서 반납
+        lora_cmd_free(cmd_req);
       }
       else
       {
         // 동기: 외부 호출자에게 처리 완료 알림 (세마포어 반환)
-        xSemaphoreGive(cmd_req.response_sem);
+        xSemaphoreGive(cmd_req->response_sem);
       }
     }
   }
@@ -732,620 +1251,1486 @@ static void lora_tx_task(void *pvParameter)
 }
 
 /**
- * @brief LoRa RX Task (수신 데이터 처리)
+ * @brief 응답 줄로 현재 명령어 완료 (TX Task 로 알림)
  */
-static void lora_process_task(void *pvParameter)
+static void lora_complete_cmd(bool result)
 {
-  size_t pos = 0;
-  size_t old_pos = 0;
-  uint8_t dummy = 0;
+  lora_cmd_request_t *cmd_req = instance.current_cmd_req;
 
-  __attribute__((section(".ccmram"))) static char temp_buf[1024];
-  LOG_INFO("LoRa RX Task started");
+  if (cmd_req == NULL)
+  {
+    LOG_WARN("current_cmd_req is NULL, skipping response handling");
+    return;
+  }
 
-  // RX Task 준비 완료 플래그 설정
-  instance.rx_task_ready = true;
-  LOG_INFO("LoRa RX Task ready");
+  LOG_INFO("Parse result: %s", result ? "OK" : "ERROR");
 
-  // TX/RX Task 모두 준비될 때까지 대기
-  while (!instance.tx_task_ready || !instance.rx_task_ready)
+  if (cmd_req->is_async)
   {
-    vTaskDelay(pdMS_TO_TICKS(10));
+    cmd_req->async_result = result;
+  }
+  else
+  {
+    *(cmd_req->result) = result;
   }
 
-  LOG_INFO("Both TX and RX tasks ready, starting LoRa initialization");
-
-  const board_config_t *config = board_get_config();
+  xTaskNotifyGive(instance.tx_task);
+}
 
-  if (config->lora_mode == LORA_MODE_BASE)
+/**
+ * @brief P2P 수신 payload 처리 (모듈 at+recv= 줄, 무선칩 RxDone 공통)
+ *
+ * 초기화 완료 후에만 처리 (초기화 중 데이터는 무시)
+ */
+static void lora_handle_recv_data(lora_p2p_recv_data_t *recv_data, lora_mode_t mode)
+{
+  if (!instance.init_complete)
   {
-    lora_init_p2p_base_async(lora_overall_init_complete);
+    LOG_WARN("Ignoring P2P data during initialization");
+    return;
   }
-  else if (config->lora_mode == LORA_MODE_ROVER)
+
+  if (mode == LORA_MODE_ROVER || mode == LORA_MODE_REPEATER)
   {
-    lora_init_p2p_rover_async(lora_overall_init_complete);
-    led_set_color(3, LED_COLOR_GREEN);
-    led_set_state(3, true);
+    led_set_toggle(3);
   }
 
-  while (1)
+  // 링크 적응 제어 frame 은 RTCM 으로 넘기지 않음
+  if (lora_link_on_recv(recv_data))
   {
-    xQueueReceive(instance.queue, &dummy, portMAX_DELAY);
+    return;
+  }
 
-    pos = lora_port_get_rx_pos();
-    char *lora_recv = lora_port_get_recv_buf();
+  if (recv_data->data_len >= RTCM_FRAG_HDR_SIZE)
+  {
+    // 베이스 원본과 중계 사본이 모두 들릴 수 있음
+    if (lora_relay_is_dup((const uint8_t *)recv_data->data))
+    {
+      return;
+    }
+    lora_stats_rx_frag(recv_data->rssi, recv_data->snr, (const uint8_t *)recv_data->data);
 
-    if (pos != old_pos)
+    if (mode == LORA_MODE_REPEATER)
     {
-      size_t len = 0;
+      lora_relay_on_frag((const uint8_t *)recv_data->data, recv_data->data_len);
+      return;
+    }
+  }
 
-      if (pos > old_pos)
-      {
-        len = pos - old_pos;
+  // 콜백이 등록되어 있으면 콜백 호출
+  if (instance.p2p_recv_callback)
+  {
+    instance.p2p_recv_callback(recv_data, instance.p2p_recv_user_data);
+  }
+  else
+  {
+    // 콜백이 없으면 RTCM fragment 재조립 및 GPS로 전송
+    LOG_INFO("P2P data received: %d bytes, RSSI=%d, SNR=%d",
+             recv_data->data_len, recv_data->rssi, recv_data->snr);
 
-        // 데이터 처리
-        memcpy(temp_buf, &lora_recv[old_pos], len);
-        temp_buf[len] = '\0';
+    // RTCM fragment 재조립 후 완성된 패킷 GPS로 전송
+    rtcm_reassembly_deliver(&instance.rtcm_reassembly,
+                            (uint8_t *)recv_data->data,
+                            recv_data->data_len);
+  }
+}
 
-        // AT 명령어 응답 처리
-        if (instance.current_cmd_req != NULL)
-        {
-          bool result = lora_parse_at_response(temp_buf, len);
-          LOG_INFO("Parse result: %s", result ? "OK" : "ERROR/NONE");
+/**
+ * @brief P2P 수신 줄 처리 (at+recv=...)
+ */
+static void lora_handle_recv_line(const char *line, lora_mode_t mode)
+{
+  lora_p2p_recv_data_t recv_data;
 
-          if (strstr(temp_buf, "OK") || strstr(temp_buf, "ERROR"))
-          {
-            // 응답 결과 저장
-            if (instance.current_cmd_req->is_async)
-            {
-              instance.current_cmd_req->async_result = result;
-            }
-            else
-            {
-              *(instance.current_cmd_req->result) = result;
-            }
-
-            // 세마포어 해제 (TX Task로 응답 완료 알림)
-            xSemaphoreGive(instance.current_cmd_req->response_sem);
-          }
-          else
-          {
-            LOG_WARN("No OK/ERROR in response");
-          }
-        }
-        else
-        {
-          LOG_WARN("current_cmd_req is NULL, skipping response handling");
-        }
+  if (!lora_parse_p2p_recv(line, &recv_data))
+  {
+    return;
+  }
 
-        // P2P 수신 데이터 처리 (at+recv=...)
-        // 초기화 완료 후에만 처리 (초기화 중 데이터는 무시)
+  lora_handle_recv_data(&recv_data, mode);
+}
 
-        if ((strstr(temp_buf, "at+recv=") || strstr(temp_buf, "AT+RECV=")) && instance.init_complete)
-        {
-          if(config->lora_mode == LORA_MODE_ROVER)
-          {
-            led_set_toggle(3);
-          }
+/**
+ * @brief 완성된 한 줄 처리
+ */
+static void lora_handle_line(const char *line, size_t len, lora_mode_t mode)
+{
+  switch (lora_classify_line(line, len))
+  {
+  case LORA_LINE_OK:
+    lora_complete_cmd(true);
+    break;
 
-          lora_p2p_recv_data_t recv_data;
+  case LORA_LINE_ERROR:
+    lora_complete_cmd(false);
+    break;
 
-          if (lora_parse_p2p_recv(temp_buf, &recv_data))
-          {
-            // 콜백이 등록되어 있으면 콜백 호출
-            if (instance.p2p_recv_callback)
-            {
-              instance.p2p_recv_callback(&recv_data, instance.p2p_recv_user_data);
-            }
-            else
-            {
-              // 콜백이 없으면 RTCM fragment 재조립 및 GPS로 전송
-              LOG_INFO("P2P data received: %d bytes, RSSI=%d, SNR=%d",
-                       recv_data.data_len, recv_data.rssi, recv_data.snr);
-
-              // RTCM fragment 재조립
-              bool complete = rtcm_reassembly_process(&instance.rtcm_reassembly,
-                                                      (uint8_t *)recv_data.data,
-                                                      recv_data.data_len);
-
-              if (complete)
-              {
-                // 완전한 RTCM 패킷 수신 - 검증 후 GPS로 전송
-                if (rtcm_validate_packet(instance.rtcm_reassembly.buffer,
-                                        instance.rtcm_reassembly.expected_len))
-                {
-                  LOG_INFO("Valid RTCM packet - sending to GPS via UART");
-
-                  // GPS UART로 직접 전송
-                  if (!gps_send_raw_data(GPS_ID_BASE,
-                                         instance.rtcm_reassembly.buffer,
-                                         instance.rtcm_reassembly.expected_len))
-                  {
-                    LOG_ERR("Failed to send RTCM data to GPS");
-                  }
-                }
-                else
-                {
-                  LOG_ERR("Invalid RTCM packet - discarding");
-                }
-
-                // 남은 데이터 처리 (다음 RTCM 패킷의 시작일 수 있음)
-                if (instance.rtcm_reassembly.buffer_pos > instance.rtcm_reassembly.expected_len)
-                {
-                  size_t remaining = instance.rtcm_reassembly.buffer_pos - instance.rtcm_reassembly.expected_len;
-                  LOG_INFO("Remaining %d bytes in buffer - moving to front", remaining);
-
-                  // 남은 데이터를 버퍼 앞으로 이동
-                  memmove(instance.rtcm_reassembly.buffer,
-                          &instance.rtcm_reassembly.buffer[instance.rtcm_reassembly.expected_len],
-                          remaining);
-                  instance.rtcm_reassembly.buffer_pos = remaining;
-                  instance.rtcm_reassembly.has_header = false;
-                  instance.rtcm_reassembly.expected_len = 0;
-
-                  // 남은 데이터로 다음 패킷 시작 시도
-                  // (재귀 호출 대신 다음 수신에서 처리됨)
-                }
-                else
-                {
-                  // 남은 데이터가 없으면 완전히 초기화
-                  rtcm_reassembly_reset(&instance.rtcm_reassembly);
-                }
-              }
-            }
-          }
-        }
-        else if ((strstr(temp_buf, "at+recv=") || strstr(temp_buf, "AT+RECV=")) && !instance.init_complete)
-        {
-          LOG_WARN("Ignoring P2P data during initialization");
-        }
+  case LORA_LINE_RECV:
+    lora_handle_recv_line(line, mode);
+    break;
+
+  default:
+    LOG_DEBUG("LoRa line: %s", line);
+    break;
+  }
+}
 
-        old_pos = pos;
+/**
+ * @brief 링 버퍼 구간을 줄 단위로 잘라 처리
+ *
+ * DMA 조각 경계와 상관없이 '\n' 이 올 때마다 한 줄을 처리하고,
+ * 끝나지 않은 줄은 다음 조각까지 line 에 남겨 둔다.
+ * 한 줄이 LORA_RX_LINE_MAX 를 넘으면 다음 '\n' 까지 버린다.
+ */
+static void lora_rx_feed(const char *data, size_t len, lora_mode_t mode)
+{
+  CCM_BSS static char line[LORA_RX_LINE_MAX];
+  static size_t line_len = 0;
+  static bool overflow = false;
+
+  for (size_t i = 0; i < len;)
+  {
+    // 출력 가능한 문자는 CR/LF 까지 한 번에 복사
+    size_t n = simd_span_text((const uint8_t *)&data[i], len - i);
+    if (n > 0)
+    {
+      if (overflow || line_len + n > LORA_RX_LINE_MAX - 1)
+      {
+        overflow = true;
       }
       else
       {
-        // Circular buffer wrap-around
-        len = LORA_RECV_BUF_SIZE - old_pos + pos;
+        memcpy(&line[line_len], &data[i], n);
+        line_len += n;
+      }
+      i += n;
+      continue;
+    }
 
-        size_t first_part = LORA_RECV_BUF_SIZE - old_pos;
-        memcpy(temp_buf, &lora_recv[old_pos], first_part);
-        memcpy(&temp_buf[first_part], &lora_recv[0], pos);
-        temp_buf[len] = '\0';
+    char c = data[i++];
 
-        LOG_INFO("LoRa recv (wrap): %s", temp_buf);
+    if (c == '\n')
+    {
+      if (overflow)
+      {
+        LOG_WARN("LoRa line too long, dropped");
+      }
+      else if (line_len > 0)
+      {
+        line[line_len] = '\0';
+        lora_handle_line(line, line_len, mode);
+      }
+      line_len = 0;
+      overflow = false;
+    }
+    else if (c == '\r' || overflow)
+    {
+      // CR 은 줄에 넣지 않음, 넘친 줄은 끝까지 건너뜀
+    }
+    else if (line_len < LORA_RX_LINE_MAX - 1)
+    {
+      line[line_len++] = c;
+    }
+    else
+    {
+      overflow = true;
+    }
+  }
+}
 
-        // 동일한 처리 로직
-        if (instance.current_cmd_req != NULL)
-        {
-          bool result = lora_parse_at_response(temp_buf, len);
+/**
+ * @brief LoRa RX Task (수신 데이터 처리)
+ */
+static void lora_process_task(void *pvParameter)
+{
+  dma_ring_t ring;
+  uint8_t dummy = 0;
 
-          if (strstr(temp_buf, "OK") || strstr(temp_buf, "ERROR"))
-          {
-            if (instance.current_cmd_req->is_async)
-            {
-              instance.current_cmd_req->async_result = result;
-            }
-            else
-            {
-              *(instance.current_cmd_req->result) = result;
-            }
-
-            xSemaphoreGive(instance.current_cmd_req->response_sem);
-          }
-        }
+  dma_ring_init(&ring, lora_port_get_recv_buf(), LORA_RECV_BUF_SIZE, 0, 0);
+  LOG_INFO("LoRa RX Task started");
 
-        if ((strstr(temp_buf, "at+recv=") || strstr(temp_buf, "AT+RECV=")) && instance.init_complete)
-        {
-          if(config->lora_mode == LORA_MODE_ROVER)
-          {
-            led_set_toggle(3);
-          }
+  // RX Task 준비 완료 플래그 설정
+  instance.rx_task_ready = true;
+  LOG_INFO("LoRa RX Task ready");
 
-          lora_p2p_recv_data_t recv_data;
+  // TX/RX Task 모두 준비될 때까지 대기
+  while (!instance.tx_task_ready || !instance.rx_task_ready)
+  {
+    vTaskDelay(pdMS_TO_TICKS(10));
+  }
 
-          if (lora_parse_p2p_recv(temp_buf, &recv_data))
-          {
-            // 콜백이 등록되어 있으면 콜백 호출
-            if (instance.p2p_recv_callback)
-            {
-              instance.p2p_recv_callback(&recv_data, instance.p2p_recv_user_data);
-            }
-            else
-            {
-              // 콜백이 없으면 RTCM fragment 재조립 및 GPS로 전송
-              LOG_INFO("P2P data received (wrap): %d bytes, RSSI=%d, SNR=%d",
-                       recv_data.data_len, recv_data.rssi, recv_data.snr);
-
-              // RTCM fragment 재조립
-              bool complete = rtcm_reassembly_process(&instance.rtcm_reassembly,
-                                                      (uint8_t *)recv_data.data,
-                                                      recv_data.data_len);
-
-              if (complete)
-              {
-                // 완전한 RTCM 패킷 수신 - 검증 후 GPS로 전송
-                if (rtcm_validate_packet(instance.rtcm_reassembly.buffer,
-                                        instance.rtcm_reassembly.expected_len))
-                {
-                  LOG_INFO("Valid RTCM packet - sending to GPS via UART (wrap)");
-
-                  // GPS UART로 직접 전송
-                  if (!gps_send_raw_data(GPS_ID_BASE,
-                                         instance.rtcm_reassembly.buffer,
-                                         instance.rtcm_reassembly.expected_len))
-                  {
-                    LOG_ERR("Failed to send RTCM data to GPS (wrap)");
-                  }
-                }
-                else
-                {
-                  LOG_ERR("Invalid RTCM packet - discarding (wrap)");
-                }
-
-                // 남은 데이터 처리 (다음 RTCM 패킷의 시작일 수 있음)
-                if (instance.rtcm_reassembly.buffer_pos > instance.rtcm_reassembly.expected_len)
-                {
-                  size_t remaining = instance.rtcm_reassembly.buffer_pos - instance.rtcm_reassembly.expected_len;
-                  LOG_INFO("Remaining %d bytes in buffer - moving to front (wrap)", remaining);
-
-                  // 남은 데이터를 버퍼 앞으로 이동
-                  memmove(instance.rtcm_reassembly.buffer,
-                          &instance.rtcm_reassembly.buffer[instance.rtcm_reassembly.expected_len],
-                          remaining);
-                  instance.rtcm_reassembly.buffer_pos = remaining;
-                  instance.rtcm_reassembly.has_header = false;
-                  instance.rtcm_reassembly.expected_len = 0;
-
-                  // 남은 데이터로 다음 패킷 시작 시도
-                  // (재귀 호출 대신 다음 수신에서 처리됨)
-                }
-                else
-                {
-                  // 남은 데이터가 없으면 완전히 초기화
-                  rtcm_reassembly_reset(&instance.rtcm_reassembly);
-                }
-              }
-            }
-          }
-        }
-        else if ((strstr(temp_buf, "at+recv=") || strstr(temp_buf, "AT+RECV=")) && !instance.init_complete)
-        {
-          LOG_WARN("Ignoring P2P data during initialization (wrap)");
-        }
+  LOG_INFO("Both TX and RX tasks ready, starting LoRa initialization");
 
-        old_pos = pos;
+  // SPI 무선칩은 리셋/설정을 여기서 (초기화 AT 명령은 TX Task 가 바꿔 실행)
+  if (instance.lora.radio)
+  {
+    instance.lora.radio->cb = lora_radio_event;
+    instance.lora.radio->user = NULL;
+    instance.radio_ready = lora_radio_call(instance.lora.radio->ops->init) == 0;
+    if (!instance.radio_ready)
+    {
+      LOG_ERR("LoRa radio init failed");
+    }
+  }
+
+  if (BOARD_LORA_IS(LORA_MODE_BASE))
+  {
+    lora_init_p2p_async(lora_p2p_base_steps, INIT_SEQ_COUNT(lora_p2p_base_steps));
+  }
+  else if (BOARD_LORA_IS(LORA_MODE_ROVER) || BOARD_LORA_IS(LORA_MODE_REPEATER))
+  {
+    // 중계기도 평소에는 수신 모드 (중계할 때만 잠깐 송신 모드)
+    lora_init_p2p_async(lora_p2p_rover_steps, INIT_SEQ_COUNT(lora_p2p_rover_steps));
+    led_set_color(3, LED_COLOR_GREEN);
+    led_set_state(3, true);
+  }
+
+  while (1)
+  {
+    xQueueReceive(instance.queue, &dummy, portMAX_DELAY);
+    irq_lat_task(IRQ_LAT_LORA);
+
+    if (instance.lora.radio)
+    {
+      xSemaphoreTake(instance.mutex, portMAX_DELAY);
+      instance.lora.radio->ops->irq(instance.lora.radio);
+      xSemaphoreGive(instance.mutex);
+      if (lora_radio_rx_ready)
+      {
+        lora_radio_rx_ready = false;
+        lora_handle_recv_data(&lora_radio_rx, LORA_MODE);
       }
+      continue;
     }
+
+    uint32_t lost;
+    uint32_t pending = dma_ring_update(&ring, lora_port_get_rx_count(), &lost);
+
+    if (pending == 0)
+    {
+      continue;
+    }
+
+    mem_wm_update(&lora_rx_wm, pending + lost < LORA_RECV_BUF_SIZE ? pending + lost
+                                                                    : LORA_RECV_BUF_SIZE);
+    if (lost)
+    {
+      LOG_WARN("RX ring overrun, %lu bytes lost", lost);
+    }
+
+    // 링 버퍼에서 바로 읽음 (wrap-around 면 두 구간)
+    dma_ring_span_t span[2];
+    uint8_t n = dma_ring_spans(&ring, span);
+
+    for (uint8_t i = 0; i < n; i++)
+    {
+      lora_rx_feed((const char *)span[i].p, span[i].len, LORA_MODE);
+    }
+    dma_ring_consume(&ring, pending);
   }
 
   vTaskDelete(NULL);
 }
 
+/**
+ * @brief flash 의 TDMA slot 적용 (범위 밖이면 끔)
+ *
+ * init 과 설정 저장 (flash_params_watch, 게시한 태스크) 에서. 다음 slot 경계부터 바뀐다.
+ */
+static bool lora_tdma_apply(const user_params_t *params, void *ctx)
+{
+  (void)ctx;
+
+  if (!lora_tdma_set((uint8_t)params->lora_tdma_slot,
+                     params->lora_tdma_slots <= LORA_TDMA_MAX_SLOTS
+                         ? (uint8_t)params->lora_tdma_slots : 0))
+  {
+    lora_tdma_set(0, 0);
+  }
+  return true;
+}
+
 void lora_instance_init(void)
 {
+  static bool tdma_watched; // 중지 후 다시 init 해도 한 번만 등록
+
   memset(&instance, 0, sizeof(lora_app_instance_t));
   lora_init(&instance.lora);
 
+  instance.p2p_params.sf = LORA_P2P_SF;
+  instance.p2p_params.bw = LORA_P2P_BW;
+  instance.p2p_params.cr = LORA_P2P_CR;
+  instance.p2p_params.preamble = LORA_P2P_PREAMBLE;
+  lora_tdma_apply(flash_params_snapshot(NULL), NULL);
+  if (!tdma_watched)
+  {
+    flash_params_watch(FLASH_PARAMS_FIELD(lora_tdma_slot), lora_tdma_apply, NULL);
+    flash_params_watch(FLASH_PARAMS_FIELD(lora_tdma_slots), lora_tdma_apply, NULL);
+    tdma_watched = true;
+  }
+  instance.airtime_us = (int32_t)(1000 * lora_airtime_permille());
+  instance.airtime_tick = xTaskGetTickCount();
+  instance.baud = LORA_UART_BAUD_DEFAULT;
+  instance.tx_overlap = true;
+
+  // 모듈은 초기화 명령어의 설정 (프로파일 0) 으로 돌아감
+  lora_link.profile = 0;
+  lora_link.st.profile = 0;
+
+  // 중계 slot 은 재시작해도 유지
+  uint8_t relay_slot = lora_relay.slot;
+  memset(&lora_relay, 0, sizeof(lora_relay));
+  lora_relay.slot = relay_slot;
+
   // RTCM 재조립 버퍼 초기화
   rtcm_reassembly_reset(&instance.rtcm_reassembly);
 
-  if (lora_port_init_instance(&instance.lora) != 0)
-  {
-    LOG_ERR("LORA 포트 초기화 실패");
-    return;
-  }
+  if (lora_port_init_instance(&instance.lora) != 0)
+  {
+    LOG_ERR("LORA 포트 초기화 실패");
+    return;
+  }
+
+  instance.queue = RTOS_QUEUE_CREATE_STATIC(lora_rx_queue, LORA_RX_QUEUE_LEN, sizeof(uint8_t));
+  mem_wm_register(&lora_rx_wm);
+  rtcm_reassembly_init();
+
+  // TX 명령어 큐 생성 (요청은 lora_cmd_pool 에 두고 포인터만 넘김)
+  instance.cmd_queue = RTOS_QUEUE_CREATE_STATIC(lora_cmd_queue, LORA_CMD_POOL_SIZE,
+                                                sizeof(lora_cmd_request_t *));
+  instance.cmd_free = RTOS_QUEUE_CREATE_STATIC(lora_cmd_free, LORA_CMD_POOL_SIZE,
+                                               sizeof(lora_cmd_request_t *));
+
+  for (size_t i = 0; i < LORA_CMD_POOL_SIZE; i++)
+  {
+    lora_cmd_request_t *req = &lora_cmd_pool[i];
+    xQueueSend(instance.cmd_free, &req, 0);
+  }
+
+  lora_port_set_queue(instance.queue);
+  instance.mutex = xSemaphoreCreateMutexStatic(&lora_mutex_buf);
+  lora_port_start(&instance.lora);
+
+  // RX/TX Task 생성
+  instance.rx_task = RTOS_TASK_CREATE_STATIC(lora_rx, lora_process_task, "lora_rx",
+                                             NULL, tskIDLE_PRIORITY + 3);
+  instance.tx_task = RTOS_TASK_CREATE_STATIC(lora_tx, lora_tx_task, "lora_tx",
+                                             NULL, tskIDLE_PRIORITY + 3);
+
+  instance.initialized = true;
+
+  LOG_INFO("LORA 인스턴스 초기화 완료");
+}
+
+bool lora_send_command_sync(const char *cmd, uint32_t timeout_ms)
+{
+  if (!instance.initialized)
+  {
+    LOG_ERR("LoRa not initialized");
+    return false;
+  }
+
+  if (!cmd || strlen(cmd) == 0)
+  {
+    LOG_ERR("Empty command");
+    return false;
+  }
+
+  // 세마포어 생성
+  SemaphoreHandle_t response_sem = HEAP_TRACK(HEAP_TAG_CMD_SEM, xSemaphoreCreateBinary());
+  if (response_sem == NULL)
+  {
+    LOG_ERR("Failed to create semaphore");
+    return false;
+  }
+
+  lora_cmd_request_t *cmd_req = lora_cmd_alloc(pdMS_TO_TICKS(1000));
+  if (cmd_req == NULL)
+  {
+    LOG_ERR("Failed to send command to TX task");
+    vSemaphoreDelete(response_sem);
+    return false;
+  }
+
+  bool result = false;
+
+  // 명령어 요청 (동기 방식)
+  cmd_req->timeout_ms = timeout_ms;
+  cmd_req->is_async = false;
+  cmd_req->response_sem = response_sem;
+  cmd_req->result = &result;
+
+  strncpy(cmd_req->cmd, cmd, sizeof(cmd_req->cmd) - 1);
+
+  // TX 태스크로 명령어 전송 요청 (슬롯 수가 큐 깊이보다 크지 않으므로 바로 들어감)
+  xQueueSend(instance.cmd_queue, &cmd_req, 0);
+
+  // TX 태스크에서 처리 완료 대기
+  if (xSemaphoreTake(response_sem, pdMS_TO_TICKS(timeout_ms + 1000)) == pdTRUE)
+  {
+    // 처리 완료
+    vSemaphoreDelete(response_sem);
+    lora_cmd_free(cmd_req);
+    return result;
+  }
+  else
+  {
+    // 외부 타임아웃 (TX 태스크 응답 없음)
+    LOG_ERR("TX task did not respond");
+    vSemaphoreDelete(response_sem);
+    return false;
+  }
+}
+
+/**
+ * @brief cmd 를 채운 비동기 요청을 TX 태스크 큐에 넣음
+ *
+ * @param cmd_req lora_cmd_alloc() 으로 받은 슬롯
+ *                (cmd, timeout_ms, toa_ms, skip_response, callback, user_data 설정)
+ */
+static void lora_queue_async_request(lora_cmd_request_t *cmd_req)
+{
+  cmd_req->is_async = true;
+  cmd_req->response_sem = NULL;
+  cmd_req->result = NULL;
+  cmd_req->async_result = false;
+
+  // TX 태스크로 명령어 전송 요청 (슬롯 수가 큐 깊이보다 크지 않으므로 바로 들어감)
+  xQueueSend(instance.cmd_queue, &cmd_req, 0);
+
+  // 즉시 반환 (non-blocking)
+  LOG_INFO("Async command queued");
+}
+
+bool lora_send_command_async(const char *cmd, uint32_t timeout_ms, uint32_t toa_ms,
+                             lora_command_callback_t callback, void *user_data,
+                             bool skip_response)
+{
+  if (!instance.initialized)
+  {
+    LOG_ERR("LoRa not initialized");
+    return false;
+  }
+
+  if (!cmd || strlen(cmd) == 0)
+  {
+    LOG_ERR("Empty command");
+    return false;
+  }
+
+  lora_cmd_request_t *cmd_req = lora_cmd_alloc(pdMS_TO_TICKS(1000));
+  if (cmd_req == NULL)
+  {
+    LOG_ERR("Failed to send command to TX task");
+    return false;
+  }
+
+  // 명령어 요청 (비동기 방식)
+  cmd_req->timeout_ms = timeout_ms;
+  cmd_req->toa_ms = toa_ms;
+  cmd_req->skip_response = skip_response;
+  cmd_req->callback = callback;
+  cmd_req->user_data = user_data;
+
+  strncpy(cmd_req->cmd, cmd, sizeof(cmd_req->cmd) - 1);
+
+  lora_queue_async_request(cmd_req);
+  return true;
+}
+
+bool lora_set_work_mode(lora_work_mode_t mode, uint32_t timeout_ms)
+{
+  char cmd[64];
+  fmt_t f;
+
+  fmt_init(&f, cmd, sizeof(cmd));
+  fmt_str(&f, "at+set_config=lora:work_mode:");
+  fmt_i32(&f, mode);
+  fmt_str(&f, "\r\n");
+  fmt_end(&f);
+  return lora_send_command_sync(cmd, timeout_ms);
+}
+
+/**
+ * @brief at+set_config=lorap2p:<freq>:<sf>:<bw>:<cr>:<preamble>:<pwr>\r\n
+ */
+static void lora_format_p2p_config(char *cmd, size_t size, uint32_t freq,
+                                   uint8_t sf, uint8_t bw, uint8_t cr,
+                                   uint16_t preamlen, uint8_t pwr)
+{
+  fmt_t f;
+
+  fmt_init(&f, cmd, size);
+  fmt_str(&f, "at+set_config=lorap2p:");
+  fmt_u32(&f, freq);
+  fmt_char(&f, ':');
+  fmt_u32(&f, sf);
+  fmt_char(&f, ':');
+  fmt_u32(&f, bw);
+  fmt_char(&f, ':');
+  fmt_u32(&f, cr);
+  fmt_char(&f, ':');
+  fmt_u32(&f, preamlen);
+  fmt_char(&f, ':');
+  fmt_u32(&f, pwr);
+  fmt_str(&f, "\r\n");
+  fmt_end(&f);
+}
+
+bool lora_set_p2p_config(uint32_t freq, uint8_t sf, uint8_t bw, uint8_t cr,
+                         uint16_t preamlen, uint8_t pwr, uint32_t timeout_ms)
+{
+  char cmd[128];
+
+  lora_format_p2p_config(cmd, sizeof(cmd), freq, sf, bw, cr, preamlen, pwr);
+  if (!lora_send_command_sync(cmd, timeout_ms))
+  {
+    return false;
+  }
+
+  instance.p2p_params.sf = sf;
+  instance.p2p_params.bw = bw;
+  instance.p2p_params.cr = cr;
+  instance.p2p_params.preamble = preamlen;
+  return true;
+}
+
+bool lora_set_p2p_transfer_mode(lora_p2p_transfer_mode_t mode, uint32_t timeout_ms)
+{
+  char cmd[64];
+  fmt_t f;
+
+  fmt_init(&f, cmd, sizeof(cmd));
+  fmt_str(&f, "at+set_config=lorap2p:transfer_mode:");
+  fmt_i32(&f, mode);
+  fmt_str(&f, "\r\n");
+  fmt_end(&f);
+  return lora_send_command_sync(cmd, timeout_ms);
+}
+
+bool lora_send_p2p_data(const char *data, uint32_t timeout_ms)
+{
+  if (!data)
+  {
+    LOG_ERR("NULL data");
+    return false;
+  }
+
+  char cmd[512];
+  fmt_t f;
+
+  fmt_init(&f, cmd, sizeof(cmd));
+  fmt_str(&f, "at+send=lorap2p:");
+  fmt_str(&f, data);
+  fmt_str(&f, "\r\n");
+  if (fmt_end(&f) == 0)
+  {
+    LOG_ERR("data too long");
+    return false;
+  }
+  return lora_send_command_sync(cmd, timeout_ms);
+}
+
+/**
+ * @brief at+send=lorap2p:<HEX>\r\n 명령을 cmd 에 바로 작성
+ *
+ * @param cmd 출력 버퍼 (LORA_P2P_CMD_SIZE 이상)
+ * @param data 바이너리 데이터 (최대 LORA_P2P_MAX_RAW 바이트)
+ * @param len 데이터 길이
+ * @return 종료 문자를 뺀 명령 길이
+ */
+static size_t lora_build_p2p_send_cmd(char *cmd, const uint8_t *data, size_t len)
+{
+  memcpy(cmd, LORA_P2P_CMD_PREFIX, LORA_P2P_CMD_PREFIX_LEN);
+  char *p = simd_hex_encode(&cmd[LORA_P2P_CMD_PREFIX_LEN], data, len);
+  *p++ = '\r';
+  *p++ = '\n';
+  *p = '\0';
+
+  return (size_t)(p - cmd);
+}
+
+bool lora_send_p2p_raw(const uint8_t *data, size_t len, uint32_t timeout_ms)
+{
+  if (!instance.initialized)
+  {
+    LOG_ERR("LoRa not initialized");
+    return false;
+  }
+
+  if (!data || len == 0)
+  {
+    LOG_ERR("NULL data or zero length");
+    return false;
+  }
+
+  // HEX conversion doubles the size, so max binary is 118 bytes (-> 236 HEX chars)
+  if (len > LORA_P2P_MAX_RAW)
+  {
+    LOG_ERR("Data too large: %d > %d (max binary for HEX ASCII)", len, LORA_P2P_MAX_RAW);
+    return false;
+  }
+
+  char cmd[LORA_P2P_CMD_SIZE];
+  lora_build_p2p_send_cmd(cmd, data, len);
+
+  LOG_INFO("Sending raw P2P data: %d bytes -> %d HEX chars", len, len * 2);
+  if (len >= 4) {
+    LOG_INFO("First 4 bytes (binary): %02X %02X %02X %02X", data[0], data[1], data[2], data[3]);
+    LOG_INFO("First 8 HEX chars: %.8s", &cmd[LORA_P2P_CMD_PREFIX_LEN]);
+  }
+
+  // Use the standard command sending mechanism
+  return lora_send_command_sync(cmd, timeout_ms);
+}
+
+/**
+ * @brief 바이너리 송신 요청을 슬롯에 바로 작성해 큐에 넣음
+ *
+ * @param wait 빈 슬롯을 기다릴 tick (TX Task 안에서는 0)
+ */
+static bool lora_queue_p2p_raw(const uint8_t *data, size_t len, uint32_t timeout_ms,
+                               lora_command_callback_t callback, void *user_data,
+                               TickType_t wait)
+{
+  lora_cmd_request_t *cmd_req = lora_cmd_alloc(wait);
+  if (cmd_req == NULL)
+  {
+    LOG_ERR("Failed to send command to TX task");
+    return false;
+  }
+
+  cmd_req->callback = callback;
+  cmd_req->user_data = user_data;
+
+  // HEX 는 슬롯에 바로 작성, 무선칩은 바이너리 그대로 (UART 시간 없음)
+  size_t cmd_len = 0;
+  if (instance.lora.radio)
+  {
+    memcpy(cmd_req->cmd, data, len);
+    cmd_req->raw_len = (uint16_t)len;
+  }
+  else
+  {
+    cmd_len = lora_build_p2p_send_cmd(cmd_req->cmd, data, len);
+  }
+
+  // 명령 UART 전송 + 무선 ToA 가 끝나야 다음 명령을 보낼 수 있다
+  uint32_t busy_us = lora_uart_us(cmd_len) + lora_get_p2p_toa_us(len);
+  uint32_t toa_ms = (busy_us + 999) / 1000;
+  if (timeout_ms == 0)
+  {
+    timeout_ms = toa_ms + LORA_RAW_RESP_MARGIN_MS;
+  }
+
+  cmd_req->timeout_ms = timeout_ms;
+  cmd_req->toa_ms = toa_ms;
+
+  // Use async command sending mechanism
+  lora_queue_async_request(cmd_req);
+
+  taskENTER_CRITICAL();
+  lora_airtime_refill();
+  instance.airtime_us -= (int32_t)busy_us;
+  taskEXIT_CRITICAL();
+  return true;
+}
+
+bool lora_send_p2p_raw_async(const uint8_t *data, size_t len, uint32_t timeout_ms,
+                              lora_command_callback_t callback, void *user_data)
+{
+  if (!instance.initialized)
+  {
+    LOG_ERR("LoRa not initialized");
+    return false;
+  }
+
+  if (!data || len == 0)
+  {
+    LOG_ERR("NULL data or zero length");
+    return false;
+  }
+
+  // HEX conversion doubles the size, so max binary is 118 bytes (-> 236 HEX chars)
+  size_t max_len = instance.lora.radio ? LORA_RADIO_PAYLOAD_MAX : LORA_P2P_MAX_RAW;
+  if (len > max_len)
+  {
+    LOG_ERR("Data too large: %d > %d", len, max_len);
+    return false;
+  }
+
+  LOG_INFO("Sending raw P2P data (async): %d bytes -> %d HEX chars", len, len * 2);
+  if (len >= 4) {
+    LOG_INFO("First 4 bytes (binary): %02X %02X %02X %02X", data[0], data[1], data[2], data[3]);
+  }
+
+  return lora_queue_p2p_raw(data, len, timeout_ms, callback, user_data,
+                            pdMS_TO_TICKS(1000));
+}
+
+uint32_t lora_get_p2p_toa_us(size_t len)
+{
+  return lora_calc_toa_us(&instance.p2p_params, len);
+}
+
+uint32_t lora_airtime_available_us(void)
+{
+  taskENTER_CRITICAL();
+  lora_airtime_refill();
+  int32_t avail = instance.airtime_us;
+  if (LORA_REG_HOUR_LIMIT_MS > 0)
+  {
+    int32_t hour_left = (int32_t)(LORA_REG_HOUR_LIMIT_MS * 1000U - lora_reg.hour_us);
+
+    if (hour_left < avail)
+    {
+      avail = hour_left;
+    }
+  }
+  taskEXIT_CRITICAL();
+
+  return avail > 0 ? (uint32_t)avail : 0;
+}
+
+/*
+ * 링크 적응 (adaptive data rate)
+ *
+ * 베이스가 LORA_LINK_POLL_MS 마다 POLL 을 보내고 잠시 receiver 로 바꿔
+ * 로버의 FEEDBACK (지난 구간 RSSI/SNR, 유실 epoch) 을 듣는다.
+ * 받은 SNR 로 각 프로파일의 여유를 계산해 가장 빠른 프로파일을 고르고,
+ * 바뀌면 SET 을 여러 번 보낸 뒤 양쪽이 같은 lorap2p 설정으로 바꾼다.
+ * RTCM 솎아내기는 ToA 기반 점유 예산이 새 변조 설정을 따라가며 처리한다.
+ *
+ * 제어 명령이 빠져 양쪽이 어긋나면 베이스는 응답 없는 POLL 이,
+ * 로버는 수신 공백이 쌓였을 때 가장 느린(튼튼한) 프로파일로 돌아가 만난다.
+ */
+
+/**
+ * @brief 프로파일의 복조 SNR 여유 예측 (0.1dB)
+ *
+ * 지금 프로파일에서 측정한 SNR 을 대역폭 비율만큼 옮기고
+ * SX127x 복조 한계 (SF7 -7.5dB, SF 하나당 -2.5dB) 를 뺀다.
+ */
+static int16_t lora_link_margin(int16_t snr_db, uint8_t from, uint8_t to)
+{
+  const lora_link_profile_t *a = &lora_link_profiles[from];
+  const lora_link_profile_t *b = &lora_link_profiles[to];
+  int16_t snr10 = snr_db * 10 + 30 * ((int16_t)a->bw - (int16_t)b->bw);
+  int16_t floor10 = -75 - 25 * ((int16_t)b->sf - 7);
+
+  return snr10 - floor10;
+}
+
+static void lora_link_format_config(char *cmd, size_t size, uint8_t profile)
+{
+  lora_format_p2p_config(cmd, size, LORA_P2P_FREQ, lora_link_profiles[profile].sf,
+                         lora_link_profiles[profile].bw, LORA_P2P_CR,
+                         LORA_P2P_PREAMBLE, LORA_P2P_PWR);
+}
+
+/**
+ * @brief 비동기 명령 하나를 큐에 넣음 (기다리지 않음)
+ */
+static bool lora_link_queue_cmd(const char *cmd, uint32_t timeout_ms, bool skip_response,
+                                lora_command_callback_t callback, void *user_data)
+{
+  lora_cmd_request_t *cmd_req = lora_cmd_alloc(0);
+  if (cmd_req == NULL)
+  {
+    return false;
+  }
+
+  strncpy(cmd_req->cmd, cmd, sizeof(cmd_req->cmd) - 1);
+  cmd_req->timeout_ms = timeout_ms;
+  cmd_req->skip_response = skip_response;
+  cmd_req->callback = callback;
+  cmd_req->user_data = user_data;
+
+  lora_queue_async_request(cmd_req);
+  return true;
+}
+
+static bool lora_link_queue_ctrl(uint8_t type, const uint8_t *body, size_t body_len)
+{
+  uint8_t frame[LORA_LINK_FRAME_MAX] = {0, LORA_LINK_CTRL, type};
+
+  memcpy(&frame[LORA_LINK_HDR_SIZE], body, body_len);
+  return lora_queue_p2p_raw(frame, LORA_LINK_HDR_SIZE + body_len, 0, NULL, NULL, 0);
+}
+
+static bool lora_link_slots(uint32_t need)
+{
+  return instance.cmd_free != NULL && uxQueueMessagesWaiting(instance.cmd_free) >= need;
+}
+
+/**
+ * @brief lorap2p 설정 명령 OK 후 변조 설정 반영 (TX Task)
+ */
+static void lora_link_config_done(bool success, void *user_data)
+{
+  uint8_t profile = (uint8_t)(uintptr_t)user_data;
+
+  if (!success)
+  {
+    LOG_ERR("LoRa link profile %d config failed", profile);
+    return;
+  }
+
+  instance.p2p_params.sf = lora_link_profiles[profile].sf;
+  instance.p2p_params.bw = lora_link_profiles[profile].bw;
+  lora_link.profile = profile;
+  lora_link.st.profile = profile;
+  lora_link.st.changes++;
+  LOG_INFO("LoRa link profile %d (SF%d, BW%d)", profile,
+           lora_link_profiles[profile].sf, lora_link_profiles[profile].bw);
+}
+
+/**
+ * @brief 프로파일 변경 명령 넣기 (설정 후 transfer_mode 다시 지정)
+ */
+static bool lora_link_apply(uint8_t profile, lora_mode_t mode)
+{
+  char cmd[96];
+
+  if (!lora_link_slots(2))
+  {
+    return false;
+  }
+
+  lora_link_format_config(cmd, sizeof(cmd), profile);
+  lora_link_queue_cmd(cmd, LORA_AT_CMD_TIMEOUT_MS, false, lora_link_config_done,
+                      (void *)(uintptr_t)profile);
+  lora_link_queue_cmd(mode == LORA_MODE_BASE ? LORA_LINK_MODE_SENDER : LORA_LINK_MODE_RECEIVER,
+                      LORA_AT_CMD_TIMEOUT_MS, false, NULL, NULL);
+  return true;
+}
+
+static void lora_link_window_done(bool success, void *user_data)
+{
+  lora_link.window_done = true;
+}
+
+/**
+ * @brief 피드백으로 다음 프로파일 고르기 (베이스)
+ *
+ * 여유가 LORA_LINK_MARGIN_DB 이상인 가장 빠른 프로파일로 가되,
+ * 빨라질 때는 한 단계씩 LORA_LINK_HYST_DB 만큼 더 여유가 있을 때만 간다.
+ * epoch 유실이 있었으면 적어도 한 단계 느리게 간다.
+ */
+static uint8_t lora_link_decide(const lora_link_feedback_t *fb)
+{
+  uint8_t cur = lora_link.profile;
+  uint8_t target = LORA_LINK_ROBUST;
+
+  for (uint8_t i = 0; i < LORA_LINK_PROFILE_COUNT; i++)
+  {
+    if (lora_link_margin(fb->snr_min, cur, i) >= LORA_LINK_MARGIN_DB * 10)
+    {
+      target = i;
+      break;
+    }
+  }
+
+  if (fb->lost > 0 && target <= cur)
+  {
+    target = cur < LORA_LINK_ROBUST ? cur + 1 : cur;
+  }
+
+  if (target < cur)
+  {
+    target = cur - 1;
+    if (lora_link_margin(fb->snr_min, cur, target) <
+        (LORA_LINK_MARGIN_DB + LORA_LINK_HYST_DB) * 10)
+    {
+      target = cur;
+    }
+  }
+
+  return target;
+}
+
+/**
+ * @brief 베이스: 프로파일 변경 알림 후 바꾸기
+ */
+static void lora_link_base_switch(uint8_t profile)
+{
+  if (!lora_link_slots(LORA_LINK_SET_REPEAT + 2))
+  {
+    return;
+  }
+
+  for (uint8_t i = 0; i < LORA_LINK_SET_REPEAT; i++)
+  {
+    lora_link_queue_ctrl(LORA_LINK_SET, &profile, 1);
+  }
+  lora_link_apply(profile, LORA_MODE_BASE);
+}
+
+/**
+ * @brief 베이스: 응답 창이 끝난 뒤 결과 처리
+ */
+static void lora_link_base_evaluate(void)
+{
+  lora_link_feedback_t fb;
+  bool valid;
+
+  taskENTER_CRITICAL();
+  valid = lora_link.fb_valid;
+  fb = lora_link.fb;
+  lora_link.fb_valid = false;
+  taskEXIT_CRITICAL();
+
+  lora_link.awaiting = false;
 
-#if LORA_MODE == LORA_MODE_BASE
-  instance.queue = xQueueCreate(10, sizeof(uint8_t));
-  if (instance.queue == NULL)
+  if (!valid)
   {
-    LOG_ERR("LORA RX 큐 생성 실패");
+    lora_link.st.misses++;
+    if (++lora_link.misses >= LORA_LINK_LOST_POLLS && lora_link.profile != LORA_LINK_ROBUST)
+    {
+      LOG_WARN("LoRa link: no feedback for %d polls, falling back", lora_link.misses);
+      lora_link.misses = 0;
+      lora_link_base_switch(LORA_LINK_ROBUST);
+    }
     return;
   }
 
-#elif LORA_MODE == LORA_MODE_ROVER
-  instance.queue = xQueueCreate(10, sizeof(uint8_t));
-  if (instance.queue == NULL)
+  lora_link.misses = 0;
+  lora_link.st.fb = fb;
+  lora_link.st.feedbacks++;
+
+  uint8_t target = lora_link_decide(&fb);
+  LOG_INFO("LoRa link feedback: rssi=%d snr=%d/%d rx=%d lost=%d -> profile %d",
+           fb.rssi, fb.snr, fb.snr_min, fb.rx_count, fb.lost, target);
+
+  if (target != lora_link.profile)
   {
-    LOG_ERR("LORA RX 큐 생성 실패");
-    return;
+    lora_link_base_switch(target);
   }
-#endif
+}
+
+/**
+ * @brief 베이스: POLL 보내고 응답 창 열기
+ */
+static void lora_link_base_poll(void)
+{
+  uint8_t body[2] = {lora_link.profile, ++lora_link.poll_seq};
+  uint32_t window_ms = LORA_LINK_FB_WINDOW_MS +
+                       2 * lora_get_p2p_toa_us(LORA_LINK_FRAME_MAX) / 1000;
 
-  // TX 명령어 큐 생성
-  instance.cmd_queue = xQueueCreate(LORA_CMD_QUEUE_SIZE, sizeof(lora_cmd_request_t));
-  if (instance.cmd_queue == NULL)
+  if (!lora_link_slots(3))
   {
-    LOG_ERR("LORA TX 큐 생성 실패");
     return;
   }
 
-  lora_port_set_queue(instance.queue);
-  instance.mutex = xSemaphoreCreateMutex();
-  lora_port_start(&instance.lora);
+  lora_link.fb_valid = false;
+  lora_link.window_done = false;
+  lora_link.awaiting = true;
+  lora_link.st.polls++;
 
-  // RX Task 생성
-  BaseType_t ret = xTaskCreate(lora_process_task, "lora_rx", 1024,
-                               NULL, tskIDLE_PRIORITY + 3, &instance.rx_task);
-  if (ret != pdPASS)
+  lora_link_queue_ctrl(LORA_LINK_POLL, body, sizeof(body));
+  // receiver 로 바꾼 뒤 창 동안 다른 명령을 보내지 않음
+  lora_link_queue_cmd(LORA_LINK_MODE_RECEIVER, window_ms, true, NULL, NULL);
+  if (!lora_link_queue_cmd(LORA_LINK_MODE_SENDER, LORA_AT_CMD_TIMEOUT_MS, false,
+                           lora_link_window_done, NULL))
   {
-    LOG_ERR("LORA RX Task 생성 실패");
-    return;
+    // 다른 생산자가 슬롯을 먼저 가져감, 다음 주기에 다시
+    lora_link.awaiting = false;
   }
+}
+
+/**
+ * @brief 로버: POLL 에 FEEDBACK 으로 응답 (RX Task)
+ */
+static void lora_link_rover_reply(uint8_t poll_seq)
+{
+  lora_link_feedback_t fb = {0};
+  uint8_t body[8];
 
-  // TX Task 생성
-  ret = xTaskCreate(lora_tx_task, "lora_tx", 1024,
-                    NULL, tskIDLE_PRIORITY + 3, &instance.tx_task);
-  if (ret != pdPASS)
+  if (!lora_link_slots(3))
   {
-    LOG_ERR("LORA TX Task 생성 실패");
     return;
   }
 
-  instance.initialized = true;
-
-  LOG_INFO("LORA 인스턴스 초기화 완료");
+  if (lora_link.rx_count > 0)
+  {
+    fb.rssi = (int16_t)(lora_link.rssi_sum / lora_link.rx_count);
+    fb.snr = (int16_t)(lora_link.snr_sum / lora_link.rx_count);
+    fb.snr_min = lora_link.snr_min;
+  }
+  fb.rx_count = lora_link.rx_count;
+  uint32_t lost = instance.rtcm_reassembly.dropped_epochs - lora_link.dropped_base;
+  fb.lost = lost > 0xFF ? 0xFF : (uint8_t)lost;
+
+  body[0] = poll_seq;
+  body[1] = (uint8_t)(int8_t)fb.rssi;
+  body[2] = (uint8_t)(int8_t)fb.snr;
+  body[3] = (uint8_t)(int8_t)fb.snr_min;
+  body[4] = (uint8_t)(fb.rx_count >> 8);
+  body[5] = (uint8_t)fb.rx_count;
+  body[6] = fb.lost;
+  body[7] = lora_link.profile;
+
+  lora_link_queue_cmd(LORA_LINK_MODE_SENDER, LORA_AT_CMD_TIMEOUT_MS, false, NULL, NULL);
+  lora_link_queue_ctrl(LORA_LINK_FEEDBACK, body, sizeof(body));
+  lora_link_queue_cmd(LORA_LINK_MODE_RECEIVER, LORA_AT_CMD_TIMEOUT_MS, false, NULL, NULL);
+
+  lora_link.st.fb = fb;
+  lora_link.st.feedbacks++;
+  lora_link.rssi_sum = 0;
+  lora_link.snr_sum = 0;
+  lora_link.rx_count = 0;
+  lora_link.dropped_base = instance.rtcm_reassembly.dropped_epochs;
 }
 
-bool lora_send_command_sync(const char *cmd, uint32_t timeout_ms)
+/**
+ * @brief 수신 frame 확인 (RX Task)
+ *
+ * @return true: 링크 제어 frame (RTCM 처리하지 않음)
+ */
+static bool lora_link_on_recv(const lora_p2p_recv_data_t *recv_data)
 {
-  if (!instance.initialized)
+  const uint8_t *d = (const uint8_t *)recv_data->data;
+  size_t len = recv_data->data_len;
+  bool ctrl = len >= LORA_LINK_HDR_SIZE && d[1] == LORA_LINK_CTRL;
+  const board_config_t *config = board_get_config();
+
+  if (config->lora_mode == LORA_MODE_ROVER)
   {
-    LOG_ERR("LoRa not initialized");
-    return false;
+    if (lora_link.rx_count == 0 || recv_data->snr < lora_link.snr_min)
+    {
+      lora_link.snr_min = recv_data->snr;
+    }
+    lora_link.rssi_sum += recv_data->rssi;
+    lora_link.snr_sum += recv_data->snr;
+    lora_link.rx_count++;
+    lora_link.last_rx = xTaskGetTickCount();
   }
 
-  if (!cmd || strlen(cmd) == 0)
+  if (!ctrl)
   {
-    LOG_ERR("Empty command");
     return false;
   }
 
-  // 세마포어 생성
-  SemaphoreHandle_t response_sem = xSemaphoreCreateBinary();
-  if (response_sem == NULL)
+  if (!lora_link.enabled)
   {
-    LOG_ERR("Failed to create semaphore");
-    return false;
+    return true;
   }
 
-  bool result = false;
+  const uint8_t *body = &d[LORA_LINK_HDR_SIZE];
+  size_t body_len = len - LORA_LINK_HDR_SIZE;
 
-  // 명령어 요청 구조체 생성 (동기 방식)
-  lora_cmd_request_t cmd_req = {
-      .timeout_ms = timeout_ms,
-      .is_async = false,
-      .skip_response = false,
-      .response_sem = response_sem,
-      .result = &result,
-      .callback = NULL,
-      .user_data = NULL,
-  };
+  switch (d[2])
+  {
+  case LORA_LINK_POLL:
+    if (config->lora_mode == LORA_MODE_ROVER && body_len >= 2)
+    {
+      lora_link_rover_reply(body[1]);
+    }
+    break;
 
-  strncpy(cmd_req.cmd, cmd, sizeof(cmd_req.cmd) - 1);
-  cmd_req.cmd[sizeof(cmd_req.cmd) - 1] = '\0';
+  case LORA_LINK_SET:
+    if (config->lora_mode == LORA_MODE_ROVER && body_len >= 1 &&
+        body[0] < LORA_LINK_PROFILE_COUNT && body[0] != lora_link.profile)
+    {
+      // 반복 SET 은 첫 번째만 (설정 완료 전엔 profile 이 아직 그대로)
+      static TickType_t applied_tick;
+      TickType_t now = xTaskGetTickCount();
 
-  // TX 태스크로 명령어 전송 요청
-  if (xQueueSend(instance.cmd_queue, &cmd_req, pdMS_TO_TICKS(1000)) != pdTRUE)
-  {
-    LOG_ERR("Failed to send command to TX task");
-    vSemaphoreDelete(response_sem);
-    return false;
-  }
+      if (now - applied_tick > pdMS_TO_TICKS(LORA_LINK_FB_WINDOW_MS) &&
+          lora_link_apply(body[0], LORA_MODE_ROVER))
+      {
+        applied_tick = now;
+      }
+    }
+    break;
 
-  // TX 태스크에서 처리 완료 대기
-  if (xSemaphoreTake(response_sem, pdMS_TO_TICKS(timeout_ms + 1000)) == pdTRUE)
-  {
-    // 처리 완료
-    vSemaphoreDelete(response_sem);
-    return result;
-  }
-  else
-  {
-    // 외부 타임아웃 (TX 태스크 응답 없음)
-    LOG_ERR("TX task did not respond");
-    vSemaphoreDelete(response_sem);
-    return false;
+  case LORA_LINK_FEEDBACK:
+    if (config->lora_mode == LORA_MODE_BASE && body_len >= 8 &&
+        lora_link.awaiting && body[0] == lora_link.poll_seq)
+    {
+      taskENTER_CRITICAL();
+      lora_link.fb.rssi = (int8_t)body[1];
+      lora_link.fb.snr = (int8_t)body[2];
+      lora_link.fb.snr_min = (int8_t)body[3];
+      lora_link.fb.rx_count = ((uint16_t)body[4] << 8) | body[5];
+      lora_link.fb.lost = body[6];
+      lora_link.fb_valid = true;
+      taskEXIT_CRITICAL();
+    }
+    break;
+
+  default:
+    break;
   }
+
+  return true;
 }
 
-bool lora_send_command_async(const char *cmd, uint32_t timeout_ms, uint32_t toa_ms,
-                             lora_command_callback_t callback, void *user_data,
-                             bool skip_response)
+/**
+ * @brief TX Task 루프에서 호출 (POLL 주기, 응답 창 결과, 로버 수신 공백)
+ *
+ * @return 다음 호출까지 기다릴 tick (꺼져 있으면 portMAX_DELAY)
+ */
+static TickType_t lora_link_poll(void)
 {
-  if (!instance.initialized)
+  if (!lora_link.enabled || !instance.init_complete)
   {
-    LOG_ERR("LoRa not initialized");
-    return false;
+    return portMAX_DELAY;
   }
 
-  if (!cmd || strlen(cmd) == 0)
+  const board_config_t *config = board_get_config();
+  TickType_t now = xTaskGetTickCount();
+
+  if (config->lora_mode == LORA_MODE_ROVER)
   {
-    LOG_ERR("Empty command");
-    return false;
+    TickType_t silent = pdMS_TO_TICKS(LORA_LINK_POLL_MS * (LORA_LINK_LOST_POLLS + 1));
+
+    if (now - lora_link.last_rx >= silent)
+    {
+      if (lora_link.profile != LORA_LINK_ROBUST)
+      {
+        LOG_WARN("LoRa link: nothing received, falling back");
+        lora_link_apply(LORA_LINK_ROBUST, LORA_MODE_ROVER);
+      }
+      lora_link.last_rx = now;
+    }
+    return pdMS_TO_TICKS(1000);
   }
 
-  // 세마포어 생성 (TX Task 내부에서 응답 대기용)
-  SemaphoreHandle_t response_sem = xSemaphoreCreateBinary();
-  if (response_sem == NULL)
+  if (lora_link.awaiting)
   {
-    LOG_ERR("Failed to create semaphore");
-    return false;
+    if (!lora_link.window_done)
+    {
+      return pdMS_TO_TICKS(100);
+    }
+    lora_link_base_evaluate();
+    lora_link.next_poll = now + pdMS_TO_TICKS(LORA_LINK_POLL_MS);
   }
 
-  // 명령어 요청 구조체 생성 (비동기 방식)
-  lora_cmd_request_t cmd_req = {
-      .timeout_ms = timeout_ms,
-      .toa_ms = toa_ms,
-      .is_async = true,
-      .skip_response = skip_response,
-      .response_sem = response_sem,
-      .result = NULL,
-      .callback = callback,
-      .user_data = user_data,
-      .async_result = false,
-  };
-
-  strncpy(cmd_req.cmd, cmd, sizeof(cmd_req.cmd) - 1);
-  cmd_req.cmd[sizeof(cmd_req.cmd) - 1] = '\0';
-
-  // TX 태스크로 명령어 전송 요청
-  if (xQueueSend(instance.cmd_queue, &cmd_req, pdMS_TO_TICKS(1000)) != pdTRUE)
+  if ((int32_t)(now - lora_link.next_poll) >= 0)
   {
-    LOG_ERR("Failed to send command to TX task");
-    vSemaphoreDelete(response_sem);
-    return false;
+    lora_link_base_poll();
+    lora_link.next_poll = now + pdMS_TO_TICKS(LORA_LINK_POLL_MS);
+    return pdMS_TO_TICKS(100);
   }
 
-  // 즉시 반환 (non-blocking)
-  LOG_INFO("Async command queued");
-  return true;
+  return lora_link.next_poll - now;
 }
 
-bool lora_set_work_mode(lora_work_mode_t mode, uint32_t timeout_ms)
+void lora_link_set_adaptive(bool enable)
 {
-  char cmd[64];
-  snprintf(cmd, sizeof(cmd), "at+set_config=lora:work_mode:%d\r\n", mode);
-  return lora_send_command_sync(cmd, timeout_ms);
+  lora_link.enabled = enable;
+  lora_link.next_poll = xTaskGetTickCount() + pdMS_TO_TICKS(LORA_LINK_POLL_MS);
+  lora_link.last_rx = xTaskGetTickCount();
+  lora_link.misses = 0;
+  lora_link.awaiting = false;
+
+  // TX Task 가 portMAX_DELAY 로 자고 있을 수 있으므로 빈 요청으로 깨움
+  if (enable && instance.cmd_queue != NULL)
+  {
+    lora_cmd_request_t *wake = NULL;
+    xQueueSend(instance.cmd_queue, &wake, 0);
+  }
 }
 
-bool lora_set_p2p_config(uint32_t freq, uint8_t sf, uint8_t bw, uint8_t cr,
-                         uint16_t preamlen, uint8_t pwr, uint32_t timeout_ms)
+void lora_link_get_status(lora_link_status_t *out)
 {
-  char cmd[128];
-  snprintf(cmd, sizeof(cmd),
-           "at+set_config=lorap2p:%lu:%d:%d:%d:%d:%d\r\n",
-           freq, sf, bw, cr, preamlen, pwr);
-  return lora_send_command_sync(cmd, timeout_ms);
-}
+  if (!out)
+  {
+    return;
+  }
 
-bool lora_set_p2p_transfer_mode(lora_p2p_transfer_mode_t mode, uint32_t timeout_ms)
-{
-  char cmd[64];
-  snprintf(cmd, sizeof(cmd), "at+set_config=lorap2p:transfer_mode:%d\r\n", mode);
-  return lora_send_command_sync(cmd, timeout_ms);
+  taskENTER_CRITICAL();
+  memcpy(out, &lora_link.st, sizeof(*out));
+  out->enabled = lora_link.enabled;
+  out->profile = lora_link.profile;
+  out->sf = lora_link_profiles[lora_link.profile].sf;
+  out->bw = lora_link_profiles[lora_link.profile].bw;
+  taskEXIT_CRITICAL();
 }
 
-bool lora_send_p2p_data(const char *data, uint32_t timeout_ms)
+/*
+ * 중계 (LORA_MODE_REPEATER)
+ *
+ * 중계기는 수신 모드로 있다가 베이스 epoch 의 fragment 를 헤더 그대로 모은다.
+ * epoch 끝 (데이터 끝, FEC 를 쓰면 마지막 패리티) 을 받거나 fragment 송신
+ * 간격보다 오래 조용하면 베이스 송신이 끝난 것으로 보고, 자기 slot 만큼
+ * 기다린 뒤 송신 모드로 바꿔 모은 fragment 를 다시 보내고 수신 모드로 돌아온다.
+ *
+ * 로버와 다른 중계기는 (seq, 헤더 [1]) 을 기억해 두 번째로 듣는 사본을 버리고,
+ * 다음 epoch 이 시작된 뒤 늦게 온 이전 seq 사본도 버린다. 그래서 베이스와
+ * 중계기가 모두 들리는 로버도 재조립이 흔들리지 않고, 중계기끼리 서로의
+ * 사본을 다시 중계하며 돌지도 않는다.
+ */
+
+/**
+ * @brief 이미 받은 fragment 인지 확인하고 기억 (RX Task)
+ *
+ * @param hdr fragment 헤더 (RTCM_FRAG_HDR_SIZE)
+ * @return true: 중복 또는 늦은 사본이라 버림
+ */
+static bool lora_relay_is_dup(const uint8_t *hdr)
 {
-  if (!data)
+  uint8_t seq = hdr[0];
+  uint16_t key = ((uint16_t)seq << 8) | hdr[1];
+
+  if (lora_relay.have_seq && seq != lora_relay.newest_seq)
   {
-    LOG_ERR("NULL data");
-    return false;
+    int8_t age = (int8_t)(lora_relay.newest_seq - seq);
+
+    if (age > 0 && age <= LORA_RELAY_STALE_SEQ)
+    {
+      lora_relay.st.stale++;
+      lora_stats_rx_dup();
+      return true;
+    }
+    if (age > LORA_RELAY_STALE_SEQ)
+    {
+      lora_relay.seen_cnt = 0;  // 크게 되돌아감: 베이스 재시작
+    }
   }
 
-  char cmd[512];
-  snprintf(cmd, sizeof(cmd), "at+send=lorap2p:%s\r\n", data);
-  return lora_send_command_sync(cmd, timeout_ms);
+  for (uint8_t i = 0; i < lora_relay.seen_cnt; i++)
+  {
+    if (lora_relay.seen[i] == key)
+    {
+      lora_relay.st.dups++;
+      lora_stats_rx_dup();
+      return true;
+    }
+  }
+
+  lora_relay.seen[lora_relay.seen_next] = key;
+  lora_relay.seen_next = (lora_relay.seen_next + 1) % LORA_RELAY_SEEN_MAX;
+  if (lora_relay.seen_cnt < LORA_RELAY_SEEN_MAX)
+  {
+    lora_relay.seen_cnt++;
+  }
+  lora_relay.newest_seq = seq;
+  lora_relay.have_seq = true;
+  return false;
 }
 
-bool lora_send_p2p_raw(const uint8_t *data, size_t len, uint32_t timeout_ms)
+/**
+ * @brief 중계할 fragment 모으기 (RX Task)
+ */
+static void lora_relay_on_frag(const uint8_t *data, size_t len)
 {
-  if (!instance.initialized)
+  bool parity = (data[1] & RTCM_FRAG_PARITY) != 0;
+  bool wake = false;
+
+  if (len > LORA_P2P_MAX_RAW)
   {
-    LOG_ERR("LoRa not initialized");
-    return false;
+    return;
   }
 
-  if (!data || len == 0)
+  taskENTER_CRITICAL();
+  if (lora_relay.pending || (lora_relay.collecting && data[0] != lora_relay.seq))
   {
-    LOG_ERR("NULL data or zero length");
-    return false;
+    // 이전 epoch 을 아직 못 보냄. 모은 것부터 보낸다.
+    lora_relay.end_seen = true;
+    lora_relay.st.missed++;
+    wake = true;
   }
-
-  // HEX conversion doubles the size, so max binary is 118 bytes (-> 236 HEX chars)
-  if (len > 118)
+  else
   {
-    LOG_ERR("Data too large: %d > 118 (max binary for HEX ASCII)", len);
-    return false;
+    if (!lora_relay.collecting)
+    {
+      lora_relay.collecting = true;
+      lora_relay.end_seen = false;
+      lora_relay.seq = data[0];
+      lora_relay.count = 0;
+      wake = true;
+    }
+
+    if (lora_relay.count < LORA_RELAY_MAX_FRAGS)
+    {
+      memcpy(lora_relay.frag[lora_relay.count], data, len);
+      lora_relay.frag_len[lora_relay.count] = (uint8_t)len;
+      lora_relay.count++;
+    }
+    else
+    {
+      lora_relay.st.overflows++;
+    }
+    lora_relay.last_rx = xTaskGetTickCount();
+
+    if (parity)
+    {
+      lora_relay.fec = true;
+      if (len > RTCM_FRAG_HDR_SIZE + 1 && (data[RTCM_FRAG_HDR_SIZE + 1] & RTCM_FRAG_LAST))
+      {
+        lora_relay.end_seen = true;
+        wake = true;
+      }
+    }
+    else if ((data[1] & RTCM_FRAG_LAST) && !lora_relay.fec)
+    {
+      lora_relay.end_seen = true;
+      wake = true;
+    }
   }
+  taskEXIT_CRITICAL();
 
-  // Convert binary data to HEX ASCII string
-  // Each byte becomes 2 HEX characters, plus null terminator
-  char hex_string[512];  // 236 * 2 + 1 = 473 bytes max
-  if (len * 2 >= sizeof(hex_string))
+  // TX Task 가 portMAX_DELAY 로 자고 있을 수 있음
+  if (wake)
   {
-    LOG_ERR("HEX string buffer too small");
-    return false;
+    lora_cmd_request_t *token = NULL;
+    xQueueSend(instance.cmd_queue, &token, 0);
   }
+}
+
+static void lora_relay_frag_done(bool success, void *user_data)
+{
+  lora_stats_tx_done(success);
+}
+
+/**
+ * @brief 모은 epoch 을 송신 모드로 바꿔 다시 보냄 (TX Task)
+ */
+static void lora_relay_send(void)
+{
+  uint8_t count = lora_relay.count;
+  uint32_t need_us = 0;
 
-  for (size_t i = 0; i < len; i++)
+  for (uint8_t i = 0; i < count; i++)
   {
-    snprintf(&hex_string[i * 2], 3, "%02X", data[i]);
+    need_us += lora_get_p2p_toa_us(lora_relay.frag_len[i]);
   }
-  hex_string[len * 2] = '\0';
 
-  LOG_INFO("Sending raw P2P data: %d bytes -> %d HEX chars", len, len * 2);
-  if (len >= 4) {
-    LOG_INFO("First 4 bytes (binary): %02X %02X %02X %02X", data[0], data[1], data[2], data[3]);
-    LOG_INFO("First 8 HEX chars: %.8s", hex_string);
+  // 일부만 보내면 로버가 끝을 못 맞추므로 통째로 보내거나 건너뜀
+  if (!lora_link_slots(count + 2) || lora_airtime_available_us() < need_us)
+  {
+    lora_relay.st.skipped++;
+    LOG_WARN("LoRa relay: seq %d skipped (%d frags)", lora_relay.seq, count);
   }
+  else
+  {
+    lora_link_queue_cmd(LORA_LINK_MODE_SENDER, LORA_AT_CMD_TIMEOUT_MS, false, NULL, NULL);
+    for (uint8_t i = 0; i < count; i++)
+    {
+      bool queued = lora_queue_p2p_raw(lora_relay.frag[i], lora_relay.frag_len[i], 0,
+                                       lora_relay_frag_done, NULL, 0);
+      lora_stats_tx_queued(queued, i == count - 1);
+    }
+    lora_link_queue_cmd(LORA_LINK_MODE_RECEIVER, LORA_AT_CMD_TIMEOUT_MS, false, NULL, NULL);
 
-  // Create AT command: at+send=lorap2p:<HEX_STRING>\r\n
-  char cmd[600];
-  snprintf(cmd, sizeof(cmd), "at+send=lorap2p:%s\r\n", hex_string);
+    lora_relay.st.epochs++;
+    lora_relay.st.frags += count;
+    LOG_INFO("LoRa relay: seq %d, %d frags, slot %d", lora_relay.seq, count, lora_relay.slot);
+  }
 
-  // Use the standard command sending mechanism
-  return lora_send_command_sync(cmd, timeout_ms);
+  taskENTER_CRITICAL();
+  lora_relay.collecting = false;
+  lora_relay.pending = false;
+  taskEXIT_CRITICAL();
 }
 
-bool lora_send_p2p_raw_async(const uint8_t *data, size_t len, uint32_t timeout_ms,
-                              lora_command_callback_t callback, void *user_data)
+/**
+ * @brief TX Task 루프에서 호출 (epoch 끝 판정, slot 대기, 중계 송신)
+ *
+ * @return 다음 호출까지 기다릴 tick (모으는 epoch 이 없으면 portMAX_DELAY)
+ */
+static TickType_t lora_relay_poll(void)
 {
-  if (!instance.initialized)
+  const board_config_t *config = board_get_config();
+
+  if (config->lora_mode != LORA_MODE_REPEATER || !instance.init_complete)
   {
-    LOG_ERR("LoRa not initialized");
-    return false;
+    return portMAX_DELAY;
   }
 
-  if (!data || len == 0)
+  // 베이스 fragment 하나의 명령 UART + ToA 보다 오래 조용하면 epoch 끝
+  uint32_t gap_us = lora_uart_us(LORA_P2P_CMD_SIZE) + lora_get_p2p_toa_us(LORA_P2P_MAX_RAW);
+  TickType_t quiet = pdMS_TO_TICKS(gap_us / 1000 + LORA_RELAY_QUIET_MS);
+  TickType_t now = xTaskGetTickCount();
+  TickType_t wait = portMAX_DELAY;
+
+  taskENTER_CRITICAL();
+  if (lora_relay.collecting && !lora_relay.pending)
   {
-    LOG_ERR("NULL data or zero length");
-    return false;
+    TickType_t idle = now - lora_relay.last_rx;
+
+    if (lora_relay.end_seen || idle >= quiet)
+    {
+      lora_relay.pending = true;
+      lora_relay.due = now + pdMS_TO_TICKS((uint32_t)lora_relay.slot * LORA_RELAY_SLOT_MS);
+    }
+    else
+    {
+      wait = quiet - idle;
+    }
   }
+  bool pending = lora_relay.pending;
+  TickType_t due = lora_relay.due;
+  taskEXIT_CRITICAL();
 
-  // HEX conversion doubles the size, so max binary is 118 bytes (-> 236 HEX chars)
-  if (len > 118)
+  if (!pending)
   {
-    LOG_ERR("Data too large: %d > 118 (max binary for HEX ASCII)", len);
-    return false;
+    return wait;
   }
 
-  // Convert binary data to HEX ASCII string
-  // Each byte becomes 2 HEX characters, plus null terminator
-  char hex_string[300];  // 118 * 2 + 1 = 237 bytes max
-  if (len * 2 >= sizeof(hex_string))
+  if ((int32_t)(now - due) < 0)
   {
-    LOG_ERR("HEX string buffer too small");
-    return false;
+    return due - now;
   }
 
-  for (size_t i = 0; i < len; i++)
+  lora_relay_send();
+  return portMAX_DELAY;
+}
+
+bool lora_tdma_set(uint8_t slot, uint8_t slots)
+{
+  if (slots > LORA_TDMA_MAX_SLOTS || (slots != 0 && slot >= slots))
   {
-    snprintf(&hex_string[i * 2], 3, "%02X", data[i]);
+    return false;
   }
-  hex_string[len * 2] = '\0';
 
-  LOG_INFO("Sending raw P2P data (async): %d bytes -> %d HEX chars", len, len * 2);
-  if (len >= 4) {
-    LOG_INFO("First 4 bytes (binary): %02X %02X %02X %02X", data[0], data[1], data[2], data[3]);
+  taskENTER_CRITICAL();
+  lora_tdma.slot = slot;
+  lora_tdma.slots = slots;
+  lora_tdma.untimed = false;
+  taskEXIT_CRITICAL();
+
+  if (slots)
+  {
+    LOG_INFO("LoRa TDMA slot %d/%d (%dms)", slot, slots, LORA_TDMA_FRAME_MS / slots);
   }
+  return true;
+}
+
+void lora_relay_set_slot(uint8_t slot)
+{
+  lora_relay.slot = slot;
+}
 
-  // Calculate ToA (Time on Air): (bytes / 118) * 350ms * 1.2
-  // uint32_t toa_ms = (len * 350 / 118);  // Base ToA
-  // toa_ms = toa_ms * 12 / 10;  // Add 20% margin (x1.2)
-  // if (toa_ms < 60) {
-  //   toa_ms = 60;  // Minimum ToA
-  // }
+void lora_relay_get_status(lora_relay_status_t *out)
+{
+  if (!out)
+  {
+    return;
+  }
 
-  uint32_t toa_ms = 0;
+  taskENTER_CRITICAL();
+  memcpy(out, &lora_relay.st, sizeof(*out));
+  out->slot = lora_relay.slot;
+  taskEXIT_CRITICAL();
+}
 
-  // Create AT command: at+send=lorap2p:<HEX_STRING>\r\n
-  char cmd[300];
-  snprintf(cmd, sizeof(cmd), "at+send=lorap2p:%s\r\n", hex_string);
+uint32_t lora_get_tx_queue_space(void)
+{
+  if (!instance.initialized || instance.cmd_free == NULL)
+  {
+    return 0;
+  }
 
-  // Use async command sending mechanism
-  return lora_send_command_async(cmd, timeout_ms, toa_ms, callback, user_data, false);
+  // TX Task 가 처리 중인 슬롯 하나는 큐 자리로 치지 않음
+  uint32_t space = (uint32_t)uxQueueMessagesWaiting(instance.cmd_free);
+  if (instance.current_cmd_req == NULL && space > 0)
+  {
+    space--;
+  }
+  return space;
 }
 
 void lora_set_p2p_recv_callback(lora_p2p_recv_callback_t callback, void *user_data)
@@ -1429,6 +2814,14 @@ void lora_instance_deinit(void) {
 
   }
 
+  if (instance.cmd_free != NULL) {
+
+    vQueueDelete(instance.cmd_free);
+
+    instance.cmd_free = NULL;
+
+  }
+
  
 
   // 4. Mutex 삭제
@@ -19,10 +19,56 @@ typedef struct {
   char data[256];
 } lora_p2p_recv_data_t;
 
+/**
+ * @brief RTCM LoRa fragment 헤더
+ *
+ * [0] epoch seq, [1] bit7 = epoch 마지막 fragment, bit6 = 패리티 fragment,
+ * bit0~5 = epoch 안 fragment index
+ */
+#define RTCM_FRAG_HDR_SIZE 2
+#define RTCM_FRAG_LAST 0x80
+#define RTCM_FRAG_PARITY 0x40
+#define RTCM_FRAG_IDX_MASK 0x3F
+#define RTCM_FRAG_DATA_SIZE (118 - RTCM_FRAG_HDR_SIZE)
+
+/**
+ * @brief 링크 적응 제어 frame
+ *
+ * [0] 0, [1] LORA_LINK_CTRL (RTCM fragment 에서는 나오지 않는 값), [2] 종류, 이후 본문
+ * - POLL     베이스 -> 로버: [프로파일][poll seq], 베이스가 잠시 receiver 로 바뀜
+ * - FEEDBACK 로버 -> 베이스: [poll seq][RSSI 평균][SNR 평균][SNR 최소]
+ *            [수신 frame 수 (2, big endian)][유실 epoch][로버 프로파일]
+ * - SET      베이스 -> 로버: [새 프로파일]
+ */
+#define LORA_LINK_CTRL (RTCM_FRAG_PARITY | RTCM_FRAG_IDX_MASK)
+#define LORA_LINK_HDR_SIZE 3
+#define LORA_LINK_FRAME_MAX (LORA_LINK_HDR_SIZE + 8)
+#define LORA_LINK_POLL 1
+#define LORA_LINK_FEEDBACK 2
+#define LORA_LINK_SET 3
+
+/**
+ * @brief 링크 적응 프로파일 수 (0: SF7/BW500 ~ 5: SF10/BW125)
+ */
+#define LORA_LINK_PROFILE_COUNT 6
+
+/**
+ * @brief XOR 패리티 fragment
+ *
+ * 헤더 뒤 [그룹 첫 index][fragment 수 | bit7 epoch 끝][마지막 fragment 길이]
+ * 다음에 그룹 데이터 fragment 들의 XOR (짧은 fragment 는 0 패딩).
+ * FEC 를 켜면 데이터 fragment 도 RTCM_FEC_DATA_SIZE 까지만 채운다.
+ */
+#define RTCM_FEC_HDR_SIZE 5
+#define RTCM_FEC_DATA_SIZE (118 - RTCM_FEC_HDR_SIZE)
+#define RTCM_FEC_MAX_GROUP 8
+
 /**
  * @brief RTCM fragment 재조립 버퍼
+ *
+ * RTCM3 프레임 최대 1029바이트 + fragment 하나
  */
-#define RTCM_REASSEMBLY_BUF_SIZE 512
+#define RTCM_REASSEMBLY_BUF_SIZE 1152
 #define RTCM_REASSEMBLY_TIMEOUT_MS 5000  // 5초 타임아웃
 
 typedef struct {
@@ -32,8 +78,99 @@ typedef struct {
   uint16_t expected_len;                      // 예상 RTCM 패킷 전체 길이
   bool has_header;                            // 헤더 수신 완료 여부
   TickType_t last_recv_tick;                  // 마지막 수신 시간
+  TickType_t frame_tick;                      // 현재 프레임 첫 바이트가 든 fragment 수신 시간
+  bool in_epoch;                              // epoch 받는 중
+  bool epoch_closed;                          // seq epoch 을 마쳤거나 버림
+  uint8_t seq;                                // 받는 중인 epoch seq
+  uint8_t next_idx;                           // 다음에 이어 붙일 fragment index
+  uint32_t dropped_epochs;                    // fragment 유실로 버린 epoch 수
+  uint32_t recovered;                         // 패리티로 복원한 fragment 수
+
+  // 패리티 복원용 최근 fragment 보관 (slot = index % RTCM_FEC_MAX_GROUP)
+  uint8_t win[RTCM_FEC_MAX_GROUP][RTCM_FRAG_DATA_SIZE];
+  uint8_t win_len[RTCM_FEC_MAX_GROUP];
+  uint8_t win_idx[RTCM_FEC_MAX_GROUP];
+  bool win_last[RTCM_FEC_MAX_GROUP];
+  uint8_t win_mask;
 } rtcm_reassembly_t;
 
+/**
+ * @brief 로버가 보고한 지난 POLL 구간 링크 품질
+ */
+typedef struct {
+  int16_t rssi;      // 평균 (dBm)
+  int16_t snr;       // 평균 (dB)
+  int16_t snr_min;   // 최소 (dB)
+  uint16_t rx_count; // 받은 frame 수
+  uint8_t lost;      // 유실로 버린 epoch 수
+} lora_link_feedback_t;
+
+/**
+ * @brief 링크 적응 상태
+ */
+typedef struct {
+  bool enabled;
+  uint8_t profile;
+  uint8_t sf;
+  uint8_t bw;
+  uint32_t polls;       // 베이스가 보낸 POLL
+  uint32_t feedbacks;   // 베이스: 받은 FEEDBACK, 로버: 보낸 FEEDBACK
+  uint32_t misses;      // 응답 없는 POLL
+  uint32_t changes;     // 프로파일 변경 횟수
+  lora_link_feedback_t fb; // 마지막 FEEDBACK
+} lora_link_status_t;
+
+/**
+ * @brief 중계 상태 (중복 판정은 로버도 씀)
+ */
+typedef struct {
+  uint8_t slot;
+  uint32_t epochs;      // 중계한 epoch
+  uint32_t frags;       // 중계 큐에 넣은 fragment
+  uint32_t skipped;     // 큐/점유 예산이 모자라 통째로 건너뛴 epoch
+  uint32_t missed;      // 중계 대기 중이라 받지 못한 fragment
+  uint32_t overflows;   // LORA_RELAY_MAX_FRAGS 를 넘은 fragment
+  uint32_t dups;        // 이미 받은 (seq, index) fragment
+  uint32_t stale;       // 지난 epoch 의 늦은 사본
+} lora_relay_status_t;
+
+/**
+ * @brief 920~923 MHz 대역 송신 규정
+ *
+ * 송신마다 ToA (변조 설정으로 계산) 를 장부에 올려 연속 송신 길이와 최근
+ * 60 분 점유를 센다. 연속 송신 (PAUSE 보다 짧게 쉬고 이어 보낸 것) 이
+ * MAX_CONT 를 넘게 되면 PAUSE 만큼 쉬었다 보낸다. HOUR_LIMIT 이 있으면
+ * 최근 60 분 합이 넘는 송신은 보내지 않는다.
+ *
+ * SPI 무선칩은 보내기 전에 LBT_SENSE 동안 듣고 순간 RSSI 가 LBT_RSSI 보다
+ * 세거나 CAD 에 LoRa preamble 이 들리면 바쁨으로 보고 물러섰다 다시 듣는다.
+ * 끝까지 바쁘면 보내지 않는다. RAK 모듈 AT 펌웨어는 채널을 들을 방법이
+ * 없어 장부와 연속 송신 한도만 적용한다.
+ *
+ * 한도로 쉬거나 못 보낸 송신은 링크 점유 예산에서 PENALTY_FRAGS 개 몫을
+ * 더 빼서 RTCM 스케줄러가 우선순위 낮은 메시지부터 솎아내게 한다.
+ */
+#define LORA_REG_LBT_RSSI_DBM (-80)
+#define LORA_REG_LBT_SENSE_MS 5
+#define LORA_REG_MAX_CONT_MS 4000
+#define LORA_REG_PAUSE_MS 50
+#define LORA_REG_HOUR_LIMIT_MS 0 // 0: 한도 없음 (KR920), ARIB STD-T108 식이면 360000
+#define LORA_REG_PENALTY_FRAGS 4
+
+typedef struct {
+  bool lbt;              // 채널을 듣고 보냄 (SPI 무선칩)
+  uint32_t tx;           // 장부에 올린 송신
+  uint32_t toa_ms;       // 누적 ToA
+  uint32_t hour_ms;      // 최근 60 분 ToA
+  uint32_t cont_max_ms;  // 가장 길었던 연속 송신
+  uint32_t guard_waits;  // 연속 송신 한도로 쉰 횟수
+  uint32_t lbt_busy;     // 채널 바쁨 (재시도마다)
+  uint32_t lbt_fail;     // 끝까지 바빠서 보내지 않은 송신
+  uint32_t hour_limited; // 시간당 한도로 보내지 않은 송신
+} lora_reg_status_t;
+
+void lora_reg_get_status(lora_reg_status_t *out);
+
 void lora_start_tx_test(void);
 /**
  * @brief LoRa P2P 수신 콜백
@@ -53,15 +190,18 @@ typedef void (*lora_command_callback_t)(bool success, void *user_data);
 
 /**
  * @brief LoRa 명령어 요청 구조체
+ *
+ * lora_app.c 의 요청 슬롯 풀에 있고 TX 큐에는 포인터만 넣는다.
  */
 typedef struct {
-  char cmd[256];                  // 전송할 AT 명령어
+  char cmd[256];                  // 전송할 AT 명령어 (raw_len 이 있으면 바이너리 payload)
+  uint16_t raw_len;               // SPI 무선칩 바이너리 송신 길이 (0: AT 명령어)
   uint32_t timeout_ms;            // 타임아웃 (ms)
-  uint32_t toa_ms;                // Time on Air (ms) - OK 응답 후 추가 대기 시간
+  uint32_t toa_ms;                // Time on Air (ms) - 전송 시작부터 다음 명령까지 최소 간격
   bool is_async;                  // true: 비동기, false: 동기
   bool skip_response;             // true: 응답 파싱 건너뛰기 (명령어만 전송)
 
-  SemaphoreHandle_t response_sem; // 응답 대기용 세마포어
+  SemaphoreHandle_t response_sem; // 동기 호출자 완료 알림용 (비동기는 NULL)
   bool *result;                   // 동기 응답 결과 (true: OK, false: ERROR/TIMEOUT)
 
   lora_command_callback_t callback; // 비동기 완료 콜백
@@ -104,7 +244,7 @@ bool lora_send_command_sync(const char *cmd, uint32_t timeout_ms);
  *
  * @param cmd AT 명령어
  * @param timeout_ms 타임아웃 (ms)
- * @param toa_ms Time on Air (ms) - OK 응답 후 추가 대기 시간
+ * @param toa_ms Time on Air (ms) - 전송 시작부터 다음 명령까지 최소 간격
  * @param callback 완료 콜백
  * @param user_data 사용자 데이터
  * @param skip_response true: 응답 파싱 건너뛰기, false: 정상 응답 대기
@@ -173,11 +313,12 @@ bool lora_send_p2p_raw(const uint8_t *data, size_t len, uint32_t timeout_ms);
  * @brief LoRa P2P Raw Binary 데이터 전송 (비동기)
  *
  * Binary 데이터를 HEX ASCII로 변환하여 비동기 전송
- * 최대 118바이트까지 전송 가능 (HEX 변환 시 236 문자)
+ * 최대 118바이트까지 전송 가능 (HEX 변환 시 236 문자).
+ * SPI 무선칩 (LORA_RADIO) 이면 변환 없이 LORA_RADIO_PAYLOAD_MAX (255) 까지.
  *
  * @param data 전송할 raw binary 데이터
- * @param len 데이터 길이 (바이트, 최대 118)
- * @param timeout_ms 타임아웃 (ms)
+ * @param len 데이터 길이 (바이트, 최대 118, 무선칩 255)
+ * @param timeout_ms 응답 타임아웃 (ms), 0 이면 ToA 로 계산
  * @param callback 완료 콜백
  * @param user_data 사용자 데이터
  * @return true: 큐 추가 성공, false: 실패
@@ -185,6 +326,78 @@ bool lora_send_p2p_raw(const uint8_t *data, size_t len, uint32_t timeout_ms);
 bool lora_send_p2p_raw_async(const uint8_t *data, size_t len, uint32_t timeout_ms,
                               lora_command_callback_t callback, void *user_data);
 
+/**
+ * @brief 링크 적응 켜기/끄기 (베이스와 로버 모두 켜야 동작)
+ *
+ * 베이스가 주기적으로 로버의 RSSI/SNR 을 물어 SF/BW 를 바꾼다.
+ * 초기화 직후는 프로파일 0 (초기화 명령어의 SF7/BW500) 이고,
+ * 끄면 그때 프로파일을 그대로 유지한다.
+ *
+ * @param enable true: 켬
+ */
+void lora_link_set_adaptive(bool enable);
+
+void lora_link_get_status(lora_link_status_t *out);
+
+#define LORA_TDMA_MAX_SLOTS 8
+
+/**
+ * @brief TDMA slot 설정 (베이스 송신)
+ *
+ * GNSS 1초를 slots 등분해 slot 번째 구간에서만 무선 송신한다. 같은 주파수를
+ * 쓰는 베이스끼리 다른 slot 을 주면 서로 겹치지 않는다. 점유 예산도 1/slots 로
+ * 줄어 RTCM 솎아내기가 slot 크기를 따라간다. 초기값은 flash 의
+ * lora_tdma_slot / lora_tdma_slots (저장하면 바로 다시 적용).
+ *
+ * @param slot slot 번호 (0 부터)
+ * @param slots slot 수 (0: 끔, 최대 LORA_TDMA_MAX_SLOTS)
+ * @return false: 범위 밖
+ */
+bool lora_tdma_set(uint8_t slot, uint8_t slots);
+
+/**
+ * @brief 중계 slot 설정 (LORA_MODE_REPEATER)
+ *
+ * 중계기는 epoch 송신이 끝난 뒤 slot x LORA_RELAY_SLOT_MS 만큼 기다렸다가
+ * 모아 둔 fragment 를 그대로 다시 보낸다. 같은 영역의 중계기끼리 다르게 준다.
+ * 기본값은 보드 설정의 LORA_RELAY_SLOT.
+ *
+ * @param slot slot 번호 (0 부터)
+ */
+void lora_relay_set_slot(uint8_t slot);
+
+void lora_relay_get_status(lora_relay_status_t *out);
+
+/**
+ * @brief LoRa TX 명령 큐의 남은 슬롯 수
+ *
+ * 큐가 차면 lora_send_command_async()가 최대 1초 블록되므로
+ * 보내기 전에 남은 자리를 확인하는 용도
+ *
+ * @return 남은 슬롯 수 (미초기화 시 0)
+ */
+uint32_t lora_get_tx_queue_space(void);
+
+/**
+ * @brief 현재 P2P 변조 설정에서 payload 의 Time on Air
+ *
+ * @param len 무선 payload 바이트 수 (HEX 변환 전)
+ * @return ToA (us)
+ */
+uint32_t lora_get_p2p_toa_us(size_t len);
+
+/**
+ * @brief 지금 쓸 수 있는 링크 점유 예산
+ *
+ * 초당 LORA_AIRTIME_BUDGET_PERMILLE 만큼 채워지고,
+ * lora_send_p2p_raw_async() 가 큐에 넣을 때 ToA + UART 전송 시간을 뺀다.
+ * 송신 규정 (LORA_REG_*) 에 걸리면 더 빼고, 시간당 한도가 있으면 남은
+ * 시간당 점유보다 크게 돌려주지 않는다.
+ *
+ * @return 남은 예산 (us)
+ */
+uint32_t lora_airtime_available_us(void);
+
 /**
  * @brief LoRa P2P 수신 콜백 등록
  *
@@ -7,6 +7,9 @@
 #include "stm32f4xx_ll_dma.h"
 #include "stm32f4xx_ll_gpio.h"
 #include "stm32f4xx_ll_usart.h"
+#include "uart_tx.h"
+#include "irq_latency.h"
+#include "dma_ring.h"
 
 #ifndef TAG
     #define TAG "LORA_PORT"
@@ -18,8 +21,10 @@
 #define LORA_PORT_UART_DMA DMA1
 #define LORA_PORT_UART_DMA_STREAM LL_DMA_STREAM_1
 
-static char lora_recv_buf[1][1024];
+static char lora_recv_buf[1][LORA_RX_RING_SIZE];
 static QueueHandle_t lora_queues[1] = {NULL};
+static uart_tx_t lora_uart3_tx;
+static volatile uint32_t lora_rx_laps; // RX DMA TC 횟수 (lora_port_get_rx_count)
 
 static void lora_uart3_dma_init(void)
 {
@@ -27,7 +32,7 @@ static void lora_uart3_dma_init(void)
 
   /* DMA interrupt init */
   /* DMA1_Stream1_IRQn interrupt configuration */
-  NVIC_SetPriority(DMA1_Stream1_IRQn, NVIC_EncodePriority(NVIC_GetPriorityGrouping(),5, 0));
+  NVIC_SetPriority(DMA1_Stream1_IRQn, UART_NVIC_PRIO(LORA_RX_IRQ_PRIO));
   NVIC_EnableIRQ(DMA1_Stream1_IRQn);
 
 }
@@ -61,7 +66,7 @@ static void lora_uart3_init(void)
 
   LL_DMA_SetDataTransferDirection(DMA1, LL_DMA_STREAM_1, LL_DMA_DIRECTION_PERIPH_TO_MEMORY);
 
-  LL_DMA_SetStreamPriorityLevel(DMA1, LL_DMA_STREAM_1, LL_DMA_PRIORITY_LOW);
+  LL_DMA_SetStreamPriorityLevel(DMA1, LL_DMA_STREAM_1, UART_DMA_PRIO(LORA_RX_DMA_PRIO));
 
   LL_DMA_SetMode(DMA1, LL_DMA_STREAM_1, LL_DMA_MODE_CIRCULAR);
 
@@ -76,13 +81,13 @@ static void lora_uart3_init(void)
   LL_DMA_DisableFifoMode(DMA1, LL_DMA_STREAM_1);
 
   /* USART3 interrupt Init */
-  NVIC_SetPriority(USART3_IRQn, NVIC_EncodePriority(NVIC_GetPriorityGrouping(),5, 0));
+  NVIC_SetPriority(USART3_IRQn, UART_NVIC_PRIO(LORA_RX_IRQ_PRIO));
   NVIC_EnableIRQ(USART3_IRQn);
 
   /* USER CODE BEGIN USART3_Init 1 */
 
   /* USER CODE END USART3_Init 1 */
-  USART_InitStruct.BaudRate = 115200;
+  USART_InitStruct.BaudRate = LORA_UART_BAUD_DEFAULT;
   USART_InitStruct.DataWidth = LL_USART_DATAWIDTH_8B;
   USART_InitStruct.StopBits = LL_USART_STOPBITS_1;
   USART_InitStruct.Parity = LL_USART_PARITY_NONE;
@@ -99,6 +104,9 @@ int lora_uart3_comm_start(void) {
                           (uint32_t)&lora_recv_buf[0]);
   LL_DMA_SetDataLength(DMA1, LL_DMA_STREAM_1,
                        sizeof(lora_recv_buf[0]));
+  lora_rx_laps = 0;
+  LL_DMA_ClearFlag_TC1(DMA1);
+  LL_DMA_EnableIT_TC(DMA1, LL_DMA_STREAM_1);
   LL_DMA_EnableIT_TE(DMA1, LL_DMA_STREAM_1);
   LL_DMA_EnableIT_FE(DMA1, LL_DMA_STREAM_1);
   LL_DMA_EnableIT_DME(DMA1, LL_DMA_STREAM_1);
@@ -117,22 +125,41 @@ int lora_uart3_comm_start(void) {
 int lora_uart3_hw_init(void) {
   lora_uart3_dma_init();
   lora_uart3_init();
+  uart_tx_init(&lora_uart3_tx, LORA_PORT_UART, DMA1, LL_DMA_STREAM_3,
+               LL_DMA_CHANNEL_4, DMA1_Stream3_IRQn, LORA_TX_DMA_PRIO,
+               LORA_TX_IRQ_PRIO);
 
   return 0;
 }
 
 int lora_uart3_send(const char *data, size_t len) {
-  for (int i = 0; i < len; i++) {
-    while (!LL_USART_IsActiveFlag_TXE(LORA_PORT_UART))
-      ;
-    LL_USART_TransmitData8(LORA_PORT_UART, *(data + i));
+  return uart_tx_send(&lora_uart3_tx, data, len);
+}
+/**
+ * @brief USART3 보드레이트 변경 (HAL ops 콜백)
+ *
+ * 송신 중인 마지막 바이트가 나간 뒤 바꾼다. RX DMA 는 그대로 둔다.
+ *
+ * @param[in] baudrate
+ * @return int 0: 성공, -1: 송신 완료 대기 시간 초과
+ */
+int lora_uart3_set_baudrate(uint32_t baudrate) {
+  TickType_t start = xTaskGetTickCount();
+
+  while (!LL_USART_IsActiveFlag_TC(LORA_PORT_UART)) {
+    if ((xTaskGetTickCount() - start) > pdMS_TO_TICKS(10)) {
+      return -1;
+    }
   }
 
-  while (!LL_USART_IsActiveFlag_TC(LORA_PORT_UART))
-    ;
+  LL_USART_Disable(LORA_PORT_UART);
+  LL_USART_SetBaudRate(LORA_PORT_UART, HAL_RCC_GetPCLK1Freq(),
+                       LL_USART_OVERSAMPLING_16, baudrate);
+  LL_USART_Enable(LORA_PORT_UART);
 
   return 0;
 }
+
 int lora_uart3_comm_stop(void) {
 
   // UART 인터럽트 비활성화
@@ -149,6 +176,8 @@ int lora_uart3_comm_stop(void) {
 
   // DMA 인터럽트 비활성화
 
+  LL_DMA_DisableIT_TC(LORA_PORT_UART_DMA, LORA_PORT_UART_DMA_STREAM);
+
   LL_DMA_DisableIT_TE(LORA_PORT_UART_DMA, LORA_PORT_UART_DMA_STREAM);
 
   LL_DMA_DisableIT_FE(LORA_PORT_UART_DMA, LORA_PORT_UART_DMA_STREAM);
@@ -178,6 +207,7 @@ int lora_uart3_comm_stop(void) {
 }
 
 
+#if LORA_RADIO == LORA_RADIO_RAK
 static const lora_hal_ops_t lora_uart3_ops = {
     .init = lora_uart3_hw_init,
     .reset = NULL,
@@ -185,8 +215,187 @@ static const lora_hal_ops_t lora_uart3_ops = {
     .stop = lora_uart3_comm_stop,
     .send = lora_uart3_send,
     .recv = NULL,
+    .set_baudrate = lora_uart3_set_baudrate,
+};
+
+#define LORA_PORT_OPS (&lora_uart3_ops)
+#define LORA_PORT_RADIO NULL
+#else
+#include "lora_radio.h"
+#include "sx126x.h"
+#include "sx127x.h"
+
+#if !defined(LORA_SPI) || !defined(LORA_NSS_PORT) || !defined(LORA_DIO_IRQHandler)
+#error "LORA_RADIO SPI chip needs LORA_SPI and pin defines in the board block"
+#endif
+#if LORA_RADIO == LORA_RADIO_SX126X && !defined(LORA_BUSY_PORT)
+#error "SX126x needs LORA_BUSY_PORT/LORA_BUSY_PIN"
+#endif
+
+#ifndef LORA_SPI_BR
+#define LORA_SPI_BR 2 // fPCLK/8 (APB1 SPI2/3 5.25 MHz, SX127x 최대 10 MHz)
+#endif
+
+static lora_radio_t lora_spi_radio;
+
+/**
+ * @brief SPI 한 byte 주고받기 (mode 0, master, 레지스터 직접)
+ *
+ * FIFO 까지 255 byte 라 DMA 없이 폴링한다 (5 MHz 에서 약 0.4 ms).
+ */
+static uint8_t lora_spi_byte(uint8_t v)
+{
+  while (!(LORA_SPI->SR & SPI_SR_TXE)) {
+  }
+  *(volatile uint8_t *)&LORA_SPI->DR = v;
+  while (!(LORA_SPI->SR & SPI_SR_RXNE)) {
+  }
+  return *(volatile uint8_t *)&LORA_SPI->DR;
+}
+
+static int lora_spi_xfer2(const uint8_t *hdr, size_t hdr_len, const uint8_t *tx,
+                          uint8_t *rx, size_t len)
+{
+  HAL_GPIO_WritePin(LORA_NSS_PORT, LORA_NSS_PIN, GPIO_PIN_RESET);
+  for (size_t i = 0; i < hdr_len; i++) {
+    lora_spi_byte(hdr[i]);
+  }
+  for (size_t i = 0; i < len; i++) {
+    uint8_t v = lora_spi_byte(tx ? tx[i] : 0);
+    if (rx) {
+      rx[i] = v;
+    }
+  }
+  HAL_GPIO_WritePin(LORA_NSS_PORT, LORA_NSS_PIN, GPIO_PIN_SET);
+  return 0;
+}
+
+static int lora_spi_xfer(const uint8_t *tx, uint8_t *rx, size_t len) {
+  return lora_spi_xfer2(NULL, 0, tx, rx, len);
+}
+
+static void lora_spi_reset(bool assert) {
+  HAL_GPIO_WritePin(LORA_RESET_PORT, LORA_RESET_PIN,
+                    assert ? GPIO_PIN_RESET : GPIO_PIN_SET);
+}
+
+#if LORA_RADIO == LORA_RADIO_SX126X
+static bool lora_spi_busy(void) {
+  return HAL_GPIO_ReadPin(LORA_BUSY_PORT, LORA_BUSY_PIN) == GPIO_PIN_SET;
+}
+#endif
+
+static void lora_spi_delay_ms(uint32_t ms) {
+  vTaskDelay(pdMS_TO_TICKS(ms) ? pdMS_TO_TICKS(ms) : 1);
+}
+
+static const lora_radio_bus_t lora_spi_bus = {
+    .xfer = lora_spi_xfer,
+    .xfer2 = lora_spi_xfer2,
+    .reset = lora_spi_reset,
+#if LORA_RADIO == LORA_RADIO_SX126X
+    .busy = lora_spi_busy,
+#else
+    .busy = NULL,
+#endif
+    .delay_ms = lora_spi_delay_ms,
+};
+
+/**
+ * @brief SPI 와 제어 핀 초기화 (칩 리셋/설정은 lora_app RX Task 가 ops 로)
+ */
+static int lora_spi_hw_init(void) {
+  GPIO_InitTypeDef gpio = {0};
+
+  __HAL_RCC_GPIOA_CLK_ENABLE();
+  __HAL_RCC_GPIOB_CLK_ENABLE();
+  __HAL_RCC_GPIOC_CLK_ENABLE();
+  LORA_SPI_CLK_ENABLE();
+
+  gpio.Pin = LORA_SPI_PINS;
+  gpio.Mode = GPIO_MODE_AF_PP;
+  gpio.Pull = GPIO_NOPULL;
+  gpio.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
+  gpio.Alternate = LORA_SPI_AF;
+  HAL_GPIO_Init(LORA_SPI_PORT, &gpio);
+
+  HAL_GPIO_WritePin(LORA_NSS_PORT, LORA_NSS_PIN, GPIO_PIN_SET);
+  gpio.Pin = LORA_NSS_PIN;
+  gpio.Mode = GPIO_MODE_OUTPUT_PP;
+  gpio.Alternate = 0;
+  HAL_GPIO_Init(LORA_NSS_PORT, &gpio);
+
+  HAL_GPIO_WritePin(LORA_RESET_PORT, LORA_RESET_PIN, GPIO_PIN_SET);
+  gpio.Pin = LORA_RESET_PIN;
+  gpio.Speed = GPIO_SPEED_FREQ_LOW;
+  HAL_GPIO_Init(LORA_RESET_PORT, &gpio);
+
+#if LORA_RADIO == LORA_RADIO_SX126X
+  gpio.Pin = LORA_BUSY_PIN;
+  gpio.Mode = GPIO_MODE_INPUT;
+  HAL_GPIO_Init(LORA_BUSY_PORT, &gpio);
+#endif
+
+  gpio.Pin = LORA_DIO_PIN;
+  gpio.Mode = GPIO_MODE_IT_RISING;
+  gpio.Pull = GPIO_PULLDOWN;
+  HAL_GPIO_Init(LORA_DIO_PORT, &gpio);
+  NVIC_SetPriority(LORA_DIO_IRQn, UART_NVIC_PRIO(LORA_RX_IRQ_PRIO));
+
+  // master, CPOL 0 / CPHA 0, 8 bit MSB 먼저, NSS 는 GPIO
+  LORA_SPI->CR1 = 0;
+  LORA_SPI->CR2 = 0;
+  LORA_SPI->CR1 = SPI_CR1_MSTR | SPI_CR1_SSM | SPI_CR1_SSI |
+                  (LORA_SPI_BR << SPI_CR1_BR_Pos);
+  LORA_SPI->CR1 |= SPI_CR1_SPE;
+
+  return 0;
+}
+
+static int lora_spi_comm_start(void) {
+  __HAL_GPIO_EXTI_CLEAR_IT(LORA_DIO_PIN);
+  NVIC_EnableIRQ(LORA_DIO_IRQn);
+  return 0;
+}
+
+static int lora_spi_comm_stop(void) {
+  NVIC_DisableIRQ(LORA_DIO_IRQn);
+  LOG_INFO("LoRa SPI 무선칩 인터럽트 중지");
+  return 0;
+}
+
+static const lora_hal_ops_t lora_spi_ops = {
+    .init = lora_spi_hw_init,
+    .reset = NULL,
+    .start = lora_spi_comm_start,
+    .stop = lora_spi_comm_stop,
+    .send = NULL, // lora_t.radio 로 보냄
+    .recv = NULL,
+    .set_baudrate = NULL,
 };
 
+/**
+ * @brief DIO (SX126x DIO1, SX127x DIO0) 상승 에지 - RX Task 만 깨움
+ */
+void LORA_DIO_IRQHandler(void) {
+  BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+  if (__HAL_GPIO_EXTI_GET_IT(LORA_DIO_PIN)) {
+    __HAL_GPIO_EXTI_CLEAR_IT(LORA_DIO_PIN);
+    irq_lat_isr(IRQ_LAT_LORA);
+    if (lora_queues[0] != NULL) {
+      uint8_t dummy = 0;
+      xQueueSendFromISR(lora_queues[0], &dummy, &xHigherPriorityTaskWoken);
+    }
+  }
+
+  portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+#define LORA_PORT_OPS (&lora_spi_ops)
+#define LORA_PORT_RADIO (&lora_spi_radio)
+#endif
+
 
 /**
  * @brief This function handles USART3 global interrupt.
@@ -196,6 +405,7 @@ void USART3_IRQHandler(void) {
   BaseType_t xHigherPriorityTaskWoken = pdFALSE;
 
   if (LL_USART_IsActiveFlag_IDLE(LORA_PORT_UART)) {
+    irq_lat_isr(IRQ_LAT_LORA);
     if (lora_queues[0] != NULL) {
       uint8_t dummy = 0;
       xQueueSendFromISR(lora_queues[0], &dummy, &xHigherPriorityTaskWoken);
@@ -230,39 +440,64 @@ void USART3_IRQHandler(void) {
 void DMA1_Stream1_IRQHandler(void)
 {
   /* USER CODE BEGIN DMA1_Stream1_IRQn 0 */
-//   LL_DMA_ClearFlag_TC1(LORA_PORT_UART_DMA);
-//   LL_DMA_ClearFlag_HT1(LORA_PORT_UART_DMA);
-
-//   if (&lora_queues[0] != NULL) {
-//     BaseType_t xHigherPriorityTaskWoken = pdFALSE;
-//     uint8_t dummy = 0;
-//     xQueueSendFromISR(&lora_queues[0], &dummy, &xHigherPriorityTaskWoken);
-//     portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
-//   }
+  BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+  if (LL_DMA_IsActiveFlag_TC1(LORA_PORT_UART_DMA)) {
+    LL_DMA_ClearFlag_TC1(LORA_PORT_UART_DMA);
+    lora_rx_laps++;
+    // IDLE 없이 링을 한 바퀴 채우는 연속 수신에서도 태스크를 깨운다
+    if (lora_queues[0] != NULL) {
+      uint8_t dummy = 0;
+      xQueueSendFromISR(lora_queues[0], &dummy, &xHigherPriorityTaskWoken);
+    }
+  }
+  LL_DMA_ClearFlag_TE1(LORA_PORT_UART_DMA);
+  LL_DMA_ClearFlag_FE1(LORA_PORT_UART_DMA);
+  LL_DMA_ClearFlag_DME1(LORA_PORT_UART_DMA);
+
+  portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
   /* USER CODE END DMA1_Stream1_IRQn 0 */
   /* USER CODE BEGIN DMA1_Stream1_IRQn 1 */
 
   /* USER CODE END DMA1_Stream1_IRQn 1 */
 }
 
+/**
+  * @brief This function handles DMA1 stream3 global interrupt (USART3_TX).
+  */
+void DMA1_Stream3_IRQHandler(void)
+{
+  uart_tx_irq_handler(&lora_uart3_tx);
+}
+
 
 int lora_port_init_instance(lora_t *lora_handle) {
   const board_config_t *config = board_get_config();
 
   LOG_INFO("LORA Port 초기화 시작 (보드: %d, GPS 타입: %s)",
            config->board, config->lora_mode == LORA_MODE_BASE ? "BASE" :
-                        (config->lora_mode == LORA_MODE_ROVER? "ROVER" : "NONE"));
+                        (config->lora_mode == LORA_MODE_ROVER? "ROVER" :
+                        (config->lora_mode == LORA_MODE_REPEATER? "REPEATER" : "NONE")));
+
+#if LORA_RADIO == LORA_RADIO_SX126X
+    lora_spi_radio.ops = &sx126x_ops;
+    lora_spi_radio.bus = &lora_spi_bus;
+#elif LORA_RADIO == LORA_RADIO_SX127X
+    lora_spi_radio.ops = &sx127x_ops;
+    lora_spi_radio.bus = &lora_spi_bus;
+#endif
+    lora_handle->radio = LORA_PORT_RADIO;
 
     if(config->lora_mode == LORA_MODE_BASE)
     {
-        lora_handle->ops = &lora_uart3_ops;
+        lora_handle->ops = LORA_PORT_OPS;
         if (lora_handle->ops->init) {
             lora_handle->ops->init();
         }
     }
-    else if(config->lora_mode == LORA_MODE_ROVER)
+    else if(config->lora_mode == LORA_MODE_ROVER || config->lora_mode == LORA_MODE_REPEATER)
     {
-        lora_handle->ops = &lora_uart3_ops;
+        lora_handle->ops = LORA_PORT_OPS;
         if (lora_handle->ops->init) {
             lora_handle->ops->init();
         }
@@ -303,6 +538,20 @@ uint32_t lora_port_get_rx_pos() {
   return pos;
 }
 
+uint32_t lora_port_get_rx_count(void) {
+  uint32_t laps;
+  uint32_t pos;
+  bool tc_pending;
+
+  do {
+    laps = lora_rx_laps;
+    pos = lora_port_get_rx_pos();
+    tc_pending = LL_DMA_IsActiveFlag_TC1(LORA_PORT_UART_DMA);
+  } while (laps != lora_rx_laps);
+
+  return dma_ring_count(laps, pos, tc_pending, sizeof(lora_recv_buf[0]));
+}
+
 char *lora_port_get_recv_buf() 
 {
   return lora_recv_buf[0];
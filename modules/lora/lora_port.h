@@ -7,10 +7,19 @@
 #include "lora.h"
 #include "board_config.h"
 
+/**
+ * @brief 모듈 기본 UART 속도 (전원 인가 직후, 속도 협상 실패 시)
+ */
+#define LORA_UART_BAUD_DEFAULT 115200
+
 int lora_port_init_instance(lora_t *lora_handle);
 void lora_port_start(lora_t *lora_handle);
 void lora_port_stop(lora_t *lora_handle);
 uint32_t lora_port_get_rx_pos();
+/**
+ * @brief RX DMA 가 지금까지 쓴 누적 byte 수 (dma_ring 용)
+ */
+uint32_t lora_port_get_rx_count(void);
 char *lora_port_get_recv_buf();
 void lora_port_set_queue(QueueHandle_t queue);
 
@@ -19,5 +28,6 @@ void lora_port_set_queue(QueueHandle_t queue);
 int lora_uart3_hw_init(void);
 int lora_uart3_comm_start(void);
 int lora_uart3_send(const char *data, size_t len);
+int lora_uart3_set_baudrate(uint32_t baudrate);
 
 #endif
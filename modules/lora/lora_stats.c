@@ -0,0 +1,374 @@
+#include "lora_stats.h"
+#include "lora_app.h"
+#include "board_config.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * @brief 통계와 진행 중 epoch 추적
+ *
+ * GPS 태스크(송신 fragment), LoRa TX 태스크(콜백), LoRa RX 태스크(수신),
+ * BLE/RS485 태스크(읽기)에서 오므로 짧은 critical section 안에서만 만진다.
+ */
+static struct
+{
+  lora_stats_t st;
+
+  // 로버: 받는 중인 epoch
+  bool in_epoch;
+  uint8_t seq;
+  uint8_t got;       // 받은 데이터 fragment
+  uint8_t max_idx;   // 받은 데이터 fragment 중 가장 큰 index
+  uint32_t closed;   // rx_expected 에 들어간 epoch 수
+} stats;
+
+static uint8_t stats_bin(int16_t v, int16_t min, int16_t step, uint8_t bins)
+{
+  if (v < min)
+  {
+    return 0;
+  }
+
+  int16_t bin = (v - min) / step + 1;
+  return bin >= bins ? bins - 1 : (uint8_t)bin;
+}
+
+/**
+ * @brief 받던 epoch 마감 (critical section 안)
+ *
+ * 받은 가장 큰 index 까지를 그 epoch 의 fragment 수로 본다.
+ * 뒤쪽 fragment 가 모두 빠진 경우는 세지 못하므로 전달률은 상한값이다.
+ */
+static void stats_epoch_close(void)
+{
+  if (!stats.in_epoch)
+  {
+    return;
+  }
+
+  uint32_t expected = (uint32_t)stats.max_idx + 1;
+  if (stats.got > 0)
+  {
+    stats.st.rx_expected += expected;
+    stats.st.rx_lost += expected - stats.got;
+    stats.closed++;
+  }
+  stats.in_epoch = false;
+}
+
+void lora_stats_tx_queued(bool queued, bool epoch_end)
+{
+  taskENTER_CRITICAL();
+  if (!queued)
+  {
+    stats.st.tx_full++;
+  }
+  else
+  {
+    stats.st.tx_queued++;
+    if (epoch_end)
+    {
+      stats.st.tx_epochs++;
+    }
+  }
+  taskEXIT_CRITICAL();
+}
+
+void lora_stats_tx_done(bool success)
+{
+  taskENTER_CRITICAL();
+  if (success)
+  {
+    stats.st.tx_sent++;
+  }
+  else
+  {
+    stats.st.tx_failed++;
+  }
+  taskEXIT_CRITICAL();
+}
+
+void lora_stats_tx_dropped(void)
+{
+  taskENTER_CRITICAL();
+  stats.st.tx_dropped++;
+  taskEXIT_CRITICAL();
+}
+
+void lora_stats_rx_frag(int16_t rssi, int16_t snr, const uint8_t *hdr)
+{
+  uint8_t seq = hdr[0];
+  bool parity = (hdr[1] & RTCM_FRAG_PARITY) != 0;
+  uint8_t idx = hdr[1] & RTCM_FRAG_IDX_MASK;
+
+  taskENTER_CRITICAL();
+  stats.st.rx_frags++;
+  stats.st.rssi_hist[stats_bin(rssi, LORA_STATS_RSSI_MIN, LORA_STATS_RSSI_STEP,
+                               LORA_STATS_RSSI_BINS)]++;
+  stats.st.snr_hist[stats_bin(snr, LORA_STATS_SNR_MIN, LORA_STATS_SNR_STEP,
+                              LORA_STATS_SNR_BINS)]++;
+
+  if (!stats.in_epoch || seq != stats.seq)
+  {
+    uint8_t gap = (uint8_t)(seq - stats.seq);
+
+    // 조금 건너뛴 seq 는 통째로 못 받은 epoch, 크게 튀면 베이스 재시작으로 보고 넘김
+    if (stats.st.rx_epochs > 0 && gap > 1 && gap < 16)
+    {
+      stats.st.rx_epochs_missed += gap - 1;
+    }
+    stats_epoch_close();
+    stats.in_epoch = true;
+    stats.seq = seq;
+    stats.got = 0;
+    stats.max_idx = 0;
+    stats.st.rx_epochs++;
+  }
+
+  if (parity)
+  {
+    stats.st.rx_parity++;
+  }
+  else
+  {
+    stats.got++;
+    if (idx > stats.max_idx)
+    {
+      stats.max_idx = idx;
+    }
+  }
+  taskEXIT_CRITICAL();
+}
+
+void lora_stats_rx_epoch_drop(void)
+{
+  taskENTER_CRITICAL();
+  stats.st.rx_epoch_drops++;
+  taskEXIT_CRITICAL();
+}
+
+void lora_stats_rx_dup(void)
+{
+  taskENTER_CRITICAL();
+  stats.st.rx_dups++;
+  taskEXIT_CRITICAL();
+}
+
+void lora_stats_rx_recovered(void)
+{
+  taskENTER_CRITICAL();
+  stats.st.rx_recovered++;
+  taskEXIT_CRITICAL();
+}
+
+void lora_stats_rx_timeout(void)
+{
+  taskENTER_CRITICAL();
+  stats.st.rx_timeouts++;
+  taskEXIT_CRITICAL();
+}
+
+void lora_stats_rx_overflow(void)
+{
+  taskENTER_CRITICAL();
+  stats.st.rx_overflows++;
+  taskEXIT_CRITICAL();
+}
+
+void lora_stats_rx_frame(uint16_t type, bool ok, bool crc_fail)
+{
+  taskENTER_CRITICAL();
+  if (!ok)
+  {
+    if (crc_fail)
+    {
+      stats.st.rx_crc_fail++;
+    }
+    else
+    {
+      stats.st.rx_invalid++;
+    }
+    taskEXIT_CRITICAL();
+    return;
+  }
+
+  uint8_t i = 0;
+  while (i < stats.st.type_cnt && stats.st.types[i].type != type)
+  {
+    i++;
+  }
+  if (i == stats.st.type_cnt && i < LORA_STATS_TYPES_MAX)
+  {
+    stats.st.types[i].type = type;
+    stats.st.types[i].count = 0;
+    stats.st.type_cnt++;
+  }
+  if (i < stats.st.type_cnt)
+  {
+    stats.st.types[i].count++;
+  }
+  taskEXIT_CRITICAL();
+}
+
+void lora_stats_get(lora_stats_t *out)
+{
+  if (!out)
+  {
+    return;
+  }
+
+  taskENTER_CRITICAL();
+  memcpy(out, &stats.st, sizeof(*out));
+  taskEXIT_CRITICAL();
+}
+
+void lora_stats_reset(void)
+{
+  taskENTER_CRITICAL();
+  memset(&stats, 0, sizeof(stats));
+  taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief a / b 를 소수 한 자리로 (b 가 0 이면 0.0)
+ */
+static void stats_ratio(uint32_t a, uint32_t b, uint32_t scale, uint32_t *ip, uint32_t *fp)
+{
+  uint32_t x10 = b ? (uint32_t)((uint64_t)a * scale * 10 / b) : 0;
+
+  *ip = x10 / 10;
+  *fp = x10 % 10;
+}
+
+size_t lora_stats_format(char *buf, size_t size)
+{
+  lora_stats_t st;
+  uint32_t closed;
+  uint32_t tx_fi, tx_ff, rx_fi, rx_ff, dr_i, dr_f;
+  size_t pos;
+  int n;
+
+  taskENTER_CRITICAL();
+  memcpy(&st, &stats.st, sizeof(st));
+  closed = stats.closed;
+  taskEXIT_CRITICAL();
+
+  // 베이스 epoch 당 fragment, 로버 epoch 당 예상 fragment
+  stats_ratio(st.tx_queued, st.tx_epochs, 1, &tx_fi, &tx_ff);
+  stats_ratio(st.rx_expected, closed, 1, &rx_fi, &rx_ff);
+  stats_ratio(st.rx_expected - st.rx_lost, st.rx_expected, 100, &dr_i, &dr_f);
+
+  n = snprintf(buf, size,
+               "+LTX,queued=%lu,sent=%lu,fail=%lu,full=%lu,drop=%lu,epochs=%lu,"
+               "fpe=%lu.%lu\n\r"
+               "+LRX,frags=%lu,parity=%lu,lost=%lu/%lu,dr=%lu.%lu%%,epochs=%lu,"
+               "missed=%lu,drop=%lu,fec=%lu,fpe=%lu.%lu,to=%lu,ovf=%lu,crc=%lu,"
+               "inv=%lu,dup=%lu\n\r",
+               st.tx_queued, st.tx_sent, st.tx_failed, st.tx_full, st.tx_dropped,
+               st.tx_epochs, tx_fi, tx_ff, st.rx_frags, st.rx_parity, st.rx_lost,
+               st.rx_expected, dr_i, dr_f, st.rx_epochs, st.rx_epochs_missed,
+               st.rx_epoch_drops, st.rx_recovered, rx_fi, rx_ff, st.rx_timeouts,
+               st.rx_overflows, st.rx_crc_fail, st.rx_invalid, st.rx_dups);
+  if (n < 0 || (size_t)n >= size)
+  {
+    return 0;
+  }
+  pos = n;
+
+  n = snprintf(&buf[pos], size - pos, "+LRSSI");
+  if (n < 0 || (size_t)n >= size - pos)
+  {
+    return 0;
+  }
+  pos += n;
+
+  for (uint8_t i = 0; i < LORA_STATS_RSSI_BINS; i++)
+  {
+    n = snprintf(&buf[pos], size - pos, ",%lu", st.rssi_hist[i]);
+    if (n < 0 || (size_t)n >= size - pos)
+    {
+      return 0;
+    }
+    pos += n;
+  }
+
+  n = snprintf(&buf[pos], size - pos, "\n\r+LSNR");
+  if (n < 0 || (size_t)n >= size - pos)
+  {
+    return 0;
+  }
+  pos += n;
+
+  for (uint8_t i = 0; i < LORA_STATS_SNR_BINS; i++)
+  {
+    n = snprintf(&buf[pos], size - pos, ",%lu", st.snr_hist[i]);
+    if (n < 0 || (size_t)n >= size - pos)
+    {
+      return 0;
+    }
+    pos += n;
+  }
+
+  n = snprintf(&buf[pos], size - pos, "\n\r+LTYPE");
+  if (n < 0 || (size_t)n >= size - pos)
+  {
+    return 0;
+  }
+  pos += n;
+
+  for (uint8_t i = 0; i < st.type_cnt; i++)
+  {
+    n = snprintf(&buf[pos], size - pos, ",%u=%lu", st.types[i].type, st.types[i].count);
+    if (n < 0 || (size_t)n >= size - pos)
+    {
+      return 0;
+    }
+    pos += n;
+  }
+
+  n = snprintf(&buf[pos], size - pos, st.type_cnt ? "\n\r" : ",none\n\r");
+  if (n < 0 || (size_t)n >= size - pos)
+  {
+    return 0;
+  }
+  pos += n;
+
+  if (board_get_config()->lora_mode == LORA_MODE_REPEATER)
+  {
+    lora_relay_status_t rl;
+
+    lora_relay_get_status(&rl);
+    n = snprintf(&buf[pos], size - pos,
+                 "+LRLY,slot=%u,epochs=%lu,frags=%lu,skip=%lu,miss=%lu,ovf=%lu,dup=%lu,"
+                 "stale=%lu\n\r",
+                 rl.slot, rl.epochs, rl.frags, rl.skipped, rl.missed, rl.overflows,
+                 rl.dups, rl.stale);
+    if (n < 0 || (size_t)n >= size - pos)
+    {
+      return 0;
+    }
+    pos += n;
+  }
+
+  lora_mode_t mode = board_get_config()->lora_mode;
+  if (mode == LORA_MODE_BASE || mode == LORA_MODE_REPEATER)
+  {
+    lora_reg_status_t rg;
+
+    lora_reg_get_status(&rg);
+    n = snprintf(&buf[pos], size - pos,
+                 "+LREG,lbt=%u,tx=%lu,toa=%lu,hour=%lu,cont=%lu,guard=%lu,busy=%lu,fail=%lu,"
+                 "hlim=%lu\n\r",
+                 rg.lbt, rg.tx, rg.toa_ms, rg.hour_ms, rg.cont_max_ms, rg.guard_waits,
+                 rg.lbt_busy, rg.lbt_fail, rg.hour_limited);
+    if (n < 0 || (size_t)n >= size - pos)
+    {
+      return 0;
+    }
+    pos += n;
+  }
+
+  return pos;
+}
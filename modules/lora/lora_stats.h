@@ -0,0 +1,135 @@
+#ifndef LORA_STATS_H
+#define LORA_STATS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief 타입별 RTCM 프레임 수를 세는 최대 타입 수 (넘치는 타입은 무시)
+ */
+#define LORA_STATS_TYPES_MAX 16
+
+/**
+ * @brief RSSI 히스토그램 구간 (dBm): <-120, -120~-111, ..., -90~-81, >=-80
+ */
+#define LORA_STATS_RSSI_BINS 6
+#define LORA_STATS_RSSI_MIN (-120)
+#define LORA_STATS_RSSI_STEP 10
+
+/**
+ * @brief SNR 히스토그램 구간 (dB): <-15, -15~-11, ..., 0~4, >=5
+ */
+#define LORA_STATS_SNR_BINS 6
+#define LORA_STATS_SNR_MIN (-15)
+#define LORA_STATS_SNR_STEP 5
+
+typedef struct
+{
+  uint16_t type;
+  uint32_t count;
+} lora_stats_type_t;
+
+/**
+ * @brief LoRa 보정 데이터 경로 통계
+ */
+typedef struct
+{
+  // 베이스 (rtcm_send_to_lora), 중계기 (중계 송신)
+  uint32_t tx_queued;      /**< 큐에 넣은 fragment (패리티 포함) */
+  uint32_t tx_sent;        /**< 모듈이 OK 한 fragment */
+  uint32_t tx_failed;      /**< ERROR/타임아웃 fragment */
+  uint32_t tx_full;        /**< 큐가 차서 못 넣은 fragment */
+  uint32_t tx_dropped;     /**< 큐/점유 예산이 모자라 보내지 않은 RTCM 프레임 */
+  uint32_t tx_epochs;      /**< 마지막 fragment 까지 넣은 epoch */
+
+  // 로버
+  uint32_t rx_frags;       /**< 받은 fragment (패리티 포함) */
+  uint32_t rx_parity;      /**< 그 중 패리티 */
+  uint32_t rx_expected;    /**< 끝난 epoch 들의 데이터 fragment 수 (index 로 추정) */
+  uint32_t rx_lost;        /**< 그 중 받지 못한 fragment */
+  uint32_t rx_epochs;      /**< fragment 를 하나라도 받은 epoch */
+  uint32_t rx_epochs_missed; /**< seq 가 건너뛴 epoch (fragment 하나도 없음) */
+  uint32_t rx_epoch_drops; /**< 재조립하지 못하고 버린 epoch */
+  uint32_t rx_recovered;   /**< 패리티로 복원한 fragment */
+  uint32_t rx_timeouts;    /**< 재조립 타임아웃 */
+  uint32_t rx_overflows;   /**< 재조립 버퍼 넘침, 잘못된 길이 */
+  uint32_t rx_crc_fail;    /**< rtcm_validate_packet CRC 실패 */
+  uint32_t rx_invalid;     /**< preamble/길이 불일치 */
+  uint32_t rx_dups;        /**< 중계로 두 번 들은 fragment, 늦은 사본 */
+  uint32_t rssi_hist[LORA_STATS_RSSI_BINS];
+  uint32_t snr_hist[LORA_STATS_SNR_BINS];
+  uint8_t type_cnt;
+  lora_stats_type_t types[LORA_STATS_TYPES_MAX];
+} lora_stats_t;
+
+/**
+ * @brief 베이스: fragment 하나 큐 추가 결과
+ *
+ * @param queued false 면 큐가 차서 못 넣음
+ * @param epoch_end epoch 마지막 데이터 fragment
+ */
+void lora_stats_tx_queued(bool queued, bool epoch_end);
+
+/**
+ * @brief 베이스: 큐에 넣었던 fragment 송신 결과 (LoRa TX 콜백)
+ */
+void lora_stats_tx_done(bool success);
+
+/**
+ * @brief 베이스: 큐/점유 예산이 모자라 RTCM 프레임을 버림
+ */
+void lora_stats_tx_dropped(void);
+
+/**
+ * @brief 로버: RTCM fragment 수신
+ *
+ * @param rssi dBm
+ * @param snr dB
+ * @param hdr fragment 헤더 (RTCM_FRAG_HDR_SIZE 바이트)
+ */
+void lora_stats_rx_frag(int16_t rssi, int16_t snr, const uint8_t *hdr);
+
+void lora_stats_rx_epoch_drop(void);
+void lora_stats_rx_recovered(void);
+void lora_stats_rx_timeout(void);
+void lora_stats_rx_overflow(void);
+
+/**
+ * @brief 로버/중계기: 이미 받은 fragment 라 버림
+ */
+void lora_stats_rx_dup(void);
+
+/**
+ * @brief 로버: 재조립한 RTCM 프레임 검증 결과
+ *
+ * @param type 메시지 타입 (ok 일 때만)
+ * @param ok true: CRC 통과
+ * @param crc_fail ok 가 false 일 때 CRC 불일치였는지 (아니면 preamble/길이)
+ */
+void lora_stats_rx_frame(uint16_t type, bool ok, bool crc_fail);
+
+void lora_stats_get(lora_stats_t *out);
+void lora_stats_reset(void);
+
+/**
+ * @brief 응답 문자열
+ *
+ * +LTX,queued=<n>,sent=<n>,fail=<n>,full=<n>,drop=<n>,epochs=<n>,fpe=<x.x>
+ * +LRX,frags=<n>,parity=<n>,lost=<n>/<예상>,dr=<x.x>%,epochs=<n>,missed=<n>,
+ *      drop=<n>,fec=<n>,fpe=<x.x>,to=<n>,ovf=<n>,crc=<n>,inv=<n>,dup=<n>
+ * +LRSSI,<구간별 수 (약한 쪽부터)>
+ * +LSNR,<구간별 수 (낮은 쪽부터)>
+ * +LTYPE,<타입>=<수>,...
+ * +LRLY,slot=<n>,epochs=<n>,frags=<n>,skip=<n>,miss=<n>,ovf=<n>,dup=<n>,stale=<n>
+ *      (중계기 보드만)
+ * +LREG,lbt=<0|1>,tx=<n>,toa=<ms>,hour=<ms>,cont=<ms>,guard=<n>,busy=<n>,fail=<n>,hlim=<n>
+ *      (송신하는 base/중계기 보드만, lora_reg_status_t)
+ *
+ * @param[out] buf
+ * @param[in] size
+ * @return size_t 문자열 길이 (0 이면 버퍼 부족)
+ */
+size_t lora_stats_format(char *buf, size_t size);
+
+#endif
@@ -0,0 +1,545 @@
+#include "rtcm_reassembly.h"
+#include "rtcm.h"
+#include "rtcm_router.h"
+#include "lora_stats.h"
+#include "mem_watermark.h"
+#include "simd.h"
+#include <string.h>
+#include <stdlib.h>
+
+#ifndef TAG
+#define TAG "LORA_APP"
+#endif
+
+#include "log.h"
+
+static mem_wm_t lora_reasm_wm = MEM_WM_INIT("lora_reasm", RTCM_REASSEMBLY_BUF_SIZE);
+
+void rtcm_reassembly_init(void)
+{
+  mem_wm_register(&lora_reasm_wm);
+}
+
+/**
+ * @brief RTCM 패킷 검증 (헤더 및 CRC)
+ *
+ * @param buffer RTCM 패킷 버퍼
+ * @param len 패킷 전체 길이
+ * @return true: 유효, false: 무효
+ */
+static bool rtcm_validate_packet(const uint8_t *buffer, size_t len)
+{
+  // 최소 길이 확인 (preamble 1 + reserved+len 2 + CRC 3 = 6 bytes)
+  if (len < 6)
+  {
+    LOG_ERR("RTCM packet too short: %d bytes", len);
+    lora_stats_rx_frame(0, false, false);
+    return false;
+  }
+
+  // Preamble 확인
+  if (buffer[0] != 0xD3)
+  {
+    LOG_ERR("Invalid RTCM preamble: 0x%02X (expected 0xD3)", buffer[0]);
+    lora_stats_rx_frame(0, false, false);
+    return false;
+  }
+
+  // Length 파싱 (10 bits, bytes 1-2)
+  uint16_t payload_len = ((buffer[1] & 0x03) << 8) | buffer[2];
+  uint16_t expected_total_len = 3 + payload_len + 3; // header(3) + payload + CRC(3)
+
+  if (len != expected_total_len)
+  {
+    LOG_ERR("RTCM length mismatch: got %d, expected %d (payload=%d)",
+            len, expected_total_len, payload_len);
+    lora_stats_rx_frame(0, false, false);
+    return false;
+  }
+
+  // CRC24Q 검증
+  uint32_t calculated_crc = rtcm_crc24q_update(0, buffer, len - 3);
+  uint32_t received_crc = ((uint32_t)buffer[len - 3] << 16) |
+                          ((uint32_t)buffer[len - 2] << 8) |
+                          buffer[len - 1];
+
+  if (calculated_crc != received_crc)
+  {
+    LOG_ERR("RTCM CRC mismatch: calculated 0x%06X, received 0x%06X",
+            calculated_crc, received_crc);
+    lora_stats_rx_frame(0, false, true);
+    return false;
+  }
+
+  // 타입 12비트 (payload 앞, 타입도 없는 빈 메시지는 0)
+  uint16_t msg_type = payload_len >= 2 ? ((uint16_t)buffer[3] << 4) | (buffer[4] >> 4) : 0;
+  lora_stats_rx_frame(msg_type, true, false);
+
+  LOG_INFO("RTCM packet valid: len=%d, payload=%d, CRC=0x%06X",
+           len, payload_len, received_crc);
+  return true;
+}
+
+/**
+ * @brief RTCM fragment 재조립 버퍼 초기화
+ */
+void rtcm_reassembly_reset(rtcm_reassembly_t *reasm)
+{
+  reasm->buffer_pos = 0;
+  reasm->expected_len = 0;
+  reasm->has_header = false;
+  reasm->last_recv_tick = 0;
+}
+
+/**
+ * @brief RTCM fragment 처리 및 재조립 (개선된 버전)
+ *
+ * - Preamble(0xD3) 자동 탐색
+ * - 완료 후 남은 데이터 자동 보존
+ *
+ * @param reasm 재조립 버퍼
+ * @param data 수신된 fragment 데이터
+ * @param len fragment 길이
+ * @return true: 완전한 RTCM 패킷 재조립 완료, false: 더 많은 fragment 필요
+ */
+static bool rtcm_reassembly_process(rtcm_reassembly_t *reasm, const uint8_t *data, size_t len)
+{
+  TickType_t current_tick = xTaskGetTickCount();
+
+  // 타임아웃 체크 (마지막 수신 후 5초 경과 시 초기화)
+  if (reasm->buffer_pos > 0 && reasm->last_recv_tick > 0)
+  {
+    TickType_t elapsed_ms = (current_tick - reasm->last_recv_tick) * 1000 / configTICK_RATE_HZ;
+    if (elapsed_ms > RTCM_REASSEMBLY_TIMEOUT_MS)
+    {
+      LOG_WARN("RTCM reassembly timeout - resetting buffer");
+      lora_stats_rx_timeout();
+      rtcm_reassembly_reset(reasm);
+    }
+  }
+
+  // 버퍼 오버플로우 체크
+  if (reasm->buffer_pos + len > RTCM_REASSEMBLY_BUF_SIZE)
+  {
+    LOG_ERR("RTCM reassembly buffer overflow - resetting");
+    lora_stats_rx_overflow();
+    mem_wm_update(&lora_reasm_wm, RTCM_REASSEMBLY_BUF_SIZE);
+    rtcm_reassembly_reset(reasm);
+    return false;
+  }
+
+  // Fragment 데이터 추가 (len 0 이면 남아 있던 데이터만 다시 파싱)
+  if (len > 0)
+  {
+    if (reasm->buffer_pos == 0)
+    {
+      reasm->frame_tick = current_tick;
+    }
+    memcpy(&reasm->buffer[reasm->buffer_pos], data, len);
+    reasm->buffer_pos += len;
+    reasm->last_recv_tick = current_tick;
+    mem_wm_update(&lora_reasm_wm, reasm->buffer_pos);
+
+    LOG_INFO("RTCM fragment received: %d bytes, total: %d bytes", len, reasm->buffer_pos);
+  }
+
+  // 헤더가 없으면 Preamble 스캔
+  if (!reasm->has_header)
+  {
+    // 0xD3(Preamble)를 찾을 때까지 스캔
+    size_t preamble_pos = 0;
+    bool found = false;
+
+    for (size_t i = 0; i < reasm->buffer_pos; i++)
+    {
+      if (reasm->buffer[i] == 0xD3)
+      {
+        preamble_pos = i;
+        found = true;
+        LOG_INFO("RTCM preamble found at offset %d", i);
+        break;
+      }
+    }
+
+    if (!found)
+    {
+      // Preamble을 못 찾으면 마지막 바이트만 남기고 버림
+      // (다음 fragment에서 0xD3가 올 수 있음)
+      if (reasm->buffer_pos > 1)
+      {
+        LOG_WARN("No preamble found, keeping last byte");
+        reasm->buffer[0] = reasm->buffer[reasm->buffer_pos - 1];
+        reasm->buffer_pos = 1;
+      }
+      return false;
+    }
+
+    // Preamble이 중간에 있으면 앞으로 이동
+    if (preamble_pos > 0)
+    {
+      LOG_INFO("Moving preamble from offset %d to start", preamble_pos);
+      memmove(reasm->buffer, &reasm->buffer[preamble_pos], reasm->buffer_pos - preamble_pos);
+      reasm->buffer_pos -= preamble_pos;
+    }
+
+    // 헤더 파싱 시도 (최소 3바이트 필요: preamble + reserved+len)
+    if (reasm->buffer_pos >= 3)
+    {
+      // Payload 길이 파싱 (10 bits)
+      uint16_t payload_len = ((reasm->buffer[1] & 0x03) << 8) | reasm->buffer[2];
+      reasm->expected_len = 3 + payload_len + 3; // header(3) + payload + CRC(3)
+      reasm->has_header = true;
+
+      LOG_INFO("RTCM header parsed: payload=%d bytes, expected total=%d bytes",
+               payload_len, reasm->expected_len);
+
+      // 예상 길이가 비정상적으로 크면 리셋
+      if (reasm->expected_len > RTCM_REASSEMBLY_BUF_SIZE)
+      {
+        LOG_ERR("Invalid RTCM length: %d > %d - resetting",
+                reasm->expected_len, RTCM_REASSEMBLY_BUF_SIZE);
+        lora_stats_rx_overflow();
+        rtcm_reassembly_reset(reasm);
+        return false;
+      }
+    }
+  }
+
+  // 완전한 패킷 수신 체크
+  if (reasm->has_header && reasm->buffer_pos >= reasm->expected_len)
+  {
+    LOG_INFO("RTCM packet reassembly complete: %d bytes (buffer has %d bytes)",
+             reasm->expected_len, reasm->buffer_pos);
+    return true;
+  }
+
+  // 더 많은 fragment 필요
+  return false;
+}
+
+/**
+ * @brief 순서가 맞는 fragment 데이터를 RTCM 스트림에 붙이고 완성된 패킷을 모두 GPS로 전송
+ *
+ * 기준국이 한 epoch 의 메시지를 이어 붙여 보내므로 fragment 하나에
+ * 여러 패킷이 끝날 수 있다. CRC 가 틀리면 1바이트만 버리고 다시 preamble 을 찾는다.
+ *
+ * @param reasm 재조립 버퍼
+ * @param data fragment 데이터 (헤더 제외)
+ * @param len 데이터 길이
+ * @param last epoch 마지막 fragment 여부
+ */
+static void rtcm_reassembly_feed(rtcm_reassembly_t *reasm, const uint8_t *data, size_t len,
+                                 bool last)
+{
+  bool complete = rtcm_reassembly_process(reasm, data, len);
+
+  while (complete)
+  {
+    size_t consumed = reasm->expected_len;
+
+    // 완전한 RTCM 패킷 수신 - 검증 후 GPS로 전송
+    if (rtcm_validate_packet(reasm->buffer, reasm->expected_len))
+    {
+      LOG_INFO("Valid RTCM packet - routing to GPS");
+
+      rtcm_router_input_frame(RTCM_SRC_LORA, reasm->buffer, reasm->expected_len,
+                              reasm->frame_tick);
+    }
+    else
+    {
+      LOG_ERR("Invalid RTCM packet - resync");
+      consumed = 1;
+    }
+
+    // 남은 데이터 처리 (다음 RTCM 패킷의 시작일 수 있음)
+    if (reasm->buffer_pos <= consumed)
+    {
+      rtcm_reassembly_reset(reasm);
+      break;
+    }
+
+    size_t remaining = reasm->buffer_pos - consumed;
+    LOG_DEBUG("Remaining %d bytes in buffer - moving to front", remaining);
+
+    memmove(reasm->buffer, &reasm->buffer[consumed], remaining);
+    reasm->buffer_pos = remaining;
+    reasm->frame_tick = reasm->last_recv_tick;
+    reasm->has_header = false;
+    reasm->expected_len = 0;
+
+    complete = rtcm_reassembly_process(reasm, NULL, 0);
+  }
+
+  reasm->next_idx++;
+
+  if (last)
+  {
+    // epoch 이 끝났는데 남은 바이트는 완성될 수 없는 조각
+    rtcm_reassembly_reset(reasm);
+    reasm->in_epoch = false;
+    reasm->epoch_closed = true;
+  }
+}
+
+/**
+ * @brief 현재 epoch 의 나머지를 버리고 다음 epoch 을 기다림
+ */
+static void rtcm_reassembly_drop_epoch(rtcm_reassembly_t *reasm, const char *reason)
+{
+  reasm->dropped_epochs++;
+  lora_stats_rx_epoch_drop();
+  LOG_WARN("RTCM epoch %d dropped at fragment %d: %s (total %lu)",
+           reasm->seq, reasm->next_idx, reason, reasm->dropped_epochs);
+
+  rtcm_reassembly_reset(reasm);
+  reasm->in_epoch = false;
+  reasm->epoch_closed = true;
+}
+
+/**
+ * @brief 창에 있는 fragment 를 next_idx 부터 순서대로 이어 붙임
+ */
+static void rtcm_reassembly_drain(rtcm_reassembly_t *reasm)
+{
+  while (reasm->in_epoch)
+  {
+    uint8_t slot = reasm->next_idx % RTCM_FEC_MAX_GROUP;
+
+    if (!(reasm->win_mask & (1U << slot)) || reasm->win_idx[slot] != reasm->next_idx)
+    {
+      break;
+    }
+
+    rtcm_reassembly_feed(reasm, reasm->win[slot], reasm->win_len[slot], reasm->win_last[slot]);
+  }
+}
+
+/**
+ * @brief 창에 fragment idx 가 있는지
+ */
+static bool rtcm_reassembly_has(const rtcm_reassembly_t *reasm, uint8_t idx)
+{
+  uint8_t slot = idx % RTCM_FEC_MAX_GROUP;
+
+  return (reasm->win_mask & (1U << slot)) && reasm->win_idx[slot] == idx;
+}
+
+/**
+ * @brief 패리티 fragment 로 빠진 fragment 하나 복원
+ *
+ * 다음에 와야 할 fragment 가 이 그룹 안에 있고 나머지가 모두 창에 있으면
+ * XOR 로 되살려 이어 붙인다. 둘 이상 빠졌으면 epoch 을 버린다.
+ *
+ * @param reasm 재조립 버퍼
+ * @param p 패리티 payload (헤더 제외)
+ * @param len payload 길이
+ */
+static void rtcm_reassembly_recover(rtcm_reassembly_t *reasm, const uint8_t *p, size_t len)
+{
+  if (len <= 3 || len - 3 > RTCM_FEC_DATA_SIZE)
+  {
+    LOG_WARN("RTCM parity length invalid: %d", len);
+    return;
+  }
+
+  uint8_t first = p[0];
+  uint8_t cnt = p[1] & 0x7F;
+  bool group_last = (p[1] & RTCM_FRAG_LAST) != 0;
+  uint8_t last_len = p[2];
+  size_t cap = len - 3;
+  uint8_t end = first + cnt;
+
+  if (cnt == 0 || cnt > RTCM_FEC_MAX_GROUP || last_len > cap)
+  {
+    LOG_WARN("RTCM parity header invalid: first=%d cnt=%d", first, cnt);
+    return;
+  }
+
+  uint8_t missing = reasm->next_idx;
+
+  if (missing >= end)
+  {
+    return;  // 그룹 전부 받음
+  }
+
+  if (missing < first)
+  {
+    rtcm_reassembly_drop_epoch(reasm, "previous group incomplete");
+    return;
+  }
+
+  uint8_t rebuilt[RTCM_FEC_DATA_SIZE];
+  memcpy(rebuilt, &p[3], cap);
+
+  for (uint8_t i = first; i < end; i++)
+  {
+    if (i == missing)
+    {
+      continue;
+    }
+
+    if (!rtcm_reassembly_has(reasm, i))
+    {
+      rtcm_reassembly_drop_epoch(reasm, "2+ fragments lost in group");
+      return;
+    }
+
+    uint8_t slot = i % RTCM_FEC_MAX_GROUP;
+    for (size_t k = 0; k < reasm->win_len[slot] && k < cap; k++)
+    {
+      rebuilt[k] ^= reasm->win[slot][k];
+    }
+  }
+
+  bool is_group_last = (missing == end - 1);
+  size_t rebuilt_len = is_group_last ? last_len : cap;
+
+  reasm->recovered++;
+  lora_stats_rx_recovered();
+  LOG_INFO("RTCM fragment %d/%d recovered by parity (total %lu)",
+           reasm->seq, missing, reasm->recovered);
+
+  rtcm_reassembly_feed(reasm, rebuilt, rebuilt_len, is_group_last && group_last);
+  rtcm_reassembly_drain(reasm);
+}
+
+/**
+ * @brief 수신 fragment 를 epoch 순서에 맞춰 재조립
+ *
+ * fragment 헤더의 seq/index 로 순서를 맞추고, 앞 fragment 가 빠지면 뒤에 온 것은
+ * 창(RTCM_FEC_MAX_GROUP)에 잠시 둔다. 패리티로 복원되면 이어 붙이고,
+ * 복원할 수 없으면 그 epoch 의 나머지만 버린 뒤 다음 epoch 에서 다시 시작한다.
+ * 이미 완성된 패킷은 보낸 뒤다.
+ *
+ * @param reasm 재조립 버퍼
+ * @param data 수신된 fragment (헤더 포함)
+ * @param len fragment 길이
+ */
+void rtcm_reassembly_deliver(rtcm_reassembly_t *reasm, const uint8_t *data, size_t len)
+{
+  if (len <= RTCM_FRAG_HDR_SIZE)
+  {
+    LOG_WARN("RTCM fragment too short: %d bytes", len);
+    return;
+  }
+
+  uint8_t seq = data[0];
+  const uint8_t *payload = &data[RTCM_FRAG_HDR_SIZE];
+  size_t payload_len = len - RTCM_FRAG_HDR_SIZE;
+
+  if (seq != reasm->seq || (!reasm->in_epoch && !reasm->epoch_closed))
+  {
+    // 새 epoch. fragment 0 이 빠졌어도 패리티로 복원될 수 있으니 바로 시작한다.
+    if (reasm->in_epoch)
+    {
+      rtcm_reassembly_drop_epoch(reasm, "next epoch started");
+    }
+    rtcm_reassembly_reset(reasm);
+    reasm->in_epoch = true;
+    reasm->epoch_closed = false;
+    reasm->seq = seq;
+    reasm->next_idx = 0;
+    reasm->win_mask = 0;
+  }
+
+  if (!reasm->in_epoch)
+  {
+    return;  // 이미 끝났거나 버린 epoch
+  }
+
+  if (data[1] & RTCM_FRAG_PARITY)
+  {
+    rtcm_reassembly_recover(reasm, payload, payload_len);
+    return;
+  }
+
+  uint8_t idx = data[1] & RTCM_FRAG_IDX_MASK;
+  bool last = (data[1] & RTCM_FRAG_LAST) != 0;
+
+  if (idx < reasm->next_idx)
+  {
+    return;  // 이미 이어 붙인 fragment
+  }
+
+  if (idx - reasm->next_idx >= RTCM_FEC_MAX_GROUP || payload_len > RTCM_FRAG_DATA_SIZE)
+  {
+    rtcm_reassembly_drop_epoch(reasm, "fragment lost");
+    return;
+  }
+
+  // 패리티 복원에 같은 그룹의 나머지가 필요하므로 이어 붙인 fragment 도 보관한다.
+  // 그룹은 RTCM_FEC_MAX_GROUP 이하라서 아직 필요한 slot 이 덮이지 않는다.
+  uint8_t slot = idx % RTCM_FEC_MAX_GROUP;
+  memcpy(reasm->win[slot], payload, payload_len);
+  reasm->win_len[slot] = (uint8_t)payload_len;
+  reasm->win_last[slot] = last;
+  reasm->win_idx[slot] = idx;
+  reasm->win_mask |= (1U << slot);
+
+  // 앞 fragment 가 빠졌으면 패리티가 올 때까지 기다림
+  rtcm_reassembly_drain(reasm);
+}
+
+/**
+ * @brief AT+RECV 응답 파싱
+ *
+ * Format: at+recv=<RSSI>,<SNR>,<Data Length>:<Data>
+ * Example: at+recv=-50,10,5:48656C6C6F
+ *
+ * @param line LORA_LINE_RECV 로 분류된 한 줄 (접두어로 시작)
+ * @param recv_data 출력 구조체
+ * @return true: 파싱 성공, false: 파싱 실패
+ */
+bool lora_parse_p2p_recv(const char *line, lora_p2p_recv_data_t *recv_data)
+{
+  const char *start = line + LORA_RECV_PREFIX_LEN; // "at+recv=" 건너뛰기
+
+  // RSSI 파싱
+  char *end = NULL;
+  recv_data->rssi = (int16_t)strtol(start, &end, 10);
+  if (!end || *end != ',')
+  {
+    return false;
+  }
+
+  // SNR 파싱
+  start = end + 1;
+  recv_data->snr = (int16_t)strtol(start, &end, 10);
+  if (!end || *end != ',')
+  {
+    return false;
+  }
+
+  // Data Length 파싱
+  start = end + 1;
+  recv_data->data_len = (uint16_t)strtol(start, &end, 10);
+  if (!end || *end != ':')
+  {
+    return false;
+  }
+
+  // Data 파싱 (HEX string)
+  start = end + 1;
+
+  // 데이터 길이 확인
+  if (recv_data->data_len > sizeof(recv_data->data) - 1)
+  {
+    LOG_ERR("P2P recv data too long: %d bytes", recv_data->data_len);
+    return false;
+  }
+
+  // HEX string을 바이너리로 변환
+  if (strlen(start) < 2 * (size_t)recv_data->data_len ||
+      simd_hex_decode((uint8_t *)recv_data->data, start, recv_data->data_len) !=
+          recv_data->data_len)
+  {
+    LOG_ERR("P2P recv: invalid HEX data (len=%d)", recv_data->data_len);
+    return false;
+  }
+  recv_data->data[recv_data->data_len] = '\0';
+
+  LOG_INFO("P2P recv: RSSI=%d, SNR=%d, Len=%d",
+           recv_data->rssi, recv_data->snr, recv_data->data_len);
+
+  return true;
+}
@@ -0,0 +1,45 @@
+#ifndef RTCM_REASSEMBLY_H
+#define RTCM_REASSEMBLY_H
+
+#include "lora_app.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * 로버 RTCM 수신 경로: at+recv 줄 파싱 -> fragment 재조립 (FEC 복원)
+ * -> RTCM 프레임 검증 -> rtcm_router_input_frame(RTCM_SRC_LORA)
+ *
+ * lora_app.c 의 RX 태스크가 쓰고, 호스트 벤치가 같은 코드로 기준국 ->
+ * 로버 전체 경로를 재생할 수 있게 따로 둔다.
+ */
+
+#define LORA_RECV_PREFIX_LEN 8  // "at+recv=" / "AT+RECV="
+
+/**
+ * @brief 재조립 버퍼 사용량 기록 등록 (lora_app 초기화 때 한 번)
+ */
+void rtcm_reassembly_init(void);
+
+/**
+ * @brief RTCM fragment 재조립 버퍼 초기화
+ */
+void rtcm_reassembly_reset(rtcm_reassembly_t *reasm);
+
+/**
+ * @brief 수신 fragment (헤더 포함) 를 epoch 순서에 맞춰 재조립
+ *
+ * 완성된 RTCM 프레임은 검증 후 rtcm_router_input_frame() 으로 넘긴다.
+ */
+void rtcm_reassembly_deliver(rtcm_reassembly_t *reasm, const uint8_t *data, size_t len);
+
+/**
+ * @brief AT+RECV 응답 파싱 (at+recv=<RSSI>,<SNR>,<Data Length>:<HEX>)
+ *
+ * @param line LORA_RECV_PREFIX_LEN 접두어로 시작하는 한 줄
+ * @param recv_data 출력 구조체
+ * @return true: 파싱 성공
+ */
+bool lora_parse_p2p_recv(const char *line, lora_p2p_recv_data_t *recv_data);
+
+#endif
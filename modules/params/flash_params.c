@@ -1,5 +1,9 @@
+#include <stdbool.h>
+#include <stddef.h>
 #include <string.h>
 #include "flash_params.h"
+#include "crc.h"
+#include "rtos_static.h"
 
 #ifndef TAG
     #define TAG "FLASH_PARAMS"
@@ -8,9 +12,138 @@
 #include "log.h"
 
 #define FLASH_MAGIC_NUMBER 0xAA55AA55U
-#define FLASH_USER_PARAMS_SECTOR  FLASH_SECTOR_11
-#define FLASH_USER_START_ADDR    0x080E0000U
 
+/*
+ * 파라미터 로그 (sector 10, 11 을 번갈아 씀)
+ *
+ * 섹터 머리말: [seq][PARAMS_LOG_MAGIC], 그 뒤로 레코드를 이어 붙인다.
+ * 레코드: [key | len << 8 | crc16 << 16][data (len, word 단위로 채움)]
+ * 저장할 때는 바뀐 필드만 레코드로 덧붙이고, 섹터가 차면 다른 섹터를 지우고
+ * RAM 의 전체 값을 옮겨 쓴 뒤 머리말을 마지막에 써서 넘어간다 (compaction).
+ * 같은 key 는 나중 레코드가 이긴다. 쓰다 끊긴 레코드는 CRC 로 걸러진다.
+ */
+#define PARAMS_LOG_MAGIC 0x50524D4CU // "LMRP"
+#define PARAMS_LOG_SECTOR_SIZE 0x20000U
+#define PARAMS_LOG_HDR_SIZE 8U
+#define PARAMS_LOG_ERASED 0xFFFFFFFFU
+
+// 이전 버전 (sector 11 에 user_params_t 통째로) 위치, 처음 부팅 때 옮겨 옴
+#define FLASH_LEGACY_ADDR 0x080E0000U
+
+static const struct
+{
+    uint32_t addr;
+    uint32_t sector;
+} params_log_sectors[2] = {
+    {0x080C0000U, FLASH_SECTOR_10},
+    {0x080E0000U, FLASH_SECTOR_11},
+};
+
+/* 레코드 key (flash 에 남으므로 번호를 바꾸거나 재사용하지 않는다, 새 필드는 끝에) */
+typedef enum
+{
+    PARAM_KEY_NTRIP_URL = 1,
+    PARAM_KEY_NTRIP_PORT,
+    PARAM_KEY_NTRIP_ID,
+    PARAM_KEY_NTRIP_PW,
+    PARAM_KEY_NTRIP_MOUNTPOINT,
+    PARAM_KEY_BOOT_LTE,
+    PARAM_KEY_BOOT_LORA,
+    PARAM_KEY_USE_MANUAL_POSITION,
+    PARAM_KEY_LAT,
+    PARAM_KEY_LON,
+    PARAM_KEY_ALT,
+    PARAM_KEY_BASELINE_LEN,
+    PARAM_KEY_BLE_DEVICE_NAME,
+    PARAM_KEY_BASE_AUTO_FIX,
+    PARAM_KEY_POS_OUTPUT_FORMAT,
+    PARAM_KEY_NTRIP2_URL,
+    PARAM_KEY_NTRIP2_PORT,
+    PARAM_KEY_NTRIP2_MOUNTPOINT,
+    PARAM_KEY_LORA_TDMA_SLOT,
+    PARAM_KEY_LORA_TDMA_SLOTS,
+    PARAM_KEY_POS_OUTPUT_DECIM,
+    PARAM_KEY_MODBUS_ADDR,
+    PARAM_KEY_GPS_BAUD,
+    PARAM_KEY_BASE_SURVEY,
+    PARAM_KEY_NAV_RATE,
+    PARAM_KEY_POS_LATENCY_COMP,
+    PARAM_KEY_GPS_TEE,
+    PARAM_KEY_BLE_MODULE,
+    PARAM_KEY_NTRIP_SRV_URL,
+    PARAM_KEY_NTRIP_SRV_PORT,
+    PARAM_KEY_NTRIP_SRV_MOUNTPOINT,
+    PARAM_KEY_NTRIP_SRV_USER,
+    PARAM_KEY_NTRIP_SRV_PW,
+    PARAM_KEY_TELEMETRY_URL,
+    PARAM_KEY_TELEMETRY_PORT,
+    PARAM_KEY_TELEMETRY_INTERVAL,
+    PARAM_KEY_TRACK_INTERVAL,
+    PARAM_KEY_GPS_GRID,
+    PARAM_KEY_LTE_BUDGET,
+    PARAM_KEY_NTRIP_THIN_MOUNTPOINT,
+    PARAM_KEY_LTE_USAGE,
+    PARAM_KEY_SD_LOG_SRC,
+    PARAM_KEY_MAX
+} param_key_t;
+
+typedef struct
+{
+    uint8_t key;
+    uint8_t size;
+    uint16_t offset;
+    bool live; // 쓰는 쪽이 매번 스냅샷을 읽거나 모듈이 직접 저장하는 상태 (재부팅 필요 없음)
+} param_field_t;
+
+#define PARAM_FIELD(k, f) {k, sizeof(((user_params_t *)0)->f), offsetof(user_params_t, f), false}
+#define PARAM_FIELD_LIVE(k, f) {k, sizeof(((user_params_t *)0)->f), offsetof(user_params_t, f), true}
+
+static const param_field_t param_fields[] = {
+    PARAM_FIELD(PARAM_KEY_NTRIP_URL, ntrip_url),
+    PARAM_FIELD(PARAM_KEY_NTRIP_PORT, ntrip_port),
+    PARAM_FIELD(PARAM_KEY_NTRIP_ID, ntrip_id),
+    PARAM_FIELD(PARAM_KEY_NTRIP_PW, ntrip_pw),
+    PARAM_FIELD(PARAM_KEY_NTRIP_MOUNTPOINT, ntrip_mountpoint),
+    PARAM_FIELD(PARAM_KEY_BOOT_LTE, boot_lte),
+    PARAM_FIELD(PARAM_KEY_BOOT_LORA, boot_lora),
+    PARAM_FIELD(PARAM_KEY_USE_MANUAL_POSITION, use_manual_position),
+    PARAM_FIELD(PARAM_KEY_LAT, lat),
+    PARAM_FIELD(PARAM_KEY_LON, lon),
+    PARAM_FIELD(PARAM_KEY_ALT, alt),
+    PARAM_FIELD(PARAM_KEY_BASELINE_LEN, baseline_len),
+    PARAM_FIELD(PARAM_KEY_BLE_DEVICE_NAME, ble_device_name),
+    PARAM_FIELD(PARAM_KEY_BASE_AUTO_FIX, base_auto_fix_enabled),
+    PARAM_FIELD_LIVE(PARAM_KEY_POS_OUTPUT_FORMAT, pos_output_format),
+    PARAM_FIELD(PARAM_KEY_NTRIP2_URL, ntrip2_url),
+    PARAM_FIELD(PARAM_KEY_NTRIP2_PORT, ntrip2_port),
+    PARAM_FIELD(PARAM_KEY_NTRIP2_MOUNTPOINT, ntrip2_mountpoint),
+    PARAM_FIELD(PARAM_KEY_LORA_TDMA_SLOT, lora_tdma_slot),
+    PARAM_FIELD(PARAM_KEY_LORA_TDMA_SLOTS, lora_tdma_slots),
+    PARAM_FIELD_LIVE(PARAM_KEY_POS_OUTPUT_DECIM, pos_output_decim),
+    PARAM_FIELD_LIVE(PARAM_KEY_MODBUS_ADDR, modbus_addr),
+    PARAM_FIELD_LIVE(PARAM_KEY_GPS_BAUD, gps_baud),
+    PARAM_FIELD_LIVE(PARAM_KEY_BASE_SURVEY, base_survey),
+    PARAM_FIELD(PARAM_KEY_NAV_RATE, nav_rate_hz),
+    PARAM_FIELD_LIVE(PARAM_KEY_POS_LATENCY_COMP, pos_latency_comp),
+    PARAM_FIELD_LIVE(PARAM_KEY_GPS_TEE, gps_tee),
+    PARAM_FIELD_LIVE(PARAM_KEY_BLE_MODULE, ble_module),
+    PARAM_FIELD(PARAM_KEY_NTRIP_SRV_URL, ntrip_srv_url),
+    PARAM_FIELD(PARAM_KEY_NTRIP_SRV_PORT, ntrip_srv_port),
+    PARAM_FIELD(PARAM_KEY_NTRIP_SRV_MOUNTPOINT, ntrip_srv_mountpoint),
+    PARAM_FIELD(PARAM_KEY_NTRIP_SRV_USER, ntrip_srv_user),
+    PARAM_FIELD(PARAM_KEY_NTRIP_SRV_PW, ntrip_srv_pw),
+    PARAM_FIELD(PARAM_KEY_TELEMETRY_URL, telemetry_url),
+    PARAM_FIELD(PARAM_KEY_TELEMETRY_PORT, telemetry_port),
+    PARAM_FIELD_LIVE(PARAM_KEY_TELEMETRY_INTERVAL, telemetry_interval_s),
+    PARAM_FIELD_LIVE(PARAM_KEY_TRACK_INTERVAL, track_interval_s),
+    PARAM_FIELD_LIVE(PARAM_KEY_GPS_GRID, gps_grid),
+    PARAM_FIELD_LIVE(PARAM_KEY_LTE_BUDGET, lte_budget_mb),
+    PARAM_FIELD(PARAM_KEY_NTRIP_THIN_MOUNTPOINT, ntrip_thin_mountpoint),
+    PARAM_FIELD_LIVE(PARAM_KEY_LTE_USAGE, lte_usage),
+    PARAM_FIELD_LIVE(PARAM_KEY_SD_LOG_SRC, sd_log_src),
+};
+
+#define PARAM_FIELD_COUNT (sizeof(param_fields) / sizeof(param_fields[0]))
 
 static const user_params_t user_default_params = 
 {
@@ -27,31 +160,92 @@ static const user_params_t user_default_params =
     .baseline_len = 100.0,
     .ble_device_name = "GuguBase",
 	.base_auto_fix_enabled = 1,
+    .pos_output_format = 0,
+    .ntrip2_url = "",
+    .ntrip2_port = "",
+    .ntrip2_mountpoint = "",
+    .lora_tdma_slot = 0,
+    .lora_tdma_slots = 0,
+    .pos_output_decim = 1,
+    .modbus_addr = 0,
+    .gps_baud = {0, 0},
+    .base_survey = {0},
+    .nav_rate_hz = 0,
+    .pos_latency_comp = 0,
+    .gps_tee = {0},
+    .ble_module = {0},
+    .ntrip_srv_url = "",
+    .ntrip_srv_port = "",
+    .ntrip_srv_mountpoint = "",
+    .ntrip_srv_user = "",
+    .ntrip_srv_pw = "",
+    .telemetry_url = "",
+    .telemetry_port = "",
+    .telemetry_interval_s = 0,
+    .track_interval_s = 0,
+    .gps_grid = {0},
+    .lte_budget_mb = 0,
+    .ntrip_thin_mountpoint = "",
+    .lte_usage = {0},
+    .sd_log_src = 0,
 };
 
 static user_params_t current_params;
 
-HAL_StatusTypeDef flash_params_erase(void)
+/* 게시된 스냅샷: params_view[params_version & 1] 이 최신 */
+static user_params_t params_view[2];
+static uint32_t params_version;
+
+/* 필드 감시 (flash_params_watch), 게시 때 바뀐 것만 콜백 */
+typedef struct
 {
-    HAL_StatusTypeDef status;
-    FLASH_EraseInitTypeDef erase_init;
-    uint32_t sector_error = 0;
+    uint16_t offset;
+    uint16_t size;
+    flash_params_watch_cb_t cb;
+    void *ctx;
+} params_watch_t;
 
-    HAL_FLASH_Unlock();
+static params_watch_t params_watches[FLASH_PARAMS_WATCH_MAX];
+static uint8_t params_watch_cnt;
+static uint32_t params_watch_pending; // 게시에서 바뀐 감시 (bit), 부르는 쪽이 가져감
+static volatile bool params_reboot_pending;
 
-    erase_init.TypeErase = FLASH_TYPEERASE_SECTORS;
-    erase_init.Sector = FLASH_USER_PARAMS_SECTOR;
-    erase_init.VoltageRange = FLASH_VOLTAGE_RANGE_3;
-    erase_init.NbSectors = 1;
+/* RAM 인덱스: key 별 최신 레코드 data 주소 (NULL 이면 flash 에 없음) */
+static struct
+{
+    const uint8_t *data[PARAM_KEY_MAX];
+    int8_t active;       // 쓰고 있는 섹터 (-1 이면 아직 없음)
+    uint32_t seq;        // 활성 섹터 순번
+    uint32_t write_addr; // 다음 레코드 주소
+} params_log = {.active = -1};
 
-    status = HAL_FLASHEx_Erase(&erase_init, &sector_error);
-    if (status != HAL_OK) {
-        uint32_t error_code = HAL_FLASH_GetError();
-        LOG_ERR("Flash erase failed: %d error_code :%d", status, error_code);
-        HAL_FLASH_Lock();
-        return status;
+static inline uint32_t params_log_rec_size(uint8_t len)
+{
+    return 4U + ((len + 3U) & ~3U);
+}
+
+static uint16_t params_log_crc(uint8_t key, uint8_t len, const void *data)
+{
+    uint8_t hdr[2] = {key, len};
+    uint16_t crc = crc16_ccitt_update(0xFFFF, hdr, sizeof(hdr));
+
+    return crc16_ccitt_update(crc, data, len);
+}
+
+static const param_field_t *params_log_field(uint8_t key)
+{
+    for (size_t i = 0; i < PARAM_FIELD_COUNT; i++)
+    {
+        if (param_fields[i].key == key)
+        {
+            return &param_fields[i];
+        }
     }
+    return NULL;
+}
 
+static void params_flash_cache_reset(void)
+{
     __HAL_FLASH_DATA_CACHE_DISABLE();
     __HAL_FLASH_INSTRUCTION_CACHE_DISABLE();
 
@@ -60,12 +254,300 @@ HAL_StatusTypeDef flash_params_erase(void)
 
     __HAL_FLASH_INSTRUCTION_CACHE_ENABLE();
     __HAL_FLASH_DATA_CACHE_ENABLE();
+}
 
+/*
+ * erase/program 중에는 같은 bank 에서 명령을 못 읽으므로 BSY 대기 루프를
+ * SRAM (.RamFunc) 에서 돌린다. flash 에 있는 함수 (HAL_GetTick 등) 는 부르지
+ * 않는다. 그 동안 들어온 ISR 은 flash 에서 읽히므로 끝날 때까지 밀린다.
+ */
+#define PARAMS_FLASH_SR_ERR (FLASH_SR_WRPERR | FLASH_SR_PGAERR | FLASH_SR_PGPERR | FLASH_SR_PGSERR)
 
-    HAL_FLASH_Lock();
+RAM_FUNC static uint32_t params_flash_erase_ram(uint32_t sector)
+{
+    FLASH->SR = PARAMS_FLASH_SR_ERR | FLASH_SR_EOP;
+    FLASH->CR = (FLASH->CR & ~(FLASH_CR_PSIZE | FLASH_CR_SNB)) | FLASH_CR_PSIZE_1 |
+                FLASH_CR_SER | (sector << FLASH_CR_SNB_Pos);
+    FLASH->CR |= FLASH_CR_STRT;
+    __DSB();
+
+    while (FLASH->SR & FLASH_SR_BSY)
+    {
+    }
+
+    FLASH->CR &= ~(FLASH_CR_SER | FLASH_CR_SNB);
+    return FLASH->SR & PARAMS_FLASH_SR_ERR;
+}
+
+RAM_FUNC static uint32_t params_flash_program_ram(uint32_t addr, uint32_t word)
+{
+    FLASH->SR = PARAMS_FLASH_SR_ERR | FLASH_SR_EOP;
+    FLASH->CR = (FLASH->CR & ~FLASH_CR_PSIZE) | FLASH_CR_PSIZE_1 | FLASH_CR_PG;
+    *(volatile uint32_t *)addr = word;
+    __DSB();
+
+    while (FLASH->SR & FLASH_SR_BSY)
+    {
+    }
+
+    FLASH->CR &= ~FLASH_CR_PG;
+    return FLASH->SR & PARAMS_FLASH_SR_ERR;
+}
+
+HAL_StatusTypeDef flash_params_erase_sector(uint32_t sector)
+{
+    uint32_t err = params_flash_erase_ram(sector);
+
+    if (err != 0)
+    {
+        LOG_ERR("Flash erase failed: sector %lu sr=0x%02lX", (unsigned long)sector,
+                (unsigned long)err);
+        return HAL_ERROR;
+    }
+
+    params_flash_cache_reset();
+    return HAL_OK;
+}
+
+static HAL_StatusTypeDef params_log_erase_sector(uint8_t idx)
+{
+    return flash_params_erase_sector(params_log_sectors[idx].sector);
+}
+
+HAL_StatusTypeDef flash_params_program(uint32_t addr, const void *src, uint32_t len)
+{
+    const uint8_t *p = src;
+
+    for (uint32_t off = 0; off < len; off += 4)
+    {
+        uint32_t word = PARAMS_LOG_ERASED;
+        uint32_t err;
+
+        memcpy(&word, &p[off], (len - off) < 4 ? (len - off) : 4);
+        err = params_flash_program_ram(addr + off, word);
+        if (err != 0)
+        {
+            LOG_ERR("Flash write failed: 0x%08lX sr=0x%02lX", (unsigned long)(addr + off),
+                    (unsigned long)err);
+            return HAL_ERROR;
+        }
+    }
+
+    return HAL_OK;
+}
+
+/**
+ * @brief 레코드 하나 덧붙임 (머리말 먼저, 끊기면 다음 부팅에 CRC 로 건너뜀)
+ */
+static HAL_StatusTypeDef params_log_append(const param_field_t *f, const user_params_t *params)
+{
+    const uint8_t *data = (const uint8_t *)params + f->offset;
+    uint32_t addr = params_log.write_addr;
+    uint32_t hdr = f->key | ((uint32_t)f->size << 8) |
+                   ((uint32_t)params_log_crc(f->key, f->size, data) << 16);
+
+    if (flash_params_program(addr, &hdr, 4) != HAL_OK ||
+        flash_params_program(addr + 4, data, f->size) != HAL_OK)
+    {
+        return HAL_ERROR;
+    }
+
+    params_log.write_addr = addr + params_log_rec_size(f->size);
+    if (memcmp((const void *)(addr + 4), data, f->size) != 0)
+    {
+        LOG_ERR("Flash verify failed (key=%u)", f->key);
+        return HAL_ERROR;
+    }
+
+    params_log.data[f->key] = (const uint8_t *)(addr + 4);
+    return HAL_OK;
+}
+
+/**
+ * @brief 다른 섹터를 지우고 params 전체를 옮겨 씀 (머리말을 마지막에 써서 전환)
+ */
+static HAL_StatusTypeDef params_log_compact(const user_params_t *params)
+{
+    uint8_t target = params_log.active == 0 ? 1 : 0;
+    uint32_t base = params_log_sectors[target].addr;
+    uint32_t seq = params_log.seq + 1;
+    uint32_t magic = PARAMS_LOG_MAGIC;
+
+    LOG_INFO("Params log compaction -> sector %lu (seq %lu)",
+             (unsigned long)params_log_sectors[target].sector, (unsigned long)seq);
+
+    if (params_log_erase_sector(target) != HAL_OK)
+    {
+        return HAL_ERROR;
+    }
+
+    memset(params_log.data, 0, sizeof(params_log.data));
+    params_log.write_addr = base + PARAMS_LOG_HDR_SIZE;
+
+    for (size_t i = 0; i < PARAM_FIELD_COUNT; i++)
+    {
+        if (params_log_append(&param_fields[i], params) != HAL_OK)
+        {
+            return HAL_ERROR;
+        }
+    }
+
+    if (flash_params_program(base, &seq, 4) != HAL_OK ||
+        flash_params_program(base + 4, &magic, 4) != HAL_OK)
+    {
+        return HAL_ERROR;
+    }
+
+    params_log.active = (int8_t)target;
+    params_log.seq = seq;
     return HAL_OK;
 }
 
+static bool params_log_sector_valid(uint8_t idx, uint32_t *seq)
+{
+    const uint32_t *hdr = (const uint32_t *)params_log_sectors[idx].addr;
+
+    if (hdr[1] != PARAMS_LOG_MAGIC)
+    {
+        return false;
+    }
+    *seq = hdr[0];
+    return true;
+}
+
+/**
+ * @brief 활성 섹터를 골라 레코드를 훑고 RAM 인덱스를 만듦
+ *
+ * @return bool 유효한 로그 섹터가 있으면 true
+ */
+static bool params_log_scan(void)
+{
+    uint32_t seq[2];
+    bool valid[2];
+    uint32_t addr;
+    uint32_t end;
+    int8_t active;
+
+    valid[0] = params_log_sector_valid(0, &seq[0]);
+    valid[1] = params_log_sector_valid(1, &seq[1]);
+
+    if (valid[0] && valid[1])
+    {
+        active = (int32_t)(seq[1] - seq[0]) > 0 ? 1 : 0;
+    }
+    else if (valid[0] || valid[1])
+    {
+        active = valid[0] ? 0 : 1;
+    }
+    else
+    {
+        params_log.active = -1;
+        return false;
+    }
+
+    memset(params_log.data, 0, sizeof(params_log.data));
+    params_log.active = active;
+    params_log.seq = seq[active];
+
+    addr = params_log_sectors[active].addr + PARAMS_LOG_HDR_SIZE;
+    end = params_log_sectors[active].addr + PARAMS_LOG_SECTOR_SIZE;
+
+    while (addr + 4 <= end)
+    {
+        uint32_t hdr = *(const uint32_t *)addr;
+        uint8_t key = hdr & 0xFF;
+        uint8_t len = (hdr >> 8) & 0xFF;
+        const uint8_t *data = (const uint8_t *)(addr + 4);
+        const param_field_t *f;
+
+        if (hdr == PARAMS_LOG_ERASED || addr + params_log_rec_size(len) > end)
+        {
+            break;
+        }
+
+        f = params_log_field(key);
+        if (f && f->size == len && params_log_crc(key, len, data) == (hdr >> 16))
+        {
+            params_log.data[key] = data;
+        }
+        addr += params_log_rec_size(len);
+    }
+
+    params_log.write_addr = addr;
+    return true;
+}
+
+/*
+ * flash writer 태스크
+ *
+ * 저장 요청을 모아 (FLASH_WRITER_BATCH_MS) 낮은 우선순위에서 한 번에 쓴다.
+ * GNSS 초기화/LoRa 송신처럼 멈추면 안 되는 구간은 flash_params_hold() 로
+ * 알리고, writer 는 hold 가 모두 풀린 뒤 (최대 FLASH_WRITER_HOLD_MAX_MS) 쓴다.
+ */
+#define FLASH_WRITER_BATCH_MS 500
+#define FLASH_WRITER_HOLD_POLL_MS 20
+#define FLASH_WRITER_HOLD_MAX_MS 10000
+#define FLASH_WRITER_SYNC_TIMEOUT_MS 15000 // hold 최대 + sector erase
+#define FLASH_WRITER_SYNC_POLL_MS 50
+
+RTOS_STATIC_TASK(flash_wr, 256);
+static TaskHandle_t writer_task;
+static SemaphoreHandle_t writer_done;
+static StaticSemaphore_t writer_done_buf;
+static SemaphoreHandle_t params_flash_mutex;
+static StaticSemaphore_t params_flash_mutex_buf;
+static user_params_t writer_snapshot;
+static uint32_t writer_holds;
+static volatile bool writer_params_req;   // 저장 요청 (동기/비동기)
+static flash_job_t *writer_jobs;          // 다른 모듈의 쓰기 (먼저 넣은 것부터)
+static volatile uint32_t writer_req_seq;  // 동기 저장 요청 번호
+static volatile uint32_t writer_done_seq; // 쓰기를 끝낸 요청 번호
+static volatile HAL_StatusTypeDef writer_result = HAL_OK;
+
+static bool params_rtos_running(void)
+{
+    return xTaskGetSchedulerState() == taskSCHEDULER_RUNNING;
+}
+
+static void params_flash_lock(void)
+{
+    if (params_flash_mutex && params_rtos_running())
+    {
+        xSemaphoreTake(params_flash_mutex, portMAX_DELAY);
+    }
+}
+
+static void params_flash_unlock(void)
+{
+    if (params_flash_mutex && params_rtos_running())
+    {
+        xSemaphoreGive(params_flash_mutex);
+    }
+}
+
+HAL_StatusTypeDef flash_params_erase(void)
+{
+    HAL_StatusTypeDef status = HAL_OK;
+
+    params_flash_lock();
+    HAL_FLASH_Unlock();
+    for (uint8_t i = 0; i < 2; i++)
+    {
+        if (params_log_erase_sector(i) != HAL_OK)
+        {
+            status = HAL_ERROR;
+        }
+    }
+    HAL_FLASH_Lock();
+
+    memset(params_log.data, 0, sizeof(params_log.data));
+    params_log.active = -1;
+    params_log.seq = 0;
+    params_flash_unlock();
+
+    return status;
+}
+
 HAL_StatusTypeDef flash_params_read(user_params_t *params)
 {
     if (params == NULL) {
@@ -73,95 +555,429 @@ HAL_StatusTypeDef flash_params_read(user_params_t *params)
         return HAL_ERROR;
     }
 
-    uint32_t magic_number = *(uint32_t*)FLASH_USER_START_ADDR;
+    // 로그에 없는 필드는 기본값 (새로 추가된 필드 포함)
+    memcpy(params, &user_default_params, sizeof(user_params_t));
 
-    if(magic_number != FLASH_MAGIC_NUMBER)
+    if (params_log.active < 0)
     {
         LOG_WARN("Flash params not initialized, loading default params");
-        memcpy(params, &user_default_params, sizeof(user_params_t));
         return HAL_OK;
     }
 
-    // Flash 메모리에서 직접 복사
-    memcpy(params, (void*)FLASH_USER_START_ADDR, sizeof(user_params_t));
+    for (size_t i = 0; i < PARAM_FIELD_COUNT; i++)
+    {
+        const param_field_t *f = &param_fields[i];
 
-    if (params->magic != FLASH_MAGIC_NUMBER) {
-         LOG_WARN("Flash params not initialized or corrupted");
-         return HAL_ERROR;
+        if (params_log.data[f->key])
+        {
+            memcpy((uint8_t *)params + f->offset, params_log.data[f->key], f->size);
+        }
     }
 
     return HAL_OK;
 }
 
-HAL_StatusTypeDef flash_params_write(user_params_t *params)
+user_params_t* flash_params_get_current(void)
 {
-    HAL_StatusTypeDef status;
-  /* Unlock to control */
-  HAL_FLASH_Unlock();
-  
-  uint32_t addr = FLASH_USER_START_ADDR;
-  uint32_t len = sizeof(user_params_t);
-  uint32_t* data = (uint32_t*)params;
-  uint32_t words = (sizeof(user_params_t) + 3) / 4;  // 올림
-  
-    for(uint32_t i = 0; i< words; i++)
-    {
-        /* Writing data to flash memory */
-        status = HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, addr, data[i]);
-        if(status == HAL_OK)
-        {
-        addr+=4;
+    return &current_params;
+}
+
+static inline bool params_range_changed(const user_params_t *prev, uint16_t offset, uint16_t size)
+{
+    return memcmp((const uint8_t *)prev + offset, (const uint8_t *)&current_params + offset, size) != 0;
+}
+
+/**
+ * @brief 직전 게시와 작업본의 차이 (critical section 안에서, 복사 전에)
+ *
+ * 바뀐 감시는 pending bit 로, 감시도 live 도 아닌 필드가 바뀌면 재부팅 필요로 남긴다.
+ */
+static void params_diff(const user_params_t *prev)
+{
+    for (uint8_t i = 0; i < params_watch_cnt; i++)
+    {
+        if (params_range_changed(prev, params_watches[i].offset, params_watches[i].size))
+        {
+            params_watch_pending |= 1UL << i;
+        }
+    }
+
+    for (size_t i = 0; i < PARAM_FIELD_COUNT && !params_reboot_pending; i++)
+    {
+        const param_field_t *f = &param_fields[i];
+        bool watched = f->live;
+
+        for (uint8_t k = 0; k < params_watch_cnt && !watched; k++)
+        {
+            watched = f->offset < params_watches[k].offset + params_watches[k].size &&
+                      params_watches[k].offset < f->offset + f->size;
+        }
+        if (!watched && params_range_changed(prev, f->offset, f->size))
+        {
+            params_reboot_pending = true;
+        }
+    }
+}
+
+/**
+ * @brief 작업본을 안 쓰는 쪽 버퍼에 복사한 뒤 version 을 올려 게시
+ *
+ * 복사는 setter 와 겹치지 않게 critical section 안에서 (게시끼리도 순서가 맞음).
+ * 바뀐 필드의 감시 콜백은 게시한 태스크에서 critical section 밖에서 부른다.
+ */
+static void params_publish(void)
+{
+    uint32_t pending;
+
+    taskENTER_CRITICAL();
+    uint32_t next = params_version + 1;
+
+    // 처음 게시 (flash 에서 읽음) 는 비교할 것이 없음
+    if (params_version != 0)
+    {
+        params_diff(&params_view[params_version & 1]);
+    }
+    memcpy(&params_view[next & 1], &current_params, sizeof(user_params_t));
+    __atomic_store_n(&params_version, next, __ATOMIC_RELEASE);
+    pending = params_watch_pending;
+    params_watch_pending = 0;
+    taskEXIT_CRITICAL();
+
+    for (uint8_t i = 0; pending; i++, pending >>= 1)
+    {
+        if ((pending & 1) && !params_watches[i].cb(flash_params_snapshot(NULL), params_watches[i].ctx))
+        {
+            // 모듈이 지금은 못 바꿈 (다음 부팅에 적용)
+            params_reboot_pending = true;
+        }
+    }
+}
+
+bool flash_params_watch(size_t offset, size_t size, flash_params_watch_cb_t cb, void *ctx)
+{
+    bool ok = false;
+
+    if (!cb || size == 0 || offset + size > sizeof(user_params_t))
+    {
+        return false;
+    }
+
+    taskENTER_CRITICAL();
+    if (params_watch_cnt < FLASH_PARAMS_WATCH_MAX)
+    {
+        params_watches[params_watch_cnt].offset = (uint16_t)offset;
+        params_watches[params_watch_cnt].size = (uint16_t)size;
+        params_watches[params_watch_cnt].cb = cb;
+        params_watches[params_watch_cnt].ctx = ctx;
+        params_watch_cnt++;
+        ok = true;
+    }
+    taskEXIT_CRITICAL();
+
+    if (!ok)
+    {
+        LOG_ERR("Flash params watch table full");
+    }
+    return ok;
+}
+
+bool flash_params_reboot_pending(void)
+{
+    return params_reboot_pending;
+}
+
+const user_params_t* flash_params_snapshot(uint32_t *version)
+{
+    uint32_t v = __atomic_load_n(&params_version, __ATOMIC_ACQUIRE);
+
+    if (version)
+    {
+        *version = v;
+    }
+    return &params_view[v & 1];
+}
+
+bool flash_params_changed(uint32_t *version)
+{
+    uint32_t v = __atomic_load_n(&params_version, __ATOMIC_ACQUIRE);
+
+    if (v == *version)
+    {
+        return false;
+    }
+    *version = v;
+    return true;
+}
+
+bool flash_params_str_empty(const char *s)
+{
+    return s[0] == '\0' || (uint8_t)s[0] == 0xFF;
+}
+
+/**
+ * @brief params 중 flash 의 최신 값과 다른 필드만 로그에 씀 (flash 를 만지는 유일한 저장 경로)
+ */
+static HAL_StatusTypeDef params_log_commit(const user_params_t *params)
+{
+    HAL_StatusTypeDef status = HAL_OK;
+    uint32_t need = 0;
+    uint32_t end;
+
+    // flash 의 최신 값과 다른 필드만
+    for (size_t i = 0; i < PARAM_FIELD_COUNT; i++)
+    {
+        const param_field_t *f = &param_fields[i];
+        const uint8_t *stored = params_log.data[f->key];
+
+        if (!stored || memcmp(stored, (const uint8_t *)params + f->offset, f->size) != 0)
+        {
+            need += params_log_rec_size(f->size);
+        }
+    }
+
+    if (need > 0)
+    {
+        HAL_FLASH_Unlock();
+
+        end = params_log.active < 0 ? 0
+                                    : params_log_sectors[params_log.active].addr +
+                                          PARAMS_LOG_SECTOR_SIZE;
+        if (params_log.active < 0 || params_log.write_addr + need > end)
+        {
+            status = params_log_compact(params);
         }
         else
         {
-        uint32_t error_code = HAL_FLASH_GetError();
-        LOG_ERR("Flash write failed: %d error_code :%d", status, error_code);
+            for (size_t i = 0; i < PARAM_FIELD_COUNT && status == HAL_OK; i++)
+            {
+                const param_field_t *f = &param_fields[i];
+                const uint8_t *stored = params_log.data[f->key];
+
+                if (!stored || memcmp(stored, (const uint8_t *)params + f->offset, f->size) != 0)
+                {
+                    status = params_log_append(f, params);
+                }
+            }
+        }
+
         HAL_FLASH_Lock();
+    }
+
+    if (status != HAL_OK)
+    {
+        // 쓰다 실패하면 flash 에 실제로 남은 것으로 인덱스를 다시 만든다
+        params_log_scan();
         return HAL_ERROR;
+    }
+
+    return HAL_OK;
+}
+
+void flash_params_hold(void)
+{
+    __atomic_add_fetch(&writer_holds, 1, __ATOMIC_RELAXED);
+}
+
+void flash_params_release(void)
+{
+    __atomic_sub_fetch(&writer_holds, 1, __ATOMIC_RELAXED);
+}
+
+bool flash_params_submit_job(flash_job_t *job)
+{
+    flash_job_t **tail;
+    bool added = false;
+
+    taskENTER_CRITICAL();
+    if (!job->queued)
+    {
+        for (tail = &writer_jobs; *tail; tail = &(*tail)->next)
+        {
         }
+        job->next = NULL;
+        job->queued = true;
+        *tail = job;
+        added = true;
     }
+    taskEXIT_CRITICAL();
 
-  /* Lock flash control register */
-  HAL_FLASH_Lock();  
-  
-  return HAL_OK;
+    if (added && writer_task)
+    {
+        xTaskNotifyGive(writer_task);
+    }
+    return added;
 }
 
-user_params_t* flash_params_get_current(void)
+static void flash_writer_run_jobs(void)
 {
-    return &current_params;
+    flash_job_t *job;
+
+    for (;;)
+    {
+        taskENTER_CRITICAL();
+        job = writer_jobs;
+        if (job)
+        {
+            writer_jobs = job->next;
+            job->next = NULL;
+            job->queued = false;
+        }
+        taskEXIT_CRITICAL();
+
+        if (!job)
+        {
+            return;
+        }
+
+        params_flash_lock();
+        HAL_FLASH_Unlock();
+        job->fn(job);
+        HAL_FLASH_Lock();
+        params_flash_unlock();
+    }
+}
+
+static void flash_writer_task(void *pvParameter)
+{
+    (void)pvParameter;
+
+    for (;;)
+    {
+        uint32_t seq;
+        uint32_t waited = 0;
+        HAL_StatusTypeDef status;
+
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        // 비동기 요청은 잠깐 더 모은다 (동기 요청이 있으면 바로, 작업만 있으면 모으지 않음)
+        while (writer_params_req && writer_req_seq == writer_done_seq &&
+               ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(FLASH_WRITER_BATCH_MS)) != 0)
+        {
+        }
+
+        while (__atomic_load_n(&writer_holds, __ATOMIC_RELAXED) > 0 &&
+               waited < FLASH_WRITER_HOLD_MAX_MS)
+        {
+            vTaskDelay(pdMS_TO_TICKS(FLASH_WRITER_HOLD_POLL_MS));
+            waited += FLASH_WRITER_HOLD_POLL_MS;
+        }
+        if (waited >= FLASH_WRITER_HOLD_MAX_MS)
+        {
+            LOG_WARN("Flash writer: hold timeout, writing anyway");
+        }
+
+        flash_writer_run_jobs();
+
+        if (!writer_params_req && writer_req_seq == writer_done_seq)
+        {
+            continue;
+        }
+        writer_params_req = false;
+
+        taskENTER_CRITICAL();
+        memcpy(&writer_snapshot, &current_params, sizeof(user_params_t));
+        seq = writer_req_seq;
+        taskEXIT_CRITICAL();
+
+        params_flash_lock();
+        status = params_log_commit(&writer_snapshot);
+        params_flash_unlock();
+
+        if (status != HAL_OK)
+        {
+            LOG_ERR("Flash params save failed");
+        }
+
+        writer_result = status;
+        if (seq != writer_done_seq)
+        {
+            writer_done_seq = seq;
+            xSemaphoreGive(writer_done);
+        }
+    }
+}
+
+void flash_params_save_async(void)
+{
+    params_publish();
+
+    if (writer_task)
+    {
+        writer_params_req = true;
+        xTaskNotifyGive(writer_task);
+    }
+    else
+    {
+        flash_params_save(&current_params);
+    }
 }
 
 HAL_StatusTypeDef flash_params_save(user_params_t *params)
 {
+    TickType_t start = xTaskGetTickCount();
+    uint32_t seq;
+
     params->magic = FLASH_MAGIC_NUMBER;
-    
-    if (flash_params_erase() != HAL_OK) {
-        return HAL_ERROR;
+    if (params != &current_params)
+    {
+        taskENTER_CRITICAL();
+        memcpy(&current_params, params, sizeof(user_params_t));
+        taskEXIT_CRITICAL();
     }
+    params_publish();
 
-    if (flash_params_write(params) != HAL_OK) {
-        return HAL_ERROR;
+    // 스케줄러 전 (이전 형식 이관) 이나 writer 가 없으면 직접
+    if (!writer_task || !params_rtos_running())
+    {
+        return params_log_commit(&current_params);
     }
 
-    user_params_t verify;
-    if (flash_params_read(&verify) != HAL_OK) {
-        return HAL_ERROR;
-    }
-    
-    if (memcmp(params, &verify, sizeof(user_params_t)) != 0) {
-        LOG_ERR("Flash verify failed");
-        return HAL_ERROR;
+    taskENTER_CRITICAL();
+    seq = ++writer_req_seq;
+    writer_params_req = true;
+    taskEXIT_CRITICAL();
+    xTaskNotifyGive(writer_task);
+
+    // 이 요청 이후에 찍은 snapshot 이 쓰일 때까지 (동시에 기다리는 쪽이 있으면 poll 로)
+    while ((int32_t)(writer_done_seq - seq) < 0)
+    {
+        if (xTaskGetTickCount() - start >= pdMS_TO_TICKS(FLASH_WRITER_SYNC_TIMEOUT_MS))
+        {
+            LOG_ERR("Flash params save timeout");
+            return HAL_TIMEOUT;
+        }
+        xSemaphoreTake(writer_done, pdMS_TO_TICKS(FLASH_WRITER_SYNC_POLL_MS));
     }
 
-    memcpy(&current_params, params, sizeof(user_params_t));
-    
-    return HAL_OK;
+    return writer_result;
 }
 
 HAL_StatusTypeDef flash_params_init(void)
 {
-    return flash_params_read(&current_params);
+    HAL_StatusTypeDef status;
+
+    if (!params_log_scan() && *(const uint32_t *)FLASH_LEGACY_ADDR == FLASH_MAGIC_NUMBER)
+    {
+        // 이전 형식: sector 11 을 그대로 두고 sector 10 에 로그를 새로 만든다
+        LOG_INFO("Migrating legacy flash params to log");
+        memcpy(&current_params, (const void *)FLASH_LEGACY_ADDR, sizeof(user_params_t));
+        status = flash_params_save(&current_params);
+    }
+    else
+    {
+        status = flash_params_read(&current_params);
+        params_publish();
+    }
+
+    if (writer_task == NULL)
+    {
+        params_flash_mutex = xSemaphoreCreateMutexStatic(&params_flash_mutex_buf);
+        writer_done = xSemaphoreCreateBinaryStatic(&writer_done_buf);
+        writer_task = RTOS_TASK_CREATE_STATIC(flash_wr, flash_writer_task, "flash_wr", NULL,
+                                              tskIDLE_PRIORITY + 1);
+    }
+
+    return status;
 }
 
 void flash_params_set_ntrip_url(const char *url)
@@ -194,6 +1010,16 @@ void flash_params_set_ntrip_mountpoint(const char *mountpoint)
     current_params.ntrip_mountpoint[sizeof(current_params.ntrip_mountpoint) - 1] = '\0';
 }
 
+void flash_params_set_ntrip_standby(const char *url, const char *port, const char *mountpoint)
+{
+    strncpy(current_params.ntrip2_url, url, sizeof(current_params.ntrip2_url) - 1);
+    current_params.ntrip2_url[sizeof(current_params.ntrip2_url) - 1] = '\0';
+    strncpy(current_params.ntrip2_port, port, sizeof(current_params.ntrip2_port) - 1);
+    current_params.ntrip2_port[sizeof(current_params.ntrip2_port) - 1] = '\0';
+    strncpy(current_params.ntrip2_mountpoint, mountpoint, sizeof(current_params.ntrip2_mountpoint) - 1);
+    current_params.ntrip2_mountpoint[sizeof(current_params.ntrip2_mountpoint) - 1] = '\0';
+}
+
 void flash_params_set_manual_position(uint32_t use_manual, const char* lat, const char* lon, const char* alt)
 {
     current_params.use_manual_position = use_manual;
@@ -227,3 +1053,116 @@ void flash_params_set_ble_device_name(const char* name)
     strncpy(current_params.ble_device_name, name, sizeof(current_params.ble_device_name) - 1);
     current_params.ble_device_name[sizeof(current_params.ble_device_name) - 1] = '\0';
 }
+
+void flash_params_set_pos_output_format(uint32_t format)
+{
+    current_params.pos_output_format = format;
+}
+
+void flash_params_set_lora_tdma(uint32_t slot, uint32_t slots)
+{
+    current_params.lora_tdma_slot = slot;
+    current_params.lora_tdma_slots = slots;
+}
+
+void flash_params_set_pos_output_decim(uint32_t decim)
+{
+    current_params.pos_output_decim = decim;
+}
+
+void flash_params_set_modbus_addr(uint32_t addr)
+{
+    current_params.modbus_addr = addr;
+}
+
+void flash_params_set_gps_baud(uint8_t id, uint32_t baud)
+{
+    if (id < sizeof(current_params.gps_baud) / sizeof(current_params.gps_baud[0]))
+    {
+        current_params.gps_baud[id] = baud;
+    }
+}
+
+void flash_params_set_base_survey(const base_survey_t *survey)
+{
+    current_params.base_survey = *survey;
+}
+
+void flash_params_set_nav_rate(uint32_t hz)
+{
+    current_params.nav_rate_hz = hz;
+}
+
+void flash_params_set_pos_latency_comp(uint32_t enable)
+{
+    current_params.pos_latency_comp = enable;
+}
+
+void flash_params_set_gps_tee(const gps_tee_params_t *tee)
+{
+    current_params.gps_tee = *tee;
+}
+
+void flash_params_set_ble_module(const ble_module_params_t *ble)
+{
+    current_params.ble_module = *ble;
+}
+
+void flash_params_set_ntrip_server(const char *url, const char *port, const char *mountpoint)
+{
+    strncpy(current_params.ntrip_srv_url, url, sizeof(current_params.ntrip_srv_url) - 1);
+    current_params.ntrip_srv_url[sizeof(current_params.ntrip_srv_url) - 1] = '\0';
+    strncpy(current_params.ntrip_srv_port, port, sizeof(current_params.ntrip_srv_port) - 1);
+    current_params.ntrip_srv_port[sizeof(current_params.ntrip_srv_port) - 1] = '\0';
+    strncpy(current_params.ntrip_srv_mountpoint, mountpoint, sizeof(current_params.ntrip_srv_mountpoint) - 1);
+    current_params.ntrip_srv_mountpoint[sizeof(current_params.ntrip_srv_mountpoint) - 1] = '\0';
+}
+
+void flash_params_set_ntrip_server_auth(const char *user, const char *pw)
+{
+    strncpy(current_params.ntrip_srv_user, user, sizeof(current_params.ntrip_srv_user) - 1);
+    current_params.ntrip_srv_user[sizeof(current_params.ntrip_srv_user) - 1] = '\0';
+    strncpy(current_params.ntrip_srv_pw, pw, sizeof(current_params.ntrip_srv_pw) - 1);
+    current_params.ntrip_srv_pw[sizeof(current_params.ntrip_srv_pw) - 1] = '\0';
+}
+
+void flash_params_set_telemetry(const char *url, const char *port)
+{
+    strncpy(current_params.telemetry_url, url, sizeof(current_params.telemetry_url) - 1);
+    current_params.telemetry_url[sizeof(current_params.telemetry_url) - 1] = '\0';
+    strncpy(current_params.telemetry_port, port, sizeof(current_params.telemetry_port) - 1);
+    current_params.telemetry_port[sizeof(current_params.telemetry_port) - 1] = '\0';
+}
+
+void flash_params_set_telemetry_interval(uint32_t sec)
+{
+    current_params.telemetry_interval_s = sec;
+}
+
+void flash_params_set_track_interval(uint32_t sec)
+{
+    current_params.track_interval_s = sec;
+}
+
+void flash_params_set_gps_grid(const gps_grid_params_t *grid)
+{
+    current_params.gps_grid = *grid;
+}
+
+void flash_params_set_lte_budget(uint32_t mb, const char *thin_mountpoint)
+{
+    current_params.lte_budget_mb = mb;
+    strncpy(current_params.ntrip_thin_mountpoint, thin_mountpoint,
+            sizeof(current_params.ntrip_thin_mountpoint) - 1);
+    current_params.ntrip_thin_mountpoint[sizeof(current_params.ntrip_thin_mountpoint) - 1] = '\0';
+}
+
+void flash_params_set_lte_usage(const lte_usage_params_t *usage)
+{
+    current_params.lte_usage = *usage;
+}
+
+void flash_params_set_sd_log_src(uint32_t src)
+{
+    current_params.sd_log_src = src;
+}
@@ -1,10 +1,65 @@
 #ifndef FLASH_PARAMS_H
 #define FLASH_PARAMS_H
 
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 #include "stm32f4xx_hal.h"
 #include "stm32f4xx_hal_flash.h"
 
+/*
+ * base_auto_fix 로 측량한 기준국 위치. signature 는 보드 종류와 나머지 필드의
+ * CRC 라서 0 이나 이전 버전 flash(0xFFFFFFFF), 다른 보드의 값은 맞지 않는다.
+ */
+typedef struct
+{
+    double lat;         // [deg]
+    double lon;         // [deg]
+    double alt;         // [m] 수신기 출력 높이 (F9P 타원체고, UM982 해발고)
+    float ci_h;         // [m] 평균의 수평 신뢰구간 (약 95%)
+    float ci_v;         // [m] 평균의 수직 신뢰구간
+    uint32_t count;     // 평균에 쓴 샘플 수
+    uint32_t signature;
+} base_survey_t;
+
+/* GNSS raw tee 설정 (gps_tee.h) */
+typedef struct
+{
+    uint32_t mask; // GPS_TEE_PROTO()/GPS_TEE_RAW, 0 이면 끔
+    uint32_t src;  // 수신기 gps_id_t
+    uint32_t rate; // 속도 제한 [byte/s], 0 이면 제한 없음
+} gps_tee_params_t;
+
+/* BLE 모듈에 마지막으로 적용한 설정 (부팅 때 같으면 AT 설정을 건너뜀) */
+typedef struct
+{
+    uint32_t baud;     // 확인된 모듈 UART 속도, 0 이나 이전 버전 flash(0xFFFFFFFF)는 모름
+    uint32_t name_crc; // 모듈에 쓴 ble_device_name 의 crc32
+} ble_module_params_t;
+
+/* 평면 좌표 출력 설정 (gps_grid.h) */
+typedef struct
+{
+    uint32_t mode;      // gps_grid_mode_t, 이전 버전 flash(0xFFFFFFFF)는 끔
+    uint32_t zone;      // UTM: 0 은 위치로 자동, 1~60 북반구, 101~160 남반구
+    uint32_t ell;       // 투영 타원체 (gps_proj_ell_t)
+    uint32_t reserved;
+    double lat0, lon0;  // TM 원점 [deg]
+    double k0;          // TM 축척계수
+    double fe, fn;      // TM false easting/northing [m]
+    double shift[7];    // WGS84 -> 대상 datum (position vector): tx ty tz [m],
+                        // rx ry rz [arcsec], ds [ppm]. 모두 0 이면 변환 안 함
+} gps_grid_params_t;
+
+/* LTE 데이터 사용량 (data_usage.h). 날짜가 바뀌면 그 기간 값을 0 부터 */
+typedef struct
+{
+    uint32_t date;     // 마지막으로 센 UTC 날짜 yyyymmdd, 0 이나 이전 버전 flash(0xFFFFFFFF)는 모름
+    uint32_t day_kb;   // 그 날 사용량 [KiB] (RX+TX, 추정 헤더 포함)
+    uint32_t month_kb; // 그 달 사용량 [KiB]
+    uint32_t total_kb; // 지금까지 [KiB]
+} lte_usage_params_t;
+
 typedef struct
 {
     uint32_t magic;
@@ -27,24 +82,180 @@ typedef struct
     char ble_device_name[32];
 
     uint32_t base_auto_fix_enabled;
+
+    uint32_t pos_output_format; // gps_pos_format_t, 이전 버전 flash(0xFFFFFFFF)는 ASCII
+
+    // 보조 캐스터 (hot standby, 계정은 주 캐스터와 공유)
+    // 이전 버전 flash 는 0xFF 로 남아 있어 첫 바이트가 0xFF 면 설정 없음으로 본다
+    char ntrip2_url[64];
+    char ntrip2_port[8];
+    char ntrip2_mountpoint[32];
+
+    // LoRa TDMA (베이스 송신 slot). slot >= slots 이면 끔 (이전 버전 flash 는 0xFFFFFFFF)
+    uint32_t lora_tdma_slot;
+    uint32_t lora_tdma_slots;
+
+    // RS485 위치 출력: N 번째 항법 해마다 한 번. 0 이나 이전 버전 flash(0xFFFFFFFF)는 매번
+    uint32_t pos_output_decim;
+
+    // RS485 Modbus RTU slave 주소 (1~247). 0 이나 이전 버전 flash(0xFFFFFFFF)는 끔
+    uint32_t modbus_addr;
+
+    // 마지막으로 확인된 F9P UART 속도 [gps_id_t] (부팅 때 먼저 시도)
+    // 0 이나 이전 버전 flash(0xFFFFFFFF)는 모름, 전체 probe
+    uint32_t gps_baud[2];
+
+    // 마지막 auto-fix 결과 (재부팅 때 standalone 위치가 가까우면 바로 재사용)
+    base_survey_t base_survey;
+
+    // rover 항법 해 주기 [Hz] (1/2/5/10/20, 재부팅부터 적용, gps_rate.h)
+    // 0 이나 이전 버전 flash(0xFFFFFFFF)는 보드 기본값
+    uint32_t nav_rate_hz;
+
+    // 위치 출력 지연 보상 (1: 보내는 순간으로 외삽, gps_time.h)
+    // 0 이나 이전 버전 flash(0xFFFFFFFF)는 끔
+    uint32_t pos_latency_comp;
+
+    // GNSS raw tee (저장하면 바로 적용)
+    gps_tee_params_t gps_tee;
+
+    // BLE 모듈 설정 상태 (ble_port 가 설정을 마친 뒤 저장)
+    ble_module_params_t ble_module;
+
+    // NTRIP server (base 가 캐스터로 RTCM 업로드). url/port 가 비어 있거나 0xFF 면 끔
+    // srv_user 가 있으면 NTRIP v2 POST (Basic 인증), 없으면 v1 SOURCE (srv_pw 만)
+    char ntrip_srv_url[64];
+    char ntrip_srv_port[8];
+    char ntrip_srv_mountpoint[32];
+    char ntrip_srv_user[32];
+    char ntrip_srv_pw[32];
+
+    // 원격 모니터링 (LTE 로 바이너리 telemetry 묶음 전송). url/port 가 비어 있거나 0xFF 면 끔
+    // 전송 간격 [s], 0 이나 이전 버전 flash(0xFFFFFFFF)는 기본값
+    char telemetry_url[64];
+    char telemetry_port[8];
+    uint32_t telemetry_interval_s;
+
+    // 위치 기록 간격 [s] (track_log.h). 0 이나 이전 버전 flash(0xFFFFFFFF)는 끔
+    uint32_t track_interval_s;
+
+    // 평면 좌표 (TM/UTM) 출력 (저장하면 바로 적용)
+    gps_grid_params_t gps_grid;
+
+    // LTE 월 데이터 한도 [MiB] (data_usage.h). 0 이나 이전 버전 flash(0xFFFFFFFF)는 정책 없음
+    uint32_t lte_budget_mb;
+    // 한도가 거의 찼을 때 쓸 가벼운 마운트포인트 (주 캐스터), 비어 있으면 바꾸지 않음
+    char ntrip_thin_mountpoint[32];
+    // 사용량 (data_usage 가 주기적으로 저장)
+    lte_usage_params_t lte_usage;
+
+    // SD 카드 raw 기록 수신기 (sd_log.h): gps_id_t + 1, 0 은 끔 (저장하면 바로 적용)
+    uint32_t sd_log_src;
 }user_params_t;
 
+/* 두 섹터 모두 지움 (공장 초기화, 다음 부팅에 기본값) */
 HAL_StatusTypeDef flash_params_erase(void);
 HAL_StatusTypeDef flash_params_read(user_params_t *params);
-HAL_StatusTypeDef flash_params_write(user_params_t *params);
 
+/*
+ * 편집용 작업본. 설정 명령 핸들러처럼 setter 를 부르고 바로 되읽는 쪽만 쓴다
+ * (setter 가 제자리에서 고치므로 다른 태스크가 읽으면 반쯤 바뀐 값을 볼 수 있다).
+ */
 user_params_t* flash_params_get_current(void);
+
+/*
+ * 읽기 전용 스냅샷 (잠금 없음). 작업본은 save/save_async 때 두 버퍼 중 안 쓰는
+ * 쪽에 복사된 뒤 version 이 올라가며 게시된다. 돌려받은 포인터는 그 다음 게시
+ * 한 번까지 그대로이므로 함수 안에서 쓰고 오래 들고 있지 않는다.
+ * version 이 NULL 이 아니면 스냅샷의 version 을 돌려준다.
+ */
+const user_params_t* flash_params_snapshot(uint32_t *version);
+/* *version 이후 게시된 설정이 있으면 true 와 함께 *version 을 최신으로 */
+bool flash_params_changed(uint32_t *version);
+/* 문자열 설정이 비어 있거나 지워진 상태 (0xFF, 이전 버전 flash 에 없던 필드) 인지 */
+bool flash_params_str_empty(const char *s);
+
+/*
+ * 필드 감시: 게시 (save/save_async) 때 [offset, offset + size) 가 직전 게시와
+ * 다르면 cb 를 부른다. 모듈이 자기 설정만 감시해서 바뀐 것만 적용하면 (base
+ * 위치, LoRa slot, NTRIP 재연결) 다른 경로는 끊기지 않는다. cb 는 게시한 태스크
+ * (설정 명령 핸들러 등) 에서 불리므로 짧게 요청만 하고, 지금 적용할 수 없으면
+ * false 를 돌려준다 (다음 부팅에 적용, flash_params_reboot_pending). 등록은 init 에서.
+ */
+#define FLASH_PARAMS_WATCH_MAX 24 // pending 이 uint32_t bit 라 32 이하
+#define FLASH_PARAMS_FIELD(f) offsetof(user_params_t, f), sizeof(((user_params_t *)0)->f)
+
+typedef bool (*flash_params_watch_cb_t)(const user_params_t *params, void *ctx);
+
+bool flash_params_watch(size_t offset, size_t size, flash_params_watch_cb_t cb, void *ctx);
+/*
+ * 부팅 후 게시한 값 중 재부팅해야 적용되는 것이 있는지 (감시 cb 가 없거나 false,
+ * 매번 스냅샷을 읽는 필드는 아님). 저장 명령은 이때만 재부팅한다.
+ */
+bool flash_params_reboot_pending(void);
+
+/* 바뀐 필드만 로그에 덧붙임 (섹터가 차면 다른 섹터로 compaction 이라 erase 1 회) */
 HAL_StatusTypeDef flash_params_save(user_params_t *params);
 HAL_StatusTypeDef flash_params_init(void);
 
+/*
+ * flash 쓰기는 writer 태스크가 맡는다. flash_params_save() 는 쓰기가 끝날 때까지
+ * 기다리고 (리셋 전 저장용), flash_params_save_async() 는 요청만 하고 바로 돌아온다.
+ * erase/program 동안 CPU 가 flash 에서 명령을 못 읽으므로, 멈추면 안 되는 구간은
+ * hold/release 로 감싸면 writer 가 끝날 때까지 미룬다 (짝을 맞출 것).
+ */
+void flash_params_save_async(void);
+void flash_params_hold(void);
+void flash_params_release(void);
+
+/*
+ * 다른 모듈의 flash 쓰기 (track log 등) 도 writer 태스크에서 한다. 파라미터 저장과
+ * 겹치지 않고 hold/release 도 같이 지킨다. fn 은 unlock 된 상태로 writer 태스크
+ * (스택 256 word) 에서 불리며 그 안에서는 아래 erase/program 만 쓴다.
+ * 이미 대기 중인 작업을 다시 넣으면 false.
+ */
+typedef struct flash_job
+{
+    void (*fn)(struct flash_job *job);
+    struct flash_job *next;
+    bool queued;
+} flash_job_t;
+
+#define FLASH_JOB_INIT(f) {.fn = (f), .next = NULL, .queued = false}
+
+bool flash_params_submit_job(flash_job_t *job);
+HAL_StatusTypeDef flash_params_erase_sector(uint32_t sector);
+/* word 단위로 씀 (len 이 4 의 배수가 아니면 끝을 0xFF 로 채움) */
+HAL_StatusTypeDef flash_params_program(uint32_t addr, const void *src, uint32_t len);
+
 /* 파라미터 설정 함수 */
 void flash_params_set_ntrip_url(const char* url);
 void flash_params_set_ntrip_port(const char* port);
 void flash_params_set_ntrip_id(const char* id);
 void flash_params_set_ntrip_pw(const char* pw);
 void flash_params_set_ntrip_mountpoint(const char* mountpoint);
+void flash_params_set_ntrip_standby(const char* url, const char* port, const char* mountpoint);
 void flash_params_set_manual_position(uint32_t use_manual, const char* lat, const char* lon, const char* alt);
 void flash_params_set_baseline_len(float len);
 void flash_params_set_ble_device_name(const char* name);
+void flash_params_set_pos_output_format(uint32_t format);
+void flash_params_set_lora_tdma(uint32_t slot, uint32_t slots);
+void flash_params_set_pos_output_decim(uint32_t decim);
+void flash_params_set_modbus_addr(uint32_t addr);
+void flash_params_set_gps_baud(uint8_t id, uint32_t baud);
+void flash_params_set_base_survey(const base_survey_t *survey);
+void flash_params_set_nav_rate(uint32_t hz);
+void flash_params_set_pos_latency_comp(uint32_t enable);
+void flash_params_set_gps_tee(const gps_tee_params_t *tee);
+void flash_params_set_ble_module(const ble_module_params_t *ble);
+void flash_params_set_ntrip_server(const char* url, const char* port, const char* mountpoint);
+void flash_params_set_ntrip_server_auth(const char* user, const char* pw);
+void flash_params_set_telemetry(const char* url, const char* port);
+void flash_params_set_telemetry_interval(uint32_t sec);
+void flash_params_set_track_interval(uint32_t sec);
+void flash_params_set_gps_grid(const gps_grid_params_t *grid);
+void flash_params_set_lte_budget(uint32_t mb, const char* thin_mountpoint);
+void flash_params_set_lte_usage(const lte_usage_params_t *usage);
+void flash_params_set_sd_log_src(uint32_t src);
 
 #endif
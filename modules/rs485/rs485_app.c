@@ -4,6 +4,8 @@
 #include "timers.h"
 #include "task.h"
 #include "semphr.h"
+#include "rtos_static.h"
+#include "mem_watermark.h"
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
@@ -11,6 +13,9 @@
 #include "board_type.h"
 #include "board_config.h"
 #include "gps_app.h"
+#include "gps_rate.h"
+#include "pos_out.h"
+#include "app_events.h"
 #include "lora_app.h"
 #include "gsm_app.h"
 #include "gsm.h"
@@ -18,6 +23,11 @@
 #include "rs485.h"
 #include "rs485_cmd.h"
 #include "rs485_port.h"
+#include "rs485_modbus.h"
+#include "irq_latency.h"
+#include "dma_ring.h"
+#include "work_queue.h"
+#include "tx_pool.h"
 
 #ifndef TAG
 #define TAG "RS485_APP"
@@ -25,14 +35,45 @@
 
 #include "log.h"
 
-TimerHandle_t gps_send_timer = NULL;
-
 static char gps_send_buf[140];
 
-static void gps_send_timer_callback(TimerHandle_t xTimer)
+static bool rs485_pos_emit(const uint8_t *data, size_t len);
+
+/**
+ * @brief 위치 출력 decimation (pos_output_decim 번째 항법 해마다)
+ *
+ * 항법 주기를 올려 한 줄씩 다 보내면 RS485 가 못 따라가는 경우
+ * 보낼 수 있는 만큼으로 decimation 을 올린다.
+ */
+static uint32_t rs485_pos_decim(void)
 {
-    gps_format_position_data(gps_send_buf);
-    rs485_send((uint8_t *)gps_send_buf, strlen(gps_send_buf));
+    uint32_t decim = flash_params_snapshot(NULL)->pos_output_decim;
+    uint32_t min_decim = gps_rate_min_decim(gps_rate_get_hz(), sizeof(gps_send_buf),
+                                            RS485_UART_BAUD);
+
+    if (decim == 0 || decim > RS485_POS_DECIM_MAX)
+    {
+        decim = 1;
+    }
+    if (decim < min_decim)
+    {
+        decim = min_decim;
+    }
+
+    return decim;
+}
+
+static pos_out_sink_t rs485_pos_sink =
+    POS_OUT_SINK_INIT("rs485", POS_OUT_FMT_USER, rs485_pos_decim, NULL, rs485_pos_emit, false);
+
+void rs485_pos_output_start(void)
+{
+    pos_out_enable(&rs485_pos_sink, true);
+}
+
+void rs485_pos_output_stop(void)
+{
+    pos_out_enable(&rs485_pos_sink, false);
 }
 
 void rs485_cmd_parse_process(rs485_instance_t *inst, const void *data, size_t len)
@@ -68,28 +109,24 @@ void rs485_cmd_parse_process(rs485_instance_t *inst, const void *data, size_t le
     }
     else if(inst->parse_stae == RS485_CMD_PARSE_STATE_DATA)
     {
-        if(inst->parser.pos < sizeof(inst->parser.data) - 1)
-        {
-          inst->parser.data[inst->parser.pos++] = (char)(*d);
-          inst->parser.data[inst->parser.pos] = '\0';
-        }
-        else
+        if(!at_cmd_line_put(&inst->parser, (char)(*d)))
         {
-          inst->parser.pos = 0;
-          inst->parser.data[inst->parser.pos] = '\0';
-          inst->parser.prev_char = '\0';
+          // 너무 긴 줄은 버림
+          at_cmd_line_reset(&inst->parser);
           inst->parse_stae = RS485_CMD_PARSE_STATE_NONE;
+          continue;
         }
 
         if(*d == '\r')
         {
-          inst->parser.data[inst->parser.pos - 1] = '\0'; // \r 제거
+          size_t line_len = --inst->parser.pos;
+
+          inst->parser.data[line_len] = '\0'; // \r 제거
           LOG_INFO("RS485 AT Command received: %s", inst->parser.data);
 
-          rs485_at_cmd_handler(inst);
+          rs485_at_cmd_handler(inst, line_len);
 
-          inst->parser.prev_char = '\0';
-          inst->parser.pos = 0;
+          at_cmd_line_reset(&inst->parser);
           inst->parse_stae = RS485_CMD_PARSE_STATE_NONE;
         }
         inst->parser.prev_char = (char)(*d);
@@ -99,28 +136,50 @@ void rs485_cmd_parse_process(rs485_instance_t *inst, const void *data, size_t le
 
 static rs485_instance_t rs485_instance = {0};
 
+#define RS485_RX_QUEUE_LEN 10
+#define RS485_TX_QUEUE_LEN 5
+#define RS485_TASK_STACK_WORDS 512
+
+RTOS_STATIC_TASK(rs485_rx, RS485_TASK_STACK_WORDS);
+RTOS_STATIC_TASK(rs485_tx, RS485_TASK_STACK_WORDS);
+RTOS_STATIC_QUEUE(rs485_rx_queue, RS485_RX_QUEUE_LEN, sizeof(uint8_t));
+RTOS_STATIC_QUEUE(rs485_tx_queue, RS485_TX_QUEUE_LEN, sizeof(tx_buf_t *));
+static StaticSemaphore_t rs485_mutex_buf;
+
+/* 깨어날 때 링에 쌓여 있던 byte */
+static mem_wm_t rs485_rx_wm = MEM_WM_INIT("rs485_rx", RS485_UART_MAX_RECV_SIZE);
+
+/**
+ * @brief IDLE 한 번에 받은 바이트 분배 (ring 끝에서 나뉘어도 링 뒤 여분에 이어 붙어 있음)
+ *
+ * Modbus 가 켜져 있으면 CRC 맞는 RTU 프레임인지 먼저 보고, 아니면 AT 파서로.
+ */
+static void rs485_rx_dispatch(rs485_instance_t *inst, const char *data, size_t len)
+{
+  if (rs485_modbus_get_addr() != 0 && len <= RS485_MODBUS_FRAME_MAX) {
+    if (rs485_modbus_process((const uint8_t *)data, len)) {
+      return;
+    }
+  }
+
+  rs485_cmd_parse_process(inst, data, len);
+}
+
 static void rs485_tx_task(void *pvParameter) {
   rs485_instance_t *inst = (rs485_instance_t *)pvParameter;
-  rs485_tx_request_t tx_req;
+  tx_buf_t *tx_req;
 
   LOG_INFO("RS485 TX Task started");
 
   while (1) {
      if (xQueueReceive(inst->tx_queue, &tx_req, portMAX_DELAY) == pdTRUE) {
-      LOG_DEBUG("RS485 Sending %d bytes", tx_req.len);
+      LOG_DEBUG("RS485 Sending %d bytes", tx_req->len);
 
       xSemaphoreTake(inst->mutex, portMAX_DELAY);
 
       if (inst->rs485.ops && inst->rs485.ops->send) {
-        if (inst->rs485.ops->tx_enable) {
-          inst->rs485.ops->tx_enable();
-        }
-
-        inst->rs485.ops->send(tx_req.data, tx_req.len);
-
-        if (inst->rs485.ops->rx_enable) {
-          inst->rs485.ops->rx_enable();
-        }
+        // DE/RE 전환은 port send 안에서 (TC 인터럽트로 수신 복귀)
+        inst->rs485.ops->send(tx_req->data, tx_req->len);
 
         LOG_DEBUG("RS485 TX complete");
       } else {
@@ -128,6 +187,7 @@ static void rs485_tx_task(void *pvParameter) {
       }
 
       xSemaphoreGive(inst->mutex);
+      tx_buf_free(tx_req);
     }
   }
 
@@ -137,11 +197,11 @@ static void rs485_tx_task(void *pvParameter) {
 static void rs485_rx_task(void *pvParameter) {
   rs485_instance_t *inst = (rs485_instance_t *)pvParameter;
 
-  size_t pos = 0;
-  size_t old_pos = 0;
+  dma_ring_t ring;
   uint8_t dummy = 0;
-  size_t total_received = 0;
 
+  dma_ring_init(&ring, rs485_port_get_recv_buf(), RS485_UART_MAX_RECV_SIZE,
+                RS485_RX_MIRROR_SIZE, 0);
   LOG_INFO("RS485 RX Task started");
 
   vTaskDelay(pdMS_TO_TICKS(2900));
@@ -149,34 +209,24 @@ static void rs485_rx_task(void *pvParameter) {
 
   while (1) {
     xQueueReceive(inst->rx_queue, &dummy, portMAX_DELAY);
+    irq_lat_task(IRQ_LAT_UART5);
 
     xSemaphoreTake(inst->mutex, portMAX_DELAY);
 
-    pos = rs485_port_get_rx_pos();
-    char *rs485_recv = rs485_port_get_recv_buf();
+    uint32_t lost;
+    uint32_t pending = dma_ring_update(&ring, rs485_port_get_rx_count(), &lost);
 
-    if (pos != old_pos) {
-      if (pos > old_pos) {
-        size_t len = pos - old_pos;
-        total_received = len;
-        LOG_DEBUG_RAW("RS485 RX: ", &rs485_recv[old_pos], len);
-        rs485_cmd_parse_process(inst, &rs485_recv[old_pos], pos - old_pos);
-      } else {
-        size_t len1 = RS485_UART_MAX_RECV_SIZE - old_pos;
-        size_t len2 = pos;
-        total_received = len1 + len2;
-        LOG_DEBUG_RAW("RS485 RX: ", &rs485_recv[old_pos], len1);
-        rs485_cmd_parse_process(inst, &rs485_recv[old_pos],
-                                RS485_UART_MAX_RECV_SIZE - old_pos);
-        if (pos > 0) {
-          LOG_DEBUG_RAW("RS485 RX: ", rs485_recv, len2);
-          rs485_cmd_parse_process(inst, rs485_recv, pos);
-        }
-      }
-      old_pos = pos;
-      if (old_pos == RS485_UART_MAX_RECV_SIZE) {
-        old_pos = 0;
-      }
+    if (lost) {
+      LOG_WARN("RX ring overrun, %lu bytes lost", lost);
+    }
+
+    if (pending > 0) {
+      const char *data = (const char *)dma_ring_linear(&ring);
+
+      LOG_DEBUG_RAW("RS485 RX: ", data, pending);
+      rs485_rx_dispatch(inst, data, pending);
+      mem_wm_update(&rs485_rx_wm, pending + lost < ring.size ? pending + lost : ring.size);
+      dma_ring_consume(&ring, pending);
     }
 
     xSemaphoreGive(inst->mutex);
@@ -196,6 +246,7 @@ void rs485_init_all(void) {
   }
 
   rs485_instance.enabled = true;
+  rs485_cmd_init();
 
   if (rs485_port_init_instance(&rs485_instance.rs485) != 0) {
     LOG_ERR("RS485 포트 초기화 실패");
@@ -203,63 +254,25 @@ void rs485_init_all(void) {
     return;
   }
 
-  rs485_instance.rx_queue = xQueueCreate(10, sizeof(uint8_t));
-  if (rs485_instance.rx_queue == NULL) {
-    LOG_ERR("RS485 RX 큐 생성 실패");
-    rs485_instance.enabled = false;
-    return;
-  }
+  rs485_instance.rx_queue = RTOS_QUEUE_CREATE_STATIC(rs485_rx_queue, RS485_RX_QUEUE_LEN,
+                                                     sizeof(uint8_t));
 
   rs485_port_set_queue(rs485_instance.rx_queue);
+  mem_wm_register(&rs485_rx_wm);
 
-  rs485_instance.tx_queue = xQueueCreate(5, sizeof(rs485_tx_request_t));
-  if (rs485_instance.tx_queue == NULL) {
-    LOG_ERR("RS485 TX 큐 생성 실패");
-    rs485_instance.enabled = false;
-    return;
-  }
-
-  rs485_instance.mutex = xSemaphoreCreateMutex();
-  if (rs485_instance.mutex == NULL) {
-    LOG_ERR("RS485 mutex 생성 실패");
-    rs485_instance.enabled = false;
-    return;
-  }
+  rs485_instance.tx_queue = RTOS_QUEUE_CREATE_STATIC(rs485_tx_queue, RS485_TX_QUEUE_LEN,
+                                                     sizeof(tx_buf_t *));
+  rs485_instance.mutex = xSemaphoreCreateMutexStatic(&rs485_mutex_buf);
 
   rs485_port_start(&rs485_instance.rs485);
 
-  BaseType_t ret = xTaskCreate(rs485_rx_task, "rs485_rx", 512,
-                                (void *)&rs485_instance,
-                                tskIDLE_PRIORITY + 1, &rs485_instance.rx_task);
-
-  if (ret != pdPASS) {
-    LOG_ERR("RS485 RX 태스크 생성 실패");
-    rs485_instance.enabled = false;
-    return;
-  }
-
-  ret = xTaskCreate(rs485_tx_task, "rs485_tx", 512,
-                    (void *)&rs485_instance,
-                    tskIDLE_PRIORITY + 3, &rs485_instance.tx_task);
+  rs485_instance.rx_task = RTOS_TASK_CREATE_STATIC(rs485_rx, rs485_rx_task, "rs485_rx",
+                                                   (void *)&rs485_instance, tskIDLE_PRIORITY + 1);
+  rs485_instance.tx_task = RTOS_TASK_CREATE_STATIC(rs485_tx, rs485_tx_task, "rs485_tx",
+                                                   (void *)&rs485_instance, tskIDLE_PRIORITY + 3);
 
-  if (ret != pdPASS) {
-    LOG_ERR("RS485 TX 태스크 생성 실패");
-    rs485_instance.enabled = false;
-    return;
-  }
-    
-  gps_send_timer = xTimerCreate(
-    "GPS_Send",           // Timer name
-    pdMS_TO_TICKS(50),          // Timer period (50ms)
-    pdTRUE,                     // Auto-reload
-    NULL,                       // Timer ID (not used)
-    gps_send_timer_callback     // Callback function
-  );
-
-  if (gps_send_timer == NULL)
-  {
-    LOG_ERR("Failed to create GPS send timer");
-  }
+  rs485_modbus_init();
+  pos_out_register(&rs485_pos_sink);
 
   LOG_INFO("RS485 초기화 완료");
 }
@@ -272,29 +285,74 @@ rs485_t *rs485_get_handle(void) {
   return &rs485_instance.rs485;
 }
 
-bool rs485_send(const char *data, size_t len) {
+static bool rs485_queue_send(const char *data, size_t len, TickType_t wait) {
   if (!rs485_instance.enabled) {
     LOG_ERR("RS485 not enabled");
     return false;
   }
 
-  if (!data || len == 0 || len > 256) {
+  if (!data || len == 0 || len > TX_POOL_MID_SIZE) {
     LOG_ERR("RS485 invalid send parameters");
     return false;
   }
 
-  rs485_tx_request_t tx_req;
-  memcpy(tx_req.data, data, len);
-  tx_req.len = len;
+  tx_buf_t *tx_req = tx_buf_dup(data, len, wait);
+  if (!tx_req) {
+    if (wait > 0) {
+      LOG_ERR("RS485 TX buffer pool empty");
+    }
+    return false;
+  }
 
-  if (xQueueSend(rs485_instance.tx_queue, &tx_req, pdMS_TO_TICKS(1000)) != pdTRUE) {
-    LOG_ERR("RS485 TX queue full");
+  if (xQueueSend(rs485_instance.tx_queue, &tx_req, wait) != pdTRUE) {
+    if (wait > 0) {
+      LOG_ERR("RS485 TX queue full");
+    }
+    tx_buf_free(tx_req);
     return false;
   }
 
   return true;
 }
 
+/* rs485_run_line() 중인 태스크의 응답 경로 */
+static rs485_reply_t rs485_reply;
+static TaskHandle_t rs485_reply_task;
+
+bool rs485_send(const char *data, size_t len) {
+  if (rs485_reply && rs485_reply_task == xTaskGetCurrentTaskHandle()) {
+    return rs485_reply(data, len);
+  }
+  return rs485_queue_send(data, len, pdMS_TO_TICKS(1000));
+}
+
+bool rs485_run_line(const char *line, size_t len, rs485_reply_t reply) {
+  bool found;
+
+  if (!rs485_instance.enabled || !rs485_instance.mutex) {
+    return false;
+  }
+
+  xSemaphoreTake(rs485_instance.mutex, portMAX_DELAY);
+  rs485_reply_task = xTaskGetCurrentTaskHandle();
+  rs485_reply = reply;
+  found = rs485_at_cmd_run(line, len);
+  rs485_reply = NULL;
+  xSemaphoreGive(rs485_instance.mutex);
+
+  return found;
+}
+
+
+/**
+ * @brief 새 항법 해의 위치 (pos_out sink) - TX 큐에 넣는다
+ *
+ * 출력 관리자를 막지 않도록 큐가 차 있으면 이번 해는 버린다.
+ */
+static bool rs485_pos_emit(const uint8_t *data, size_t len)
+{
+    return rs485_queue_send((const char *)data, len, 0);
+}
 
 rs485_instance_t* rs485_get_instance(void) {
   return &rs485_instance;
@@ -324,6 +382,8 @@ char *ERROR2_Response = "+E02\r";  // Parameter ERROR
 char *ERROR3_Response = "+E03\r";  // NO ready device ERROR
 
 static SemaphoreHandle_t rs485_tx_mutex;
+static StaticSemaphore_t rs485_tx_mutex_buf;
+RTOS_STATIC_TASK(soft_rs485, 512);
 
 volatile bool is_gugu_started = false;
 
@@ -503,6 +563,7 @@ void RS485_SetReceiveMode(void)
   HAL_GPIO_WritePin(RS485_RE_PORT, RS485_RE_PIN, GPIO_PIN_RESET); // DE=0, RE=0 (수신)
 }
 
+#if !SOFTUART_USE_DMA
 void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
 {
   if (htim->Instance == TIM1)
@@ -510,6 +571,7 @@ void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
     SoftUartHandler();
   }
 }
+#endif
 
 int get_line(uint8_t SoftUartNumber, char *buffer, int maxlen)
 {
@@ -555,22 +617,51 @@ static void base_config_complete(bool success, void *user_data)
   base_init_finished = true;
 }
 
-static void send_gps_task(void *pvParameters)
+// pos_out 이 만든 마지막 위치 (워커가 보내기 전에 다음 해가 덮을 수 있음)
+static uint8_t soft_pos_buf[POS_OUT_BUF_SIZE];
+static size_t soft_pos_len;
+
+// 위치 한 줄 송신 (공용 LOW 워커, soft UART 송신 완료까지 잠듦)
+static void send_gps_work(work_t *work)
 {
-  char buf[120];
-  TickType_t xLastWakeTime = xTaskGetTickCount();
+  uint8_t buf[POS_OUT_BUF_SIZE];
+  size_t len;
 
-  while (1)
+  (void)work;
+
+  taskENTER_CRITICAL();
+  len = soft_pos_len;
+  memcpy(buf, soft_pos_buf, len);
+  soft_pos_len = 0;
+  taskEXIT_CRITICAL();
+
+  if (is_gugu_started && len > 0)
   {
-    vTaskDelayUntil(&xLastWakeTime, pdMS_TO_TICKS(2000));
-    if (is_gugu_started)
-    {
-      gps_format_position_data(buf);
-      RS485_Send((uint8_t *)buf, strlen(buf));
-    }
+    RS485_Send(buf, len);
   }
 }
 
+static work_t send_gps = WORK_INIT(send_gps_work, NULL, WORK_PRIO_LOW);
+
+// soft UART 송신은 끝날 때까지 막히므로 출력 관리자 대신 워커에 넘긴다
+static bool soft_pos_emit(const uint8_t *data, size_t len)
+{
+  if (!is_gugu_started || len > sizeof(soft_pos_buf))
+  {
+    return false;
+  }
+
+  taskENTER_CRITICAL();
+  memcpy(soft_pos_buf, data, len);
+  soft_pos_len = len;
+  taskEXIT_CRITICAL();
+
+  return work_submit(&send_gps);
+}
+
+static pos_out_sink_t soft_pos_sink =
+    POS_OUT_SINK_INIT("soft485", POS_OUT_FMT_USER, rs485_pos_decim, NULL, soft_pos_emit, true);
+
 static void rs485_task(void *pvParameter)
 {
   char ch;
@@ -867,21 +958,14 @@ static void rs485_task(void *pvParameter)
     else if (strncmp(rx_buffer, "AT+SAVE\r", 8) == 0)
     {
       user_params_t *params = flash_params_get_current();
-      if (flash_params_erase() != HAL_OK)
+      if (flash_params_save(params) != HAL_OK)
       {
         RS485_Send(ERROR_Response, strlen(ERROR_Response));
       }
       else
       {
-        if (flash_params_write(params) != HAL_OK)
-        {
-          RS485_Send(ERROR_Response, strlen(ERROR_Response));
-        }
-        else
-        {
-          RS485_Send((uint8_t *)"+SAVE\r", strlen("+SAVE\r"));
-          NVIC_SystemReset();
-        }
+        RS485_Send((uint8_t *)"+SAVE\r", strlen("+SAVE\r"));
+        NVIC_SystemReset();
       }
     }
     else
@@ -893,9 +977,9 @@ static void rs485_task(void *pvParameter)
 
 void rs485_app_init(void)
 {
-  rs485_tx_mutex = xSemaphoreCreateMutex();
-  xTaskCreate(rs485_task, "RS485_Task", 512, NULL, tskIDLE_PRIORITY + 1, NULL);
-  xTaskCreate(send_gps_task, "send_gps", 512, NULL, tskIDLE_PRIORITY + 1, NULL);
+  rs485_tx_mutex = xSemaphoreCreateMutexStatic(&rs485_tx_mutex_buf);
+  RTOS_TASK_CREATE_STATIC(soft_rs485, rs485_task, "RS485_Task", NULL, tskIDLE_PRIORITY + 1);
+  pos_out_register(&soft_pos_sink);
 }
 
 #endif
@@ -8,12 +8,17 @@
 #include "semphr.h"
 #include "task.h"
 #include "rs485.h"
+#include "at_cmd.h"
+#include "board_config.h"
 #include <stdbool.h>
 #include <stdint.h>
 
-#define RS485_UART_MAX_RECV_SIZE 512
+#define RS485_UART_MAX_RECV_SIZE RS485_RX_RING_SIZE
 
-extern TimerHandle_t gps_send_timer;
+/**
+ * @brief 위치 출력 decimation 상한 (AT+POSDEC)
+ */
+#define RS485_POS_DECIM_MAX 100
 
 typedef enum
 {
@@ -22,18 +27,6 @@ typedef enum
   RS485_CMD_PARSE_STATE_DATA,
 }rs485_cmd_parse_state_t;
 
-typedef struct {
-  char data[256];
-  size_t len;
-} rs485_tx_request_t;
-
-typedef struct
-{
-  char data[128];
-  size_t pos;
-  char prev_char;
-}rs485_cmd_parser_t;
-
 typedef enum
 {
   RTK_ACTIVE_STATUS_NONE = 0,
@@ -44,7 +37,7 @@ typedef enum
 typedef struct {
   rs485_t rs485;
   rs485_cmd_parse_state_t parse_stae;
-  rs485_cmd_parser_t parser;
+  at_cmd_line_t parser;
   QueueHandle_t rx_queue;
   TaskHandle_t rx_task;
   bool enabled;
@@ -61,6 +54,28 @@ rs485_t *rs485_get_handle(void);
 rs485_instance_t* rs485_get_instance(void);
 bool rs485_send(const char *data, size_t len);
 
+typedef bool (*rs485_reply_t)(const char *data, size_t len);
+
+/**
+ * @brief 다른 포트 (USB) 에서 받은 커맨드 줄 처리
+ *
+ * RS485 RX 와 같은 잠금 안에서 돌고, 그동안 이 태스크의 rs485_send() 는
+ * reply 로 간다.
+ *
+ * @param line NUL 로 끝나는 줄 ("AT+..")
+ * @return false RS485 꺼짐 또는 없는 커맨드
+ */
+bool rs485_run_line(const char *line, size_t len, rs485_reply_t reply);
+
+/**
+ * @brief 위치 출력 시작/중지
+ *
+ * 시작하면 GPS 의 새 항법 해마다 (pos_output_decim 번째마다) 한 번씩
+ * 설정된 형식 (pos_out 이 epoch 당 한 번 만든 것) 을 보낸다.
+ */
+void rs485_pos_output_start(void);
+void rs485_pos_output_stop(void);
+
 #if USE_SOFTUART
 
 #define SOFT_UART_TX_PIN        GPIO_PIN_2
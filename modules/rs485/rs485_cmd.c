@@ -8,11 +8,33 @@
 #include "semphr.h"
 #include "flash_params.h"
 #include "gps_app.h"
+#include "gps_rate.h"
+#include "gps_time.h"
+#include "gps_tee.h"
+#include "gps_grid.h"
+#include "pos_out.h"
 #include "lora_app.h"
 #include "gsm_app.h"
 #include "gsm.h"
 #include "lte_init.h"
 #include "rs485_app.h"
+#include "rs485_modbus.h"
+#include "rtcm_router.h"
+#include "ntrip_monitor.h"
+#include "ntrip_server.h"
+#include "telemetry.h"
+#include "track_log.h"
+#include "sd_log.h"
+#include "lora_stats.h"
+#include "rtos_stats.h"
+#include "irq_latency.h"
+#include "epoch_deadline.h"
+#include "boot_timeline.h"
+#include "boot_stage.h"
+#include "pm_trace.h"
+#include "heap_track.h"
+#include "mem_watermark.h"
+#include "diag_bundle.h"
 
 #ifndef TAG
 #define TAG "RS485_CMD"
@@ -20,55 +42,242 @@
 
 #include "log.h"
 
-static const char *rs485_resp_str_ok = "OK\r";
-static const char *rs485_resp_str_invalid = "+E01\r";
-static const char *rs485_resp_str_param_err = "+E02\r";
-static const char *rs485_resp_str_not_rdy = "+E03\r";
-static const char *rs485_resp_str_err = "+ERROR\r";
+static const at_resp_t rs485_resp_ok = AT_RESP("OK\r");
+static const at_resp_t rs485_resp_invalid = AT_RESP("+E01\r");
+static const at_resp_t rs485_resp_param_err = AT_RESP("+E02\r");
+static const at_resp_t rs485_resp_not_rdy = AT_RESP("+E03\r");
+static const at_resp_t rs485_resp_err = AT_RESP("+ERROR\r");
 
 #define RS485_AT_RESP_SEND(data) rs485_send(data, strlen(data))
-#define RS485_AT_RESP_SEND_OK() RS485_AT_RESP_SEND(rs485_resp_str_ok)
-#define RS485_AT_RESP_SEND_INVALID() RS485_AT_RESP_SEND(rs485_resp_str_invalid)
-#define RS485_AT_RESP_SEND_PARAM_ERR() RS485_AT_RESP_SEND(rs485_resp_str_param_err)
-#define RS485_AT_RESP_SEND_NOT_RDY() RS485_AT_RESP_SEND(rs485_resp_str_not_rdy)
-#define RS485_AT_RESP_SEND_ERR() RS485_AT_RESP_SEND(rs485_resp_str_err)
-
-static void at_handler(const char *param);
-static void atz_handler(const char *param);
-static void atandz_handler(const char *param);
-static void at_ver_handler(const char *param);
-static void at_gps_manuf_handler(const char *param);
-static void at_read_config_handler(const char *param);
-static void at_set_baseline_handler(const char *param);
-static void at_set_ntrip_ip_handler(const char *param);
-static void at_set_ntrip_id_handler(const char *param);
-static void at_set_ntrip_mountpoint_handler(const char *param);
-static void at_set_ntrip_passwd_handler(const char *param);
-static void at_set_rtk_start_handler(const char *param);
-static void at_set_rtk_stop_handler(const char *param);
-static void at_save_handler(const char *param);
-
-static const at_cmd_entry_t at_cmd_table[] = {
-	    {"AT+GPSMANUF?", at_gps_manuf_handler},
-	    {"AT+CONFIG?", at_read_config_handler},
-	    {"AT+SETBASELINE:", at_set_baseline_handler},
-	    {"AT+GUGUSTART:", at_set_rtk_start_handler},
-	    {"AT+GUGUSTOP", at_set_rtk_stop_handler},
-	    {"AT+CASTER:", at_set_ntrip_ip_handler},
-	    {"AT+MOUNTPOINT=", at_set_ntrip_mountpoint_handler},
-	    {"AT+PASSWD=", at_set_ntrip_passwd_handler},
-	    {"AT+VER?", at_ver_handler},
-	    {"AT+ID=", at_set_ntrip_id_handler},
-      {"AT+SAVE", at_save_handler},
-	    {"AT&F", atandz_handler},
-	    {"ATZ", atz_handler},
-	    {"AT", at_handler},
-    {NULL, NULL}};
+#define RS485_AT_RESP_SEND_FIXED(resp) rs485_send((resp).str, (resp).len)
+#define RS485_AT_RESP_SEND_OK() RS485_AT_RESP_SEND_FIXED(rs485_resp_ok)
+#define RS485_AT_RESP_SEND_INVALID() RS485_AT_RESP_SEND_FIXED(rs485_resp_invalid)
+#define RS485_AT_RESP_SEND_PARAM_ERR() RS485_AT_RESP_SEND_FIXED(rs485_resp_param_err)
+#define RS485_AT_RESP_SEND_NOT_RDY() RS485_AT_RESP_SEND_FIXED(rs485_resp_not_rdy)
+#define RS485_AT_RESP_SEND_ERR() RS485_AT_RESP_SEND_FIXED(rs485_resp_err)
+
+static void at_handler(void *ctx, const char *param, size_t param_len);
+static void atz_handler(void *ctx, const char *param, size_t param_len);
+static void atandz_handler(void *ctx, const char *param, size_t param_len);
+static void at_ver_handler(void *ctx, const char *param, size_t param_len);
+static void at_gps_manuf_handler(void *ctx, const char *param, size_t param_len);
+static void at_read_config_handler(void *ctx, const char *param, size_t param_len);
+static void at_set_baseline_handler(void *ctx, const char *param, size_t param_len);
+static void at_set_ntrip_ip_handler(void *ctx, const char *param, size_t param_len);
+static void at_set_ntrip_standby_handler(void *ctx, const char *param, size_t param_len);
+static void at_set_ntrip_server_handler(void *ctx, const char *param, size_t param_len);
+static void at_set_ntrip_server_auth_handler(void *ctx, const char *param, size_t param_len);
+static void at_ntrip_server_handler(void *ctx, const char *param, size_t param_len);
+static void at_set_ntrip_id_handler(void *ctx, const char *param, size_t param_len);
+static void at_set_ntrip_mountpoint_handler(void *ctx, const char *param, size_t param_len);
+static void at_set_ntrip_passwd_handler(void *ctx, const char *param, size_t param_len);
+static void at_set_rtk_start_handler(void *ctx, const char *param, size_t param_len);
+static void at_set_rtk_stop_handler(void *ctx, const char *param, size_t param_len);
+static void at_save_handler(void *ctx, const char *param, size_t param_len);
+static void at_corr_latency_handler(void *ctx, const char *param, size_t param_len);
+static void at_corr_latency_reset_handler(void *ctx, const char *param, size_t param_len);
+static void at_ntrip_stat_handler(void *ctx, const char *param, size_t param_len);
+static void at_ntrip_stat_reset_handler(void *ctx, const char *param, size_t param_len);
+static void at_lora_stat_handler(void *ctx, const char *param, size_t param_len);
+static void at_lora_stat_reset_handler(void *ctx, const char *param, size_t param_len);
+static void at_set_pos_decim_handler(void *ctx, const char *param, size_t param_len);
+static void at_pos_decim_handler(void *ctx, const char *param, size_t param_len);
+static void at_set_pos_latency_handler(void *ctx, const char *param, size_t param_len);
+static void at_pos_latency_handler(void *ctx, const char *param, size_t param_len);
+static void at_pos_out_handler(void *ctx, const char *param, size_t param_len);
+static void at_set_gps_tee_handler(void *ctx, const char *param, size_t param_len);
+static void at_gps_tee_handler(void *ctx, const char *param, size_t param_len);
+static void at_set_nav_rate_handler(void *ctx, const char *param, size_t param_len);
+static void at_nav_rate_handler(void *ctx, const char *param, size_t param_len);
+static void at_set_modbus_handler(void *ctx, const char *param, size_t param_len);
+static void at_modbus_handler(void *ctx, const char *param, size_t param_len);
+static void at_task_stat_handler(void *ctx, const char *param, size_t param_len);
+static void at_task_stat_reset_handler(void *ctx, const char *param, size_t param_len);
+static void at_set_log_level_handler(void *ctx, const char *param, size_t param_len);
+static void at_log_level_handler(void *ctx, const char *param, size_t param_len);
+static void at_boot_timeline_handler(void *ctx, const char *param, size_t param_len);
+static void at_boot_timeline_prev_handler(void *ctx, const char *param, size_t param_len);
+static void at_heap_handler(void *ctx, const char *param, size_t param_len);
+static void at_heap_reset_handler(void *ctx, const char *param, size_t param_len);
+static void at_pm_trace_handler(void *ctx, const char *param, size_t param_len);
+static void at_pm_trace_prev_handler(void *ctx, const char *param, size_t param_len);
+static void at_wm_handler(void *ctx, const char *param, size_t param_len);
+static void at_wm_reset_handler(void *ctx, const char *param, size_t param_len);
+static void at_irq_latency_handler(void *ctx, const char *param, size_t param_len);
+static void at_irq_latency_reset_handler(void *ctx, const char *param, size_t param_len);
+static void at_epoch_dl_handler(void *ctx, const char *param, size_t param_len);
+static void at_epoch_dl_reset_handler(void *ctx, const char *param, size_t param_len);
+static void at_set_telemetry_handler(void *ctx, const char *param, size_t param_len);
+static void at_telemetry_handler(void *ctx, const char *param, size_t param_len);
+static void at_set_telemetry_interval_handler(void *ctx, const char *param, size_t param_len);
+static void at_track_handler(void *ctx, const char *param, size_t param_len);
+static void at_track_clear_handler(void *ctx, const char *param, size_t param_len);
+static void at_track_download_handler(void *ctx, const char *param, size_t param_len);
+static void at_track_flush_handler(void *ctx, const char *param, size_t param_len);
+static void at_set_track_interval_handler(void *ctx, const char *param, size_t param_len);
+static void at_sd_log_handler(void *ctx, const char *param, size_t param_len);
+static void at_set_sd_log_handler(void *ctx, const char *param, size_t param_len);
+static void at_sd_format_handler(void *ctx, const char *param, size_t param_len);
+static void at_set_grid_handler(void *ctx, const char *param, size_t param_len);
+static void at_grid_handler(void *ctx, const char *param, size_t param_len);
+static void at_set_grid_datum_handler(void *ctx, const char *param, size_t param_len);
+static void at_rx_diag_handler(void *ctx, const char *param, size_t param_len);
+static void at_diag_handler(void *ctx, const char *param, size_t param_len);
+static void at_diag_read_handler(void *ctx, const char *param, size_t param_len);
+static void at_diag_lte_handler(void *ctx, const char *param, size_t param_len);
+
+// 이름 순(strcmp)으로 정렬해서 추가, 겹치는 이름은 가장 긴 것이 선택됨
+static const at_cmd_entry_t at_cmd_entries[] = {
+    AT_CMD("AT", at_handler),
+    AT_CMD("AT&F", atandz_handler),
+    AT_CMD("AT+BOOT?", at_boot_timeline_handler),
+    AT_CMD("AT+BOOTPREV?", at_boot_timeline_prev_handler),
+    AT_CMD("AT+CASTER2:", at_set_ntrip_standby_handler),
+    AT_CMD("AT+CASTER:", at_set_ntrip_ip_handler),
+    AT_CMD("AT+CLAT?", at_corr_latency_handler),
+    AT_CMD("AT+CLATRST", at_corr_latency_reset_handler),
+    AT_CMD("AT+CONFIG?", at_read_config_handler),
+    AT_CMD("AT+DIAG=", at_diag_read_handler),
+    AT_CMD("AT+DIAG?", at_diag_handler),
+    AT_CMD("AT+DIAGTX", at_diag_lte_handler),
+    AT_CMD("AT+EPDL?", at_epoch_dl_handler),
+    AT_CMD("AT+EPDLRST", at_epoch_dl_reset_handler),
+    AT_CMD("AT+GPSMANUF?", at_gps_manuf_handler),
+    AT_CMD("AT+GRID=", at_set_grid_handler),
+    AT_CMD("AT+GRID?", at_grid_handler),
+    AT_CMD("AT+GRIDDS=", at_set_grid_datum_handler),
+    AT_CMD("AT+GTEE=", at_set_gps_tee_handler),
+    AT_CMD("AT+GTEE?", at_gps_tee_handler),
+    AT_CMD("AT+GUGUSTART:", at_set_rtk_start_handler),
+    AT_CMD("AT+GUGUSTOP", at_set_rtk_stop_handler),
+    AT_CMD("AT+HEAP?", at_heap_handler),
+    AT_CMD("AT+HEAPRST", at_heap_reset_handler),
+    AT_CMD("AT+ID=", at_set_ntrip_id_handler),
+    AT_CMD("AT+IRQLAT?", at_irq_latency_handler),
+    AT_CMD("AT+IRQLATRST", at_irq_latency_reset_handler),
+    AT_CMD("AT+LOGLV=", at_set_log_level_handler),
+    AT_CMD("AT+LOGLV?", at_log_level_handler),
+    AT_CMD("AT+LSTAT?", at_lora_stat_handler),
+    AT_CMD("AT+LSTATRST", at_lora_stat_reset_handler),
+    AT_CMD("AT+MODBUS=", at_set_modbus_handler),
+    AT_CMD("AT+MODBUS?", at_modbus_handler),
+    AT_CMD("AT+MOUNTPOINT=", at_set_ntrip_mountpoint_handler),
+    AT_CMD("AT+NAVRATE=", at_set_nav_rate_handler),
+    AT_CMD("AT+NAVRATE?", at_nav_rate_handler),
+    AT_CMD("AT+NSRV:", at_set_ntrip_server_handler),
+    AT_CMD("AT+NSRV?", at_ntrip_server_handler),
+    AT_CMD("AT+NSRVPW=", at_set_ntrip_server_auth_handler),
+    AT_CMD("AT+NSTAT?", at_ntrip_stat_handler),
+    AT_CMD("AT+NSTATRST", at_ntrip_stat_reset_handler),
+    AT_CMD("AT+PASSWD=", at_set_ntrip_passwd_handler),
+    AT_CMD("AT+PMT?", at_pm_trace_handler),
+    AT_CMD("AT+PMTPREV?", at_pm_trace_prev_handler),
+    AT_CMD("AT+POSDEC=", at_set_pos_decim_handler),
+    AT_CMD("AT+POSDEC?", at_pos_decim_handler),
+    AT_CMD("AT+POSLAT=", at_set_pos_latency_handler),
+    AT_CMD("AT+POSLAT?", at_pos_latency_handler),
+    AT_CMD("AT+POSOUT?", at_pos_out_handler),
+    AT_CMD("AT+RXDIAG?", at_rx_diag_handler),
+    AT_CMD("AT+SAVE", at_save_handler),
+    AT_CMD("AT+SDFMT", at_sd_format_handler),
+    AT_CMD("AT+SDLOG=", at_set_sd_log_handler),
+    AT_CMD("AT+SDLOG?", at_sd_log_handler),
+    AT_CMD("AT+SETBASELINE:", at_set_baseline_handler),
+    AT_CMD("AT+TASK?", at_task_stat_handler),
+    AT_CMD("AT+TASKRST", at_task_stat_reset_handler),
+    AT_CMD("AT+TELEM:", at_set_telemetry_handler),
+    AT_CMD("AT+TELEM?", at_telemetry_handler),
+    AT_CMD("AT+TELEMINT=", at_set_telemetry_interval_handler),
+    AT_CMD("AT+TRK?", at_track_handler),
+    AT_CMD("AT+TRKCLR", at_track_clear_handler),
+    AT_CMD("AT+TRKDL=", at_track_download_handler),
+    AT_CMD("AT+TRKFL", at_track_flush_handler),
+    AT_CMD("AT+TRKINT=", at_set_track_interval_handler),
+    AT_CMD("AT+VER?", at_ver_handler),
+    AT_CMD("AT+WM?", at_wm_handler),
+    AT_CMD("AT+WMRST", at_wm_reset_handler),
+    AT_CMD("ATZ", atz_handler),
+};
+
+static const at_cmd_table_t at_cmd_table = AT_CMD_TABLE(at_cmd_entries);
 
 volatile bool base_init_finish = false;
 volatile bool is_gugu_start = false;
 rtk_active_status_t active_status = RTK_ACTIVE_STATUS_NONE;
 
+rtk_active_status_t rs485_cmd_get_active_status(void)
+{
+    return active_status;
+}
+
+// AT+DIAG=<off> 한 번에 보내는 진단 묶음 조각
+#define RS485_DIAG_CHUNK 512
+
+/**
+ * @brief 진단 묶음 (diag_bundle.h) 을 새로 만듦
+ *
+ * +DIAG=<len>,<crc16 hex>. 내용은 AT+DIAG=<off> 로 조각씩 읽는다.
+ */
+static void at_diag_handler(void *ctx, const char *param, size_t param_len)
+{
+    uint16_t crc;
+    size_t len = diag_bundle_build(&crc);
+    char buf[32];
+
+    if (len == 0)
+    {
+        RS485_AT_RESP_SEND_NOT_RDY();
+        return;
+    }
+
+    sprintf(buf, "+DIAG=%u,%04X\r", (unsigned)len, crc);
+    RS485_AT_RESP_SEND(buf);
+}
+
+/**
+ * @brief 진단 묶음 조각: +DIAG=<off>,<n> 줄 다음 n byte 그대로, 그 뒤 OK
+ */
+static void at_diag_read_handler(void *ctx, const char *param, size_t param_len)
+{
+    static uint8_t data[RS485_DIAG_CHUNK];
+    char *end;
+    unsigned long off = strtoul(param, &end, 10);
+    size_t n;
+    char buf[32];
+
+    if (end == param)
+    {
+        RS485_AT_RESP_SEND_PARAM_ERR();
+        return;
+    }
+
+    n = diag_bundle_read(off, data, sizeof(data));
+    if (n == 0)
+    {
+        RS485_AT_RESP_SEND_PARAM_ERR();
+        return;
+    }
+
+    sprintf(buf, "+DIAG=%lu,%u\r", off, (unsigned)n);
+    RS485_AT_RESP_SEND(buf);
+    rs485_send((const char *)data, n);
+    RS485_AT_RESP_SEND_OK();
+}
+
+/**
+ * @brief 진단 묶음을 LTE telemetry 로 보냄 (telemetry 가 동작 중일 때)
+ */
+static void at_diag_lte_handler(void *ctx, const char *param, size_t param_len)
+{
+    if (!telemetry_send_diag())
+    {
+        RS485_AT_RESP_SEND_NOT_RDY();
+        return;
+    }
+
+    RS485_AT_RESP_SEND_OK();
+}
+
 static void base_init_complete(bool success, void *user_data)
 {
   gps_id_t id = (gps_id_t)(uintptr_t)user_data;
@@ -77,32 +286,35 @@ static void base_init_complete(bool success, void *user_data)
   base_init_finish = true;
 }
 
-void rs485_at_cmd_handler(rs485_instance_t *inst)
+void rs485_cmd_init(void)
 {
-    for (int i = 0; at_cmd_table[i].name != NULL; i++)
-    {
-        size_t name_len = strlen(at_cmd_table[i].name);
+    int bad = at_cmd_table_check(&at_cmd_table);
 
-        if (strncmp(inst->parser.data, at_cmd_table[i].name, name_len) == 0)
-        {
-            at_cmd_table[i].handler(inst->parser.data + name_len);
-            return;
-        }
+    if (bad >= 0)
+    {
+        LOG_ERR("RS485 cmd table not sorted at %s", at_cmd_entries[bad].name);
     }
 }
 
-static void at_handler(const char *param)
+void rs485_at_cmd_handler(rs485_instance_t *inst, size_t len)
+{
+    at_cmd_dispatch(&at_cmd_table, inst, inst->parser.data, len);
+}
+
+bool rs485_at_cmd_run(const char *line, size_t len)
+{
+    return at_cmd_dispatch(&at_cmd_table, rs485_get_instance(), line, len);
+}
+
+static void at_handler(void *ctx, const char *param, size_t param_len)
 {
     RS485_AT_RESP_SEND_OK();
 }
 
-static void atz_handler(const char *param)
+static void atz_handler(void *ctx, const char *param, size_t param_len)
 {
     // xSemaphoreTake(rs485_get_instance()->mutex, portMAX_DELAY);
-    rs485_get_handle()->ops->tx_enable();
     rs485_get_handle()->ops->send("+RESET\r", strlen("+RESET\r"));
-    vTaskDelay(pdMS_TO_TICKS(2));
-    rs485_get_handle()->ops->rx_enable();
     // xSemaphoreGive(rs485_get_instance()->mutex);
 
     vTaskDelay(pdMS_TO_TICKS(200));
@@ -110,14 +322,11 @@ static void atz_handler(const char *param)
     HAL_NVIC_SystemReset();
 }
 
-static void atandz_handler(const char *param)
+static void atandz_handler(void *ctx, const char *param, size_t param_len)
 {
     if(flash_params_erase() == HAL_OK)
     {
-        rs485_get_handle()->ops->tx_enable();
         rs485_get_handle()->ops->send("+CONFIGINIT\r", strlen("+CONFIGINIT\r"));
-        vTaskDelay(pdMS_TO_TICKS(2));
-        rs485_get_handle()->ops->rx_enable();
 
         vTaskDelay(pdMS_TO_TICKS(200));
         NVIC_SystemReset();
@@ -128,14 +337,14 @@ static void atandz_handler(const char *param)
     }
 }
 
-static void at_ver_handler(const char *param)
+static void at_ver_handler(void *ctx, const char *param, size_t param_len)
 {
     char version_str[20];
     sprintf(version_str, "%s\r", BOARD_VERSION);
     RS485_AT_RESP_SEND(version_str);
 }
 
-static void at_gps_manuf_handler(const char *param)
+static void at_gps_manuf_handler(void *ctx, const char *param, size_t param_len)
 {
     const board_config_t *config = board_get_config();
     char manuf_str[20];
@@ -157,7 +366,7 @@ static void at_gps_manuf_handler(const char *param)
     RS485_AT_RESP_SEND(manuf_str);
 }
 
-static void at_read_config_handler(const char *param)
+static void at_read_config_handler(void *ctx, const char *param, size_t param_len)
 {
     user_params_t *params = flash_params_get_current();
 
@@ -180,7 +389,7 @@ static void at_read_config_handler(const char *param)
     RS485_AT_RESP_SEND(resp_str);
 }
 
-static void at_set_baseline_handler(const char *param)
+static void at_set_baseline_handler(void *ctx, const char *param, size_t param_len)
 {
     float baseline_value = strtof(param, NULL);
 
@@ -197,7 +406,7 @@ static void at_set_baseline_handler(const char *param)
       }
 }
 
-static void at_set_ntrip_ip_handler(const char *param)
+static void at_set_ntrip_ip_handler(void *ctx, const char *param, size_t param_len)
 {
     user_params_t *params = flash_params_get_current();
     char buf[72];
@@ -234,7 +443,155 @@ static void at_set_ntrip_ip_handler(const char *param)
     }
 }
 
-static void at_set_ntrip_id_handler(const char *param)
+/**
+ * @brief 보조(hot standby) 캐스터 설정
+ *
+ * 형식: AT+CASTER2:host:port/mountpoint, 값이 없으면 보조 캐스터 끔.
+ * 계정은 주 캐스터(AT+ID, AT+PASSWD)와 같이 쓴다. GUGUSTART 때 적용된다.
+ */
+static void at_set_ntrip_standby_handler(void *ctx, const char *param, size_t param_len)
+{
+    user_params_t *params = flash_params_get_current();
+    char buf[128];
+    char host[64] = {0};
+    char port[8] = {0};
+    char mount[32] = {0};
+
+    size_t len = param_len; // 파서가 \r 을 떼고 길이를 넘겨 줌
+
+    if (len == 0)
+    {
+        flash_params_set_ntrip_standby("", "", "");
+        rs485_send("+CASTER2=\r", sizeof("+CASTER2=\r") - 1);
+        return;
+    }
+
+    const char *slash = memchr(param, '/', len);
+    const char *colon = NULL;
+    for (const char *p = param; slash && p < slash; p++)
+    {
+        if (*p == ':')
+        {
+            colon = p; // 마지막 ':'
+        }
+    }
+
+    if (!slash || !colon)
+    {
+        RS485_AT_RESP_SEND_PARAM_ERR();
+        return;
+    }
+
+    size_t host_len = (size_t)(colon - param);
+    size_t port_len = (size_t)(slash - colon - 1);
+    size_t mount_len = (size_t)(param + len - slash - 1);
+
+    if (host_len == 0 || host_len >= sizeof(host) || port_len == 0 ||
+        port_len >= sizeof(port) || mount_len == 0 || mount_len >= sizeof(mount))
+    {
+        RS485_AT_RESP_SEND_PARAM_ERR();
+        return;
+    }
+
+    memcpy(host, param, host_len);
+    memcpy(port, colon + 1, port_len);
+    memcpy(mount, slash + 1, mount_len);
+    flash_params_set_ntrip_standby(host, port, mount);
+
+    sprintf(buf, "+CASTER2=%s:%s/%s\r", params->ntrip2_url, params->ntrip2_port,
+            params->ntrip2_mountpoint);
+    RS485_AT_RESP_SEND(buf);
+}
+
+/**
+ * @brief NTRIP server (base 가 캐스터로 RTCM 업로드) 캐스터 설정
+ *
+ * 형식: AT+NSRV:host:port/mountpoint, 값이 없으면 업로드 끔.
+ * base 좌표가 고정된 뒤 (auto-fix 완료) NTRIP client 대신 시작된다.
+ */
+static void at_set_ntrip_server_handler(void *ctx, const char *param, size_t param_len)
+{
+    user_params_t *params = flash_params_get_current();
+    char buf[128];
+    char host[64] = {0};
+    char port[8] = {0};
+    char mount[32] = {0};
+
+    size_t len = param_len;
+
+    if (len == 0)
+    {
+        flash_params_set_ntrip_server("", "", "");
+        rs485_send("+NSRV=\r", sizeof("+NSRV=\r") - 1);
+        return;
+    }
+
+    const char *slash = memchr(param, '/', len);
+    const char *colon = NULL;
+    for (const char *p = param; slash && p < slash; p++)
+    {
+        if (*p == ':')
+        {
+            colon = p; // 마지막 ':'
+        }
+    }
+
+    if (!slash || !colon)
+    {
+        RS485_AT_RESP_SEND_PARAM_ERR();
+        return;
+    }
+
+    size_t host_len = (size_t)(colon - param);
+    size_t port_len = (size_t)(slash - colon - 1);
+    size_t mount_len = (size_t)(param + len - slash - 1);
+
+    if (host_len == 0 || host_len >= sizeof(host) || port_len == 0 ||
+        port_len >= sizeof(port) || mount_len == 0 || mount_len >= sizeof(mount))
+    {
+        RS485_AT_RESP_SEND_PARAM_ERR();
+        return;
+    }
+
+    memcpy(host, param, host_len);
+    memcpy(port, colon + 1, port_len);
+    memcpy(mount, slash + 1, mount_len);
+    flash_params_set_ntrip_server(host, port, mount);
+
+    sprintf(buf, "+NSRV=%s:%s/%s\r", params->ntrip_srv_url, params->ntrip_srv_port,
+            params->ntrip_srv_mountpoint);
+    RS485_AT_RESP_SEND(buf);
+}
+
+/**
+ * @brief NTRIP server 인증
+ *
+ * 형식: AT+NSRVPW=user:password 면 NTRIP v2 (POST), AT+NSRVPW=password 면
+ * v1 (SOURCE). 응답에 비밀번호는 싣지 않는다.
+ */
+static void at_set_ntrip_server_auth_handler(void *ctx, const char *param, size_t param_len)
+{
+    char user[32] = {0};
+    char pw[32] = {0};
+    const char *colon = memchr(param, ':', param_len);
+    size_t user_len = colon ? (size_t)(colon - param) : 0;
+    const char *pw_start = colon ? colon + 1 : param;
+    size_t pw_len = (size_t)(param + param_len - pw_start);
+
+    if ((colon && user_len == 0) || user_len >= sizeof(user) || pw_len >= sizeof(pw))
+    {
+        RS485_AT_RESP_SEND_PARAM_ERR();
+        return;
+    }
+
+    memcpy(user, param, user_len);
+    memcpy(pw, pw_start, pw_len);
+    flash_params_set_ntrip_server_auth(user, pw);
+
+    RS485_AT_RESP_SEND(user[0] ? "+NSRVPW=v2\r" : "+NSRVPW=v1\r");
+}
+
+static void at_set_ntrip_id_handler(void *ctx, const char *param, size_t param_len)
 {
     user_params_t *params = flash_params_get_current();
     char buf[64];
@@ -258,7 +615,7 @@ static void at_set_ntrip_id_handler(const char *param)
       }
 }
 
-static void at_set_ntrip_mountpoint_handler(const char *param)
+static void at_set_ntrip_mountpoint_handler(void *ctx, const char *param, size_t param_len)
 {
     user_params_t *params = flash_params_get_current();
     char buf[64];
@@ -268,7 +625,7 @@ static void at_set_ntrip_mountpoint_handler(const char *param)
     RS485_AT_RESP_SEND(buf);
 }
 
-static void at_set_ntrip_passwd_handler(const char *param)
+static void at_set_ntrip_passwd_handler(void *ctx, const char *param, size_t param_len)
 {
     user_params_t *params = flash_params_get_current();
     char passwd[32];
@@ -279,7 +636,7 @@ static void at_set_ntrip_passwd_handler(const char *param)
     RS485_AT_RESP_SEND(passwd);
 }
 
-static void at_set_rtk_start_handler(const char *param)
+static void at_set_rtk_start_handler(void *ctx, const char *param, size_t param_len)
 {
     if (strncmp(param, "LTE", 3) == 0)
       {
@@ -294,10 +651,7 @@ static void at_set_rtk_start_handler(const char *param)
         active_status = RTK_ACTIVE_STATUS_GSM;
         is_gugu_start = true;
 
-        if (gps_send_timer != NULL)
-        {
-          xTimerStart(gps_send_timer, 0);
-        }
+        rs485_pos_output_start();
       }
       else if (strncmp(param, "LORA", 4) == 0)
       {
@@ -314,10 +668,7 @@ static void at_set_rtk_start_handler(const char *param)
         active_status = RTK_ACTIVE_STATUS_LORA;
         is_gugu_start = true;
 
-        if (gps_send_timer != NULL)
-        {
-          xTimerStart(gps_send_timer, 0);
-        }
+        rs485_pos_output_start();
       }
       else
       {
@@ -325,10 +676,11 @@ static void at_set_rtk_start_handler(const char *param)
       }
 }
 
-static void at_set_rtk_stop_handler(const char *param)
+static void at_set_rtk_stop_handler(void *ctx, const char *param, size_t param_len)
 {
        if(active_status == RTK_ACTIVE_STATUS_LORA)
       {
+        rs485_pos_output_stop();
         lora_instance_deinit();
         gps_cleanup_all();
         vTaskDelay(pdMS_TO_TICKS(100));  // 100ms 대기 권장
@@ -341,10 +693,7 @@ static void at_set_rtk_stop_handler(const char *param)
         if(lte_get_init_state() == LTE_INIT_DONE)
         {
           // gsm 초기화
-          if (gps_send_timer != NULL)
-          {
-              xTimerStop(gps_send_timer, 0);
-          }
+          rs485_pos_output_stop();
           is_gugu_start = false;
           ntrip_stop();
           vTaskDelay(pdMS_TO_TICKS(100));
@@ -363,29 +712,827 @@ static void at_set_rtk_stop_handler(const char *param)
       }
       else
       {
+        rs485_pos_output_stop();
         is_gugu_start = false;
         rs485_send("+GUGUSTOP\r", strlen("+GUGUSTOP\r"));
       }
 }
 
-static void at_save_handler(const char *param)
+static void at_save_handler(void *ctx, const char *param, size_t param_len)
 {
     user_params_t *params = flash_params_get_current();
-      if (flash_params_erase() != HAL_OK)
+      if (flash_params_save(params) != HAL_OK)
       {
         RS485_AT_RESP_SEND_ERR();
       }
       else
       {
-        if (flash_params_write(params) != HAL_OK)
+        rs485_send((uint8_t *)"+SAVE\r", strlen("+SAVE\r"));
+        // 바뀐 설정이 모두 바로 적용됐으면 (flash_params_watch) 재부팅하지 않음
+        if (flash_params_reboot_pending())
         {
-          RS485_AT_RESP_SEND_ERR();
+            vTaskDelay(pdMS_TO_TICKS(500));
+            NVIC_SystemReset();
         }
-        else
+      }
+}
+
+static void at_corr_latency_handler(void *ctx, const char *param, size_t param_len)
+{
+    char buf[512];
+
+    if (rtcm_router_format_latency(buf, sizeof(buf)) == 0)
+    {
+        RS485_AT_RESP_SEND_ERR();
+        return;
+    }
+
+    RS485_AT_RESP_SEND(buf);
+}
+
+static void at_corr_latency_reset_handler(void *ctx, const char *param, size_t param_len)
+{
+    rtcm_router_reset_latency();
+    RS485_AT_RESP_SEND_OK();
+}
+
+// 수신기 쪽 진단: 소스별로 수신기가 쓴/안 쓴 보정 메시지 + 수신기 포트 버퍼
+static void at_rx_diag_handler(void *ctx, const char *param, size_t param_len)
+{
+    // GPS 2 개 x (요약 + 포트 5) 줄이면 800 바이트 가까이
+    static char buf[1280];
+    size_t len = rtcm_router_format_engine(buf, sizeof(buf));
+
+    if (len == 0 || gps_format_rx_comms(&buf[len], sizeof(buf) - len) == 0)
+    {
+        RS485_AT_RESP_SEND_ERR();
+        return;
+    }
+
+    RS485_AT_RESP_SEND(buf);
+}
+
+static void at_ntrip_stat_handler(void *ctx, const char *param, size_t param_len)
+{
+    char buf[400];
+
+    if (ntrip_mon_format(buf, sizeof(buf)) == 0)
+    {
+        RS485_AT_RESP_SEND_ERR();
+        return;
+    }
+
+    RS485_AT_RESP_SEND(buf);
+}
+
+static void at_ntrip_stat_reset_handler(void *ctx, const char *param, size_t param_len)
+{
+    ntrip_mon_reset();
+    RS485_AT_RESP_SEND_OK();
+}
+
+/**
+ * @brief NTRIP server 상태
+ *
+ * +NSRV=<state>,<frames>,<bytes>,<batches>,<dropped>,<send_errors>,<reconnects>
+ * state 0: 시작 안 함, 1: 연결 중, 2: 업로드 중
+ */
+static void at_ntrip_server_handler(void *ctx, const char *param, size_t param_len)
+{
+    ntrip_srv_stats_t st;
+    char buf[128];
+
+    ntrip_server_get_stats(&st);
+    sprintf(buf, "+NSRV=%u,%lu,%lu,%lu,%lu,%lu,%lu\r", st.state, st.frames, st.bytes,
+            st.batches, st.dropped, st.send_errors, st.reconnects);
+    RS485_AT_RESP_SEND(buf);
+}
+
+/**
+ * @brief 원격 모니터링 서버 설정
+ *
+ * 형식: AT+TELEM:host:port, 값이 없으면 끄고 동작 중이면 바로 멈춘다.
+ * 켜기는 다음 LTE 초기화부터.
+ */
+static void at_set_telemetry_handler(void *ctx, const char *param, size_t param_len)
+{
+    user_params_t *params = flash_params_get_current();
+    char buf[96];
+    char host[64] = {0};
+    char port[8] = {0};
+    const char *colon = NULL;
+
+    if (param_len == 0)
+    {
+        flash_params_set_telemetry("", "");
+        telemetry_stop();
+        rs485_send("+TELEM=\r", sizeof("+TELEM=\r") - 1);
+        return;
+    }
+
+    for (const char *p = param; p < param + param_len; p++)
+    {
+        if (*p == ':')
         {
-        rs485_send((uint8_t *)"+SAVE\r", strlen("+SAVE\r"));
-        vTaskDelay(pdMS_TO_TICKS(500));
-          NVIC_SystemReset();
+            colon = p; // 마지막 ':'
         }
-      }
+    }
+
+    if (!colon)
+    {
+        RS485_AT_RESP_SEND_PARAM_ERR();
+        return;
+    }
+
+    size_t host_len = (size_t)(colon - param);
+    size_t port_len = (size_t)(param + param_len - colon - 1);
+
+    if (host_len == 0 || host_len >= sizeof(host) || port_len == 0 || port_len >= sizeof(port))
+    {
+        RS485_AT_RESP_SEND_PARAM_ERR();
+        return;
+    }
+
+    memcpy(host, param, host_len);
+    memcpy(port, colon + 1, port_len);
+    flash_params_set_telemetry(host, port);
+
+    sprintf(buf, "+TELEM=%s:%s\r", params->telemetry_url, params->telemetry_port);
+    RS485_AT_RESP_SEND(buf);
+}
+
+/**
+ * @brief 원격 모니터링 전송 간격 [s] (5~3600, 0 은 기본값 30)
+ */
+static void at_set_telemetry_interval_handler(void *ctx, const char *param, size_t param_len)
+{
+    char *end;
+    long sec = strtol(param, &end, 10);
+
+    if (end == param || (sec != 0 && (sec < 5 || sec > 3600)))
+    {
+        RS485_AT_RESP_SEND_PARAM_ERR();
+        return;
+    }
+
+    flash_params_set_telemetry_interval((uint32_t)sec);
+    RS485_AT_RESP_SEND_OK();
+}
+
+/**
+ * @brief 원격 모니터링 상태
+ *
+ * +TELEM=<state>,<records>,<sent>,<overwritten>,<batches>,<bytes>,<send_errors>,<reconnects>
+ * state 0: 시작 안 함, 1: 연결 중, 2: 연결됨
+ */
+static void at_telemetry_handler(void *ctx, const char *param, size_t param_len)
+{
+    telem_stats_t st;
+    char buf[128];
+
+    telemetry_get_stats(&st);
+    sprintf(buf, "+TELEM=%u,%lu,%lu,%lu,%lu,%lu,%lu,%lu\r", st.state, st.records, st.sent,
+            st.overwritten, st.batches, st.bytes, st.send_errors, st.reconnects);
+    RS485_AT_RESP_SEND(buf);
+}
+
+/**
+ * @brief 위치 궤적 기록 상태
+ *
+ * +TRK=<interval>,<first>,<last>,<pages>,<capacity>,<ram_records>,<records>,<bytes>,
+ *      <dropped_pages>,<write_errors>
+ */
+static void at_track_handler(void *ctx, const char *param, size_t param_len)
+{
+    track_log_info_t info;
+    char buf[128];
+
+    track_log_get_info(&info);
+    sprintf(buf, "+TRK=%lu,%lu,%lu,%lu,%lu,%u,%lu,%lu,%lu,%lu\r", info.interval_s,
+            info.first_seq, info.last_seq, info.pages, info.capacity, info.ram_records,
+            info.records, info.bytes, info.dropped_pages, info.write_errors);
+    RS485_AT_RESP_SEND(buf);
+}
+
+/**
+ * @brief 기록 간격 [s] (0 은 끔, 최대 TRACK_INTERVAL_MAX_S), 저장하면 바로 적용
+ */
+static void at_set_track_interval_handler(void *ctx, const char *param, size_t param_len)
+{
+    char *end;
+    long sec = strtol(param, &end, 10);
+
+    if (end == param || sec < 0 || sec > TRACK_INTERVAL_MAX_S)
+    {
+        RS485_AT_RESP_SEND_PARAM_ERR();
+        return;
+    }
+
+    flash_params_set_track_interval((uint32_t)sec);
+    RS485_AT_RESP_SEND_OK();
+}
+
+static void at_track_flush_handler(void *ctx, const char *param, size_t param_len)
+{
+    track_log_flush();
+    RS485_AT_RESP_SEND_OK();
+}
+
+static void at_track_clear_handler(void *ctx, const char *param, size_t param_len)
+{
+    track_log_clear();
+    RS485_AT_RESP_SEND_OK();
+}
+
+/**
+ * @brief 궤적 페이지 내려받기
+ *
+ * 형식: AT+TRKDL=<seq>,<count> (count 최대 16). +TRKDL=<n> 뒤에 flash 의 256 byte
+ * 페이지 n 개를 그대로 (binary) 보내고 OK. 덮였거나 깨진 번호는 건너뛴다.
+ * 페이지마다 번호와 CRC 가 있어 받는 쪽이 확인한다.
+ */
+#define RS485_TRACK_DL_MAX 16
+
+static void at_track_download_handler(void *ctx, const char *param, size_t param_len)
+{
+    const uint8_t *pages[RS485_TRACK_DL_MAX];
+    char *end;
+    unsigned long seq = strtoul(param, &end, 10);
+    unsigned long count;
+    uint8_t n = 0;
+    char buf[32];
+
+    if (end == param || *end != ',')
+    {
+        RS485_AT_RESP_SEND_PARAM_ERR();
+        return;
+    }
+    param = end + 1;
+    count = strtoul(param, &end, 10);
+    if (end == param || count == 0 || count > RS485_TRACK_DL_MAX)
+    {
+        RS485_AT_RESP_SEND_PARAM_ERR();
+        return;
+    }
+
+    for (unsigned long i = 0; i < count; i++)
+    {
+        const uint8_t *page = track_log_page((uint32_t)(seq + i));
+
+        if (page)
+        {
+            pages[n++] = page;
+        }
+    }
+
+    sprintf(buf, "+TRKDL=%u\r", n);
+    RS485_AT_RESP_SEND(buf);
+    for (uint8_t i = 0; i < n; i++)
+    {
+        rs485_send((const char *)pages[i], TRACK_PAGE_SIZE);
+    }
+    RS485_AT_RESP_SEND_OK();
+}
+
+/**
+ * @brief SD 카드 raw 기록 상태
+ *
+ * +SDLOG=<src>,<state>,<card_mb>,<epoch>,<next>,<chunks>,<bytes>,<dropped>,<write_errors>,
+ *        <write_ms_max>
+ * state: 0 카드 없음, 1 포맷 안 됨 (AT+SDFMT), 2 기록 중, 3 가득 참
+ */
+static void at_sd_log_handler(void *ctx, const char *param, size_t param_len)
+{
+    sd_log_info_t info;
+    char buf[128];
+
+    sd_log_get_info(&info);
+    sprintf(buf, "+SDLOG=%lu,%u,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu\r",
+            flash_params_get_current()->sd_log_src, info.state, info.card_mb, info.epoch,
+            info.next, info.chunks, info.bytes, info.dropped, info.write_errors,
+            info.write_ms_max);
+    RS485_AT_RESP_SEND(buf);
+}
+
+/**
+ * @brief 기록할 수신기 (0 끔, 1~ 수신기 번호 + 1), 저장하면 바로 적용
+ */
+static void at_set_sd_log_handler(void *ctx, const char *param, size_t param_len)
+{
+    char *end;
+    unsigned long src = strtoul(param, &end, 10);
+
+    if (end == param || !sd_log_src_valid(src))
+    {
+        RS485_AT_RESP_SEND_PARAM_ERR();
+        return;
+    }
+
+    flash_params_set_sd_log_src(src);
+    RS485_AT_RESP_SEND_OK();
+}
+
+/**
+ * @brief 카드를 처음부터 다시 (superblock epoch 만 바꿈, 기다리지 않음)
+ */
+static void at_sd_format_handler(void *ctx, const char *param, size_t param_len)
+{
+    sd_log_format();
+    RS485_AT_RESP_SEND_OK();
+}
+
+/**
+ * @brief 평면 좌표 투영 설정, 저장하면 바로 적용
+ *
+ * 형식: AT+GRID=0 (끔) | AT+GRID=1[,zone] (UTM, zone 0 자동, 101~160 남반구)
+ *       | AT+GRID=2,lat0,lon0,k0,fe,fn (TM)
+ * 출력은 위치 형식 2/3 (Modbus POS_FORMAT, BLE SF+) 또는 Modbus GRID 레지스터.
+ */
+static void at_set_grid_handler(void *ctx, const char *param, size_t param_len)
+{
+    gps_grid_params_t grid = flash_params_get_current()->gps_grid;
+
+    if (!gps_grid_parse(param, &grid))
+    {
+        RS485_AT_RESP_SEND_PARAM_ERR();
+        return;
+    }
+
+    flash_params_set_gps_grid(&grid);
+    RS485_AT_RESP_SEND_OK();
+}
+
+/**
+ * @brief 평면 좌표 datum (투영 타원체, WGS84 에서의 7 변수 position vector)
+ *
+ * 형식: AT+GRIDDS=<ell>[,tx,ty,tz,rx,ry,rz,ds] ([m], [arcsec], [ppm])
+ * ell 0: GRS80/WGS84, 1: Bessel 1841. 변환 값이 없으면 변환 안 함.
+ */
+static void at_set_grid_datum_handler(void *ctx, const char *param, size_t param_len)
+{
+    gps_grid_params_t grid = flash_params_get_current()->gps_grid;
+
+    if (!gps_grid_parse_datum(param, &grid))
+    {
+        RS485_AT_RESP_SEND_PARAM_ERR();
+        return;
+    }
+
+    flash_params_set_gps_grid(&grid);
+    RS485_AT_RESP_SEND_OK();
+}
+
+/**
+ * @brief 평면 좌표 상태
+ *
+ * +GRID=<mode>,<zone>,<ell>,<datum shift>,<valid>,<anchors>,<anchor_cyc>,<fwd_cyc>
+ * anchor_cyc 는 기준점을 새로 잡은 변환, fwd_cyc 는 보통 변환의 DWT cycle.
+ */
+static void at_grid_handler(void *ctx, const char *param, size_t param_len)
+{
+    const gps_grid_params_t *grid = &flash_params_snapshot(NULL)->gps_grid;
+    gps_grid_info_t info;
+    bool shift = false;
+    char buf[96];
+
+    // 이전 버전 flash 는 mode 가 0xFFFFFFFF, 나머지는 NaN
+    for (int i = 0; i < 7 && grid->mode <= GPS_GRID_TM; i++)
+    {
+        shift |= grid->shift[i] != 0.0;
+    }
+    gps_grid_get_info(&info);
+    sprintf(buf, "+GRID=%lu,%lu,%lu,%d,%d,%lu,%lu,%lu\r", grid->mode, grid->zone, grid->ell,
+            shift, info.valid, info.anchors, info.anchor_cyc, info.fwd_cyc);
+    RS485_AT_RESP_SEND(buf);
+}
+
+static void at_lora_stat_handler(void *ctx, const char *param, size_t param_len)
+{
+    // 타입이 많으면 700 바이트 넘음, 태스크 스택이 작아서 static
+    static char buf[768];
+
+    if (lora_stats_format(buf, sizeof(buf)) == 0)
+    {
+        RS485_AT_RESP_SEND_ERR();
+        return;
+    }
+
+    RS485_AT_RESP_SEND(buf);
+}
+
+static void at_lora_stat_reset_handler(void *ctx, const char *param, size_t param_len)
+{
+    lora_stats_reset();
+    RS485_AT_RESP_SEND_OK();
+}
+
+// 태스크별 CPU 점유율(AT+TASKRST 이후 구간), 스택 여유, heap 상태
+static void at_task_stat_handler(void *ctx, const char *param, size_t param_len)
+{
+    // 태스크 20개 가까이면 1KB 넘음, 태스크 스택이 작아서 static
+    static char buf[1280];
+
+    if (rtos_stats_format(buf, sizeof(buf)) == 0)
+    {
+        RS485_AT_RESP_SEND_ERR();
+        return;
+    }
+
+    RS485_AT_RESP_SEND(buf);
+}
+
+static void at_task_stat_reset_handler(void *ctx, const char *param, size_t param_len)
+{
+    rtos_stats_reset();
+    RS485_AT_RESP_SEND_OK();
+}
+
+// 실행 중 로그 레벨: AT+LOGLV=<TAG 또는 접두어*>,<0~4> ("*" 는 기본값, 규칙 초기화)
+static void at_set_log_level_handler(void *ctx, const char *param, size_t param_len)
+{
+    char tag[LOG_RULE_NAME_MAX];
+    const char *comma = memchr(param, ',', param_len);
+    char *end;
+    long level;
+
+    if (!comma || comma == param || (size_t)(comma - param) >= sizeof(tag))
+    {
+        RS485_AT_RESP_SEND_PARAM_ERR();
+        return;
+    }
+
+    memcpy(tag, param, comma - param);
+    tag[comma - param] = '\0';
+    level = strtol(comma + 1, &end, 10);
+
+    if (end == comma + 1 || level < LOG_LEVEL_NONE || level > LOG_LEVEL_DEBUG ||
+        !log_set_level(tag, (uint8_t)level))
+    {
+        RS485_AT_RESP_SEND_PARAM_ERR();
+        return;
+    }
+
+    RS485_AT_RESP_SEND_OK();
+}
+
+static void at_log_level_handler(void *ctx, const char *param, size_t param_len)
+{
+    char buf[256];
+
+    if (log_format_levels(buf, sizeof(buf)) == 0)
+    {
+        RS485_AT_RESP_SEND_ERR();
+        return;
+    }
+
+    RS485_AT_RESP_SEND(buf);
+}
+
+// 리셋 후 단계별 도달 시각 (ms) 과 초기화 단계별 시간, AT+BOOTPREV? 는 리셋 전 부팅 기록
+static void at_boot_timeline_send(bool prev)
+{
+    // 단계 13개면 350 바이트 가까이 + 초기화 단계, 태스크 스택이 작아서 static
+    static char buf[512];
+    size_t len = boot_timeline_format(buf, sizeof(buf), prev);
+
+    if (len == 0)
+    {
+        RS485_AT_RESP_SEND_ERR();
+        return;
+    }
+    if (!prev && boot_stage_format(&buf[len], sizeof(buf) - len) == 0)
+    {
+        buf[len] = '\0'; // 모자라서 잘린 줄은 버림
+    }
+
+    RS485_AT_RESP_SEND(buf);
+}
+
+static void at_boot_timeline_handler(void *ctx, const char *param, size_t param_len)
+{
+    at_boot_timeline_send(false);
+}
+
+static void at_boot_timeline_prev_handler(void *ctx, const char *param, size_t param_len)
+{
+    at_boot_timeline_send(true);
+}
+
+// 태그별 heap 사용량 (cur/peak/n/fail) 과 전체 free/min-ever-free
+static void at_heap_handler(void *ctx, const char *param, size_t param_len)
+{
+    // 태그 7줄 + 합계 한 줄이 450 바이트 가까이, 태스크 스택이 작아서 static
+    static char buf[512];
+
+    if (heap_track_format(buf, sizeof(buf)) == 0)
+    {
+        RS485_AT_RESP_SEND_ERR();
+        return;
+    }
+
+    RS485_AT_RESP_SEND(buf);
+}
+
+static void at_heap_reset_handler(void *ctx, const char *param, size_t param_len)
+{
+    heap_track_reset_peak();
+    RS485_AT_RESP_SEND_OK();
+}
+
+// 사후 분석 이벤트 링 (+PMT 줄), AT+PMTPREV? 는 리셋 전 부팅 (리셋 원인 포함)
+static void at_pm_trace_send(bool prev)
+{
+    // 레코드 128개면 4KB 가 넘어서 버퍼 하나씩 나눠 보냄, 태스크 스택이 작아서 static
+    static char buf[512];
+    uint16_t first = 0;
+    uint16_t next;
+
+    while (pm_trace_format(buf, sizeof(buf), prev, first, &next) > 0)
+    {
+        RS485_AT_RESP_SEND(buf);
+        first = next;
+    }
+
+    if (first == 0)
+    {
+        RS485_AT_RESP_SEND_ERR();
+    }
+}
+
+static void at_pm_trace_handler(void *ctx, const char *param, size_t param_len)
+{
+    at_pm_trace_send(false);
+}
+
+static void at_pm_trace_prev_handler(void *ctx, const char *param, size_t param_len)
+{
+    at_pm_trace_send(true);
+}
+
+// 포트별 UART IDLE -> 담당 태스크 처리 시작 지연 (us, USE_IRQ_LATENCY)
+static void at_irq_latency_handler(void *ctx, const char *param, size_t param_len)
+{
+    // 포트 5줄이 300 바이트 가까이, 태스크 스택이 작아서 static
+    static char buf[384];
+
+    if (irq_lat_format(buf, sizeof(buf)) == 0)
+    {
+        RS485_AT_RESP_SEND_ERR();
+        return;
+    }
+
+    RS485_AT_RESP_SEND(buf);
+}
+
+static void at_irq_latency_reset_handler(void *ctx, const char *param, size_t param_len)
+{
+    irq_lat_reset();
+    RS485_AT_RESP_SEND_OK();
+}
+
+// 소비자별 항법 해 epoch -> 출력 완료 지연 (us) 과 마감 초과
+static void at_epoch_dl_handler(void *ctx, const char *param, size_t param_len)
+{
+    // 소비자 8줄이면 800 바이트 가까이
+    static char buf[896];
+
+    if (epoch_dl_format(buf, sizeof(buf)) == 0)
+    {
+        RS485_AT_RESP_SEND_ERR();
+        return;
+    }
+
+    RS485_AT_RESP_SEND(buf);
+}
+
+static void at_epoch_dl_reset_handler(void *ctx, const char *param, size_t param_len)
+{
+    epoch_dl_reset();
+    RS485_AT_RESP_SEND_OK();
+}
+
+// 링/재조립 버퍼, 큐, 메모리 풀의 최대 사용량 (버퍼 크기 조정용)
+static void at_wm_handler(void *ctx, const char *param, size_t param_len)
+{
+    static char buf[1024];
+
+    if (mem_wm_format(buf, sizeof(buf)) == 0)
+    {
+        RS485_AT_RESP_SEND_ERR();
+        return;
+    }
+
+    RS485_AT_RESP_SEND(buf);
+}
+
+static void at_wm_reset_handler(void *ctx, const char *param, size_t param_len)
+{
+    mem_wm_reset_peak();
+    RS485_AT_RESP_SEND_OK();
+}
+
+// 위치 출력 decimation: N 번째 항법 해마다 한 번 (1 이면 매번), AT+SAVE 로 저장
+static void at_set_pos_decim_handler(void *ctx, const char *param, size_t param_len)
+{
+    char *end;
+    long decim = strtol(param, &end, 10);
+
+    if (end == param || decim < 1 || decim > RS485_POS_DECIM_MAX)
+    {
+        RS485_AT_RESP_SEND_PARAM_ERR();
+        return;
+    }
+
+    flash_params_set_pos_output_decim((uint32_t)decim);
+    RS485_AT_RESP_SEND_OK();
+}
+
+static void at_pos_decim_handler(void *ctx, const char *param, size_t param_len)
+{
+    uint32_t decim = flash_params_get_current()->pos_output_decim;
+    char buf[24];
+
+    if (decim == 0 || decim > RS485_POS_DECIM_MAX)
+    {
+        decim = 1;
+    }
+
+    snprintf(buf, sizeof(buf), "+POSDEC=%lu\r", decim);
+    RS485_AT_RESP_SEND(buf);
+}
+
+// 위치 출력 지연 보상 켜기/끄기 (0/1), AT+SAVE 부터 적용
+static void at_set_pos_latency_handler(void *ctx, const char *param, size_t param_len)
+{
+    char *end;
+    long enable = strtol(param, &end, 10);
+
+    if (end == param || enable < 0 || enable > 1)
+    {
+        RS485_AT_RESP_SEND_PARAM_ERR();
+        return;
+    }
+
+    flash_params_set_pos_latency_comp((uint32_t)enable);
+    RS485_AT_RESP_SEND_OK();
+}
+
+// 보상 사용 여부, PPS 동기 여부, 잰 출력 지연 [us] (epoch -> 프레임 도착)
+static void at_pos_latency_handler(void *ctx, const char *param, size_t param_len)
+{
+    char buf[48];
+
+    snprintf(buf, sizeof(buf), "+POSLAT=%d,%d,%lu\r",
+             flash_params_get_current()->pos_latency_comp == 1,
+             gps_time_pps_locked(GPS_ID_BASE),
+             gps_time_latency_us(GPS_ID_BASE));
+    RS485_AT_RESP_SEND(buf);
+}
+
+// 위치 출력 관리자: 항법 해, sink 송신, 형식별 포맷 횟수 (+GPS/bin/+GRD/grid bin/GGA/Modbus)
+static void at_pos_out_handler(void *ctx, const char *param, size_t param_len)
+{
+    pos_out_stats_t st;
+    char buf[112];
+
+    pos_out_get_stats(&st);
+    snprintf(buf, sizeof(buf), "+POSOUT=%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu\r", st.epochs, st.emits,
+             st.renders[POS_OUT_FMT_ASCII], st.renders[POS_OUT_FMT_BINARY],
+             st.renders[POS_OUT_FMT_GRID_ASCII], st.renders[POS_OUT_FMT_GRID_BINARY],
+             st.renders[POS_OUT_FMT_NMEA_GGA], st.renders[POS_OUT_FMT_MODBUS]);
+    RS485_AT_RESP_SEND(buf);
+}
+
+// GNSS raw tee: <mask>,<src>,<rate> (gps_tee.h, mask 0 이면 끔), AT+SAVE 부터 적용
+static void at_set_gps_tee_handler(void *ctx, const char *param, size_t param_len)
+{
+    gps_tee_params_t tee;
+    char *end;
+
+    tee.mask = strtoul(param, &end, 0);
+    if (end == param || *end != ',')
+    {
+        RS485_AT_RESP_SEND_PARAM_ERR();
+        return;
+    }
+    param = end + 1;
+    tee.src = strtoul(param, &end, 10);
+    if (end == param || *end != ',')
+    {
+        RS485_AT_RESP_SEND_PARAM_ERR();
+        return;
+    }
+    param = end + 1;
+    tee.rate = strtoul(param, &end, 10);
+    if (end == param || !gps_tee_params_valid(tee.mask, tee.src))
+    {
+        RS485_AT_RESP_SEND_PARAM_ERR();
+        return;
+    }
+
+    flash_params_set_gps_tee(&tee);
+    RS485_AT_RESP_SEND_OK();
+}
+
+// 설정 (mask,src,rate) 과 누적 통계 (frames,bytes,limited,dropped)
+static void at_gps_tee_handler(void *ctx, const char *param, size_t param_len)
+{
+    const gps_tee_params_t *tee = &flash_params_get_current()->gps_tee;
+    gps_tee_stats_t st;
+    char buf[96];
+
+    gps_tee_get_stats(&st);
+    snprintf(buf, sizeof(buf), "+GTEE=0x%lX,%lu,%lu,%lu,%lu,%lu,%lu\r",
+             tee->mask, tee->src, tee->rate,
+             st.frames, st.bytes, st.limited, st.dropped);
+    RS485_AT_RESP_SEND(buf);
+}
+
+// 항법 해 주기 [Hz], UART 대역/링이 못 받는 값은 거절, AT+SAVE 후 재부팅부터 적용
+static void at_set_nav_rate_handler(void *ctx, const char *param, size_t param_len)
+{
+    char *end;
+    long hz = strtol(param, &end, 10);
+    gps_rate_result_t res;
+    char buf[64];
+
+    if (end == param || hz < 1)
+    {
+        RS485_AT_RESP_SEND_PARAM_ERR();
+        return;
+    }
+
+    res = gps_rate_check((uint32_t)hz);
+    if (res == GPS_RATE_ERR_INVALID)
+    {
+        RS485_AT_RESP_SEND_PARAM_ERR();
+        return;
+    }
+    if (res != GPS_RATE_OK)
+    {
+        LOG_WARN("nav rate %ld Hz refused: %s", hz, gps_rate_result_str(res));
+        snprintf(buf, sizeof(buf), "+NAVRATE:ERR,%s\r", gps_rate_result_str(res));
+        RS485_AT_RESP_SEND(buf);
+        return;
+    }
+
+    flash_params_set_nav_rate((uint32_t)hz);
+    RS485_AT_RESP_SEND_OK();
+}
+
+// 지금 적용된 주기, 저장된 주기 (재부팅 후), 수신기별 UART 속도와 epoch 당 수신 byte
+static void at_nav_rate_handler(void *ctx, const char *param, size_t param_len)
+{
+    uint32_t hz = gps_rate_get_hz();
+    uint32_t saved = flash_params_get_current()->nav_rate_hz;
+    char buf[96];
+    int len;
+
+    if (!gps_rate_is_valid(saved))
+    {
+        saved = hz;
+    }
+
+    len = snprintf(buf, sizeof(buf), "+NAVRATE=%lu,%lu", hz, saved);
+    for (int i = 0; i < GPS_ID_MAX && len > 0 && len < (int)sizeof(buf); i++)
+    {
+        if (board_get_config()->gps[i] == GPS_TYPE_NONE)
+        {
+            continue;
+        }
+        len += snprintf(buf + len, sizeof(buf) - len, ",%lu/%lu",
+                        gps_rate_uart_baud((gps_id_t)i, hz),
+                        gps_rate_epoch_bytes((gps_id_t)i));
+    }
+    if (len > 0 && len < (int)sizeof(buf) - 1)
+    {
+        buf[len++] = '\r';
+        buf[len] = '\0';
+    }
+
+    RS485_AT_RESP_SEND(buf);
+}
+
+// Modbus RTU slave 주소 (0 이면 끔), 바로 적용되고 AT+SAVE 로 저장
+static void at_set_modbus_handler(void *ctx, const char *param, size_t param_len)
+{
+    char *end;
+    long addr = strtol(param, &end, 10);
+
+    if (end == param || addr < 0 || addr > RS485_MODBUS_ADDR_MAX)
+    {
+        RS485_AT_RESP_SEND_PARAM_ERR();
+        return;
+    }
+
+    flash_params_set_modbus_addr((uint32_t)addr);
+    RS485_AT_RESP_SEND_OK();
+}
+
+static void at_modbus_handler(void *ctx, const char *param, size_t param_len)
+{
+    char buf[24];
+
+    snprintf(buf, sizeof(buf), "+MODBUS=%u\r", rs485_modbus_get_addr());
+    RS485_AT_RESP_SEND(buf);
 }
@@ -1,11 +1,19 @@
+#ifndef RS485_CMD_H
+#define RS485_CMD_H
+
 #include "rs485_app.h"
+#include "at_cmd.h"
+
+// 커맨드 테이블 정렬 확인 (초기화 때 한 번)
+void rs485_cmd_init(void);
+
+// AT 커맨드 처리, len 은 parser.data 길이
+void rs485_at_cmd_handler(rs485_instance_t *inst, size_t len);
 
-typedef void (*at_cmd_handler_t)(const char *param);
+// parser 밖의 줄 처리 (rs485_run_line), 없는 커맨드면 false
+bool rs485_at_cmd_run(const char *line, size_t len);
 
-typedef struct
-{
-    const char* name;
-    at_cmd_handler_t handler;
-}at_cmd_entry_t;
+// GUGUSTART 로 켠 보정 링크 (Modbus 상태 레지스터용)
+rtk_active_status_t rs485_cmd_get_active_status(void);
 
-void rs485_at_cmd_handler(rs485_instance_t *inst);
\ No newline at end of file
+#endif
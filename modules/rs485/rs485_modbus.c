@@ -0,0 +1,388 @@
+#include "rs485_modbus.h"
+#include "rs485_app.h"
+#include "rs485_cmd.h"
+#include "flash_params.h"
+#include "gps_app.h"
+#include "gps_grid.h"
+#include "pos_out.h"
+#include "rtcm_router.h"
+#include "crc.h"
+#include <math.h>
+#include <string.h>
+
+#ifndef TAG
+#define TAG "RS485_MODBUS"
+#endif
+
+#include "log.h"
+
+#define MB_FC_READ_HOLDING 0x03
+#define MB_FC_READ_INPUT 0x04
+#define MB_FC_WRITE_MULTIPLE 0x10
+
+#define MB_EX_ILLEGAL_FUNCTION 0x01
+#define MB_EX_ILLEGAL_ADDRESS 0x02
+#define MB_EX_ILLEGAL_VALUE 0x03
+#define MB_EX_DEVICE_FAILURE 0x04
+
+#define MB_READ_QTY_MAX 125
+#define MB_WRITE_QTY_MAX 123
+
+static uint8_t mb_resp[RS485_MODBUS_FRAME_MAX];
+
+static inline uint16_t mb_get16(const uint8_t *p)
+{
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+static inline void mb_put16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)(v >> 8);
+    p[1] = (uint8_t)v;
+}
+
+static inline void mb_reg32(uint16_t *reg, uint32_t v)
+{
+    reg[0] = (uint16_t)(v >> 16);
+    reg[1] = (uint16_t)v;
+}
+
+static uint16_t mb_clip16(double v)
+{
+    if (!(v > 0))
+    {
+        return 0;
+    }
+    if (v >= 65535.0)
+    {
+        return 65535;
+    }
+    return (uint16_t)lround(v);
+}
+
+uint8_t rs485_modbus_get_addr(void)
+{
+    uint32_t addr = flash_params_snapshot(NULL)->modbus_addr;
+
+    if (addr == 0 || addr > RS485_MODBUS_ADDR_MAX)
+    {
+        return 0;
+    }
+    return (uint8_t)addr;
+}
+
+/**
+ * @brief 위치로 정해지는 입력 레지스터 (pos_out 이 항법 해마다 한 번)
+ *
+ * 해 나이, 링크, 보정 상태는 읽을 때 mb_fill_input() 이 채운다.
+ */
+static size_t mb_render_input(const gps_position_t *pos, uint8_t *buf, size_t size)
+{
+    uint16_t reg[RS485_MB_IR_COUNT] = {0};
+    uint16_t status = 0;
+    int64_t lat = pos->llh.lat;
+    int64_t lon = pos->llh.lon;
+
+    if (size < sizeof(reg))
+    {
+        return 0;
+    }
+
+    mb_reg32(&reg[RS485_MB_IR_ITOW], pos->itow);
+    mb_reg32(&reg[RS485_MB_IR_LAT], (uint32_t)(int32_t)(lat / 100));
+    mb_reg32(&reg[RS485_MB_IR_LON], (uint32_t)(int32_t)(lon / 100));
+    reg[RS485_MB_IR_LAT_HP] = (uint16_t)(int16_t)(lat % 100);
+    reg[RS485_MB_IR_LON_HP] = (uint16_t)(int16_t)(lon % 100);
+    mb_reg32(&reg[RS485_MB_IR_MSL_ALT], (uint32_t)gps_llh_alt_to_mm(pos->llh.msl_alt));
+    mb_reg32(&reg[RS485_MB_IR_ELL_ALT], (uint32_t)gps_llh_alt_to_mm(pos->llh.ellipsoid_alt));
+    reg[RS485_MB_IR_HEADING] = (uint16_t)(lround(pos->heading * 100.0) % 36000);
+    reg[RS485_MB_IR_FIX] = (uint16_t)pos->fix;
+    reg[RS485_MB_IR_SAT] = (uint16_t)pos->sat_num;
+    reg[RS485_MB_IR_HDOP] = mb_clip16(pos->hdop * 100.0);
+    reg[RS485_MB_IR_H_ACC] = mb_clip16(pos->h_acc * 1000.0);
+    reg[RS485_MB_IR_V_ACC] = mb_clip16(pos->v_acc * 1000.0);
+
+    if (pos->tick != 0 && pos->fix > 0)
+    {
+        status |= RS485_MB_STATUS_POS_VALID;
+    }
+
+    // 평면 좌표도 위경도처럼 cm + 나머지로 나눈다 (UTM 남반구 northing 은 int32 mm 를 넘음)
+    gps_proj_xy_t xy = {0};
+    if (gps_grid_convert(pos, &xy))
+    {
+        status |= RS485_MB_STATUS_GRID_VALID;
+    }
+    mb_reg32(&reg[RS485_MB_IR_GRID_E], (uint32_t)(int32_t)(xy.e / 100));
+    mb_reg32(&reg[RS485_MB_IR_GRID_N], (uint32_t)(int32_t)(xy.n / 100));
+    reg[RS485_MB_IR_GRID_E_HP] = (uint16_t)(int16_t)(xy.e % 100);
+    reg[RS485_MB_IR_GRID_N_HP] = (uint16_t)(int16_t)(xy.n % 100);
+    mb_reg32(&reg[RS485_MB_IR_GRID_H], (uint32_t)gps_llh_alt_to_mm(xy.h));
+    reg[RS485_MB_IR_GRID_ZONE] = (uint16_t)(xy.zone | (xy.south ? 0x80 : 0));
+
+    reg[RS485_MB_IR_STATUS] = status;
+
+    memcpy(buf, reg, sizeof(reg));
+    return sizeof(reg);
+}
+
+static void mb_fill_input(uint16_t *reg)
+{
+    gps_position_t pos;
+    rtcm_router_stats_t st;
+    rtcm_src_t src = rtcm_router_get_active();
+    TickType_t now = xTaskGetTickCount();
+    size_t size = RS485_MB_IR_COUNT * sizeof(uint16_t);
+
+    if (pos_out_get(POS_OUT_FMT_MODBUS, (uint8_t *)reg, size) != size)
+    {
+        memset(reg, 0, size);
+    }
+    pos_out_position(&pos);
+
+    if (pos.tick != 0)
+    {
+        reg[RS485_MB_IR_SOL_AGE] = mb_clip16((double)(now - pos.tick) * portTICK_PERIOD_MS);
+    }
+    else
+    {
+        reg[RS485_MB_IR_SOL_AGE] = 0xFFFF;
+    }
+
+    reg[RS485_MB_IR_LINK] = (uint16_t)rs485_cmd_get_active_status();
+    reg[RS485_MB_IR_CORR_SRC] = (uint16_t)src;
+
+    if (src != RTCM_SRC_NONE && rtcm_router_get_stats(src, &st))
+    {
+        reg[RS485_MB_IR_CORR_AGE] = mb_clip16(st.age_ms);
+        if (st.age_ms < RTCM_ROUTER_STALE_MS)
+        {
+            reg[RS485_MB_IR_STATUS] |= RS485_MB_STATUS_CORR_OK;
+        }
+    }
+    else
+    {
+        reg[RS485_MB_IR_CORR_AGE] = 0xFFFF;
+    }
+}
+
+void rs485_modbus_init(void)
+{
+    pos_out_set_render(POS_OUT_FMT_MODBUS, mb_render_input);
+}
+
+static void mb_fill_holding(uint16_t *reg)
+{
+    const user_params_t *params = flash_params_snapshot(NULL);
+    uint32_t decim = params->pos_output_decim;
+
+    if (decim == 0 || decim > RS485_POS_DECIM_MAX)
+    {
+        decim = 1;
+    }
+
+    reg[RS485_MB_HR_ADDR] = rs485_modbus_get_addr();
+    reg[RS485_MB_HR_POS_DECIM] = (uint16_t)decim;
+    reg[RS485_MB_HR_POS_FORMAT] = params->pos_output_format < GPS_POS_FORMAT_COUNT
+                                      ? (uint16_t)params->pos_output_format
+                                      : GPS_POS_FORMAT_ASCII;
+    reg[RS485_MB_HR_SAVE] = 0;
+}
+
+/**
+ * @brief 쓰기 요청 적용 (전부 검사한 뒤 한꺼번에)
+ *
+ * @return uint8_t 0 성공, 그 외 exception 코드
+ */
+static uint8_t mb_write_holding(uint16_t start, uint16_t qty, const uint8_t *data)
+{
+    uint16_t reg[RS485_MB_HR_COUNT];
+
+    mb_fill_holding(reg);
+    for (uint16_t i = 0; i < qty; i++)
+    {
+        reg[start + i] = mb_get16(&data[i * 2]);
+    }
+
+    if (reg[RS485_MB_HR_ADDR] == 0 || reg[RS485_MB_HR_ADDR] > RS485_MODBUS_ADDR_MAX ||
+        reg[RS485_MB_HR_POS_DECIM] == 0 || reg[RS485_MB_HR_POS_DECIM] > RS485_POS_DECIM_MAX ||
+        reg[RS485_MB_HR_POS_FORMAT] >= GPS_POS_FORMAT_COUNT ||
+        reg[RS485_MB_HR_SAVE] > 1)
+    {
+        return MB_EX_ILLEGAL_VALUE;
+    }
+
+    flash_params_set_modbus_addr(reg[RS485_MB_HR_ADDR]);
+    flash_params_set_pos_output_decim(reg[RS485_MB_HR_POS_DECIM]);
+    flash_params_set_pos_output_format(reg[RS485_MB_HR_POS_FORMAT]);
+
+    if (reg[RS485_MB_HR_SAVE])
+    {
+        // 응답을 늦추지 않게 writer 에 맡김 (실패는 writer 가 로그)
+        flash_params_save_async();
+        LOG_INFO("Modbus 설정 저장 요청");
+    }
+
+    return 0;
+}
+
+/**
+ * @brief FC 03/04 - 레지스터를 응답 버퍼에 big-endian 으로 채움
+ *
+ * @return uint8_t 0 성공, 그 외 exception 코드
+ */
+static uint8_t mb_read(uint8_t fc, const uint8_t *req, size_t len, size_t *resp_len)
+{
+    uint16_t reg[(int)RS485_MB_IR_COUNT > (int)RS485_MB_HR_COUNT ? (int)RS485_MB_IR_COUNT
+                                                                  : (int)RS485_MB_HR_COUNT];
+    uint16_t count = fc == MB_FC_READ_INPUT ? RS485_MB_IR_COUNT : RS485_MB_HR_COUNT;
+    uint16_t start;
+    uint16_t qty;
+
+    if (len != 6)
+    {
+        return MB_EX_ILLEGAL_VALUE;
+    }
+
+    start = mb_get16(&req[2]);
+    qty = mb_get16(&req[4]);
+
+    if (qty == 0 || qty > MB_READ_QTY_MAX)
+    {
+        return MB_EX_ILLEGAL_VALUE;
+    }
+    if ((uint32_t)start + qty > count)
+    {
+        return MB_EX_ILLEGAL_ADDRESS;
+    }
+
+    if (fc == MB_FC_READ_INPUT)
+    {
+        mb_fill_input(reg);
+    }
+    else
+    {
+        mb_fill_holding(reg);
+    }
+
+    mb_resp[2] = (uint8_t)(qty * 2);
+    for (uint16_t i = 0; i < qty; i++)
+    {
+        mb_put16(&mb_resp[3 + i * 2], reg[start + i]);
+    }
+    *resp_len = 3 + qty * 2;
+
+    return 0;
+}
+
+/**
+ * @brief FC 16 - holding register 여러 개 쓰기
+ */
+static uint8_t mb_write(const uint8_t *req, size_t len, size_t *resp_len)
+{
+    uint16_t start;
+    uint16_t qty;
+    uint8_t byte_cnt;
+    uint8_t ex;
+
+    if (len < 7)
+    {
+        return MB_EX_ILLEGAL_VALUE;
+    }
+
+    start = mb_get16(&req[2]);
+    qty = mb_get16(&req[4]);
+    byte_cnt = req[6];
+
+    if (qty == 0 || qty > MB_WRITE_QTY_MAX || byte_cnt != qty * 2 || len != 7U + byte_cnt)
+    {
+        return MB_EX_ILLEGAL_VALUE;
+    }
+    if ((uint32_t)start + qty > RS485_MB_HR_COUNT)
+    {
+        return MB_EX_ILLEGAL_ADDRESS;
+    }
+
+    ex = mb_write_holding(start, qty, &req[7]);
+    if (ex)
+    {
+        return ex;
+    }
+
+    // 응답은 시작 주소와 개수만 되돌려 준다
+    memcpy(&mb_resp[2], &req[2], 4);
+    *resp_len = 6;
+
+    return 0;
+}
+
+bool rs485_modbus_process(const uint8_t *frame, size_t len)
+{
+    uint8_t addr = rs485_modbus_get_addr();
+    size_t resp_len = 0;
+    uint16_t crc;
+    uint8_t fc;
+    uint8_t ex;
+
+    if (addr == 0 || len < 4 || len > RS485_MODBUS_FRAME_MAX)
+    {
+        return false;
+    }
+
+    crc = (uint16_t)(frame[len - 2] | (frame[len - 1] << 8));
+    if (crc16_modbus_update(0xFFFF, frame, len - 2) != crc)
+    {
+        return false;
+    }
+
+    // 다른 slave 로 가는 요청
+    if (frame[0] != addr && frame[0] != 0)
+    {
+        return true;
+    }
+
+    fc = frame[1];
+    len -= 2;
+
+    switch (fc)
+    {
+    case MB_FC_READ_HOLDING:
+    case MB_FC_READ_INPUT:
+        ex = mb_read(fc, frame, len, &resp_len);
+        break;
+
+    case MB_FC_WRITE_MULTIPLE:
+        ex = mb_write(frame, len, &resp_len);
+        break;
+
+    default:
+        ex = MB_EX_ILLEGAL_FUNCTION;
+        break;
+    }
+
+    // 브로드캐스트(주소 0)는 쓰기만 하고 응답하지 않는다
+    if (frame[0] == 0)
+    {
+        return true;
+    }
+
+    mb_resp[0] = addr;
+    if (ex)
+    {
+        mb_resp[1] = fc | 0x80;
+        mb_resp[2] = ex;
+        resp_len = 3;
+    }
+    else
+    {
+        mb_resp[1] = fc;
+    }
+
+    crc = crc16_modbus_update(0xFFFF, mb_resp, resp_len);
+    mb_resp[resp_len++] = (uint8_t)crc;
+    mb_resp[resp_len++] = (uint8_t)(crc >> 8);
+
+    rs485_send((const char *)mb_resp, resp_len);
+
+    return true;
+}
@@ -0,0 +1,89 @@
+#ifndef RS485_MODBUS_H
+#define RS485_MODBUS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Modbus RTU 프레임 최대 길이 (주소 + PDU 253 + CRC)
+ */
+#define RS485_MODBUS_FRAME_MAX 256
+
+#define RS485_MODBUS_ADDR_MAX 247
+
+/**
+ * @brief input register (FC 04, 읽기 전용) - 읽을 때 항법 해 스냅샷으로 채움
+ *
+ * 32bit 값은 상위 word 가 먼저 온다. 값이 없으면 나이 레지스터는 0xFFFF.
+ */
+typedef enum {
+  RS485_MB_IR_ITOW = 0,       /**< 2 word, GPS time of week [ms] */
+  RS485_MB_IR_LAT = 2,        /**< 2 word, int32 [1e-7 deg] */
+  RS485_MB_IR_LON = 4,        /**< 2 word, int32 [1e-7 deg] */
+  RS485_MB_IR_LAT_HP = 6,     /**< int16 [1e-9 deg], -99 ~ 99 */
+  RS485_MB_IR_LON_HP = 7,     /**< int16 [1e-9 deg] */
+  RS485_MB_IR_MSL_ALT = 8,    /**< 2 word, int32 [mm] */
+  RS485_MB_IR_ELL_ALT = 10,   /**< 2 word, int32 [mm] */
+  RS485_MB_IR_HEADING = 12,   /**< [0.01 deg] */
+  RS485_MB_IR_FIX = 13,       /**< gps_fix_t */
+  RS485_MB_IR_SAT = 14,
+  RS485_MB_IR_HDOP = 15,      /**< [0.01] */
+  RS485_MB_IR_H_ACC = 16,     /**< [mm], 65535 에서 포화 */
+  RS485_MB_IR_V_ACC = 17,     /**< [mm] */
+  RS485_MB_IR_SOL_AGE = 18,   /**< 마지막 항법 해 이후 [ms] */
+  RS485_MB_IR_LINK = 19,      /**< rtk_active_status_t (GUGUSTART 링크) */
+  RS485_MB_IR_CORR_SRC = 20,  /**< rtcm_src_t, 3 이면 없음 */
+  RS485_MB_IR_CORR_AGE = 21,  /**< 마지막 보정 프레임 이후 [ms] */
+  RS485_MB_IR_STATUS = 22,    /**< RS485_MB_STATUS_* 비트 */
+  RS485_MB_IR_GRID_E = 23,    /**< 2 word, int32 easting [cm] (gps_grid.h) */
+  RS485_MB_IR_GRID_N = 25,    /**< 2 word, int32 northing [cm] */
+  RS485_MB_IR_GRID_E_HP = 27, /**< int16 [0.1 mm], -99 ~ 99 */
+  RS485_MB_IR_GRID_N_HP = 28, /**< int16 [0.1 mm] */
+  RS485_MB_IR_GRID_H = 29,    /**< 2 word, int32 투영 datum 타원체고 [mm] */
+  RS485_MB_IR_GRID_ZONE = 31, /**< UTM zone (bit7: 남반구), TM 은 0 */
+  RS485_MB_IR_COUNT
+} rs485_mb_input_reg_t;
+
+#define RS485_MB_STATUS_POS_VALID (1U << 0)  /**< 항법 해 있음, fix > 0 */
+#define RS485_MB_STATUS_CORR_OK (1U << 1)    /**< 보정 데이터 끊기지 않음 */
+#define RS485_MB_STATUS_GRID_VALID (1U << 2) /**< GRID_* 레지스터 유효 (없으면 0) */
+
+/**
+ * @brief holding register (FC 03 읽기, FC 16 쓰기) - 설정
+ *
+ * 쓰기는 값을 모두 검사한 뒤에 적용한다. SAVE 에 1 을 쓰면 flash 에 저장
+ * (sector 지우기로 1~2초 걸리므로 master timeout 을 넉넉히).
+ * 주소 변경은 응답을 보낸 다음 요청부터 적용된다.
+ */
+typedef enum {
+  RS485_MB_HR_ADDR = 0,       /**< slave 주소 1~247 */
+  RS485_MB_HR_POS_DECIM = 1,  /**< 위치 출력 decimation 1~RS485_POS_DECIM_MAX */
+  RS485_MB_HR_POS_FORMAT = 2, /**< gps_pos_format_t */
+  RS485_MB_HR_SAVE = 3,       /**< 1: flash 저장, 읽으면 0 */
+  RS485_MB_HR_COUNT
+} rs485_mb_holding_reg_t;
+
+/**
+ * @brief 입력 레지스터 포맷 함수를 pos_out 에 등록 (pos_out_init 뒤)
+ */
+void rs485_modbus_init(void);
+
+/**
+ * @brief slave 주소 (0 이면 Modbus 꺼짐)
+ */
+uint8_t rs485_modbus_get_addr(void);
+
+/**
+ * @brief 한 번의 IDLE 로 받은 바이트를 Modbus RTU 요청으로 처리
+ *
+ * RTU 프레임은 문자 사이 공백 없이 오므로 IDLE 한 번에 한 프레임이
+ * 들어온다. CRC 가 맞으면 (다른 slave 주소라도) 소비한 것으로 본다.
+ *
+ * @param[in] frame
+ * @param[in] len
+ * @return true Modbus 프레임이었음, false 이면 AT 파서로 넘긴다
+ */
+bool rs485_modbus_process(const uint8_t *frame, size_t len);
+
+#endif
@@ -8,6 +8,12 @@
 #include "stm32f4xx_ll_usart.h"
 #include "FreeRTOS.h"
 #include "queue.h"
+#include "semphr.h"
+#include "task.h"
+#include "uart_tx.h"
+#include "irq_latency.h"
+#include "dma_ring.h"
+#include <string.h>
 
 #ifndef TAG
     #define TAG "RS485_PORT"
@@ -19,16 +25,37 @@
 #define RS485_PORT_UART_DMA DMA1
 #define RS485_PORT_UART_DMA_STREAM LL_DMA_STREAM_0
 
-static char rs485_recv_buf[1][512];
+// DMA 는 앞 RS485_RX_RING_SIZE 만 돈다. 뒤는 wrap 걸친 프레임을 이어 붙이는 자리
+static char rs485_recv_buf[1][RS485_RX_RING_SIZE + RS485_RX_MIRROR_SIZE];
 static QueueHandle_t rs485_queues[1] = {NULL};
+static uart_tx_t rs485_uart5_tx;
+static volatile uint32_t rs485_rx_laps; // RX DMA TC 횟수 (rs485_port_get_rx_count)
 
-static void rs485_rx_enable();
+/**
+ * @brief 송신 구간 (DE/RE 는 USART TC 인터럽트에서 수신으로 되돌린다)
+ *
+ * 호출자 버퍼는 태스크 스택이나 CCM 일 수 있어서 SRAM 으로 복사해 DMA 를
+ * 걸고, 마지막 stop bit 가 나가 TC 가 설 때까지만 semaphore 로 기다린다.
+ */
+static uint8_t rs485_tx_buf[256];
+static SemaphoreHandle_t rs485_tx_lock = NULL;
+static SemaphoreHandle_t rs485_tc_sem = NULL;
+
+#if USE_RS485
+/*
+ * GNSS raw tee 송신 링 (DMA 가 직접 읽으므로 SRAM)
+ *
+ * 쓸 때 DE 를 켜고 TC 인터럽트를 걸어 두면 링이 다 나간 뒤 TC ISR 이
+ * 수신으로 되돌린다. 링 DMA 는 구간마다 바로 이어 걸리므로 중간에 TC 가
+ * 서지 않는다.
+ */
+static uint8_t rs485_tee_buf[GPS_TEE_TX_RING_SIZE];
+static uart_tx_stream_t rs485_tee;
+static bool rs485_tee_ready;
+#endif
 
-static inline void delay_us(uint32_t us) {
-    uint32_t start = DWT->CYCCNT;
-    uint32_t cycles = us * (SystemCoreClock / 1000000);
-    while ((DWT->CYCCNT - start) < cycles);
-}
+void rs485_tx_enable();
+void rs485_rx_enable();
 
 static void rs485_uart5_dma_init(void)
 {
@@ -38,7 +65,7 @@ static void rs485_uart5_dma_init(void)
 
   /* DMA interrupt init */
   /* DMA1_Stream0_IRQn interrupt configuration */
-  NVIC_SetPriority(DMA1_Stream0_IRQn, NVIC_EncodePriority(NVIC_GetPriorityGrouping(),5, 0));
+  NVIC_SetPriority(DMA1_Stream0_IRQn, UART_NVIC_PRIO(UART5_RX_IRQ_PRIO));
   NVIC_EnableIRQ(DMA1_Stream0_IRQn);
 
 }
@@ -86,7 +113,7 @@ static void rs485_uart5_init(void)
 
   LL_DMA_SetDataTransferDirection(DMA1, LL_DMA_STREAM_0, LL_DMA_DIRECTION_PERIPH_TO_MEMORY);
 
-  LL_DMA_SetStreamPriorityLevel(DMA1, LL_DMA_STREAM_0, LL_DMA_PRIORITY_LOW);
+  LL_DMA_SetStreamPriorityLevel(DMA1, LL_DMA_STREAM_0, UART_DMA_PRIO(UART5_RX_DMA_PRIO));
 
   LL_DMA_SetMode(DMA1, LL_DMA_STREAM_0, LL_DMA_MODE_CIRCULAR);
 
@@ -101,13 +128,13 @@ static void rs485_uart5_init(void)
   LL_DMA_DisableFifoMode(DMA1, LL_DMA_STREAM_0);
 
   /* UART5 interrupt Init */
-  NVIC_SetPriority(UART5_IRQn, NVIC_EncodePriority(NVIC_GetPriorityGrouping(),5, 0));
+  NVIC_SetPriority(UART5_IRQn, UART_NVIC_PRIO(UART5_RX_IRQ_PRIO));
   NVIC_EnableIRQ(UART5_IRQn);
 
   /* USER CODE BEGIN UART5_Init 1 */
 
   /* USER CODE END UART5_Init 1 */
-  USART_InitStruct.BaudRate = 115200;
+  USART_InitStruct.BaudRate = RS485_UART_BAUD;
   USART_InitStruct.DataWidth = LL_USART_DATAWIDTH_8B;
   USART_InitStruct.StopBits = LL_USART_STOPBITS_1;
   USART_InitStruct.Parity = LL_USART_PARITY_NONE;
@@ -126,7 +153,10 @@ int rs485_uart5_comm_start(void) {
   LL_DMA_SetMemoryAddress(DMA1, LL_DMA_STREAM_0,
                           (uint32_t)&rs485_recv_buf[0]);
   LL_DMA_SetDataLength(DMA1, LL_DMA_STREAM_0,
-                       sizeof(rs485_recv_buf[0]));
+                       RS485_RX_RING_SIZE);
+  rs485_rx_laps = 0;
+  LL_DMA_ClearFlag_TC0(DMA1);
+  LL_DMA_EnableIT_TC(DMA1, LL_DMA_STREAM_0);
   LL_DMA_EnableIT_TE(DMA1, LL_DMA_STREAM_0);
   LL_DMA_EnableIT_FE(DMA1, LL_DMA_STREAM_0);
   LL_DMA_EnableIT_DME(DMA1, LL_DMA_STREAM_0);
@@ -145,38 +175,157 @@ int rs485_uart5_comm_start(void) {
 int rs485_uart5_hw_init(void) {
   rs485_uart5_dma_init();
   rs485_uart5_init();
+  uart_tx_init(&rs485_uart5_tx, UART5, DMA1, LL_DMA_STREAM_7, LL_DMA_CHANNEL_4,
+               DMA1_Stream7_IRQn, UART5_TX_DMA_PRIO, UART5_TX_IRQ_PRIO);
+#if USE_RS485
+  rs485_tee_ready = uart_tx_stream_init(&rs485_tee, &rs485_uart5_tx, rs485_tee_buf,
+                                        sizeof(rs485_tee_buf));
+#endif
+
+  if (rs485_tx_lock == NULL) {
+    rs485_tx_lock = xSemaphoreCreateMutex();
+  }
+  if (rs485_tc_sem == NULL) {
+    rs485_tc_sem = xSemaphoreCreateBinary();
+  }
   rs485_rx_enable();
 
   return 0;
 }
 
+/**
+ * @brief DMA 완료 (DMA ISR) - 시프트 레지스터가 빌 때 TC 인터럽트로 넘긴다
+ */
+static void rs485_uart5_dma_done(bool ok, void *user_data) {
+  (void)user_data;
+
+  if (!ok) {
+    BaseType_t woken = pdFALSE;
+
+    rs485_rx_enable();
+    xSemaphoreGiveFromISR(rs485_tc_sem, &woken);
+    portYIELD_FROM_ISR(woken);
+    return;
+  }
+
+  LL_USART_EnableIT_TC(UART5);
+
+#if USE_RS485
+  // tee 링이 바로 이어서 나가면 TC 는 링이 빌 때에야 선다: DE 는 TC ISR 에
+  // 맡기고 송신자는 지금 풀어 준다 (늦게 오는 TC 의 give 는 다음 송신 전에 비움)
+  if (rs485_tee.head != rs485_tee.tail) {
+    BaseType_t woken = pdFALSE;
+
+    xSemaphoreGiveFromISR(rs485_tc_sem, &woken);
+    portYIELD_FROM_ISR(woken);
+  }
+#endif
+}
+
 int rs485_uart5_send(const char *data, size_t len) {
-  for (int i = 0; i < len; i++) {
-    while (!LL_USART_IsActiveFlag_TXE(UART5))
-      ;
-    LL_USART_TransmitData8(UART5, *(data + i));
+  size_t sent = 0;
+
+  if (!rs485_tx_lock || !rs485_tc_sem ||
+      xTaskGetSchedulerState() != taskSCHEDULER_RUNNING) {
+    // 스케줄러 전: polling 송신 (uart_tx_send 가 TC 까지 기다린다)
+    rs485_tx_enable();
+    uart_tx_send(&rs485_uart5_tx, data, len);
+    rs485_rx_enable();
+    return 0;
   }
 
-  while (!LL_USART_IsActiveFlag_TC(UART5))
-    ;
+  xSemaphoreTake(rs485_tx_lock, portMAX_DELAY);
+
+  while (sent < len) {
+    size_t chunk = len - sent;
+
+    if (chunk > sizeof(rs485_tx_buf)) {
+      chunk = sizeof(rs485_tx_buf);
+    }
+    memcpy(rs485_tx_buf, &data[sent], chunk);
 
+    xSemaphoreTake(rs485_tc_sem, 0);
+    rs485_tx_enable();
+
+    if (!uart_tx_send_async(&rs485_uart5_tx, rs485_tx_buf, chunk,
+                            rs485_uart5_dma_done, NULL)) {
+      rs485_rx_enable();
+      break;
+    }
+
+    if (xSemaphoreTake(rs485_tc_sem, pdMS_TO_TICKS(UART_TX_TIMEOUT_MS(chunk))) !=
+        pdTRUE) {
+      LOG_ERR("RS485 TX TC timeout");
+      LL_USART_DisableIT_TC(UART5);
+      rs485_rx_enable();
+      break;
+    }
+    sent += chunk;
+  }
+
+  xSemaphoreGive(rs485_tx_lock);
+
+  return sent == len ? 0 : -1;
+}
+
+/**
+ * @brief GNSS raw tee 스트림 송신 (블로킹 없음, 쓰는 태스크는 하나)
+ *
+ * @return size_t 링에 들어간 바이트 수 (나머지는 버려짐)
+ */
+size_t rs485_port_stream_write(const void *data, size_t len) {
+#if USE_RS485
+  size_t n;
+
+  if (!rs485_tee_ready || len == 0) {
+    return 0;
+  }
+
+  // 이전 전송이 남긴 TC 를 지우고 DE 를 켠 뒤 DMA 를 건다
+  taskENTER_CRITICAL();
+  rs485_tx_enable();
+  LL_USART_ClearFlag_TC(UART5);
+  taskEXIT_CRITICAL();
+
+  n = uart_tx_stream_write(&rs485_tee, data, len);
+  LL_USART_EnableIT_TC(UART5);
+
+  return n;
+#else
   return 0;
+#endif
+}
+
+/**
+ * @brief 링이 가득 차서 버린 tee 누적 바이트
+ */
+uint32_t rs485_port_stream_dropped(void) {
+#if USE_RS485
+  return rs485_tee.dropped;
+#else
+  return 0;
+#endif
 }
 
+/**
+ * @brief 송신 방향으로 전환
+ *
+ * 드라이버 enable 시간(수십 ns)은 DMA 가 첫 start bit 를 내보내기 전에
+ * 지나가므로 따로 기다리지 않는다.
+ */
 void rs485_tx_enable()
 {
     HAL_GPIO_WritePin(GPIOC, GPIO_PIN_10, GPIO_PIN_SET); // DE
     HAL_GPIO_WritePin(GPIOC, GPIO_PIN_11, GPIO_PIN_SET); // /RE
-
-    delay_us(5);
 }
 
+/**
+ * @brief 수신 방향으로 전환 (TC ISR 에서도 호출)
+ */
 void rs485_rx_enable()
 {
     HAL_GPIO_WritePin(GPIOC, GPIO_PIN_10, GPIO_PIN_RESET); // DE
     HAL_GPIO_WritePin(GPIOC, GPIO_PIN_11, GPIO_PIN_RESET); // /RE
-
-    delay_us(5);
 }
 
 static const rs485_hal_ops_t rs485_uart5_ops = {
@@ -200,6 +349,7 @@ void UART5_IRQHandler(void) {
   BaseType_t xHigherPriorityTaskWoken = pdFALSE;
 
   if (LL_USART_IsActiveFlag_IDLE(UART5)) {
+    irq_lat_isr(IRQ_LAT_UART5);
     if (rs485_queues[0] != NULL) {
       uint8_t dummy = 0;
       xQueueSendFromISR(rs485_queues[0], &dummy, &xHigherPriorityTaskWoken);
@@ -207,6 +357,14 @@ void UART5_IRQHandler(void) {
     LL_USART_ClearFlag_IDLE(UART5);
   }
 
+  // 마지막 stop bit 까지 나갔다: 바로 수신으로 전환
+  if (LL_USART_IsEnabledIT_TC(UART5) && LL_USART_IsActiveFlag_TC(UART5)) {
+    LL_USART_DisableIT_TC(UART5);
+    rs485_rx_enable();
+    if (rs485_tc_sem != NULL) {
+      xSemaphoreGiveFromISR(rs485_tc_sem, &xHigherPriorityTaskWoken);
+    }
+  }
 
   if (LL_USART_IsActiveFlag_PE(UART5)) {
     LL_USART_ClearFlag_PE(UART5);
@@ -230,6 +388,12 @@ void UART5_IRQHandler(void) {
 
 void DMA1_Stream0_IRQHandler(void)
 {
+  // 바퀴 수만 센다. Modbus 프레임은 IDLE 에서 한 번에 넘겨야 하므로 깨우지 않음
+  if (LL_DMA_IsActiveFlag_TC0(DMA1)) {
+    LL_DMA_ClearFlag_TC0(DMA1);
+    rs485_rx_laps++;
+  }
+
   if (LL_DMA_IsActiveFlag_TE0(DMA1)) {
 
     LL_DMA_ClearFlag_TE0(DMA1);
@@ -254,6 +418,11 @@ void DMA1_Stream0_IRQHandler(void)
   }
 }
 
+void DMA1_Stream7_IRQHandler(void)
+{
+  uart_tx_irq_handler(&rs485_uart5_tx);
+}
+
 #endif
 
 int rs485_port_init_instance(rs485_t *rs485_handle) {
@@ -299,10 +468,24 @@ void rs485_port_stop(rs485_t *rs485_handle) {
 }
 
 uint32_t rs485_port_get_rx_pos() {
-  uint32_t pos = sizeof(rs485_recv_buf[0]) - LL_DMA_GetDataLength(RS485_PORT_UART_DMA, RS485_PORT_UART_DMA_STREAM);
+  uint32_t pos = RS485_RX_RING_SIZE - LL_DMA_GetDataLength(RS485_PORT_UART_DMA, RS485_PORT_UART_DMA_STREAM);
   return pos;
 }
 
+uint32_t rs485_port_get_rx_count(void) {
+  uint32_t laps;
+  uint32_t pos;
+  bool tc_pending;
+
+  do {
+    laps = rs485_rx_laps;
+    pos = rs485_port_get_rx_pos();
+    tc_pending = LL_DMA_IsActiveFlag_TC0(RS485_PORT_UART_DMA);
+  } while (laps != rs485_rx_laps);
+
+  return dma_ring_count(laps, pos, tc_pending, RS485_RX_RING_SIZE);
+}
+
 char *rs485_port_get_recv_buf() 
 {
   return rs485_recv_buf[0];
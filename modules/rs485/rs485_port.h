@@ -7,13 +7,26 @@
 #include "FreeRTOS.h"
 #include "queue.h"
 
+#define RS485_UART_BAUD 115200
+
 int rs485_port_init_instance(rs485_t *rs485_handle);
 void rs485_port_start(rs485_t *rs485_handle);
 void rs485_port_stop(rs485_t *rs485_handle);
 
+/**
+ * @brief 수신 링 뒤 여분 (dma_ring_linear, 링보다 길게 쌓이면 overrun 이라 링 크기면 충분)
+ */
+#define RS485_RX_MIRROR_SIZE RS485_RX_RING_SIZE
+
 uint32_t rs485_port_get_rx_pos(void);
+/**
+ * @brief RX DMA 가 지금까지 쓴 누적 byte 수 (dma_ring 용)
+ */
+uint32_t rs485_port_get_rx_count(void);
 char *rs485_port_get_recv_buf(void);
 
 void rs485_port_set_queue(QueueHandle_t queue);
+size_t rs485_port_stream_write(const void *data, size_t len);
+uint32_t rs485_port_stream_dropped(void);
 
 #endif
\ No newline at end of file
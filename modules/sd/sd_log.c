@@ -0,0 +1,405 @@
+#include "sd_log.h"
+#include "sd_port.h"
+#include "crc.h"
+#include "flash_params.h"
+#include "rtos_static.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include <string.h>
+
+#if USE_SD_LOG
+
+#ifndef TAG
+#define TAG "SD_LOG"
+#endif
+
+#include "log.h"
+
+_Static_assert(SD_LOG_CHUNK % SD_BLOCK_SIZE == 0, "SD_LOG_CHUNK 은 512 의 배수");
+_Static_assert(SD_LOG_CHUNK <= 65536, "chunk 데이터 길이는 16 bit");
+
+#define SD_LOG_CHUNK_BLOCKS (SD_LOG_CHUNK / SD_BLOCK_SIZE)
+#define SD_LOG_DATA (SD_LOG_CHUNK - SD_LOG_HDR_SIZE)
+
+#define SD_LOG_SB_MAGIC "GNSSRAW1"
+#define SD_LOG_MAGIC 0x474F4C52U // "RLOG"
+#define SD_LOG_SB_CRC_OFF (SD_BLOCK_SIZE - 2)
+#define SD_LOG_HDR_CRC_OFF (SD_LOG_HDR_SIZE - 2)
+
+#define SD_LOG_TASK_STACK_WORDS 384
+#define SD_LOG_RETRY_MS 5000 // 카드가 없을 때 다시 마운트
+
+RTOS_STATIC_TASK(sd_log_task, SD_LOG_TASK_STACK_WORDS);
+
+// DMA 가 읽으므로 CCM 이 아닌 RAM, word 정렬
+static uint32_t sdl_chunk[2][SD_LOG_CHUNK / 4];
+static uint32_t sdl_blk[SD_BLOCK_SIZE / 4]; // superblock, 이분 탐색 (writer 태스크)
+
+static struct {
+  // RX 태스크 (채우는 chunk)
+  uint8_t cur;
+  uint32_t fill;
+  TickType_t fill_tick;
+  uint8_t fill_id;
+
+  volatile bool full[2]; // true: writer 에게 넘김, writer 가 쓰고 false
+
+  // writer 태스크
+  uint8_t wr;
+  uint32_t epoch;
+  uint32_t chunks;
+  uint32_t session;
+  volatile uint32_t next;
+  volatile uint8_t state;
+  volatile bool format_req;
+  uint32_t card_mb;
+
+  // 통계 (critical section)
+  uint32_t bytes;
+  uint32_t dropped;
+  uint32_t write_errors;
+  uint32_t write_ms_max;
+} sdl;
+
+static TaskHandle_t sdl_task;
+
+static uint16_t get_le16(const uint8_t *p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+
+static uint32_t get_le32(const uint8_t *p) {
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) |
+         ((uint32_t)p[3] << 24);
+}
+
+static void put_le16(uint8_t *p, uint16_t v) {
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_le32(uint8_t *p, uint32_t v) {
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)(v >> 8);
+  p[2] = (uint8_t)(v >> 16);
+  p[3] = (uint8_t)(v >> 24);
+}
+
+/* RX 태스크 */
+
+static void sd_log_drop(uint32_t n) {
+  taskENTER_CRITICAL();
+  sdl.dropped += n;
+  taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief 채우던 chunk 를 writer 로 넘기고 다른 chunk 로
+ */
+static void sd_log_close(void) {
+  uint8_t *c = (uint8_t *)sdl_chunk[sdl.cur];
+
+  put_le32(&c[16], (uint32_t)(sdl.fill_tick * portTICK_PERIOD_MS));
+  put_le32(&c[20], sdl.dropped);
+  put_le16(&c[24], (uint16_t)sdl.fill);
+  c[26] = sdl.fill_id;
+
+  sdl.full[sdl.cur] = true;
+  sdl.cur ^= 1;
+  sdl.fill = 0;
+  xTaskNotifyGive(sdl_task);
+}
+
+static void sd_log_put(const uint8_t *p, size_t n) {
+  while (n > 0) {
+    size_t k;
+
+    if (sdl.full[sdl.cur]) {
+      sd_log_drop((uint32_t)n); // writer 가 앞 chunk 를 아직 쓰는 중
+      return;
+    }
+    if (sdl.fill == 0) {
+      sdl.fill_tick = xTaskGetTickCount();
+    }
+
+    k = SD_LOG_DATA - sdl.fill;
+    if (k > n) {
+      k = n;
+    }
+    memcpy((uint8_t *)sdl_chunk[sdl.cur] + SD_LOG_HDR_SIZE + sdl.fill, p, k);
+    sdl.fill += (uint32_t)k;
+    p += k;
+    n -= k;
+
+    if (sdl.fill == SD_LOG_DATA) {
+      sd_log_close();
+    }
+  }
+}
+
+void sd_log_raw(gps_id_t id, const void *ring, size_t size, size_t from, size_t to) {
+  const uint8_t *r = ring;
+
+  if (sdl.state != SD_LOG_READY || flash_params_snapshot(NULL)->sd_log_src != (uint32_t)id + 1 ||
+      from == to) {
+    return;
+  }
+
+  // 수신기가 바뀌었거나 오래 모은 chunk 는 먼저 닫음
+  if (sdl.fill > 0 && (sdl.fill_id != (uint8_t)id ||
+                       xTaskGetTickCount() - sdl.fill_tick >= pdMS_TO_TICKS(SD_LOG_FLUSH_MS))) {
+    sd_log_close();
+  }
+  sdl.fill_id = (uint8_t)id;
+
+  if (to > from) {
+    sd_log_put(&r[from], to - from);
+  } else {
+    sd_log_put(&r[from], size - from);
+    sd_log_put(r, to);
+  }
+}
+
+/* writer 태스크 */
+
+static bool sd_log_sb_valid(const uint8_t *sb, uint32_t blocks) {
+  uint32_t chunks = get_le32(&sb[20]);
+
+  return memcmp(sb, SD_LOG_SB_MAGIC, 8) == 0 &&
+         get_le16(&sb[SD_LOG_SB_CRC_OFF]) == crc16_ccitt_update(0xFFFF, sb, SD_LOG_SB_CRC_OFF) &&
+         get_le32(&sb[12]) == SD_LOG_DATA_LBA && get_le32(&sb[16]) == SD_LOG_CHUNK_BLOCKS &&
+         chunks > 0 && chunks <= (blocks - SD_LOG_DATA_LBA) / SD_LOG_CHUNK_BLOCKS;
+}
+
+/**
+ * @brief chunk i 가 이번 epoch 로 쓰였는지
+ *
+ * @return int 1 쓰임, 0 아님, 음수 읽기 실패
+ */
+static int sd_log_probe(uint32_t i) {
+  const uint8_t *h = (const uint8_t *)sdl_blk;
+  int r = sd_port_read(SD_LOG_DATA_LBA + i * SD_LOG_CHUNK_BLOCKS, sdl_blk, 1);
+
+  if (r) {
+    return r;
+  }
+  return get_le32(h) == SD_LOG_MAGIC && get_le32(&h[4]) == sdl.epoch && get_le32(&h[8]) == i &&
+         get_le16(&h[SD_LOG_HDR_CRC_OFF]) == crc16_ccitt_update(0xFFFF, h, SD_LOG_HDR_CRC_OFF);
+}
+
+/**
+ * @brief 카드 초기화, superblock 확인, 기록 끝 찾기
+ */
+static void sd_log_mount(void) {
+  const uint8_t *sb = (const uint8_t *)sdl_blk;
+  uint32_t blocks;
+  uint32_t lo, hi;
+
+  if (sd_port_init() != 0) {
+    return;
+  }
+  blocks = sd_port_blocks();
+  sdl.card_mb = blocks / 2048;
+
+  if (sd_port_read(0, sdl_blk, 1) != 0) {
+    return;
+  }
+  if (blocks <= SD_LOG_DATA_LBA + SD_LOG_CHUNK_BLOCKS || !sd_log_sb_valid(sb, blocks)) {
+    sdl.state = SD_LOG_UNFORMATTED;
+    LOG_WARN("SD 카드에 기록 영역 없음 (AT+SDFMT)");
+    return;
+  }
+  sdl.epoch = get_le32(&sb[8]);
+  sdl.chunks = get_le32(&sb[20]);
+
+  // 앞에서부터 차례로 쓰므로 [0, lo) 는 쓰였고 [hi, chunks) 는 아님
+  lo = 0;
+  hi = sdl.chunks;
+  while (lo < hi) {
+    uint32_t mid = lo + (hi - lo) / 2;
+    int r = sd_log_probe(mid);
+
+    if (r < 0) {
+      return;
+    }
+    if (r) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+
+  sdl.next = lo;
+  sdl.session = lo;
+  sdl.state = lo < sdl.chunks ? SD_LOG_READY : SD_LOG_FULL;
+  LOG_INFO("SD log: epoch %lu, chunk %lu/%lu", sdl.epoch, lo, sdl.chunks);
+}
+
+/**
+ * @brief superblock 을 새 epoch 로 (앞 기록은 epoch 가 달라 끝 찾기에서 빠짐)
+ */
+static void sd_log_do_format(void) {
+  uint8_t *sb = (uint8_t *)sdl_blk;
+  uint32_t blocks;
+  uint32_t epoch;
+
+  if (sdl.state == SD_LOG_NO_CARD) {
+    sd_log_mount();
+    if (sdl.state == SD_LOG_NO_CARD) {
+      LOG_WARN("SD 카드 없음, 포맷 안 함");
+      return;
+    }
+  }
+
+  blocks = sd_port_blocks();
+  if (blocks <= SD_LOG_DATA_LBA + SD_LOG_CHUNK_BLOCKS || sd_port_read(0, sdl_blk, 1) != 0) {
+    return;
+  }
+  // superblock 이 없던 카드는 예전 epoch 를 모르므로 부팅 후 시간으로 겹치지 않게
+  epoch = memcmp(sb, SD_LOG_SB_MAGIC, 8) == 0 ? get_le32(&sb[8]) + 1
+                                             : (uint32_t)xTaskGetTickCount() | 0x80000000U;
+
+  memset(sb, 0, SD_BLOCK_SIZE);
+  memcpy(sb, SD_LOG_SB_MAGIC, 8);
+  put_le32(&sb[8], epoch);
+  put_le32(&sb[12], SD_LOG_DATA_LBA);
+  put_le32(&sb[16], SD_LOG_CHUNK_BLOCKS);
+  put_le32(&sb[20], (blocks - SD_LOG_DATA_LBA) / SD_LOG_CHUNK_BLOCKS);
+  put_le16(&sb[SD_LOG_SB_CRC_OFF], crc16_ccitt_update(0xFFFF, sb, SD_LOG_SB_CRC_OFF));
+
+  if (sd_port_write(0, sdl_blk, 1) != 0) {
+    taskENTER_CRITICAL();
+    sdl.write_errors++;
+    taskEXIT_CRITICAL();
+    sdl.state = SD_LOG_NO_CARD;
+    return;
+  }
+
+  sdl.epoch = epoch;
+  sdl.chunks = get_le32(&sb[20]);
+  sdl.next = 0;
+  sdl.session = 0;
+  sdl.state = SD_LOG_READY;
+  LOG_INFO("SD log 포맷: epoch %lu, %lu chunks", epoch, sdl.chunks);
+}
+
+/**
+ * @brief 넘겨받은 chunk 에 번호/CRC 를 채워 다음 자리에 한 번에
+ *
+ * 실패하면 chunk 는 버리고 다시 마운트한다 (끝 찾기가 같은 자리를 돌려줌).
+ */
+static void sd_log_write_chunk(uint8_t *c) {
+  uint32_t len = get_le16(&c[24]);
+  TickType_t start = xTaskGetTickCount();
+  uint32_t ms;
+  int r;
+
+  put_le32(&c[0], SD_LOG_MAGIC);
+  put_le32(&c[4], sdl.epoch);
+  put_le32(&c[8], sdl.next);
+  put_le32(&c[12], sdl.session);
+  memset(&c[27], 0, 3);
+  put_le16(&c[SD_LOG_HDR_CRC_OFF], crc16_ccitt_update(0xFFFF, c, SD_LOG_HDR_CRC_OFF));
+
+  r = sd_port_write(SD_LOG_DATA_LBA + sdl.next * SD_LOG_CHUNK_BLOCKS, c, SD_LOG_CHUNK_BLOCKS);
+  ms = (uint32_t)((xTaskGetTickCount() - start) * portTICK_PERIOD_MS);
+
+  taskENTER_CRITICAL();
+  if (r == 0) {
+    sdl.bytes += len;
+    if (ms > sdl.write_ms_max) {
+      sdl.write_ms_max = ms;
+    }
+  } else {
+    sdl.write_errors++;
+    sdl.dropped += len;
+  }
+  taskEXIT_CRITICAL();
+
+  if (r != 0) {
+    LOG_ERR("SD chunk %lu 쓰기 실패 (%d), 다시 마운트", sdl.next, r);
+    sdl.state = SD_LOG_NO_CARD;
+    return;
+  }
+  if (++sdl.next >= sdl.chunks) {
+    sdl.state = SD_LOG_FULL;
+    LOG_WARN("SD log 가득 참");
+  }
+}
+
+static void sd_log_task_fn(void *pvParameter) {
+  (void)pvParameter;
+
+  while (1) {
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(SD_LOG_RETRY_MS));
+
+    if (sdl.format_req) {
+      sdl.format_req = false;
+      sd_log_do_format();
+    } else if (sdl.state == SD_LOG_NO_CARD && flash_params_snapshot(NULL)->sd_log_src != 0) {
+      sd_log_mount();
+    }
+
+    // RX 태스크가 닫은 순서대로 (번갈아)
+    while (sdl.full[sdl.wr]) {
+      uint8_t *c = (uint8_t *)sdl_chunk[sdl.wr];
+
+      if (sdl.state == SD_LOG_READY) {
+        sd_log_write_chunk(c);
+      } else {
+        sd_log_drop(get_le16(&c[24]));
+      }
+      sdl.full[sdl.wr] = false;
+      sdl.wr ^= 1;
+    }
+  }
+}
+
+void sd_log_init(void) {
+  if (sdl_task) {
+    return;
+  }
+  sdl_task = RTOS_TASK_CREATE_STATIC(sd_log_task, sd_log_task_fn, "sd_log", NULL,
+                                     tskIDLE_PRIORITY + 1);
+}
+
+void sd_log_format(void) {
+  if (!sdl_task) {
+    return;
+  }
+  sdl.format_req = true;
+  xTaskNotifyGive(sdl_task);
+}
+
+void sd_log_get_info(sd_log_info_t *out) {
+  out->state = (sd_log_state_t)sdl.state;
+  out->src = flash_params_snapshot(NULL)->sd_log_src;
+  out->card_mb = sdl.card_mb;
+  out->epoch = sdl.epoch;
+  out->next = sdl.next;
+  out->chunks = sdl.chunks;
+
+  taskENTER_CRITICAL();
+  out->bytes = sdl.bytes;
+  out->dropped = sdl.dropped;
+  out->write_errors = sdl.write_errors;
+  out->write_ms_max = sdl.write_ms_max;
+  taskEXIT_CRITICAL();
+}
+
+#else
+
+void sd_log_init(void) {}
+
+void sd_log_raw(gps_id_t id, const void *ring, size_t size, size_t from, size_t to) {
+  (void)id;
+  (void)ring;
+  (void)size;
+  (void)from;
+  (void)to;
+}
+
+void sd_log_format(void) {}
+
+void sd_log_get_info(sd_log_info_t *out) { memset(out, 0, sizeof(*out)); }
+
+#endif
+
+bool sd_log_src_valid(uint32_t src) { return src <= GPS_CNT; }
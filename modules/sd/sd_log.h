@@ -0,0 +1,96 @@
+#ifndef SD_LOG_H
+#define SD_LOG_H
+
+#include "board_config.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief GNSS raw 기록 (SD 카드, PPK 백업과 후처리용)
+ *
+ * raw tee 와 같은 자리 (RX 태스크가 파싱을 마친 링 구간) 에서 설정한 수신기의
+ * 수신 byte 전부를 RAM chunk 두 개 (SD_LOG_CHUNK) 에 번갈아 모은다. 찬 chunk 는
+ * writer 태스크가 카드의 다음 자리에 multi-block 한 번으로 쓰고, 그동안 RX
+ * 태스크는 다른 chunk 를 채운다. RX 태스크는 memcpy 만 하고 카드를 기다리지
+ * 않는다 (두 chunk 가 다 차 있으면 버리고 센다). 수신이 느려도 SD_LOG_FLUSH_MS
+ * 가 지나면 덜 찬 chunk 를 닫는다 (수신이 멈추면 다음 수신 때).
+ *
+ * 카드 배치 (파일 시스템 없음, 카드 전체를 씀, little-endian):
+ *
+ *  LBA 0 superblock
+ *   off size
+ *    0  8   "GNSSRAW1"
+ *    8  4   epoch (AT+SDFMT 마다 +1)
+ *   12  4   첫 chunk LBA (SD_LOG_DATA_LBA)
+ *   16  4   chunk 크기 [block]
+ *   20  4   chunk 수
+ *  510  2   CRC16-CCITT (init 0xFFFF, 0~509)
+ *
+ *  LBA SD_LOG_DATA_LBA + i x chunk 크기: chunk i (앞에서부터 차례로, 끝에 닿으면 멈춤)
+ *   off size
+ *    0  4   magic "RLOG"
+ *    4  4   epoch (superblock 과 다르면 지난 기록)
+ *    8  4   chunk 번호 i
+ *   12  4   session (이번 마운트 - 부팅, 카드 재인식, 포맷 - 에서 처음 쓴 chunk 번호)
+ *   16  4   첫 byte 를 받은 때 [ms, 부팅 후]
+ *   20  4   session 에서 버린 byte (누적, 앞 chunk 와 차이가 이 chunk 앞의 빈틈)
+ *   24  2   데이터 길이
+ *   26  1   수신기 gps_id_t
+ *   27  3   0
+ *   30  2   CRC16-CCITT (0~29)
+ *   32      수신 byte 그대로 (데이터 길이 뒤는 의미 없음)
+ *
+ * 기록 끝은 마운트 때 chunk 머리말을 이분 탐색해 찾는다 (block 읽기 20 여 번).
+ * AT+SDFMT 는 epoch 만 올려 지우지 않고 처음부터 다시 쓴다. superblock 이 없는
+ * 카드 (FAT 으로 포맷된 새 카드 등) 는 AT+SDFMT 전에는 쓰지 않는다.
+ *
+ * USE_SD_LOG 0 인 보드는 아무것도 하지 않는다 (상태는 늘 SD_LOG_NO_CARD).
+ */
+#define SD_LOG_DATA_LBA 8192 // 4 MiB (카드 erase 단위에 맞춤)
+#define SD_LOG_HDR_SIZE 32
+#define SD_LOG_FLUSH_MS 2000
+
+typedef enum {
+  SD_LOG_NO_CARD = 0,
+  SD_LOG_UNFORMATTED, // superblock 없음 또는 chunk 크기가 다름
+  SD_LOG_READY,
+  SD_LOG_FULL,
+} sd_log_state_t;
+
+typedef struct {
+  sd_log_state_t state;
+  uint32_t src;          // 0 끔, 아니면 수신기 gps_id_t + 1
+  uint32_t card_mb;
+  uint32_t epoch;
+  uint32_t next;         // 다음에 쓸 chunk
+  uint32_t chunks;       // 전체 chunk 수
+  uint32_t bytes;        // 부팅 후 카드에 쓴 수신 byte
+  uint32_t dropped;      // 두 chunk 가 다 차 있어 버린 byte
+  uint32_t write_errors;
+  uint32_t write_ms_max; // chunk 쓰기 최대 시간 (앞 쓰기 busy 포함)
+} sd_log_info_t;
+
+/**
+ * @brief writer 태스크 시작 (카드 마운트는 태스크에서)
+ */
+void sd_log_init(void);
+
+/**
+ * @brief 수신 구간 (RX 태스크, gps_tee_raw 에서, 블로킹 없음)
+ */
+void sd_log_raw(gps_id_t id, const void *ring, size_t size, size_t from, size_t to);
+
+/**
+ * @brief 새 epoch 로 처음부터 (writer 태스크가 superblock 을 씀, 요청만)
+ */
+void sd_log_format(void);
+
+void sd_log_get_info(sd_log_info_t *out);
+
+/**
+ * @brief 설정 값 검사 (0 또는 있는 수신기 + 1)
+ */
+bool sd_log_src_valid(uint32_t src);
+
+#endif
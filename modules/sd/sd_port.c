@@ -0,0 +1,380 @@
+#include "sd_port.h"
+#include "board_config.h"
+#include "stm32f4xx_hal.h"
+#include "stm32f4xx_ll_bus.h"
+#include "stm32f4xx_ll_gpio.h"
+#include "FreeRTOS.h"
+#include "semphr.h"
+#include "task.h"
+
+#if USE_SD_LOG
+
+#ifndef TAG
+#define TAG "SD_PORT"
+#endif
+
+#include "log.h"
+
+// SDIOCLK 는 PLL48CLK (48 MHz), 카드 클럭 = 48 / (CLKDIV + 2)
+#define SD_CLK_INIT_DIV 118 // 400 kHz (식별)
+#define SD_CLK_FAST_DIV 0   // 24 MHz (default speed)
+#define SD_DATA_TMO_CLK (24000000U / 2) // 데이터/busy 500 ms [카드 클럭]
+
+#define SD_CMD_TMO_MS 5
+#define SD_INIT_TMO_MS 1000 // ACMD41 (카드가 준비될 때까지)
+#define SD_BUSY_TMO_MS 500  // 프로그램 중 (SDXC 쓰기 최대 500 ms)
+#define SD_XFER_TMO_MS 1000
+#define SD_DMA_TMO_MS 5
+
+#define SD_DMA DMA2
+#define SD_DMA_STREAM DMA2_Stream6
+#define SD_DMA_CHANNEL 4U
+
+// R1 카드 상태
+#define SD_R1_ERRORS 0xFDF98008U
+#define SD_R1_READY_FOR_DATA (1U << 8)
+#define SD_R1_STATE(r) (((r) >> 9) & 0xFU)
+#define SD_R1_STATE_TRAN 4U
+
+#define SD_OCR_BUSY 0x80000000U // 1 이면 준비 끝
+#define SD_OCR_CCS 0x40000000U  // block 주소 (SDHC/SDXC)
+#define SD_OCR_VOLT 0x00100000U // 3.2~3.3 V
+#define SD_CHECK_PATTERN 0x1AAU // CMD8: 2.7~3.6 V + 0xAA
+
+#define SD_ICR_ALL                                                                                 \
+  (SDIO_ICR_CCRCFAILC | SDIO_ICR_DCRCFAILC | SDIO_ICR_CTIMEOUTC | SDIO_ICR_DTIMEOUTC |             \
+   SDIO_ICR_TXUNDERRC | SDIO_ICR_RXOVERRC | SDIO_ICR_CMDRENDC | SDIO_ICR_CMDSENTC |                \
+   SDIO_ICR_DATAENDC | SDIO_ICR_STBITERRC | SDIO_ICR_DBCKENDC)
+#define SD_ICR_CMD (SDIO_ICR_CCRCFAILC | SDIO_ICR_CTIMEOUTC | SDIO_ICR_CMDRENDC | SDIO_ICR_CMDSENTC)
+#define SD_STA_DATA_ERR                                                                            \
+  (SDIO_STA_DCRCFAIL | SDIO_STA_DTIMEOUT | SDIO_STA_TXUNDERR | SDIO_STA_RXOVERR | SDIO_STA_STBITERR)
+#define SD_MASK_DATA                                                                               \
+  (SDIO_MASK_DCRCFAILIE | SDIO_MASK_DTIMEOUTIE | SDIO_MASK_TXUNDERRIE | SDIO_MASK_RXOVERRIE |      \
+   SDIO_MASK_DATAENDIE | SDIO_MASK_STBITERRIE)
+
+typedef enum {
+  SD_RESP_NONE = 0,
+  SD_RESP_SHORT, // R1/R6/R7
+  SD_RESP_R3,    // OCR, CRC 없음 (CCRCFAIL 이 정상)
+  SD_RESP_LONG,  // R2
+} sd_resp_t;
+
+static struct {
+  uint32_t blocks;
+  uint16_t rca;
+  bool sdhc;
+  bool hw_ready; // 핀, 클럭, 세마포어
+} card;
+
+static SemaphoreHandle_t sd_done;
+static StaticSemaphore_t sd_done_buf;
+static volatile uint32_t sd_sta; // IRQ 가 본 데이터 상태
+
+static int sd_cmd(uint8_t idx, uint32_t arg, sd_resp_t resp) {
+  uint32_t wait = resp == SD_RESP_NONE ? SDIO_STA_CMDSENT
+                                       : SDIO_STA_CMDREND | SDIO_STA_CCRCFAIL | SDIO_STA_CTIMEOUT;
+  uint32_t waitresp = resp == SD_RESP_NONE   ? 0
+                      : resp == SD_RESP_LONG ? SDIO_CMD_WAITRESP
+                                             : SDIO_CMD_WAITRESP_0;
+  uint32_t start = HAL_GetTick();
+  uint32_t sta;
+
+  SDIO->ICR = SD_ICR_CMD;
+  SDIO->ARG = arg;
+  SDIO->CMD = idx | waitresp | SDIO_CMD_CPSMEN;
+
+  while (!((sta = SDIO->STA) & wait)) {
+    if (HAL_GetTick() - start > SD_CMD_TMO_MS) {
+      return SD_PORT_ERR_CMD;
+    }
+  }
+  SDIO->ICR = SD_ICR_CMD;
+
+  if (sta & SDIO_STA_CTIMEOUT) {
+    return SD_PORT_ERR_CMD;
+  }
+  if ((sta & SDIO_STA_CCRCFAIL) && resp != SD_RESP_R3) {
+    return SD_PORT_ERR_CMD;
+  }
+  if (resp == SD_RESP_SHORT && SDIO->RESPCMD != idx) {
+    return SD_PORT_ERR_CMD;
+  }
+  return 0;
+}
+
+/**
+ * @brief R1 응답 명령 (카드 상태 에러 비트까지 봄)
+ */
+static int sd_cmd_r1(uint8_t idx, uint32_t arg) {
+  int r = sd_cmd(idx, arg, SD_RESP_SHORT);
+
+  if (r == 0 && (SDIO->RESP1 & SD_R1_ERRORS)) {
+    r = SD_PORT_ERR_CMD;
+  }
+  return r;
+}
+
+static int sd_acmd(uint8_t idx, uint32_t arg, sd_resp_t resp) {
+  int r = sd_cmd_r1(55, (uint32_t)card.rca << 16);
+
+  return r ? r : sd_cmd(idx, arg, resp);
+}
+
+/**
+ * @brief 카드가 전송 상태이고 데이터를 받을 수 있을 때까지 (앞 쓰기 busy)
+ */
+static int sd_wait_ready(void) {
+  TickType_t start = xTaskGetTickCount();
+
+  while (1) {
+    int r = sd_cmd_r1(13, (uint32_t)card.rca << 16);
+
+    if (r) {
+      return r;
+    }
+    if ((SDIO->RESP1 & SD_R1_READY_FOR_DATA) && SD_R1_STATE(SDIO->RESP1) == SD_R1_STATE_TRAN) {
+      return 0;
+    }
+    if (xTaskGetTickCount() - start > pdMS_TO_TICKS(SD_BUSY_TMO_MS)) {
+      return SD_PORT_ERR_TMO;
+    }
+    vTaskDelay(1);
+  }
+}
+
+static void sd_hw_init(void) {
+  LL_GPIO_InitTypeDef gpio = {0};
+
+  LL_AHB1_GRP1_EnableClock(LL_AHB1_GRP1_PERIPH_GPIOC | LL_AHB1_GRP1_PERIPH_GPIOD |
+                           LL_AHB1_GRP1_PERIPH_DMA2);
+  LL_APB2_GRP1_EnableClock(LL_APB2_GRP1_PERIPH_SDIO);
+
+  gpio.Mode = LL_GPIO_MODE_ALTERNATE;
+  gpio.Speed = LL_GPIO_SPEED_FREQ_VERY_HIGH;
+  gpio.OutputType = LL_GPIO_OUTPUT_PUSHPULL;
+  gpio.Alternate = LL_GPIO_AF_12;
+
+  // D0~D3, CMD 는 pull-up (카드가 없거나 1 bit 면 high), CK 는 그대로
+  gpio.Pin = SD_BUS_4BIT ? LL_GPIO_PIN_8 | LL_GPIO_PIN_9 | LL_GPIO_PIN_10 | LL_GPIO_PIN_11
+                         : LL_GPIO_PIN_8;
+  gpio.Pull = LL_GPIO_PULL_UP;
+  LL_GPIO_Init(GPIOC, &gpio);
+  gpio.Pin = LL_GPIO_PIN_2;
+  LL_GPIO_Init(GPIOD, &gpio);
+  gpio.Pin = LL_GPIO_PIN_12;
+  gpio.Pull = LL_GPIO_PULL_NO;
+  LL_GPIO_Init(GPIOC, &gpio);
+
+  sd_done = xSemaphoreCreateBinaryStatic(&sd_done_buf);
+
+  NVIC_SetPriority(SDIO_IRQn, NVIC_EncodePriority(NVIC_GetPriorityGrouping(), SDIO_IRQ_PRIO, 0));
+  NVIC_EnableIRQ(SDIO_IRQn);
+
+  card.hw_ready = true;
+}
+
+/**
+ * @brief CSD 에서 용량 (block 수)
+ */
+static uint32_t sd_csd_blocks(void) {
+  uint32_t r1 = SDIO->RESP1, r2 = SDIO->RESP2, r3 = SDIO->RESP3;
+
+  if ((r1 >> 30) == 1) {
+    // CSD 2.0: C_SIZE [69:48], (C_SIZE + 1) x 512 KiB
+    uint32_t c_size = ((r2 & 0x3FU) << 16) | (r3 >> 16);
+
+    return (c_size + 1) * 1024U;
+  }
+
+  // CSD 1.0: C_SIZE [73:62], C_SIZE_MULT [49:47], READ_BL_LEN [83:80]
+  uint32_t c_size = ((r2 & 0x3FFU) << 2) | (r3 >> 30);
+  uint32_t mult = (r3 >> 15) & 0x7U;
+  uint32_t bl_len = (r2 >> 16) & 0xFU;
+
+  return (c_size + 1) << (mult + 2 + bl_len - 9);
+}
+
+int sd_port_init(void) {
+  uint32_t start;
+  uint32_t ocr = 0;
+  uint32_t blocks;
+  bool v2;
+  int r;
+
+  if (!card.hw_ready) {
+    sd_hw_init();
+  }
+  card.blocks = 0;
+  card.rca = 0;
+
+  LL_APB2_GRP1_ForceReset(LL_APB2_GRP1_PERIPH_SDIO);
+  LL_APB2_GRP1_ReleaseReset(LL_APB2_GRP1_PERIPH_SDIO);
+
+  // 전원 켜고 74 클럭 이상 흘린 뒤 CMD0
+  SDIO->CLKCR = SD_CLK_INIT_DIV;
+  SDIO->POWER = SDIO_POWER_PWRCTRL;
+  vTaskDelay(pdMS_TO_TICKS(2));
+  SDIO->CLKCR |= SDIO_CLKCR_CLKEN;
+  vTaskDelay(pdMS_TO_TICKS(2));
+
+  sd_cmd(0, 0, SD_RESP_NONE);
+  v2 = sd_cmd(8, SD_CHECK_PATTERN, SD_RESP_SHORT) == 0 && (SDIO->RESP1 & 0xFFFU) == SD_CHECK_PATTERN;
+
+  start = HAL_GetTick();
+  do {
+    if ((r = sd_acmd(41, SD_OCR_VOLT | (v2 ? SD_OCR_CCS : 0), SD_RESP_R3)) != 0) {
+      return r; // 카드 없음
+    }
+    ocr = SDIO->RESP1;
+    if (ocr & SD_OCR_BUSY) {
+      break;
+    }
+    vTaskDelay(pdMS_TO_TICKS(10));
+  } while (HAL_GetTick() - start < SD_INIT_TMO_MS);
+
+  if (!(ocr & SD_OCR_BUSY)) {
+    return SD_PORT_ERR_TMO;
+  }
+  card.sdhc = (ocr & SD_OCR_CCS) != 0;
+
+  if ((r = sd_cmd(2, 0, SD_RESP_LONG)) != 0 || (r = sd_cmd(3, 0, SD_RESP_SHORT)) != 0) {
+    return r;
+  }
+  card.rca = (uint16_t)(SDIO->RESP1 >> 16);
+
+  if ((r = sd_cmd(9, (uint32_t)card.rca << 16, SD_RESP_LONG)) != 0) {
+    return r;
+  }
+  blocks = sd_csd_blocks();
+
+  if ((r = sd_cmd_r1(7, (uint32_t)card.rca << 16)) != 0 ||
+      (!card.sdhc && (r = sd_cmd_r1(16, SD_BLOCK_SIZE)) != 0)) {
+    return r;
+  }
+
+  if (SD_BUS_4BIT) {
+    if ((r = sd_acmd(6, 2, SD_RESP_SHORT)) != 0) {
+      return r;
+    }
+    SDIO->CLKCR = SD_CLK_FAST_DIV | SDIO_CLKCR_CLKEN | SDIO_CLKCR_WIDBUS_0;
+  } else {
+    SDIO->CLKCR = SD_CLK_FAST_DIV | SDIO_CLKCR_CLKEN;
+  }
+  card.blocks = blocks;
+
+  LOG_INFO("SD %s %lu MiB, %d bit", card.sdhc ? "SDHC" : "SDSC", card.blocks / 2048,
+           SD_BUS_4BIT ? 4 : 1);
+  return 0;
+}
+
+uint32_t sd_port_blocks(void) { return card.blocks; }
+
+/**
+ * @brief DMA stream 설정 (SDIO 가 흐름 제어, word 4 개 burst)
+ */
+static void sd_dma_start(void *buf, bool write) {
+  DMA_Stream_TypeDef *s = SD_DMA_STREAM;
+
+  s->CR &= ~DMA_SxCR_EN;
+  while (s->CR & DMA_SxCR_EN) {
+  }
+  SD_DMA->HIFCR = DMA_HIFCR_CTCIF6 | DMA_HIFCR_CHTIF6 | DMA_HIFCR_CTEIF6 | DMA_HIFCR_CDMEIF6 |
+                  DMA_HIFCR_CFEIF6;
+
+  s->PAR = (uint32_t)&SDIO->FIFO;
+  s->M0AR = (uint32_t)buf;
+  s->NDTR = 0;
+  s->FCR = DMA_SxFCR_DMDIS | DMA_SxFCR_FTH; // FIFO 가득 (4 word)
+  s->CR = (SD_DMA_CHANNEL << DMA_SxCR_CHSEL_Pos) | DMA_SxCR_MBURST_0 | DMA_SxCR_PBURST_0 |
+          (((uint32_t)SDIO_DMA_PRIO & 0x3U) << DMA_SxCR_PL_Pos) | DMA_SxCR_MSIZE_1 |
+          DMA_SxCR_PSIZE_1 | DMA_SxCR_MINC | DMA_SxCR_PFCTRL | (write ? DMA_SxCR_DIR_0 : 0);
+  s->CR |= DMA_SxCR_EN;
+}
+
+/**
+ * @brief 전송 한 번: DMA 를 걸고 DATAEND 또는 에러 IRQ 까지 잠듦
+ */
+static int sd_xfer(uint32_t lba, void *buf, uint32_t n, bool write) {
+  uint32_t addr = card.sdhc ? lba : lba * SD_BLOCK_SIZE;
+  uint32_t dctrl = (9U << SDIO_DCTRL_DBLOCKSIZE_Pos) | SDIO_DCTRL_DMAEN | SDIO_DCTRL_DTEN;
+  uint32_t start;
+  int r;
+
+  if (card.blocks == 0 || ((uint32_t)buf & 3U) || n == 0 || lba + n > card.blocks) {
+    return SD_PORT_ERR_CMD;
+  }
+  if ((r = sd_wait_ready()) != 0) {
+    return r;
+  }
+
+  if (write && n > 1 && (r = sd_acmd(23, n, SD_RESP_SHORT)) != 0) {
+    return r;
+  }
+
+  xSemaphoreTake(sd_done, 0);
+  sd_sta = 0;
+  sd_dma_start(buf, write);
+  SDIO->ICR = SD_ICR_ALL;
+  SDIO->DTIMER = SD_DATA_TMO_CLK;
+  SDIO->DLEN = n * SD_BLOCK_SIZE;
+  SDIO->MASK = SD_MASK_DATA;
+
+  // 읽기는 DPSM 을 먼저 열고 명령, 쓰기는 명령 응답 뒤에 데이터
+  if (write) {
+    r = sd_cmd_r1(n > 1 ? 25 : 24, addr);
+    if (r == 0) {
+      SDIO->DCTRL = dctrl;
+    }
+  } else {
+    SDIO->DCTRL = dctrl | SDIO_DCTRL_DTDIR;
+    r = sd_cmd_r1(n > 1 ? 18 : 17, addr);
+  }
+
+  if (r == 0 && xSemaphoreTake(sd_done, pdMS_TO_TICKS(SD_XFER_TMO_MS)) != pdTRUE) {
+    r = SD_PORT_ERR_TMO;
+  }
+  if (r == 0 && (sd_sta & SD_STA_DATA_ERR)) {
+    r = (sd_sta & SDIO_STA_DTIMEOUT) ? SD_PORT_ERR_TMO : SD_PORT_ERR_DATA;
+  }
+
+  SDIO->MASK = 0;
+  SDIO->DCTRL = 0;
+  if (n > 1 || r != 0) {
+    int s = sd_cmd_r1(12, 0); // STOP (에러면 카드를 전송 상태로 되돌림)
+
+    if (r == 0) {
+      r = s;
+    }
+  }
+
+  // 읽기는 DMA FIFO 가 메모리로 다 비워질 때까지
+  start = HAL_GetTick();
+  while ((SD_DMA_STREAM->CR & DMA_SxCR_EN) && HAL_GetTick() - start <= SD_DMA_TMO_MS) {
+  }
+  if (SD_DMA_STREAM->CR & DMA_SxCR_EN) {
+    SD_DMA_STREAM->CR &= ~DMA_SxCR_EN;
+    if (r == 0) {
+      r = SD_PORT_ERR_DATA;
+    }
+  }
+  SDIO->ICR = SD_ICR_ALL;
+
+  return r;
+}
+
+int sd_port_read(uint32_t lba, void *buf, uint32_t n) { return sd_xfer(lba, buf, n, false); }
+
+int sd_port_write(uint32_t lba, const void *buf, uint32_t n) {
+  return sd_xfer(lba, (void *)buf, n, true);
+}
+
+void SDIO_IRQHandler(void) {
+  BaseType_t woken = pdFALSE;
+
+  sd_sta = SDIO->STA;
+  SDIO->MASK = 0;
+  xSemaphoreGiveFromISR(sd_done, &woken);
+  portYIELD_FROM_ISR(woken);
+}
+
+#endif
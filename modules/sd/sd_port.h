@@ -0,0 +1,49 @@
+#ifndef SD_PORT_H
+#define SD_PORT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief SD 카드 (SDIO + DMA2 Stream6, 레지스터 직접, ST SD 라이브러리 없음)
+ *
+ * block 장치로만 쓴다 (파일 시스템 없음). 읽기/쓰기는 호출 태스크가 DMA 가
+ * 끝날 때까지 잠들고, 여러 block 쓰기는 ACMD23 으로 미리 지울 block 수를
+ * 알려 CMD25 한 번에 보낸다. 카드가 앞 쓰기를 프로그램하는 동안 (busy) 은
+ * 다음 명령 앞에서 CMD13 으로 기다린다. 한 태스크에서만 부른다.
+ */
+#define SD_BLOCK_SIZE 512
+
+#define SD_PORT_ERR_CMD -1  // 응답 없음 (카드 없음) 또는 카드 상태 에러
+#define SD_PORT_ERR_DATA -2 // 데이터 CRC, FIFO under/overrun
+#define SD_PORT_ERR_TMO -3  // 데이터 또는 busy 시간 초과
+
+/**
+ * @brief 핀, 클럭 설정 후 카드 초기화 (400 kHz 로 식별 뒤 24 MHz)
+ *
+ * 다시 불러도 된다 (카드를 다시 넣었을 때).
+ *
+ * @return int 0 성공, SD_PORT_ERR_*
+ */
+int sd_port_init(void);
+
+/**
+ * @brief 카드 전체 block 수 (초기화 전이면 0)
+ */
+uint32_t sd_port_blocks(void);
+
+/**
+ * @brief block 읽기
+ *
+ * @param buf 4 byte 정렬, CCM 이 아닌 RAM
+ */
+int sd_port_read(uint32_t lba, void *buf, uint32_t n);
+
+/**
+ * @brief block 쓰기 (n > 1 이면 pre-erase + multi-block)
+ *
+ * @param buf 4 byte 정렬, CCM 이 아닌 RAM
+ */
+int sd_port_write(uint32_t lba, const void *buf, uint32_t n);
+
+#endif
@@ -0,0 +1,187 @@
+#include "usb_app.h"
+#include "usb_port.h"
+#include "board_config.h"
+#include "at_cmd.h"
+#include "rtos_static.h"
+#include <stdio.h>
+#include <string.h>
+#if USE_RS485
+#include "rs485_app.h"
+#elif USE_BLE
+#include "ble_app.h"
+#endif
+
+#if USE_USB
+
+#ifndef TAG
+#define TAG "USB_APP"
+#endif
+
+#include "log.h"
+
+#define USB_TASK_STACK_WORDS 512 // 커맨드 핸들러가 이 스택에서 돎 (RS485/BLE RX 와 같게)
+#define USB_POLL_MS 100
+#define USB_REPLY_WAIT_MS 200    // 응답이 링에 다 들어갈 때까지
+
+typedef enum {
+  USB_MODE_CMD = 0,
+  USB_MODE_RAW,
+} usb_mode_t;
+
+RTOS_STATIC_TASK(usb_task, USB_TASK_STACK_WORDS);
+
+static volatile uint8_t usb_mode;
+static volatile bool usb_log_on = true;
+static at_cmd_line_t usb_line;
+
+static const at_resp_t usb_resp_ok = AT_RESP("OK\r\n");
+static const at_resp_t usb_resp_err = AT_RESP("ERROR\r\n");
+
+bool usb_app_stream_on(void) { return usb_mode == USB_MODE_RAW && usb_port_is_open(); }
+
+size_t usb_app_stream_write(const void *data, size_t len) { return usb_port_write(data, len); }
+
+uint32_t usb_app_stream_dropped(void) {
+  usb_port_stats_t st;
+
+  usb_port_get_stats(&st);
+  return st.tx_drop;
+}
+
+/**
+ * @brief log mirror: 커맨드 모드에서 줄이 통째로 들어갈 때만
+ */
+static bool usb_log_write(const char *line, size_t len) {
+  if (usb_mode != USB_MODE_CMD || !usb_log_on || !usb_port_is_open() ||
+      usb_port_write_room() < len) {
+    return false;
+  }
+  return usb_port_write(line, len) == len;
+}
+
+/**
+ * @brief 커맨드 응답 (링이 비길 잠깐 기다림, 진단 조각처럼 긴 것)
+ */
+static bool usb_reply(const char *data, size_t len) {
+  TickType_t start = xTaskGetTickCount();
+
+  while (len > 0 && usb_port_is_open()) {
+    size_t n = usb_port_write(data, len);
+
+    data += n;
+    len -= n;
+    if (len == 0) {
+      break;
+    }
+    if (xTaskGetTickCount() - start > pdMS_TO_TICKS(USB_REPLY_WAIT_MS)) {
+      return false;
+    }
+    vTaskDelay(1);
+  }
+  return len == 0;
+}
+
+static void usb_status_reply(void) {
+  usb_port_stats_t st;
+  char buf[112];
+
+  usb_port_get_stats(&st);
+  snprintf(buf, sizeof(buf), "+USB,mode=%s,log=%u,tx=%lu,drop=%lu,rx=%lu,rst=%lu\r\n",
+           usb_mode == USB_MODE_RAW ? "raw" : "cmd", usb_log_on ? 1 : 0,
+           (unsigned long)st.tx_bytes, (unsigned long)st.tx_drop, (unsigned long)st.rx_bytes,
+           (unsigned long)st.resets);
+  usb_reply(buf, strlen(buf));
+}
+
+/**
+ * @brief 한 줄: USB 것이 아니면 보드의 커맨드 표로
+ */
+static void usb_run_line(const char *line, size_t len) {
+  bool ok;
+
+  if (len == 0) {
+    return;
+  }
+  if (strcmp(line, "USB?") == 0) {
+    usb_status_reply();
+    return;
+  }
+  if (strcmp(line, "USB+RAW") == 0) {
+    usb_reply(usb_resp_ok.str, usb_resp_ok.len);
+    usb_mode = USB_MODE_RAW;
+    LOG_INFO("USB raw tee 모드");
+    return;
+  }
+  if (strncmp(line, "USB+LOG=", 8) == 0 && (line[8] == '0' || line[8] == '1') && line[9] == '\0') {
+    usb_log_on = line[8] == '1';
+    usb_reply(usb_resp_ok.str, usb_resp_ok.len);
+    return;
+  }
+
+#if USE_RS485
+  ok = rs485_run_line(line, len, usb_reply);
+#elif USE_BLE
+  ok = ble_run_line(line, len, usb_reply);
+#else
+  ok = false;
+#endif
+  if (!ok) {
+    usb_reply(usb_resp_err.str, usb_resp_err.len);
+  }
+}
+
+static void usb_rx(void) {
+  char buf[64];
+  size_t n;
+
+  while ((n = usb_port_read(buf, sizeof(buf))) > 0) {
+    if (usb_mode != USB_MODE_CMD) {
+      continue; // raw 모드 입력은 버림
+    }
+    for (size_t i = 0; i < n; i++) {
+      char c = buf[i];
+
+      if (c == '\r' || c == '\n') {
+        usb_run_line(usb_line.data, usb_line.pos);
+        at_cmd_line_reset(&usb_line);
+      } else if (!at_cmd_line_put(&usb_line, c)) {
+        at_cmd_line_reset(&usb_line); // 너무 긴 줄은 버림
+      }
+    }
+  }
+}
+
+static void usb_task_fn(void *pvParameter) {
+  bool open = false;
+
+  (void)pvParameter;
+
+  while (1) {
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(USB_POLL_MS));
+
+    if (usb_port_is_open() != open) {
+      open = !open;
+      // 닫으면 (DTR, 뽑힘) 다음에 열 때 커맨드 모드부터
+      usb_mode = USB_MODE_CMD;
+      at_cmd_line_reset(&usb_line);
+      LOG_INFO("USB 포트 %s", open ? "열림" : "닫힘");
+    }
+    if (open) {
+      usb_rx();
+    }
+  }
+}
+
+void usb_app_init(void) {
+  TaskHandle_t task;
+
+  at_cmd_line_reset(&usb_line);
+  task = RTOS_TASK_CREATE_STATIC(usb_task, usb_task_fn, "usb", NULL, tskIDLE_PRIORITY + 1);
+  if (usb_port_init(task) != 0) {
+    vTaskDelete(task);
+    return;
+  }
+  log_set_mirror(usb_log_write);
+}
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef USB_APP_H
+#define USB_APP_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief USB CDC 포트 용도 (USE_USB 보드만)
+ *
+ * 포트를 열면 커맨드 모드로 시작한다: 로그 (지연 로거가 RTT 로 내보내는
+ * 줄과 같은 것) 가 나가고, 받은 줄은 보드의 커맨드 (RS485 보드는 AT+...,
+ * BLE 보드는 앱 커맨드) 로 처리해 응답도 USB 로 돌려준다. USB 만의 줄:
+ *
+ *   USB?        +USB,mode=<cmd|raw>,log=<0|1>,tx=,drop=,rx=,rst=
+ *   USB+LOG=<0|1> 로그 끄고 켜기
+ *   USB+RAW     GNSS raw tee (AT+GTEE / RT+ 설정) 를 이 포트로, 로그와 커맨드는
+ *               멈춤. 포트를 닫으면 (DTR) 커맨드 모드로 돌아감
+ *
+ * FS 코어 IN endpoint 가 4 개라 CDC ACM 두 개 (각각 bulk IN + interrupt IN)
+ * 는 들어가지 않아 포트 하나를 모드로 나눠 쓴다.
+ */
+
+/**
+ * @brief USB 포트와 태스크 시작
+ */
+void usb_app_init(void);
+
+/**
+ * @brief raw tee 가 USB 로 나가는 중
+ */
+bool usb_app_stream_on(void);
+
+/**
+ * @brief raw tee 송신 (GNSS RX 태스크, 블로킹 없음)
+ *
+ * @return size_t 넣은 길이
+ */
+size_t usb_app_stream_write(const void *data, size_t len);
+
+/**
+ * @brief 포트 송신 링이 차서 버린 byte (누적)
+ */
+uint32_t usb_app_stream_dropped(void);
+
+#endif
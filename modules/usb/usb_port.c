@@ -0,0 +1,812 @@
+#include "usb_port.h"
+#include "board_config.h"
+#include "stm32f4xx_hal.h"
+#include "stm32f4xx_ll_bus.h"
+#include "stm32f4xx_ll_gpio.h"
+#include "stm32f4xx_ll_utils.h"
+#include <stdio.h>
+#include <string.h>
+
+#if USE_USB
+
+#ifndef TAG
+#define TAG "USB_PORT"
+#endif
+
+#include "log.h"
+
+#define USBX USB_OTG_FS
+#define USB_DEV ((USB_OTG_DeviceTypeDef *)(USB_OTG_FS_PERIPH_BASE + USB_OTG_DEVICE_BASE))
+#define USB_IN(i)                                                              \
+  ((USB_OTG_INEndpointTypeDef *)(USB_OTG_FS_PERIPH_BASE + USB_OTG_IN_ENDPOINT_BASE + (i) * 0x20U))
+#define USB_OUT(i)                                                             \
+  ((USB_OTG_OUTEndpointTypeDef *)(USB_OTG_FS_PERIPH_BASE + USB_OTG_OUT_ENDPOINT_BASE + (i) * 0x20U))
+#define USB_FIFO(i) (*(volatile uint32_t *)(USB_OTG_FS_PERIPH_BASE + USB_OTG_FIFO_BASE + (i) * 0x1000U))
+#define USB_PCGCCTL (*(volatile uint32_t *)(USB_OTG_FS_PERIPH_BASE + USB_OTG_PCGCCTL_BASE))
+
+#define USB_EP0_MPS 64
+#define USB_CDC_MPS 64
+#define USB_CDC_NOTIF_MPS 8
+#define USB_EP_DATA 1   // bulk IN/OUT
+#define USB_EP_NOTIF 2  // interrupt IN (보낼 것은 없지만 ACM 에 필요)
+
+/* FIFO 크기 [word], FS 코어 전체 320 word */
+#define USB_FIFO_RX_WORDS 128
+#define USB_FIFO_EP0_WORDS (USB_EP0_MPS / 4)
+#define USB_FIFO_DATA_WORDS (USB_CDC_XFER_MAX / 4)
+#define USB_FIFO_NOTIF_WORDS 16
+_Static_assert(USB_FIFO_RX_WORDS + USB_FIFO_EP0_WORDS + USB_FIFO_DATA_WORDS +
+                       USB_FIFO_NOTIF_WORDS <= 320, "OTG FS FIFO 320 word");
+_Static_assert((USB_CDC_TX_RING & (USB_CDC_TX_RING - 1)) == 0, "USB_CDC_TX_RING 은 2 의 거듭제곱");
+_Static_assert((USB_CDC_RX_RING & (USB_CDC_RX_RING - 1)) == 0, "USB_CDC_RX_RING 은 2 의 거듭제곱");
+
+/* GRXSTSP PKTSTS */
+#define USB_RX_OUT_DATA 2
+#define USB_RX_SETUP_DATA 6
+
+#define USB_RESET_TMO_MS 10
+
+/* bmRequestType / bRequest */
+#define USB_REQ_DIR_IN 0x80
+#define USB_REQ_TYPE_MASK 0x60
+#define USB_REQ_TYPE_STD 0x00
+#define USB_REQ_TYPE_CLASS 0x20
+#define USB_REQ_GET_STATUS 0x00
+#define USB_REQ_SET_ADDRESS 0x05
+#define USB_REQ_GET_DESCRIPTOR 0x06
+#define USB_REQ_GET_CONFIGURATION 0x08
+#define USB_REQ_SET_CONFIGURATION 0x09
+#define USB_REQ_GET_INTERFACE 0x0A
+#define USB_REQ_SET_INTERFACE 0x0B
+#define CDC_SET_LINE_CODING 0x20
+#define CDC_GET_LINE_CODING 0x21
+#define CDC_SET_CONTROL_LINE_STATE 0x22
+#define CDC_SEND_BREAK 0x23
+
+#define USB_DESC_DEVICE 1
+#define USB_DESC_CONFIG 2
+#define USB_DESC_STRING 3
+
+#define USB_STR_SERIAL 3
+
+typedef enum {
+  EP0_IDLE = 0,
+  EP0_DATA_IN,   // IN 데이터 단계
+  EP0_DATA_OUT,  // OUT 데이터 단계 (line coding)
+  EP0_STATUS,    // 상태 단계 ZLP
+} ep0_state_t;
+
+static const uint8_t dev_desc[18] = {
+    18, USB_DESC_DEVICE, 0x00, 0x02, // USB 2.0
+    0x02, 0x00, 0x00,                // CDC
+    USB_EP0_MPS,
+    USB_VID & 0xFF, USB_VID >> 8, USB_PID & 0xFF, USB_PID >> 8,
+    0x00, 0x01,                      // bcdDevice 1.00
+    1, 2, USB_STR_SERIAL, 1,
+};
+
+#define CFG_DESC_LEN 67
+
+static const uint8_t cfg_desc[CFG_DESC_LEN] = {
+    9, USB_DESC_CONFIG, CFG_DESC_LEN, 0, 2, 1, 0, 0x80, 50, // bus 전원 100 mA
+    /* 통신 interface 0 */
+    9, 4, 0, 0, 1, 0x02, 0x02, 0x01, 0,
+    5, 0x24, 0x00, 0x10, 0x01,             // header 1.10
+    5, 0x24, 0x01, 0x00, 1,                // call management
+    4, 0x24, 0x02, 0x02,                   // ACM: line coding, control line state
+    5, 0x24, 0x06, 0, 1,                   // union
+    7, 5, 0x80 | USB_EP_NOTIF, 0x03, USB_CDC_NOTIF_MPS, 0, 16,
+    /* 데이터 interface 1 */
+    9, 4, 1, 0, 2, 0x0A, 0x00, 0x00, 0,
+    7, 5, USB_EP_DATA, 0x02, USB_CDC_MPS, 0, 0,
+    7, 5, 0x80 | USB_EP_DATA, 0x02, USB_CDC_MPS, 0, 0,
+};
+
+static const uint8_t str_lang[4] = {4, USB_DESC_STRING, 0x09, 0x04};
+static const char *const str_ascii[] = {NULL, "IOTIZ", "GUGU RTK"};
+static uint8_t str_buf[2 + 2 * 24]; // UTF-16LE 로 바꾼 문자열 하나 (EP0 가 보내는 동안 유지)
+
+static struct {
+  TaskHandle_t notify;
+  volatile bool configured;
+  volatile bool suspended;
+  volatile bool dtr;
+  uint8_t config;
+  uint8_t line_coding[7];
+
+  /* EP0 */
+  uint8_t setup[8];
+  uint8_t ep0_buf[8];
+  ep0_state_t ep0;
+  const uint8_t *ep0_ptr;
+  uint16_t ep0_left;
+  bool ep0_zlp;
+  uint8_t ep0_req;
+
+  /* 송신: head 는 쓰는 태스크 (critical), tail 과 전송 상태는 IRQ */
+  uint8_t tx_ring[USB_CDC_TX_RING];
+  volatile uint32_t tx_head, tx_tail;
+  uint32_t tx_len;  // 진행 중 전송 길이 (0: ZLP)
+  uint32_t tx_fill; // 그중 FIFO 에 넣은 길이
+  bool tx_busy;
+
+  /* 수신: head 는 IRQ, tail 은 읽는 태스크 */
+  uint8_t rx_ring[USB_CDC_RX_RING];
+  volatile uint32_t rx_head, rx_tail;
+  volatile bool rx_armed;
+
+  usb_port_stats_t stats;
+} usb;
+
+static void usb_notify_from_isr(BaseType_t *woken) {
+  if (usb.notify) {
+    vTaskNotifyGiveFromISR(usb.notify, woken);
+  }
+}
+
+static bool usb_core_reset(void) {
+  uint32_t start = HAL_GetTick();
+
+  while (!(USBX->GRSTCTL & USB_OTG_GRSTCTL_AHBIDL)) {
+    if (HAL_GetTick() - start > USB_RESET_TMO_MS) {
+      return false;
+    }
+  }
+  USBX->GRSTCTL |= USB_OTG_GRSTCTL_CSRST;
+  while (USBX->GRSTCTL & USB_OTG_GRSTCTL_CSRST) {
+    if (HAL_GetTick() - start > USB_RESET_TMO_MS) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static void usb_flush_tx(uint32_t num) {
+  USBX->GRSTCTL = USB_OTG_GRSTCTL_TXFFLSH | (num << USB_OTG_GRSTCTL_TXFNUM_Pos);
+  while (USBX->GRSTCTL & USB_OTG_GRSTCTL_TXFFLSH) {
+  }
+}
+
+static void usb_flush_rx(void) {
+  USBX->GRSTCTL = USB_OTG_GRSTCTL_RXFFLSH;
+  while (USBX->GRSTCTL & USB_OTG_GRSTCTL_RXFFLSH) {
+  }
+}
+
+/**
+ * @brief FIFO 에 byte 열을 word 로 (마지막 word 는 남는 byte 0)
+ */
+static void usb_fifo_write(uint8_t ep, const uint8_t *src, uint32_t len) {
+  volatile uint32_t *fifo = &USB_FIFO(ep);
+
+  for (uint32_t i = 0; i < len; i += 4) {
+    uint32_t w = 0;
+
+    memcpy(&w, &src[i], len - i < 4 ? len - i : 4);
+    *fifo = w;
+  }
+}
+
+/* ---------------------------------------------------------------- EP0 */
+
+static void ep0_out_start(bool data) {
+  USB_OUT(0)->DOEPTSIZ = (3U << USB_OTG_DOEPTSIZ_STUPCNT_Pos) | (1U << USB_OTG_DOEPTSIZ_PKTCNT_Pos) |
+                         USB_EP0_MPS;
+  if (data) {
+    USB_OUT(0)->DOEPCTL |= USB_OTG_DOEPCTL_EPENA | USB_OTG_DOEPCTL_CNAK;
+  }
+}
+
+static void ep0_in_packet(const uint8_t *data, uint16_t len) {
+  USB_IN(0)->DIEPTSIZ = (1U << USB_OTG_DIEPTSIZ_PKTCNT_Pos) | len;
+  USB_IN(0)->DIEPCTL |= USB_OTG_DIEPCTL_EPENA | USB_OTG_DIEPCTL_CNAK;
+  if (len) {
+    usb_fifo_write(0, data, len); // FIFO 0 은 packet 하나 크기이고 지금 비어 있음
+  }
+}
+
+static void ep0_stall(void) {
+  USB_IN(0)->DIEPCTL |= USB_OTG_DIEPCTL_STALL;
+  USB_OUT(0)->DOEPCTL |= USB_OTG_DOEPCTL_STALL;
+  usb.ep0 = EP0_IDLE;
+}
+
+static void ep0_status_in(void) {
+  usb.ep0 = EP0_STATUS;
+  ep0_in_packet(NULL, 0);
+}
+
+/**
+ * @brief IN 데이터 단계 시작 (요청 길이로 자르고, 짧게 끝나는데 MPS 배수면 ZLP)
+ */
+static void ep0_send(const uint8_t *data, uint16_t len) {
+  uint16_t want = (uint16_t)(usb.setup[6] | usb.setup[7] << 8);
+
+  if (len > want) {
+    len = want;
+  }
+  usb.ep0 = EP0_DATA_IN;
+  usb.ep0_ptr = data;
+  usb.ep0_left = len;
+  usb.ep0_zlp = len < want && len % USB_EP0_MPS == 0;
+
+  uint16_t n = len < USB_EP0_MPS ? len : USB_EP0_MPS;
+  ep0_in_packet(data, n);
+  usb.ep0_ptr += n;
+  usb.ep0_left -= n;
+}
+
+static void ep0_in_done(void) {
+  if (usb.ep0 != EP0_DATA_IN) {
+    usb.ep0 = EP0_IDLE;
+    return;
+  }
+  if (usb.ep0_left || usb.ep0_zlp) {
+    uint16_t n = usb.ep0_left < USB_EP0_MPS ? usb.ep0_left : USB_EP0_MPS;
+
+    if (n == 0) {
+      usb.ep0_zlp = false;
+    }
+    ep0_in_packet(usb.ep0_ptr, n);
+    usb.ep0_ptr += n;
+    usb.ep0_left -= n;
+    return;
+  }
+  // 호스트의 상태 단계 ZLP OUT 받기
+  usb.ep0 = EP0_STATUS;
+  ep0_out_start(true);
+}
+
+static const uint8_t *usb_string(uint8_t idx, uint16_t *len) {
+  char serial[25];
+  const char *s;
+  size_t n;
+
+  if (idx == 0) {
+    *len = sizeof(str_lang);
+    return str_lang;
+  }
+  if (idx == USB_STR_SERIAL) {
+    snprintf(serial, sizeof(serial), "%08lX%08lX%08lX", (unsigned long)LL_GetUID_Word2(),
+             (unsigned long)LL_GetUID_Word1(), (unsigned long)LL_GetUID_Word0());
+    s = serial;
+  } else if (idx < sizeof(str_ascii) / sizeof(str_ascii[0])) {
+    s = str_ascii[idx];
+  } else {
+    return NULL;
+  }
+
+  n = strlen(s);
+  if (n > (sizeof(str_buf) - 2) / 2) {
+    n = (sizeof(str_buf) - 2) / 2;
+  }
+  str_buf[0] = (uint8_t)(2 + 2 * n);
+  str_buf[1] = USB_DESC_STRING;
+  for (size_t i = 0; i < n; i++) {
+    str_buf[2 + 2 * i] = (uint8_t)s[i];
+    str_buf[3 + 2 * i] = 0;
+  }
+  *len = str_buf[0];
+  return str_buf;
+}
+
+static void usb_rx_arm(void);
+
+/**
+ * @brief SET_CONFIGURATION: 데이터/알림 endpoint 켜고 OUT 받기 시작
+ */
+static void usb_configure(uint8_t config) {
+  usb.config = config;
+  if (config == 0) {
+    usb.configured = false;
+    USB_IN(USB_EP_DATA)->DIEPCTL &= ~USB_OTG_DIEPCTL_USBAEP;
+    USB_IN(USB_EP_NOTIF)->DIEPCTL &= ~USB_OTG_DIEPCTL_USBAEP;
+    USB_OUT(USB_EP_DATA)->DOEPCTL &= ~USB_OTG_DOEPCTL_USBAEP;
+    return;
+  }
+
+  USB_IN(USB_EP_DATA)->DIEPCTL = USB_CDC_MPS | (2U << USB_OTG_DIEPCTL_EPTYP_Pos) |
+                                 ((uint32_t)USB_EP_DATA << USB_OTG_DIEPCTL_TXFNUM_Pos) |
+                                 USB_OTG_DIEPCTL_SD0PID_SEVNFRM | USB_OTG_DIEPCTL_USBAEP;
+  USB_IN(USB_EP_NOTIF)->DIEPCTL = USB_CDC_NOTIF_MPS | (3U << USB_OTG_DIEPCTL_EPTYP_Pos) |
+                                  ((uint32_t)USB_EP_NOTIF << USB_OTG_DIEPCTL_TXFNUM_Pos) |
+                                  USB_OTG_DIEPCTL_SD0PID_SEVNFRM | USB_OTG_DIEPCTL_USBAEP;
+  USB_OUT(USB_EP_DATA)->DOEPCTL = USB_CDC_MPS | (2U << USB_OTG_DOEPCTL_EPTYP_Pos) |
+                                  USB_OTG_DOEPCTL_SD0PID_SEVNFRM | USB_OTG_DOEPCTL_USBAEP;
+  USB_DEV->DAINTMSK |= (1U << USB_EP_DATA) | (1U << (16 + USB_EP_DATA));
+
+  usb_flush_tx(USB_EP_DATA);
+  usb.tx_busy = false;
+  usb.tx_tail = usb.tx_head; // 열기 전 것은 버림
+  usb.rx_head = usb.rx_tail = 0;
+  usb.rx_armed = false;
+  usb.configured = true;
+  usb_rx_arm();
+}
+
+static void usb_setup_std(void) {
+  const uint8_t *s = usb.setup;
+  uint16_t value = (uint16_t)(s[2] | s[3] << 8);
+  static uint8_t reply[2];
+  const uint8_t *desc = NULL;
+  uint16_t len = 0;
+
+  switch (s[1]) {
+  case USB_REQ_GET_DESCRIPTOR:
+    switch (value >> 8) {
+    case USB_DESC_DEVICE:
+      desc = dev_desc;
+      len = sizeof(dev_desc);
+      break;
+    case USB_DESC_CONFIG:
+      desc = cfg_desc;
+      len = sizeof(cfg_desc);
+      break;
+    case USB_DESC_STRING:
+      desc = usb_string((uint8_t)value, &len);
+      break;
+    default: // device qualifier 등 (FS 전용)
+      break;
+    }
+    if (!desc) {
+      ep0_stall();
+      return;
+    }
+    ep0_send(desc, len);
+    return;
+  case USB_REQ_SET_ADDRESS:
+    // OTG 코어는 상태 단계 전에 주소를 넣어도 상태 ZLP 는 옛 주소로 나감
+    USB_DEV->DCFG = (USB_DEV->DCFG & ~USB_OTG_DCFG_DAD) | ((value & 0x7FU) << USB_OTG_DCFG_DAD_Pos);
+    ep0_status_in();
+    return;
+  case USB_REQ_SET_CONFIGURATION:
+    if (value > 1) {
+      ep0_stall();
+      return;
+    }
+    usb_configure((uint8_t)value);
+    ep0_status_in();
+    return;
+  case USB_REQ_GET_CONFIGURATION:
+    reply[0] = usb.config;
+    ep0_send(reply, 1);
+    return;
+  case USB_REQ_GET_STATUS:
+    reply[0] = reply[1] = 0;
+    ep0_send(reply, 2);
+    return;
+  case USB_REQ_GET_INTERFACE:
+    reply[0] = 0;
+    ep0_send(reply, 1);
+    return;
+  case USB_REQ_SET_INTERFACE:
+  default: // CLEAR/SET_FEATURE 는 받아만 둠 (halt 된 endpoint 가 없음)
+    ep0_status_in();
+    return;
+  }
+}
+
+static void usb_setup_class(BaseType_t *woken) {
+  const uint8_t *s = usb.setup;
+
+  switch (s[1]) {
+  case CDC_SET_LINE_CODING:
+    usb.ep0 = EP0_DATA_OUT;
+    usb.ep0_req = s[1];
+    ep0_out_start(true);
+    return;
+  case CDC_GET_LINE_CODING:
+    ep0_send(usb.line_coding, sizeof(usb.line_coding));
+    return;
+  case CDC_SET_CONTROL_LINE_STATE:
+    usb.dtr = (s[2] & 0x01) != 0;
+    usb_notify_from_isr(woken);
+    ep0_status_in();
+    return;
+  case CDC_SEND_BREAK:
+    ep0_status_in();
+    return;
+  default:
+    ep0_stall();
+    return;
+  }
+}
+
+static void usb_setup(BaseType_t *woken) {
+  uint8_t type = usb.setup[0] & USB_REQ_TYPE_MASK;
+
+  usb.ep0 = EP0_IDLE;
+  if (type == USB_REQ_TYPE_STD) {
+    usb_setup_std();
+  } else if (type == USB_REQ_TYPE_CLASS) {
+    usb_setup_class(woken);
+  } else {
+    ep0_stall();
+  }
+}
+
+static void ep0_out_done(void) {
+  if (usb.ep0 == EP0_DATA_OUT) {
+    if (usb.ep0_req == CDC_SET_LINE_CODING) {
+      memcpy(usb.line_coding, usb.ep0_buf, sizeof(usb.line_coding));
+      memcpy(&usb.stats.baud, usb.line_coding, 4);
+    }
+    ep0_status_in();
+    return;
+  }
+  // 상태 단계 OUT 끝, 다음 SETUP 기다림
+  usb.ep0 = EP0_IDLE;
+  ep0_out_start(false);
+}
+
+/* ------------------------------------------------------------ 데이터 */
+
+/**
+ * @brief 진행 중 전송의 남은 packet 을 FIFO 자리만큼 (IRQ 또는 critical)
+ */
+static void usb_tx_fill(void) {
+  USB_OTG_INEndpointTypeDef *ep = USB_IN(USB_EP_DATA);
+
+  while (usb.tx_fill < usb.tx_len) {
+    uint32_t n = usb.tx_len - usb.tx_fill;
+
+    if (n > USB_CDC_MPS) {
+      n = USB_CDC_MPS;
+    }
+    if ((ep->DTXFSTS & USB_OTG_DTXFSTS_INEPTFSAV) < (n + 3) / 4) {
+      USB_DEV->DIEPEMPMSK |= 1U << USB_EP_DATA; // 빈 자리가 나면 다시
+      return;
+    }
+    usb_fifo_write(USB_EP_DATA,
+                   &usb.tx_ring[(usb.tx_tail + usb.tx_fill) & (USB_CDC_TX_RING - 1)], n);
+    usb.tx_fill += n;
+  }
+  USB_DEV->DIEPEMPMSK &= ~(1U << USB_EP_DATA);
+}
+
+/**
+ * @brief 쉬고 있으면 링의 연속 구간 하나를 전송으로 (IRQ 또는 critical)
+ */
+static void usb_tx_kick(bool zlp) {
+  uint32_t avail, off, len;
+
+  if (!usb.configured || usb.tx_busy) {
+    return;
+  }
+  avail = usb.tx_head - usb.tx_tail;
+  if (avail == 0 && !zlp) {
+    return;
+  }
+
+  off = usb.tx_tail & (USB_CDC_TX_RING - 1);
+  len = avail;
+  if (len > USB_CDC_TX_RING - off) {
+    len = USB_CDC_TX_RING - off;
+  }
+  if (len > USB_CDC_XFER_MAX) {
+    len = USB_CDC_XFER_MAX;
+  }
+
+  usb.tx_len = len;
+  usb.tx_fill = 0;
+  usb.tx_busy = true;
+  USB_IN(USB_EP_DATA)->DIEPTSIZ =
+      ((len ? (len + USB_CDC_MPS - 1) / USB_CDC_MPS : 1U) << USB_OTG_DIEPTSIZ_PKTCNT_Pos) | len;
+  USB_IN(USB_EP_DATA)->DIEPCTL |= USB_OTG_DIEPCTL_EPENA | USB_OTG_DIEPCTL_CNAK;
+  usb_tx_fill();
+}
+
+static void usb_tx_done(void) {
+  uint32_t len = usb.tx_len;
+
+  usb.tx_tail += len;
+  usb.tx_busy = false;
+  usb.stats.tx_bytes += len;
+  // 호스트 읽기가 끝나도록, MPS 배수로 끝났는데 더 보낼 게 없으면 ZLP
+  usb_tx_kick(len && len % USB_CDC_MPS == 0 && usb.tx_head == usb.tx_tail);
+}
+
+static void usb_rx_arm(void) {
+  if (!usb.configured || usb.rx_armed ||
+      USB_CDC_RX_RING - (usb.rx_head - usb.rx_tail) < USB_CDC_MPS) {
+    return;
+  }
+  usb.rx_armed = true;
+  USB_OUT(USB_EP_DATA)->DOEPTSIZ = (1U << USB_OTG_DOEPTSIZ_PKTCNT_Pos) | USB_CDC_MPS;
+  USB_OUT(USB_EP_DATA)->DOEPCTL |= USB_OTG_DOEPCTL_EPENA | USB_OTG_DOEPCTL_CNAK;
+}
+
+/**
+ * @brief RX FIFO 맨 앞 항목 하나 (SETUP 또는 OUT 데이터)
+ */
+static void usb_rx_pop(void) {
+  uint32_t sts = USBX->GRXSTSP;
+  uint8_t ep = (uint8_t)(sts & USB_OTG_GRXSTSP_EPNUM);
+  uint32_t cnt = (sts & USB_OTG_GRXSTSP_BCNT) >> USB_OTG_GRXSTSP_BCNT_Pos;
+  uint32_t pkt = (sts & USB_OTG_GRXSTSP_PKTSTS) >> USB_OTG_GRXSTSP_PKTSTS_Pos;
+  volatile uint32_t *fifo = &USB_FIFO(0);
+  uint8_t *dst = NULL;
+  uint32_t size = 0;
+
+  if (pkt != USB_RX_OUT_DATA && pkt != USB_RX_SETUP_DATA) {
+    return;
+  }
+  if (pkt == USB_RX_SETUP_DATA) {
+    dst = usb.setup;
+    size = sizeof(usb.setup);
+  } else if (ep == 0) {
+    dst = usb.ep0_buf;
+    size = sizeof(usb.ep0_buf);
+  }
+
+  for (uint32_t i = 0; i < cnt; i += 4) {
+    uint32_t w = *fifo;
+
+    for (uint32_t k = 0; k < 4 && i + k < cnt; k++) {
+      uint8_t b = (uint8_t)(w >> (8 * k));
+
+      if (dst) {
+        if (i + k < size) {
+          dst[i + k] = b;
+        }
+      } else if (ep == USB_EP_DATA) {
+        // arm 할 때 packet 하나 자리를 확인했음
+        usb.rx_ring[usb.rx_head & (USB_CDC_RX_RING - 1)] = b;
+        usb.rx_head++;
+      }
+    }
+  }
+  if (!dst && ep == USB_EP_DATA) {
+    usb.stats.rx_bytes += cnt;
+  }
+}
+
+static void usb_bus_reset(void) {
+  usb.stats.resets++;
+  usb.configured = false;
+  usb.suspended = false;
+  usb.dtr = false;
+  usb.config = 0;
+  usb.tx_busy = false;
+  usb.rx_armed = false;
+  usb.ep0 = EP0_IDLE;
+
+  USB_DEV->DCTL &= ~USB_OTG_DCTL_RWUSIG;
+  usb_flush_tx(0x10); // 전부
+  for (uint8_t i = 0; i < 4; i++) {
+    USB_IN(i)->DIEPINT = 0xFFFF;
+    USB_OUT(i)->DOEPINT = 0xFFFF;
+    USB_IN(i)->DIEPCTL = (USB_IN(i)->DIEPCTL & USB_OTG_DIEPCTL_EPENA)
+                             ? (USB_OTG_DIEPCTL_EPDIS | USB_OTG_DIEPCTL_SNAK)
+                             : 0;
+    USB_OUT(i)->DOEPCTL = (USB_OUT(i)->DOEPCTL & USB_OTG_DOEPCTL_EPENA)
+                              ? (USB_OTG_DOEPCTL_EPDIS | USB_OTG_DOEPCTL_SNAK)
+                              : 0;
+  }
+  USB_DEV->DAINT = 0xFFFFFFFFU;
+  USB_DEV->DAINTMSK = (1U << 0) | (1U << 16);
+  USB_DEV->DIEPMSK = USB_OTG_DIEPMSK_XFRCM;
+  USB_DEV->DOEPMSK = USB_OTG_DOEPMSK_XFRCM | USB_OTG_DOEPMSK_STUPM;
+  USB_DEV->DIEPEMPMSK = 0;
+  USB_DEV->DCFG &= ~USB_OTG_DCFG_DAD;
+  ep0_out_start(false);
+}
+
+static void usb_in_irq(void) {
+  uint32_t daint = USB_DEV->DAINT & USB_DEV->DAINTMSK & 0xFFFFU;
+
+  if (daint & (1U << 0)) {
+    uint32_t st = USB_IN(0)->DIEPINT;
+
+    USB_IN(0)->DIEPINT = st;
+    if (st & USB_OTG_DIEPINT_XFRC) {
+      ep0_in_done();
+    }
+  }
+  if (daint & (1U << USB_EP_DATA)) {
+    USB_OTG_INEndpointTypeDef *ep = USB_IN(USB_EP_DATA);
+    uint32_t st = ep->DIEPINT;
+
+    if (st & USB_OTG_DIEPINT_XFRC) {
+      ep->DIEPINT = USB_OTG_DIEPINT_XFRC;
+      usb_tx_done();
+    }
+    if ((st & USB_OTG_DIEPINT_TXFE) && (USB_DEV->DIEPEMPMSK & (1U << USB_EP_DATA))) {
+      usb_tx_fill();
+    }
+  }
+}
+
+static void usb_out_irq(BaseType_t *woken) {
+  uint32_t daint = USB_DEV->DAINT & USB_DEV->DAINTMSK;
+
+  if (daint & (1U << 16)) {
+    uint32_t st = USB_OUT(0)->DOEPINT;
+
+    USB_OUT(0)->DOEPINT = st;
+    if (st & USB_OTG_DOEPINT_STUP) {
+      ep0_out_start(false);
+      usb_setup(woken);
+    } else if (st & USB_OTG_DOEPINT_XFRC) {
+      ep0_out_done();
+    }
+  }
+  if (daint & (1U << (16 + USB_EP_DATA))) {
+    uint32_t st = USB_OUT(USB_EP_DATA)->DOEPINT;
+
+    USB_OUT(USB_EP_DATA)->DOEPINT = st;
+    if (st & USB_OTG_DOEPINT_XFRC) {
+      usb.rx_armed = false;
+      usb_rx_arm();
+      usb_notify_from_isr(woken);
+    }
+  }
+}
+
+void OTG_FS_IRQHandler(void) {
+  BaseType_t woken = pdFALSE;
+  uint32_t sts = USBX->GINTSTS & USBX->GINTMSK;
+
+  if (sts & USB_OTG_GINTSTS_USBRST) {
+    USBX->GINTSTS = USB_OTG_GINTSTS_USBRST;
+    usb_bus_reset();
+    usb_notify_from_isr(&woken);
+  }
+  if (sts & USB_OTG_GINTSTS_ENUMDNE) {
+    USBX->GINTSTS = USB_OTG_GINTSTS_ENUMDNE;
+    USB_IN(0)->DIEPCTL &= ~USB_OTG_DIEPCTL_MPSIZ; // 64 byte
+    USB_DEV->DCTL |= USB_OTG_DCTL_CGINAK;
+  }
+  if (sts & USB_OTG_GINTSTS_RXFLVL) {
+    USBX->GINTMSK &= ~USB_OTG_GINTMSK_RXFLVLM;
+    while (USBX->GINTSTS & USB_OTG_GINTSTS_RXFLVL) {
+      usb_rx_pop();
+    }
+    USBX->GINTMSK |= USB_OTG_GINTMSK_RXFLVLM;
+  }
+  if (sts & USB_OTG_GINTSTS_OEPINT) {
+    usb_out_irq(&woken);
+  }
+  if (sts & USB_OTG_GINTSTS_IEPINT) {
+    usb_in_irq();
+  }
+  if (sts & USB_OTG_GINTSTS_USBSUSP) {
+    USBX->GINTSTS = USB_OTG_GINTSTS_USBSUSP;
+    if (usb.configured && !usb.suspended) {
+      usb.stats.suspends++;
+    }
+    usb.suspended = true; // 케이블을 뽑아도 여기로 옴 (VBUS 감지 없음)
+    usb_notify_from_isr(&woken);
+  }
+  if (sts & USB_OTG_GINTSTS_WKUINT) {
+    USBX->GINTSTS = USB_OTG_GINTSTS_WKUINT;
+    usb.suspended = false;
+  }
+
+  portYIELD_FROM_ISR(woken);
+}
+
+/* ------------------------------------------------------------- API */
+
+int usb_port_init(TaskHandle_t notify) {
+  LL_GPIO_InitTypeDef gpio = {0};
+
+  usb.notify = notify;
+  // 115200 8N1 (호스트가 바꿔도 실제 속도와는 상관없음)
+  memcpy(usb.line_coding, (const uint8_t[]){0x00, 0xC2, 0x01, 0x00, 0, 0, 8}, 7);
+
+  LL_AHB1_GRP1_EnableClock(LL_AHB1_GRP1_PERIPH_GPIOA);
+  gpio.Pin = LL_GPIO_PIN_11 | LL_GPIO_PIN_12;
+  gpio.Mode = LL_GPIO_MODE_ALTERNATE;
+  gpio.Speed = LL_GPIO_SPEED_FREQ_VERY_HIGH;
+  gpio.OutputType = LL_GPIO_OUTPUT_PUSHPULL;
+  gpio.Pull = LL_GPIO_PULL_NO;
+  gpio.Alternate = LL_GPIO_AF_10;
+  LL_GPIO_Init(GPIOA, &gpio);
+  LL_AHB2_GRP1_EnableClock(LL_AHB2_GRP1_PERIPH_OTGFS);
+
+  USBX->GAHBCFG &= ~USB_OTG_GAHBCFG_GINT;
+  USBX->GUSBCFG |= USB_OTG_GUSBCFG_PHYSEL;
+  if (!usb_core_reset()) {
+    LOG_ERR("USB 코어 리셋 실패");
+    return -1;
+  }
+  USBX->GCCFG = USB_OTG_GCCFG_PWRDWN | USB_OTG_GCCFG_NOVBUSSENS;
+
+  // 장치 모드 강제, AHB 168 MHz 에서 turnaround 6
+  USBX->GUSBCFG = (USBX->GUSBCFG & ~(USB_OTG_GUSBCFG_FHMOD | USB_OTG_GUSBCFG_TRDT)) |
+                  USB_OTG_GUSBCFG_FDMOD | (6U << USB_OTG_GUSBCFG_TRDT_Pos);
+  HAL_Delay(25);
+
+  USB_PCGCCTL = 0;
+  USB_DEV->DCFG |= USB_OTG_DCFG_DSPD; // 내장 FS PHY
+  USB_DEV->DCTL |= USB_OTG_DCTL_SDIS;
+
+  USBX->GRXFSIZ = USB_FIFO_RX_WORDS;
+  USBX->DIEPTXF0_HNPTXFSIZ = (USB_FIFO_EP0_WORDS << 16) | USB_FIFO_RX_WORDS;
+  USBX->DIEPTXF[USB_EP_DATA - 1] = (USB_FIFO_DATA_WORDS << 16) |
+                                   (USB_FIFO_RX_WORDS + USB_FIFO_EP0_WORDS);
+  USBX->DIEPTXF[USB_EP_NOTIF - 1] =
+      (USB_FIFO_NOTIF_WORDS << 16) |
+      (USB_FIFO_RX_WORDS + USB_FIFO_EP0_WORDS + USB_FIFO_DATA_WORDS);
+  usb_flush_tx(0x10);
+  usb_flush_rx();
+
+  USB_DEV->DIEPMSK = 0;
+  USB_DEV->DOEPMSK = 0;
+  USB_DEV->DAINTMSK = 0;
+  USBX->GINTSTS = 0xFFFFFFFFU;
+  USBX->GINTMSK = USB_OTG_GINTMSK_USBRST | USB_OTG_GINTMSK_ENUMDNEM | USB_OTG_GINTMSK_RXFLVLM |
+                  USB_OTG_GINTMSK_IEPINT | USB_OTG_GINTMSK_OEPINT | USB_OTG_GINTMSK_USBSUSPM |
+                  USB_OTG_GINTMSK_WUIM;
+
+  NVIC_SetPriority(OTG_FS_IRQn, NVIC_EncodePriority(NVIC_GetPriorityGrouping(), USB_IRQ_PRIO, 0));
+  NVIC_EnableIRQ(OTG_FS_IRQn);
+  USBX->GAHBCFG |= USB_OTG_GAHBCFG_GINT;
+
+  USB_DEV->DCTL &= ~USB_OTG_DCTL_SDIS; // D+ pull-up, 호스트가 reset 부터
+  LOG_INFO("USB CDC 시작");
+  return 0;
+}
+
+bool usb_port_is_open(void) { return usb.configured && usb.dtr && !usb.suspended; }
+
+size_t usb_port_write_room(void) {
+  return USB_CDC_TX_RING - (usb.tx_head - usb.tx_tail);
+}
+
+size_t usb_port_write(const void *data, size_t len) {
+  const uint8_t *src = data;
+  uint32_t head, off, room, n;
+
+  if (!usb_port_is_open() || len == 0) {
+    return 0;
+  }
+
+  taskENTER_CRITICAL();
+  head = usb.tx_head;
+  room = USB_CDC_TX_RING - (head - usb.tx_tail);
+  n = len < room ? (uint32_t)len : room;
+  off = head & (USB_CDC_TX_RING - 1);
+  if (n > USB_CDC_TX_RING - off) {
+    memcpy(&usb.tx_ring[off], src, USB_CDC_TX_RING - off);
+    memcpy(usb.tx_ring, &src[USB_CDC_TX_RING - off], n - (USB_CDC_TX_RING - off));
+  } else {
+    memcpy(&usb.tx_ring[off], src, n);
+  }
+  usb.tx_head = head + n;
+  usb.stats.tx_drop += (uint32_t)(len - n);
+  usb_tx_kick(false);
+  taskEXIT_CRITICAL();
+
+  return n;
+}
+
+size_t usb_port_read(void *dst, size_t len) {
+  uint8_t *d = dst;
+  uint32_t tail = usb.rx_tail;
+  uint32_t n = usb.rx_head - tail;
+
+  if (n > len) {
+    n = (uint32_t)len;
+  }
+  for (uint32_t i = 0; i < n; i++) {
+    d[i] = usb.rx_ring[(tail + i) & (USB_CDC_RX_RING - 1)];
+  }
+  usb.rx_tail = tail + n;
+
+  if (n) {
+    taskENTER_CRITICAL();
+    usb_rx_arm(); // 자리가 없어 멈춰 있었으면 다시
+    taskEXIT_CRITICAL();
+  }
+  return n;
+}
+
+void usb_port_get_stats(usb_port_stats_t *out) {
+  taskENTER_CRITICAL();
+  *out = usb.stats;
+  taskEXIT_CRITICAL();
+}
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef USB_PORT_H
+#define USB_PORT_H
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief USB OTG FS 장치, CDC ACM 하나 (레지스터 직접, ST USB 라이브러리 없음)
+ *
+ * FS 코어는 DMA 가 없어 FIFO 를 IRQ 가 채우고 비운다. IN 은 송신 링의
+ * 연속 구간을 한 전송 (최대 USB_CDC_XFER_MAX) 으로 걸고 TX FIFO 가
+ * 비는 만큼 packet 을 미리 넣어 둬서 (FIFO 에 8 packet) 호스트가 앞
+ * packet 을 가져가는 동안 다음 것이 준비돼 있다. OUT 은 RX FIFO 에서 수신
+ * 링으로 바로 읽고, 링에 packet 하나 자리가 없으면 다시 받지 않아 (NAK)
+ * 호스트가 기다린다.
+ *
+ * 송신은 여러 태스크가 같이 쓰고 (critical section 안 memcpy), 호스트가 포트를
+ * 열지 않았으면 (DTR) 쌓지 않고 버린다.
+ */
+#define USB_CDC_TX_RING 4096 // 2 의 거듭제곱
+#define USB_CDC_RX_RING 512
+#define USB_CDC_XFER_MAX 512 // IN 전송 하나 (EP1 TX FIFO 크기)
+
+typedef struct {
+  uint32_t tx_bytes;
+  uint32_t tx_drop;  // 포트가 열려 있는데 링이 차서 버림
+  uint32_t rx_bytes;
+  uint32_t resets;   // bus reset
+  uint32_t suspends;
+  uint32_t baud;     // 호스트가 설정한 값 (의미 없음, 보고만)
+} usb_port_stats_t;
+
+/**
+ * @brief 클럭, 핀, 코어 설정 후 bus 에 붙음 (D+ pull-up)
+ *
+ * @param notify 수신 또는 포트 열림/닫힘 때 깨울 태스크 (xTaskNotifyGive)
+ * @return int 0 성공, -1 코어 리셋 시간 초과
+ */
+int usb_port_init(TaskHandle_t notify);
+
+/**
+ * @brief 송신 링에 복사 (블로킹 없음)
+ *
+ * @return size_t 넣은 길이, 포트가 닫혀 있으면 0
+ */
+size_t usb_port_write(const void *data, size_t len);
+
+/**
+ * @brief 송신 링 남은 자리 (통째로 넣을지 미리 볼 때)
+ */
+size_t usb_port_write_room(void);
+
+/**
+ * @brief 수신 링에서 꺼냄 (태스크 하나만)
+ */
+size_t usb_port_read(void *dst, size_t len);
+
+/**
+ * @brief 설정 끝났고 호스트가 포트를 열었음 (DTR)
+ */
+bool usb_port_is_open(void);
+
+void usb_port_get_stats(usb_port_stats_t *out);
+
+#endif
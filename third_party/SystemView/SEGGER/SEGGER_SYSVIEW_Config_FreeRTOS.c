@@ -53,6 +53,7 @@ Revision: $Rev: 7745 $
 */
 #include "FreeRTOS.h"
 #include "SEGGER_SYSVIEW.h"
+#include "trace_marker.h"
 
 extern const SEGGER_SYSVIEW_OS_API SYSVIEW_X_OS_TraceAPI;
 
@@ -87,6 +88,9 @@ extern const SEGGER_SYSVIEW_OS_API SYSVIEW_X_OS_TraceAPI;
 static void _cbSendSystemDesc(void) {
   SEGGER_SYSVIEW_SendSysDesc("N="SYSVIEW_APP_NAME",D="SYSVIEW_DEVICE_NAME",O=FreeRTOS");
   SEGGER_SYSVIEW_SendSysDesc("I#15=SysTick");
+#if defined(USE_TRACE_MARKERS)
+  trace_marker_send_names();
+#endif
 }
 
 /*********************************************************************